@@ -0,0 +1,124 @@
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012-2013 by European Organization for Nuclear Research (CERN)
+# Author: Justin Salmon <jsalmon@cern.ch>
+#-------------------------------------------------------------------------------
+# XRootD is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# XRootD is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with XRootD.  If not, see <http:#www.gnu.org/licenses/>.
+#-------------------------------------------------------------------------------
+"""Awaitable variants of :mod:`XRootD.client.File` and
+:mod:`XRootD.client.FileSystem` operations for use with :mod:`asyncio`.
+
+Completions are not handed to Python on the XrdCl worker threads. They are
+parked on a per event loop completion queue, and the loop is woken through a
+pipe that it watches, so the callbacks run on the loop thread and the GIL is
+only taken by that thread. Any number of requests may be in flight at once::
+
+  from XRootD.client.aio import AsyncFile
+
+  async def head(url):
+    f = AsyncFile()
+    status, _ = await f.open(url)
+    status, data = await f.read(0, 1024)
+    await f.close()
+    return data
+
+Every operation returns a future resolving to the same
+``(XRootDStatus, response)`` tuple the synchronous call would return.
+"""
+from __future__ import absolute_import, division, print_function
+
+import asyncio
+import weakref
+
+from pyxrootd import client
+from XRootD.client.file import File
+from XRootD.client.filesystem import FileSystem
+
+_queues = weakref.WeakKeyDictionary()
+
+def completion_queue(loop=None):
+  """Return the completion queue serving the given (or the current) event
+  loop, registering it with the loop on first use."""
+  if loop is None:
+    loop = asyncio.get_event_loop()
+  queue = _queues.get(loop)
+  if queue is None:
+    queue = client.CompletionQueue()
+    loop.add_reader(queue.fileno(), queue.drain)
+    _queues[loop] = queue
+  return queue
+
+class _QueuedCallback(object):
+  """Callback completing a future, bound to a completion queue."""
+  def __init__(self, queue, future):
+    self.queue = queue
+    self.future = future
+
+  def __call__(self, status, response, hostlist):
+    if not self.future.done():
+      self.future.set_result((status, response))
+
+def _submit(loop, method, *args, **kwargs):
+  future = loop.create_future()
+  kwargs['callback'] = _QueuedCallback(completion_queue(loop), future)
+  status = method(*args, **kwargs)
+  # The callback never fires for a request that could not be sent
+  if not status.ok:
+    future.set_result((status, None))
+  return future
+
+class _Awaitable(object):
+  _methods = ()
+
+  def __init__(self, target, loop):
+    self.__target = target
+    self.__loop = loop
+
+  def __getattr__(self, name):
+    attr = getattr(self.__target, name)
+    if name not in self._methods:
+      return attr
+    loop = self.__loop
+    def method(*args, **kwargs):
+      return _submit(loop or asyncio.get_event_loop(), attr, *args, **kwargs)
+    method.__doc__ = attr.__doc__
+    method.__name__ = name
+    return method
+
+class AsyncFile(_Awaitable):
+  """:mod:`XRootD.client.File` whose asynchronous operations (open, close,
+  stat, read, write, sync, truncate, vector_read, fcntl, visa) return
+  futures. Other attributes are those of the wrapped file.
+
+  :param loop: event loop to complete on, defaults to the current one
+  """
+  _methods = ('open', 'close', 'stat', 'read', 'write', 'sync', 'truncate',
+              'vector_read', 'fcntl', 'visa')
+
+  def __init__(self, loop=None):
+    _Awaitable.__init__(self, File(), loop)
+
+class AsyncFileSystem(_Awaitable):
+  """:mod:`XRootD.client.FileSystem` whose asynchronous operations return
+  futures. Other attributes are those of the wrapped file system.
+
+  :param  url: The URL of the server to connect with
+  :type   url: string
+  :param loop: event loop to complete on, defaults to the current one
+  """
+  _methods = ('locate', 'deeplocate', 'mv', 'query', 'truncate', 'rm',
+              'mkdir', 'rmdir', 'chmod', 'ping', 'stat', 'statvfs',
+              'protocol', 'dirlist', 'sendinfo', 'prepare')
+
+  def __init__(self, url, loop=None):
+    _Awaitable.__init__(self, FileSystem(url), loop)
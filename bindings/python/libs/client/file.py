@@ -126,6 +126,22 @@ class File(object):
     status, response = self.__file.read(offset, size, timeout)
     return XRootDStatus(status), response
 
+  def read_into(self, buffer, offset=0, size=0, timeout=0):
+    """Read a data chunk from a given offset directly into a writable object
+    supporting the buffer protocol (bytearray, memoryview, numpy array, ...).
+    No intermediate copy is made and the GIL is released while reading.
+
+    :param buffer: writable, contiguous buffer to be filled
+    :param offset: offset from the beginning of the file
+    :type  offset: integer
+    :param   size: number of bytes to be read, defaults to the buffer length
+    :type    size: integer
+    :returns:      tuple containing :mod:`XRootD.client.responses.XRootDStatus`
+                   object and the number of bytes that were read
+    """
+    status, nbytes = self.__file.read_into(buffer, offset, size, timeout)
+    return XRootDStatus(status), nbytes
+
   def readline(self, offset=0, size=0, chunksize=0):
     """Read a data chunk from a given offset, until the first newline or EOF
     encountered.
@@ -160,7 +176,7 @@ class File(object):
     """
     return self.__file.readlines(offset, size, chunksize)
 
-  def readchunks(self, offset=0, chunksize=1024 * 1024 * 2):
+  def readchunks(self, offset=0, chunksize=1024 * 1024 * 2, prefetch=0):
     """Return an iterator object which will read data chunks from a given
     offset of the given chunksize until EOF.
 
@@ -168,9 +184,13 @@ class File(object):
     :type     offset: integer
     :param chunksize: size of chunk to read, in bytes
     :type  chunksize: integer
+    :param  prefetch: number of chunks to keep reading asynchronously ahead of
+                      the one being returned; chunks still come back in order.
+                      With 0 each chunk is read when it is asked for.
+    :type   prefetch: integer
     :returns:         iterator object
     """
-    return self.__file.readchunks(offset, chunksize)
+    return self.__file.readchunks(offset, chunksize, prefetch)
 
   def write(self, buffer, offset=0, size=0, timeout=0, callback=None):
     """Write a data chunk at a given offset.
@@ -239,6 +259,21 @@ class File(object):
     if response: response = VectorReadInfo(response)
     return XRootDStatus(status), response
 
+  def vector_read_into(self, chunks, buffer=None, timeout=0):
+    """Read scattered data chunks in one operation, placing them back to back
+    in a single contiguous buffer. No per-chunk copies are made.
+
+    :param chunks: list of the chunks to be read, as for :func:`vector_read`
+    :type  chunks: list of 2-tuples of the form (offset, size)
+    :param buffer: optional writable buffer at least as large as the sum of
+                   the chunk sizes; a new bytearray is allocated if omitted
+    :returns:      tuple containing :mod:`XRootD.client.responses.XRootDStatus`
+                   object and a list with a memoryview of each chunk, in
+                   request order (None on failure)
+    """
+    status, response = self.__file.vector_read_into(chunks, buffer, timeout)
+    return XRootDStatus(status), response
+
   def fcntl(self, arg, timeout=0, callback=None):
     """Perform a custom operation on an open file.
 
@@ -26,11 +26,13 @@ class CallbackWrapper(object):
       raise TypeError('callback must be callable function, class or lambda')
     self.callback = callback
     self.responsetype = responsetype
+    # Callbacks bound to a completion queue keep that binding when wrapped
+    self.queue = getattr(callback, 'queue', None)
 
   def __call__(self, status, response, *argv):
     self.status = XRootDStatus(status)
     self.response = response
-    if self.responsetype:
+    if self.responsetype and response is not None:
       self.response = self.responsetype(response)
     if argv:
       self.hostlist = HostList(argv[0])
@@ -28,6 +28,7 @@
 #include "PyXRootD.hh"
 #include "Conversions.hh"
 #include "Utils.hh"
+#include "PyXRootDCompletionQueue.hh"
 #include "XrdCl/XrdClXRootDResponses.hh"
 
 namespace PyXRootD
@@ -36,14 +37,17 @@ namespace PyXRootD
   //! Generic asynchronous response handler
   //----------------------------------------------------------------------------
   template<typename Type>
-  class AsyncResponseHandler: public XrdCl::ResponseHandler
+  class AsyncResponseHandler: public XrdCl::ResponseHandler,
+                              public DeferredResponse
   {
     public:
       //------------------------------------------------------------------------
-      //! Constructor
+      //! Constructor, if a queue is given the callback is run when the queue
+      //! gets drained rather than on the XrdCl thread delivering the response
       //------------------------------------------------------------------------
-      AsyncResponseHandler( PyObject *callback ) :
-          callback( callback ), state( PyGILState_UNLOCKED ) {}
+      AsyncResponseHandler( PyObject *callback, CompletionQueue *queue = 0 ) :
+          callback( callback ), state( PyGILState_UNLOCKED ), queue( queue ),
+          dStatus( 0 ), dResponse( 0 ), dHostList( 0 ), dWithHosts( false ) {}
 
       //------------------------------------------------------------------------
       //! Destructor
@@ -57,6 +61,16 @@ namespace PyXRootD
                                     XrdCl::AnyObject *response,
                                     XrdCl::HostList *hostList )
       {
+        //----------------------------------------------------------------------
+        // Park the response on the completion queue without taking the GIL
+        //----------------------------------------------------------------------
+        if ( queue ) {
+          dStatus = status; dResponse = response; dHostList = hostList;
+          dWithHosts = true;
+          queue->Post( this );
+          return;
+        }
+
         // If we get called while the program's exit handlers are being called,
         // then calls to PyGILState_Ensure() deadlock.  Py_IsInitialized() is
         // not thread-safe but we appear to be lacking in alternates.
@@ -169,6 +183,12 @@ namespace PyXRootD
       void HandleResponse( XrdCl::XRootDStatus *status,
                            XrdCl::AnyObject *response )
       {
+        if ( queue ) {
+          dStatus = status; dResponse = response;
+          queue->Post( this );
+          return;
+        }
+
         // If we get called while the program's exit handlers are being called,
         // then calls to PyGILState_Ensure() deadlock.  Py_IsInitialized() is
         // not thread-safe but we appear to be lacking in alternates.
@@ -243,6 +263,20 @@ namespace PyXRootD
         delete this;
       }
 
+      //------------------------------------------------------------------------
+      //! Run the callback for a queued response, called with the GIL held
+      //! while the completion queue is being drained
+      //------------------------------------------------------------------------
+      void Deliver()
+      {
+        CompletionQueue *q = queue;
+        queue = 0;
+        if ( dWithHosts ) HandleResponseWithHosts( dStatus, dResponse,
+                                                   dHostList );
+        else HandleResponse( dStatus, dResponse );
+        Py_DECREF( q );
+      }
+
       //------------------------------------------------------------------------
       //! Parse out and convert the AnyObject response to a mapping type
       //------------------------------------------------------------------------
@@ -269,6 +303,11 @@ namespace PyXRootD
 
       PyObject *callback;
       PyGILState_STATE state;
+      CompletionQueue     *queue;
+      XrdCl::XRootDStatus *dStatus;
+      XrdCl::AnyObject    *dResponse;
+      XrdCl::HostList     *dHostList;
+      bool                 dWithHosts;
   };
 
   //----------------------------------------------------------------------------
@@ -281,7 +320,9 @@ namespace PyXRootD
       return NULL;
     }
 
-    return new AsyncResponseHandler<T>( callback );
+    CompletionQueue *queue = GetCompletionQueue( callback );
+    if ( queue ) Py_INCREF( queue );
+    return new AsyncResponseHandler<T>( callback, queue );
   }
 }
 
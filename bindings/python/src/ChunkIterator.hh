@@ -27,6 +27,9 @@
 
 #include "PyXRootD.hh"
 #include "PyXRootDFile.hh"
+#include "XrdCl/XrdClMessageUtils.hh"
+
+#include <deque>
 
 namespace PyXRootD
 {
@@ -36,25 +39,109 @@ namespace PyXRootD
   class ChunkIterator
   {
     public:
+      //------------------------------------------------------------------------
+      //! An outstanding read, the data lands straight in the bytes object
+      //! that will be handed out
+      //------------------------------------------------------------------------
+      struct Prefetch
+      {
+        XrdCl::SyncResponseHandler *handler;
+        PyObject                   *chunk;
+      };
+
       PyObject_HEAD
-      File    *file;
-      uint32_t chunksize;
-      uint64_t startOffset;
-      uint64_t currentOffset;
+      File                  *file;
+      uint32_t               chunksize;
+      uint64_t               startOffset;
+      uint64_t               currentOffset;
+      uint32_t               depth;
+      uint64_t               nextOffset;
+      bool                   atEnd;
+      std::deque<Prefetch>  *inflight;
   };
 
+  //----------------------------------------------------------------------------
+  //! Wait for an outstanding read to finish and return the number of bytes
+  //! read, or -1 if it failed
+  //----------------------------------------------------------------------------
+  static int64_t ChunkIterator_reap( ChunkIterator::Prefetch &rd )
+  {
+    XrdCl::ChunkInfo *info = 0;
+    int64_t           rlen = -1;
+
+    async( rd.handler->WaitForResponse() );
+
+    XrdCl::XRootDStatus *status   = rd.handler->GetStatus();
+    XrdCl::AnyObject    *response = rd.handler->GetResponse();
+    if ( status && status->IsOK() && response ) {
+      response->Get( info );
+      if ( info ) rlen = info->length;
+    }
+    delete status;
+    delete response;
+    delete rd.handler;
+    rd.handler = 0;
+    return rlen;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Keep up to depth reads in flight ahead of the consumer
+  //----------------------------------------------------------------------------
+  static void ChunkIterator_fill( ChunkIterator *self )
+  {
+    while ( !self->atEnd && self->inflight->size() < self->depth ) {
+      ChunkIterator::Prefetch rd;
+      rd.chunk = PyBytes_FromStringAndSize( NULL, self->chunksize );
+      if ( !rd.chunk ) {
+        PyErr_Clear();
+        return;
+      }
+      rd.handler = new XrdCl::SyncResponseHandler();
+
+      XrdCl::XRootDStatus st =
+          self->file->file->Read( self->nextOffset, self->chunksize,
+                                  PyBytes_AS_STRING( rd.chunk ), rd.handler );
+      if ( !st.IsOK() ) {
+        delete rd.handler;
+        Py_DECREF( rd.chunk );
+        self->atEnd = true;
+        return;
+      }
+
+      self->inflight->push_back( rd );
+      self->nextOffset += self->chunksize;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Wait for and discard all outstanding reads
+  //----------------------------------------------------------------------------
+  static void ChunkIterator_drain( ChunkIterator *self )
+  {
+    self->atEnd = true;
+    while ( !self->inflight->empty() ) {
+      ChunkIterator_reap( self->inflight->front() );
+      Py_DECREF( self->inflight->front().chunk );
+      self->inflight->pop_front();
+    }
+  }
+
   //----------------------------------------------------------------------------
   //! __init__
   //----------------------------------------------------------------------------
   static int ChunkIterator_init(ChunkIterator *self, PyObject *args)
   {
-    PyObject *py_offset = NULL, *py_chunksize = NULL;
+    PyObject *py_offset = NULL, *py_chunksize = NULL, *py_depth = NULL;
+    File     *file = NULL;
+
+    if ( self->inflight ) return 0;
 
-    if ( !PyArg_ParseTuple( args, "OOO", &self->file,&py_offset,
-                            &py_chunksize ) ) return -1;
+    if ( !PyArg_ParseTuple( args, "OOO|O", &file, &py_offset,
+                            &py_chunksize, &py_depth ) ) return -1;
 
     unsigned long long tmp_offset = 0;
     unsigned int tmp_chunksize = 2 * 1024 * 1024; // 2 MB
+    unsigned int tmp_depth = 0;
 
     if ( py_offset && PyObjToUllong( py_offset, &tmp_offset, "offset" ) )
       return -1;
@@ -62,12 +149,37 @@ namespace PyXRootD
     if ( py_chunksize && PyObjToUint( py_chunksize, &tmp_chunksize, "chunksize" ) )
       return -1;
 
+    if ( py_depth && PyObjToUint( py_depth, &tmp_depth, "prefetch" ) )
+      return -1;
+
+    //--------------------------------------------------------------------------
+    // Outstanding reads point into the file so we have to keep it around
+    //--------------------------------------------------------------------------
+    Py_INCREF( file );
+    self->file = file;
     self->startOffset = (uint64_t)tmp_offset;
     self->chunksize = (uint32_t)tmp_chunksize;
     self->currentOffset = self->startOffset;
+    self->depth = (uint32_t)tmp_depth;
+    self->nextOffset = self->startOffset;
+    self->atEnd = false;
+    self->inflight = new std::deque<ChunkIterator::Prefetch>();
     return 0;
   }
 
+  //----------------------------------------------------------------------------
+  //! Deallocation function, waits for reads still in flight
+  //----------------------------------------------------------------------------
+  static void ChunkIterator_dealloc( ChunkIterator *self )
+  {
+    if ( self->inflight ) {
+      ChunkIterator_drain( self );
+      delete self->inflight;
+    }
+    Py_XDECREF( self->file );
+    Py_TYPE(self)->tp_free( (PyObject*) self );
+  }
+
   //----------------------------------------------------------------------------
   //! __iter__
   //----------------------------------------------------------------------------
@@ -77,13 +189,48 @@ namespace PyXRootD
     return (PyObject*) self;
   }
 
+  //----------------------------------------------------------------------------
+  //! __iternext__ with prefetching, chunks are still returned in file order
+  //----------------------------------------------------------------------------
+  static PyObject* ChunkIterator_prefetch_next(ChunkIterator *self)
+  {
+    ChunkIterator_fill( self );
+    if ( self->inflight->empty() ) {
+      PyErr_SetNone( PyExc_StopIteration );
+      return NULL;
+    }
+
+    ChunkIterator::Prefetch rd = self->inflight->front();
+    self->inflight->pop_front();
+    int64_t rlen = ChunkIterator_reap( rd );
+
+    //--------------------------------------------------------------------------
+    // A short or failed read ends the iteration, as in the synchronous case
+    //--------------------------------------------------------------------------
+    if ( rlen <= 0 ) {
+      Py_DECREF( rd.chunk );
+      ChunkIterator_drain( self );
+      PyErr_SetNone( PyExc_StopIteration );
+      return NULL;
+    }
+
+    if ( (uint64_t)rlen < self->chunksize ) {
+      ChunkIterator_drain( self );
+      if ( _PyBytes_Resize( &rd.chunk, rlen ) ) return NULL;
+    }
+
+    self->currentOffset += self->chunksize;
+    ChunkIterator_fill( self );
+    return rd.chunk;
+  }
+
   //----------------------------------------------------------------------------
   //! __iternext__
-  //!
-  //! Dumb implementation, should use prefetching/readv
   //----------------------------------------------------------------------------
   static PyObject* ChunkIterator_iternext(ChunkIterator *self)
   {
+    if ( self->depth ) return ChunkIterator_prefetch_next( self );
+
     XrdCl::Buffer *chunk = self->file->ReadChunk( self->file,
                                                   self->currentOffset,
                                                   self->chunksize);
@@ -114,7 +261,7 @@ namespace PyXRootD
       "client.File.ChunkIterator",                /* tp_name */
       sizeof(ChunkIterator),                      /* tp_basicsize */
       0,                                          /* tp_itemsize */
-      0,                                          /* tp_dealloc */
+      (destructor) ChunkIterator_dealloc,         /* tp_dealloc */
       0,                                          /* tp_print */
       0,                                          /* tp_getattr */
       0,                                          /* tp_setattr */
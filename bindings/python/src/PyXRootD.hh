@@ -48,6 +48,8 @@
 #define PyBytes_Check PyString_Check
 #define PyBytes_FromString PyString_FromString
 #define PyBytes_FromStringAndSize PyString_FromStringAndSize
+#define PyBytes_AS_STRING PyString_AS_STRING
+#define _PyBytes_Resize _PyString_Resize
 #endif
 
 #endif /* PYXROOTD_HH_ */
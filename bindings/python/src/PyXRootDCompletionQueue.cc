@@ -0,0 +1,210 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2012-2014 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+
+#include "PyXRootDCompletionQueue.hh"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace PyXRootD
+{
+  PyDoc_STRVAR(completionqueue_type_doc, "CompletionQueue object (internal)");
+
+  //----------------------------------------------------------------------------
+  //! __init__() equivalent
+  //----------------------------------------------------------------------------
+  static int CompletionQueue_init( CompletionQueue *self, PyObject *args )
+  {
+    if ( self->mutex ) return 0;
+
+    if ( pipe( self->pipeFD ) ) {
+      PyErr_SetFromErrno( PyExc_OSError );
+      return -1;
+    }
+
+    for ( int i = 0; i < 2; ++i ) {
+      fcntl( self->pipeFD[i], F_SETFL,
+             fcntl( self->pipeFD[i], F_GETFL ) | O_NONBLOCK );
+      fcntl( self->pipeFD[i], F_SETFD, FD_CLOEXEC );
+    }
+
+    self->mutex = new XrdSysMutex();
+    self->items = new std::deque<DeferredResponse*>();
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Deallocation function, called when object is deleted. Every pending
+  //! response holds a reference to the queue so there are none left here.
+  //----------------------------------------------------------------------------
+  static void CompletionQueue_dealloc( CompletionQueue *self )
+  {
+    if ( self->mutex ) {
+      close( self->pipeFD[0] );
+      close( self->pipeFD[1] );
+      delete self->items;
+      delete self->mutex;
+    }
+    Py_TYPE(self)->tp_free( (PyObject*) self );
+  }
+
+  //----------------------------------------------------------------------------
+  // Queue a response and wake up the reader if the queue was empty
+  //----------------------------------------------------------------------------
+  void CompletionQueue::Post( DeferredResponse *rsp )
+  {
+    bool wakeUp;
+
+    mutex->Lock();
+    wakeUp = items->empty();
+    items->push_back( rsp );
+    mutex->UnLock();
+
+    if ( wakeUp ) {
+      ssize_t rc;
+      do { rc = write( pipeFD[1], "!", 1 ); } while ( rc < 0 && errno == EINTR );
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Return the file descriptor to wait on for readability
+  //----------------------------------------------------------------------------
+  PyObject* CompletionQueue::FileNo( CompletionQueue *self, PyObject *args,
+                                     PyObject *kwds )
+  {
+    return Py_BuildValue( "i", self->pipeFD[0] );
+  }
+
+  //----------------------------------------------------------------------------
+  // Run the callbacks of all queued responses, return how many were run
+  //----------------------------------------------------------------------------
+  PyObject* CompletionQueue::Drain( CompletionQueue *self, PyObject *args,
+                                    PyObject *kwds )
+  {
+    std::deque<DeferredResponse*> ready;
+    char buff[64];
+
+    //--------------------------------------------------------------------------
+    // Consume the wake up first: anything posted after the swap below finds
+    // the queue empty again and so writes a fresh byte.
+    //--------------------------------------------------------------------------
+    while ( read( self->pipeFD[0], buff, sizeof( buff ) ) > 0 ) {}
+
+    self->mutex->Lock();
+    ready.swap( *self->items );
+    self->mutex->UnLock();
+
+    for ( size_t i = 0; i < ready.size(); ++i ) ready[i]->Deliver();
+
+    return Py_BuildValue( "k", (unsigned long) ready.size() );
+  }
+
+  //----------------------------------------------------------------------------
+  // Return the number of responses waiting to be drained
+  //----------------------------------------------------------------------------
+  PyObject* CompletionQueue::Pending( CompletionQueue *self, PyObject *args,
+                                      PyObject *kwds )
+  {
+    unsigned long n;
+    self->mutex->Lock();
+    n = self->items->size();
+    self->mutex->UnLock();
+    return Py_BuildValue( "k", n );
+  }
+
+  //----------------------------------------------------------------------------
+  // Find the queue a callback is bound to
+  //----------------------------------------------------------------------------
+  CompletionQueue* GetCompletionQueue( PyObject *callback )
+  {
+    PyObject *queue = PyObject_GetAttrString( callback, "queue" );
+    if ( !queue ) {
+      PyErr_Clear();
+      return 0;
+    }
+
+    // The callback keeps the queue alive
+    Py_DECREF( queue );
+    if ( !PyObject_TypeCheck( queue, &CompletionQueueType ) ) return 0;
+    return (CompletionQueue*) queue;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Visible method definitions
+  //----------------------------------------------------------------------------
+  static PyMethodDef CompletionQueueMethods[] =
+  {
+    { "fileno",
+       (PyCFunction) PyXRootD::CompletionQueue::FileNo,  METH_VARARGS | METH_KEYWORDS, NULL },
+    { "drain",
+       (PyCFunction) PyXRootD::CompletionQueue::Drain,   METH_VARARGS | METH_KEYWORDS, NULL },
+    { "pending",
+       (PyCFunction) PyXRootD::CompletionQueue::Pending, METH_VARARGS | METH_KEYWORDS, NULL },
+
+    { NULL } /* Sentinel */
+  };
+
+  //----------------------------------------------------------------------------
+  //! CompletionQueue binding type object
+  //----------------------------------------------------------------------------
+  PyTypeObject CompletionQueueType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "pyxrootd.CompletionQueue",                 /* tp_name */
+    sizeof(CompletionQueue),                    /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor) CompletionQueue_dealloc,       /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_compare */
+    0,                                          /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    0,                                          /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    completionqueue_type_doc,                   /* tp_doc */
+    0,                                          /* tp_traverse */
+    0,                                          /* tp_clear */
+    0,                                          /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    0,                                          /* tp_iter */
+    0,                                          /* tp_iternext */
+    CompletionQueueMethods,                     /* tp_methods */
+    0,                                          /* tp_members */
+    0,                                          /* tp_getset */
+    0,                                          /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    (initproc) CompletionQueue_init,            /* tp_init */
+  };
+}
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2012-2014 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+
+#ifndef PYXROOTD_COMPLETION_QUEUE_HH_
+#define PYXROOTD_COMPLETION_QUEUE_HH_
+
+#include "PyXRootD.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+#include <deque>
+
+namespace PyXRootD
+{
+  //----------------------------------------------------------------------------
+  //! A response whose Python side handling has been put off until the owner
+  //! of the completion queue drains it
+  //----------------------------------------------------------------------------
+  class DeferredResponse
+  {
+    public:
+      virtual void Deliver() = 0;
+      virtual ~DeferredResponse() {}
+  };
+
+  //----------------------------------------------------------------------------
+  //! Completion queue binding class
+  //!
+  //! Responses for callbacks bound to a queue are parked here by the XrdCl
+  //! worker threads without touching the interpreter. The first response
+  //! added to an empty queue writes one byte to a pipe whose read end an
+  //! event loop can wait on; drain() then runs the callbacks on the thread
+  //! that owns the loop.
+  //----------------------------------------------------------------------------
+  class CompletionQueue
+  {
+    public:
+      static PyObject* FileNo( CompletionQueue *self, PyObject *args,
+                               PyObject *kwds );
+      static PyObject* Drain( CompletionQueue *self, PyObject *args,
+                              PyObject *kwds );
+      static PyObject* Pending( CompletionQueue *self, PyObject *args,
+                                PyObject *kwds );
+
+      //------------------------------------------------------------------------
+      //! Queue a response, may be called without holding the GIL
+      //------------------------------------------------------------------------
+      void Post( DeferredResponse *rsp );
+
+    public:
+      PyObject_HEAD
+      XrdSysMutex                    *mutex;
+      std::deque<DeferredResponse*>  *items;
+      int                             pipeFD[2];
+  };
+
+  extern PyTypeObject CompletionQueueType;
+
+  //----------------------------------------------------------------------------
+  //! Return the completion queue a callback is bound to (via its "queue"
+  //! attribute) or null if it is an ordinary callback
+  //----------------------------------------------------------------------------
+  CompletionQueue* GetCompletionQueue( PyObject *callback );
+}
+
+#endif /* PYXROOTD_COMPLETION_QUEUE_HH_ */
@@ -118,7 +118,15 @@ namespace PyXRootD
   //----------------------------------------------------------------------------
   PyObject* CopyProcess::Prepare( CopyProcess *self, PyObject *args, PyObject *kwds )
   {
-    XrdCl::XRootDStatus status = self->process->Prepare();
+    XrdCl::XRootDStatus status;
+
+    //--------------------------------------------------------------------------
+    //! Preparing may contact the source so do not hold the GIL meanwhile
+    //--------------------------------------------------------------------------
+    Py_BEGIN_ALLOW_THREADS
+    status = self->process->Prepare();
+    Py_END_ALLOW_THREADS
+
     return ConvertType( &status );
   }
 
@@ -181,9 +181,8 @@ namespace PyXRootD
       if (info) delete info;
     }
 
-    buffer = new char[size];
-
     if ( callback && callback != Py_None ) {
+      buffer = new char[size];
       XrdCl::ResponseHandler *handler = GetHandler<XrdCl::ChunkInfo>( callback );
       if ( !handler ) {
         delete[] buffer;
@@ -193,10 +192,18 @@ namespace PyXRootD
     }
 
     else {
-      uint32_t bytesRead;
+      //------------------------------------------------------------------------
+      // Read straight into the bytes object we hand back; nobody else can see
+      // it yet so it is safe to fill it with the GIL released.
+      //------------------------------------------------------------------------
+      uint32_t bytesRead = 0;
+      pyresponse = PyBytes_FromStringAndSize( NULL, size );
+      if ( !pyresponse ) return NULL;
+      buffer = PyBytes_AS_STRING( pyresponse );
       async( status = self->file->Read( offset, size, buffer, bytesRead, timeout ) );
-      pyresponse = PyBytes_FromStringAndSize( buffer, bytesRead );
-      delete[] buffer;
+      if ( !status.IsOK() ) bytesRead = 0;
+      if ( bytesRead != size && _PyBytes_Resize( &pyresponse, bytesRead ) )
+        return NULL;
     }
 
     pystatus = ConvertType<XrdCl::XRootDStatus>( &status );
@@ -208,6 +215,76 @@ namespace PyXRootD
     return o;
   }
 
+  //----------------------------------------------------------------------------
+  //! Read a data chunk at a given offset into a caller supplied buffer
+  //----------------------------------------------------------------------------
+  PyObject* File::ReadInto( File *self, PyObject *args, PyObject *kwds )
+  {
+    static const char  *kwlist[] = { "buffer", "offset", "size", "timeout",
+                                     NULL };
+    uint64_t            offset   = 0;
+    uint32_t            size     = 0;
+    uint16_t            timeout  = 0;
+    uint32_t            bytesRead = 0;
+    PyObject           *pybuffer = NULL, *pystatus = NULL;
+    PyObject           *py_offset = NULL, *py_size = NULL, *py_timeout = NULL;
+    Py_buffer           view;
+    XrdCl::XRootDStatus status;
+
+    if ( !self->file->IsOpen() ) return FileClosedError();
+
+    if ( !PyArg_ParseTupleAndKeywords( args, kwds, "O|OOO:read_into",
+        (char**) kwlist, &pybuffer, &py_offset, &py_size, &py_timeout ) )
+      return NULL;
+
+    unsigned long long tmp_offset = 0;
+    unsigned int tmp_size = 0;
+    unsigned short int tmp_timeout = 0;
+
+    if ( py_offset && PyObjToUllong( py_offset, &tmp_offset, "offset" ) )
+      return NULL;
+
+    if ( py_size && PyObjToUint(py_size, &tmp_size, "size" ) )
+      return NULL;
+
+    if ( py_timeout && PyObjToUshrt(py_timeout, &tmp_timeout, "timeout" ) )
+      return NULL;
+
+    offset = (uint64_t)tmp_offset;
+    size = (uint32_t)tmp_size;
+    timeout = (uint16_t)tmp_timeout;
+
+    //--------------------------------------------------------------------------
+    // The buffer stays exported (and hence cannot be resized) until the read
+    // completes, so we may safely fill it without holding the GIL
+    //--------------------------------------------------------------------------
+    if ( PyObject_GetBuffer( pybuffer, &view, PyBUF_WRITABLE ) ) return NULL;
+
+    if ( !size ) {
+      if ( (uint64_t)view.len > 0xffffffffULL ) {
+        PyBuffer_Release( &view );
+        PyErr_SetString( PyExc_ValueError, "buffer too large, give a size" );
+        return NULL;
+      }
+      size = (uint32_t)view.len;
+    }
+    else if ( (uint64_t)size > (uint64_t)view.len ) {
+      PyBuffer_Release( &view );
+      PyErr_SetString( PyExc_ValueError, "size exceeds the buffer length" );
+      return NULL;
+    }
+
+    async( status = self->file->Read( offset, size, view.buf, bytesRead,
+                                      timeout ) );
+    PyBuffer_Release( &view );
+    if ( !status.IsOK() ) bytesRead = 0;
+
+    pystatus = ConvertType<XrdCl::XRootDStatus>( &status );
+    PyObject *o = Py_BuildValue( "OI", pystatus, bytesRead );
+    Py_DECREF( pystatus );
+    return o;
+  }
+
   //----------------------------------------------------------------------------
   // Read a data chunk at a given offset, until the first newline encountered
   // or size data read.
@@ -362,15 +439,15 @@ namespace PyXRootD
   {
     XrdCl::XRootDStatus status;
     XrdCl::Buffer      *buffer;
-    XrdCl::Buffer      *temp;
-    uint32_t            bytesRead;
+    uint32_t            bytesRead = 0;
 
-    temp = new XrdCl::Buffer( size );
-    status = self->file->Read( offset, size, temp->GetBuffer(), bytesRead );
+    buffer = new XrdCl::Buffer( size );
+    async( status = self->file->Read( offset, size, buffer->GetBuffer(),
+                                      bytesRead ) );
+    if ( !status.IsOK() ) bytesRead = 0;
 
-    buffer = new XrdCl::Buffer( bytesRead );
-    buffer->Append( temp->GetBuffer(), bytesRead );
-    delete temp;
+    if ( !bytesRead ) buffer->Free();
+    else if ( bytesRead < size ) buffer->ReAllocate( bytesRead );
     return buffer;
   }
 
@@ -380,16 +457,19 @@ namespace PyXRootD
   //----------------------------------------------------------------------------
   PyObject* File::ReadChunks( File *self, PyObject *args, PyObject *kwds )
   {
-    static const char *kwlist[]  = { "offset", "chunksize", NULL };
+    static const char *kwlist[]  = { "offset", "chunksize", "prefetch", NULL };
     uint64_t           offset    = 0;
     uint32_t           chunksize = 0;
+    uint32_t           prefetch  = 0;
     ChunkIterator     *iterator;
     PyObject          *py_offset = NULL, *py_chunksize = NULL;
+    PyObject          *py_prefetch = NULL;
 
     if ( !self->file->IsOpen() ) return FileClosedError();
 
-    if ( !PyArg_ParseTupleAndKeywords( args, kwds, "|OO:readchunks",
-         (char**) kwlist, &py_offset, &py_chunksize ) ) return NULL;
+    if ( !PyArg_ParseTupleAndKeywords( args, kwds, "|OOO:readchunks",
+         (char**) kwlist, &py_offset, &py_chunksize, &py_prefetch ) )
+      return NULL;
 
     unsigned long long tmp_offset = 0;
     unsigned int tmp_chunksize = 1024 * 1024 *2;  // 2 MB
@@ -400,14 +480,19 @@ namespace PyXRootD
     if ( py_chunksize && PyObjToUint( py_chunksize, &tmp_chunksize, "chunksize" ) )
       return NULL;
 
+    unsigned int tmp_prefetch = 0;
+    if ( py_prefetch && PyObjToUint( py_prefetch, &tmp_prefetch, "prefetch" ) )
+      return NULL;
+
     offset = (uint64_t)tmp_offset;
     chunksize = (uint32_t)tmp_chunksize;
+    prefetch = (uint32_t)tmp_prefetch;
     ChunkIteratorType.tp_new = PyType_GenericNew;
 
     if ( PyType_Ready( &ChunkIteratorType ) < 0 ) return NULL;
 
-    args = Py_BuildValue( "OOO", self, Py_BuildValue("k", offset),
-                                       Py_BuildValue("I", chunksize) );
+    args = Py_BuildValue( "OKII", self, (unsigned long long) offset,
+                                        chunksize, prefetch );
     iterator = (ChunkIterator*)
                PyObject_CallObject( (PyObject *) &ChunkIteratorType, args );
     Py_DECREF( args );
@@ -556,6 +641,54 @@ namespace PyXRootD
     return o;
   }
 
+  //----------------------------------------------------------------------------
+  //! Convert a python list of (offset, length) tuples into a chunk list with
+  //! no buffers attached. Return nonzero and set an exception on error.
+  //----------------------------------------------------------------------------
+  static int ParseChunkList( PyObject *pychunks, XrdCl::ChunkList &chunks,
+                             const char *fname )
+  {
+    if ( !PyList_Check( pychunks ) ) {
+      PyErr_SetString( PyExc_TypeError, "chunks parameter must be a list" );
+      return -1;
+    }
+
+    for ( int i = 0; i < PyList_Size( pychunks ); ++i ) {
+      PyObject *chunk = PyList_GetItem( pychunks, i );
+
+      if ( !PyTuple_Check( chunk ) || ( PyTuple_Size( chunk ) != 2 ) ) {
+        PyErr_Format( PyExc_TypeError, "%s() expects list of tuples"
+                                       " of length 2", fname );
+        return -1;
+      }
+
+      // Check that offset and length values are valid
+      unsigned long long tmp_offset = 0;
+      unsigned int tmp_length = 0;
+
+      if ( PyObjToUllong( PyTuple_GetItem( chunk, 0 ), &tmp_offset, "offset" ) )
+        return -1;
+
+      if ( PyObjToUint( PyTuple_GetItem( chunk, 1 ), &tmp_length, "length" ) )
+        return -1;
+
+      chunks.push_back( XrdCl::ChunkInfo( (uint64_t)tmp_offset,
+                                          (uint32_t)tmp_length, 0 ) );
+    }
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Free the private chunk buffers allocated for a vector read
+  //----------------------------------------------------------------------------
+  static void FreeChunkList( XrdCl::ChunkList &chunks )
+  {
+    for ( size_t i = 0; i < chunks.size(); ++i ) {
+      delete[] (char*) chunks[i].buffer;
+      chunks[i].buffer = 0;
+    }
+  }
+
   //----------------------------------------------------------------------------
   //! Read scattered data chunks in one operation
   //----------------------------------------------------------------------------
@@ -563,8 +696,6 @@ namespace PyXRootD
   {
     static const char  *kwlist[] = { "chunks", "timeout", "callback", NULL };
     uint16_t            timeout  = 0;
-    uint64_t            offset   = 0;
-    uint32_t            length   = 0;
     PyObject           *pychunks = NULL, *callback = NULL;
     PyObject           *pyresponse = NULL, *pystatus = NULL, *py_timeout = NULL;
     XrdCl::XRootDStatus status;
@@ -582,40 +713,18 @@ namespace PyXRootD
 
     timeout = (uint16_t)tmp_timeout;
 
-    if ( !PyList_Check( pychunks ) ) {
-      PyErr_SetString( PyExc_TypeError, "chunks parameter must be a list" );
-      return NULL;
-    }
-
-    for ( int i = 0; i < PyList_Size( pychunks ); ++i ) {
-      PyObject *chunk = PyList_GetItem( pychunks, i );
-
-      if ( !PyTuple_Check( chunk ) || ( PyTuple_Size( chunk ) != 2 ) ) {
-        PyErr_SetString( PyExc_TypeError, "vector_read() expects list of tuples"
-                                          " of length 2" );
-        return NULL;
-      }
-
-      // Check that offset and length values are valid
-      unsigned long long tmp_offset = 0;
-      unsigned int tmp_length = 0;
-
-      if ( PyObjToUllong( PyTuple_GetItem( chunk, 0 ), &tmp_offset, "offset" ) )
-        return NULL;
-
-      if ( PyObjToUint( PyTuple_GetItem( chunk, 1 ), &tmp_length, "length" ) )
-        return NULL;
+    if ( ParseChunkList( pychunks, chunks, "vector_read" ) ) return NULL;
 
-      offset = (uint64_t)tmp_offset;
-      length = (uint32_t)tmp_length;
-      char    *buffer = new char[length];
-      chunks.push_back( XrdCl::ChunkInfo( offset, length, buffer ) );
-    }
+    for ( size_t i = 0; i < chunks.size(); ++i )
+      chunks[i].buffer = new char[chunks[i].length];
 
     if ( callback && callback != Py_None ) {
       XrdCl::ResponseHandler *handler
           = GetHandler<XrdCl::VectorReadInfo>( callback );
-      if ( !handler ) return NULL;
+      if ( !handler ) {
+        FreeChunkList( chunks );
+        return NULL;
+      }
       async( status = self->file->VectorRead( chunks, 0, handler, timeout ) );
     }
     else {
@@ -623,6 +732,7 @@ namespace PyXRootD
       async( status = self->file->VectorRead( chunks, 0, info, timeout ) );
       pyresponse = ConvertType<XrdCl::VectorReadInfo>( info );
       delete info;
+      FreeChunkList( chunks );
     }
 
     pystatus = ConvertType<XrdCl::XRootDStatus>( &status );
@@ -634,6 +744,102 @@ namespace PyXRootD
     return o;
   }
 
+  //----------------------------------------------------------------------------
+  //! Read scattered data chunks into one contiguous buffer and return
+  //! memoryviews of the individual chunks
+  //----------------------------------------------------------------------------
+  PyObject* File::VectorReadInto( File *self, PyObject *args, PyObject *kwds )
+  {
+    static const char  *kwlist[] = { "chunks", "buffer", "timeout", NULL };
+    uint16_t            timeout  = 0;
+    uint64_t            total    = 0;
+    PyObject           *pychunks = NULL, *pybuffer = NULL, *py_timeout = NULL;
+    PyObject           *target   = NULL, *pyresponse = NULL, *pystatus = NULL;
+    Py_buffer           view;
+    XrdCl::XRootDStatus status;
+    XrdCl::ChunkList    chunks;
+
+    if ( !self->file->IsOpen() ) return FileClosedError();
+
+    if ( !PyArg_ParseTupleAndKeywords( args, kwds, "O|OO:vector_read_into",
+         (char**) kwlist, &pychunks, &pybuffer, &py_timeout ) ) return NULL;
+
+    unsigned short int tmp_timeout = 0;
+
+    if ( py_timeout && PyObjToUshrt( py_timeout, &tmp_timeout, "timeout" ) )
+      return NULL;
+
+    timeout = (uint16_t)tmp_timeout;
+
+    if ( ParseChunkList( pychunks, chunks, "vector_read_into" ) ) return NULL;
+
+    for ( size_t i = 0; i < chunks.size(); ++i ) total += chunks[i].length;
+
+    //--------------------------------------------------------------------------
+    // Either fill the caller's buffer or allocate a single bytearray for all
+    // the chunks. Holding the buffer export across the read keeps the target
+    // from being resized while the GIL is released.
+    //--------------------------------------------------------------------------
+    if ( pybuffer && pybuffer != Py_None ) {
+      target = pybuffer;
+      Py_INCREF( target );
+    }
+    else if ( !( target = PyByteArray_FromStringAndSize( NULL, total ) ) )
+      return NULL;
+
+    if ( PyObject_GetBuffer( target, &view, PyBUF_WRITABLE ) ) {
+      Py_DECREF( target );
+      return NULL;
+    }
+
+    if ( (uint64_t)view.len < total ) {
+      PyBuffer_Release( &view );
+      Py_DECREF( target );
+      PyErr_SetString( PyExc_ValueError, "buffer too small for the chunks" );
+      return NULL;
+    }
+
+    char *where = (char*) view.buf;
+    for ( size_t i = 0; i < chunks.size(); ++i ) {
+      chunks[i].buffer = where;
+      where += chunks[i].length;
+    }
+
+    XrdCl::VectorReadInfo *info = 0;
+    async( status = self->file->VectorRead( chunks, 0, info, timeout ) );
+    delete info;
+    PyBuffer_Release( &view );
+
+    if ( status.IsOK() ) {
+      PyObject *mview = PyMemoryView_FromObject( target );
+      if ( !mview ) {
+        Py_DECREF( target );
+        return NULL;
+      }
+
+      pyresponse = PyList_New( chunks.size() );
+      Py_ssize_t start = 0;
+      for ( size_t i = 0; i < chunks.size(); ++i ) {
+        Py_ssize_t end = start + chunks[i].length;
+        PyList_SET_ITEM( pyresponse, i,
+                         PySequence_GetSlice( mview, start, end ) );
+        start = end;
+      }
+      Py_DECREF( mview );
+    }
+    else {
+      Py_INCREF( Py_None );
+      pyresponse = Py_None;
+    }
+    Py_DECREF( target );
+
+    pystatus = ConvertType<XrdCl::XRootDStatus>( &status );
+    PyObject *o = Py_BuildValue( "OO", pystatus, pyresponse );
+    Py_DECREF( pystatus );
+    Py_DECREF( pyresponse );
+    return o;
+  }
+
   //----------------------------------------------------------------------------
   // Perform a custom operation on an open file
   //----------------------------------------------------------------------------
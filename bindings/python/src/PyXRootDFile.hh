@@ -44,6 +44,7 @@ namespace PyXRootD
       static PyObject* Close( File *self, PyObject *args, PyObject *kwds );
       static PyObject* Stat( File *self, PyObject *args, PyObject *kwds );
       static PyObject* Read( File *self, PyObject *args, PyObject *kwds );
+      static PyObject* ReadInto( File *self, PyObject *args, PyObject *kwds );
       static PyObject* ReadLine( File *self, PyObject *args, PyObject *kwds );
       static PyObject* ReadLines( File *self, PyObject *args, PyObject *kwds );
       static XrdCl::Buffer* ReadChunk( File *self, uint64_t offset, uint32_t size );
@@ -52,6 +53,8 @@ namespace PyXRootD
       static PyObject* Sync( File *self, PyObject *args, PyObject *kwds );
       static PyObject* Truncate( File *self, PyObject *args, PyObject *kwds );
       static PyObject* VectorRead( File *self, PyObject *args, PyObject *kwds );
+      static PyObject* VectorReadInto( File *self, PyObject *args,
+                                       PyObject *kwds );
       static PyObject* Fcntl( File *self, PyObject *args, PyObject *kwds );
       static PyObject* Visa( File *self, PyObject *args, PyObject *kwds );
       static PyObject* IsOpen( File *self, PyObject *args, PyObject *kwds );
@@ -163,6 +166,8 @@ namespace PyXRootD
        (PyCFunction) PyXRootD::File::Stat,                METH_VARARGS | METH_KEYWORDS, NULL },
     { "read",
        (PyCFunction) PyXRootD::File::Read,                METH_VARARGS | METH_KEYWORDS, NULL },
+    { "read_into",
+       (PyCFunction) PyXRootD::File::ReadInto,            METH_VARARGS | METH_KEYWORDS, NULL },
     { "readline",
        (PyCFunction) PyXRootD::File::ReadLine,            METH_VARARGS | METH_KEYWORDS, NULL },
     { "readlines",
@@ -177,6 +182,8 @@ namespace PyXRootD
        (PyCFunction) PyXRootD::File::Truncate,            METH_VARARGS | METH_KEYWORDS, NULL },
     { "vector_read",
        (PyCFunction) PyXRootD::File::VectorRead,          METH_VARARGS | METH_KEYWORDS, NULL },
+    { "vector_read_into",
+       (PyCFunction) PyXRootD::File::VectorReadInto,      METH_VARARGS | METH_KEYWORDS, NULL },
     { "fcntl",
        (PyCFunction) PyXRootD::File::Fcntl,               METH_VARARGS | METH_KEYWORDS, NULL },
     { "visa",
@@ -27,6 +27,7 @@
 #include "PyXRootDFile.hh"
 #include "PyXRootDCopyProcess.hh"
 #include "PyXRootDURL.hh"
+#include "PyXRootDCompletionQueue.hh"
 
 namespace PyXRootD
 {
@@ -115,6 +116,16 @@ namespace PyXRootD
     }
     Py_INCREF( &CopyProcessType );
 
+    CompletionQueueType.tp_new = PyType_GenericNew;
+    if ( PyType_Ready( &CompletionQueueType ) < 0 ) {
+#ifdef IS_PY3K
+      return NULL;
+#else
+      return;
+#endif
+    }
+    Py_INCREF( &CompletionQueueType );
+
 #ifdef IS_PY3K
     ClientModule = PyModule_Create(&moduledef);
 #else
@@ -133,6 +144,7 @@ namespace PyXRootD
     PyModule_AddObject( ClientModule, "File", (PyObject *) &FileType );
     PyModule_AddObject( ClientModule, "URL", (PyObject *) &URLType );
     PyModule_AddObject( ClientModule, "CopyProcess", (PyObject *) &CopyProcessType );
+    PyModule_AddObject( ClientModule, "CompletionQueue", (PyObject *) &CompletionQueueType );
 
 #ifdef IS_PY3K
     return ClientModule;
@@ -0,0 +1,41 @@
+from XRootD import client
+from XRootD.client.flags import OpenFlags
+from env import *
+import pytest
+
+asyncio = pytest.importorskip('asyncio')
+from XRootD.client.aio import AsyncFile, AsyncFileSystem, completion_queue
+
+def run(future):
+  loop = asyncio.get_event_loop()
+  return loop.run_until_complete(asyncio.wait_for(future, 60))
+
+def test_aio_filesystem():
+  fs = AsyncFileSystem(SERVER_URL)
+  status, response = run(fs.ping())
+  assert status.ok
+  status, response = run(fs.stat(bigfile[len(SERVER_URL):]))
+  assert status.ok
+  assert response.size > 0
+  assert fs.url.hostname == client.FileSystem(SERVER_URL).url.hostname
+
+def test_aio_reads():
+  f = AsyncFile()
+  status, response = run(f.open(bigfile, OpenFlags.READ))
+  assert status.ok
+  status, response = run(f.stat())
+  size = min(response.size, 4 * 1024 * 1024)
+
+  status, data = run(f.read(0, size))
+  assert status.ok
+
+  chunk = 4096
+  futures = [f.read(off, chunk) for off in range(0, size, chunk)]
+  results = run(asyncio.gather(*futures))
+  assert all(status.ok for status, _ in results)
+  assert b''.join(response for _, response in results) == data
+  assert completion_queue().pending() == 0
+
+  status, response = run(f.close())
+  assert status.ok
+  pytest.raises(ValueError, 'f.read()')
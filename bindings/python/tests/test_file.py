@@ -181,6 +181,29 @@ def test_read_sync():
   assert len(response) == size
   f.close()
 
+def test_read_into_sync():
+  f = client.File()
+  status, response = f.open(bigfile, OpenFlags.READ)
+  assert status.ok
+  status, response = f.read(size=4096)
+  assert status.ok
+
+  buf = bytearray(4096)
+  status, nbytes = f.read_into(buf)
+  assert status.ok
+  assert nbytes == len(response)
+  assert bytes(buf[:nbytes]) == response
+
+  view = memoryview(buf)[1024:]
+  status, nbytes = f.read_into(view, offset=1024, size=1024)
+  assert status.ok
+  assert nbytes == 1024
+  assert bytes(buf[1024:2048]) == response[1024:2048]
+
+  pytest.raises(ValueError, 'f.read_into(buf, size=8192)')
+  pytest.raises(BufferError, 'f.read_into(bytes(16))')
+  f.close()
+
 def test_read_async():
   f = client.File()
   status, response = f.open(bigfile, OpenFlags.READ)
@@ -325,6 +348,23 @@ def test_readchunks_big():
   assert total == size
   f.close()
 
+def test_readchunks_prefetch():
+  f = client.File()
+  f.open(bigfile, OpenFlags.READ)
+  status, data = f.read()
+  assert status.ok
+
+  for depth in (1, 4):
+    chunks = list(f.readchunks(chunksize=64 * 1024, prefetch=depth))
+    assert b''.join(chunks) == data
+    assert all(len(chunk) == 64 * 1024 for chunk in chunks[:-1])
+
+  # Abandoning the iterator with reads in flight must be safe
+  it = f.readchunks(offset=1000, chunksize=1024, prefetch=8)
+  assert next(it) == data[1000:2024]
+  del it
+  f.close()
+
 def test_vector_read_sync():
   v = [(0, 100), (101, 200), (201, 200)]
   vlen = sum([vec[1] for vec in v])
@@ -347,6 +387,34 @@ def test_vector_read_sync():
 
   f.close()
 
+def test_vector_read_into_sync():
+  v = [(0, 100), (101, 200), (201, 200)]
+  vlen = sum([vec[1] for vec in v])
+
+  f = client.File()
+  status, __ = f.open(bigfile, OpenFlags.READ)
+  assert status.ok
+  status, stat_info = f.stat()
+  assert status.ok
+
+  if (stat_info.size > max([off + sz for (off, sz) in v])):
+    status, expected = f.vector_read(chunks=v)
+    assert status.ok
+    buf = bytearray(vlen)
+    status, views = f.vector_read_into(v, buf)
+    assert status.ok
+    assert len(views) == len(v)
+    for view, chunk in zip(views, expected.chunks):
+      assert view.tobytes() == chunk.buffer
+    assert bytes(buf) == b''.join([c.buffer for c in expected.chunks])
+
+    status, views = f.vector_read_into(v)
+    assert status.ok
+    assert [len(view) for view in views] == [sz for (off, sz) in v]
+
+  pytest.raises(ValueError, 'f.vector_read_into(v, bytearray(vlen - 1))')
+  f.close()
+
 def test_vector_read_async():
   v = [(0, 100), (101, 200), (201, 200)]
   vlen = sum([vec[1] for vec in v])
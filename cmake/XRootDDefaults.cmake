@@ -16,6 +16,7 @@ define_default( ENABLE_KRB5       TRUE )
 define_default( ENABLE_READLINE   TRUE )
 define_default( ENABLE_XRDCL      TRUE )
 define_default( ENABLE_TESTS      FALSE )
+define_default( ENABLE_BENCHMARKS FALSE )
 define_default( ENABLE_HTTP       TRUE )
 define_default( ENABLE_CEPH       TRUE )
 define_default( ENABLE_PYTHON     TRUE )
@@ -8,6 +8,7 @@ component_status( CRYPTO    BUILD_CRYPTO    OPENSSL_FOUND )
 component_status( KRB5      BUILD_KRB5      KERBEROS5_FOUND )
 component_status( XRDCL     ENABLE_XRDCL    TRUE_VAR )
 component_status( TESTS     BUILD_TESTS     CPPUNIT_FOUND )
+component_status( BENCH     ENABLE_BENCHMARKS TRUE_VAR )
 component_status( HTTP      BUILD_HTTP      OPENSSL_FOUND )
 component_status( TPC       BUILD_TPC       CURL_FOUND )
 component_status( MACAROONS BUILD_MACAROONS MACAROONS_FOUND )
@@ -27,6 +28,7 @@ message( STATUS "Crypto support:    " ${STATUS_CRYPTO} )
 message( STATUS "Kerberos5 support: " ${STATUS_KRB5} )
 message( STATUS "XrdCl:             " ${STATUS_XRDCL} )
 message( STATUS "Tests:             " ${STATUS_TESTS} )
+message( STATUS "Benchmarks:        " ${STATUS_BENCH} )
 message( STATUS "HTTP support:      " ${STATUS_HTTP} )
 message( STATUS "HTTP TPC support:  " ${STATUS_TPC} )
 message( STATUS "Macaroons support: " ${STATUS_MACAROONS} )
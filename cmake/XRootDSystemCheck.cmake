@@ -31,6 +31,11 @@ endif()
 check_include_file( shadow.h HAVE_SHADOWPW )
 compiler_define_if_found( HAVE_SHADOWPW HAVE_SHADOWPW )
 
+if( Linux )
+  check_symbol_exists( IORING_FEAT_RW_CUR_POS "linux/io_uring.h" HAVE_IO_URING )
+  compiler_define_if_found( HAVE_IO_URING HAVE_IO_URING )
+endif()
+
 #-------------------------------------------------------------------------------
 # Some socket related functions
 #-------------------------------------------------------------------------------
@@ -97,6 +102,12 @@ endif()
 check_include_file( et/com_err.h HAVE_ET_COM_ERR_H )
 compiler_define_if_found( HAVE_ET_COM_ERR_H HAVE_ET_COM_ERR_H )
 
+#-------------------------------------------------------------------------------
+# Check for static user space tracing probes (USDT)
+#-------------------------------------------------------------------------------
+check_include_file( sys/sdt.h HAVE_SDT )
+compiler_define_if_found( HAVE_SDT HAVE_SDT )
+
 #-------------------------------------------------------------------------------
 # Check for the atomics
 #-------------------------------------------------------------------------------
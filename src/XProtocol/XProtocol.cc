@@ -97,7 +97,8 @@ const char *reqNames[kXR_REQFENCE-kXR_auth] =
               "sync",        "stat",        "set",         "write",
               "admin",       "prepare",     "statx",       "endsess",
               "bind",        "readv",       "verifyw",     "locate",
-              "truncate",    "sigver",      "decrypt",     "writev"
+              "truncate",    "sigver",      "decrypt",     "writev",
+              "pgread"
              };
 
 // Following value is used to determine if the error or request code is
@@ -89,8 +89,38 @@
 #define kXR_attrProxy 0x00000200
 #define kXR_attrSuper 0x00000400
 
+// Set in the kXR_protocol response when the client asked for compressed read
+// responses (kXR_wantcmp) and the server provides them. See
+// ServerResponseCmp_Read for the format.
+//
+#define kXR_cmpRead   0x00010000
+
+// A data server may suggest how many parallel data substreams (kXR_bind) a
+// client on the network it connected from should use for large reads. The
+// number of substreams, not counting the main stream, is kept in these bits
+// of the kXR_protocol response flags (0 means no suggestion).
+//
+#define kXR_strmHint  0x00f00000
+#define kXR_strmShft  20
+
 #define kXR_maxReqRetry 10
 
+// The kXR_pgread response data is a sequence of units, each being the network
+// ordered CRC32C checksum of a page followed by the page data. Pages are
+// aligned on file offsets so the first and last unit may be short.
+//
+#define kXR_pgPageSZ 4096
+#define kXR_pgPageBL 12
+#define kXR_pgUnitSZ (kXR_pgPageSZ + 4)
+
+// A kXR_statx request uses the kXR_stat layout. With kXR_sfull set in options
+// the response holds one line per path, in request order and separated by new
+// lines. A line is either the kXR_stat response for the path or an '!'
+// followed by the kXR error code of the failure. Servers that do not know the
+// option return the flag bytes instead, which never contain a blank.
+//
+#define kXR_maxStatx 1024
+
 // Kind of error inside a XTNetFile's routine (temporary)
 //
 enum XReqErrorType {
@@ -140,6 +170,7 @@ enum XRequestTypes {
    kXR_sigver,  // 3029
    kXR_decrypt, // 3030
    kXR_writev,  // 3031
+   kXR_pgread,  // 3032
    kXR_REQFENCE // Always last valid request code +1
 };
 
@@ -190,7 +221,8 @@ enum XLoginVersion {
 };
 
 enum XStatRequestOption {
-   kXR_vfs    = 1
+   kXR_vfs    = 1,
+   kXR_sfull  = 2
 };
 
 enum XStatRespFlags {
@@ -230,8 +262,19 @@ enum XOpenRequestOption {
    kXR_open_wrto=32768
 };
 
+// Options in ClientOpenRequest::optiont. With kXR_ordata the server reads
+// rdlen bytes at offset rdoffs once the file is open and returns them with the
+// open response (see ServerResponseOpen_Read). Adding kXR_orclose asks that
+// the file then be closed, saving the close request as well.
+//
+enum XOpenRequestOptionT {
+   kXR_ordata   = 0x01,
+   kXR_orclose  = 0x02
+};
+
 enum XProtocolRequestFlags {
-   kXR_secreqs  = 1      // Return security requirements
+   kXR_secreqs  = 1,     // Return security requirements
+   kXR_wantcmp  = 2      // Client accepts compressed read responses
 };
 
 enum XQueryType {
@@ -467,10 +510,21 @@ struct ClientOpenRequest {
    kXR_unt16 requestid;
    kXR_unt16 mode;
    kXR_unt16 options;
-   kXR_char  reserved[12];
+   kXR_char  optiont;
+   kXR_char  reserved[3];
+   kXR_int32 rdlen;     // bytes to read with kXR_ordata
+   kXR_unt32 rdoffs;    // offset of that read (first 4GB only)
    kXR_int32  dlen;
 };
 
+struct ClientPgReadRequest {
+   kXR_char  streamid[2];
+   kXR_unt16 requestid;
+   kXR_char  fhandle[4];
+   kXR_int64 offset;
+   kXR_int32 rlen;
+   kXR_int32 dlen;
+};
 struct ClientPingRequest {
    kXR_char  streamid[2];
    kXR_unt16 requestid;
@@ -631,6 +685,7 @@ typedef union {
    struct ClientMkdirRequest mkdir;
    struct ClientMvRequest mv;
    struct ClientOpenRequest open;
+   struct ClientPgReadRequest pgread;
    struct ClientPingRequest ping;
    struct ClientPrepareRequest prepare;
    struct ClientProtocolRequest protocol;
@@ -714,6 +769,21 @@ struct ServerResponseBody_Open {
    kXR_char cptype[4]; // kXR_retstat is specified
 }; // info will follow if kXR_retstat is specified
 
+// A server that honours kXR_ordata places this after the full (12 byte)
+// ServerResponseBody_Open, followed by rdlen bytes of data and then any
+// kXR_retstat information. Its first byte is never an ASCII digit so that it
+// can be told apart from the stat information sent by a server that ignored
+// the option. Without it the client must read the data itself. This is also
+// the case when the server could not do the read; the file is then left open.
+//
+#define kXR_orclosed 0x01
+
+struct ServerResponseOpen_Read {
+   kXR_char  flags;     // kXR_orclosed if the file was closed after the read
+   kXR_char  reserved[3];
+   kXR_int32 rdlen;     // bytes of data that follow
+};
+
 // The following information is returned in the response body when kXR_secreqs
 // is set in ClientProtocolRequest::flags. Note that the size of secvec is
 // defined by secvsz and will not be present when secvsz == 0.
@@ -764,6 +834,16 @@ struct ServerResponseBody_Protocol {
 #define kXR_ShortProtRespLen sizeof(ServerResponseBody_Protocol)-\
                              sizeof(ServerResponseReqs_Protocol)
 
+// Once kXR_cmpRead has been negotiated the body of every non-empty kXR_read and
+// kXR_readv response (kXR_ok or kXR_oksofar) starts with the header below. When
+// clen is zero the rlen bytes of the response follow as is. Otherwise clen
+// bytes follow that inflate (zlib format) to the rlen bytes of the response.
+//
+struct ServerResponseCmp_Read {
+   kXR_int32 rlen;
+   kXR_int32 clen;
+};
+
 struct ServerResponseBody_Login {
    kXR_char  sessid[16];
    kXR_char  sec[4096]; // Should be sufficient for every use
@@ -115,6 +115,9 @@ enum CmsReqCode            // Request Codes
      kYR_update  = 25,
      kYR_usage   = 26,
      kYR_xauth   = 27,
+     kYR_statev  = 28,
+     kYR_havev   = 29,
+     kYR_nsmap   = 30,
      kYR_MaxReq            // Count of request numbers (highest + 1)
 };
 
@@ -229,12 +232,34 @@ struct CmsGoneRequest
 // Request: have <path>
 // Respond: n/a
 //
+// A Missing modifier is only sent by managers, in response to a state request
+// carrying kYR_negok, and says that nothing beneath it has the file.
+//
 struct CmsHaveRequest
 {      CmsRRHdr      Hdr;
-       enum          {Online = 1, Pending = 2};  // Modifiers
+       enum          {Online = 1, Pending = 2, Missing = 3};  // Modifiers
 //     kXR_string    Path;
 };
 
+/******************************************************************************/
+/*                         h a v e v   R e q u e s t                          */
+/******************************************************************************/
+  
+// Request: havev <bitmap>
+// Respond: n/a
+//
+// Reply to a statev request; streamid is the batch id of the statev request.
+// The bitmap holds two bits per path, in request order and starting with the
+// low order bits of the first byte, with the value being one of the
+// CmsHaveRequest modifiers or zero when the path was not found (yet). It is
+// always sent with the kYR_raw modifier and only when some path was found or,
+// for kYR_negok batches, is known to be missing.
+//
+struct CmsHaveVRequest
+{      CmsRRHdr      Hdr;
+//     kXR_char      Bitmap[(n+3)/4];
+};
+
 /******************************************************************************/
 /*                        l o c a t e   R e q u e s t                         */
 /******************************************************************************/
@@ -248,6 +273,7 @@ enum  {kYR_refresh = 0x0001,
        kYR_retname = 0x0002,
        kYR_retuniq = 0x0004,
        kYR_asap    = 0x0080,
+       kYR_pushok  = 0x0100,  // Redirector accepts a waitresp + async reply
        kYR_retipv4 = 0x0000,  // Client is only IPv4
        kYR_retipv46= 0x1000,  // Client is IPv4 IPv6
        kYR_retipv6 = 0x2000,  // Client is only IPv6
@@ -299,6 +325,8 @@ struct CmsLoginData
                   kYR_suspend =   0x00000100,   // Suspended login
                   kYR_nostage =   0x00000200,   // Staging unavailable
                   kYR_trying  =   0x00000400,   // Extensive login retries
+                  kYR_batchq  =   0x00000800,   // Supports statev/havev
+                  kYR_nsmapok =   0x00001000,   // Accepts nsmap (managers)
                   kYR_debug   =   0x80000000,
                   kYR_share   =   0x7f000000,   // Mask to isolate share
                   kYR_shift   =   24,           // Share shift position
@@ -374,6 +402,35 @@ struct CmsMvRequest {
 //     kXR_string    New_Path;
 };
 
+/******************************************************************************/
+/*                         n s m a p   R e q u e s t                          */
+/******************************************************************************/
+  
+// Request: nsmap <life> <size> <offset> <hashes> <bits>
+// Respond: n/a
+//
+// A data server's namespace map: a bloom filter of the files it has, sent to
+// managers that indicated kYR_nsmapok at login. It is always sent with the
+// kYR_raw modifier and, as a map may be large, in segments of at most maxSeg
+// bytes in increasing offset order. The streamid is the map generation and
+// is the same for all segments of a map. The map takes effect once the last
+// segment arrives and is valid for Life seconds. The bit for path probe i
+// (0 <= i < Hashes) is (h1 + i*h2) mod (Size*8) where h1 and h2 are the low
+// and high order 32 bits of the 64-bit FNV-1a hash of the path, with repeated
+// and trailing slashes ignored and h2 forced to be odd. Bit n is held in byte
+// n/8 as the value 1 << (n%8). Size is always a power of two.
+//
+struct CmsNSMapRequest
+{      CmsRRHdr      Hdr;
+       kXR_unt32     Life;     // Seconds the map is valid
+       kXR_unt32     Size;     // Total bytes in the map
+       kXR_unt32     Offset;   // Offset of Bits in the map
+       kXR_unt32     Hashes;   // Number of probes per path
+//     kXR_char      Bits[Hdr.datalen-16];
+
+enum  {maxSeg = 32768};
+};
+
 /******************************************************************************/
 /*                          p i n g   R e q u e s t                           */
 /******************************************************************************/
@@ -516,7 +573,8 @@ enum  {kYR_refresh = 0x00000001,
        kYR_aNone   = 0x00400000,  // Affinity: none
        kYR_aSpec   = 0x00700000,  // Mask to test if any affinity specified
        kYR_aPack   = 0x00300000,  // Mask to test if the affinity packs choice
-       kYR_aWait   = 0x00200000   // Mask to test if the affinity must wait
+       kYR_aWait   = 0x00200000,  // Mask to test if the affinity must wait
+       kYR_pushok  = 0x00800000   // Redirector accepts a waitresp + async reply
       };
 //     kXR_string    Path;
 //     kXR_string    Opaque; // Optional
@@ -547,10 +605,31 @@ struct CmsStateRequest
 
 enum  {kYR_refresh = 0x01,   // Modifier
        kYR_noresp  = 0x02,
+       kYR_negok   = 0x04,   // Requestor accepts a have Missing response
        kYR_metaman = 0x08
       };
 };
   
+/******************************************************************************/
+/*                        s t a t e v   R e q u e s t                         */
+/******************************************************************************/
+  
+// Request: statev <path> [<path> [...]]
+// Respond: havev <bitmap>
+//
+// A batched state request. It is always sent with the kYR_raw modifier and
+// the paths follow one another with each one null terminated. The streamid is
+// the batch id and the only other modifiers allowed are kYR_refresh and
+// kYR_negok. Paths that cannot be resolved immediately are handled as
+// individual state requests.
+//
+struct CmsStateVRequest
+{      CmsRRHdr      Hdr;
+//     kXR_string    Path[n];
+
+enum  {maxPaths = 1024};
+};
+  
 /******************************************************************************/
 /*                        s t a t f s   R e q u e s t                         */
 /******************************************************************************/
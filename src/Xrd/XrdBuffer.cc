@@ -25,13 +25,16 @@
 /* The copyright holder's institutional names and contributor's names may not */
 /* be used to endorse or promote products derived from this software without  */
 /* specific prior written permission of the institution or contributor.       */
-/******************************************************************************/
 
+#include <fcntl.h>
 #include <time.h>
 #include <unistd.h>
 #if !defined(__APPLE__) && !defined(__FreeBSD__)
 #include <malloc.h>
 #endif
+#ifdef __linux__
+#include <sched.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
@@ -66,6 +69,7 @@ const char *XrdBuffManager::TraceID = "BuffManager";
 namespace
 {
 static const int minBuffSz = 1 << XRD_BUSHIFT;
+static const int maxNumaNd = 64;
 }
 
 namespace XrdGlobal
@@ -74,6 +78,36 @@ XrdBuffXL xlBuff;
 }
 
 using namespace XrdGlobal;
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+// A per-thread magazine of free buffers. It is only used by its owning thread
+// except when the reshaper trims it or the thread exits, so the mutex is
+// almost never contended. Buffers in a magazine always belong to its node.
+//
+class XrdBuffMag
+{
+public:
+
+XrdSysMutex     mMutex;
+XrdBuffMag     *next;
+XrdBuffMag     *prev;
+XrdBuffManager *bMgr;
+long long       numhit;
+int             node;
+int             numreq[XRD_BUCKETS];
+int             numbuf[XRD_BUCKETS];
+XrdBuffer      *slot[XRD_BUCKETS][XRD_MAGSLOTS];
+
+                XrdBuffMag(XrdBuffManager *bmP, int nd)
+                          : next(0), prev(0), bMgr(bmP), numhit(0), node(nd)
+                          {memset(numreq, 0, sizeof(numreq));
+                           memset(numbuf, 0, sizeof(numbuf));
+                          }
+               ~XrdBuffMag() {}
+};
  
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
@@ -103,7 +137,19 @@ XrdBuffManager::XrdBuffManager(XrdSysError *lP, XrdOucTrace *tP, int minrst) :
 #endif
    rsinprog = 0;
    minrsw   = minrst;
-   memset(static_cast<void *>(bucket), 0, sizeof(bucket));
+   magList  = 0;
+   useTLS   = false;
+   memset(magCap, 0, sizeof(magCap));
+
+// Determine the numa topology. We always have at least one node pool and
+// until NUMA pools are enabled we only use the first one.
+//
+   cpuNode  = 0;
+   numCPU   = 0;
+   maxNodes = 1;
+   MapNodes();
+   nodePool = new NodePool[maxNodes];
+   numNodes = 1;
 }
 
 /******************************************************************************/
@@ -114,12 +160,13 @@ XrdBuffManager::~XrdBuffManager()
 {
    XrdBuffer *bP;
 
+   for (int n = 0; n < maxNodes; n++)
    for (int i = 0; i < XRD_BUCKETS; i++)
-       {while((bP = bucket[i].bnext))
-             {bucket[i].bnext = bP->next;
+       {while((bP = nodePool[n].bucket[i].bnext))
+             {nodePool[n].bucket[i].bnext = bP->next;
               delete bP;
              }
-        bucket[i].numbuf = 0;
+        nodePool[n].bucket[i].numbuf = 0;
        }
 }
 
@@ -146,8 +193,10 @@ void XrdBuffManager::Init()
 XrdBuffer *XrdBuffManager::Obtain(int sz)
 {
    XrdBuffer *bp;
+   XrdBuffMag *mP;
+   NodePool *pP;
    char *memp;
-   int mk, pk, bindex;
+   int mk, pk, bindex, node = 0;
 
 // Make sure the request is within our limits
 //
@@ -162,14 +211,31 @@ XrdBuffer *XrdBuffManager::Obtain(int sz)
    if (mk < sz) {bindex++; mk = mk << 1;}
    if (bindex >= slots) return 0;    // Should never happen!
 
-// Obtain a lock on the bucket array and try to give away an existing buffer
+// Try this thread's magazine first. The request is counted there as well.
 //
-    Reshaper.Lock();
-    totreq++;
-    bucket[bindex].numreq++;
-    if ((bp = bucket[bindex].bnext))
-       {bucket[bindex].bnext = bp->next; bucket[bindex].numbuf--;}
-    Reshaper.UnLock();
+   if (useTLS)
+      {mP = getMag();
+       mP->mMutex.Lock();
+       mP->numreq[bindex]++;
+       if (mP->numbuf[bindex])
+          {bp = mP->slot[bindex][--mP->numbuf[bindex]];
+           mP->numhit++;
+           mP->mMutex.UnLock();
+           return bp;
+          }
+       mP->mMutex.UnLock();
+       node = mP->node;
+      }
+
+// Obtain a lock on the node's pool and try to give away an existing buffer
+//
+    pP = &nodePool[node];
+    pP->pMutex.Lock();
+    pP->nodereq++;
+    if (!useTLS) pP->bucket[bindex].numreq++;
+    if ((bp = pP->bucket[bindex].bnext))
+       {pP->bucket[bindex].bnext = bp->next; pP->bucket[bindex].numbuf--;}
+    pP->pMutex.UnLock();
 
 // Check if we really allocated a buffer
 //
@@ -180,14 +246,20 @@ XrdBuffer *XrdBuffManager::Obtain(int sz)
    pk = (mk < pagsz ? mk : pagsz);
    if (!(memp = static_cast<char *>(memalign(pk, mk)))) return 0;
 
+// With NUMA pools, touch every page now so that the memory is placed on the
+// node of the requesting thread (first touch policy).
+//
+   if (numNodes > 1) for (int i = 0; i < mk; i += pagsz) memp[i] = 0;
+
 // Wrap the memory with a buffer object
 //
-   if (!(bp = new XrdBuffer(memp, mk, bindex))) {free(memp); return 0;}
+   if (!(bp = new XrdBuffer(memp, mk, bindex, node))) {free(memp); return 0;}
 
 // Update statistics
 //
     Reshaper.Lock();
     totbuf++;
+    pP->nodebuf++; pP->nodealo += mk;
     if ((totalo += mk) > maxalo && !rsinprog)
        {rsinprog = 1; Reshaper.Signal();}
     Reshaper.UnLock();
@@ -226,19 +298,38 @@ int XrdBuffManager::Recalc(int sz)
   
 void XrdBuffManager::Release(XrdBuffer *bp)
 {
+   XrdBuffMag *mP;
+   NodePool *pP;
    int bindex = bp->bindex;
 
 // Check if we should release this via the big buffer object
 //
    if (bindex >= slots) {xlBuff.Release(bp); return;}
 
-// Obtain a lock on the bucket array and reclaim the buffer
+// Keep the buffer in this thread's magazine if it has room and the buffer
+// belongs to the thread's node. Otherwise, it goes back to its node pool.
 //
-    Reshaper.Lock();
-    bp->next = bucket[bp->bindex].bnext;
-    bucket[bp->bindex].bnext = bp;
-    bucket[bindex].numbuf++;
-    Reshaper.UnLock();
+   if (useTLS && magCap[bindex])
+      {mP = getMag();
+       if (bp->bnode == mP->node)
+          {mP->mMutex.Lock();
+           if (mP->numbuf[bindex] < magCap[bindex])
+              {mP->slot[bindex][mP->numbuf[bindex]++] = bp;
+               mP->mMutex.UnLock();
+               return;
+              }
+           mP->mMutex.UnLock();
+          }
+      }
+
+// Obtain a lock on the node pool and reclaim the buffer
+//
+    pP = &nodePool[bp->bnode];
+    pP->pMutex.Lock();
+    bp->next = pP->bucket[bindex].bnext;
+    pP->bucket[bindex].bnext = bp;
+    pP->bucket[bindex].numbuf++;
+    pP->pMutex.UnLock();
 }
  
 /******************************************************************************/
@@ -247,11 +338,14 @@ void XrdBuffManager::Release(XrdBuffer *bp)
   
 void XrdBuffManager::Reshape()
 {
-int i, bufprof[XRD_BUCKETS], numfreed;
+int i, n, bufprof[maxNumaNd][XRD_BUCKETS], nodereq[maxNumaNd][XRD_BUCKETS];
+int numfreed;
 time_t delta, lastshape = time(0);
 long long memslot, memhave, memtarget = (long long)(.80*(float)maxalo);
+long long memfreed;
 XrdSysTimer Timer;
 float requests, buffers;
+XrdBuffMag *mP;
 XrdBuffer *bp;
 
 // This is an endless loop to periodically reshape the buffer pool
@@ -265,34 +359,77 @@ while(1)
           Timer.Wait((minrsw-delta)*1000);
           Reshaper.Lock();
          }
+      memhave = totalo;
+      buffers = (float)totbuf;
+      Reshaper.UnLock();
 
-      // We have the lock so compute the request profile
+      // Collect the request profile from every node pool and every magazine
+      //
+      totreq = 0;
+      for (n = 0; n < maxNodes; n++)
+          {nodePool[n].pMutex.Lock();
+           for (i = 0; i < slots; i++)
+               {nodereq[n][i] = nodePool[n].bucket[i].numreq;
+                nodePool[n].bucket[i].numreq = 0;
+                totreq += nodereq[n][i];
+               }
+           nodePool[n].pMutex.UnLock();
+          }
+      magMutex.Lock();
+      for (mP = magList; mP; mP = mP->next)
+          {mP->mMutex.Lock();
+           for (i = 0; i < slots; i++)
+               {nodereq[mP->node][i] += mP->numreq[i];
+                totreq += mP->numreq[i];
+                mP->numreq[i] = 0;
+               }
+           mP->mMutex.UnLock();
+          }
+      magMutex.UnLock();
+
+      // Compute the request profile for each node
       //
       if (totreq > slots)
          {requests = (float)totreq;
-          buffers  = (float)totbuf;
+          for (n = 0; n < maxNodes; n++)
           for (i = 0; i < slots; i++)
-              {bufprof[i] = (int)(buffers*(((float)bucket[i].numreq)/requests));
-               bucket[i].numreq = 0;
-              }
-          totreq = 0; memhave = totalo;
+              bufprof[n][i] = (int)(buffers*(((float)nodereq[n][i])/requests));
          } else memhave = 0;
-      Reshaper.UnLock();
+      totreq = 0;
+
+      // If we need to trim, return all magazine buffers to their node pools.
+      // They are refilled as needed so this only costs us a few lookups.
+      //
+      if (memhave > memtarget)
+         {magMutex.Lock();
+          for (mP = magList; mP; mP = mP->next) Flush(mP);
+          magMutex.UnLock();
+         }
 
-      // Reshape the buffer pool to agree with the request profile
+      // Reshape each node pool to agree with the request profile
       //
       memslot = maxsz; numfreed = 0;
       for (i = slots-1; i >= 0 && memhave > memtarget; i--)
-          {Reshaper.Lock();
-           while(bucket[i].numbuf > bufprof[i])
-                if ((bp = bucket[i].bnext))
-                   {bucket[i].bnext = bp->next;
-                    delete bp;
-                    bucket[i].numbuf--; numfreed++;
-                    memhave -= memslot; totalo  -= memslot;
-                    totbuf--;
-                   } else {bucket[i].numbuf = 0; break;}
-           Reshaper.UnLock();
+          {for (n = 0; n < maxNodes; n++)
+               {NodePool *pP = &nodePool[n];
+                int nfree = 0;
+                pP->pMutex.Lock();
+                while(pP->bucket[i].numbuf > bufprof[n][i])
+                     if ((bp = pP->bucket[i].bnext))
+                        {pP->bucket[i].bnext = bp->next;
+                         delete bp;
+                         pP->bucket[i].numbuf--; nfree++;
+                        } else {pP->bucket[i].numbuf = 0; break;}
+                pP->pMutex.UnLock();
+                if (nfree)
+                   {memfreed = memslot*nfree;
+                    Reshaper.Lock();
+                    totalo -= memfreed;  totbuf -= nfree;
+                    pP->nodealo -= memfreed; pP->nodebuf -= nfree;
+                    Reshaper.UnLock();
+                    memhave -= memfreed; numfreed += nfree;
+                   }
+               }
            memslot = memslot>>1;
           }
 
@@ -321,6 +458,47 @@ void XrdBuffManager::Set(int maxmem, int minw)
    if (minw   > 0) minrsw = minw;
    Reshaper.UnLock();
 }
+
+/******************************************************************************/
+/*                              S e t C a c h e                               */
+/******************************************************************************/
+
+void XrdBuffManager::SetCache(int tcache, bool numa)
+{
+   static bool isSet = false;
+   int rc;
+
+// This may only be done once, before any thread uses the buffer pool
+//
+   if (isSet) return;
+   isSet = true;
+
+// Compute the magazine capacity of each bucket. Small buffers get the full
+// capacity, larger ones get proportionally less and the largest get none.
+//
+   if (tcache > XRD_MAGSLOTS) tcache = XRD_MAGSLOTS;
+   if (tcache < 0) tcache = 0;
+   for (int i = 0; i < XRD_BUCKETS; i++)
+       magCap[i] = (i <= 6 ? tcache : tcache >> (i-6));
+
+// Establish the number of node pools we will use
+//
+   if (numa && maxNodes < 2)
+      XrdLog->Say("Config warning: only one numa node found; "
+                  "node pools not enabled.");
+   numNodes = (numa ? maxNodes : 1);
+
+// Create the key for the per-thread magazine if we need one
+//
+   if (tcache || numNodes > 1)
+      {if ((rc = pthread_key_create(&magKey, magFree)))
+          {XrdLog->Emsg("BuffManager", rc, "create buffer cache key");
+           numNodes = 1;
+           return;
+          }
+       useTLS = true;
+      }
+}
  
 /******************************************************************************/
 /*                                 S t a t s                                  */
@@ -329,19 +507,207 @@ void XrdBuffManager::Set(int maxmem, int minw)
 int XrdBuffManager::Stats(char *buff, int blen, int do_sync)
 {
     static char statfmt[] = "<stats id=\"buff\"><reqs>%d</reqs>"
-                "<mem>%lld</mem><buffs>%d</buffs><adj>%d</adj>%s</stats>";
+                "<mem>%lld</mem><buffs>%d</buffs><adj>%d</adj>%s";
+    static char tcfmt[]   = "<tc><num>%d</num><hits>%lld</hits>"
+                            "<buffs>%d</buffs></tc>";
+    static char nodefmt[] = "<node id=\"%d\"><reqs>%d</reqs><mem>%lld</mem>"
+                            "<buffs>%d</buffs><free>%d</free></node>";
+    static char statend[] = "</stats>";
+    XrdBuffMag *mP;
     char xlStats[1024];
-    int nlen;
+    long long numhit = 0;
+    int i, n, nlen, nreq = 0, numfree, nummag = 0, magbuf = 0;
 
 // If only size wanted, return it
 //
-   if (!buff) return sizeof(statfmt) + 16*4 + xlBuff.Stats(0,0);
+   if (!buff) return sizeof(statfmt) + 16*4 + xlBuff.Stats(0,0)
+                   + sizeof(tcfmt) + 16*3 + sizeof(statend)
+                   + (numNodes > 1 ? 16 + numNodes*(sizeof(nodefmt)+16*5) : 0);
+
+// Collect the magazine information first as it is not covered by do_sync
+//
+   if (useTLS)
+      {magMutex.Lock();
+       for (mP = magList; mP; mP = mP->next)
+           {nummag++;
+            numhit += mP->numhit;
+            for (i = 0; i < XRD_BUCKETS; i++)
+                {nreq += mP->numreq[i]; magbuf += mP->numbuf[i];}
+           }
+       magMutex.UnLock();
+      }
+
+// Count the requests made to the node pools
+//
+   for (n = 0; n < numNodes; n++)
+       {if (do_sync) nodePool[n].pMutex.Lock();
+        for (i = 0; i < XRD_BUCKETS; i++) nreq += nodePool[n].bucket[i].numreq;
+        if (do_sync) nodePool[n].pMutex.UnLock();
+       }
 
 // Return formatted stats
 //
    if (do_sync) Reshaper.Lock();
    xlBuff.Stats(xlStats, sizeof(xlStats), do_sync);
-   nlen = snprintf(buff,blen,statfmt,totreq,totalo,totbuf,totadj,xlStats);
+   nlen = snprintf(buff,blen,statfmt,nreq,totalo,totbuf,totadj,xlStats);
    if (do_sync) Reshaper.UnLock();
+
+// Add the thread cache information
+//
+   if (useTLS && nlen < blen)
+      nlen += snprintf(buff+nlen, blen-nlen, tcfmt, nummag, numhit, magbuf);
+
+// Add the information for each node pool
+//
+   if (numNodes > 1)
+      {if (nlen < blen) nlen += snprintf(buff+nlen, blen-nlen, "<numa>");
+       for (n = 0; n < numNodes && nlen < blen; n++)
+           {NodePool *pP = &nodePool[n];
+            if (do_sync) pP->pMutex.Lock();
+            numfree = 0;
+            for (i = 0; i < XRD_BUCKETS; i++) numfree += pP->bucket[i].numbuf;
+            if (do_sync) pP->pMutex.UnLock();
+            nlen += snprintf(buff+nlen, blen-nlen, nodefmt, n, pP->nodereq,
+                             pP->nodealo, pP->nodebuf, numfree);
+           }
+       if (nlen < blen) nlen += snprintf(buff+nlen, blen-nlen, "</numa>");
+      }
+
+// All done
+//
+   if (nlen < blen) nlen += snprintf(buff+nlen, blen-nlen, "%s", statend);
    return nlen;
 }
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                 F l u s h                                  */
+/******************************************************************************/
+
+void XrdBuffManager::Flush(XrdBuffMag *mP)
+{
+   NodePool *pP = &nodePool[mP->node];
+   XrdBuffer *bp;
+
+// Return every buffer in the magazine to its node pool
+//
+   mP->mMutex.Lock();
+   pP->pMutex.Lock();
+   for (int i = 0; i < XRD_BUCKETS; i++)
+       {while(mP->numbuf[i])
+             {bp = mP->slot[i][--mP->numbuf[i]];
+              bp->next = pP->bucket[i].bnext;
+              pP->bucket[i].bnext = bp;
+              pP->bucket[i].numbuf++;
+             }
+        pP->bucket[i].numreq += mP->numreq[i];
+        mP->numreq[i] = 0;
+       }
+   pP->pMutex.UnLock();
+   mP->mMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                                g e t M a g                                 */
+/******************************************************************************/
+
+XrdBuffMag *XrdBuffManager::getMag()
+{
+   XrdBuffMag *mP;
+
+// Return the existing magazine for this thread, if any
+//
+   if ((mP = static_cast<XrdBuffMag *>(pthread_getspecific(magKey)))) return mP;
+
+// Create a new magazine for the node this thread is running on
+//
+   mP = new XrdBuffMag(this, getNode());
+   pthread_setspecific(magKey, mP);
+
+// Add the magazine to our list so that the reshaper can find it
+//
+   magMutex.Lock();
+   if ((mP->next = magList)) magList->prev = mP;
+   magList = mP;
+   magMutex.UnLock();
+   return mP;
+}
+
+/******************************************************************************/
+/*                               g e t N o d e                                */
+/******************************************************************************/
+
+int XrdBuffManager::getNode()
+{
+#ifdef __linux__
+   int cpu;
+
+   if (numNodes > 1 && (cpu = sched_getcpu()) >= 0 && cpu < numCPU)
+      return cpuNode[cpu];
+#endif
+   return 0;
+}
+
+/******************************************************************************/
+/*                               M a p N o d e s                              */
+/******************************************************************************/
+
+void XrdBuffManager::MapNodes()
+{
+#ifdef __linux__
+   char path[80], cpus[4096], *cP, *eP;
+   int fd, rlen, cpu1, cpu2, node;
+
+// Get the number of cpus that we may encounter
+//
+   if ((numCPU = (int)sysconf(_SC_NPROCESSORS_CONF)) <= 0) {numCPU = 0; return;}
+   cpuNode = new short[numCPU];
+   memset(cpuNode, 0, sizeof(short)*numCPU);
+
+// Read the cpu list of each node (e.g. "0-7,16-23")
+//
+   for (node = 0; node < maxNumaNd; node++)
+       {snprintf(path, sizeof(path),
+                 "/sys/devices/system/node/node%d/cpulist", node);
+        if ((fd = open(path, O_RDONLY)) < 0) break;
+        rlen = read(fd, cpus, sizeof(cpus)-1);
+        close(fd);
+        if (rlen <= 0) break;
+        cpus[rlen] = 0;
+        cP = cpus;
+        while(*cP >= '0' && *cP <= '9')
+             {cpu1 = cpu2 = strtol(cP, &eP, 10);
+              if (*eP == '-') cpu2 = strtol(eP+1, &eP, 10);
+              for (int i = cpu1; i <= cpu2 && i < numCPU; i++) cpuNode[i] = node;
+              if (*eP != ',') break;
+              cP = eP+1;
+             }
+       }
+   if (node > 1) maxNodes = node;
+#endif
+}
+
+/******************************************************************************/
+/*                               m a g F r e e                                */
+/******************************************************************************/
+
+void XrdBuffManager::magFree(void *magP)
+{
+   XrdBuffMag *mP = static_cast<XrdBuffMag *>(magP);
+   XrdBuffManager *bmP = mP->bMgr;
+
+// Remove the magazine from the list of magazines
+//
+   bmP->magMutex.Lock();
+   if (mP->prev) mP->prev->next = mP->next;
+      else bmP->magList = mP->next;
+   if (mP->next) mP->next->prev = mP->prev;
+   bmP->magMutex.UnLock();
+
+// Return the buffers to the node pool and delete the magazine
+//
+   bmP->Flush(mP);
+   delete mP;
+}
@@ -30,6 +30,7 @@
 /******************************************************************************/
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include "XrdSys/XrdSysPthread.hh"
@@ -45,8 +46,10 @@ public:
 char *   buff;     // -> buffer
 int      bsize;    // size of this buffer
 
-         XrdBuffer(char *bp, int sz, int ix)
-                      {buff = bp; bsize = sz; bindex = ix; next = 0;}
+         XrdBuffer(char *bp, int sz, int ix, int nd=0)
+                      {buff = bp; bsize = sz; bindex = ix; bnode = nd;
+                       next = 0;
+                      }
 
         ~XrdBuffer() {if (buff) free(buff);}
 
@@ -55,6 +58,7 @@ int      bsize;    // size of this buffer
 private:
 
 int        bindex;
+int        bnode;    // NUMA node pool that owns this buffer
 XrdBuffer *next;
 static int pagesz;
 };
@@ -65,9 +69,16 @@ static int pagesz;
 
 #define XRD_BUCKETS 12
 #define XRD_BUSHIFT 10
+#define XRD_MAGSLOTS 16
 
 // There should be only one instance of this class per buffer pool.
 //
+// Buffers are kept in one pool per NUMA node (only node 0 unless NUMA pools
+// are enabled). Optionally, each thread also has a small magazine of free
+// buffers in front of its node pool so that most Obtain()/Release() calls
+// need no shared lock. Reshape() trims magazines as well as the node pools.
+//
+class XrdBuffMag;
 class XrdOucTrace;
 class XrdSysError;
   
@@ -89,6 +100,12 @@ void        Reshape();
 
 void        Set(int maxmem=-1, int minw=-1);
 
+// SetCache() must be called before Init(). The tcache value is the maximum
+// number of small buffers each thread may cache per bucket (0 disables).
+// When numa is true, buffers are obtained from the pool of the caller's node.
+//
+void        SetCache(int tcache, bool numa);
+
 int         Stats(char *buff, int blen, int do_sync=0);
 
             XrdBuffManager(XrdSysError *lP, XrdOucTrace *tP, int minrst=20*60);
@@ -105,10 +122,43 @@ const int  shift;
 const int  pagsz;
 const int  maxsz;
 
-struct {XrdBuffer *bnext;
-        int         numbuf;
-        int         numreq;
-       } bucket[XRD_BUCKETS];          // 1K to 1<<(szshift+slots-1)M buffers
+friend class XrdBuffMag;
+
+struct BuckVec
+      {XrdBuffer *bnext;
+       int        numbuf;
+       int        numreq;
+      };
+
+struct NodePool
+      {XrdSysMutex pMutex;
+       BuckVec     bucket[XRD_BUCKETS]; // 1K to 1<<(szshift+slots-1)M buffers
+       long long   nodealo;
+       int         nodebuf;
+       int         nodereq;
+       char        pad[64];             // Keep pools in separate cache lines
+                   NodePool() : nodealo(0), nodebuf(0), nodereq(0)
+                              {memset(bucket, 0, sizeof(bucket));}
+                  ~NodePool() {}
+      };
+
+NodePool   *nodePool;       // One per NUMA node
+short      *cpuNode;        // CPU number to node number map
+int         numCPU;
+int         numNodes;       // Number of node pools in use
+int         maxNodes;       // Number of nodes in the system
+
+XrdBuffMag   *magList;      // All thread magazines
+XrdSysMutex   magMutex;     // Protects magList
+pthread_key_t magKey;
+int           magCap[XRD_BUCKETS];
+bool          useTLS;
+
+XrdBuffMag *getMag();
+int         getNode();
+void        Flush(XrdBuffMag *mP);
+void        MapNodes();
+static void magFree(void *mP);
 
 int       totreq;
 int       totbuf;
@@ -163,13 +163,20 @@ XrdConfig::XrdConfig() : Log(&Logger, "Xrd"), Trace(&Log), Sched(&Log, &Trace),
    Net_Opts = XRDNET_KEEPALIVE;
    Wan_Blen = 1024*1024; // Default window size 1M
    Wan_Opts = XRDNET_KEEPALIVE;
+   Net_Lsnr = 1;
+   Net_TFO  = 0;
    repDest[0] = 0;
    repDest[1] = 0;
    repInt     = 600;
    repOpts    = 0;
    ppNet      = 0;
+   ppEdge     = 0;
+   ppInl      = 0;
+   ppPoll     = 0;
    NetTCPlep  = -1;
    NetADM     = 0;
+   NetRPT     = 0;
+   NetRPTn    = 0;
    coreV      = 1;
    memset(NetTCP, 0, sizeof(NetTCP));
 
@@ -198,7 +205,8 @@ XrdConfig::XrdConfig() : Log(&Logger, "Xrd"), Trace(&Log), Sched(&Log, &Trace),
    ProtInfo.argc     = 0;
    ProtInfo.argv     = 0;
 
-   XrdNetAddr::SetCache(3*60*60); // Cache address resolutions for 3 hours
+   XrdNetAddr::SetCache(3*60*60, 60); // Cache address resolutions for 3 hours
+                                      // and failed ones for a minute
 }
   
 /******************************************************************************/
@@ -438,6 +446,13 @@ int XrdConfig::Configure(int argc, char **argv)
       {LogInfo.xrdEnv = &theEnv;
        LogInfo.iName  = myInsName;
        LogInfo.cfgFn  = ConfigFN;
+       const char *aqVal = getenv("XRDLOGASYNC");
+       if (aqVal)
+          {long long aqsz;
+           if (XrdOuca2x::a2sz(Log, "XRDLOGASYNC", aqVal, &aqsz,
+                               0, 16*1024*1024)) _exit(16);
+           LogInfo.asyncQ = static_cast<int>(aqsz);
+          }
        if (!XrdOucLogging::configLog(Log, LogInfo)) _exit(16);
        Log.logger()->AddMsg(XrdBANNER);
       }
@@ -575,6 +590,7 @@ int XrdConfig::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError *eDest)
    //
    TS_Xeq("buffers",       xbuf);
    TS_Xeq("network",       xnet);
+   TS_Xeq("nettune",       xntune);
    TS_Xeq("sched",         xsched);
    TS_Xeq("trace",         xtrace);
 
@@ -956,6 +972,8 @@ int XrdConfig::Setup(char *dfltp)
 //
    XrdLink::Init(&Log, &Trace, &Sched);
    XrdPoll::Init(&Log, &Trace, &Sched);
+   XrdPoll::EdgeMode(ppEdge != 0);
+   XrdPoll::setPollers(ppPoll, ppInl != 0);
    if (!XrdLink::Setup(ProtInfo.ConnMax, ProtInfo.idleWait)
    ||  !XrdPoll::Setup(ProtInfo.ConnMax)) return 1;
 
@@ -997,6 +1015,20 @@ int XrdConfig::Setup(char *dfltp)
                                  ProtInfo.myName, Firstcp->port,
                                  ProtInfo.myInst, ProtInfo.myProg, mySitName);
 
+// Multiple listeners per port require that every socket allow port reuse
+//
+   if (Net_Lsnr > 1)
+      {Net_Opts |= XRDNET_REUSEPORT;
+       Wan_Opts |= XRDNET_REUSEPORT;
+      }
+
+// Let clients send their first request in the SYN if so wanted
+//
+   if (Net_TFO)
+      {Net_Opts |= XRDNET_FASTOPEN;
+       Wan_Opts |= XRDNET_FASTOPEN;
+      }
+
 // Allocate a WAN port number of we need to
 //
    if (PortWAN &&  (NetWAN = new XrdInet(&Log, &Trace, Police)))
@@ -1044,6 +1076,34 @@ int XrdConfig::Setup(char *dfltp)
          Firstcp = cp->Next; delete cp;
         }
 
+// Add the additional listeners for each port. The kernel distributes incomming
+// connections across all of the sockets bound to the same port. Note that a
+// socket supplied by systemd does not allow port reuse.
+//
+   if (Net_Lsnr > 1)
+      {NetRPT = new XrdInet *[(XrdProtLoad::ProtoMax+1) * (Net_Lsnr-1)];
+       for (i = 0; i <= XrdProtLoad::ProtoMax; i++)
+           {if (!NetTCP[i]) continue;
+            bool isWAN = (i == XrdProtLoad::ProtoMax);
+            for (int k = 1; k < Net_Lsnr; k++)
+                {XrdInet *netP = new XrdInet(&Log, &Trace, Police);
+                 if (isWAN) netP->setDefaults(Wan_Opts, Wan_Blen);
+                    else    netP->setDefaults(Net_Opts, Net_Blen);
+                 if (myDomain) netP->setDomain(myDomain);
+                 if (netP->Bind(NetTCP[i]->Port(), "tcp"))
+                    {char pBuff[16];
+                     snprintf(pBuff, sizeof(pBuff), "%d", NetTCP[i]->Port());
+                     Log.Say("Config warning: unable to add listeners for port ",
+                             pBuff, ".");
+                     delete netP;
+                     break;
+                    }
+                 NetRPT[NetRPTn++] = netP;
+                }
+           }
+       TRACE(NET, NetRPTn <<" additional listeners added");
+      }
+
 // Leave the env port number to be the first used port number. This may
 // or may not be the same as the default port number.
 //
@@ -1202,11 +1262,16 @@ int XrdConfig::xhpath(XrdSysError *eDest, XrdOucStream &Config)
 
 /* Function: xbuf
 
-   Purpose:  To parse the directive: buffers [maxbsz <bsz>] <memsz> [<rint>]
+   Purpose:  To parse the directive: buffers [maxbsz <bsz>] [tcache <nb>] [numa]
+                                             <memsz> [<rint>]
 
              <bsz>      maximum size of an individualbuffer. The default is 2m.
                         Specify any value 2m < bsz <= 1g; if specified, it must
                         appear before the <memsz> and <memsz> becomes optional.
+             <nb>       maximum number of small buffers each thread may cache
+                        for reuse (0 to 16). The default is 0 (no caching).
+             numa       obtain buffers from a pool local to the numa node of
+                        the requesting thread.
              <memsz>    maximum amount of memory devoted to buffers
              <rint>     minimum buffer reshape interval in seconds
 
@@ -1216,21 +1281,39 @@ int XrdConfig::xbuf(XrdSysError *eDest, XrdOucStream &Config)
 {
     static const long long minBSZ = 1024*1024*2+1;  // 2mb
     static const long long maxBSZ = 1024*1024*1024; // 1gb
-    int bint = -1;
+    int bint = -1, tcache = -1;
+    bool numa = false;
     long long blim;
     char *val;
 
     if (!(val = Config.GetWord()))
        {eDest->Emsg("Config", "buffer memory limit not specified"); return 1;}
 
-    if (!strcmp("maxbsz", val))
-       {if (!(val = Config.GetWord()))
-           {eDest->Emsg("Config", "max buffer size not specified"); return 1;}
-        if (XrdOuca2x::a2sz(*eDest,"maxbz value",val,&blim,minBSZ,maxBSZ))
-           return 1;
-        XrdGlobal::xlBuff.Init(blim);
-        if (!(val = Config.GetWord())) return 0;
-       }
+    while(1)
+         {if (!strcmp("maxbsz", val))
+             {if (!(val = Config.GetWord()))
+                 {eDest->Emsg("Config", "max buffer size not specified");
+                  return 1;
+                 }
+              if (XrdOuca2x::a2sz(*eDest,"maxbz value",val,&blim,minBSZ,maxBSZ))
+                 return 1;
+              XrdGlobal::xlBuff.Init(blim);
+             }
+          else if (!strcmp("tcache", val))
+             {if (!(val = Config.GetWord()))
+                 {eDest->Emsg("Config", "tcache value not specified");
+                  return 1;
+                 }
+              if (XrdOuca2x::a2i(*eDest,"tcache value",val,&tcache,
+                                 0,XRD_MAGSLOTS)) return 1;
+             }
+          else if (!strcmp("numa", val)) numa = true;
+          else break;
+          if (!(val = Config.GetWord()))
+             {if (tcache > 0 || numa) BuffPool.SetCache(tcache, numa);
+              return 0;
+             }
+         }
 
     if (XrdOuca2x::a2sz(*eDest,"buffer limit value",val,&blim,
                        (long long)1024*1024)) return 1;
@@ -1240,6 +1323,7 @@ int XrdConfig::xbuf(XrdSysError *eDest, XrdOucStream &Config)
           return 1;
 
     BuffPool.Set((int)blim, bint);
+    if (tcache > 0 || numa) BuffPool.SetCache(tcache, numa);
     return 0;
 }
 
@@ -1252,7 +1336,11 @@ int XrdConfig::xbuf(XrdSysError *eDest, XrdOucStream &Config)
    Purpose:  To parse directive: network [wan] [[no]keepalive] [buffsz <blen>]
                                          [kaparms parms] [cache <ct>] [[no]dnr]
                                          [routes <rtype> [use <ifn1>,<ifn2>]]
-                                         [[no]rpipa]
+                                         [[no]rpipa] [listeners <n>]
+                                         [[no]edgepoll] [coalesce <csz>]
+                                         [negcache <nt>] [dnsprefetch <n>]
+                                         [pollers {<np> | cores}] [[no]inline]
+                                         [[no]fastopen]
 
              <rtype>: split | common | local
 
@@ -1264,6 +1352,26 @@ int XrdConfig::xbuf(XrdSysError *eDest, XrdOucStream &Config)
              [no]dnr   do [not] perform a reverse DNS lookup if not needed.
              routes    specifies the network configuration (see reference)
              [no]rpipa do [not] resolve private IP addresses.
+             listeners number of sockets to listen on for each port. When
+                       more than one, each one has its own accept thread and
+                       the kernel distributes new connections (SO_REUSEPORT).
+             edgepoll  do [not] use edge triggered epoll events. This avoids
+                       re-arming the link in the poll set after each request.
+             <csz>     is the buffer size used to combine small responses sent
+                       while a request is processed into fewer writes (0 off).
+             <nt>      Seconds to cache addresses that could not be resolved.
+             dnsprefetch number of threads (1 to 64) resolving the host name
+                       of new connections in the background while the protocol
+                       handshake proceeds. The default is not to prefetch.
+             <np>      number of poller threads (1 to 64, default 3) or cores
+                       for one per online cpu.
+             inline    do [not] let poller threads process requests that
+                       cannot block themselves (run-to-completion mode). Each
+                       poller is then bound to its own cpu. Only honored for
+                       epoll and protocols that support it (i.e. xroot).
+             fastopen  do [not] accept data in the SYN of new connections
+                       (TCP Fast Open) so that clients can send the protocol
+                       handshake without waiting for the connection.
 
    Output: 0 upon success or !0 upon failure.
 */
@@ -1272,7 +1380,8 @@ int XrdConfig::xnet(XrdSysError *eDest, XrdOucStream &Config)
 {
     char *val;
     int  i, n, V_keep = -1, V_nodnr = 0, V_iswan = 0, V_blen = -1, V_ct = -1, V_assumev4;
-    int  v_rpip = -1;
+    int  v_rpip = -1, V_lsnr = -1, V_edge = -1, V_coal = -1;
+    int  V_nct = -1, V_dnsp = -1, V_poll = -1, V_inl = -1, V_tfo = -1;
     long long llp;
     struct netopts {const char *opname; int hasarg; int opval;
                            int *oploc;  const char *etxt;}
@@ -1284,8 +1393,19 @@ int XrdConfig::xnet(XrdSysError *eDest, XrdOucStream &Config)
         {"kaparms",    4, 0, &V_keep,   "option"},
         {"buffsz",     1, 0, &V_blen,   "network buffsz"},
         {"cache",      2, 0, &V_ct,     "cache time"},
+        {"coalesce",   1, 0, &V_coal,   "network coalesce"},
         {"dnr",        0, 0, &V_nodnr,  "option"},
+        {"dnsprefetch",5, 0, &V_dnsp,   "network dnsprefetch"},
+        {"edgepoll",   0, 1, &V_edge,   "option"},
+        {"noedgepoll", 0, 0, &V_edge,   "option"},
+        {"fastopen",   0, 1, &V_tfo,    "option"},
+        {"nofastopen", 0, 0, &V_tfo,    "option"},
+        {"inline",     0, 1, &V_inl,    "option"},
+        {"noinline",   0, 0, &V_inl,    "option"},
+        {"listeners",  5, 0, &V_lsnr,   "network listeners"},
+        {"negcache",   2, 0, &V_nct,    "negative cache time"},
         {"nodnr",      0, 1, &V_nodnr,  "option"},
+        {"pollers",    6, 0, &V_poll,   "network pollers"},
         {"routes",     3, 1, 0,         "routes"},
         {"rpipa",      0, 1, &v_rpip,   "rpipa"},
         {"norpipa",    0, 0, &v_rpip,   "norpipa"},
@@ -1330,6 +1450,21 @@ int XrdConfig::xnet(XrdSysError *eDest, XrdOucStream &Config)
                           ppNet = 1;
                           break;
                          }
+                      if (ntopts[i].hasarg == 6)
+                         {if (!strcmp(val, "cores"))
+                             n = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+                             else if (XrdOuca2x::a2i(*eDest,ntopts[i].etxt,val,
+                                                     &n,1,XRD_MAXPOLLERS))
+                                     return 1;
+                          *ntopts[i].oploc = (n > 0 ? n : 1);
+                          break;
+                         }
+                      if (ntopts[i].hasarg == 5)
+                         {if (XrdOuca2x::a2i(*eDest,ntopts[i].etxt,val,&n,1,64))
+                             return 1;
+                          *ntopts[i].oploc = n;
+                          break;
+                         }
                       if (ntopts[i].hasarg == 2)
                          {if (XrdOuca2x::a2tm(*eDest,ntopts[i].etxt,val,&n,0))
                              return 1;
@@ -1359,7 +1494,49 @@ int XrdConfig::xnet(XrdSysError *eDest, XrdOucStream &Config)
          Net_Opts |= (V_nodnr ? XRDNET_NORLKUP   : 0);
         }
 
-     if (V_ct >= 0) XrdNetAddr::SetCache(V_ct);
+     if (V_lsnr > 0)
+        {
+#ifndef SO_REUSEPORT
+         if (V_lsnr > 1)
+            {eDest->Say("Config warning: multiple listeners not supported on "
+                        "this platform.");
+             V_lsnr = 1;
+            }
+#endif
+         Net_Lsnr = V_lsnr;
+        }
+     if (V_tfo >= 0)
+        {
+#ifndef TCP_FASTOPEN
+         if (V_tfo) eDest->Say("Config warning: network fastopen not "
+                               "supported on this platform.");
+         V_tfo = 0;
+#endif
+         Net_TFO = V_tfo;
+        }
+     if (V_edge >= 0) ppEdge = static_cast<char>(V_edge);
+     if (V_poll > 0) ppPoll = V_poll;
+     if (V_inl >= 0)
+        {
+#ifndef __linux__
+         if (V_inl) eDest->Say("Config warning: network inline not supported "
+                               "on this platform.");
+         V_inl = 0;
+#endif
+         ppInl = static_cast<char>(V_inl);
+        }
+     if (V_coal >= 0)
+        {if (V_coal > 1024*1024)
+            {eDest->Emsg("Config", "network coalesce size may not exceed 1m");
+             return 1;
+            }
+         XrdLink::setCoalesce(V_coal);
+        }
+
+     if (V_ct >= 0 || V_nct >= 0 || V_dnsp >= 0)
+        XrdNetAddr::SetCache((V_ct   >= 0 ? V_ct   : 3*60*60),
+                             (V_nct  >= 0 ? V_nct  : 60),
+                             (V_dnsp >= 0 ? V_dnsp : 0));
      if (v_rpip >= 0) XrdInet::netIF.SetRPIPA(v_rpip != 0);
      if (V_assumev4 >= 0) XrdInet::SetAssumeV4(true);
      return 0;
@@ -1412,6 +1589,92 @@ int XrdConfig::xnkap(XrdSysError *eDest, char *val)
    return 0;
 }
   
+/******************************************************************************/
+/*                                x n t u n e                                 */
+/******************************************************************************/
+
+/* Function: xntune
+
+   Purpose:  To parse the directive: nettune {local | public} [cc <alg>]
+                                             [lowat <lsz>] [pacing <rate>]
+                                             [window <wsz>]
+
+             local     the settings apply to connections from private addresses.
+             public    the settings apply to connections from other addresses.
+             <alg>     the TCP congestion control algorithm (e.g. bbr).
+             <lsz>     is the TCP_NOTSENT_LOWAT value limiting unsent data
+                       queued in the socket, which keeps responses from
+                       waiting behind a large backlog.
+             <rate>    is the maximum pacing rate in bytes per second.
+             <wsz>     is the socket buffer size. Leave it unset to keep
+                       kernel buffer autotuning.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdConfig::xntune(XrdSysError *eDest, XrdOucStream &Config)
+{
+    XrdNetSocket::TuneParms parms;
+    long long llp;
+    char *val;
+    bool isLcl;
+
+    if (!(val = Config.GetWord()))
+       {eDest->Emsg("Config", "nettune network class not specified"); return 1;}
+         if (!strcmp(val, "local"))  isLcl = true;
+    else if (!strcmp(val, "public")) isLcl = false;
+    else {eDest->Emsg("Config", "Invalid nettune network class -", val);
+          return 1;
+         }
+
+    while((val = Config.GetWord()))
+         {     if (!strcmp(val, "cc"))
+                  {if (!(val = Config.GetWord()))
+                      {eDest->Emsg("Config", "nettune cc value not specified");
+                       return 1;
+                      }
+                   if (strlen(val) >= sizeof(parms.cc))
+                      {eDest->Emsg("Config", "nettune cc name too long -", val);
+                       return 1;
+                      }
+                   strcpy(parms.cc, val);
+                  }
+          else if (!strcmp(val, "lowat"))
+                  {if (!(val = Config.GetWord()))
+                      {eDest->Emsg("Config","nettune lowat value not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2sz(*eDest, "nettune lowat", val, &llp,
+                                       1, 0x7fffffff)) return 1;
+                   parms.lowat = static_cast<int>(llp);
+                  }
+          else if (!strcmp(val, "pacing"))
+                  {if (!(val = Config.GetWord()))
+                      {eDest->Emsg("Config","nettune pacing value not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2sz(*eDest, "nettune pacing", val, &parms.pacing,
+                                       1)) return 1;
+                  }
+          else if (!strcmp(val, "window"))
+                  {if (!(val = Config.GetWord()))
+                      {eDest->Emsg("Config","nettune window value not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2sz(*eDest, "nettune window", val, &llp,
+                                       1, 0x7fffffff)) return 1;
+                   parms.window = static_cast<int>(llp);
+                  }
+          else {eDest->Emsg("Config", "Invalid nettune option -", val);
+                return 1;
+               }
+         }
+
+    if (isLcl) XrdInet::netLcl = parms;
+       else    XrdInet::netPub = parms;
+    return 0;
+}
+
 /******************************************************************************/
 /*                                 x p o r t                                  */
 /******************************************************************************/
@@ -1667,6 +1930,7 @@ int XrdConfig::xrep(XrdSysError *eDest, XrdOucStream &Config)
 
    Purpose:  To parse directive: sched [mint <mint>] [maxt <maxt>] [avlt <at>]
                                        [idle <idle>] [stksz <qnt>] [core <cv>]
+                                       [queues <nq>]
 
              <mint>   is the minimum number of threads that we need. Once
                       this number of threads is created, it does not decrease.
@@ -1683,6 +1947,9 @@ int XrdConfig::xrep(XrdSysError *eDest, XrdOucStream &Config)
              <idle>   The time (in time spec) between checks for underused
                       threads. Those found will be terminated. Default is 780.
              <qnt>    The thread stack size in bytes or K, M, or G.
+             <nq>     The number of run queues. When greater than 1, each
+                      worker uses its own queue and idle workers steal work
+                      from other queues. The default is a single queue.
 
    Output: 0 upon success or 1 upon failure.
 */
@@ -1692,7 +1959,7 @@ int XrdConfig::xsched(XrdSysError *eDest, XrdOucStream &Config)
     char *val;
     long long lpp;
     int  i, ppp = 0;
-    int  V_mint = -1, V_maxt = -1, V_idle = -1, V_avlt = -1;
+    int  V_mint = -1, V_maxt = -1, V_idle = -1, V_avlt = -1, V_nrq = -1;
     struct schedopts {const char *opname; int minv; int *oploc;
                       const char *opmsg;} scopts[] =
        {
@@ -1701,7 +1968,8 @@ int XrdConfig::xsched(XrdSysError *eDest, XrdOucStream &Config)
         {"maxt",       1, &V_maxt, "sched maxt"},
         {"avlt",       1, &V_avlt, "sched avlt"},
         {"core",       1,       0, "sched core"},
-        {"idle",       0, &V_idle, "sched idle"}
+        {"idle",       0, &V_idle, "sched idle"},
+        {"queues",     1, &V_nrq,  "sched queues"}
        };
     int numopts = sizeof(scopts)/sizeof(struct schedopts);
 
@@ -1760,6 +2028,7 @@ int XrdConfig::xsched(XrdSysError *eDest, XrdOucStream &Config)
 // Establish scheduler options
 //
    Sched.setParms(V_mint, V_maxt, V_avlt, V_idle);
+   if (V_nrq > 1) Sched.setQueues(V_nrq);
    return 0;
 }
 
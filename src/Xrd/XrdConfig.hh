@@ -59,6 +59,8 @@ int         ConfigXeq(char *var, XrdOucStream &Config, XrdSysError *eDest=0);
 XrdProtocol_Config  ProtInfo;
 XrdInet            *NetADM;
 XrdInet            *NetTCP[XrdProtLoad::ProtoMax+1];
+XrdInet           **NetRPT;       // Added SO_REUSEPORT listeners on NetTCP ports
+int                 NetRPTn;
 
 private:
 
@@ -76,6 +78,7 @@ int   xhpath(XrdSysError *edest, XrdOucStream &Config);
 int   xbuf(XrdSysError *edest, XrdOucStream &Config);
 int   xnet(XrdSysError *edest, XrdOucStream &Config);
 int   xnkap(XrdSysError *edest, char *val);
+int   xntune(XrdSysError *edest, XrdOucStream &Config);
 int   xlog(XrdSysError *edest, XrdOucStream &Config);
 int   xport(XrdSysError *edest, XrdOucStream &Config);
 int   xprot(XrdSysError *edest, XrdOucStream &Config);
@@ -110,6 +113,8 @@ int                 Net_Blen;
 int                 Net_Opts;
 int                 Wan_Blen;
 int                 Wan_Opts;
+int                 Net_Lsnr;     // Listening sockets per port
+int                 Net_TFO;      // Accept TCP Fast Open connections
 
 int                 PortTCP;      // TCP Port to listen on
 int                 PortUDP;      // UDP Port to listen on (currently unsupported)
@@ -120,6 +125,9 @@ int                 HomeMode;
 int                 repInt;
 char                repOpts;
 char                ppNet;
+char                ppEdge;
+char                ppInl;
+int                 ppPoll;
 signed char         coreV;
 };
 #endif
@@ -66,6 +66,9 @@
 
        XrdNetIF    XrdInet::netIF;
 
+XrdNetSocket::TuneParms XrdInet::netLcl;
+XrdNetSocket::TuneParms XrdInet::netPub;
+
 /******************************************************************************/
 /*                                A c c e p t                                 */
 /******************************************************************************/
@@ -93,7 +96,8 @@ XrdLink *XrdInet::Accept(int opts, int timeout, XrdSysSemaphore *theSem)
 // will be doing a background check on this connection.
 //
    if (theSem) theSem->Post();
-   if (!(netOpts & XRDNET_NORLKUP)) myAddr.Name();
+   if (!(netOpts & XRDNET_NORLKUP) && (Patrol || !myAddr.Prefetch()))
+      myAddr.Name();
 
 // Authorize by ip address or full (slow) hostname format. We defer the check
 // so that the next accept can occur before we do any DNS resolution.
@@ -109,6 +113,13 @@ XrdLink *XrdInet::Accept(int opts, int timeout, XrdSysSemaphore *theSem)
           }
       }
 
+// Apply the socket tuning for this class of network
+//
+   if (!myAddr.isIPType(XrdNetAddrInfo::IPuX))
+      {XrdNetSocket::TuneParms &tune = (myAddr.isPrivate() ? netLcl : netPub);
+       if (tune.isSet()) XrdNetSocket::setTune(myAddr.SockFD(), tune, eDest);
+      }
+
 // Allocate a new network object
 //
    if (!(lp = XrdLink::Alloc(myAddr, lnkopts)))
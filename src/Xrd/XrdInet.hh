@@ -33,6 +33,7 @@
 
 #include "XrdNet/XrdNet.hh"
 #include "XrdNet/XrdNetIF.hh"
+#include "XrdNet/XrdNetSocket.hh"
 
 // The XrdInet class defines a generic network where we can define common
 // initial tcp/ip and udp operations. It is based on the generalized network
@@ -68,6 +69,14 @@ static bool GetAssumeV4() {return AssumeV4;}
 static
 XrdNetIF    netIF;
 
+// Socket tuning applied to accepted connections from private (netLcl) and
+// public (netPub) addresses.
+//
+static
+XrdNetSocket::TuneParms netLcl;
+static
+XrdNetSocket::TuneParms netPub;
+
 private:
 int Listen();
 
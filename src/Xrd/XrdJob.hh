@@ -33,6 +33,8 @@
 #include <string.h>
 #include <strings.h>
 #include <time.h>
+
+#include "XrdSys/XrdSysTimerWheel.hh"
   
 // The XrdJob class is a super-class that is inherited by any class that needs
 // to schedule work on behalf of itself. The XrdJob class is optimized for
@@ -42,17 +44,24 @@
 class XrdJob
 {
 friend class XrdScheduler;
+friend class XrdSchedulerQueue;
 public:
 XrdJob    *NextJob;   // -> Next job in the queue (zero if last)
 const char *Comment;   // -> Description of work for debugging (static!)
 
 virtual void  DoIt() = 0;
 
-              XrdJob(const char *desc="")
-                    {Comment = desc; NextJob = 0; SchedTime = 0;}
+              XrdJob(const char *desc="") : TimerEntry(this)
+                    {Comment = desc; NextJob = 0;
+                     QueueTime = 0;
+                    }
 virtual      ~XrdJob() {}
 
 private:
-time_t      SchedTime; // -> Time job is to be scheduled
+struct TimerEnt : public XrdSysTimerWheel::Entry
+      {XrdJob *Job;
+               TimerEnt(XrdJob *jp) : Job(jp) {}
+      }     TimerEntry; // -> Time job is to be scheduled (timer wheel)
+long long   QueueTime;  // -> Time job was queued (usec, work stealing only)
 };
 #endif
@@ -27,9 +27,11 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <new>
 #include <poll.h>
 #include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/uio.h>
@@ -142,6 +144,7 @@ static const char *TraceID;
        int             XrdLink::devNull = XrdSysFD_Open("/dev/null", O_RDONLY);
        short           XrdLink::killWait= 3;  // Kill then wait
        short           XrdLink::waitKill= 4;  // Wait then kill
+       int             XrdLink::coalMax = 0;  // Coalescing is off
 
 // The following values are defined for LinkBat[]. We assume that FREE is 0
 //
@@ -157,6 +160,7 @@ XrdLink::XrdLink() : XrdJob("connection"), IOSemaphore(0, "link i/o")
 {
   Etext = 0;
   HostName = 0;
+  coalBuff = 0;
   Reset();
 }
 
@@ -177,6 +181,8 @@ void XrdLink::Reset()
   sendQ    = 0;
   Protocol = 0; 
   ProtoAlt = 0;
+  peekBuff = 0;
+  peekLen  = 0;
   conTime  = time(0);
   stallCnt = stallCntTot = 0;
   tardyCnt = tardyCntTot = 0;
@@ -185,9 +191,15 @@ void XrdLink::Reset()
   Poller   = 0; 
   PollEnt  = 0;
   isEnabled= 0;
+  coalOn   = 0;
+  coalLen  = 0;
+  evState  = 0;
   isIdle   = 0;
   inQ      = 0;
   isBridged= 0;
+  inlineOK = 0;
+  inLine   = 0;
+  offLoad  = 0;
   BytesOut = BytesIn = BytesOutTot = BytesInTot = 0;
   doPost   = 0;
   LockReads= 0;
@@ -231,14 +243,21 @@ XrdLink *XrdLink::Alloc(XrdNetAddr &peer, int opts)
 //
    if (!(lp = LinkTab[peerFD]))
       {unsigned int i;
-       XrdLink **blp, *nlp = new XrdLink[LinkAlloc]();
-       if (!nlp)
+       XrdLink **blp, *nlp;
+       void *lMem;
+// Links are never freed; a quantum is carved out of one aligned block so that
+// the cache line separation within each link holds. The block is first
+// touched here, by the thread accepting the connection, which places it on
+// the memory node of the cpu that will most likely service it.
+//
+       if (posix_memalign(&lMem, XRDLINK_CLSZ, LinkAlloc*sizeof(XrdLink)))
           {LTMutex.UnLock();
            XrdLog->Emsg("Link", ENOMEM, "create link"); 
            return (XrdLink *)0;
           }
+       nlp = (XrdLink *)lMem;
        blp = &LinkTab[peerFD/LinkAlloc*LinkAlloc];
-       for (i = 0; i < LinkAlloc; i++, blp++) *blp = &nlp[i];
+       for (i = 0; i < LinkAlloc; i++, blp++) *blp = new(&nlp[i]) XrdLink();
        lp = LinkTab[peerFD];
       }
       else lp->Reset();
@@ -327,6 +346,10 @@ int XrdLink::Close(int defer)
 {  XrdSysMutexHelper opHelper(opMutex);
    int csec, fd, rc = 0;
 
+// Push out any coalesced responses before the connection goes away
+//
+   if (coalLen) {wrMutex.Lock(); coalFlush(); wrMutex.UnLock();}
+
 // If a defer close is requested, we can close the descriptor but we must
 // keep the slot number to prevent a new client getting the same fd number.
 // Linux is peculiar in that any in-progress operations will remain in that
@@ -422,6 +445,77 @@ int XrdLink::Close(int defer)
    return rc;
 }
 
+/******************************************************************************/
+/* private                     c o a l F l u s h                              */
+/******************************************************************************/
+
+// The caller must hold the wrMutex
+//
+void XrdLink::coalFlush()
+{
+   if (coalLen)
+      {if (sendData(coalBuff, coalLen) < 0 && FD >= 0)
+          XrdLog->Emsg("Link", errno, "send to", ID);
+       coalLen = 0;
+      }
+}
+
+/******************************************************************************/
+/* private                      c o a l P o l l                               */
+/******************************************************************************/
+
+// Called before reading. Coalesced responses may stay buffered only while the
+// next request has already arrived; otherwise we would wait with them.
+//
+void XrdLink::coalPoll()
+{
+   struct pollfd polltab = {FD, POLLIN|POLLRDNORM, 0};
+   int retc;
+
+   do {retc = poll(&polltab, 1, 0);} while(retc < 0 && errno == EINTR);
+   if (retc == 1 && (polltab.revents & (POLLIN|POLLRDNORM))) return;
+
+   wrMutex.Lock();
+   coalFlush();
+   wrMutex.UnLock();
+}
+
+/******************************************************************************/
+/* private                      c o a l S e n d                               */
+/******************************************************************************/
+
+// The caller must hold the wrMutex and coalescing must be on
+//
+int XrdLink::coalSend(const struct iovec *iov, int iocnt, int bytes)
+{
+   struct iovec myIOV[coalIOV];
+   int i, retc;
+
+// Small responses from the thread processing requests are simply buffered
+//
+   if (bytes <= coalMax - coalLen && pthread_equal(coalTID, pthread_self()))
+      {for (i = 0; i < iocnt; i++)
+           {memcpy(coalBuff+coalLen, iov[i].iov_base, iov[i].iov_len);
+            coalLen += iov[i].iov_len;
+           }
+       return bytes;
+      }
+
+// Anything else goes out right away, preceded by whatever was buffered. We
+// try to do that with a single writev().
+//
+   if (!coalLen) return sendIOV(iov, iocnt, bytes);
+   if (iocnt >= coalIOV) coalFlush();
+      else {myIOV[0].iov_base = coalBuff;
+            myIOV[0].iov_len  = coalLen;
+            memcpy(&myIOV[1], iov, iocnt*sizeof(struct iovec));
+            retc = sendIOV(myIOV, iocnt+1, bytes+coalLen);
+            coalLen = 0;
+            return (retc < 0 ? retc : bytes);
+           }
+   return sendIOV(iov, iocnt, bytes);
+}
+
 /******************************************************************************/
 /*                                  D o I t                                   */
 /******************************************************************************/
@@ -437,11 +531,45 @@ void XrdLink::DoIt()
 // = 0 -> OK, get next request, if allowed, o/w enable the link
 // > 0 -> Slow link, stop getting requests  and enable the link
 //
-   if (Protocol)
-      do {rc = Protocol->Process(this);} while (!rc && XrdSched->canStick());
-      else {XrdLog->Emsg("Link", "Dispatch on closed link", ID);
-            return;
-           }
+   if (!Protocol)
+      {XrdLog->Emsg("Link", "Dispatch on closed link", ID);
+       return;
+      }
+
+// When so configured, small responses are coalesced while we process requests
+// and sent when we are done or would otherwise wait for the next request.
+//
+   if (coalMax && !sendQ)
+      {wrMutex.Lock();
+       if (!coalBuff) coalBuff = (char *)malloc(coalMax);
+       if (coalBuff) {coalTID = pthread_self(); coalOn = 1;}
+       wrMutex.UnLock();
+      }
+
+   do {rc = Protocol->Process(this);}
+      while (!rc && !inLine && XrdSched->canStick());
+
+   if (coalOn)
+      {wrMutex.Lock();
+       coalFlush();
+       coalOn = 0;
+       wrMutex.UnLock();
+      }
+
+// When run by the poller, anything that may block is done by a worker thread.
+// That includes continuing a request the protocol handed off and closing.
+//
+   if (inLine)
+      {inLine = 0;
+       if (offLoad)
+          {offLoad = 0;
+           if (!rc) {XrdSched->Schedule((XrdJob *)this); return;}
+          }
+       if (rc < 0 && rc != -EINPROGRESS)
+          {if (XrdPoll::Finish(this)) XrdSched->Schedule((XrdJob *)this);
+           return;
+          }
+      }
 
 // Either re-enable the link and cycle back waiting for a new request, leave
 // disabled, or terminate the connection.
@@ -555,13 +683,21 @@ int XrdLink::Peek(char *Buff, int Blen, int timeout)
    ssize_t mlen;
    int retc;
 
+// If the protocol loader already peeked at enough data, return a copy of it
+//
+   if (peekBuff && Blen <= peekLen)
+      {memcpy(Buff, peekBuff, Blen);
+       return Blen;
+      }
+
 // Lock the read mutex if we need to, the helper will unlock it upon exit
 //
    if (LockReads) theMutex.Lock(&rdMutex);
 
 // Wait until we can actually read something
 //
-   isIdle = 0;
+   if (isIdle) isIdle = 0;
+   if (coalLen) coalPoll();
    do {retc = poll(&polltab, 1, timeout);} while(retc < 0 && errno == EINTR);
    if (retc != 1)
       {if (retc == 0) return 0;
@@ -600,7 +736,8 @@ int XrdLink::Recv(char *Buff, int Blen)
 // timeout to receive as much data as possible.
 //
    if (LockReads) rdMutex.Lock();
-   isIdle = 0;
+   if (isIdle) isIdle = 0;
+   if (coalLen) coalPoll();
    do {rlen = read(FD, Buff, Blen);} while(rlen < 0 && errno == EINTR);
    if (rlen > 0) AtomicAdd(BytesIn, rlen);
    if (LockReads) rdMutex.UnLock();
@@ -625,7 +762,8 @@ int XrdLink::Recv(char *Buff, int Blen, int timeout)
 
 // Wait up to timeout milliseconds for data to arrive
 //
-   isIdle = 0;
+   if (isIdle) isIdle = 0;
+   if (coalLen) coalPoll();
    while(Blen > 0)
         {do {retc = poll(&polltab,1,timeout);} while(retc < 0 && errno == EINTR);
          if (retc != 1)
@@ -664,6 +802,57 @@ int XrdLink::Recv(char *Buff, int Blen, int timeout)
 }
 
 
+/******************************************************************************/
+
+int XrdLink::RecvAtLeast(char *Buff, int Need, int Blen, int timeout)
+{
+   XrdSysMutexHelper theMutex;
+   struct pollfd polltab = {FD, POLLIN|POLLRDNORM, 0};
+   ssize_t rlen, totlen = 0;
+   int retc;
+
+// Lock the read mutex if we need to, the helper will unlock it upon exit
+//
+   if (LockReads) theMutex.Lock(&rdMutex);
+
+// Wait up to timeout milliseconds for data to arrive and read whatever is
+// there until we have what we need.
+//
+   if (isIdle) isIdle = 0;
+   if (coalLen) coalPoll();
+   while(totlen < Need)
+        {do {retc = poll(&polltab,1,timeout);} while(retc < 0 && errno == EINTR);
+         if (retc != 1)
+            {if (retc == 0)
+                {tardyCnt++;
+                 if (totlen)
+                    {if ((++stallCnt & 0xff) == 1) TRACEI(DEBUG,"read timed out");
+                     AtomicAdd(BytesIn, totlen);
+                    }
+                 return int(totlen);
+                }
+             return (FD >= 0 ? XrdLog->Emsg("Link", -errno, "poll", ID) : -1);
+            }
+
+         if (!(polltab.revents & (POLLIN|POLLRDNORM)))
+            {XrdLog->Emsg("Link", XrdPoll::Poll2Text(polltab.revents),
+                                 "polling", ID);
+             return -1;
+            }
+
+         do {rlen = recv(FD, Buff+totlen, Blen-totlen, 0);}
+            while(rlen < 0 && errno == EINTR);
+         if (rlen <= 0)
+            {if (!rlen) return -ENOMSG;
+             return (FD<0 ? -1 : XrdLog->Emsg("Link",-errno,"receive from",ID));
+            }
+         totlen += rlen;
+        }
+
+   AtomicAdd(BytesIn, totlen);
+   return int(totlen);
+}
+
 /******************************************************************************/
 /*                               R e c v A l l                                */
 /******************************************************************************/
@@ -677,6 +866,7 @@ int XrdLink::RecvAll(char *Buff, int Blen, int timeout)
 // Check if timeout specified. Notice that the timeout is the max we will
 // for some data. We will wait forever for all the data. Yeah, it's weird.
 //
+   if (coalLen) coalPoll();
    if (timeout >= 0)
       {do {retc = poll(&polltab,1,timeout);} while(retc < 0 && errno == EINTR);
        if (retc != 1)
@@ -693,7 +883,7 @@ int XrdLink::RecvAll(char *Buff, int Blen, int timeout)
 // Note that we will block until we receive all he bytes.
 //
    if (LockReads) rdMutex.Lock();
-   isIdle = 0;
+   if (isIdle) isIdle = 0;
    do {rlen = recv(FD,Buff,Blen,MSG_WAITALL);} while(rlen < 0 && errno == EINTR);
    if (rlen > 0) AtomicAdd(BytesIn, rlen);
    if (LockReads) rdMutex.UnLock();
@@ -716,7 +906,7 @@ int XrdLink::Send(const char *Buff, int Blen)
 // Get a lock
 //
    wrMutex.Lock();
-   isIdle = 0;
+   if (isIdle) isIdle = 0;
    AtomicAdd(BytesOut, Blen);
 
 // Do non-blocking writes if we are setup to do so.
@@ -727,6 +917,17 @@ int XrdLink::Send(const char *Buff, int Blen)
        return retc;
       }
 
+// Coalesce the data with other responses if we are doing so
+//
+   if (coalOn)
+      {struct iovec myIOV = {(void *)Buff, (size_t)Blen};
+       retc = coalSend(&myIOV, 1, Blen);
+       wrMutex.UnLock();
+       if (retc >= 0) return Blen;
+       XrdLog->Emsg("Link", errno, "send to", ID);
+       return -1;
+      }
+
 // Write the data out
 //
    while(bytesleft)
@@ -749,9 +950,7 @@ int XrdLink::Send(const char *Buff, int Blen)
   
 int XrdLink::Send(const struct iovec *iov, int iocnt, int bytes)
 {
-   ssize_t bytesleft, n, retc = 0;
-   const char *Buff;
-   int i;
+   int i, retc;
 
 // Add up bytes if they were not given to us
 //
@@ -760,7 +959,7 @@ int XrdLink::Send(const struct iovec *iov, int iocnt, int bytes)
 // Get a lock and assume we will be successful (statistically we are)
 //
    wrMutex.Lock();
-   isIdle = 0;
+   if (isIdle) isIdle = 0;
    AtomicAdd(BytesOut, bytes);
 
 // Do non-blocking writes if we are setup to do so.
@@ -771,29 +970,9 @@ int XrdLink::Send(const struct iovec *iov, int iocnt, int bytes)
        return retc;
       }
 
-// Write the data out. On some version of Unix (e.g., Linux) a writev() may
-// end at any time without writing all the bytes when directed to a socket.
-// So, we attempt to resume the writev() using a combination of write() and
-// a writev() continuation. This approach slowly converts a writev() to a
-// series of writes if need be. We must do this inline because we must hold
-// the lock until all the bytes are written or an error occurs.
+// Write the data out, possibly along with other responses
 //
-   bytesleft = static_cast<ssize_t>(bytes);
-   while(bytesleft)
-        {do {retc = writev(FD, iov, iocnt);} while(retc < 0 && errno == EINTR);
-         if (retc >= bytesleft || retc < 0) break;
-         bytesleft -= retc;
-         while(retc >= (n = static_cast<ssize_t>(iov->iov_len)))
-              {retc -= n; iov++; iocnt--;}
-         Buff = (const char *)iov->iov_base + retc; n -= retc; iov++; iocnt--;
-         while(n) {if ((retc = write(FD, Buff, n)) < 0)
-                      {if (errno == EINTR) continue;
-                          else break;
-                      }
-                   n -= retc; Buff += retc;
-                  }
-         if (retc < 0 || iocnt < 1) break;
-        }
+   retc = (coalOn ? coalSend(iov, iocnt, bytes) : sendIOV(iov, iocnt, bytes));
 
 // All done
 //
@@ -843,7 +1022,8 @@ int XrdLink::Send(const sfVec *sfP, int sfN)
 // very limited conditions.
 //
    wrMutex.Lock();
-   isIdle = 0;
+   if (isIdle) isIdle = 0;
+   coalFlush();
 do{retc = sendfilev(FD, vecSFP, sfN, &xframt);
 
 // Check if all went well and return if so (usual case)
@@ -887,7 +1067,7 @@ do{retc = sendfilev(FD, vecSFP, sfN, &xframt);
 // lock the link
 //
    wrMutex.Lock();
-   isIdle = 0;
+   if (isIdle) isIdle = 0;
 
 // In linux we need to cork the socket. On permanent errors we do not uncork
 // the socket because it will be closed in short order.
@@ -897,6 +1077,10 @@ do{retc = sendfilev(FD, vecSFP, sfN, &xframt);
        uncork = 0; sfOK = 0;
       }
 
+// Coalesced responses precede the data and share the corked segments
+//
+   coalFlush();
+
 // Send the header first
 //
    for (i = 0; i < sfN; sfP++, i++)
@@ -958,6 +1142,47 @@ int XrdLink::sendData(const char *Buff, int Blen)
    return retc;
 }
 
+/******************************************************************************/
+/* private                       s e n d I O V                                */
+/******************************************************************************/
+
+// The caller must hold the wrMutex. Returns bytes upon success and -1 upon
+// failure with errno set.
+//
+int XrdLink::sendIOV(const struct iovec *iov, int iocnt, int bytes)
+{
+   ssize_t bytesleft, n, retc = 0;
+   const char *Buff;
+
+// Write the data out. On some version of Unix (e.g., Linux) a writev() may
+// end at any time without writing all the bytes when directed to a socket.
+// So, we attempt to resume the writev() using a combination of write() and
+// a writev() continuation. This approach slowly converts a writev() to a
+// series of writes if need be. We must do this inline because we must hold
+// the lock until all the bytes are written or an error occurs.
+//
+   bytesleft = static_cast<ssize_t>(bytes);
+   while(bytesleft)
+        {do {retc = writev(FD, iov, iocnt);} while(retc < 0 && errno == EINTR);
+         if (retc >= bytesleft || retc < 0) break;
+         bytesleft -= retc;
+         while(retc >= (n = static_cast<ssize_t>(iov->iov_len)))
+              {retc -= n; iov++; iocnt--;}
+         Buff = (const char *)iov->iov_base + retc; n -= retc; iov++; iocnt--;
+         while(n) {if ((retc = write(FD, Buff, n)) < 0)
+                      {if (errno == EINTR) continue;
+                          else break;
+                      }
+                   n -= retc; Buff += retc;
+                  }
+         if (retc < 0 || iocnt < 1) break;
+        }
+
+// All done
+//
+   return (retc < 0 ? -1 : bytes);
+}
+
 /******************************************************************************/
 /*                              s e t E t e x t                               */
 /******************************************************************************/
@@ -1012,6 +1237,7 @@ bool XrdLink::setNB()
    opMutex.Lock();
    if (!sendQ)
       {wrMutex.Lock();
+       coalFlush();
        sendQ = new XrdSendQ(*this, wrMutex);
        wrMutex.UnLock();
       }
@@ -60,6 +60,10 @@ class XrdScheduler;
 class XrdSendQ;
 class XrdSysError;
 
+// The alignment used to keep the read and write sides of a link apart
+//
+#define XRDLINK_CLSZ 64
+
 class XrdLink : XrdJob
 {
 public:
@@ -103,6 +107,18 @@ int           Close(int defer=0);
 
 void          DoIt();
 
+// Process a request on the calling poller thread (run-to-completion mode).
+// While doing so, isInline() is true and a protocol that is about to do
+// something that may block calls Offload() and returns 0. The link is then
+// scheduled as usual instead of being re-enabled. Only links whose protocol
+// called armInline() are processed this way.
+//
+void          DoInline() {inLine = 1; DoIt();}
+
+bool          isInline() {return inLine != 0;}
+
+void          Offload() {offLoad = 1;}
+
 void          Enable();
 
 int           FDnum() {int fd = FD; return (fd < 0 ? -fd : fd);}
@@ -205,6 +221,12 @@ int           Peek(char *buff, int blen, int timeout=-1);
 int           Recv(char *buff, int blen);
 int           Recv(char *buff, int blen, int timeout);
 
+// Receive at least need bytes but take whatever else is queued up to blen
+// bytes. Returns the number of bytes read, which is less than need only when
+// no more data arrived within the timeout, or -1 upon error.
+//
+int           RecvAtLeast(char *buff, int need, int blen, int timeout);
+
 int           RecvAll(char *buff, int blen, int timeout=-1);
 
 int           Send(const char *buff, int blen);
@@ -222,12 +244,19 @@ int           setEtext(const char *text);
 
 void          setID(const char *userid, int procid);
 
+static void   setCoalesce(int bsz) {coalMax = bsz;}
+
 static void   setKWT(int wkSec, int kwSec);
 
 void          setLocation(XrdNetAddrInfo::LocInfo &loc) {Addr.SetLocation(loc);}
 
 bool          setNB();
 
+// Serve Peek() requests of at most blen bytes from buff (buff=0 turns it off).
+// Used while protocols are being matched so the socket is peeked only once.
+//
+void          setPeek(char *buff, int blen) {peekBuff = buff; peekLen = blen;}
+
 XrdProtocol  *setProtocol(XrdProtocol *pp);
 
 void          setRef(int cnt);                          // ASYNC Mode
@@ -249,13 +278,20 @@ int           UseCnt() {return InUse;}
 void          armBridge() {isBridged = 1;}
 int           hasBridge() {return isBridged;}
 
+void          armInline() {inlineOK = 1;}
+bool          canInline() {return inlineOK != 0;}
+
               XrdLink();
              ~XrdLink() {}  // Is never deleted!
 
 private:
 
+void   coalFlush();
+void   coalPoll();
+int    coalSend(const struct iovec *iov, int iocnt, int bytes);
 void   Reset();
 int    sendData(const char *Buff, int Blen);
+int    sendIOV(const struct iovec *iov, int iocnt, int bytes);
 
 static XrdSysError  *XrdLog;
 static XrdOucTrace  *XrdTrace;
@@ -271,6 +307,8 @@ static const char   *TraceID;
 static int           devNull;
 static short         killWait;
 static short         waitKill;
+static int           coalMax;    // Size of the coalesce buffer (0 -> off)
+static const int     coalIOV = 32;
 
 // Statistical area (global and local)
 //
@@ -284,16 +322,37 @@ static int          LinkTimeOuts;
 static int          LinkStalls;
 static int          LinkSfIntr;
 static int          maxFD;
+static XrdSysMutex  statsMutex;
+
+// Read side: touched on every receive by the thread reading the link. Kept
+// in its own cache line so that it does not bounce with the write side when
+// responses are sent by another thread (e.g. asynchronous I/O).
+//
+alignas(XRDLINK_CLSZ)
+XrdSysMutex         rdMutex;
        long long        BytesIn;
-       long long        BytesInTot;
+       int              stallCnt;
+       int              tardyCnt;
+
+// Write side: touched on every send and protected by wrMutex.
+//
+alignas(XRDLINK_CLSZ)
+XrdSysMutex         wrMutex;
        long long        BytesOut;
+       int              SfIntr;
+int                 coalLen;        // Protected by wrMutex
+XrdSendQ           *sendQ;          // Protected by wrMutex && opMutex
+char               *coalBuff;       // Coalesced small responses
+pthread_t           coalTID;        // Thread processing requests via DoIt()
+char                coalOn;         // Protected by wrMutex
+
+// Whatever follows is only looked at when the link changes state or its
+// statistics are collected.
+//
+       long long        BytesInTot;
        long long        BytesOutTot;
-       int              stallCnt;
        int              stallCntTot;
-       int              tardyCnt;
        int              tardyCntTot;
-       int              SfIntr;
-static XrdSysMutex  statsMutex;
 
 // Identification section
 //
@@ -308,13 +367,12 @@ pthread_t           TID;     // Hack to keep abi compatability
 XrdLink            *Next;    // Only used by PollPoll.icc
 #endif
 XrdSysMutex         opMutex;
-XrdSysMutex         rdMutex;
-XrdSysMutex         wrMutex;
 XrdSysSemaphore     IOSemaphore;
 XrdSysCondVar      *KillcvP;        // Protected by opMutex!
-XrdSendQ           *sendQ;          // Protected by wrMutex && opMutex
 XrdProtocol        *Protocol;
 XrdProtocol        *ProtoAlt;
+char               *peekBuff;       // Only set while a protocol is matched
+int                 peekLen;
 XrdPoll            *Poller;
 struct pollfd      *PollEnt;
 char               *Etext;
@@ -326,9 +384,13 @@ int                 doPost;
 char                LockReads;
 char                KeepFD;
 char                isEnabled;
+char                evState;        // Only used by PollE.icc in edge mode
 char                isIdle;
 char                inQ;    // Only used by PollPoll.icc
 char                isBridged;
+char                inlineOK;       // Protocol can run on the poller thread
+char                inLine;         // Running  on the poller thread
+char                offLoad;        // Protocol wants a worker thread
 char                KillCnt;        // Protected by opMutex!
 static const char   KillMax =   60;
 static const char   KillMsk = 0x7f;
@@ -204,6 +204,22 @@ int main(int argc, char *argv[])
               }
           }
 
+// Spawn a thread for each additional listener sharing a port with one of the
+// networks above. The accept threads for a port then run concurrently.
+//
+   for (i = 0; i < Main.Config.NetRPTn; i++)
+       {XrdMain *Parms = new XrdMain(Main.Config.NetRPT[i]);
+        XrdInet *netWAN = Main.Config.NetTCP[XrdProtLoad::ProtoMax];
+        sprintf(buff, "Port %d handler %d", Parms->thePort, i+1);
+        if (netWAN && netWAN->Port() == Parms->thePort)
+           Parms->thePort = -(Parms->thePort);
+        if ((retc = XrdSysThread::Run(&tid, mainAccept, (void *)Parms,
+                                      XRDSYSTHREAD_BIND, strdup(buff))))
+           {Main.Config.ProtInfo.eDest->Emsg("main", retc, "create", buff);
+            _exit(3);
+           }
+       }
+
 // Finally, start accepting connections on the main port
 //
    Main.theNet  = Main.Config.NetTCP[0];
@@ -30,6 +30,9 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
   
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysFD.hh"
@@ -76,7 +79,8 @@ int           Stats(char *buff, int blen, int do_sync=0) {return 0;}
 /*                           G l o b a l   D a t a                            */
 /******************************************************************************/
   
-       XrdPoll   *XrdPoll::Pollers[XRD_NUMPOLLERS] = {0, 0, 0};
+       XrdPoll   *XrdPoll::Pollers[XRD_MAXPOLLERS] = {0};
+       int        XrdPoll::numPollers = XRD_NUMPOLLERS;
 
        XrdSysMutex  XrdPoll::doingAttach;
 
@@ -85,6 +89,8 @@ int           Stats(char *buff, int blen, int do_sync=0) {return 0;}
        XrdOucTrace  *XrdPoll::XrdTrace = 0;
        XrdSysError  *XrdPoll::XrdLog   = 0;
        XrdScheduler *XrdPoll::XrdSched = 0;
+       bool          XrdPoll::wantEdge = false;
+       bool          XrdPoll::runInline= false;
 
 /******************************************************************************/
 /*              T h r e a d   S t a r t u p   I n t e r f a c e               */
@@ -116,7 +122,7 @@ XrdPoll::XrdPoll()
    int fildes[2];
 
    TID=0;
-   numAttached=numEnabled=numEvents=numInterrupts=0;
+   numAttached=numEnabled=numEvents=numInterrupts=numInline=0;
 
    if (XrdSysFD_Pipe(fildes) == 0)
       {CmdFD = fildes[1];
@@ -149,7 +155,7 @@ int XrdPoll::Attach(XrdLink *lp)
 // Find a poller with the smallest number of entries
 //
    pp = Pollers[0];
-   for (i = 1; i < XRD_NUMPOLLERS; i++)
+   for (i = 1; i < numPollers; i++)
        if (pp->numAttached > Pollers[i]->numAttached) pp = Pollers[i];
 
 // Include this FD into the poll set of the poller
@@ -282,6 +288,16 @@ char *XrdPoll::Poll2Text(short events)
   return (char *)0;
 }
 
+/******************************************************************************/
+/*                            s e t P o l l e r s                             */
+/******************************************************************************/
+  
+void XrdPoll::setPollers(int num, bool inl)
+{
+   if (num > 0) numPollers = (num > XRD_MAXPOLLERS ? XRD_MAXPOLLERS : num);
+   runInline = inl;
+}
+
 /******************************************************************************/
 /*                                 S e t u p                                  */
 /******************************************************************************/
@@ -294,11 +310,11 @@ int XrdPoll::Setup(int numfd)
 
 // Calculate the number of table entries per poller
 //
-   maxfd  = (numfd / XRD_NUMPOLLERS) + 16;
+   maxfd  = (numfd / numPollers) + 16;
 
 // Verify that we initialized the poller table
 //
-   for (i = 0; i < XRD_NUMPOLLERS; i++)
+   for (i = 0; i < numPollers; i++)
        {if (!(Pollers[i] = newPoller(i, maxfd))) return 0;
         Pollers[i]->PID = i;
 
@@ -311,6 +327,16 @@ int XrdPoll::Setup(int numfd)
                                       XRDSYSTHREAD_BIND, "Poller")))
            {XrdLog->Emsg("Poll", retc, "create poller thread"); return 0;}
         Pollers[i]->TID = tid;
+#ifdef __linux__
+        if (runInline)
+           {cpu_set_t cpuSet;
+            int ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+            CPU_ZERO(&cpuSet);
+            CPU_SET((ncpu > 0 ? i % ncpu : 0), &cpuSet);
+            if ((retc = pthread_setaffinity_np(tid, sizeof(cpuSet), &cpuSet)))
+               XrdLog->Emsg("Poll", retc, "bind poller thread to a cpu");
+           }
+#endif
         PArg.PollSync.Wait();
         if (PArg.retcode)
            {XrdLog->Emsg("Poll", PArg.retcode, "start poller");
@@ -330,29 +356,30 @@ int XrdPoll::Setup(int numfd)
 int XrdPoll::Stats(char *buff, int blen, int do_sync)
 {
    static const char statfmt[] = "<stats id=\"poll\"><att>%d</att>"
-   "<en>%d</en><ev>%d</ev><int>%d</int></stats>";
-   int i, numatt = 0, numen = 0, numev = 0, numint = 0;
+   "<en>%d</en><ev>%d</ev><int>%d</int><inl>%d</inl></stats>";
+   int i, numatt = 0, numen = 0, numev = 0, numint = 0, numinl = 0;
    XrdPoll *pp;
 
 // Return number of bytes if so wanted
 //
-   if (!buff) return (sizeof(statfmt)+(4*16))*XRD_NUMPOLLERS;
+   if (!buff) return (sizeof(statfmt)+(5*16))*numPollers;
 
 // Get statistics. While we wish we could honor do_sync, doing so would be
 // costly and hardly worth it. So, we do not include code such as:
 //    x = pp->y; if (do_sync) while(x != pp->y) x = pp->y; tot += x;
 //
-   for (i = 0; i < XRD_NUMPOLLERS; i++)
+   for (i = 0; i < numPollers; i++)
        {pp = Pollers[i];
         numatt += pp->numAttached; 
         numen  += pp->numEnabled;
         numev  += pp->numEvents;
         numint += pp->numInterrupts;
+        numinl += pp->numInline;
        }
 
 // Format and return
 //
-   return snprintf(buff, blen, statfmt, numatt, numen, numev, numint);
+   return snprintf(buff, blen, statfmt, numatt, numen, numev, numint, numinl);
 }
   
 /******************************************************************************/
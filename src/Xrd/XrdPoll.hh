@@ -33,6 +33,7 @@
 #include "XrdSys/XrdSysPthread.hh"
 
 #define XRD_NUMPOLLERS 3
+#define XRD_MAXPOLLERS 64
 
 class XrdOucTrace;
 class XrdSysError;
@@ -64,6 +65,16 @@ virtual int   Enable(XrdLink *lp)  = 0;
 //
 static  int   Finish(XrdLink *lp, const char *etxt=0); //Implementation supplied
 
+// EdgeMode() is called at config time to ask for edge triggered polling. It is
+//            only honored by the epoll implementation.
+//
+static  void  EdgeMode(bool onoff) {wantEdge = onoff;}
+
+// InLine() returns true if pollers run links that allow it inline (i.e. in
+//          run-to-completion mode). Set via setPollers().
+//
+static  bool  InLine() {return runInline;}
+
 // Init()   is called to set pointers to external interfaces at config time.
 //
 static  void  Init(XrdSysError *eP, XrdOucTrace *tP, XrdScheduler *sP)
@@ -73,6 +84,11 @@ static  void  Init(XrdSysError *eP, XrdOucTrace *tP, XrdScheduler *sP)
 //
 static  char *Poll2Text(short events); // Implementation supplied
 
+// setPollers() is called at config time to set the number of pollers and
+//              whether they process links inline, each bound to its own cpu.
+//
+static  void  setPollers(int num, bool inl);
+
 // Setup() is called at config time to perform poller configuration
 //
 static  int   Setup(int numfd);        // Implementation supplied
@@ -92,7 +108,8 @@ static  int   Stats(char *buff, int blen, int do_sync=0);
 
 // The following table reference the pollers in effect
 //
-static     XrdPoll   *Pollers[XRD_NUMPOLLERS];
+static     XrdPoll   *Pollers[XRD_MAXPOLLERS];
+static     int        numPollers;
 
            XrdPoll();
 virtual   ~XrdPoll() {}
@@ -103,6 +120,8 @@ static     const char   *TraceID;                  // For tracing
 static     XrdOucTrace  *XrdTrace;
 static     XrdSysError  *XrdLog;
 static     XrdScheduler *XrdSched;
+static     bool          wantEdge;
+static     bool          runInline;
 
 // Gets the next request on the poll pipe. This is common to all implentations.
 //
@@ -143,6 +162,7 @@ int           PipeBlen;
            int         numEnabled;     // Count of Enable() calls
            int         numEvents;      // Count of poll fd's dispatched
            int         numInterrupts;  // Number of interrupts (e.g., signals)
+           int         numInline;      // Count of links processed inline
 
 private:
 
@@ -57,6 +57,8 @@ protected:
 const  char *x2Text(unsigned int evf, char *buff);
 
 private:
+int  Claim(XrdLink *lp);
+int  EnableET(XrdLink *lp);
 void remFD(XrdLink *lp, unsigned int events);
 
 #ifdef EPOLLONESHOT
@@ -67,6 +69,16 @@ void remFD(XrdLink *lp, unsigned int events);
    static const int ePollEvents = EPOLLIN  | EPOLLHUP | EPOLLPRI | EPOLLERR |
                                   EPOLLRDHUP | ePollOneShot;
 
+// In edge mode the fd is armed once when included and XrdLink::evState,
+// changed only via compare and swap, tracks whether the link is enabled or
+// received an event while it was disabled.
+//
+   static const int ePollEdge   = EPOLLIN  | EPOLLHUP | EPOLLPRI | EPOLLERR |
+                                  EPOLLRDHUP | EPOLLET;
+   static const char evIdle = 0;
+   static const char evOn   = 1;
+   static const char evPend = 2;
+
 struct epoll_event *PollTab;
        int          PollDfd;
        int          PollMax;
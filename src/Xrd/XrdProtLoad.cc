@@ -54,6 +54,10 @@ int          XrdProtLoad::ProtPort[ProtoMax] = {0};
 int          XrdProtLoad::ProtoCnt = 0;
 int          XrdProtLoad::ProtWCnt = 0;
 
+int           XrdProtLoad::hailWait = 30*1000;
+unsigned char XrdProtLoad::ProtHint[256] = {0};
+unsigned char XrdProtLoad::WANHint[256]  = {0};
+
 namespace
 {
 char            *liblist[XrdProtLoad::ProtoMax];
@@ -98,6 +102,7 @@ int XrdProtLoad::Load(const char *lname, const char *pname,
 
 // Obtain an instance of this protocol
 //
+   hailWait = pi->hailWait;
    xp = getProtocol(lname, pname, parms, pi);
    if (!xp) {XrdLog->Emsg("Protocol","Protocol", pname, "could not be loaded");
              return 0;
@@ -156,20 +161,40 @@ int XrdProtLoad::Port(const char *lname, const char *pname,
   
 int XrdProtLoad::Process(XrdLink *lp)
 {
-     XrdProtocol *pp = 0;
-     int i;
+     XrdProtocol  *pp = 0, **pTab;
+     unsigned char *hTab, *hP = 0;
+     char pBuff[peekSZ];
+     int i = -1, j, n, pCnt;
 
 // Check if this is a WAN lookup or standard lookup
 //
-   if (myPort < 0)
-      {for (i = 0; i < ProtWCnt; i++)
-           if ((pp = ProtoWAN[i]->Match(lp))) break;
-              else if (lp->isFlawed()) return -1;
-      } else {
-       for (i = 0; i < ProtoCnt; i++)
-           if (myPort == ProtPort[i] && (pp = Protocol[i]->Match(lp))) break;
-               else if (lp->isFlawed()) return -1;
+   if (myPort < 0) {pTab = ProtoWAN; pCnt = ProtWCnt; hTab = WANHint;}
+      else         {pTab = Protocol; pCnt = ProtoCnt; hTab = ProtHint;}
+
+// Peek at the initial data only once. Each protocol's Match() peek is served
+// from this copy unless it wants more than we got. The first byte selects the
+// protocol that last claimed a connection starting with it, which we try
+// first. Otherwise, all protocols are tried in order as usual.
+//
+   if ((n = lp->Peek(pBuff, sizeof(pBuff), hailWait)) > 0)
+      {lp->setPeek(pBuff, n);
+       hP = &hTab[(unsigned char)pBuff[0]];
+       if ((i = *hP - 1) >= 0 && (myPort < 0 || myPort == ProtPort[i]))
+          pp = pTab[i]->Match(lp);
+       if (!pp && lp->isFlawed()) {lp->setPeek(0, 0); return -1;}
+      }
+
+// Run through the table if the hint did not work out
+//
+   if (!pp)
+      {for (j = i, i = 0; i < pCnt; i++)
+           {if (i == j || (myPort >= 0 && myPort != ProtPort[i])) continue;
+            if ((pp = pTab[i]->Match(lp))) break;
+            if (lp->isFlawed()) {lp->setPeek(0, 0); return -1;}
+           }
+       if (pp && hP) *hP = (unsigned char)(i+1);
       }
+   lp->setPeek(0, 0);
    if (!pp) {lp->setEtext("matching protocol not found"); return -1;}
 
 // Now attach the new protocol object to the link
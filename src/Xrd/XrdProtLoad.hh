@@ -80,6 +80,11 @@ static XrdProtocol   *ProtoWAN[ProtoMax];   // ->Supported protocol objects WAN
 static int            ProtoCnt;             // Number in table (at least 1)
 static int            ProtWCnt;             // Number in table (WAN may be 0)
 
+static const int      peekSZ = 64;          // Bytes peeked at to match
+static int            hailWait;             // Max millisecs to wait for them
+static unsigned char  ProtHint[256];        // First byte -> Protocol index+1
+static unsigned char  WANHint[256];         // First byte -> ProtoWAN index+1
+
        int            myPort;
 };
 #endif
@@ -32,7 +32,9 @@
 #include <signal.h>
 #include <stdio.h>
 #include <sys/resource.h>
+#include <sched.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #ifdef __APPLE__
@@ -41,6 +43,7 @@
 
 #include "Xrd/XrdJob.hh"
 #include "Xrd/XrdScheduler.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysError.hh"
 
 #define XRD_TRACE XrdTrace->
@@ -65,6 +68,66 @@ class XrdSchedulerPID
                         {next = prev; pid = newpid;}
      ~XrdSchedulerPID() {}
      };
+
+/******************************************************************************/
+
+// A run queue used in work stealing mode. Each worker thread owns one queue
+// but any worker may take jobs from any queue. Statistics are protected by
+// the queue mutex and times are in microseconds.
+//
+class XrdSchedulerQueue
+     {public:
+      XrdSysMutex      qMutex;
+      XrdJob          *First;
+      XrdJob          *Last;
+      int              inQ;       // Number of jobs in the queue
+      int              maxQ;      // Longest queue length we had
+      long long        numPost;   // Number of jobs placed in the queue
+      long long        numStolen; // Number of jobs taken by other workers
+      long long        totWait;   // Total time jobs waited in the queue
+      long long        maxWait;   // Longest time a job waited in the queue
+      char             Pad[64];   // Keep queues in separate cache lines
+
+static long long       Now()
+                          {struct timeval tv;
+                           gettimeofday(&tv, 0);
+                           return static_cast<long long>(tv.tv_sec)*1000000
+                                + tv.tv_usec;
+                          }
+
+      XrdJob          *Get(bool stolen)
+                          {XrdJob *jp;
+                           qMutex.Lock();
+                           if ((jp = First))
+                              {long long wt = Now() - jp->QueueTime;
+                               if (!(First = jp->NextJob)) Last = 0;
+                               inQ--;
+                               if (stolen) numStolen++;
+                               totWait += wt;
+                               if (wt > maxWait) maxWait = wt;
+                              }
+                           qMutex.UnLock();
+                           return jp;
+                          }
+
+      void             Put(int numjobs, XrdJob *jfirst, XrdJob *jlast)
+                          {long long qTime = Now();
+                           XrdJob *jp = jfirst;
+                           jlast->NextJob = 0;
+                           while(jp) {jp->QueueTime = qTime; jp = jp->NextJob;}
+                           qMutex.Lock();
+                           if (First) Last->NextJob = jfirst;
+                              else    First = jfirst;
+                           Last = jlast;
+                           inQ += numjobs; numPost += numjobs;
+                           if (inQ > maxQ) maxQ = inQ;
+                           qMutex.UnLock();
+                          }
+
+      XrdSchedulerQueue() : First(0), Last(0), inQ(0), maxQ(0), numPost(0),
+                            numStolen(0), totWait(0), maxWait(0) {}
+     ~XrdSchedulerQueue() {}
+     };
   
 /******************************************************************************/
 /*            E x t e r n a l   T h r e a d   I n t e r f a c e s             */
@@ -95,7 +158,8 @@ void *XrdStartWorking(void *carg)
 XrdScheduler::XrdScheduler(XrdSysError *eP, XrdOucTrace *tP,
                            int minw, int maxw, int maxi)
               : XrdJob("underused thread monitor"),
-                WorkAvail(0, "sched work")
+                WorkAvail(0, "sched work"),
+                TimerWheel(time(0)), TimerRings(0, "sched timer")
 {
     struct rlimit rlim;
 
@@ -115,7 +179,12 @@ XrdScheduler::XrdScheduler(XrdSysError *eP, XrdOucTrace *tP,
     num_Layoffs =  0;
     num_Limited =  0;
     firstPID    =  0;
-    WorkFirst = WorkLast = TimerQueue = 0;
+    RunQ        =  0;
+    numRunQ     =  0;
+    nextRunQ    =  0;
+    rrRunQ      =  0;
+    WorkFirst = WorkLast = 0;
+    TimerWake   =  0;
 
 // Make sure we are using the maximum number of threads allowed (Linux only)
 //
@@ -176,28 +245,15 @@ XrdScheduler::~XrdScheduler()  // The scheduler is never deleted!
 
 void XrdScheduler::Cancel(XrdJob *jp)
 {
-   XrdJob *p, *pp = 0;
-
-// Lock the queue
-//
-   TimerMutex.Lock();
-
-// Find the matching job, if any
-//
-   p = TimerQueue;
-   while(p && p != jp) {pp = p; p = p->NextJob;}
+   bool found;
 
-// Delete the job element
+// Remove the job from the timer wheel, if it is there
 //
-   if (p)
-      {if (pp) pp->NextJob = p->NextJob;
-          else  TimerQueue = p->NextJob;
-       TRACE(SCHED, "time event " <<jp->Comment <<" cancelled");
-      }
+   TimerRings.Lock();
+   found = TimerWheel.Cancel(&(jp->TimerEntry));
+   TimerRings.UnLock();
 
-// All done
-//
-   TimerMutex.UnLock();
+   if (found) {TRACE(SCHED, "time event " <<jp->Comment <<" cancelled");}
 }
   
 /******************************************************************************/
@@ -323,6 +379,10 @@ void XrdScheduler::Run()
    int waiting;
    XrdJob *jp;
 
+// If we are using multiple run queues then use the work stealing loop
+//
+   if (numRunQ) {RunSteal(); return;}
+
 // Wait for work then do it (an endless task for a worker thread)
 //
    do {do {DispatchMutex.Lock();          idl_Workers++;DispatchMutex.UnLock();
@@ -364,6 +424,10 @@ void XrdScheduler::Run()
   
 void XrdScheduler::Schedule(XrdJob *jp)
 {
+// If we have multiple run queues, place the job in the selected one
+//
+   if (numRunQ) {RunQPost(RunQPick(), 1, jp, jp); return;}
+
 // Lock down our data area
 //
    SchedMutex.Lock();
@@ -396,6 +460,11 @@ void XrdScheduler::Schedule(XrdJob *jp)
 void XrdScheduler::Schedule(int numjobs, XrdJob *jfirst, XrdJob *jlast)
 {
 
+// If we have multiple run queues, place the jobs in the selected one. Idle
+// workers will steal them from that queue if its owner is busy.
+//
+   if (numRunQ) {RunQPost(RunQPick(), numjobs, jfirst, jlast); return;}
+
 // Lock down our data area
 //
    SchedMutex.Lock();
@@ -430,33 +499,16 @@ void XrdScheduler::Schedule(int numjobs, XrdJob *jfirst, XrdJob *jlast)
 
 void XrdScheduler::Schedule(XrdJob *jp, time_t atime)
 {
-   XrdJob *pp = 0, *p;
-
-// Cancel this event, if scheduled
-//
-   Cancel(jp);
-
-// Lock the queue
-//
    if (TRACING(TRACE_SCHED) && *(jp->Comment) != '.')
       {TRACE(SCHED, "scheduling " <<jp->Comment <<" in " <<atime-time(0) <<" seconds");}
-   jp->SchedTime = atime;
-   TimerMutex.Lock();
-
-// Find the insertion point for the work element
-//
-   p = TimerQueue;
-   while(p && p->SchedTime <= atime) {pp = p; p = p->NextJob;}
 
-// Insert the job element
+// Add the job to the timer wheel, this replaces any pending schedule. Wake up
+// the timer thread if it would sleep past the new time.
 //
-   jp->NextJob = p;
-   if (pp)  pp->NextJob = jp;
-      else {TimerQueue = jp; TimerRings.Signal();}
-
-// All done
-//
-   TimerMutex.UnLock();
+   TimerRings.Lock();
+   TimerWheel.Add(&(jp->TimerEntry), atime);
+   if (atime < TimerWake) {TimerWake = atime; TimerRings.Signal();}
+   TimerRings.UnLock();
 }
 
 /******************************************************************************/
@@ -505,6 +557,32 @@ void XrdScheduler::setParms(int minw, int maxw, int avlw, int maxi, int once)
    TRACE(SCHED,"Set stk_Workers=" <<stk_Workers <<" max_Workidl=" <<max_Workidl);
 }
 
+/******************************************************************************/
+/*                             s e t Q u e u e s                              */
+/******************************************************************************/
+
+void XrdScheduler::setQueues(int nq) // Serialized one time call before Start!
+{
+   int retc;
+
+// Ignore this call if we already have queues or only one queue is wanted
+//
+   if (RunQ || nq < 2) return;
+
+// Create the key that associates a worker thread with its run queue
+//
+   if ((retc = pthread_key_create(&RunQKey, 0)))
+      {XrdLog->Emsg("Scheduler", retc, "create run queue key");
+       return;
+      }
+
+// Allocate the run queues
+//
+   RunQ    = new XrdSchedulerQueue[nq];
+   numRunQ = nq;
+   TRACE(SCHED, "Using " <<nq <<" run queues with work stealing");
+}
+
 /******************************************************************************/
 /*                                 S t a r t                                  */
 /******************************************************************************/
@@ -542,15 +620,18 @@ int XrdScheduler::Stats(char *buff, int blen, int do_sync)
 {
     int cnt_Jobs, cnt_JobsinQ, xam_QLength, cnt_Workers, cnt_idl;
     int cnt_TCreate, cnt_TDestroy, cnt_Limited;
+    int n;
     static char statfmt[] = "<stats id=\"sched\"><jobs>%d</jobs>"
                 "<inq>%d</inq><maxinq>%d</maxinq>"
                 "<threads>%d</threads><idle>%d</idle>"
                 "<tcr>%d</tcr><tde>%d</tde>"
-                "<tlimr>%d</tlimr></stats>";
+                "<tlimr>%d</tlimr>";
+    static char statend[] = "</stats>";
 
 // If only length wanted, do so
 //
-   if (!buff) return sizeof(statfmt) + 16*8;
+   if (!buff) return sizeof(statfmt) + 16*8 + sizeof(statend)
+                   + (numRunQ ? RunQStats(0, 0) : 0);
 
 // Get values protected by the Dispatch lock (avoid lock if no sync needed)
 //
@@ -570,11 +651,16 @@ int XrdScheduler::Stats(char *buff, int blen, int do_sync)
    cnt_Limited = num_Limited;
    if (do_sync) SchedMutex.UnLock();
 
-// Format the stats and return them
+// Format the stats
 //
-   return snprintf(buff, blen, statfmt, cnt_Jobs, cnt_JobsinQ, xam_QLength,
-                   cnt_Workers, cnt_idl, cnt_TCreate, cnt_TDestroy,
-                   cnt_Limited);
+   n = snprintf(buff, blen, statfmt, cnt_Jobs, cnt_JobsinQ, xam_QLength,
+                cnt_Workers, cnt_idl, cnt_TCreate, cnt_TDestroy, cnt_Limited);
+   if (n >= blen) return n;
+
+// Add the run queue information, if any, and return
+//
+   if (numRunQ) {n += RunQStats(buff+n, blen-n); if (n >= blen) return n;}
+   return n + snprintf(buff+n, blen-n, "%s", statend);
 }
 
 /******************************************************************************/
@@ -583,23 +669,39 @@ int XrdScheduler::Stats(char *buff, int blen, int do_sync)
   
 void XrdScheduler::TimeSched()
 {
-   XrdJob *jp;
+   XrdSysTimerWheel::Entry *ep;
+   long long next;
+   time_t now;
    int wtime;
 
-// Continuous loop until we find some work here
-//
-   do {TimerMutex.Lock();
-       if (TimerQueue) wtime = TimerQueue->SchedTime-time(0);
-          else wtime = 60*60;
-       if (wtime > 0)
-          {TimerMutex.UnLock();
-           TimerRings.Wait(wtime);
-          } else {
-           jp = TimerQueue;
-           TimerQueue = jp->NextJob;
-           Schedule(jp);
-           TimerMutex.UnLock();
+// Continuous loop until we find some work here. The timer lock is the lock
+// of the condition variable, so no wake up can get lost between deciding to
+// sleep and sleeping.
+//
+// Expired jobs are chained through NextJob while the lock is held as they
+// may be rescheduled (i.e. put back in the wheel) as soon as we let go.
+//
+   TimerRings.Lock();
+   do {now = time(0);
+       if ((ep = TimerWheel.Expire(now)))
+          {XrdJob *jfirst = 0, *jlast = 0, *jp;
+           int numjobs = 0;
+           do {jp = static_cast<XrdJob::TimerEnt *>(ep)->Job;
+               ep = ep->Next();
+               if (jlast) jlast->NextJob = jp;
+                  else    jfirst = jp;
+               jlast = jp; numjobs++;
+              } while(ep);
+           TimerRings.UnLock();
+           Schedule(numjobs, jfirst, jlast);
+           TimerRings.Lock();
+           continue;
           }
+       if ((next = TimerWheel.NextTick()) < 0) wtime = 60*60;
+          else wtime = (next > now ? next - now : 1);
+       if (wtime > 60*60) wtime = 60*60;
+       TimerWake = now + wtime;
+       TimerRings.Wait(wtime);
        } while(1);
 }
 
@@ -648,6 +750,170 @@ void XrdScheduler::hireWorker(int dotrace)
       } else if (dotrace) TRACE(SCHED, "Now have " <<num_Workers <<" workers" );
 }
  
+/******************************************************************************/
+/*                              R u n Q P i c k                               */
+/******************************************************************************/
+
+XrdSchedulerQueue *XrdScheduler::RunQPick()
+{
+   unsigned int qNum;
+   long myQ;
+
+// Workers place jobs in their own queue so that related work stays local.
+// Anyone else (e.g. poller threads) spreads the jobs round-robin.
+//
+   if ((myQ = (long)pthread_getspecific(RunQKey))) return &RunQ[myQ-1];
+
+   AtomicBeg(SchedMutex);
+   AtomicFAdd(qNum, rrRunQ, 1);
+   AtomicEnd(SchedMutex);
+   return &RunQ[qNum % numRunQ];
+}
+
+/******************************************************************************/
+/*                              R u n Q P o s t                               */
+/******************************************************************************/
+
+void XrdScheduler::RunQPost(XrdSchedulerQueue *qP, int numjobs,
+                            XrdJob *jfirst, XrdJob *jlast)
+{
+   int inQ;
+
+// Place the jobs in the queue. Only that queue's lock is needed.
+//
+   qP->Put(numjobs, jfirst, jlast);
+
+// Calculate statistics (the maximum length is only approximate)
+//
+   AtomicBeg(SchedMutex);
+   AtomicAdd(num_Jobs, numjobs);
+   AtomicFAdd(inQ, num_JobsinQ, numjobs);
+   AtomicEnd(SchedMutex);
+   if (inQ+numjobs > max_QLength) max_QLength = inQ+numjobs;
+
+// Indicate number of jobs to work on
+//
+   while(numjobs--) WorkAvail.Post();
+}
+
+/******************************************************************************/
+/*                             R u n Q S t a t s                              */
+/******************************************************************************/
+
+int XrdScheduler::RunQStats(char *buff, int blen)
+{
+   static char hdrfmt[] = "<rq><num>%d</num>";
+   static char qfmt[]   = "<q id=\"%d\"><inq>%d</inq><maxinq>%d</maxinq>"
+                          "<jobs>%lld</jobs><stolen>%lld</stolen>"
+                          "<avgwt>%lld</avgwt><maxwt>%lld</maxwt></q>";
+   static char trlfmt[] = "<steals>%lld</steals></rq>";
+   XrdSchedulerQueue *qP;
+   long long numStolen = 0, numPost, numWait, maxWait, qStolen;
+   int i, n, inQ, maxQ;
+
+// If only length wanted, do so
+//
+   if (!buff) return sizeof(hdrfmt) + 16 + sizeof(trlfmt) + 24
+                   + numRunQ*(sizeof(qfmt) + 16*2 + 24*4);
+
+// Format the header
+//
+   n = snprintf(buff, blen, hdrfmt, numRunQ);
+
+// Format each queue (avgwt and maxwt are in microseconds)
+//
+   for (i = 0; i < numRunQ && n < blen; i++)
+       {qP = &RunQ[i];
+        qP->qMutex.Lock();
+        inQ = qP->inQ; maxQ = qP->maxQ; numPost = qP->numPost;
+        qStolen = qP->numStolen; maxWait = qP->maxWait;
+        numWait = (numPost > qP->inQ ? qP->totWait/(numPost - qP->inQ) : 0);
+        qP->qMutex.UnLock();
+        numStolen += qStolen;
+        n += snprintf(buff+n, blen-n, qfmt, i, inQ, maxQ, numPost, qStolen,
+                      numWait, maxWait);
+       }
+
+// Format the trailer and return
+//
+   if (n >= blen) return n;
+   return n + snprintf(buff+n, blen-n, trlfmt, numStolen);
+}
+
+/******************************************************************************/
+/*                              R u n S t e a l                               */
+/******************************************************************************/
+
+void XrdScheduler::RunSteal()
+{
+   XrdSchedulerQueue *myRQ;
+   XrdJob *jp;
+   int i, myQ, waiting, tries;
+
+// Grab a run queue for this worker and remember it for Schedule()
+//
+   AtomicBeg(SchedMutex);
+   AtomicFAdd(myQ, nextRunQ, 1);
+   AtomicEnd(SchedMutex);
+   myQ = static_cast<unsigned int>(myQ) % numRunQ;
+   myRQ = &RunQ[myQ];
+   pthread_setspecific(RunQKey, (void *)(long)(myQ+1));
+
+// Wait for work then do it (an endless task for a worker thread). Each post
+// of the semaphore corresponds to a job placed in some queue. We first look
+// at our own queue and then steal from the others. A job may be taken by
+// another worker while we scan, so we rescan a few times before giving up.
+//
+   do {do {AtomicBeg(DispatchMutex);
+           AtomicInc(idl_Workers);
+           AtomicEnd(DispatchMutex);
+           WorkAvail.Wait();
+           AtomicBeg(DispatchMutex);
+           AtomicFSub(waiting, idl_Workers, 1);
+           AtomicEnd(DispatchMutex);
+           waiting--;
+           for (tries = 0; tries < 3; tries++)
+               {if ((jp = myRQ->Get(false))) break;
+                for (i = 1; i < numRunQ; i++)
+                    {XrdSchedulerQueue *qP = &RunQ[(myQ+i) % numRunQ];
+                     if (qP->inQ && (jp = qP->Get(true))) break;
+                    }
+                if (jp) break;
+                SchedMutex.Lock();
+                if (num_Layoffs > 0)
+                   {num_Layoffs--;
+                    if (waiting)
+                       {num_TDestroy++; num_Workers--;
+                        TRACE(SCHED, "terminating thread; workers=" <<num_Workers);
+                        SchedMutex.UnLock();
+                        return;
+                       }
+                    SchedMutex.UnLock();
+                    break;
+                   }
+                SchedMutex.UnLock();
+                sched_yield();
+               }
+          } while(!jp);
+
+    // Adjust the queue count
+    //
+       AtomicBeg(SchedMutex);
+       AtomicDec(num_JobsinQ);
+       AtomicEnd(SchedMutex);
+
+    // Check if we should hire a new worker (we always want 1 idle thread)
+    // before running this job.
+    //
+       if (!waiting) hireWorker();
+       if (TRACING(TRACE_SCHED) && *(jp->Comment) != '.')
+          {TRACE(SCHED, "running " <<jp->Comment <<" rq=" <<myQ
+                        <<" inq=" <<num_JobsinQ);
+          }
+       jp->DoIt();
+      } while(1);
+}
+
 /******************************************************************************/
 /*                             t r a c e E x i t                              */
 /******************************************************************************/
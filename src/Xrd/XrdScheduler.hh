@@ -34,9 +34,11 @@
 
 #include "XrdSys/XrdSysPthread.hh"
 #include "Xrd/XrdJob.hh"
+#include "XrdSys/XrdSysTimerWheel.hh"
 
 class XrdOucTrace;
 class XrdSchedulerPID;
+class XrdSchedulerQueue;
 class XrdSysError;
 
 #define MAX_SCHED_PROCS 30000
@@ -66,6 +68,12 @@ void          Schedule(XrdJob *jp, time_t atime);
 
 void          setParms(int minw, int maxw, int avlt, int maxi, int once=0);
 
+// setQueues() enables the work stealing mode where each worker thread is
+// assigned one of nq run queues and idle workers steal from other queues.
+// It must be called before Start(); a value less than 2 uses a single queue.
+//
+void          setQueues(int nq);
+
 void          Start();
 
 int           Stats(char *buff, int blen, int do_sync=0);
@@ -107,15 +115,26 @@ XrdJob                *WorkLast;
 XrdSysSemaphore        WorkAvail;
 XrdSysMutex            SchedMutex; // Protects private area
 
-XrdJob                *TimerQueue; // Pending work
-XrdSysCondVar          TimerRings;
-XrdSysMutex            TimerMutex; // Protects scheduler area
+XrdSysTimerWheel       TimerWheel; // Pending work by time (in seconds)
+time_t                 TimerWake;  // When the timer thread wakes up next
+XrdSysCondVar          TimerRings; // Protects the above area
 
 XrdSchedulerPID       *firstPID;
 XrdSysMutex            ReaperMutex;
 
+XrdSchedulerQueue     *RunQ;       // Per worker run queues (work stealing)
+int                    numRunQ;    // Number of run queues (0 -> single q)
+int                    nextRunQ;   // Queue for the next hired worker
+int                    rrRunQ;     // Queue for the next job from non-workers
+pthread_key_t          RunQKey;    // Run queue number + 1 of the worker
+
 void hireWorker(int dotrace=1);
 void Monitor();
+void RunQPost(XrdSchedulerQueue *qP, int numjobs, XrdJob *jfirst,
+              XrdJob *jlast);
+void RunSteal();
+XrdSchedulerQueue *RunQPick();
+int  RunQStats(char *buff, int blen);
 void traceExit(pid_t pid, int status);
 static const char *TraceID;
 };
@@ -71,6 +71,7 @@ XrdScheduler *XrdSendQ::Sched = 0;
 XrdSysError  *XrdSendQ::Say   = 0;
 unsigned int  XrdSendQ::qWarn = 3;
 unsigned int  XrdSendQ::qMax  = 0xffffffff;
+unsigned int  XrdSendQ::qFast = 0;
 bool          XrdSendQ::qPerm = false;
 
 /******************************************************************************/
@@ -80,9 +81,13 @@ bool          XrdSendQ::qPerm = false;
 XrdSendQ::XrdSendQ(XrdLink &lP, XrdSysMutex &mP)
                   : XrdJob("sendQ runner"),
                     mLink(lP), wMutex(mP),
-                    fMsg(0), lMsg(0), delQ(0), theFD(lP.FDnum()),
+                    delQ(0), theFD(lP.FDnum()),
                     inQ(0), qWmsg(qWarn), discards(0),
-                    active(false), terminate(false) {}
+                    active(false), terminate(false)
+{
+   fMsg[qFQ] = lMsg[qFQ] = 0;
+   fMsg[qNQ] = lMsg[qNQ] = 0;
+}
   
 /******************************************************************************/
 /*                                  D o I t                                   */
@@ -91,7 +96,7 @@ XrdSendQ::XrdSendQ(XrdLink &lP, XrdSysMutex &mP)
 void XrdSendQ::DoIt()
 {
    mBuff   *theMsg;
-   int      myFD, rc;
+   int      myFD, qX, rc;
    bool     theEnd;
 
 // Obtain the lock
@@ -102,10 +107,14 @@ void XrdSendQ::DoIt()
 //
    if (delQ) {RelMsgs(delQ); delQ = 0;}
 
-// Send all queued messages (we can use a blocking send here)
+// Send all queued messages (we can use a blocking send here). The fast queue
+// is looked at before each message so that small messages need not wait for
+// all of the large ones queued ahead of them.
 //
-   while(!terminate && (theMsg = fMsg))
-        {if (!(fMsg = fMsg->next)) lMsg = 0;
+   while(!terminate && (fMsg[qFQ] || fMsg[qNQ]))
+        {qX = (fMsg[qFQ] ? qFQ : qNQ);
+         theMsg = fMsg[qX];
+         if (!(fMsg[qX] = theMsg->next)) lMsg[qX] = 0;
          inQ--; myFD = theFD;
          wMutex.UnLock();
          rc = send(myFD, theMsg->mData, theMsg->mLen, 0);
@@ -117,7 +126,10 @@ void XrdSendQ::DoIt()
 // Before we exit check if we should delete any messages
 //
    if (delQ) {RelMsgs(delQ); delQ = 0;}
-   if ((theEnd = terminate) && fMsg) RelMsgs(fMsg);
+   if ((theEnd = terminate))
+      {if (fMsg[qFQ]) RelMsgs(fMsg[qFQ]);
+       if (fMsg[qNQ]) RelMsgs(fMsg[qNQ]);
+      }
    active = false;
    qWmsg  = qWarn;
 
@@ -133,8 +145,10 @@ void XrdSendQ::DoIt()
 /* Private:                         Q M s g                                   */
 /******************************************************************************/
   
-bool XrdSendQ::QMsg(XrdSendQ::mBuff *theMsg)
+bool XrdSendQ::QMsg(XrdSendQ::mBuff *theMsg, bool isPart)
 {
+   int qX;
+
 // Check if we reached the max number of messages
 //
    if (inQ >= qMax)
@@ -149,12 +163,15 @@ bool XrdSendQ::QMsg(XrdSendQ::mBuff *theMsg)
        return false;
       }
 
-// Add the message at the end of the queue
+// Add the message at the end of its queue. The rest of a partially sent
+// message must go out before anything else. This is assured as it is only
+// queued when no thread is running the queue (i.e. both queues are empty).
 //
+   qX = (isPart || (unsigned int)theMsg->mLen <= qFast ? qFQ : qNQ);
    theMsg->next = 0;
-   if (lMsg) lMsg->next = theMsg;
-      else   fMsg       = theMsg;
-   lMsg = theMsg;
+   if (lMsg[qX]) lMsg[qX]->next = theMsg;
+      else       fMsg[qX]       = theMsg;
+   lMsg[qX] = theMsg;
    inQ++;
 
 // If there is no active thread handling this queue, schedule one
@@ -202,12 +219,13 @@ void XrdSendQ::Scuttle() // qMutex must be locked!
 {
 // Simply move any outsanding messages to the deletion queue
 //
-   if (fMsg)
-      {lMsg->next = delQ;
-       delQ = fMsg;
-       fMsg = lMsg = 0;
-       inQ  = 0;
-      }
+   for (int qX = qFQ; qX <= qNQ; qX++)
+       if (fMsg[qX])
+          {lMsg[qX]->next = delQ;
+           delQ = fMsg[qX];
+           fMsg[qX] = lMsg[qX] = 0;
+          }
+   inQ = 0;
 }
 
 /******************************************************************************/
@@ -241,7 +259,7 @@ int XrdSendQ::Send(const char *buff, int blen)
 
 // Queue the message.
 //
-   return (QMsg(theMsg) ? blen : -1);
+   return (QMsg(theMsg, bsent != 0) ? blen : -1);
 }
 
 /******************************************************************************/
@@ -299,7 +317,7 @@ int XrdSendQ::Send(const struct iovec *iov, int iovcnt, int iotot)
 
 // Queue the message.
 //
-   return (QMsg(theMsg) ? iotot : 0);
+   return (QMsg(theMsg, !active) ? iotot : 0);
 }
 
 /******************************************************************************/
@@ -396,7 +414,8 @@ void XrdSendQ::Terminate(XrdLink *lP)
        terminate = true;
        theFD     =-1;
       } else {
-       if (fMsg) {RelMsgs(fMsg); fMsg = lMsg = 0;}
+       if (fMsg[qFQ]) RelMsgs(fMsg[qFQ]);
+       if (fMsg[qNQ]) RelMsgs(fMsg[qNQ]);
        if (delQ) {RelMsgs(delQ); delQ = 0;}
        delete this;
       }
@@ -55,6 +55,8 @@ static   void Init(XrdSysError *eP, XrdScheduler *sP) {Say = eP; Sched = sP;}
 
 static   void SetAQ(bool onoff)         {qPerm = onoff;}
 
+static   void SetQF(unsigned int qfVal) {qFast = qfVal;}
+
 static   void SetQM(unsigned int qmVal) {qMax  = qmVal;}
 
 static   void SetQW(unsigned int qwVal) {qWarn = qwVal;}
@@ -77,7 +79,7 @@ int    mLen;
 char   mData[4]; // Always made long enough
 };
 
-bool     QMsg(mBuff *theMsg);
+bool     QMsg(mBuff *theMsg, bool isPart=false);
 void     RelMsgs(mBuff *mP);
 void     Scuttle();
 
@@ -85,12 +87,19 @@ static XrdScheduler *Sched;
 static XrdSysError  *Say;
 static unsigned int  qWarn;
 static unsigned int  qMax;
+static unsigned int  qFast;
 static bool          qPerm;
 XrdLink             &mLink;
 XrdSysMutex         &wMutex;
 
-mBuff               *fMsg;
-mBuff               *lMsg;
+// Messages no longer than qFast bytes (and the unsent part of a message that
+// was partially sent) go on the fast queue and are sent before any message
+// waiting on the normal queue. Order is kept within each queue.
+//
+static const int     qFQ = 0;
+static const int     qNQ = 1;
+mBuff               *fMsg[2];
+mBuff               *lMsg[2];
 mBuff               *delQ;
 int                  theFD;
 unsigned int         inQ;
@@ -114,7 +114,7 @@ XrdAccPrivs XrdAccAccess::Access(const XrdSecEntity    *Entity,
 
 // Get a shared context for these potentially long running routines
 //
-   Access_Context.Lock(xs_Shared);
+   Access_Context.ReadLock();
 
 // Run through the exclusive list first as only one rule will apply
 //
@@ -122,7 +122,7 @@ XrdAccPrivs XrdAccAccess::Access(const XrdSecEntity    *Entity,
    while (xlP)
          {if (xlP->Applies(Entity))
              {xlP->caps->Privs(caps, path, plen, phash);
-              Access_Context.UnLock(xs_Shared);
+              Access_Context.ReadUnLock();
               return Access(caps, Entity, path, oper);
              }
           xlP = xlP->next;
@@ -214,7 +214,7 @@ XrdAccPrivs XrdAccAccess::Access(const XrdSecEntity    *Entity,
 
 // We are now done with looking at changeable data
 //
-   Access_Context.UnLock(xs_Shared);
+   Access_Context.ReadUnLock();
 
 // Return the privileges as needed
 //
@@ -322,7 +322,7 @@ void XrdAccAccess::SwapTabs(struct XrdAccAccess_Tables &newtab)
 
 // Get an exclusive context to change the table pointers
 //
-   Access_Context.Lock(xs_Exclusive);
+   Access_Context.WriteLock();
 
 // Save the old pointer while replacing it with the new pointer
 //
@@ -347,7 +347,7 @@ void XrdAccAccess::SwapTabs(struct XrdAccAccess_Tables &newtab)
 
 // We can now let loose new table searchers
 //
-   Access_Context.UnLock(xs_Exclusive);
+   Access_Context.WriteUnLock();
 }
 
 /******************************************************************************/
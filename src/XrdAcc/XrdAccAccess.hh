@@ -34,8 +34,8 @@
 #include "XrdAcc/XrdAccAuthorize.hh"
 #include "XrdAcc/XrdAccCapability.hh"
 #include "XrdSec/XrdSecEntity.hh"
-#include "XrdOuc/XrdOucHash.hh"
-#include "XrdSys/XrdSysXSLock.hh"
+#include "XrdOuc/XrdOucOAHash.hh"
+#include "XrdSys/XrdSysDRWLock.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 
 /******************************************************************************/
@@ -81,20 +81,20 @@ struct XrdAccAccess_ID
        };
   
 struct XrdAccAccess_Tables
-       {XrdOucHash<XrdAccCapability> *G_Hash;  // Groups
-        XrdOucHash<XrdAccCapability> *H_Hash;  // Hosts
-        XrdOucHash<XrdAccCapability> *N_Hash;  // Netgroups
-        XrdOucHash<XrdAccCapability> *O_Hash;  // Organizations
-        XrdOucHash<XrdAccCapability> *R_Hash;  // Roles
-        XrdOucHash<XrdAccAccess_ID>  *S_Hash;  // Sets
-        XrdOucHash<XrdAccCapability> *T_Hash;  // Templates
-        XrdOucHash<XrdAccCapability> *U_Hash;  // Users
-                  XrdAccCapName     *D_List;  // Domains
-                  XrdAccCapName     *E_List;  // Domains (end of list)
-                  XrdAccCapability  *X_List;  // Fungable capbailities
-                  XrdAccCapability  *Z_List;  // Default  capbailities
-                  XrdAccAccess_ID   *SXList;  // 's' exclusive list
-                  XrdAccAccess_ID   *SYList;  // 's' inclusive list
+       {XrdOucOAHash<XrdAccCapability> *G_Hash;  // Groups
+        XrdOucOAHash<XrdAccCapability> *H_Hash;  // Hosts
+        XrdOucOAHash<XrdAccCapability> *N_Hash;  // Netgroups
+        XrdOucOAHash<XrdAccCapability> *O_Hash;  // Organizations
+        XrdOucOAHash<XrdAccCapability> *R_Hash;  // Roles
+        XrdOucOAHash<XrdAccAccess_ID>  *S_Hash;  // Sets
+        XrdOucOAHash<XrdAccCapability> *T_Hash;  // Templates
+        XrdOucOAHash<XrdAccCapability> *U_Hash;  // Users
+                    XrdAccCapName     *D_List;  // Domains
+                    XrdAccCapName     *E_List;  // Domains (end of list)
+                    XrdAccCapability  *X_List;  // Fungable capbailities
+                    XrdAccCapability  *Z_List;  // Default  capbailities
+                    XrdAccAccess_ID   *SXList;  // 's' exclusive list
+                    XrdAccAccess_ID   *SYList;  // 's' inclusive list
 
         XrdAccAccess_Tables() {G_Hash = 0; H_Hash = 0; N_Hash = 0;
                                O_Hash = 0; R_Hash = 0;
@@ -162,7 +162,7 @@ XrdAccPrivs Access(      XrdAccPrivCaps  &caps,
 
 struct XrdAccAccess_Tables Atab;
 
-XrdSysXSLock Access_Context;
+XrdSysDRWLock Access_Context;
 
 XrdAccAudit *Auditor;
 };
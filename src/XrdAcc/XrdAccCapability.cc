@@ -28,6 +28,11 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <algorithm>
+#include <limits.h>
+#include <unordered_map>
+#include <vector>
+
 #include "XrdAcc/XrdAccCapability.hh"
 
 /******************************************************************************/
@@ -36,6 +41,38 @@
   
 extern unsigned long XrdOucHashVal2(const char *KeyVal, int KeyLen);
 
+/******************************************************************************/
+/*                 S t r u c t   X r d A c c C a p I n d e x                  */
+/******************************************************************************/
+
+// The first capability in list order whose path is a prefix of the target path
+// applies. The index finds the earliest such plain capability by looking up
+// the target's prefix at each path length present in the list; the prefix
+// hash is computed incrementally so the target is only hashed once. Template
+// references cannot be indexed and are checked in order, but only those that
+// come before the best plain capability.
+//
+struct XrdAccCapIndex
+{
+struct Ent {XrdAccCapability *cap; int pos;};
+
+typedef std::unordered_multimap<unsigned long long, Ent> pathMap;
+
+pathMap          Paths;
+std::vector<int> Lens;     // Distinct path lengths, ascending
+std::vector<Ent> Tmps;     // Template references in list order
+};
+
+namespace
+{
+const unsigned long long hInit = 14695981039346656037ULL;
+
+inline unsigned long long hNext(unsigned long long hval, char c)
+{
+   return (hval ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+}
+}
+
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -46,7 +83,7 @@ XrdAccCapability::XrdAccCapability(char *pathval, XrdAccPrivCaps &privval)
 
 // Do common initialization
 //
-   next = 0; ctmp = 0;
+   next = 0; ctmp = 0; cidx = 0;
    priv.pprivs = privval.pprivs; priv.nprivs = privval.nprivs;
    plen = strlen(pathval); pins = 0; prem = 0;
    pkey = XrdOucHashVal2((const char *)pathval, plen);
@@ -71,10 +108,47 @@ XrdAccCapability::~XrdAccCapability()
      XrdAccCapability *cp, *np = next;
 
      if (path) {free(path); path = 0;}
+     if (cidx) {delete cidx; cidx = 0;}
 
      while(np) {cp = np; np = np->next; cp->next = 0; delete cp;}
      next = 0;
 }
+/******************************************************************************/
+/*                                 I n d e x                                  */
+/******************************************************************************/
+
+void XrdAccCapability::Index()
+{
+   static const int minCaps = 16;
+   XrdAccCapability *cp;
+   XrdAccCapIndex::Ent ent;
+   unsigned long long hval;
+   int i, n = 0;
+
+// Short lists are faster to scan
+//
+   for (cp = this; cp; cp = cp->next) n++;
+   if (n < minCaps || cidx) return;
+
+// Index each capability by its path or, for template references, its order
+//
+   cidx = new XrdAccCapIndex;
+   for (cp = this, n = 0; cp; cp = cp->next, n++)
+       {ent.cap = cp; ent.pos = n;
+        if (cp->ctmp) {cidx->Tmps.push_back(ent); continue;}
+        for (hval = hInit, i = 0; i < cp->plen; i++)
+            hval = hNext(hval, cp->path[i]);
+        cidx->Paths.insert(std::make_pair(hval, ent));
+        cidx->Lens.push_back(cp->plen);
+       }
+
+// Keep only distinct lengths
+//
+   std::sort(cidx->Lens.begin(), cidx->Lens.end());
+   cidx->Lens.erase(std::unique(cidx->Lens.begin(), cidx->Lens.end()),
+                    cidx->Lens.end());
+}
+
 /******************************************************************************/
 /*                                 P r i v s                                  */
 /******************************************************************************/
@@ -87,6 +161,8 @@ int XrdAccCapability::Privs(      XrdAccPrivCaps &pathpriv,
 {XrdAccCapability *cp=this;
  const int psl = (pathsub ? strlen(pathsub) : 0);
 
+ if (cidx && !pathsub) return Lookup(pathpriv, pathname, pathlen, pathhash);
+
  do {if (cp->ctmp)
        {if (cp->ctmp->Privs(pathpriv,pathname,pathlen,pathhash,pathsub))
            return 1;
@@ -131,6 +207,50 @@ int XrdAccCapability::Subcomp(const char *pathname, const int pathlen,
    return 1;
 }
 
+/******************************************************************************/
+/* Private:                       L o o k u p                                 */
+/******************************************************************************/
+
+int XrdAccCapability::Lookup(      XrdAccPrivCaps &pathpriv,
+                             const char           *pathname,
+                             const int             pathlen,
+                             const unsigned long   pathhash)
+{
+   std::pair<XrdAccCapIndex::pathMap::iterator,
+             XrdAccCapIndex::pathMap::iterator> range;
+   XrdAccCapIndex::pathMap::iterator pP;
+   std::vector<int>::iterator lP;
+   std::vector<XrdAccCapIndex::Ent>::iterator tP;
+   XrdAccCapability *best = 0;
+   unsigned long long hval = hInit;
+   int i = 0, bpos = INT_MAX;
+
+// Find the earliest plain capability whose path prefixes the target path
+//
+   for (lP = cidx->Lens.begin(); lP != cidx->Lens.end() && *lP <= pathlen; ++lP)
+       {while(i < *lP) hval = hNext(hval, pathname[i++]);
+        range = cidx->Paths.equal_range(hval);
+        for (pP = range.first; pP != range.second; ++pP)
+            {if (pP->second.pos < bpos && pP->second.cap->plen == *lP
+             &&  !strncmp(pathname, pP->second.cap->path, *lP))
+                {bpos = pP->second.pos; best = pP->second.cap;}
+            }
+       }
+
+// Template references that precede it are checked first, as a scan would
+//
+   for (tP = cidx->Tmps.begin(); tP != cidx->Tmps.end() && tP->pos < bpos; ++tP)
+       if (tP->cap->ctmp->Privs(pathpriv, pathname, pathlen, pathhash))
+          return 1;
+
+// Add in the privileges of the best match, if any
+//
+   if (!best) return 0;
+   pathpriv.pprivs = (XrdAccPrivs)(pathpriv.pprivs | best->priv.pprivs);
+   pathpriv.nprivs = (XrdAccPrivs)(pathpriv.nprivs | best->priv.nprivs);
+   return 1;
+}
+
 /******************************************************************************/
 /*                         X r d A c c C a p N a m e                          */
 /******************************************************************************/
@@ -39,12 +39,20 @@
 /******************************************************************************/
 /*                      X r d A c c C a p a b i l i t y                       */
 /******************************************************************************/
+
+struct XrdAccCapIndex;
   
 class XrdAccCapability
 {
 public:
 void                Add(XrdAccCapability *newcap) {next = newcap;}
 
+// Index() indexes the capability list starting with this capability by path
+// so that Privs() need not scan it. It should be called on the head of the
+// list once the list is complete. Short lists are not indexed.
+//
+void                Index();
+
 XrdAccCapability   *Next() {return next;}
 
 // Privs() searches the associated capability for a prefix matching path. If one
@@ -79,14 +87,20 @@ int                 Subcomp(const char *pathname, const int pathlen,
                   XrdAccCapability(char *pathval, XrdAccPrivCaps &privval);
 
                   XrdAccCapability(XrdAccCapability *taddr)
-                        {next = 0; ctmp = taddr;
+                        {next = 0; ctmp = taddr; cidx = 0;
                          pkey = 0; path = 0; plen = 0; pins = 0; prem = 0;
                         }
 
                  ~XrdAccCapability();
 private:
+int               Lookup(      XrdAccPrivCaps &pathpriv,
+                         const char           *pathname,
+                         const int             pathlen,
+                         const unsigned long   pathhash);
+
 XrdAccCapability *next;      // -> Next capability
 XrdAccCapability *ctmp;      // -> Capability template
+XrdAccCapIndex   *cidx;      // -> Path index (list head only)
 
 /*----------- The below fields are valid when template is zero -----------*/
 
@@ -186,13 +186,13 @@ int XrdAccConfig::ConfigDB(int Warm, XrdSysError &Eroute)
 
 // Allocate new hash tables
 //
-   if (!(tabs.G_Hash = new XrdOucHash<XrdAccCapability>()) ||
-       !(tabs.H_Hash = new XrdOucHash<XrdAccCapability>()) ||
-       !(tabs.N_Hash = new XrdOucHash<XrdAccCapability>()) ||
-       !(tabs.O_Hash = new XrdOucHash<XrdAccCapability>()) ||
-       !(tabs.R_Hash = new XrdOucHash<XrdAccCapability>()) ||
-       !(tabs.T_Hash = new XrdOucHash<XrdAccCapability>()) ||
-       !(tabs.U_Hash = new XrdOucHash<XrdAccCapability>()) )
+   if (!(tabs.G_Hash = new XrdOucOAHash<XrdAccCapability>()) ||
+       !(tabs.H_Hash = new XrdOucOAHash<XrdAccCapability>()) ||
+       !(tabs.N_Hash = new XrdOucOAHash<XrdAccCapability>()) ||
+       !(tabs.O_Hash = new XrdOucOAHash<XrdAccCapability>()) ||
+       !(tabs.R_Hash = new XrdOucOAHash<XrdAccCapability>()) ||
+       !(tabs.T_Hash = new XrdOucOAHash<XrdAccCapability>()) ||
+       !(tabs.U_Hash = new XrdOucOAHash<XrdAccCapability>()) )
       {Eroute.Emsg("ConfigDB","Insufficient storage for id tables.");
        Database->Close(); return 1;
       }
@@ -585,7 +585,7 @@ int XrdAccConfig::ConfigDBrec(XrdSysError &Eroute,
     int alluser = 0, anyuser = 0, domname = 0, NoGo = 0;
     DB_RecType rectype;
     XrdAccAccess_ID *sp = 0;
-    XrdOucHash<XrdAccCapability> *hp;
+    XrdOucOAHash<XrdAccCapability> *hp;
     XrdAccGroupType gtype = XrdAccNoGroup;
     XrdAccPrivCaps xprivs;
     XrdAccCapability mycap((char *)"", xprivs), *currcap, *lastcap = &mycap;
@@ -699,8 +699,9 @@ int XrdAccConfig::ConfigDBrec(XrdSysError &Eroute,
        return -1;
       }
 
-   // Insert the capability into the appropriate table/list
+   // Index long capability lists and insert them into the appropriate table
    //
+   mycap.Next()->Index();
         if (sp) sp->caps = mycap.Next();
    else if (domname)
            {if (!(ncp = new XrdAccCapName(authid, mycap.Next())))
@@ -826,7 +827,7 @@ int XrdAccConfig::idDef(XrdSysError &Eroute,
 
 // Make sure this name has not been specified before
 //
-   if (!tabs.S_Hash) tabs.S_Hash = new XrdOucHash<XrdAccAccess_ID>;
+   if (!tabs.S_Hash) tabs.S_Hash = new XrdOucOAHash<XrdAccAccess_ID>;
       else if (tabs.S_Hash->Find(theID.name))
               {Eroute.Emsg("ConfigXeq","duplicate id definition -",theID.name);
                return -1;
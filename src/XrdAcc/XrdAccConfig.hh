@@ -34,7 +34,7 @@
 
 #include "XrdOuc/XrdOuca2x.hh"
 #include "XrdSys/XrdSysError.hh"
-#include "XrdOuc/XrdOucHash.hh"
+#include "XrdOuc/XrdOucOAHash.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdOuc/XrdOucStream.hh"
 #include "XrdAcc/XrdAccAccess.hh"
@@ -91,7 +91,7 @@ XrdAccGroups::XrdAccGroups()
 char *XrdAccGroups::AddName(const XrdAccGroupType gtype, const char *name)
 {
    char *np;
-   XrdOucHash<char> *hp;
+   XrdOucOAHash<char> *hp;
 
 // Prepare to add a group name
 //
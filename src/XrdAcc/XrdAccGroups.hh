@@ -33,7 +33,7 @@
 #include <grp.h>
 #include <limits.h>
 
-#include "XrdOuc/XrdOucHash.hh"
+#include "XrdOuc/XrdOucOAHash.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
 /******************************************************************************/
@@ -166,9 +166,9 @@ int         HaveNetGroups;
 XrdSysMutex  Group_Build_Context, Group_Name_Context;
 XrdSysMutex  Group_Cache_Context, NetGroup_Cache_Context;
 
-XrdOucHash<XrdAccGroupList> NetGroup_Cache;
-XrdOucHash<XrdAccGroupList>    Group_Cache;
-XrdOucHash<char>               Group_Names;
-XrdOucHash<char>            NetGroup_Names;
+XrdOucOAHash<XrdAccGroupList> NetGroup_Cache;
+XrdOucOAHash<XrdAccGroupList>    Group_Cache;
+XrdOucOAHash<char>               Group_Names;
+XrdOucOAHash<char>            NetGroup_Names;
 };
 #endif
@@ -5,6 +5,7 @@ include( XRootDCommon )
 # Modules
 #-------------------------------------------------------------------------------
 set( LIB_XRDCL_PROXY_PLUGIN XrdClProxyPlugin-${PLUGIN_VERSION} )
+set( LIB_XRDCL_BLOCKCACHE_PLUGIN XrdClBlockCachePlugin-${PLUGIN_VERSION} )
 
 #-------------------------------------------------------------------------------
 # Shared library version
@@ -159,6 +160,30 @@ set_target_properties(
   INTERFACE_LINK_LIBRARIES ""
   LINK_INTERFACE_LIBRARIES "" )
 
+#-------------------------------------------------------------------------------
+# XrdClBlockCachePlugin library, needs robust process shared mutexes
+#-------------------------------------------------------------------------------
+if( NOT MacOSX )
+  add_library(
+    ${LIB_XRDCL_BLOCKCACHE_PLUGIN}
+    MODULE
+    XrdApps/XrdClBlockCachePlugin/BlockCachePlugin.cc
+    XrdApps/XrdClBlockCachePlugin/BlockCacheFile.cc
+    XrdApps/XrdClBlockCachePlugin/BlockCacheStore.cc)
+
+  target_link_libraries(${LIB_XRDCL_BLOCKCACHE_PLUGIN} XrdCl XrdUtils pthread)
+
+  set_target_properties(
+    ${LIB_XRDCL_BLOCKCACHE_PLUGIN}
+    PROPERTIES
+    INTERFACE_LINK_LIBRARIES ""
+    LINK_INTERFACE_LIBRARIES "" )
+
+  install(
+    TARGETS ${LIB_XRDCL_BLOCKCACHE_PLUGIN}
+    LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR} )
+endif()
+
 #-------------------------------------------------------------------------------
 # Install
 #-------------------------------------------------------------------------------
@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#include "BlockCacheFile.hh"
+#include "BlockCacheStore.hh"
+#include "XrdCl/XrdClJobManager.hh"
+#include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClLog.hh"
+#include "XrdCl/XrdClURL.hh"
+#include <sstream>
+
+namespace
+{
+using namespace xrdcl_blockcache;
+
+//------------------------------------------------------------------------------
+// Fetches missing blocks from the underlying file
+//------------------------------------------------------------------------------
+class FileFetcher: public BlockFetcher
+{
+public:
+  FileFetcher(XrdCl::File* file, uint16_t timeout):
+    pFile(file), mTimeout(timeout)
+  {}
+
+  virtual XrdCl::XRootDStatus Fetch(uint64_t offset, uint32_t size,
+                                    char* buffer, uint32_t& bytesRead)
+  {
+    return pFile->Read(offset, size, buffer, bytesRead, mTimeout);
+  }
+
+private:
+  XrdCl::File* pFile;
+  uint16_t     mTimeout;
+};
+
+//------------------------------------------------------------------------------
+// Runs a cached read on a worker, waiting for a block fetched by another
+// process must not tie up the client's own workers
+//------------------------------------------------------------------------------
+class ReadJob: public XrdCl::Job
+{
+public:
+  ReadJob(BlockCacheFile* file, uint64_t offset, uint32_t size, void* buffer,
+          XrdCl::ResponseHandler* handler, uint16_t timeout):
+    pFile(file), mOffset(offset), mSize(size), pBuffer(buffer),
+    pHandler(handler), mTimeout(timeout)
+  {}
+
+  virtual void Run(void* arg)
+  {
+    uint32_t bytesRead = 0;
+    XrdCl::XRootDStatus st = pFile->CachedRead(mOffset, mSize, (char*)pBuffer,
+                                               bytesRead, mTimeout);
+    XrdCl::AnyObject* response = 0;
+
+    if (st.IsOK()) {
+      response = new XrdCl::AnyObject();
+      response->Set(new XrdCl::ChunkInfo(mOffset, bytesRead, pBuffer));
+    }
+
+    pHandler->HandleResponse(new XrdCl::XRootDStatus(st), response);
+    delete this;
+  }
+
+private:
+  BlockCacheFile*         pFile;
+  uint64_t                mOffset;
+  uint32_t                mSize;
+  void*                   pBuffer;
+  XrdCl::ResponseHandler* pHandler;
+  uint16_t                mTimeout;
+};
+}
+
+namespace xrdcl_blockcache
+{
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+BlockCacheFile::BlockCacheFile(BlockCacheStore* store, XrdCl::JobManager* jobs):
+  pFile(0),
+  pStore(store),
+  pJobs(jobs),
+  mKey(0),
+  mSize(0),
+  mIsOpen(false),
+  mCacheable(false),
+  mKeySet(false)
+{}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+BlockCacheFile::~BlockCacheFile()
+{
+  if (pFile) {
+    delete pFile;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Open
+//------------------------------------------------------------------------------
+XRootDStatus
+BlockCacheFile::Open(const std::string& url,
+                     OpenFlags::Flags flags,
+                     Access::Mode mode,
+                     ResponseHandler* handler,
+                     uint16_t timeout)
+{
+  XRootDStatus st;
+
+  if (mIsOpen) {
+    st = XRootDStatus(stError, errInvalidOp);
+    return st;
+  }
+
+  // Only files that nobody can change through us are cached. The opaque
+  // part of the URL is left out of the key, it usually carries tokens that
+  // differ from one job to the next.
+  //
+  const int update = OpenFlags::Delete | OpenFlags::New | OpenFlags::Append |
+                     OpenFlags::Update | OpenFlags::Write;
+  XrdCl::URL u(url);
+  mUrl = u.GetHostId() + "/" + u.GetPath();
+  mCacheable = pStore && !(flags & update);
+
+  pFile = new XrdCl::File(false);
+  st = pFile->Open(url, flags, mode, handler, timeout);
+
+  if (st.IsOK()) {
+    mIsOpen = true;
+  }
+
+  return st;
+}
+
+//------------------------------------------------------------------------------
+// Read
+//------------------------------------------------------------------------------
+XRootDStatus
+BlockCacheFile::Read(uint64_t         offset,
+                     uint32_t         size,
+                     void*            buffer,
+                     ResponseHandler* handler,
+                     uint16_t         timeout)
+{
+  if (!mCacheable) {
+    return pFile->Read(offset, size, buffer, handler, timeout);
+  }
+
+  pJobs->QueueJob(new ReadJob(this, offset, size, buffer, handler, timeout));
+  return XRootDStatus();
+}
+
+//------------------------------------------------------------------------------
+// Read through the cache
+//------------------------------------------------------------------------------
+XRootDStatus
+BlockCacheFile::CachedRead(uint64_t  offset,
+                           uint32_t  size,
+                           char*     buffer,
+                           uint32_t& bytesRead,
+                           uint16_t  timeout)
+{
+  bytesRead = 0;
+
+  if (!SetKey(timeout)) {
+    return pFile->Read(offset, size, buffer, bytesRead, timeout);
+  }
+
+  if (offset >= mSize) {
+    return XRootDStatus();
+  }
+
+  FileFetcher fetcher(pFile, timeout);
+  uint64_t bsz = pStore->BlockSize();
+  uint64_t end = (offset + size < mSize ? offset + size : mSize);
+  uint64_t pos = offset;
+
+  while (pos < end) {
+    uint64_t block = pos / bsz;
+    uint32_t boff  = pos % bsz;
+    uint32_t blen  = (mSize - block * bsz < bsz ? mSize - block * bsz : bsz);
+    uint32_t want  = (end - pos < bsz - boff ? end - pos : bsz - boff);
+    uint32_t got   = 0;
+    XRootDStatus st = pStore->Read(mKey, block, blen, boff, want,
+                                   buffer + (pos - offset), got, fetcher);
+
+    if (!st.IsOK()) {
+      return st;
+    }
+
+    bytesRead += got;
+    pos += got;
+
+    if (got < want) {
+      break;
+    }
+  }
+
+  return XRootDStatus();
+}
+
+//------------------------------------------------------------------------------
+// Derive the cache key of the file
+//------------------------------------------------------------------------------
+bool
+BlockCacheFile::SetKey(uint16_t timeout)
+{
+  XrdSysMutexHelper scopedLock(mMutex);
+
+  if (mKeySet) {
+    return true;
+  }
+
+  StatInfo* info = 0;
+  XRootDStatus st = pFile->Stat(false, info, timeout);
+
+  if (!st.IsOK() || !info) {
+    XrdCl::Log* log = XrdCl::DefaultEnv::GetLog();
+    log->Debug(FileMsg, "Block cache bypassed for %s: %s", mUrl.c_str(),
+               st.ToString().c_str());
+    return false;
+  }
+
+  std::ostringstream key;
+  key << mUrl << '?' << info->GetSize() << ':' << info->GetModTime();
+  mSize   = info->GetSize();
+  mKey    = BlockCacheStore::Hash(key.str());
+  mKeySet = true;
+  delete info;
+  return true;
+}
+
+} // namespace xrdcl_blockcache
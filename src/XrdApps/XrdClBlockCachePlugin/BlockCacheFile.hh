@@ -0,0 +1,216 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#pragma once
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClPlugInInterface.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+using namespace XrdCl;
+
+namespace XrdCl
+{
+class JobManager;
+}
+
+namespace xrdcl_blockcache
+{
+class BlockCacheStore;
+
+//------------------------------------------------------------------------------
+//! XrdClFile plugin that serves the reads of files opened read-only from the
+//! node-local block cache. Everything else goes straight to the file.
+//------------------------------------------------------------------------------
+class BlockCacheFile: public XrdCl::FilePlugIn
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param store cache to use, none if 0
+  //! @param jobs  workers running the cached reads
+  //----------------------------------------------------------------------------
+  BlockCacheFile(BlockCacheStore* store, XrdCl::JobManager* jobs);
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  virtual ~BlockCacheFile();
+
+  //----------------------------------------------------------------------------
+  //! Open
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Open(const std::string& url,
+                            OpenFlags::Flags flags,
+                            Access::Mode mode,
+                            ResponseHandler* handler,
+                            uint16_t timeout);
+
+  //----------------------------------------------------------------------------
+  //! Close
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Close(ResponseHandler* handler,
+                             uint16_t         timeout)
+  {
+    return pFile->Close(handler, timeout);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Stat
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Stat(bool             force,
+                            ResponseHandler* handler,
+                            uint16_t         timeout)
+  {
+    return pFile->Stat(force, handler, timeout);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Read
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Read(uint64_t         offset,
+                            uint32_t         size,
+                            void*            buffer,
+                            ResponseHandler* handler,
+                            uint16_t         timeout);
+
+  //----------------------------------------------------------------------------
+  //! Write
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Write(uint64_t         offset,
+                             uint32_t         size,
+                             const void*      buffer,
+                             ResponseHandler* handler,
+                             uint16_t         timeout)
+  {
+    return pFile->Write(offset, size, buffer, handler, timeout);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Sync
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Sync(ResponseHandler* handler,
+                            uint16_t         timeout)
+  {
+    return pFile->Sync(handler, timeout);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Truncate
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Truncate(uint64_t         size,
+                                ResponseHandler* handler,
+                                uint16_t         timeout)
+  {
+    return pFile->Truncate(size, handler, timeout);
+  }
+
+  //----------------------------------------------------------------------------
+  //! VectorRead
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus VectorRead(const ChunkList& chunks,
+                                  void*            buffer,
+                                  ResponseHandler* handler,
+                                  uint16_t         timeout)
+  {
+    return pFile->VectorRead(chunks, buffer, handler, timeout);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Fcntl
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Fcntl(const Buffer&    arg,
+                             ResponseHandler* handler,
+                             uint16_t         timeout)
+  {
+    return pFile->Fcntl(arg, handler, timeout);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Visa
+  //----------------------------------------------------------------------------
+  virtual XRootDStatus Visa(ResponseHandler* handler,
+                            uint16_t         timeout)
+  {
+    return pFile->Visa(handler, timeout);
+  }
+
+  //----------------------------------------------------------------------------
+  //! IsOpen
+  //----------------------------------------------------------------------------
+  virtual bool IsOpen() const
+  {
+    return pFile->IsOpen();
+  }
+
+  //----------------------------------------------------------------------------
+  //! SetProperty
+  //----------------------------------------------------------------------------
+  virtual bool SetProperty(const std::string& name,
+                           const std::string& value)
+  {
+    return pFile->SetProperty(name, value);
+  }
+
+  //----------------------------------------------------------------------------
+  //! GetProperty
+  //----------------------------------------------------------------------------
+  virtual bool GetProperty(const std::string& name,
+                           std::string& value) const
+  {
+    return pFile->GetProperty(name, value);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Read through the cache, called by the workers
+  //----------------------------------------------------------------------------
+  XRootDStatus CachedRead(uint64_t  offset,
+                          uint32_t  size,
+                          char*     buffer,
+                          uint32_t& bytesRead,
+                          uint16_t  timeout);
+
+private:
+
+  //----------------------------------------------------------------------------
+  //! Derive the cache key of the file from its URL, size and modification
+  //! time, the latter two so that a file that changed is not served stale
+  //! data. Its size is remembered as well.
+  //!
+  //! @return true if the key is known
+  //----------------------------------------------------------------------------
+  bool SetKey(uint16_t timeout);
+
+  XrdCl::File*       pFile;
+  BlockCacheStore*   pStore;
+  XrdCl::JobManager* pJobs;
+  std::string        mUrl;
+  XrdSysMutex        mMutex;
+  uint64_t           mKey;
+  uint64_t           mSize;
+  bool               mIsOpen;
+  bool               mCacheable;
+  bool               mKeySet;
+};
+
+} // namespace xrdcl_blockcache
@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#include "BlockCachePlugin.hh"
+#include "BlockCacheFile.hh"
+#include "BlockCacheStore.hh"
+#include "XrdVersion.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClJobManager.hh"
+#include "XrdCl/XrdClLog.hh"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <cstdio>
+
+XrdVERSIONINFO(XrdClGetPlugIn, XrdClGetPlugIn)
+
+extern "C"
+{
+  void* XrdClGetPlugIn(const void* arg)
+  {
+    const std::map<std::string, std::string>* config =
+      static_cast< const std::map<std::string, std::string>* >(arg);
+    return static_cast<void*>(new xrdcl_blockcache::BlockCacheFactory(config));
+  }
+}
+
+namespace
+{
+//------------------------------------------------------------------------------
+// Get a parameter from the configuration, the environment taking precedence
+//------------------------------------------------------------------------------
+std::string GetParam(const std::map<std::string, std::string>* config,
+                     const char* key, const char* env, const char* dflt)
+{
+  const char* val = getenv(env);
+
+  if (val && *val) {
+    return val;
+  }
+
+  if (config) {
+    std::map<std::string, std::string>::const_iterator it = config->find(key);
+
+    if (it != config->end() && !it->second.empty()) {
+      return it->second;
+    }
+  }
+
+  return dflt;
+}
+
+//------------------------------------------------------------------------------
+// Convert a size with an optional k, m or g suffix, 0 if invalid
+//------------------------------------------------------------------------------
+uint64_t ToSize(const std::string& str)
+{
+  char* end = 0;
+  unsigned long long val = strtoull(str.c_str(), &end, 10);
+
+  if (end == str.c_str()) {
+    return 0;
+  }
+
+  switch (*end) {
+  case 'k': case 'K': val <<= 10; end++; break;
+  case 'm': case 'M': val <<= 20; end++; break;
+  case 'g': case 'G': val <<= 30; end++; break;
+  default: break;
+  }
+
+  return (*end ? 0 : val);
+}
+}
+
+namespace xrdcl_blockcache
+{
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+BlockCacheFactory::BlockCacheFactory(const std::map<std::string, std::string>*
+                                     config):
+  pStore(0), pJobs(0)
+{
+  XrdCl::Log* log = XrdCl::DefaultEnv::GetLog();
+  char dfltPath[64];
+  snprintf(dfltPath, sizeof(dfltPath), "/dev/shm/xrdcl-blockcache-%u",
+           (unsigned int)geteuid());
+  std::string path = GetParam(config, "path", "XRD_BLOCKCACHE_PATH",
+                              dfltPath);
+  std::string size = GetParam(config, "size", "XRD_BLOCKCACHE_SIZE", "512m");
+  std::string bsz  = GetParam(config, "blocksize", "XRD_BLOCKCACHE_BLOCKSIZE",
+                              "256k");
+  std::string thds = GetParam(config, "threads", "XRD_BLOCKCACHE_THREADS",
+                              "4");
+  uint64_t cacheSize = ToSize(size);
+  uint64_t blockSize = ToSize(bsz);
+  int      threads   = atoi(thds.c_str());
+
+  if (!cacheSize || blockSize < 4096 || blockSize > 0x40000000 ||
+      blockSize > cacheSize || threads < 1) {
+    log->Error(1, "Invalid block cache configuration: size=%s blocksize=%s "
+               "threads=%s; caching disabled", size.c_str(), bsz.c_str(),
+               thds.c_str());
+    return;
+  }
+
+  // Waiting for a block that another process is fetching must not hold up
+  // the client's own workers, so cached reads run on workers of our own.
+  //
+  pStore = new BlockCacheStore();
+
+  if (!pStore->Attach(path, cacheSize, blockSize)) {
+    log->Error(1, "Unable to attach block cache %s: %s; caching disabled",
+               path.c_str(), strerror(errno));
+    delete pStore;
+    pStore = 0;
+    return;
+  }
+
+  pJobs = new XrdCl::JobManager(threads);
+
+  if (!pJobs->Initialize() || !pJobs->Start()) {
+    log->Error(1, "Unable to start the block cache workers; caching "
+               "disabled");
+    delete pJobs;
+    pJobs = 0;
+    delete pStore;
+    pStore = 0;
+    return;
+  }
+
+  log->Info(1, "Block cache %s attached with %u byte blocks", path.c_str(),
+            pStore->BlockSize());
+}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+BlockCacheFactory::~BlockCacheFactory()
+{
+  if (pJobs) {
+    pJobs->Stop();
+    pJobs->Finalize();
+    delete pJobs;
+  }
+
+  delete pStore;
+}
+
+//------------------------------------------------------------------------------
+// Create a file plug-in for the given URL
+//------------------------------------------------------------------------------
+XrdCl::FilePlugIn*
+BlockCacheFactory::CreateFile(const std::string& url)
+{
+  return static_cast<XrdCl::FilePlugIn*>(new BlockCacheFile(pStore, pJobs));
+}
+
+//------------------------------------------------------------------------------
+// Create a file system plug-in for the given URL
+//------------------------------------------------------------------------------
+XrdCl::FileSystemPlugIn*
+BlockCacheFactory::CreateFileSystem(const std::string& url)
+{
+  XrdCl::Log* log = XrdCl::DefaultEnv::GetLog();
+  log->Error(1, "FileSystem plugin implementation not suppoted");
+  return static_cast<XrdCl::FileSystemPlugIn*>(0);
+}
+} // namespace xrdcl_blockcache
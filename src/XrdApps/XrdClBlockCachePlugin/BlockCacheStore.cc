@@ -0,0 +1,605 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#include "BlockCacheStore.hh"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+//------------------------------------------------------------------------------
+// Bump the version whenever the layout of the mapping changes
+//------------------------------------------------------------------------------
+const char     cacheMagic[8] = {'X', 'r', 'd', 'C', 'l', 'B', 'C', '\0'};
+const uint32_t cacheVersion  = 1;
+
+//------------------------------------------------------------------------------
+// A fetch that did not complete in this many seconds is taken over
+//------------------------------------------------------------------------------
+const time_t   fillTimeout   = 120;
+
+//------------------------------------------------------------------------------
+// How far from the cold end we look for an unpinned block to evict
+//------------------------------------------------------------------------------
+const int      victimScan    = 256;
+
+enum SlotState {slotEmpty = 0, slotFilling, slotValid};
+
+uint64_t Align(uint64_t val, uint64_t to)
+{
+  return (val + to - 1) / to * to;
+}
+}
+
+namespace xrdcl_blockcache
+{
+//------------------------------------------------------------------------------
+// The start of the mapping
+//------------------------------------------------------------------------------
+struct BlockCacheStore::Header
+{
+  char            magic[8];
+  uint32_t        version;
+  uint32_t        blockSize;
+  uint32_t        nSlots;
+  uint32_t        nBuckets;
+  uint64_t        slotOffset;
+  uint64_t        dataOffset;
+  uint64_t        mapSize;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  int32_t         lruHead;
+  int32_t         lruTail;
+  int32_t         freeHead;
+  uint64_t        hits;
+  uint64_t        misses;
+  uint64_t        joins;
+  uint64_t        evictions;
+};
+
+//------------------------------------------------------------------------------
+// One per block of data
+//------------------------------------------------------------------------------
+struct BlockCacheStore::Slot
+{
+  uint64_t key;
+  uint64_t block;
+  int32_t  hashNext;
+  int32_t  lruPrev;
+  int32_t  lruNext;
+  uint32_t state;
+  uint32_t length;
+  uint32_t pins;
+  pid_t    filler;
+  time_t   fillStart;
+};
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+BlockCacheStore::BlockCacheStore():
+  mHdr(0), mSlots(0), mBuckets(0), mData(0), mMapSize(0)
+{}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+BlockCacheStore::~BlockCacheStore()
+{
+  if (mHdr) {
+    munmap(mHdr, mMapSize);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Attach to the cache
+//------------------------------------------------------------------------------
+bool
+BlockCacheStore::Attach(const std::string& path, uint64_t size,
+                        uint32_t blockSize)
+{
+  Header hdr;
+  struct stat st;
+  int fd, rc;
+
+  if ((fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600)) < 0) {
+    return false;
+  }
+
+  // Serialize the attaching processes so that only one of them formats the
+  // cache. Once formatted the header is never changed.
+  //
+  do {
+    rc = flock(fd, LOCK_EX);
+  } while (rc && errno == EINTR);
+
+  bool isNew = true;
+
+  if (!rc && !fstat(fd, &st) && st.st_size >= (off_t)sizeof(Header)
+      && pread(fd, &hdr, sizeof(Header), 0) == (ssize_t)sizeof(Header)
+      && !memcmp(hdr.magic, cacheMagic, sizeof(cacheMagic))
+      && hdr.version == cacheVersion && st.st_size == (off_t)hdr.mapSize) {
+    isNew = false;
+  } else if (!rc) {
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.version   = cacheVersion;
+    hdr.blockSize = blockSize;
+    hdr.nSlots    = (size / blockSize < 16 ? 16 : size / blockSize);
+    hdr.nBuckets  = 1;
+
+    while (hdr.nBuckets < hdr.nSlots) {
+      hdr.nBuckets <<= 1;
+    }
+
+    hdr.slotOffset = Align(sizeof(Header) + hdr.nBuckets * sizeof(int32_t), 64);
+    hdr.dataOffset = Align(hdr.slotOffset + hdr.nSlots * sizeof(Slot), 4096);
+    hdr.mapSize    = hdr.dataOffset + (uint64_t)hdr.nSlots * blockSize;
+
+    // The file is sparse, on tmpfs the data pages only take up memory once
+    // a block is stored in them
+    //
+    if (ftruncate(fd, 0) || ftruncate(fd, hdr.mapSize)) {
+      rc = -1;
+    }
+  }
+
+  void* addr = MAP_FAILED;
+
+  if (!rc) {
+    addr = mmap(0, hdr.mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+
+  if (addr == MAP_FAILED) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    return false;
+  }
+
+  mHdr     = (Header*)addr;
+  mMapSize = hdr.mapSize;
+  mBuckets = (int32_t*)((char*)addr + sizeof(Header));
+  mSlots   = (Slot*)((char*)addr + hdr.slotOffset);
+  mData    = (char*)addr + hdr.dataOffset;
+
+  if (isNew) {
+    pthread_mutexattr_t mattr;
+    pthread_condattr_t  cattr;
+    pthread_mutexattr_init(&mattr);
+    pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&mHdr->mutex, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&mHdr->cond, &cattr);
+    pthread_condattr_destroy(&cattr);
+    mHdr->version    = hdr.version;
+    mHdr->blockSize  = hdr.blockSize;
+    mHdr->nSlots     = hdr.nSlots;
+    mHdr->nBuckets   = hdr.nBuckets;
+    mHdr->slotOffset = hdr.slotOffset;
+    mHdr->dataOffset = hdr.dataOffset;
+    mHdr->mapSize    = hdr.mapSize;
+    mHdr->lruHead    = mHdr->lruTail = -1;
+    mHdr->freeHead   = -1;
+
+    for (uint32_t i = 0; i < hdr.nBuckets; ++i) {
+      mBuckets[i] = -1;
+    }
+
+    for (int i = hdr.nSlots - 1; i >= 0; --i) {
+      Release(i);
+    }
+
+    // The magic goes in last, a cache without it is formatted again
+    //
+    memcpy(mHdr->magic, cacheMagic, sizeof(cacheMagic));
+  }
+
+  flock(fd, LOCK_UN);
+  close(fd);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Block size of the attached cache
+//------------------------------------------------------------------------------
+uint32_t
+BlockCacheStore::BlockSize() const
+{
+  return mHdr->blockSize;
+}
+
+//------------------------------------------------------------------------------
+// Copy data out of a block, fetching it if need be
+//------------------------------------------------------------------------------
+XrdCl::XRootDStatus
+BlockCacheStore::Read(uint64_t key, uint64_t block, uint32_t blockLen,
+                      uint32_t offset, uint32_t size, char* buffer,
+                      uint32_t& bytesRead, BlockFetcher& fetcher)
+{
+  bool joined = false;
+  int  idx;
+
+  bytesRead = 0;
+
+  while (true) {
+    Lock();
+
+    if ((idx = Lookup(key, block)) >= 0) {
+      Slot& slot = mSlots[idx];
+
+      if (slot.state == slotValid) {
+        // A hit. The pin keeps the block from being evicted while we copy
+        // the data without holding the lock.
+        //
+        slot.pins++;
+        LruUnlink(idx);
+        LruPush(idx);
+        mHdr->hits++;
+        break;
+      }
+
+      // Someone else is fetching the block, wait for it unless it looks as
+      // if they will never finish, in which case we fetch it ourselves
+      //
+      if (!Abandoned(slot)) {
+        if (!joined) {
+          mHdr->joins++;
+          joined = true;
+        }
+
+        Wait();
+        UnLock();
+        continue;
+      }
+    } else if ((idx = Victim()) < 0) {
+      // Every block is in use, read around the cache
+      //
+      UnLock();
+      return fetcher.Fetch(block * mHdr->blockSize + offset, size, buffer,
+                           bytesRead);
+    } else {
+      mSlots[idx].key   = key;
+      mSlots[idx].block = block;
+      mSlots[idx].pins  = 0;
+      HashLink(idx);
+      mHdr->misses++;
+    }
+
+    Slot& slot = mSlots[idx];
+    slot.state     = slotFilling;
+    slot.filler    = getpid();
+    slot.fillStart = time(0);
+    UnLock();
+
+    uint32_t got = 0;
+    XrdCl::XRootDStatus st = fetcher.Fetch(block * mHdr->blockSize, blockLen,
+                                           Data(idx), got);
+    Lock();
+
+    // Should the fetch have been taken over while we were at it, the block
+    // is now someone else's business
+    //
+    if (slot.state != slotFilling || slot.key != key || slot.block != block
+        || slot.filler != getpid()) {
+      UnLock();
+
+      if (!st.IsOK()) {
+        return st;
+      }
+
+      continue;
+    }
+
+    if (!st.IsOK()) {
+      HashUnlink(idx);
+      Release(idx);
+      Wake();
+      UnLock();
+      return st;
+    }
+
+    slot.state  = slotValid;
+    slot.length = got;
+    slot.pins++;
+    LruPush(idx);
+    Wake();
+    break;
+  }
+
+  // We hold a pin on the block and the lock
+  //
+  Slot& slot = mSlots[idx];
+  UnLock();
+
+  if (offset < slot.length) {
+    bytesRead = (size < slot.length - offset ? size : slot.length - offset);
+    memcpy(buffer, Data(idx) + offset, bytesRead);
+  }
+
+  Lock();
+  slot.pins--;
+  UnLock();
+  return XrdCl::XRootDStatus();
+}
+
+//------------------------------------------------------------------------------
+// 64-bit FNV-1a hash of a string
+//------------------------------------------------------------------------------
+uint64_t
+BlockCacheStore::Hash(const std::string& str)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  for (size_t i = 0; i < str.size(); ++i) {
+    hash = (hash ^ (unsigned char)str[i]) * 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+// Lock the cache
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::Lock()
+{
+  if (pthread_mutex_lock(&mHdr->mutex) == EOWNERDEAD) {
+    Recover();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Called when the previous owner of the lock died holding it. The lists may
+// be half updated, so all of them are rebuilt from the slots.
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::Recover()
+{
+  pthread_mutex_consistent(&mHdr->mutex);
+  mHdr->lruHead = mHdr->lruTail = -1;
+  mHdr->freeHead = -1;
+
+  for (uint32_t i = 0; i < mHdr->nBuckets; ++i) {
+    mBuckets[i] = -1;
+  }
+
+  for (int i = mHdr->nSlots - 1; i >= 0; --i) {
+    if (mSlots[i].state == slotValid) {
+      HashLink(i);
+      LruPush(i);
+    } else if (mSlots[i].state == slotFilling) {
+      HashLink(i);
+    } else {
+      Release(i);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Unlock the cache
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::UnLock()
+{
+  pthread_mutex_unlock(&mHdr->mutex);
+}
+
+//------------------------------------------------------------------------------
+// Wait a little for a fetch to complete, the lock must be held. The wait is
+// bounded since the fetcher might die without telling us.
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::Wait()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_nsec += 50 * 1000000;
+
+  if (ts.tv_nsec >= 1000000000) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000;
+  }
+
+  if (pthread_cond_timedwait(&mHdr->cond, &mHdr->mutex, &ts) == EOWNERDEAD) {
+    Recover();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Wake up whoever waits for a fetch, the lock must be held
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::Wake()
+{
+  pthread_cond_broadcast(&mHdr->cond);
+}
+
+//------------------------------------------------------------------------------
+// Find the slot holding a block, the lock must be held
+//------------------------------------------------------------------------------
+int
+BlockCacheStore::Lookup(uint64_t key, uint64_t block)
+{
+  uint64_t hash = (key ^ (block * 0x9E3779B97F4A7C15ULL)) * 0xff51afd7ed558ccdULL;
+  int idx = mBuckets[(hash >> 32) & (mHdr->nBuckets - 1)];
+
+  while (idx >= 0 && (mSlots[idx].key != key || mSlots[idx].block != block)) {
+    idx = mSlots[idx].hashNext;
+  }
+
+  return idx;
+}
+
+//------------------------------------------------------------------------------
+// Get a slot for a new block, the lock must be held
+//------------------------------------------------------------------------------
+int
+BlockCacheStore::Victim()
+{
+  int idx = mHdr->freeHead;
+
+  if (idx >= 0) {
+    mHdr->freeHead = mSlots[idx].hashNext;
+    return idx;
+  }
+
+  idx = mHdr->lruTail;
+
+  for (int n = 0; idx >= 0 && n < victimScan; ++n) {
+    if (!mSlots[idx].pins) {
+      LruUnlink(idx);
+      HashUnlink(idx);
+      mHdr->evictions++;
+      return idx;
+    }
+
+    idx = mSlots[idx].lruPrev;
+  }
+
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+// Link a slot into its hash chain
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::HashLink(int idx)
+{
+  Slot& slot = mSlots[idx];
+  uint64_t hash = (slot.key ^ (slot.block * 0x9E3779B97F4A7C15ULL))
+                  * 0xff51afd7ed558ccdULL;
+  int32_t& head = mBuckets[(hash >> 32) & (mHdr->nBuckets - 1)];
+  slot.hashNext = head;
+  head = idx;
+}
+
+//------------------------------------------------------------------------------
+// Unlink a slot from its hash chain
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::HashUnlink(int idx)
+{
+  Slot& slot = mSlots[idx];
+  uint64_t hash = (slot.key ^ (slot.block * 0x9E3779B97F4A7C15ULL))
+                  * 0xff51afd7ed558ccdULL;
+  int32_t* link = &mBuckets[(hash >> 32) & (mHdr->nBuckets - 1)];
+
+  while (*link >= 0 && *link != idx) {
+    link = &mSlots[*link].hashNext;
+  }
+
+  if (*link == idx) {
+    *link = slot.hashNext;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Put a slot at the hot end of the LRU list
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::LruPush(int idx)
+{
+  Slot& slot = mSlots[idx];
+  slot.lruPrev = -1;
+  slot.lruNext = mHdr->lruHead;
+
+  if (mHdr->lruHead >= 0) {
+    mSlots[mHdr->lruHead].lruPrev = idx;
+  } else {
+    mHdr->lruTail = idx;
+  }
+
+  mHdr->lruHead = idx;
+}
+
+//------------------------------------------------------------------------------
+// Take a slot off the LRU list
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::LruUnlink(int idx)
+{
+  Slot& slot = mSlots[idx];
+
+  if (slot.lruPrev >= 0) {
+    mSlots[slot.lruPrev].lruNext = slot.lruNext;
+  } else {
+    mHdr->lruHead = slot.lruNext;
+  }
+
+  if (slot.lruNext >= 0) {
+    mSlots[slot.lruNext].lruPrev = slot.lruPrev;
+  } else {
+    mHdr->lruTail = slot.lruPrev;
+  }
+
+  slot.lruPrev = slot.lruNext = -1;
+}
+
+//------------------------------------------------------------------------------
+// Put a slot on the free list, it is chained through the hash link
+//------------------------------------------------------------------------------
+void
+BlockCacheStore::Release(int idx)
+{
+  Slot& slot = mSlots[idx];
+  slot.state    = slotEmpty;
+  slot.length   = 0;
+  slot.lruPrev  = slot.lruNext = -1;
+  slot.hashNext = mHdr->freeHead;
+  mHdr->freeHead = idx;
+}
+
+//------------------------------------------------------------------------------
+// Check whether the fetch of a block was abandoned, the lock must be held
+//------------------------------------------------------------------------------
+bool
+BlockCacheStore::Abandoned(const Slot& slot)
+{
+  if (time(0) - slot.fillStart > fillTimeout) {
+    return true;
+  }
+
+  return slot.filler != getpid() && kill(slot.filler, 0) && errno == ESRCH;
+}
+
+//------------------------------------------------------------------------------
+// Data of a slot
+//------------------------------------------------------------------------------
+char*
+BlockCacheStore::Data(int idx)
+{
+  return mData + (uint64_t)idx * mHdr->blockSize;
+}
+
+} // namespace xrdcl_blockcache
@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#pragma once
+#include "XrdCl/XrdClXRootDResponses.hh"
+#include <stdint.h>
+#include <string>
+
+namespace xrdcl_blockcache
+{
+//------------------------------------------------------------------------------
+//! Source of the data for blocks that are not in the cache
+//------------------------------------------------------------------------------
+class BlockFetcher
+{
+public:
+  virtual ~BlockFetcher() {}
+
+  //----------------------------------------------------------------------------
+  //! Read size bytes at offset of the file into buffer
+  //----------------------------------------------------------------------------
+  virtual XrdCl::XRootDStatus Fetch(uint64_t  offset,
+                                    uint32_t  size,
+                                    char     *buffer,
+                                    uint32_t &bytesRead) = 0;
+};
+
+//------------------------------------------------------------------------------
+//! Node-local block cache kept in a memory mapped file, normally on tmpfs,
+//! and shared by all the processes that attach to it. Blocks are identified
+//! by a file key and their number, evicted in least recently used order and
+//! fetched only once however many processes miss on them at the same time:
+//! the first one fetches the block while the others wait for it. All the
+//! bookkeeping lives in the mapping and is protected by a robust process
+//! shared mutex, so a process dying while holding it does not wedge the
+//! others and a block whose fetcher died is fetched again.
+//------------------------------------------------------------------------------
+class BlockCacheStore
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //----------------------------------------------------------------------------
+  BlockCacheStore();
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  ~BlockCacheStore();
+
+  //----------------------------------------------------------------------------
+  //! Attach to the cache at path, creating it with the given size and block
+  //! size if it does not exist yet. An existing cache keeps its geometry.
+  //!
+  //! @return true on success, false with errno set otherwise
+  //----------------------------------------------------------------------------
+  bool Attach(const std::string& path, uint64_t size, uint32_t blockSize);
+
+  //----------------------------------------------------------------------------
+  //! Block size of the attached cache
+  //----------------------------------------------------------------------------
+  uint32_t BlockSize() const;
+
+  //----------------------------------------------------------------------------
+  //! Copy size bytes at offset within block number block of the file
+  //! identified by key into buffer, fetching the block if need be. The
+  //! block is blockLen bytes long, less than the block size only for the
+  //! last block of a file.
+  //!
+  //! @param bytesRead number of bytes copied, less than size if the block
+  //!                  turned out to be shorter than expected
+  //----------------------------------------------------------------------------
+  XrdCl::XRootDStatus Read(uint64_t      key,
+                           uint64_t      block,
+                           uint32_t      blockLen,
+                           uint32_t      offset,
+                           uint32_t      size,
+                           char         *buffer,
+                           uint32_t     &bytesRead,
+                           BlockFetcher &fetcher);
+
+  //----------------------------------------------------------------------------
+  //! 64-bit FNV-1a hash of a string, used to derive file keys
+  //----------------------------------------------------------------------------
+  static uint64_t Hash(const std::string& str);
+
+private:
+  struct Header;
+  struct Slot;
+
+  void  Lock();
+  void  Recover();
+  void  UnLock();
+  void  Wait();
+  void  Wake();
+
+  int   Lookup(uint64_t key, uint64_t block);
+  int   Victim();
+  void  HashLink(int idx);
+  void  HashUnlink(int idx);
+  void  LruPush(int idx);
+  void  LruUnlink(int idx);
+  void  Release(int idx);
+  bool  Abandoned(const Slot& slot);
+  char* Data(int idx);
+
+  Header  *mHdr;
+  Slot    *mSlots;
+  int32_t *mBuckets;
+  char    *mData;
+  size_t   mMapSize;
+};
+
+} // namespace xrdcl_blockcache
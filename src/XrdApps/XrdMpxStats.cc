@@ -28,8 +28,11 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <errno.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/uio.h>
 
@@ -76,21 +79,23 @@ struct statsBuff
        char            Pad[2];
      };
 
-void       Add(statsBuff *sbP);
+void       Add(statsBuff *sbP, statsBuff *sbLast=0, int sbNum=1);
 
 statsBuff *getBuff();
 
 void      *Run(XrdMpxXml *xP);
 
-           XrdMpxOut() : Ready(0), inQ(0), Free(0) {}
+           XrdMpxOut() : Ready(0), inQ(0), inQLast(0), Free(0) {}
           ~XrdMpxOut() {}
 
 private:
 
 XrdSysMutex     myMutex;
+XrdSysMutex     outMutex;
 XrdSysSemaphore Ready;
 
 statsBuff      *inQ;
+statsBuff      *inQLast;
 statsBuff      *Free;
 };
 
@@ -98,15 +103,21 @@ statsBuff      *Free;
 /*                        X r d M p x O u t : : A d d                         */
 /******************************************************************************/
   
-void XrdMpxOut::Add(statsBuff *sbP)
+// A chain of sbNum buffers from sbP to sbLast may be added at once. Buffers
+// are processed in the order they were received.
+//
+void XrdMpxOut::Add(statsBuff *sbP, statsBuff *sbLast, int sbNum)
 {
+   if (!sbLast) sbLast = sbP;
+   sbLast->Next = 0;
 
-// Add this to the queue and signal the processing thread
+// Add these to the queue and signal the processing threads
 //
    myMutex.Lock();
-   sbP->Next = inQ;
-   inQ = sbP;
-   Ready.Post();
+   if (inQLast) inQLast->Next = sbP;
+      else      inQ          = sbP;
+   inQLast = sbLast;
+   while(sbNum--) Ready.Post();
    myMutex.UnLock();
 }
 
@@ -144,7 +155,7 @@ void *XrdMpxOut::Run(XrdMpxXml *xP)
    while(1)
         {Ready.Wait();
          myMutex.Lock();
-         if ((sbP = inQ)) inQ = sbP->Next;
+         if ((sbP = inQ) && !(inQ = sbP->Next)) inQLast = 0;
          myMutex.UnLock();
          if (!sbP) continue;
          if (xP)
@@ -159,11 +170,17 @@ void *XrdMpxOut::Run(XrdMpxXml *xP)
              wLen = sbP->Dlen+1;
             }
 
+// Formatting may be done by several threads but each record is written
+// as a unit.
+//
+         outMutex.Lock();
          while(wLen > 0)
               {do {rc = write(STDOUT_FILENO, bP, wLen);}
                   while(rc < 0 && errno == EINTR);
+               if (rc < 0) break;
                wLen -= rc; bP += rc;
               }
+         outMutex.UnLock();
 
          myMutex.Lock(); sbP->Next = Free; Free = sbP; myMutex.UnLock();
         }
@@ -198,7 +215,8 @@ void *mainOutput(void *parg)
   
 void Usage(int rc)
 {
-   cerr <<"\nUsage: mpxstats [-f {cgi|flat|xml}] -p <port> [-s]" <<endl;
+   cerr <<"\nUsage: mpxstats [-f {cgi|flat|xml}] -p <port> [-s] [-t <thrds>] "
+          "[-w <rcvbuf>]" <<endl;
    exit(rc);
 }
 
@@ -216,8 +234,7 @@ int main(int argc, char *argv[])
    XrdMpxOut::statsBuff *sbP = 0;
    XrdNetSocket mySocket(&Say);
    XrdMpxXml *xP = 0;
-   SOCKLEN_t fromLen;
-   int Port = 0, retc, udpFD;
+   int Port = 0, retc, udpFD, Thrds = 1, Wsz = 0;
    char buff[64], c;
    bool Debug;
 
@@ -225,7 +242,7 @@ int main(int argc, char *argv[])
 //
    opterr = 0; Debug = false; Opts = 0;
    if (argc > 1 && '-' == *argv[1]) 
-      while ((c = getopt(argc,argv,"df:p:s")) && ((unsigned char)c != 0xff))
+      while ((c = getopt(argc,argv,"df:p:st:w:")) && ((unsigned char)c != 0xff))
      { switch(c)
        {
        case 'd': Debug = true;
@@ -242,6 +259,12 @@ int main(int argc, char *argv[])
                  break;
        case 's': Opts |= addSender;
                  break;
+       case 't': if ((Thrds = atoi(optarg)) < 1 || Thrds > 64)
+                    {Say.Emsg(":", "Invalid thread count - ", optarg); Usage(1);}
+                 break;
+       case 'w': if ((Wsz = atoi(optarg)) < 1)
+                    {Say.Emsg(":", "Invalid rcvbuf size - ", optarg); Usage(1);}
+                 break;
        default:  sprintf(buff,"'%c'", optopt);
                  if (c == ':') Say.Emsg(":", buff, "value not specified.");
                     else Say.Emsg(0, buff, "option is invalid");
@@ -269,7 +292,7 @@ int main(int argc, char *argv[])
 
 // Create a UDP socket and bind it to a port
 //
-   if (mySocket.Open(0, Port, XRDNET_SERVER|XRDNET_UDPSOCKET, 0) < 0)
+   if (mySocket.Open(0, Port, XRDNET_SERVER|XRDNET_UDPSOCKET, Wsz) < 0)
       {Say.Emsg(":", -mySocket.LastError(), "create udp socket"); exit(4);}
    udpFD = mySocket.Detach();
 
@@ -277,23 +300,67 @@ int main(int argc, char *argv[])
 //
    if (fType != XrdMpxXml::fmtXML) xP = new XrdMpxXml(fType, Debug);
 
-// Now run a thread to output whatever we get
+// Now run the threads to output whatever we get. With more than one thread
+// records are formatted in parallel and may be written out of order.
 //
-   if ((retc = XrdSysThread::Run(&tid, mainOutput, (void *)xP,
-                                 XRDSYSTHREAD_BIND, "Output")))
-      {Say.Emsg(":", retc, "create output thread"); exit(4);}
+   for (int i = 0; i < Thrds; i++)
+       if ((retc = XrdSysThread::Run(&tid, mainOutput, (void *)xP,
+                                     XRDSYSTHREAD_BIND, "Output")))
+          {Say.Emsg(":", retc, "create output thread"); exit(4);}
 
-// Now simply wait for the messages
+// Now simply wait for the messages. Where possible we receive as many as
+// are pending with a single call to keep up with large numbers of senders.
 //
-   fromLen = sizeof(sbP->From);
+#ifdef __linux__
+   static const int rBatch = 64;
+   struct mmsghdr mMsg[rBatch];
+   XrdMpxOut::statsBuff *sbFirst;
+   struct iovec   mIov[rBatch];
+   XrdMpxOut::statsBuff *mBuff[rBatch];
+
+   memset(mMsg,  0, sizeof(mMsg));
+   memset(mBuff, 0, sizeof(mBuff));
+   while(1)
+        {for (int i = 0; i < rBatch; i++)
+             {if (!mBuff[i]) mBuff[i] = statsQ.getBuff();
+              mIov[i].iov_base = mBuff[i]->Data;
+              mIov[i].iov_len  = sizeof(mBuff[i]->Data);
+              mMsg[i].msg_hdr.msg_name    = &(mBuff[i]->From.Addr);
+              mMsg[i].msg_hdr.msg_namelen = sizeof(mBuff[i]->From);
+              mMsg[i].msg_hdr.msg_iov     = &mIov[i];
+              mMsg[i].msg_hdr.msg_iovlen  = 1;
+             }
+         if ((retc = recvmmsg(udpFD, mMsg, rBatch, MSG_WAITFORONE, 0)) < 0)
+            {if (errno == EINTR) continue;
+             Say.Emsg(":", errno, "recv udp message"); exit(8);
+            }
+         if (!retc) continue;
+         sbFirst = mBuff[0];
+         for (int i = 0; i < retc; i++)
+             {sbP = mBuff[i]; mBuff[i] = 0;
+              sbP->Dlen = mMsg[i].msg_len;
+              sbP->Data[sbP->Dlen] = 0;
+              sbP->Next = (i+1 < retc ? mBuff[i+1] : 0);
+             }
+         statsQ.Add(sbFirst, sbP, retc);
+        }
+#else
+   SOCKLEN_t fromLen;
+
    while(1)
         {sbP = statsQ.getBuff();
+         fromLen = sizeof(sbP->From);
          retc = recvfrom(udpFD, sbP->Data, sizeof(sbP->Data), 0,
                                &sbP->From.Addr, &fromLen);
-         if (retc < 0) {Say.Emsg(":", retc, "recv udp message"); exit(8);}
+         if (retc < 0)
+            {if (errno == EINTR) continue;
+             Say.Emsg(":", errno, "recv udp message"); exit(8);
+            }
          sbP->Dlen = retc;
+         sbP->Data[retc] = 0;
          statsQ.Add(sbP);
         }
+#endif
 
 // Should never get here
 //
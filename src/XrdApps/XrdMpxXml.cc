@@ -159,6 +159,8 @@ std::map<const char *, const char *, vCmp> vnMap {
 {"ssi.req.proc",    "Requests started:"},
 {"ssi.req.rdr",     "Requests redirected:"},
 {"ssi.req.relb",    "Request buff releases:"},
+{"ssi.req.qtm",     "Request queue wait usec:"},
+{"ssi.req.qmx",     "Request queue wait max:"},
 {"ssi.req.dly",     "Requests delayed:"},
 {"ssi.rsp.bad",     "Response violations:"},
 {"ssi.rsp.cbk",     "Response callbacks:"},
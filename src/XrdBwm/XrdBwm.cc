@@ -103,6 +103,9 @@ XrdBwm::XrdBwm()
    PolParm       = 0;
    PolSlotsIn    = 1;
    PolSlotsOut   = 1;
+   PolMaxWait    = 3600;
+   PolClass      = 0;
+   PolFairQ      = false;
 
 // Obtain port number we will be using
 //
@@ -264,6 +267,9 @@ int XrdBwmFile::open(const char          *path,      // In
             info      - Opaque information:
                         bwm.src=<src  host>
                         bwm.dst=<dest host>
+                        bwm.size=<expected bytes>     (optional)
+                        bwm.deadline=<max queue sec>  (optional)
+                        bwm.class=<scheduling class>  (optional)
 
   Output:   Returns SFS_OK upon success, otherwise SFS_ERROR is returned.
 */
@@ -272,6 +278,10 @@ int XrdBwmFile::open(const char          *path,      // In
    XrdBwmHandle *hP;
    int incomming;
    const char *miss, *theUsr, *theSrc, *theDst=0, *theLfn=0, *lclNode, *rmtNode;
+   const char *theCls;
+   char *eP;
+   long long theSize = -1;
+   int theDeadline = 0;
    XrdOucEnv Open_Env(info);
 
 // Trace entry
@@ -318,9 +328,23 @@ int XrdBwmFile::open(const char          *path,      // In
            {incomming = 1; lclNode = theDst; rmtNode = theSrc;}
    else return XrdBwmFS.Emsg("open", error, EREMOTE, "open", path);
 
+// Pick up the optional scheduling hints. These are only hints, so anything
+// that does not make sense is simply ignored.
+//
+   if ((theCls = Open_Env.Get("bwm.size")))
+      {theSize = strtoll(theCls, &eP, 10);
+       if (*eP || theSize < 0) theSize = -1;
+      }
+   if ((theCls = Open_Env.Get("bwm.deadline")))
+      {theDeadline = strtol(theCls, &eP, 10);
+       if (*eP || theDeadline < 0) theDeadline = 0;
+      }
+   theCls = Open_Env.Get("bwm.class");
+
 // Get a handle for this file.
 //
-   if (!(hP = XrdBwmHandle::Alloc(theUsr,theLfn,lclNode,rmtNode,incomming)))
+   if (!(hP = XrdBwmHandle::Alloc(theUsr,theLfn,lclNode,rmtNode,incomming,
+                                  theSize, theDeadline, theCls)))
       return XrdBwmFS.Stall(error, 13, path);
 
 // All done
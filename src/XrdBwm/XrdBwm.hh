@@ -145,6 +145,7 @@ XrdBwmHandle  *oh;
 class XrdAccAuthorize;
 class XrdBwmLogger;
 class XrdBwmPolicy;
+class XrdOucTList;
 
 class XrdBwm : public XrdSfsFileSystem
 {
@@ -281,6 +282,9 @@ char             *locResp;        //    ->Locate Response
 int               locRlen;        //      Length of locResp;
 int               PolSlotsIn;
 int               PolSlotsOut;
+int               PolMaxWait;
+XrdOucTList      *PolClass;       //    ->Fair queuing class weights
+bool              PolFairQ;
 
 static XrdBwmHandle     *dummyHandle;
 XrdSysMutex              ocMutex; // Global mutex for open/close
@@ -299,6 +303,7 @@ int           setupPolicy(XrdSysError &);
 int           xalib(XrdOucStream &, XrdSysError &);
 int           xlog(XrdOucStream &, XrdSysError &);
 int           xpol(XrdOucStream &, XrdSysError &);
+int           xfairq(XrdOucStream &, XrdSysError &);
 int           xtrace(XrdOucStream &, XrdSysError &);
 };
 #endif
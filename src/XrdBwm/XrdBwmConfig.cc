@@ -41,6 +41,7 @@
 #include "XrdBwm/XrdBwmLogger.hh"
 #include "XrdBwm/XrdBwmPolicy.hh"
 #include "XrdBwm/XrdBwmPolicy1.hh"
+#include "XrdBwm/XrdBwmPolicy2.hh"
 #include "XrdBwm/XrdBwmTrace.hh"
 
 #include "XrdOuc/XrdOuca2x.hh"
@@ -49,6 +50,7 @@
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysHeaders.hh"
 #include "XrdOuc/XrdOucStream.hh"
+#include "XrdOuc/XrdOucTList.hh"
 #include "XrdOuc/XrdOucTrace.hh"
 
 #include "XrdAcc/XrdAccAuthorize.hh"
@@ -129,6 +131,13 @@ int XrdBwm::Configure(XrdSysError &Eroute) {
 // Establish scheduling policy
 //
    if (PolLib) NoGo |= setupPolicy(Eroute);
+      else if (PolFairQ)
+              {XrdBwmPolicy2 *fqP;
+               fqP = new XrdBwmPolicy2(PolSlotsIn, PolSlotsOut, PolMaxWait);
+               for (XrdOucTList *tP = PolClass; tP; tP = tP->next)
+                   fqP->Weight(tP->text, tP->val);
+               Policy = fqP;
+              }
       else Policy = new XrdBwmPolicy1(PolSlotsIn, PolSlotsOut);
 
 // Start logger object
@@ -254,9 +263,19 @@ int XrdBwm::xlog(XrdOucStream &Config, XrdSysError &Eroute)
 
    Purpose:  To parse the directive: policy args
 
-             Args: {maxslots <innum> <outnum> | lib <path> [<parms>]}
+             Args: {maxslots <innum> <outnum> | lib <path> [<parms>] |
+                    fairq <innum> <outnum> [maxwait <sec>]
+                          [class <name> <weight>] [...]}
 
              <num>     maximum number of slots available.
+             fairq     use weighted fair queuing: queued requests are served
+                       by class in proportion to the class weight, smallest
+                       expected transfer first within a class.
+             <sec>     the longest a request may be queued before it takes
+                       precedence over all others (default 3600, 0 is none).
+             <name>    the class name, as passed in bwm.class; requests of
+                       any other class go into class "default".
+             <weight>  the relative share of the class (default 1).
              <path>    if preceeded by lib, the path of the policy library to 
                        be used; otherwise, the file that describes policy.
              <parms>   optional parms to be passed
@@ -279,11 +298,16 @@ int XrdBwm::xpol(XrdOucStream &Config, XrdSysError &Eroute)
    if (PolLib)  {free(PolLib);  PolLib  = 0;}
    if (PolParm) {free(PolParm); PolParm = 0;}
    PolSlotsIn = PolSlotsOut = 0;
+   PolMaxWait = 3600;
+   PolFairQ   = false;
+   while (PolClass)
+         {XrdOucTList *tP = PolClass; PolClass = tP->next; delete tP;}
 
-// If the word maxslots then this is a simple policy
+// If the word maxslots or fairq then this is a built-in policy
 //
-   if (!strcmp("maxslots", val))
-      {if (!(val = Config.GetWord()) || !val[0])
+   if (!strcmp("maxslots", val) || !strcmp("fairq", val))
+      {PolFairQ = (*val == 'f');
+       if (!(val = Config.GetWord()) || !val[0])
           {Eroute.Emsg("Config", "policy in slots not specified"); return 1;}
        if (XrdOuca2x::a2i(Eroute,"policy in slots",val,&pl,0,32767)) return 1;
        PolSlotsIn = pl;
@@ -291,7 +315,7 @@ int XrdBwm::xpol(XrdOucStream &Config, XrdSysError &Eroute)
           {Eroute.Emsg("Config", "policy out slots not specified"); return 1;}
        if (XrdOuca2x::a2i(Eroute,"policy out slots",val,&pl,0,32767)) return 1;
        PolSlotsOut = pl;
-       return 0;
+       return (PolFairQ ? xfairq(Config, Eroute) : 0);
       }
 
 // Make sure the word is lib
@@ -316,6 +340,59 @@ int XrdBwm::xpol(XrdOucStream &Config, XrdSysError &Eroute)
    return 0;
 }
 
+/******************************************************************************/
+/*                                x f a i r q                                 */
+/******************************************************************************/
+
+/* Function: xfairq
+
+   Purpose:  To parse the remaining fairq policy options:
+
+             [maxwait <sec>] [class <name> <weight>] [...]
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdBwm::xfairq(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val, cName[64];
+    int pl;
+
+   while((val = Config.GetWord()) && val[0])
+        {if (!strcmp("maxwait", val))
+            {if (!(val = Config.GetWord()) || !val[0])
+                {Eroute.Emsg("Config", "policy maxwait not specified");
+                 return 1;
+                }
+             if (XrdOuca2x::a2tm(Eroute,"policy maxwait",val,&pl,0)) return 1;
+             PolMaxWait = pl;
+            }
+         else if (!strcmp("class", val))
+            {if (!(val = Config.GetWord()) || !val[0])
+                {Eroute.Emsg("Config", "policy class not specified");
+                 return 1;
+                }
+             if (strlen(val) >= sizeof(cName))
+                {Eroute.Emsg("Config", "policy class name too long -", val);
+                 return 1;
+                }
+             strcpy(cName, val);
+             if (!(val = Config.GetWord()) || !val[0])
+                {Eroute.Emsg("Config", "policy class weight not specified");
+                 return 1;
+                }
+             if (XrdOuca2x::a2i(Eroute,"policy class weight",val,&pl,1,1000))
+                return 1;
+             PolClass = new XrdOucTList(cName, pl, PolClass);
+            }
+         else {Eroute.Emsg("Config", "invalid fairq option -", val); return 1;}
+        }
+
+// All done
+//
+   return 0;
+}
+
 /******************************************************************************/
 /*                                x t r a c e                                 */
 /******************************************************************************/
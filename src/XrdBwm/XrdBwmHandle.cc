@@ -167,7 +167,8 @@ int XrdBwmHandle::Activate(XrdOucErrInfo &einfo)
   
 XrdBwmHandle *XrdBwmHandle::Alloc(const char *theUsr,  const char *thePath,
                                   const char *LclNode, const char *RmtNode,
-                                  int Incomming)
+                                  int Incomming, long long theSize,
+                                  int theDeadline, const char *theClass)
 {
    XrdBwmHandle *hP = Alloc();
 
@@ -180,6 +181,9 @@ XrdBwmHandle *XrdBwmHandle::Alloc(const char *theUsr,  const char *thePath,
        hP->Parms.RmtNode   = strdup(RmtNode);
        hP->Parms.Direction = (Incomming ? XrdBwmPolicy::Incomming
                                         : XrdBwmPolicy::Outgoing);
+       hP->Parms.Size      = theSize;
+       hP->Parms.Deadline  = theDeadline;
+       hP->Parms.Class     = (theClass ? strdup(theClass) : 0);
        hP->Status          = Idle;
        hP->qTime           = 0;
        hP->rTime           = 0;
@@ -366,6 +370,7 @@ void XrdBwmHandle::Retire()
    if (Parms.Lfn)     {free(Parms.Lfn);     Parms.Lfn = 0;}
    if (Parms.LclNode) {free(Parms.LclNode); Parms.LclNode = 0;}
    if (Parms.RmtNode) {free(Parms.RmtNode); Parms.RmtNode = 0;}
+   if (Parms.Class)   {free(Parms.Class);   Parms.Class   = 0;}
    Alloc(this);
 }
 
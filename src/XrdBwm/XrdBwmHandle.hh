@@ -50,7 +50,8 @@ enum HandleState {Idle = 0, Scheduled, Dispatched};
 
 static XrdBwmHandle *Alloc(const char *theUsr,  const char *thePath,
                            const char *lclNode, const char *rmtNode,
-                           int Incomming);
+                           int Incomming, long long theSize=-1,
+                           int theDeadline=0, const char *theClass=0);
 
 static void         *Dispatch();
 
@@ -121,6 +121,9 @@ const char  *Tident;     // In: -> Client's trace identity
       char  *LclNode;    // In: -> Local  node involved in the request
       char  *RmtNode;    // In: -> Remote node involved in the request
       Flow   Direction;  // In: -> Data flow relative to Lclpoint (see enum)
+      long long Size;    // In: -> Expected bytes to transfer (-1 if unknown)
+      int    Deadline;   // In: -> Seconds the request may be queued (0 if none)
+      char  *Class;      // In: -> Scheduling class of the request or nil
 };
 
 virtual int  Schedule(char *RespBuff, int RespSize, SchedParms &Parms) = 0;
@@ -0,0 +1,299 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d B w m P o l i c y 2 . c c                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <limits.h>
+#include <string.h>
+
+#include <limits>
+
+#include "XrdBwm/XrdBwmPolicy2.hh"
+
+/******************************************************************************/
+/*                         L o c a l   D e f i n e s                          */
+/******************************************************************************/
+
+// Requests are charged at least minCost bytes so that a stream of empty files
+// is not free; requests of unknown size are charged as a large file.
+//
+#define minCost  (1024LL*1024LL)
+#define unkCost  (64LL*1024LL*1024LL)
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdBwmPolicy2::XrdBwmPolicy2(int inslots, int outslots, int maxwait)
+{
+// Initialize values
+//
+   theQ[In ].maxSlots = theQ[In ].curSlots  =  inslots;
+   theQ[Out].maxSlots = theQ[Out].curSlots  = outslots;
+   defClass = new fqClass(1);
+   Classes["default"] = defClass;
+   maxWait = maxwait;
+   refID   = 1;
+   nextWay = In;
+}
+
+/******************************************************************************/
+/*                              D i s p a t c h                               */
+/******************************************************************************/
+
+int  XrdBwmPolicy2::Dispatch(char *RespBuff, int RespSize)
+{
+   fqReq *rP;
+   Flow   Way;
+   int    rID;
+
+// Obtain mutex and check if we have any queued requests. We alternate the
+// direction we look at first so that a busy one does not hold up the other.
+//
+   do {pMutex.Lock();
+       Way = (nextWay == In ? In : Out);
+       if ((rP = Next(Way)) || (rP = Next(Way == In ? Out : In)))
+          {Active[rP->refID] = rP;
+           nextWay = (rP->Way == In ? Out : In);
+           rID = rP->refID; *RespBuff = '\0';
+           pMutex.UnLock();
+           return rID;
+          }
+       pMutex.UnLock();
+       pSem.Wait();
+      } while(1);
+
+// Should never get here
+//
+   strcpy(RespBuff, "Fatal logic error!");
+   return 0;
+}
+
+/******************************************************************************/
+/*                                  D o n e                                   */
+/******************************************************************************/
+
+int  XrdBwmPolicy2::Done(int rHandle)
+{
+   std::map<int, fqReq *>::iterator it;
+   fqReq *rP = 0;
+   int rc = 0;
+
+// Make sure we have a positive value here
+//
+   if (rHandle < 0) rHandle = -rHandle;
+
+// Remove the element from whichever queue it is in
+//
+   pMutex.Lock();
+   if ((it = Active.find(rHandle)) != Active.end())
+      {rP = it->second;
+       Active.erase(it);
+       if (theQ[rP->Way].curSlots++ == 0) pSem.Post();
+       rc = 1;
+      }
+   else if ((it = Queued.find(rHandle)) != Queued.end())
+      {rP = it->second;
+       Queued.erase(it);
+       theQ[rP->Way].byDeadline.erase(rP->dlPos);
+       rP->Cls->bySize[rP->Way].erase(rP->szPos);
+       theQ[rP->Way].Num--;
+       rc = -1;
+      }
+   pMutex.UnLock();
+
+// delete the element and return
+//
+   if (rP) delete rP;
+   return rc;
+}
+
+/******************************************************************************/
+/*                              S c h e d u l e                               */
+/******************************************************************************/
+
+int  XrdBwmPolicy2::Schedule(char *RespBuff, int RespSize, SchedParms &Parms)
+{
+   static const char *theWay[] = {"Incomming", "Outgoing"};
+   fqReq *rP;
+   fqClass *cP;
+   long long Cost;
+   time_t Deadline;
+   int myID, Wait;
+
+// Get the global lock and generate a reference ID
+//
+   *RespBuff = '\0';
+   pMutex.Lock();
+   myID = ++refID;
+   cP = getClass(Parms.Class);
+   if (Parms.Size < 0) Cost = unkCost;
+      else Cost = (Parms.Size < minCost ? minCost : Parms.Size);
+   rP = new fqReq(myID, Parms.Direction, cP, Cost);
+   fqQueue &theWayQ = theQ[rP->Way];
+
+// Check if we can immediately schedule this request or must defer it. A
+// deferred request is ordered by its deadline and by its size within its
+// class; equal keys keep their arrival order.
+//
+        if (theWayQ.curSlots > 0)
+           {theWayQ.curSlots--;
+            Active[myID] = rP;
+            Charge(rP);
+           }
+   else if (theWayQ.maxSlots)
+           {Wait = (Parms.Deadline > 0 ? Parms.Deadline : maxWait);
+            if (Wait > 0) Deadline = time(0) + Wait;
+               else Deadline = std::numeric_limits<time_t>::max();
+            if (cP->bySize[rP->Way].empty()
+            &&  cP->vTime[rP->Way] < theWayQ.vNow)
+               cP->vTime[rP->Way] = theWayQ.vNow;
+            rP->dlPos = theWayQ.byDeadline.insert(dlMap::value_type
+                                                  (Deadline, rP));
+            rP->szPos = cP->bySize[rP->Way].insert(szMap::value_type
+                        ((Parms.Size < 0 ? LLONG_MAX : Parms.Size), rP));
+            Queued[myID] = rP;
+            theWayQ.Num++;
+            myID = -myID;
+           }
+   else {strcpy(RespBuff, theWay[rP->Way]);
+         strcat(RespBuff, " requests are not allowed.");
+         delete rP;
+         myID = 0;
+        }
+
+// All done
+//
+   pMutex.UnLock();
+   return myID;
+}
+
+/******************************************************************************/
+/*                                S t a t u s                                 */
+/******************************************************************************/
+
+void XrdBwmPolicy2::Status(int &numqIn, int &numqOut, int &numXeq)
+{
+
+// Get the global lock and return the values
+//
+   pMutex.Lock();
+   numqIn  = theQ[In ].Num;
+   numqOut = theQ[Out].Num;
+   numXeq  = static_cast<int>(Active.size());
+   pMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                                W e i g h t                                 */
+/******************************************************************************/
+
+void XrdBwmPolicy2::Weight(const char *cName, int cWeight)
+{
+   fqClass *&cP = Classes[cName];
+
+// Set the weight of the class, creating it as needed. Only configured
+// classes exist; requests naming any other class go into the default one.
+//
+   if (cWeight < 1) cWeight = 1;
+   if (cP) cP->Weight = cWeight;
+      else cP = new fqClass(cWeight);
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                C h a r g e                                 */
+/******************************************************************************/
+
+// Must be called with the mutex held when the request becomes active. The
+// class is never charged from a time earlier than that of the request that
+// was last started so that an idle class cannot bank its share.
+//
+void XrdBwmPolicy2::Charge(fqReq *rP)
+{
+   fqClass *cP = rP->Cls;
+   fqQueue &theWayQ = theQ[rP->Way];
+
+   if (cP->vTime[rP->Way] < theWayQ.vNow) cP->vTime[rP->Way] = theWayQ.vNow;
+   theWayQ.vNow = cP->vTime[rP->Way];
+   cP->vTime[rP->Way] += static_cast<double>(rP->Cost) / cP->Weight;
+}
+
+/******************************************************************************/
+/*                              g e t C l a s s                               */
+/******************************************************************************/
+
+XrdBwmPolicy2::fqClass *XrdBwmPolicy2::getClass(const char *cName)
+{
+   std::map<std::string, fqClass *>::iterator it;
+
+   if (!cName || !(*cName)
+   ||  (it = Classes.find(cName)) == Classes.end()) return defClass;
+   return it->second;
+}
+
+/******************************************************************************/
+/*                                  N e x t                                   */
+/******************************************************************************/
+
+// Must be called with the mutex held. Returns the next request to start in
+// the indicated direction, if a slot is available, and removes it from the
+// queues.
+//
+XrdBwmPolicy2::fqReq *XrdBwmPolicy2::Next(Flow Way)
+{
+   std::map<std::string, fqClass *>::iterator it;
+   fqQueue &theWayQ = theQ[Way];
+   fqClass *cP = 0;
+   fqReq   *rP;
+
+// Make sure we have something to do
+//
+   if (!theWayQ.Num || !theWayQ.curSlots) return 0;
+
+// A request whose deadline passed always goes first. Otherwise, select the
+// backlogged class with the least virtual time and take its smallest request.
+//
+   if (theWayQ.byDeadline.begin()->first <= time(0))
+      rP = theWayQ.byDeadline.begin()->second;
+      else {for (it = Classes.begin(); it != Classes.end(); it++)
+                {if (it->second->bySize[Way].empty()) continue;
+                 if (!cP || it->second->vTime[Way] < cP->vTime[Way])
+                    cP = it->second;
+                }
+            rP = cP->bySize[Way].begin()->second;
+           }
+
+// Remove the request from the queues and charge its class
+//
+   theWayQ.byDeadline.erase(rP->dlPos);
+   rP->Cls->bySize[Way].erase(rP->szPos);
+   Queued.erase(rP->refID);
+   theWayQ.Num--; theWayQ.curSlots--;
+   Charge(rP);
+   return rP;
+}
@@ -0,0 +1,125 @@
+#ifndef __BWM_POLICY2_HH__
+#define __BWM_POLICY2_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d B w m P o l i c y 2 . h h                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <time.h>
+#include <map>
+#include <string>
+
+#include "XrdBwm/XrdBwmPolicy.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/* XrdBwmPolicy2 is a weighted fair queuing policy. Like XrdBwmPolicy1 it has a
+   fixed number of slots per direction but queued requests are not served in
+   arrival order. Each request belongs to a class (bwm.class) that receives a
+   share of the slots proportional to its weight: a class is charged the
+   expected size of each request it starts divided by its weight and the
+   class with the least charge goes next. Within a class the request with the
+   smallest expected size (bwm.size) goes first; requests of unknown size are
+   served in arrival order after all of the sized ones. Finally, a request
+   whose deadline (bwm.deadline or the configured maximum wait) has passed
+   goes ahead of everything else so that large transfers are not starved.
+*/
+
+class XrdBwmPolicy2 : public XrdBwmPolicy
+{
+public:
+
+int  Dispatch(char *RespBuff, int RespSize);
+
+int  Done(int rHandle);
+
+int  Schedule(char *RespBuff, int RespSize, SchedParms &Parms);
+
+void Status(int &numqIn, int &numqOut, int &numXeq);
+
+void Weight(const char *cName, int cWeight);
+
+     XrdBwmPolicy2(int inslots, int outslots, int maxwait);
+    ~XrdBwmPolicy2() {} // Never deleted!
+
+private:
+
+enum Flow {In = 0, Out = 1, IOX = 2};
+
+struct fqReq;
+
+typedef std::multimap<time_t,    fqReq *> dlMap;
+typedef std::multimap<long long, fqReq *> szMap;
+
+struct fqClass
+      {szMap      bySize[IOX];
+       double     vTime[IOX];
+       int        Weight;
+
+                  fqClass(int w) : Weight(w) {vTime[In] = vTime[Out] = 0.0;}
+                 ~fqClass() {}
+      };
+
+struct fqReq
+      {fqClass        *Cls;
+       dlMap::iterator dlPos;
+       szMap::iterator szPos;
+       long long       Cost;
+       int             refID;
+       Flow            Way;
+
+       fqReq(int id, XrdBwmPolicy::Flow xF, fqClass *cP, long long cost)
+            : Cls(cP), Cost(cost), refID(id),
+              Way(xF == XrdBwmPolicy::Incomming ? In : Out) {}
+      ~fqReq() {}
+      };
+
+struct fqQueue
+      {dlMap    byDeadline;
+       double   vNow;
+       int      Num;
+       int      curSlots;
+       int      maxSlots;
+
+                fqQueue() : vNow(0.0), Num(0), curSlots(0), maxSlots(0) {}
+               ~fqQueue() {}
+      };
+
+void     Charge(fqReq *rP);
+fqClass *getClass(const char *cName);
+fqReq   *Next(Flow Way);
+
+std::map<std::string, fqClass *> Classes;
+std::map<int, fqReq *>           Active;
+std::map<int, fqReq *>           Queued;
+fqQueue                          theQ[IOX];
+
+XrdSysSemaphore pSem;
+XrdSysMutex     pMutex;
+fqClass        *defClass;
+int             maxWait;
+int             refID;
+int             nextWay;
+};
+#endif
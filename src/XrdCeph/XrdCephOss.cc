@@ -90,6 +90,8 @@ XrdCephOss::~XrdCephOss() {
 
 // declared and used in XrdCephPosix.cc
 extern unsigned int g_maxCephPoolIdx;
+extern unsigned int g_aioDepth;
+extern bool g_readAhead;
 int XrdCephOss::Configure(const char *configfn, XrdSysError &Eroute) {
    int NoGo = 0;
    XrdOucEnv myEnv;
@@ -121,6 +123,32 @@ int XrdCephOss::Configure(const char *configfn, XrdSysError &Eroute) {
            return 1;
          }
        }
+       if (!strncmp(var, "ceph.aiodepth", 13)) {
+         var = Config.GetWord();
+         if (var) {
+           unsigned long value = strtoul(var, 0, 10);
+           if (value > 0 and value <= 64) {
+             g_aioDepth = value;
+           } else {
+             Eroute.Emsg("Config", "Invalid value for ceph.aiodepth in config file (must be between 1 and 64)", configfn, var);
+             return 1;
+           }
+         } else {
+           Eroute.Emsg("Config", "Missing value for ceph.aiodepth in config file", configfn);
+           return 1;
+         }
+       }
+       if (!strncmp(var, "ceph.readahead", 14)) {
+         var = Config.GetWord();
+         if (var && !strcmp(var, "on")) {
+           g_readAhead = true;
+         } else if (var && !strcmp(var, "off")) {
+           g_readAhead = false;
+         } else {
+           Eroute.Emsg("Config", "Invalid or missing value for ceph.readahead in config file (must be on or off)", configfn);
+           return 1;
+         }
+       }
        if (!strncmp(var, "ceph.namelib", 12)) {
          var = Config.GetWord();
          if (var) {
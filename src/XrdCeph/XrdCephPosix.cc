@@ -34,10 +34,14 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <radosstriper/libradosstriper.hpp>
+#include <algorithm>
+#include <atomic>
+#include <list>
 #include <map>
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <vector>
 #if !defined(__FreeBSD__)
 #include <sys/xattr.h>
 #endif
@@ -61,12 +65,41 @@ struct CephFile {
   unsigned long long objectSize;
 };
 
+/// one asynchronous read ahead of a stripe unit
+struct CephReadBlock {
+  CephReadBlock(off64_t o) : offset(o), completion(0) {}
+  off64_t offset;
+  librados::AioCompletion *completion;
+  ceph::bufferlist bl;
+};
+
+/// state of the asynchronous reads ahead and writes behind of an open file
+/// Only allocated when g_aioDepth is above 1, or for read only files when
+/// g_readAhead is set (then one stripe unit is read ahead)
+struct CephAioState {
+  CephAioState() : nextRead(0), writeError(0) {}
+  /// serializes the synchronous I/O calls on this file (aio runs in parallel)
+  XrdSysMutex mutex;
+  /// blocks read ahead, ordered and contiguous
+  std::list<CephReadBlock*> blocks;
+  /// offset expected by the next sequential read
+  off64_t nextRead;
+  /// writes in flight, oldest first
+  std::list<librados::AioCompletion*> writes;
+  /// first error of a write behind, returned by the next call
+  int writeError;
+};
+
 struct CephFileRef : CephFile {
   int flags;
   mode_t mode;
   unsigned long long offset;
   unsigned rdcount;
   unsigned wrcount;
+  CephAioState *aio;
+  /// striper and cluster resolved at open time, so that I/O needs no lookup
+  libradosstriper::RadosStriper *striper;
+  librados::Rados *cluster;
 };
 
 /// small struct for directory listing
@@ -101,17 +134,31 @@ unsigned int g_cephPoolIdx = 0;
 /// may be overwritten in the configuration file
 /// (See XrdCephOss::configure)
 unsigned int g_maxCephPoolIdx = 1;
+/// number of stripe units read ahead and of writes behind per open file,
+/// defaults to 1, i.e. synchronous I/O. May be overwritten in the
+/// configuration file (See XrdCephOss::configure)
+unsigned int g_aioDepth = 1;
+/// whether files open for read keep the next stripe unit read ahead
+/// even when g_aioDepth is 1 (See XrdCephOss::configure)
+bool g_readAhead = false;
 /// pointer to library providing Name2Name interface. 0 be default
 /// populated in case of ceph.namelib entry in the config file in XrdCephOss
 XrdOucName2Name *g_namelib = 0;
 
 /// global variable holding a list of files currently opened for write
 std::multiset<std::string> g_filesOpenForWrite;
-/// global variable holding a map of file descriptor to file reference
-std::map<unsigned int, CephFileRef> g_fds;
-/// global variable remembering the next available file descriptor
+/// global table of file descriptor to file reference. It is made of chunks
+/// allocated on demand and never freed, so that it can be read without any
+/// lock. Only insertions and deletions take g_fd_mutex
+#define CEPH_FD_CHUNKSIZE 1024
+#define CEPH_FD_NBCHUNKS  4096
+typedef std::atomic<CephFileRef*> CephFdSlot;
+std::atomic<CephFdSlot*> g_fdChunks[CEPH_FD_NBCHUNKS];
+/// global variable remembering the next never used file descriptor
 unsigned int g_nextCephFd = 0;
-/// mutex protecting the map of file descriptors and the openForWrite multiset
+/// file descriptors freed by close, to be reused
+std::vector<unsigned int> g_freeCephFds;
+/// mutex protecting updates of the file descriptors table and the openForWrite multiset
 XrdSysMutex g_fd_mutex;
 /// mutex protecting initialization of ceph clusters
 XrdSysMutex g_init_mutex;
@@ -148,41 +195,62 @@ bool isOpenForWrite(std::string& name) {
   return g_filesOpenForWrite.find(name) != g_filesOpenForWrite.end();
 }
 
-/// look for a FileRef from its file descriptor
+/// look for a FileRef from its file descriptor, without locking
 CephFileRef* getFileRef(int fd) {
-  XrdSysMutexHelper lock(g_fd_mutex);
-  std::map<unsigned int, CephFileRef>::iterator it = g_fds.find(fd);
-  if (it != g_fds.end()) {
-    return &(it->second);
-  } else {
+  if (fd < 0 || fd >= CEPH_FD_CHUNKSIZE * CEPH_FD_NBCHUNKS) {
     return 0;
   }
+  CephFdSlot *chunk = g_fdChunks[fd / CEPH_FD_CHUNKSIZE].load(std::memory_order_acquire);
+  if (0 == chunk) {
+    return 0;
+  }
+  return chunk[fd % CEPH_FD_CHUNKSIZE].load(std::memory_order_acquire);
 }
 
 /// deletes a FileRef from the global table of file descriptors
-void deleteFileRef(int fd, const CephFileRef &fr) {
+void deleteFileRef(int fd) {
   XrdSysMutexHelper lock(g_fd_mutex);
-  if (fr.flags & (O_WRONLY|O_RDWR)) {
-    g_filesOpenForWrite.erase(g_filesOpenForWrite.find(fr.name));
+  CephFileRef *fr = getFileRef(fd);
+  if (0 == fr) {
+    return;
   }
-  std::map<unsigned int, CephFileRef>::iterator it = g_fds.find(fd);
-  if (it != g_fds.end()) {
-    g_fds.erase(it);
+  if (fr->flags & (O_WRONLY|O_RDWR)) {
+    g_filesOpenForWrite.erase(g_filesOpenForWrite.find(fr->name));
   }
+  g_fdChunks[fd / CEPH_FD_CHUNKSIZE].load()[fd % CEPH_FD_CHUNKSIZE].store(0, std::memory_order_release);
+  g_freeCephFds.push_back(fd);
+  delete fr->aio;
+  delete fr;
 }
 
 /**
- * inserts a new FileRef into the global table of file descriptors
- * and return the associated file descriptor
+ * inserts a copy of a new FileRef into the global table of file descriptors
+ * and return the associated file descriptor, or -EMFILE if the table is full
  */
 int insertFileRef(CephFileRef &fr) {
   XrdSysMutexHelper lock(g_fd_mutex);
-  g_fds[g_nextCephFd] = fr;
-  g_nextCephFd++;
+  unsigned int fd;
+  if (!g_freeCephFds.empty()) {
+    fd = g_freeCephFds.back();
+    g_freeCephFds.pop_back();
+  } else if (g_nextCephFd < CEPH_FD_CHUNKSIZE * CEPH_FD_NBCHUNKS) {
+    fd = g_nextCephFd++;
+  } else {
+    return -EMFILE;
+  }
+  CephFdSlot *chunk = g_fdChunks[fd / CEPH_FD_CHUNKSIZE].load();
+  if (0 == chunk) {
+    chunk = new CephFdSlot[CEPH_FD_CHUNKSIZE];
+    for (unsigned int i = 0; i < CEPH_FD_CHUNKSIZE; i++) {
+      chunk[i].store(0);
+    }
+    g_fdChunks[fd / CEPH_FD_CHUNKSIZE].store(chunk, std::memory_order_release);
+  }
+  chunk[fd % CEPH_FD_CHUNKSIZE].store(new CephFileRef(fr), std::memory_order_release);
   if (fr.flags & (O_WRONLY|O_RDWR)) {
     g_filesOpenForWrite.insert(fr.name);
   }
-  return g_nextCephFd-1;
+  return fd;
 }
 
 /// global variable containing defaults for CephFiles
@@ -427,6 +495,9 @@ static CephFileRef getCephFileRef(const char *path, XrdOucEnv *env, int flags,
   fr.offset = 0;
   fr.rdcount = 0;
   fr.wrcount = 0;
+  fr.aio = 0;
+  fr.striper = 0;
+  fr.cluster = 0;
   return fr;
 }
 
@@ -552,7 +623,8 @@ int checkAndCreateStriper(unsigned int cephPoolIdx, std::string &userAtPool, con
   return 1;
 } 
 
-static libradosstriper::RadosStriper* getRadosStriper(const CephFile& file) {
+static libradosstriper::RadosStriper* getRadosStriper(const CephFile& file,
+                                                      librados::Rados **cluster = 0) {
   XrdSysMutexHelper lock(g_striper_mutex);
   std::stringstream ss;
   ss << file.userId << '@' << file.pool << ',' << file.nbStripes << ','
@@ -563,6 +635,9 @@ static libradosstriper::RadosStriper* getRadosStriper(const CephFile& file) {
     logwrapper((char*)"getRadosStriper : checkAndCreateStriper failed");
     return 0;
   }
+  if (cluster) {
+    *cluster = g_cluster[cephPoolIdx];
+  }
   return g_radosStripers[cephPoolIdx][userAtPool];
 }
 
@@ -605,27 +680,190 @@ void ceph_posix_set_logfunc(void (*logfunc) (char *, va_list argp)) {
 
 static int ceph_posix_internal_truncate(const CephFile &file, unsigned long long size);
 
+/// creates a completion for waiting on an aio call of the file
+static librados::AioCompletion* ceph_aio_create_completion(CephFileRef &fr) {
+  return fr.cluster->aio_create_completion();
+}
+
+/// waits for and forgets all blocks read ahead. Must be called with the state mutex
+static void ceph_aio_drop_reads(CephAioState &st) {
+  for (std::list<CephReadBlock*>::iterator it = st.blocks.begin(); it != st.blocks.end(); it++) {
+    (*it)->completion->wait_for_complete();
+    (*it)->completion->release();
+    delete *it;
+  }
+  st.blocks.clear();
+}
+
+/// waits until at most keep writes are in flight, remembering the first error.
+/// Must be called with the state mutex
+static void ceph_aio_wait_writes(CephAioState &st, size_t keep) {
+  while (!st.writes.empty() && (st.writes.size() > keep || st.writes.front()->is_complete())) {
+    librados::AioCompletion *completion = st.writes.front();
+    st.writes.pop_front();
+    completion->wait_for_complete();
+    int rc = completion->get_return_value();
+    completion->release();
+    if (rc < 0 && 0 == st.writeError) {
+      st.writeError = rc;
+    }
+  }
+}
+
+/// returns and clears the first error of the writes behind
+static int ceph_aio_write_error(CephAioState &st) {
+  int rc = st.writeError;
+  st.writeError = 0;
+  return rc;
+}
+
+/// waits for all aio of the file and returns the first write error
+static int ceph_aio_sync(CephFileRef &fr) {
+  XrdSysMutexHelper lock(fr.aio->mutex);
+  ceph_aio_drop_reads(*fr.aio);
+  ceph_aio_wait_writes(*fr.aio, 0);
+  return ceph_aio_write_error(*fr.aio);
+}
+
+/**
+ * pread reading ahead : sequential reads keep g_aioDepth stripe units in
+ * flight, so that consecutive objects of the file are read in parallel.
+ * With g_readAhead, at least the next stripe unit is kept in flight.
+ * Other reads drop the blocks read ahead and go straight to the striper
+ */
+static ssize_t ceph_aio_pread(CephFileRef &fr, libradosstriper::RadosStriper *striper,
+                              void *buf, size_t count, off64_t offset) {
+  CephAioState &st = *fr.aio;
+  XrdSysMutexHelper lock(st.mutex);
+  off64_t bsz = fr.stripeUnit;
+  unsigned int depth = std::max(g_aioDepth, g_readAhead ? 2u : 1u);
+  // writes behind must have landed before we read
+  ceph_aio_wait_writes(st, 0);
+  int rc = ceph_aio_write_error(st);
+  if (rc) return rc;
+  bool covered = !st.blocks.empty() && st.blocks.front()->offset <= offset &&
+    offset < st.blocks.back()->offset + bsz;
+  if ((offset != st.nextRead && !covered) || (off64_t)count > depth * bsz) {
+    ceph_aio_drop_reads(st);
+    ceph::bufferlist bl;
+    rc = striper->read(fr.name, &bl, count, offset);
+    if (rc < 0) return rc;
+    bl.copy(0, rc, (char*)buf);
+    st.nextRead = offset + rc;
+    fr.rdcount++;
+    return rc;
+  }
+  // forget the blocks we went past
+  while (!st.blocks.empty() && st.blocks.front()->offset + bsz <= offset) {
+    CephReadBlock *block = st.blocks.front();
+    st.blocks.pop_front();
+    block->completion->wait_for_complete();
+    block->completion->release();
+    delete block;
+  }
+  // issue the missing blocks
+  off64_t next = st.blocks.empty() ? (offset / bsz) * bsz : st.blocks.back()->offset + bsz;
+  while (st.blocks.size() < depth) {
+    CephReadBlock *block = new CephReadBlock(next);
+    block->completion = ceph_aio_create_completion(fr);
+    if (0 == block->completion) {
+      delete block;
+      break;
+    }
+    if (striper->aio_read(fr.name, block->completion, &block->bl, bsz, next) < 0) {
+      block->completion->release();
+      delete block;
+      break;
+    }
+    st.blocks.push_back(block);
+    next += bsz;
+  }
+  if (st.blocks.empty()) {
+    return -EIO;
+  }
+  // copy the data out of the blocks
+  size_t done = 0;
+  for (std::list<CephReadBlock*>::iterator it = st.blocks.begin();
+       it != st.blocks.end() && done < count; it++) {
+    CephReadBlock *block = *it;
+    block->completion->wait_for_complete();
+    int brc = block->completion->get_return_value();
+    if (brc < 0) {
+      ceph_aio_drop_reads(st);
+      if (done) break;
+      return brc;
+    }
+    off64_t inBlock = offset + done - block->offset;
+    if (brc <= inBlock) break;
+    size_t n = std::min((size_t)(brc - inBlock), count - done);
+    block->bl.copy(inBlock, n, (char*)buf + done);
+    done += n;
+    // end of file
+    if (brc < bsz) break;
+  }
+  st.nextRead = offset + done;
+  fr.rdcount++;
+  return done;
+}
+
+/**
+ * pwrite writing behind : the data is copied and written asynchronously,
+ * with up to g_aioDepth writes in flight. Errors are returned by a later
+ * write, fsync or close
+ */
+static ssize_t ceph_aio_pwrite(CephFileRef &fr, libradosstriper::RadosStriper *striper,
+                               const void *buf, size_t count, off64_t offset) {
+  CephAioState &st = *fr.aio;
+  XrdSysMutexHelper lock(st.mutex);
+  ceph_aio_drop_reads(st);
+  ceph_aio_wait_writes(st, g_aioDepth - 1);
+  int rc = ceph_aio_write_error(st);
+  if (rc) return rc;
+  librados::AioCompletion *completion = ceph_aio_create_completion(fr);
+  if (0 == completion) {
+    return -EINVAL;
+  }
+  ceph::bufferlist bl;
+  bl.append((const char*)buf, count);
+  rc = striper->aio_write(fr.name, completion, bl, count, offset);
+  if (rc) {
+    completion->release();
+    return rc;
+  }
+  st.writes.push_back(completion);
+  fr.wrcount++;
+  return count;
+}
+
 int ceph_posix_open(XrdOucEnv* env, const char *pathname, int flags, mode_t mode) {
   CephFileRef fr = getCephFileRef(pathname, env, flags, mode, 0);
+  // resolve the striper once, the I/O calls use it from the file reference
+  fr.striper = getRadosStriper(fr, &fr.cluster);
+  if (0 == fr.striper) {
+    return -EINVAL;
+  }
+  if (g_aioDepth > 1 || (g_readAhead && (flags & O_ACCMODE) == O_RDONLY)) {
+    fr.aio = new CephAioState();
+  }
   int fd = insertFileRef(fr);
+  if (fd < 0) {
+    delete fr.aio;
+    return fd;
+  }
   logwrapper((char*)"ceph_open: fd %d associated to %s", fd, pathname);
   // in case of O_CREAT and O_EXCL, we should complain if the file exists
   // in case of O_READ, the file has to exist
   if (((flags & O_CREAT) && (flags & O_EXCL)) || ((flags&O_ACCMODE) == O_RDONLY)) {
-    libradosstriper::RadosStriper *striper = getRadosStriper(fr);
-    if (0 == striper) {
-      deleteFileRef(fd, fr);
-      return -EINVAL;
-    }
+    libradosstriper::RadosStriper *striper = fr.striper;
     struct stat buf;
     int rc = striper->stat(fr.name, (uint64_t*)&(buf.st_size), &(buf.st_atime));
     if ((flags&O_ACCMODE) == O_RDONLY) {
       if (rc) {
-        deleteFileRef(fd, fr);
+        deleteFileRef(fd);
         return rc;
       }
     } else if (rc != -ENOENT) {
-      deleteFileRef(fd, fr);
+      deleteFileRef(fd);
       if (0 == rc) return -EEXIST;
       return rc;
     }
@@ -635,7 +873,7 @@ int ceph_posix_open(XrdOucEnv* env, const char *pathname, int flags, mode_t mode
     int rc = ceph_posix_internal_truncate(fr, 0);
     // fail only if file exists and cannot be truncated
     if (rc < 0 && rc != -ENOENT) {
-      deleteFileRef(fd, fr);
+      deleteFileRef(fd);
       return rc;
     }
   }
@@ -645,10 +883,14 @@ int ceph_posix_open(XrdOucEnv* env, const char *pathname, int flags, mode_t mode
 int ceph_posix_close(int fd) {
   CephFileRef* fr = getFileRef(fd);
   if (fr) {
+    int rc = 0;
+    if (fr->aio) {
+      rc = ceph_aio_sync(*fr);
+    }
     logwrapper((char*)"ceph_close: closed fd %d for file %s, read ops count %d, write ops count %d",
                fd, fr->name.c_str(), fr->rdcount, fr->wrcount);
-    deleteFileRef(fd, *fr);
-    return 0;
+    deleteFileRef(fd);
+    return rc;
   } else {
     return -EBADF;
   }
@@ -695,10 +937,15 @@ ssize_t ceph_posix_write(int fd, const void *buf, size_t count) {
     if ((fr->flags & (O_WRONLY|O_RDWR)) == 0) {
       return -EBADF;
     }
-    libradosstriper::RadosStriper *striper = getRadosStriper(*fr);
+    libradosstriper::RadosStriper *striper = fr->striper;
     if (0 == striper) {
       return -EINVAL;
     }
+    if (fr->aio) {
+      ssize_t rc = ceph_aio_pwrite(*fr, striper, buf, count, fr->offset);
+      if (rc > 0) fr->offset += rc;
+      return rc;
+    }
     ceph::bufferlist bl;
     bl.append((const char*)buf, count);
     int rc = striper->write(fr->name, bl, count, fr->offset);
@@ -719,10 +966,13 @@ ssize_t ceph_posix_pwrite(int fd, const void *buf, size_t count, off64_t offset)
     if ((fr->flags & (O_WRONLY|O_RDWR)) == 0) {
       return -EBADF;
     }
-    libradosstriper::RadosStriper *striper = getRadosStriper(*fr);
+    libradosstriper::RadosStriper *striper = fr->striper;
     if (0 == striper) {
       return -EINVAL;
     }
+    if (fr->aio) {
+      return ceph_aio_pwrite(*fr, striper, buf, count, offset);
+    }
     ceph::bufferlist bl;
     bl.append((const char*)buf, count);
     int rc = striper->write(fr->name, bl, count, offset);
@@ -754,20 +1004,21 @@ ssize_t ceph_aio_write(int fd, XrdSfsAio *aiop, AioCB *cb) {
       return -EBADF;
     }
     // get the striper object
-    libradosstriper::RadosStriper *striper = getRadosStriper(*fr);
+    libradosstriper::RadosStriper *striper = fr->striper;
     if (0 == striper) {
       return -EINVAL;
     }
+    // blocks read ahead would not see this write
+    if (fr->aio) {
+      XrdSysMutexHelper lock(fr->aio->mutex);
+      ceph_aio_drop_reads(*fr->aio);
+    }
     // prepare a bufferlist around the given buffer
     ceph::bufferlist bl;
     bl.append(buf, count);
     // get the poolIdx to use
-    int cephPoolIdx = getCephPoolIdxAndIncrease();
-    // Get the cluster to use
-    librados::Rados* cluster = checkAndCreateCluster(cephPoolIdx);
-    if (0 == cluster) {
-      return -EINVAL;
-    }
+    // get the cluster the striper uses
+    librados::Rados* cluster = fr->cluster;
     // prepare a ceph AioCompletion object and do async call
     AioArgs *args = new AioArgs(aiop, cb, count);
     librados::AioCompletion *completion =
@@ -789,10 +1040,15 @@ ssize_t ceph_posix_read(int fd, void *buf, size_t count) {
     if ((fr->flags & O_WRONLY) != 0) {
       return -EBADF;
     }
-    libradosstriper::RadosStriper *striper = getRadosStriper(*fr);
+    libradosstriper::RadosStriper *striper = fr->striper;
     if (0 == striper) {
       return -EINVAL;
     }
+    if (fr->aio) {
+      ssize_t rc = ceph_aio_pread(*fr, striper, buf, count, fr->offset);
+      if (rc > 0) fr->offset += rc;
+      return rc;
+    }
     ceph::bufferlist bl;
     int rc = striper->read(fr->name, &bl, count, fr->offset);
     if (rc < 0) return rc;
@@ -813,10 +1069,13 @@ ssize_t ceph_posix_pread(int fd, void *buf, size_t count, off64_t offset) {
     if ((fr->flags & O_WRONLY) != 0) {
       return -EBADF;
     }
-    libradosstriper::RadosStriper *striper = getRadosStriper(*fr);
+    libradosstriper::RadosStriper *striper = fr->striper;
     if (0 == striper) {
       return -EINVAL;
     }
+    if (fr->aio) {
+      return ceph_aio_pread(*fr, striper, buf, count, offset);
+    }
     ceph::bufferlist bl;
     int rc = striper->read(fr->name, &bl, count, offset);
     if (rc < 0) return rc;
@@ -828,6 +1087,109 @@ ssize_t ceph_posix_pread(int fd, void *buf, size_t count, off64_t offset) {
   }
 }
 
+/// largest hole between two readv segments of the same stripe unit that is
+/// still read through rather than split into two concurrent reads
+static const off64_t g_readVMaxGap = 128*1024;
+
+/// one rados read covering close segments of a readv within a stripe unit
+struct CephReadGroup {
+  CephReadGroup(off64_t o, size_t l, int f) :
+    offset(o), len(l), first(f), last(f), completion(0) {}
+  off64_t offset;
+  size_t len;
+  int first;
+  int last;
+  librados::AioCompletion *completion;
+  ceph::bufferlist bl;
+};
+
+/// orders readv segments by offset
+struct CephReadVOrder {
+  CephReadVOrder(XrdOucIOVec *v) : readV(v) {}
+  bool operator()(int a, int b) const { return readV[a].offset < readV[b].offset; }
+  XrdOucIOVec *readV;
+};
+
+ssize_t ceph_posix_readv(int fd, XrdOucIOVec *readV, int n) {
+  CephFileRef* fr = getFileRef(fd);
+  if (fr) {
+    if ((fr->flags & O_WRONLY) != 0) {
+      return -EBADF;
+    }
+    libradosstriper::RadosStriper *striper = fr->striper;
+    if (0 == striper) {
+      return -EINVAL;
+    }
+    // writes behind must have landed before we read
+    if (fr->aio) {
+      XrdSysMutexHelper lock(fr->aio->mutex);
+      ceph_aio_wait_writes(*fr->aio, 0);
+    }
+    // sort the segments and group those close to each other in the same
+    // stripe unit, so that the whole vector costs about one OSD round trip
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), CephReadVOrder(readV));
+    off64_t bsz = fr->stripeUnit;
+    std::vector<CephReadGroup*> groups;
+    for (int k = 0; k < n; k++) {
+      XrdOucIOVec &seg = readV[order[k]];
+      if (!groups.empty() && seg.offset / bsz == groups.back()->offset / bsz &&
+          seg.offset <= groups.back()->offset + (off64_t)groups.back()->len + g_readVMaxGap) {
+        CephReadGroup *group = groups.back();
+        off64_t end = std::max(group->offset + (off64_t)group->len, (off64_t)(seg.offset + seg.size));
+        group->len = end - group->offset;
+        group->last = k;
+      } else {
+        groups.push_back(new CephReadGroup(seg.offset, seg.size, k));
+      }
+    }
+    // issue one read per group, all in parallel
+    ssize_t rc = 0;
+    for (size_t g = 0; g < groups.size(); g++) {
+      CephReadGroup *group = groups[g];
+      group->completion = fr->cluster->aio_create_completion();
+      if (0 == group->completion) {
+        rc = -EINVAL;
+        break;
+      }
+      int arc = striper->aio_read(fr->name, group->completion, &group->bl, group->len, group->offset);
+      if (arc < 0) {
+        group->completion->release();
+        group->completion = 0;
+        rc = arc;
+        break;
+      }
+    }
+    // collect the data, a short segment is an error like in XrdOssDF::ReadV
+    ssize_t nbytes = 0;
+    for (size_t g = 0; g < groups.size(); g++) {
+      CephReadGroup *group = groups[g];
+      if (group->completion) {
+        group->completion->wait_for_complete();
+        int grc = group->completion->get_return_value();
+        group->completion->release();
+        if (grc < 0 && 0 == rc) rc = grc;
+        for (int k = group->first; 0 == rc && k <= group->last; k++) {
+          XrdOucIOVec &seg = readV[order[k]];
+          off64_t inGroup = seg.offset - group->offset;
+          if (grc - inGroup < seg.size) {
+            rc = -ESPIPE;
+            break;
+          }
+          group->bl.copy(inGroup, seg.size, seg.data);
+          nbytes += seg.size;
+        }
+      }
+      delete group;
+    }
+    fr->rdcount++;
+    return (rc ? rc : nbytes);
+  } else {
+    return -EBADF;
+  }
+}
+
 static void ceph_aio_read_complete(rados_completion_t c, void *arg) {
   AioArgs *awa = reinterpret_cast<AioArgs*>(arg);
   size_t rc = rados_aio_get_return_value(c);
@@ -854,19 +1216,20 @@ ssize_t ceph_aio_read(int fd, XrdSfsAio *aiop, AioCB *cb) {
       return -EBADF;
     }
     // get the striper object
-    libradosstriper::RadosStriper *striper = getRadosStriper(*fr);
+    libradosstriper::RadosStriper *striper = fr->striper;
     if (0 == striper) {
       return -EINVAL;
     }
+    // writes behind must have landed before we read
+    if (fr->aio) {
+      XrdSysMutexHelper lock(fr->aio->mutex);
+      ceph_aio_wait_writes(*fr->aio, 0);
+    }
     // prepare a bufferlist to receive data
     ceph::bufferlist *bl = new ceph::bufferlist();
     // get the poolIdx to use
-    int cephPoolIdx = getCephPoolIdxAndIncrease();
-    // Get the cluster to use
-    librados::Rados* cluster = checkAndCreateCluster(cephPoolIdx);
-    if (0 == cluster) {
-      return -EINVAL;
-    }
+    // get the cluster the striper uses
+    librados::Rados* cluster = fr->cluster;
     // prepare a ceph AioCompletion object and do async call
     AioArgs *args = new AioArgs(aiop, cb, count, bl);
     librados::AioCompletion *completion =
@@ -887,11 +1250,16 @@ int ceph_posix_fstat(int fd, struct stat *buf) {
     // minimal stat : only size and times are filled
     // atime, mtime and ctime are set all to the same value
     // mode is set arbitrarily to 0666 | S_IFREG
-    libradosstriper::RadosStriper *striper = getRadosStriper(*fr);
+    libradosstriper::RadosStriper *striper = fr->striper;
     if (0 == striper) {
       logwrapper((char*)"ceph_stat: getRadosStriper failed");
       return -EINVAL;
     }
+    // the size must include the writes behind
+    if (fr->aio) {
+      XrdSysMutexHelper lock(fr->aio->mutex);
+      ceph_aio_wait_writes(*fr->aio, 0);
+    }
     memset(buf, 0, sizeof(*buf));
     int rc = striper->stat(fr->name, (uint64_t*)&(buf->st_size), &(buf->st_atime));
     if (rc != 0) {
@@ -938,6 +1306,9 @@ int ceph_posix_fsync(int fd) {
   CephFileRef* fr = getFileRef(fd);
   if (fr) {
     logwrapper((char*)"ceph_sync: fd %d", fd);
+    if (fr->aio) {
+      return ceph_aio_sync(*fr);
+    }
     return 0;
   } else {
     return -EBADF;
@@ -1143,6 +1514,10 @@ int ceph_posix_ftruncate(int fd, unsigned long long size) {
   CephFileRef* fr = getFileRef(fd);
   if (fr) {
     logwrapper((char*)"ceph_posix_ftruncate: fd %d, size %d", fd, size);
+    if (fr->aio) {
+      int rc = ceph_aio_sync(*fr);
+      if (rc) return rc;
+    }
     return ceph_posix_internal_truncate(*fr, size);
   } else {
     return -EBADF;
@@ -33,6 +33,7 @@
 #include <stdarg.h>
 #include <dirent.h>
 #include <XrdOuc/XrdOucEnv.hh>
+#include <XrdOuc/XrdOucIOVec.hh>
 #include <XrdSys/XrdSysXAttr.hh>
 
 class XrdSfsAio;
@@ -51,6 +52,7 @@ ssize_t ceph_aio_write(int fd, XrdSfsAio *aiop, AioCB *cb);
 ssize_t ceph_posix_read(int fd, void *buf, size_t count);
 ssize_t ceph_posix_pread(int fd, void *buf, size_t count, off64_t offset);
 ssize_t ceph_aio_read(int fd, XrdSfsAio *aiop, AioCB *cb);
+ssize_t ceph_posix_readv(int fd, XrdOucIOVec *readV, int n);
 int ceph_posix_fstat(int fd, struct stat *buf);
 int ceph_posix_stat(XrdOucEnv* env, const char *pathname, struct stat *buf);
 int ceph_posix_fsync(int fd);
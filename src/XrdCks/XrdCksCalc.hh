@@ -54,6 +54,22 @@ public:
 virtual char *Calc(const char *Buff, int BLen)
                   {Init(); Update(Buff, BLen); return Final();}
 
+//------------------------------------------------------------------------------
+//! Append the running checksum of the data that immediately follows the data
+//! seen so far by this object. This allows ranges of a file to be checksummed
+//! concurrently and then combined. The default is that this isn't supported.
+//!
+//! @param    Next   -> Object obtained via New() that computed the checksum
+//!                     of the following data. When nil, the call only tells
+//!                     whether combining is supported.
+//! @param    NLen   -> Number of bytes that were checksummed by Next.
+//!
+//! @return   true if the checksums were (or can be) combined; false otherwise.
+//------------------------------------------------------------------------------
+
+virtual bool  Combine(XrdCksCalc *Next, long long NLen)
+                     {(void)Next; (void)NLen; return false;}
+
 //------------------------------------------------------------------------------
 //! Get the current binary checksum value (defaults to final). However, the
 //! final checksum result is not affected.
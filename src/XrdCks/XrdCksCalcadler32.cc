@@ -0,0 +1,235 @@
+/******************************************************************************/
+/*                                                                            */
+/*                  X r d C k s C a l c a d l e r 3 2 . c c                   */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdCks/XrdCksCalcadler32.hh"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define XRDCKS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/* The following implementation of adler32 was derived from zlib and is
+                   * Copyright (C) 1995-1998 Mark Adler
+   Below are the zlib license terms for this implementation.
+*/
+  
+/* zlib.h -- interface of the 'zlib' general purpose compression library
+  version 1.1.4, March 11th, 2002
+
+  Copyright (C) 1995-2002 Jean-loup Gailly and Mark Adler
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+
+  Jean-loup Gailly        Mark Adler
+  jloup@gzip.org          madler@alumni.caltech.edu
+
+
+  The data format used by the zlib library is described by RFCs (Request for
+  Comments) 1950 to 1952 in the files ftp://ds.internic.net/rfc/rfc1950.txt
+  (zlib format), rfc1951.txt (deflate format) and rfc1952.txt (gzip format).
+*/
+
+#define DO1(buf)  {unSum1 += *buf++; unSum2 += unSum1;}
+#define DO2(buf)  DO1(buf); DO1(buf);
+#define DO4(buf)  DO2(buf); DO2(buf);
+#define DO8(buf)  DO4(buf); DO4(buf);
+#define DO16(buf) DO8(buf); DO8(buf);
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+  
+namespace
+{
+const unsigned int AdlerBase  = 0xFFF1;
+const          int AdlerNMax  = 5552;
+
+/* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
+
+typedef void (*AdlerSum_t)(unsigned int &, unsigned int &,
+                           const unsigned char *, int);
+
+/******************************************************************************/
+/*                            A d l e r S c a l a r                           */
+/******************************************************************************/
+
+void AdlerScalar(unsigned int &Sum1, unsigned int &Sum2,
+                 const unsigned char *buff, int BLen)
+{
+// Work on local copies, the byte pointer could alias the references
+//
+   unsigned int unSum1 = Sum1, unSum2 = Sum2;
+   int k;
+   while(BLen > 0)
+        {k = (BLen < AdlerNMax ? BLen : AdlerNMax);
+         BLen -= k;
+         while(k >= 16) {DO16(buff); k -= 16;}
+         if (k != 0) do {DO1(buff);} while (--k);
+         unSum1 %= AdlerBase; unSum2 %= AdlerBase;
+        }
+   Sum1 = unSum1; Sum2 = unSum2;
+}
+
+#ifdef XRDCKS_X86_SIMD
+/******************************************************************************/
+/*                              A d l e r A V X 2                             */
+/******************************************************************************/
+
+// Each 32 byte block adds the byte sum to s1 and the byte sum weighted by
+// 32..1 to s2, plus 32 times the s1 value that precedes the block. The running
+// sum of block-start s1 values is kept in vPS and scaled once per NMAX run.
+//
+__attribute__((target("avx2")))
+void AdlerAVX2(unsigned int &unSum1, unsigned int &unSum2,
+               const unsigned char *buff, int BLen)
+{
+   const __m256i vTaps = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                          24, 23, 22, 21, 20, 19, 18, 17,
+                                          16, 15, 14, 13, 12, 11, 10,  9,
+                                           8,  7,  6,  5,  4,  3,  2,  1);
+   const __m256i vOnes = _mm256_set1_epi16(1);
+   const __m256i vZero = _mm256_setzero_si256();
+   int blocks = BLen / 32;
+
+   BLen -= blocks * 32;
+   while(blocks)
+        {int n = (blocks < AdlerNMax/32 ? blocks : AdlerNMax/32);
+         blocks -= n;
+
+         __m256i vPS = _mm256_setr_epi32(unSum1 * n, 0, 0, 0, 0, 0, 0, 0);
+         __m256i vS2 = _mm256_setr_epi32(unSum2,     0, 0, 0, 0, 0, 0, 0);
+         __m256i vS1 = vZero;
+
+         do {__m256i bytes = _mm256_loadu_si256((const __m256i *)buff);
+             vPS = _mm256_add_epi32(vPS, vS1);
+             vS1 = _mm256_add_epi32(vS1, _mm256_sad_epu8(bytes, vZero));
+             __m256i mad = _mm256_maddubs_epi16(bytes, vTaps);
+             vS2 = _mm256_add_epi32(vS2, _mm256_madd_epi16(mad, vOnes));
+             buff += 32;
+            } while(--n);
+
+         vS2 = _mm256_add_epi32(vS2, _mm256_slli_epi32(vPS, 5));
+
+         __m128i s1 = _mm_add_epi32(_mm256_castsi256_si128(vS1),
+                                    _mm256_extracti128_si256(vS1, 1));
+         __m128i s2 = _mm_add_epi32(_mm256_castsi256_si128(vS2),
+                                    _mm256_extracti128_si256(vS2, 1));
+         s1 = _mm_add_epi32(s1, _mm_shuffle_epi32(s1, _MM_SHUFFLE(1,0,3,2)));
+         s2 = _mm_add_epi32(s2, _mm_shuffle_epi32(s2, _MM_SHUFFLE(1,0,3,2)));
+         s2 = _mm_add_epi32(s2, _mm_shuffle_epi32(s2, _MM_SHUFFLE(2,3,0,1)));
+
+         unSum1 = (unSum1 + (unsigned int)_mm_cvtsi128_si32(s1)) % AdlerBase;
+         unSum2 = (unsigned int)_mm_cvtsi128_si32(s2) % AdlerBase;
+        }
+
+// Whatever is left is less than one block
+//
+   if (BLen) AdlerScalar(unSum1, unSum2, buff, BLen);
+}
+#endif
+
+/******************************************************************************/
+/*                            A d l e r P i c k                               */
+/******************************************************************************/
+
+void AdlerPick(unsigned int &, unsigned int &, const unsigned char *, int);
+
+AdlerSum_t AdlerSum = AdlerPick;
+
+// The first call selects the kernel for the processor we are running on. All
+// kernels give identical results so a racing first call is harmless.
+//
+void AdlerPick(unsigned int &unSum1, unsigned int &unSum2,
+               const unsigned char *buff, int BLen)
+{
+   AdlerSum_t theSum = AdlerScalar;
+
+#ifdef XRDCKS_X86_SIMD
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2")) theSum = AdlerAVX2;
+#endif
+
+   AdlerSum = theSum;
+   theSum(unSum1, unSum2, buff, BLen);
+}
+}
+
+/******************************************************************************/
+/*                               C o m b i n e                                */
+/******************************************************************************/
+
+// This is the adler32_combine() method from zlib; the running sums are always
+// kept reduced modulo the base.
+//
+bool XrdCksCalcadler32::Combine(XrdCksCalc *Next, long long NLen)
+{
+   XrdCksCalcadler32 *nP = dynamic_cast<XrdCksCalcadler32 *>(Next);
+   unsigned int rem, sum1, sum2;
+
+// A nil object is a query; otherwise it must be one of ours
+//
+   if (!Next) return true;
+   if (!nP || NLen < 0) return false;
+
+// Combine the sums
+//
+   rem  = static_cast<unsigned int>(NLen % AdlerBase);
+   sum1 = unSum1;
+   sum2 = static_cast<unsigned int>((static_cast<unsigned long long>(rem)
+                                    * sum1) % AdlerBase);
+   sum1 += nP->unSum1 + AdlerBase - 1;
+   sum2 += unSum2 + nP->unSum2 + AdlerBase - rem;
+   if (sum1 >= AdlerBase) sum1 -= AdlerBase;
+   if (sum1 >= AdlerBase) sum1 -= AdlerBase;
+   if (sum2 >= (AdlerBase << 1)) sum2 -= (AdlerBase << 1);
+   if (sum2 >= AdlerBase) sum2 -= AdlerBase;
+   unSum1 = sum1; unSum2 = sum2;
+   return true;
+}
+
+/******************************************************************************/
+/*                                U p d a t e                                 */
+/******************************************************************************/
+  
+void XrdCksCalcadler32::Update(const char *Buff, int BLen)
+{
+   AdlerSum(unSum1, unSum2, (const unsigned char *)Buff, BLen);
+}
@@ -141,6 +141,242 @@ unsigned int XrdCksCalccrc32::crctable[256] =
 /*                   End of CRC Lookup Table                     */
 /*****************************************************************/
 
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define XRDCKS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+typedef unsigned int (*Crc32Sum_t)(const unsigned int *, unsigned int,
+                                   const unsigned char *, int);
+
+// Slicing-by-8 tables, SliceTab[0] is the class lookup table and entry k
+// gives the CRC of a byte followed by k zero bytes.
+//
+unsigned int SliceTab[8][256];
+
+/******************************************************************************/
+/*                              C r c B y t e s                               */
+/******************************************************************************/
+
+inline unsigned int CrcBytes(const unsigned int *tab, unsigned int crc,
+                             const unsigned char *p, int reclen)
+{
+   while(reclen-- > 0) crc = (crc<<8) ^ tab[(unsigned char)((crc>>24)^*p++)];
+   return crc;
+}
+
+/******************************************************************************/
+/*                              C r c S l i c e                               */
+/******************************************************************************/
+
+unsigned int CrcSlice(const unsigned int *tab, unsigned int crc,
+                      const unsigned char *p, int reclen)
+{
+   while(reclen >= 8)
+        {unsigned int one = crc ^ ((unsigned int)p[0] << 24
+                                 | (unsigned int)p[1] << 16
+                                 | (unsigned int)p[2] <<  8
+                                 | (unsigned int)p[3]);
+         crc = SliceTab[7][one >> 24]         ^ SliceTab[6][(one >> 16) & 0xff]
+             ^ SliceTab[5][(one >> 8) & 0xff] ^ SliceTab[4][one & 0xff]
+             ^ SliceTab[3][p[4]]              ^ SliceTab[2][p[5]]
+             ^ SliceTab[1][p[6]]              ^ SliceTab[0][p[7]];
+         p += 8; reclen -= 8;
+        }
+   return CrcBytes(tab, crc, p, reclen);
+}
+
+/******************************************************************************/
+/*                              C r c S h i f t                               */
+/******************************************************************************/
+
+// Multiply two polynomials modulo P
+//
+unsigned int CrcMulModP(unsigned int a, unsigned int b)
+{
+   unsigned int r = 0;
+   for (int i = 31; i >= 0; i--)
+       {r = (r & 0x80000000 ? (r << 1) ^ 0x04C11DB7 : r << 1);
+        if (b & (1U << i)) r ^= a;
+       }
+   return r;
+}
+
+// Return the CRC register after feeding it n zero bytes, i.e. crc * x^(8n).
+//
+unsigned int CrcShift(unsigned int crc, unsigned long long n)
+{
+   unsigned int xpow = 1, base = 0x100;
+
+   while(n)
+        {if (n & 1) xpow = CrcMulModP(xpow, base);
+         base = CrcMulModP(base, base); n >>= 1;
+        }
+   return CrcMulModP(crc, xpow);
+}
+
+#ifdef XRDCKS_X86_SIMD
+/******************************************************************************/
+/*                              C r c F o l d                                 */
+/******************************************************************************/
+
+// Folding constants x^n mod P for the (non-reflected) cksum polynomial
+//
+unsigned long long FoldK576, FoldK512, FoldK192, FoldK128, FoldK96, FoldK64;
+
+unsigned long long XpowModP(int n)
+{
+   unsigned int r = 1;
+   while(n--) r = (r & 0x80000000 ? (r << 1) ^ 0x04C11DB7 : r << 1);
+   return r;
+}
+
+// Each 16 byte block is loaded byte reversed so that the first byte holds the
+// highest degree coefficients. The accumulators are moved forward in the
+// stream by multiplying each 64 bit half with x^n mod P; at the end the single
+// remaining 128 bit accumulator A gives the CRC as A * x^32 mod P.
+//
+__attribute__((target("pclmul,ssse3")))
+inline __m128i CrcFold(__m128i x, __m128i k, __m128i next)
+{
+   return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                      _mm_clmulepi64_si128(x, k, 0x11)),
+                        next);
+}
+
+__attribute__((target("pclmul,ssse3")))
+unsigned int CrcPCLMUL(const unsigned int *tab, unsigned int crc,
+                       const unsigned char *p, int reclen)
+{
+   if (reclen < 64) return CrcSlice(tab, crc, p, reclen);
+
+   const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                        7,  6,  5,  4,  3,  2, 1, 0);
+   const __m128i *q = (const __m128i *)p;
+   __m128i x1, x2, x3, x4, k;
+
+   x1 = _mm_shuffle_epi8(_mm_loadu_si128(q+0), bswap);
+   x2 = _mm_shuffle_epi8(_mm_loadu_si128(q+1), bswap);
+   x3 = _mm_shuffle_epi8(_mm_loadu_si128(q+2), bswap);
+   x4 = _mm_shuffle_epi8(_mm_loadu_si128(q+3), bswap);
+   x1 = _mm_xor_si128(x1, _mm_setr_epi32(0, 0, 0, crc));
+   q += 4; reclen -= 64;
+
+// Fold 64 bytes at a time
+//
+   k = _mm_set_epi64x(FoldK576, FoldK512);
+   while(reclen >= 64)
+        {x1 = CrcFold(x1, k, _mm_shuffle_epi8(_mm_loadu_si128(q+0), bswap));
+         x2 = CrcFold(x2, k, _mm_shuffle_epi8(_mm_loadu_si128(q+1), bswap));
+         x3 = CrcFold(x3, k, _mm_shuffle_epi8(_mm_loadu_si128(q+2), bswap));
+         x4 = CrcFold(x4, k, _mm_shuffle_epi8(_mm_loadu_si128(q+3), bswap));
+         q += 4; reclen -= 64;
+        }
+
+// Fold the four accumulators into one and then 16 bytes at a time
+//
+   k  = _mm_set_epi64x(FoldK192, FoldK128);
+   x1 = CrcFold(x1, k, x2);
+   x1 = CrcFold(x1, k, x3);
+   x1 = CrcFold(x1, k, x4);
+   while(reclen >= 16)
+        {x1 = CrcFold(x1, k, _mm_shuffle_epi8(_mm_loadu_si128(q), bswap));
+         q++; reclen -= 16;
+        }
+
+// Reduce A * x^32 to 64 bits: H * x^96 + L * x^32, then the top 32 bits
+//
+   __m128i s = _mm_xor_si128(_mm_clmulepi64_si128(x1,
+                                  _mm_set_epi64x(0, FoldK96), 0x01),
+                             _mm_slli_si128(_mm_move_epi64(x1), 4));
+   s = _mm_xor_si128(_mm_move_epi64(s),
+                     _mm_clmulepi64_si128(_mm_srli_si128(s, 8),
+                                          _mm_set_epi64x(0, FoldK64), 0x00));
+
+// The last 64 bit value T gives (T_hi * x^32 mod P) ^ T_lo
+//
+   unsigned long long t = (unsigned long long)_mm_cvtsi128_si64(s);
+   unsigned char hi[4] = {(unsigned char)(t >> 56), (unsigned char)(t >> 48),
+                          (unsigned char)(t >> 40), (unsigned char)(t >> 32)};
+   crc = CrcBytes(tab, 0, hi, 4) ^ (unsigned int)t;
+
+   return CrcSlice(tab, crc, (const unsigned char *)q, reclen);
+}
+#endif
+
+/******************************************************************************/
+/*                              C r c P i c k                                 */
+/******************************************************************************/
+
+unsigned int CrcPick(const unsigned int *, unsigned int,
+                     const unsigned char *, int);
+
+Crc32Sum_t Crc32Sum = CrcPick;
+
+// The first call builds the tables and selects the kernel for the processor
+// we are running on. A racing first call recomputes identical values.
+//
+unsigned int CrcPick(const unsigned int *tab, unsigned int crc,
+                     const unsigned char *p, int reclen)
+{
+   Crc32Sum_t theSum = CrcSlice;
+
+   for (int i = 0; i < 256; i++)
+       {unsigned int v = SliceTab[0][i] = tab[i];
+        for (int k = 1; k < 8; k++)
+            SliceTab[k][i] = v = (v << 8) ^ tab[v >> 24];
+       }
+
+#ifdef XRDCKS_X86_SIMD
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3"))
+      {FoldK576 = XpowModP(576); FoldK512 = XpowModP(512);
+       FoldK192 = XpowModP(192); FoldK128 = XpowModP(128);
+       FoldK96  = XpowModP(96);  FoldK64  = XpowModP(64);
+       theSum = CrcPCLMUL;
+      }
+#endif
+
+   Crc32Sum = theSum;
+   return theSum(tab, crc, p, reclen);
+}
+}
+
+/******************************************************************************/
+/*                               C o m b i n e                                */
+/******************************************************************************/
+
+// The initial register is zero, so the register after A followed by B is the
+// register after A moved past len(B) zero bytes plus the register of B alone.
+// The length bytes are only appended by Final().
+//
+bool XrdCksCalccrc32::Combine(XrdCksCalc *Next, long long NLen)
+{
+   XrdCksCalccrc32 *nP = dynamic_cast<XrdCksCalccrc32 *>(Next);
+
+// A nil object is a query; otherwise it must be one of ours
+//
+   if (!Next) return true;
+   if (!nP || NLen != nP->TotLen) return false;
+
+// Combine the registers
+//
+   C32Result = CrcShift(C32Result, static_cast<unsigned long long>(NLen))
+             ^ nP->C32Result;
+   TotLen   += NLen;
+   return true;
+}
+
+/******************************************************************************/
+/*                                U p d a t e                                 */
+/******************************************************************************/
+
 /* Calculate CRC-32 Checksum for NAACCR Record,
    skipping area of record containing checksum field.
 
@@ -165,6 +401,7 @@ unsigned int XrdCksCalccrc32::crctable[256] =
      Use unsigned int instead of long to insure 32 bit values.
      Include length bits at the end to correspond to the Posix 1003.2 spec.
      Make this a C++ class.
+     Process eight bytes at a time or fold with carry-less multiplication.
 */
 void XrdCksCalccrc32::Update(const char *p, int reclen)
 {
@@ -172,7 +409,5 @@ void XrdCksCalccrc32::Update(const char *p, int reclen)
 // Process each byte
 //
    TotLen += reclen;
-   while(reclen-- > 0)
-        C32Result = (C32Result<<8) 
-                  ^ crctable[(unsigned char)((C32Result>>24)^*p++)];
+   C32Result = Crc32Sum(crctable, C32Result, (const unsigned char *)p, reclen);
 }
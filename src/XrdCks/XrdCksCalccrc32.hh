@@ -42,6 +42,8 @@ class XrdCksCalccrc32 : public XrdCksCalc
 {
 public:
 
+bool        Combine(XrdCksCalc *Next, long long NLen);
+
 char *Final() {char buff[sizeof(long long)];
                long long tLcs = TotLen;
                int i = 0;
@@ -70,7 +70,8 @@ XrdCksConfig::XrdCksConfig(const char *cFN, XrdSysError *Eroute, int &aOK,
 /*                             C o n f i g u r e                              */
 /******************************************************************************/
   
-XrdCks *XrdCksConfig::Configure(const char *dfltCalc, int rdsz, XrdOss *ossP)
+XrdCks *XrdCksConfig::Configure(const char *dfltCalc, int rdsz, XrdOss *ossP,
+                                int rdPar, XrdScheduler *schedP)
 {
    XrdCks *myCks = getCks(ossP, rdsz);
    XrdOucTList *tP = CksList;
@@ -80,6 +81,11 @@ XrdCks *XrdCksConfig::Configure(const char *dfltCalc, int rdsz, XrdOss *ossP)
 //
    if (!myCks) return 0;
 
+// Our own managers can compute a checksum in parallel, plugins are on their own
+//
+   if (!CksLib && rdPar > 1 && schedP)
+      static_cast<XrdCksManager *>(myCks)->SetParallel(rdPar, schedP);
+
 // Configure the object
 //
    while(tP) {NoGo |= myCks->Config("ckslib", tP->text); tP = tP->next;}
@@ -35,6 +35,7 @@
 class XrdCks;
 class XrdOss;
 class XrdOucStream;
+class XrdScheduler;
 class XrdSysError;
 
 struct XrdVersionInfo;
@@ -43,7 +44,8 @@ class XrdCksConfig
 {
 public:
 
-XrdCks *Configure(const char *dfltCalc=0, int rdsz=0, XrdOss *ossP=0);
+XrdCks *Configure(const char *dfltCalc=0, int rdsz=0, XrdOss *ossP=0,
+                  int rdPar=1, XrdScheduler *schedP=0);
 
 int     Manager() {return CksLib != 0;}
 
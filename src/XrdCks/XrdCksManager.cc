@@ -38,6 +38,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
   
+#include "Xrd/XrdJob.hh"
+#include "Xrd/XrdScheduler.hh"
 #include "XrdCks/XrdCksCalc.hh"
 #include "XrdCks/XrdCksCalcadler32.hh"
 #include "XrdCks/XrdCksCalccrc32.hh"
@@ -54,6 +56,135 @@
 #include "XrdSys/XrdSysPlugin.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+/******************************************************************************/
+/*                              C k s R a n g e                               */
+/******************************************************************************/
+
+// Checksum Length bytes starting at Offset, segSize bytes at a time using mmap
+// I/O. Returns 0 upon success and errno otherwise.
+//
+int CksRange(XrdSysError *eDest, int FD, const char *Pfn, off_t Offset,
+             off_t Length, int segSize, XrdCksCalc *csP)
+{
+   char *inBuff;
+   size_t ioSize;
+   int rc;
+
+   ioSize = (Length < (off_t)segSize ? Length : segSize);
+   while(Length)
+        {if ((inBuff = (char *)mmap(0, ioSize, PROT_READ,
+#if defined(__FreeBSD__)
+                       MAP_RESERVED0040|MAP_PRIVATE, FD, Offset)) == MAP_FAILED)
+#else
+                       MAP_NORESERVE|MAP_PRIVATE, FD, Offset)) == MAP_FAILED)
+#endif
+            {rc = errno; eDest->Emsg("Cks", rc, "memory map", Pfn);
+             return (rc ? rc : EIO);
+            }
+         madvise(inBuff, ioSize, MADV_SEQUENTIAL);
+         csP->Update(inBuff, ioSize);
+         Length -= ioSize; Offset += ioSize;
+         if (munmap(inBuff, ioSize) < 0)
+            {rc = errno; eDest->Emsg("Cks",rc,"unmap memory for",Pfn);
+             return (rc ? rc : EIO);
+            }
+         if (Length < (off_t)segSize) ioSize = Length;
+        }
+   return 0;
+}
+
+/******************************************************************************/
+/*                           C k s P a r a l l e l                            */
+/******************************************************************************/
+
+// The ranges of a file are handed out to whoever asks first, the calling
+// thread included, so the computation completes even when no scheduler thread
+// ever runs a helper. The last reference deletes the object; a helper that
+// runs after all ranges were taken merely drops its reference.
+//
+class CksParallel
+{
+public:
+
+struct Range {XrdCksCalc *csP; off_t Offset; off_t Length; int rc;};
+
+class  Helper : public XrdJob
+      {public:
+       void DoIt() {Parent->Work(); Parent->Unref();}
+       CksParallel *Parent;
+       Helper() : XrdJob("cks range"), Parent(0) {}
+      };
+
+Range  *rTab;
+Helper *hTab;
+
+void    Start(XrdScheduler *sP)
+               {numRefs += numRanges-1;
+                for (int i = 0; i < numRanges-1; i++) sP->Schedule(&hTab[i]);
+               }
+
+void    Unref() {ctxMutex.Lock();
+                 bool isLast = (--numRefs == 0);
+                 ctxMutex.UnLock();
+                 if (isLast) delete this;
+                }
+
+void    Wait()  {ctxMutex.Lock();
+                 bool isDone = (numDone == numRanges);
+                 ctxMutex.UnLock();
+                 if (!isDone) doneSem.Wait();
+                }
+
+void    Work()
+               {int rNum;
+                while(true)
+                     {ctxMutex.Lock();
+                      if (nextRange >= numRanges) {ctxMutex.UnLock(); break;}
+                      rNum = nextRange++;
+                      ctxMutex.UnLock();
+                      Range &rP = rTab[rNum];
+                      rP.rc = CksRange(eDest, fileFD, filePath, rP.Offset,
+                                       rP.Length, segSize, rP.csP);
+                      ctxMutex.Lock();
+                      if (++numDone == numRanges) doneSem.Post();
+                      ctxMutex.UnLock();
+                     }
+               }
+
+        CksParallel(XrdSysError *erP, int fd, const char *pfn, int sSize,
+                    int nRanges)
+                   : rTab(new Range[nRanges]()), hTab(new Helper[nRanges-1]),
+                     eDest(erP), filePath(pfn), fileFD(fd), segSize(sSize),
+                     numRanges(nRanges), nextRange(0), numDone(0),
+                     numRefs(1), doneSem(0)
+                   {for (int i = 0; i < nRanges-1; i++) hTab[i].Parent = this;}
+
+       ~CksParallel() {for (int i = 1; i < numRanges; i++)
+                           if (rTab[i].csP) rTab[i].csP->Recycle();
+                       delete [] rTab;
+                       delete [] hTab;
+                      }
+private:
+
+XrdSysMutex      ctxMutex;
+XrdSysError     *eDest;
+const char      *filePath;
+int              fileFD;
+int              segSize;
+int              numRanges;
+int              nextRange;
+int              numDone;
+int              numRefs;
+XrdSysSemaphore  doneSem;
+};
+}
+
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -75,6 +206,11 @@ XrdCksManager::XrdCksManager(XrdSysError *erP, int rdsz, XrdVersionInfo &vInfo,
    strcpy(csTab[2].Name, "md5");
    csLast = 2;
 
+// Checksums are computed sequentially unless we are told otherwise
+//
+   rdPar  = 1;
+   schedP = 0;
+
 // Compute the i/o size
 //
    if (rdsz <= 65536) segSize = 67108864;
@@ -152,10 +288,8 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
             ~ioFD() {if (FD >= 0) close(FD);}
         } In;
    struct stat Stat;
-   char *inBuff;
-   off_t  Offset=0, fileSize;
-   size_t ioSize, calcSize;
-   int rc;
+   off_t  fileSize, rngSize;
+   int i, nRanges, rc;
 
 // Open the input file
 //
@@ -165,32 +299,55 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
 //
    if (fstat(In.FD, &Stat)) return -errno;
    if (!(Stat.st_mode & S_IFREG)) return -EPERM;
-   calcSize = fileSize = Stat.st_size;
+   fileSize = Stat.st_size;
    MTime = Stat.st_mtime;
 
-// We now compute checksum 64MB at a time using mmap I/O
+// We compute the checksum 64MB at a time using mmap I/O. Unless the file spans
+// more than one segment and the checksum can be pieced together, do it all in
+// this thread.
 //
-   ioSize = (fileSize < (off_t)segSize ? fileSize : segSize); rc = 0;
-   while(calcSize)
-        {if ((inBuff = (char *)mmap(0, ioSize, PROT_READ, 
-#if defined(__FreeBSD__)
-                       MAP_RESERVED0040|MAP_PRIVATE, In.FD, Offset)) == MAP_FAILED)
-#else
-                       MAP_NORESERVE|MAP_PRIVATE, In.FD, Offset)) == MAP_FAILED)
-#endif
-            {rc = errno; eDest->Emsg("Cks", rc, "memory map", Pfn); break;}
-         madvise(inBuff, ioSize, MADV_SEQUENTIAL);
-         csP->Update(inBuff, ioSize);
-         calcSize -= ioSize; Offset += ioSize;
-         if (munmap(inBuff, ioSize) < 0)
-            {rc = errno; eDest->Emsg("Cks",rc,"unmap memory for",Pfn); break;}
-         if (calcSize < (size_t)segSize) ioSize = calcSize;
-        }
+   if (rdPar < 2 || !schedP || fileSize <= (off_t)segSize
+   ||  !csP->Combine(0, 0))
+      {if ((rc = CksRange(eDest, In.FD, Pfn, 0, fileSize, segSize, csP)))
+          return -rc;
+       return 0;
+      }
 
-// Return if we failed
+// Split the file into at most rdPar ranges that are a multiple of the segment
+// size (this keeps the mmap offsets aligned).
 //
-   if (calcSize) return (rc ? -rc : -EIO);
-   return 0;
+   rngSize = (fileSize + rdPar - 1) / rdPar;
+   rngSize = ((rngSize + segSize - 1) / segSize) * segSize;
+   nRanges = static_cast<int>((fileSize + rngSize - 1) / rngSize);
+
+// Setup the ranges; the first one continues the caller's checksum object
+//
+   CksParallel *ctxP = new CksParallel(eDest, In.FD, Pfn, segSize, nRanges);
+   for (rc = 0, i = 0; i < nRanges; i++)
+       {ctxP->rTab[i].Offset = rngSize * i;
+        ctxP->rTab[i].Length = (i == nRanges-1 ? fileSize - rngSize*i
+                                               : rngSize);
+        if (!i) ctxP->rTab[i].csP = csP;
+           else if (!(ctxP->rTab[i].csP = csP->New())) {rc = ENOMEM; break;}
+       }
+
+// Start the helpers, do our share, and wait for all the ranges to complete.
+// Then combine the pieces in file order.
+//
+   if (!rc)
+      {ctxP->Start(schedP);
+       ctxP->Work();
+       ctxP->Wait();
+       for (i = 0; i < nRanges && !rc; i++) rc = ctxP->rTab[i].rc;
+       for (i = 1; i < nRanges && !rc; i++)
+           if (!csP->Combine(ctxP->rTab[i].csP, ctxP->rTab[i].Length))
+              rc = ENOTSUP;
+      }
+
+// Drop our reference and return
+//
+   ctxP->Unref();
+   return (rc ? -rc : 0);
 }
 
 /******************************************************************************/
@@ -42,6 +42,7 @@
 
 class  XrdCksCalc;
 class  XrdCksLoader;
+class  XrdScheduler;
 class  XrdSysError;
 struct XrdVersionInfo;
   
@@ -68,6 +69,9 @@ virtual int         Size( const char  *Name=0);
 
 virtual int         Set(  const char *Pfn, XrdCksData &Cks, int myTime=0);
 
+        void        SetParallel(int nway, XrdScheduler *sP)
+                               {rdPar = nway; schedP = sP;}
+
 virtual int         Ver(  const char *Pfn, XrdCksData &Cks);
 
                     XrdCksManager(XrdSysError *erP, int iosz,
@@ -80,6 +84,9 @@ protected:
               supplied CksObj and places the file's modification time in MTime.
               Otherwise, it returns -errno. The default implementation uses
               open(), fstat(), mmap(), and unmap() to calculate the results.
+              When SetParallel() was called with more than one way and the
+              checksum supports Combine(), ranges of the file are checksummed
+              concurrently by scheduler threads and then combined.
 */
 virtual int         Calc(const char *Pfn, time_t &MTime, XrdCksCalc *CksObj);
 
@@ -110,6 +117,8 @@ static const int csMax = 8;
 csInfo           csTab[csMax];
 int              csLast;
 int              segSize;
+int              rdPar;
+XrdScheduler    *schedP;
 XrdCksLoader    *cksLoader;
 XrdVersionInfo  &myVersion;
 };
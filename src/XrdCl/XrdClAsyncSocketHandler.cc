@@ -54,7 +54,9 @@ namespace XrdCl
     pOutMsgDone( false ),
     pOutHandler( 0 ),
     pIncMsgSize( 0 ),
-    pOutMsgSize( 0 )
+    pOutMsgSize( 0 ),
+    pRacer( 0 ),
+    pRaceSet( false )
   {
     Env *env = DefaultEnv::GetEnv();
 
@@ -83,14 +85,59 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   Status AsyncSocketHandler::Connect( time_t timeout )
   {
-    Log *log = DefaultEnv::GetLog();
     pLastActivity = pConnectionStarted = ::time(0);
     pConnectionTimeout = timeout;
+    pHandShakeDone = false;
+
+    //--------------------------------------------------------------------------
+    // The primary socket may return before we have started the racer, so
+    // the poller thread must wait for us to be done here
+    //--------------------------------------------------------------------------
+    XrdSysMutexHelper scopedLock( pRaceMutex );
+
+    //--------------------------------------------------------------------------
+    // Initiate async connection to the address
+    //--------------------------------------------------------------------------
+    Status st = StartConnect( pSocket, pSockAddr );
+    if( !st.IsOK() && pRaceSet )
+    {
+      pSockAddr = pRaceAddr;
+      pRaceSet  = false;
+      st = StartConnect( pSocket, pSockAddr );
+    }
+    if( !st.IsOK() )
+      return st;
+
+    //--------------------------------------------------------------------------
+    // Race the address of the other family, whichever answers first will
+    // carry the stream and the other one is dropped. We don't care if the
+    // racer cannot be started, the primary address is going on anyway.
+    //--------------------------------------------------------------------------
+    if( pRaceSet )
+    {
+      pRacer = new Socket();
+      pRacer->SetChannelID( pChannelData );
+      if( !StartConnect( pRacer, pRaceAddr ).IsOK() )
+      {
+        delete pRacer;
+        pRacer = 0;
+      }
+    }
+    return Status();
+  }
+
+  //----------------------------------------------------------------------------
+  // Initialize the socket and start connecting it to the given address
+  //----------------------------------------------------------------------------
+  Status AsyncSocketHandler::StartConnect( Socket           *socket,
+                                           XrdNetAddr       &address )
+  {
+    Log *log = DefaultEnv::GetLog();
 
     //--------------------------------------------------------------------------
     // Initialize the socket
     //--------------------------------------------------------------------------
-    Status st = pSocket->Initialize( pSockAddr.Family() );
+    Status st = socket->Initialize( address.Family() );
     if( !st.IsOK() )
     {
       log->Error( AsyncSockMsg, "[%s] Unable to initialize socket: %s",
@@ -109,8 +156,8 @@ namespace XrdCl
     if( keepAlive )
     {
       int    param = 1;
-      Status st    = pSocket->SetSockOpt( SOL_SOCKET, SO_KEEPALIVE, &param,
-                                          sizeof(param) );
+      Status st    = socket->SetSockOpt( SOL_SOCKET, SO_KEEPALIVE, &param,
+                                         sizeof(param) );
       if( !st.IsOK() )
         log->Error( AsyncSockMsg, "[%s] Unable to turn on keepalive: %s",
                     st.ToString().c_str() );
@@ -120,38 +167,36 @@ namespace XrdCl
 
       param = DefaultTCPKeepAliveTime;
       env->GetInt( "TCPKeepAliveTime", param );
-      st = pSocket->SetSockOpt(SOL_TCP, TCP_KEEPIDLE, &param, sizeof(param));
+      st = socket->SetSockOpt(SOL_TCP, TCP_KEEPIDLE, &param, sizeof(param));
       if( !st.IsOK() )
         log->Error( AsyncSockMsg, "[%s] Unable to set keepalive time: %s",
                     st.ToString().c_str() );
 
       param = DefaultTCPKeepAliveInterval;
       env->GetInt( "TCPKeepAliveInterval", param );
-      st = pSocket->SetSockOpt(SOL_TCP, TCP_KEEPINTVL, &param, sizeof(param));
+      st = socket->SetSockOpt(SOL_TCP, TCP_KEEPINTVL, &param, sizeof(param));
       if( !st.IsOK() )
         log->Error( AsyncSockMsg, "[%s] Unable to set keepalive interval: %s",
                     st.ToString().c_str() );
 
       param = DefaultTCPKeepAliveProbes;
       env->GetInt( "TCPKeepAliveProbes", param );
-      st = pSocket->SetSockOpt(SOL_TCP, TCP_KEEPCNT, &param, sizeof(param));
+      st = socket->SetSockOpt(SOL_TCP, TCP_KEEPCNT, &param, sizeof(param));
       if( !st.IsOK() )
         log->Error( AsyncSockMsg, "[%s] Unable to set keepalive probes: %s",
                     st.ToString().c_str() );
 #endif
     }
 
-    pHandShakeDone = false;
-
     //--------------------------------------------------------------------------
     // Initiate async connection to the address
     //--------------------------------------------------------------------------
     char nameBuff[256];
-    pSockAddr.Format( nameBuff, sizeof(nameBuff), XrdNetAddrInfo::fmtAdv6 );
+    address.Format( nameBuff, sizeof(nameBuff), XrdNetAddrInfo::fmtAdv6 );
     log->Debug( AsyncSockMsg, "[%s] Attempting connection to %s",
                 pStreamName.c_str(), nameBuff );
 
-    st = pSocket->ConnectToAddress( pSockAddr, 0 );
+    st = socket->ConnectToAddress( address, 0 );
     if( !st.IsOK() )
     {
       log->Error( AsyncSockMsg, "[%s] Unable to initiate the connection: %s",
@@ -159,30 +204,96 @@ namespace XrdCl
       return st;
     }
 
-    pSocket->SetStatus( Socket::Connecting );
+    socket->SetStatus( Socket::Connecting );
 
     //--------------------------------------------------------------------------
     // We should get the ready to write event once we're really connected
     // so we need to listen to it
     //--------------------------------------------------------------------------
-    if( !pPoller->AddSocket( pSocket, this ) )
+    if( !pPoller->AddSocket( socket, this ) )
     {
       Status st( stFatal, errPollerError );
-      pSocket->Close();
+      socket->Close();
       return st;
     }
 
-    if( !pPoller->EnableWriteNotification( pSocket, true, pTimeoutResolution ) )
+    if( !pPoller->EnableWriteNotification( socket, true, pTimeoutResolution ) )
     {
       Status st( stFatal, errPollerError );
-      pPoller->RemoveSocket( pSocket );
-      pSocket->Close();
+      pPoller->RemoveSocket( socket );
+      socket->Close();
       return st;
     }
 
     return Status();
   }
 
+  //----------------------------------------------------------------------------
+  // Drop the racing socket
+  //----------------------------------------------------------------------------
+  void AsyncSocketHandler::DropRacer()
+  {
+    pRaceSet = false;
+    if( !pRacer ) return;
+    pPoller->RemoveSocket( pRacer );
+    pRacer->Close();
+    delete pRacer;
+    pRacer = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Make the racing socket carry the stream and drop the primary one
+  //----------------------------------------------------------------------------
+  void AsyncSocketHandler::PromoteRacer()
+  {
+    pPoller->RemoveSocket( pSocket );
+    pSocket->Close();
+    delete pSocket;
+    pSocket   = pRacer;
+    pRacer    = 0;
+    pSockAddr = pRaceAddr;
+    pRaceSet  = false;
+  }
+
+  //----------------------------------------------------------------------------
+  // Handle an event on the racing socket
+  //----------------------------------------------------------------------------
+  void AsyncSocketHandler::OnRaceEvent( uint8_t type, Socket *socket )
+  {
+    XrdSysMutexHelper scopedLock( pRaceMutex );
+    if( !pRacer || socket != pRacer )
+      return;
+
+    //--------------------------------------------------------------------------
+    // The primary socket keeps track of the connection timeout
+    //--------------------------------------------------------------------------
+    if( !( type & ReadyToWrite ) )
+      return;
+
+    Log *log = DefaultEnv::GetLog();
+    char nameBuff[256];
+    pRaceAddr.Format( nameBuff, sizeof(nameBuff), XrdNetAddrInfo::fmtAdv6 );
+
+    int errorCode = 0;
+    socklen_t optSize = sizeof( errorCode );
+    Status st = pRacer->GetSockOpt( SOL_SOCKET, SO_ERROR, &errorCode,
+                                    &optSize );
+    if( !st.IsOK() || errorCode )
+    {
+      log->Debug( AsyncSockMsg, "[%s] Racing connection to %s failed: %s",
+                  pStreamName.c_str(), nameBuff,
+                  strerror( st.IsOK() ? errorCode : errno ) );
+      DropRacer();
+      return;
+    }
+
+    log->Debug( AsyncSockMsg, "[%s] Racing connection to %s won",
+                pStreamName.c_str(), nameBuff );
+    PromoteRacer();
+    scopedLock.UnLock();
+    OnConnectionReturn();
+  }
+
   //----------------------------------------------------------------------------
   // Close the connection
   //----------------------------------------------------------------------------
@@ -197,6 +308,25 @@ namespace XrdCl
     pPoller->RemoveSocket( pSocket );
     pSocket->Close();
 
+    //--------------------------------------------------------------------------
+    // We may not be on the poller thread, so the racer is taken out under the
+    // lock but removed from the poller without holding it
+    //--------------------------------------------------------------------------
+    if( unlikely( pRaceSet ) )
+    {
+      pRaceMutex.Lock();
+      Socket *racer = pRacer;
+      pRacer   = 0;
+      pRaceSet = false;
+      pRaceMutex.UnLock();
+      if( racer )
+      {
+        pPoller->RemoveSocket( racer );
+        racer->Close();
+        delete racer;
+      }
+    }
+
     if( !pIncHandler.second )
       delete pIncoming;
 
@@ -220,8 +350,17 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   // Handler a socket event
   //----------------------------------------------------------------------------
-  void AsyncSocketHandler::Event( uint8_t type, XrdCl::Socket */*socket*/ )
+  void AsyncSocketHandler::Event( uint8_t type, XrdCl::Socket *socket )
   {
+    //--------------------------------------------------------------------------
+    // Event on the socket racing the primary one
+    //--------------------------------------------------------------------------
+    if( unlikely( socket != pSocket ) )
+    {
+      OnRaceEvent( type, socket );
+      return;
+    }
+
     //--------------------------------------------------------------------------
     // Read event
     //--------------------------------------------------------------------------
@@ -309,11 +448,27 @@ namespace XrdCl
     {
       log->Error( AsyncSockMsg, "[%s] Unable to connect: %s",
                   pStreamName.c_str(), strerror( errorCode ) );
+
+      //------------------------------------------------------------------------
+      // The other address family is still in the race, let it carry on
+      //------------------------------------------------------------------------
+      XrdSysMutexHelper scopedLock( pRaceMutex );
+      if( pRacer )
+      {
+        PromoteRacer();
+        return;
+      }
+      scopedLock.UnLock();
       pStream->OnConnectError( pSubStreamNum,
                                Status( stError, errConnectionError ) );
       return;
     }
     pSocket->SetStatus( Socket::Connected );
+    if( unlikely( pRaceSet ) )
+    {
+      XrdSysMutexHelper scopedLock( pRaceMutex );
+      DropRacer();
+    }
 
     //--------------------------------------------------------------------------
     // Initialize the handshake
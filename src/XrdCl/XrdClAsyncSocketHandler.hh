@@ -87,6 +87,23 @@ namespace XrdCl
         pSockAddr = address;
       }
 
+      //------------------------------------------------------------------------
+      //! Set the address to race against the primary one while connecting
+      //------------------------------------------------------------------------
+      void SetRaceAddress( const XrdNetAddr &address )
+      {
+        pRaceAddr = address;
+        pRaceSet  = true;
+      }
+
+      //------------------------------------------------------------------------
+      //! Connect to the primary address only
+      //------------------------------------------------------------------------
+      void ClearRaceAddress()
+      {
+        pRaceSet = false;
+      }
+
       //------------------------------------------------------------------------
       //! Get the address that the socket is connected to
       //------------------------------------------------------------------------
@@ -113,7 +130,7 @@ namespace XrdCl
       //------------------------------------------------------------------------
       //! Handle a socket event
       //------------------------------------------------------------------------
-      virtual void Event( uint8_t type, XrdCl::Socket */*socket*/ );
+      virtual void Event( uint8_t type, XrdCl::Socket *socket );
 
       //------------------------------------------------------------------------
       //! Enable uplink
@@ -153,11 +170,32 @@ namespace XrdCl
 
     private:
 
+      //------------------------------------------------------------------------
+      // Initialize the socket and start connecting it to the given address
+      //------------------------------------------------------------------------
+      Status StartConnect( Socket *socket, XrdNetAddr &address );
+
       //------------------------------------------------------------------------
       // Connect returned
       //------------------------------------------------------------------------
       void OnConnectionReturn();
 
+      //------------------------------------------------------------------------
+      // Handle an event on the racing socket
+      //------------------------------------------------------------------------
+      void OnRaceEvent( uint8_t type, Socket *socket );
+
+      //------------------------------------------------------------------------
+      // Make the racing socket carry the stream and drop the primary one,
+      // needs the race mutex
+      //------------------------------------------------------------------------
+      void PromoteRacer();
+
+      //------------------------------------------------------------------------
+      // Drop the racing socket, needs the race mutex
+      //------------------------------------------------------------------------
+      void DropRacer();
+
       //------------------------------------------------------------------------
       // Got a write readiness event
       //------------------------------------------------------------------------
@@ -306,6 +344,10 @@ namespace XrdCl
       uint32_t                       pIncMsgSize;
       uint32_t                       pOutMsgSize;
       time_t                         pLastActivity;
+      Socket                        *pRacer;
+      XrdNetAddr                     pRaceAddr;
+      bool                           pRaceSet;
+      XrdSysMutex                    pRaceMutex;
   };
 }
 
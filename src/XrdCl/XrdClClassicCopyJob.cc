@@ -24,6 +24,7 @@
 
 #include "XrdCl/XrdClClassicCopyJob.hh"
 #include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClCopyBufferPool.hh"
 #include "XrdCl/XrdClLog.hh"
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdCl/XrdClFile.hh"
@@ -169,6 +170,11 @@ namespace
   class Source
   {
     public:
+      //------------------------------------------------------------------------
+      //! Constructor
+      //------------------------------------------------------------------------
+      Source(): pPool( 0 ) {}
+
       //------------------------------------------------------------------------
       // Destructor
       //------------------------------------------------------------------------
@@ -199,6 +205,27 @@ namespace
       //------------------------------------------------------------------------
       virtual XrdCl::XRootDStatus GetCheckSum( std::string &checkSum,
                                                std::string &checkSumType ) = 0;
+
+      //------------------------------------------------------------------------
+      //! Set the pool the chunk buffers come from, if none they are
+      //! allocated
+      //------------------------------------------------------------------------
+      void SetBufferPool( XrdCl::CopyBufferPool *pool )
+      {
+        pPool = pool;
+      }
+
+      //------------------------------------------------------------------------
+      //! Set the I/O mode for local files (see File::SetProperty)
+      //------------------------------------------------------------------------
+      void SetLocalIO( const std::string &localIO )
+      {
+        pLocalIO = localIO;
+      }
+
+    protected:
+      XrdCl::CopyBufferPool *pPool;
+      std::string            pLocalIO;
   };
 
   //----------------------------------------------------------------------------
@@ -211,7 +238,8 @@ namespace
       //! Constructor
       //------------------------------------------------------------------------
       Destination():
-        pPosc( false ), pForce( false ), pCoerce( false ), pMakeDir( false ) {}
+        pPosc( false ), pForce( false ), pCoerce( false ), pMakeDir( false ),
+        pPool( 0 ) {}
 
       //------------------------------------------------------------------------
       //! Destructor
@@ -279,11 +307,30 @@ namespace
         pMakeDir = makedir;
       }
 
+      //------------------------------------------------------------------------
+      //! Set the pool the chunk buffers are returned to, if none they are
+      //! deleted
+      //------------------------------------------------------------------------
+      void SetBufferPool( XrdCl::CopyBufferPool *pool )
+      {
+        pPool = pool;
+      }
+
+      //------------------------------------------------------------------------
+      //! Set the I/O mode for local files (see File::SetProperty)
+      //------------------------------------------------------------------------
+      void SetLocalIO( const std::string &localIO )
+      {
+        pLocalIO = localIO;
+      }
+
     protected:
-      bool pPosc;
-      bool pForce;
-      bool pCoerce;
-      bool pMakeDir;
+      bool                   pPosc;
+      bool                   pForce;
+      bool                   pCoerce;
+      bool                   pMakeDir;
+      XrdCl::CopyBufferPool *pPool;
+      std::string            pLocalIO;
   };
 
   //----------------------------------------------------------------------------
@@ -337,7 +384,9 @@ namespace
         Log *log = DefaultEnv::GetLog();
 
         uint32_t toRead = pChunkSize;
-        char *buffer = new char[toRead];
+        char *buffer = CopyBufferPool::Get( pPool, toRead );
+        if( !buffer )
+          return XRootDStatus( stError, errOSError, ENOMEM );
 
         int64_t  bytesRead = 0;
         uint32_t offset    = 0;
@@ -348,7 +397,7 @@ namespace
           {
             log->Debug( UtilityMsg, "Unable to read from stdin: %s",
                         strerror( errno ) );
-            delete [] buffer;
+            CopyBufferPool::Release( pPool, buffer );
             return XRootDStatus( stError, errOSError, errno );
           }
 
@@ -362,7 +411,7 @@ namespace
 
         if( bytesRead == 0 )
         {
-          delete [] buffer;
+          CopyBufferPool::Release( pPool, buffer );
           return XRootDStatus( stOK, suDone );
         }
 
@@ -439,6 +488,8 @@ namespace
         std::string value;
         DefaultEnv::GetEnv()->GetString( "ReadRecovery", value );
         pFile->SetProperty( "ReadRecovery", value );
+        if( !pLocalIO.empty() )
+          pFile->SetProperty( "LocalIO", pLocalIO );
 
         XRootDStatus st = pFile->Open( pUrl->GetURL(), OpenFlags::Read );
         if( !st.IsOK() )
@@ -486,7 +537,7 @@ namespace
           ChunkHandler *ch = pChunks.front();
           pChunks.pop();
           ch->sem->Wait();
-          delete [] (char *)ch->chunk.buffer;
+          XrdCl::CopyBufferPool::Release( pPool, ch->chunk.buffer );
           delete ch;
         }
       }
@@ -542,7 +593,9 @@ namespace
           return XRootDStatus( stError, errUninitialized );
 
         //----------------------------------------------------------------------
-        // Fill the queue
+        // Fill the queue. Buffers are always of the full chunk size so that
+        // they can be recycled. We only wait for one if we hold none, our
+        // chunks in flight would otherwise never be returned to the pool.
         //----------------------------------------------------------------------
         while( pChunks.size() < pParallel && pCurrentOffset < pSize )
         {
@@ -550,7 +603,15 @@ namespace
           if( pCurrentOffset + chunkSize > (uint64_t)pSize )
             chunkSize = pSize - pCurrentOffset;
 
-          char *buffer = new char[chunkSize];
+          char *buffer = CopyBufferPool::Get( pPool, pChunkSize,
+                                              pChunks.empty() );
+          if( !buffer )
+          {
+            if( pChunks.empty() )
+              return XRootDStatus( stError, errOSError, ENOMEM );
+            break;
+          }
+
           ChunkHandler *ch = new ChunkHandler;
           ch->chunk.offset = pCurrentOffset;
           ch->chunk.length = chunkSize;
@@ -580,7 +641,7 @@ namespace
           log->Debug( UtilityMsg, "Unable read %d bytes at %ld from %s: %s",
                       ch->chunk.length, ch->chunk.offset,
                       pUrl->GetURL().c_str(), ch->status.ToStr().c_str() );
-          delete [] (char *)ch->chunk.buffer;
+          CopyBufferPool::Release( pPool, ch->chunk.buffer );
           CleanUpChunks();
           return ch->status;
         }
@@ -754,6 +815,8 @@ namespace
         std::string value;
         DefaultEnv::GetEnv()->GetString( "ReadRecovery", value );
         pFile->SetProperty( "ReadRecovery", value );
+        if( !pLocalIO.empty() )
+          pFile->SetProperty( "LocalIO", pLocalIO );
 
         XRootDStatus st = pFile->Open( pUrl->GetURL(), OpenFlags::Read );
         if( !st.IsOK() )
@@ -795,21 +858,24 @@ namespace
         //----------------------------------------------------------------------
         // Fill the queue
         //----------------------------------------------------------------------
-        char     *buffer = new char[pChunkSize];
+        char     *buffer = CopyBufferPool::Get( pPool, pChunkSize );
         uint32_t  bytesRead = 0;
 
+        if( !buffer )
+          return XRootDStatus( stError, errOSError, ENOMEM );
+
         XRootDStatus st = pFile->Read( pCurrentOffset, pChunkSize, buffer,
                                        bytesRead );
 
         if( !st.IsOK() )
         {
-          delete [] buffer;
+          CopyBufferPool::Release( pPool, buffer );
           return st;
         }
 
         if( !bytesRead )
         {
-          delete [] buffer;
+          CopyBufferPool::Release( pPool, buffer );
           return XRootDStatus( stOK, suDone );
         }
 
@@ -1053,7 +1119,7 @@ namespace
           {
             log->Debug( UtilityMsg, "Unable to write to stdout: %s",
                         strerror( errno ) );
-            delete [] (char*)ci.buffer; ci.buffer = 0;
+            CopyBufferPool::Release( pPool, ci.buffer ); ci.buffer = 0;
             return XRootDStatus( stError, errOSError, errno );
           }
           pCurrentOffset += wr;
@@ -1063,7 +1129,7 @@ namespace
         while( length );
 
         pCkSumHelper.Update( ci.buffer, ci.length );
-        delete [] (char*)ci.buffer; ci.buffer = 0;
+        CopyBufferPool::Release( pPool, ci.buffer ); ci.buffer = 0;
         return XRootDStatus();
       }
 
@@ -1127,6 +1193,8 @@ namespace
         std::string value;
         DefaultEnv::GetEnv()->GetString( "WriteRecovery", value );
         pFile->SetProperty( "WriteRecovery", value );
+        if( !pLocalIO.empty() )
+          pFile->SetProperty( "LocalIO", pLocalIO );
 
         OpenFlags::Flags flags = OpenFlags::Update;
         if( pForce )
@@ -1181,7 +1249,6 @@ namespace
         XRDCL_SMART_PTR_T<ChunkHandler> ch( pChunks.front() );
         pChunks.pop();
         ch->sem->Wait();
-        delete [] (char*)ch->chunk.buffer;
         if( !ch->status.IsOK() )
         {
           Log *log = DefaultEnv::GetLog();
@@ -1189,6 +1256,8 @@ namespace
                       ch->chunk.length, ch->chunk.offset,
                       pUrl->GetURL().c_str(), ch->status.ToStr().c_str() );
           CleanUpChunks();
+          XrdCl::CopyBufferPool::Release( pPool, ci.buffer );
+          ci.buffer = 0;
           return ch->status;
         }
         return QueueChunk( ci );
@@ -1204,7 +1273,6 @@ namespace
           ChunkHandler *ch = pChunks.front();
           pChunks.pop();
           ch->sem->Wait();
-          delete [] (char *)ch->chunk.buffer;
           delete ch;
         }
       }
@@ -1214,13 +1282,13 @@ namespace
       //------------------------------------------------------------------------
       XrdCl::XRootDStatus QueueChunk( XrdCl::ChunkInfo &ci )
       {
-        ChunkHandler *ch = new ChunkHandler(ci);
+        ChunkHandler *ch = new ChunkHandler( ci, pPool );
         XrdCl::XRootDStatus st;
         st = pFile->Write( ci.offset, ci.length, ci.buffer, ch );
         if( !st.IsOK() )
         {
           CleanUpChunks();
-          delete [] (char*)ci.buffer;
+          XrdCl::CopyBufferPool::Release( pPool, ci.buffer );
           ci.buffer = 0;
           delete ch;
           return st;
@@ -1242,7 +1310,6 @@ namespace
           ch->sem->Wait();
           if( !ch->status.IsOK() )
             st = ch->status;
-          delete [] (char *)ch->chunk.buffer;
           delete ch;
         }
         return st;
@@ -1267,25 +1334,29 @@ namespace
       XRootDDestination &operator = (const XRootDDestination &other);
 
       //------------------------------------------------------------------------
-      // Asynchronous chunk handler
+      // Asynchronous chunk handler, the buffer is recycled as soon as the
+      // write is done
       //------------------------------------------------------------------------
       class ChunkHandler: public XrdCl::ResponseHandler
       {
         public:
-          ChunkHandler( XrdCl::ChunkInfo ci ):
+          ChunkHandler( XrdCl::ChunkInfo ci, XrdCl::CopyBufferPool *pool ):
             sem( new XrdCl::Semaphore(0) ),
-            chunk(ci) {}
+            chunk(ci), pool(pool) {}
           virtual ~ChunkHandler() { delete sem; }
           virtual void HandleResponse( XrdCl::XRootDStatus *statusval,
                                        XrdCl::AnyObject    */*response*/ )
           {
             this->status = *statusval;
             delete statusval;
+            XrdCl::CopyBufferPool::Release( pool, chunk.buffer );
+            chunk.buffer = 0;
             sem->Post();
           }
 
           XrdCl::Semaphore       *sem;
           XrdCl::ChunkInfo        chunk;
+          XrdCl::CopyBufferPool  *pool;
           XrdCl::XRootDStatus     status;
       };
 
@@ -1322,6 +1393,7 @@ namespace XrdCl
     std::string checkSumType;
     std::string checkSumPreset;
     std::string zipSource;
+    std::string localIO;
     uint16_t    parallelChunks;
     uint32_t    chunkSize;
     uint64_t    blockSize;
@@ -1341,6 +1413,7 @@ namespace XrdCl
     pProperties->Get( "zipArchive",      zip );
     pProperties->Get( "xcp",             xcp );
     pProperties->Get( "xcpBlockSize",    blockSize );
+    pProperties->Get( "localIO",         localIO );
 
     if( zip )
       pProperties->Get( "zipSource",     zipSource );
@@ -1366,6 +1439,8 @@ namespace XrdCl
         src.reset( new XRootDSource( &GetSource(), chunkSize, parallelChunks ) );
     }
 
+    src->SetBufferPool( pBufferPool );
+    src->SetLocalIO( localIO );
     XRootDStatus st = src->Initialize();
     if( !st.IsOK() ) return st;
     uint64_t size = src->GetSize() >= 0 ? src->GetSize() : 0;
@@ -1395,6 +1470,8 @@ namespace XrdCl
     dest->SetPOSC(  posc );
     dest->SetCoerce( coerce );
     dest->SetMakeDir( makeDir );
+    dest->SetBufferPool( pBufferPool );
+    dest->SetLocalIO( localIO );
     st = dest->Initialize();
     if( !st.IsOK() ) return st;
 
@@ -43,6 +43,8 @@ namespace XrdCl
   // Environment settings
   //----------------------------------------------------------------------------
   const int DefaultSubStreamsPerChannel = 1;
+  const int DefaultAutoSubStreams       = 8;
+  const int DefaultAutoReadStripeSize   = 1048576;
   const int DefaultConnectionWindow     = 120;
   const int DefaultConnectionRetry      = 5;
   const int DefaultRequestTimeout       = 1800;
@@ -52,6 +54,7 @@ namespace XrdCl
   const int DefaultRunForkHandler       = 0;
   const int DefaultRedirectLimit        = 16;
   const int DefaultWorkerThreads        = 3;
+  const int DefaultWorkerQueues         = 0;
   const int DefaultCPChunkSize          = 16777216;
   const int DefaultCPParallelChunks     = 4;
   const int DefaultDataServerTTL        = 300;
@@ -71,6 +74,26 @@ namespace XrdCl
   const int DefaultAioSignal            = 0;
   const int DefaultPreferIPv4           = 0;
   const int DefaultMaxMetalinkWait      = 60;
+  const int DefaultWaitJitter           = 25;
+  const int DefaultReadStripeSize       = 0;
+  const int DefaultReadBatchSize        = 0;
+  const int DefaultReadBatchWindow      = 2;
+  const int DefaultDirWalkParallel      = 16;
+  const int DefaultTCPNotSentLowat      = 0;
+  const int DefaultTCPPacingRate        = 0;
+  const int DefaultReadCompression      = 0;
+  const int DefaultTCPWindow            = 0;
+  const int DefaultMetalinkRanking      = 1;
+  const int DefaultMetalinkRace         = 0;
+  const int DefaultMetalinkRaceTimeout  = 5;
+  const int DefaultRedirectCacheTTL     = 0;
+  const int DefaultRedirectCacheByDir   = 0;
+  const int DefaultWriteBehindSize      = 0;
+  const int DefaultWriteBehindWindow    = 100;
+  const int DefaultWriteBehindInFlight  = 4;
+  const int DefaultTCPFastOpen          = 0;
+  const int DefaultConnectionRace       = 0;
+  const int DefaultTraceSample          = 0;
 
   const char * const DefaultPollerPreference   = "built-in";
   const char * const DefaultNetworkStack       = "IPAuto";
@@ -82,6 +105,10 @@ namespace XrdCl
   const char * const DefaultWriteRecovery      = "true";
   const char * const DefaultOpenRecovery       = "true";
   const char * const DefaultGlfnRedirector     = "";
+  const char * const DefaultCPLocalIO          = "buffered";
+  const char * const DefaultTCPCongestion      = "";
+  const char * const DefaultMetalinkCountry    = "";
+  const char * const DefaultTraceSpans         = "";
 }
 
 #endif // __XRD_CL_CONSTANTS_HH__
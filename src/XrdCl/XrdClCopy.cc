@@ -438,6 +438,103 @@ XrdCl::XRootDStatus GetDirList( XrdCl::FileSystem        *fs,
   return XRootDStatus();
 }
 
+//------------------------------------------------------------------------------
+// Collect the files found while walking a remote directory
+//------------------------------------------------------------------------------
+class IndexRemoteHandler: public XrdCl::DirWalkHandler
+{
+  public:
+    IndexRemoteHandler( const std::string &basePath, uint16_t dirOffset ):
+      pBasePath( basePath ), pDirOffset( dirOffset ), pEnd( &pStart ),
+      pFailed( false ), pSem( 0 )
+    {
+      XrdCl::DirectoryList top;
+      top.SetParentName( XrdCl::URL( basePath ).GetPath() );
+      pTopDir = top.GetParentName();
+    }
+
+    ~IndexRemoteHandler()
+    {
+      XrdCpFile *file;
+      while( ( file = pStart.Next ) )
+      {
+        pStart.Next = file->Next;
+        file->Next  = 0;
+        delete file;
+      }
+    }
+
+    virtual bool HandleEntries( XrdCl::DirectoryList *entries )
+    {
+      using namespace XrdCl;
+      std::string dir = entries->GetParentName().substr( pTopDir.size() );
+      int badUrl = 0;
+
+      for( auto itr = entries->Begin(); itr != entries->End(); ++itr )
+      {
+        DirectoryList::ListEntry *e = *itr;
+        if( !e->GetStatInfo() || e->GetStatInfo()->TestFlags( StatInfo::IsDir ) )
+          continue;
+        std::string path = pBasePath + '/' + dir + e->GetName();
+        XrdCpFile *current = new XrdCpFile( path.c_str(), badUrl );
+        if( badUrl )
+        {
+          DefaultEnv::GetLog()->Error( AppMsg, "Bad URL: %s", path.c_str() );
+          delete current;
+          pFailed = true;
+          break;
+        }
+
+        current->Doff = pDirOffset;
+        pEnd->Next    = current;
+        pEnd          = current;
+      }
+
+      delete entries;
+      return !pFailed;
+    }
+
+    virtual void HandleError( const std::string         &path,
+                              const XrdCl::XRootDStatus &status )
+    {
+      XrdCl::DefaultEnv::GetLog()->Info( XrdCl::AppMsg, "Failed to get "
+                                         "directory listing for %s: %s",
+                                         path.c_str(),
+                                         status.GetErrorMessage().c_str() );
+    }
+
+    virtual void HandleDone( XrdCl::XRootDStatus *status )
+    {
+      pStatus = *status;
+      delete status;
+      pSem.Post();
+    }
+
+    //--------------------------------------------------------------------------
+    // Wait for the walk to finish and take the files found
+    //--------------------------------------------------------------------------
+    XrdCl::XRootDStatus Wait( XrdCpFile *&files )
+    {
+      pSem.Wait();
+      files = 0;
+      if( pFailed || !pStatus.IsOK() || pStatus.code == XrdCl::suPartial )
+        return pStatus;
+      files = pStart.Next;
+      pStart.Next = 0;
+      return pStatus;
+    }
+
+  private:
+    std::string          pBasePath;
+    std::string          pTopDir;
+    uint16_t             pDirOffset;
+    XrdCpFile            pStart;
+    XrdCpFile           *pEnd;
+    bool                 pFailed;
+    XrdCl::XRootDStatus  pStatus;
+    XrdSysSemaphore      pSem;
+};
+
 //------------------------------------------------------------------------------
 // Recursively index all files and directories inside a remote directory
 //------------------------------------------------------------------------------
@@ -450,41 +547,28 @@ XrdCpFile *IndexRemote( XrdCl::FileSystem *fs,
   Log *log = DefaultEnv::GetLog();
   log->Debug( AppMsg, "Indexing %s", basePath.c_str() );
 
-  DirectoryList *dirList = 0;
-  XRootDStatus st = fs->DirList( URL( basePath ).GetPath(), DirListFlags::Recursive, dirList );
-  if( !st.IsOK() )
+  //----------------------------------------------------------------------------
+  // Walk the tree rather than listing it at once so that only the files, not
+  // all the listings, are kept in memory. Like a recursive listing the index
+  // fails should any directory fail to be listed.
+  //----------------------------------------------------------------------------
+  IndexRemoteHandler handler( basePath, dirOffset );
+  XrdCpFile *files = 0;
+  XRootDStatus st = fs->DirWalk( URL( basePath ).GetPath(),
+                                 DirListFlags::Recursive, &handler );
+  if( st.IsOK() )
+    st = handler.Wait( files );
+
+  if( !files )
   {
-    log->Info( AppMsg, "Failed to get directory listing for %s: %s",
-                       basePath.c_str(),
-                       st.GetErrorMessage().c_str() );
+    if( !st.IsOK() || st.code == suPartial )
+      log->Info( AppMsg, "Failed to get directory listing for %s: %s",
+                         basePath.c_str(),
+                         st.GetErrorMessage().c_str() );
     return 0;
   }
 
-  XrdCpFile start, *current = 0;
-  XrdCpFile *end   = &start;
-  int       badUrl = 0;
-  for( auto itr = dirList->Begin(); itr != dirList->End(); ++itr )
-  {
-    DirectoryList::ListEntry *e = *itr;
-    if( e->GetStatInfo()->TestFlags( StatInfo::IsDir ) )
-      continue;
-    std::string path = basePath + '/' + e->GetName();
-    current = new XrdCpFile( path.c_str(), badUrl );
-    if( badUrl )
-    {
-      delete current;
-      log->Error( AppMsg, "Bad URL: %s", current->Path );
-      return 0;
-    }
-
-    current->Doff = dirOffset;
-    end->Next     = current;
-    end           = current;
-  }
-
-  delete dirList;
-
-  return start.Next;
+  return files;
 }
 
 //------------------------------------------------------------------------------
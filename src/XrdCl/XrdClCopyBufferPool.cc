@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+
+#include "XrdCl/XrdClCopyBufferPool.hh"
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  // Constructor
+  //----------------------------------------------------------------------------
+  CopyBufferPool::CopyBufferPool( uint64_t limit ):
+    pCond( 0 ), pLimit( limit ), pAllocated( 0 ), pInUse( 0 )
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  // Destructor
+  //----------------------------------------------------------------------------
+  CopyBufferPool::~CopyBufferPool()
+  {
+    std::map<char*, uint32_t>::iterator it;
+    for( it = pOwned.begin(); it != pOwned.end(); ++it )
+      free( it->first );
+  }
+
+  //----------------------------------------------------------------------------
+  // Get a buffer
+  //----------------------------------------------------------------------------
+  char *CopyBufferPool::Get( uint32_t size, bool wait )
+  {
+    static const uint64_t pgSize = sysconf( _SC_PAGESIZE );
+    uint64_t allocSize = ( (uint64_t)size + pgSize - 1 ) & ~( pgSize - 1 );
+    XrdSysCondVarHelper scopedLock( pCond );
+
+    while( 1 )
+    {
+      //------------------------------------------------------------------------
+      // Reuse the first free buffer that is large enough
+      //------------------------------------------------------------------------
+      std::vector<char*>::iterator it;
+      for( it = pFree.begin(); it != pFree.end(); ++it )
+        if( pOwned[*it] >= size )
+        {
+          char *buffer = *it;
+          pFree.erase( it );
+          ++pInUse;
+          return buffer;
+        }
+
+      //------------------------------------------------------------------------
+      // Allocate a new one if there is room, making room by dropping the
+      // free buffers that are too small
+      //------------------------------------------------------------------------
+      while( pAllocated + allocSize > pLimit && !pFree.empty() )
+      {
+        char *buffer = pFree.back();
+        pFree.pop_back();
+        pAllocated -= pOwned[buffer];
+        pOwned.erase( buffer );
+        free( buffer );
+      }
+
+      if( pAllocated + allocSize <= pLimit || !pInUse )
+      {
+        void *buffer = 0;
+        if( posix_memalign( &buffer, pgSize, allocSize ) )
+          return 0;
+        pOwned[(char*)buffer] = allocSize;
+        pAllocated += allocSize;
+        ++pInUse;
+        return (char*)buffer;
+      }
+
+      if( !wait )
+        return 0;
+      pCond.Wait();
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Return a buffer
+  //----------------------------------------------------------------------------
+  void CopyBufferPool::Release( void *buffer )
+  {
+    if( !buffer )
+      return;
+
+    XrdSysCondVarHelper scopedLock( pCond );
+    if( pOwned.find( (char*)buffer ) == pOwned.end() )
+    {
+      delete [] (char*)buffer;
+      return;
+    }
+
+    pFree.push_back( (char*)buffer );
+    --pInUse;
+    pCond.Broadcast();
+  }
+}
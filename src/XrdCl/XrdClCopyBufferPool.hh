@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+
+#ifndef __XRD_CL_COPY_BUFFER_POOL_HH__
+#define __XRD_CL_COPY_BUFFER_POOL_HH__
+
+#include "XrdSys/XrdSysPthread.hh"
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  //! A bounded pool of page aligned chunk buffers shared by the jobs of a
+  //! copy process. Buffers are recycled rather than freed once the chunk
+  //! they hold has been written, and a job asking for a buffer while the
+  //! pool is exhausted waits until another one is returned.
+  //----------------------------------------------------------------------------
+  class CopyBufferPool
+  {
+    public:
+      //------------------------------------------------------------------------
+      //! Constructor
+      //!
+      //! @param limit number of bytes the buffers may take up altogether
+      //------------------------------------------------------------------------
+      CopyBufferPool( uint64_t limit );
+
+      //------------------------------------------------------------------------
+      //! Destructor, all the buffers must have been returned
+      //------------------------------------------------------------------------
+      ~CopyBufferPool();
+
+      //------------------------------------------------------------------------
+      //! Get a buffer of at least size bytes
+      //!
+      //! @param size size of the buffer
+      //! @param wait if true wait for a buffer to become available, otherwise
+      //!             give up if the pool is exhausted
+      //! @return     the buffer or 0 if none is available and wait is false
+      //!
+      //! A caller must only wait if it does not itself hold buffers that it
+      //! would only return after getting this one. A buffer larger than the
+      //! pool is only handed out when no other buffer is in use.
+      //------------------------------------------------------------------------
+      char *Get( uint32_t size, bool wait = true );
+
+      //------------------------------------------------------------------------
+      //! Return a buffer to the pool, buffers that do not come from the pool
+      //! are deleted
+      //------------------------------------------------------------------------
+      void Release( void *buffer );
+
+      //------------------------------------------------------------------------
+      //! Get a buffer from the pool or, if there is none, allocate it
+      //------------------------------------------------------------------------
+      static char *Get( CopyBufferPool *pool, uint32_t size, bool wait = true )
+      {
+        return pool ? pool->Get( size, wait ) : new char[size];
+      }
+
+      //------------------------------------------------------------------------
+      //! Return a buffer to the pool or, if there is none, delete it
+      //------------------------------------------------------------------------
+      static void Release( CopyBufferPool *pool, void *buffer )
+      {
+        if( pool )
+          pool->Release( buffer );
+        else
+          delete [] (char*)buffer;
+      }
+
+    private:
+      CopyBufferPool( const CopyBufferPool &other );
+      CopyBufferPool &operator = ( const CopyBufferPool &other );
+
+      XrdSysCondVar               pCond;
+      std::map<char*, uint32_t>   pOwned; // all the pool's buffers and sizes
+      std::vector<char*>          pFree;
+      uint64_t                    pLimit;
+      uint64_t                    pAllocated;
+      uint32_t                    pInUse;
+  };
+}
+
+#endif // __XRD_CL_COPY_BUFFER_POOL_HH__
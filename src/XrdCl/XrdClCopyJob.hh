@@ -29,6 +29,8 @@
 
 namespace XrdCl
 {
+  class CopyBufferPool;
+
   //----------------------------------------------------------------------------
   //! Copy job
   //----------------------------------------------------------------------------
@@ -43,7 +45,8 @@ namespace XrdCl
                PropertyList *jobResults ):
         pProperties( jobProperties ),
         pResults( jobResults ),
-        pJobId( jobId )
+        pJobId( jobId ),
+        pBufferPool( 0 )
       {
         pProperties->Get( "source", pSource );
         pProperties->Get( "target", pTarget );
@@ -96,12 +99,22 @@ namespace XrdCl
         return pTarget;
       }
 
+      //------------------------------------------------------------------------
+      //! Set the pool the chunk buffers are to be taken from, if none they
+      //! are allocated as needed
+      //------------------------------------------------------------------------
+      void SetBufferPool( CopyBufferPool *pool )
+      {
+        pBufferPool = pool;
+      }
+
     protected:
-      PropertyList *pProperties;
-      PropertyList *pResults;
-      URL           pSource;
-      URL           pTarget;
-      uint16_t      pJobId;
+      PropertyList   *pProperties;
+      PropertyList   *pResults;
+      URL             pSource;
+      URL             pTarget;
+      uint16_t        pJobId;
+      CopyBufferPool *pBufferPool;
   };
 }
 
@@ -31,6 +31,7 @@
 #include "XrdCl/XrdClFileSystem.hh"
 #include "XrdCl/XrdClMonitor.hh"
 #include "XrdCl/XrdClCopyJob.hh"
+#include "XrdCl/XrdClCopyBufferPool.hh"
 #include "XrdCl/XrdClUtils.hh"
 #include "XrdCl/XrdClJobManager.hh"
 #include "XrdCl/XrdClUglyHacks.hh"
@@ -238,6 +239,22 @@ namespace XrdCl
     if( !p.HasProperty( "dynamicSource" ) )
       p.Set( "dynamicSource", false );
 
+    if( !p.HasProperty( "localIO" ) )
+    {
+      std::string val = DefaultCPLocalIO;
+      env->GetString( "CPLocalIO", val );
+      p.Set( "localIO", val );
+    }
+
+    std::string localIO;
+    p.Get( "localIO", localIO );
+    if( localIO != "buffered" && localIO != "stream" && localIO != "direct" )
+    {
+      pJobProperties.pop_back();
+      return XRootDStatus( stError, errInvalidArgs, 0,
+                           "localIO has to be buffered, stream or direct" );
+    }
+
     //--------------------------------------------------------------------------
     // Insert the properties
     //--------------------------------------------------------------------------
@@ -389,7 +406,8 @@ namespace XrdCl
     //--------------------------------------------------------------------------
     // Get the configuration
     //--------------------------------------------------------------------------
-    uint8_t parallelThreads = 1;
+    uint8_t  parallelThreads = 1;
+    uint64_t poolSize        = 0;
     if( pJobProperties.size() > 0 &&
         pJobProperties.rbegin()->HasProperty( "jobType" ) &&
         pJobProperties.rbegin()->Get<std::string>( "jobType" ) == "configuration" )
@@ -397,8 +415,40 @@ namespace XrdCl
       PropertyList &config = *pJobProperties.rbegin();
       if( config.HasProperty( "parallel" ) )
         parallelThreads = (uint8_t)config.Get<int>( "parallel" );
+      if( config.HasProperty( "bufferPoolSize" ) )
+        config.Get( "bufferPoolSize", poolSize );
+    }
+
+    //--------------------------------------------------------------------------
+    // All the jobs take their chunk buffers from the same pool. By default it
+    // holds what the jobs running at the same time may have in flight: up to
+    // parallelChunks reads and as many writes plus the chunk being handed
+    // over.
+    //--------------------------------------------------------------------------
+    if( !poolSize )
+    {
+      uint64_t jobSize = 0;
+      for( std::vector<CopyJob*>::iterator itJ = pJobs.begin();
+           itJ != pJobs.end(); ++itJ )
+      {
+        uint32_t chunkSize      = 0;
+        uint16_t parallelChunks = 0;
+        (*itJ)->GetProperties()->Get( "chunkSize",      chunkSize );
+        (*itJ)->GetProperties()->Get( "parallelChunks", parallelChunks );
+        uint64_t size = uint64_t( 2 * parallelChunks + 1 ) * chunkSize;
+        if( size > jobSize )
+          jobSize = size;
+      }
+      poolSize = jobSize * std::min( (size_t)( parallelThreads ?
+                                               parallelThreads : 1 ),
+                                     pJobs.size() );
     }
 
+    CopyBufferPool pool( poolSize );
+    for( std::vector<CopyJob*>::iterator itJ = pJobs.begin();
+         itJ != pJobs.end(); ++itJ )
+      (*itJ)->SetBufferPool( &pool );
+
     //--------------------------------------------------------------------------
     // Run the show
     //--------------------------------------------------------------------------
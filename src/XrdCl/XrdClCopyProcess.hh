@@ -144,12 +144,23 @@ namespace XrdCl
       //! tpcTimeout     [uint16_t] - time limit for the actual copy to finish
       //! dynamicSource  [bool]     - support for the case where the size source
       //!                             file may change during reading process
+      //! localIO        [string]   - how local sources and destinations use
+      //!                             the page cache: "buffered" (default),
+      //!                             "stream" - drop the data from the cache
+      //!                             once read or written back, "direct" -
+      //!                             bypass the cache with O_DIRECT where the
+      //!                             chunks are aligned, stream otherwise
       //!
       //! Configuration job - this is a job that that is supposed to configure
       //! the copy process as a whole instead of adding a copy job:
       //!
       //! jobType        [string]   - "configuration" - for configuraion
       //! parallel       [uint8_t]  - nomber of copy jobs to be run in parallel
+      //! bufferPoolSize [uint64_t] - bytes of chunk buffers shared by all the
+      //!                             jobs, jobs wait for a buffer once they
+      //!                             are used up; if 0 or not set there are
+      //!                             as many as the jobs run in parallel may
+      //!                             use
       //!
       //! Results:
       //! sourceCheckSum [string]   - checksum at source, if requested
@@ -267,11 +267,13 @@ namespace XrdCl
     REGISTER_VAR_INT( varsInt, "RequestTimeout",       DefaultRequestTimeout       );
     REGISTER_VAR_INT( varsInt, "StreamTimeout",        DefaultStreamTimeout        );
     REGISTER_VAR_INT( varsInt, "SubStreamsPerChannel", DefaultSubStreamsPerChannel );
+    REGISTER_VAR_INT( varsInt, "AutoSubStreams",       DefaultAutoSubStreams       );
     REGISTER_VAR_INT( varsInt, "TimeoutResolution",    DefaultTimeoutResolution    );
     REGISTER_VAR_INT( varsInt, "StreamErrorWindow",    DefaultStreamErrorWindow    );
     REGISTER_VAR_INT( varsInt, "RunForkHandler",       DefaultRunForkHandler       );
     REGISTER_VAR_INT( varsInt, "RedirectLimit",        DefaultRedirectLimit        );
     REGISTER_VAR_INT( varsInt, "WorkerThreads",        DefaultWorkerThreads        );
+    REGISTER_VAR_INT( varsInt, "WorkerQueues",         DefaultWorkerQueues         );
     REGISTER_VAR_INT( varsInt, "CPChunkSize",          DefaultCPChunkSize          );
     REGISTER_VAR_INT( varsInt, "CPParallelChunks",     DefaultCPParallelChunks     );
     REGISTER_VAR_INT( varsInt, "DataServerTTL",        DefaultDataServerTTL        );
@@ -291,6 +293,29 @@ namespace XrdCl
     REGISTER_VAR_INT( varsInt, "AioSignal",            DefaultAioSignal            );
     REGISTER_VAR_INT( varsInt, "PreferIPv4",           DefaultPreferIPv4           );
     REGISTER_VAR_INT( varsInt, "MaxMetalinkWait",      DefaultMaxMetalinkWait      );
+    REGISTER_VAR_INT( varsInt, "WaitJitter",           DefaultWaitJitter           );
+    REGISTER_VAR_INT( varsInt, "ReadStripeSize",       DefaultReadStripeSize       );
+    REGISTER_VAR_INT( varsInt, "ReadBatchSize",        DefaultReadBatchSize        );
+    REGISTER_VAR_INT( varsInt, "ReadBatchWindow",      DefaultReadBatchWindow      );
+    REGISTER_VAR_INT( varsInt, "DirWalkParallel",      DefaultDirWalkParallel      );
+    REGISTER_VAR_INT( varsInt, "LanTCPNotSentLowat",   DefaultTCPNotSentLowat      );
+    REGISTER_VAR_INT( varsInt, "LanTCPPacingRate",     DefaultTCPPacingRate        );
+    REGISTER_VAR_INT( varsInt, "ReadCompression",      DefaultReadCompression      );
+    REGISTER_VAR_INT( varsInt, "LanTCPWindow",         DefaultTCPWindow            );
+    REGISTER_VAR_INT( varsInt, "WanTCPNotSentLowat",   DefaultTCPNotSentLowat      );
+    REGISTER_VAR_INT( varsInt, "WanTCPPacingRate",     DefaultTCPPacingRate        );
+    REGISTER_VAR_INT( varsInt, "WanTCPWindow",         DefaultTCPWindow            );
+    REGISTER_VAR_INT( varsInt, "MetalinkRanking",      DefaultMetalinkRanking      );
+    REGISTER_VAR_INT( varsInt, "MetalinkRace",         DefaultMetalinkRace         );
+    REGISTER_VAR_INT( varsInt, "MetalinkRaceTimeout",  DefaultMetalinkRaceTimeout  );
+    REGISTER_VAR_INT( varsInt, "RedirectCacheTTL",     DefaultRedirectCacheTTL     );
+    REGISTER_VAR_INT( varsInt, "RedirectCacheByDir",   DefaultRedirectCacheByDir   );
+    REGISTER_VAR_INT( varsInt, "WriteBehindSize",      DefaultWriteBehindSize      );
+    REGISTER_VAR_INT( varsInt, "WriteBehindWindow",    DefaultWriteBehindWindow    );
+    REGISTER_VAR_INT( varsInt, "WriteBehindInFlight",  DefaultWriteBehindInFlight  );
+    REGISTER_VAR_INT( varsInt, "TCPFastOpen",          DefaultTCPFastOpen          );
+    REGISTER_VAR_INT( varsInt, "ConnectionRace",       DefaultConnectionRace       );
+    REGISTER_VAR_INT( varsInt, "TraceSample",          DefaultTraceSample          );
 
     REGISTER_VAR_STR( varsStr, "PollerPreference",     DefaultPollerPreference     );
     REGISTER_VAR_STR( varsStr, "ClientMonitor",        DefaultClientMonitor        );
@@ -302,6 +327,11 @@ namespace XrdCl
     REGISTER_VAR_STR( varsStr, "WriteRecovery",        DefaultWriteRecovery        );
     REGISTER_VAR_STR( varsStr, "OpenRecovery",         DefaultOpenRecovery         );
     REGISTER_VAR_STR( varsStr, "GlfnRedirector",       DefaultGlfnRedirector       );
+    REGISTER_VAR_STR( varsStr, "CPLocalIO",            DefaultCPLocalIO            );
+    REGISTER_VAR_STR( varsStr, "LanTCPCongestion",     DefaultTCPCongestion        );
+    REGISTER_VAR_STR( varsStr, "WanTCPCongestion",     DefaultTCPCongestion        );
+    REGISTER_VAR_STR( varsStr, "MetalinkCountry",      DefaultMetalinkCountry      );
+    REGISTER_VAR_STR( varsStr, "TraceSpans",           DefaultTraceSpans           );
 
     //--------------------------------------------------------------------------
     // Process the configuration files
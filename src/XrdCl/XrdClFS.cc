@@ -32,11 +32,14 @@
 #include "XrdCl/XrdClUtils.hh"
 #include "XrdCl/XrdClCopyProcess.hh"
 #include "XrdCl/XrdClFile.hh"
+#include "XrdSys/XrdSysPthread.hh"
 
 #include <cstdlib>
 #include <cstdio>
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
 #include <cmath>
 
 #ifdef HAVE_READLINE
@@ -828,6 +831,42 @@ XRootDStatus ProcessStatQuery( StatInfo *info, const std::string &query )
   return XRootDStatus( stError, errResponseNegative );
 }
 
+//------------------------------------------------------------------------------
+// Print the stat info of a path
+//------------------------------------------------------------------------------
+void PrintStatInfo( std::ostream &out, const std::string &fullPath,
+                    StatInfo *info )
+{
+  std::string flags;
+
+  if( info->TestFlags( StatInfo::XBitSet ) )
+    flags += "XBitSet|";
+  if( info->TestFlags( StatInfo::IsDir ) )
+    flags += "IsDir|";
+  if( info->TestFlags( StatInfo::Other ) )
+    flags += "Other|";
+  if( info->TestFlags( StatInfo::Offline ) )
+    flags += "Offline|";
+  if( info->TestFlags( StatInfo::POSCPending ) )
+    flags += "POSCPending|";
+  if( info->TestFlags( StatInfo::IsReadable ) )
+    flags += "IsReadable|";
+  if( info->TestFlags( StatInfo::IsWritable ) )
+    flags += "IsWritable|";
+  if( info->TestFlags( StatInfo::BackUpExists ) )
+    flags += "BackUpExists|";
+
+  if( !flags.empty() )
+    flags.erase( flags.length()-1, 1 );
+
+  out << "Path:   " << fullPath << std::endl;
+  out << "Id:     " << info->GetId() << std::endl;
+  out << "Size:   " << info->GetSize() << std::endl;
+  out << "MTime:  " << info->GetModTimeAsString() << std::endl;
+  out << "Flags:  " << info->GetFlags() << " (" << flags << ")";
+  out << std::endl;
+}
+
 //------------------------------------------------------------------------------
 // Stat a path
 //------------------------------------------------------------------------------
@@ -893,34 +932,7 @@ XRootDStatus DoStat( FileSystem                      *fs,
   //----------------------------------------------------------------------------
   // Print the result
   //----------------------------------------------------------------------------
-  std::string flags;
-
-  if( info->TestFlags( StatInfo::XBitSet ) )
-    flags += "XBitSet|";
-  if( info->TestFlags( StatInfo::IsDir ) )
-    flags += "IsDir|";
-  if( info->TestFlags( StatInfo::Other ) )
-    flags += "Other|";
-  if( info->TestFlags( StatInfo::Offline ) )
-    flags += "Offline|";
-  if( info->TestFlags( StatInfo::POSCPending ) )
-    flags += "POSCPending|";
-  if( info->TestFlags( StatInfo::IsReadable ) )
-    flags += "IsReadable|";
-  if( info->TestFlags( StatInfo::IsWritable ) )
-    flags += "IsWritable|";
-  if( info->TestFlags( StatInfo::BackUpExists ) )
-    flags += "BackUpExists|";
-
-  if( !flags.empty() )
-    flags.erase( flags.length()-1, 1 );
-
-  std::cout << "Path:   " << fullPath << std::endl;
-  std::cout << "Id:     " << info->GetId() << std::endl;
-  std::cout << "Size:   " << info->GetSize() << std::endl;
-  std::cout << "MTime:  " << info->GetModTimeAsString() << std::endl;
-  std::cout << "Flags:  " << info->GetFlags() << " (" << flags << ")";
-  std::cout << std::endl;
+  PrintStatInfo( std::cout, fullPath, info );
   if( query.length() != 0 )
   {
     st = ProcessStatQuery( info, query );
@@ -1485,12 +1497,19 @@ XRootDStatus PrintHelp( FileSystem *, Env *,
 {
   printf( "Usage:\n"                                                          );
   printf( "   xrdfs [--no-cwd] host[:port]              - interactive mode\n" );
-  printf( "   xrdfs            host[:port] command args - batch mode\n\n"     );
+  printf( "   xrdfs            host[:port] command args - batch mode\n"       );
+  printf( "   xrdfs [--no-cwd] host[:port] batch [-j n] [file]\n"             );
+  printf( "                                             - pipelined mode\n\n"   );
 
   printf( "Available options:\n\n"                                            );
 
   printf( "   --no-cwd no CWD is being preset\n\n"                            );
 
+  printf( "Pipelined mode reads commands, one per line, from file or stdin\n" );
+  printf( "and runs chmod, mkdir, mv, rm, rmdir, stat and truncate with up\n"   );
+  printf( "to n (default 16) of them in flight. Results are printed as they\n" );
+  printf( "complete; any other command waits for those in flight to finish.\n\n" );
+
   printf( "Available commands:\n\n"                                           );
 
   printf( "   exit\n"                                                         );
@@ -1852,6 +1871,245 @@ int ExecuteCommand( const URL &url, int argc, char **argv )
   return st;
 }
 
+//------------------------------------------------------------------------------
+// State shared by the commands in flight in pipelined mode
+//------------------------------------------------------------------------------
+struct BatchContext
+{
+  BatchContext( int maxInFlight ): slots( maxInFlight ), slotCount( maxInFlight ),
+                                   lastCode( 0 ) {}
+
+  //----------------------------------------------------------------------------
+  // Wait for all the commands in flight to complete
+  //----------------------------------------------------------------------------
+  void Drain()
+  {
+    for( int i = 0; i < slotCount; ++i ) slots.Wait();
+    for( int i = 0; i < slotCount; ++i ) slots.Post();
+  }
+
+  XrdSysSemaphore slots;
+  int             slotCount;
+  XrdSysMutex     outMutex;
+  int             lastCode;
+};
+
+//------------------------------------------------------------------------------
+// Print the outcome of a pipelined command
+//------------------------------------------------------------------------------
+class BatchHandler: public ResponseHandler
+{
+  public:
+    BatchHandler( BatchContext *ctx, uint64_t line, const std::string &cmd,
+                  const std::string &path ):
+      pCtx( ctx ), pLine( line ), pCmd( cmd ), pPath( path ) {}
+
+    virtual void HandleResponse( XRootDStatus *status, AnyObject *response )
+    {
+      std::ostringstream out;
+      if( status->IsOK() && response && pCmd == "stat" )
+      {
+        StatInfo *info = 0;
+        response->Get( info );
+        if( info ) PrintStatInfo( out, pPath, info );
+      }
+
+      pCtx->outMutex.Lock();
+      if( status->IsOK() )
+        std::cout << out.str() << std::flush;
+      else
+      {
+        std::cerr << "[" << pLine << "] " << pCmd << " " << pPath << ": ";
+        std::cerr << status->ToStr() << std::endl;
+        pCtx->lastCode = status->GetShellCode();
+      }
+      pCtx->outMutex.UnLock();
+
+      delete status;
+      delete response;
+      pCtx->slots.Post();
+      delete this;
+    }
+
+  private:
+    BatchContext *pCtx;
+    uint64_t      pLine;
+    std::string   pCmd;
+    std::string   pPath;
+};
+
+//------------------------------------------------------------------------------
+// Issue a command asynchronously if it is one we can pipeline
+//------------------------------------------------------------------------------
+bool PipelineCommand( FileSystem *fs, Env *env, BatchContext *ctx,
+                      uint64_t line, const FSExecutor::CommandParams &args,
+                      XRootDStatus &st )
+{
+  const std::string &cmd  = args[0];
+  uint32_t           argc = args.size();
+  std::string        path, path2;
+  Access::Mode       mode = Access::None;
+  uint64_t           size = 0;
+
+  //----------------------------------------------------------------------------
+  // Check if we know how to do this one, if not it is run synchronously
+  //----------------------------------------------------------------------------
+  if( argc == 2 )
+  {
+    if( cmd != "rm" && cmd != "rmdir" && cmd != "stat" && cmd != "mkdir" )
+      return false;
+    if( cmd == "mkdir" && args[1][0] == '-' )
+      return false;
+    if( cmd == "mkdir" )
+      ConvertMode( mode, "rwxr-x---" );
+  }
+  else if( argc == 3 )
+  {
+    if( cmd == "chmod" )
+    {
+      if( !( st = ConvertMode( mode, args[2] ) ).IsOK() )
+        return true;
+    }
+    else if( cmd == "truncate" )
+    {
+      char *result;
+      size = ::strtoll( args[2].c_str(), &result, 0 );
+      if( *result != 0 )
+      {
+        st = XRootDStatus( stError, errInvalidArgs );
+        return true;
+      }
+    }
+    else if( cmd == "mv" )
+    {
+      if( !( st = BuildPath( path2, env, args[2] ) ).IsOK() )
+        return true;
+    }
+    else return false;
+  }
+  else return false;
+
+  if( !( st = BuildPath( path, env, args[1] ) ).IsOK() )
+    return true;
+
+  //----------------------------------------------------------------------------
+  // Wait for a free slot and fire it off
+  //----------------------------------------------------------------------------
+  BatchHandler *handler = new BatchHandler( ctx, line, cmd, path );
+  ctx->slots.Wait();
+
+       if( cmd == "rm" )       st = fs->Rm( path, handler );
+  else if( cmd == "rmdir" )    st = fs->RmDir( path, handler );
+  else if( cmd == "stat" )     st = fs->Stat( path, handler );
+  else if( cmd == "mkdir" )    st = fs->MkDir( path, MkDirFlags::None, mode,
+                                               handler );
+  else if( cmd == "chmod" )    st = fs->ChMod( path, mode, handler );
+  else if( cmd == "truncate" ) st = fs->Truncate( path, size, handler );
+  else                         st = fs->Mv( path, path2, handler );
+
+  if( !st.IsOK() )
+  {
+    delete handler;
+    ctx->slots.Post();
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Execute commands read from a file or stdin, pipelining what we can
+//------------------------------------------------------------------------------
+int ExecuteBatch( const URL &url, int argc, char **argv, bool noCwd )
+{
+  //----------------------------------------------------------------------------
+  // Parse the arguments: batch [-j n] [file]
+  //----------------------------------------------------------------------------
+  int         maxInFlight = 16;
+  std::string inName      = "-";
+
+  for( int i = 1; i < argc; ++i )
+  {
+    if( !strcmp( argv[i], "-j" ) && i+1 < argc )
+    {
+      maxInFlight = atoi( argv[++i] );
+      if( maxInFlight < 1 )
+      {
+        std::cerr << "Invalid number of commands in flight" << std::endl;
+        return 50;
+      }
+    }
+    else inName = argv[i];
+  }
+
+  std::ifstream inFile;
+  if( inName != "-" )
+  {
+    inFile.open( inName.c_str() );
+    if( !inFile.good() )
+    {
+      std::cerr << "Unable to open " << inName << std::endl;
+      return 50;
+    }
+  }
+  std::istream &in = ( inName == "-" ? std::cin : inFile );
+
+  //----------------------------------------------------------------------------
+  // Set up the environment
+  //----------------------------------------------------------------------------
+  FSExecutor   *ex = CreateExecutor( url );
+  FileSystem    fs( url );
+  BatchContext  ctx( maxInFlight );
+  Env          *env = ex->GetEnv();
+
+  if( noCwd )
+    env->PutInt( "NoCWD", 1 );
+
+  //----------------------------------------------------------------------------
+  // Execute the commands
+  //----------------------------------------------------------------------------
+  std::string input, cmdline;
+  uint64_t    line = 0;
+  while( std::getline( in, input ) )
+  {
+    ++line;
+    if( cmdline.empty() && ( input.empty() || input[0] == '#' ) )
+      continue;
+    if( cmdline.empty() && ( input == "exit" || input == "quit" ) )
+      break;
+
+    std::vector<std::string> args;
+    cmdline += input;
+    if( !getArguments( args, cmdline ) )
+      continue;
+    cmdline.erase();
+    if( args.empty() )
+      continue;
+
+    XRootDStatus st;
+    if( !PipelineCommand( &fs, env, &ctx, line, args, st ) )
+    {
+      ctx.Drain();
+      std::cout << std::flush;
+      st = ex->Execute( args );
+    }
+
+    if( !st.IsOK() )
+    {
+      ctx.outMutex.Lock();
+      std::cerr << "[" << line << "] " << args[0] << ": " << st.ToStr();
+      std::cerr << std::endl;
+      ctx.lastCode = st.GetShellCode();
+      ctx.outMutex.UnLock();
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Cleanup
+  //----------------------------------------------------------------------------
+  ctx.Drain();
+  delete ex;
+  return ctx.lastCode;
+}
+
 //------------------------------------------------------------------------------
 // Start the show
 //------------------------------------------------------------------------------
@@ -1892,5 +2150,7 @@ int main( int argc, char **argv )
   if( argc == urlIndex + 1 )
     return ExecuteInteractive( url, noCwd );
   int shift = urlIndex + 1;
+  if( !strcmp( argv[shift], "batch" ) )
+    return ExecuteBatch( url, argc-shift, argv+shift, noCwd );
   return ExecuteCommand( url, argc-shift, argv+shift );
 }
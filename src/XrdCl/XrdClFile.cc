@@ -124,6 +124,60 @@ namespace XrdCl
     return MessageUtils::WaitForStatus( &handler );
   }
 
+  //----------------------------------------------------------------------------
+  // Open the file and read a data chunk - async
+  //----------------------------------------------------------------------------
+  XRootDStatus File::OpenRead( const std::string &url,
+                               OpenFlags::Flags   flags,
+                               uint64_t           offset,
+                               uint32_t           size,
+                               void              *buffer,
+                               bool               closeAfter,
+                               ResponseHandler   *handler,
+                               uint16_t           timeout )
+  {
+    //--------------------------------------------------------------------------
+    // Plug-ins only know how to open
+    //--------------------------------------------------------------------------
+    if( pEnablePlugIns && !pPlugIn &&
+        DefaultEnv::GetPlugInManager()->GetFactory( url ) )
+      return XRootDStatus( stError, errNotSupported );
+
+    if( pPlugIn )
+      return XRootDStatus( stError, errNotSupported );
+
+    return pStateHandler->OpenRead( url, flags, offset, size, buffer,
+                                    closeAfter, handler, timeout );
+  }
+
+  //----------------------------------------------------------------------------
+  // Open the file and read a data chunk - sync
+  //----------------------------------------------------------------------------
+  XRootDStatus File::OpenRead( const std::string &url,
+                               OpenFlags::Flags   flags,
+                               uint64_t           offset,
+                               uint32_t           size,
+                               void              *buffer,
+                               uint32_t          &bytesRead,
+                               bool               closeAfter,
+                               uint16_t           timeout )
+  {
+    SyncResponseHandler handler;
+    Status st = OpenRead( url, flags, offset, size, buffer, closeAfter,
+                          &handler, timeout );
+    if( !st.IsOK() )
+      return st;
+
+    ChunkInfo *chunkInfo = 0;
+    XRootDStatus status = MessageUtils::WaitForResponse( &handler, chunkInfo );
+    if( status.IsOK() )
+    {
+      bytesRead = chunkInfo->length;
+      delete chunkInfo;
+    }
+    return status;
+  }
+
   //----------------------------------------------------------------------------
   // Close the file - async
   //----------------------------------------------------------------------------
@@ -218,6 +272,47 @@ namespace XrdCl
     return status;
   }
 
+  //----------------------------------------------------------------------------
+  // Read a data chunk with page checksums at a given offset - async
+  //----------------------------------------------------------------------------
+  XRootDStatus File::PgRead( uint64_t         offset,
+                             uint32_t         size,
+                             void            *buffer,
+                             ResponseHandler *handler,
+                             uint16_t         timeout )
+  {
+    if( pPlugIn )
+      return XRootDStatus( stError, errNotSupported );
+
+    return pStateHandler->PgRead( offset, size, buffer, handler, timeout );
+  }
+
+  //----------------------------------------------------------------------------
+  // Read a data chunk with page checksums at a given offset - sync
+  //----------------------------------------------------------------------------
+  XRootDStatus File::PgRead( uint64_t               offset,
+                             uint32_t               size,
+                             void                  *buffer,
+                             std::vector<uint32_t> &cksums,
+                             uint32_t              &bytesRead,
+                             uint16_t               timeout )
+  {
+    SyncResponseHandler handler;
+    Status st = PgRead( offset, size, buffer, &handler, timeout );
+    if( !st.IsOK() )
+      return st;
+
+    PageInfo *pageInfo = 0;
+    XRootDStatus status = MessageUtils::WaitForResponse( &handler, pageInfo );
+    if( status.IsOK() )
+    {
+      bytesRead = pageInfo->length;
+      cksums.swap( pageInfo->cksums );
+      delete pageInfo;
+    }
+    return status;
+  }
+
   //----------------------------------------------------------------------------
   // Write a data chunk at a given offset - async
   //----------------------------------------------------------------------------
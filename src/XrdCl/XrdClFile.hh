@@ -100,6 +100,61 @@ namespace XrdCl
                          uint16_t           timeout = 0 )
                          XRD_WARN_UNUSED_RESULT;
 
+      //------------------------------------------------------------------------
+      //! Open the file pointed to by the given URL and read a data chunk at
+      //! a given offset - async. The server is asked to do both in a single
+      //! request; one that cannot is sent the read separately. If closeAfter
+      //! is set the file is closed once the data has been read, which the
+      //! server may also do as part of the same request.
+      //!
+      //! @param url        url of the file to be opened
+      //! @param flags      OpenFlags::Flags
+      //! @param offset     offset from the beginning of the file
+      //! @param size       number of bytes to be read
+      //! @param buffer     a pointer to a buffer big enough to hold the data
+      //! @param closeAfter close the file once the data has been read
+      //! @param handler    handler to be notified when the response arrives,
+      //!                   the response parameter will hold a ChunkInfo
+      //!                   object if the procedure was successful
+      //! @param timeout    timeout value, if 0 the environment default will
+      //!                   be used
+      //! @return           status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus OpenRead( const std::string &url,
+                             OpenFlags::Flags   flags,
+                             uint64_t           offset,
+                             uint32_t           size,
+                             void              *buffer,
+                             bool               closeAfter,
+                             ResponseHandler   *handler,
+                             uint16_t           timeout = 0 )
+                             XRD_WARN_UNUSED_RESULT;
+
+      //------------------------------------------------------------------------
+      //! Open the file pointed to by the given URL and read a data chunk at
+      //! a given offset - sync
+      //!
+      //! @param url        url of the file to be opened
+      //! @param flags      OpenFlags::Flags
+      //! @param offset     offset from the beginning of the file
+      //! @param size       number of bytes to be read
+      //! @param buffer     a pointer to a buffer big enough to hold the data
+      //! @param bytesRead  number of bytes actually read
+      //! @param closeAfter close the file once the data has been read
+      //! @param timeout    timeout value, if 0 the environment default will
+      //!                   be used
+      //! @return           status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus OpenRead( const std::string &url,
+                             OpenFlags::Flags   flags,
+                             uint64_t           offset,
+                             uint32_t           size,
+                             void              *buffer,
+                             uint32_t          &bytesRead,
+                             bool               closeAfter = false,
+                             uint16_t           timeout    = 0 )
+                             XRD_WARN_UNUSED_RESULT;
+
       //------------------------------------------------------------------------
       //! Close the file - async
       //!
@@ -191,6 +246,50 @@ namespace XrdCl
                          uint16_t  timeout = 0 )
                          XRD_WARN_UNUSED_RESULT;
 
+      //------------------------------------------------------------------------
+      //! Read a data chunk at a given offset along with the CRC32C checksum
+      //! of every 4KB page - async. The checksums are computed or supplied
+      //! by the server and are verified as the data arrives, a mismatch
+      //! fails the request with errDataError.
+      //!
+      //! @param offset  offset from the beginning of the file
+      //! @param size    number of bytes to be read
+      //! @param buffer  a pointer to a buffer big enough to hold the data
+      //! @param handler handler to be notified when the response arrives,
+      //!                the response parameter will hold a PageInfo object if
+      //!                the procedure was successful
+      //! @param timeout timeout value, if 0 the environment default will be
+      //!                used
+      //! @return        status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus PgRead( uint64_t         offset,
+                           uint32_t         size,
+                           void            *buffer,
+                           ResponseHandler *handler,
+                           uint16_t         timeout = 0 )
+                           XRD_WARN_UNUSED_RESULT;
+
+      //------------------------------------------------------------------------
+      //! Read a data chunk at a given offset along with the CRC32C checksum
+      //! of every 4KB page - sync
+      //!
+      //! @param offset    offset from the beginning of the file
+      //! @param size      number of bytes to be read
+      //! @param buffer    a pointer to a buffer big enough to hold the data
+      //! @param cksums    the verified checksums of the pages read
+      //! @param bytesRead number of bytes actually read
+      //! @param timeout   timeout value, if 0 the environment default will be
+      //!                  used
+      //! @return          status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus PgRead( uint64_t               offset,
+                           uint32_t               size,
+                           void                  *buffer,
+                           std::vector<uint32_t> &cksums,
+                           uint32_t              &bytesRead,
+                           uint16_t               timeout = 0 )
+                           XRD_WARN_UNUSED_RESULT;
+
       //------------------------------------------------------------------------
       //! Write a data chunk at a given offset - async
       //! The call interprets and returns the server response, which may be
@@ -456,6 +555,20 @@ namespace XrdCl
       //! ReadRecovery     [true/false] - enable/disable read recovery
       //! WriteRecovery    [true/false] - enable/disable write recovery
       //! FollowRedirects  [true/false] - enable/disable following redirections
+      //! ReadStripeSize   [bytes]      - split bigger reads over the substreams
+      //!                                 (0 disables striping)
+      //! ReadBatchSize    [bytes]      - send concurrent reads up to this size
+      //!                                 as one vector read (0 disables it)
+      //! WriteBehindSize  [bytes]      - buffer writes smaller than this and
+      //!                                 send them together, errors are
+      //!                                 reported by the next sync or close
+      //!                                 (0 disables it)
+      //! LocalIO          [buffered/stream/direct] - for local files, whether
+      //!                                 the data goes through the page cache,
+      //!                                 is dropped from it once read or
+      //!                                 written back, or bypasses it with
+      //!                                 O_DIRECT where aligned; to be set
+      //!                                 before opening
       //------------------------------------------------------------------------
       bool SetProperty( const std::string &name, const std::string &value );
 
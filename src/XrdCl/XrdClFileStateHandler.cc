@@ -38,13 +38,212 @@
 #include "XrdCl/XrdClJobManager.hh"
 #include "XrdCl/XrdClUglyHacks.hh"
 #include "XrdClRedirectorRegistry.hh"
+#include "XrdCl/XrdClHostMetrics.hh"
+#include "XrdCl/XrdClRedirectCache.hh"
+#include "XrdOuc/XrdOucTraceCtx.hh"
 
 #include <sstream>
 #include <memory>
+#include <vector>
+#include <list>
+#include <algorithm>
 #include <sys/time.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 namespace
 {
+  //----------------------------------------------------------------------------
+  // Check if a file opened without a trace context should start a new trace,
+  // the first call sets up the span exporter. The sampling has its own count
+  // as the server that loaded us, if any, may sample its files at another rate
+  //----------------------------------------------------------------------------
+  bool TraceSampled()
+  {
+    using namespace XrdCl;
+    static std::atomic<uint32_t> count( 0 );
+    static int                   every = []()
+    {
+      Env *env = DefaultEnv::GetEnv();
+      int  n   = DefaultTraceSample;
+      std::string dest;
+      env->GetInt( "TraceSample", n );
+      env->GetString( "TraceSpans", dest );
+      if( !dest.empty() && !XrdOucTraceCtx::Exporting() &&
+          !XrdOucTraceCtx::Export( dest.c_str() ) )
+        DefaultEnv::GetLog()->Error( FileMsg, "Unable to export spans to %s: "
+                                     "%s", dest.c_str(), strerror( errno ) );
+      return n > 0 ? n : 0;
+    }();
+
+    return every && count++ % every == 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Object that completes an open that was asked to read data as well, it
+  // reads the data itself if the server did not send it along with the open
+  // response, closes the file if asked to and then calls the user handler
+  //----------------------------------------------------------------------------
+  class OpenReadHandler: public XrdCl::ResponseHandler
+  {
+    public:
+      //------------------------------------------------------------------------
+      // Constructor
+      //------------------------------------------------------------------------
+      OpenReadHandler( XrdCl::FileStateHandler *stateHandler,
+                       XrdCl::ResponseHandler  *userHandler,
+                       const XrdCl::ChunkInfo  &chunk,
+                       bool                     closeAfter,
+                       uint16_t                 timeout ):
+        pStateHandler( stateHandler ),
+        pUserHandler( userHandler ),
+        pChunk( chunk ),
+        pCloseAfter( closeAfter ),
+        pTimeout( timeout ),
+        pHaveData( false ),
+        pClosed( false ),
+        pReading( false ),
+        pStatus( 0 ),
+        pHostList( 0 )
+      {
+      }
+
+      //------------------------------------------------------------------------
+      // Take the data that came with the open response
+      //------------------------------------------------------------------------
+      void SetData( const XrdCl::OpenInfo &openInfo )
+      {
+        if( !openInfo.HasReadData() ) return;
+        const std::string &data = openInfo.GetReadData();
+        pChunk.length = std::min<uint32_t>( pChunk.length, data.size() );
+        memcpy( pChunk.buffer, data.data(), pChunk.length );
+        pHaveData = true;
+        pClosed   = openInfo.IsReadClosed();
+      }
+
+      //------------------------------------------------------------------------
+      // Carry on once the open has completed
+      //------------------------------------------------------------------------
+      void Start( XrdCl::XRootDStatus *status, XrdCl::HostList *hostList )
+      {
+        pStatus   = status;
+        pHostList = hostList;
+
+        if( !pStatus->IsOK() )
+          Done();
+        else if( pClosed )
+        {
+          pStateHandler->OnClose( pStatus );
+          Done();
+        }
+        else if( !pHaveData )
+        {
+          pReading = true;
+          Issue( pStateHandler->Read( pChunk.offset, pChunk.length,
+                                      pChunk.buffer, this, pTimeout ) );
+        }
+        else
+          Finish();
+      }
+
+      //------------------------------------------------------------------------
+      // Handle the response to the read or the close
+      //------------------------------------------------------------------------
+      virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
+                                            XrdCl::AnyObject    *response,
+                                            XrdCl::HostList     *hostList )
+      {
+        using namespace XrdCl;
+        delete hostList;
+
+        if( pReading )
+        {
+          pReading = false;
+          if( status->IsOK() )
+          {
+            ChunkInfo *chunk = 0;
+            response->Get( chunk );
+            pChunk.length = chunk->length;
+          }
+          else
+            *pStatus = *status;
+          delete status;
+          delete response;
+          Finish();
+          return;
+        }
+
+        //----------------------------------------------------------------------
+        // A failed read takes precedence over a failed close
+        //----------------------------------------------------------------------
+        if( pStatus->IsOK() && !status->IsOK() )
+          *pStatus = *status;
+        delete status;
+        delete response;
+        Done();
+      }
+
+    private:
+      //------------------------------------------------------------------------
+      // Close the file if asked to, otherwise we are done
+      //------------------------------------------------------------------------
+      void Finish()
+      {
+        if( pCloseAfter )
+          Issue( pStateHandler->Close( this, pTimeout ) );
+        else
+          Done();
+      }
+
+      //------------------------------------------------------------------------
+      // Finish up if a request could not be issued
+      //------------------------------------------------------------------------
+      void Issue( const XrdCl::XRootDStatus &st )
+      {
+        if( st.IsOK() ) return;
+        if( pStatus->IsOK() )
+          *pStatus = st;
+        Done();
+      }
+
+      //------------------------------------------------------------------------
+      // Call the user handler and say bye bye
+      //------------------------------------------------------------------------
+      void Done()
+      {
+        using namespace XrdCl;
+        AnyObject *obj = 0;
+        if( pStatus->IsOK() )
+        {
+          obj = new AnyObject();
+          obj->Set( new ChunkInfo( pChunk ) );
+        }
+
+        if( pUserHandler )
+          pUserHandler->HandleResponseWithHosts( pStatus, obj, pHostList );
+        else
+        {
+          delete pStatus;
+          delete obj;
+          delete pHostList;
+        }
+        delete this;
+      }
+
+      XrdCl::FileStateHandler *pStateHandler;
+      XrdCl::ResponseHandler  *pUserHandler;
+      XrdCl::ChunkInfo         pChunk;
+      bool                     pCloseAfter;
+      uint16_t                 pTimeout;
+      bool                     pHaveData;
+      bool                     pClosed;
+      bool                     pReading;
+      XrdCl::XRootDStatus     *pStatus;
+      XrdCl::HostList         *pHostList;
+  };
+
   //----------------------------------------------------------------------------
   // Object that does things to the FileStateHandler when kXR_open returns
   // and then calls the user handler
@@ -56,9 +255,11 @@ namespace
       // Constructor
       //------------------------------------------------------------------------
       OpenHandler( XrdCl::FileStateHandler *stateHandler,
-                   XrdCl::ResponseHandler  *userHandler ):
+                   XrdCl::ResponseHandler  *userHandler,
+                   OpenReadHandler         *readHandler = 0 ):
         pStateHandler( stateHandler ),
-        pUserHandler( userHandler )
+        pUserHandler( userHandler ),
+        pReadHandler( readHandler )
       {
       }
 
@@ -74,16 +275,33 @@ namespace
         //----------------------------------------------------------------------
         // Extract the statistics info
         //----------------------------------------------------------------------
+        //----------------------------------------------------------------------
+        // The open may have gone to a cached data server and have to be
+        // repeated at the redirector
+        //----------------------------------------------------------------------
+        if( pStateHandler->RetryOpen( status, this ) )
+        {
+          delete status;
+          delete response;
+          delete hostList;
+          return;
+        }
+
         OpenInfo *openInfo = 0;
         if( status->IsOK() )
           response->Get( openInfo );
 
+        if( pReadHandler && openInfo )
+          pReadHandler->SetData( *openInfo );
+
         //----------------------------------------------------------------------
         // Notify the state handler and the client and say bye bye
         //----------------------------------------------------------------------
         pStateHandler->OnOpen( status, openInfo, hostList );
         delete response;
-        if( pUserHandler )
+        if( pReadHandler )
+          pReadHandler->Start( status, hostList );
+        else if( pUserHandler )
           pUserHandler->HandleResponseWithHosts( status, 0, hostList );
         else
         {
@@ -96,6 +314,7 @@ namespace
     private:
       XrdCl::FileStateHandler *pStateHandler;
       XrdCl::ResponseHandler  *pUserHandler;
+      OpenReadHandler         *pReadHandler;
   };
 
   //----------------------------------------------------------------------------
@@ -169,6 +388,7 @@ namespace
         pMessage( message ),
         pSendParams( sendParams )
       {
+        gettimeofday( &pStart, 0 );
       }
 
       //------------------------------------------------------------------------
@@ -201,8 +421,10 @@ namespace
         }
 
         //----------------------------------------------------------------------
-        // We're clear
+        // We're clear, large reads tell us how fast the server is
         //----------------------------------------------------------------------
+        ReportTransfer( hostList );
+        if( pStateHandler->IsTraced() ) ReportSpan( hostList );
         responsePtr.release();
         pStateHandler->OnStateResponse( status, pMessage, response, hostList );
         pUserHandler->HandleResponseWithHosts( status, response, hostList );
@@ -218,146 +440,748 @@ namespace
       }
 
     private:
+      //------------------------------------------------------------------------
+      // Feed the read throughput into the host metrics
+      //------------------------------------------------------------------------
+      void ReportTransfer( XrdCl::HostList *hostList )
+      {
+        using namespace XrdCl;
+        ClientRequest *req = (ClientRequest*)pMessage->GetBuffer();
+        uint32_t rlen;
+        if( req->header.requestid == kXR_read )        rlen = req->read.rlen;
+        else if( req->header.requestid == kXR_pgread ) rlen = req->pgread.rlen;
+        else return;
+        if( rlen < HostMetrics::MinTransferSize || !hostList ||
+            hostList->empty() || hostList->back().url.IsLocalFile() )
+          return;
+
+        timeval now;
+        gettimeofday( &now, 0 );
+        double secs = ( now.tv_sec - pStart.tv_sec ) +
+                      ( now.tv_usec - pStart.tv_usec ) / 1000000.0;
+        HostMetrics::ReportTransfer( HostMetrics::Key( hostList->back().url ),
+                                     rlen, secs );
+      }
+
+      //------------------------------------------------------------------------
+      // Report the reads of a traced file as spans
+      //------------------------------------------------------------------------
+      void ReportSpan( XrdCl::HostList *hostList )
+      {
+        using namespace XrdCl;
+        ClientRequest *req = (ClientRequest*)pMessage->GetBuffer();
+        ChunkList     *chunks = pSendParams.chunkList;
+        const char    *name;
+        uint64_t       offset = 0;
+        uint32_t       length = 0;
+
+        switch( req->header.requestid )
+        {
+          case kXR_read:
+            name = "xrdcl.read";
+            offset = req->read.offset; length = req->read.rlen;
+            break;
+          case kXR_pgread:
+            name = "xrdcl.pgread";
+            offset = req->pgread.offset; length = req->pgread.rlen;
+            break;
+          case kXR_readv:
+            name = "xrdcl.readv";
+            if( chunks && !chunks->empty() )
+            {
+              offset = chunks->front().offset;
+              for( size_t i = 0; i < chunks->size(); ++i )
+                length += (*chunks)[i].length;
+            }
+            break;
+          default:
+            return;
+        }
+        pStateHandler->OnStateSpan( name, pStart, offset, length, hostList );
+      }
+
       XrdCl::FileStateHandler  *pStateHandler;
       XrdCl::ResponseHandler   *pUserHandler;
       XrdCl::Message           *pMessage;
       XrdCl::MessageSendParams  pSendParams;
+      timeval                   pStart;
   };
-}
 
-namespace XrdCl
-{
-  //------------------------------------------------------------------------
-  //! Holds a reference to a ResponceHandler
-  //! and allows to safely delete it
-  //------------------------------------------------------------------------
-  class ResponseHandlerHolder : public ResponseHandler
+  //----------------------------------------------------------------------------
+  // Collects the responses to the pieces of a striped read or vector read
+  // and calls the user handler once for the whole request. The object counts
+  // one reference per piece in flight and one for the issuer, whoever drops
+  // the last one delivers the response.
+  //----------------------------------------------------------------------------
+  class StripedReadHandler
   {
     public:
       //------------------------------------------------------------------------
-      //! Constructor
+      // Constructor
       //------------------------------------------------------------------------
-      ResponseHandlerHolder( ResponseHandler * handler ) : pHandler( handler ), pReferenceCounter( 1 ) {}
+      StripedReadHandler( XrdCl::ResponseHandler *userHandler,
+                          bool                    vectorRead,
+                          uint64_t                offset,
+                          void                   *buffer,
+                          int                     nParts ):
+        pUserHandler( userHandler ),
+        pVectorRead( vectorRead ),
+        pOffset( offset ),
+        pBuffer( buffer ),
+        pExpected( nParts, 0 ),
+        pResponses( nParts, (XrdCl::AnyObject*)0 ),
+        pHostList( 0 ),
+        pPending( nParts + 1 )
+      {
+      }
+
       //------------------------------------------------------------------------
-      //! Destructor is private - use 'Destroy' in order to delete the object
-      //! Always destroys the actual ResponseHandler and deletes itself only
-      //! if this is the last reference
+      // Destructor
       //------------------------------------------------------------------------
-      void Destroy()
+      ~StripedReadHandler()
+      {
+        for( size_t i = 0; i < pResponses.size(); ++i )
+          delete pResponses[i];
+        delete pHostList;
+      }
+
+      //------------------------------------------------------------------------
+      // Get the handler for a piece of the request
+      //------------------------------------------------------------------------
+      XrdCl::ResponseHandler *GetPartHandler( int part, uint32_t expected );
+
+      //------------------------------------------------------------------------
+      // Called when the response to a piece arrives
+      //------------------------------------------------------------------------
+      void PartDone( int                  part,
+                     XrdCl::XRootDStatus *status,
+                     XrdCl::AnyObject    *response,
+                     XrdCl::HostList     *hostList )
       {
         XrdSysMutexHelper scopedLock( pMutex );
-        // delete the actual handler
-        if( pHandler )
+        if( !status->IsOK() && pStatus.IsOK() )
+          pStatus = *status;
+        delete status;
+        pResponses[part] = response;
+        if( hostList )
         {
-          delete pHandler;
-          pHandler = 0;
+          delete pHostList;
+          pHostList = hostList;
         }
-        // and than destroy myself if this is the last reference
-        DestroyMyself( scopedLock );
+
+        if( --pPending ) return;
+        scopedLock.UnLock();
+        Deliver( false );
       }
+
       //------------------------------------------------------------------------
-      //! Increment reference counter
+      // Called by the issuer after sending the pieces. The pieces from
+      // 'sent' onwards failed to go out with 'status' and will never call
+      // back. If nothing went out the error is returned and the user handler
+      // is not called, otherwise the issuer gets OK.
       //------------------------------------------------------------------------
-      ResponseHandlerHolder* Self()
+      XrdCl::XRootDStatus Issued( int sent, const XrdCl::XRootDStatus &status )
       {
         XrdSysMutexHelper scopedLock( pMutex );
-        ++pReferenceCounter;
-        return this;
+        if( sent == 0 )
+        {
+          scopedLock.UnLock();
+          delete this;
+          return status;
+        }
+
+        if( !status.IsOK() && pStatus.IsOK() )
+          pStatus = status;
+        pPending -= ( pExpected.size() - sent ) + 1;
+        if( pPending ) return XrdCl::XRootDStatus();
+        scopedLock.UnLock();
+
+        //----------------------------------------------------------------------
+        // Everything came back already, we are still under the file mutex
+        // so the user handler has to be called from a worker thread
+        //----------------------------------------------------------------------
+        Deliver( true );
+        return XrdCl::XRootDStatus();
       }
+
+    private:
       //------------------------------------------------------------------------
-      // Handle the response
+      // Assemble the response and hand it to the user
       //------------------------------------------------------------------------
-      virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
-                                            XrdCl::AnyObject    *response,
-                                            XrdCl::HostList     *hostList )
+      void Deliver( bool queue )
       {
-        XrdSysMutexHelper scopedLock( pMutex );
-        // delegate the job to the actual handler
-        if( pHandler )
+        using namespace XrdCl;
+        XRootDStatus *status   = new XRootDStatus( pStatus );
+        AnyObject    *response = 0;
+
+        if( pStatus.IsOK() )
         {
-          pHandler->HandleResponseWithHosts( status, response, hostList );
-          // after handling a response the handler destroys itself,
-          // so we need to nullify the pointer
-          pHandler = 0;
+          response = new AnyObject();
+          if( pVectorRead )
+          {
+            VectorReadInfo *info  = new VectorReadInfo();
+            uint32_t        total = 0;
+            for( size_t i = 0; i < pResponses.size(); ++i )
+            {
+              VectorReadInfo *part = 0;
+              pResponses[i]->Get( part );
+              ChunkList &chunks = part->GetChunks();
+              info->GetChunks().insert( info->GetChunks().end(),
+                                        chunks.begin(), chunks.end() );
+              total += part->GetSize();
+            }
+            info->SetSize( total );
+            response->Set( info );
+          }
+          else
+          {
+            //------------------------------------------------------------------
+            // The data is contiguous up to the first short piece
+            //------------------------------------------------------------------
+            uint32_t total = 0;
+            for( size_t i = 0; i < pResponses.size(); ++i )
+            {
+              ChunkInfo *part = 0;
+              pResponses[i]->Get( part );
+              total += part->length;
+              if( part->length < pExpected[i] ) break;
+            }
+            response->Set( new ChunkInfo( pOffset, total, pBuffer ) );
+          }
         }
+
+        HostList *hostList = pHostList;
+        pHostList = 0;
+        ResponseHandler *handler = pUserHandler;
+        delete this;
+
+        if( queue )
+        {
+          JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+          jobMan->QueueJob( new ResponseJob( handler, status, response,
+                                             hostList ) );
+        }
+        else if( handler )
+          handler->HandleResponseWithHosts( status, response, hostList );
         else
         {
           delete status;
           delete response;
           delete hostList;
         }
-        // destroy the object if it is
-        DestroyMyself( scopedLock );
       }
 
-    private:
-      //------------------------------------------------------------------------
-      //! Deletes itself only if this is the last reference
-      //------------------------------------------------------------------------
-      void DestroyMyself( XrdSysMutexHelper &lck )
-      {
-        // decrement the reference counter
-        --pReferenceCounter;
-        // if the object is not used anymore delete it
-        if( pReferenceCounter == 0)
-        {
-          lck.UnLock();
-          delete this;
-        }
-      }
-      //------------------------------------------------------------------------
-      //! Private Destructor (use 'Destroy' method)
-      //------------------------------------------------------------------------
-      ~ResponseHandlerHolder() {}
-      //------------------------------------------------------------------------
-      // The actual handler
-      //------------------------------------------------------------------------
-      ResponseHandler* pHandler;
-      //------------------------------------------------------------------------
-      // Reference counter
-      //------------------------------------------------------------------------
-      size_t pReferenceCounter;
-      //------------------------------------------------------------------------
-      // and respective mutex
-      //------------------------------------------------------------------------
-      mutable XrdSysRecMutex pMutex;
+      XrdCl::ResponseHandler          *pUserHandler;
+      bool                             pVectorRead;
+      uint64_t                         pOffset;
+      void                            *pBuffer;
+      std::vector<uint32_t>            pExpected;
+      std::vector<XrdCl::AnyObject*>   pResponses;
+      XrdCl::HostList                 *pHostList;
+      XrdCl::XRootDStatus              pStatus;
+      size_t                           pPending;
+      XrdSysMutex                      pMutex;
   };
 
   //----------------------------------------------------------------------------
-  // Constructor
+  // Forwards the response to a piece of a striped read to the collector
   //----------------------------------------------------------------------------
-  FileStateHandler::FileStateHandler():
-    pFileState( Closed ),
-    pStatInfo( 0 ),
-    pFileUrl( 0 ),
-    pDataServer( 0 ),
-    pLoadBalancer( 0 ),
-    pStateRedirect( 0 ),
-    pFileHandle( 0 ),
-    pOpenMode( 0 ),
-    pOpenFlags( 0 ),
-    pSessionId( 0 ),
-    pDoRecoverRead( true ),
-    pDoRecoverWrite( true ),
-    pFollowRedirects( true ),
-    pUseVirtRedirector( true ),
-    pReOpenHandler( 0 )
+  class StripedPartHandler: public XrdCl::ResponseHandler
   {
-    pFileHandle = new uint8_t[4];
-    ResetMonitoringVars();
-    DefaultEnv::GetForkHandler()->RegisterFileObject( this );
-    DefaultEnv::GetFileTimer()->RegisterFileObject( this );
-    pLFileHandler = new LocalFileHandler();
+    public:
+      StripedPartHandler( StripedReadHandler *collector, int part ):
+        pCollector( collector ), pPart( part ) {}
+
+      virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
+                                            XrdCl::AnyObject    *response,
+                                            XrdCl::HostList     *hostList )
+      {
+        pCollector->PartDone( pPart, status, response, hostList );
+        delete this;
+      }
+
+    private:
+      StripedReadHandler *pCollector;
+      int                 pPart;
+  };
+
+  XrdCl::ResponseHandler *StripedReadHandler::GetPartHandler( int      part,
+                                                              uint32_t expected )
+  {
+    pExpected[part] = expected;
+    return new StripedPartHandler( this, part );
   }
 
-  //------------------------------------------------------------------------
-  //! Constructor
-  //!
-  //! @param useVirtRedirector if true Metalink files will be treated
-  //!                          as a VirtualRedirectors
-  //------------------------------------------------------------------------
-  FileStateHandler::FileStateHandler( bool useVirtRedirector ):
-    pFileState( Closed ),
+  //----------------------------------------------------------------------------
+  // Servers accept at most this many elements in a kXR_readv
+  //----------------------------------------------------------------------------
+  const size_t maxReadBatch = 1024;
+
+  //----------------------------------------------------------------------------
+  // Servers accept at most this many elements in a kXR_writev and none larger
+  // than their transfer size, which is at least 256KB
+  //----------------------------------------------------------------------------
+  const size_t   maxWriteBatch   = 1024;
+  const uint32_t maxWriteSegment = 262144;
+
+  //----------------------------------------------------------------------------
+  // Handles the response to a batch of small reads sent as one request,
+  // a plain kXR_read for a batch of one, and hands every user handler its
+  // own piece
+  //----------------------------------------------------------------------------
+  class ReadBatchHandler: public XrdCl::ResponseHandler
+  {
+    public:
+      ReadBatchHandler( std::atomic<uint32_t>                     &inFlight,
+                        const std::vector<XrdCl::ResponseHandler*> &handlers,
+                        bool                                        vectorRead ):
+        pInFlight( inFlight ), pHandlers( handlers ), pVectorRead( vectorRead )
+      {
+      }
+
+      virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
+                                            XrdCl::AnyObject    *response,
+                                            XrdCl::HostList     *hostList )
+      {
+        using namespace XrdCl;
+
+        //----------------------------------------------------------------------
+        // The file may be gone once the user handlers have run
+        //----------------------------------------------------------------------
+        --pInFlight;
+
+        if( !pVectorRead )
+        {
+          pHandlers[0]->HandleResponseWithHosts( status, response, hostList );
+          delete this;
+          return;
+        }
+
+        VectorReadInfo *info = 0;
+        if( status->IsOK() )
+        {
+          response->Get( info );
+          if( !info || info->GetChunks().size() != pHandlers.size() )
+          {
+            *status = XRootDStatus( stError, errInvalidResponse );
+            info    = 0;
+          }
+        }
+
+        for( size_t i = 0; i < pHandlers.size(); ++i )
+        {
+          AnyObject *piece = 0;
+          if( info )
+          {
+            piece = new AnyObject();
+            piece->Set( new ChunkInfo( info->GetChunks()[i] ) );
+          }
+          pHandlers[i]->HandleResponseWithHosts( new XRootDStatus( *status ),
+                                                 piece,
+                                                 hostList ? new HostList( *hostList ) : 0 );
+        }
+
+        delete status;
+        delete response;
+        delete hostList;
+        delete this;
+      }
+
+    private:
+      std::atomic<uint32_t>              &pInFlight;
+      std::vector<XrdCl::ResponseHandler*> pHandlers;
+      bool                                 pVectorRead;
+  };
+
+  //----------------------------------------------------------------------------
+  // Keeps the data of a batch of buffered writes until the server has
+  // answered and tells the file how it went
+  //----------------------------------------------------------------------------
+  class WriteBatchHandler: public XrdCl::ResponseHandler
+  {
+    public:
+      WriteBatchHandler( XrdCl::FileStateHandler *stateHandler,
+                         std::vector<char>       &data ):
+        pStateHandler( stateHandler )
+      {
+        pData.swap( data );
+      }
+
+      virtual void HandleResponse( XrdCl::XRootDStatus *status,
+                                   XrdCl::AnyObject    *response )
+      {
+        pStateHandler->OnWriteBatch( status );
+        delete status;
+        delete response;
+        delete this;
+      }
+
+    private:
+      XrdCl::FileStateHandler *pStateHandler;
+      std::vector<char>        pData;
+  };
+
+  //----------------------------------------------------------------------------
+  // Reports the failure of a buffered write in place of the success of the
+  // operation that followed it
+  //----------------------------------------------------------------------------
+  class WriteErrorHandler: public XrdCl::ResponseHandler
+  {
+    public:
+      WriteErrorHandler( XrdCl::ResponseHandler    *userHandler,
+                         const XrdCl::XRootDStatus &error ):
+        pUserHandler( userHandler ), pError( error )
+      {
+      }
+
+      virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
+                                            XrdCl::AnyObject    *response,
+                                            XrdCl::HostList     *hostList )
+      {
+        if( status->IsOK() )
+          *status = pError;
+        pUserHandler->HandleResponseWithHosts( status, response, hostList );
+        delete this;
+      }
+
+    private:
+      XrdCl::ResponseHandler *pUserHandler;
+      XrdCl::XRootDStatus     pError;
+  };
+
+  //----------------------------------------------------------------------------
+  // Sends the batches of small reads and writes whose window has passed. A
+  // single thread serves all the files.
+  //----------------------------------------------------------------------------
+  class BatchTimer
+  {
+    public:
+      //------------------------------------------------------------------------
+      // Get the timer, it is never deleted
+      //------------------------------------------------------------------------
+      static BatchTimer *Instance()
+      {
+        static BatchTimer *timer = new BatchTimer();
+        return timer;
+      }
+
+      //------------------------------------------------------------------------
+      // Flush the read (or write) batch with the given generation of the file
+      // in ms milliseconds
+      //------------------------------------------------------------------------
+      void Schedule( XrdCl::FileStateHandler *file, uint64_t gen, int ms,
+                     bool write = false )
+      {
+        pCond.Lock();
+        if( pPid != getpid() )
+        {
+          //--------------------------------------------------------------------
+          // First use or we are a forked child, so there is no thread
+          //--------------------------------------------------------------------
+          pthread_t tid;
+          pEntries.clear();
+          pBusy = 0;
+          if( pthread_create( &tid, 0, BatchTimer::Run, this ) == 0 )
+          {
+            pthread_detach( tid );
+            pPid = getpid();
+          }
+        }
+        //----------------------------------------------------------------------
+        // Batches of the same kind expire in the order they were started, so
+        // this only walks past the ones with a longer window
+        //----------------------------------------------------------------------
+        Entry e( file, gen, Now() + ms, write );
+        std::list<Entry>::iterator it = pEntries.end();
+        while( it != pEntries.begin() )
+        {
+          std::list<Entry>::iterator prev = it; --prev;
+          if( prev->deadline <= e.deadline ) break;
+          it = prev;
+        }
+        if( pEntries.insert( it, e ) == pEntries.begin() )
+          pCond.Broadcast();
+        pCond.UnLock();
+      }
+
+      //------------------------------------------------------------------------
+      // Forget about the file, wait if its batch is being sent
+      //------------------------------------------------------------------------
+      void Remove( XrdCl::FileStateHandler *file )
+      {
+        pCond.Lock();
+        std::list<Entry>::iterator it = pEntries.begin();
+        while( it != pEntries.end() )
+        {
+          if( it->file == file )
+            it = pEntries.erase( it );
+          else
+            ++it;
+        }
+        while( pBusy == file )
+          pCond.Wait();
+        pCond.UnLock();
+      }
+
+    private:
+      struct Entry
+      {
+        Entry( XrdCl::FileStateHandler *f, uint64_t g, uint64_t d, bool w ):
+          file( f ), gen( g ), deadline( d ), write( w ) {}
+        XrdCl::FileStateHandler *file;
+        uint64_t                 gen;
+        uint64_t                 deadline;
+        bool                     write;
+      };
+
+      BatchTimer(): pCond( 0 ), pBusy( 0 ), pPid( 0 ) {}
+
+      static uint64_t Now()
+      {
+        timespec ts;
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+      }
+
+      static void *Run( void *arg )
+      {
+        ((BatchTimer*)arg)->Loop();
+        return 0;
+      }
+
+      void Loop()
+      {
+        pCond.Lock();
+        for( ;; )
+        {
+          if( pEntries.empty() )
+          {
+            pCond.Wait();
+            continue;
+          }
+
+          uint64_t now = Now();
+          Entry    e   = pEntries.front();
+          if( e.deadline > now )
+          {
+            pCond.WaitMS( e.deadline - now );
+            continue;
+          }
+
+          //--------------------------------------------------------------------
+          // Never take the file lock while holding ours, the files call us
+          // with theirs held
+          //--------------------------------------------------------------------
+          pEntries.pop_front();
+          pBusy = e.file;
+          pCond.UnLock();
+          if( e.write )
+            e.file->FlushWriteBatch( e.gen );
+          else
+            e.file->FlushReadBatch( e.gen );
+          pCond.Lock();
+          pBusy = 0;
+          pCond.Broadcast();
+        }
+      }
+
+      XrdSysCondVar            pCond;
+      std::list<Entry>         pEntries;
+      XrdCl::FileStateHandler *pBusy;
+      pid_t                    pPid;
+  };
+}
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  // The small reads waiting to be sent as one request
+  //----------------------------------------------------------------------------
+  struct FileStateHandler::ReadBatch
+  {
+    ReadBatch( uint16_t t ): timeout( t ) {}
+    ChunkList                      chunks;
+    std::vector<ResponseHandler*>  handlers;
+    uint16_t                       timeout;
+  };
+
+  //----------------------------------------------------------------------------
+  // The small writes waiting to be sent as one request, the chunks point
+  // into the data once the batch is sent
+  //----------------------------------------------------------------------------
+  struct FileStateHandler::WriteBatch
+  {
+    WriteBatch( uint16_t t ): timeout( t ) {}
+    ChunkList                      chunks;
+    std::vector<char>              data;
+    uint16_t                       timeout;
+  };
+
+  //------------------------------------------------------------------------
+  //! Holds a reference to a ResponceHandler
+  //! and allows to safely delete it
+  //------------------------------------------------------------------------
+  class ResponseHandlerHolder : public ResponseHandler
+  {
+    public:
+      //------------------------------------------------------------------------
+      //! Constructor
+      //------------------------------------------------------------------------
+      ResponseHandlerHolder( ResponseHandler * handler ) : pHandler( handler ), pReferenceCounter( 1 ) {}
+      //------------------------------------------------------------------------
+      //! Destructor is private - use 'Destroy' in order to delete the object
+      //! Always destroys the actual ResponseHandler and deletes itself only
+      //! if this is the last reference
+      //------------------------------------------------------------------------
+      void Destroy()
+      {
+        XrdSysMutexHelper scopedLock( pMutex );
+        // delete the actual handler
+        if( pHandler )
+        {
+          delete pHandler;
+          pHandler = 0;
+        }
+        // and than destroy myself if this is the last reference
+        DestroyMyself( scopedLock );
+      }
+      //------------------------------------------------------------------------
+      //! Increment reference counter
+      //------------------------------------------------------------------------
+      ResponseHandlerHolder* Self()
+      {
+        XrdSysMutexHelper scopedLock( pMutex );
+        ++pReferenceCounter;
+        return this;
+      }
+      //------------------------------------------------------------------------
+      // Handle the response
+      //------------------------------------------------------------------------
+      virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
+                                            XrdCl::AnyObject    *response,
+                                            XrdCl::HostList     *hostList )
+      {
+        XrdSysMutexHelper scopedLock( pMutex );
+        // delegate the job to the actual handler
+        if( pHandler )
+        {
+          pHandler->HandleResponseWithHosts( status, response, hostList );
+          // after handling a response the handler destroys itself,
+          // so we need to nullify the pointer
+          pHandler = 0;
+        }
+        else
+        {
+          delete status;
+          delete response;
+          delete hostList;
+        }
+        // destroy the object if it is
+        DestroyMyself( scopedLock );
+      }
+
+    private:
+      //------------------------------------------------------------------------
+      //! Deletes itself only if this is the last reference
+      //------------------------------------------------------------------------
+      void DestroyMyself( XrdSysMutexHelper &lck )
+      {
+        // decrement the reference counter
+        --pReferenceCounter;
+        // if the object is not used anymore delete it
+        if( pReferenceCounter == 0)
+        {
+          lck.UnLock();
+          delete this;
+        }
+      }
+      //------------------------------------------------------------------------
+      //! Private Destructor (use 'Destroy' method)
+      //------------------------------------------------------------------------
+      ~ResponseHandlerHolder() {}
+      //------------------------------------------------------------------------
+      // The actual handler
+      //------------------------------------------------------------------------
+      ResponseHandler* pHandler;
+      //------------------------------------------------------------------------
+      // Reference counter
+      //------------------------------------------------------------------------
+      size_t pReferenceCounter;
+      //------------------------------------------------------------------------
+      // and respective mutex
+      //------------------------------------------------------------------------
+      mutable XrdSysRecMutex pMutex;
+  };
+
+  //----------------------------------------------------------------------------
+  // Constructor
+  //----------------------------------------------------------------------------
+  FileStateHandler::FileStateHandler():
+    pFileState( Closed ),
+    pStatInfo( 0 ),
+    pFileUrl( 0 ),
+    pDataServer( 0 ),
+    pLoadBalancer( 0 ),
+    pStateRedirect( 0 ),
+    pFileHandle( 0 ),
+    pOpenMode( 0 ),
+    pOpenFlags( 0 ),
+    pSessionId( 0 ),
+    pDoRecoverRead( true ),
+    pDoRecoverWrite( true ),
+    pFollowRedirects( true ),
+    pUseVirtRedirector( true ),
+    pReadStripeSize( DefaultReadStripeSize ),
+    pReadStripes( DefaultSubStreamsPerChannel ),
+    pReadBatchSize( DefaultReadBatchSize ),
+    pReadBatchWindow( DefaultReadBatchWindow ),
+    pReadBatch( 0 ),
+    pReadBatchGen( 0 ),
+    pReadsInFlight( 0 ),
+    pWriteBehindSize( DefaultWriteBehindSize ),
+    pWriteBehindWindow( DefaultWriteBehindWindow ),
+    pWriteBehindInFlight( DefaultWriteBehindInFlight ),
+    pWriteBatch( 0 ),
+    pWriteBatchGen( 0 ),
+    pWritesInFlight( 0 ),
+    pTraceCtx( 0 ),
+    pReOpenHandler( 0 ),
+    pOpenCached( false ),
+    pOpenRetry( 0 ),
+    pOpenTimeout( 0 )
+  {
+    pFileHandle = new uint8_t[4];
+    Env *env = DefaultEnv::GetEnv();
+    int stripeSize = DefaultReadStripeSize;
+    env->GetInt( "ReadStripeSize", stripeSize );
+    env->GetInt( "SubStreamsPerChannel", pReadStripes );
+    if( stripeSize > 0 ) pReadStripeSize = stripeSize;
+    int batchSize = DefaultReadBatchSize;
+    env->GetInt( "ReadBatchSize", batchSize );
+    env->GetInt( "ReadBatchWindow", pReadBatchWindow );
+    if( batchSize > 0 ) pReadBatchSize = batchSize;
+    if( pReadBatchWindow < 1 ) pReadBatchWindow = 1;
+    int wbSize = DefaultWriteBehindSize;
+    env->GetInt( "WriteBehindSize",     wbSize );
+    env->GetInt( "WriteBehindWindow",   pWriteBehindWindow );
+    env->GetInt( "WriteBehindInFlight", pWriteBehindInFlight );
+    if( wbSize > 0 ) pWriteBehindSize = wbSize;
+    if( pWriteBehindWindow < 1 ) pWriteBehindWindow = 1;
+    if( pWriteBehindInFlight < 1 ) pWriteBehindInFlight = 1;
+    ResetMonitoringVars();
+    DefaultEnv::GetForkHandler()->RegisterFileObject( this );
+    DefaultEnv::GetFileTimer()->RegisterFileObject( this );
+    pLFileHandler = new LocalFileHandler();
+  }
+
+  //------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param useVirtRedirector if true Metalink files will be treated
+  //!                          as a VirtualRedirectors
+  //------------------------------------------------------------------------
+  FileStateHandler::FileStateHandler( bool useVirtRedirector ):
+    pFileState( Closed ),
     pStatInfo( 0 ),
     pFileUrl( 0 ),
     pDataServer( 0 ),
@@ -371,9 +1195,43 @@ namespace XrdCl
     pDoRecoverWrite( true ),
     pFollowRedirects( true ),
     pUseVirtRedirector( useVirtRedirector ),
-    pReOpenHandler( 0 )
+    pReadStripeSize( DefaultReadStripeSize ),
+    pReadStripes( DefaultSubStreamsPerChannel ),
+    pReadBatchSize( DefaultReadBatchSize ),
+    pReadBatchWindow( DefaultReadBatchWindow ),
+    pReadBatch( 0 ),
+    pReadBatchGen( 0 ),
+    pReadsInFlight( 0 ),
+    pWriteBehindSize( DefaultWriteBehindSize ),
+    pWriteBehindWindow( DefaultWriteBehindWindow ),
+    pWriteBehindInFlight( DefaultWriteBehindInFlight ),
+    pWriteBatch( 0 ),
+    pWriteBatchGen( 0 ),
+    pWritesInFlight( 0 ),
+    pTraceCtx( 0 ),
+    pReOpenHandler( 0 ),
+    pOpenCached( false ),
+    pOpenRetry( 0 ),
+    pOpenTimeout( 0 )
   {
     pFileHandle = new uint8_t[4];
+    Env *env = DefaultEnv::GetEnv();
+    int stripeSize = DefaultReadStripeSize;
+    env->GetInt( "ReadStripeSize", stripeSize );
+    env->GetInt( "SubStreamsPerChannel", pReadStripes );
+    if( stripeSize > 0 ) pReadStripeSize = stripeSize;
+    int batchSize = DefaultReadBatchSize;
+    env->GetInt( "ReadBatchSize", batchSize );
+    env->GetInt( "ReadBatchWindow", pReadBatchWindow );
+    if( batchSize > 0 ) pReadBatchSize = batchSize;
+    if( pReadBatchWindow < 1 ) pReadBatchWindow = 1;
+    int wbSize = DefaultWriteBehindSize;
+    env->GetInt( "WriteBehindSize",     wbSize );
+    env->GetInt( "WriteBehindWindow",   pWriteBehindWindow );
+    env->GetInt( "WriteBehindInFlight", pWriteBehindInFlight );
+    if( wbSize > 0 ) pWriteBehindSize = wbSize;
+    if( pWriteBehindWindow < 1 ) pWriteBehindWindow = 1;
+    if( pWriteBehindInFlight < 1 ) pWriteBehindInFlight = 1;
     ResetMonitoringVars();
     DefaultEnv::GetForkHandler()->RegisterFileObject( this );
     DefaultEnv::GetFileTimer()->RegisterFileObject( this );
@@ -381,266 +1239,784 @@ namespace XrdCl
   }
 
   //----------------------------------------------------------------------------
-  // Destructor
+  // Destructor
+  //----------------------------------------------------------------------------
+  FileStateHandler::~FileStateHandler()
+  {
+    if( pReadBatchGen || pWriteBatchGen )
+      BatchTimer::Instance()->Remove( this );
+    delete pReadBatch;
+    delete pWriteBatch;
+
+    if( pReOpenHandler )
+      pReOpenHandler->Destroy();
+
+    if( DefaultEnv::GetFileTimer() )
+      DefaultEnv::GetFileTimer()->UnRegisterFileObject( this );
+
+    if( DefaultEnv::GetForkHandler() )
+      DefaultEnv::GetForkHandler()->UnRegisterFileObject( this );
+
+    if( pFileState != Closed && DefaultEnv::GetLog() )
+    {
+      XRootDStatus st;
+      MonitorClose( &st );
+      ResetMonitoringVars();
+    }
+
+    // check if the logger is still there, this is only for root, as root might
+    // have unload us already so in this case we don't want to do anything
+    if( DefaultEnv::GetLog() && pUseVirtRedirector && pFileUrl && pFileUrl->IsMetalink() )
+    {
+      RedirectorRegistry& registry = RedirectorRegistry::Instance();
+      registry.Release( *pFileUrl );
+    }
+
+    delete pStatInfo;
+    delete pFileUrl;
+    delete pDataServer;
+    delete pLoadBalancer;
+    delete pOpenRetry;
+    delete [] pFileHandle;
+    delete pLFileHandler;
+    delete pTraceCtx;
+  }
+
+  //----------------------------------------------------------------------------
+  // Open the file pointed to by the given URL
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::Open( const std::string &url,
+                                       uint16_t           flags,
+                                       uint16_t           mode,
+                                       ResponseHandler   *handler,
+                                       uint16_t           timeout )
+  {
+    OpenHandler *openHandler = new OpenHandler( this, handler );
+    XRootDStatus st = DoOpen( url, flags, mode, openHandler, timeout, 0, false );
+    if( !st.IsOK() )
+      delete openHandler;
+    return st;
+  }
+
+  //----------------------------------------------------------------------------
+  // Open the file and read a chunk of it
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::OpenRead( const std::string &url,
+                                           uint16_t           flags,
+                                           uint64_t           offset,
+                                           uint32_t           size,
+                                           void              *buffer,
+                                           bool               closeAfter,
+                                           ResponseHandler   *handler,
+                                           uint16_t           timeout )
+  {
+    if( !buffer || !size )
+      return XRootDStatus( stError, errInvalidArgs );
+
+    ChunkInfo        chunk( offset, size, buffer );
+    OpenReadHandler *readHandler = new OpenReadHandler( this, handler, chunk,
+                                                        closeAfter, timeout );
+    OpenHandler     *openHandler = new OpenHandler( this, 0, readHandler );
+    XRootDStatus st = DoOpen( url, flags, 0, openHandler, timeout, &chunk,
+                              closeAfter );
+    if( !st.IsOK() )
+    {
+      delete openHandler;
+      delete readHandler;
+    }
+    return st;
+  }
+
+  //----------------------------------------------------------------------------
+  // Send the open request
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::DoOpen( const std::string &url,
+                                         uint16_t           flags,
+                                         uint16_t           mode,
+                                         ResponseHandler   *openHandler,
+                                         uint16_t           timeout,
+                                         const ChunkInfo   *rdChunk,
+                                         bool               rdClose )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+
+    //--------------------------------------------------------------------------
+    // Check if we can proceed
+    //--------------------------------------------------------------------------
+    if( pFileState == Error )
+      return pStatus;
+
+    if( pFileState == OpenInProgress )
+      return XRootDStatus( stError, errInProgress );
+
+    if( pFileState == CloseInProgress || pFileState == Opened ||
+        pFileState == Recovering )
+      return XRootDStatus( stError, errInvalidOp );
+
+    pFileState = OpenInProgress;
+
+    //--------------------------------------------------------------------------
+    // Check if the parameters are valid
+    //--------------------------------------------------------------------------
+    Log *log = DefaultEnv::GetLog();
+
+    if (pFileUrl)
+    {
+      if( pUseVirtRedirector && pFileUrl->IsMetalink() )
+      {
+        RedirectorRegistry& registry = RedirectorRegistry::Instance();
+        registry.Release( *pFileUrl );
+      }
+      delete pFileUrl;
+      pFileUrl = 0;
+    }
+
+    pFileUrl = new URL( url );
+    if( !pFileUrl->IsValid() )
+    {
+      log->Error( FileMsg, "[0x%x@%s] Trying to open invalid url: %s",
+                  this, pFileUrl->GetPath().c_str(), url.c_str() );
+      pStatus    = XRootDStatus( stError, errInvalidArgs );
+      pFileState = Error;
+      return pStatus;
+    }
+
+    //--------------------------------------------------------------------------
+    // Check if the recovery procedures should be enabled
+    //--------------------------------------------------------------------------
+    const URL::ParamsMap &urlParams = pFileUrl->GetParams();
+    URL::ParamsMap::const_iterator it;
+    it = urlParams.find( "xrdcl.recover-reads" );
+    if( (it != urlParams.end() && it->second == "false") ||
+        !pDoRecoverRead )
+    {
+      pDoRecoverRead = false;
+      log->Debug( FileMsg, "[0x%x@%s] Read recovery procedures are disabled",
+                  this, pFileUrl->GetURL().c_str() );
+    }
+
+    it = urlParams.find( "xrdcl.recover-writes" );
+    if( (it != urlParams.end() && it->second == "false") ||
+        !pDoRecoverWrite )
+    {
+      pDoRecoverWrite = false;
+      log->Debug( FileMsg, "[0x%x@%s] Write recovery procedures are disabled",
+                  this, pFileUrl->GetURL().c_str() );
+    }
+
+    //--------------------------------------------------------------------------
+    // Check if the file is traced, either as part of a trace that the caller
+    // passed in the URL or as one of the files we sample. A new trace is
+    // passed on to the servers in the open CGI.
+    //--------------------------------------------------------------------------
+    delete pTraceCtx;
+    pTraceCtx = 0;
+    gettimeofday( &pOpenStart, 0 );
+    it = urlParams.find( XrdOucTraceCtx::CgiKey );
+    if( it != urlParams.end() )
+    {
+      XrdOucTraceCtx ctx;
+      if( ctx.Parse( it->second.c_str() ) && ctx.isSampled() )
+        pTraceCtx = new XrdOucTraceCtx( ctx );
+    }
+    else if( !pFileUrl->IsLocalFile() && TraceSampled() )
+    {
+      char tp[XrdOucTraceCtx::CtxLen+1];
+      pTraceCtx = new XrdOucTraceCtx();
+      pTraceCtx->Start();
+      pTraceCtx->Format( tp, sizeof( tp ) );
+      URL::ParamsMap params = urlParams;
+      params[XrdOucTraceCtx::CgiKey] = tp;
+      pFileUrl->SetParams( params );
+      log->Debug( FileMsg, "[0x%x@%s] Tracing as %s", this,
+                  pFileUrl->GetURL().c_str(), tp );
+    }
+
+    //--------------------------------------------------------------------------
+    // Open the file
+    //--------------------------------------------------------------------------
+    log->Debug( FileMsg, "[0x%x@%s] Sending an open command", this,
+                pFileUrl->GetURL().c_str() );
+
+    pOpenMode  = mode;
+    pOpenFlags = flags;
+
+    Message           *msg;
+    ClientOpenRequest *req;
+    std::string        path = pFileUrl->GetPathWithFilteredParams();
+    MessageUtils::CreateRequest( msg, req, path.length() );
+
+    req->requestid = kXR_open;
+    req->mode      = mode;
+    req->options   = flags | kXR_async | kXR_retstat;
+    req->dlen      = path.length();
+    msg->Append( path.c_str(), path.length(), 24 );
+
+    //--------------------------------------------------------------------------
+    // Ask the server to read the data as well, it can only be asked to do so
+    // in the first 4GB of the file, beyond that we read it ourselves
+    //--------------------------------------------------------------------------
+    if( rdChunk && rdChunk->offset <= 0xffffffffULL )
+    {
+      req->optiont = kXR_ordata | ( rdClose ? kXR_orclose : 0 );
+      req->rdlen   = rdChunk->length;
+      req->rdoffs  = rdChunk->offset;
+    }
+
+    //--------------------------------------------------------------------------
+    // Skip the redirector if we know where it sent us last time, but keep a
+    // copy of the request to ask it if the data server does not cooperate
+    //--------------------------------------------------------------------------
+    URL target;
+    delete pOpenRetry;
+    pOpenRetry   = 0;
+    pOpenCached  = IsRedirectCacheable() &&
+                   RedirectCache::Get( *pFileUrl, target );
+    pOpenTimeout = timeout;
+    if( pOpenCached )
+    {
+      log->Debug( FileMsg, "[0x%x@%s] Sending the open to %s found in the "
+                  "redirect cache", this, pFileUrl->GetURL().c_str(),
+                  target.GetHostId().c_str() );
+      pOpenRetry = new Message( msg->GetSize() );
+      pOpenRetry->Append( msg->GetBuffer(), msg->GetSize(), 0 );
+    }
+
+    XRootDTransport::SetDescription( msg );
+    MessageSendParams params; params.timeout = timeout;
+    params.followRedirects = pFollowRedirects;
+    MessageUtils::ProcessSendParams( params );
+
+    Status st = IssueRequest( pOpenCached ? target : *pFileUrl, msg,
+                              openHandler, params );
+
+    if( !st.IsOK() )
+    {
+      pStatus    = st;
+      pFileState = Error;
+      return st;
+    }
+    return st;
+  }
+
+  //----------------------------------------------------------------------------
+  // Close the file object
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::Close( ResponseHandler *handler,
+                                        uint16_t         timeout )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+
+    //--------------------------------------------------------------------------
+    // Check if we can proceed
+    //--------------------------------------------------------------------------
+    if( pFileState == Error )
+      return pStatus;
+
+    if( pFileState == CloseInProgress )
+      return XRootDStatus( stError, errInProgress );
+
+    if( pReadBatch )
+      SendReadBatch();
+
+    if( DeferUntilWritten( true, handler, timeout ) )
+      return XRootDStatus();
+
+    if( pFileState == OpenInProgress || pFileState == Closed ||
+        pFileState == Recovering || !pInTheFly.empty() )
+      return XRootDStatus( stError, errInvalidOp );
+
+    //--------------------------------------------------------------------------
+    // A buffered write failed, the file is closed all the same but the user
+    // learns about it
+    //--------------------------------------------------------------------------
+    if( !pWriteError.IsOK() )
+    {
+      handler     = new WriteErrorHandler( handler, pWriteError );
+      pWriteError = XRootDStatus();
+    }
+
+    pFileState = CloseInProgress;
+
+    Log *log = DefaultEnv::GetLog();
+    log->Debug( FileMsg, "[0x%x@%s] Sending a close command for handle 0x%x to "
+                "%s", this, pFileUrl->GetURL().c_str(),
+                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
+
+    //--------------------------------------------------------------------------
+    // Close the file
+    //--------------------------------------------------------------------------
+    Message            *msg;
+    ClientCloseRequest *req;
+    MessageUtils::CreateRequest( msg, req );
+
+    req->requestid = kXR_close;
+    memcpy( req->fhandle, pFileHandle, 4 );
+
+    XRootDTransport::SetDescription( msg );
+    msg->SetSessionId( pSessionId );
+    CloseHandler *closeHandler = new CloseHandler( this, handler, msg );
+    MessageSendParams params;
+    params.timeout = timeout;
+    params.followRedirects = false;
+    params.stateful        = true;
+    MessageUtils::ProcessSendParams( params );
+
+    Status st = IssueRequest( *pDataServer, msg, closeHandler, params );
+
+    if( !st.IsOK() )
+    {
+      delete closeHandler;
+      if( st.code == errInvalidSession && IsReadOnly() )
+      {
+        pFileState = Closed;
+        return st;
+      }
+
+      pStatus    = st;
+      pFileState = Error;
+      return st;
+    }
+    return st;
+  }
+
+  //----------------------------------------------------------------------------
+  // Stat the file
   //----------------------------------------------------------------------------
-  FileStateHandler::~FileStateHandler()
+  XRootDStatus FileStateHandler::Stat( bool             force,
+                                       ResponseHandler *handler,
+                                       uint16_t         timeout )
   {
-    if( pReOpenHandler )
-      pReOpenHandler->Destroy();
-
-    if( DefaultEnv::GetFileTimer() )
-      DefaultEnv::GetFileTimer()->UnRegisterFileObject( this );
+    XrdSysMutexHelper scopedLock( pMutex );
 
-    if( DefaultEnv::GetForkHandler() )
-      DefaultEnv::GetForkHandler()->UnRegisterFileObject( this );
+    if( pFileState != Opened && pFileState != Recovering )
+      return XRootDStatus( stError, errInvalidOp );
 
-    if( pFileState != Closed && DefaultEnv::GetLog() )
+    //--------------------------------------------------------------------------
+    // Return the cached info, if the open response had none ask the server
+    //--------------------------------------------------------------------------
+    if( !force && pStatInfo )
     {
-      XRootDStatus st;
-      MonitorClose( &st );
-      ResetMonitoringVars();
+      AnyObject *obj = new AnyObject();
+      obj->Set( new StatInfo( *pStatInfo ) );
+      handler->HandleResponseWithHosts( new XRootDStatus(), obj,
+                                        new HostList() );
+      return XRootDStatus();
     }
 
-    // check if the logger is still there, this is only for root, as root might
-    // have unload us already so in this case we don't want to do anything
-    if( DefaultEnv::GetLog() && pUseVirtRedirector && pFileUrl && pFileUrl->IsMetalink() )
-    {
-      RedirectorRegistry& registry = RedirectorRegistry::Instance();
-      registry.Release( *pFileUrl );
-    }
+    if( pWriteBatch )
+      SendWriteBatch();
 
-    delete pStatInfo;
-    delete pFileUrl;
-    delete pDataServer;
-    delete pLoadBalancer;
-    delete [] pFileHandle;
-    delete pLFileHandler;
+    Log *log = DefaultEnv::GetLog();
+    log->Debug( FileMsg, "[0x%x@%s] Sending a stat command for handle 0x%x to "
+                "%s", this, pFileUrl->GetURL().c_str(),
+                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
+
+    //--------------------------------------------------------------------------
+    // Issue a new stat request
+    // stating a file handle doesn't work (fixed in 3.2.0) so we need to
+    // stat the pat
+    //--------------------------------------------------------------------------
+    Message           *msg;
+    ClientStatRequest *req;
+    std::string        path = pFileUrl->GetPath();
+    MessageUtils::CreateRequest( msg, req );
+
+    req->requestid = kXR_stat;
+    memcpy( req->fhandle, pFileHandle, 4 );
+
+    MessageSendParams params;
+    params.timeout         = timeout;
+    params.followRedirects = false;
+    params.stateful        = true;
+    MessageUtils::ProcessSendParams( params );
+
+    XRootDTransport::SetDescription( msg );
+    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
+
+    return SendOrQueue( *pDataServer, msg, stHandler, params );
   }
 
   //----------------------------------------------------------------------------
-  // Open the file pointed to by the given URL
+  // Read a data chunk at a given offset - sync
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Open( const std::string &url,
-                                       uint16_t           flags,
-                                       uint16_t           mode,
-                                       ResponseHandler   *handler,
-                                       uint16_t           timeout )
+  XRootDStatus FileStateHandler::Read( uint64_t         offset,
+                                       uint32_t         size,
+                                       void            *buffer,
+                                       ResponseHandler *handler,
+                                       uint16_t         timeout )
   {
     XrdSysMutexHelper scopedLock( pMutex );
 
+    if( pFileState != Opened && pFileState != Recovering )
+      return XRootDStatus( stError, errInvalidOp );
+
+    if( pWriteBatch )
+      SendWriteBatch();
+
+    if( IsLocalAccess() )
+    {
+      ++pRCount;
+      pRBytes += size;
+      return pLFileHandler->Read( offset, size, buffer, handler, timeout );
+    }
+
     //--------------------------------------------------------------------------
-    // Check if we can proceed
+    // Batch small reads as long as they cannot fail because of the end of
+    // file, a short element would fail the whole kXR_readv
     //--------------------------------------------------------------------------
-    if( pFileState == Error )
-      return pStatus;
+    if( pReadBatchSize && size && size <= pReadBatchSize &&
+        pFileState == Opened && !pDataServer->IsLocalFile() &&
+        pStatInfo && offset + size <= pStatInfo->GetSize() )
+      return BatchedRead( offset, size, buffer, handler, timeout );
 
-    if( pFileState == OpenInProgress )
-      return XRootDStatus( stError, errInProgress );
+    int      stripes;
+    uint32_t stripeSize;
+    if( GetReadStripes( size, stripes, stripeSize ) )
+      return StripedRead( offset, size, buffer, handler, timeout,
+                          stripes, stripeSize );
 
-    if( pFileState == CloseInProgress || pFileState == Opened ||
-        pFileState == Recovering )
+    return SendRead( offset, size, buffer, handler, timeout );
+  }
+
+  //----------------------------------------------------------------------------
+  // Read a data chunk with page checksums at a given offset - async
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::PgRead( uint64_t         offset,
+                                         uint32_t         size,
+                                         void            *buffer,
+                                         ResponseHandler *handler,
+                                         uint16_t         timeout )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+
+    if( pFileState != Opened && pFileState != Recovering )
       return XRootDStatus( stError, errInvalidOp );
 
-    pFileState = OpenInProgress;
+    if( pWriteBatch )
+      SendWriteBatch();
 
-    //--------------------------------------------------------------------------
-    // Check if the parameters are valid
-    //--------------------------------------------------------------------------
-    Log *log = DefaultEnv::GetLog();
+    if( !buffer )
+      return XRootDStatus( stError, errInvalidArgs );
 
-    if (pFileUrl)
+    if( IsLocalAccess() )
     {
-      if( pUseVirtRedirector && pFileUrl->IsMetalink() )
-      {
-        RedirectorRegistry& registry = RedirectorRegistry::Instance();
-        registry.Release( *pFileUrl );
-      }
-      delete pFileUrl;
-      pFileUrl = 0;
+      ++pRCount;
+      pRBytes += size;
+      return pLFileHandler->PgRead( offset, size, buffer, handler, timeout );
     }
 
-    pFileUrl = new URL( url );
-    if( !pFileUrl->IsValid() )
-    {
-      log->Error( FileMsg, "[0x%x@%s] Trying to open invalid url: %s",
-                  this, pFileUrl->GetPath().c_str(), url.c_str() );
-      pStatus    = XRootDStatus( stError, errInvalidArgs );
-      pFileState = Error;
-      return pStatus;
-    }
+    Log *log = DefaultEnv::GetLog();
+    log->Debug( FileMsg, "[0x%x@%s] Sending a pgread command for handle 0x%x "
+                "to %s", this, pFileUrl->GetURL().c_str(),
+                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
 
-    //--------------------------------------------------------------------------
-    // Check if the recovery procedures should be enabled
-    //--------------------------------------------------------------------------
-    const URL::ParamsMap &urlParams = pFileUrl->GetParams();
-    URL::ParamsMap::const_iterator it;
-    it = urlParams.find( "xrdcl.recover-reads" );
-    if( (it != urlParams.end() && it->second == "false") ||
-        !pDoRecoverRead )
-    {
-      pDoRecoverRead = false;
-      log->Debug( FileMsg, "[0x%x@%s] Read recovery procedures are disabled",
-                  this, pFileUrl->GetURL().c_str() );
-    }
+    Message             *msg;
+    ClientPgReadRequest *req;
+    MessageUtils::CreateRequest( msg, req );
 
-    it = urlParams.find( "xrdcl.recover-writes" );
-    if( (it != urlParams.end() && it->second == "false") ||
-        !pDoRecoverWrite )
+    req->requestid  = kXR_pgread;
+    req->offset     = offset;
+    req->rlen       = size;
+    memcpy( req->fhandle, pFileHandle, 4 );
+
+    ChunkList *list   = new ChunkList();
+    list->push_back( ChunkInfo( offset, size, buffer ) );
+
+    XRootDTransport::SetDescription( msg );
+    MessageSendParams params;
+    params.timeout         = timeout;
+    params.followRedirects = false;
+    params.stateful        = true;
+    params.chunkList       = list;
+    MessageUtils::ProcessSendParams( params );
+    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
+
+    return SendOrQueue( *pDataServer, msg, stHandler, params );
+  }
+
+  //----------------------------------------------------------------------------
+  // Write a data chunk at a given offset - async
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::Write( uint64_t         offset,
+                                        uint32_t         size,
+                                        const void      *buffer,
+                                        ResponseHandler *handler,
+                                        uint16_t         timeout )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+
+    if( pFileState != Opened && pFileState != Recovering )
+      return XRootDStatus( stError, errInvalidOp );
+
+    if( IsLocalAccess() )
     {
-      pDoRecoverWrite = false;
-      log->Debug( FileMsg, "[0x%x@%s] Write recovery procedures are disabled",
-                  this, pFileUrl->GetURL().c_str() );
+      ++pWCount;
+      pWBytes += size;
+      return pLFileHandler->Write( offset, size, buffer, handler, timeout );
     }
 
     //--------------------------------------------------------------------------
-    // Open the file
+    // Small writes are copied and sent together later, anything else has to
+    // go after what has been buffered so far
     //--------------------------------------------------------------------------
-    log->Debug( FileMsg, "[0x%x@%s] Sending an open command", this,
-                pFileUrl->GetURL().c_str() );
+    if( pWriteBehindSize && size && size < pWriteBehindSize &&
+        pFileState == Opened )
+      return BufferedWrite( offset, size, buffer, handler, timeout );
 
-    pOpenMode  = mode;
-    pOpenFlags = flags;
-    OpenHandler *openHandler = new OpenHandler( this, handler );
+    if( pWriteBatch )
+      SendWriteBatch();
 
-    Message           *msg;
-    ClientOpenRequest *req;
-    std::string        path = pFileUrl->GetPathWithFilteredParams();
-    MessageUtils::CreateRequest( msg, req, path.length() );
+    return SendWrite( offset, size, buffer, handler, timeout );
+  }
 
-    req->requestid = kXR_open;
-    req->mode      = mode;
-    req->options   = flags | kXR_async | kXR_retstat;
-    req->dlen      = path.length();
-    msg->Append( path.c_str(), path.length(), 24 );
+  //----------------------------------------------------------------------------
+  // Build and send a kXR_write
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::SendWrite( uint64_t         offset,
+                                            uint32_t         size,
+                                            const void      *buffer,
+                                            ResponseHandler *handler,
+                                            uint16_t         timeout )
+  {
+    Log *log = DefaultEnv::GetLog();
+    log->Debug( FileMsg, "[0x%x@%s] Sending a write command for handle 0x%x to "
+                "%s", this, pFileUrl->GetURL().c_str(),
+                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
+
+    Message            *msg;
+    ClientWriteRequest *req;
+    MessageUtils::CreateRequest( msg, req );
+
+    req->requestid  = kXR_write;
+    req->offset     = offset;
+    req->dlen       = size;
+    memcpy( req->fhandle, pFileHandle, 4 );
+
+    ChunkList *list   = new ChunkList();
+    list->push_back( ChunkInfo( 0, size, (char*)buffer ) );
+
+    MessageSendParams params;
+    params.timeout         = timeout;
+    params.followRedirects = false;
+    params.stateful        = true;
+    params.chunkList       = list;
 
-    XRootDTransport::SetDescription( msg );
-    MessageSendParams params; params.timeout = timeout;
-    params.followRedirects = pFollowRedirects;
     MessageUtils::ProcessSendParams( params );
 
-    Status st = IssueRequest( *pFileUrl, msg, openHandler, params );
+    XRootDTransport::SetDescription( msg );
+    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
+
+    return SendOrQueue( *pDataServer, msg, stHandler, params );
+  }
+
+  //----------------------------------------------------------------------------
+  // Commit all pending disk writes - async
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::Sync( ResponseHandler *handler,
+                                       uint16_t         timeout )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+
+    if( pFileState != Opened && pFileState != Recovering )
+      return XRootDStatus( stError, errInvalidOp );
+
+    if( DeferUntilWritten( false, handler, timeout ) )
+      return XRootDStatus();
 
-    if( !st.IsOK() )
+    if( !pWriteError.IsOK() )
     {
-      delete openHandler;
-      pStatus    = st;
-      pFileState = Error;
+      XRootDStatus st = pWriteError;
+      pWriteError = XRootDStatus();
       return st;
     }
-    return st;
+
+    Log *log = DefaultEnv::GetLog();
+    log->Debug( FileMsg, "[0x%x@%s] Sending a sync command for handle 0x%x to "
+                "%s", this, pFileUrl->GetURL().c_str(),
+                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
+
+    Message           *msg;
+    ClientSyncRequest *req;
+    MessageUtils::CreateRequest( msg, req );
+
+    req->requestid = kXR_sync;
+    memcpy( req->fhandle, pFileHandle, 4 );
+
+    MessageSendParams params;
+    params.timeout         = timeout;
+    params.followRedirects = false;
+    params.stateful        = true;
+    MessageUtils::ProcessSendParams( params );
+
+    XRootDTransport::SetDescription( msg );
+    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
+
+    return SendOrQueue( *pDataServer, msg, stHandler, params );
   }
 
   //----------------------------------------------------------------------------
-  // Close the file object
+  // Truncate the file to a particular size - async
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Close( ResponseHandler *handler,
-                                        uint16_t         timeout )
+  XRootDStatus FileStateHandler::Truncate( uint64_t         size,
+                                           ResponseHandler *handler,
+                                           uint16_t         timeout )
   {
     XrdSysMutexHelper scopedLock( pMutex );
 
-    //--------------------------------------------------------------------------
-    // Check if we can proceed
-    //--------------------------------------------------------------------------
-    if( pFileState == Error )
-      return pStatus;
-
-    if( pFileState == CloseInProgress )
-      return XRootDStatus( stError, errInProgress );
-
-    if( pFileState == OpenInProgress || pFileState == Closed ||
-        pFileState == Recovering || !pInTheFly.empty() )
+    if( pFileState != Opened && pFileState != Recovering )
       return XRootDStatus( stError, errInvalidOp );
 
-    pFileState = CloseInProgress;
+    if( pWriteBatch )
+      SendWriteBatch();
 
     Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a close command for handle 0x%x to "
+    log->Debug( FileMsg, "[0x%x@%s] Sending a truncate command for handle 0x%x to "
                 "%s", this, pFileUrl->GetURL().c_str(),
                 *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
 
-    //--------------------------------------------------------------------------
-    // Close the file
-    //--------------------------------------------------------------------------
-    Message            *msg;
-    ClientCloseRequest *req;
+    Message               *msg;
+    ClientTruncateRequest *req;
     MessageUtils::CreateRequest( msg, req );
 
-    req->requestid = kXR_close;
+    req->requestid = kXR_truncate;
     memcpy( req->fhandle, pFileHandle, 4 );
+    req->offset = size;
 
-    XRootDTransport::SetDescription( msg );
-    msg->SetSessionId( pSessionId );
-    CloseHandler *closeHandler = new CloseHandler( this, handler, msg );
     MessageSendParams params;
-    params.timeout = timeout;
+    params.timeout         = timeout;
     params.followRedirects = false;
     params.stateful        = true;
     MessageUtils::ProcessSendParams( params );
 
-    Status st = IssueRequest( *pDataServer, msg, closeHandler, params );
-
-    if( !st.IsOK() )
-    {
-      delete closeHandler;
-      if( st.code == errInvalidSession && IsReadOnly() )
-      {
-        pFileState = Closed;
-        return st;
-      }
+    XRootDTransport::SetDescription( msg );
+    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
 
-      pStatus    = st;
-      pFileState = Error;
-      return st;
-    }
-    return st;
+    return SendOrQueue( *pDataServer, msg, stHandler, params );
   }
 
   //----------------------------------------------------------------------------
-  // Stat the file
+  // Read scattered data chunks in one operation - async
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Stat( bool             force,
-                                       ResponseHandler *handler,
-                                       uint16_t         timeout )
+  XRootDStatus FileStateHandler::VectorRead( const ChunkList &chunks,
+                                             void            *buffer,
+                                             ResponseHandler *handler,
+                                             uint16_t         timeout )
   {
+    //--------------------------------------------------------------------------
+    // Sanity check
+    //--------------------------------------------------------------------------
     XrdSysMutexHelper scopedLock( pMutex );
 
     if( pFileState != Opened && pFileState != Recovering )
       return XRootDStatus( stError, errInvalidOp );
 
-    //--------------------------------------------------------------------------
-    // Return the cached info
-    //--------------------------------------------------------------------------
-    if( !force )
+    if( pWriteBatch )
+      SendWriteBatch();
+
+    if( IsLocalAccess() )
     {
-      AnyObject *obj = new AnyObject();
-      obj->Set( new StatInfo( *pStatInfo ) );
-      handler->HandleResponseWithHosts( new XRootDStatus(), obj,
-                                        new HostList() );
-      return XRootDStatus();
+      ++pVRCount;
+      for( size_t i = 0; i < chunks.size(); ++i )
+        pVRBytes += chunks[i].length;
+      pVSegs += chunks.size();
+      return pLFileHandler->VectorRead( chunks, buffer, handler, timeout );
+    }
+
+    if( chunks.size() > 1 )
+    {
+      uint64_t total = 0;
+      for( size_t i = 0; i < chunks.size(); ++i )
+        total += chunks[i].length;
+      int      stripes;
+      uint32_t stripeSize;
+      if( GetReadStripes( total, stripes, stripeSize ) )
+        return StripedVectorRead( chunks, buffer, handler, timeout,
+                                  stripes, stripeSize );
     }
 
+    return SendVectorRead( chunks, buffer, handler, timeout );
+  }
+
+  //------------------------------------------------------------------------
+  // Write scattered data chunks in one operation - async
+  //------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::VectorWrite( const ChunkList &chunks,
+                                              ResponseHandler *handler,
+                                              uint16_t         timeout )
+  {
+    //--------------------------------------------------------------------------
+    // Sanity check
+    //--------------------------------------------------------------------------
+    XrdSysMutexHelper scopedLock( pMutex );
+
+    if( pFileState != Opened && pFileState != Recovering )
+      return XRootDStatus( stError, errInvalidOp );
+
+    if( pWriteBatch )
+      SendWriteBatch();
+
+    return SendVectorWrite( chunks, handler, timeout );
+  }
+
+  //----------------------------------------------------------------------------
+  // Build and send a kXR_writev
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::SendVectorWrite( const ChunkList &chunks,
+                                                  ResponseHandler *handler,
+                                                  uint16_t         timeout )
+  {
     Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a stat command for handle 0x%x to "
-                "%s", this, pFileUrl->GetURL().c_str(),
+    log->Debug( FileMsg, "[0x%x@%s] Sending a vector write command for handle "
+                "0x%x to %s", this, pFileUrl->GetURL().c_str(),
                 *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
 
     //--------------------------------------------------------------------------
-    // Issue a new stat request
-    // stating a file handle doesn't work (fixed in 3.2.0) so we need to
-    // stat the pat
+    // Determine the size of the payload
     //--------------------------------------------------------------------------
-    Message           *msg;
-    ClientStatRequest *req;
-    std::string        path = pFileUrl->GetPath();
-    MessageUtils::CreateRequest( msg, req );
 
-    req->requestid = kXR_stat;
-    memcpy( req->fhandle, pFileHandle, 4 );
+    // the size of write vector
+    uint32_t payloadSize = sizeof(XrdProto::write_list) * chunks.size();
+
+    //--------------------------------------------------------------------------
+    // Build the message
+    //--------------------------------------------------------------------------
+    Message             *msg;
+    ClientWriteVRequest *req;
+    MessageUtils::CreateRequest( msg, req, payloadSize );
+
+    req->requestid = kXR_writev;
+    req->dlen      = sizeof(XrdProto::write_list) * chunks.size();
+
+    ChunkList *list   = new ChunkList();
+
+    //--------------------------------------------------------------------------
+    // Copy the chunk info
+    //--------------------------------------------------------------------------
+    XrdProto::write_list *writeList =
+        reinterpret_cast<XrdProto::write_list*>( msg->GetBuffer( 24 ) );
+
+
+
+    for( size_t i = 0; i < chunks.size(); ++i )
+    {
+      writeList[i].wlen   = chunks[i].length;
+      writeList[i].offset = chunks[i].offset;
+      memcpy( writeList[i].fhandle, pFileHandle, 4 );
+
+      list->push_back( ChunkInfo( chunks[i].offset,
+                                  chunks[i].length,
+                                  chunks[i].buffer ) );
+    }
 
+    //--------------------------------------------------------------------------
+    // Send the message
+    //--------------------------------------------------------------------------
     MessageSendParams params;
     params.timeout         = timeout;
     params.followRedirects = false;
     params.stateful        = true;
+    params.chunkList       = list;
     MessageUtils::ProcessSendParams( params );
 
     XRootDTransport::SetDescription( msg );
@@ -649,55 +2025,68 @@ namespace XrdCl
     return SendOrQueue( *pDataServer, msg, stHandler, params );
   }
 
-  //----------------------------------------------------------------------------
-  // Read a data chunk at a given offset - sync
-  //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Read( uint64_t         offset,
-                                       uint32_t         size,
-                                       void            *buffer,
-                                       ResponseHandler *handler,
-                                       uint16_t         timeout )
+  //------------------------------------------------------------------------
+  // Write scattered buffers in one operation - async
+  //------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::WriteV( uint64_t            offset,
+                                         const struct iovec *iov,
+                                         int                 iovcnt,
+                                         ResponseHandler    *handler,
+                                         uint16_t            timeout )
   {
     XrdSysMutexHelper scopedLock( pMutex );
 
     if( pFileState != Opened && pFileState != Recovering )
       return XRootDStatus( stError, errInvalidOp );
 
+    if( pWriteBatch )
+      SendWriteBatch();
+
     Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a read command for handle 0x%x to "
+    log->Debug( FileMsg, "[0x%x@%s] Sending a write command for handle 0x%x to "
                 "%s", this, pFileUrl->GetURL().c_str(),
                 *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
 
-    Message           *msg;
-    ClientReadRequest *req;
+    Message            *msg;
+    ClientWriteRequest *req;
     MessageUtils::CreateRequest( msg, req );
 
-    req->requestid  = kXR_read;
+    ChunkList *list   = new ChunkList();
+
+    uint32_t size = 0;
+    for( int i = 0; i < iovcnt; ++i )
+    {
+      size += iov[i].iov_len;
+      list->push_back( ChunkInfo( 0, iov[i].iov_len,
+                       (char*)iov[i].iov_base ) );
+    }
+
+    req->requestid  = kXR_write;
     req->offset     = offset;
-    req->rlen       = size;
+    req->dlen       = size;
     memcpy( req->fhandle, pFileHandle, 4 );
 
-    ChunkList *list   = new ChunkList();
-    list->push_back( ChunkInfo( offset, size, buffer ) );
 
-    XRootDTransport::SetDescription( msg );
+
     MessageSendParams params;
     params.timeout         = timeout;
     params.followRedirects = false;
     params.stateful        = true;
     params.chunkList       = list;
+
     MessageUtils::ProcessSendParams( params );
+
+    XRootDTransport::SetDescription( msg );
     StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
 
     return SendOrQueue( *pDataServer, msg, stHandler, params );
   }
 
   //----------------------------------------------------------------------------
-  // Write a data chunk at a given offset - async
+  // Performs a custom operation on an open file, server implementation
+  // dependent - async
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Write( uint64_t         offset,
-                                        uint32_t         size,
-                                        const void      *buffer,
+  XRootDStatus FileStateHandler::Fcntl( const Buffer    &arg,
                                         ResponseHandler *handler,
                                         uint16_t         timeout )
   {
@@ -706,29 +2095,28 @@ namespace XrdCl
     if( pFileState != Opened && pFileState != Recovering )
       return XRootDStatus( stError, errInvalidOp );
 
+    if( pWriteBatch )
+      SendWriteBatch();
+
     Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a write command for handle 0x%x to "
+    log->Debug( FileMsg, "[0x%x@%s] Sending a fcntl command for handle 0x%x to "
                 "%s", this, pFileUrl->GetURL().c_str(),
                 *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
 
     Message            *msg;
-    ClientWriteRequest *req;
-    MessageUtils::CreateRequest( msg, req );
+    ClientQueryRequest *req;
+    MessageUtils::CreateRequest( msg, req, arg.GetSize() );
 
-    req->requestid  = kXR_write;
-    req->offset     = offset;
-    req->dlen       = size;
+    req->requestid = kXR_query;
+    req->infotype  = kXR_Qopaqug;
+    req->dlen      = arg.GetSize();
     memcpy( req->fhandle, pFileHandle, 4 );
-
-    ChunkList *list   = new ChunkList();
-    list->push_back( ChunkInfo( 0, size, (char*)buffer ) );
+    msg->Append( arg.GetBuffer(), arg.GetSize(), 24 );
 
     MessageSendParams params;
     params.timeout         = timeout;
     params.followRedirects = false;
     params.stateful        = true;
-    params.chunkList       = list;
-
     MessageUtils::ProcessSendParams( params );
 
     XRootDTransport::SetDescription( msg );
@@ -738,9 +2126,9 @@ namespace XrdCl
   }
 
   //----------------------------------------------------------------------------
-  // Commit all pending disk writes - async
+  // Get access token to a file - async
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Sync( ResponseHandler *handler,
+  XRootDStatus FileStateHandler::Visa( ResponseHandler *handler,
                                        uint16_t         timeout )
   {
     XrdSysMutexHelper scopedLock( pMutex );
@@ -749,15 +2137,16 @@ namespace XrdCl
       return XRootDStatus( stError, errInvalidOp );
 
     Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a sync command for handle 0x%x to "
+    log->Debug( FileMsg, "[0x%x@%s] Sending a visa command for handle 0x%x to "
                 "%s", this, pFileUrl->GetURL().c_str(),
                 *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
 
-    Message           *msg;
-    ClientSyncRequest *req;
+    Message            *msg;
+    ClientQueryRequest *req;
     MessageUtils::CreateRequest( msg, req );
 
-    req->requestid = kXR_sync;
+    req->requestid = kXR_query;
+    req->infotype  = kXR_Qvisa;
     memcpy( req->fhandle, pFileHandle, 4 );
 
     MessageSendParams params;
@@ -773,58 +2162,191 @@ namespace XrdCl
   }
 
   //----------------------------------------------------------------------------
-  // Truncate the file to a particular size - async
+  // Check if the file is open
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Truncate( uint64_t         size,
-                                           ResponseHandler *handler,
-                                           uint16_t         timeout )
+  bool FileStateHandler::IsOpen() const
   {
     XrdSysMutexHelper scopedLock( pMutex );
 
-    if( pFileState != Opened && pFileState != Recovering )
-      return XRootDStatus( stError, errInvalidOp );
+    if( pFileState == Opened || pFileState == Recovering )
+      return true;
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  // Set file property
+  //----------------------------------------------------------------------------
+  bool FileStateHandler::SetProperty( const std::string &name,
+                                      const std::string &value )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+    if( name == "ReadRecovery" )
+    {
+      if( value == "true" ) pDoRecoverRead = true;
+      else pDoRecoverRead = false;
+      return true;
+    }
+    else if( name == "WriteRecovery" )
+    {
+      if( value == "true" ) pDoRecoverWrite = true;
+      else pDoRecoverWrite = false;
+      return true;
+    }
+    else if( name == "FollowRedirects" )
+    {
+      if( value == "true" ) pFollowRedirects = true;
+      else pFollowRedirects = false;
+      return true;
+    }
+    else if( name == "ReadStripeSize" )
+    {
+      char *end;
+      long  stripeSize = strtol( value.c_str(), &end, 10 );
+      if( *end || stripeSize < 0 || stripeSize > 0x7fffffff ) return false;
+      pReadStripeSize = stripeSize;
+      return true;
+    }
+    else if( name == "ReadBatchSize" )
+    {
+      char *end;
+      long  batchSize = strtol( value.c_str(), &end, 10 );
+      if( *end || batchSize < 0 || batchSize > 0x7fffffff ) return false;
+      pReadBatchSize = batchSize;
+      if( !pReadBatchSize && pReadBatch )
+        SendReadBatch();
+      return true;
+    }
+    else if( name == "WriteBehindSize" )
+    {
+      char *end;
+      long  wbSize = strtol( value.c_str(), &end, 10 );
+      if( *end || wbSize < 0 || wbSize > 0x7fffffff ) return false;
+      pWriteBehindSize = wbSize;
+      if( pWriteBatch && pWriteBatch->data.size() >= pWriteBehindSize )
+        SendWriteBatch();
+      return true;
+    }
+    else if( name == "LocalIO" )
+    {
+      if( value == "buffered" )
+        pLFileHandler->SetIOMode( LocalFileHandler::Buffered );
+      else if( value == "stream" )
+        pLFileHandler->SetIOMode( LocalFileHandler::Stream );
+      else if( value == "direct" )
+        pLFileHandler->SetIOMode( LocalFileHandler::Direct );
+      else return false;
+      return true;
+    }
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  // Get file property
+  //----------------------------------------------------------------------------
+  bool FileStateHandler::GetProperty( const std::string &name,
+                                      std::string &value ) const
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+    if( name == "ReadRecovery" )
+    {
+      if( pDoRecoverRead ) value = "true";
+      else value = "false";
+      return true;
+    }
+    else if( name == "WriteRecovery" )
+    {
+      if( pDoRecoverWrite ) value = "true";
+      else value = "false";
+      return true;
+    }
+    else if( name == "FollowRedirects" )
+    {
+      if( pFollowRedirects ) value = "true";
+      else value = "false";
+      return true;
+    }
+    else if( name == "ReadStripeSize" )
+    {
+      std::ostringstream o; o << pReadStripeSize;
+      value = o.str();
+      return true;
+    }
+    else if( name == "ReadBatchSize" )
+    {
+      std::ostringstream o; o << pReadBatchSize;
+      value = o.str();
+      return true;
+    }
+    else if( name == "WriteBehindSize" )
+    {
+      std::ostringstream o; o << pWriteBehindSize;
+      value = o.str();
+      return true;
+    }
+    else if( name == "LocalIO" )
+    {
+      switch( pLFileHandler->GetIOMode() )
+      {
+        case LocalFileHandler::Stream: value = "stream";   break;
+        case LocalFileHandler::Direct: value = "direct";   break;
+        default:                       value = "buffered"; break;
+      }
+      return true;
+    }
+    else if( name == "DataServer" && pDataServer )
+      { value = pDataServer->GetHostId(); return true; }
+    else if( name == "LastURL" && pDataServer )
+      { value =  pDataServer->GetURL(); return true; }
+    value = "";
+    return false;
+  }
 
+  //----------------------------------------------------------------------------
+  // Build and send a single kXR_read
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::SendRead( uint64_t         offset,
+                                           uint32_t         size,
+                                           void            *buffer,
+                                           ResponseHandler *handler,
+                                           uint16_t         timeout )
+  {
     Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a truncate command for handle 0x%x to "
+    log->Debug( FileMsg, "[0x%x@%s] Sending a read command for handle 0x%x to "
                 "%s", this, pFileUrl->GetURL().c_str(),
                 *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
 
-    Message               *msg;
-    ClientTruncateRequest *req;
+    Message           *msg;
+    ClientReadRequest *req;
     MessageUtils::CreateRequest( msg, req );
 
-    req->requestid = kXR_truncate;
+    req->requestid  = kXR_read;
+    req->offset     = offset;
+    req->rlen       = size;
     memcpy( req->fhandle, pFileHandle, 4 );
-    req->offset = size;
 
+    ChunkList *list   = new ChunkList();
+    list->push_back( ChunkInfo( offset, size, buffer ) );
+
+    XRootDTransport::SetDescription( msg );
     MessageSendParams params;
     params.timeout         = timeout;
     params.followRedirects = false;
     params.stateful        = true;
+    params.chunkList       = list;
     MessageUtils::ProcessSendParams( params );
-
-    XRootDTransport::SetDescription( msg );
     StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
 
     return SendOrQueue( *pDataServer, msg, stHandler, params );
   }
 
   //----------------------------------------------------------------------------
-  // Read scattered data chunks in one operation - async
+  // Build and send a single kXR_readv
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::VectorRead( const ChunkList &chunks,
-                                             void            *buffer,
-                                             ResponseHandler *handler,
-                                             uint16_t         timeout )
+  XRootDStatus FileStateHandler::SendVectorRead( const ChunkList &chunks,
+                                                 void            *buffer,
+                                                 ResponseHandler *handler,
+                                                 uint16_t         timeout )
   {
-    //--------------------------------------------------------------------------
-    // Sanity check
-    //--------------------------------------------------------------------------
-    XrdSysMutexHelper scopedLock( pMutex );
-
-    if( pFileState != Opened && pFileState != Recovering )
-      return XRootDStatus( stError, errInvalidOp );
-
     Log *log = DefaultEnv::GetLog();
     log->Debug( FileMsg, "[0x%x@%s] Sending a vector read command for handle "
                 "0x%x to %s", this, pFileUrl->GetURL().c_str(),
@@ -883,281 +2405,463 @@ namespace XrdCl
     return SendOrQueue( *pDataServer, msg, stHandler, params );
   }
 
-  //------------------------------------------------------------------------
-  // Write scattered data chunks in one operation - async
-  //------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::VectorWrite( const ChunkList &chunks,
-                                              ResponseHandler *handler,
-                                              uint16_t         timeout )
+  //----------------------------------------------------------------------------
+  // Decide whether to stripe a read
+  //----------------------------------------------------------------------------
+  bool FileStateHandler::GetReadStripes( uint64_t   size,
+                                         int       &stripes,
+                                         uint32_t  &stripeSize )
   {
-    //--------------------------------------------------------------------------
-    // Sanity check
-    //--------------------------------------------------------------------------
-    XrdSysMutexHelper scopedLock( pMutex );
-
-    if( pFileState != Opened && pFileState != Recovering )
-      return XRootDStatus( stError, errInvalidOp );
-
-    Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a vector write command for handle "
-                "0x%x to %s", this, pFileUrl->GetURL().c_str(),
-                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
+    if( pReadStripes > 1 )
+    {
+      stripes    = pReadStripes;
+      stripeSize = pReadStripeSize;
+      return pReadStripeSize && size > pReadStripeSize;
+    }
 
     //--------------------------------------------------------------------------
-    // Determine the size of the payload
+    // Ask the transport whether the server made us open substreams, only for
+    // reads that are worth it
     //--------------------------------------------------------------------------
+    stripeSize = pReadStripeSize ? pReadStripeSize : DefaultAutoReadStripeSize;
+    if( size <= stripeSize || pDataServer->IsLocalFile() )
+      return false;
 
-    // the size of write vector
-    uint32_t payloadSize = sizeof(XrdProto::write_list) * chunks.size();
+    AnyObject  qryResult;
+    uint16_t  *qryResponse = 0;
+    stripes = 1;
+    if( DefaultEnv::GetPostMaster()->QueryTransport( *pDataServer,
+                                                     XRootDQuery::SubStreams,
+                                                     qryResult ).IsOK() )
+    {
+      qryResult.Get( qryResponse );
+      if( qryResponse )
+        stripes = *qryResponse + 1;
+      delete qryResponse;
+    }
+    return stripes > 1;
+  }
+
+  //----------------------------------------------------------------------------
+  // Split a read into pieces travelling over different substreams
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::StripedRead( uint64_t         offset,
+                                              uint32_t         size,
+                                              void            *buffer,
+                                              ResponseHandler *handler,
+                                              uint16_t         timeout,
+                                              int              stripes,
+                                              uint32_t         stripeSize )
+  {
+    if( pDataServer->IsLocalFile() )
+      return SendRead( offset, size, buffer, handler, timeout );
 
     //--------------------------------------------------------------------------
-    // Build the message
+    // No more pieces than streams and no piece smaller than the stripe size
     //--------------------------------------------------------------------------
-    Message             *msg;
-    ClientWriteVRequest *req;
-    MessageUtils::CreateRequest( msg, req, payloadSize );
+    uint64_t piece = ( (uint64_t)size + stripes - 1 ) / stripes;
+    if( piece < stripeSize ) piece = stripeSize;
+    int nParts = ( size + piece - 1 ) / piece;
 
-    req->requestid = kXR_writev;
-    req->dlen      = sizeof(XrdProto::write_list) * chunks.size();
+    Log *log = DefaultEnv::GetLog();
+    log->Debug( FileMsg, "[0x%x@%s] Striping a read of %d bytes at %ld into "
+                "%d pieces", this, pFileUrl->GetURL().c_str(), size, offset,
+                nParts );
+
+    StripedReadHandler *collector = new StripedReadHandler( handler, false,
+                                                            offset, buffer,
+                                                            nParts );
+    XRootDStatus st;
+    int          sent;
+    for( sent = 0; sent < nParts; ++sent )
+    {
+      uint32_t pieceOff  = sent * piece;
+      uint32_t pieceSize = std::min<uint64_t>( piece, size - pieceOff );
+      ResponseHandler *partHandler = collector->GetPartHandler( sent,
+                                                                pieceSize );
+      st = SendRead( offset + pieceOff, pieceSize, (char*)buffer + pieceOff,
+                     partHandler, timeout );
+      if( !st.IsOK() )
+      {
+        delete partHandler;
+        break;
+      }
+    }
+    return collector->Issued( sent, st );
+  }
 
-    ChunkList *list   = new ChunkList();
+  //----------------------------------------------------------------------------
+  // Split a vector read into pieces travelling over different substreams
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::StripedVectorRead( const ChunkList &chunks,
+                                                    void            *buffer,
+                                                    ResponseHandler *handler,
+                                                    uint16_t         timeout,
+                                                    int              stripes,
+                                                    uint32_t         stripeSize )
+  {
+    if( pDataServer->IsLocalFile() )
+      return SendVectorRead( chunks, buffer, handler, timeout );
 
     //--------------------------------------------------------------------------
-    // Copy the chunk info
+    // Cut the chunk list into consecutive groups of roughly the same number
+    // of bytes, keeping the original order so that the responses can simply
+    // be concatenated
     //--------------------------------------------------------------------------
-    XrdProto::write_list *writeList =
-        reinterpret_cast<XrdProto::write_list*>( msg->GetBuffer( 24 ) );
-
-
+    uint64_t total = 0;
+    for( size_t i = 0; i < chunks.size(); ++i )
+      total += chunks[i].length;
+    uint64_t target = ( total + stripes - 1 ) / stripes;
+    if( target < stripeSize ) target = stripeSize;
 
+    std::vector<size_t> groupStart;
+    uint64_t            groupSize = 0;
     for( size_t i = 0; i < chunks.size(); ++i )
     {
-      writeList[i].wlen   = chunks[i].length;
-      writeList[i].offset = chunks[i].offset;
-      memcpy( writeList[i].fhandle, pFileHandle, 4 );
-
-      list->push_back( ChunkInfo( chunks[i].offset,
-                                  chunks[i].length,
-                                  chunks[i].buffer ) );
+      if( groupStart.empty() || groupSize >= target )
+      {
+        groupStart.push_back( i );
+        groupSize = 0;
+      }
+      groupSize += chunks[i].length;
     }
+    groupStart.push_back( chunks.size() );
+    int nParts = groupStart.size() - 1;
 
-    //--------------------------------------------------------------------------
-    // Send the message
-    //--------------------------------------------------------------------------
-    MessageSendParams params;
-    params.timeout         = timeout;
-    params.followRedirects = false;
-    params.stateful        = true;
-    params.chunkList       = list;
-    MessageUtils::ProcessSendParams( params );
-
-    XRootDTransport::SetDescription( msg );
-    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
-
-    return SendOrQueue( *pDataServer, msg, stHandler, params );
-  }
-
-  //------------------------------------------------------------------------
-  // Write scattered buffers in one operation - async
-  //------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::WriteV( uint64_t            offset,
-                                         const struct iovec *iov,
-                                         int                 iovcnt,
-                                         ResponseHandler    *handler,
-                                         uint16_t            timeout )
-  {
-    XrdSysMutexHelper scopedLock( pMutex );
-
-    if( pFileState != Opened && pFileState != Recovering )
-      return XRootDStatus( stError, errInvalidOp );
+    if( nParts == 1 )
+      return SendVectorRead( chunks, buffer, handler, timeout );
 
     Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a write command for handle 0x%x to "
-                "%s", this, pFileUrl->GetURL().c_str(),
-                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
-
-    Message            *msg;
-    ClientWriteRequest *req;
-    MessageUtils::CreateRequest( msg, req );
-
-    ChunkList *list   = new ChunkList();
-
-    uint32_t size = 0;
-    for( int i = 0; i < iovcnt; ++i )
+    log->Debug( FileMsg, "[0x%x@%s] Striping a vector read of %d chunks into "
+                "%d pieces", this, pFileUrl->GetURL().c_str(), chunks.size(),
+                nParts );
+
+    StripedReadHandler *collector = new StripedReadHandler( handler, true,
+                                                            0, buffer,
+                                                            nParts );
+    XRootDStatus st;
+    char        *cursor = (char*)buffer;
+    int          sent;
+    for( sent = 0; sent < nParts; ++sent )
     {
-      size += iov[i].iov_len;
-      list->push_back( ChunkInfo( 0, iov[i].iov_len,
-                       (char*)iov[i].iov_base ) );
+      ChunkList part( chunks.begin() + groupStart[sent],
+                      chunks.begin() + groupStart[sent+1] );
+      uint32_t  partSize = 0;
+      for( size_t i = 0; i < part.size(); ++i )
+        partSize += part[i].length;
+
+      ResponseHandler *partHandler = collector->GetPartHandler( sent,
+                                                                partSize );
+      st = SendVectorRead( part, cursor, partHandler, timeout );
+      if( !st.IsOK() )
+      {
+        delete partHandler;
+        break;
+      }
+      if( cursor ) cursor += partSize;
     }
+    return collector->Issued( sent, st );
+  }
 
-    req->requestid  = kXR_write;
-    req->offset     = offset;
-    req->dlen       = size;
-    memcpy( req->fhandle, pFileHandle, 4 );
-
+  //----------------------------------------------------------------------------
+  // Add a small read to the pending batch or send it right away
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::BatchedRead( uint64_t         offset,
+                                              uint32_t         size,
+                                              void            *buffer,
+                                              ResponseHandler *handler,
+                                              uint16_t         timeout )
+  {
+    //--------------------------------------------------------------------------
+    // With nothing in flight there is nothing to wait for, a lone reader is
+    // never delayed
+    //--------------------------------------------------------------------------
+    if( !pReadBatch && !pReadsInFlight )
+    {
+      std::vector<ResponseHandler*> handlers( 1, handler );
+      ReadBatchHandler *batchHandler = new ReadBatchHandler( pReadsInFlight,
+                                                             handlers, false );
+      ++pReadsInFlight;
+      XRootDStatus st = SendRead( offset, size, buffer, batchHandler, timeout );
+      if( !st.IsOK() )
+      {
+        --pReadsInFlight;
+        delete batchHandler;
+      }
+      return st;
+    }
 
+    //--------------------------------------------------------------------------
+    // Otherwise the read joins the batch, which goes out when its window
+    // passes or when it is full
+    //--------------------------------------------------------------------------
+    if( !pReadBatch )
+    {
+      pReadBatch = new ReadBatch( timeout );
+      BatchTimer::Instance()->Schedule( this, ++pReadBatchGen,
+                                            pReadBatchWindow );
+    }
 
-    MessageSendParams params;
-    params.timeout         = timeout;
-    params.followRedirects = false;
-    params.stateful        = true;
-    params.chunkList       = list;
+    pReadBatch->chunks.push_back( ChunkInfo( offset, size, buffer ) );
+    pReadBatch->handlers.push_back( handler );
+    if( pReadBatch->chunks.size() >= maxReadBatch )
+      SendReadBatch();
+    return XRootDStatus();
+  }
 
-    MessageUtils::ProcessSendParams( params );
+  //----------------------------------------------------------------------------
+  // Send the pending batch of small reads
+  //----------------------------------------------------------------------------
+  void FileStateHandler::SendReadBatch()
+  {
+    XRDCL_SMART_PTR_T<ReadBatch> batch( pReadBatch );
+    pReadBatch = 0;
+
+    bool vectorRead = batch->chunks.size() > 1;
+    ReadBatchHandler *batchHandler = new ReadBatchHandler( pReadsInFlight,
+                                                           batch->handlers,
+                                                           vectorRead );
+    XRootDStatus st;
+    ++pReadsInFlight;
+    if( vectorRead )
+    {
+      Log *log = DefaultEnv::GetLog();
+      log->Debug( FileMsg, "[0x%x@%s] Sending a batch of %d reads as a vector "
+                  "read", this, pFileUrl->GetURL().c_str(),
+                  batch->chunks.size() );
+      st = SendVectorRead( batch->chunks, 0, batchHandler, batch->timeout );
+    }
+    else
+      st = SendRead( batch->chunks[0].offset, batch->chunks[0].length,
+                     batch->chunks[0].buffer, batchHandler, batch->timeout );
 
-    XRootDTransport::SetDescription( msg );
-    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
+    if( st.IsOK() )
+      return;
 
-    return SendOrQueue( *pDataServer, msg, stHandler, params );
+    //--------------------------------------------------------------------------
+    // The reads were already accepted so their handlers get the error, from
+    // a worker thread since we are under the file mutex
+    //--------------------------------------------------------------------------
+    --pReadsInFlight;
+    delete batchHandler;
+    JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+    for( size_t i = 0; i < batch->handlers.size(); ++i )
+      jobMan->QueueJob( new ResponseJob( batch->handlers[i],
+                                         new XRootDStatus( st ), 0, 0 ) );
   }
 
   //----------------------------------------------------------------------------
-  // Performs a custom operation on an open file, server implementation
-  // dependent - async
+  // Send the pending batch if it is still the given one
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Fcntl( const Buffer    &arg,
-                                        ResponseHandler *handler,
-                                        uint16_t         timeout )
+  void FileStateHandler::FlushReadBatch( uint64_t generation )
   {
     XrdSysMutexHelper scopedLock( pMutex );
+    if( pReadBatch && pReadBatchGen == generation )
+      SendReadBatch();
+  }
 
-    if( pFileState != Opened && pFileState != Recovering )
-      return XRootDStatus( stError, errInvalidOp );
-
-    Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a fcntl command for handle 0x%x to "
-                "%s", this, pFileUrl->GetURL().c_str(),
-                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
+  //----------------------------------------------------------------------------
+  // Copy a small write to the pending batch
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::BufferedWrite( uint64_t         offset,
+                                                uint32_t         size,
+                                                const void      *buffer,
+                                                ResponseHandler *handler,
+                                                uint16_t         timeout )
+  {
+    if( pWriteBatch && pWriteBatch->data.size() + size > pWriteBehindSize )
+      SendWriteBatch();
 
-    Message            *msg;
-    ClientQueryRequest *req;
-    MessageUtils::CreateRequest( msg, req, arg.GetSize() );
+    if( !pWriteBatch )
+    {
+      pWriteBatch = new WriteBatch( timeout );
+      pWriteBatch->data.reserve( pWriteBehindSize );
+      BatchTimer::Instance()->Schedule( this, ++pWriteBatchGen,
+                                        pWriteBehindWindow, true );
+    }
 
-    req->requestid = kXR_query;
-    req->infotype  = kXR_Qopaqug;
-    req->dlen      = arg.GetSize();
-    memcpy( req->fhandle, pFileHandle, 4 );
-    msg->Append( arg.GetBuffer(), arg.GetSize(), 24 );
+    //--------------------------------------------------------------------------
+    // A write continuing the previous one extends it
+    //--------------------------------------------------------------------------
+    ChunkList &chunks = pWriteBatch->chunks;
+    if( !chunks.empty() &&
+        chunks.back().offset + chunks.back().length == offset &&
+        chunks.back().length + size <= maxWriteSegment )
+      chunks.back().length += size;
+    else
+      chunks.push_back( ChunkInfo( offset, size, 0 ) );
 
-    MessageSendParams params;
-    params.timeout         = timeout;
-    params.followRedirects = false;
-    params.stateful        = true;
-    MessageUtils::ProcessSendParams( params );
+    const char *data = (const char*)buffer;
+    pWriteBatch->data.insert( pWriteBatch->data.end(), data, data + size );
 
-    XRootDTransport::SetDescription( msg );
-    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
+    //--------------------------------------------------------------------------
+    // The writer may go on right away unless we already wait for too many
+    // batches, then it has to wait for one of them
+    //--------------------------------------------------------------------------
+    if( pWritesInFlight >= pWriteBehindInFlight )
+      pWriteWaiting.push_back( handler );
+    else
+    {
+      JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+      jobMan->QueueJob( new ResponseJob( handler, new XRootDStatus(), 0, 0 ) );
+    }
 
-    return SendOrQueue( *pDataServer, msg, stHandler, params );
+    if( pWriteBatch->data.size() >= pWriteBehindSize ||
+        chunks.size() >= maxWriteBatch )
+      SendWriteBatch();
+    return XRootDStatus();
   }
 
   //----------------------------------------------------------------------------
-  // Get access token to a file - async
+  // Send the pending batch of small writes
   //----------------------------------------------------------------------------
-  XRootDStatus FileStateHandler::Visa( ResponseHandler *handler,
-                                       uint16_t         timeout )
+  void FileStateHandler::SendWriteBatch()
   {
-    XrdSysMutexHelper scopedLock( pMutex );
-
-    if( pFileState != Opened && pFileState != Recovering )
-      return XRootDStatus( stError, errInvalidOp );
-
-    Log *log = DefaultEnv::GetLog();
-    log->Debug( FileMsg, "[0x%x@%s] Sending a visa command for handle 0x%x to "
-                "%s", this, pFileUrl->GetURL().c_str(),
-                *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
+    XRDCL_SMART_PTR_T<WriteBatch> batch( pWriteBatch );
+    pWriteBatch = 0;
 
-    Message            *msg;
-    ClientQueryRequest *req;
-    MessageUtils::CreateRequest( msg, req );
+    char *data = batch->data.data();
+    for( size_t i = 0; i < batch->chunks.size(); ++i )
+    {
+      batch->chunks[i].buffer = data;
+      data += batch->chunks[i].length;
+    }
 
-    req->requestid = kXR_query;
-    req->infotype  = kXR_Qvisa;
-    memcpy( req->fhandle, pFileHandle, 4 );
+    WriteBatchHandler *batchHandler = new WriteBatchHandler( this,
+                                                             batch->data );
+    XRootDStatus st;
+    ++pWritesInFlight;
+    if( batch->chunks.size() > 1 )
+    {
+      Log *log = DefaultEnv::GetLog();
+      log->Debug( FileMsg, "[0x%x@%s] Sending a batch of %d writes as a vector "
+                  "write", this, pFileUrl->GetURL().c_str(),
+                  batch->chunks.size() );
+      st = SendVectorWrite( batch->chunks, batchHandler, batch->timeout );
+    }
+    else
+      st = SendWrite( batch->chunks[0].offset, batch->chunks[0].length,
+                      batch->chunks[0].buffer, batchHandler, batch->timeout );
 
-    MessageSendParams params;
-    params.timeout         = timeout;
-    params.followRedirects = false;
-    params.stateful        = true;
-    MessageUtils::ProcessSendParams( params );
+    if( st.IsOK() )
+      return;
 
-    XRootDTransport::SetDescription( msg );
-    StatefulHandler *stHandler = new StatefulHandler( this, handler, msg, params );
+    //--------------------------------------------------------------------------
+    // The writes were already acknowledged, the next sync or close reports
+    // the error, and whoever waits for the batch does not wait any longer
+    //--------------------------------------------------------------------------
+    --pWritesInFlight;
+    delete batchHandler;
+    if( pWriteError.IsOK() )
+      pWriteError = st;
 
-    return SendOrQueue( *pDataServer, msg, stHandler, params );
+    JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+    for( size_t i = 0; i < pWriteWaiting.size(); ++i )
+      jobMan->QueueJob( new ResponseJob( pWriteWaiting[i],
+                                         new XRootDStatus(), 0, 0 ) );
+    pWriteWaiting.clear();
   }
 
   //----------------------------------------------------------------------------
-  // Check if the file is open
+  // Send the pending write batch if it is still the given one
   //----------------------------------------------------------------------------
-  bool FileStateHandler::IsOpen() const
+  void FileStateHandler::FlushWriteBatch( uint64_t generation )
   {
     XrdSysMutexHelper scopedLock( pMutex );
+    if( pWriteBatch && pWriteBatchGen == generation )
+      SendWriteBatch();
+  }
 
-    if( pFileState == Opened || pFileState == Recovering )
-      return true;
-    return false;
+  //----------------------------------------------------------------------------
+  // Hold back a sync or close until the buffered writes are done
+  //----------------------------------------------------------------------------
+  bool FileStateHandler::DeferUntilWritten( bool             close,
+                                            ResponseHandler *handler,
+                                            uint16_t         timeout )
+  {
+    if( pWriteBatch )
+      SendWriteBatch();
+    if( !pWritesInFlight )
+      return false;
+    pWriteDeferred.push_back( DeferredOp( close, handler, timeout ) );
+    return true;
   }
 
   //----------------------------------------------------------------------------
-  // Set file property
+  // Process the response to a batch of buffered writes
   //----------------------------------------------------------------------------
-  bool FileStateHandler::SetProperty( const std::string &name,
-                                      const std::string &value )
+  void FileStateHandler::OnWriteBatch( const XRootDStatus *status )
   {
-    XrdSysMutexHelper scopedLock( pMutex );
-    if( name == "ReadRecovery" )
-    {
-      if( value == "true" ) pDoRecoverRead = true;
-      else pDoRecoverRead = false;
-      return true;
-    }
-    else if( name == "WriteRecovery" )
+    std::vector<ResponseHandler*> waiting;
+    std::vector<DeferredOp>       deferred;
     {
-      if( value == "true" ) pDoRecoverWrite = true;
-      else pDoRecoverWrite = false;
-      return true;
+      XrdSysMutexHelper scopedLock( pMutex );
+      --pWritesInFlight;
+      if( !status->IsOK() && pWriteError.IsOK() )
+      {
+        Log *log = DefaultEnv::GetLog();
+        log->Error( FileMsg, "[0x%x@%s] Buffered write failed: %s", this,
+                    pFileUrl->GetURL().c_str(), status->ToStr().c_str() );
+        pWriteError = *status;
+      }
+      waiting.swap( pWriteWaiting );
+      if( !pWritesInFlight && !pWriteBatch )
+        deferred.swap( pWriteDeferred );
     }
-    else if( name == "FollowRedirects" )
+
+    //--------------------------------------------------------------------------
+    // Let the held back writers go and run whatever waited for all the
+    // writes to be done, a close being the last thing that can happen
+    //--------------------------------------------------------------------------
+    for( size_t i = 0; i < waiting.size(); ++i )
+      waiting[i]->HandleResponse( new XRootDStatus(), 0 );
+
+    for( size_t i = 0; i < deferred.size(); ++i )
     {
-      if( value == "true" ) pFollowRedirects = true;
-      else pFollowRedirects = false;
-      return true;
+      DeferredOp  &op = deferred[i];
+      XRootDStatus st = op.close ? Close( op.handler, op.timeout )
+                                 : Sync( op.handler, op.timeout );
+      if( !st.IsOK() )
+        op.handler->HandleResponse( new XRootDStatus( st ), 0 );
     }
-    return false;
   }
 
   //----------------------------------------------------------------------------
-  // Get file property
+  // Resend the open to the redirector if it failed at a cached data server
   //----------------------------------------------------------------------------
-  bool FileStateHandler::GetProperty( const std::string &name,
-                                      std::string &value ) const
+  bool FileStateHandler::RetryOpen( const XRootDStatus *status,
+                                    ResponseHandler    *openHandler )
   {
     XrdSysMutexHelper scopedLock( pMutex );
-    if( name == "ReadRecovery" )
-    {
-      if( pDoRecoverRead ) value = "true";
-      else value = "false";
-      return true;
-    }
-    else if( name == "WriteRecovery" )
-    {
-      if( pDoRecoverWrite ) value = "true";
-      else value = "false";
-      return true;
-    }
-    else if( name == "FollowRedirects" )
+    if( status->IsOK() || !pOpenRetry )
+      return false;
+
+    Log *log = DefaultEnv::GetLog();
+    URL  target;
+    if( RedirectCache::Get( *pFileUrl, target ) )
+      RedirectCache::Invalidate( *pFileUrl, target );
+
+    log->Debug( FileMsg, "[0x%x@%s] Open at %s found in the redirect cache "
+                "failed: %s, asking the redirector", this,
+                pFileUrl->GetURL().c_str(), target.GetHostId().c_str(),
+                status->ToStr().c_str() );
+
+    Message *msg = pOpenRetry;
+    pOpenRetry   = 0;
+    pOpenCached  = false;
+
+    XRootDTransport::SetDescription( msg );
+    MessageSendParams params; params.timeout = pOpenTimeout;
+    params.followRedirects = pFollowRedirects;
+    MessageUtils::ProcessSendParams( params );
+
+    Status st = IssueRequest( *pFileUrl, msg, openHandler, params );
+    if( !st.IsOK() )
     {
-      if( pFollowRedirects ) value = "true";
-      else value = "false";
-      return true;
+      delete msg;
+      return false;
     }
-    else if( name == "DataServer" && pDataServer )
-      { value = pDataServer->GetHostId(); return true; }
-    else if( name == "LastURL" && pDataServer )
-      { value =  pDataServer->GetURL(); return true; }
-    value = "";
-    return false;
+    return true;
   }
 
   //----------------------------------------------------------------------------
@@ -1206,6 +2910,19 @@ namespace XrdCl
     log->Debug( FileMsg, "[0x%x@%s] Open has returned with status %s",
                 this, pFileUrl->GetURL().c_str(), status->ToStr().c_str() );
 
+    //--------------------------------------------------------------------------
+    // Let the metalink redirector learn which replicas work
+    //--------------------------------------------------------------------------
+    if( hostList && pUseVirtRedirector && pFileUrl->IsMetalink() )
+    {
+      RedirectorRegistry &registry = RedirectorRegistry::Instance();
+      VirtualRedirector  *redirector = registry.Get( *pFileUrl );
+      if( redirector ) redirector->ReportOpen( *hostList, *status );
+    }
+
+    delete pOpenRetry;
+    pOpenRetry = 0;
+
     //--------------------------------------------------------------------------
     // We have failed
     //--------------------------------------------------------------------------
@@ -1252,6 +2969,20 @@ namespace XrdCl
                   pDataServer->GetHostId().c_str(), *((uint32_t*)pFileHandle),
                   pSessionId );
 
+      //------------------------------------------------------------------------
+      // Remember where the redirector sent us, or, if we skipped it, keep it
+      // as the load balancer so that the recovery goes through it
+      //------------------------------------------------------------------------
+      if( hostList && IsRedirectCacheable() )
+      {
+        if( pOpenCached )
+        {
+          if( !pLoadBalancer ) pLoadBalancer = new URL( *pFileUrl );
+        }
+        else if( hostList->size() > 1 )
+          RedirectCache::Put( *pFileUrl, hostList->back().url );
+      }
+
       //------------------------------------------------------------------------
       // Inform the monitoring about opening success
       //------------------------------------------------------------------------
@@ -1264,8 +2995,16 @@ namespace XrdCl
         i.dataServer = pDataServer->GetHostId();
         i.oFlags     = pOpenFlags;
         i.fSize      = pStatInfo ? pStatInfo->GetSize() : 0;
+        if( pTraceCtx )
+        {
+          char tp[XrdOucTraceCtx::CtxLen+1];
+          pTraceCtx->Format( tp, sizeof( tp ) );
+          i.traceCtx = tp;
+        }
         mon->Event( Monitor::EvOpen, &i );
       }
+      if( pTraceCtx )
+        OnStateSpan( "xrdcl.open", pOpenStart, 0, 0, hostList );
 
       //------------------------------------------------------------------------
       // Resend the queued messages if any
@@ -1346,7 +3085,8 @@ namespace XrdCl
       ClientRequest *req = (ClientRequest*)message->GetBuffer();
       switch( req->header.requestid )
       {
-        case kXR_read:   i.opCode = Monitor::ErrorInfo::ErrRead;  break;
+        case kXR_read:
+        case kXR_pgread: i.opCode = Monitor::ErrorInfo::ErrRead;  break;
         case kXR_readv:  i.opCode = Monitor::ErrorInfo::ErrReadV; break;
         case kXR_write:  i.opCode = Monitor::ErrorInfo::ErrWrite; break;
         // TODO
@@ -1358,6 +3098,15 @@ namespace XrdCl
       mon->Event( Monitor::EvErrIO, &i );
     }
 
+    //--------------------------------------------------------------------------
+    // The data server failed us, don't send anybody else there directly
+    //--------------------------------------------------------------------------
+    if( pDataServer && IsRedirectCacheable() )
+    {
+      RedirectCache::Invalidate( *pFileUrl, *pDataServer );
+      pOpenCached = false;
+    }
+
     //--------------------------------------------------------------------------
     // The message is not recoverable
     //--------------------------------------------------------------------------
@@ -1461,6 +3210,16 @@ namespace XrdCl
         break;
       }
 
+      //------------------------------------------------------------------------
+      // Handle pgread response
+      //------------------------------------------------------------------------
+      case kXR_pgread:
+      {
+        ++pRCount;
+        pRBytes += req->pgread.rlen;
+        break;
+      }
+
       //------------------------------------------------------------------------
       // Handle readv response
       //------------------------------------------------------------------------
@@ -1501,6 +3260,49 @@ namespace XrdCl
     };
   }
 
+  //----------------------------------------------------------------------------
+  // Report an operation on a traced file
+  //----------------------------------------------------------------------------
+  void FileStateHandler::OnStateSpan( const char     *name,
+                                      const timeval  &start,
+                                      uint64_t        offset,
+                                      uint32_t        length,
+                                      const HostList *hostList )
+  {
+    XrdOucTraceCtx *ctx = pTraceCtx;
+    if( !ctx ) return;
+
+    timeval now;
+    gettimeofday( &now, 0 );
+    long long beg = start.tv_sec * 1000000LL + start.tv_usec;
+    long long dur = now.tv_sec * 1000000LL + now.tv_usec - beg;
+
+    std::string server;
+    if( hostList && !hostList->empty() )
+      server = hostList->back().url.GetHostId();
+
+    char attr[320], span[1024];
+    snprintf( attr, sizeof( attr ), "\"off\":%llu,\"len\":%u,\"server\":\"%s\"",
+              (unsigned long long)offset, length, server.c_str() );
+    int n = ctx->SpanText( span, sizeof( span ), name, beg, dur, attr );
+    if( !n ) return;
+    XrdOucTraceCtx::Emit( span, n );
+
+    Monitor *mon = DefaultEnv::GetMonitor();
+    if( mon )
+    {
+      Monitor::SpanInfo i;
+      i.file   = pFileUrl;
+      i.name   = name;
+      i.sTOD   = start;
+      i.eTOD   = now;
+      i.offset = offset;
+      i.length = length;
+      i.json.assign( span, n );
+      mon->Event( Monitor::EvSpan, &i );
+    }
+  }
+
   //------------------------------------------------------------------------
   //! Tick
   //------------------------------------------------------------------------
@@ -1547,6 +3349,10 @@ namespace XrdCl
   {
     Log *log = DefaultEnv::GetLog();
 
+    delete pReadBatch;
+    pReadBatch     = 0;
+    pReadsInFlight = 0;
+
     if( pFileState == Closed || pFileState == Error )
       return;
 
@@ -1621,6 +3427,16 @@ namespace XrdCl
     return false;
   }
 
+  //----------------------------------------------------------------------------
+  // Local files are read and written in the calling thread, so going through
+  // a request message and the stateful handler only adds overhead
+  //----------------------------------------------------------------------------
+  bool FileStateHandler::IsLocalAccess() const
+  {
+    return pFileState == Opened && pDataServer && pDataServer->IsLocalFile() &&
+           !( pUseVirtRedirector && pDataServer->IsMetalink() );
+  }
+
   //----------------------------------------------------------------------------
   // Check if the file is open for read only
   //----------------------------------------------------------------------------
@@ -1719,6 +3535,19 @@ namespace XrdCl
     return IssueRequest( *pDataServer, msg, handler, params );
   }
 
+  //----------------------------------------------------------------------------
+  // Check if the file location may be used with the redirect cache
+  //----------------------------------------------------------------------------
+  bool FileStateHandler::IsRedirectCacheable() const
+  {
+    static const uint16_t notRO = kXR_delete | kXR_new | kXR_open_updt |
+                                  kXR_open_apnd | kXR_open_wrto | kXR_refresh;
+
+    return pFollowRedirects && pFileUrl && !( pOpenFlags & notRO ) &&
+           !pFileUrl->IsMetalink() && !pFileUrl->IsLocalFile() &&
+           RedirectCache::Enabled();
+  }
+
   //----------------------------------------------------------------------------
   // Re-open the current file at a given server
   //----------------------------------------------------------------------------
@@ -1867,6 +3696,12 @@ namespace XrdCl
         memcpy( req->fhandle, pFileHandle, 4 );
         break;
       }
+      case kXR_pgread:
+      {
+        ClientPgReadRequest *req = (ClientPgReadRequest*)msg->GetBuffer();
+        memcpy( req->fhandle, pFileHandle, 4 );
+        break;
+      }
       case kXR_write:
       {
         ClientWriteRequest *req = (ClientWriteRequest*)msg->GetBuffer();
@@ -31,11 +31,15 @@
 #include "XrdCl/XrdClMessageUtils.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdCl/XrdClLocalFileHandler.hh"
+#include <atomic>
 #include <list>
 #include <set>
+#include <vector>
 
 #include <sys/uio.h>
 
+class XrdOucTraceCtx;
+
 namespace XrdCl
 {
   class ResponseHandlerHolder;
@@ -95,6 +99,30 @@ namespace XrdCl
                          ResponseHandler   *handler,
                          uint16_t           timeout  = 0 );
 
+      //------------------------------------------------------------------------
+      //! Open the file pointed to by the given URL and read a chunk of it
+      //!
+      //! @param url        url of the file to be opened
+      //! @param flags      OpenFlags::Flags
+      //! @param offset     offset from the beginning of the file
+      //! @param size       number of bytes to be read
+      //! @param buffer     a pointer to a buffer big enough to hold the data
+      //! @param closeAfter close the file once the data has been read
+      //! @param handler    handler to be notified when the data has been
+      //!                   read, the response parameter will hold a ChunkInfo
+      //! @param timeout    timeout value, if 0 the environment default will
+      //!                   be used
+      //! @return           status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus OpenRead( const std::string &url,
+                             uint16_t           flags,
+                             uint64_t           offset,
+                             uint32_t           size,
+                             void              *buffer,
+                             bool               closeAfter,
+                             ResponseHandler   *handler,
+                             uint16_t           timeout  = 0 );
+
       //------------------------------------------------------------------------
       //! Close the file object
       //!
@@ -144,6 +172,25 @@ namespace XrdCl
                          ResponseHandler *handler,
                          uint16_t         timeout = 0 );
 
+      //------------------------------------------------------------------------
+      //! Read a data chunk with page checksums at a given offset - async
+      //!
+      //! @param offset  offset from the beginning of the file
+      //! @param size    number of bytes to be read
+      //! @param buffer  a pointer to a buffer big enough to hold the data
+      //! @param handler handler to be notified when the response arrives,
+      //!                the response parameter will hold a PageInfo object if
+      //!                the procedure was successful
+      //! @param timeout timeout value, if 0 the environment default will be
+      //!                used
+      //! @return        status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus PgRead( uint64_t         offset,
+                           uint32_t         size,
+                           void            *buffer,
+                           ResponseHandler *handler,
+                           uint16_t         timeout = 0 );
+
       //------------------------------------------------------------------------
       //! Write a data chunk at a given offset - async
       //!
@@ -260,6 +307,16 @@ namespace XrdCl
       XRootDStatus Visa( ResponseHandler *handler,
                          uint16_t         timeout = 0 );
 
+      //------------------------------------------------------------------------
+      //! Resend the open to the redirector if it went to a cached data server
+      //! and failed there
+      //!
+      //! @return true if the open was resent with the given handler, the
+      //!         response is then not to be processed
+      //------------------------------------------------------------------------
+      bool RetryOpen( const XRootDStatus *status,
+                      ResponseHandler    *openHandler );
+
       //------------------------------------------------------------------------
       //! Process the results of the opening operation
       //------------------------------------------------------------------------
@@ -296,6 +353,24 @@ namespace XrdCl
                             AnyObject    *response,
                             HostList     *hostList );
 
+      //------------------------------------------------------------------------
+      //! Report an operation on a traced file that started at start and has
+      //! just completed
+      //------------------------------------------------------------------------
+      void OnStateSpan( const char     *name,
+                        const timeval  &start,
+                        uint64_t        offset,
+                        uint32_t        length,
+                        const HostList *hostList );
+
+      //------------------------------------------------------------------------
+      //! Check if the file is traced
+      //------------------------------------------------------------------------
+      bool IsTraced() const
+      {
+        return pTraceCtx != 0;
+      }
+
       //------------------------------------------------------------------------
       //! Check if the file is open
       //------------------------------------------------------------------------
@@ -346,6 +421,23 @@ namespace XrdCl
       //------------------------------------------------------------------------
       void AfterForkChild();
 
+      //------------------------------------------------------------------------
+      //! Send the pending batch of small reads if it is still the one with
+      //! the given generation number
+      //------------------------------------------------------------------------
+      void FlushReadBatch( uint64_t generation );
+
+      //------------------------------------------------------------------------
+      //! Send the pending batch of small writes if it is still the one with
+      //! the given generation number
+      //------------------------------------------------------------------------
+      void FlushWriteBatch( uint64_t generation );
+
+      //------------------------------------------------------------------------
+      //! Process the response to a batch of buffered writes
+      //------------------------------------------------------------------------
+      void OnWriteBatch( const XRootDStatus *status );
+
     private:
       //------------------------------------------------------------------------
       // Helper for queuing messages
@@ -362,6 +454,18 @@ namespace XrdCl
       };
       typedef std::list<RequestData> RequestList;
 
+      //------------------------------------------------------------------------
+      //! Send the open request, optionally asking the server to read a chunk
+      //! of the file as well
+      //------------------------------------------------------------------------
+      XRootDStatus DoOpen( const std::string &url,
+                           uint16_t           flags,
+                           uint16_t           mode,
+                           ResponseHandler   *openHandler,
+                           uint16_t           timeout,
+                           const ChunkInfo   *rdChunk,
+                           bool               rdClose );
+
       //------------------------------------------------------------------------
       //! Send a message to a host or put it in the recovery queue
       //------------------------------------------------------------------------
@@ -399,6 +503,18 @@ namespace XrdCl
       //------------------------------------------------------------------------
       bool IsReadOnly() const;
 
+      //------------------------------------------------------------------------
+      //! Check if data requests may be handed straight to the local file
+      //! handler, without building request messages
+      //------------------------------------------------------------------------
+      bool IsLocalAccess() const;
+
+      //------------------------------------------------------------------------
+      //! Check if the location of the file may be taken from, and stored in,
+      //! the redirect cache
+      //------------------------------------------------------------------------
+      bool IsRedirectCacheable() const;
+
       //------------------------------------------------------------------------
       //! Re-open the current file at a given server
       //------------------------------------------------------------------------
@@ -457,6 +573,125 @@ namespace XrdCl
                                  ResponseHandler   *handler,
                                  MessageSendParams &sendParams );
 
+      //------------------------------------------------------------------------
+      //! Build and send a single kXR_read, the mutex must be held
+      //------------------------------------------------------------------------
+      XRootDStatus SendRead( uint64_t         offset,
+                             uint32_t         size,
+                             void            *buffer,
+                             ResponseHandler *handler,
+                             uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Build and send a single kXR_readv, the mutex must be held
+      //------------------------------------------------------------------------
+      XRootDStatus SendVectorRead( const ChunkList &chunks,
+                                   void            *buffer,
+                                   ResponseHandler *handler,
+                                   uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Build and send a single kXR_write, the mutex must be held
+      //------------------------------------------------------------------------
+      XRootDStatus SendWrite( uint64_t         offset,
+                              uint32_t         size,
+                              const void      *buffer,
+                              ResponseHandler *handler,
+                              uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Build and send a single kXR_writev, the mutex must be held
+      //------------------------------------------------------------------------
+      XRootDStatus SendVectorWrite( const ChunkList &chunks,
+                                    ResponseHandler *handler,
+                                    uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Split a read into pieces travelling over different substreams,
+      //! the mutex must be held
+      //------------------------------------------------------------------------
+      XRootDStatus StripedRead( uint64_t         offset,
+                                uint32_t         size,
+                                void            *buffer,
+                                ResponseHandler *handler,
+                                uint16_t         timeout,
+                                int              stripes,
+                                uint32_t         stripeSize );
+
+      //------------------------------------------------------------------------
+      //! Split a vector read into pieces travelling over different
+      //! substreams, the mutex must be held
+      //------------------------------------------------------------------------
+      XRootDStatus StripedVectorRead( const ChunkList &chunks,
+                                      void            *buffer,
+                                      ResponseHandler *handler,
+                                      uint16_t         timeout,
+                                      int              stripes,
+                                      uint32_t         stripeSize );
+
+      //------------------------------------------------------------------------
+      //! Tell whether a read of the given size is to be striped and over how
+      //! many pieces of at least what size. Unless the user configured
+      //! substreams the ones suggested by the data server are used. The
+      //! mutex must be held.
+      //------------------------------------------------------------------------
+      bool GetReadStripes( uint64_t   size,
+                           int       &stripes,
+                           uint32_t  &stripeSize );
+
+      //------------------------------------------------------------------------
+      //! Add a small read to the pending batch, or send it right away if no
+      //! read is in flight, the mutex must be held
+      //------------------------------------------------------------------------
+      XRootDStatus BatchedRead( uint64_t         offset,
+                                uint32_t         size,
+                                void            *buffer,
+                                ResponseHandler *handler,
+                                uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Send the pending batch of small reads, the mutex must be held
+      //------------------------------------------------------------------------
+      void SendReadBatch();
+
+      //------------------------------------------------------------------------
+      //! Copy a small write to the pending batch and acknowledge it, unless
+      //! too many batches are in flight, the mutex must be held
+      //------------------------------------------------------------------------
+      XRootDStatus BufferedWrite( uint64_t         offset,
+                                  uint32_t         size,
+                                  const void      *buffer,
+                                  ResponseHandler *handler,
+                                  uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Send the pending batch of small writes, the mutex must be held
+      //------------------------------------------------------------------------
+      void SendWriteBatch();
+
+      //------------------------------------------------------------------------
+      //! Hold back a sync or close until the buffered writes are done
+      //!
+      //! @return true if the operation has been held back
+      //------------------------------------------------------------------------
+      bool DeferUntilWritten( bool close, ResponseHandler *handler,
+                              uint16_t timeout );
+
+      struct ReadBatch;
+      struct WriteBatch;
+
+      //------------------------------------------------------------------------
+      //! A sync or close waiting for the buffered writes
+      //------------------------------------------------------------------------
+      struct DeferredOp
+      {
+        DeferredOp( bool c, ResponseHandler *h, uint16_t t ):
+          close( c ), handler( h ), timeout( t ) {}
+        bool             close;
+        ResponseHandler *handler;
+        uint16_t         timeout;
+      };
+
       mutable XrdSysMutex     pMutex;
       FileStatus              pFileState;
       XRootDStatus            pStatus;
@@ -475,6 +710,22 @@ namespace XrdCl
       bool                    pDoRecoverWrite;
       bool                    pFollowRedirects;
       bool                    pUseVirtRedirector;
+      uint32_t                pReadStripeSize;
+      int                     pReadStripes;
+      uint32_t                pReadBatchSize;
+      int                     pReadBatchWindow;
+      ReadBatch              *pReadBatch;
+      uint64_t                pReadBatchGen;
+      std::atomic<uint32_t>   pReadsInFlight;
+      uint32_t                pWriteBehindSize;
+      int                     pWriteBehindWindow;
+      int                     pWriteBehindInFlight;
+      WriteBatch             *pWriteBatch;
+      uint64_t                pWriteBatchGen;
+      int                     pWritesInFlight;
+      XRootDStatus            pWriteError;
+      std::vector<ResponseHandler*> pWriteWaiting;
+      std::vector<DeferredOp> pWriteDeferred;
 
       //------------------------------------------------------------------------
       // Monitoring variables
@@ -490,6 +741,8 @@ namespace XrdCl
       uint64_t                 pWCount;
       uint64_t                 pVWCount;
       XRootDStatus             pCloseReason;
+      XrdOucTraceCtx          *pTraceCtx;
+      timeval                  pOpenStart;
 
       //------------------------------------------------------------------------
       // Holds the OpenHanlder used to issue reopen
@@ -497,6 +750,14 @@ namespace XrdCl
       //------------------------------------------------------------------------
       ResponseHandlerHolder *pReOpenHandler;
 
+      //------------------------------------------------------------------------
+      // Open sent to a data server found in the redirect cache and the copy
+      // of it to send to the redirector if that fails
+      //------------------------------------------------------------------------
+      bool                   pOpenCached;
+      Message               *pOpenRetry;
+      uint16_t               pOpenTimeout;
+
       //------------------------------------------------------------------------
       // Responsible for file:// operations on the local filesystem
       //------------------------------------------------------------------------
@@ -41,6 +41,8 @@
 #include <sys/stat.h>
 
 #include <memory>
+#include <deque>
+#include <vector>
 
 
 namespace
@@ -754,6 +756,389 @@ namespace
 
       XrdCl::ResponseHandler *pHandler;
   };
+
+  //----------------------------------------------------------------------------
+  // Directory walk common context for all handlers
+  //----------------------------------------------------------------------------
+  class DirWalkCtx
+  {
+    public:
+      //------------------------------------------------------------------------
+      // A listing waiting for the stats of its entries
+      //------------------------------------------------------------------------
+      struct Listing
+      {
+          Listing( XrdCl::DirectoryList *list ) :
+            list( list ), left( list->GetSize() ) { }
+
+          XrdCl::DirectoryList *list;
+          uint32_t              left;
+      };
+
+      DirWalkCtx( const XrdCl::URL &url, const std::string &path,
+                  XrdCl::DirListFlags::Flags flags,
+                  XrdCl::DirWalkHandler *handler, uint32_t parallel,
+                  uint16_t timeout ) :
+        fs( new XrdCl::FileSystem( url ) ), top( path ), handler( handler ),
+        flags( flags ), parallel( parallel ), inFlight( 1 ), failures( 0 ),
+        timeout( timeout ), stop( false )
+      {
+      }
+
+      ~DirWalkCtx()
+      {
+        delete fs;
+      }
+
+      //------------------------------------------------------------------------
+      // Do we need stat information for the entries
+      //------------------------------------------------------------------------
+      bool NeedStat() const
+      {
+        return flags & ( XrdCl::DirListFlags::Stat |
+                         XrdCl::DirListFlags::Recursive );
+      }
+
+      void Listed( const std::string &path, XrdCl::XRootDStatus *status,
+                   XrdCl::DirectoryList *list );
+      void Stated( Listing *listing, uint32_t index,
+                   XrdCl::XRootDStatus *status, XrdCl::StatInfo *info );
+      void Pump();
+
+    private:
+      void Complete( XrdCl::DirectoryList *list );
+      void Failed( const std::string &path, const XrdCl::XRootDStatus &st );
+      void Stop();
+      bool Unstat( Listing *listing, XrdCl::StatInfo *info, uint32_t index );
+
+      typedef std::pair<Listing*, uint32_t> StatTask;
+
+      XrdCl::FileSystem           *fs;
+      std::string                  top;
+      XrdCl::DirWalkHandler       *handler;
+      XrdCl::DirListFlags::Flags   flags;
+      uint32_t                     parallel;
+      uint32_t                     inFlight;
+      uint32_t                     failures;
+      uint16_t                     timeout;
+      bool                         stop;
+      XrdCl::XRootDStatus          status;
+      std::vector<std::string>     dirs;  // to be listed, depth first
+      std::deque<StatTask>         stats; // to be stat'ed
+      XrdSysMutex                  mtx;
+      XrdSysMutex                  deliverMtx;
+  };
+
+  //----------------------------------------------------------------------------
+  // Handle the listing of a directory that is being walked
+  //----------------------------------------------------------------------------
+  class DirWalkListHandler: public XrdCl::ResponseHandler
+  {
+    public:
+      DirWalkListHandler( DirWalkCtx *ctx, const std::string &path ) :
+        pCtx( ctx ), pPath( path )
+      {
+      }
+
+      virtual void HandleResponse( XrdCl::XRootDStatus *status,
+                                   XrdCl::AnyObject    *response )
+      {
+        XrdCl::DirectoryList *list = 0;
+        if( status->IsOK() && response )
+        {
+          response->Get( list );
+          response->Set( (char*) 0 );
+        }
+        delete response;
+
+        DirWalkCtx *ctx = pCtx;
+        ctx->Listed( pPath, status, list );
+        delete this;
+        ctx->Pump();
+      }
+
+    private:
+      DirWalkCtx  *pCtx;
+      std::string  pPath;
+  };
+
+  //----------------------------------------------------------------------------
+  // Handle the stat of an entry of a directory that is being walked
+  //----------------------------------------------------------------------------
+  class DirWalkStatHandler: public XrdCl::ResponseHandler
+  {
+    public:
+      DirWalkStatHandler( DirWalkCtx *ctx, DirWalkCtx::Listing *listing,
+                          uint32_t index ) :
+        pCtx( ctx ), pListing( listing ), pIndex( index )
+      {
+      }
+
+      virtual void HandleResponse( XrdCl::XRootDStatus *status,
+                                   XrdCl::AnyObject    *response )
+      {
+        XrdCl::StatInfo *info = 0;
+        if( status->IsOK() && response )
+        {
+          response->Get( info );
+          response->Set( (char*) 0 );
+        }
+        delete response;
+
+        DirWalkCtx *ctx = pCtx;
+        ctx->Stated( pListing, pIndex, status, info );
+        delete this;
+        ctx->Pump();
+      }
+
+    private:
+      DirWalkCtx          *pCtx;
+      DirWalkCtx::Listing *pListing;
+      uint32_t             pIndex;
+  };
+
+  //----------------------------------------------------------------------------
+  // A directory has been listed, takes ownership of status and list
+  //----------------------------------------------------------------------------
+  void DirWalkCtx::Listed( const std::string &path,
+                           XrdCl::XRootDStatus *st,
+                           XrdCl::DirectoryList *list )
+  {
+    using namespace XrdCl;
+
+    if( st->IsOK() && !list )
+      *st = XRootDStatus( stError, errInternal );
+
+    if( !st->IsOK() )
+      Failed( path, *st );
+    else if( NeedStat() && list->GetSize() && !list->At( 0 )->GetStatInfo() )
+    {
+      //------------------------------------------------------------------------
+      // The server does not do bulk stats, queue the entries for stat'ing
+      //------------------------------------------------------------------------
+      XrdSysMutexHelper scoped( mtx );
+      if( stop )
+        delete list;
+      else
+      {
+        Listing *listing = new Listing( list );
+        for( uint32_t i = 0; i < list->GetSize(); ++i )
+          stats.push_back( StatTask( listing, i ) );
+      }
+    }
+    else
+      Complete( list );
+
+    delete st;
+  }
+
+  //----------------------------------------------------------------------------
+  // An entry has been stat'ed, takes ownership of status and info
+  //----------------------------------------------------------------------------
+  void DirWalkCtx::Stated( Listing *listing, uint32_t index,
+                           XrdCl::XRootDStatus *st, XrdCl::StatInfo *info )
+  {
+    delete st;
+    bool last;
+    {
+      XrdSysMutexHelper scoped( mtx );
+      last = Unstat( listing, info, index );
+      if( last && stop )
+      {
+        delete listing->list;
+        delete listing;
+        last = false;
+      }
+    }
+    if( last )
+    {
+      Complete( listing->list );
+      delete listing;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Record the stat of an entry, must be called with the mutex held. Returns
+  // true if this was the last entry of the listing.
+  //----------------------------------------------------------------------------
+  bool DirWalkCtx::Unstat( Listing *listing, XrdCl::StatInfo *info,
+                           uint32_t index )
+  {
+    if( info )
+      listing->list->At( index )->SetStatInfo( info );
+    else
+      ++failures;
+    return --listing->left == 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Deliver the entries of a directory, takes ownership of the list
+  //----------------------------------------------------------------------------
+  void DirWalkCtx::Complete( XrdCl::DirectoryList *list )
+  {
+    using namespace XrdCl;
+
+    //--------------------------------------------------------------------------
+    // Queue the sub-directories in reverse so that they are listed in order
+    //--------------------------------------------------------------------------
+    if( flags & DirListFlags::Recursive )
+    {
+      XrdSysMutexHelper scoped( mtx );
+      for( uint32_t i = list->GetSize(); i > 0; --i )
+      {
+        StatInfo *info = list->At( i - 1 )->GetStatInfo();
+        if( info && info->TestFlags( StatInfo::IsDir ) )
+          dirs.push_back( list->GetParentName() + list->At( i - 1 )->GetName() );
+      }
+    }
+
+    XrdSysMutexHelper delivering( deliverMtx );
+    mtx.Lock();
+    bool stopped = stop;
+    mtx.UnLock();
+    if( stopped )
+    {
+      delete list;
+      return;
+    }
+
+    if( !handler->HandleEntries( list ) )
+    {
+      XrdSysMutexHelper scoped( mtx );
+      Stop();
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // A directory could not be listed
+  //----------------------------------------------------------------------------
+  void DirWalkCtx::Failed( const std::string &path,
+                           const XrdCl::XRootDStatus &st )
+  {
+    if( path == top )
+    {
+      XrdSysMutexHelper scoped( mtx );
+      status = st;
+      return;
+    }
+
+    XrdSysMutexHelper delivering( deliverMtx );
+    mtx.Lock();
+    ++failures;
+    bool stopped = stop;
+    mtx.UnLock();
+    if( !stopped )
+      handler->HandleError( path, st );
+  }
+
+  //----------------------------------------------------------------------------
+  // Stop the walk, must be called with the mutex held
+  //----------------------------------------------------------------------------
+  void DirWalkCtx::Stop()
+  {
+    stop = true;
+    dirs.clear();
+    while( !stats.empty() )
+    {
+      Listing *listing = stats.front().first;
+      stats.pop_front();
+      if( --listing->left == 0 )
+      {
+        delete listing->list;
+        delete listing;
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Called whenever a request has been handled, sends requests until the
+  // limit is reached and then releases the request that was handled, which
+  // keeps the context alive in the meantime. The one releasing the last
+  // request ends the walk, after which the context is gone.
+  //----------------------------------------------------------------------------
+  void DirWalkCtx::Pump()
+  {
+    using namespace XrdCl;
+
+    while( true )
+    {
+      std::string path;
+      StatTask    task( 0, 0 );
+
+      //------------------------------------------------------------------------
+      // The request being released is still counted, hence the <=
+      //------------------------------------------------------------------------
+      mtx.Lock();
+      if( inFlight <= parallel && !stats.empty() )
+      {
+        task = stats.front();
+        stats.pop_front();
+        ++inFlight;
+      }
+      else if( inFlight <= parallel && !dirs.empty() )
+      {
+        path = dirs.back();
+        dirs.pop_back();
+        ++inFlight;
+      }
+      else
+      {
+        bool done = !--inFlight;
+        mtx.UnLock();
+        if( !done )
+          return;
+
+        XRootDStatus *st;
+        if( !status.IsOK() )
+          st = new XRootDStatus( status );
+        else if( stop )
+          st = new XRootDStatus( stError, errOperationInterrupted );
+        else if( failures )
+          st = new XRootDStatus( stOK, suPartial );
+        else
+          st = new XRootDStatus();
+        handler->HandleDone( st );
+        delete this;
+        return;
+      }
+      mtx.UnLock();
+
+      //------------------------------------------------------------------------
+      // Failures to send are handled here rather than through the handlers
+      // so that a run of them does not recurse
+      //------------------------------------------------------------------------
+      if( task.first )
+      {
+        DirectoryList *list = task.first->list;
+        std::string fullPath = list->GetParentName() +
+                               list->At( task.second )->GetName();
+        ResponseHandler *h = new DirWalkStatHandler( this, task.first,
+                                                     task.second );
+        XRootDStatus st = fs->Stat( fullPath, h, timeout );
+        if( !st.IsOK() )
+        {
+          delete h;
+          Stated( task.first, task.second, new XRootDStatus( st ), 0 );
+          XrdSysMutexHelper scoped( mtx );
+          --inFlight;
+        }
+      }
+      else
+      {
+        DirListFlags::Flags f = NeedStat() ? DirListFlags::Stat
+                                           : DirListFlags::None;
+        ResponseHandler *h = new DirWalkListHandler( this, path );
+        XRootDStatus st = fs->DirList( path, f, h, timeout );
+        if( !st.IsOK() )
+        {
+          delete h;
+          Listed( path, new XRootDStatus( st ), 0 );
+          XrdSysMutexHelper scoped( mtx );
+          --inFlight;
+        }
+      }
+    }
+  }
 }
 
 namespace XrdCl
@@ -1302,6 +1687,60 @@ namespace XrdCl
     return MessageUtils::WaitForResponse( &handler, response );
   }
 
+  //----------------------------------------------------------------------------
+  // Obtain status information for a list of paths - async
+  //----------------------------------------------------------------------------
+  XRootDStatus FileSystem::StatBulk( const std::vector<std::string> &paths,
+                                     ResponseHandler                *handler,
+                                     uint16_t                        timeout )
+  {
+    if( pPlugIn || pUrl->IsLocalFile() )
+      return XRootDStatus( stError, errNotSupported );
+
+    if( paths.empty() || paths.size() > kXR_maxStatx )
+      return XRootDStatus( stError, errInvalidArgs );
+
+    std::vector<std::string>::const_iterator it;
+    std::string                              list;
+    for( it = paths.begin(); it != paths.end(); ++it )
+    {
+      if( it->empty() || it->find( '\n' ) != std::string::npos )
+        return XRootDStatus( stError, errInvalidArgs );
+      list += FilterXrdClCgi( *it );
+      list += "\n";
+    }
+    list.erase( list.length()-1, 1 );
+
+    Message           *msg;
+    ClientStatRequest *req;
+    MessageUtils::CreateRequest( msg, req, list.length() );
+
+    req->requestid  = kXR_statx;
+    req->options    = kXR_sfull;
+    req->dlen       = list.length();
+    msg->Append( list.c_str(), list.length(), 24 );
+    MessageSendParams params; params.timeout = timeout;
+    MessageUtils::ProcessSendParams( params );
+    XRootDTransport::SetDescription( msg );
+
+    return Send( msg, handler, params );
+  }
+
+  //----------------------------------------------------------------------------
+  // Obtain status information for a list of paths - sync
+  //----------------------------------------------------------------------------
+  XRootDStatus FileSystem::StatBulk( const std::vector<std::string>  &paths,
+                                     StatInfoList                  *&response,
+                                     uint16_t                         timeout )
+  {
+    SyncResponseHandler handler;
+    Status st = StatBulk( paths, &handler, timeout );
+    if( !st.IsOK() )
+      return st;
+
+    return MessageUtils::WaitForResponse( &handler, response );
+  }
+
   //----------------------------------------------------------------------------
   // Obtain status information for a path - async
   //----------------------------------------------------------------------------
@@ -1432,6 +1871,43 @@ namespace XrdCl
     return Send( msg, handler, params );
   }
 
+  //----------------------------------------------------------------------------
+  // Walk a directory - async
+  //----------------------------------------------------------------------------
+  XRootDStatus FileSystem::DirWalk( const std::string   &path,
+                                    DirListFlags::Flags  flags,
+                                    DirWalkHandler      *handler,
+                                    uint32_t             parallel,
+                                    uint16_t             timeout )
+  {
+    if( flags & DirListFlags::Locate )
+      return XRootDStatus( stError, errNotSupported );
+
+    if( !parallel )
+    {
+      int val = DefaultDirWalkParallel;
+      DefaultEnv::GetEnv()->GetInt( "DirWalkParallel", val );
+      parallel = val > 0 ? val : 1;
+    }
+
+    //--------------------------------------------------------------------------
+    // The top directory is listed right away so that failing to send the
+    // request can be reported to the caller
+    //--------------------------------------------------------------------------
+    DirWalkCtx *ctx = new DirWalkCtx( *pUrl, path, flags, handler, parallel,
+                                      timeout );
+    DirListFlags::Flags f = ctx->NeedStat() ? DirListFlags::Stat
+                                            : DirListFlags::None;
+    ResponseHandler *h = new DirWalkListHandler( ctx, path );
+    XRootDStatus st = DirList( path, f, h, timeout );
+    if( !st.IsOK() )
+    {
+      delete h;
+      delete ctx;
+    }
+    return st;
+  }
+
   //----------------------------------------------------------------------------
   // List entries of a directory - sync
   //----------------------------------------------------------------------------
@@ -183,6 +183,47 @@ namespace XrdCl
   };
   XRDOUC_ENUM_OPERATORS( PrepareFlags::Flags )
 
+  //----------------------------------------------------------------------------
+  //! Receives the results of FileSystem::DirWalk
+  //----------------------------------------------------------------------------
+  class DirWalkHandler
+  {
+    public:
+      virtual ~DirWalkHandler() {}
+
+      //------------------------------------------------------------------------
+      //! Called once for each directory that has been listed, never
+      //! concurrently. The path of the directory is the parent name of the
+      //! list. The walk waits for the call to return so it should be short.
+      //!
+      //! @param entries the entries of the directory, to be deleted by the
+      //!                handler
+      //! @return        false to stop the walk
+      //------------------------------------------------------------------------
+      virtual bool HandleEntries( DirectoryList *entries ) = 0;
+
+      //------------------------------------------------------------------------
+      //! Called for a sub-directory that could not be listed, the walk goes
+      //! on. Never called concurrently with HandleEntries.
+      //------------------------------------------------------------------------
+      virtual void HandleError( const std::string  &path,
+                                const XRootDStatus &status )
+      {
+        (void)path; (void)status;
+      }
+
+      //------------------------------------------------------------------------
+      //! Called once the walk is over, no other call follows
+      //!
+      //! @param status stOK if everything was listed, stOK with suPartial if
+      //!               some entries could not be listed or stat'ed,
+      //!               errOperationInterrupted if the walk was stopped or
+      //!               the error listing the top directory; to be deleted
+      //!               by the handler
+      //------------------------------------------------------------------------
+      virtual void HandleDone( XRootDStatus *status ) = 0;
+  };
+
   //----------------------------------------------------------------------------
   //! Send file/filesystem queries to an XRootD cluster
   //----------------------------------------------------------------------------
@@ -537,6 +578,40 @@ namespace XrdCl
                          uint16_t            timeout = 0 )
                          XRD_WARN_UNUSED_RESULT;
 
+      //------------------------------------------------------------------------
+      //! Obtain status information for a list of paths in one request - async
+      //!
+      //! The server stats the paths concurrently and answers for all of them
+      //! at once. The failure to stat a path is reported in its entry.
+      //!
+      //! @param paths   up to kXR_maxStatx file/directory paths
+      //! @param handler handler to be notified when the response arrives,
+      //!                the response parameter will hold a StatInfoList
+      //!                object if the procedure is successful
+      //! @param timeout timeout value, if 0 the environment default will
+      //!                be used
+      //! @return        status of the operation, errNotSupported if the
+      //!                server does not support bulk stats
+      //------------------------------------------------------------------------
+      XRootDStatus StatBulk( const std::vector<std::string> &paths,
+                             ResponseHandler                *handler,
+                             uint16_t                        timeout = 0 )
+                             XRD_WARN_UNUSED_RESULT;
+
+      //------------------------------------------------------------------------
+      //! Obtain status information for a list of paths in one request - sync
+      //!
+      //! @param paths    up to kXR_maxStatx file/directory paths
+      //! @param response the response (to be deleted by the user)
+      //! @param timeout  timeout value, if 0 the environment default will
+      //!                 be used
+      //! @return         status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus StatBulk( const std::vector<std::string>  &paths,
+                             StatInfoList                  *&response,
+                             uint16_t                         timeout = 0 )
+                             XRD_WARN_UNUSED_RESULT;
+
       //------------------------------------------------------------------------
       //! Obtain status information for a Virtual File System - async
       //!
@@ -627,6 +702,34 @@ namespace XrdCl
                             uint16_t              timeout = 0 )
                             XRD_WARN_UNUSED_RESULT;
 
+      //------------------------------------------------------------------------
+      //! Walk a directory - async
+      //!
+      //! Unlike DirList the entries are handed over one directory at a time
+      //! as soon as they are known, so the whole tree is never held in
+      //! memory. Up to parallel dirlist and stat requests are kept in flight.
+      //! Entries are stat'ed individually only if the server does not return
+      //! their stat information with the listing.
+      //!
+      //! @param path     directory path
+      //! @param flags    DirListFlags::Stat and DirListFlags::Recursive are
+      //!                 honoured, DirListFlags::Locate is not supported
+      //! @param handler  handler receiving the entries, must stay valid
+      //!                 until its HandleDone has been called
+      //! @param parallel number of requests in flight, if 0 the environment
+      //!                 default will be used
+      //! @param timeout  timeout value of each request, if 0 the environment
+      //!                 default will be used
+      //! @return         status of the operation, the handler is only
+      //!                 called if it is OK
+      //------------------------------------------------------------------------
+      XRootDStatus DirWalk( const std::string   &path,
+                            DirListFlags::Flags  flags,
+                            DirWalkHandler      *handler,
+                            uint32_t             parallel = 0,
+                            uint16_t             timeout  = 0 )
+                            XRD_WARN_UNUSED_RESULT;
+
       //------------------------------------------------------------------------
       //! Send info to the server (up to 1024 characters)- async
       //!
@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#include "XrdCl/XrdClHostMetrics.hh"
+#include "XrdCl/XrdClURL.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+#include <unordered_map>
+#include <sstream>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // A host entry, the values are valid until the entry is stale
+  //----------------------------------------------------------------------------
+  struct Entry
+  {
+    Entry(): updated( 0 ) {}
+    XrdCl::HostMetrics::Info info;
+    time_t                   updated;
+  };
+
+  typedef std::unordered_map<std::string, Entry> EntryMap;
+
+  const double EwmaWeight = 0.25; // weight of a new sample
+  const int    StaleAfter = 3600; // seconds
+  const int    FailHold   = 60;   // seconds per consecutive failure
+  const int    FailMax    = 8;    // cap of the above multiplier
+  const size_t MaxEntries = 4096;
+
+  XrdSysMutex  metMutex;
+  EntryMap     metMap;
+
+  //----------------------------------------------------------------------------
+  // Get the entry for the key, creating it if need be (metMutex held)
+  //----------------------------------------------------------------------------
+  Entry &GetEntry( const std::string &key, time_t now )
+  {
+    EntryMap::iterator it = metMap.find( key );
+    if( it != metMap.end() )
+    {
+      if( now - it->second.updated > StaleAfter )
+        it->second = Entry();
+      it->second.updated = now;
+      return it->second;
+    }
+
+    //--------------------------------------------------------------------------
+    // A process rarely talks to that many servers, if it does just drop the
+    // one we heard of least recently
+    //--------------------------------------------------------------------------
+    if( metMap.size() >= MaxEntries )
+    {
+      EntryMap::iterator old = metMap.begin();
+      for( it = metMap.begin(); it != metMap.end(); ++it )
+        if( it->second.updated < old->second.updated ) old = it;
+      metMap.erase( old );
+    }
+
+    Entry &entry  = metMap[key];
+    entry.updated = now;
+    return entry;
+  }
+
+  //----------------------------------------------------------------------------
+  // Fold a sample into an average
+  //----------------------------------------------------------------------------
+  inline void Fold( double &avg, double sample )
+  {
+    if( avg < 0 ) avg = sample;
+    else avg += EwmaWeight * ( sample - avg );
+  }
+}
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  // Key under which the given url's host is stored
+  //----------------------------------------------------------------------------
+  std::string HostMetrics::Key( const URL &url )
+  {
+    std::ostringstream o;
+    o << url.GetHostName() << ":" << url.GetPort();
+    return o.str();
+  }
+
+  //----------------------------------------------------------------------------
+  // Get what we know about a host
+  //----------------------------------------------------------------------------
+  bool HostMetrics::Get( const std::string &key, Info &info )
+  {
+    XrdSysMutexHelper scopedLock( metMutex );
+    EntryMap::const_iterator it = metMap.find( key );
+    if( it == metMap.end() || time( 0 ) - it->second.updated > StaleAfter )
+      return false;
+    info = it->second.info;
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Estimated time to open and transfer the given number of bytes
+  //----------------------------------------------------------------------------
+  double HostMetrics::Cost( const Info &info, uint64_t bytes )
+  {
+    if( info.latency < 0 && info.rate < 0 ) return -1;
+    double cost = info.latency > 0 ? info.latency : 0;
+    if( bytes && info.rate > 0 ) cost += bytes / info.rate;
+    return cost;
+  }
+
+  //----------------------------------------------------------------------------
+  // Check if the host failed recently
+  //----------------------------------------------------------------------------
+  bool HostMetrics::Failing( const Info &info, time_t now )
+  {
+    if( !info.failed ) return false;
+    int n = info.nFail < FailMax ? info.nFail : FailMax;
+    return now - info.failed < FailHold * n;
+  }
+
+  //----------------------------------------------------------------------------
+  // Record a request round trip to the host
+  //----------------------------------------------------------------------------
+  void HostMetrics::ReportLatency( const std::string &key, double seconds )
+  {
+    XrdSysMutexHelper scopedLock( metMutex );
+    Entry &entry = GetEntry( key, time( 0 ) );
+    Fold( entry.info.latency, seconds );
+    entry.info.failed = 0;
+    entry.info.nFail  = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Record that the host could not be used
+  //----------------------------------------------------------------------------
+  void HostMetrics::ReportFailure( const std::string &key )
+  {
+    XrdSysMutexHelper scopedLock( metMutex );
+    time_t now = time( 0 );
+    Entry &entry = GetEntry( key, now );
+    entry.info.failed = now;
+    ++entry.info.nFail;
+  }
+
+  //----------------------------------------------------------------------------
+  // Record a data transfer from the host
+  //----------------------------------------------------------------------------
+  void HostMetrics::ReportTransfer( const std::string &key, uint64_t bytes,
+                                    double seconds )
+  {
+    if( bytes < MinTransferSize || seconds <= 0 ) return;
+    XrdSysMutexHelper scopedLock( metMutex );
+    Entry &entry = GetEntry( key, time( 0 ) );
+    Fold( entry.info.rate, bytes / seconds );
+  }
+}
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#ifndef __XRD_CL_HOST_METRICS_HH__
+#define __XRD_CL_HOST_METRICS_HH__
+
+#include <string>
+#include <stdint.h>
+#include <time.h>
+
+namespace XrdCl
+{
+  class URL;
+
+  //----------------------------------------------------------------------------
+  //! Process-wide table of the latency and throughput measured for each
+  //! server, used to rank the replicas of a metalink. The values are
+  //! exponentially weighted moving averages; samples older than an hour are
+  //! not trusted anymore.
+  //----------------------------------------------------------------------------
+  class HostMetrics
+  {
+    public:
+      //------------------------------------------------------------------------
+      //! What we know about a host
+      //------------------------------------------------------------------------
+      struct Info
+      {
+        Info(): latency( -1 ), rate( -1 ), failed( 0 ), nFail( 0 ) {}
+
+        double latency;   //!< seconds, negative if not known
+        double rate;      //!< bytes per second, negative if not known
+        time_t failed;    //!< time of the last failure, zero if none
+        int    nFail;     //!< consecutive failures
+      };
+
+      //------------------------------------------------------------------------
+      //! Key under which the given url's host is stored (host:port)
+      //------------------------------------------------------------------------
+      static std::string Key( const URL &url );
+
+      //------------------------------------------------------------------------
+      //! Get what we know about a host
+      //!
+      //! @return false if nothing (recent) is known
+      //------------------------------------------------------------------------
+      static bool Get( const std::string &key, Info &info );
+
+      //------------------------------------------------------------------------
+      //! Estimated time in seconds to open and transfer the given number of
+      //! bytes from the host, negative if nothing is known about it
+      //------------------------------------------------------------------------
+      static double Cost( const Info &info, uint64_t bytes );
+
+      //------------------------------------------------------------------------
+      //! Check if the host failed recently and should be tried last
+      //------------------------------------------------------------------------
+      static bool Failing( const Info &info, time_t now );
+
+      //------------------------------------------------------------------------
+      //! Record a request round trip (seconds) to the host
+      //------------------------------------------------------------------------
+      static void ReportLatency( const std::string &key, double seconds );
+
+      //------------------------------------------------------------------------
+      //! Record that the host could not be used
+      //------------------------------------------------------------------------
+      static void ReportFailure( const std::string &key );
+
+      //------------------------------------------------------------------------
+      //! Record a data transfer of given size and duration from the host
+      //------------------------------------------------------------------------
+      static void ReportTransfer( const std::string &key, uint64_t bytes,
+                                  double seconds );
+
+      //------------------------------------------------------------------------
+      //! Reads smaller than this are dominated by latency and are not
+      //! used to estimate the throughput
+      //------------------------------------------------------------------------
+      static const uint32_t MinTransferSize = 262144;
+  };
+}
+
+#endif // __XRD_CL_HOST_METRICS_HH__
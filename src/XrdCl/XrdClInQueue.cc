@@ -22,9 +22,29 @@
 #include "XrdCl/XrdClMessage.hh"
 
 #include <arpa/inet.h>              // for network unmarshalling stuff
+#include <stdlib.h>
+#include <new>
 
 namespace XrdCl
 {
+  //----------------------------------------------------------------------------
+  // Constructor
+  //----------------------------------------------------------------------------
+  InQueue::InQueue(): pHandlersEnd( 0 )
+  {
+    pHandlers = (HandlerAndExpire*)calloc( 0x10000, sizeof(HandlerAndExpire) );
+    if( !pHandlers )
+      throw std::bad_alloc();
+  }
+
+  //----------------------------------------------------------------------------
+  // Destructor
+  //----------------------------------------------------------------------------
+  InQueue::~InQueue()
+  {
+    free( pHandlers );
+  }
+
   //----------------------------------------------------------------------------
   // Filter messages
   //----------------------------------------------------------------------------
@@ -73,17 +93,17 @@ namespace XrdCl
       return true;
     }
 
-    // Lookup the sid in the map of handlers
+    // Lookup the sid in the table of handlers
     pMutex.Lock();
-    HandlerMap::iterator it = pHandlers.find(msgSid);
+    HandlerAndExpire &slot = pHandlers[msgSid];
 
-    if (it != pHandlers.end())
+    if( slot.handler )
     {
-      handler = it->second.first;
+      handler = slot.handler;
       action  = handler->Examine( msg );
 
       if( action & IncomingMsgHandler::RemoveHandler )
-        pHandlers.erase( it );
+        slot.handler = 0;
     }
 
     if( !(action & IncomingMsgHandler::Take) )
@@ -121,7 +141,7 @@ namespace XrdCl
     }
 
     if( !(action & IncomingMsgHandler::RemoveHandler) )
-      pHandlers[handlerSid] = HandlerAndExpire( handler, expires );
+      SetHandler( handlerSid, handler, expires );
   }
 
   //----------------------------------------------------------------------------
@@ -143,16 +163,16 @@ namespace XrdCl
     }
 
     XrdSysMutexHelper scopedLock( pMutex );
-    HandlerMap::iterator it = pHandlers.find(msgSid);
+    HandlerAndExpire &slot = pHandlers[msgSid];
 
-    if (it != pHandlers.end())
+    if( slot.handler )
     {
-      handler = it->second.first;
+      handler = slot.handler;
       act     = handler->Examine( msg );
-      exp     = it->second.second;
+      exp     = slot.expires;
 
       if( act & IncomingMsgHandler::Take )
-        pHandlers.erase( it );
+        slot.handler = 0;
     }
 
     if( handler )
@@ -172,7 +192,7 @@ namespace XrdCl
   {
     uint16_t handlerSid = handler->GetSid();
     XrdSysMutexHelper scopedLock( pMutex );
-    pHandlers[handlerSid] = HandlerAndExpire( handler, expires );
+    SetHandler( handlerSid, handler, expires );
   }
 
   //----------------------------------------------------------------------------
@@ -182,7 +202,7 @@ namespace XrdCl
   {
     uint16_t handlerSid = handler->GetSid();
     XrdSysMutexHelper scopedLock( pMutex );
-    pHandlers.erase(handlerSid);
+    pHandlers[handlerSid].handler = 0;
   }
 
   //----------------------------------------------------------------------------
@@ -194,14 +214,16 @@ namespace XrdCl
   {
     uint8_t action = 0;
     XrdSysMutexHelper scopedLock( pMutex );
-    for( HandlerMap::iterator it = pHandlers.begin(); it != pHandlers.end(); )
+    for( uint32_t sid = 0; sid < pHandlersEnd; ++sid )
     {
-      action = it->second.first->OnStreamEvent( event, streamNum, status );
+      IncomingMsgHandler *handler = pHandlers[sid].handler;
+      if( !handler )
+        continue;
+
+      action = handler->OnStreamEvent( event, streamNum, status );
 
       if( action & IncomingMsgHandler::RemoveHandler )
-        pHandlers.erase( it++ );
-      else
-        ++it;
+        pHandlers[sid].handler = 0;
     }
   }
 
@@ -214,17 +236,27 @@ namespace XrdCl
       now = ::time(0);
 
     XrdSysMutexHelper scopedLock( pMutex );
-    HandlerMap::iterator it = pHandlers.begin();
-    while( it != pHandlers.end() )
+    for( uint32_t sid = 0; sid < pHandlersEnd; ++sid )
     {
-      if( it->second.second <= now )
+      IncomingMsgHandler *handler = pHandlers[sid].handler;
+      if( handler && pHandlers[sid].expires <= now )
       {
-        it->second.first->OnStreamEvent( IncomingMsgHandler::Timeout, 0,
-                                         Status( stError, errOperationExpired ) );
-        pHandlers.erase( it++ );
+        handler->OnStreamEvent( IncomingMsgHandler::Timeout, 0,
+                                Status( stError, errOperationExpired ) );
+        pHandlers[sid].handler = 0;
       }
-      else
-        ++it;
     }
   }
+
+  //----------------------------------------------------------------------------
+  // Register the handler for the sid, must be called with the mutex held
+  //----------------------------------------------------------------------------
+  void InQueue::SetHandler( uint16_t sid, IncomingMsgHandler *handler,
+                            time_t expires )
+  {
+    pHandlers[sid].handler = handler;
+    pHandlers[sid].expires = expires;
+    if( sid >= pHandlersEnd )
+      pHandlersEnd = (uint32_t)sid + 1;
+  }
 }
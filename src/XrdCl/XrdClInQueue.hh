@@ -21,7 +21,8 @@
 
 #include <XrdSys/XrdSysPthread.hh>
 #include <map>
-#include <utility>
+#include <stdint.h>
+#include <time.h>
 #include "XrdCl/XrdClStatus.hh"
 #include "XrdCl/XrdClPostMasterInterfaces.hh"
 
@@ -35,6 +36,16 @@ namespace XrdCl
   class InQueue
   {
     public:
+      //------------------------------------------------------------------------
+      //! Constructor
+      //------------------------------------------------------------------------
+      InQueue();
+
+      //------------------------------------------------------------------------
+      //! Destructor
+      //------------------------------------------------------------------------
+      ~InQueue();
+
       //------------------------------------------------------------------------
       //! Add a fully reconstructed message to the queue
       //------------------------------------------------------------------------
@@ -98,12 +109,29 @@ namespace XrdCl
       //------------------------------------------------------------------------
       bool DiscardMessage(Message* msg, uint16_t& sid) const;
 
-      typedef std::pair<IncomingMsgHandler *, time_t> HandlerAndExpire;
-      typedef std::map<uint16_t, HandlerAndExpire> HandlerMap;
+      InQueue( const InQueue & );
+      InQueue &operator = ( const InQueue & );
+
+      //------------------------------------------------------------------------
+      // Handlers are kept in a table indexed directly by their SID. The table
+      // is zero filled on allocation, so only the pages for the SIDs actually
+      // in use get touched, and the scans over all the handlers stop at the
+      // highest SID ever registered.
+      //------------------------------------------------------------------------
+      struct HandlerAndExpire
+      {
+        IncomingMsgHandler *handler;
+        time_t              expires;
+      };
+
+      void SetHandler( uint16_t sid, IncomingMsgHandler *handler,
+                       time_t expires );
+
       typedef std::map<uint16_t, Message*> MessageMap;
-      MessageMap pMessages;
-      HandlerMap pHandlers;
-      XrdSysRecMutex pMutex;
+      MessageMap        pMessages;
+      HandlerAndExpire *pHandlers;
+      uint32_t          pHandlersEnd;
+      XrdSysRecMutex    pMutex;
   };
 }
 
@@ -33,6 +33,19 @@ extern "C"
     mgr->RunJobs();
     return 0;
   }
+
+  static void UnlockShard( void *arg )
+  {
+    ((XrdSysCondVar*)arg)->UnLock();
+  }
+}
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // The queue used by the calling thread plus one, zero if none yet
+  //----------------------------------------------------------------------------
+  __thread uint32_t tlsShard = 0;
 }
 
 namespace XrdCl
@@ -51,6 +64,13 @@ namespace XrdCl
   bool JobManager::Finalize()
   {
     pJobs.Clear();
+    for( uint32_t i = 0; i < pNbShards; ++i )
+    {
+      pShards[i].cond.Lock();
+      pShards[i].jobs.clear();
+      pShards[i].pending = 0;
+      pShards[i].cond.UnLock();
+    }
     return true;
   }
 
@@ -69,6 +89,11 @@ namespace XrdCl
       return false;
     }
 
+    pNextWorker = 0;
+    pNbIdle     = 0;
+    for( uint32_t i = 0; i < pNbShards; ++i )
+      pShards[i].idle = 0;
+
     for( uint32_t i = 0; i < pWorkers.size(); ++i )
     {
       int ret = ::pthread_create( &pWorkers[i], 0, ::RunRunnerThread, this );
@@ -82,7 +107,8 @@ namespace XrdCl
       }
     }
     pRunning = true;
-    log->Debug( JobMgrMsg, "Job manager started, %d workers", pWorkers.size() );
+    log->Debug( JobMgrMsg, "Job manager started, %d workers, %d queues",
+                pWorkers.size(), pNbShards ? pNbShards : 1 );
     return true;
   }
 
@@ -141,6 +167,12 @@ namespace XrdCl
   void JobManager::RunJobs()
   {
     pthread_setcanceltype( PTHREAD_CANCEL_DEFERRED, 0 );
+    if( pShards )
+    {
+      RunShard( pNextWorker++ % pNbShards );
+      return;
+    }
+
     for( ;; )
     {
       JobHelper h = pJobs.Get();
@@ -149,4 +181,109 @@ namespace XrdCl
       pthread_setcancelstate( PTHREAD_CANCEL_ENABLE, 0 );
     }
   }
+
+  //----------------------------------------------------------------------------
+  // Queue a job in the queue of the calling thread
+  //----------------------------------------------------------------------------
+  void JobManager::QueueShard( const JobHelper &h )
+  {
+    //--------------------------------------------------------------------------
+    // Threads get their queue assigned round-robin the first time they queue
+    // a job, the workers use the queue they serve
+    //--------------------------------------------------------------------------
+    if( !tlsShard )
+      tlsShard = pNextShard++ % pNbShards + 1;
+    uint32_t shard = ( tlsShard - 1 ) % pNbShards;
+
+    Shard &s = pShards[shard];
+    s.cond.Lock();
+    s.jobs.push_back( h );
+    ++s.pending;
+    bool woken = s.idle;
+    if( woken )
+      s.cond.Signal();
+    s.cond.UnLock();
+
+    //--------------------------------------------------------------------------
+    // All the workers of the queue are busy, wake up an idle worker of
+    // another queue so that it steals the job
+    //--------------------------------------------------------------------------
+    if( woken || !pNbIdle )
+      return;
+
+    for( uint32_t i = 1; i < pNbShards; ++i )
+    {
+      Shard &o = pShards[( shard + i ) % pNbShards];
+      o.cond.Lock();
+      woken = o.idle;
+      if( woken )
+        o.cond.Signal();
+      o.cond.UnLock();
+      if( woken )
+        break;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Take a job from the given queue or, failing that, from another one
+  //----------------------------------------------------------------------------
+  bool JobManager::TakeJob( uint32_t shard, JobHelper &h )
+  {
+    for( uint32_t i = 0; i < pNbShards; ++i )
+    {
+      Shard &s = pShards[( shard + i ) % pNbShards];
+      if( !s.pending )
+        continue;
+
+      s.cond.Lock();
+      if( !s.jobs.empty() )
+      {
+        h = s.jobs.front();
+        s.jobs.pop_front();
+        --s.pending;
+        s.cond.UnLock();
+        return true;
+      }
+      s.cond.UnLock();
+    }
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  // Run the jobs of the given queue
+  //----------------------------------------------------------------------------
+  void JobManager::RunShard( uint32_t shard )
+  {
+    Shard &s = pShards[shard];
+    tlsShard = shard + 1;
+
+    for( ;; )
+    {
+      JobHelper h;
+      if( TakeJob( shard, h ) )
+      {
+        pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, 0 );
+        h.job->Run( h.arg );
+        pthread_setcancelstate( PTHREAD_CANCEL_ENABLE, 0 );
+        continue;
+      }
+
+      //------------------------------------------------------------------------
+      // Nothing to do anywhere, wait for a job to be queued here or for
+      // a busy queue to ask for help. The wait is where we get cancelled.
+      //------------------------------------------------------------------------
+      s.cond.Lock();
+      if( s.jobs.empty() )
+      {
+        ++s.idle;
+        ++pNbIdle;
+        pthread_cleanup_push( UnlockShard, &s.cond );
+        s.cond.Wait();
+        pthread_cleanup_pop( 0 );
+        --pNbIdle;
+        --s.idle;
+      }
+      s.cond.UnLock();
+    }
+  }
 }
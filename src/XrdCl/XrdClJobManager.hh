@@ -20,6 +20,8 @@
 #define __XRD_CL_JOB_MANAGER_HH__
 
 #include <stdint.h>
+#include <atomic>
+#include <deque>
 #include <vector>
 #include <algorithm>
 #include <pthread.h>
@@ -46,17 +48,36 @@ namespace XrdCl
 
   //----------------------------------------------------------------------------
   //! A synchronized queue
+  //!
+  //! By default all the workers share a single queue. With more than one
+  //! queue requested every queue is served by its own workers and a thread
+  //! queuing jobs always uses the same queue, so the callbacks of the
+  //! channels handled by one event loop stay on the same workers. Idle
+  //! workers steal jobs queued for the others.
   //----------------------------------------------------------------------------
   class JobManager
   {
     public:
       //------------------------------------------------------------------------
       //! Constructor
-      //------------------------------------------------------------------------
-      JobManager( uint32_t workers )
+      //!
+      //! @param workers number of worker threads
+      //! @param queues  number of job queues, at most one per worker, when
+      //!                less than two a single shared queue is used
+      //------------------------------------------------------------------------
+      JobManager( uint32_t workers, uint32_t queues = 0 ):
+        pShards( 0 ), pNbShards( 0 ), pNbIdle( 0 ), pNextShard( 0 ),
+        pNextWorker( 0 )
       {
         pRunning = false;
         pWorkers.resize( workers );
+        if( queues > workers )
+          queues = workers;
+        if( queues > 1 )
+        {
+          pNbShards = queues;
+          pShards   = new Shard[queues];
+        }
       }
 
       //------------------------------------------------------------------------
@@ -64,6 +85,7 @@ namespace XrdCl
       //------------------------------------------------------------------------
       ~JobManager()
       {
+        delete [] pShards;
       }
 
       //------------------------------------------------------------------------
@@ -91,7 +113,10 @@ namespace XrdCl
       //------------------------------------------------------------------------
       void QueueJob( Job *job, void *arg = 0 )
       {
-        pJobs.Put( JobHelper( job, arg ) );
+        if( pShards )
+          QueueShard( JobHelper( job, arg ) );
+        else
+          pJobs.Put( JobHelper( job, arg ) );
       }
 
       //------------------------------------------------------------------------
@@ -120,8 +145,40 @@ namespace XrdCl
         void *arg;
       };
 
+      //------------------------------------------------------------------------
+      //! A job queue with the workers serving it
+      //------------------------------------------------------------------------
+      struct Shard
+      {
+        Shard(): cond( 0 ), pending( 0 ), idle( 0 ) {}
+        XrdSysCondVar         cond;
+        std::deque<JobHelper> jobs;
+        std::atomic<uint32_t> pending;
+        uint32_t              idle;
+      };
+
+      //------------------------------------------------------------------------
+      //! Queue a job in the queue of the calling thread
+      //------------------------------------------------------------------------
+      void QueueShard( const JobHelper &h );
+
+      //------------------------------------------------------------------------
+      //! Take a job from the given queue or, failing that, from another one
+      //------------------------------------------------------------------------
+      bool TakeJob( uint32_t shard, JobHelper &h );
+
+      //------------------------------------------------------------------------
+      //! Run the jobs of the given queue
+      //------------------------------------------------------------------------
+      void RunShard( uint32_t shard );
+
       std::vector<pthread_t> pWorkers;
       SyncQueue<JobHelper>   pJobs;
+      Shard                 *pShards;
+      uint32_t               pNbShards;
+      std::atomic<uint32_t>  pNbIdle;
+      std::atomic<uint32_t>  pNextShard;
+      std::atomic<uint32_t>  pNextWorker;
       XrdSysMutex            pMutex;
       bool                   pRunning;
   };
@@ -23,6 +23,7 @@
 #include "XrdCl/XrdClMessageUtils.hh"
 #include "XrdCl/XrdClFileSystem.hh"
 #include "XProtocol/XProtocol.hh"
+#include "XrdOuc/XrdOucCRC.hh"
 
 #include <string>
 #include <memory>
@@ -30,6 +31,7 @@
 #include <iostream>
 
 #include <fcntl.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -39,6 +41,22 @@
 
 namespace
 {
+  //----------------------------------------------------------------------------
+  // Drop a file range from the page cache. Dirty pages cannot be dropped so
+  // written data is synced first, which also keeps a writer from running
+  // ahead of the disk.
+  //----------------------------------------------------------------------------
+  void DropCacheRange( int fd, off_t offset, off_t size, bool written )
+  {
+#if defined(__linux__)
+    if( written )
+      sync_file_range( fd, offset, size, SYNC_FILE_RANGE_WAIT_BEFORE |
+                       SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER );
+#endif
+#if defined(POSIX_FADV_DONTNEED)
+    posix_fadvise( fd, offset, size, POSIX_FADV_DONTNEED );
+#endif
+  }
 
   class AioCtx
   {
@@ -47,8 +65,6 @@ namespace
       enum Opcode
       {
         None,
-        Read,
-        Write,
         Sync
       };
 
@@ -81,24 +97,6 @@ namespace
       }
 
 
-      void SetWrite( int fd, size_t offset, size_t size, const void *buffer )
-      {
-        cb->aio_fildes = fd;
-        cb->aio_offset = offset;
-        cb->aio_buf    = const_cast<void*>( buffer );
-        cb->aio_nbytes = size;
-        opcode = Opcode::Write;
-      }
-
-      void SetRead( int fd, size_t offset, size_t size, void *buffer )
-      {
-        cb->aio_fildes = fd;
-        cb->aio_offset = offset;
-        cb->aio_buf    = buffer;
-        cb->aio_nbytes = size;
-        opcode = Opcode::Read;
-      }
-
       void SetFsync( int fd )
       {
         cb->aio_fildes = fd;
@@ -156,34 +154,15 @@ namespace
           QueueTask( error, 0, me->hosts, me->handler );
         }
         else
-        {
-          AnyObject *resp = 0;
-
-          if( me->opcode == Opcode::Read )
-          {
-            ChunkInfo *chunk = new ChunkInfo( me->cb->aio_offset,
-                                              rc,
-                                              const_cast<void*>( me->cb->aio_buf ) );
-            resp = new AnyObject();
-            resp->Set( chunk );
-          }
-
-          QueueTask( new XRootDStatus(), resp, me->hosts, me->handler );
-        }
+          QueueTask( new XRootDStatus(), 0, me->hosts, me->handler );
       }
 
       static const char* GetErrMsg( Opcode opcode )
       {
-        static const char readmsg[]  = "Read:  failed %s";
-        static const char writemsg[] = "Write: failed %s";
         static const char syncmsg[]  = "Sync:  failed %s";
 
         switch( opcode )
         {
-          case Opcode::Read:  return readmsg;
-
-          case Opcode::Write: return writemsg;
-
           case Opcode::Sync:  return syncmsg;
 
           default:            return 0;
@@ -226,7 +205,7 @@ namespace XrdCl
   // Constructor
   //------------------------------------------------------------------------
   LocalFileHandler::LocalFileHandler() :
-      fd( -1 )
+      fd( -1 ), dfd( -1 ), ioMode( Buffered )
   {
     jmngr = DefaultEnv::GetPostMaster()->GetJobManager();
   }
@@ -268,6 +247,15 @@ namespace XrdCl
   XRootDStatus LocalFileHandler::Close( ResponseHandler* handler,
       uint16_t timeout )
   {
+    if( ioMode != Buffered )
+      DropCacheRange( fd, 0, 0, false );
+
+    if( dfd >= 0 )
+    {
+      close( dfd );
+      dfd = -1;
+    }
+
     if( close( fd ) == -1 )
     {
       Log *log = DefaultEnv::GetLog();
@@ -318,58 +306,94 @@ namespace XrdCl
   }
 
   //------------------------------------------------------------------------
-  // Read
+  // Read - the data is read right away in the calling thread, local disk
+  // I/O is not worth a round trip through an asynchronous I/O thread; only
+  // the notification of the handler is asynchronous
   //------------------------------------------------------------------------
   XRootDStatus LocalFileHandler::Read( uint64_t offset, uint32_t size,
       void* buffer, ResponseHandler* handler, uint16_t timeout )
   {
-#if defined(__APPLE__)
-    Log *log = DefaultEnv::GetLog();
-    int read = 0;
-    if( ( read = pread( fd, buffer, size, offset ) ) == -1 )
-    {
-      log->Error( FileMsg, "Read: failed %s", strerror( errno ) );
-      XRootDStatus *error = new XRootDStatus( stError, errErrorResponse,
-                                              XProtocol::mapError( errno ),
-                                              strerror( errno ) );
+    uint32_t      bytesRead = 0;
+    XRootDStatus *error     = ReadData( offset, size, buffer, bytesRead );
+    if( error )
       return QueueTask( error, 0, handler );
-    }
-    ChunkInfo *chunk = new ChunkInfo( offset, read, buffer );
+
+    ChunkInfo *chunk = new ChunkInfo( offset, bytesRead, buffer );
     AnyObject *resp = new AnyObject();
     resp->Set( chunk );
     return QueueTask( new XRootDStatus(), resp, handler );
-#else
-    AioCtx *ctx = new AioCtx( pHostList, handler );
-    ctx->SetRead( fd, offset, size, buffer );
+  }
+
+  //------------------------------------------------------------------------
+  // PgRead - as Read, the page checksums are computed from the data
+  //------------------------------------------------------------------------
+  XRootDStatus LocalFileHandler::PgRead( uint64_t offset, uint32_t size,
+      void* buffer, ResponseHandler* handler, uint16_t timeout )
+  {
+    uint32_t      bytesRead = 0;
+    XRootDStatus *error     = ReadData( offset, size, buffer, bytesRead );
+    if( error )
+      return QueueTask( error, 0, handler );
 
-    int rc = aio_read( *ctx );
+    std::vector<uint32_t> cksums( XrdOucCRC::PgCount( offset, bytesRead ) );
+    if( bytesRead )
+      XrdOucCRC::Calc32C( buffer, bytesRead, offset, &cksums[0] );
+    PageInfo *pages = new PageInfo( offset, bytesRead, buffer, cksums );
+    AnyObject *resp = new AnyObject();
+    resp->Set( pages );
+    return QueueTask( new XRootDStatus(), resp, handler );
+  }
 
-    if( rc < 0 )
+  //------------------------------------------------------------------------
+  // Read the data into the buffer
+  //------------------------------------------------------------------------
+  XRootDStatus *LocalFileHandler::ReadData( uint64_t offset, uint32_t size,
+      void *buffer, uint32_t &bytesRead )
+  {
+    int   fildes = GetFd( offset, size, buffer );
+    char *buff   = reinterpret_cast<char*>( buffer );
+
+    bytesRead = 0;
+    while( bytesRead < size )
     {
-      Log *log = DefaultEnv::GetLog();
-      log->Error( FileMsg, "Read: failed %s", strerror( errno ) );
-      return XRootDStatus( stError, errOSError, XProtocol::mapError( rc ),
-                           strerror( errno ) );
+      ssize_t ret = pread( fildes, buff + bytesRead, size - bytesRead,
+                           offset + bytesRead );
+      if( ret < 0 )
+      {
+        if( errno == EINTR ) continue;
+        Log *log = DefaultEnv::GetLog();
+        log->Error( FileMsg, "Read: failed %s", strerror( errno ) );
+        return new XRootDStatus( stError, errErrorResponse,
+                                 XProtocol::mapError( errno ),
+                                 strerror( errno ) );
+      }
+      if( ret == 0 ) break; // end of file
+      bytesRead += ret;
+      // the remainder is not aligned anymore
+      if( bytesRead < size ) fildes = fd;
     }
 
-    return XRootDStatus();
-#endif
+    DropCache( fildes, offset, bytesRead, false );
+    return 0;
   }
 
   //------------------------------------------------------------------------
-  // Write
+  // Write - as Read, the data is written right away in the calling thread
   //------------------------------------------------------------------------
   XRootDStatus LocalFileHandler::Write( uint64_t offset, uint32_t size,
       const void* buffer, ResponseHandler* handler, uint16_t timeout )
   {
-#if defined(__APPLE__)
-    const char *buff = reinterpret_cast<const char*>( buffer );
-    size_t bytesWritten = 0;
+    int         fildes       = GetFd( offset, size, buffer );
+    const char *buff         = reinterpret_cast<const char*>( buffer );
+    uint32_t    bytesWritten = 0;
+
     while( bytesWritten < size )
     {
-      ssize_t ret = pwrite( fd, buff, size, offset );
+      ssize_t ret = pwrite( fildes, buff + bytesWritten, size - bytesWritten,
+                            offset + bytesWritten );
       if( ret < 0 )
       {
+        if( errno == EINTR ) continue;
         Log *log = DefaultEnv::GetLog();
         log->Error( FileMsg, "Write: failed %s", strerror( errno ) );
         XRootDStatus *error = new XRootDStatus( stError, errErrorResponse,
@@ -377,27 +401,13 @@ namespace XrdCl
                                                 strerror( errno ) );
         return QueueTask( error, 0, handler );
       }
-      offset += ret;
-      buff += ret;
       bytesWritten += ret;
-    }
-    return QueueTask( new XRootDStatus(), 0, handler );
-#else
-    AioCtx *ctx = new AioCtx( pHostList, handler );
-    ctx->SetWrite( fd, offset, size, buffer );
-
-    int rc = aio_write( *ctx );
-
-    if( rc < 0 )
-    {
-      Log *log = DefaultEnv::GetLog();
-      log->Error( FileMsg, "Write: failed %s", strerror( errno ) );
-      return XRootDStatus( stError, errOSError, XProtocol::mapError( rc ),
-                           strerror( errno ) );
+      // the remainder is not aligned anymore
+      if( bytesWritten < size ) fildes = fd;
     }
 
-    return XRootDStatus();
-#endif
+    DropCache( fildes, offset, bytesWritten, true );
+    return QueueTask( new XRootDStatus(), 0, handler );
   }
 
   //------------------------------------------------------------------------
@@ -478,6 +488,7 @@ namespace XrdCl
                                                 strerror( errno ) );
         return QueueTask( error, 0, handler );
       }
+      DropCache( fd, chunk.offset, bytesRead, false );
       totalSize += bytesRead;
       info->GetChunks().push_back( ChunkInfo( chunk.offset, bytesRead, buffer ) );
       if( useBuffer )
@@ -512,6 +523,7 @@ namespace XrdCl
                                                 strerror( errno ) );
         return QueueTask( error, 0, handler );
       }
+      DropCache( fd, chunk.offset, bytesWritten, true );
     }
 
     return QueueTask( new XRootDStatus(), 0, handler );
@@ -574,6 +586,7 @@ namespace XrdCl
       }
     }
 
+    DropCache( fd, offset, size, true );
     return QueueTask( new XRootDStatus(), 0, handler );
   }
 
@@ -715,6 +728,32 @@ namespace XrdCl
                            strerror( errno ) );
     }
     //---------------------------------------------------------------------
+    // Keep the data out of the page cache if asked to. For direct I/O we
+    // open the file a second time with O_DIRECT, requests that are not
+    // page aligned (e.g. the tail of the file) go through the buffered
+    // descriptor and are streamed.
+    //---------------------------------------------------------------------
+    if( ioMode != Buffered )
+    {
+#if defined(__APPLE__)
+      fcntl( fd, F_NOCACHE, 1 );
+#else
+#if defined(O_DIRECT)
+      if( ioMode == Direct )
+      {
+        dfd = open( path.c_str(), ( openflags & ~( O_CREAT | O_EXCL | O_TRUNC ) )
+                                  | O_DIRECT );
+        if( dfd == -1 )
+          log->Warning( FileMsg, "Open: direct I/O not possible on %s (%s), "
+                        "streaming instead", path.c_str(), strerror( errno ) );
+      }
+#endif
+#if defined(POSIX_FADV_SEQUENTIAL)
+      posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+#endif
+    }
+    //---------------------------------------------------------------------
     // Stat File and cache statInfo in openInfo
     //---------------------------------------------------------------------
     struct stat ssp;
@@ -749,6 +788,30 @@ namespace XrdCl
     return XRootDStatus();
   }
 
+  //------------------------------------------------------------------------
+  // GetFd - O_DIRECT requires the offset, the size and the buffer to be
+  // aligned, we stick to the page size that works on all file systems
+  //------------------------------------------------------------------------
+  int LocalFileHandler::GetFd( uint64_t offset, uint64_t size,
+                               const void *buffer ) const
+  {
+    static const uint64_t align = 4096;
+    if( dfd < 0 || offset % align || size % align ||
+        reinterpret_cast<uintptr_t>( buffer ) % align )
+      return fd;
+    return dfd;
+  }
+
+  //------------------------------------------------------------------------
+  // DropCache
+  //------------------------------------------------------------------------
+  void LocalFileHandler::DropCache( int fildes, uint64_t offset,
+                                    uint64_t size, bool written ) const
+  {
+    if( ioMode != Buffered && fildes == fd && size )
+      DropCacheRange( fildes, offset, size, written );
+  }
+
   XRootDStatus LocalFileHandler::ExecRequest( const URL         &url,
                                               Message           *msg,
                                               ResponseHandler   *handler,
@@ -783,6 +846,13 @@ namespace XrdCl
                      handler, sendParams.timeout );
       }
 
+      case kXR_pgread:
+      {
+        return PgRead( req->pgread.offset, req->pgread.rlen,
+                       sendParams.chunkList->front().buffer,
+                       handler, sendParams.timeout );
+      }
+
       case kXR_write:
       {
         ChunkList *chunks = sendParams.chunkList;
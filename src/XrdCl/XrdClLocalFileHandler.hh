@@ -33,10 +33,38 @@ namespace XrdCl
   {
     public:
 
+      //------------------------------------------------------------------------
+      //! How the file data goes through the page cache
+      //------------------------------------------------------------------------
+      enum IOMode
+      {
+        Buffered, //!< normal buffered I/O
+        Stream,   //!< drop the data from the page cache once it has been
+                  //!< read or written back
+        Direct    //!< bypass the page cache (O_DIRECT) for page aligned
+                  //!< requests, stream the others
+      };
+
       LocalFileHandler();
 
       ~LocalFileHandler();
 
+      //------------------------------------------------------------------------
+      //! Set the I/O mode, has to be called before the file is opened
+      //------------------------------------------------------------------------
+      void SetIOMode( IOMode mode )
+      {
+        ioMode = mode;
+      }
+
+      //------------------------------------------------------------------------
+      //! Get the I/O mode
+      //------------------------------------------------------------------------
+      IOMode GetIOMode() const
+      {
+        return ioMode;
+      }
+
       //------------------------------------------------------------------------
       //! Open the file pointed to by the given URL
       //!
@@ -79,7 +107,7 @@ namespace XrdCl
       XRootDStatus Stat( ResponseHandler *handler, uint16_t timeout = 0 );
 
       //------------------------------------------------------------------------
-      //! Read a data chunk at a given offset - sync
+      //! Read a data chunk at a given offset - async
       //!
       //! @param offset  offset from the beginning of the file
       //! @param size    number of bytes to be read
@@ -97,6 +125,22 @@ namespace XrdCl
       XRootDStatus Read( uint64_t offset, uint32_t size, void *buffer,
           ResponseHandler *handler, uint16_t timeout = 0 );
 
+      //------------------------------------------------------------------------
+      //! Read a data chunk with page checksums at a given offset - async
+      //!
+      //! @param offset  offset from the beginning of the file
+      //! @param size    number of bytes to be read
+      //! @param buffer  a pointer to a buffer big enough to hold the data
+      //! @param handler handler to be notified when the response arrives,
+      //!                the response parameter will hold a PageInfo object if
+      //!                the procedure was successful
+      //! @param timeout timeout value, if 0 the environment default will be
+      //!                used
+      //! @return        status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus PgRead( uint64_t offset, uint32_t size, void *buffer,
+          ResponseHandler *handler, uint16_t timeout = 0 );
+
       //------------------------------------------------------------------------
       //! Write a data chunk at a given offset - async
       //!
@@ -242,6 +286,25 @@ namespace XrdCl
       XRootDStatus OpenImpl( const std::string &url, uint16_t flags,
                              uint16_t mode, AnyObject *&resp );
 
+      //---------------------------------------------------------------------
+      // Get the descriptor to use for a request, the O_DIRECT one if there
+      // is one and the request is suitably aligned
+      //---------------------------------------------------------------------
+      int GetFd( uint64_t offset, uint64_t size, const void *buffer ) const;
+
+      //---------------------------------------------------------------------
+      // Read the data for Read() and PgRead(), returns the error or 0
+      //---------------------------------------------------------------------
+      XRootDStatus *ReadData( uint64_t offset, uint32_t size, void *buffer,
+                              uint32_t &bytesRead );
+
+      //---------------------------------------------------------------------
+      // Drop a range read or written through the buffered descriptor from
+      // the page cache, if not in buffered mode
+      //---------------------------------------------------------------------
+      void DropCache( int fildes, uint64_t offset, uint64_t size,
+                      bool written ) const;
+
       //---------------------------------------------------------------------
       // Receives LocalFileTasks to handle them async
       //---------------------------------------------------------------------
@@ -252,6 +315,16 @@ namespace XrdCl
       //---------------------------------------------------------------------
       int fd;
 
+      //---------------------------------------------------------------------
+      // The O_DIRECT file descriptor, -1 if not in direct mode
+      //---------------------------------------------------------------------
+      int dfd;
+
+      //---------------------------------------------------------------------
+      // The I/O mode
+      //---------------------------------------------------------------------
+      IOMode ioMode;
+
       //---------------------------------------------------------------------
       // The file URL
       //---------------------------------------------------------------------
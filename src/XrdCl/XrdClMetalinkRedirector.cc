@@ -18,6 +18,8 @@
 #include "XrdCl/XrdClUtils.hh"
 #include "XrdCl/XrdClPostMasterInterfaces.hh"
 #include "XrdCl/XrdClPostMaster.hh"
+#include "XrdCl/XrdClHostMetrics.hh"
+#include "XrdCl/XrdClXRootDTransport.hh"
 
 #include "XrdXml/XrdXmlMetaLink.hh"
 
@@ -25,6 +27,11 @@
 
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+
+#include <algorithm>
 
 namespace XrdCl
 {
@@ -214,13 +221,175 @@ namespace XrdCl
       ResponseHandler *pUserHandler;
   };
 
+  //----------------------------------------------------------------------------
+  // Seconds elapsed since the given time
+  //----------------------------------------------------------------------------
+  static double Elapsed( const timeval &since )
+  {
+    timeval now;
+    gettimeofday( &now, 0 );
+    return ( now.tv_sec - since.tv_sec ) +
+           ( now.tv_usec - since.tv_usec ) / 1000000.0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Queue a redirect response to the given replica for the request
+  //----------------------------------------------------------------------------
+  static void QueueRedirect( const Message *msg, IncomingMsgHandler *handler,
+                             const std::string &replica )
+  {
+    const ClientRequestHdr *req =
+        reinterpret_cast<const ClientRequestHdr*>( msg->GetBuffer() );
+    Message *resp = new Message( sizeof(ServerResponse) );
+    ServerResponse* response =
+        reinterpret_cast<ServerResponse*>( resp->GetBuffer() );
+    response->hdr.status = kXR_redirect;
+    response->hdr.streamid[0] = req->streamid[0];
+    response->hdr.streamid[1] = req->streamid[1];
+    response->hdr.dlen = 4 + replica.size(); // 4 bytes are reserved for port number
+    response->body.redirect.port = -1; // this indicates that the full URL will be given in the 'host' field
+    memcpy( response->body.redirect.host, replica.c_str(), replica.size() );
+
+    JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+    jobMan->QueueJob( new RedirectJob( handler ), resp );
+  }
+
+  //----------------------------------------------------------------------------
+  // A race between the top replicas for a request ("happy eyeballs").
+  //
+  // Every candidate gets a kXR_ping, so that the connection and the login
+  // are done in parallel. The request is redirected to the first candidate
+  // that answers; its channel is ready by then. If none answers, the request
+  // goes to the best ranked one and the usual retry logic takes over. The
+  // object deletes itself after the last ping has come back.
+  //----------------------------------------------------------------------------
+  class MetalinkRace
+  {
+    public:
+      MetalinkRace( const Message *msg, IncomingMsgHandler *handler,
+                    const std::vector<std::string> &candidates ) :
+        pMsg( msg ), pHandler( handler ), pCandidates( candidates ),
+        pPending( candidates.size() + 1 ), pDone( false )
+      {
+      }
+
+      void Start( uint16_t timeout );
+
+      //------------------------------------------------------------------------
+      // Account the outcome of a ping (or of the start when idx is negative)
+      //------------------------------------------------------------------------
+      void Done( int idx, bool ok )
+      {
+        bool win = false, fallback = false, last;
+        {
+          XrdSysMutexHelper scopedLock( pMutex );
+          if( ok && !pDone ) pDone = win = true;
+          last = ( --pPending == 0 );
+          if( last && !pDone ) pDone = fallback = true;
+        }
+
+        if( win )
+        {
+          DefaultEnv::GetLog()->Debug( UtilityMsg, "Metalink race won by %s",
+                                       pCandidates[idx].c_str() );
+          QueueRedirect( pMsg, pHandler, pCandidates[idx] );
+        }
+        else if( fallback )
+          QueueRedirect( pMsg, pHandler, pCandidates[0] );
+
+        if( last ) delete this;
+      }
+
+    private:
+      const Message            *pMsg;
+      IncomingMsgHandler       *pHandler;
+      std::vector<std::string>  pCandidates;
+      size_t                    pPending;
+      bool                      pDone;
+      XrdSysMutex               pMutex;
+  };
+
+  //----------------------------------------------------------------------------
+  // A single leg of the race, records the round trip of the ping
+  //----------------------------------------------------------------------------
+  class MetalinkRaceLeg: public ResponseHandler
+  {
+    public:
+      MetalinkRaceLeg( MetalinkRace *race, int idx, const std::string &key ) :
+        pRace( race ), pIdx( idx ), pKey( key )
+      {
+        gettimeofday( &pStart, 0 );
+      }
+
+      virtual void HandleResponse( XRootDStatus *status, AnyObject *response )
+      {
+        bool ok = status->IsOK();
+        if( ok ) HostMetrics::ReportLatency( pKey, Elapsed( pStart ) );
+        else HostMetrics::ReportFailure( pKey );
+        delete status;
+        delete response;
+        pRace->Done( pIdx, ok );
+        delete this;
+      }
+
+    private:
+      MetalinkRace *pRace;
+      int           pIdx;
+      std::string   pKey;
+      timeval       pStart;
+  };
+
+  //----------------------------------------------------------------------------
+  // Send the pings
+  //----------------------------------------------------------------------------
+  void MetalinkRace::Start( uint16_t timeout )
+  {
+    for( size_t i = 0; i < pCandidates.size(); ++i )
+    {
+      URL url( pCandidates[i] );
+      Message           *msg;
+      ClientPingRequest *req;
+      MessageUtils::CreateRequest( msg, req );
+      req->requestid = kXR_ping;
+      MessageSendParams params; params.timeout = timeout;
+      params.followRedirects = false;
+      MessageUtils::ProcessSendParams( params );
+      XRootDTransport::SetDescription( msg );
+
+      MetalinkRaceLeg *leg = new MetalinkRaceLeg( this, i,
+                                                  HostMetrics::Key( url ) );
+      Status st = MessageUtils::SendMessage( url, msg, leg, params, 0 );
+      if( !st.IsOK() )
+      {
+        delete msg;
+        XRootDStatus *status = new XRootDStatus( st );
+        leg->HandleResponse( status, 0 );
+      }
+    }
+    Done( -1, false );
+  }
+
   //----------------------------------------------------------------------------
   // Constructor
   //----------------------------------------------------------------------------
   MetalinkRedirector::MetalinkRedirector( const std::string & url ) :
       pUrl( url ), pFile( new File( File::DisableVirtRedirect ) ), pReady(
-          false ), pFileSize( -1 )
+          false ), pFileSize( -1 ), pRanking( DefaultMetalinkRanking ),
+      pRace( DefaultMetalinkRace ), pRaceTimeout( DefaultMetalinkRaceTimeout )
   {
+    Env *env = DefaultEnv::GetEnv();
+    env->GetInt( "MetalinkRanking", pRanking );
+    env->GetInt( "MetalinkRace", pRace );
+    env->GetInt( "MetalinkRaceTimeout", pRaceTimeout );
+
+    std::string countries;
+    env->GetString( "MetalinkCountry", countries );
+    std::transform( countries.begin(), countries.end(), countries.begin(),
+                    ::tolower );
+    std::vector<std::string> cc;
+    Utils::splitString( cc, countries, "," );
+    pPrefCountries.insert( cc.begin(), cc.end() );
+    pPrefCountries.erase( std::string() );
   }
 
   //----------------------------------------------------------------------------
@@ -311,32 +480,6 @@ namespace XrdCl
     }
   }
 
-  //----------------------------------------------------------------------------
-  // Generates redirect response for the given request
-  //----------------------------------------------------------------------------
-  Message* MetalinkRedirector::GetResponse( const Message *msg ) const
-  {
-    if( !pStatus.IsOK() )
-      return GetErrorMsg( msg, "Could not load the Metalink file.",
-          static_cast<XErrorCode>( XProtocol::mapError( pStatus.errNo ) ) );
-    const ClientRequestHdr *req =
-        reinterpret_cast<const ClientRequestHdr*>( msg->GetBuffer() );
-    // get the redirect location
-    std::string replica;
-    if( !GetReplica( msg, replica ).IsOK() )
-      return GetErrorMsg( msg, "No more replicas to try.", kXR_NotFound );
-    Message *resp = new Message( sizeof(ServerResponse) );
-    ServerResponse* response =
-        reinterpret_cast<ServerResponse*>( resp->GetBuffer() );
-    response->hdr.status = kXR_redirect;
-    response->hdr.streamid[0] = req->streamid[0];
-    response->hdr.streamid[1] = req->streamid[1];
-    response->hdr.dlen = 4 + replica.size(); // 4 bytes are reserved for port number
-    response->body.redirect.port = -1; // this indicates that the full URL will be given in the 'host' field
-    memcpy( response->body.redirect.host, replica.c_str(), replica.size() );
-    return resp;
-  }
-
   //----------------------------------------------------------------------------
   // Generates error response for the given request
   //----------------------------------------------------------------------------
@@ -368,13 +511,82 @@ namespace XrdCl
   XRootDStatus MetalinkRedirector::HandleRequestImpl( const Message *msg,
       IncomingMsgHandler *handler )
   {
-    Message *resp = GetResponse( msg );
     JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
-    RedirectJob *job = new RedirectJob( handler );
-    jobMan->QueueJob( job, resp );
+    if( !pStatus.IsOK() )
+    {
+      Message *resp = GetErrorMsg( msg, "Could not load the Metalink file.",
+          static_cast<XErrorCode>( XProtocol::mapError( pStatus.errNo ) ) );
+      jobMan->QueueJob( new RedirectJob( handler ), resp );
+      return XRootDStatus();
+    }
+
+    std::vector<size_t> order;
+    Rank( msg, order );
+    if( order.empty() )
+    {
+      Message *resp = GetErrorMsg( msg, "No more replicas to try.",
+                                   kXR_NotFound );
+      jobMan->QueueJob( new RedirectJob( handler ), resp );
+      return XRootDStatus();
+    }
+
+    //--------------------------------------------------------------------------
+    // Opens may race the top replicas, everything else is simply redirected
+    // to the best one
+    //--------------------------------------------------------------------------
+    const ClientRequestHdr *req =
+        reinterpret_cast<const ClientRequestHdr*>( msg->GetBuffer() );
+    kXR_unt16 reqId = msg->IsMarshalled() ? ntohs( req->requestid )
+                                          : req->requestid;
+    if( reqId == kXR_open && pRace > 1 && Race( msg, handler, order ) )
+      return XRootDStatus();
+
+    Redirect( msg, handler, order[0] );
     return XRootDStatus();
   }
 
+  //----------------------------------------------------------------------------
+  // Queues a redirect response to the given replica
+  //----------------------------------------------------------------------------
+  void MetalinkRedirector::Redirect( const Message *msg,
+      IncomingMsgHandler *handler, size_t replica )
+  {
+    timeval now;
+    gettimeofday( &now, 0 );
+    pIssued[pKeys[replica]] = now;
+    QueueRedirect( msg, handler, pReplicas[replica] );
+  }
+
+  //----------------------------------------------------------------------------
+  // Pings the top ranked replicas in parallel
+  //----------------------------------------------------------------------------
+  bool MetalinkRedirector::Race( const Message *msg,
+      IncomingMsgHandler *handler, const std::vector<size_t> &order )
+  {
+    std::vector<std::string> candidates;
+    for( size_t i = 0; i < order.size() && (int)candidates.size() < pRace; ++i )
+    {
+      //------------------------------------------------------------------------
+      // There is nothing to win against a local file or a replica that is
+      // known to be down (those are ranked last)
+      //------------------------------------------------------------------------
+      const std::string &replica = pReplicas[order[i]];
+      if( URL( replica ).IsLocalFile() )
+        break;
+      HostMetrics::Info info;
+      if( HostMetrics::Get( pKeys[order[i]], info ) &&
+          HostMetrics::Failing( info, time( 0 ) ) )
+        break;
+      candidates.push_back( replica );
+    }
+    if( candidates.size() < 2 )
+      return false;
+
+    MetalinkRace *race = new MetalinkRace( msg, handler, candidates );
+    race->Start( pRaceTimeout );
+    return true;
+  }
+
   //----------------------------------------------------------------------------
   // If the MetalinkRedirector is initialized creates an instant
   // redirect response, otherwise queues the request until initialization
@@ -400,8 +612,50 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   int MetalinkRedirector::Count( Message *req ) const
   {
-    ReplicaList::const_iterator itr = GetReplica( req );
-    return pReplicas.end() - itr;
+    std::vector<size_t> order;
+    Rank( req, order );
+    return order.size();
+  }
+
+  //----------------------------------------------------------------------------
+  // Account the outcome of an open in the host metrics. The last host in the
+  // list is the one that answered, replicas visited before it did not work
+  // out. If the answer came from us (no more replicas) none of them did. An
+  // error response is an answer from a working server, only communication
+  // errors count as failures.
+  //----------------------------------------------------------------------------
+  void MetalinkRedirector::ReportOpen( const HostList &hostList,
+                                       const XRootDStatus &status )
+  {
+    if( hostList.empty() )
+      return;
+
+    std::string last = HostMetrics::Key( hostList.back().url );
+    bool served = std::find( pKeys.begin(), pKeys.end(), last ) != pKeys.end();
+
+    HostList::const_iterator it;
+    for( it = hostList.begin(); it != hostList.end(); ++it )
+    {
+      std::string key = HostMetrics::Key( it->url );
+      if( key != last &&
+          std::find( pKeys.begin(), pKeys.end(), key ) != pKeys.end() )
+        HostMetrics::ReportFailure( key );
+    }
+    if( !served )
+      return;
+
+    if( !status.IsOK() && status.code != errErrorResponse )
+    {
+      HostMetrics::ReportFailure( last );
+      return;
+    }
+
+    XrdSysMutexHelper scopedLock( pMutex );
+    IssueMap::iterator itr = pIssued.find( last );
+    if( itr == pIssued.end() )
+      return;
+    HostMetrics::ReportLatency( last, Elapsed( itr->second ) );
+    pIssued.erase( itr );
   }
 
   //----------------------------------------------------------------------------
@@ -423,54 +677,115 @@ namespace XrdCl
   {
     URL replica;
     const char *url = 0;
-    while( ( url = fileInfos[0]->GetUrl() ) )
+    char cntry[8];
+    int prty;
+    while( ( url = fileInfos[0]->GetUrl( cntry, &prty ) ) )
     {
       replica = URL( url );
       if( !replica.IsValid() || replica.GetURL().size() > 4096 )
         continue; // this is the internal limit (defined in the protocol)
       pReplicas.push_back( replica.GetURL() );
+      pHosts.push_back( replica.GetHostName() );
+      pKeys.push_back( HostMetrics::Key( replica ) );
+      std::string cc( cntry );
+      std::transform( cc.begin(), cc.end(), cc.begin(), ::tolower );
+      pCountries.push_back( cc );
+      pPriorities.push_back( prty );
     }
   }
 
   //----------------------------------------------------------------------------
-  //! Get the next replica for the given message
-  //----------------------------------------------------------------------------
-  XRootDStatus MetalinkRedirector::GetReplica( const Message *msg,
-      std::string &replica ) const
-  {
-    ReplicaList::const_iterator itr = GetReplica( msg );
-    if( itr == pReplicas.end() )
-      return XRootDStatus( stError, errNotFound );
-
-    replica = *itr;
-    return XRootDStatus();
-  }
-
-  //----------------------------------------------------------------------------
-  //! Get the next replica for the given message
-  //----------------------------------------------------------------------------
-  MetalinkRedirector::ReplicaList::const_iterator
-  MetalinkRedirector::GetReplica( const Message *msg ) const
+  // Ranks the replicas that have not been tried yet for the given message.
+  //
+  // In order of precedence: hosts that failed recently go last, as does the
+  // GLFN redirector (the last resort); replicas in a preferred country come
+  // first; then the estimated cost of the host decides, where costs within
+  // 25% of each other are considered equal; then the metalink priority and
+  // finally the metalink order. A host without measurements is assumed to
+  // cost the average of the measured ones, so that it gets its chance.
+  //----------------------------------------------------------------------------
+  void MetalinkRedirector::Rank( const Message *msg,
+                                 std::vector<size_t> &order ) const
   {
-    if( pReplicas.empty() )
-      return pReplicas.cend();
-
+    order.clear();
+    std::set<std::string> triedSet;
     std::string tried;
-    if( !GetCgiInfo( msg, "tried", tried ).IsOK() )
-      return pReplicas.cbegin();
+    if( GetCgiInfo( msg, "tried", tried ).IsOK() )
+    {
+      ReplicaList triedList;
+      Utils::splitString( triedList, tried, "," );
+      triedSet.insert( triedList.begin(), triedList.end() );
+    }
 
-    ReplicaList triedList;
-    Utils::splitString( triedList, tried, "," );
-    std::set<std::string> triedSet( triedList.begin(), triedList.end() );
+    for( size_t i = 0; i < pReplicas.size(); ++i )
+      if( !triedSet.count( pHosts[i] ) ) order.push_back( i );
+
+    if( !pRanking || order.size() < 2 )
+      return;
+
+    //--------------------------------------------------------------------------
+    // Collect the metrics
+    //--------------------------------------------------------------------------
+    time_t   now   = time( 0 );
+    uint64_t bytes = pFileSize > 0 ? pFileSize : 0;
+    std::vector<double> cost( pReplicas.size(), -1 );
+    std::vector<bool>   failing( pReplicas.size(), false );
+    double total = 0;
+    int    known = 0;
+    for( size_t i = 0; i < order.size(); ++i )
+    {
+      HostMetrics::Info info;
+      if( !HostMetrics::Get( pKeys[order[i]], info ) ) continue;
+      failing[order[i]] = HostMetrics::Failing( info, now );
+      cost[order[i]]    = HostMetrics::Cost( info, bytes );
+      if( cost[order[i]] >= 0 ) { total += cost[order[i]]; ++known; }
+    }
+    double avg = known ? total / known : 0;
+
+    //--------------------------------------------------------------------------
+    // Build the sort keys and sort
+    //--------------------------------------------------------------------------
+    struct Key
+    {
+      bool   failing;
+      bool   lastResort;
+      bool   foreign;
+      int    bucket;
+      int    priority;
+      size_t index;
+
+      bool operator<( const Key &k ) const
+      {
+        if( failing    != k.failing    ) return !failing;
+        if( lastResort != k.lastResort ) return !lastResort;
+        if( foreign    != k.foreign    ) return !foreign;
+        if( bucket     != k.bucket     ) return bucket < k.bucket;
+        if( priority   != k.priority   ) return priority < k.priority;
+        return index < k.index;
+      }
+    };
 
-    ReplicaList::const_iterator itr = pReplicas.begin();
-    for( ; itr != pReplicas.end(); ++itr )
+    std::vector<Key> keys;
+    keys.reserve( order.size() );
+    for( size_t i = 0; i < order.size(); ++i )
     {
-      URL url( *itr );
-      if( !triedSet.count( url.GetHostName() ) ) break;
+      size_t idx = order[i];
+      double c   = cost[idx] >= 0 ? cost[idx] : avg;
+      Key key;
+      key.failing    = failing[idx];
+      key.lastResort = pPriorities[idx] == INT_MAX;
+      key.foreign    = !pPrefCountries.empty() &&
+                       !pPrefCountries.count( pCountries[idx] );
+      key.bucket     = known ? (int)floor( log( std::max( c, 1e-4 ) ) /
+                                           log( 1.25 ) ) : 0;
+      key.priority   = pPriorities[idx];
+      key.index      = idx;
+      keys.push_back( key );
     }
+    std::sort( keys.begin(), keys.end() );
 
-    return itr;
+    for( size_t i = 0; i < keys.size(); ++i )
+      order[i] = keys[i].index;
   }
 
   //----------------------------------------------------------------------------
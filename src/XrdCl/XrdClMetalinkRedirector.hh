@@ -14,6 +14,9 @@
 #include <string>
 #include <list>
 #include <map>
+#include <set>
+#include <vector>
+#include <sys/time.h>
 
 
 class XrdOucFileInfo;
@@ -99,6 +102,12 @@ class MetalinkRedirector : public VirtualRedirector
     //----------------------------------------------------------------------------
     virtual int Count( Message *req ) const;
 
+    //----------------------------------------------------------------------------
+    //! Account the outcome of an open that went through this redirector
+    //! in the per host metrics used to rank the replicas
+    //----------------------------------------------------------------------------
+    virtual void ReportOpen( const HostList &hostList, const XRootDStatus &status );
+
   private:
 
     //----------------------------------------------------------------------------
@@ -124,9 +133,18 @@ class MetalinkRedirector : public VirtualRedirector
     void FinalizeInitialization( const XRootDStatus &status = XRootDStatus() );
 
     //----------------------------------------------------------------------------
-    //! Generates redirect response for the given request
+    //! Queues a redirect response to the given replica
+    //----------------------------------------------------------------------------
+    void Redirect( const Message *msg, IncomingMsgHandler *handler, size_t replica );
+
+    //----------------------------------------------------------------------------
+    //! Pings the top ranked replicas in parallel and redirects the request to
+    //! the first one that answers
+    //!
+    //! @return false if there was nothing to race
     //----------------------------------------------------------------------------
-    Message* GetResponse( const Message *msg ) const;
+    bool Race( const Message *msg, IncomingMsgHandler *handler,
+               const std::vector<size_t> &order );
 
     //----------------------------------------------------------------------------
     //! Generates error response for the given request
@@ -144,9 +162,12 @@ class MetalinkRedirector : public VirtualRedirector
     void InitReplicas( XrdOucFileInfo **fileInfos );
 
     //----------------------------------------------------------------------------
-    //! Get the next replica for the given message
+    //! Puts the indices of the replicas that have not been tried yet for the
+    //! given message into order, best first. The replicas are ranked by the
+    //! measured cost of their hosts, the preferred countries and the metalink
+    //! priority, unless ranking is disabled.
     //----------------------------------------------------------------------------
-    XRootDStatus GetReplica( const Message *msg, std::string &replica ) const;
+    void Rank( const Message *msg, std::vector<size_t> &order ) const;
 
     //----------------------------------------------------------------------------
     //! Extracts an element from URL cgi
@@ -156,22 +177,28 @@ class MetalinkRedirector : public VirtualRedirector
     typedef std::list< std::pair<const Message*, IncomingMsgHandler*> > RedirectList;
     typedef std::map<std::string, std::string>                          CksumMap;
     typedef std::vector<std::string>                                    ReplicaList;
-
-    //----------------------------------------------------------------------------
-    //! Get the next replica for the given message
-    //----------------------------------------------------------------------------
-    ReplicaList::const_iterator GetReplica( const Message *msg ) const;
+    typedef std::map<std::string, timeval>                              IssueMap;
 
     RedirectList     pPendingRedirects;
     std::string      pUrl;
     File            *pFile;
     CksumMap         pChecksums;
     ReplicaList      pReplicas;
+    ReplicaList      pHosts;      // host names, as in the "tried" cgi
+    ReplicaList      pKeys;       // HostMetrics keys
+    ReplicaList      pCountries;  // location attributes (lower case)
+    std::vector<int> pPriorities;
+    IssueMap         pIssued;     // when we last redirected to a host
     bool             pReady;
     XRootDStatus     pStatus;
     std::string      pTarget;
     long long        pFileSize;
 
+    int              pRanking;
+    int              pRace;
+    int              pRaceTimeout;
+    std::set<std::string> pPrefCountries;
+
     XrdSysMutex      pMutex;
 
     static const std::string LocalFile;
@@ -104,6 +104,7 @@ namespace XrdCl
         std::string  dataServer;  //!< Actual fata server
         uint64_t     fSize;       //!< File size in bytes
         uint16_t     oFlags;      //!< OpenFlags
+        std::string  traceCtx;    //!< xrd.traceparent of a traced file or empty
       };
 
       //------------------------------------------------------------------------
@@ -205,6 +206,25 @@ namespace XrdCl
         bool         isOK;      //!< True if checksum matched, false otherwise
       };
 
+      //------------------------------------------------------------------------
+      //! Describe a timed operation on a traced file
+      //------------------------------------------------------------------------
+      struct SpanInfo
+      {
+        SpanInfo(): file(0), name(0), offset(0), length(0)
+        {
+          sTOD.tv_sec = 0; sTOD.tv_usec = 0;
+          eTOD.tv_sec = 0; eTOD.tv_usec = 0;
+        }
+        const URL   *file;        //!< File in question
+        const char  *name;        //!< Operation, e.g. "xrdcl.read"
+        timeval      sTOD;        //!< gettimeofday() when the request was sent
+        timeval      eTOD;        //!< gettimeofday() when the response arrived
+        uint64_t     offset;      //!< Offset of the data (reads)
+        uint32_t     length;      //!< Length of the data (reads)
+        std::string  json;        //!< The span as one line of JSON
+      };
+
       //------------------------------------------------------------------------
       //! Event codes passed to the Event() method. Event code values not
       //! listed here, if encountered, should be ignored.
@@ -218,7 +238,8 @@ namespace XrdCl
         EvClose,          //!< CloseInfo: File closed
         EvErrIO,          //!< ErrorInfo: An I/O error occurred
         EvConnect,        //!< ConnectInfo: Login  into a server
-        EvDisconnect      //!< DisconnectInfo: Logout from a server
+        EvDisconnect,     //!< DisconnectInfo: Logout from a server
+        EvSpan            //!< SpanInfo: Operation on a traced file timed
 
       };
 
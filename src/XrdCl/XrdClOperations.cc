@@ -193,6 +193,7 @@ namespace XrdCl
     if( !pipeline.operation )
       throw std::invalid_argument( "Pipeline already has been executed." );
     firstOperation = pipeline.operation.release();
+    firstOperation->AssignToWorkflow( this );
   }
 
   //----------------------------------------------------------------------------
@@ -234,10 +235,22 @@ namespace XrdCl
     if( semaphore )
     {
       status = new XRootDStatus( lastOperationStatus );
+      // the callback may delete us, so make sure we don't touch any
+      // member after calling it
+      std::function<void( Workflow* )> callback = onEnd;
       semaphore->Post();
+      if( callback ) callback( this );
     }
   }
 
+  //----------------------------------------------------------------------------
+  // Workflow::OnEnd
+  //----------------------------------------------------------------------------
+  void Workflow::OnEnd( std::function<void( Workflow* )> callback )
+  {
+    onEnd = callback;
+  }
+
   //----------------------------------------------------------------------------
   // Workflow::GetStatus
   //----------------------------------------------------------------------------
@@ -26,6 +26,7 @@
 #ifndef __XRD_CL_OPERATIONS_HH__
 #define __XRD_CL_OPERATIONS_HH__
 
+#include <functional>
 #include <memory>
 #include <stdexcept>
 #include <sstream>
@@ -290,6 +291,15 @@ namespace XrdCl
        //-----------------------------------------------------------------------
       void Print();
 
+      //------------------------------------------------------------------------
+      //! Set a callback to be invoked once the pipeline execution came to an
+      //! end. It is called after the status has been set and the workflow
+      //! is not accessed anymore afterwards, so it may delete the workflow.
+      //!
+      //! @param callback : the callback, gets the workflow as argument
+      //------------------------------------------------------------------------
+      void OnEnd( std::function<void( Workflow* )> callback );
+
     private:
       //------------------------------------------------------------------------
       //! Release the semaphore and save status
@@ -324,6 +334,11 @@ namespace XrdCl
       //! true if logging is enabled, false otherwise
       //------------------------------------------------------------------------
       bool logging;
+
+      //------------------------------------------------------------------------
+      //! Callback invoked at the end of the execution (may be empty)
+      //------------------------------------------------------------------------
+      std::function<void( Workflow* )> onEnd;
   };
 
   //----------------------------------------------------------------------------
@@ -552,6 +567,14 @@ namespace XrdCl
 
     public:
 
+      //------------------------------------------------------------------------
+      //! Constructor, creates an empty pipeline
+      //------------------------------------------------------------------------
+      Pipeline()
+      {
+
+      }
+
       //------------------------------------------------------------------------
       //! Constructor
       //------------------------------------------------------------------------
@@ -29,6 +29,8 @@
 #include "XrdCl/XrdClOperations.hh"
 #include "XrdCl/XrdClOperationHandlers.hh"
 
+#include <list>
+
 namespace XrdCl
 {
   //----------------------------------------------------------------------------
@@ -229,6 +231,253 @@ namespace XrdCl
     PipesToVec( v, operations... );
     return Parallel( v );
   }
+
+  //----------------------------------------------------------------------------
+  //! Failure policies of a streamed parallel operation
+  //----------------------------------------------------------------------------
+  struct ParallelPolicy
+  {
+    enum Type
+    {
+      All,   //!< succeed if all pipelines succeed, stop at the first failure
+      Any,   //!< succeed as soon as one of the pipelines succeeds
+      Quorum //!< succeed as soon as the given number of pipelines succeed
+    };
+  };
+
+  //----------------------------------------------------------------------------
+  //! Generator of pipelines for a streamed parallel operation. It is called
+  //! each time there is room for another pipeline and should assign it to
+  //! the argument and return true, or return false if there are no more.
+  //----------------------------------------------------------------------------
+  typedef std::function<bool( Pipeline& )> PipelineGenerator;
+
+  //----------------------------------------------------------------------------
+  //! Streamed parallel operation, executes pipelines obtained from a generator
+  //! keeping at most a given number of them running at a time. Pipelines are
+  //! only created when they are about to be run and are released as soon as
+  //! they end, so arbitrarily large collections (e.g. open, read and close
+  //! of a very long list of files) can be processed in constant memory and
+  //! without flooding the server.
+  //!
+  //! Once the outcome is known according to the failure policy no further
+  //! pipelines are started, the ones already running are waited for before
+  //! the operation ends.
+  //!
+  //! @arg state : describes current operation configuration state
+  //!              (@see Operation)
+  //----------------------------------------------------------------------------
+  template<State state = Bare>
+  class ParallelStreamOperation:
+      public ConcreteOperation<ParallelStreamOperation, state>
+  {
+      template<State> friend class ParallelStreamOperation;
+
+    public:
+
+      //------------------------------------------------------------------------
+      //! Constructor: copy-move a ParallelStreamOperation in different state
+      //------------------------------------------------------------------------
+      template<State from>
+      ParallelStreamOperation( ParallelStreamOperation<from> &&obj ) :
+          ConcreteOperation<ParallelStreamOperation, state>( std::move( obj ) ),
+          generator( std::move( obj.generator ) ), limit( obj.limit ),
+          policy( obj.policy ), quorum( obj.quorum )
+      {
+      }
+
+      //------------------------------------------------------------------------
+      //! Constructor
+      //!
+      //! @param generator : generator of the pipelines to be executed
+      //! @param limit     : maximum number of pipelines running at a time
+      //! @param policy    : failure policy
+      //! @param quorum    : number of pipelines that need to succeed
+      //!                    (Quorum policy only)
+      //------------------------------------------------------------------------
+      ParallelStreamOperation( PipelineGenerator    generator,
+                               uint16_t             limit,
+                               ParallelPolicy::Type policy = ParallelPolicy::All,
+                               size_t               quorum = 1 ) :
+          generator( generator ), limit( limit ? limit : 1 ), policy( policy ),
+          quorum( quorum ? quorum : 1 )
+      {
+        static_assert(state == Configured, "Constructor is available only for type ParallelStreamOperation<Configured>");
+      }
+
+      //------------------------------------------------------------------------
+      //! make visible the >> inherited from ConcreteOperation
+      //------------------------------------------------------------------------
+      using ConcreteOperation<ParallelStreamOperation, state>::operator>>;
+
+      //------------------------------------------------------------------------
+      //! Adds handler for the operation
+      //!
+      //! @param handleFunction : callback (function, functor or lambda)
+      //------------------------------------------------------------------------
+      ParallelStreamOperation<Handled> operator>>(
+          std::function<void( XRootDStatus& )> handleFunction )
+      {
+        ForwardingHandler *forwardingHandler = new SimpleFunctionWrapper(
+            handleFunction );
+        return this->StreamImpl( forwardingHandler );
+      }
+
+      //------------------------------------------------------------------------
+      //! @return : operation name
+      //------------------------------------------------------------------------
+      std::string ToString()
+      {
+        std::ostringstream oss;
+        oss << "ParallelStream(" << limit << ")";
+        return oss.str();
+      }
+
+    private:
+
+      //------------------------------------------------------------------------
+      //! @return : true if the outcome is known according to the policy
+      //------------------------------------------------------------------------
+      bool Decided( size_t succeeded, size_t failed )
+      {
+        switch( policy )
+        {
+          case ParallelPolicy::All:    return failed > 0;
+          case ParallelPolicy::Any:    return succeeded > 0;
+          case ParallelPolicy::Quorum: return succeeded >= quorum;
+        }
+        return false;
+      }
+
+      //------------------------------------------------------------------------
+      //! Run operation
+      //!
+      //! @param params :  container with parameters forwarded from
+      //!                  previous operation
+      //! @return       :  status of the operation
+      //------------------------------------------------------------------------
+      XRootDStatus Run( std::shared_ptr<ArgsContainer> &params,
+          int bucketDefault = 0 )
+      {
+        XrdSysCondVar         endCond( 0 );
+        std::list<Workflow*>  ended;
+        XRootDStatus          failure;
+        size_t                running = 0, succeeded = 0, failed = 0;
+        int                   bucket = 0;
+        bool                  more = true;
+
+        while( true )
+        {
+          //--------------------------------------------------------------------
+          // Start as many pipelines as we may, unless it's already decided
+          //--------------------------------------------------------------------
+          while( more && running < limit && !Decided( succeeded, failed ) )
+          {
+            Pipeline pipeline;
+            if( !generator( pipeline ) )
+            {
+              more = false;
+              break;
+            }
+
+            Workflow *wf;
+            try
+            {
+              wf = new Workflow( std::move( pipeline ), false );
+            }
+            catch( const std::invalid_argument &err )
+            {
+              if( !failed++ )
+                failure = XRootDStatus( stError, errInvalidArgs, 0, err.what() );
+              more = false;
+              break;
+            }
+
+            wf->OnEnd( [&endCond, &ended]( Workflow *w )
+                       {
+                         XrdSysCondVarHelper lck( endCond );
+                         ended.push_back( w );
+                         endCond.Signal();
+                       } );
+
+            XRootDStatus st = wf->Run( params, ++bucket );
+            if( !st.IsOK() )
+            {
+              // the pipeline did not even start, so it won't end either
+              delete wf;
+              if( !failed++ ) failure = st;
+              continue;
+            }
+            ++running;
+          }
+
+          if( !running ) break;
+
+          //--------------------------------------------------------------------
+          // Wait for a pipeline to end and account for it
+          //--------------------------------------------------------------------
+          endCond.Lock();
+          while( ended.empty() ) endCond.Wait();
+          Workflow *wf = ended.front();
+          ended.pop_front();
+          endCond.UnLock();
+
+          XRootDStatus st = wf->GetStatus();
+          delete wf;
+          --running;
+          if( st.IsOK() ) ++succeeded;
+          else if( !failed++ ) failure = st;
+        }
+
+        //----------------------------------------------------------------------
+        // Work out the final status
+        //----------------------------------------------------------------------
+        bool ok;
+        switch( policy )
+        {
+          case ParallelPolicy::All:    ok = !failed;              break;
+          case ParallelPolicy::Any:    ok = succeeded > 0;        break;
+          case ParallelPolicy::Quorum: ok = succeeded >= quorum;  break;
+          default:                     ok = false;
+        }
+
+        XRootDStatus *st;
+        if( ok ) st = new XRootDStatus();
+        else if( failed ) st = new XRootDStatus( failure );
+        else
+        {
+          std::ostringstream oss;
+          oss << "Only " << succeeded << " pipelines succeeded, required were "
+              << ( policy == ParallelPolicy::Quorum ? quorum : 1 ) << ".";
+          st = new XRootDStatus( stError, errInvalidArgs, 0, oss.str() );
+        }
+        this->handler->HandleResponseWithHosts( st, nullptr, nullptr );
+
+        return XRootDStatus();
+      }
+
+      PipelineGenerator    generator;
+      uint16_t             limit;
+      ParallelPolicy::Type policy;
+      size_t               quorum;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Factory function for creating a streamed parallel operation
+  //!
+  //! @param generator : generator of the pipelines to be executed
+  //! @param limit     : maximum number of pipelines running at a time
+  //! @param policy    : failure policy
+  //! @param quorum    : number of pipelines that need to succeed
+  //!                    (Quorum policy only)
+  //----------------------------------------------------------------------------
+  inline ParallelStreamOperation<Configured> ParallelStream(
+      PipelineGenerator generator, uint16_t limit,
+      ParallelPolicy::Type policy = ParallelPolicy::All, size_t quorum = 1 )
+  {
+    return ParallelStreamOperation<Configured>( generator, limit, policy,
+                                                quorum );
+  }
 }
 
 #endif // __XRD_CL_OPERATIONS_HH__
@@ -42,9 +42,13 @@ namespace XrdCl
     Env *env = DefaultEnv::GetEnv();
     int workerThreads = DefaultWorkerThreads;
     env->GetInt( "WorkerThreads", workerThreads );
+    int workerQueues = DefaultWorkerQueues;
+    env->GetInt( "WorkerQueues", workerQueues );
+    if( workerQueues < 0 )
+      workerQueues = 0;
 
     pTaskManager = new TaskManager();
-    pJobManager  = new JobManager(workerThreads);
+    pJobManager  = new JobManager( workerThreads, workerQueues );
   }
 
   //----------------------------------------------------------------------------
@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+
+#include "XrdCl/XrdClRedirectCache.hh"
+#include "XrdCl/XrdClURL.hh"
+#include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClMessageUtils.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+#include <unordered_map>
+#include <time.h>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // A cached redirect
+  //----------------------------------------------------------------------------
+  struct Entry
+  {
+    Entry(): expires( 0 ) {}
+    XrdCl::URL target;
+    time_t     expires;
+  };
+
+  typedef std::unordered_map<std::string, Entry> EntryMap;
+
+  const size_t MaxEntries = 65536;
+
+  XrdSysMutex  rdrMutex;
+  EntryMap     rdrMap;
+
+  //----------------------------------------------------------------------------
+  // Get the settings
+  //----------------------------------------------------------------------------
+  void GetConfig( int &ttl, bool &byDir )
+  {
+    XrdCl::Env *env = XrdCl::DefaultEnv::GetEnv();
+    int dir = XrdCl::DefaultRedirectCacheByDir;
+    ttl     = XrdCl::DefaultRedirectCacheTTL;
+    env->GetInt( "RedirectCacheTTL",   ttl );
+    env->GetInt( "RedirectCacheByDir", dir );
+    byDir = dir;
+  }
+
+  //----------------------------------------------------------------------------
+  // Key of the path and the key of its directory
+  //----------------------------------------------------------------------------
+  std::string PathKey( const XrdCl::URL &url )
+  {
+    return url.GetHostId() + url.GetPath();
+  }
+
+  std::string DirKey( const XrdCl::URL &url )
+  {
+    const std::string &path = url.GetPath();
+    std::string::size_type pos = path.rfind( '/' );
+    if( pos == std::string::npos ) return url.GetHostId() + "/";
+    return url.GetHostId() + path.substr( 0, pos + 1 );
+  }
+
+  //----------------------------------------------------------------------------
+  // Find a live entry (rdrMutex held)
+  //----------------------------------------------------------------------------
+  const Entry *Find( const std::string &key, time_t now )
+  {
+    EntryMap::iterator it = rdrMap.find( key );
+    if( it == rdrMap.end() ) return 0;
+    if( it->second.expires <= now )
+    {
+      rdrMap.erase( it );
+      return 0;
+    }
+    return &it->second;
+  }
+
+  //----------------------------------------------------------------------------
+  // Store an entry (rdrMutex held)
+  //----------------------------------------------------------------------------
+  void Store( const std::string &key, const XrdCl::URL &target, time_t expires )
+  {
+    //--------------------------------------------------------------------------
+    // If the table is full drop what has expired, and if that was not enough
+    // start over, it will fill again with what is in use
+    //--------------------------------------------------------------------------
+    if( rdrMap.size() >= MaxEntries && !rdrMap.count( key ) )
+    {
+      time_t now = time( 0 );
+      EntryMap::iterator it = rdrMap.begin();
+      while( it != rdrMap.end() )
+        if( it->second.expires <= now ) it = rdrMap.erase( it );
+        else ++it;
+      if( rdrMap.size() >= MaxEntries ) rdrMap.clear();
+    }
+
+    Entry &entry  = rdrMap[key];
+    entry.target  = target;
+    entry.expires = expires;
+  }
+
+  //----------------------------------------------------------------------------
+  // Remove the entry if it points to the given host (rdrMutex held)
+  //----------------------------------------------------------------------------
+  void Remove( const std::string &key, const std::string &hostId )
+  {
+    EntryMap::iterator it = rdrMap.find( key );
+    if( it != rdrMap.end() && it->second.target.GetHostId() == hostId )
+      rdrMap.erase( it );
+  }
+}
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  // Check if the cache is enabled
+  //----------------------------------------------------------------------------
+  bool RedirectCache::Enabled()
+  {
+    int  ttl;
+    bool byDir;
+    GetConfig( ttl, byDir );
+    return ttl > 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Find where the given url was redirected to
+  //----------------------------------------------------------------------------
+  bool RedirectCache::Get( const URL &url, URL &target )
+  {
+    int  ttl;
+    bool byDir;
+    GetConfig( ttl, byDir );
+    if( ttl <= 0 ) return false;
+
+    URL where;
+    {
+      XrdSysMutexHelper scopedLock( rdrMutex );
+      time_t now = time( 0 );
+      const Entry *entry = Find( PathKey( url ), now );
+      if( !entry && byDir ) entry = Find( DirKey( url ), now );
+      if( !entry ) return false;
+      where = entry->target;
+    }
+
+    //--------------------------------------------------------------------------
+    // Keep what the user asked for and add what the redirector gave
+    //--------------------------------------------------------------------------
+    URL::ParamsMap params = url.GetParams();
+    MessageUtils::MergeCGI( params, where.GetParams(), true );
+    target = url;
+    target.SetProtocol( where.GetProtocol() );
+    target.SetUserName( where.GetUserName() );
+    target.SetHostPort( where.GetHostName(), where.GetPort() );
+    target.SetParams( params );
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Remember that the given url was redirected to the target
+  //----------------------------------------------------------------------------
+  void RedirectCache::Put( const URL &url, const URL &target )
+  {
+    int  ttl;
+    bool byDir;
+    GetConfig( ttl, byDir );
+    if( ttl <= 0 ) return;
+
+    XrdSysMutexHelper scopedLock( rdrMutex );
+    time_t expires = time( 0 ) + ttl;
+    Store( PathKey( url ), target, expires );
+    if( byDir ) Store( DirKey( url ), target, expires );
+  }
+
+  //----------------------------------------------------------------------------
+  // Forget the entries for the url that point to the given data server
+  //----------------------------------------------------------------------------
+  void RedirectCache::Invalidate( const URL &url, const URL &target )
+  {
+    XrdSysMutexHelper scopedLock( rdrMutex );
+    if( rdrMap.empty() ) return;
+    Remove( PathKey( url ), target.GetHostId() );
+    Remove( DirKey( url ), target.GetHostId() );
+  }
+}
@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#ifndef __XRD_CL_REDIRECT_CACHE_HH__
+#define __XRD_CL_REDIRECT_CACHE_HH__
+
+namespace XrdCl
+{
+  class URL;
+
+  //----------------------------------------------------------------------------
+  //! Process-wide table of the data servers the redirectors sent us to,
+  //! keyed by redirector and path, so that re-opening a file (or, if
+  //! configured, opening another file in the same directory) can go straight
+  //! to the data server. Entries live for XRD_REDIRECTCACHETTL seconds, the
+  //! cache is disabled if that is zero.
+  //----------------------------------------------------------------------------
+  class RedirectCache
+  {
+    public:
+      //------------------------------------------------------------------------
+      //! Check if the cache is enabled
+      //------------------------------------------------------------------------
+      static bool Enabled();
+
+      //------------------------------------------------------------------------
+      //! Find where the given url was redirected to
+      //!
+      //! @param url    the url as given to the redirector
+      //! @param target the url to use instead: the same path and parameters,
+      //!               the cached data server and the opaque data it was
+      //!               given on the redirect
+      //! @return false if nothing (recent) is known
+      //------------------------------------------------------------------------
+      static bool Get( const URL &url, URL &target );
+
+      //------------------------------------------------------------------------
+      //! Remember that the given url was redirected to the target
+      //------------------------------------------------------------------------
+      static void Put( const URL &url, const URL &target );
+
+      //------------------------------------------------------------------------
+      //! Forget the entries for the url that point to the given data server,
+      //! called when the data server failed us
+      //------------------------------------------------------------------------
+      static void Invalidate( const URL &url, const URL &target );
+  };
+}
+
+#endif // __XRD_CL_REDIRECT_CACHE_HH__
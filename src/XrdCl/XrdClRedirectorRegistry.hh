@@ -103,6 +103,13 @@ class VirtualRedirector
     //! Count how many replicas do we have left to try for given request
     //----------------------------------------------------------------------------
     virtual int Count( Message *req ) const = 0;
+
+    //----------------------------------------------------------------------------
+    //! Account the outcome of an open that went through this redirector
+    //! (by default nothing is done)
+    //----------------------------------------------------------------------------
+    virtual void ReportOpen( const HostList     &/*hostList*/,
+                             const XRootDStatus &/*status*/ ) {}
 };
 
 //--------------------------------------------------------------------------------
@@ -25,26 +25,42 @@ namespace XrdCl
   //---------------------------------------------------------------------------
   Status SIDManager::AllocateSID( uint8_t sid[2] )
   {
-    XrdSysMutexHelper scopedLock( pMutex );
-
-    uint16_t allocSID = 1;
+    uint16_t allocSID = 0;
 
     //--------------------------------------------------------------------------
-    // Get a SID from the list of free SIDs if it's not empty
+    // Pop a SID off the stack of free SIDs if it's not empty. SID 0 is never
+    // handed out so it marks the bottom of the stack.
     //--------------------------------------------------------------------------
-    if( !pFreeSIDs.empty() )
+    uint32_t head = pFreeHead.load( std::memory_order_acquire );
+    while( head & 0xffff )
     {
-      allocSID = pFreeSIDs.front();
-      pFreeSIDs.pop_front();
+      uint16_t top  = head & 0xffff;
+      uint32_t next = ( ( head + 0x10000 ) & 0xffff0000 ) |
+                      pNext[top].load( std::memory_order_relaxed );
+      if( pFreeHead.compare_exchange_weak( head, next,
+                                           std::memory_order_acquire,
+                                           std::memory_order_acquire ) )
+      {
+        pNumFree.fetch_sub( 1, std::memory_order_relaxed );
+        allocSID = top;
+        break;
+      }
     }
+
     //--------------------------------------------------------------------------
     // Allocate a new SID if possible
     //--------------------------------------------------------------------------
-    else
+    if( !allocSID )
     {
-      if( pSIDCeiling == 0xffff )
-        return Status( stError, errNoMoreFreeSIDs );
-      allocSID = pSIDCeiling++;
+      uint32_t ceiling = pSIDCeiling.load( std::memory_order_relaxed );
+      do
+      {
+        if( ceiling >= 0xffff )
+          return Status( stError, errNoMoreFreeSIDs );
+      }
+      while( !pSIDCeiling.compare_exchange_weak( ceiling, ceiling + 1,
+                                                 std::memory_order_relaxed ) );
+      allocSID = ceiling;
     }
 
     memcpy( sid, &allocSID, 2 );
@@ -56,10 +72,9 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   void SIDManager::ReleaseSID( uint8_t sid[2] )
   {
-    XrdSysMutexHelper scopedLock( pMutex );
     uint16_t relSID = 0;
     memcpy( &relSID, sid, 2 );
-    pFreeSIDs.push_back( relSID );
+    PushFree( relSID );
   }
 
   //----------------------------------------------------------------------------
@@ -96,7 +111,7 @@ namespace XrdCl
     uint16_t tiSID = 0;
     memcpy( &tiSID, sid, 2 );
     pTimeOutSIDs.erase( tiSID );
-    pFreeSIDs.push_back( tiSID );
+    PushFree( tiSID );
   }
 
   //------------------------------------------------------------------------
@@ -107,7 +122,7 @@ namespace XrdCl
     XrdSysMutexHelper scopedLock( pMutex );
     std::set<uint16_t>::iterator it;
     for( it = pTimeOutSIDs.begin(); it != pTimeOutSIDs.end(); ++it )
-      pFreeSIDs.push_back( *it );
+      PushFree( *it );
     pTimeOutSIDs.clear();
   }
 
@@ -117,6 +132,29 @@ namespace XrdCl
   uint16_t SIDManager::GetNumberOfAllocatedSIDs() const
   {
     XrdSysMutexHelper scopedLock( pMutex );
-    return pSIDCeiling - pFreeSIDs.size() - pTimeOutSIDs.size() - 1;
+    return pSIDCeiling.load( std::memory_order_relaxed ) -
+           pNumFree.load( std::memory_order_relaxed ) -
+           pTimeOutSIDs.size() - 1;
+  }
+
+  //----------------------------------------------------------------------------
+  // Push a SID onto the stack of free SIDs
+  //----------------------------------------------------------------------------
+  void SIDManager::PushFree( uint16_t sid )
+  {
+    if( !sid )
+      return;
+
+    uint32_t head = pFreeHead.load( std::memory_order_relaxed );
+    uint32_t next;
+    do
+    {
+      pNext[sid].store( head & 0xffff, std::memory_order_relaxed );
+      next = ( ( head + 0x10000 ) & 0xffff0000 ) | sid;
+    }
+    while( !pFreeHead.compare_exchange_weak( head, next,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed ) );
+    pNumFree.fetch_add( 1, std::memory_order_relaxed );
   }
 }
@@ -19,7 +19,7 @@
 #ifndef __XRD_CL_SID_MANAGER_HH__
 #define __XRD_CL_SID_MANAGER_HH__
 
-#include <list>
+#include <atomic>
 #include <set>
 #include <stdint.h>
 #include "XrdSys/XrdSysPthread.hh"
@@ -29,6 +29,12 @@ namespace XrdCl
 {
   //----------------------------------------------------------------------------
   //! Handle XRootD stream IDs
+  //!
+  //! Free SIDs are kept on a lock-free stack threaded through a SID-indexed
+  //! array of links so that allocating and releasing a SID takes no lock.
+  //! The stack head carries a generation tag in its upper 16 bits to guard
+  //! against ABA. Only the bookkeeping of timed out SIDs is protected by
+  //! the mutex.
   //----------------------------------------------------------------------------
   class SIDManager
   {
@@ -37,7 +43,16 @@ namespace XrdCl
       //------------------------------------------------------------------------
       //! Constructor
       //------------------------------------------------------------------------
-      SIDManager(): pSIDCeiling(1) {}
+      SIDManager(): pFreeHead(0), pSIDCeiling(1), pNumFree(0),
+                    pNext( new std::atomic<uint16_t>[0x10000] ) {}
+
+      //------------------------------------------------------------------------
+      //! Destructor
+      //------------------------------------------------------------------------
+      ~SIDManager()
+      {
+        delete [] pNext;
+      }
 
       //------------------------------------------------------------------------
       //! Allocate a SID
@@ -87,10 +102,17 @@ namespace XrdCl
       uint16_t GetNumberOfAllocatedSIDs() const;
 
     private:
-      std::list<uint16_t>  pFreeSIDs;
-      std::set<uint16_t>   pTimeOutSIDs;
-      uint16_t             pSIDCeiling;
-      mutable XrdSysMutex  pMutex;
+      SIDManager( const SIDManager & );
+      SIDManager &operator = ( const SIDManager & );
+
+      void PushFree( uint16_t sid );
+
+      std::atomic<uint32_t>  pFreeHead;
+      std::atomic<uint32_t>  pSIDCeiling;
+      std::atomic<uint32_t>  pNumFree;
+      std::atomic<uint16_t> *pNext;
+      std::set<uint16_t>     pTimeOutSIDs;
+      mutable XrdSysMutex    pMutex;
   };
 }
 
@@ -19,6 +19,7 @@
 #include "XrdCl/XrdClSocket.hh"
 #include "XrdCl/XrdClUtils.hh"
 #include "XrdNet/XrdNetConnect.hh"
+#include "XrdNet/XrdNetSocket.hh"
 #include "XrdCl/XrdClConstants.hh"
 #include "XrdCl/XrdClMessage.hh"
 #include "XrdCl/XrdClDefaultEnv.hh"
@@ -198,6 +199,57 @@ namespace XrdCl
 
     pServerAddr = addr;
 
+    //--------------------------------------------------------------------------
+    // Tune the socket for the class of network the server is on, this needs
+    // to happen before connecting for the window to be negotiated
+    //--------------------------------------------------------------------------
+    XrdCl::Env *env = XrdCl::DefaultEnv::GetEnv();
+    std::string pfx = pServerAddr.isPrivate() ? "Lan" : "Wan";
+    XrdNetSocket::TuneParms tune;
+    int val = DefaultTCPNotSentLowat;
+    env->GetInt( pfx + "TCPNotSentLowat", val );
+    tune.lowat = val;
+    val = DefaultTCPPacingRate;
+    env->GetInt( pfx + "TCPPacingRate", val );
+    tune.pacing = val;
+    val = DefaultTCPWindow;
+    env->GetInt( pfx + "TCPWindow", val );
+    tune.window = val;
+    std::string cc = DefaultTCPCongestion;
+    env->GetString( pfx + "TCPCongestion", cc );
+    if( cc.size() < sizeof( tune.cc ) )
+      strcpy( tune.cc, cc.c_str() );
+    if( tune.isSet() && XrdNetSocket::setTune( pSocket, tune ) )
+    {
+      char nameBuff[256];
+      pServerAddr.Format( nameBuff, sizeof( nameBuff ), XrdNetAddr::fmtAdv6 );
+      Log *log = DefaultEnv::GetLog();
+      log->Warning( PostMasterMsg, "Unable to apply all of the %s TCP tuning "
+                    "to the socket connecting to %s", pfx.c_str(), nameBuff );
+    }
+
+    //--------------------------------------------------------------------------
+    // With TCP Fast Open the connect returns immediately and the first bytes
+    // we write (the handshake) are carried in the SYN, if the server has
+    // given us a cookie before; otherwise the kernel falls back to the usual
+    // three-way handshake
+    //--------------------------------------------------------------------------
+#ifdef TCP_FASTOPEN_CONNECT
+    val = DefaultTCPFastOpen;
+    env->GetInt( "TCPFastOpen", val );
+    if( val )
+    {
+      int one = 1;
+      if( ::setsockopt( pSocket, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &one,
+                        sizeof( one ) ) < 0 )
+      {
+        Log *log = DefaultEnv::GetLog();
+        log->Debug( PostMasterMsg, "Unable to enable TCP Fast Open: %s",
+                    strerror( errno ) );
+      }
+    }
+#endif
+
     //--------------------------------------------------------------------------
     // Connect
     //--------------------------------------------------------------------------
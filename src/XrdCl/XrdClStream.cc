@@ -38,6 +38,7 @@
 
 #include <sys/types.h>
 #include <algorithm>
+#include <iterator>
 #include <sys/socket.h>
 #include <sys/time.h>
 
@@ -144,6 +145,9 @@ namespace XrdCl
 
     pAddressType = Utils::String2AddressType( netStack );
 
+    pConnectionRace    = Utils::GetIntParameter( *url, "ConnectionRace",
+                                                 DefaultConnectionRace );
+
     Log *log = DefaultEnv::GetLog();
     log->Debug( PostMasterMsg, "[%s] Stream parameters: Network Stack: %s, "
                 "Connection Window: %d, ConnectionRetry: %d, Stream Error "
@@ -261,8 +265,7 @@ namespace XrdCl
 
     while( !pAddresses.empty() )
     {
-      pSubStreams[0]->socket->SetAddress( pAddresses.back() );
-      pAddresses.pop_back();
+      SetNextAddress();
       pConnectionInitTime = ::time( 0 );
       st = pSubStreams[0]->socket->Connect( pConnectionWindow );
       if( st.IsOK() )
@@ -404,6 +407,15 @@ namespace
     private:
       XrdCl::Stream *pStream;
   };
+
+  //----------------------------------------------------------------------------
+  // Check whether the address is reached over IPv4
+  //----------------------------------------------------------------------------
+  bool IsIPv4( const XrdNetAddr &addr )
+  {
+    return addr.isIPType( XrdNetAddrInfo::IPv4 ) ||
+           ( addr.isIPType( XrdNetAddrInfo::IPv6 ) && addr.isMapped() );
+  }
 }
 
 namespace XrdCl
@@ -679,8 +691,7 @@ namespace XrdCl
       Status st;
       do
       {
-        pSubStreams[0]->socket->SetAddress( pAddresses.back() );
-        pAddresses.pop_back();
+        SetNextAddress();
         pConnectionInitTime = ::time( 0 );
         st = pSubStreams[0]->socket->Connect( pConnectionWindow );
       }
@@ -726,6 +737,34 @@ namespace XrdCl
     OnFatalError( subStream, status, scopedLock );
   }
 
+  //----------------------------------------------------------------------------
+  // Pick the next address to connect the main stream to
+  //----------------------------------------------------------------------------
+  void Stream::SetNextAddress()
+  {
+    AsyncSocketHandler *socket = pSubStreams[0]->socket;
+    socket->SetAddress( pAddresses.back() );
+    pAddresses.pop_back();
+    socket->ClearRaceAddress();
+
+    if( !pConnectionRace )
+      return;
+
+    //--------------------------------------------------------------------------
+    // The addresses are sorted by preference, so the best candidate of the
+    // other family is the one closest to the back
+    //--------------------------------------------------------------------------
+    bool isIPv4 = IsIPv4( socket->GetAddress() );
+    std::vector<XrdNetAddr>::reverse_iterator itr;
+    for( itr = pAddresses.rbegin(); itr != pAddresses.rend(); ++itr )
+      if( IsIPv4( *itr ) != isIPv4 )
+      {
+        socket->SetRaceAddress( *itr );
+        pAddresses.erase( std::next( itr ).base() );
+        return;
+      }
+  }
+
   //----------------------------------------------------------------------------
   // Call back when an error has occurred
   //----------------------------------------------------------------------------
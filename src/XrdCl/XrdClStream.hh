@@ -300,6 +300,12 @@ namespace XrdCl
                          Status             status,
                          XrdSysMutexHelper &lock );
 
+      //------------------------------------------------------------------------
+      //! Pick the next address to connect the main stream to and the address
+      //! of the other family to race against it, if enabled
+      //------------------------------------------------------------------------
+      void SetNextAddress();
+
       //------------------------------------------------------------------------
       //! Inform the monitoring about disconnection
       //------------------------------------------------------------------------
@@ -334,6 +340,7 @@ namespace XrdCl
       uint16_t                       pConnectionWindow;
       SubStreamList                  pSubStreams;
       std::vector<XrdNetAddr>        pAddresses;
+      bool                           pConnectionRace;
       Utils::AddressType             pAddressType;
       ChannelHandlerList             pChannelEvHandlers;
       uint64_t                       pSessionId;
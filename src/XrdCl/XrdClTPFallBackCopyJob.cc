@@ -79,6 +79,7 @@ namespace XrdCl
       pJob = new ClassicCopyJob( pJobId, pProperties, pResults );
     else
       return st;
+    pJob->SetBufferPool( pBufferPool );
 
     //--------------------------------------------------------------------------
     // Run the job
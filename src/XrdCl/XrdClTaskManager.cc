@@ -44,7 +44,8 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   // Constructor
   //----------------------------------------------------------------------------
-  TaskManager::TaskManager(): pResolution(1), pRunnerThread(0), pRunning(false)
+  TaskManager::TaskManager(): pResolution(1), pWheel( time(0) ),
+    pRunnerThread(0), pRunning(false), pStopping(false), pWakeUp(0)
   {}
 
   //----------------------------------------------------------------------------
@@ -52,10 +53,21 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   TaskManager::~TaskManager()
   {
-    TaskSet::iterator  it, itE;
+    TaskMap::iterator it;
     for( it = pTasks.begin(); it != pTasks.end(); ++it )
-      if( it->own )
-        delete it->task;
+    {
+      if( it->second->own )
+        delete it->first;
+      delete it->second;
+    }
+
+    SoonMap::iterator sIt;
+    for( sIt = pSoon.begin(); sIt != pSoon.end(); ++sIt )
+    {
+      if( sIt->second->own )
+        delete sIt->second->task;
+      delete sIt->second;
+    }
   }
 
   //----------------------------------------------------------------------------
@@ -73,6 +85,7 @@ namespace XrdCl
       return false;
     }
 
+    pStopping = false;
     int ret = ::pthread_create( &pRunnerThread, 0, ::RunRunnerThread, this );
     if( ret != 0 )
     {
@@ -99,12 +112,15 @@ namespace XrdCl
       return false;
     }
 
-    if( ::pthread_cancel( pRunnerThread ) != 0 )
-    {
-      log->Error( TaskMgrMsg, "Unable to cancel the task runner thread: %s",
-                  strerror( errno ) );
-      return false;
-    }
+    //--------------------------------------------------------------------------
+    // The runner checks the flag whenever it goes to sleep so it has to be
+    // woken up rather than cancelled; it may be asleep on the condition
+    // variable which it would otherwise leave locked.
+    //--------------------------------------------------------------------------
+    pWakeUp.Lock();
+    pStopping = true;
+    pWakeUp.Signal();
+    pWakeUp.UnLock();
 
     void *threadRet;
     int ret = pthread_join( pRunnerThread, (void **)&threadRet );
@@ -131,7 +147,49 @@ namespace XrdCl
                 task->GetName().c_str(), Utils::TimeToString(time).c_str() );
 
     XrdSysMutexHelper scopedLock( pMutex );
-    pTasks.insert( TaskHelper( task, time, own ) );
+    TaskHelper *&th = pTasks[task];
+    if( !th ) th = new TaskHelper( task, own );
+    else th->own = own;
+    pWheel.Add( th, time );
+  }
+
+  //----------------------------------------------------------------------------
+  // Run the given task after the given number of milliseconds
+  //----------------------------------------------------------------------------
+  void TaskManager::RegisterTaskMs( Task *task, uint32_t delay, bool own )
+  {
+    Log *log = DefaultEnv::GetLog();
+
+    log->Debug( TaskMgrMsg, "Registering task: \"%s\" to be run in %u ms",
+                task->GetName().c_str(), delay );
+
+    uint64_t due = NowMs() + delay;
+    bool     earliest;
+
+    pMutex.Lock();
+    earliest = pSoon.empty() || due < pSoon.begin()->first;
+    pSoon.insert( std::make_pair( due, new TaskHelper( task, own ) ) );
+    pMutex.UnLock();
+
+    //--------------------------------------------------------------------------
+    // The runner may be sleeping past the new deadline
+    //--------------------------------------------------------------------------
+    if( earliest )
+    {
+      pWakeUp.Lock();
+      pWakeUp.Signal();
+      pWakeUp.UnLock();
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Monotonic clock in milliseconds
+  //----------------------------------------------------------------------------
+  uint64_t TaskManager::NowMs()
+  {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return uint64_t( ts.tv_sec ) * 1000 + ts.tv_nsec / 1000000;
   }
 
   //--------------------------------------------------------------------------
@@ -153,44 +211,43 @@ namespace XrdCl
   {
     Log *log = DefaultEnv::GetLog();
 
-    //--------------------------------------------------------------------------
-    // We want the thread to be cancelable only when we sleep between tasks
-    // execution
-    //--------------------------------------------------------------------------
-    pthread_setcanceltype( PTHREAD_CANCEL_DEFERRED, 0 );
-
     for(;;)
     {
-      pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, 0 );
       pMutex.Lock();
 
       //------------------------------------------------------------------------
-      // Remove the tasks from the active set - super inefficient,
-      // but, hopefully, never really necessary. We first need to build a list
-      // of iterators because it is impossible to remove elements from
-      // a multiset when iterating over it
+      // Remove the tasks from the wheel. Tasks that are not there have either
+      // completed or are just being run, in the latter case they are back
+      // in the wheel by the next round.
       //------------------------------------------------------------------------
       TaskList::iterator listIt = pToBeUnregistered.begin();
-      TaskSet::iterator  it, itE;
-      std::list<TaskSet::iterator> iteratorList;
-      std::list<TaskSet::iterator>::iterator itRem;
+      TaskMap::iterator  it;
       for( ; listIt != pToBeUnregistered.end(); ++listIt )
       {
-        for( it = pTasks.begin(); it != pTasks.end(); ++it )
-        {
-          if( it->task == *listIt )
-            iteratorList.push_back( it );
-        }
+        it = pTasks.find( *listIt );
+        if( it == pTasks.end() )
+          continue;
+        TaskHelper *th = it->second;
+        log->Debug( TaskMgrMsg, "Removing task: \"%s\"", th->task->GetName().c_str() );
+        pWheel.Cancel( th );
+        pTasks.erase( it );
+        if( th->own )
+          delete th->task;
+        delete th;
       }
 
-      for( itRem = iteratorList.begin(); itRem != iteratorList.end(); ++itRem )
+      for( listIt = pToBeUnregistered.begin();
+           listIt != pToBeUnregistered.end() && !pSoon.empty(); ++listIt )
       {
-        Task *tsk = (*itRem)->task;
-        bool  own = (*itRem)->own;
-        log->Debug( TaskMgrMsg, "Removing task: \"%s\"", tsk->GetName().c_str() );
-        pTasks.erase( *itRem );
-        if( own )
-          delete tsk;
+        SoonMap::iterator sIt = pSoon.begin();
+        while( sIt != pSoon.end() )
+        {
+          if( sIt->second->task != *listIt ) { ++sIt; continue; }
+          if( sIt->second->own )
+            delete sIt->second->task;
+          delete sIt->second;
+          pSoon.erase( sIt++ );
+        }
       }
 
       pToBeUnregistered.clear();
@@ -198,50 +255,85 @@ namespace XrdCl
       //------------------------------------------------------------------------
       // Select the tasks to be run
       //------------------------------------------------------------------------
-      time_t                          now = time(0);
-      std::list<TaskHelper>           toRun;
-      std::list<TaskHelper>::iterator trIt;
+      time_t                   now = time(0);
+      std::list<TaskHelper*>   toRun;
+      XrdSysTimerWheel::Entry *ep  = pWheel.Expire( now );
 
-      it  = pTasks.begin();
-      itE = pTasks.upper_bound( TaskHelper( 0, now ) );
-
-      for( ; it != itE; ++it )
-        toRun.push_back( TaskHelper( it->task, 0, it->own ) );
+      for( ; ep; ep = ep->Next() )
+      {
+        TaskHelper *th = static_cast<TaskHelper*>( ep );
+        pTasks.erase( th->task );
+        toRun.push_back( th );
+      }
 
-      pTasks.erase( pTasks.begin(), itE );
+      uint64_t nowMs = NowMs();
+      while( !pSoon.empty() && pSoon.begin()->first <= nowMs )
+      {
+        toRun.push_back( pSoon.begin()->second );
+        pSoon.erase( pSoon.begin() );
+      }
       pMutex.UnLock();
 
       //------------------------------------------------------------------------
-      // Run the tasks and reinsert them if necessary
+      // Run the tasks and reinsert them if necessary. A task registered again
+      // while it was running keeps the new registration.
       //------------------------------------------------------------------------
+      std::list<TaskHelper*>::iterator trIt;
       for( trIt = toRun.begin(); trIt != toRun.end(); ++trIt )
       {
+        TaskHelper *th = *trIt;
         log->Dump( TaskMgrMsg, "Running task: \"%s\"",
-                   trIt->task->GetName().c_str() );
-        time_t schedule = trIt->task->Run( now );
+                   th->task->GetName().c_str() );
+        time_t schedule = th->task->Run( now );
         if( schedule )
         {
           log->Dump( TaskMgrMsg, "Will rerun task \"%s\" at [%s]",
-                     trIt->task->GetName().c_str(),
+                     th->task->GetName().c_str(),
                      Utils::TimeToString(schedule).c_str() );
           pMutex.Lock();
-          pTasks.insert( TaskHelper( trIt->task, schedule, trIt->own ) );
+          TaskHelper *&slot = pTasks[th->task];
+          if( !slot )
+          {
+            slot = th;
+            pWheel.Add( th, schedule );
+          }
+          else delete th;
           pMutex.UnLock();
         }
         else
         {
           log->Debug( TaskMgrMsg, "Done with task: \"%s\"",
-                      trIt->task->GetName().c_str() );
-          if( trIt->own )
-            delete trIt->task;
+                      th->task->GetName().c_str() );
+          pMutex.Lock();
+          bool again = pTasks.count( th->task );
+          pMutex.UnLock();
+          if( th->own && !again )
+            delete th->task;
+          delete th;
         }
       }
 
       //------------------------------------------------------------------------
-      // Enable the cancelation and go to sleep
+      // Sleep until the next tick or until the earliest short delay task is
+      // due, whichever comes first. Registering an earlier one, or stopping
+      // the manager, wakes us up.
       //------------------------------------------------------------------------
-      pthread_setcancelstate( PTHREAD_CANCEL_ENABLE, 0 );
-      XrdSysTimer::Wait( pResolution*1000 );
+      int waitMs = pResolution*1000;
+      pWakeUp.Lock();
+      pMutex.Lock();
+      if( !pSoon.empty() )
+      {
+        uint64_t due = pSoon.begin()->first;
+        nowMs = NowMs();
+        if( due <= nowMs ) waitMs = 0;
+        else if( due - nowMs < (uint64_t)waitMs ) waitMs = due - nowMs;
+      }
+      pMutex.UnLock();
+
+      if( !pStopping && waitMs > 0 ) pWakeUp.WaitMS( waitMs );
+      bool stop = pStopping;
+      pWakeUp.UnLock();
+      if( stop ) return;
     }
   }
 }
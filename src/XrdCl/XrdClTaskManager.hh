@@ -22,10 +22,13 @@
 #include <ctime>
 #include <set>
 #include <list>
+#include <map>
 #include <string>
+#include <unordered_map>
 #include <stdint.h>
 #include <pthread.h>
 #include "XrdSys/XrdSysPthread.hh"
+#include "XrdSys/XrdSysTimerWheel.hh"
 
 namespace XrdCl
 {
@@ -98,7 +101,8 @@ namespace XrdCl
       bool Stop();
 
       //------------------------------------------------------------------------
-      //! Run the given task at the given time.
+      //! Run the given task at the given time. Registering a task that is
+      //! already registered moves it to the new time.
       //!
       //! @param task task to be run
       //! @param time time at which the task should be run
@@ -107,6 +111,18 @@ namespace XrdCl
       //------------------------------------------------------------------------
       void RegisterTask( Task *task, time_t time, bool own = true );
 
+      //------------------------------------------------------------------------
+      //! Run the given task after the given number of milliseconds. Unlike
+      //! the tasks above these are not bound to the one second resolution of
+      //! the task wheel. The task must not be registered already.
+      //!
+      //! @param task  task to be run
+      //! @param delay delay in milliseconds
+      //! @param own   determines whether the task object should be destroyed
+      //!              when no longer needed
+      //------------------------------------------------------------------------
+      void RegisterTaskMs( Task *task, uint32_t delay, bool own = true );
+
       //------------------------------------------------------------------------
       //! Remove a task, the unregistration process is asynchronous and may
       //! be performed at any point in the future, the function just queues
@@ -123,38 +139,36 @@ namespace XrdCl
     private:
 
       //------------------------------------------------------------------------
-      // Task set helpers
+      // Task wheel helpers, the tasks are kept in a timer wheel (in seconds)
+      // so that registering and removing one is O(1)
       //------------------------------------------------------------------------
-      struct TaskHelper
+      struct TaskHelper: public XrdSysTimerWheel::Entry
       {
-        TaskHelper( Task *tsk, time_t tme, bool ow = true ):
-          task(tsk), execTime(tme), own(ow) {}
+        TaskHelper( Task *tsk, bool ow = true ): task(tsk), own(ow) {}
         Task   *task;
-        time_t  execTime;
         bool    own;
       };
 
-      struct TaskHelperCmp
-      {
-        bool operator () ( const TaskHelper &th1, const TaskHelper &th2 ) const
-        {
-          return th1.execTime < th2.execTime;
-        }
-      };
+      typedef std::unordered_map<Task*, TaskHelper*> TaskMap;
+      typedef std::list<Task*>                        TaskList;
+      typedef std::multimap<uint64_t, TaskHelper*>    SoonMap;
 
-      typedef std::multiset<TaskHelper, TaskHelperCmp> TaskSet;
-      typedef std::list<Task*>                         TaskList;
+      static uint64_t NowMs();
 
       //------------------------------------------------------------------------
       // Private variables
       //------------------------------------------------------------------------
-      uint16_t    pResolution;
-      TaskSet     pTasks;
-      TaskList    pToBeUnregistered;
-      pthread_t   pRunnerThread;
-      bool        pRunning;
-      XrdSysMutex pMutex;
-      XrdSysMutex pOpMutex;
+      uint16_t         pResolution;
+      XrdSysTimerWheel pWheel;
+      TaskMap          pTasks;
+      TaskList         pToBeUnregistered;
+      SoonMap          pSoon;
+      pthread_t        pRunnerThread;
+      bool             pRunning;
+      bool             pStopping;
+      XrdSysMutex      pMutex;
+      XrdSysMutex      pOpMutex;
+      XrdSysCondVar    pWakeUp;
   };
 }
 
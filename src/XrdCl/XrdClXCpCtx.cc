@@ -68,6 +68,7 @@ XCpSrc* XCpCtx::WeakestLink( XCpSrc *exclude )
   uint64_t transferRate = -1; // set transferRate to max uint64 value
   XCpSrc *ret = 0;
 
+  XrdSysMutexHelper lck( pMtx );
   std::list<XCpSrc*>::iterator itr;
   for( itr = pSources.begin() ; itr != pSources.end() ; ++itr )
   {
@@ -84,6 +85,24 @@ XCpSrc* XCpCtx::WeakestLink( XCpSrc *exclude )
   return ret;
 }
 
+uint64_t XCpCtx::BestRate( XCpSrc *exclude )
+{
+  uint64_t transferRate = 0;
+
+  XrdSysMutexHelper lck( pMtx );
+  std::list<XCpSrc*>::iterator itr;
+  for( itr = pSources.begin() ; itr != pSources.end() ; ++itr )
+  {
+    XCpSrc *src = *itr;
+    if( src == exclude || !src->IsRunning() ) continue;
+    uint64_t tmp = src->TransferRate();
+    if( tmp > transferRate )
+      transferRate = tmp;
+  }
+
+  return transferRate;
+}
+
 void XCpCtx::PutChunk( ChunkInfo* chunk )
 {
   pSink.Put( chunk );
@@ -174,12 +193,12 @@ void XCpCtx::NotifyIdleSrc()
   pDoneCV.Broadcast();
 }
 
-bool XCpCtx::AllDone()
+bool XCpCtx::AllDone( int timeout )
 {
   XrdSysCondVarHelper lck( pDoneCV );
 
   if( !pDone )
-    pDoneCV.Wait( 60 );
+    pDoneCV.Wait( timeout );
 
   return pDone;
 }
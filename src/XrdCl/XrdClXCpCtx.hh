@@ -90,6 +90,15 @@ class XCpCtx
      */
     bool GetNextUrl( std::string & url );
 
+    /**
+     * @return : true if there are replicas that have not been tried yet
+     */
+    bool HasNextUrl()
+    {
+      XrdSysMutexHelper lck( pMtx );
+      return !pUrls.empty();
+    }
+
     /**
      * Get the 'weakest' sources
      *
@@ -99,6 +108,16 @@ class XCpCtx
      */
     XCpSrc* WeakestLink( XCpSrc *exclude );
 
+    /**
+     * Get the transfer rate of the fastest running source
+     *
+     * @param exclude : the source that is excluded from the
+     *                  search
+     * @return        : the transfer rate [B/s], 0 if there is
+     *                  no other running source
+     */
+    uint64_t BestRate( XCpSrc *exclude );
+
     /**
      * Put a chunk into the sink
      *
@@ -182,12 +201,13 @@ class XCpCtx
     /**
      * Returns true if all chunks have been transfered,
      * otherwise blocks until NotifyIdleSrc is called,
-     * or a 1 minute timeout occurs.
+     * or the timeout occurs.
      *
-     * @return : true is all chunks have been transfered,
-     *           false otherwise.
+     * @param timeout : the timeout [s]
+     * @return        : true is all chunks have been transfered,
+     *                  false otherwise.
      */
-    bool AllDone();
+    bool AllDone( int timeout );
 
     /**
      * Notify those who are waiting for initialization.
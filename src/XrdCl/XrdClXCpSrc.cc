@@ -30,6 +30,32 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <time.h>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Tuning of the rebalancing between the sources:
+  // - a source checks every RebalanceInterval seconds whether to take over
+  //   work from a slower one, once it has been transferring for Warmup
+  //   seconds; idle sources look for work to steal just as often
+  // - a source that is SlowRatio times slower than the fastest is abandoned
+  // - a chunk should take ChunkTime us to transfer, or ChunkRTTs times the
+  //   shortest chunk latency if that is longer
+  //----------------------------------------------------------------------------
+  const time_t   RebalanceInterval = 5;
+  const time_t   Warmup            = 10;
+  const uint64_t SlowRatio         = 10;
+  const uint64_t ChunkTime         = 500000;
+  const uint64_t ChunkRTTs         = 8;
+
+  uint64_t Now()
+  {
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  }
+}
 
 namespace XrdCl
 {
@@ -39,7 +65,8 @@ class ChunkHandler: public ResponseHandler
   public:
 
     ChunkHandler( XCpSrc *src, uint64_t offset, uint64_t size, char *buffer, File *handle ) :
-      pSrc( src->Self() ), pOffset( offset ), pSize( size ), pBuffer( buffer ), pHandle( handle )
+      pSrc( src->Self() ), pOffset( offset ), pSize( size ), pBuffer( buffer ), pHandle( handle ),
+      pIssued( Now() )
     {
 
     }
@@ -76,7 +103,7 @@ class ChunkHandler: public ResponseHandler
         chunk = 0;
       }
 
-      pSrc->ReportResponse( status, chunk, pHandle );
+      pSrc->ReportResponse( status, chunk, pHandle, Now() - pIssued );
 
       delete this;
     }
@@ -88,11 +115,13 @@ class ChunkHandler: public ResponseHandler
     uint64_t           pSize;
     char              *pBuffer;
     File              *pHandle;
+    uint64_t           pIssued;
 };
 
 
 XCpSrc::XCpSrc( uint32_t chunkSize, uint8_t parallel, int64_t fileSize, XCpCtx *ctx ) :
-  pChunkSize( chunkSize ), pParallel( parallel ), pFileSize( fileSize ), pThread(),
+  pChunkSize( chunkSize ), pDefChunkSize( chunkSize ), pMinLatency( 0 ), pNextCheck( 0 ),
+  pParallel( parallel ), pFileSize( fileSize ), pThread(),
   pCtx( ctx->Self() ), pFile( 0 ), pCurrentOffset( 0 ), pBlkEnd( 0 ), pDataTransfered( 0 ), pRefCount( 1 ),
   pRunning( false ), pStartTime( 0 ), pTransferTime( 0 )
 {
@@ -144,6 +173,7 @@ void XCpSrc::StartDownloading()
 
   // start counting transfer time
   pStartTime = time( 0 );
+  pNextCheck = pStartTime + Warmup;
 
   while( pRunning )
   {
@@ -164,11 +194,10 @@ void XCpSrc::StartDownloading()
       // check if the overall download process is
       // done, this makes the thread wait until
       // either the download is done, or a source
-      // went to error, or a 60s timeout has been
-      // reached (the timeout is there so we can
-      // check if a source degraded in the meanwhile
-      // and now we can steal from it)
-      if( !pCtx->AllDone() )
+      // went to error, or the rebalance interval
+      // passed (so we can check if a source degraded
+      // in the meanwhile and now we can steal from it)
+      if( !pCtx->AllDone( RebalanceInterval ) )
       {
         // reset start time after pause
         pStartTime = time( 0 );
@@ -190,25 +219,35 @@ void XCpSrc::StartDownloading()
       if( !Recover().IsOK() )
       {
         delete status;
-        pRunning = false;
-        // notify idle sources, they might be
-        // interested in taking over my workload
-        pCtx->NotifyIdleSrc();
-        // put a null chunk so we are sure
-        // the main thread doesn't get stuck
-        // at the sync queue
-        pCtx->PutChunk( 0 );
-        // if we have data we need to wait for someone to take over
-        // unless the extreme copy is over, in this case we don't care
-        while( HasData() && !pCtx->AllDone() );
-
+        Retire();
         return;
       }
     }
     delete status;
+
+    if( time( 0 ) >= pNextCheck && !Rebalance() )
+    {
+      Retire();
+      return;
+    }
   }
 }
 
+void XCpSrc::Retire()
+{
+  pRunning = false;
+  // notify idle sources, they might be
+  // interested in taking over my workload
+  pCtx->NotifyIdleSrc();
+  // put a null chunk so we are sure
+  // the main thread doesn't get stuck
+  // at the sync queue
+  pCtx->PutChunk( 0 );
+  // if we have data we need to wait for someone to take over
+  // unless the extreme copy is over, in this case we don't care
+  while( HasData() && !pCtx->AllDone( RebalanceInterval ) );
+}
+
 XRootDStatus XCpSrc::Initialize()
 {
   Log *log = DefaultEnv::GetLog();
@@ -300,6 +339,9 @@ XRootDStatus XCpSrc::Recover()
   pTransferTime   = 0;
   pStartTime      = time( 0 );
   pDataTransfered = 0;
+  pNextCheck      = pStartTime + Warmup;
+  pMinLatency     = 0;
+  pChunkSize      = pDefChunkSize;
 
   return st;
 }
@@ -323,11 +365,13 @@ XRootDStatus XCpSrc::ReadChunks()
     {
       delete[] buffer;
       delete   handler;
-      ReportResponse( new XRootDStatus( st ), 0, pFile );
+      ReportResponse( new XRootDStatus( st ), 0, pFile, 0 );
       return st;
     }
   }
 
+  AdjustChunkSize();
+
   while( pOngoing.size() < pParallel && pCurrentOffset < pBlkEnd )
   {
     uint64_t chunkSize = pChunkSize;
@@ -342,7 +386,7 @@ XRootDStatus XCpSrc::ReadChunks()
     {
       delete[] buffer;
       delete   handler;
-      ReportResponse( new XRootDStatus( st ), 0, pFile );
+      ReportResponse( new XRootDStatus( st ), 0, pFile, 0 );
       return st;
     }
   }
@@ -354,7 +398,8 @@ XRootDStatus XCpSrc::ReadChunks()
   return XRootDStatus( stOK, suContinue );
 }
 
-void XCpSrc::ReportResponse( XRootDStatus *status, ChunkInfo *chunk, File *handle )
+void XCpSrc::ReportResponse( XRootDStatus *status, ChunkInfo *chunk, File *handle,
+                             uint64_t latency )
 {
   XrdSysMutexHelper lck( pMtx );
   bool ignore = false;
@@ -367,6 +412,13 @@ void XCpSrc::ReportResponse( XRootDStatus *status, ChunkInfo *chunk, File *handl
     // response (this could happen due to
     // source change or stealing)
     ignore = !pOngoing.erase( chunk->offset );
+    if( !ignore )
+    {
+      pDataTransfered += chunk->length;
+      if( FilesEqual( pFile, handle ) && latency &&
+          ( !pMinLatency || latency < pMinLatency ) )
+        pMinLatency = latency;
+    }
   }
   else if( FilesEqual( pFile, handle ) )
   {
@@ -409,17 +461,141 @@ void XCpSrc::ReportResponse( XRootDStatus *status, ChunkInfo *chunk, File *handl
   }
 
   if( chunk )
-  {
-    pDataTransfered += chunk->length;
     pCtx->PutChunk( chunk );
+}
+
+void XCpSrc::AdjustChunkSize()
+{
+  // wait for the transfer rate to settle
+  time_t duration = pTransferTime + time( 0 ) - pStartTime;
+  uint64_t rate = TransferRate();
+  if( duration < 2 || !rate ) return;
+
+  // the parallel chunks share the transfer rate, so a chunk of the
+  // optimal size takes 'target' us to arrive
+  uint64_t target = ChunkTime;
+  if( pMinLatency * ChunkRTTs > target ) target = pMinLatency * ChunkRTTs;
+  uint64_t optimal = static_cast<uint64_t>( double( rate ) * target / 1000000 / pParallel );
+
+  uint64_t minSize = pDefChunkSize / 16, maxSize = uint64_t( pDefChunkSize ) * 2;
+  if( minSize < 65536 ) minSize = ( pDefChunkSize < 65536 ? pDefChunkSize : 65536 );
+  if( maxSize > 0x7fffffff ) maxSize = 0x7fffffff;
+  if( optimal < minSize ) optimal = minSize;
+  if( optimal > maxSize ) optimal = maxSize;
+
+  // move half way towards the optimum, so we do not overreact,
+  // and keep the chunks page multiples
+  uint64_t size = ( uint64_t( pChunkSize ) + optimal ) / 2;
+  if( size > 4096 ) size &= ~uint64_t( 4095 );
+  pChunkSize = static_cast<uint32_t>( size );
+}
+
+bool XCpSrc::Rebalance()
+{
+  Log *log = DefaultEnv::GetLog();
+  pNextCheck = time( 0 ) + RebalanceInterval;
+
+  // give up on this source if it is far slower than the fastest one,
+  // either there are spare replicas or the others will take over
+  uint64_t myRate = TransferRate(), bestRate = pCtx->BestRate( this );
+  if( myRate * SlowRatio < bestRate )
+  {
+    std::string myHost = URL( pUrl ).GetHostName();
+    log->Warning( UtilityMsg, "%s is too slow (%llu B/s, fastest source "
+                  "%llu B/s), abandoning it", myHost.c_str(),
+                  (unsigned long long)myRate, (unsigned long long)bestRate );
+
+    if( !pCtx->HasNextUrl() ) return false;
+
+    // close the file once the outstanding reads come back, exactly
+    // as if the file had failed
+    XrdSysMutexHelper lck( pMtx );
+    if( pFile )
+    {
+      if( pOngoing.empty() )
+      {
+        XRootDStatus st = pFile->Close();
+        delete pFile;
+      }
+      else pFailed[pFile] = pOngoing.size();
+      pFile = 0;
+    }
+    lck.UnLock();
+
+    return Recover().IsOK();
   }
+
+  Share( pCtx->WeakestLink( this ) );
+  return true;
+}
+
+void XCpSrc::Share( XCpSrc *src )
+{
+  if( !src ) return;
+
+  // lock in a fixed order, the other source may be doing the same
+  XrdSysMutexHelper lck1( this < src ? pMtx : src->pMtx ),
+                    lck2( this < src ? src->pMtx : pMtx );
+
+  Log *log = DefaultEnv::GetLog();
+  std::string myHost = URL( pUrl ).GetHostName(), srcHost = URL( src->pUrl ).GetHostName();
+
+  uint64_t steal, stealEnd = src->pBlkEnd;
+
+  if( !src->pRunning )
+  {
+    // the source has stopped, we take over everything
+    pRecovered.insert( src->pOngoing.begin(),   src->pOngoing.end() );
+    pRecovered.insert( src->pRecovered.begin(), src->pRecovered.end() );
+    src->pOngoing.clear();
+    src->pRecovered.clear();
+    steal = ( src->pCurrentOffset < src->pBlkEnd ? src->pBlkEnd - src->pCurrentOffset : 0 );
+    src->pCurrentOffset = 0;
+    src->pBlkEnd = 0;
+    pCtx->NotifyIdleSrc();
+
+    log->Debug( UtilityMsg, "%s: Taking over everything from %s", myHost.c_str(), srcHost.c_str() );
+  }
+  else
+  {
+    // we only take unrequested data from the end of its block, enough
+    // for both of us to be done at the same time at the current rates
+    uint64_t myRate = TransferRate(), srcRate = src->TransferRate();
+    if( src->pCurrentOffset >= src->pBlkEnd || myRate <= srcRate ) return;
+
+    uint64_t myData = ( pCurrentOffset < pBlkEnd ? pBlkEnd - pCurrentOffset : 0 );
+    std::map<uint64_t, uint64_t>::iterator itr;
+    for( itr = pRecovered.begin(); itr != pRecovered.end(); ++itr )
+      myData += itr->second;
+    for( itr = pOngoing.begin(); itr != pOngoing.end(); ++itr )
+      myData += itr->second;
+
+    uint64_t srcData = src->pBlkEnd - src->pCurrentOffset;
+    double share = ( double( srcData ) * myRate - double( myData ) * srcRate )
+                   / double( myRate + srcRate );
+
+    // not worth it for less than a couple of chunks
+    if( share < 2.0 * pChunkSize ) return;
+    steal = static_cast<uint64_t>( share );
+    if( srcData - steal < src->pChunkSize ) steal = srcData;
+    src->pBlkEnd -= steal;
+
+    log->Debug( UtilityMsg, "%s: Taking over %llu bytes from %s", myHost.c_str(),
+                (unsigned long long)steal, srcHost.c_str() );
+  }
+
+  // add the data to our recovered chunks
+  for( uint64_t offset = stealEnd - steal; offset < stealEnd; offset += pChunkSize )
+    pRecovered[offset] = ( stealEnd - offset < pChunkSize ? stealEnd - offset : pChunkSize );
 }
 
 void XCpSrc::Steal( XCpSrc *src )
 {
   if( !src ) return;
 
-  XrdSysMutexHelper lck1( pMtx ), lck2( src->pMtx );
+  // lock in a fixed order, the other source may be doing the same
+  XrdSysMutexHelper lck1( this < src ? pMtx : src->pMtx ),
+                    lck2( this < src ? src->pMtx : pMtx );
 
   Log *log = DefaultEnv::GetLog();
   std::string myHost = URL( pUrl ).GetHostName(), srcHost = URL( src->pUrl ).GetHostName();
@@ -443,16 +619,18 @@ void XCpSrc::Steal( XCpSrc *src )
     // need to notify
     pCtx->NotifyIdleSrc();
 
-    log->Debug( UtilityMsg, "s%: Stealing everything from %s", myHost.c_str(), srcHost.c_str() );
+    log->Debug( UtilityMsg, "%s: Stealing everything from %s", myHost.c_str(), srcHost.c_str() );
 
     return;
   }
 
   // the source we are stealing from is just slower, only take part of its work
   // so we want a fraction of its work we want for ourself
+  // until we have received some data assume we are as fast as the source
   uint64_t myTransferRate = TransferRate(), srcTransferRate = src->TransferRate();
-  if( myTransferRate == 0 ) return;
-  double fraction = double( myTransferRate ) / double( myTransferRate + srcTransferRate );
+  double fraction = 0.5;
+  if( myTransferRate )
+    fraction = double( myTransferRate ) / double( myTransferRate + srcTransferRate );
 
   if( src->pCurrentOffset < src->pBlkEnd )
   {
@@ -468,7 +646,7 @@ void XCpSrc::Steal( XCpSrc *src )
     pBlkEnd        = src->pBlkEnd;
     src->pBlkEnd  -= steal;
 
-    log->Debug( UtilityMsg, "s%: Stealing fraction (%f) of block from %s", myHost.c_str(), fraction, srcHost.c_str() );
+    log->Debug( UtilityMsg, "%s: Stealing fraction (%f) of block from %s", myHost.c_str(), fraction, srcHost.c_str() );
 
     return;
   }
@@ -483,7 +661,7 @@ void XCpSrc::Steal( XCpSrc *src )
       src->pRecovered.erase( itr );
     }
 
-    log->Debug( UtilityMsg, "s%: Stealing fraction (%f) of recovered chunks from %s", myHost.c_str(), fraction, srcHost.c_str() );
+    log->Debug( UtilityMsg, "%s: Stealing fraction (%f) of recovered chunks from %s", myHost.c_str(), fraction, srcHost.c_str() );
 
     return;
   }
@@ -504,7 +682,7 @@ void XCpSrc::Steal( XCpSrc *src )
       src->pOngoing.erase( itr );
     }
 
-    log->Debug( UtilityMsg, "s%: Stealing fraction (%f) of ongoing chunks from %s", myHost.c_str(), fraction, srcHost.c_str() );
+    log->Debug( UtilityMsg, "%s: Stealing fraction (%f) of ongoing chunks from %s", myHost.c_str(), fraction, srcHost.c_str() );
   }
 }
 
@@ -520,7 +698,7 @@ XRootDStatus XCpSrc::GetWork()
 
     Log *log = DefaultEnv::GetLog();
     std::string myHost = URL( pUrl ).GetHostName();
-    log->Debug( UtilityMsg, "s% got next block", myHost.c_str() );
+    log->Debug( UtilityMsg, "%s: got next block", myHost.c_str() );
 
     return XRootDStatus();
   }
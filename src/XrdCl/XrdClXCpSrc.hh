@@ -214,15 +214,54 @@ class XCpSrc
      */
     XRootDStatus GetWork();
 
+    /**
+     * Move part of the work a source has not requested yet over to us,
+     * so that at our respective transfer rates we both finish at about
+     * the same time. A source that has stopped gives up all its work.
+     * Unlike Steal() this keeps our own block, the work taken over is
+     * added to the recovered chunks.
+     *
+     * @param src : the source we are taking work from
+     */
+    void Share( XCpSrc *src );
+
+    /**
+     * Called periodically while we are transferring data:
+     * - gives up on this source if it is much slower than the
+     *   fastest one, switching to a spare replica if there is one
+     * - otherwise takes over work from the weakest source if it
+     *   would finish well after us
+     *
+     * @return : false if this source has been abandoned and
+     *           should stop, true otherwise
+     */
+    bool Rebalance();
+
+    /**
+     * Adjust the chunk size to the transfer rate and the latency
+     * of this source, so that a chunk takes long enough to amortize
+     * the round trip but a slow source holds little data in flight.
+     * Must be called with the mutex held.
+     */
+    void AdjustChunkSize();
+
+    /**
+     * Stop the source after it failed or was abandoned and wait
+     * until someone else took over its work.
+     */
+    void Retire();
+
     /**
      * This method is used by ChunkHandler to report the result of a write,
      * to the source object.
      *
-     * @param stats  : operation status
-     * @param chunk  : the read chunk (if operation failed, should be null)
-     * @param handle : the file object used to read the chunk
+     * @param stats   : operation status
+     * @param chunk   : the read chunk (if operation failed, should be null)
+     * @param handle  : the file object used to read the chunk
+     * @param latency : the time it took to read the chunk [us]
      */
-    void ReportResponse( XRootDStatus *status, ChunkInfo *chunk, File *handle );
+    void ReportResponse( XRootDStatus *status, ChunkInfo *chunk, File *handle,
+                         uint64_t latency );
 
     /**
      * Delets a pointer and sets it to null.
@@ -262,10 +301,26 @@ class XCpSrc
     }
 
     /**
-     * Default chunk size
+     * Current chunk size (adjusted to the transfer rate)
      */
     uint32_t                      pChunkSize;
 
+    /**
+     * Default chunk size
+     */
+    uint32_t                      pDefChunkSize;
+
+    /**
+     * The shortest time it took to read a chunk from the
+     * current URL [us], 0 if not known yet
+     */
+    uint64_t                      pMinLatency;
+
+    /**
+     * The time of the next call to Rebalance()
+     */
+    time_t                        pNextCheck;
+
     /**
      * Number of parallel chunks
      */
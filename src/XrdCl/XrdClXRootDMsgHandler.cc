@@ -37,11 +37,18 @@
 #include "XrdCl/XrdClMessageUtils.hh"
 #include "XrdCl/XrdClLocalFileHandler.hh"
 #include "XrdCl/XrdClRedirectorRegistry.hh"
+#include "XrdOuc/XrdOucCRC.hh"
 
 #include <arpa/inet.h>              // for network unmarshalling stuff
 #include "XrdSys/XrdSysPlatform.hh" // same as above
+#include "XrdSys/XrdSysProbe.hh"
+#include <cctype>
+#include <algorithm>
 #include <memory>
+#include <random>
 #include <sstream>
+#include <sys/uio.h>
+#include <zlib.h>
 
 namespace
 {
@@ -195,6 +202,13 @@ namespace XrdCl
         // already (handler installed to late and the message has been cached)
         //----------------------------------------------------------------------
         uint16_t reqId = ntohs( req->header.requestid );
+
+        //----------------------------------------------------------------------
+        // Compressed read responses are always cached and inflated at the end
+        //----------------------------------------------------------------------
+        if( ( reqId == kXR_read || reqId == kXR_readv ) && IsReadCompressed() )
+          return Take | RemoveHandler;
+
         if( reqId == kXR_read && msg->GetSize() == 8 )
         {
           pReadRawStarted = false;
@@ -236,6 +250,9 @@ namespace XrdCl
         // the buffer offset to prepare for the next one
         //----------------------------------------------------------------------
         uint16_t reqId = ntohs( req->header.requestid );
+        if( ( reqId == kXR_read || reqId == kXR_readv ) && IsReadCompressed() )
+          return Take | NoProcess;
+
         if( reqId == kXR_read )
         {
           if( msg->GetSize() == 8 )
@@ -378,7 +395,10 @@ namespace XrdCl
     // redirector)
     //--------------------------------------------------------------------------
     if( rsp->hdr.status != kXR_wait )
+    {
       pAggregatedWaitTime = 0;
+      pWaitCount          = 0;
+    }
 
     switch( rsp->hdr.status )
     {
@@ -607,6 +627,7 @@ namespace XrdCl
         XRDCL_SMART_PTR_T<Message> msgPtr( pResponse );
         pResponse = 0;
         uint32_t waitSeconds = 0;
+        uint32_t waitMs      = 0;
 
         if( rsp->hdr.dlen >= 4 )
         {
@@ -617,8 +638,9 @@ namespace XrdCl
                      "message %s: %s", pUrl.GetHostId().c_str(),
                      rsp->body.wait.seconds, pRequest->GetDescription().c_str(),
                      infoMsg );
-          delete [] infoMsg;
           waitSeconds = rsp->body.wait.seconds;
+          waitMs      = GetWaitHint( infoMsg, rsp->hdr.dlen-4, waitSeconds );
+          delete [] infoMsg;
         }
         else
         {
@@ -628,6 +650,7 @@ namespace XrdCl
         }
 
         pAggregatedWaitTime += waitSeconds;
+        ++pWaitCount;
 
         // We need a special case if the data node comes from metalink
         // redirector. In this case it might make more sense to try the
@@ -657,15 +680,21 @@ namespace XrdCl
         }
 
         //----------------------------------------------------------------------
-        // Register a task to resend the message in some seconds, if we still
-        // have time to do that, and report a timeout otherwise
+        // Register a task to resend the message after the wait, stretched by
+        // a random amount so that the clients told to wait at the same time
+        // do not all come back at the same time, if we still have time to do
+        // that, and report a timeout otherwise
         //----------------------------------------------------------------------
-        time_t resendTime = ::time(0)+waitSeconds;
+        uint32_t delay      = JitterWait( waitMs );
+        time_t   resendTime = ::time(0) + ( delay + 999 ) / 1000;
 
         if( resendTime < pExpiration )
         {
+          log->Dump( XRootDMsg, "[%s] Resending %s in %u ms",
+                     pUrl.GetHostId().c_str(),
+                     pRequest->GetDescription().c_str(), delay );
           TaskManager *taskMgr = pPostMaster->GetTaskManager();
-          taskMgr->RegisterTask( new WaitTask( pRef->Self() ), resendTime );
+          taskMgr->RegisterTaskMs( new WaitTask( pRef->Self() ), delay );
         }
         else
         {
@@ -884,11 +913,16 @@ namespace XrdCl
         }
 
         //----------------------------------------------------------------------
-        // We set up reading of the next header
+        // We set up reading of the next header, part of it may have come
+        // in together with the previous chunk
         //----------------------------------------------------------------------
-        pAsyncOffset     = 0;
+        pAsyncOffset     = pReadVRawNextHeaderSize;
         pAsyncReadSize   = 16;
         pAsyncReadBuffer = (char*)&pReadVRawChunkHeader;
+        if( pReadVRawNextHeaderSize )
+          memcpy( pAsyncReadBuffer, pReadVRawNextHeader,
+                  pReadVRawNextHeaderSize );
+        pReadVRawNextHeaderSize = 0;
       }
 
       //------------------------------------------------------------------------
@@ -988,9 +1022,13 @@ namespace XrdCl
     }
 
     //--------------------------------------------------------------------------
-    // Read the body
+    // Read the body straight into the user buffer and, if the message holds
+    // another chunk, get its header with the same system call
     //--------------------------------------------------------------------------
-    Status st = ReadAsync( socket, bytesRead );
+    uint32_t nextHdr = 0;
+    if( pReadVRawMsgOffset + pAsyncReadSize + 16 <= pAsyncMsgSize )
+      nextHdr = 16;
+    Status st = ReadAsyncWithHeader( socket, bytesRead, nextHdr );
 
     if( st.IsOK() && st.code == suDone )
     {
@@ -1063,6 +1101,40 @@ namespace XrdCl
     return Status( stOK, suDone );
   }
 
+  //--------------------------------------------------------------------------
+  // Read a buffer asynchronously and scatter whatever follows it into the
+  // next chunk header
+  //--------------------------------------------------------------------------
+  Status XRootDMsgHandler::ReadAsyncWithHeader( int       socket,
+                                                uint32_t &bytesRead,
+                                                uint32_t  nextHdr )
+  {
+    while( pAsyncOffset < pAsyncReadSize )
+    {
+      iovec iov[2];
+      iov[0].iov_base = pAsyncReadBuffer + pAsyncOffset;
+      iov[0].iov_len  = pAsyncReadSize - pAsyncOffset;
+      iov[1].iov_base = pReadVRawNextHeader;
+      iov[1].iov_len  = nextHdr;
+      int status = ::readv( socket, iov, nextHdr ? 2 : 1 );
+      if( status < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) )
+        return Status( stOK, suRetry );
+
+      if( status <= 0 )
+        return Status( stError, errSocketError, errno );
+
+      uint32_t body = (uint32_t)status;
+      if( body > iov[0].iov_len )
+      {
+        pReadVRawNextHeaderSize = body - iov[0].iov_len;
+        body                    = iov[0].iov_len;
+      }
+      pAsyncOffset     += body;
+      bytesRead        += status;
+    }
+    return Status( stOK, suDone );
+  }
+
   //----------------------------------------------------------------------------
   // We're here when we requested sending something over the wire
   // and there has been a status update on this action
@@ -1079,6 +1151,8 @@ namespace XrdCl
     {
       log->Dump( XRootDMsg, "[%s] Message %s has been successfully sent.",
                  pUrl.GetHostId().c_str(), message->GetDescription().c_str() );
+      XrdSysProbe2( xrdcl, request__sent, this,
+                    ntohs( ((ClientRequest *)message->GetBuffer())->header.requestid ) );
       Status st = pPostMaster->Receive( pUrl, this, pExpiration );
       if( st.IsOK() )
       {
@@ -1143,6 +1217,10 @@ namespace XrdCl
     XRootDStatus *status   = ProcessStatus();
     AnyObject    *response = 0;
 
+    XrdSysProbe3( xrdcl, request__done, this,
+                  ((ClientRequest *)pRequest->GetBuffer())->header.requestid,
+                  status->code );
+
     if( status->IsOK() )
     {
       Status st = ParseResponse( response );
@@ -1259,7 +1337,8 @@ namespace XrdCl
     // Partial answers, we need to glue them together before parsing
     //--------------------------------------------------------------------------
     else if( req->header.requestid != kXR_read &&
-             req->header.requestid != kXR_readv )
+             req->header.requestid != kXR_readv &&
+             req->header.requestid != kXR_pgread )
     {
       for( uint32_t i = 0; i < pPartialResps.size(); ++i )
       {
@@ -1455,6 +1534,45 @@ namespace XrdCl
         return Status();
       }
 
+      //------------------------------------------------------------------------
+      // kXR_statx - full stat information only
+      //------------------------------------------------------------------------
+      case kXR_statx:
+      {
+        if( !(req->stat.options & kXR_sfull) )
+          return Status( stError, errNotSupported );
+
+        log->Dump( XRootDMsg, "[%s] Parsing the response to %s as "
+                   "StatInfoList", pUrl.GetHostId().c_str(),
+                   pRequest->GetDescription().c_str() );
+
+        //----------------------------------------------------------------------
+        // A server not knowing kXR_sfull sends one flag byte per path
+        //----------------------------------------------------------------------
+        if( !memchr( buffer, ' ', length ) )
+          return Status( stError, errNotSupported );
+
+        std::string paths( pRequest->GetBuffer(24), req->stat.dlen );
+
+        char *nullBuffer = new char[length+1];
+        nullBuffer[length] = 0;
+        memcpy( nullBuffer, buffer, length );
+
+        StatInfoList *data = new StatInfoList();
+        if( data->ParseServerResponse( paths, nullBuffer ) == false )
+        {
+          delete data;
+          delete [] nullBuffer;
+          return Status( stError, errInvalidResponse );
+        }
+        delete [] nullBuffer;
+
+        AnyObject *obj = new AnyObject();
+        obj->Set( data );
+        response = obj;
+        return Status();
+      }
+
       //------------------------------------------------------------------------
       // kXR_open - if we got the statistics, otherwise return 0
       //------------------------------------------------------------------------
@@ -1473,6 +1591,38 @@ namespace XrdCl
 
         AnyObject *obj      = new AnyObject();
         StatInfo  *statInfo = 0;
+        uint32_t   statOffs = 12;
+        uint32_t   rdLen    = 0;
+        bool       rdData   = false;
+        bool       rdClosed = false;
+
+        //----------------------------------------------------------------------
+        // Handle the data if we asked for it to be read along with the open.
+        // It precedes the stat info and, unlike the stat info, never starts
+        // with a digit. A server that did not read it simply leaves it out.
+        //----------------------------------------------------------------------
+        if( ( req->open.optiont & kXR_ordata ) &&
+            rsp->hdr.dlen >= int32_t( 12 + sizeof( ServerResponseOpen_Read ) ) &&
+            !isdigit( (unsigned char)buffer[12] ) )
+        {
+          ServerResponseOpen_Read *rdResp = (ServerResponseOpen_Read*)( buffer+12 );
+          rdLen    = ntohl( rdResp->rdlen );
+          rdClosed = rdResp->flags & kXR_orclosed;
+          statOffs = 12 + sizeof( ServerResponseOpen_Read );
+          if( rdLen > uint32_t( rsp->hdr.dlen ) - statOffs )
+          {
+            log->Error( XRootDMsg, "[%s] Got invalid open response data "
+                        "length to %s.", pUrl.GetHostId().c_str(),
+                        pRequest->GetDescription().c_str() );
+            delete obj;
+            return Status( stError, errInvalidResponse );
+          }
+          log->Dump( XRootDMsg, "[%s] Got %u bytes of data in response to %s",
+                     pUrl.GetHostId().c_str(), rdLen,
+                     pRequest->GetDescription().c_str() );
+          rdData    = true;
+          statOffs += rdLen;
+        }
 
         //----------------------------------------------------------------------
         // Handle StatInfo if requested
@@ -1483,11 +1633,12 @@ namespace XrdCl
                      pUrl.GetHostId().c_str(),
                      pRequest->GetDescription().c_str() );
 
-          if( rsp->hdr.dlen >= 12 )
+          if( uint32_t( rsp->hdr.dlen ) >= statOffs )
           {
-            char *nullBuffer = new char[rsp->hdr.dlen-11];
-            nullBuffer[rsp->hdr.dlen-12] = 0;
-            memcpy( nullBuffer, buffer+12, rsp->hdr.dlen-12 );
+            uint32_t statLen = rsp->hdr.dlen - statOffs;
+            char *nullBuffer = new char[statLen+1];
+            nullBuffer[statLen] = 0;
+            memcpy( nullBuffer, buffer+statOffs, statLen );
 
             statInfo = new StatInfo();
             if( statInfo->ParseServerResponse( nullBuffer ) == false )
@@ -1498,7 +1649,7 @@ namespace XrdCl
             delete [] nullBuffer;
           }
 
-          if( rsp->hdr.dlen < 12 || !statInfo )
+          if( !statInfo )
           {
             log->Error( XRootDMsg, "[%s] Unable to parse StatInfo in response "
                         "to %s", pUrl.GetHostId().c_str(),
@@ -1511,6 +1662,9 @@ namespace XrdCl
         OpenInfo *data = new OpenInfo( (uint8_t*)buffer,
                                        pResponse->GetSessionId(),
                                        statInfo );
+        if( rdData )
+          data->SetReadData( buffer+12+sizeof( ServerResponseOpen_Read ),
+                             rdLen, rdClosed );
         obj->Set( data );
         response = obj;
         return Status();
@@ -1525,6 +1679,17 @@ namespace XrdCl
                    pUrl.GetHostId().c_str(),
                    pRequest->GetDescription().c_str() );
 
+        //----------------------------------------------------------------------
+        // Inflate the responses if the server compressed them
+        //----------------------------------------------------------------------
+        if( pReadCmp > 0 )
+        {
+          Status st = UnCompressReadResponses();
+          if( !st.IsOK() )
+            return st;
+          rsp = (ServerResponse *)pResponse->GetBuffer();
+        }
+
         //----------------------------------------------------------------------
         // Glue in the cached responses if necessary
         //----------------------------------------------------------------------
@@ -1577,6 +1742,30 @@ namespace XrdCl
         return Status();
       }
 
+      //------------------------------------------------------------------------
+      // kXR_pgread - the data is interleaved with the page checksums
+      //------------------------------------------------------------------------
+      case kXR_pgread:
+      {
+        log->Dump( XRootDMsg, "[%s] Parsing the response to %s as PageInfo",
+                   pUrl.GetHostId().c_str(),
+                   pRequest->GetDescription().c_str() );
+
+        ChunkInfo  chunk  = pChunkList->front();
+        PageInfo  *pgInfo = new PageInfo( chunk.offset, 0, chunk.buffer );
+        Status st = PostProcessPgRead( pgInfo );
+        if( !st.IsOK() )
+        {
+          delete pgInfo;
+          return st;
+        }
+
+        AnyObject *obj = new AnyObject();
+        obj->Set( pgInfo );
+        response = obj;
+        return Status();
+      }
+
       //------------------------------------------------------------------------
       // kXR_readv - we need to pass the length of the buffer to the user code
       //------------------------------------------------------------------------
@@ -1717,6 +1906,16 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   Status XRootDMsgHandler::PostProcessReadV( VectorReadInfo *vReadInfo )
   {
+    //--------------------------------------------------------------------------
+    // Inflate the responses if the server compressed them
+    //--------------------------------------------------------------------------
+    if( pReadCmp > 0 )
+    {
+      Status st = UnCompressReadResponses();
+      if( !st.IsOK() )
+        return st;
+    }
+
     //--------------------------------------------------------------------------
     // Unpack the stuff that needs to be unpacked
     //--------------------------------------------------------------------------
@@ -1746,6 +1945,84 @@ namespace XrdCl
     return Status();
   }
 
+  //----------------------------------------------------------------------------
+  // Post process page read
+  //----------------------------------------------------------------------------
+  Status XRootDMsgHandler::PostProcessPgRead( PageInfo *pgInfo )
+  {
+    //--------------------------------------------------------------------------
+    // Each partial response holds whole units, so unpack them one at a time
+    //--------------------------------------------------------------------------
+    Status st;
+    for( uint32_t i = 0; i < pPartialResps.size(); ++i )
+    {
+      st = UnPackPgReadResponse( (ServerResponse*)pPartialResps[i]->GetBuffer(),
+                                 pgInfo );
+      if( !st.IsOK() )
+        return st;
+    }
+    return UnPackPgReadResponse( (ServerResponse*)pResponse->GetBuffer(),
+                                 pgInfo );
+  }
+
+  //----------------------------------------------------------------------------
+  // Unpack a single pgread response
+  //----------------------------------------------------------------------------
+  Status XRootDMsgHandler::UnPackPgReadResponse( ServerResponse *rsp,
+                                                 PageInfo       *pgInfo )
+  {
+    Log      *log    = DefaultEnv::GetLog();
+    ChunkInfo chunk  = pChunkList->front();
+    char     *cursor = rsp->body.buffer.data;
+    uint32_t  left   = rsp->hdr.dlen;
+
+    while( left )
+    {
+      uint64_t offset = pgInfo->offset + pgInfo->length;
+      uint32_t pglen  = kXR_pgPageSZ - ( offset & ( kXR_pgPageSZ - 1 ) );
+      uint32_t cksum;
+
+      if( left <= sizeof( cksum ) )
+      {
+        log->Error( XRootDMsg, "[%s] Handling response to %s: truncated page "
+                    "at offset %llu.", pUrl.GetHostId().c_str(),
+                    pRequest->GetDescription().c_str(),
+                    (unsigned long long)offset );
+        return Status( stError, errInvalidResponse );
+      }
+      if( pglen > left - sizeof( cksum ) )
+        pglen = left - sizeof( cksum );
+
+      if( pgInfo->length + pglen > chunk.length )
+      {
+        log->Error( XRootDMsg, "[%s] Handling response to %s: user supplied "
+                    "buffer is too small for the received data.",
+                    pUrl.GetHostId().c_str(),
+                    pRequest->GetDescription().c_str() );
+        return Status( stError, errInvalidResponse );
+      }
+
+      memcpy( &cksum, cursor, sizeof( cksum ) );
+      cksum   = ntohl( cksum );
+      cursor += sizeof( cksum );
+      if( XrdOucCRC::Calc32C( cursor, pglen ) != cksum )
+      {
+        log->Error( XRootDMsg, "[%s] Handling response to %s: page checksum "
+                    "mismatch at offset %llu.", pUrl.GetHostId().c_str(),
+                    pRequest->GetDescription().c_str(),
+                    (unsigned long long)offset );
+        return Status( stError, errDataError );
+      }
+
+      memcpy( (char*)pgInfo->buffer + pgInfo->length, cursor, pglen );
+      pgInfo->cksums.push_back( cksum );
+      pgInfo->length += pglen;
+      cursor         += pglen;
+      left           -= pglen + sizeof( cksum );
+    }
+    return Status();
+  }
+
   //----------------------------------------------------------------------------
   //! Unpack a single readv response
   //----------------------------------------------------------------------------
@@ -1830,6 +2107,107 @@ namespace XrdCl
     return Status();
   }
 
+  //----------------------------------------------------------------------------
+  // Check whether the server compresses our read responses
+  //----------------------------------------------------------------------------
+  bool XRootDMsgHandler::IsReadCompressed()
+  {
+    if( pReadCmp < 0 )
+    {
+      AnyObject  qryResult;
+      bool      *qryResponse = 0;
+      pReadCmp = 0;
+      if( pPostMaster->QueryTransport( pUrl, XRootDQuery::ReadCompressed,
+                                       qryResult ).IsOK() )
+      {
+        qryResult.Get( qryResponse );
+        if( qryResponse && *qryResponse )
+          pReadCmp = 1;
+        delete qryResponse;
+      }
+    }
+    return pReadCmp > 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Inflate the compressed read responses in place
+  //----------------------------------------------------------------------------
+  Status XRootDMsgHandler::UnCompressReadResponses()
+  {
+    for( uint32_t i = 0; i < pPartialResps.size(); ++i )
+    {
+      Status st = UnCompressResponse( pPartialResps[i] );
+      if( !st.IsOK() )
+        return st;
+    }
+    return UnCompressResponse( pResponse );
+  }
+
+  //----------------------------------------------------------------------------
+  // Inflate a single compressed read response in place
+  //----------------------------------------------------------------------------
+  Status XRootDMsgHandler::UnCompressResponse( Message *msg )
+  {
+    ServerResponse *rsp = (ServerResponse*)msg->GetBuffer();
+    if( rsp->hdr.dlen == 0 )
+      return Status();
+
+    Log *log = DefaultEnv::GetLog();
+    if( rsp->hdr.dlen < (kXR_int32)sizeof( ServerResponseCmp_Read ) ||
+        msg->GetSize() != (uint32_t)rsp->hdr.dlen + 8 )
+    {
+      log->Error( XRootDMsg, "[%s] Handling response to %s: compressed "
+                  "response is truncated.", pUrl.GetHostId().c_str(),
+                  pRequest->GetDescription().c_str() );
+      return Status( stError, errInvalidResponse );
+    }
+
+    ServerResponseCmp_Read *cmpHdr = (ServerResponseCmp_Read*)msg->GetBuffer(8);
+    uint32_t rlen = ntohl( cmpHdr->rlen );
+    uint32_t clen = ntohl( cmpHdr->clen );
+    uint32_t dlen = rsp->hdr.dlen - sizeof( ServerResponseCmp_Read );
+
+    if( ( clen && clen != dlen ) || ( !clen && rlen != dlen ) )
+    {
+      log->Error( XRootDMsg, "[%s] Handling response to %s: inconsistent "
+                  "compression header.", pUrl.GetHostId().c_str(),
+                  pRequest->GetDescription().c_str() );
+      return Status( stError, errInvalidResponse );
+    }
+
+    char *buffer = (char*)malloc( rlen + 8 );
+    if( !buffer )
+      return Status( stError, errOSError, ENOMEM );
+    memcpy( buffer, msg->GetBuffer(), 8 );
+
+    if( !clen )
+      memcpy( buffer + 8, msg->GetBuffer( 8 + sizeof( ServerResponseCmp_Read ) ),
+              rlen );
+    else
+    {
+      uLongf outLen = rlen;
+      int rc = uncompress( (Bytef*)buffer + 8, &outLen,
+                 (const Bytef*)msg->GetBuffer( 8 + sizeof( ServerResponseCmp_Read ) ),
+                 clen );
+      if( rc != Z_OK || outLen != rlen )
+      {
+        free( buffer );
+        log->Error( XRootDMsg, "[%s] Handling response to %s: unable to "
+                    "inflate the data (%d).", pUrl.GetHostId().c_str(),
+                    pRequest->GetDescription().c_str(), rc );
+        return Status( stError, errInvalidResponse );
+      }
+    }
+
+    log->Dump( XRootDMsg, "[%s] Handling response to %s: inflated %d bytes "
+               "to %d", pUrl.GetHostId().c_str(),
+               pRequest->GetDescription().c_str(), clen, rlen );
+
+    msg->Grab( buffer, rlen + 8 );
+    ((ServerResponse*)msg->GetBuffer())->hdr.dlen = rlen;
+    return Status();
+  }
+
   //----------------------------------------------------------------------------
   // Recover error
   //----------------------------------------------------------------------------
@@ -1981,6 +2359,7 @@ namespace XrdCl
       }
 
       pUrl = url;
+      pReadCmp = -1;
     }
 
     if( pUrl.IsMetalink() && pFollowMetalink )
@@ -2169,6 +2548,45 @@ namespace XrdCl
     return false;
   }
 
+  //------------------------------------------------------------------------
+  // Extract the wait time in milliseconds from a kXR_wait response
+  //------------------------------------------------------------------------
+  uint32_t XRootDMsgHandler::GetWaitHint( const char *infoMsg, uint32_t len,
+                                          uint32_t seconds )
+  {
+    const char *hint = (const char*)memchr( infoMsg, 0, len );
+    if( hint && uint32_t( ++hint - infoMsg ) + 3 < len
+        && !strncmp( hint, "ms=", 3 ) )
+    {
+      char *eP;
+      unsigned long ms = strtoul( hint + 3, &eP, 10 );
+      if( eP != hint + 3 && ms <= 0x7fffffffUL ) return ms;
+    }
+    return seconds * 1000;
+  }
+
+  //------------------------------------------------------------------------
+  // Stretch a wait by a random amount
+  //------------------------------------------------------------------------
+  uint32_t XRootDMsgHandler::JitterWait( uint32_t waitMs )
+  {
+    static thread_local std::minstd_rand rng( std::random_device{}() );
+
+    int jitter = DefaultWaitJitter;
+    DefaultEnv::GetEnv()->GetInt( "WaitJitter", jitter );
+    if( jitter <= 0 ) return waitMs;
+
+    //----------------------------------------------------------------------
+    // Even an immediate retry gets spread once it is not the first one
+    //----------------------------------------------------------------------
+    uint64_t span = waitMs;
+    if( span < 100 && pWaitCount > 1 ) span = 100;
+    span = span * jitter / 100 * std::min<uint16_t>( pWaitCount, 4 );
+    if( !span ) return waitMs;
+
+    return waitMs + uint32_t( rng() % ( span + 1 ) );
+  }
+
   //------------------------------------------------------------------------
   // Dump the redirect-trace-back into the log file
   //------------------------------------------------------------------------
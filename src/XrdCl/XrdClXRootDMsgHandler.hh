@@ -184,6 +184,7 @@ namespace XrdCl
         pReadVRawSizeError( false ),
         pReadVRawChunkIndex( 0 ),
         pReadVRawMsgDiscard( false ),
+        pReadVRawNextHeaderSize( 0 ),
 
         pOtherRawStarted( false ),
 
@@ -192,9 +193,12 @@ namespace XrdCl
         pStateful( false ),
 
         pAggregatedWaitTime( 0 ),
+        pWaitCount( 0 ),
 
         pMsgInFly( false ),
 
+        pReadCmp( -1 ),
+
         pRef( new MsgHandlerRef( this ) )
       {
         pPostMaster = DefaultEnv::GetPostMaster();
@@ -415,6 +419,13 @@ namespace XrdCl
       //------------------------------------------------------------------------
       Status ReadAsync( int socket, uint32_t &btesRead );
 
+      //------------------------------------------------------------------------
+      //! Same as ReadAsync but scatter the bytes following the buffer
+      //! into the next kXR_readv chunk header, up to nextHdr bytes
+      //------------------------------------------------------------------------
+      Status ReadAsyncWithHeader( int socket, uint32_t &bytesRead,
+                                  uint32_t nextHdr );
+
       //------------------------------------------------------------------------
       //! Recover error
       //------------------------------------------------------------------------
@@ -457,11 +468,36 @@ namespace XrdCl
       //------------------------------------------------------------------------
       Status PostProcessReadV( VectorReadInfo *vReadInfo );
 
+      //------------------------------------------------------------------------
+      //! Post process page read, verify and strip the page checksums
+      //------------------------------------------------------------------------
+      Status PostProcessPgRead( PageInfo *pgInfo );
+
+      //------------------------------------------------------------------------
+      //! Unpack a single pgread response
+      //------------------------------------------------------------------------
+      Status UnPackPgReadResponse( ServerResponse *rsp, PageInfo *pgInfo );
+
       //------------------------------------------------------------------------
       //! Unpack a single readv response
       //------------------------------------------------------------------------
       Status UnPackReadVResponse( Message *msg );
 
+      //------------------------------------------------------------------------
+      //! Check whether the server compresses our read responses
+      //------------------------------------------------------------------------
+      bool IsReadCompressed();
+
+      //------------------------------------------------------------------------
+      //! Inflate the compressed read responses in place
+      //------------------------------------------------------------------------
+      Status UnCompressReadResponses();
+
+      //------------------------------------------------------------------------
+      //! Inflate a single compressed read response in place
+      //------------------------------------------------------------------------
+      Status UnCompressResponse( Message *msg );
+
       //------------------------------------------------------------------------
       //! Update the "tried=" part of the CGI of the current message
       //------------------------------------------------------------------------
@@ -501,6 +537,20 @@ namespace XrdCl
       //------------------------------------------------------------------------
       bool OmitWait( Message *request, const URL &url );
 
+      //------------------------------------------------------------------------
+      //! Extract the wait time in milliseconds from a kXR_wait response. The
+      //! server may append "ms=<n>" after the terminating null of the info
+      //! message, otherwise the time is the given number of seconds.
+      //------------------------------------------------------------------------
+      static uint32_t GetWaitHint( const char *infoMsg, uint32_t len,
+                                   uint32_t seconds );
+
+      //------------------------------------------------------------------------
+      //! Stretch a wait by a random amount that grows with the number of
+      //! consecutive kXR_wait responses to this request (WaitJitter percent)
+      //------------------------------------------------------------------------
+      uint32_t JitterWait( uint32_t waitMs );
+
       //------------------------------------------------------------------------
       //! Dump the redirect-trace-back into the log file
       //------------------------------------------------------------------------
@@ -554,6 +604,8 @@ namespace XrdCl
       int32_t                         pReadVRawChunkIndex;
       readahead_list                  pReadVRawChunkHeader;
       bool                            pReadVRawMsgDiscard;
+      char                            pReadVRawNextHeader[16];
+      uint32_t                        pReadVRawNextHeaderSize;
 
       bool                            pOtherRawStarted;
 
@@ -561,12 +613,15 @@ namespace XrdCl
 
       bool                            pStateful;
       int                             pAggregatedWaitTime;
+      uint16_t                        pWaitCount;
 
       std::unique_ptr<RedirectEntry>  pRdirEntry;
       RedirectTraceBack               pRedirectTraceBack;
 
       bool                            pMsgInFly;
 
+      int8_t                          pReadCmp;
+
       //------------------------------------------------------------------------
       // (Counted) Reference to myself - passed to WaitTask
       //------------------------------------------------------------------------
@@ -307,4 +307,57 @@ namespace XrdCl
     }
     return true;
   }
+
+  //----------------------------------------------------------------------------
+  // StatInfoList constructor
+  //----------------------------------------------------------------------------
+  StatInfoList::StatInfoList()
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  // Destructor
+  //----------------------------------------------------------------------------
+  StatInfoList::~StatInfoList()
+  {
+    std::vector<Entry>::iterator it;
+    for( it = pEntries.begin(); it != pEntries.end(); ++it )
+      delete it->info;
+  }
+
+  //----------------------------------------------------------------------------
+  // Parse the bulk stat response, one line per path
+  //----------------------------------------------------------------------------
+  bool StatInfoList::ParseServerResponse( const std::string &paths,
+                                          const char        *data )
+  {
+    if( !data )
+      return false;
+
+    std::vector<std::string> pathList, lines;
+    Utils::splitString( pathList, paths, "\n" );
+    Utils::splitString( lines, data, "\n" );
+
+    if( pathList.size() != lines.size() )
+      return false;
+
+    for( size_t i = 0; i < lines.size(); ++i )
+    {
+      if( !lines[i].empty() && lines[i][0] == '!' )
+      {
+        uint32_t errNo = atoi( lines[i].c_str()+1 );
+        Add( pathList[i], 0, XRootDStatus( stError, errErrorResponse, errNo ) );
+        continue;
+      }
+
+      StatInfo *info = new StatInfo();
+      if( !info->ParseServerResponse( lines[i].c_str() ) )
+      {
+        delete info;
+        return false;
+      }
+      Add( pathList[i], info );
+    }
+    return true;
+  }
 }
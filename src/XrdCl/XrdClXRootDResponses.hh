@@ -692,6 +692,96 @@ namespace XrdCl
       std::string pParent;
   };
 
+  //----------------------------------------------------------------------------
+  //! Stat information of a list of paths, returned by a bulk stat
+  //----------------------------------------------------------------------------
+  class StatInfoList
+  {
+    public:
+      //------------------------------------------------------------------------
+      //! Constructor
+      //------------------------------------------------------------------------
+      StatInfoList();
+
+      //------------------------------------------------------------------------
+      //! Destructor
+      //------------------------------------------------------------------------
+      ~StatInfoList();
+
+      //------------------------------------------------------------------------
+      //! Add an entry to the list - takes ownership of the stat info, which
+      //! must be null if the path could not be stat'ed
+      //------------------------------------------------------------------------
+      void Add( const std::string  &path,
+                StatInfo           *info,
+                const XRootDStatus &status = XRootDStatus() )
+      {
+        pEntries.push_back( Entry( path, info, status ) );
+      }
+
+      //------------------------------------------------------------------------
+      //! Get the number of entries, same as the number of requested paths
+      //------------------------------------------------------------------------
+      uint32_t GetSize() const
+      {
+        return pEntries.size();
+      }
+
+      //------------------------------------------------------------------------
+      //! Get the path of an entry
+      //------------------------------------------------------------------------
+      const std::string &GetPath( uint32_t index ) const
+      {
+        return pEntries[index].path;
+      }
+
+      //------------------------------------------------------------------------
+      //! Get the stat info of an entry, null if the stat failed
+      //------------------------------------------------------------------------
+      StatInfo *GetStatInfo( uint32_t index )
+      {
+        return pEntries[index].info;
+      }
+
+      //------------------------------------------------------------------------
+      //! Get the stat info of an entry, null if the stat failed
+      //------------------------------------------------------------------------
+      const StatInfo *GetStatInfo( uint32_t index ) const
+      {
+        return pEntries[index].info;
+      }
+
+      //------------------------------------------------------------------------
+      //! Get the status of the stat of an entry
+      //------------------------------------------------------------------------
+      const XRootDStatus &GetStatus( uint32_t index ) const
+      {
+        return pEntries[index].status;
+      }
+
+      //------------------------------------------------------------------------
+      //! Parse the server response to a bulk stat of the given new line
+      //! separated paths and fill up the object
+      //------------------------------------------------------------------------
+      bool ParseServerResponse( const std::string &paths,
+                                const char        *data );
+
+    private:
+      StatInfoList( const StatInfoList& );
+      StatInfoList &operator=( const StatInfoList& );
+
+      struct Entry
+      {
+        Entry( const std::string &p, StatInfo *i, const XRootDStatus &st ):
+          path( p ), info( i ), status( st ) {}
+        std::string  path;
+        StatInfo    *info;
+        XRootDStatus status;
+      };
+
+      std::vector<Entry> pEntries;
+  };
+
   //----------------------------------------------------------------------------
   //! Information returned by file open operation
   //----------------------------------------------------------------------------
@@ -704,7 +794,8 @@ namespace XrdCl
       OpenInfo( const uint8_t *fileHandle,
                 uint64_t       sessionId,
                 StatInfo *statInfo        = 0 ):
-        pSessionId(sessionId), pStatInfo( statInfo )
+        pSessionId(sessionId), pStatInfo( statInfo ), pHasReadData( false ),
+        pReadClosed( false )
       {
         memcpy( pFileHandle, fileHandle, 4 );
       }
@@ -741,10 +832,51 @@ namespace XrdCl
         return pSessionId;
       }
 
+      //------------------------------------------------------------------------
+      //! Set the data the server read along with the open
+      //!
+      //! @param data   the data
+      //! @param size   the size of the data
+      //! @param closed true if the server closed the file after reading
+      //------------------------------------------------------------------------
+      void SetReadData( const char *data, uint32_t size, bool closed )
+      {
+        pReadData.assign( data, size );
+        pHasReadData = true;
+        pReadClosed  = closed;
+      }
+
+      //------------------------------------------------------------------------
+      //! True if the server read data along with the open
+      //------------------------------------------------------------------------
+      bool HasReadData() const
+      {
+        return pHasReadData;
+      }
+
+      //------------------------------------------------------------------------
+      //! Get the data the server read along with the open
+      //------------------------------------------------------------------------
+      const std::string &GetReadData() const
+      {
+        return pReadData;
+      }
+
+      //------------------------------------------------------------------------
+      //! True if the server closed the file after reading the data
+      //------------------------------------------------------------------------
+      bool IsReadClosed() const
+      {
+        return pReadClosed;
+      }
+
     private:
-      uint8_t   pFileHandle[4];
-      uint64_t  pSessionId;
-      StatInfo *pStatInfo;
+      uint8_t      pFileHandle[4];
+      uint64_t     pSessionId;
+      StatInfo    *pStatInfo;
+      std::string  pReadData;
+      bool         pHasReadData;
+      bool         pReadClosed;
   };
 
   //----------------------------------------------------------------------------
@@ -768,6 +900,26 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   typedef std::vector<ChunkInfo> ChunkList;
 
+  //----------------------------------------------------------------------------
+  //! Describe the data returned by a page read along with the CRC32C checksum
+  //! of each page (pages are aligned on file offsets so the first and the
+  //! last one may be short)
+  //----------------------------------------------------------------------------
+  struct PageInfo
+  {
+    //--------------------------------------------------------------------------
+    //! Constructor
+    //--------------------------------------------------------------------------
+    PageInfo( uint64_t off = 0, uint32_t len = 0, void *buff = 0,
+              const std::vector<uint32_t> &cks = std::vector<uint32_t>() ):
+      offset( off ), length( len ), buffer( buff ), cksums( cks ) {}
+
+    uint64_t              offset; //! offset in the file
+    uint32_t              length; //! number of bytes read
+    void                 *buffer; //! buffer holding the data
+    std::vector<uint32_t> cksums; //! CRC32C checksum of each page
+  };
+
   //----------------------------------------------------------------------------
   //! Vector read info
   //----------------------------------------------------------------------------
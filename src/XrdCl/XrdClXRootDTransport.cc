@@ -146,7 +146,10 @@ namespace XrdCl
       waitBarrier(0),
       protection(0),
       protRespBody(0),
-      protRespSize(0)
+      protRespSize(0),
+      nextDownStream(0),
+      readCompressed(false),
+      autoStreams(0)
     {
       sidManager = new SIDManager();
       memset( sessionId, 0, 16 );
@@ -187,6 +190,9 @@ namespace XrdCl
     XrdSecProtect               *protection;
     ServerResponseBody_Protocol *protRespBody;
     unsigned int                 protRespSize;
+    uint32_t                     nextDownStream;
+    bool                         readCompressed;
+    uint16_t                     autoStreams;
     XrdSysMutex                  mutex;
   };
 
@@ -364,14 +370,18 @@ namespace XrdCl
     {
       Status st = ProcessProtocolResp( handShakeData, info );
 
+      //------------------------------------------------------------------------
+      // The stream vector may have grown if the server suggested substreams
+      //------------------------------------------------------------------------
+      XRootDStreamInfo &mInfo = info->stream[handShakeData->subStreamId];
       if( !st.IsOK() )
       {
-        sInfo.status = XRootDStreamInfo::Broken;
+        mInfo.status = XRootDStreamInfo::Broken;
         return st;
       }
 
       handShakeData->out = GenerateLogIn( handShakeData, info );
-      sInfo.status = XRootDStreamInfo::LoginSent;
+      mInfo.status = XRootDStreamInfo::LoginSent;
       return Status( stOK, suContinue );
     }
 
@@ -661,7 +671,13 @@ namespace XrdCl
       if( connected.empty() )
         downStream = 0;
       else
-        downStream = connected[random()%connected.size()];
+      {
+        //----------------------------------------------------------------------
+        // Rotate over the connected streams so that consecutive reads, e.g.
+        // the pieces of a striped read, end up on different sockets
+        //----------------------------------------------------------------------
+        downStream = connected[info->nextDownStream++ % connected.size()];
+      }
     }
 
     if( upStream >= info->stream.size() )
@@ -833,6 +849,8 @@ namespace XrdCl
       case kXR_open:
         req->open.mode    = htons( req->open.mode );
         req->open.options = htons( req->open.options );
+        req->open.rdlen   = htonl( req->open.rdlen );
+        req->open.rdoffs  = htonl( req->open.rdoffs );
         break;
 
       //------------------------------------------------------------------------
@@ -843,6 +861,14 @@ namespace XrdCl
         req->read.rlen   = htonl( req->read.rlen );
         break;
 
+      //------------------------------------------------------------------------
+      // kXR_pgread
+      //------------------------------------------------------------------------
+      case kXR_pgread:
+        req->pgread.offset = htonll( req->pgread.offset );
+        req->pgread.rlen   = htonl( req->pgread.rlen );
+        break;
+
       //------------------------------------------------------------------------
       // kXR_write
       //------------------------------------------------------------------------
@@ -1093,6 +1119,21 @@ namespace XrdCl
       case XRootDQuery::ProtocolVersion:
         result.Set( new int( info->protocolVersion ), false );
         return Status();
+
+      //------------------------------------------------------------------------
+      // Whether the server compresses read responses
+      //------------------------------------------------------------------------
+      case XRootDQuery::ReadCompressed:
+        result.Set( new bool( info->readCompressed ), false );
+        return Status();
+
+      //------------------------------------------------------------------------
+      // Number of data substreams besides the main one
+      //------------------------------------------------------------------------
+      case XRootDQuery::SubStreams:
+        result.Set( new uint16_t( info->serverFlags & kXR_isServer ?
+                                  info->stream.size() - 1 : 0 ), false );
+        return Status();
     };
     return Status( stError, errQueryNotSupported );
   }
@@ -1318,6 +1359,11 @@ namespace XrdCl
     proto->requestid = htons(kXR_protocol);
     proto->clientpv  = htonl(kXR_PROTOCOLVERSION);
     proto->flags     = kXR_secreqs;
+
+    int readCmp = DefaultReadCompression;
+    DefaultEnv::GetEnv()->GetInt( "ReadCompression", readCmp );
+    if( readCmp )
+      proto->flags |= kXR_wantcmp;
     return msg;
   }
 
@@ -1403,6 +1449,30 @@ namespace XrdCl
 
     if( rsp->body.protocol.pval >= 0x297 )
       info->serverFlags = rsp->body.protocol.flags;
+    info->readCompressed = ( info->serverFlags & kXR_cmpRead );
+
+    //--------------------------------------------------------------------------
+    // Use the number of data substreams suggested by the server, unless the
+    // user asked for substreams, so that large reads get spread over several
+    // sockets where a single one cannot fill the pipe
+    //--------------------------------------------------------------------------
+    uint32_t hint = ( info->serverFlags & kXR_strmHint ) >> kXR_strmShft;
+    if( hint && ( info->serverFlags & kXR_isServer ) &&
+        info->stream.size() == 1 )
+    {
+      int maxAuto = DefaultAutoSubStreams;
+      DefaultEnv::GetEnv()->GetInt( "AutoSubStreams", maxAuto );
+      if( maxAuto > 0 )
+      {
+        if( hint > (uint32_t)maxAuto ) hint = maxAuto;
+        info->stream.resize( hint + 1 );
+        info->autoStreams = hint;
+        log->Debug( XRootDTransportMsg, "[%s] Server suggests %d data "
+                    "substreams, using %d", hsData->streamName.c_str(),
+                    ( info->serverFlags & kXR_strmHint ) >> kXR_strmShft,
+                    hint );
+      }
+    }
 
     if( rsp->hdr.dlen > 8 )
     {
@@ -1763,6 +1833,27 @@ namespace XrdCl
       {
         info->authProtocolName = info->authProtocol->Entity.prot;
 
+        //----------------------------------------------------------------------
+        // The server may have handed us a ticket to be used on later logins,
+        // the security layer records it when given the ticket as a token
+        //----------------------------------------------------------------------
+        XrdSecGetProt_t authHandler = GetAuthHandler();
+        if( rsp->hdr.dlen > 0 && authHandler )
+        {
+          log->Debug( XRootDTransportMsg, "[%s] Received a login ticket.",
+                      hsData->streamName.c_str() );
+          char *tktData = (char*)malloc( rsp->hdr.dlen );
+          memcpy( tktData, rsp->body.buffer.data, rsp->hdr.dlen );
+          XrdSecParameters tktToken( tktData, rsp->hdr.dlen );
+          XrdOucErrInfo    ei( "", info->authEnv );
+          XrdNetAddrInfo  &srvAddrInfo =
+                             *const_cast<XrdNetAddr *>( hsData->serverAddr );
+          XrdSecProtocol  *tktProt =
+                             (*authHandler)( hsData->url->GetHostName().c_str(),
+                                             srvAddrInfo, tktToken, &ei );
+          if( tktProt ) tktProt->Delete();
+        }
+
         //----------------------------------------------------------------------
         // Do we need protection?
         //----------------------------------------------------------------------
@@ -2116,6 +2207,9 @@ namespace XrdCl
     repr.erase( repr.length()-1, 1 );
 
     repr += "]";
+
+    if( flags & kXR_cmpRead )
+      repr += " compressed reads";
     return repr;
   }
 }
@@ -2196,6 +2290,12 @@ namespace XrdCl
           if( sreq->options & kXR_retstat )
             o << "kXR_retstat ";
         }
+        if( sreq->optiont & kXR_ordata )
+        {
+          o << ", read: " << sreq->rdlen << "@" << sreq->rdoffs;
+          if( sreq->optiont & kXR_orclose )
+            o << " and close";
+        }
         o << ")";
         break;
       }
@@ -2242,6 +2342,26 @@ namespace XrdCl
         break;
       }
 
+      //------------------------------------------------------------------------
+      // kXR_statx
+      //------------------------------------------------------------------------
+      case kXR_statx:
+      {
+        ClientStatRequest *sreq = (ClientStatRequest *)msg->GetBuffer();
+        char *fn = GetDataAsString( msg );
+        uint32_t cnt = *fn ? 1 : 0;
+        for( char *cursor = fn; *cursor; ++cursor )
+          if( *cursor == '\n' ) ++cnt;
+        delete [] fn;
+        o << "kXR_statx (paths: " << cnt << ", flags: ";
+        if( sreq->options & kXR_sfull )
+          o << "kXR_sfull";
+        else
+          o << "none";
+        o << ")";
+        break;
+      }
+
       //------------------------------------------------------------------------
       // kXR_read
       //------------------------------------------------------------------------
@@ -2257,6 +2377,21 @@ namespace XrdCl
         break;
       }
 
+      //------------------------------------------------------------------------
+      // kXR_pgread
+      //------------------------------------------------------------------------
+      case kXR_pgread:
+      {
+        ClientPgReadRequest *sreq = (ClientPgReadRequest *)msg->GetBuffer();
+        o << "kXR_pgread (";
+        o << "handle: " << FileHandleToStr( sreq->fhandle );
+        o << std::setbase(10);
+        o << ", ";
+        o << "offset: " << sreq->offset << ", ";
+        o << "size: " << sreq->rlen << ")";
+        break;
+      }
+
       //------------------------------------------------------------------------
       // kXR_write
       //------------------------------------------------------------------------
@@ -46,6 +46,10 @@ namespace XrdCl
     static const uint16_t SIDManager      = 1001; //!< returns the SIDManager object
     static const uint16_t ServerFlags     = 1002; //!< returns server flags
     static const uint16_t ProtocolVersion = 1003; //!< returns the protocol version
+    static const uint16_t ReadCompressed  = 1004; //!< returns true if read
+                                                  //!< responses are compressed
+    static const uint16_t SubStreams      = 1005; //!< returns the number of
+                                                  //!< data substreams
   };
 
   //----------------------------------------------------------------------------
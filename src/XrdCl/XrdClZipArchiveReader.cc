@@ -34,7 +34,9 @@
 
 #include <string>
 #include <map>
+#include <deque>
 #include <memory>
+#include <ctime>
 
 namespace XrdCl
 {
@@ -138,12 +140,79 @@ struct CDFH
     static const uint32_t kCdfhSign     = 0x02014b50;
 };
 
+//----------------------------------------------------------------------------
+// Central directories of recently opened archives, so that opening the
+// same archive again needs no more than the open itself
+//----------------------------------------------------------------------------
+class CdCache
+{
+  public:
+
+    struct Entry
+    {
+      uint64_t    pArchiveSize;
+      time_t      pModTime;
+      uint64_t    pCdOffset;
+      uint16_t    pNbCdRec;
+      std::string pCd;
+    };
+
+    static CdCache& Instance()
+    {
+      static CdCache cache;
+      return cache;
+    }
+
+    bool Get( const std::string &url, uint64_t size, time_t mtime, Entry &entry )
+    {
+      XrdSysMutexHelper scopedLock( pMutex );
+      std::map<std::string, Entry>::iterator itr = pEntries.find( url );
+      if( itr == pEntries.end() ) return false;
+      if( itr->second.pArchiveSize != size || itr->second.pModTime != mtime )
+        return false;
+      entry = itr->second;
+      return true;
+    }
+
+    void Put( const std::string &url, const Entry &entry )
+    {
+      XrdSysMutexHelper scopedLock( pMutex );
+      std::map<std::string, Entry>::iterator itr = pEntries.find( url );
+      if( itr != pEntries.end() )
+      {
+        itr->second = entry;
+        return;
+      }
+      if( pOrder.size() >= kMaxEntries )
+      {
+        pEntries.erase( pOrder.front() );
+        pOrder.pop_front();
+      }
+      pEntries[url] = entry;
+      pOrder.push_back( url );
+    }
+
+  private:
+
+    static const size_t kMaxEntries = 256;
+
+    XrdSysMutex                   pMutex;
+    std::map<std::string, Entry>  pEntries;
+    std::deque<std::string>       pOrder;
+};
+
 
 class ZipArchiveReaderImpl
 {
   public:
 
-    ZipArchiveReaderImpl( File &archive ) : pArchive( archive ), pArchiveSize( 0 ), pRefCount( 1 ), pOpen( false ) { }
+    ZipArchiveReaderImpl( File &archive ) : pArchive( archive ), pArchiveSize( 0 ), pModTime( 0 ), pCdOffset( 0 ), pRefCount( 1 ), pOpen( false ) { }
+
+    //------------------------------------------------------------------------
+    // The tail of the archive we read in one go on open, it covers the
+    // largest EOCD record and usually the whole central directory
+    //------------------------------------------------------------------------
+    static const uint32_t kTailReadSize = 131072;
 
     ZipArchiveReaderImpl* Self()
     {
@@ -175,6 +244,8 @@ class ZipArchiveReaderImpl
 
     XRootDStatus Read( const std::string &filename, uint64_t relativeOffset, uint32_t size, void *buffer, ResponseHandler *userHandler, uint16_t timeout = 0 );
 
+    XRootDStatus VectorRead( const std::vector<std::string> &filenames, const ChunkList &chunks, ResponseHandler *userHandler, uint16_t timeout = 0 );
+
     XRootDStatus Read( uint64_t relativeOffset, uint32_t size, void *buffer, ResponseHandler *userHandler, uint16_t timeout = 0 )
     {
       if( pBoundFile.empty() )
@@ -233,7 +304,7 @@ class ZipArchiveReaderImpl
       return 0;
     }
 
-    XRootDStatus ParseCdRecords( char *buffer, uint16_t nbCdRecords, uint32_t bufferSize )
+    XRootDStatus ParseCdRecords( const char *buffer, uint16_t nbCdRecords, uint32_t bufferSize )
     {
       uint32_t offset = 0;
       pCdRecords.reserve( nbCdRecords );
@@ -242,7 +313,7 @@ class ZipArchiveReaderImpl
       {
         if( bufferSize < CDFH::kCdfhBaseSize ) break;
         // check the signature
-        uint32_t *signature = (uint32_t*)( buffer + offset );
+        const uint32_t *signature = (const uint32_t*)( buffer + offset );
         if( *signature != CDFH::kCdfhSign ) return XRootDStatus( stError, errErrorResponse, errDataError, "Central-directory-file-header signature not found." );
         // parse the record
         CDFH *cdfh = new CDFH( buffer + offset );
@@ -267,6 +338,7 @@ class ZipArchiveReaderImpl
       // worry about zip64, it is so small that standard EOCD will do
 
       // parse Central-Directory-File-Header records
+      pCdOffset = pEocd->pCdOffset;
       XRootDStatus st = ParseCdRecords( pBuffer.get() + pEocd->pCdOffset, pEocd->pNbCdRec, pEocd->pCdSize );
 
       return st;
@@ -276,11 +348,63 @@ class ZipArchiveReaderImpl
     {
       // parse Central-Directory-File-Header records
       XRootDStatus st = ParseCdRecords( pBuffer.get(), nbCdRecords, bufferSize );
+      if( st.IsOK() ) CacheCd( pBuffer.get(), nbCdRecords, bufferSize );
       // successful or not we don't need it anymore
       pBuffer.reset();
       return st;
     }
 
+    bool CdFromCache()
+    {
+      CdCache::Entry entry;
+      if( !CdCache::Instance().Get( pUrl, pArchiveSize, pModTime, entry ) )
+        return false;
+      pCdOffset = entry.pCdOffset;
+      if( !ParseCdRecords( entry.pCd.data(), entry.pNbCdRec, entry.pCd.size() ).IsOK() )
+      {
+        ClearRecords();
+        return false;
+      }
+      return true;
+    }
+
+    void CacheCd( const char *buffer, uint16_t nbCdRecords, uint32_t bufferSize )
+    {
+      CdCache::Entry entry;
+      entry.pArchiveSize = pArchiveSize;
+      entry.pModTime     = pModTime;
+      entry.pCdOffset    = pCdOffset;
+      entry.pNbCdRec     = nbCdRecords;
+      entry.pCd.assign( buffer, bufferSize );
+      CdCache::Instance().Put( pUrl, entry );
+    }
+
+    //------------------------------------------------------------------------
+    // Translate an offset relative to a file into an offset in the archive,
+    // the size is trimmed to the end of the file
+    //------------------------------------------------------------------------
+    XRootDStatus Locate( const std::string &filename, uint64_t relativeOffset, uint32_t &size, uint64_t &offset )
+    {
+      std::map<std::string, size_t>::iterator cditr = pFileToCdfh.find( filename );
+      if( cditr == pFileToCdfh.end() ) return XRootDStatus( stError, errNotFound, errNotFound, "File not found." );
+      CDFH *cdfh = pCdRecords[cditr->second];
+
+      // Now the problem is that at the beginning of our
+      // file there is the Local-file-header, which size
+      // is not known because of the variable size 'extra'
+      // field, so we need to know the offset of the next
+      // record and shift it by the file size.
+      // The next record is either the next LFH (next file)
+      // or the start of the Central-directory.
+      uint64_t nextRecordOffset = ( cditr->second + 1 < pCdRecords.size() ) ? pCdRecords[cditr->second + 1]->pOffset : pCdOffset;
+      uint32_t fileSize = cdfh->pCompressionMethod ? cdfh->pCompressedSize : cdfh->pUncompressedSize;
+      if( relativeOffset > fileSize ) return XRootDStatus( stError, errInvalidArgs, errInvalidArgs, "Offset beyond the end of file." );
+      offset = nextRecordOffset - fileSize + relativeOffset;
+      uint32_t sizeTillEnd = fileSize - relativeOffset;
+      if( size > sizeTillEnd ) size = sizeTillEnd;
+      return XRootDStatus();
+    }
+
   private:
 
     void ClearRecords()
@@ -294,6 +418,7 @@ class ZipArchiveReaderImpl
       pFileToCdfh.clear();
 
       pBoundFile.erase();
+      pCdOffset = 0;
     }
 
     ~ZipArchiveReaderImpl()
@@ -311,7 +436,10 @@ class ZipArchiveReaderImpl
     }
 
     File                          &pArchive;
+    std::string                    pUrl;
     uint64_t                       pArchiveSize;
+    time_t                         pModTime;
+    uint64_t                       pCdOffset;
     std::unique_ptr<char[]>        pBuffer;
     std::unique_ptr<EOCD>          pEocd;
     std::unique_ptr<ZIP64_EOCD>    pZip64Eocd;
@@ -462,33 +590,6 @@ class ZipOpenHandler : public ZipHandlerBase<void>
 };
 
 
-class StatArchiveHandler : public ZipHandlerBase<StatInfo>
-{
-  public:
-
-    StatArchiveHandler( ZipArchiveReaderImpl *impl, ResponseHandler *userHandler ): ZipHandlerBase<StatInfo>( impl, userHandler ) { }
-
-    virtual void HandleResponseImpl( XRootDStatus *status, StatInfo *response )
-    {
-      uint64_t size = response->GetSize();
-      pImpl->SetArchiveSize( size );
-
-      // if the size of the file is smaller than the maximum comment size +
-      // EOCD size simply download the whole file, otherwise download the EOCD
-      XRootDStatus st = ( size <= EOCD::kMaxCommentSize + EOCD::kEocdBaseSize + ZIP64_EOCDL::kZip64EocdlSize ) ?
-                        pImpl->ReadArchive( pUserHandler ) :
-                        pImpl->ReadEocd( pUserHandler );
-      if( !st.IsOK() )
-      {
-        *status = st;
-        throw ZipHandlerException<StatInfo>( status, response );
-      }
-
-      DeleteArgs( status, response );
-    }
-};
-
-
 class ReadArchiveHandler : public ZipHandlerBase<ChunkInfo>
 {
   public:
@@ -582,6 +683,29 @@ class ZipReadHandler : public ZipHandlerBase<ChunkInfo>
 };
 
 
+class ZipVectorReadHandler : public ZipHandlerBase<VectorReadInfo>
+{
+  public:
+
+    ZipVectorReadHandler( const ChunkList &chunks, ZipArchiveReaderImpl *impl, ResponseHandler *userHandler ) : ZipHandlerBase<VectorReadInfo>( impl, userHandler ), pChunks( chunks ) { }
+
+    virtual void HandleResponseImpl( XRootDStatus *status, VectorReadInfo *response )
+    {
+      // the chunks come back in the order they were requested
+      ChunkList &chunks = response->GetChunks();
+      for( size_t i = 0; i < chunks.size() && i < pChunks.size(); ++i )
+        chunks[i].offset = pChunks[i].offset;
+      if( pUserHandler ) pUserHandler->HandleResponse( status, PkgResp( response ) );
+      else
+        DeleteArgs( status, response );
+    }
+
+  private:
+
+    ChunkList pChunks;
+};
+
+
 ZipArchiveReader::ZipArchiveReader( File &archive ) : pImpl( new ZipArchiveReaderImpl( archive ) )
 {
 
@@ -596,6 +720,7 @@ ZipArchiveReader::~ZipArchiveReader()
 
 XRootDStatus ZipArchiveReaderImpl::Open( const std::string &url, ResponseHandler *userHandler, uint16_t timeout )
 {
+  pUrl = url;
   ZipOpenHandler *handler = new ZipOpenHandler( this, userHandler );
   XRootDStatus st = pArchive.Open( url, OpenFlags::Read, Access::None, handler, timeout );
   if( !st.IsOK() ) delete handler;
@@ -627,10 +752,26 @@ XRootDStatus ZipArchiveReaderImpl::StatArchive( ResponseHandler *userHandler )
   // just to be on the safe side
   ClearRecords();
 
-  StatArchiveHandler *handler = new StatArchiveHandler( this, userHandler );
-  XRootDStatus st = pArchive.Stat( true, handler );
-  if( !st.IsOK() ) delete handler;
-  return st;
+  // the open response carries the stat information so normally
+  // this does not cost a round trip
+  StatInfo *infoptr = 0;
+  XRootDStatus st = pArchive.Stat( false, infoptr );
+  if( !st.IsOK() ) return st;
+  std::unique_ptr<StatInfo> info( infoptr );
+  pArchiveSize = info->GetSize();
+  pModTime     = info->GetModTime();
+
+  // we might have seen this archive already
+  if( pArchiveSize > kTailReadSize && CdFromCache() )
+  {
+    if( userHandler ) userHandler->HandleResponse( new XRootDStatus(), 0 );
+    return XRootDStatus();
+  }
+
+  // if the archive is not bigger than the tail we would read
+  // simply download the whole file, otherwise read the tail
+  return ( pArchiveSize <= kTailReadSize ) ? ReadArchive( userHandler ) :
+                                             ReadEocd( userHandler );
 }
 
 XRootDStatus ZipArchiveReaderImpl::ReadArchive( ResponseHandler *userHandler )
@@ -646,7 +787,7 @@ XRootDStatus ZipArchiveReaderImpl::ReadArchive( ResponseHandler *userHandler )
 
 XRootDStatus ZipArchiveReaderImpl::ReadEocd( ResponseHandler *userHandler )
 {
-  uint32_t size   = EOCD::kMaxCommentSize + EOCD::kEocdBaseSize + ZIP64_EOCDL::kZip64EocdlSize;
+  uint32_t size   = kTailReadSize;
   uint64_t offset = pArchiveSize - size;
   pBuffer.reset( new char[size] );
   ReadEocdHandler *handler = new ReadEocdHandler( this, userHandler );
@@ -661,6 +802,9 @@ XRootDStatus ZipArchiveReaderImpl::ReadCdfh( uint64_t bytesRead, ResponseHandler
   if( !eocdBlock ) throw ZipHandlerException<AnyObject>( new XRootDStatus( stError, errDataError, errDataError, "End-of-central-directory signature not found." ), 0 );
   pEocd.reset( new EOCD( eocdBlock ) );
 
+  // the offset at which we did the read
+  uint64_t buffOffset = pArchiveSize - bytesRead;
+
   // Let's see if it is ZIP64 (if yes, the EOCD will be preceded with ZIP64 EOCD locator)
   char *zip64EocdlBlock = eocdBlock - ZIP64_EOCDL::kZip64EocdlSize;
   // make sure there is enough data to assume there's a ZIP64 EOCD locator
@@ -670,8 +814,6 @@ XRootDStatus ZipArchiveReaderImpl::ReadCdfh( uint64_t bytesRead, ResponseHandler
     if( *signature == ZIP64_EOCDL::kZip64EocdlSign )
     {
       std::unique_ptr<ZIP64_EOCDL> eocdl( new ZIP64_EOCDL( zip64EocdlBlock ) );
-      // the offset at which we did the read
-      uint64_t buffOffset = pArchiveSize - bytesRead;
       if( buffOffset > eocdl->pZip64EocdOffset )
       {
         // we need to read more data
@@ -695,8 +837,22 @@ XRootDStatus ZipArchiveReaderImpl::ReadCdfh( uint64_t bytesRead, ResponseHandler
     */
   }
 
-  uint64_t offset = pZip64Eocd ? pZip64Eocd->pCdOffset : pEocd->pCdOffset;
+  pCdOffset       = pZip64Eocd ? pZip64Eocd->pCdOffset : pEocd->pCdOffset;
+  uint64_t offset = pCdOffset;
   uint32_t size   = pZip64Eocd ? pZip64Eocd->pCdSize   : pEocd->pCdSize;
+
+  // usually the central directory came with the tail, so there
+  // is no need to read it again
+  if( offset >= buffOffset && offset + size <= pArchiveSize )
+  {
+    XRootDStatus st = ParseCdRecords( pBuffer.get() + ( offset - buffOffset ), pEocd->pNbCdRec, size );
+    if( st.IsOK() ) CacheCd( pBuffer.get() + ( offset - buffOffset ), pEocd->pNbCdRec, size );
+    pBuffer.reset();
+    // in fact this is the result of open
+    if( userHandler ) userHandler->HandleResponse( new XRootDStatus( st ), 0 );
+    return XRootDStatus();
+  }
+
   pBuffer.reset( new char[size] );
   ReadCdfhHandler *handler = new ReadCdfhHandler( this, userHandler, pEocd->pNbCdRec );
   XRootDStatus st = pArchive.Read( offset, size, pBuffer.get(), handler );
@@ -762,6 +918,27 @@ XRootDStatus ZipArchiveReader::Read( uint64_t offset, uint32_t size, void *buffe
   return status;
 }
 
+//------------------------------------------------------------------------
+// Async vector read.
+//------------------------------------------------------------------------
+XRootDStatus ZipArchiveReader::VectorRead( const std::vector<std::string> &filenames, const ChunkList &chunks, ResponseHandler *handler, uint16_t timeout )
+{
+  return pImpl->VectorRead( filenames, chunks, handler, timeout );
+}
+
+//------------------------------------------------------------------------
+// Sync vector read.
+//------------------------------------------------------------------------
+XRootDStatus ZipArchiveReader::VectorRead( const std::vector<std::string> &filenames, const ChunkList &chunks, VectorReadInfo *&vReadInfo, uint16_t timeout )
+{
+  SyncResponseHandler handler;
+  Status st = VectorRead( filenames, chunks, &handler, timeout );
+  if( !st.IsOK() )
+    return st;
+
+  return MessageUtils::WaitForResponse( &handler, vReadInfo );
+}
+
 //------------------------------------------------------------------------
 // Sync list
 //------------------------------------------------------------------------
@@ -778,22 +955,9 @@ XRootDStatus ZipArchiveReaderImpl::Read( const std::string &filename, uint64_t r
 {
   if( !pArchive.IsOpen() ) return XRootDStatus( stError, errInvalidOp, errInvalidOp, "Archive not opened." );
 
-  std::map<std::string, size_t>::iterator cditr = pFileToCdfh.find( filename );
-  if( cditr == pFileToCdfh.end() ) return XRootDStatus( stError, errNotFound, errNotFound, "File not found." );
-  CDFH *cdfh = pCdRecords[cditr->second];
-
-  // Now the problem is that at the beginning of our
-  // file there is the Local-file-header, which size
-  // is not known because of the variable size 'extra'
-  // field, so we need to know the offset of the next
-  // record and shift it by the file size.
-  // The next record is either the next LFH (next file)
-  // or the start of the Central-directory.
-  uint64_t nextRecordOffset = ( cditr->second + 1 < pCdRecords.size() ) ? pCdRecords[cditr->second + 1]->pOffset : pEocd->pCdOffset;
-  uint32_t fileSize = cdfh->pCompressionMethod ? cdfh->pCompressedSize : cdfh->pUncompressedSize;
-  uint64_t offset = nextRecordOffset - fileSize + relativeOffset;
-  uint32_t sizeTillEnd = fileSize - relativeOffset;
-  if( size > sizeTillEnd ) size = sizeTillEnd;
+  uint64_t offset = 0;
+  XRootDStatus st = Locate( filename, relativeOffset, size, offset );
+  if( !st.IsOK() ) return st;
 
   // check if we have the whole file in our local buffer
   if( pBuffer )
@@ -818,7 +982,60 @@ XRootDStatus ZipArchiveReaderImpl::Read( const std::string &filename, uint64_t r
   }
 
   ZipReadHandler *handler = new ZipReadHandler( relativeOffset, this, userHandler );
-  XRootDStatus st = pArchive.Read( offset, size, buffer, handler, timeout );
+  st = pArchive.Read( offset, size, buffer, handler, timeout );
+  if( !st.IsOK() ) delete handler;
+
+  return st;
+}
+
+XRootDStatus ZipArchiveReaderImpl::VectorRead( const std::vector<std::string> &filenames, const ChunkList &chunks, ResponseHandler *userHandler, uint16_t timeout )
+{
+  if( !pArchive.IsOpen() ) return XRootDStatus( stError, errInvalidOp, errInvalidOp, "Archive not opened." );
+  if( filenames.size() != chunks.size() ) return XRootDStatus( stError, errInvalidArgs );
+
+  // translate the chunks, the data goes straight into the user buffers
+  ChunkList archiveChunks;
+  archiveChunks.reserve( chunks.size() );
+  for( size_t i = 0; i < chunks.size(); ++i )
+  {
+    uint32_t size   = chunks[i].length;
+    uint64_t offset = 0;
+    XRootDStatus st = Locate( filenames[i], chunks[i].offset, size, offset );
+    if( !st.IsOK() ) return st;
+    archiveChunks.push_back( ChunkInfo( offset, size, chunks[i].buffer ) );
+  }
+
+  // check if we have the whole file in our local buffer
+  if( pBuffer )
+  {
+    VectorReadInfo *info = new VectorReadInfo();
+    uint32_t total = 0;
+    for( size_t i = 0; i < archiveChunks.size(); ++i )
+    {
+      if( archiveChunks[i].offset + archiveChunks[i].length > pArchiveSize )
+      {
+        delete info;
+        if( userHandler ) userHandler->HandleResponse( new XRootDStatus( stError, errDataError ), 0 );
+        return XRootDStatus( stError, errDataError );
+      }
+      memcpy( archiveChunks[i].buffer, pBuffer.get() + archiveChunks[i].offset, archiveChunks[i].length );
+      info->GetChunks().push_back( ChunkInfo( chunks[i].offset, archiveChunks[i].length, archiveChunks[i].buffer ) );
+      total += archiveChunks[i].length;
+    }
+    info->SetSize( total );
+
+    if( userHandler )
+    {
+      AnyObject *resp = new AnyObject();
+      resp->Set( info );
+      userHandler->HandleResponse( new XRootDStatus(), resp );
+    }
+    else delete info;
+    return XRootDStatus();
+  }
+
+  ZipVectorReadHandler *handler = new ZipVectorReadHandler( chunks, this, userHandler );
+  XRootDStatus st = pArchive.VectorRead( archiveChunks, 0, handler, timeout );
   if( !st.IsOK() ) delete handler;
 
   return st;
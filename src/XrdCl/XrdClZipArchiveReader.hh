@@ -64,11 +64,16 @@ class ZipArchiveReader
     //!
     //! During the open, the End-of-central-directory record
     //! and the Central-directory-file-headers records are
-    //! being read and parsed.
+    //! being read and parsed. Both are looked for in a single
+    //! read of the tail of the archive, the central directory
+    //! is only read separately if it does not fit in there.
+    //! The parsed central directory is cached per archive URL
+    //! and reused as long as the archive size and modification
+    //! time do not change.
     //!
-    //! If the ZIP archive is smaller than the maximum size
-    //! of the EOCD record the whole archive is being down-
-    //! loaded and kept in local memory.
+    //! If the ZIP archive is smaller than the tail read the
+    //! whole archive is being downloaded and kept in local
+    //! memory.
     //!
     //! @param url     : URL of the archive
     //! @param handler : the handler for the async operation
@@ -117,6 +122,27 @@ class ZipArchiveReader
     //------------------------------------------------------------------------
     XRootDStatus Read( uint64_t offset, uint32_t size, void *buffer, uint32_t &bytesRead, uint16_t timeout = 0 );
 
+    //------------------------------------------------------------------------
+    //! Async vector read, the chunks may refer to different files and all of
+    //! them are read from the archive with a single vector read.
+    //!
+    //! @param filenames : names of the files the chunks refer to, one for
+    //!                    each chunk
+    //! @param chunks    : the chunks to read, offsets are relative for the
+    //!                    respective file and each chunk has its own buffer
+    //! @param handler   : the handler for the async operation, the response
+    //!                    is a VectorReadInfo with the relative offsets
+    //! @param timeout   : the timeout of the async operation
+    //!
+    //! @return          : OK on success, error otherwise
+    //------------------------------------------------------------------------
+    XRootDStatus VectorRead( const std::vector<std::string> &filenames, const ChunkList &chunks, ResponseHandler *handler, uint16_t timeout = 0 );
+
+    //------------------------------------------------------------------------
+    //! Sync vector read.
+    //------------------------------------------------------------------------
+    XRootDStatus VectorRead( const std::vector<std::string> &filenames, const ChunkList &chunks, VectorReadInfo *&vReadInfo, uint16_t timeout = 0 );
+
     //------------------------------------------------------------------------
     //! Sync list
     //------------------------------------------------------------------------
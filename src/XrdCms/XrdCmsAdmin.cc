@@ -42,6 +42,7 @@
 #include "XrdCms/XrdCmsAdmin.hh"
 #include "XrdCms/XrdCmsConfig.hh"
 #include "XrdCms/XrdCmsManager.hh"
+#include "XrdCms/XrdCmsNSMap.hh"
 #include "XrdCms/XrdCmsPrepare.hh"
 #include "XrdCms/XrdCmsState.hh"
 #include "XrdCms/XrdCmsTrace.hh"
@@ -801,6 +802,10 @@ void XrdCmsAdmin::do_RmDud(int isPfn)
           } else tp = apath;
       }
 
+// Make sure our namespace map includes the file
+//
+   NSPub.Added(tp);
+
 // Check if we are relaying remove events and, if so, vector through that.
 //
    if (areFunc) AddEvent(tp, kYR_have, Mods);
@@ -63,13 +63,13 @@ public:
 
 void   DoIt() {Cache.Recycle(myList); delete this;}
 
-       XrdCmsCacheJob(XrdCmsKeyItem *List)
-                     : XrdJob("cache scrubber"), myList(List) {}
+       XrdCmsCacheJob(XrdCmsKeyItem **List) : XrdJob("cache scrubber")
+                     {memcpy(myList, List, sizeof(myList));}
       ~XrdCmsCacheJob() {}
 
 private:
 
-XrdCmsKeyItem *myList;
+XrdCmsKeyItem *myList[XrdCmsCache::shardNum];
 };
 
 /******************************************************************************/
@@ -116,18 +116,19 @@ void *XrdCmsStartTickTock(void *carg)
   
 int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
 {
+   CacheShard &cS = Shard(Sel.Path);
    XrdCmsKeyItem *iP;
    SMask_t xmask;
    int isrw = (Sel.Opts & XrdCmsSelect::Write), isnew = 0;
 
 // Serialize processing
 //
-   myMutex.Lock();
+   cS.Mutex.Lock();
 
 // Check for fast path processing
 //
    if (  !(iP = Sel.Path.TODRef) || !(iP->Key.Equiv(Sel.Path)))
-      if ((iP = Sel.Path.TODRef = CTable.Find(Sel.Path)))
+      if ((iP = Sel.Path.TODRef = cS.Table.Find(Sel.Path)))
          Sel.Path.Ref = iP->Key.Ref;
 
 // Add/Modify the entry
@@ -137,8 +138,9 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
           {iP->Loc.deadline = QDelay + time(0);
            iP->Loc.lifeline = nilTMO + iP->Loc.deadline;
            iP->Loc.hfvec = 0; iP->Loc.pfvec = 0; iP->Loc.qfvec = 0;
+           iP->Loc.nfvec = 0;
            iP->Loc.TOD_B = BClock;
-           iP->Key.TOD = Tock;
+           iP->Key.TOD = cS.Tock;
           } else {
            xmask = iP->Loc.pfvec;
            if (Sel.Opts & XrdCmsSelect::Pending) iP->Loc.pfvec |= mask;
@@ -146,6 +148,7 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
            isnew = (iP->Loc.hfvec == 0) || (iP->Loc.pfvec != xmask);
            iP->Loc.hfvec |=  mask;
            iP->Loc.qfvec &= ~mask;
+           iP->Loc.nfvec &= ~mask;
            if (isrw) {iP->Loc.deadline = 0;
                       if (iP->Loc.roPend || iP->Loc.rwPend)
                          Dispatch(Sel, iP, iP->Loc.roPend, iP->Loc.rwPend);
@@ -155,12 +158,13 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
                      }
           }
       } else if (!(Sel.Opts & XrdCmsSelect::Advisory))
-                {Sel.Path.TOD = Tock;
-                 if ((iP = CTable.Add(Sel.Path)))
+                {Sel.Path.TOD = cS.Tock;
+                 if ((iP = cS.Table.Add(Sel.Path, cS.TockTab)))
                     {iP->Loc.pfvec    = (Sel.Opts&XrdCmsSelect::Pending?mask:0);
                      iP->Loc.hfvec    = mask;
                      iP->Loc.TOD_B    = BClock;
                      iP->Loc.qfvec    = 0;
+                     iP->Loc.nfvec    = 0;
                      iP->Loc.deadline = QDelay + time(0);
                      iP->Loc.lifeline = nilTMO + iP->Loc.deadline;
                      Sel.Path.Ref     = iP->Key.Ref;
@@ -170,7 +174,7 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
 
 // All done
 //
-   myMutex.UnLock();
+   cS.Mutex.UnLock();
    return isnew;
 }
   
@@ -190,29 +194,30 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
   
 int XrdCmsCache::DelFile(XrdCmsSelect &Sel, SMask_t mask)
 {
+   CacheShard &cS = Shard(Sel.Path);
    XrdCmsKeyItem *iP;
    int gone4good;
 
 // Lock the hash table
 //
-   myMutex.Lock();
+   cS.Mutex.Lock();
 
 // Look up the entry and remove server
 //
-   if ((iP = CTable.Find(Sel.Path)))
+   if ((iP = cS.Table.Find(Sel.Path)))
       {iP->Loc.hfvec &= ~mask;
        iP->Loc.pfvec &= ~mask;
        if ((gone4good = (iP->Loc.hfvec == 0)))
           {if (nilTMO) iP->Loc.lifeline = nilTMO + time(0);
            if (!(Sel.Opts & XrdCmsSelect::Advisory)
-           &&  XrdCmsKeyItem::Unload(iP) && !CTable.Recycle(iP))
+           &&  XrdCmsKeyItem::Unload(cS.TockTab, iP) && !cS.Table.Recycle(iP))
               Say.Emsg("DelFile", "Delete failed for", iP->Key.Val);
           }
       } else gone4good = 0;
 
 // All done
 //
-   myMutex.UnLock();
+   cS.Mutex.UnLock();
    return gone4good;
 }
   
@@ -231,22 +236,27 @@ int XrdCmsCache::DelFile(XrdCmsSelect &Sel, SMask_t mask)
   
 int  XrdCmsCache::GetFile(XrdCmsSelect &Sel, SMask_t mask)
 {
+   CacheShard &cS = Shard(Sel.Path);
    XrdCmsKeyItem *iP;
    SMask_t bVec;
    int retc;
 
 // Lock the hash table
 //
-   myMutex.Lock();
+   cS.Mutex.Lock();
 
-// Look up the entry and return location information
+// Look up the entry and return location information. The bounce information
+// is shared by all shards and is only read here.
 //
-   if ((iP = CTable.Find(Sel.Path)))
-      {if ((bVec = (iP->Loc.TOD_B < BClock 
-                 ? getBVec(iP->Key.TOD, iP->Loc.TOD_B) & mask : 0)))
+   if ((iP = cS.Table.Find(Sel.Path)))
+      {cS.Hits++;
+       bvLock.ReadLock();
+       if ((bVec = (iP->Loc.TOD_B < BClock 
+                 ? getBVec(cS, iP->Key.TOD, iP->Loc.TOD_B) & mask : 0)))
           {iP->Loc.hfvec &= ~bVec; 
            iP->Loc.pfvec &= ~bVec;
            iP->Loc.qfvec &= ~mask;
+           iP->Loc.nfvec &= ~bVec;
            iP->Loc.deadline = QDelay + time(0);
            iP->Loc.lifeline = nilTMO + iP->Loc.deadline;
            retc = -1;
@@ -262,15 +272,57 @@ int  XrdCmsCache::GetFile(XrdCmsSelect &Sel, SMask_t mask)
        Sel.Vec.pf      = okVec & iP->Loc.pfvec;
        Sel.Vec.bf      = okVec & (bVec | iP->Loc.qfvec); iP->Loc.qfvec = 0;
        Sel.Path.Ref    = iP->Key.Ref;
-      } else retc = 0;
+       bvLock.ReadUnLock();
+      } else {cS.Miss++; retc = 0;}
 
 // All done
 //
-   myMutex.UnLock();
+   cS.Mutex.UnLock();
    Sel.Path.TODRef = iP;
    return retc;
 }
 
+/******************************************************************************/
+/* Public                       M i s s F i l e                               */
+/******************************************************************************/
+
+// This method is called when managers below us report that they definitely
+// do not have the file. Once all of the nodes that could have the file say
+// so there is no point in waiting for the query deadline. So, we settle the
+// query right away and let waiting redirectors retry to get the final answer.
+  
+int XrdCmsCache::MissFile(XrdCmsSelect &Sel, SMask_t mask, SMask_t qmask)
+{
+   EPNAME("MissFile");
+   CacheShard &cS = Shard(Sel.Path);
+   XrdCmsKeyItem *iP;
+   int settled = 0;
+
+// Lock the hash table
+//
+   cS.Mutex.Lock();
+
+// Look up the entry and record the nodes that do not have the file
+//
+   if ((iP = cS.Table.Find(Sel.Path)))
+      {iP->Loc.hfvec &= ~mask;
+       iP->Loc.pfvec &= ~mask;
+       iP->Loc.nfvec |=  mask;
+       if (!iP->Loc.hfvec && qmask && (iP->Loc.nfvec & qmask) == qmask
+       &&  iP->Loc.deadline)
+          {iP->Loc.deadline = 0; settled = 1;
+           if (iP->Loc.roPend) {RRQ.Del(iP->Loc.roPend, iP); iP->Loc.roPend=0;}
+           if (iP->Loc.rwPend) {RRQ.Del(iP->Loc.rwPend, iP); iP->Loc.rwPend=0;}
+          }
+      }
+
+// All done
+//
+   cS.Mutex.UnLock();
+   DEBUG("rc=" <<settled <<" path=" <<Sel.Path.Val);
+   return settled;
+}
+
 /******************************************************************************/
 /* Public                        U n k F i l e                                */
 /******************************************************************************/
@@ -278,23 +330,25 @@ int  XrdCmsCache::GetFile(XrdCmsSelect &Sel, SMask_t mask)
 int XrdCmsCache::UnkFile(XrdCmsSelect &Sel, SMask_t mask)
 {
    EPNAME("UnkFile");
+   CacheShard &cS = Shard(Sel.Path);
    XrdCmsKeyItem *iP;
 
 // Make sure we have the proper information. If so, lock the hash table
 //
-   myMutex.Lock();
+   cS.Mutex.Lock();
 
-// Look up the entry and if valid update the unqueried vector. Note that
-// this method may only be called after GetFile() or AddFile() for a new entry
+// Look up the entry and if valid update the unqueried vector. Normally this
+// method is called after GetFile() or AddFile() for a new entry. Otherwise,
+// (e.g. a batched query was sent later on) we find the entry and add to it.
 //
    if ((iP = Sel.Path.TODRef))
       {if (iP->Key.Equiv(Sel.Path)) iP->Loc.qfvec = mask;
           else iP = 0;
-      }
+      } else if ((iP = cS.Table.Find(Sel.Path))) iP->Loc.qfvec |= mask;
 
 // Return result
 //
-   myMutex.UnLock();
+   cS.Mutex.UnLock();
    DEBUG("rc=" <<(iP ? 1 : 0) <<" path=" <<Sel.Path.Val);
    return (iP ? 1 : 0);
 }
@@ -313,7 +367,8 @@ int XrdCmsCache::WT4File(XrdCmsSelect &Sel, SMask_t mask)
 // Make sure we have the proper information. If so, lock the hash table
 //
    if (!Sel.InfoP) return DLTime;
-   myMutex.Lock();
+   CacheShard &cS = Shard(Sel.Path);
+   cS.Mutex.Lock();
 
 // Look up the entry and if valid add it to the callback queue. Note that
 // this method may only be called after GetFile() or AddFile() for a new entry
@@ -328,7 +383,7 @@ int XrdCmsCache::WT4File(XrdCmsSelect &Sel, SMask_t mask)
 
 // Return result
 //
-   myMutex.UnLock();
+   cS.Mutex.UnLock();
    DEBUG("rc=" <<retc <<" path=" <<Sel.Path.Val);
    return retc;
 }
@@ -345,11 +400,11 @@ void XrdCmsCache::Bounce(SMask_t smask, int SNum)
 
 // Simply indicate that this server bounced
 //
-   myMutex.Lock();
+   bvLock.WriteLock();
    Bounced[SNum] = ++BClock;
    okVec |= smask;
    if (SNum > vecHi) vecHi = SNum;
-   myMutex.UnLock();
+   bvLock.WriteUnLock();
 }
 
 /******************************************************************************/
@@ -366,11 +421,11 @@ void XrdCmsCache::Drop(SMask_t smask, int SNum, int xHi)
 
 // Remove the node from the list of valid nodes
 //
-   myMutex.Lock();
+   bvLock.WriteLock();
    Bounced[SNum] = 0;
    okVec &= nmask;
    vecHi = xHi;
-   myMutex.UnLock();
+   bvLock.WriteUnLock();
 }
 
 /******************************************************************************/
@@ -379,7 +434,6 @@ void XrdCmsCache::Drop(SMask_t smask, int SNum, int xHi)
   
 int XrdCmsCache::Init(int fxHold, int fxDelay, int fxQuery, int seFS, int nxHold)
 {
-   XrdCmsKeyItem *iP;
    pthread_t tid;
 
 // Indicate whether we are a shared-everything setup as this changes how we
@@ -411,32 +465,78 @@ int XrdCmsCache::Init(int fxHold, int fxDelay, int fxQuery, int seFS, int nxHold
 
 // Get the first reserve of cache items
 //
-   iP = XrdCmsKeyItem::Alloc(0);
-   XrdCmsKeyItem::Unload((unsigned int)0);
-   iP->Recycle();
+   XrdCmsKeyItem::Replenish();
 
 // All done
 //
    return 1;
 }
 
+/******************************************************************************/
+/* public                          S t a t s                                  */
+/******************************************************************************/
+  
+int XrdCmsCache::Stats(char *bfr, int bln)
+{
+   static const char statfmt1[] = "<cache><n>%d</n>";
+   static const char statfmt2[] = "<s id=\"%d\"><h>%lld</h><m>%lld</m>"
+                                  "<n>%d</n></s>";
+   static const char statfmt3[] = "</cache>";
+   long long Hits, Miss;
+   int i, mlen, num, tlen;
+
+// Check if actual length wanted
+//
+   if (!bfr) return sizeof(statfmt1) + 10 + sizeof(statfmt3)
+                 + (sizeof(statfmt2) + 10 + 20*2 + 10) * shardNum;
+
+// Format the header
+//
+   if ((tlen = snprintf(bfr, bln, statfmt1, shardNum)) >= bln) return 0;
+
+// Add each shard. Each one is locked in turn so the totals are not a
+// snapshot of the whole cache, which does not matter for statistics.
+//
+   for (i = 0; i < shardNum; i++)
+       {Shards[i].Mutex.Lock();
+        Hits = Shards[i].Hits; Miss = Shards[i].Miss;
+        num  = Shards[i].Table.Num();
+        Shards[i].Mutex.UnLock();
+        mlen = snprintf(bfr+tlen, bln-tlen, statfmt2, i, Hits, Miss, num);
+        if ((tlen += mlen) >= bln) return 0;
+       }
+
+// Finish up
+//
+   if (bln - tlen < (int)sizeof(statfmt3)) return 0;
+   strcpy(bfr+tlen, statfmt3);
+   return tlen + sizeof(statfmt3) - 1;
+}
+
 /******************************************************************************/
 /* public                       T i c k T o c k                               */
 /******************************************************************************/
 
 void *XrdCmsCache::TickTock()
 {
-   XrdCmsKeyItem *iP;
+   XrdCmsKeyItem *iP[shardNum];
+   bool doJob;
 
-// Simply adjust the clock and trim old entries
+// Simply adjust the clock and trim old entries. Each shard is done on its own
+// so that lookups are only held up for the time it takes to sweep one shard.
 //
    do {XrdSysTimer::Snooze(Tick);
-       myMutex.Lock();
-       Tock = (Tock+1) & XrdCmsKeyItem::TickMask;
-       Bhistory[Tock].Start = Bhistory[Tock].End = 0;
-       iP = XrdCmsKeyItem::Unload(Tock);
-       myMutex.UnLock();
-       if (iP) Sched->Schedule((XrdJob *)new XrdCmsCacheJob(iP));
+       doJob = false;
+       for (int i = 0; i < shardNum; i++)
+           {CacheShard &cS = Shards[i];
+            cS.Mutex.Lock();
+            cS.Tock = (cS.Tock+1) & XrdCmsKeyItem::TickMask;
+            cS.Bhistory[cS.Tock].Start = cS.Bhistory[cS.Tock].End = 0;
+            if ((iP[i] = XrdCmsKeyItem::Unload(cS.TockTab, cS.Tock)))
+               doJob = true;
+            cS.Mutex.UnLock();
+           }
+       if (doJob) Sched->Schedule((XrdJob *)new XrdCmsCacheJob(iP));
       } while(1);
 
 // Keep compiler happy
@@ -502,7 +602,10 @@ void XrdCmsCache::Dispatch(XrdCmsSelect &Sel, XrdCmsKeyItem *iP,
 /*                               g e t B V e c                                */
 /******************************************************************************/
   
-SMask_t XrdCmsCache::getBVec(unsigned int TODa, unsigned int &TODb)
+// The caller must hold the shard mutex and at least a read lock on bvLock.
+
+SMask_t XrdCmsCache::getBVec(CacheShard &cS, unsigned int TODa,
+                                             unsigned int &TODb)
 {
    EPNAME("getBVec");
    SMask_t BVec(0);
@@ -510,20 +613,20 @@ SMask_t XrdCmsCache::getBVec(unsigned int TODa, unsigned int &TODb)
 
 // See if we can use a previously calculated bVec
 //
-   if (Bhistory[TODa].End == BClock && Bhistory[TODa].Start <= TODb)
-      {Bhits++; TODb = BClock; return Bhistory[TODa].Vec;}
+   if (cS.Bhistory[TODa].End == BClock && cS.Bhistory[TODa].Start <= TODb)
+      {cS.Bhits++; TODb = BClock; return cS.Bhistory[TODa].Vec;}
 
 // Calculate the new vector
 //
    for (i = 0; i <= vecHi; i++)
-       if (TODb < Bounced[i]) BVec |= 1ULL << i;
-
-   Bhistory[TODa].Vec   = BVec;
-   Bhistory[TODa].Start = TODb;
-   Bhistory[TODa].End   = BClock;
-   TODb                 = BClock;
-   Bmiss++;
-   if (!(Bmiss & 0xff)) DEBUG("hits=" <<Bhits <<" miss=" <<Bmiss);
+       if (TODb < Bounced[i]) BVec |= SMask_t::Bit(i);
+
+   cS.Bhistory[TODa].Vec   = BVec;
+   cS.Bhistory[TODa].Start = TODb;
+   cS.Bhistory[TODa].End   = BClock;
+   TODb                    = BClock;
+   cS.Bmiss++;
+   if (!(cS.Bmiss & 0xff)) DEBUG("hits=" <<cS.Bhits <<" miss=" <<cS.Bmiss);
    return BVec;
 }
 
@@ -531,36 +634,33 @@ SMask_t XrdCmsCache::getBVec(unsigned int TODa, unsigned int &TODb)
 /*                               R e c y c l e                                */
 /******************************************************************************/
   
-void XrdCmsCache::Recycle(XrdCmsKeyItem *theList)
+void XrdCmsCache::Recycle(XrdCmsKeyItem **theList)
 {
    XrdCmsKeyItem *iP;
    char msgBuff[100];
    int numNull, numHave, numFree, numRecycled = 0;
 
-// Recycle the list of cache items, as needed
-//
-   while((iP = theList))
-        {theList = iP->Key.TODRef;
-         if (iP->Loc.roPend) RRQ.Del(iP->Loc.roPend, iP);
-         if (iP->Loc.rwPend) RRQ.Del(iP->Loc.rwPend, iP);
-         myMutex.Lock(); CTable.Recycle(iP); myMutex.UnLock();
-         numRecycled++;
-        }
+// Recycle the list of cache items for each shard, as needed
+//
+   for (int i = 0; i < shardNum; i++)
+       while((iP = theList[i]))
+            {theList[i] = iP->Key.TODRef;
+             if (iP->Loc.roPend) RRQ.Del(iP->Loc.roPend, iP);
+             if (iP->Loc.rwPend) RRQ.Del(iP->Loc.rwPend, iP);
+             Shards[i].Mutex.Lock();
+             Shards[i].Table.Recycle(iP);
+             Shards[i].Mutex.UnLock();
+             numRecycled++;
+            }
 
 // See if we have enough items in reserve
 //
-   myMutex.Lock();
    XrdCmsKeyItem::Stats(numHave, numFree, numNull);
    if (numFree < XrdCmsKeyItem::minFree)
-      {myMutex.UnLock();
-       if (!(numNull /= 4)) numNull = 1;
+      {if (!(numNull /= 4)) numNull = 1;
        numHave += XrdCmsKeyItem::minAlloc * numNull;
-       while(numNull--)
-            {myMutex.Lock();
-             numFree = XrdCmsKeyItem::Replenish();
-             myMutex.UnLock();
-            }
-      } else myMutex.UnLock();
+       while(numNull--) numFree = XrdCmsKeyItem::Replenish();
+      }
 
 // Log the stats
 //
@@ -37,6 +37,7 @@
 #include "XrdCms/XrdCmsKey.hh"
 #include "XrdCms/XrdCmsNash.hh"
 #include "XrdCms/XrdCmsPList.hh"
+#include "XrdSys/XrdSysDRWLock.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdCms/XrdCmsSelect.hh"
 #include "XrdCms/XrdCmsTypes.hh"
@@ -45,6 +46,7 @@ class XrdCmsCache
 {
 public:
 friend class XrdCmsCacheJob;
+friend class XrdCmsCacheSnap;
 
 XrdCmsPList_Anchor Paths;
 
@@ -61,6 +63,12 @@ int         DelFile(XrdCmsSelect &Sel, SMask_t mask);
 //
 int         GetFile(XrdCmsSelect &Sel, SMask_t mask);
 
+// MissFile() records that the nodes in mask reported the file missing and
+//            returns true if this settled the query as every node in qmask
+//            has now done so; waiting requests are then released.
+//
+int         MissFile(XrdCmsSelect &Sel, SMask_t mask, SMask_t qmask);
+
 // UnkFile() updates the unqueried vector and returns 1 upon success, 0 o/w.
 //
 int         UnkFile(XrdCmsSelect &Sel, SMask_t mask);
@@ -76,45 +84,75 @@ void        Drop(SMask_t mask, int SNum, int xHi);
 
 int         Init(int fxHold, int fxDelay, int fxQuery, int seFS, int nxHold);
 
+// Stats() formats per shard lookup statistics into bfr and returns the length
+//         or, when bfr is nil, the maximum length needed.
+//
+int         Stats(char *bfr, int bln);
+
 void       *TickTock();
 
 static const int min_nxTime = 60;
 
-            XrdCmsCache() : okVec(0), Tick(8*60*60), Tock(0), BClock(0), 
-                            nilTMO(0),
-                            DLTime(5), QDelay(5), Bhits(0), Bmiss(0), vecHi(-1),
-                            isDFS(0)
-                          {memset(Bounced,  0, sizeof(Bounced));
-                           memset(Bhistory, 0, sizeof(Bhistory));
-                          }
+// The cache is split into shards by the high order bits of the path hash.
+// Each shard has its own lock, hash table, and expiration lists so that
+// lookups of unrelated paths and the clock never contend with each other.
+//
+static const int shardBits = 5;
+static const int shardNum  = 1 << shardBits;
+
+            XrdCmsCache() : okVec(0), BClock(0), vecHi(-1), Tick(8*60*60),
+                            nilTMO(0), DLTime(5), QDelay(5), isDFS(0)
+                          {memset(Bounced,  0, sizeof(Bounced));}
            ~XrdCmsCache() {}   // Never gets deleted
 
 private:
 
+struct CacheShard
+      {XrdSysMutex    Mutex;
+       XrdCmsNash     Table;
+       XrdCmsKeyItem *TockTab[XrdCmsKeyItem::TickRate];
+       struct {SMask_t      Vec;
+               unsigned int Start;
+               unsigned int End;
+              }       Bhistory[XrdCmsKeyItem::TickRate];
+       long long      Hits;
+       long long      Miss;
+       int            Bhits;
+       int            Bmiss;
+       unsigned int   Tock;
+
+                      CacheShard() : Table(1597, 2584), Hits(0), Miss(0),
+                                     Bhits(0), Bmiss(0), Tock(0)
+                                   {memset(TockTab, 0, sizeof(TockTab));
+                                    memset((void *)Bhistory,0,sizeof(Bhistory));
+                                   }
+      };
+
+inline CacheShard &Shard(XrdCmsKey &Key)
+                        {if (!Key.Hash) Key.setHash();
+                         return Shards[Key.Hash >> (32 - shardBits)];
+                        }
+
 void          Add2Q(XrdCmsRRQInfo *Info, XrdCmsKeyItem *cp, int selOpts);
 void          Dispatch(XrdCmsSelect &Sel, XrdCmsKeyItem *cinfo,
                        short roQ, short rwQ);
-SMask_t       getBVec(unsigned int todA, unsigned int &todB);
-void          Recycle(XrdCmsKeyItem *theList);
+SMask_t       getBVec(CacheShard &cS, unsigned int todA, unsigned int &todB);
+void          Recycle(XrdCmsKeyItem **theList);
 
-struct  {SMask_t      Vec;
-         unsigned int Start;
-         unsigned int End;
-        }             Bhistory[XrdCmsKeyItem::TickRate];
+CacheShard    Shards[shardNum];
 
-XrdSysMutex   myMutex;
-XrdCmsNash    CTable;
+// The following are protected by the bvLock and describe bounced servers
+//
+XrdSysDRWLock bvLock;
 unsigned int  Bounced[STMax];
 SMask_t       okVec;
-unsigned int  Tick;
-unsigned int  Tock;
 unsigned int  BClock;
+         int  vecHi;
+
+unsigned int  Tick;
          int  nilTMO;
          int  DLTime;
          int  QDelay;
-         int  Bhits;
-         int  Bmiss;
-         int  vecHi;
          int  isDFS;
 };
 
@@ -0,0 +1,449 @@
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d C m s C a c h e S n a p . c c                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "XrdCms/XrdCmsCache.hh"
+#include "XrdCms/XrdCmsCacheSnap.hh"
+#include "XrdCms/XrdCmsNode.hh"
+#include "XrdCms/XrdCmsSelect.hh"
+#include "XrdCms/XrdCmsTrace.hh"
+
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+#include "Xrd/XrdJob.hh"
+#include "Xrd/XrdScheduler.hh"
+
+namespace XrdCms
+{
+extern XrdScheduler *Sched;
+}
+
+using namespace XrdCms;
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+  
+XrdCmsCacheSnap XrdCms::CacheSnap;
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+  
+class XrdCmsSnapJob : XrdJob
+{
+public:
+
+void   DoIt() {CacheSnap.Restore(oSlot, nSlot, Who); delete this;}
+
+       XrdCmsSnapJob(int oslot, int nslot, const char *who)
+                    : XrdJob("cache restore"), oSlot(oslot), nSlot(nslot)
+                    {strncpy(Who, who, sizeof(Who)-1); Who[sizeof(Who)-1] = 0;}
+      ~XrdCmsSnapJob() {}
+
+private:
+
+int    oSlot;
+int    nSlot;
+char   Who[256];
+};
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+const char snapMagic[8] = "xrdcmss";
+const int  snapVersion  = 1;
+
+bool WriteAll(int fd, const char *buff, size_t blen)
+{
+   ssize_t wlen;
+
+   while(blen)
+        {if ((wlen = write(fd, buff, blen)) < 0)
+            {if (errno == EINTR) continue;
+             return false;
+            }
+         buff += wlen; blen -= wlen;
+        }
+   return true;
+}
+}
+
+/******************************************************************************/
+/*            E x t e r n a l   T h r e a d   I n t e r f a c e s             */
+/******************************************************************************/
+  
+void *XrdCmsStartCacheSnap(void *carg)
+      {XrdCmsCacheSnap *csP = (XrdCmsCacheSnap *)carg;
+       return csP->Start();
+      }
+
+/******************************************************************************/
+/* Public                         A t t a c h                                 */
+/******************************************************************************/
+  
+void XrdCmsCacheSnap::Attach(XrdCmsNode *nP)
+{
+   char idBuff[idLen];
+   int i, iNum, nSlot = nP->ID(iNum);
+
+// Nothing to do if snapshots are not being taken
+//
+   if (!snapPath) return;
+
+// Record the identity of the node now occupying this slot
+//
+   nP->Identity(idBuff, sizeof(idBuff));
+   sMutex.Lock();
+   strcpy(nodeTab[nSlot].Ident, idBuff);
+   nodeTab[nSlot].ConfigID = nP->ConfigID;
+   nodeTab[nSlot].inUse    = 1;
+
+// If we are restoring a snapshot, find where this node was and restore what it
+// had in the background. Nodes not found will need to be asked about files.
+//
+   if (mapAddr)
+      {for (i = 0; i < STMax; i++)
+           if (oldTab[i].inUse && !oldUsed[i]
+           &&  oldTab[i].ConfigID == nP->ConfigID
+           &&  !strcmp(oldTab[i].Ident, idBuff)) break;
+       if (i < STMax)
+          {oldUsed[i] = 1; numJobs++; numLeft--;
+           Sched->Schedule((XrdJob *)new XrdCmsSnapJob(i, nSlot, nP->Ident));
+          } else freshNodes |= nP->Mask();
+      }
+   sMutex.UnLock();
+}
+
+/******************************************************************************/
+/* Public                           I n i t                                   */
+/******************************************************************************/
+  
+int XrdCmsCacheSnap::Init(const char *path, int every, int maxAge)
+{
+   pthread_t tid;
+   char buff[2048];
+
+// Record the snapshot file names
+//
+   snprintf(buff, sizeof(buff), "%s.tmp", path);
+   snapPath = strdup(path);
+   snapTemp = strdup(buff);
+   snapIntv = every;
+
+// Map any existing snapshot so that it can be restored
+//
+   Load(maxAge);
+
+// Start the thread that takes the snapshots
+//
+   if (XrdSysThread::Run(&tid, XrdCmsStartCacheSnap, (void *)this,
+                         0, "Cache snapshot"))
+      {Say.Emsg("Init", errno, "start cache snapshot");
+       return 0;
+      }
+   return 1;
+}
+  
+/******************************************************************************/
+/* Private                          L o a d                                   */
+/******************************************************************************/
+  
+int XrdCmsCacheSnap::Load(int maxAge)
+{
+   const SnapHdr *hP;
+   struct stat Stat;
+   const char *eTxt = 0;
+   char *mP, buff[80];
+   int i, fd;
+
+// Open the snapshot, it need not exist
+//
+   if ((fd = open(snapPath, O_RDONLY)) < 0)
+      {if (errno != ENOENT) Say.Emsg("Snap", errno, "open", snapPath);
+       return 0;
+      }
+
+// Map it into memory
+//
+   if (fstat(fd, &Stat))
+      {Say.Emsg("Snap", errno, "stat", snapPath);
+       close(fd);
+       return 0;
+      }
+   if (Stat.st_size < (off_t)(sizeof(SnapHdr) + STMax*sizeof(SnapNode)))
+      {Say.Emsg("Snap", "Ignoring truncated cache snapshot", snapPath);
+       close(fd);
+       return 0;
+      }
+   mP = (char *)mmap(0, Stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (mP == MAP_FAILED)
+      {Say.Emsg("Snap", errno, "map", snapPath);
+       return 0;
+      }
+
+// Validate the snapshot
+//
+   hP = (const SnapHdr *)mP;
+        if (memcmp(hP->Magic, snapMagic, sizeof(snapMagic))
+        ||  hP->Version != snapVersion)      eTxt = "unsupported";
+   else if (hP->maxNodes != STMax
+        ||  hP->maskSize != (int)sizeof(SMask_t)) eTxt = "incompatible";
+   else if (hP->Size != Stat.st_size)        eTxt = "truncated";
+   else if (hP->Created + maxAge < time(0))  eTxt = "stale";
+   if (eTxt)
+      {snprintf(buff, sizeof(buff), "Ignoring %s cache snapshot", eTxt);
+       Say.Emsg("Snap", buff, snapPath);
+       munmap(mP, Stat.st_size);
+       return 0;
+      }
+
+// Document what we found
+//
+   snprintf(buff, sizeof(buff), "%lld locations for %d nodes",
+            hP->numRecs, hP->numNodes);
+   Say.Say("Config cache snapshot has ", buff, " from ", snapPath);
+
+// Establish the restore information
+//
+   sMutex.Lock();
+   mapAddr = mP;
+   mapSize = Stat.st_size;
+   mapEnd  = hP->Created + maxAge;
+   oldTab  = (SnapNode *)(mP + sizeof(SnapHdr));
+   recBeg  = mP + sizeof(SnapHdr) + STMax*sizeof(SnapNode);
+   recEnd  = mP + mapSize;
+   memset(oldUsed, 0, sizeof(oldUsed));
+   for (i = 0; i < STMax; i++) if (oldTab[i].inUse) numLeft++;
+   if (!numLeft) Unmap();
+   sMutex.UnLock();
+   return 1;
+}
+
+/******************************************************************************/
+/* Public                        R e s t o r e                                */
+/******************************************************************************/
+  
+void XrdCmsCacheSnap::Restore(int oSlot, int nSlot, const char *who)
+{
+   const SnapRec *rP;
+   SMask_t fresh, nMask = SMask_t::Bit(nSlot);
+   char *cP, buff[64];
+   int numRest = 0;
+
+// Get the nodes that must still be asked about the files we restore
+//
+   sMutex.Lock();
+   fresh = freshNodes;
+   sMutex.UnLock();
+
+// Run through the snapshot adding the files the node had. We do this without
+// a lock as the mapping stays in place as long as restores are running.
+// Restored entries are treated as if the node had just reported them. Nodes
+// unknown to the snapshot are marked as not having been asked.
+//
+   for (cP = recBeg; cP + sizeof(SnapRec) <= recEnd; cP += rP->rLen)
+       {rP = (const SnapRec *)cP;
+        if (rP->rLen < sizeof(SnapRec) || cP + rP->rLen > recEnd) break;
+        if (!rP->hfvec.Has(oSlot)) continue;
+        XrdCmsSelect Sel((rP->pfvec.Has(oSlot) ? XrdCmsSelect::Pending : 0),
+                         (char *)cP + sizeof(SnapRec), rP->pLen-1);
+        Sel.Path.Hash = rP->Hash;
+        Cache.AddFile(Sel, nMask);
+        if (fresh)
+           {Sel.Path.TODRef = 0;
+            Cache.UnkFile(Sel, fresh);
+           }
+        numRest++;
+       }
+
+// Document what we did
+//
+   snprintf(buff, sizeof(buff), "Restored %d cached locations for", numRest);
+   Say.Emsg("Snap", buff, who);
+
+// Indicate this restore is done and let go of the snapshot if possible
+//
+   sMutex.Lock();
+   numJobs--;
+   if (!numJobs && !numLeft) Unmap();
+   sMutex.UnLock();
+}
+
+/******************************************************************************/
+/* Private                          S a v e                                   */
+/******************************************************************************/
+  
+void XrdCmsCacheSnap::Save()
+{
+   SnapHdr  Hdr;
+   SnapRec  Rec;
+   XrdCmsKeyItem *iP;
+   char *bP = 0, Pad[8] = {0};
+   size_t bLen, bMax = 0, rLen;
+   long long numRecs = 0, Size;
+   int i, t, fd;
+
+// Create the temporary snapshot file
+//
+   if ((fd = open(snapTemp, O_WRONLY|O_CREAT|O_TRUNC, 0644)) < 0)
+      {Say.Emsg("Snap", errno, "create", snapTemp);
+       return;
+      }
+
+// Write an initial header followed by the node identities
+//
+   memset(&Hdr, 0, sizeof(Hdr));
+   memcpy(Hdr.Magic, snapMagic, sizeof(Hdr.Magic));
+   Hdr.Version  = snapVersion;
+   Hdr.maxNodes = STMax;
+   Hdr.maskSize = sizeof(SMask_t);
+   Hdr.Created  = time(0);
+   sMutex.Lock();
+   for (i = 0; i < STMax; i++) if (nodeTab[i].inUse) Hdr.numNodes++;
+   if (!WriteAll(fd, (char *)&Hdr, sizeof(Hdr))
+   ||  !WriteAll(fd, (char *)nodeTab, sizeof(nodeTab)))
+      {sMutex.UnLock();
+       Say.Emsg("Snap", errno, "write", snapTemp);
+       close(fd); unlink(snapTemp);
+       return;
+      }
+   sMutex.UnLock();
+   Size = sizeof(Hdr) + sizeof(nodeTab);
+
+// Copy the known locations of each shard into a buffer and write it out. Only
+// entries that some node has are worth keeping. Each shard is held only for
+// the time it takes to copy its entries.
+//
+   memset((void *)&Rec, 0, sizeof(Rec));
+   for (i = 0; i < XrdCmsCache::shardNum; i++)
+       {XrdCmsCache::CacheShard &cS = Cache.Shards[i];
+        bLen = 0;
+        cS.Mutex.Lock();
+        for (t = 0; t < (int)XrdCmsKeyItem::TickRate; t++)
+            for (iP = cS.TockTab[t]; iP; iP = iP->Key.TODRef)
+                {if (!(iP->Loc.hfvec) || !iP->Key.Val || !iP->Key.Len
+                 ||  iP->Key.Len >= (int)(65535-sizeof(Rec)-8)) continue;
+                 rLen = (sizeof(Rec) + iP->Key.Len + 1 + 7) & ~size_t(7);
+                 if (bLen + rLen > bMax)
+                    {char *nP;
+                     size_t nMax = (bMax ? bMax*2 : 1024*1024);
+                     while(bLen + rLen > nMax) nMax *= 2;
+                     if (!(nP = (char *)realloc(bP, nMax))) break;
+                     bP = nP; bMax = nMax;
+                    }
+                 Rec.hfvec = iP->Loc.hfvec;
+                 Rec.pfvec = iP->Loc.pfvec;
+                 Rec.Hash  = iP->Key.Hash;
+                 Rec.pLen  = static_cast<unsigned short>(iP->Key.Len + 1);
+                 Rec.rLen  = static_cast<unsigned short>(rLen);
+                 memcpy(bP+bLen, &Rec, sizeof(Rec));
+                 memcpy(bP+bLen+sizeof(Rec), iP->Key.Val, Rec.pLen);
+                 memcpy(bP+bLen+sizeof(Rec)+Rec.pLen, Pad,
+                        rLen - sizeof(Rec) - Rec.pLen);
+                 bLen += rLen; numRecs++;
+                }
+        cS.Mutex.UnLock();
+        if (bLen && !WriteAll(fd, bP, bLen))
+           {Say.Emsg("Snap", errno, "write", snapTemp);
+            close(fd); unlink(snapTemp); free(bP);
+            return;
+           }
+        Size += bLen;
+       }
+   if (bP) free(bP);
+
+// Complete the header and make the snapshot the current one
+//
+   Hdr.numRecs = numRecs;
+   Hdr.Size    = Size;
+   if (pwrite(fd, &Hdr, sizeof(Hdr), 0) != (ssize_t)sizeof(Hdr) || fsync(fd))
+      {Say.Emsg("Snap", errno, "write", snapTemp);
+       close(fd); unlink(snapTemp);
+       return;
+      }
+   close(fd);
+   if (rename(snapTemp, snapPath))
+      {Say.Emsg("Snap", errno, "rename", snapTemp);
+       unlink(snapTemp);
+      }
+}
+
+/******************************************************************************/
+/* Public                          S t a r t                                  */
+/******************************************************************************/
+  
+void *XrdCmsCacheSnap::Start()
+{
+   EPNAME("Snap")
+
+// Periodically take a snapshot. Any snapshot being restored is let go once it
+// has outlived the cache lifetime as nothing in it would be valid anymore.
+//
+   do {XrdSysTimer::Snooze(snapIntv);
+       sMutex.Lock();
+       if (mapAddr && !numJobs && mapEnd <= time(0)) Unmap();
+       sMutex.UnLock();
+       Save();
+       DEBUG("cache snapshot written to " <<snapPath);
+      } while(1);
+
+// Keep compiler happy
+//
+   return (void *)0;
+}
+
+/******************************************************************************/
+/* Private                         U n m a p                                  */
+/******************************************************************************/
+
+// The caller must hold sMutex.
+  
+void XrdCmsCacheSnap::Unmap()
+{
+   if (mapAddr)
+      {munmap(mapAddr, mapSize);
+       mapAddr = 0; mapSize = 0; oldTab = 0;
+       recBeg  = recEnd = 0;
+       freshNodes = 0;
+      }
+}
@@ -0,0 +1,129 @@
+#ifndef __XRDCMSCACHESNAP_HH__
+#define __XRDCMSCACHESNAP_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d C m s C a c h e S n a p . h h                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include "XrdCms/XrdCmsTypes.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+// The XrdCmsCacheSnap class periodically writes the known file locations in
+// the cache to a snapshot file. When a manager restarts, the snapshot is
+// mapped into memory and the locations a node had are put back into the cache
+// as soon as that node logs in again; provided the node's identity and its
+// exports have not changed. The snapshot is let go once it is older than the
+// cache lifetime or all of its nodes have been restored.
+//
+class XrdCmsNode;
+
+class XrdCmsCacheSnap
+{
+public:
+
+// Attach() is called when a node has logged in and its paths are known.
+//
+void   Attach(XrdCmsNode *nP);
+
+// Init() maps any existing snapshot and starts the snapshot thread.
+//
+int    Init(const char *path, int every, int maxAge);
+
+// Restore() puts back the locations recorded for oSlot as belonging to nSlot.
+//
+void   Restore(int oSlot, int nSlot, const char *who);
+
+void  *Start();
+
+       XrdCmsCacheSnap() : snapPath(0), snapTemp(0), snapIntv(0),
+                           mapAddr(0), mapSize(0), mapEnd(0), oldTab(0),
+                           numJobs(0), numLeft(0)
+                         {memset(nodeTab, 0, sizeof(nodeTab));}
+      ~XrdCmsCacheSnap() {}
+
+private:
+
+static const int idLen = 256;
+
+struct SnapHdr
+      {char         Magic[8];             // "xrdcmss" plus null byte
+       int          Version;
+       int          maxNodes;             // STMax in effect
+       int          maskSize;             // sizeof(SMask_t)
+       int          numNodes;             // Nodes with an identity
+       long long    Created;              // time() of the snapshot
+       long long    numRecs;              // Number of location records
+       long long    Size;                 // Total size of the file
+      };
+
+struct SnapNode
+      {unsigned int ConfigID;             // Node's export configuration id
+       int          inUse;                // Entry is valid
+       char         Ident[idLen];         // Node's identity
+      };
+
+struct SnapRec
+      {SMask_t        hfvec;              // Nodes having the file
+       SMask_t        pfvec;              // Nodes staging the file
+       unsigned int   Hash;               // Path hash
+       unsigned short pLen;               // Path length including null byte
+       unsigned short rLen;               // Record length (multiple of 8)
+//     char           Path[pLen];
+      };
+
+int    Load(int maxAge);
+void   Save();
+void   Unmap();
+
+XrdSysMutex  sMutex;
+SnapNode     nodeTab[STMax];              // Protected by sMutex
+char        *snapPath;
+char        *snapTemp;
+int          snapIntv;
+
+// The following describe a mapped snapshot being restored (also sMutex)
+//
+char        *mapAddr;
+size_t       mapSize;
+time_t       mapEnd;
+SnapNode    *oldTab;
+char        *recBeg;
+char        *recEnd;
+SMask_t      freshNodes;                  // Nodes not in the snapshot
+int          numJobs;                     // Restores in progress
+int          numLeft;                     // Nodes yet to be restored
+char         oldUsed[STMax];
+};
+
+namespace XrdCms
+{
+extern    XrdCmsCacheSnap CacheSnap;
+}
+#endif
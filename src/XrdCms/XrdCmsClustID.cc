@@ -98,6 +98,7 @@ bool XrdCmsClustID::AddNode(XrdCmsNode *nP, bool isMan)
 {
    EPNAME("AddNode");
    XrdSysMutexHelper cidHelper(cidMtx);
+   char mBuff[SMask_t::HexLen];
    int iNum, sNum;
 
 // For servers we only add the identification mask
@@ -105,7 +106,7 @@ bool XrdCmsClustID::AddNode(XrdCmsNode *nP, bool isMan)
    if (!isMan)
       {cidMask |= nP->Mask();
        DEBUG("srv " <<nP->Ident <<" cluster " <<cidName
-             <<" mask=" <<hex <<cidMask <<dec <<" anum=" <<npNum);
+             <<" mask=" <<cidMask.Hex(mBuff, sizeof(mBuff)) <<" anum=" <<npNum);
        return true;
       }
 
@@ -132,7 +133,7 @@ bool XrdCmsClustID::AddNode(XrdCmsNode *nP, bool isMan)
    cidMask |= nP->Mask();
    nodeP[npNum++] = nP;
    DEBUG("man " <<nP->Ident <<" cluster " <<cidName
-         <<" mask=" <<hex <<cidMask <<dec <<" anum=" <<npNum);
+         <<" mask=" <<cidMask.Hex(mBuff, sizeof(mBuff)) <<" anum=" <<npNum);
    return true;
 }
 
@@ -221,13 +222,14 @@ XrdCmsNode *XrdCmsClustID::RemNode(XrdCmsNode *nP)
 {
    EPNAME("RemNode");
    bool didRM = false;
+   char mBuff[SMask_t::HexLen];
 
 // For servers we only need to remove the mask
 //
    if (!(nP->isMan | nP->isPeer))
       {cidMask &= ~(nP->Mask());
        DEBUG("srv " <<nP->Ident <<" cluster " <<cidName
-             <<" mask=" <<hex <<cidMask <<dec <<" anum=" <<npNum);
+             <<" mask=" <<cidMask.Hex(mBuff, sizeof(mBuff)) <<" anum=" <<npNum);
        return 0;
       }
 
@@ -249,7 +251,7 @@ XrdCmsNode *XrdCmsClustID::RemNode(XrdCmsNode *nP)
 // Do some debugging and return what we have in the table
 //
    DEBUG("man " <<nP->Ident <<" cluster " <<cidName
-         <<" mask=" <<hex <<cidMask <<dec <<" anum=" <<npNum
+         <<" mask=" <<cidMask.Hex(mBuff, sizeof(mBuff)) <<" anum=" <<npNum
          <<(didRM ? "" : " n/p"));
    return (npNum ? nodeP[0] : 0);
 }
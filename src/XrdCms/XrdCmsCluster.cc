@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <netinet/in.h>
+#include <sched.h>
 #include <sys/types.h>
 
 #include "XProtocol/YProtocol.hh"
@@ -49,15 +50,19 @@
 #include "XrdCms/XrdCmsCluster.hh"
 #include "XrdCms/XrdCmsClustID.hh"
 #include "XrdCms/XrdCmsNode.hh"
+#include "XrdCms/XrdCmsNSMap.hh"
+#include "XrdCms/XrdCmsPrepare.hh"
 #include "XrdCms/XrdCmsRole.hh"
 #include "XrdCms/XrdCmsRRQ.hh"
 #include "XrdCms/XrdCmsState.hh"
 #include "XrdCms/XrdCmsSelect.hh"
+#include "XrdCms/XrdCmsStateQ.hh"
 #include "XrdCms/XrdCmsTrace.hh"
 #include "XrdCms/XrdCmsTypes.hh"
 
 #include "XrdOuc/XrdOucPup.hh"
 
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSys/XrdSysTimer.hh"
@@ -100,6 +105,29 @@ XrdCmsNode *nodeP;
 int         nodeEnt;
 int         nodeInst;
 };
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+unsigned int rndSeed = 0;
+
+// Return a pseudo-random number in [0,n). This is a Weyl sequence scrambled by
+// a murmur finalizer; cheap, usable without any lock, and good enough to
+// spread selections across nodes.
+//
+int Random(int n)
+{
+   unsigned int x = AtomicAdd(rndSeed, 0x9e3779b9U);
+
+   x ^= x >> 16; x *= 0x85ebca6bU;
+   x ^= x >> 13; x *= 0xc2b2ae35U;
+   x ^= x >> 16;
+   return static_cast<int>(x % static_cast<unsigned int>(n));
+}
+}
   
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
@@ -118,10 +146,15 @@ XrdCmsCluster::XrdCmsCluster()
      SelRcnt = 0;
      SelRtot = 0;
      SelTcnt = 0;
+     nsMapOn = false;
      doReset = 0;
      resetMask = 0;
      peerHost  = 0;
      peerMask  = ~peerHost;
+     memset((void *)SnapTab, 0, sizeof(SnapTab));
+     theSnap   = &SnapTab[0];
+     snapEpoch = 0;
+     snapRdrs[0] = snapRdrs[1] = 0;
 }
   
 /******************************************************************************/
@@ -218,7 +251,7 @@ XrdCmsNode *XrdCmsCluster::Add(XrdLink *lp, int port, int Status, int sport,
        NodeTab[Slot] = nP = new XrdCmsNode(lp, theIF, theNID, port, 0, Slot);
        if (!cidP) cidP = XrdCmsClustID::AddID(theNID);
        if ((cidP->AddNode(nP, SpecAlt))) nP->cidP = cidP;
-          else {delete nP; NodeTab[Slot] = 0; return 0;} // OK to do delete!
+          else {delete nP; NodeTab[Slot] = 0; SnapPub(); return 0;} // OK!
       }
 
 // Indicate whether this snode can be redirected
@@ -268,6 +301,10 @@ XrdCmsNode *XrdCmsCluster::Add(XrdLink *lp, int port, int Status, int sport,
                       nP->isBad & XrdCmsNode::isSuspend ? 0 : 1,
                       nP->isNoStage ? 0 : 1);
 
+// Make the new node visible to lock-free selections
+//
+   SnapPub();
+
 // All done. Return the node locked.
 //
    nP->Lock(false);
@@ -442,6 +479,44 @@ SMask_t XrdCmsCluster::Broadcast(SMask_t smask, XrdCms::CmsRRHdr &Hdr,
    return Broadcast(smask, ioV, 2, Dlen+sizeof(Hdr));
 }
 
+/******************************************************************************/
+/*                            B r o a d c a s t V                             */
+/******************************************************************************/
+
+SMask_t XrdCmsCluster::BroadcastV(SMask_t smask, const struct iovec *iod,
+                                  int iovcnt, int iotot, SMask_t &oldMask)
+{
+   EPNAME("BroadcastV")
+   int i;
+   XrdCmsNode *nP;
+   SMask_t bmask, unQueried(0);
+
+// Obtain a lock on the table and screen out peer nodes
+//
+   STMutex.Lock();
+   bmask = smask & peerMask;
+   oldMask = 0;
+
+// Run through the table just as Broadcast() does, diverting nodes that do not
+// understand batched state requests to the caller.
+//
+   for (i = 0; i <= STHi; i++)
+       {if ((nP = NodeTab[i]) && nP->isNode(bmask))
+           {if (nP->isOffline) unQueried |= nP->Mask();
+               else if (!nP->canStateV) oldMask |= nP->Mask();
+               else {nP->g2Ref(STMutex);
+                     if (nP->Send(iod, iovcnt, iotot) < 0)
+                        {unQueried |= nP->Mask();
+                         DEBUG(nP->Ident <<" is unreachable");
+                        }
+                     nP->Ref2g(STMutex);
+                    }
+           }
+       }
+   STMutex.UnLock();
+   return unQueried;
+}
+
 /******************************************************************************/
 /*                             B r o a d s e n d                              */
 /******************************************************************************/
@@ -648,12 +723,15 @@ int XrdCmsCluster::Locate(XrdCmsSelect &Sel)
 // First check if we have seen this file before. If so, get nodes that have it.
 // A Refresh request kills this because it's as if we hadn't seen it before.
 // If the file was found but either a query is in progress or we have a server
-// bounce; the client must wait.
+// bounce; the client must wait. Should the namespace maps say no one has the
+// file, there is no one to ask.
 //
    if (Sel.Opts & XrdCmsSelect::Refresh 
    || !(retc = Cache.GetFile(Sel, pinfo.rovec)))
-      {Cache.AddFile(Sel, 0);
-       qfVec = pinfo.rovec; Sel.Vec.hf = 0;
+      {if ((retc = NSMapFile(Sel, pinfo))) qfVec = 0;
+          else {Cache.AddFile(Sel, 0);
+                qfVec = pinfo.rovec; Sel.Vec.hf = 0;
+               }
       } else qfVec = Sel.Vec.bf;
 
 // Compute the delay, if any
@@ -663,14 +741,9 @@ int XrdCmsCluster::Locate(XrdCmsSelect &Sel)
 
 // Check if we have to ask any nodes if they have the file
 //
-   if (qfVec)
-      {CmsStateRequest QReq = {{Sel.Path.Hash, kYR_state, kYR_raw, 0}};
-       if (Sel.Opts & XrdCmsSelect::Refresh)
-          QReq.Hdr.modifier |= CmsStateRequest::kYR_refresh;
-       TRACE(Files, "seeking " <<Sel.Path.Val);
-       qfVec = Cluster.Broadcast(qfVec, QReq.Hdr, 
-                                 (void *)Sel.Path.Val, Sel.Path.Len+1);
-       if (qfVec) Cache.UnkFile(Sel, qfVec);
+   if (qfVec && (qfVec &= ~NSMapNot(Sel, qfVec & ~pinfo.ssvec)))
+      {TRACE(Files, "seeking " <<Sel.Path.Val);
+       if ((qfVec = StateQ.Query(qfVec, Sel))) Cache.UnkFile(Sel, qfVec);
       }
    return retc;
 }
@@ -685,14 +758,26 @@ void *XrdCmsCluster::MonPerf()
    struct iovec ioV[] = {{(char *)&Usage, sizeof(Usage)}};
    int ioVnum = sizeof(ioV)/sizeof(struct iovec);
    int ioVtot = sizeof(Usage);
-   SMask_t allNodes(~0);
-   int uInterval = Config.AskPing*Config.AskPerf;
+   XrdCmsNode *nP;
+   SMask_t staleNodes;
+   time_t tStale;
+   int i, uInterval = Config.AskPing*Config.AskPerf;
 
 // Sleep for the indicated amount of time, then ask for load on each server
+// that has not told us about its load on its own since the last round.
+// Servers push a report whenever their load changes significantly, so only
+// the quiet ones need to be polled.
 //
    while(uInterval)
-        {XrdSysTimer::Snooze(uInterval);
-         Broadcast(allNodes, ioV, ioVnum, ioVtot);
+        {tStale = time(0);
+         XrdSysTimer::Snooze(uInterval);
+         staleNodes = 0;
+         STMutex.Lock();
+         for (i = 0; i <= STHi; i++)
+             if ((nP = NodeTab[i]) && nP->LoadTime < tStale)
+                staleNodes |= nP->NodeMask;
+         STMutex.UnLock();
+         if (staleNodes) Broadcast(staleNodes, ioV, ioVnum, ioVtot);
         }
    return (void *)0;
 }
@@ -744,6 +829,76 @@ void *XrdCmsCluster::MonRefs()
    return (void *)0;
 }
 
+/******************************************************************************/
+/*                              N S M a p A d d                               */
+/******************************************************************************/
+  
+void XrdCmsCluster::NSMapAdd(XrdCmsNode *nP, const char *path)
+{
+   unsigned long long hval;
+
+// Nothing to do unless this node sent us a map
+//
+   if (!nsMapOn || !nP->nsMap) return;
+   hval = XrdCmsNSMap::Hash(path);
+
+// Add the file to the map so that we will keep asking the node about it
+//
+   STMutex.Lock();
+   if (nP->nsMap) nP->nsMap->Add(hval);
+   STMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                              N S M a p N o t                               */
+/******************************************************************************/
+
+SMask_t XrdCmsCluster::NSMapNot(XrdCmsSelect &Sel, SMask_t mask)
+{
+   EPNAME("NSMapNot");
+   XrdCmsNode *nP;
+   SMask_t noMask(0);
+   unsigned long long hval;
+   time_t tNow;
+   int i;
+
+// Nothing to do if no node ever sent us a namespace map
+//
+   if (!nsMapOn || !mask) return noMask;
+   hval = XrdCmsNSMap::Hash(Sel.Path.Val);
+   tNow = time(0);
+
+// Find all the nodes whose valid map says that they do not have the file
+//
+   STMutex.Lock();
+   for (i = 0; i <= STHi; i++)
+       if ((nP = NodeTab[i]) && nP->isNode(mask) && nP->nsMap
+       &&  nP->nsMap->isValid(tNow) && !nP->nsMap->Has(hval))
+          noMask |= nP->Mask();
+   STMutex.UnLock();
+
+   if (noMask) DEBUG("nsmap rules out some nodes for " <<Sel.Path.Val);
+   return noMask;
+}
+
+/******************************************************************************/
+/*                              N S M a p S e t                               */
+/******************************************************************************/
+
+void XrdCmsCluster::NSMapSet(XrdCmsNode *nP, XrdCmsNSMap *mP)
+{
+   XrdCmsNSMap *oldP;
+
+// Swap in the new map, the old one can only be deleted once no one uses it
+//
+   STMutex.Lock();
+   oldP = nP->nsMap;
+   nP->nsMap = mP;
+   if (mP) nsMapOn = true;
+   STMutex.UnLock();
+   if (oldP) delete oldP;
+}
+
 /******************************************************************************/
 /*                                R e m o v e                                 */
 /******************************************************************************/
@@ -863,6 +1018,7 @@ void XrdCmsCluster::Remove(const char *reason, XrdCmsNode *theNode, int immed)
                           altNode->isBad & XrdCmsNode::isSuspend ? 0 :  1,
                           altNode->isNoStage ? 0 :  1);
        setAltMan(altNode->NodeID, altNode->Link, altNode->subsPort);
+       SnapPub();
        Say.Emsg("Manager",altNode->Ident,"replacing dropped",theNode->Ident);
        LockHandler.doDrop = true;
        return;
@@ -979,8 +1135,9 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
 // meta-operation (e.g., remove) in which case the file itself remain unmodified
 // or a replica request, in which case we select a new target server.
 //
-   if (!(Sel.Opts & XrdCmsSelect::Refresh)
-   &&   (retc = Cache.GetFile(Sel, pinfo.rovec)))
+   if ((!(Sel.Opts & XrdCmsSelect::Refresh)
+   &&    (retc = Cache.GetFile(Sel, pinfo.rovec)))
+   ||   (retc = NSMapFile(Sel, pinfo)))
       {if (isRW)
           {     if (retc<0) return Config.LUPDelay;
               else if (Sel.Opts & XrdCmsSelect::Replica)
@@ -1024,14 +1181,11 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
 // in the callback queue only if we have no possible selections
 //
    if (Sel.Vec.bf)
-      {CmsStateRequest QReq = {{Sel.Path.Hash, kYR_state, kYR_raw, 0}};
-       if (Sel.Opts & XrdCmsSelect::Refresh)
-          QReq.Hdr.modifier |= CmsStateRequest::kYR_refresh;
-       if (dowt) retc= (fRD ? Cache.WT4File(Sel,Sel.Vec.hf) : Config.LUPDelay);
+      {if (dowt) retc= (fRD ? Cache.WT4File(Sel,Sel.Vec.hf) : Config.LUPDelay);
+       Sel.Vec.bf &= ~NSMapNot(Sel, Sel.Vec.bf & ~pinfo.ssvec);
        TRACE(Files, "seeking " <<Sel.Path.Val);
-       amask = Cluster.Broadcast(Sel.Vec.bf, QReq.Hdr,
-                                 (void *)Sel.Path.Val,Sel.Path.Len+1);
-       if (amask) Cache.UnkFile(Sel, amask);
+       if (Sel.Vec.bf && (amask = StateQ.Query(Sel.Vec.bf, Sel)))
+          Cache.UnkFile(Sel, amask);
        if (dowt) return retc;
       } else if (dowt && retc < 0 && !noSel)
                 return (fRD ? Cache.WT4File(Sel,Sel.Vec.hf) : Config.LUPDelay);
@@ -1074,10 +1228,8 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
 int XrdCmsCluster::Select(SMask_t pmask, int &port, char *hbuff, int &hlen,
                           int isrw, int isMulti, int ifWant)
 {
-   static const SMask_t smLow(255);
    XrdCmsSelector selR;
    XrdCmsNode *nP = 0;
-   SMask_t tmask;
    int Snum = 0;
    XrdNetIF::ifType nType = static_cast<XrdNetIF::ifType>(ifWant);
 
@@ -1110,9 +1262,7 @@ int XrdCmsCluster::Select(SMask_t pmask, int &port, char *hbuff, int &hlen,
 // In shared-nothing systems the incomming mask will only have a single node.
 // Compute the a single node number that is contained in the mask.
 //
-   do {if (!(tmask = pmask & smLow)) Snum += 8;
-         else {while((tmask = tmask>>1)) Snum++; break;}
-      } while((pmask = pmask >> 8));
+   Snum = pmask.First();
 
 // See if the node passes muster
 //
@@ -1124,8 +1274,8 @@ int XrdCmsCluster::Select(SMask_t pmask, int &port, char *hbuff, int &hlen,
        if (nP)
           {if (isrw)
               if (nP->isNoStage || nP->DiskFree < nP->DiskMinF)    nP = 0;
-                 else {SelWcnt++; nP->RefTotW++; nP->RefW++;}
-              else    {SelRcnt++; nP->RefTotR++; nP->RefR++;}
+                 else {SelWcnt++; nP->RefTotW++; nP->RefW++; nP->RefI++;}
+              else    {SelRcnt++; nP->RefTotR++; nP->RefR++; nP->RefI++;}
           }
       }
 
@@ -1218,19 +1368,29 @@ void XrdCmsCluster::Space(SpaceData &sData, SMask_t smask)
 int XrdCmsCluster::Stats(char *bfr, int bln)
 {
    static const char statfmt1[] = "<stats id=\"cms\">"
-                     "<role>%s</role></stats>";
-   int mlen;
+                     "<role>%s</role>";
+   static const char statfmt2[] = "</stats>";
+   int mlen, plen;
 
 // Check if actual length wanted
 //
-   if (!bfr) return  sizeof(statfmt1) + 8;
+   if (!bfr) return  sizeof(statfmt1) + 8 + sizeof(statfmt2)
+                   + (Config.DiskSS ? PrepQ.Stats(0, 0) : 0);
 
-// Format the statistics (not much here for now)
+// Format the statistics (not much here for now). Staging servers also report
+// how their prepare queue is doing.
 //
    mlen = snprintf(bfr, bln, statfmt1, Config.myRType);
-
    if ((bln -= mlen) <= 0) return 0;
-   return mlen;
+
+   if (Config.DiskSS)
+      {if (!(plen = PrepQ.Stats(bfr+mlen, bln))) return 0;
+       mlen += plen; bln -= plen;
+      }
+
+   if (bln <= (int)sizeof(statfmt2)) return 0;
+   strcpy(bfr+mlen, statfmt2);
+   return mlen + sizeof(statfmt2) - 1;
 }
 
 /******************************************************************************/
@@ -1253,6 +1413,7 @@ int XrdCmsCluster::Statt(char *bfr, int bln)
           "<lf>%lld</lf><ls>%lld</ls><rf>%lld</rf><rs>%lld</rs></frq>";
 
    static int AddFrq = (Config.RepStats & XrdCmsConfig::RepStat_frq);
+   static int AddCch = (Config.RepStats & XrdCmsConfig::RepStat_cch);
    static int AddShr = (Config.RepStats & XrdCmsConfig::RepStat_shr)
                        && Config.asMetaMan();
 
@@ -1280,6 +1441,7 @@ int XrdCmsCluster::Statt(char *bfr, int bln)
           (sizeof(statfmt2) + 10*2 + 256 + 16) * STMax + sizeof(statfmt4);
        if (AddShr) n += sizeof(statfmt3) + 12;
        if (AddFrq) n += sizeof(statfmt4) + (10*8);
+       if (AddCch) n += Cache.Stats(0, 0);
        return n;
       }
 
@@ -1336,6 +1498,11 @@ int XrdCmsCluster::Statt(char *bfr, int bln)
        bfr += mlen; bln -= mlen; tlen += mlen;
       }
 
+   if (AddCch && bln > 0)
+      {if (!(mlen = Cache.Stats(bfr, bln))) return 0;
+       bfr += mlen; bln -= mlen; tlen += mlen;
+      }
+
 // See if we overflowed. otherwise finish up
 //
    if (sp || bln < (int)sizeof(statfmt0)) return 0;
@@ -1445,9 +1612,11 @@ int XrdCmsCluster::Drop(int sent, int sinst, XrdCmsDrop *djp)
 //
    if (sent == STHi) while(STHi >= 0 && !NodeTab[STHi]) STHi--;
 
-// Invalidate any cached entries for this node
+// Invalidate any cached entries for this node and make sure no lock-free
+// selection can still see it before it gets deleted.
 //
    if (nP->NodeMask) Cache.Drop(nP->NodeMask, sent, STHi);
+   SnapPub();
 
 // We can now delete the node object if we were called via a job as we are on
 // a different thread. Direct calls require that we schedule the deletion as
@@ -1468,30 +1637,7 @@ int XrdCmsCluster::Drop(int sent, int sinst, XrdCmsDrop *djp)
 
 int XrdCmsCluster::Multiple(SMask_t mVec)
 {
-   static const unsigned long long Left32  = 0xffffffff00000000LL;
-   static const unsigned long long Right32 = 0x00000000ffffffffLL;
-   static const unsigned long long Left16  = 0x00000000ffff0000LL;
-   static const unsigned long long Right16 = 0x000000000000ffffLL;
-   static const unsigned long long Left08  = 0x000000000000ff00LL;
-   static const unsigned long long Right08 = 0x00000000000000ffLL;
-   static const unsigned long long Left04  = 0x00000000000000f0LL;
-   static const unsigned long long Right04 = 0x000000000000000fLL;
-//                                0 1 2 3 4 5 6 7 8 9 A B C D E F
-   static const int isMult[16] = {0,0,0,1,0,1,1,1,0,1,1,1,1,1,1,1};
-
-   if (mVec & Left32) {if (mVec & Right32) return 1;
-                          else mVec = mVec >> 32LL;
-                      }
-   if (mVec & Left16) {if (mVec & Right16) return 1;
-                          else mVec = mVec >> 16LL;
-                      }
-   if (mVec & Left08) {if (mVec & Right08) return 1;
-                          else mVec = mVec >>  8LL;
-                      }
-   if (mVec & Left04) {if (mVec & Right04) return 1;
-                          else mVec = mVec >>  4LL;
-                      }
-   return isMult[mVec];
+   return mVec.Count() > 1;
 }
   
 /******************************************************************************/
@@ -1500,19 +1646,30 @@ int XrdCmsCluster::Multiple(SMask_t mVec)
   
 bool XrdCmsCluster::maxBits(SMask_t mVec, int mbits)
 {
-   int count = 0;
-
-// Count bits. This is the fastest way assuming few bits are set
+// Count bits and indicate whether we have reached the maximum bits set
 //
-   while(mVec)
-        {mVec &= (mVec - 1);
-         count++;
-         if (count >= mbits) return true;
-        }
+   return mVec.Count() >= mbits;
+}
 
-// Indicate we have not reached the maximum bits set
+/******************************************************************************/
+/*                             N S M a p F i l e                              */
+/******************************************************************************/
+
+// When the namespace maps of all the nodes that could have the file say that
+// they do not have it, we record the file as missing without asking anyone.
+// Nodes that can stage the file are never ruled out this way.
 //
-   return false;
+int XrdCmsCluster::NSMapFile(XrdCmsSelect &Sel, XrdCmsPInfo &pinfo)
+{
+   SMask_t amask = pinfo.rovec & ~pinfo.ssvec;
+
+   if (!nsMapOn || !amask || amask != pinfo.rovec
+   ||  NSMapNot(Sel, amask) != amask) return 0;
+
+   Cache.AddFile(Sel, 0);
+   Cache.MissFile(Sel, amask, amask);
+   Sel.Vec.hf = Sel.Vec.pf = Sel.Vec.bf = 0;
+   return 1;
 }
 
 /******************************************************************************/
@@ -1543,6 +1700,7 @@ int XrdCmsCluster::SelNode(XrdCmsSelect &Sel, SMask_t pmask, SMask_t amask)
     EPNAME("SelNode")
     const char *act=0;
     int isalt = 0, pass = 2;
+    bool byRef;
     SMask_t mask;
     XrdCmsNode *nP = 0;
     XrdCmsSelector selR;
@@ -1563,22 +1721,28 @@ int XrdCmsCluster::SelNode(XrdCmsSelect &Sel, SMask_t pmask, SMask_t amask)
       else selR.needSpace = (Sel.Opts & XrdCmsSelect::Write
                           ?  XrdCmsNode::allowsRW : 0);
 
+// Try to find a primary node without holding the global mutex. This is the
+// common case and, when successful, we return with the global mutex held.
+//
+   byRef = Config.sched_RR || (Sel.Opts & XrdCmsSelect::UseRef);
+   if (NodeCnt < Config.SUPCount || !(nP = SelbySnap(pmask, selR, byRef)))
+
 // Scan for a primary and alternate node (alternates do staging). At this
 // point we omit all peer nodes as they are our last resort. Note that Selbyxxx
 // returns the node unlocked but we have he global mutex so that is OK.
 //
-   STMutex.Lock();
+  {STMutex.Lock();
    mask = pmask & peerMask;
    while(pass--)
         {if (mask)
-            {nP = (Config.sched_RR || (Sel.Opts & XrdCmsSelect::UseRef)
-                ?  SelbyRef(mask,selR) : SelbyLoad(mask,selR));
+            {nP = (byRef ? SelbyRef(mask,selR) : SelbyLoad(mask,selR));
              if (nP || (selR.nPick && selR.delay)
              ||  NodeCnt < Config.SUPCount) break;
             }
          mask = amask & peerMask; isalt = XrdCmsNode::allowsSS;
          if (!(Sel.Opts & XrdCmsSelect::isMeta)) selR.needSpace |= isalt;
         }
+  }
 
 // If we found an eligible node then dispatch the client to it. We will
 // swap the global mutex for the node mutex to minimize interefrence.
@@ -1670,6 +1834,7 @@ int XrdCmsCluster::SelNode(XrdCmsSelect &Sel, SMask_t pmask, SMask_t amask)
 #define RefCount(sP, sPMulti, NeedSpace)                       \
         if (NeedSpace) {SelWcnt++; sP->RefTotW++; sP->RefW++;} \
            else        {SelRcnt++; sP->RefTotR++; sP->RefR++;} \
+        sP->RefI++;                                            \
         if (sPMulti && sP->Share && !sP->Shrem--)              \
            {sP->RefW += sP->Shrip; sP->RefR += sP->Shrip;      \
             sP->Shrem = sP->Share; sP->Shrin++;                \
@@ -1729,14 +1894,64 @@ XrdCmsNode *XrdCmsCluster::SelbyCost(SMask_t mask, XrdCmsSelector &selR)
   
 XrdCmsNode *XrdCmsCluster::SelbyLoad(SMask_t mask, XrdCmsSelector &selR)
 {
-    XrdCmsNode *np, *sp = 0;
-    bool Multi = false, reqSS = (selR.needSpace & XrdCmsNode::allowsSS) != 0;
+    XrdCmsNode *sp;
+    bool Multi;
 
-// Scan for a node (preset possible, suspended, overloaded, full, and dead)
+// Scan the node table
 //
    selR.Reset(); SelTcnt++;
-   for (int i = 0; i <= STHi; i++)
-       if ((np = NodeTab[i]) && (np->NodeMask & mask))
+   sp = ScanbyLoad(mask, selR, NodeTab, STHi+1, Multi);
+
+// Check for overloaded node and return result
+//
+   if (!sp) return calcDelay(selR);
+   RefCount(sp, Multi, selR.needSpace);
+   return sp;
+}
+
+/******************************************************************************/
+/*                              S e l b y R e f                               */
+/******************************************************************************/
+
+// Caller must have the STMutex locked. The returned node. if any, is unlocked.
+
+XrdCmsNode *XrdCmsCluster::SelbyRef(SMask_t mask, XrdCmsSelector &selR)
+{
+    XrdCmsNode *sp;
+    bool Multi;
+
+// Scan the node table
+//
+   selR.Reset(); SelTcnt++;
+   sp = ScanbyRef(mask, selR, NodeTab, STHi+1, Multi);
+
+// Check for overloaded node and return result
+//
+   if (!sp) return calcDelay(selR);
+   RefCount(sp, Multi, selR.needSpace);
+   return sp;
+}
+ 
+/******************************************************************************/
+/*                            S c a n b y L o a d                             */
+/******************************************************************************/
+
+// The caller must either hold the STMutex or be reading a node snapshot.
+// Multi is set when more than one node was eligible.
+
+XrdCmsNode *XrdCmsCluster::ScanbyLoad(SMask_t mask, XrdCmsSelector &selR,
+                                      XrdCmsNode **nTab, int nNum, bool &Multi)
+{
+    XrdCmsNode *np, *sp = 0, *eTab[STMax];
+    bool reqSS = (selR.needSpace & XrdCmsNode::allowsSS) != 0;
+    bool doP2C = Config.sched_P2C && !selR.selPack;
+    int eNum = 0;
+
+// Scan for a node (preset possible, suspended, overloaded, full, and dead)
+//
+   Multi = false;
+   for (int i = 0; i < nNum; i++)
+       if ((np = nTab[i]) && (np->NodeMask & mask))
           {if (!(selR.needNet & np->hasNet))      {selR.xNoNet= true; continue;}
            selR.nPick++;
            if (np->isOffline)                     {selR.xOff  = true; continue;}
@@ -1745,6 +1960,7 @@ XrdCmsNode *XrdCmsCluster::SelbyLoad(SMask_t mask, XrdCmsSelector &selR)
            if (selR.needSpace && (np->DiskFree < np->DiskMinF
                                   || (reqSS && np->isNoStage)))
               {selR.xFull = true; continue;}
+           if (doP2C) {eTab[eNum++] = np; continue;}
            if (!sp) sp = np;
               else{if (selR.needSpace)
                       {if (abs(sp->myMass - np->myMass) <= Config.P_fuzz)
@@ -1766,29 +1982,51 @@ XrdCmsNode *XrdCmsCluster::SelbyLoad(SMask_t mask, XrdCmsSelector &selR)
                   }
           }
 
-// Check for overloaded node and return result
-//
-   if (!sp) return calcDelay(selR);
-   RefCount(sp, Multi, selR.needSpace);
+// When picking from two choices, compare two distinct random eligible nodes.
+// Redirects made since a node last reported its load count against it so
+// that a burst of requests does not all land on the same node.
+//
+   if (doP2C && eNum)
+      {XrdCmsNode *xp;
+       int i, j, sLoad, xLoad;
+       if (eNum == 1) return eTab[0];
+       Multi = true;
+       i = Random(eNum);
+       if ((j = Random(eNum-1)) >= i) j++;
+       sp = eTab[i]; xp = eTab[j];
+       if (selR.needSpace)
+          {sLoad = sp->myMass + sp->RefI; xLoad = xp->myMass + xp->RefI;}
+          else
+          {sLoad = sp->myLoad + sp->RefI; xLoad = xp->myLoad + xp->RefI;}
+       if (abs(sLoad - xLoad) <= Config.P_fuzz)
+          {if (selR.needSpace)
+              {if (sp->RefW > xp->RefW)                               sp=xp;}
+              else if (sp->RefR > xp->RefR)                           sp=xp;
+          }
+          else if (sLoad > xLoad)                                     sp=xp;
+      }
+
    return sp;
 }
 
 /******************************************************************************/
-/*                              S e l b y R e f                               */
+/*                             S c a n b y R e f                              */
 /******************************************************************************/
 
-// Caller must have the STMutex locked. The returned node. if any, is unlocked.
+// The caller must either hold the STMutex or be reading a node snapshot.
+// Multi is set when more than one node was eligible.
 
-XrdCmsNode *XrdCmsCluster::SelbyRef(SMask_t mask, XrdCmsSelector &selR)
+XrdCmsNode *XrdCmsCluster::ScanbyRef(SMask_t mask, XrdCmsSelector &selR,
+                                     XrdCmsNode **nTab, int nNum, bool &Multi)
 {
     XrdCmsNode *np, *sp = 0;
-    bool Multi = false, reqSS = (selR.needSpace & XrdCmsNode::allowsSS) != 0;
+    bool reqSS = (selR.needSpace & XrdCmsNode::allowsSS) != 0;
 
 // Scan for a node (sp points to the selected one)
 //
-   selR.Reset(); SelTcnt++;
-   for (int i = 0; i <= STHi; i++)
-       if ((np = NodeTab[i]) && (np->NodeMask & mask))
+   Multi = false;
+   for (int i = 0; i < nNum; i++)
+       if ((np = nTab[i]) && (np->NodeMask & mask))
           {if (!(selR.needNet & np->hasNet))    {selR.xNoNet= true; continue;}
            selR.nPick++;
            if (np->isOffline)                   {selR.xOff  = true; continue;}
@@ -1805,13 +2043,97 @@ XrdCmsNode *XrdCmsCluster::SelbyRef(SMask_t mask, XrdCmsSelector &selR)
                    }
           }
 
-// Check for overloaded node and return result
+   return sp;
+}
+
+/******************************************************************************/
+/*                             S e l b y S n a p                              */
+/******************************************************************************/
+
+// Select a primary node by scanning the published snapshot of the node table
+// without holding the global mutex. The mutex is only obtained to verify that
+// the chosen node is still in the table and to count the reference. Upon
+// success the node is returned with the STMutex held. Otherwise, nil is
+// returned without the mutex and the caller must do a locked selection.
+
+XrdCmsNode *XrdCmsCluster::SelbySnap(SMask_t pmask, XrdCmsSelector &selR,
+                                     bool byRef)
+{
+#ifdef HAVE_ATOMICS
+    XrdCmsNode *sp;
+    SelSnap *snP;
+    SMask_t mask;
+    bool Multi;
+    int Inst = 0, Slot = 0, rdr;
+
+// Scan the current snapshot. Nodes in the snapshot cannot be deleted until
+// we end our read.
 //
-   if (!sp) return calcDelay(selR);
+   rdr = SnapBeg();
+   snP = theSnap;
+   if (!(mask = pmask & snP->peerMask)) {SnapEnd(rdr); return 0;}
+   selR.Reset();
+   sp = (byRef ? ScanbyRef (mask, selR, snP->Node, snP->Num, Multi)
+               : ScanbyLoad(mask, selR, snP->Node, snP->Num, Multi));
+   if (sp) Slot = sp->ID(Inst);
+   SnapEnd(rdr);
+   if (!sp) return 0;
+
+// Make sure the node is still the one in the table (it may have been replaced
+// or deleted as we no longer hold a read) and that it is still usable.
+//
+   STMutex.Lock();
+   if (NodeTab[Slot] != sp || sp->Inst() != Inst
+   ||  sp->isOffline || sp->isBad)
+      {STMutex.UnLock();
+       return 0;
+      }
+   SelTcnt++;
    RefCount(sp, Multi, selR.needSpace);
    return sp;
+#else
+   return 0;
+#endif
 }
- 
+
+/******************************************************************************/
+/*                               S n a p P u b                                */
+/******************************************************************************/
+
+// Publish a new snapshot of the node table for lock-free selection. The
+// caller must hold the STMutex and must do so whenever a node is added to or
+// removed from the table before any removed node can be deleted.
+
+void XrdCmsCluster::SnapPub()
+{
+#ifdef HAVE_ATOMICS
+   SelSnap *snP = (theSnap == &SnapTab[0] ? &SnapTab[1] : &SnapTab[0]);
+   int j = 0;
+
+// Fill the unused snapshot. No reader can be using it as we waited for all of
+// them to finish with it after the previous publication.
+//
+   for (int i = 0; i <= STHi; i++) if (NodeTab[i]) snP->Node[j++] = NodeTab[i];
+   snP->Num      = j;
+   snP->peerMask = peerMask;
+
+// Make it the current snapshot
+//
+   __sync_synchronize();
+   theSnap = snP;
+   __sync_synchronize();
+
+// Wait for the readers that may still see the previous snapshot. They work
+// in one of two epochs, so we flip the epoch twice and wait for each one to
+// drain. Reads are very short and never block so this is quick.
+//
+   for (int k = 0; k < 2; k++)
+       {int old = AtomicInc(snapEpoch) & 1;
+        while(AtomicGet(snapRdrs[old])) sched_yield();
+       }
+#endif
+}
+
 /******************************************************************************/
 /*                                S e l D F S                                 */
 /******************************************************************************/
@@ -1820,7 +2142,7 @@ int XrdCmsCluster::SelDFS(XrdCmsSelect &Sel, SMask_t amask,
                           SMask_t &pmask, SMask_t &smask, int isRW)
 {
    EPNAME("SelDFS");
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int oldOpts, rc;
 
 // The first task is to find out if the file exists somewhere. If we are doing
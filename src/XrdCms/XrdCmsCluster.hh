@@ -38,6 +38,7 @@
 #include "XrdCms/XrdCmsTypes.hh"
 #include "XrdOuc/XrdOucTList.hh"
 #include "XrdOuc/XrdOucEnum.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
 class XrdLink;
@@ -107,6 +108,8 @@ int       sUtil;    // Average utilization (largest one)
 //
 class XrdCmsBaseFR;
 class XrdCmsClustID;
+class XrdCmsNSMap;
+class XrdCmsPInfo;
 class XrdCmsSelected;
 class XrdOucTList;
 
@@ -136,6 +139,12 @@ SMask_t         Broadcast(SMask_t smask, XrdCms::CmsRRHdr &Hdr,
 SMask_t         Broadcast(SMask_t smask, XrdCms::CmsRRHdr &Hdr,
                           void *Data,    int Dlen);
 
+// Sends a statev message to all nodes matching smask that accept it. The
+// nodes that do not accept it are returned in oldMask and are not sent to.
+//
+SMask_t         BroadcastV(SMask_t smask, const struct iovec *iod, int iovcnt,
+                           int iotot, SMask_t &oldMask);
+
 // Sends a message to a single node in a round-robbin fashion.
 //
 int             Broadsend(SMask_t smask, XrdCms::CmsRRHdr &Hdr,
@@ -160,6 +169,18 @@ XrdCmsSelected *List(SMask_t mask, CmsLSOpts opts, bool &oksel);
 //
 int             Locate(XrdCmsSelect &Sel);
 
+// Adds a path to the node's namespace map, if it has one
+//
+void            NSMapAdd(XrdCmsNode *nP, const char *path);
+
+// Returns the nodes in mask whose namespace map says they lack the file
+//
+SMask_t         NSMapNot(XrdCmsSelect &Sel, SMask_t mask);
+
+// Replaces the node's namespace map with a new one
+//
+void            NSMapSet(XrdCmsNode *nP, XrdCmsNSMap *mP);
+
 // Always run as a separate thread to monitor subscribed node performance
 //
 void           *MonPerf();
@@ -217,16 +238,28 @@ int         Drop(int sent, int sinst, XrdCmsDrop *djp=0);
 void        Record(char *path, const char *reason, bool force=false);
 bool        maxBits(SMask_t mVec, int mbits);
 int         Multiple(SMask_t mVec);
+int         NSMapFile(XrdCmsSelect &Sel, XrdCmsPInfo &pinfo);
 enum        {eExists, eDups, eROfs, eNoRep, eNoSel, eNoEnt}; // Passed to SelFail
 int         SelFail(XrdCmsSelect &Sel, int rc);
 int         SelNode(XrdCmsSelect &Sel, SMask_t  pmask, SMask_t  amask);
 XrdCmsNode *SelbyCost(SMask_t, XrdCmsSelector &selR);
 XrdCmsNode *SelbyLoad(SMask_t, XrdCmsSelector &selR);
 XrdCmsNode *SelbyRef (SMask_t, XrdCmsSelector &selR);
+XrdCmsNode *SelbySnap(SMask_t, XrdCmsSelector &selR, bool byRef);
+XrdCmsNode *ScanbyLoad(SMask_t, XrdCmsSelector &selR,
+                       XrdCmsNode **nTab, int nNum, bool &Multi);
+XrdCmsNode *ScanbyRef (SMask_t, XrdCmsSelector &selR,
+                       XrdCmsNode **nTab, int nNum, bool &Multi);
 int         SelDFS(XrdCmsSelect &Sel, SMask_t amask,
                    SMask_t &pmask, SMask_t &smask, int isRW);
 void        sendAList(XrdLink *lp);
 void        setAltMan(int snum, XrdLink *lp, int port);
+int         SnapBeg() {int rdr = AtomicGet(snapEpoch) & 1;
+                       AtomicInc(snapRdrs[rdr]);
+                       return rdr;
+                      }
+void        SnapEnd(int rdr) {AtomicDec(snapRdrs[rdr]);}
+void        SnapPub();
 int         Unreachable(XrdCmsSelect &Sel, bool none);
 int         Unuseable(XrdCmsSelect &Sel);
 
@@ -245,6 +278,7 @@ long long     SelWtot;          // Total number of r/w selections (successful)
 long long     SelRcnt;          // Curr  number of r/o selections (successful)
 long long     SelRtot;          // Total number of r/o selections (successful)
 long long     SelTcnt;          // Total number of all selections
+bool          nsMapOn;          // Some node has sent us a namespace map
 
 // The following is a list of IP:Port tokens that identify supervisor nodes.
 // The information is sent via the try request to redirect nodes; as needed.
@@ -259,6 +293,21 @@ int           AltMent;
 SMask_t       resetMask;        // Nodes to receive a reset event
 SMask_t       peerHost;         // Nodes that are acting as peers
 SMask_t       peerMask;         // Always ~peerHost
+
+// The following is a read-only copy of the node table used to select nodes
+// without holding the STMutex. A new copy is published under the STMutex
+// whenever the table changes and the previous copy is only reused after all
+// readers of it have finished (see SnapBeg() and SnapEnd()).
+//
+struct SelSnap {int         Num;          // Number of nodes in Node[]
+                SMask_t     peerMask;     // Copy of peerMask
+                XrdCmsNode *Node[STMax];  // Nodes present in NodeTab
+               };
+
+SelSnap            SnapTab[2];
+SelSnap * volatile theSnap;     // Current snapshot
+int                snapEpoch;   // Low order bit selects the reader counter
+int                snapRdrs[2]; // Number of active readers per epoch
 };
 
 XRDOUC_ENUM_OPERATORS(XrdCmsCluster::CmsLSOpts)
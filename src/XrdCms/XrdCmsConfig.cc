@@ -51,9 +51,11 @@
 #include "XrdCms/XrdCmsBaseFS.hh"
 #include "XrdCms/XrdCmsBlackList.hh"
 #include "XrdCms/XrdCmsCache.hh"
+#include "XrdCms/XrdCmsCacheSnap.hh"
 #include "XrdCms/XrdCmsCluster.hh"
 #include "XrdCms/XrdCmsConfig.hh"
 #include "XrdCms/XrdCmsManager.hh"
+#include "XrdCms/XrdCmsNSMap.hh"
 #include "XrdCms/XrdCmsMeter.hh"
 #include "XrdCms/XrdCmsNode.hh"
 #include "XrdCms/XrdCmsPrepare.hh"
@@ -63,6 +65,7 @@
 #include "XrdCms/XrdCmsRRQ.hh"
 #include "XrdCms/XrdCmsSecurity.hh"
 #include "XrdCms/XrdCmsState.hh"
+#include "XrdCms/XrdCmsStateQ.hh"
 #include "XrdCms/XrdCmsSupervisor.hh"
 #include "XrdCms/XrdCmsTrace.hh"
 #include "XrdCms/XrdCmsUtils.hh"
@@ -370,12 +373,12 @@ int XrdCmsConfig::Configure2()
    sprintf(buff, " phase 2 %s initialization started.", myRole);
    Say.Say("++++++ ", myInstance, buff);
 
-// Fix up the QryMinum (we hard code 64 as the max) and P_gshr values.
+// Fix up the QryMinum (we hard code STMax as the max) and P_gshr values.
 // The QryMinum only applies to a metamanager and is set as 1 minus the min.
 //
         if (!isMeta)       QryMinum =  0;
    else if (QryMinum <  2) QryMinum =  0;
-   else if (QryMinum > 64) QryMinum = 64;
+   else if (QryMinum > STMax) QryMinum = STMax;
    if (P_gshr < 0) P_gshr = 0;
       else if (P_gshr > 100) P_gshr = 100;
 
@@ -383,9 +386,16 @@ int XrdCmsConfig::Configure2()
 // location cache scrubber.
 //
    if (QryDelay < 0) QryDelay = LUPDelay;
+   if (QryPush  < 0) QryPush  = QryDelay;
    if (isManager) 
       NoGo = !Cache.Init(cachelife,LUPDelay,QryDelay,baseFS.isDFS(),emptylife);
 
+// If the cache is to survive restarts, restore any snapshot we have and start
+// taking new ones.
+//
+   if (!NoGo && isManager && fxSnapPath)
+      NoGo = !CacheSnap.Init(fxSnapPath, fxSnapIntv, cachelife);
+
 // Issue warning if the adminpath resides in /tmp
 //
    if (!strncmp(AdminPath, "/tmp/", 5))
@@ -435,6 +445,11 @@ int XrdCmsConfig::Configure2()
   if (!NoGo && isManager)              NoGo = setupManager();
   if (!NoGo && (isServer || ManList))  NoGo = setupServer();
 
+// Data servers may summarize their namespace for their managers
+//
+   if (!NoGo && NSMapIntv && isServer && !isManager)
+      NoGo = !NSPub.Init(NSMapIntv, NSMapSize);
+
 // If we are a solo peer then we have no servers and a lot of space and
 // connections don't matter. Only one connection matters for a meta-manager.
 // Servers, supervisors, and managers who have a meta manager must wait for
@@ -504,11 +519,13 @@ int XrdCmsConfig::ConfigXeq(char *var, XrdOucStream &CFile, XrdSysError *eDest)
    TS_Xeq("dfs",           xdfs);    // Any,     non-dynamic
    TS_Xeq("export",        xexpo);   // Any,     non-dynamic
    TS_Xeq("fsxeq",         xfsxq);   // Server,  non-dynamic
+   TS_Xeq("fxsnap",        xfxsnp);  // Manager, non-dynamic
    TS_Xeq("localroot",     xlclrt);  // Any,     non-dynamic
    TS_Xeq("manager",       xmang);   // Server,  non-dynamic
    TS_Xeq("namelib",       xnml);    // Server,  non-dynamic
    TS_Xeq("vnid",          xvnid);   // Server,  non-dynamic
    TS_Xeq("nbsendq",       xnbsq);   // Any      non-dynamic
+   TS_Xeq("nsmap",         xnsmap);  // Server,  non-dynamic
    TS_Xeq("osslib",        xolib);   // Any,     non-dynamic
    TS_Xeq("perf",          xperf);   // Server,  non-dynamic
    TS_Xeq("pidpath",       xpidf);   // Any,     non-dynamic
@@ -655,6 +672,8 @@ void XrdCmsConfig::ConfigDefaults(void)
    LUPDelay = 5;
    QryDelay =-1;
    QryMinum = 0;
+   QryBatch = 0;
+   QryPush  =-1;
    LUPHold  = 178;
    DELDelay = 960;  // 15 minutes
    DRPDelay = 10*60;
@@ -694,7 +713,7 @@ void XrdCmsConfig::ConfigDefaults(void)
    DiskOK   = 0;          // Does not have any disk
    myPaths  = (char *)""; // Default is 'r /'
    ConfigFN = 0;
-   sched_RR = sched_Pack = sched_Level = 0; sched_Force = 1;
+   sched_RR = sched_Pack = sched_Level = sched_P2C = 0; sched_Force = 1;
    isManager= 0;
    isMeta   = 0;
    isPeer   = 0;
@@ -735,6 +754,10 @@ void XrdCmsConfig::ConfigDefaults(void)
    cachelife= 8*60*60;
    emptylife= 0;
    pendplife=   60*60*24*7;
+   fxSnapPath=0;
+   fxSnapIntv=5*60;
+   NSMapIntv= 0;
+   NSMapSize= 0;
    DiskLinger=0;
    ProgCH   = 0;
    ProgMD   = 0;
@@ -1097,7 +1120,11 @@ int XrdCmsConfig::setupManager()
 
 // Initialize the fast redirect queue
 //
-   RRQ.Init(LUPHold, LUPDelay);
+   RRQ.Init(LUPHold, LUPDelay, QryPush);
+
+// Initialize state query batching
+//
+   if (!StateQ.Init(QryBatch)) return 1;
 
 // Initialize the security interface
 //
@@ -1483,7 +1510,8 @@ int XrdCmsConfig::xcid(XrdSysError *eDest, XrdOucStream &CFile)
                                            [service <sec>] [hold <msec>]
                                            [peer <sec>] [rw <lvl>] [qdl <sec>]
                                            [qdn <cnt>] [delnode <sec>]
-                                           [nostage <cnt>]
+                                           [nostage <cnt>] [qbatch <msec>]
+                                           [push <sec>]
 
    delnode   <sec>     maximum seconds to wait to be able to delete a node.
    discard   <cnt>     maximum number a message may be forwarded.
@@ -1495,6 +1523,12 @@ int XrdCmsConfig::xcid(XrdSysError *eDest, XrdOucStream &CFile)
    overload  <sec>     seconds to delay client when all servers overloaded.
    peer      <sec>     maximum seconds client may be delayed before peer
                        selection is triggered.
+   push      <sec>     maximum seconds to park a lookup that was not resolved
+                       within the hold time and push the response once a
+                       server has the file. The default is the qdl value and
+                       zero reverts to telling the client to wait and retry.
+   qbatch    <msec>    milliseconds to collect state queries for the same
+                       servers and send them as one batched query.
    qdl       <sec>     the query response deadline.
    qdn       <cnt>     Min number of servers that must respond to satisfy qdl.
    rw        <lvl>     how to delay r/w lookups (one of three levels):
@@ -1526,6 +1560,8 @@ int XrdCmsConfig::xdelay(XrdSysError *eDest, XrdOucStream &CFile)
         {"nostage",  &noStage,  01},
         {"overload", &MaxDelay,-1},
         {"peer",     &PSDelay,  1},
+        {"push",     &QryPush,  1},
+        {"qbatch",   &QryBatch, 0},
         {"qdl",      &QryDelay, 1},
         {"qdn",      &QryMinum, 0},
         {"rw",       &RWDelay,  0},
@@ -1551,7 +1587,8 @@ int XrdCmsConfig::xdelay(XrdSysError *eDest, XrdOucStream &CFile)
                       }
                    if (dyopts[i].istime < 0 && !strcmp(val, "*")) ppp = -1;
                       else if (dyopts[i].istime)
-                              {if (XrdOuca2x::a2tm(*eDest,etxt,val,&ppp,1))
+                              {if (XrdOuca2x::a2tm(*eDest,etxt,val,&ppp,
+                                         dyopts[i].oploc == &QryPush ? 0 : 1))
                                   return 1;
                               } else
                                if (*dyopts[i].opname == 'r')
@@ -1875,6 +1912,52 @@ int XrdCmsConfig::xfxhld(XrdSysError *eDest, XrdOucStream &CFile)
     return 0;
 }
 
+/******************************************************************************/
+/*                                x f x s n p                                 */
+/******************************************************************************/
+
+/* Function: xfxsnp
+
+   Purpose:  To parse the directive: fxsnap <path> [every <sec>]
+
+             <path> the file where the location cache snapshot is kept. The
+                    snapshot is used to repopulate the cache after a restart.
+             <sec>  number of seconds (or M, H, etc) between snapshots. The
+                    default is 5 minutes.
+
+   Type: Manager only, non-dynamic.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdCmsConfig::xfxsnp(XrdSysError *eDest, XrdOucStream &CFile)
+{
+    char *val;
+    int ct;
+
+    if (!isManager) return CFile.noEcho();
+
+    if (!(val = CFile.GetWord()) || *val != '/')
+       {eDest->Emsg("Config", "fxsnap path not specified or not absolute.");
+        return 1;
+       }
+    if (fxSnapPath) free(fxSnapPath);
+    fxSnapPath = strdup(val);
+
+    if ((val = CFile.GetWord()))
+       {if (strcmp(val, "every"))
+           {eDest->Emsg("Config", "invalid fxsnap option -", val); return 1;}
+        if (!(val = CFile.GetWord()))
+           {eDest->Emsg("Config", "fxsnap every value not specified.");
+            return 1;
+           }
+        if (XrdOuca2x::a2tm(*eDest, "fxsnap every value", val, &ct, 10))
+           return 1;
+        fxSnapIntv = ct;
+       }
+    return 0;
+}
+
 /******************************************************************************/
 /*                                x l c l r t                                 */
 /******************************************************************************/
@@ -2030,13 +2113,16 @@ int XrdCmsConfig::xmang(XrdSysError *eDest, XrdOucStream &CFile)
 /* Function: xnbsq
 
    Purpose:  To parse the directive: nbsendq [<opt>] [warn <nw>] [maxq <mq>]
+                                             [fast <sz>]
 
              <opt>     One of: all | off | remote
              <nw>      Warning will be issued    at a <nw> backlog.
              <mq>      Message will be discarded at a <mq> backlog (<mq> may
                        also be the word "none").
+             <sz>      Queued messages of at most <sz> bytes are sent ahead
+                       of longer queued messages (0 keeps arrival order).
 
-   Defaults: remote warn 3 maxq 30
+   Defaults: remote warn 3 maxq 30 fast 0
 
    Output: 0 upon success or !0 upon failure.
 */
@@ -2080,6 +2166,11 @@ int XrdCmsConfig::xnbsq(XrdSysError *eDest, XrdOucStream &CFile)
                  {if (XrdOuca2x::a2i(*eDest,"nbsendq warn",val,&ival,0)) return 1;
                   XrdSendQ::SetQW(ival);
                  }
+         else if (!strcmp(xopt, "fast"))
+                 {if (XrdOuca2x::a2i(*eDest,"nbsendq fast",val,&ival,0,65536))
+                     return 1;
+                  XrdSendQ::SetQF(ival);
+                 }
          else eDest->Say("Config warning: ignoring invalid nbsendq option '",xopt,"'.");
          val = CFile.GetWord();
         }
@@ -2123,6 +2214,58 @@ int XrdCmsConfig::xnml(XrdSysError *eDest, XrdOucStream &CFile)
    return 0;
 }
   
+/******************************************************************************/
+/*                                 x n s m a p                                */
+/******************************************************************************/
+
+/* Function: xnsmap
+
+   Purpose:  To parse the directive: nsmap [every <sec>] [size <bytes>]
+
+             <sec>     number of seconds (or M, H, etc) between rebuilds of the
+                       namespace map sent to managers. The default is 10 minutes.
+             <bytes>   the size of the map (rounded up to a power of two). The
+                       default is about ten bits per file.
+
+   Type: Server only, non-dynamic.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdCmsConfig::xnsmap(XrdSysError *eDest, XrdOucStream &CFile)
+{
+    char *val;
+    long long sz;
+    int ct;
+
+    if (!isServer || isManager) return CFile.noEcho();
+
+    NSMapIntv = 10*60;
+    while((val = CFile.GetWord()))
+         {     if (!strcmp(val, "every"))
+                  {if (!(val = CFile.GetWord()))
+                      {eDest->Emsg("Config", "nsmap every value not specified.");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2tm(*eDest,"nsmap every value",val,&ct,10))
+                      return 1;
+                   NSMapIntv = ct;
+                  }
+          else if (!strcmp(val, "size"))
+                  {if (!(val = CFile.GetWord()))
+                      {eDest->Emsg("Config", "nsmap size value not specified.");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2sz(*eDest, "nsmap size value", val, &sz,
+                                       XrdCmsNSMap::minSize,
+                                       XrdCmsNSMap::maxSize)) return 1;
+                   NSMapSize = static_cast<int>(sz);
+                  }
+          else {eDest->Emsg("Config", "invalid nsmap option -", val); return 1;}
+         }
+    return 0;
+}
+  
 /******************************************************************************/
 /*                                 x o l i b                                  */
 /******************************************************************************/
@@ -2304,11 +2447,16 @@ int XrdCmsConfig::xping(XrdSysError *eDest, XrdOucStream &CFile)
 
 /* Function: xprep
 
-   Purpose:  To parse the directive: prep  [echo]
+   Purpose:  To parse the directive: prep  [echo] [batch <num>] [rate <num>]
                                            [reset <cnt>] [scrub <sec>] 
                                            [ifpgm <pgm>]
 
          echo          display list of pending prepares during resets.
+         batch <num>   maximum number of prepare requests handed to the
+                       prepare manager at once (default 64, max 1024).
+         rate  <num>   maximum number of prepare requests per second per VO,
+                       where the VO is the first path component. The default
+                       of 0 imposes no limit.
          reset <cnt>   number of scrubs after which a full reset is done.
          scrub <sec>   time (seconds, M, H) between pendq scrubs.
          ifpgm <pgm>   program that adds, deletes, and lists prepare queue
@@ -2322,7 +2470,7 @@ int XrdCmsConfig::xping(XrdSysError *eDest, XrdOucStream &CFile)
    Output: 0 upon success or !0 upon failure. Ignored by manager.
 */
 int XrdCmsConfig::xprep(XrdSysError *eDest, XrdOucStream &CFile)
-{   int   reset=0, scrub=0, echo = 0, doset = 0;
+{   int   reset=0, scrub=0, echo = 0, doset = 0, bsz = 0, rate = -1;
     char  *prepif=0, *val, rest[2048];
 
     if (!isServer) return CFile.noEcho();
@@ -2330,6 +2478,21 @@ int XrdCmsConfig::xprep(XrdSysError *eDest, XrdOucStream &CFile)
     if (!(val = CFile.GetWord())) {PrepQ.setParms(""); return 0;}
 
     do {     if (!strcmp("echo", val)) doset = echo = 1;
+        else if (!strcmp("batch", val))
+                {if (!(val = CFile.GetWord()))
+                    {eDest->Emsg("Config", "prep batch value not specified");
+                     return 1;
+                    }
+                 if (XrdOuca2x::a2i(*eDest,"prep batch",val,&bsz,1,
+                                    XrdCmsPrepArgs::maxBatch)) return 1;
+                }
+        else if (!strcmp("rate", val))
+                {if (!(val = CFile.GetWord()))
+                    {eDest->Emsg("Config", "prep rate value not specified");
+                     return 1;
+                    }
+                 if (XrdOuca2x::a2i(*eDest,"prep rate",val,&rate,0)) return 1;
+                }
         else if (!strcmp("reset", val))
                 {if (!(val = CFile.GetWord()))
                     {eDest->Emsg("Config", "prep reset value not specified");
@@ -2365,6 +2528,7 @@ int XrdCmsConfig::xprep(XrdSysError *eDest, XrdOucStream &CFile)
 //
    if (scrub) pendplife = scrub;
    if (doset) PrepQ.setParms(reset, scrub, echo);
+   XrdCmsPrepArgs::setParms(bsz, rate);
    if (prepif) {if (!isExec(eDest, "prep", prepif)) return 1;
                    else return PrepQ.setParms(prepif);
                } else PrepQ.setParms("");
@@ -2434,6 +2598,7 @@ int XrdCmsConfig::xreps(XrdSysError *eDest, XrdOucStream &CFile)
     static struct repsopts {const char *opname; int opval;} rsopts[] =
        {
         {"all",      RepStat_All},
+        {"cch",      RepStat_cch},
         {"frq",      RepStat_frq},
         {"shr",      RepStat_shr}
        };
@@ -2646,6 +2811,7 @@ int XrdCmsConfig::xrole(XrdSysError *eDest, XrdOucStream &CFile)
                                        [mem <p>] [pag <p>] [space <p>]
                                        [fuzz <p>] [maxload <p>] [refreset <sec>]
                 [affinity [default] {none | weak | strong | strict}]
+                [pick {best | p2c}]
 
              <p>      is the percentage to include in the load as a value
                       between 0 and 100. For fuzz this is the largest
@@ -2655,7 +2821,10 @@ int XrdCmsConfig::xrole(XrdSysError *eDest, XrdOucStream &CFile)
                       between reference counter resets. gshr is the percentage
                       share of requests that should be redirected here via the 
                       metamanager (i.e. global share). The gsdflt is the
-                      default to be used by the metamanager.
+                      default to be used by the metamanager. pick best selects
+                      the least loaded node while pick p2c selects the better
+                      of two randomly chosen eligible nodes taking into account
+                      redirects made since the node last reported its load.
 
    Type: Any, dynamic.
 
@@ -2681,6 +2850,7 @@ int XrdCmsConfig::xsched(XrdSysError *eDest, XrdOucStream &CFile)
         {"maxload",  100, &MaxLoad},
         {"refreset", -1,  &RefReset},
         {"affinity", -2,  0},
+        {"pick",     -3,  0},
         {"tryhname",   1, &V_hntry}
        };
     int numopts = sizeof(scopts)/sizeof(struct schedopts);
@@ -2700,6 +2870,14 @@ int XrdCmsConfig::xsched(XrdSysError *eDest, XrdOucStream &CFile)
                       {if (!xschedm(val, eDest, CFile)) return 1;
                        break;
                       }
+                   if (scopts[i].maxv == -3)
+                      {     if (!strcmp(val, "best")) sched_P2C = 0;
+                       else if (!strcmp(val, "p2c"))  sched_P2C = 1;
+                       else {eDest->Emsg("Config", "Invalid sched pick -", val);
+                             return 1;
+                            }
+                       break;
+                      }
                    if (scopts[i].maxv < 0)
                       {if (XrdOuca2x::a2tm(*eDest,"sched value", val, &ppp, 0)) 
                           return 1;
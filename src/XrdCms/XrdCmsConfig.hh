@@ -75,6 +75,8 @@ int         PSDelay;      // Maximum delay time before peer is selected
 int         RWDelay;      // R/W lookup delay handling (0 | 1 | 2)
 int         QryDelay;     // Query Response Deadline
 int         QryMinum;     // Query Response Deadline Minimum Available
+int         QryBatch;     // Query batching window (in milliseconds)
+int         QryPush;      // Maximum time to park a lookup for a pushed reply
 int         SRVDelay;     // Minimum delay at startup
 int         SUPCount;     // Minimum server count
 int         SUPLevel;     // Minimum server count as floating percentage
@@ -123,6 +125,7 @@ char        sched_RR;     // 1 -> Simply do round robin scheduling
 char        sched_Pack;   // 1 -> Pick oldest node (>1 same but wait for resps)
 char        sched_Level;  // 1 -> Use load-based level for "pack" selection
 char        sched_Force;  // 1 -> Client cannot select mode
+char        sched_P2C;    // 1 -> Pick the better of two random nodes
 int         doWait;       // 1 -> Wait for a data end-point
 
 int         adsPort;      // Alternate server port
@@ -187,6 +190,7 @@ XrdNetSecurity    *Police;
 //
 static const int RepStat_frq    = 0x0001; // Fast Response Queue
 static const int RepStat_shr    = 0x0002; // Share
+static const int RepStat_cch    = 0x0004; // Location cache
 static const int RepStat_All    = 0xffff; // All
 
 private:
@@ -214,10 +218,12 @@ int  xdfs(XrdSysError *edest, XrdOucStream &CFile);
 int  xexpo(XrdSysError *edest, XrdOucStream &CFile);
 int  xfsxq(XrdSysError *edest, XrdOucStream &CFile);
 int  xfxhld(XrdSysError *edest, XrdOucStream &CFile);
+int  xfxsnp(XrdSysError *edest, XrdOucStream &CFile);
 int  xlclrt(XrdSysError *edest, XrdOucStream &CFile);
 int  xmang(XrdSysError *edest, XrdOucStream &CFile);
 int  xnbsq(XrdSysError *edest, XrdOucStream &CFile);
 int  xnml(XrdSysError *edest, XrdOucStream &CFile);
+int  xnsmap(XrdSysError *edest, XrdOucStream &CFile);
 int  xolib(XrdSysError *edest, XrdOucStream &CFile);
 int  xperf(XrdSysError *edest, XrdOucStream &CFile);
 int  xpidf(XrdSysError *edest, XrdOucStream &CFile);
@@ -257,6 +263,10 @@ int               perfint;
 int               cachelife;
 int               emptylife;
 int               pendplife;
+char             *fxSnapPath;
+int               fxSnapIntv;
+int               NSMapIntv;
+int               NSMapSize;
 int               FSlim;
 };
 namespace XrdCms
@@ -425,6 +425,14 @@ int XrdCmsFinderRMT::Locate(XrdOucErrInfo &Resp, const char *path, int flags,
       }
   }
 
+// If the caller can handle a deferred response, tell the manager so that it
+// can park a request it cannot yet answer and push the answer when it arrives.
+//
+   if (Resp.getErrCB())
+      Data.Opts |= (Data.Request.rrCode == kYR_locate
+                 ?  int(CmsLocateRequest::kYR_pushok)
+                 :  int(CmsSelectRequest::kYR_pushok));
+
 // Pack the arguments
 //
    if (!(iovcnt = Parser.Pack(int(Data.Request.rrCode), &xmsg[1], &xmsg[xNum],
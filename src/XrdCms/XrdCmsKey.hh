@@ -33,6 +33,7 @@
 #include <string.h>
 
 #include "XrdCms/XrdCmsTypes.hh"
+#include "XrdSys/XrdSysPthread.hh"
 
 /******************************************************************************/
 /*                       C l a s s   X r d C m s K e y                        */
@@ -92,6 +93,7 @@ public:
 SMask_t        hfvec;    // Servers that are staging or have the file
 SMask_t        pfvec;    // Servers that are staging         the file
 SMask_t        qfvec;    // Servers that are not yet queried
+SMask_t        nfvec;    // Servers that reported the file missing
 unsigned int   TOD_B;    // Server currency clock
 int            lifeline; // TOD when nil entry should expire
 union {
@@ -120,7 +122,9 @@ XrdCmsKeyLoc&  operator=(const XrdCmsKeyLoc &rhs)
   
 // The XrdCmsKeyItem object marries the XrdCmsKey and XrdCmsKeyLoc objects in
 // the key cache. It is only used by logical manipulator, XrdCmsCache, which
-// always front-ends the physical manipulator, XrdCmsNash.
+// always front-ends the physical manipulator, XrdCmsNash. Items are placed on
+// one of TickRate expiration lists (tockTab) supplied by the caller who must
+// serialize access to it. The free list is shared and has its own lock.
 //
 class XrdCmsKeyItem
 {
@@ -130,19 +134,19 @@ public:
        XrdCmsKey      Key;
        XrdCmsKeyItem *Next;
 
-static XrdCmsKeyItem *Alloc(unsigned int theTock);
+static XrdCmsKeyItem *Alloc(XrdCmsKeyItem **tockTab, unsigned int theTock);
 
        void           Recycle();
 
-       void           Reload();
+       void           Reload(XrdCmsKeyItem **tockTab);
 
 static int            Replenish();
 
 static void           Stats(int &isAlloc, int &isFree, int &wasEmpty);
 
-static XrdCmsKeyItem *Unload(unsigned int   theTock);
+static XrdCmsKeyItem *Unload(XrdCmsKeyItem **tockTab, unsigned int theTock);
 
-static XrdCmsKeyItem *Unload(XrdCmsKeyItem *theItem);
+static XrdCmsKeyItem *Unload(XrdCmsKeyItem **tockTab, XrdCmsKeyItem *theItem);
 
        XrdCmsKeyItem() {}  // Warning see the constructor!
       ~XrdCmsKeyItem() {}  // These are usually never deleted
@@ -154,7 +158,9 @@ static const          int minFree  = 1024;
 
 private:
 
-static XrdCmsKeyItem *TockTable[TickRate];
+static int            Refill();
+
+static XrdSysMutex    fMutex;
 static XrdCmsKeyItem *Free;
 static int            numFree;
 static int            numHave;
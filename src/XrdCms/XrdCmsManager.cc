@@ -284,6 +284,32 @@ void XrdCmsManager::Inform(const char *What, struct iovec *vP, int vN, int vT)
   
 /******************************************************************************/
 
+int XrdCmsManager::InformNS(struct iovec *vP, int vN, int vT)
+{
+   XrdCmsNode *nP;
+   int i, nSent = 0;
+
+// Obtain a lock on the table
+//
+   MTMutex.Lock();
+
+// Run through the table looking for managers that accept namespace maps
+//
+   for (i = 0; i <= MTHi; i++)
+       {if ((nP=MastTab[i]) && !nP->isOffline && nP->okNSMap())
+           {nP->Lock(true);
+            MTMutex.UnLock();
+            if (nP->Send(vP, vN, vT) >= 0) nSent++;
+            nP->UnLock();
+            MTMutex.Lock();
+           }
+       }
+   MTMutex.UnLock();
+   return nSent;
+}
+  
+/******************************************************************************/
+
 void XrdCmsManager::Inform(XrdCms::CmsReqCode rCode, int rMod,
                                   const char *Arg,  int Alen)
 {
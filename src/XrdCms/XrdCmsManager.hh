@@ -73,6 +73,10 @@ static void Inform(const char *What, struct iovec *vP, int vN, int vT=0);
 static void Inform(XrdCms::CmsReqCode rCode, int rMod, const char *Arg=0, int Alen=0);
 static void Inform(XrdCms::CmsRRHdr &Hdr, const char *Arg=0, int Alen=0);
 
+// Sends to managers that accept namespace maps, returning how many were sent to
+//
+static int  InformNS(struct iovec *vP, int vN, int vT);
+
 static bool Present() {return MTHi >= 0;};
 
 void        Remove(XrdCmsNode *nP, const char *reason=0);
@@ -32,6 +32,7 @@
 #include <fcntl.h>
 #include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
@@ -321,7 +322,8 @@ int XrdCmsMeter::Report(int &pcpu, int &pnet, int &pxeq,
 void *XrdCmsMeter::Run()
 {
    const struct timespec rqtp = {30, 0};
-   int i, myLoad, prevLoad = -1;
+   int i, myLoad, lastLoad = -1;
+   bool isHigh, wasHigh = false;
    char *lp = 0;
 
 // Execute the program (keep restarting and keep reading the output)
@@ -336,12 +338,18 @@ void *XrdCmsMeter::Run()
                    repMutex.UnLock();
                    if (i != 5) break;
                    myLoad = calcLoad(cpu_load,net_load,xeq_load,mem_load,pag_load);
-                   if (prevLoad >= 0)
-                      {prevLoad = prevLoad - myLoad;
-                       if (prevLoad < 0) prevLoad = -prevLoad;
-                       if (prevLoad > Config.P_fuzz) XrdCmsNode::Report_Usage(0);
-                      }
-                   prevLoad = myLoad;
+                   isHigh = myLoad > Config.MaxLoad;
+//
+// Report the load when it moved away from the last reported value by more
+// than the fuzz factor (so slow drifts are reported and jitter is not) or
+// whenever we cross the load at which managers stop selecting us.
+//
+                   if (isHigh != wasHigh || (lastLoad >= 0
+                   &&  abs(myLoad - lastLoad) > Config.P_fuzz))
+                      {XrdCmsNode::Report_Usage(0);
+                       lastLoad = myLoad;
+                      } else if (lastLoad < 0) lastLoad = myLoad;
+                   wasHigh = isHigh;
                   }
          if (lp) Say.Emsg("Meter","Perf monitor returned invalid output:",lp);
             else Say.Emsg("Meter","Perf monitor died.");
@@ -499,7 +507,7 @@ void XrdCmsMeter::SpaceMsg(int why)
   
 void XrdCmsMeter::UpdtSpace()
 {
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    SpaceData mySpace;
 
 // Get new space values for the cluser
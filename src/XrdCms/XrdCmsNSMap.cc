@@ -0,0 +1,403 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d C m s N S M a p . c c                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <netinet/in.h>
+#include <sys/uio.h>
+
+#include "XProtocol/YProtocol.hh"
+
+#include "XrdCms/XrdCmsConfig.hh"
+#include "XrdCms/XrdCmsManager.hh"
+#include "XrdCms/XrdCmsNSMap.hh"
+#include "XrdCms/XrdCmsPList.hh"
+#include "XrdCms/XrdCmsTrace.hh"
+
+#include "XrdOuc/XrdOucName2Name.hh"
+#include "XrdOuc/XrdOucNSWalk.hh"
+#include "XrdSys/XrdSysError.hh"
+
+using namespace XrdCms;
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+  
+XrdCmsNSPub XrdCms::NSPub;
+
+/******************************************************************************/
+/*            E x t e r n a l   T h r e a d   I n t e r f a c e s             */
+/******************************************************************************/
+  
+void *XrdCmsStartNSPub(void *carg)
+      {XrdCmsNSPub *npP = (XrdCmsNSPub *)carg;
+       return npP->Start();
+      }
+
+/******************************************************************************/
+/*                     C l a s s   X r d C m s N S M a p                      */
+/******************************************************************************/
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+  
+XrdCmsNSMap::XrdCmsNSMap(unsigned int size, int nhash, unsigned int gen)
+                        : mapFill(0), mapGen(gen), numHash(nhash), mapEnd(0)
+{
+// The size must be a power of two, the caller should have made sure of that
+//
+   if (!size || size > maxSize || (size & (size-1))) size = 0;
+   mapSize = size;
+   mapMask = size*8 - 1;
+   mapBits = (size ? (char *)calloc(size, 1) : 0);
+   if (!mapBits) mapSize = 0;
+}
+
+/******************************************************************************/
+/* Public                            A d d                                    */
+/******************************************************************************/
+  
+void XrdCmsNSMap::Add(unsigned long long hval)
+{
+   unsigned int n, h1 = static_cast<unsigned int>(hval);
+   unsigned int    h2 = static_cast<unsigned int>(hval >> 32) | 1;
+
+   for (int i = 0; i < numHash; i++)
+       {n = (h1 + i*h2) & mapMask;
+        mapBits[n >> 3] |= static_cast<char>(1 << (n & 7));
+       }
+}
+
+/******************************************************************************/
+/* Public                           F i l l                                   */
+/******************************************************************************/
+  
+int XrdCmsNSMap::Fill(const char *data, int dlen, unsigned int offset)
+{
+   if (!mapBits || offset != mapFill || dlen < 0
+   ||  static_cast<unsigned int>(dlen) > mapSize - offset) return -1;
+
+   memcpy(mapBits+offset, data, dlen);
+   mapFill += dlen;
+   return mapFill == mapSize;
+}
+
+/******************************************************************************/
+/* Public                            H a s                                    */
+/******************************************************************************/
+  
+bool XrdCmsNSMap::Has(unsigned long long hval)
+{
+   unsigned int n, h1 = static_cast<unsigned int>(hval);
+   unsigned int    h2 = static_cast<unsigned int>(hval >> 32) | 1;
+
+   for (int i = 0; i < numHash; i++)
+       {n = (h1 + i*h2) & mapMask;
+        if (!(mapBits[n >> 3] & (1 << (n & 7)))) return false;
+       }
+   return true;
+}
+
+/******************************************************************************/
+/* Public                           H a s h                                   */
+/******************************************************************************/
+
+// This is the 64-bit FNV-1a hash. Repeated and trailing slashes are skipped
+// so that a path matches regardless of how the client spelled it.
+//
+unsigned long long XrdCmsNSMap::Hash(const char *path)
+{
+   const unsigned char *pP = (const unsigned char *)path;
+   unsigned long long hval = 0xcbf29ce484222325ULL;
+
+   while(*pP)
+        {if (*pP == '/' && (*(pP+1) == '/' || !*(pP+1))) {pP++; continue;}
+         hval ^= *pP++;
+         hval *= 0x100000001b3ULL;
+        }
+   return hval;
+}
+
+/******************************************************************************/
+/*                     C l a s s   X r d C m s N S P u b                      */
+/******************************************************************************/
+/******************************************************************************/
+/* Public                          A d d e d                                  */
+/******************************************************************************/
+  
+void XrdCmsNSPub::Added(const char *path)
+{
+   unsigned long long hval;
+
+// Nothing to do if we are not publishing a map
+//
+   if (!pubIntv) return;
+   hval = XrdCmsNSMap::Hash(path);
+
+// Add the file to the current map and remember it for the map being built
+//
+   pubCV.Lock();
+   if (curMap) curMap->Add(hval);
+   if (isBuilding) addVec.push_back(hval);
+   pubCV.UnLock();
+}
+
+/******************************************************************************/
+/* Private                         B u i l d                                  */
+/******************************************************************************/
+  
+XrdCmsNSMap *XrdCmsNSPub::Build(unsigned int &nFiles)
+{
+   static const int wOpts = XrdOucNSWalk::retFile | XrdOucNSWalk::retLink
+                          | XrdOucNSWalk::retType
+                          | XrdOucNSWalk::Recurse | XrdOucNSWalk::skpErrs;
+   std::vector<unsigned long long> hVec;
+   std::vector<std::string> eVec;
+   XrdOucNSWalk::NSEnt *nsP, *nxP;
+   XrdCmsNSMap *mapP;
+   XrdCmsPList *plP;
+   const char *fn;
+   char pBuff[XrdCmsMAX_PATH_LEN+1], lBuff[XrdCmsMAX_PATH_LEN+1];
+   unsigned int mSize;
+   int rc;
+
+// Anything reported while we walk the namespace must end up in the map
+//
+   pubCV.Lock();
+   addVec.clear();
+   isBuilding = true;
+   pubCV.UnLock();
+
+// Get the list of exported paths so we need not hold the lock while walking
+//
+   Config.PathList.Lock();
+   plP = Config.PathList.First();
+   while(plP) {eVec.push_back(plP->Path()); plP = plP->Next();}
+   Config.PathList.UnLock();
+
+// Walk each exported path collecting the hash of every file we find. Since we
+// need the logical name of each file, map physical names back when we must.
+//
+   for (unsigned int k = 0; k < eVec.size(); k++)
+       {fn = eVec[k].c_str();
+        if (Config.lcl_N2N
+        &&  (rc = Config.lcl_N2N->lfn2pfn(fn, pBuff, sizeof(pBuff))))
+           {Say.Emsg("NSMap", rc, "determine pfn for", fn);
+            continue;
+           }
+        XrdOucNSWalk nsWalk(0, (Config.lcl_N2N ? pBuff : fn), 0, wOpts);
+        while((nsP = nsWalk.Index(rc)))
+             {do {fn = nsP->Path;
+                  if (!Config.lcl_N2N
+                  ||  !Config.lcl_N2N->pfn2lfn(fn, lBuff, sizeof(lBuff)))
+                     hVec.push_back(XrdCmsNSMap::Hash(Config.lcl_N2N
+                                                      ? lBuff : fn));
+                  nxP = nsP->Next; delete nsP;
+                 } while((nsP = nxP));
+             }
+       }
+
+// Size the map for about ten bits per file unless we were told the size. The
+// map must be a power of two in size.
+//
+   nFiles = hVec.size();
+   if (pubSize) mSize = pubSize;
+      else {mSize = XrdCmsNSMap::minSize;
+            while(mSize < XrdCmsNSMap::maxSize
+            &&    mSize*8ULL < nFiles*10ULL) mSize <<= 1;
+           }
+
+// Build the map
+//
+   mapP = new XrdCmsNSMap(mSize, XrdCmsNSMap::defHash, ++pubGen);
+   if (!mapP->Data())
+      {Say.Emsg("NSMap", ENOMEM, "build namespace map");
+       delete mapP; mapP = 0;
+      } else {
+       for (unsigned int i = 0; i < nFiles; i++) mapP->Add(hVec[i]);
+      }
+
+// Add in whatever was reported while we were walking and we are done
+//
+   pubCV.Lock();
+   if (mapP) for (unsigned int i = 0; i < addVec.size(); i++)
+                 mapP->Add(addVec[i]);
+   addVec.clear();
+   isBuilding = false;
+   pubCV.UnLock();
+   return mapP;
+}
+  
+/******************************************************************************/
+/* Public                           I n i t                                   */
+/******************************************************************************/
+  
+int XrdCmsNSPub::Init(int every, int size)
+{
+   pthread_t tid;
+   unsigned int mSize;
+
+// Files that can be staged in are not in the namespace so a map would
+// wrongly tell our managers that we do not have them.
+//
+   if (Config.DiskSS)
+      {Say.Say("Config warning: nsmap ignored; this server may stage files.");
+       return 1;
+      }
+
+// Round up the size to the next power of two
+//
+   if (size > 0)
+      {mSize = XrdCmsNSMap::minSize;
+       while(mSize < XrdCmsNSMap::maxSize && mSize < (unsigned int)size)
+            mSize <<= 1;
+       pubSize = mSize;
+      }
+   pubIntv = every;
+
+// Start the thread that builds and publishes the map
+//
+   if (XrdSysThread::Run(&tid, XrdCmsStartNSPub, (void *)this,
+                         0, "Namespace map"))
+      {Say.Emsg("Init", errno, "start namespace map publisher");
+       pubIntv = 0;
+       return 0;
+      }
+   return 1;
+}
+
+/******************************************************************************/
+/* Private                       P u b l i s h                                */
+/******************************************************************************/
+
+// The caller must hold the pubCV lock which is released here.
+//
+void XrdCmsNSPub::Publish()
+{
+   EPNAME("Publish")
+   static const unsigned int maxSeg = CmsNSMapRequest::maxSeg;
+   CmsNSMapRequest nsReq;
+   struct iovec ioV[2];
+   char *mBits;
+   unsigned int mSize, mOffs, sLen, mGen;
+   int mHash, nMan = 0;
+
+// Copy the map so that new files can be added while we send it
+//
+   if (!curMap) {pubCV.UnLock(); return;}
+   mSize = curMap->Size(); mGen = curMap->Gen(); mHash = curMap->Hashes();
+   if (!(mBits = (char *)malloc(mSize)))
+      {pubCV.UnLock();
+       Say.Emsg("NSMap", ENOMEM, "send namespace map");
+       return;
+      }
+   memcpy(mBits, curMap->Data(), mSize);
+   pubCV.UnLock();
+
+// Fill out the fixed part of each segment. The map is valid until a second
+// refresh is missed.
+//
+   nsReq.Hdr.streamid = mGen;
+   nsReq.Hdr.rrCode   = kYR_nsmap;
+   nsReq.Hdr.modifier = kYR_raw;
+   nsReq.Life         = htonl(static_cast<kXR_unt32>(pubIntv*2 + 60));
+   nsReq.Size         = htonl(mSize);
+   nsReq.Hashes       = htonl(static_cast<kXR_unt32>(mHash));
+   ioV[0].iov_base    = (char *)&nsReq;
+   ioV[0].iov_len     = sizeof(nsReq);
+
+// Send the map in segments to every manager that accepts it
+//
+   for (mOffs = 0; mOffs < mSize; mOffs += sLen)
+       {sLen = (mSize - mOffs > maxSeg ? maxSeg : mSize - mOffs);
+        nsReq.Hdr.datalen = htons(static_cast<kXR_unt16>(sizeof(nsReq)
+                                  - sizeof(nsReq.Hdr) + sLen));
+        nsReq.Offset      = htonl(mOffs);
+        ioV[1].iov_base   = mBits + mOffs;
+        ioV[1].iov_len    = sLen;
+        nMan = XrdCmsManager::InformNS(ioV, 2, sizeof(nsReq) + sLen);
+        if (!nMan) break;
+       }
+   free(mBits);
+   DEBUG("map " <<mGen <<' ' <<mSize <<" bytes sent to " <<nMan <<" managers");
+}
+
+/******************************************************************************/
+/* Public                         R e s e n d                                 */
+/******************************************************************************/
+  
+void XrdCmsNSPub::Resend()
+{
+   if (!pubIntv) return;
+   pubCV.Lock();
+   doResend = true;
+   pubCV.Signal();
+   pubCV.UnLock();
+}
+
+/******************************************************************************/
+/* Public                          S t a r t                                  */
+/******************************************************************************/
+  
+void *XrdCmsNSPub::Start()
+{
+   EPNAME("NSMap")
+   XrdCmsNSMap *mapP, *oldP;
+   time_t nextBuild = 0, tNow;
+   unsigned int nFiles;
+
+// Rebuild the map every interval and send it out. In between we only resend
+// the current map when we log into another manager.
+//
+   pubCV.Lock();
+   do {tNow = time(0);
+       if (tNow >= nextBuild)
+          {pubCV.UnLock();
+           mapP = Build(nFiles);
+           pubCV.Lock();
+           if (mapP)
+              {oldP = curMap; curMap = mapP;
+               DEBUG("map " <<mapP->Gen() <<" built for " <<nFiles <<" files");
+               if (oldP) delete oldP;
+              }
+           nextBuild = time(0) + pubIntv;
+          } else if (!doResend)
+                    {pubCV.Wait(static_cast<int>(nextBuild - tNow));
+                     continue;
+                    }
+       doResend = false;
+       Publish();
+       pubCV.Lock();
+      } while(1);
+
+// Keep compiler happy
+//
+   return (void *)0;
+}
@@ -0,0 +1,150 @@
+#ifndef __XRDCMSNSMAP_HH__
+#define __XRDCMSNSMAP_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d C m s N S M a p . h h                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                     C l a s s   X r d C m s N S M a p                      */
+/******************************************************************************/
+  
+// The XrdCmsNSMap class is a bloom filter summarizing the files a data server
+// has (see the nsmap request in YProtocol.hh for the exact layout). Servers
+// build one from their exported namespace and send it to their managers, who
+// then only ask the servers whose map may hold a file about it. A map has no
+// false negatives for the files present when it was built or reported since
+// then via have requests; files that appear behind the server's back are only
+// seen once the map is rebuilt.
+//
+class XrdCmsNSMap
+{
+public:
+
+// Add() and Has() record and test a path hash as returned by Hash().
+//
+void   Add(unsigned long long hval);
+
+bool   Has(unsigned long long hval);
+
+static unsigned long long Hash(const char *path);
+
+// Fill() copies in a segment at the indicated offset. Segments must arrive
+// in order. It returns 1 when the map is complete, 0 when more segments are
+// expected and -1 if the segment does not fit.
+//
+int    Fill(const char *data, int dlen, unsigned int offset);
+
+inline
+char  *Data()   {return mapBits;}
+
+inline
+unsigned int Gen()  {return mapGen;}
+
+inline
+int    Hashes() {return numHash;}
+
+inline
+bool   isValid(time_t tNow) {return tNow < mapEnd;}
+
+inline
+void   setLife(int life) {mapEnd = time(0) + life;}
+
+inline
+unsigned int Size() {return mapSize;}
+
+       XrdCmsNSMap(unsigned int size, int nhash, unsigned int gen=0);
+      ~XrdCmsNSMap() {if (mapBits) free(mapBits);}
+
+static const int          defHash = 7;         // Probes per path
+static const unsigned int maxSize = 128*1024*1024;
+static const unsigned int minSize = 8*1024;
+
+private:
+
+char          *mapBits;
+unsigned int   mapSize;
+unsigned int   mapMask;   // Number of bits - 1
+unsigned int   mapFill;   // Bytes received so far
+unsigned int   mapGen;
+int            numHash;
+time_t         mapEnd;
+};
+
+/******************************************************************************/
+/*                     C l a s s   X r d C m s N S P u b                      */
+/******************************************************************************/
+  
+// The XrdCmsNSPub class runs on data servers. It periodically rebuilds the
+// server's namespace map and sends it to every manager that accepts one.
+//
+class XrdCmsNSPub
+{
+public:
+
+// Added() is called whenever the server reports a new file to its managers.
+//
+void   Added(const char *path);
+
+// Init() starts the thread that builds and sends the map.
+//
+int    Init(int every, int size);
+
+// Resend() is called when we log into a manager that accepts namespace maps.
+//
+void   Resend();
+
+void  *Start();
+
+       XrdCmsNSPub() : pubCV(0, "nsmap"), curMap(0), pubIntv(0), pubSize(0),
+                       pubGen(0), isBuilding(false), doResend(false) {}
+      ~XrdCmsNSPub() {}
+
+private:
+
+XrdCmsNSMap *Build(unsigned int &nFiles);
+void         Publish();
+
+XrdSysCondVar  pubCV;      // Protects everything below
+XrdCmsNSMap   *curMap;
+std::vector<unsigned long long> addVec; // Added while building
+int            pubIntv;
+int            pubSize;
+unsigned int   pubGen;
+bool           isBuilding;
+bool           doResend;
+};
+
+namespace XrdCms
+{
+extern    XrdCmsNSPub NSPub;
+}
+#endif
@@ -51,14 +51,15 @@ XrdCmsNash::XrdCmsNash(int psize, int csize)
 /* public                            A d d                                    */
 /******************************************************************************/
   
-XrdCmsKeyItem *XrdCmsNash::Add(XrdCmsKey &Key)
+XrdCmsKeyItem *XrdCmsNash::Add(XrdCmsKey &Key, XrdCmsKeyItem **tockTab)
 {
    XrdCmsKeyItem *hip;
    unsigned int kent;
 
 // Allocate the entry
 //
-   if (!(hip = XrdCmsKeyItem::Alloc(Key.TOD))) return (XrdCmsKeyItem *)0;
+   if (!(hip = XrdCmsKeyItem::Alloc(tockTab, Key.TOD)))
+      return (XrdCmsKeyItem *)0;
 
 // Check if we should expand the table
 //
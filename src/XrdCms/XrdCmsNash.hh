@@ -35,10 +35,12 @@
 class XrdCmsNash
 {
 public:
-XrdCmsKeyItem *Add(XrdCmsKey &Key);
+XrdCmsKeyItem *Add(XrdCmsKey &Key, XrdCmsKeyItem **tockTab);
 
 XrdCmsKeyItem *Find(XrdCmsKey &Key);
 
+int            Num() {return nashnum;}
+
 int            Recycle(XrdCmsKeyItem *rip);
 
 // When allocateing a new nash, specify the required starting size. Make
@@ -49,12 +49,14 @@
 #include "XrdCms/XrdCmsManager.hh"
 #include "XrdCms/XrdCmsManList.hh"
 #include "XrdCms/XrdCmsMeter.hh"
+#include "XrdCms/XrdCmsNSMap.hh"
 #include "XrdCms/XrdCmsPList.hh"
 #include "XrdCms/XrdCmsPrepare.hh"
 #include "XrdCms/XrdCmsRRData.hh"
 #include "XrdCms/XrdCmsNode.hh"
 #include "XrdCms/XrdCmsSelect.hh"
 #include "XrdCms/XrdCmsState.hh"
+#include "XrdCms/XrdCmsStateQ.hh"
 #include "XrdCms/XrdCmsTrace.hh"
 
 #include "XrdOss/XrdOss.hh"
@@ -92,11 +94,10 @@ XrdCmsNode::XrdCmsNode(XrdLink *lnkp, const char *theIF, const char *nid,
                        int port, int lvl, int id) : nodeMutex(0, "nodeCV")
 {
     static XrdSysMutex   iMutex;
-    static const SMask_t smask_1(1);
     static int           iNum = 1;
 
     Link     =  lnkp;
-    NodeMask =  (id < 0 ? 0 : smask_1 << id);
+    NodeMask =  (id < 0 ? SMask_t(0) : SMask_t::Bit(id));
     NodeID   = id;
     cidP     =  0;
     hasNet   =  0;
@@ -127,8 +128,10 @@ XrdCmsNode::XrdCmsNode(XrdLink *lnkp, const char *theIF, const char *nid,
     Share    =  0;
     Shrem    =  0;
     Shrin    =  0;
+    RefI     =  0;
     logload  =  Config.LogPerf;
     DropTime =  0;
+    LoadTime =  0;
     DropJob  =  0;
     myName   =  0;
     myNlen   =  0;
@@ -142,6 +145,10 @@ XrdCmsNode::XrdCmsNode(XrdLink *lnkp, const char *theIF, const char *nid,
     TimeZone = 0;
     subsPort = 0;
     myVersion= kYR_Version;
+    canStateV= false;
+    canNSMap =  false;
+    nsMap    =  0;
+    nsNew    =  0;
 
     lkCount  = 0;
     ulCount  = 0;
@@ -171,6 +178,8 @@ XrdCmsNode::~XrdCmsNode()
    if (Ident) free(Ident);
    if (myNID) free(myNID);
    if (myName)free(myName);
+   if (nsMap) delete nsMap;
+   if (nsNew) delete nsNew;
 }
 
 /******************************************************************************/
@@ -412,7 +421,7 @@ const char *XrdCmsNode::do_Disc(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Gone(XrdCmsRRData &Arg)
 {
    EPNAME("do_Gone")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int newgone;
 
 // Do some debugging
@@ -454,25 +463,43 @@ const char *XrdCmsNode::do_Gone(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Have(XrdCmsRRData &Arg)
 {
    EPNAME("do_Have")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    XrdCmsPInfo  pinfo;
    int isnew, Opts;
 
 // Do some debugging
 //
-   TRACER(Files, (Arg.Request.modifier&CmsHaveRequest::Pending ? "P ":"") 
+   TRACER(Files, ((Arg.Request.modifier & CmsHaveRequest::Missing)
+                  == CmsHaveRequest::Missing ? "M " :
+                  Arg.Request.modifier & CmsHaveRequest::Pending ? "P ":"")
                  <<Arg.Path);
 
 // Find if we can handle the file in r/w mode and if staging is present
 //
    Opts = (Cache.Paths.Find(Arg.Path, pinfo) && (pinfo.rwvec & NodeMask)
         ? XrdCmsSelect::Write : 0);
+
+// A manager below us may tell us that it does not have a file we asked about.
+// This may settle the query well before its deadline. These never propagate
+// as we will tell our managers when they ask us, like everyone else.
+//
+   if ((Arg.Request.modifier & CmsHaveRequest::Missing)
+                            == CmsHaveRequest::Missing)
+      {if (Config.asManager())
+          {XrdCmsSelect Sel(XrdCmsSelect::Advisory, Arg.Path, Arg.PathLen-1);
+           Sel.Path.Hash = Arg.Request.streamid;
+           if (baseFS.isDFS()) Cache.MissFile(Sel, allNodes, NodeMask);
+              else Cache.MissFile(Sel, NodeMask, pinfo.rovec);
+          }
+       return 0;
+      }
    if (Arg.Request.modifier & CmsHaveRequest::Pending)
       Opts |= XrdCmsSelect::Pending;
 
 // Update path information. If we are exporting a shared-everything file system
 // then we need to also provide the cache the current list of nodes and how
-// they export the path in question for fast redispatch processing.
+// they export the path in question for fast redispatch processing. Otherwise,
+// the node's namespace map, if any, must now include the file.
 //
    if (!Config.asManager()) isnew = 1;
       else {XrdCmsSelect Sel(XrdCmsSelect::Advisory|Opts,Arg.Path,Arg.PathLen-1);
@@ -480,7 +507,10 @@ const char *XrdCmsNode::do_Have(XrdCmsRRData &Arg)
             if (baseFS.isDFS())
                {Sel.Vec.hf = pinfo.rovec; Sel.Vec.wf = pinfo.rwvec;
                 isnew       = Cache.AddFile(Sel, allNodes);
-               } else isnew = Cache.AddFile(Sel, NodeMask);
+               } else {
+                isnew       = Cache.AddFile(Sel, NodeMask);
+                Cluster.NSMapAdd(this, Arg.Path);
+               }
            }
 
 // Return if we have no managers or we already informed the managers
@@ -496,6 +526,18 @@ const char *XrdCmsNode::do_Have(XrdCmsRRData &Arg)
    return 0;
 }
   
+/******************************************************************************/
+/*                              d o _ H a v e V                               */
+/******************************************************************************/
+  
+// Responses to batched state requests are handled by the state query batcher.
+//
+const char *XrdCmsNode::do_HaveV(XrdCmsRRData &Arg)
+{
+   StateQ.Answer(this, Arg);
+   return 0;
+}
+  
 /******************************************************************************/
 /*                               d o _ L o a d                                */
 /******************************************************************************/
@@ -521,6 +563,12 @@ const char *XrdCmsNode::do_Load(XrdCmsRRData &Arg)
    myLoad = Meter.calcLoad(pcpu, pnet, pxeq, pmem, ppag);
    myMass = Meter.calcLoad(myLoad, pdsk);
    DiskFree = Arg.dskFree;
+   LoadTime = time(0);
+
+// The load now reflects some of the redirects made since the last report, so
+// let the count of in-flight redirects decay.
+//
+   RefI >>= 1;
    DiskUtil = pdsk;
 
 // Do some debugging
@@ -631,6 +679,8 @@ const char *XrdCmsNode::do_Locate(XrdCmsRRData &Arg)
    if (Arg.Opts & CmsLocateRequest::kYR_asap)
       {Sel.Opts |= XrdCmsSelect::Asap;    *toP++='i'; Sel.InfoP = &reqInfo;
        reqInfo.lsLU = static_cast<char>(lsopts);
+       if (Arg.Opts & CmsLocateRequest::kYR_pushok)
+          {reqInfo.canPush = 1;           *toP++='p';}
       }
       else                                            Sel.InfoP = 0;
 
@@ -830,7 +880,7 @@ const char *XrdCmsNode::do_Mkpath(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Mv(XrdCmsRRData &Arg)
 {
    EPNAME("do_Mv")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int rc;
 
 // Do some debugging
@@ -877,6 +927,57 @@ const char *XrdCmsNode::do_Mv(XrdCmsRRData &Arg)
    return (rc ? fsFail(Arg.Ident, "mv", Arg.Path, rc) : 0);
 }
 
+/******************************************************************************/
+/*                              d o _ N S M a p                               */
+/******************************************************************************/
+  
+// Request: nsmap <life> <size> <offset> <hashes> <bits>
+// Respond: n/a
+//
+// The segments are collected in a new map that replaces the current one when
+// the last segment arrives. Anything out of order discards the new map and we
+// keep using the old one until it expires.
+//
+const char *XrdCmsNode::do_NSMap(XrdCmsRRData &Arg)
+{
+   EPNAME("do_NSMap")
+   static const int fLen = sizeof(CmsNSMapRequest) - sizeof(CmsRRHdr);
+   CmsNSMapRequest nsReq;
+   unsigned int mSize, mOffs;
+   int rc;
+
+// Extract the fixed fields, the bits follow them
+//
+   if (Arg.Dlen < fLen) {DEBUGR("ignoring short nsmap segment"); return 0;}
+   memcpy(((char *)&nsReq) + sizeof(CmsRRHdr), Arg.Buff, fLen);
+   mSize = ntohl(nsReq.Size);
+   mOffs = ntohl(nsReq.Offset);
+
+// The first segment starts a new map
+//
+   if (!mOffs)
+      {if (nsNew) delete nsNew;
+       nsNew = new XrdCmsNSMap(mSize, static_cast<int>(ntohl(nsReq.Hashes)),
+                               Arg.Request.streamid);
+      } else if (!nsNew || nsNew->Gen() != Arg.Request.streamid)
+                {DEBUGR("ignoring nsmap segment " <<mOffs);
+                 return 0;
+                }
+
+// Add in the segment and if the map is complete, start using it
+//
+   if ((rc = nsNew->Fill(Arg.Buff+fLen, Arg.Dlen-fLen, mOffs)) > 0)
+      {nsNew->setLife(static_cast<int>(ntohl(nsReq.Life)));
+       DEBUGR("nsmap " <<nsNew->Gen() <<' ' <<mSize <<" bytes");
+       Cluster.NSMapSet(this, nsNew);
+       nsNew = 0;
+      } else if (rc < 0)
+                {DEBUGR("invalid nsmap segment " <<mOffs <<" size " <<mSize);
+                 delete nsNew; nsNew = 0;
+                }
+   return 0;
+}
+
 /******************************************************************************/
 /*                               d o _ P i n g                                */
 /******************************************************************************/
@@ -960,7 +1061,7 @@ const char *XrdCmsNode::do_PrepDel(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Rm(XrdCmsRRData &Arg)
 {
    EPNAME("do_Rm")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int rc;
 
 // Do some debugging
@@ -995,7 +1096,7 @@ const char *XrdCmsNode::do_Rm(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Rmdir(XrdCmsRRData &Arg)
 {
    EPNAME("do_Rmdir")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int rc;
 
 // Do some debugging
@@ -1051,6 +1152,8 @@ const char *XrdCmsNode::do_Select(XrdCmsRRData &Arg)
    if (Arg.Opts & CmsSelectRequest::kYR_prvtnet)
       {XrdNetIF::Privatize(ifType);                                *toP++='P';}
    Sel.Opts |= static_cast<int>(ifType) & XrdCmsSelect::ifWant;
+   if (Arg.Opts & CmsSelectRequest::kYR_pushok)
+      {reqInfo.canPush = 1;                                        *toP++='p';}
 
 // Complete the arguments to select
 //
@@ -1274,7 +1377,9 @@ const char *XrdCmsNode::do_State(XrdCmsRRData &Arg)
 {
    EPNAME("do_State")
    struct iovec xmsg[2];
-   int rc, noResp = Arg.Request.modifier & CmsStateRequest::kYR_noresp;
+   int noResp = Arg.Request.modifier & CmsStateRequest::kYR_noresp;
+   int negOK  = Arg.Request.modifier & CmsStateRequest::kYR_negok;
+   int rc;
 
 // Do some debugging
 //
@@ -1283,27 +1388,21 @@ const char *XrdCmsNode::do_State(XrdCmsRRData &Arg)
 // Process: state <path>
 // Respond: have <path>
 //
-   isKnown = 1;
-
-// If we are a manager then check for the file in the local cache. Otherwise,
-// ask the underlying filesystem whether it has the file.
+// A file we know to be missing is reported as such only if the requestor
+// can handle it. Otherwise, we say nothing as always.
 //
-        if (isMan) {if(!(Arg.Request.modifier = do_StateFWD(Arg))) return 0;}
-   else if (!Config.DiskOK && !Config.asProxy()) return 0;
-   else if (baseFS.Limit() && Arg.Request.modifier&CmsStateRequest::kYR_metaman)
-           {XrdCmsPInfo pinfo;
-            pinfo.rovec = NodeMask;
-            if ((rc = baseFS.Exists(Arg,pinfo)) > 0) Arg.Request.modifier = rc;
-               else return 0;
-           }
-   else     if ((rc = baseFS.Exists(Arg.Path, -(Arg.PathLen-1))) > 0)
-                Arg.Request.modifier = rc;
-   else     return 0;
+   if (!(rc = do_StateChk(Arg))) return 0;
+   if (rc < 0)
+      {if (!negOK) return 0;
+       rc = CmsHaveRequest::Missing;
+      }
+   Arg.Request.modifier = static_cast<kXR_char>(rc);
 
 // Respond appropriately
 //
-   if (Arg.Request.modifier && !noResp)
-      {TRACER(Files,Arg.Path <<" responding have!");
+   if (!noResp)
+      {TRACER(Files,Arg.Path <<(rc == CmsHaveRequest::Missing
+                              ? " responding missing!" : " responding have!"));
        xmsg[0].iov_base      = (char *)&Arg.Request;
        xmsg[0].iov_len       = sizeof(Arg.Request);
        xmsg[1].iov_base      = Arg.Buff;
@@ -1315,6 +1414,34 @@ const char *XrdCmsNode::do_State(XrdCmsRRData &Arg)
    return 0;
 }
   
+/******************************************************************************/
+/*                           d o _ S t a t e C h k                            */
+/******************************************************************************/
+  
+// Returns the have modifier for the file in Arg, zero if we don't know of it,
+// or -1 if we are a manager and know that nothing beneath us has the file.
+//
+int XrdCmsNode::do_StateChk(XrdCmsRRData &Arg)
+{
+   int rc;
+
+   isKnown = 1;
+
+// If we are a manager then check for the file in the local cache. Otherwise,
+// ask the underlying filesystem whether it has the file.
+//
+        if (isMan) return do_StateFWD(Arg);
+   else if (!Config.DiskOK && !Config.asProxy()) return 0;
+   else if (baseFS.Limit() && Arg.Request.modifier&CmsStateRequest::kYR_metaman)
+           {XrdCmsPInfo pinfo;
+            pinfo.rovec = NodeMask;
+            if ((rc = baseFS.Exists(Arg,pinfo)) > 0) return rc;
+           }
+   else     if ((rc = baseFS.Exists(Arg.Path, -(Arg.PathLen-1))) > 0)
+                return rc;
+   return 0;
+}
+
 /******************************************************************************/
 /*                           d o _ S t a t e D F S                            */
 /******************************************************************************/
@@ -1322,7 +1449,7 @@ const char *XrdCmsNode::do_State(XrdCmsRRData &Arg)
 void XrdCmsNode::do_StateDFS(XrdCmsBaseFR *rP, int rc)
 {
    EPNAME("StateDFs");
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    CmsRRHdr Request = {rP->Sid, 0, (kXR_char)(rP->Mod | kYR_raw), 0};
    XrdCmsSelect Sel(0, rP->Path, rP->PathLen);
    int isNew;
@@ -1375,7 +1502,7 @@ void XrdCmsNode::do_StateDFS(XrdCmsBaseFR *rP, int rc)
 int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
 {
    EPNAME("do_StateFWD");
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    XrdCmsSelect Sel(0, Arg.Path, Arg.PathLen-1);
    XrdCmsPInfo  pinfo;
    int retc;
@@ -1384,7 +1511,7 @@ int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
 //
    if (!Cache.Paths.Find(Arg.Path, pinfo) || pinfo.rovec == 0)
       {DEBUGR("Path find failed for state " <<Arg.Path);
-       return 0;
+       return -1;
       }
 
 // Get the primary locations for this file
@@ -1400,6 +1527,10 @@ int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
    if (!retc && !Config.asServer())
       Arg.Request.modifier |= CmsStateRequest::kYR_metaman;
 
+// Any managers below us may tell us right away that they do not have the file
+//
+   Arg.Request.modifier |= CmsStateRequest::kYR_negok;
+
 // Here we process the case where we need to discover whether the file exists.
 // For distributed file systems, we either ask the underlying file system here
 // or forward the request to some arbitrary node in a callback via the baseFS.
@@ -1415,7 +1546,7 @@ int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
                return 0;
               }
            if ((retc = baseFS.Exists(Arg, pinfo)) <= 0)
-              {if (retc < 0) Cache.AddFile(Sel, 0);
+              {if (retc < 0) {Cache.AddFile(Sel, 0); return -1;}
                return 0;
               }
            Sel.Opts=(retc == CmsHaveRequest::Pending ? XrdCmsSelect::Pending:0);
@@ -1425,7 +1556,7 @@ int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
           }
        if (Sel.Vec.pf != 0) return CmsHaveRequest::Pending;
        if (Sel.Vec.hf != 0) return CmsHaveRequest::Online;
-       return 0;
+       return (retc > 0 ? -1 : 0);
       }
 
 // For shared-nothing setups, first check if we need to ask any unasked nodes
@@ -1443,7 +1574,70 @@ int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
 //
    if (Sel.Vec.hf != 0) return CmsHaveRequest::Online;
    if (Sel.Vec.pf != 0){return CmsHaveRequest::Pending;}
-                        return 0;
+
+// If the query deadline passed and no node has the file nor remains to be
+// asked, we know that the file is not here.
+//
+   return (retc > 0 && Sel.Vec.bf == 0 ? -1 : 0);
+}
+
+/******************************************************************************/
+/*                             d o _ S t a t e V                              */
+/******************************************************************************/
+  
+// Batched state requests are handled path by path as state requests. Paths
+// that are known right away are reported in a single havev response while
+// the rest are reported by individual have responses when they are found.
+//
+const char *XrdCmsNode::do_StateV(XrdCmsRRData &Arg)
+{
+   EPNAME("do_StateV")
+   static const int maxPaths = CmsStateVRequest::maxPaths;
+   unsigned char bMap[maxPaths/4];
+   struct iovec xmsg[2] = {{(char *)&Arg.Request, sizeof(Arg.Request)},
+                           {(char *)bMap,         0}};
+   XrdCmsRRData pArg = Arg;
+   char *bP = Arg.Buff, *eP = Arg.Buff + Arg.Dlen, *zP;
+   int negOK = Arg.Request.modifier & CmsStateRequest::kYR_negok;
+   int rc, pNum = 0, hNum = 0;
+
+// Process: statev <path> [<path> [...]]
+// Respond: havev <bitmap>
+//
+   memset(bMap, 0, sizeof(bMap));
+   while(bP < eP && pNum < maxPaths && (zP = (char *)memchr(bP, 0, eP-bP)))
+        {XrdCmsKey pKey(bP, zP-bP);
+         pKey.setHash();
+         pArg.Request.streamid = pKey.Hash;
+         pArg.Request.rrCode   = kYR_state;
+         pArg.Request.modifier = Arg.Request.modifier;
+         pArg.Path    = pArg.Buff = bP;
+         pArg.PathLen = pArg.Dlen = zP-bP+1;
+         if ((rc = do_StateChk(pArg)) < 0)
+            rc = (negOK ? static_cast<int>(CmsHaveRequest::Missing) : 0);
+         if (rc > 0)
+            {bMap[pNum>>2] |= static_cast<unsigned char>(rc << ((pNum&3)<<1));
+             hNum++;
+            }
+         bP = zP+1; pNum++;
+        }
+
+// Do some debugging
+//
+   TRACER(Files, "have " <<hNum <<" of " <<pNum <<" in batch "
+                 <<Arg.Request.streamid);
+
+// Respond only if we have any of the files or know some of them are missing
+//
+   if (hNum)
+      {rc = (pNum+3)/4;
+       xmsg[1].iov_len       = rc;
+       Arg.Request.rrCode    = kYR_havev;
+       Arg.Request.modifier  = kYR_raw;
+       Arg.Request.datalen   = htons(static_cast<unsigned short>(rc));
+       Link->Send(xmsg, 2);
+      }
+   return 0;
 }
 
 /******************************************************************************/
@@ -30,6 +30,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 #include <netinet/in.h>
@@ -47,6 +48,7 @@ class XrdCmsBaseFS;
 class XrdCmsClustID;
 class XrdCmsDrop;
 class XrdCmsManager;
+class XrdCmsNSMap;
 class XrdCmsPrepArgs;
 class XrdCmsRRData;
 class XrdCmsSelected;
@@ -94,6 +96,7 @@ const  char  *do_Chmod(XrdCmsRRData &Arg);
 const  char  *do_Disc(XrdCmsRRData &Arg);
 const  char  *do_Gone(XrdCmsRRData &Arg);
 const  char  *do_Have(XrdCmsRRData &Arg);
+const  char  *do_HaveV(XrdCmsRRData &Arg);
 const  char  *do_Load(XrdCmsRRData &Arg);
 const  char  *do_Locate(XrdCmsRRData &Arg);
 static int    do_LocFmt(char *buff, XrdCmsSelected *sP,
@@ -102,6 +105,7 @@ static int    do_LocFmt(char *buff, XrdCmsSelected *sP,
 const  char  *do_Mkdir(XrdCmsRRData &Arg);
 const  char  *do_Mkpath(XrdCmsRRData &Arg);
 const  char  *do_Mv(XrdCmsRRData &Arg);
+const  char  *do_NSMap(XrdCmsRRData &Arg);
 const  char  *do_Ping(XrdCmsRRData &Arg);
 const  char  *do_Pong(XrdCmsRRData &Arg);
 const  char  *do_PrepAdd(XrdCmsRRData &Arg);
@@ -112,8 +116,10 @@ const  char  *do_Select(XrdCmsRRData &Arg);
 static int    do_SelPrep(XrdCmsPrepArgs &Arg);
 const  char  *do_Space(XrdCmsRRData &Arg);
 const  char  *do_State(XrdCmsRRData &Arg);
+       int    do_StateChk(XrdCmsRRData &Arg);
 static void   do_StateDFS(XrdCmsBaseFR *rP, int rc);
        int    do_StateFWD(XrdCmsRRData &Arg);
+const  char  *do_StateV(XrdCmsRRData &Arg);
 const  char  *do_StatFS(XrdCmsRRData &Arg);
 const  char  *do_Stats(XrdCmsRRData &Arg);
 const  char  *do_Status(XrdCmsRRData &Arg);
@@ -128,6 +134,11 @@ const  char  *do_Usage(XrdCmsRRData &Arg);
 
 inline int    ID(int &INum) {INum = Instance; return NodeID;}
 
+inline int    Identity(char *buff, int blen) // Stable across restarts
+                      {return snprintf(buff, blen, "%s %s:%d",
+                                       myNID, Name(), netIF.Port());
+                      }
+
 inline int    Inst() {return Instance;}
 
        bool   inDomain() {return netIF.InDomain(&netID);}
@@ -212,6 +223,11 @@ inline int   Send(const struct iovec *iov, int iovcnt, int iotot=0)
 
         void setVersion(unsigned short vnum) {myVersion = vnum;}
 
+        void setStateV(bool svok) {canStateV = svok;}
+
+        void setNSMap(bool nsok) {canNSMap = nsok;}
+        bool okNSMap() {return canNSMap;}
+
 inline void  setSlot(short rslot) {RSlot = rslot;}
 inline short getSlot() {return RSlot;}
 
@@ -252,6 +268,10 @@ int                Instance;
 int                myLevel;
 short              subsPort;     // Subscription port number
 unsigned short     myVersion;
+bool               canStateV;    // Node accepts statev requests
+bool               canNSMap;     // Manager accepts nsmap requests
+XrdCmsNSMap       *nsMap;        // Node's namespace map (Cluster STMutex)
+XrdCmsNSMap       *nsNew;        // Namespace map being received
 char              *myCID;
 char              *myNID;
 char              *myName;
@@ -272,6 +292,8 @@ char               Shrem;        // Share of requests left
 char               Shrip;        // Share of requests to skip
 char               Rsvd[2];
 int                Shrin;        // Share intervals used
+int                RefI;         // Redirects since the last load report
+time_t             LoadTime;     // When the last load report arrived
 
 // The following fields are used to keep the supervisor's free space value
 //
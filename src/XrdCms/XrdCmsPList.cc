@@ -63,6 +63,7 @@ int XrdCmsPList_Anchor::Add(const char *pname, XrdCmsPInfo *pinfo)
    p = new XrdCmsPList(pname, pinfo);
    if (pp) { p->next = pp->next; pp->next = p;}
       else { p->next =     next;     next = p;}
+   trieOK = false;
 
 // All done
 //
@@ -76,18 +77,12 @@ int XrdCmsPList_Anchor::Add(const char *pname, XrdCmsPInfo *pinfo)
   
 int XrdCmsPList_Anchor::Find(const char *pname, XrdCmsPInfo &pinfo)
 {
-   int plen = strlen(pname);
+   XrdCmsPList *p;
 
-// Lock the anchor and setup for search
+// Lock the anchor and find the longest matching path
 //
    Lock();
-   XrdCmsPList *p = next;
-
-// Find matching entry
-//
-   while(p) if (p->pathlen <= plen && !strncmp(p->pathname, pname, p->pathlen)) 
-               {pinfo = p->pathmask; break;}
-               else p = p->next;
+   if ((p = Match(pname))) pinfo = p->pathmask;
 
 // All done
 //
@@ -142,6 +137,7 @@ SMask_t XrdCmsPList_Anchor::Insert(const char *pname, XrdCmsPInfo *pinfo)
                            p->pathmask.Or(&(pp->pathmask));
                         pp = pp->next;
                        }
+             trieOK = false;
            }
 
 // All done
@@ -170,6 +166,7 @@ void XrdCmsPList_Anchor::Remove(SMask_t mask)
         {if (!pp->pathmask.And(zmask))
             {if (prevp) {prevp->next = pp->next; delete pp; pp = prevp->next;}
                 else    {       next = pp->next; delete pp; pp = next;}
+             trieOK = false;
             }
             else {prevp = pp; pp = pp->next;}
         }
@@ -180,23 +177,18 @@ void XrdCmsPList_Anchor::Remove(SMask_t mask)
 }
 
 /******************************************************************************/
-/*                                  F i n d                                   */
+/*                                  T y p e                                   */
 /******************************************************************************/
   
 const char *XrdCmsPList_Anchor::Type(const char *pname)
 {
-   int isrw = 0, plen = strlen(pname);
+   XrdCmsPList *p;
+   int isrw = 0;
 
-// Lock the anchor and setup for search
+// Lock the anchor and find the longest matching path
 //
    Lock();
-   XrdCmsPList *p = next;
-
-// Find matching entry
-//
-   while(p) if (p->pathlen <= plen && !strncmp(p->pathname, pname, p->pathlen)) 
-               {isrw = (p->pathmask.rwvec != 0); break;}
-               else p = p->next;
+   if ((p = Match(pname))) isrw = (p->pathmask.rwvec != 0);
 
 // All done
 //
@@ -205,6 +197,90 @@ const char *XrdCmsPList_Anchor::Type(const char *pname)
    return "?";
 }
  
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                               C o m p i l e                                */
+/******************************************************************************/
+  
+bool XrdCmsPList_Anchor::Compile()  // Must be called with the lock held!
+{
+   XrdCmsPList *p;
+   const char *cp;
+   int n, k, num = 1;
+
+// Count the nodes we may need, it's at most one per path character
+//
+   for (p = next; p; p = p->next) num += p->pathlen;
+   if (num > trieMax)
+      {PTNode *newTrie = (PTNode *)realloc(trie, num*sizeof(PTNode));
+       if (!newTrie) return false;
+       trie = newTrie; trieMax = num;
+      }
+
+// Start with the root which matches the empty path
+//
+   trie[0].pent = 0; trie[0].child = trie[0].sibling = -1; trie[0].pchr = 0;
+   trieNum = 1;
+
+// Add each path. The list is sorted longest path first and has no duplicates
+// so each path ends up at its own node.
+//
+   for (p = next; p; p = p->next)
+       {n = 0; cp = p->pathname;
+        while(*cp)
+             {for (k = trie[n].child; k >= 0; k = trie[k].sibling)
+                  if (trie[k].pchr == *cp) break;
+              if (k < 0)
+                 {k = trieNum++;
+                  trie[k].pent    = 0;     trie[k].child = -1;
+                  trie[k].sibling = trie[n].child;
+                  trie[k].pchr    = *cp;   trie[n].child = k;
+                 }
+              n = k; cp++;
+             }
+        trie[n].pent = p;
+       }
+
+// All done
+//
+   trieOK = true;
+   return true;
+}
+
+/******************************************************************************/
+/*                                 M a t c h                                  */
+/******************************************************************************/
+  
+XrdCmsPList *XrdCmsPList_Anchor::Match(const char *pname)
+{                                   // Must be called with the lock held!
+   XrdCmsPList *p;
+   int n;
+
+// Make sure the trie reflects the path list. Should we not be able to build
+// it, fall back to a scan of the list (it's sorted longest path first).
+//
+   if (!trieOK && !Compile())
+      {int plen = strlen(pname);
+       for (p = next; p; p = p->next)
+           if (p->pathlen <= plen && !strncmp(p->pathname, pname, p->pathlen))
+              break;
+       return p;
+      }
+
+// Walk down the trie remembering the last (i.e. longest) path we passed
+//
+   p = trie[0].pent;
+   for (n = 0; *pname; pname++)
+       {for (n = trie[n].child; n >= 0; n = trie[n].sibling)
+            if (trie[n].pchr == *pname) break;
+        if (n < 0) break;
+        if (trie[n].pent) p = trie[n].pent;
+       }
+   return p;
+}
+
 /******************************************************************************/
 /*                                 P T y p e                                  */
 /******************************************************************************/
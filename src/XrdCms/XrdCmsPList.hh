@@ -105,7 +105,7 @@ inline void         Empty(XrdCmsPList *newlist=0)
                     {Lock();
                      XrdCmsPList *p = next;
                      while(p) {next = p->next; delete p; p = next;}
-                     next = newlist;
+                     next = newlist; trieOK = false;
                      UnLock();
                     }
 
@@ -124,18 +124,37 @@ const  char        *Type(const char *pname);
 inline XrdCmsPList *Zorch(XrdCmsPList *newlist=0)
                    {Lock();
                     XrdCmsPList *p = next;
-                    next = newlist;
+                    next = newlist; trieOK = false;
                     UnLock();
                     return p;
                    }
 
-       XrdCmsPList_Anchor() {next = 0;}
+       XrdCmsPList_Anchor() : next(0), trie(0), trieNum(0), trieMax(0),
+                              trieOK(false) {}
 
-      ~XrdCmsPList_Anchor() {Empty();}
+      ~XrdCmsPList_Anchor() {Empty(); if (trie) free(trie);}
 
 private:
 
+// The path list is compiled into a character trie so that the longest
+// matching prefix is found in time proportional to the length of the path
+// instead of the number of paths. The trie only points to list entries, so
+// mask changes are seen right away; it is rebuilt when entries come and go.
+//
+struct PTNode {XrdCmsPList *pent;     // Path ending here, if any
+               int          child;    // First child   or -1
+               int          sibling;  // Next sibling  or -1
+               char         pchr;     // The character of this node
+              };
+
+bool          Compile();
+XrdCmsPList  *Match(const char *pname);
+
 XrdSysMutex   mutex;
 XrdCmsPList  *next;
+PTNode       *trie;
+int           trieNum;
+int           trieMax;
+bool          trieOK;
 };
 #endif
@@ -63,9 +63,26 @@ inline int            Parse(XrdCms::CmsLoginData *Data,
                                               (char *)Data);
                            }
 
+// The high rate requests have a fixed layout parsed inline; the table driven
+// unpack is used for all others and to diagnose a malformed fixed layout.
+//
 inline int            Parse(int rnum, const char *Aps, const char *Apt, 
                             XrdCmsRRData *Data)
                            {Data->Opaque = Data->Opaque2 = Data->Path = 0;
+                            switch(rnum)
+                                  {case XrdCms::kYR_select:
+                                   case XrdCms::kYR_locate:
+                                        if (ParseLoc(Aps, Apt, Data)) return 1;
+                                        break;
+                                   case XrdCms::kYR_state:
+                                   case XrdCms::kYR_have:
+                                   case XrdCms::kYR_gone:
+                                   case XrdCms::kYR_try:
+                                   case XrdCms::kYR_statfs:
+                                        if (ParsePth(Aps, Apt, Data)) return 1;
+                                        break;
+                                   default: break;
+                                  }
                             return rnum < XrdCms::kYR_MaxReq 
                                    && vecArgs[rnum] != 0
                                    && Pup.Unpack(Aps, Apt,
@@ -82,6 +99,32 @@ static XrdOucPupArgs *PupArgs(int rnum)
 
 private:
 
+// These must accept exactly what Pup.Unpack() accepts for locArgs and pthArgs
+//
+static inline bool    ParseLoc(const char *bp, const char *bend,
+                               XrdCmsRRData *Data)
+                              {int dlen;
+                               if (!XrdOucPup::UnpackStr(bp, bend, Data->Ident,
+                                                         dlen)
+                               ||  !XrdOucPup::UnpackNum(bp, bend, Data->Opts)
+                               ||  !XrdOucPup::UnpackStr(bp, bend, Data->Path,
+                                                         Data->PathLen))
+                                  return false;
+                               if (bp == bend) return true;
+                               if (!XrdOucPup::UnpackStr(bp, bend, Data->Opaque,
+                                                         dlen, true))
+                                  return false;
+                               if (bp == bend) return true;
+                               return XrdOucPup::UnpackStr(bp, bend, Data->Avoid,
+                                                           dlen, true);
+                              }
+
+static inline bool    ParsePth(const char *bp, const char *bend,
+                               XrdCmsRRData *Data)
+                              {return XrdOucPup::UnpackStr(bp, bend, Data->Path,
+                                                           Data->PathLen);
+                              }
+
 static const char   **PupNVec;
 static XrdOucPupNames PupName;
 
@@ -28,16 +28,103 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
   
+#include <ctype.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <sys/types.h>
 
 #include "XrdCms/XrdCmsConfig.hh"
 #include "XrdCms/XrdCmsPrepare.hh"
 #include "XrdCms/XrdCmsPrepArgs.hh"
+#include "XrdSys/XrdSysTimer.hh"
 
 using namespace XrdCms;
 
+/******************************************************************************/
+/*                  L o c a l   C l a s s   P r e p V O                       */
+/******************************************************************************/
+
+// Prepare requests are queued by priority within the virtual organization
+// making them. As the cms protocol does not carry the requestor's identity,
+// the VO is taken to be the first component of the path (e.g. /atlas). Each
+// VO is given a token bucket so that a bulk request from one VO only delays
+// that VO's requests and not everyone else's.
+//
+class XrdCmsPrepVO
+{
+public:
+
+XrdCmsPrepVO   *Next;
+XrdCmsPrepArgs *First[XrdCmsPrepArgs::prtyNum];
+XrdCmsPrepArgs *Last [XrdCmsPrepArgs::prtyNum];
+long long       Credit;   // In thousandths of a request
+long long       tLast;    // Millisecond time of last refill
+char            Name[64];
+
+static int      Rate;     // Requests per second per VO, 0 -> unlimited
+
+static long long Now()
+                {struct timespec tNow;
+                 clock_gettime(CLOCK_MONOTONIC, &tNow);
+                 return (long long)tNow.tv_sec*1000 + tNow.tv_nsec/1000000;
+                }
+
+// Return true if a request may be handed out now and charge for it
+//
+bool            Admit(long long tNow)
+                {if (!Rate) return true;
+                 if (Credit < 1000)
+                    {Credit += (tNow - tLast) * Rate;
+                     if (Credit > (long long)Rate*1000) Credit = Rate*1000;
+                    }
+                 tLast = tNow;
+                 if (Credit < 1000) return false;
+                 Credit -= 1000;
+                 return true;
+                }
+
+void            Add(XrdCmsPrepArgs *aP)
+                {int p = aP->qPrty;
+                 aP->Next = 0;
+                 if (First[p]) Last[p]->Next = aP;
+                    else       First[p]      = aP;
+                 Last[p] = aP;
+                }
+
+XrdCmsPrepArgs *Take(int p)
+                {XrdCmsPrepArgs *aP = First[p];
+                 if (!(First[p] = aP->Next)) Last[p] = 0;
+                 return aP;
+                }
+
+                XrdCmsPrepVO(const char *path, XrdCmsPrepVO *np) : Next(np)
+                {const char *eP;
+                 int n;
+                 memset(First, 0, sizeof(First));
+                 memset(Last,  0, sizeof(Last));
+                 Credit = Rate*1000; tLast = Now();
+                 if (*path == '/') path++;
+                 if (!(eP = index(path, '/'))) n = 0;
+                    else if ((n = eP - path) >= (int)sizeof(Name))
+                            n = sizeof(Name)-1;
+                 strncpy(Name, path, n); Name[n] = 0;
+                }
+               ~XrdCmsPrepVO() {}
+
+// Return true if the path belongs to this VO
+//
+bool            isVO(const char *path)
+                {int n = strlen(Name);
+                 if (*path == '/') path++;
+                 if (!n) return index(path, '/') == 0;
+                 return !strncmp(Name, path, n) && path[n] == '/';
+                }
+};
+
+int XrdCmsPrepVO::Rate = 0;
+
 /******************************************************************************/
 /*                      S t a t i c   V a r i a b l e s                       */
 /******************************************************************************/
@@ -45,9 +132,11 @@ using namespace XrdCms;
 XrdSysMutex     XrdCmsPrepArgs::PAQueue;
 XrdSysSemaphore XrdCmsPrepArgs::PAReady(0);
 
-XrdCmsPrepArgs *XrdCmsPrepArgs::First = 0;
-XrdCmsPrepArgs *XrdCmsPrepArgs::Last  = 0;
-int             XrdCmsPrepArgs::isIdle= 1;
+XrdCmsPrepVO   *XrdCmsPrepArgs::voFirst   = 0;
+int             XrdCmsPrepArgs::isIdle    = 1;
+int             XrdCmsPrepArgs::numQueued = 0;
+long long       XrdCmsPrepArgs::numHeld   = 0;
+int             XrdCmsPrepArgs::batchSize = 64;
   
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
@@ -79,6 +168,11 @@ XrdCmsPrepArgs::XrdCmsPrepArgs(XrdCmsRRData &Arg) : XrdJob("prepare")
        if (*clPath != '/') clPath = 0;
       } else clPath = 0;
 
+// Compute the queue priority (higher numbers go first)
+//
+   if (!prty || !isdigit(*prty)) qPrty = 0;
+      else if ((qPrty = *prty - '0') >= prtyNum) qPrty = prtyNum-1;
+
 // Fill out the iovec
 //
    ioV[0].iov_base = (char *)&Request;
@@ -88,24 +182,44 @@ XrdCmsPrepArgs::XrdCmsPrepArgs(XrdCmsRRData &Arg) : XrdJob("prepare")
 }
 
 /******************************************************************************/
-/*                            g e t R e q u e s t                             */
+/*                              g e t B a t c h                               */
 /******************************************************************************/
   
-XrdCmsPrepArgs *XrdCmsPrepArgs::getRequest() // Static
+int XrdCmsPrepArgs::getBatch(XrdCmsPrepArgs **aVec, int aMax) // Static
 {
-   XrdCmsPrepArgs *parg;
+   XrdCmsPrepVO *vP;
+   long long tNow;
+   int p, n, took;
 
-// Wait for a request
+// Wait for at least one request. Requests are handed out highest priority
+// first and, within a priority, round-robin across VO's that are within their
+// rate. If everything queued is being held back, wait for the next token.
 //
    do {PAQueue.Lock();
-       if ((parg = First))
-          if (parg == Last) First = Last = 0;
-             else           First = parg->Next;
-          else {isIdle = 1; PAQueue.UnLock(); PAReady.Wait();}
-      } while(parg == 0);
+       n = 0;
+       if (numQueued)
+          {tNow = XrdCmsPrepVO::Now();
+           for (p = prtyNum-1; p >= 0 && n < aMax; p--)
+               do {took = 0;
+                   for (vP = voFirst; vP && n < aMax; vP = vP->Next)
+                       {if (!vP->First[p]) continue;
+                        if (vP->Admit(tNow))
+                           {aVec[n++] = vP->Take(p); took = 1;}
+                           else numHeld++;
+                       }
+                  } while(took && n < aMax);
+           numQueued -= n;
+          }
+       if (n) break;
+       if (numQueued)
+          {PAQueue.UnLock();
+           XrdSysTimer::Wait(XrdCmsPrepVO::Rate && XrdCmsPrepVO::Rate < 100
+                            ? 1000/XrdCmsPrepVO::Rate : 10);
+          } else {isIdle = 1; PAQueue.UnLock(); PAReady.Wait();}
+      } while(1);
    isIdle = 0;
    PAQueue.UnLock();
-   return parg;
+   return n;
 }
 
 /******************************************************************************/
@@ -116,19 +230,21 @@ XrdCmsPrepArgs *XrdCmsPrepArgs::getRequest() // Static
 //
 void XrdCmsPrepArgs::Process()
 {
-   XrdCmsPrepArgs *aP;
+   XrdCmsPrepArgs *aVec[maxBatch];
+   int i, n;
 
 // Process all queued prepare arguments. If we have data then we do this
-// for real. Otherwise, simply do a server selection and, if need be, tell 
-// the server to stage the file.
+// for real, a batch at a time. Otherwise, simply do a server selection and,
+// if need be, tell the server to stage the file.
 //
    if (Config.DiskOK)
-      do {aP = getRequest();
-          PrepQ.Prepare(aP);
-          delete aP;
+      do {n = getBatch(aVec, batchSize);
+          PrepQ.Prepare(aVec, n);
+          for (i = 0; i < n; i++) delete aVec[i];
          } while(1);
       else
-      do {getRequest()->DoIt();
+      do {n = getBatch(aVec, batchSize);
+          for (i = 0; i < n; i++) aVec[i]->DoIt();
          } while(1);
 }
   
@@ -138,13 +254,27 @@ void XrdCmsPrepArgs::Process()
   
 void XrdCmsPrepArgs::Queue()
 {
+   XrdCmsPrepVO *vP;
 
-// Lock the queue and add the element and post the waiter
+// Lock the queue, find the VO queue (adding one if need be), add the element
+// and post the waiter
 //
    PAQueue.Lock();
-   if (First) Last->Next = this;
-      else    First      = this;
-   Last = this;
+   vP = voFirst;
+   while(vP && !vP->isVO(path)) vP = vP->Next;
+   if (!vP) voFirst = vP = new XrdCmsPrepVO(path, voFirst);
+   vP->Add(this);
+   numQueued++;
    if (isIdle) PAReady.Post();
    PAQueue.UnLock();
 }
+
+/******************************************************************************/
+/*                              s e t P a r m s                               */
+/******************************************************************************/
+  
+void XrdCmsPrepArgs::setParms(int bsz, int rate) // Static
+{
+   if (bsz > 0) batchSize = (bsz > maxBatch ? maxBatch : bsz);
+   if (rate >= 0) XrdCmsPrepVO::Rate = rate;
+}
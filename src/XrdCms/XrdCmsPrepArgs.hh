@@ -37,10 +37,14 @@
 #include "XrdCms/XrdCmsRRData.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
+class XrdCmsPrepVO;
+
 class XrdCmsPrepArgs : public XrdJob
 {
 public:
-static const int       iovNum = 2;
+static const int       iovNum   = 2;
+static const int       maxBatch = 1024; // Most requests handled at once
+static const int       prtyNum  = 4;    // Priorities 0 (lowest) to 3
 
 XrdCms::CmsRRHdr        Request;
         char           *Ident;
@@ -53,6 +57,7 @@ XrdCms::CmsRRHdr        Request;
         char           *clPath;   // ->coloc path, if any
         int             options;
         int             pathlen;  // Includes null byte
+        int             qPrty;    // Queue priority
 
         struct iovec    ioV[iovNum];  // To forward the request
 
@@ -62,20 +67,29 @@ static  void            Process();
 
         void            Queue();
 
-static  XrdCmsPrepArgs *getRequest();
+static  int             getBatch(XrdCmsPrepArgs **aVec, int aMax);
+
+static  long long       Held()   {return numHeld;}
+
+static  int             Queued() {return numQueued;}
+
+static  void            setParms(int bsz, int rate);
 
                         XrdCmsPrepArgs(XrdCmsRRData &Arg);
 
                        ~XrdCmsPrepArgs() {if (Data) free(Data);}
 
 private:
+friend class XrdCmsPrepVO;
 
 static XrdSysMutex      PAQueue;
 static XrdSysSemaphore  PAReady;
        XrdCmsPrepArgs  *Next;
-static XrdCmsPrepArgs  *First;
-static XrdCmsPrepArgs  *Last;
+static XrdCmsPrepVO    *voFirst;
 static int              isIdle;
+static int              numQueued;
+static long long        numHeld;
+static int              batchSize;
        char            *Data;
 
 };
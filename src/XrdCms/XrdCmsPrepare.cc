@@ -28,8 +28,11 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
   
+#include <errno.h>
 #include <fcntl.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -86,74 +89,71 @@ XrdCmsPrepare::XrdCmsPrepare() : XrdJob("Prep cache scrubber"),
  PrepFrm  = 0;
  prepOK   = 0;
  N2N      = 0;
+ batchBuff= 0;
+ batchBsz = 0;
+ numBatch = numStaged = numOnline = 0;
 }
 
 /******************************************************************************/
 /*                                   A d d                                    */
 /******************************************************************************/
   
-int XrdCmsPrepare::Add(XrdCmsPrepArgs &pargs)
+int XrdCmsPrepare::Add(XrdCmsPrepArgs **pVec, int pNum)
 {
-   char *pdata[XrdOucMsubs::maxElem+2], prtybuff[8], *pP=prtybuff;
-   int rc, pdlen[XrdOucMsubs::maxElem + 2];
+   int i, rc, bLen, numAdded = 0;
 
-// Check if we are using the built-in mechanism
+// Check if we are using the built-in mechanism. It takes one entry at a time.
 //
    if (PrepFrm)
-      {rc = PrepFrm->Add('+',pargs.path,  pargs.opaque,pargs.Ident,pargs.reqid,
-                             pargs.notify,pargs.mode,atoi(pargs.prty));
-       if (rc) Say.Emsg("Add", rc, "prepare", pargs.path);
-          else {PTMutex.Lock();
-                if (!PTable.Add(pargs.path, 0, 0, Hash_data_is_key)) NumFiles++;
-                PTMutex.UnLock();
-               }
-       return rc == 0;
+      {for (i = 0; i < pNum; i++)
+           {XrdCmsPrepArgs &pargs = *pVec[i];
+            rc = PrepFrm->Add('+',pargs.path,  pargs.opaque,pargs.Ident,
+                              pargs.reqid,pargs.notify,pargs.mode,
+                              atoi(pargs.prty));
+            if (rc) Say.Emsg("Add", rc, "prepare", pargs.path);
+               else {PTMutex.Lock();
+                     if (!PTable.Add(pargs.path, 0, 0, Hash_data_is_key))
+                        NumFiles++;
+                     numStaged++; numAdded++;
+                     PTMutex.UnLock();
+                    }
+           }
+       PTMutex.Lock(); numBatch++; PTMutex.UnLock();
+       return numAdded;
       }
 
 // Restart the scheduler if need be
 //
    PTMutex.Lock();
    if (!prepif || !prepSched.isAlive())
-      {Say.Emsg("Add","No prepare manager; prepare",pargs.reqid,"ignored.");
+      {Say.Emsg("Add","No prepare manager; prepare",pVec[0]->reqid,"ignored.");
        PTMutex.UnLock();
        return 0;
       }
 
-// Write out the header line
+// Format all of the request lines into a single buffer so that the prepare
+// manager gets the whole batch with one write.
 //
-   if (!prepMsg)
-      {*pP++ = pargs.prty[0]; *pP = '\0';
-       pdata[0] = (char *)"+ ";               pdlen[0] = 2;
-       pdata[1] = pargs.reqid;                pdlen[1] = strlen(pargs.reqid);
-       pdata[2] = (char *)" ";                pdlen[2] = 1;
-       pdata[3] = pargs.notify;               pdlen[3] = strlen(pargs.notify);
-       pdata[4] = (char *)" ";                pdlen[4] = 1;
-       pdata[5] = prtybuff;                   pdlen[5] = strlen(prtybuff);
-       pdata[6] = (char *)" ";                pdlen[6] = 1;
-       pdata[7] = pargs.mode;                 pdlen[7] = strlen(pargs.mode);
-       pdata[8] = (char *)" ";                pdlen[8] = 1;
-       pdata[9] = pargs.path;                 pdlen[9] = strlen(pargs.path);
-       pdata[10] = (char *)"\n";              pdlen[10] = 1;
-       pdata[11]= 0;                          pdlen[11]= 0;
-      if (!(rc = prepSched.Put((const char **)pdata, (const int *)pdlen)))
-         if (!PTable.Add(pargs.path, 0, 0, Hash_data_is_key)) NumFiles++;
-      } else {
-       int Oflag = (index(pargs.mode, (int)'w') ? O_RDWR : 0);
-       mode_t Prty = atoi(pargs.prty);
-       XrdOucEnv Env(pargs.opaque);
-       XrdOucMsubsInfo Info(pargs.Ident, &Env,  N2N,   pargs.path,
-                            pargs.notify, Prty, Oflag, pargs.mode, pargs.reqid);
-       int k = prepMsg->Subs(Info, pdata, pdlen);
-       pdata[k]   = (char *)"\n"; pdlen[k++] = 1;
-       pdata[k]   = 0;            pdlen[k]   = 0;
-       if (!(rc = prepSched.Put((const char **)pdata, (const int *)pdlen)))
-          if (!PTable.Add(pargs.path, 0, 0, Hash_data_is_key)) NumFiles++;
+   bLen = 0;
+   for (i = 0; i < pNum; i++)
+       if (!Format(*pVec[i], bLen))
+          {Say.Emsg("Add", ENOMEM, "batch prepare requests");
+           PTMutex.UnLock();
+           return 0;
+          }
+
+// Write out the batch and record the pending files
+//
+   if (!(rc = prepSched.Put(batchBuff, bLen)))
+      {for (i = 0; i < pNum; i++)
+           if (!PTable.Add(pVec[i]->path, 0, 0, Hash_data_is_key)) NumFiles++;
+       numAdded = pNum; numStaged += pNum; numBatch++;
       }
 
 // All done
 //
    PTMutex.UnLock();
-   return rc == 0;
+   return numAdded;
 }
 
 /******************************************************************************/
@@ -310,25 +310,32 @@ void XrdCmsPrepare::Init()
 /*                               P r e p a r e                                */
 /******************************************************************************/
 
-void XrdCmsPrepare::Prepare(XrdCmsPrepArgs *pargs)
+void XrdCmsPrepare::Prepare(XrdCmsPrepArgs **pVec, int pNum)
 {
    EPNAME("Prepare");
-   int rc;
-
-// Check if this file is not online, prepare it
-//
-   if (!(rc = isOnline(pargs->path)))
-      {DEBUG("Preparing " <<pargs->reqid <<' ' <<pargs->notify <<' ' 
-                          <<pargs->prty <<' ' <<pargs->mode <<' ' <<pargs->path);
-       if (!Config.DiskSS) Say.Emsg("Prepare","staging disallowed; ignoring prep",
-                                    pargs->Ident, pargs->reqid);
-          else Add(*pargs);
-       return;
-      }
-
-// If the file is really online, inform the requestor
-//
-   if (rc > 0) Inform("avail", pargs);
+   XrdCmsPrepArgs *sVec[XrdCmsPrepArgs::maxBatch], *pargs;
+   int i, rc, sNum = 0;
+
+// Check which files are not online, those need to be prepared. Files that are
+// online get reported as available to whoever wants to know.
+//
+   for (i = 0; i < pNum; i++)
+       {pargs = pVec[i];
+        if (!(rc = isOnline(pargs->path)))
+           {DEBUG("Preparing " <<pargs->reqid <<' ' <<pargs->notify <<' '
+                    <<pargs->prty <<' ' <<pargs->mode <<' ' <<pargs->path);
+            if (!Config.DiskSS) Say.Emsg("Prepare","staging disallowed; "
+                                  "ignoring prep", pargs->Ident, pargs->reqid);
+               else if (sNum < XrdCmsPrepArgs::maxBatch) sVec[sNum++] = pargs;
+           } else if (rc > 0)
+                     {Inform("avail", pargs);
+                      PTMutex.Lock(); numOnline++; PTMutex.UnLock();
+                     }
+       }
+
+// Hand whatever needs to be staged to the prepare manager in one go
+//
+   if (sNum) Add(sVec, sNum);
 }
 
 /******************************************************************************/
@@ -394,9 +401,88 @@ int XrdCmsPrepare::setParms(const char *ifpgm, char *ifmsg)
  return 0;
 }
  
+/******************************************************************************/
+/*                                 S t a t s                                  */
+/******************************************************************************/
+  
+int XrdCmsPrepare::Stats(char *buff, int blen)
+{
+   static const char statfmt[] = "<prep><q>%d</q><h>%lld</h><b>%lld</b>"
+                     "<s>%lld</s><o>%lld</o><p>%d</p></prep>";
+   long long nBatch, nStaged, nOnline;
+   int nFiles, mlen;
+
+// Check if actual length wanted
+//
+   if (!buff) return sizeof(statfmt) + 3*8 + 4*16;
+
+// Get a consistent copy of the counters
+//
+   PTMutex.Lock();
+   nBatch = numBatch; nStaged = numStaged; nOnline = numOnline;
+   nFiles = NumFiles;
+   PTMutex.UnLock();
+
+// Format the statistics
+//
+   mlen = snprintf(buff, blen, statfmt, XrdCmsPrepArgs::Queued(),
+                   XrdCmsPrepArgs::Held(), nBatch, nStaged, nOnline, nFiles);
+   return (mlen < blen ? mlen : 0);
+}
+
 /******************************************************************************/
 /*                       P r i v a t e   M e t h o d s                        */
 /******************************************************************************/
+/******************************************************************************/
+/*                                F o r m a t                                 */
+/******************************************************************************/
+
+int XrdCmsPrepare::Format(XrdCmsPrepArgs &pargs, int &bLen)
+{                          // Must be called with PTMutex locked!
+   char *pdata[XrdOucMsubs::maxElem+2], prtybuff[8], *pP=prtybuff, *bP;
+   int i, k, n, pdlen[XrdOucMsubs::maxElem + 2];
+   int Oflag = (index(pargs.mode, (int)'w') ? O_RDWR : 0);
+   mode_t Prty = atoi(pargs.prty);
+   XrdOucEnv Env(pargs.opaque);
+   XrdOucMsubsInfo Info(pargs.Ident, &Env,  N2N,   pargs.path,
+                        pargs.notify, Prty, Oflag, pargs.mode, pargs.reqid);
+
+// Construct the request line, either the standard one or the one specified
+// by the prepmsg directive.
+//
+   if (!prepMsg)
+      {*pP++ = pargs.prty[0]; *pP = '\0';
+       pdata[0] = (char *)"+ ";               pdlen[0] = 2;
+       pdata[1] = pargs.reqid;                pdlen[1] = strlen(pargs.reqid);
+       pdata[2] = (char *)" ";                pdlen[2] = 1;
+       pdata[3] = pargs.notify;               pdlen[3] = strlen(pargs.notify);
+       pdata[4] = (char *)" ";                pdlen[4] = 1;
+       pdata[5] = prtybuff;                   pdlen[5] = strlen(prtybuff);
+       pdata[6] = (char *)" ";                pdlen[6] = 1;
+       pdata[7] = pargs.mode;                 pdlen[7] = strlen(pargs.mode);
+       pdata[8] = (char *)" ";                pdlen[8] = 1;
+       pdata[9] = pargs.path;                 pdlen[9] = strlen(pargs.path);
+       k = 10;
+      } else k = prepMsg->Subs(Info, pdata, pdlen);
+   pdata[k]   = (char *)"\n"; pdlen[k++] = 1;
+
+// Make sure the line fits in the batch buffer
+//
+   for (n = 0, i = 0; i < k; i++) n += pdlen[i];
+   if (bLen + n > batchBsz)
+      {int nsz = (batchBsz ? batchBsz*2 : 65536);
+       while(nsz < bLen + n) nsz *= 2;
+       if (!(bP = (char *)realloc(batchBuff, nsz))) return 0;
+       batchBuff = bP; batchBsz = nsz;
+      }
+
+// Append the line
+//
+   for (i = 0; i < k; i++)
+       {memcpy(batchBuff+bLen, pdata[i], pdlen[i]); bLen += pdlen[i];}
+   return 1;
+}
+
 /******************************************************************************/
 /*                              i s O n l i n e                               */
 /******************************************************************************/
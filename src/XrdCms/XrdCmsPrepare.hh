@@ -47,7 +47,10 @@ class XrdCmsPrepare : public XrdJob
 {
 public:
 
-int        Add(XrdCmsPrepArgs &pargs);
+int        Add(XrdCmsPrepArgs &pargs)
+              {XrdCmsPrepArgs *pP = &pargs; return Add(&pP, 1) == 1;}
+
+int        Add(XrdCmsPrepArgs **pVec, int pNum);
 
 int        Del(char *reqid);
 
@@ -65,7 +68,9 @@ int        isOK() {return prepOK;}
 
 int        Pending() {return NumFiles;}
 
-void       Prepare(XrdCmsPrepArgs *pargs);
+void       Prepare(XrdCmsPrepArgs *pargs) {Prepare(&pargs, 1);}
+
+void       Prepare(XrdCmsPrepArgs **pVec, int pNum);
 
 void       Reset(const char *iName, const char *aPath, int aMode);
 
@@ -75,11 +80,14 @@ int        setParms(const char *ifpgm, char *ifmsg=0);
 
 int        setParms(XrdOucName2Name *n2n) {N2N = n2n; return 0;}
 
+int        Stats(char *buff, int blen);
+
            XrdCmsPrepare();
           ~XrdCmsPrepare() {}   // Never gets deleted
 
 private:
 
+int        Format(XrdCmsPrepArgs &pargs, int &bLen);
 int        isOnline(char *path);
 void       Reset();
 void       Scrub();
@@ -93,6 +101,8 @@ XrdOucMsubs          *prepMsg;
 XrdNetMsg            *Relay;
 XrdFrcProxy          *PrepFrm;
 char                 *prepif;
+char                 *batchBuff;
+int                   batchBsz;
 time_t                lastemsg;
 pid_t                 preppid;
 int                   prepOK;
@@ -101,6 +111,9 @@ int                   doEcho;
 int                   resetcnt;
 int                   scrub2rst;
 int                   scrubtime;
+long long             numBatch;    // Batches handed to the prepare manager
+long long             numStaged;   // Files handed to the prepare manager
+long long             numOnline;   // Files found to already be online
 };
 
 namespace XrdCms
@@ -48,6 +48,7 @@
 
 #include "XrdCms/XrdCmsBaseFS.hh"
 #include "XrdCms/XrdCmsCache.hh"
+#include "XrdCms/XrdCmsCacheSnap.hh"
 #include "XrdCms/XrdCmsCluster.hh"
 #include "XrdCms/XrdCmsConfig.hh"
 #include "XrdCms/XrdCmsJob.hh"
@@ -55,6 +56,7 @@
 #include "XrdCms/XrdCmsManager.hh"
 #include "XrdCms/XrdCmsManTree.hh"
 #include "XrdCms/XrdCmsMeter.hh"
+#include "XrdCms/XrdCmsNSMap.hh"
 #include "XrdCms/XrdCmsProtocol.hh"
 #include "XrdCms/XrdCmsRole.hh"
 #include "XrdCms/XrdCmsRouting.hh"
@@ -331,6 +333,10 @@ void XrdCmsProtocol::Pander(const char *manager, int mport)
       {if (!Config.DiskSS) Role |=  CmsLoginData::kYR_nostage;}
       else chk4Suspend = XrdCmsState::FES_Suspend;
 
+// Indicate that we can handle batched state requests
+//
+   Role |= CmsLoginData::kYR_batchq;
+
 // Keep connecting to our manager. If suspended, wait for a resumption first
 //
    do {if (Config.doWait && chk4Suspend)
@@ -388,6 +394,8 @@ void XrdCmsProtocol::Pander(const char *manager, int mport)
              else {XrdOucEnv cgiEnv((const char *)Data.envCGI);
                    const char *sname = cgiEnv.Get("site");
                    Say.Emsg("Protocol", "Logged into", sname, Link->Name());
+                   myNode->setNSMap((Data.Mode & CmsLoginData::kYR_nsmapok)!=0);
+                   if (myNode->okNSMap()) NSPub.Resend();
                    if (Data.SID)
                       Manager->Verify(Link, (const char *)Data.SID, sname);
                    Reason = Dispatch(isUp, TimeOut, 2);
@@ -573,7 +581,7 @@ XrdCmsRouting *XrdCmsProtocol::Admit()
 
 // Establish outgoing mode
 //
-   Data.Mode = 0;
+   Data.Mode = CmsLoginData::kYR_nsmapok;
    if (Trace.What & TRACE_Debug) Data.Mode |= CmsLoginData::kYR_debug;
    if (CmsState.Suspended)      {Data.Mode |= CmsLoginData::kYR_suspend;
                                  wasSuspended = 1;
@@ -659,6 +667,7 @@ XrdCmsRouting *XrdCmsProtocol::Admit()
       return (XrdCmsRouting *)0;
    myNode->RoleID = static_cast<char>(roleID);
    myNode->setVersion(Data.Version);
+   myNode->setStateV((Data.Mode & CmsLoginData::kYR_batchq) != 0);
 
 // Calculate the share as the reference mininum if we are a meta-manager
 //
@@ -723,6 +732,11 @@ XrdCmsRouting *XrdCmsProtocol::Admit()
    if (Config.asManager()) {Manager->Reset(); myNode->SyncSpace();}
    myNode->isBad &= ~XrdCmsNode::isDisabled;
 
+// Record the node for the cache snapshot. If the node was known before a
+// restart, the locations it had will be put back in the cache.
+//
+   if (Config.asManager() && myNode->isMan <= 1) CacheSnap.Attach(myNode);
+
 // At this point we can switch to nonblocking sendq for this node
 //
    if (Config.nbSQ && (Config.nbSQ > 1 || !myNode->inDomain()))
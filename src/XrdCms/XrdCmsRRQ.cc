@@ -35,6 +35,7 @@
 
 #include "XrdCms/XrdCmsCluster.hh"
 #include "XrdCms/XrdCmsNode.hh"
+#include "XrdCms/XrdCmsReq.hh"
 #include "XrdCms/XrdCmsRRQ.hh"
 #include "XrdCms/XrdCmsRTable.hh"
 #include "XrdCms/XrdCmsTrace.hh"
@@ -88,7 +89,21 @@ short XrdCmsRRQ::Add(short Snum, XrdCmsRRQInfo *Info)
 //
    myMutex.Lock(); Stats.Add2Q++;
    if (Snum && Slot[Snum].Info.Key == Info->Key && Slot[Snum].Expire)
-      {if (Info->isLU)
+      {
+
+    // If the slot is parked, the requestors were told to wait for a pushed
+    // response. So, do the same here or, if we can't, tell it to wait.
+    //
+       if (Slot[Snum].Parked)
+          {bool isAsync;
+           RTable.Lock(); isAsync = sendPush(sp); RTable.UnLock();
+           if (!isAsync)
+              {myMutex.UnLock();
+               sp->Recycle();
+               return Snum;
+              }
+          }
+       if (Info->isLU)
           {sp->LkUp = Slot[Snum].LkUp;
            Slot[Snum].LkUp = sp;
           } else {
@@ -103,7 +118,7 @@ short XrdCmsRRQ::Add(short Snum, XrdCmsRRQInfo *Info)
 // Queue this slot to the pending response queue and tell the timeout scheduler
 //
    sp->Expire = myClock+1;
-   if (waitQ.Singleton()) isWaiting.Post();
+   if (waitQ.Singleton() && pushQ.Singleton()) isWaiting.Post();
    waitQ.Prev()->Insert(&sp->Link);
    myMutex.UnLock();
    return sp->slotNum;
@@ -122,15 +137,16 @@ void XrdCmsRRQ::Del(short Snum, const void *Key)
 /*                                  I n i t                                   */
 /******************************************************************************/
   
-int XrdCmsRRQ::Init(int Tint, int Tdly)
+int XrdCmsRRQ::Init(int Tint, int Tdly, int Tpsh)
 {
    int rc;
    pthread_t tid;
 
-// Set values
+// Set values (the push time is in seconds but we count it in time slices)
 //
    if (Tint) Tslice = Tint;
    if (Tdly) Tdelay = Tdly;
+   if (Tpsh > 0) Tpush = (Tpsh*1000 + Tslice - 1) / Tslice;
    Stats.Reset();
 
 // Fill out the response structure
@@ -190,6 +206,24 @@ int XrdCmsRRQ::Init(int Tint, int Tdly)
    return 0;
 }
 
+/******************************************************************************/
+/*                              p u s h W a i t                               */
+/******************************************************************************/
+
+// The caller must hold myMutex.
+
+void XrdCmsRRQ::pushWait(XrdCmsRRQSlot *sP)
+{
+   XrdCmsRRQSlot *rP;
+
+// Tell each requestor in either chain to wait for the pushed response
+//
+   RTable.Lock();
+   for (rP = sP;       rP; rP = rP->Cont) sendPush(rP);
+   for (rP = sP->LkUp; rP; rP = rP->LkUp) sendPush(rP);
+   RTable.UnLock();
+}
+
 /******************************************************************************/
 /*                                 R e a d y                                  */
 /******************************************************************************/
@@ -250,7 +284,22 @@ void *XrdCmsRRQ::Respond()
        Stats.rdFast += rdFast; Stats.rdSlow += rdSlow;
        Stats.luFast += luFast; Stats.luSlow += luSlow;
        if (readyQ.Singleton()) {myMutex.UnLock(); break;}
-       sp = readyQ.Next()->Item(); sp->Link.Remove(); sp->Expire = 0;
+       sp = readyQ.Next()->Item(); sp->Link.Remove();
+
+    // If nobody responded within the hold time we can park the request and
+    // push the response when it arrives, provided the requestors accept it.
+    // The slot stays valid so that a late response can still ready it. The
+    // waitresp replies are sent under the lock as Add() may join the slot.
+    //
+       if (!sp->Arg1 && Tpush && !sp->Parked)
+          {sp->Parked = 1; sp->Expire = myClock + Tpush;
+           if (waitQ.Singleton() && pushQ.Singleton()) isWaiting.Post();
+           pushQ.Prev()->Insert(&sp->Link);
+           pushWait(sp);
+           myMutex.UnLock();
+           continue;
+          }
+       sp->Expire = 0;
        myMutex.UnLock();
 
     // A locate request can be pggy-backed on a select request and vice-versa
@@ -320,8 +369,9 @@ void XrdCmsRRQ::sendLocResp(XrdCmsRRQSlot *lP)
 // Send the reply to each waiting redirector
 //
    RTable.Lock();
-   do {if ((nP = RTable.Find(lP->Info.Rnum, lP->Info.Rinst)))
+   do {if (!lP->Done && (nP = RTable.Find(lP->Info.Rnum, lP->Info.Rinst)))
           {dataResp.Hdr.streamid = lP->Info.ID;
+           dataResp.Hdr.modifier = (lP->Async ? CmsResponse::kYR_async : 0);
            nP->Send(data_iov, iov_cnt, bytes);
           }
        luFast++;
@@ -341,8 +391,9 @@ void XrdCmsRRQ::sendLwtResp(XrdCmsRRQSlot *rP)
 // For each request, find the redirector and ask it to send a wait
 //
    RTable.Lock();
-do{if ((nP = RTable.Find(rP->Info.Rnum, rP->Info.Rinst)))
+do{if (!rP->Done && (nP = RTable.Find(rP->Info.Rnum, rP->Info.Rinst)))
       {waitResp.Hdr.streamid = rP->Info.ID; luSlow++;
+       waitResp.Hdr.modifier = (rP->Async ? CmsResponse::kYR_async : 0);
        nP->Send((char *)&waitResp, sizeof(waitResp));
 //     DEBUG("Redirect delay " <<nP->Name() <<' ' <<Tdelay);
       }
@@ -351,6 +402,47 @@ do{if ((nP = RTable.Find(rP->Info.Rnum, rP->Info.Rinst)))
    RTable.UnLock();
 }
   
+/******************************************************************************/
+/*                              s e n d P u s h                               */
+/******************************************************************************/
+
+// The caller must hold the RTable lock. Returns true if the requestor will
+// receive an async response and false if it was told to wait and retry.
+
+bool XrdCmsRRQ::sendPush(XrdCmsRRQSlot *rP)
+{
+   CmsResponse pushResp;
+   XrdCmsNode *nP;
+
+// Skip requestors that have already been handled
+//
+   if (rP->Async || rP->Done) return rP->Async != 0;
+
+// Requestors that cannot accept an async response must retry after a delay.
+// Otherwise, send a waitresp with the message number the response will use.
+//
+   pushResp.Hdr.streamid = rP->Info.ID;
+   pushResp.Hdr.modifier = 0;
+   pushResp.Hdr.datalen  = htons(static_cast<unsigned short>(sizeof(pushResp.Val)));
+   if (!rP->Info.canPush)
+      {pushResp.Hdr.rrCode = kYR_wait;
+       pushResp.Val        = htonl(Tdelay);
+       rP->Done = 1;
+      } else {
+       rP->Info.ID         = XrdCmsReq::AsyncID();
+       pushResp.Hdr.rrCode = kYR_waitresp;
+       pushResp.Val        = htonl(rP->Info.ID);
+       rP->Async = 1;
+      }
+
+// Send off the response (async message numbers must go out in order)
+//
+   if ((nP = RTable.Find(rP->Info.Rnum, rP->Info.Rinst)))
+      nP->Send((char *)&pushResp, sizeof(pushResp));
+   if (rP->Async) XrdCmsReq::AsyncDone();
+   return rP->Async != 0;
+}
+
 /******************************************************************************/
 /*                           s e n d R e d R e s p                            */
 /******************************************************************************/
@@ -376,12 +468,15 @@ void XrdCmsRRQ::sendRedResp(XrdCmsRRQSlot *rP)
 // For each request, find the redirector and ask it to send the message
 //
    RTable.Lock();
-do{if ((nP = RTable.Find(rP->Info.Rnum, rP->Info.Rinst)))
-      {if (doredir){redrResp.Hdr.streamid = rP->Info.ID; rdFast++;
+do{if (!rP->Done && (nP = RTable.Find(rP->Info.Rnum, rP->Info.Rinst)))
+      {kXR_char rMod = (rP->Async ? CmsResponse::kYR_async : 0);
+       if (doredir){redrResp.Hdr.streamid = rP->Info.ID; rdFast++;
+                    redrResp.Hdr.modifier = rMod;
                     nP->Send(redr_iov, iov_cnt, hlen);
 //                  DEBUG("Fast redirect " <<nP->Name() <<" -> " <<hostbuff);
                    }
               else {waitResp.Hdr.streamid = rP->Info.ID; rdSlow++;
+                    waitResp.Hdr.modifier = rMod;
                     nP->Send((char *)&waitResp, sizeof(waitResp));
 //                  DEBUG("Redirect delay " <<nP->Name() <<' ' <<Tdelay);
                    }
@@ -420,7 +515,12 @@ void *XrdCmsRRQ::TimeOut()
 //                   DEBUG("expired slot " <<sp->slotNum);
                      readyQ.Prev()->Insert(&sp->Link);
                     }
-               if (waitQ.Singleton()) break;
+               while((sp=pushQ.Next()->Item()) && sp->Expire < myClock)
+                    {sp->Link.Remove();
+                     if (readyQ.Singleton()) isReady.Post();
+                     readyQ.Prev()->Insert(&sp->Link);
+                    }
+               if (waitQ.Singleton() && pushQ.Singleton()) break;
               }
          myMutex.UnLock();
         }
@@ -447,6 +547,7 @@ XrdCmsRRQSlot::XrdCmsRRQSlot() : Link(this)
       } else Cont = 0;
    Arg1 = Arg2 = 0;
    Info.Key = 0;
+   Parked = Async = Done = 0;
 }
 
 /******************************************************************************/
@@ -465,6 +566,7 @@ XrdCmsRRQSlot *XrdCmsRRQSlot::Alloc(XrdCmsRRQInfo *theInfo)
        sp->LkUp = 0;
        sp->Arg1 = 0;
        sp->Arg2 = 0;
+       sp->Parked = sp->Async = sp->Done = 0;
       }
    myMutex.UnLock();
    return sp;
@@ -56,13 +56,14 @@ char      minR;    // Minimum number of responses for fast redispatch
 char      actR;    // Actual  number of responses
 char      lsLU;    // Lookup options
 char      ifOP;    // XrdNetIF::ifType to return (cast as char)
+char      canPush; // True if requestor accepts a waitresp + async response
 SMask_t   rwVec;   // R/W servers for corresponding path (if isLU is true)
 
-        XrdCmsRRQInfo() : isLU(0), ifOP(0) {}
+        XrdCmsRRQInfo() : isLU(0), ifOP(0), canPush(0) {}
         XrdCmsRRQInfo(int rinst, short rnum, kXR_unt32 id, int minQ=0)
                         : Key(0), ID(id), Rinst(rinst), Rnum(rnum),
                           isRW(0), isLU(0), minR(minQ), actR(0), lsLU(0), ifOP(0),
-                          rwVec(0) {}
+                          canPush(0), rwVec(0) {}
        ~XrdCmsRRQInfo() {}
 };
 
@@ -95,6 +96,9 @@ static   short                       initSlot;
          SMask_t                     Arg2;
 unsigned int                         Expire;
          int                         slotNum;
+         char                        Parked;   // Slot held past the hold time
+         char                        Async;    // Requestor was sent a waitresp
+         char                        Done;     // Requestor was already answered
 };
 
 /******************************************************************************/
@@ -109,7 +113,7 @@ short Add(short Snum, XrdCmsRRQInfo *ip);
 
 void  Del(short Snum, const void *Key);
 
-int   Init(int Tint=0, int Tdly=0);
+int   Init(int Tint=0, int Tdly=0, int Tpsh=0);
 
 int   Ready(int Snum, const void *Key, SMask_t mask1, SMask_t mask2);
 
@@ -147,11 +151,13 @@ void *TimeOut();
 
       XrdCmsRRQ() : isWaiting(0), isReady(0),
                     luFast(0),    luSlow(0),  rdFast(0), rdSlow(0),
-                    Tslice(178),  Tdelay(5),  myClock(0) {}
+                    Tslice(178),  Tdelay(5),  Tpush(0), myClock(0) {}
      ~XrdCmsRRQ() {}
 
 private:
 
+void pushWait(XrdCmsRRQSlot *sP);
+bool sendPush(XrdCmsRRQSlot *rP);
 void sendLocResp(XrdCmsRRQSlot *lP);
 void sendLwtResp(XrdCmsRRQSlot *rP);
 void sendRedResp(XrdCmsRRQSlot *rP);
@@ -162,6 +168,7 @@ static const int numSlots = 1024;
          XrdSysSemaphore               isReady;
          XrdCmsRRQSlot                 Slot[numSlots];
          XrdOucDLlist<XrdCmsRRQSlot>   waitQ;
+         XrdOucDLlist<XrdCmsRRQSlot>   pushQ;   // Parked for a pushed reply
          XrdOucDLlist<XrdCmsRRQSlot>   readyQ;  // Redirect/Locate ready queue
 static   const int                     iov_cnt = 2;
          struct iovec                  data_iov[iov_cnt];
@@ -180,6 +187,7 @@ union   {char                          hostbuff[288];
          int                           rdSlow;
          int                           Tslice;
          int                           Tdelay;
+         int                           Tpush;   // In Tslice units
 unsigned int                           myClock;
 };
 
@@ -50,6 +50,16 @@
 
 using namespace XrdCms;
 
+/******************************************************************************/
+/*                        L o c a l   S t a t i c s                           */
+/******************************************************************************/
+
+namespace
+{
+XrdSysMutex  rnMutex;
+unsigned int RequestNum = 0;
+}
+
 /******************************************************************************/
 /*                        C o n s t r u c t o r   # 1                         */
 /******************************************************************************/
@@ -76,6 +86,22 @@ XrdCmsReq::XrdCmsReq(XrdCmsReq *Req, unsigned int rn)
    ReqAdv  = 0;
 }
 
+/******************************************************************************/
+/*                               A s y n c I D                                */
+/******************************************************************************/
+  
+unsigned int XrdCmsReq::AsyncID()
+{
+   rnMutex.Lock();
+   return ++RequestNum;
+}
+
+/******************************************************************************/
+/*                             A s y n c D o n e                              */
+/******************************************************************************/
+  
+void XrdCmsReq::AsyncDone() {rnMutex.UnLock();}
+
 /******************************************************************************/
 /*                           R e p l y _ E r r o r                            */
 /******************************************************************************/
@@ -300,10 +326,8 @@ void XrdCmsReq::Reply_Wait(int sec)
   
 XrdCmsReq *XrdCmsReq::Reply_WaitResp(int sec)
 {
-   static XrdSysMutex rnMutex;
-   static unsigned int RequestNum = 0;
-          unsigned int rnum;
-          XrdCmsReq *newReq;
+   unsigned int rnum;
+   XrdCmsReq *newReq;
 
 // If this is already a waitresp object then we cannot do this again. So,
 // just return a null pointer indicating an invalid call.
@@ -312,12 +336,7 @@ XrdCmsReq *XrdCmsReq::Reply_WaitResp(int sec)
 
 // Generate a request number unless no reply is needed
 //
-   if (ReqID)
-      {rnMutex.Lock();
-       RequestNum++;
-       rnum = RequestNum;
-       rnMutex.UnLock();
-     } else rnum = 0;
+   rnum = (ReqID ? AsyncID() : 0);
 
 // Construct a new request object. This object will be used to actually effect
 // the reply. We need to do this because the server may disappear before we
@@ -328,8 +347,8 @@ XrdCmsReq *XrdCmsReq::Reply_WaitResp(int sec)
 // Reply to the requestor mapping our ID to their ID
 //
    if (rnum)
-      {
-       Reply(kYR_waitresp, rnum);
+      {Reply(kYR_waitresp, rnum);
+       AsyncDone();
       }
 
 // Return an object to affect an asynchronous reply
@@ -93,6 +93,13 @@ void       Reply_Wait(int sec);
 //
 XrdCmsReq *Reply_WaitResp(int sec=0);
 
+// Obtain the next waitresp message number. Numbers must reach the redirector
+// in ascending order, so the number lock is held upon return and AsyncDone()
+// must be called once the waitresp carrying the number has been sent.
+//
+static unsigned int AsyncID();
+static void         AsyncDone();
+
            XrdCmsReq(XrdCmsNode *nP, unsigned int id, char adv=0);
            XrdCmsReq(XrdCmsReq  *rP, unsigned int rn);
           ~XrdCmsReq() {}
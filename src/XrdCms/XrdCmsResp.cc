@@ -214,6 +214,11 @@ void XrdCmsResp::ReplyXeq()
       Result = SFS_ERROR;
      }
 
+// A stall is returned as the number of seconds to wait, as in the sync case.
+//
+  if (Result == SFS_STALL && (Result = getErrInfo()) < SFS_STALL)
+     Result = SFS_STALL;
+
 // Before invoking the callback we must be assured that the waitresp response
 // has been sent to the client. We do this by waiting on a semaphore which is
 // posted *after* the waitresp response is sent.
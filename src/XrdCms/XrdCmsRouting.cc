@@ -62,11 +62,14 @@ XrdCmsRouter::theRoute initRouter[] =
        {kYR_disc,    "disc",   &XrdCmsNode::do_Disc},
        {kYR_gone,    "gone",   &XrdCmsNode::do_Gone},
        {kYR_have,    "have",   &XrdCmsNode::do_Have},
+       {kYR_havev,   "havev",  &XrdCmsNode::do_HaveV},
        {kYR_load,    "load",   &XrdCmsNode::do_Load},
+       {kYR_nsmap,   "nsmap",  &XrdCmsNode::do_NSMap},
        {kYR_ping,    "ping",   &XrdCmsNode::do_Ping},
        {kYR_pong,    "pong",   &XrdCmsNode::do_Pong},
        {kYR_space,   "space",  &XrdCmsNode::do_Space},
        {kYR_state,   "state",  &XrdCmsNode::do_State},
+       {kYR_statev,  "statev", &XrdCmsNode::do_StateV},
        {kYR_status,  "status", &XrdCmsNode::do_Status},
        {kYR_try,     "try",    &XrdCmsNode::do_Try},
        {kYR_update,  "update", &XrdCmsNode::do_Update},
@@ -91,6 +94,7 @@ XrdCmsRouting::theRouting initMANrouting[] =
       {kYR_prepdel, XrdCmsRouting::isSync  | XrdCmsRouting::Forward},
       {kYR_space,   XrdCmsRouting::isSync  | XrdCmsRouting::noArgs},
       {kYR_state,   XrdCmsRouting::isSync},
+      {kYR_statev,  XrdCmsRouting::isSync},
       {kYR_stats,   XrdCmsRouting::AsyncQ0 | XrdCmsRouting::noArgs},
       {kYR_try,     XrdCmsRouting::isSync},
       {kYR_usage,   XrdCmsRouting::isSync  | XrdCmsRouting::noArgs},
@@ -156,7 +160,9 @@ XrdCmsRouting::theRouting initRSProuting[] =
       {kYR_disc,    XrdCmsRouting::isSync | XrdCmsRouting::noArgs},
       {kYR_gone,    XrdCmsRouting::isSync},
       {kYR_have,    XrdCmsRouting::AsyncQ0},
+      {kYR_havev,   XrdCmsRouting::AsyncQ0},
       {kYR_load,    XrdCmsRouting::isSync},
+      {kYR_nsmap,   XrdCmsRouting::isSync},
       {kYR_pong,    XrdCmsRouting::isSync | XrdCmsRouting::noArgs},
       {kYR_status,  XrdCmsRouting::isSync | XrdCmsRouting::noArgs},
       {0,           0}};
@@ -185,6 +191,7 @@ XrdCmsRouting::theRouting initSRVrouting[] =
       {kYR_rmdir,   XrdCmsRouting::AsyncQ1},
       {kYR_space,   XrdCmsRouting::isSync  | XrdCmsRouting::noArgs},
       {kYR_state,   XrdCmsRouting::AsyncQ0},
+      {kYR_statev,  XrdCmsRouting::AsyncQ0},
       {kYR_stats,   XrdCmsRouting::AsyncQ0 | XrdCmsRouting::noArgs},
       {kYR_trunc,   XrdCmsRouting::AsyncQ1},
       {kYR_try,     XrdCmsRouting::isSync},
@@ -215,6 +222,7 @@ XrdCmsRouting::theRouting initSUProuting[] =
       {kYR_rmdir,   XrdCmsRouting::AsyncQ1 | XrdCmsRouting::Forward},
       {kYR_space,   XrdCmsRouting::isSync  | XrdCmsRouting::noArgs},
       {kYR_state,   XrdCmsRouting::isSync},
+      {kYR_statev,  XrdCmsRouting::isSync},
       {kYR_stats,   XrdCmsRouting::AsyncQ0 | XrdCmsRouting::noArgs},
       {kYR_trunc,   XrdCmsRouting::AsyncQ1 | XrdCmsRouting::Forward},
       {kYR_try,     XrdCmsRouting::isSync},
@@ -0,0 +1,311 @@
+/******************************************************************************/
+/*                                                                            */
+/*                       X r d C m s S t a t e Q . c c                        */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <string.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+#include "XProtocol/YProtocol.hh"
+
+#include "XrdCms/XrdCmsBaseFS.hh"
+#include "XrdCms/XrdCmsCache.hh"
+#include "XrdCms/XrdCmsCluster.hh"
+#include "XrdCms/XrdCmsManager.hh"
+#include "XrdCms/XrdCmsNode.hh"
+#include "XrdCms/XrdCmsRRData.hh"
+#include "XrdCms/XrdCmsSelect.hh"
+#include "XrdCms/XrdCmsStateQ.hh"
+#include "XrdCms/XrdCmsTrace.hh"
+
+#include "XrdSys/XrdSysError.hh"
+
+using namespace XrdCms;
+
+/******************************************************************************/
+/*                        G l o b a l   O b j e c t s                         */
+/******************************************************************************/
+
+XrdCmsStateQ XrdCms::StateQ;
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+long long Clock()
+{
+   struct timespec tNow;
+
+   clock_gettime(CLOCK_MONOTONIC, &tNow);
+   return static_cast<long long>(tNow.tv_sec)*1000 + tNow.tv_nsec/1000000;
+}
+}
+  
+/******************************************************************************/
+/*                     T h r e a d   I n t e r f a c e s                      */
+/******************************************************************************/
+
+void *XrdCmsStartStateQ(void *carg)
+      {XrdCmsStateQ *sqP = (XrdCmsStateQ *)carg;
+       return sqP->Start();
+      }
+  
+/******************************************************************************/
+/* Public                         A n s w e r                                 */
+/******************************************************************************/
+  
+void XrdCmsStateQ::Answer(XrdCmsNode *nP, XrdCmsRRData &Arg)
+{
+   EPNAME("Answer")
+   static const SMask_t allNodes(FULLMASK);
+   const unsigned char *bMap = (const unsigned char *)Arg.Buff;
+   unsigned int bID = Arg.Request.streamid;
+   Batch *bP = &bTab[bID % maxSent];
+   XrdCmsPInfo pinfo;
+   XrdCms::CmsRRHdr Hdr = {0, kYR_have, 0, 0};
+   char pBuff[maxBytes], Code[maxPaths], *pP;
+   int i, n, pLen, Opts, isnew, pNum = 0, bLen = 0;
+
+// Copy out the paths the node has as the batch may be reused while we update
+// the cache. Responses to batches we no longer have are simply ignored and
+// the client will be asked to retry later on as with any missing response.
+//
+   qCond.Lock();
+   if (bP->ID != bID || !bID)
+      {qCond.UnLock();
+       DEBUG(nP->Ident <<" answered expired batch " <<bID);
+       return;
+      }
+   n = (bP->Num < Arg.Dlen*4 ? bP->Num : Arg.Dlen*4);
+   for (i = 0; i < n; i++)
+       {if (!(Code[pNum] = (bMap[i>>2] >> ((i&3)<<1)) & 0x03)) continue;
+        pLen = bP->Offs[i+1] - bP->Offs[i];
+        memcpy(pBuff+bLen, bP->Buff+bP->Offs[i], pLen);
+        bLen += pLen; pNum++;
+       }
+   qCond.UnLock();
+   TRACE(Files, nP->Ident <<" answered " <<pNum <<" of " <<n <<" in batch " <<bID);
+
+// Now process each path just as if it were a have response
+//
+   for (i = 0, pP = pBuff; i < pNum; i++, pP += pLen)
+       {pLen = strlen(pP)+1;
+        Opts = (Cache.Paths.Find(pP, pinfo) && (pinfo.rwvec & nP->Mask())
+             ? XrdCmsSelect::Write : 0);
+        if (Code[i] == CmsHaveRequest::Missing)
+           {XrdCmsSelect Sel(XrdCmsSelect::Advisory, pP, pLen-1);
+            if (baseFS.isDFS()) Cache.MissFile(Sel, allNodes, nP->Mask());
+               else Cache.MissFile(Sel, nP->Mask(), pinfo.rovec);
+            continue;
+           }
+        if (Code[i] == CmsHaveRequest::Pending) Opts |= XrdCmsSelect::Pending;
+        XrdCmsSelect Sel(XrdCmsSelect::Advisory|Opts, pP, pLen-1);
+        if (baseFS.isDFS())
+           {Sel.Vec.hf = pinfo.rovec; Sel.Vec.wf = pinfo.rwvec;
+            isnew       = Cache.AddFile(Sel, allNodes);
+           } else isnew = Cache.AddFile(Sel, nP->Mask());
+        if (isnew && XrdCmsManager::Present())
+           {Hdr.streamid = Sel.Path.Hash;
+            Hdr.modifier = static_cast<kXR_char>(Code[i] | kYR_raw);
+            XrdCmsManager::Inform(Hdr, pP, pLen);
+           }
+       }
+}
+
+/******************************************************************************/
+/* Private                          C o p y                                   */
+/******************************************************************************/
+  
+void XrdCmsStateQ::Copy(Batch &To, Batch &From)
+{
+   To.Mask = From.Mask; To.Born = From.Born; To.ID   = From.ID;
+   To.Num  = From.Num;  To.Len  = From.Len;  To.Mods = From.Mods;
+   To.Full = From.Full;
+   memcpy(To.Offs, From.Offs, (From.Num+1)*sizeof(To.Offs[0]));
+   memcpy(To.Buff, From.Buff, From.Len);
+}
+
+/******************************************************************************/
+/* Public                           I n i t                                   */
+/******************************************************************************/
+  
+int XrdCmsStateQ::Init(int msWin)
+{
+   pthread_t tid;
+
+// Nothing to do if batching has not been enabled
+//
+   if (msWin <= 0) return 1;
+
+// Start the thread that sends off the batches
+//
+   if (XrdSysThread::Run(&tid, XrdCmsStartStateQ, (void *)this,
+                         0, "State query batcher"))
+      {Say.Emsg("Init", errno, "start state query batcher");
+       return 0;
+      }
+
+// Batching is now in effect
+//
+   msWait = msWin;
+   return 1;
+}
+
+/******************************************************************************/
+/* Public                          Q u e r y                                  */
+/******************************************************************************/
+  
+SMask_t XrdCmsStateQ::Query(SMask_t smask, XrdCmsSelect &Sel)
+{
+   CmsStateRequest QReq = {{Sel.Path.Hash, kYR_state, kYR_raw, 0}};
+   kXR_char Mods = (Sel.Opts & XrdCmsSelect::Refresh
+                 ? kXR_char(CmsStateRequest::kYR_refresh) : 0)
+                 | kXR_char(CmsStateRequest::kYR_negok);
+   int i, pLen = Sel.Path.Len+1;
+   Batch *bP = 0;
+
+// Add the path to an open batch for the same set of nodes, if possible. Open
+// a new batch if there is none; the sender sends it once the window passes.
+//
+   if (msWait && pLen <= maxBytes)
+      {qCond.Lock();
+       for (i = 0; i < numOpen; i++)
+           {bP = Open[i];
+            if (bP->Full || bP->Mods != Mods || bP->Mask != smask) continue;
+            if (bP->Len + pLen <= maxBytes) break;
+            bP->Full = true; qCond.Signal();
+           }
+       if (i >= numOpen)
+          {if (numOpen >= maxOpen) bP = 0;
+              else {if (!(++nextID)) ++nextID;
+                    bP = &bTab[nextID % maxSent];
+                    bP->Mask = smask; bP->Born = Clock(); bP->ID = nextID;
+                    bP->Num  = bP->Len = 0; bP->Mods = Mods; bP->Full = false;
+                    bP->Offs[0] = 0;
+                    Open[numOpen++] = bP;
+                    if (numOpen == 1) qCond.Signal();
+                   }
+          }
+       if (bP)
+          {memcpy(bP->Buff+bP->Len, Sel.Path.Val, pLen);
+           bP->Len += pLen; bP->Num++;
+           bP->Offs[bP->Num] = static_cast<unsigned short>(bP->Len);
+           if (bP->Num >= maxPaths || bP->Len >= maxBytes)
+              {bP->Full = true; qCond.Signal();}
+           qCond.UnLock();
+           return 0;
+          }
+       qCond.UnLock();
+      }
+
+// Batching is not possible, ask the nodes right away
+//
+   QReq.Hdr.modifier |= Mods;
+   return Cluster.Broadcast(smask, QReq.Hdr,
+                            (void *)Sel.Path.Val, pLen);
+}
+
+/******************************************************************************/
+/* Private                          S e n d                                   */
+/******************************************************************************/
+  
+void XrdCmsStateQ::Send(Batch &bP)
+{
+   EPNAME("Send")
+   CmsStateVRequest VReq = {{bP.ID, kYR_statev,
+                             static_cast<kXR_char>(kYR_raw | bP.Mods), 0}};
+   CmsStateRequest  QReq = {{0, kYR_state,
+                             static_cast<kXR_char>(kYR_raw | bP.Mods), 0}};
+   struct iovec ioV[2] = {{(char *)&VReq, sizeof(VReq)},
+                          {bP.Buff, (size_t)bP.Len}};
+   SMask_t qMask, oMask, unQueried;
+   int i, pLen;
+
+// Send the batch to all nodes that accept batches
+//
+   VReq.Hdr.datalen = htons(static_cast<unsigned short>(bP.Len));
+   unQueried = Cluster.BroadcastV(bP.Mask, ioV, 2, sizeof(VReq)+bP.Len, oMask);
+   TRACE(Files, "sent " <<bP.Num <<" paths in batch " <<bP.ID);
+
+// If every node got the batch then we are done. Otherwise, individually ask
+// the nodes that do not support batches and tell the cache about any nodes
+// that could not be asked so that they are asked at the next lookup.
+//
+   if (!unQueried && !oMask) return;
+   for (i = 0; i < bP.Num; i++)
+       {pLen = bP.Offs[i+1] - bP.Offs[i];
+        XrdCmsSelect Sel(0, bP.Buff+bP.Offs[i], pLen-1);
+        qMask = unQueried;
+        if (oMask)
+           {Sel.Path.setHash();
+            QReq.Hdr.streamid = Sel.Path.Hash;
+            qMask |= Cluster.Broadcast(oMask, QReq.Hdr, (void *)Sel.Path.Val,
+                                       pLen);
+           }
+        if (qMask) Cache.UnkFile(Sel, qMask);
+       }
+}
+
+/******************************************************************************/
+/* Public                          S t a r t                                  */
+/******************************************************************************/
+  
+void *XrdCmsStateQ::Start()
+{
+   long long Now, Due;
+   int i;
+
+// Send off batches that are full or whose window has passed. Batches are
+// opened in time order so only the oldest one needs to be timed.
+//
+   qCond.Lock();
+   do {if (!numOpen) {qCond.Wait(); continue;}
+       for (i = 0; i < numOpen && !Open[i]->Full; i++) {}
+       if (i >= numOpen)
+          {Now = Clock(); Due = Open[0]->Born + msWait;
+           if (Now < Due)
+              {qCond.WaitMS(static_cast<int>(Due - Now));
+               continue;
+              }
+           i = 0;
+          }
+       Copy(sBatch, *Open[i]);
+       numOpen--;
+       if (i < numOpen) memmove(&Open[i], &Open[i+1],
+                                (numOpen-i)*sizeof(Batch *));
+       qCond.UnLock();
+       Send(sBatch);
+       qCond.Lock();
+      } while(1);
+
+// We should never get here
+//
+   return (void *)0;
+}
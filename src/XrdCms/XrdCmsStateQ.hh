@@ -0,0 +1,103 @@
+#ifndef __XRDCMSSTATEQ_HH__
+#define __XRDCMSSTATEQ_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                       X r d C m s S t a t e Q . h h                        */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include "XProtocol/YProtocol.hh"
+
+#include "XrdCms/XrdCmsTypes.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+// The XrdCmsStateQ class coalesces the state queries a manager sends to its
+// nodes. Paths that are to be asked of the same set of nodes are collected
+// for a short window and then sent as a single statev request; nodes answer
+// with a havev bitmap for the paths they have. Nodes that do not support
+// statev are sent the usual individual state requests at that time.
+//
+class XrdCmsNode;
+class XrdCmsRRData;
+class XrdCmsSelect;
+
+class XrdCmsStateQ
+{
+public:
+
+// Process a havev response from the indicated node.
+//
+void    Answer(XrdCmsNode *nP, XrdCmsRRData &Arg);
+
+// Start batching using the window in milliseconds (0 disables batching).
+//
+int     Init(int msWin);
+
+// Ask the nodes in smask whether they have Sel.Path. The nodes that could not
+// be asked are returned; with batching these are reported to the cache later.
+//
+SMask_t Query(SMask_t smask, XrdCmsSelect &Sel);
+
+void   *Start();
+
+        XrdCmsStateQ() : qCond(0, "StateQ"), numOpen(0), nextID(0), msWait(0) {}
+       ~XrdCmsStateQ() {}
+
+private:
+
+static const int maxOpen  = 8;    // Batches being filled at any one time
+static const int maxSent  = 64;   // Batches whose responses we can accept
+static const int maxPaths = XrdCms::CmsStateVRequest::maxPaths;
+static const int maxBytes = 16384;// Must not exceed XrdCmsProtocol maxReqSize
+
+struct Batch
+      {SMask_t        Mask;                // Nodes being asked
+       long long      Born;                // Time the batch was opened in ms
+       unsigned int   ID;                  // Batch id sent as the streamid
+       int            Num;                 // Number of paths
+       int            Len;                 // Bytes used in Buff
+       kXR_char       Mods;                // State request modifiers
+       bool           Full;                // No room for more paths
+       unsigned short Offs[maxPaths+1];    // Path offsets; Offs[Num] == Len
+       char           Buff[maxBytes];      // Null terminated paths
+      };
+
+void    Copy(Batch &To, Batch &From);
+void    Send(Batch &bP);
+
+XrdSysCondVar  qCond;
+Batch         *Open[maxOpen];
+int            numOpen;
+unsigned int   nextID;
+int            msWait;
+Batch          bTab[maxSent];
+Batch          sBatch;
+};
+
+namespace XrdCms
+{
+extern    XrdCmsStateQ StateQ;
+}
+#endif
@@ -30,13 +30,127 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
   
-typedef unsigned long long SMask_t;
+#include <stdio.h>
 
-#define FULLMASK 0xFFFFFFFFFFFFFFFFULL
+// The following defines our cell size (maximum subscribers). It must be a
+// multiple of 64 as node sets are kept as an array of 64-bit words.
+//
+#define STMax 256
+
+/******************************************************************************/
+/*                       C l a s s   X r d C m s M a s k                      */
+/******************************************************************************/
+
+// A set of nodes with one bit per cell slot. All operations work word by word
+// over a small fixed size array so that the compiler can unroll and vectorize
+// them. A mask may be constructed from an integer, which sets the low order
+// bits, so that zero can be used to denote the empty set.
+
+class XrdCmsMask
+{
+public:
+
+static const int mWords = STMax/64;
+static const int HexLen = STMax/4+1;  // Buffer size needed by Hex()
+
+inline bool       Any() const
+                     {unsigned long long v = 0;
+                      for (int i = 0; i < mWords; i++) v |= mVec[i];
+                      return v != 0;
+                     }
 
-// The following defines our cell size (maximum subscribers)
+static XrdCmsMask Bit(int n)
+                     {XrdCmsMask m;
+                      m.mVec[n >> 6] = 1ULL << (n & 63);
+                      return m;
+                     }
+
+inline int        Count() const
+                     {int n = 0;
+                      for (int i = 0; i < mWords; i++)
+                          n += __builtin_popcountll(mVec[i]);
+                      return n;
+                     }
+
+// Return the number of the lowest slot in the set or -1 if the set is empty.
 //
-#define STMax 64
+inline int        First() const
+                     {for (int i = 0; i < mWords; i++)
+                          if (mVec[i]) return (i << 6) + __builtin_ctzll(mVec[i]);
+                      return -1;
+                     }
+
+inline bool       Has(int n) const
+                     {return (mVec[n >> 6] & (1ULL << (n & 63))) != 0;}
+
+// Format the mask in hex into buff, which should be HexLen bytes long.
+//
+       const char *Hex(char *buff, int blen) const
+                     {int i = mWords-1, n;
+                      while(i > 0 && !mVec[i]) i--;
+                      n = snprintf(buff, blen, "%llx", mVec[i]);
+                      while(--i >= 0 && n > 0 && n < blen)
+                           n += snprintf(buff+n, blen-n, "%016llx", mVec[i]);
+                      return buff;
+                     }
+
+explicit operator bool() const {return Any();}
+
+inline bool       operator!() const {return !Any();}
+
+inline XrdCmsMask operator~() const
+                     {XrdCmsMask m;
+                      for (int i = 0; i < mWords; i++) m.mVec[i] = ~mVec[i];
+                      return m;
+                     }
+
+inline XrdCmsMask &operator&=(const XrdCmsMask &rhs)
+                     {for (int i = 0; i < mWords; i++) mVec[i] &= rhs.mVec[i];
+                      return *this;
+                     }
+
+inline XrdCmsMask &operator|=(const XrdCmsMask &rhs)
+                     {for (int i = 0; i < mWords; i++) mVec[i] |= rhs.mVec[i];
+                      return *this;
+                     }
+
+inline XrdCmsMask &operator^=(const XrdCmsMask &rhs)
+                     {for (int i = 0; i < mWords; i++) mVec[i] ^= rhs.mVec[i];
+                      return *this;
+                     }
+
+inline XrdCmsMask operator&(const XrdCmsMask &rhs) const
+                     {XrdCmsMask m(*this); return m &= rhs;}
+
+inline XrdCmsMask operator|(const XrdCmsMask &rhs) const
+                     {XrdCmsMask m(*this); return m |= rhs;}
+
+inline XrdCmsMask operator^(const XrdCmsMask &rhs) const
+                     {XrdCmsMask m(*this); return m ^= rhs;}
+
+inline bool       operator==(const XrdCmsMask &rhs) const
+                     {unsigned long long v = 0;
+                      for (int i = 0; i < mWords; i++)
+                          v |= mVec[i] ^ rhs.mVec[i];
+                      return v == 0;
+                     }
+
+inline bool       operator!=(const XrdCmsMask &rhs) const
+                     {return !(*this == rhs);}
+
+                  XrdCmsMask(unsigned long long v=0)
+                     {mVec[0] = v;
+                      for (int i = 1; i < mWords; i++) mVec[i] = 0;
+                     }
+
+private:
+
+unsigned long long mVec[mWords];
+};
+
+typedef XrdCmsMask SMask_t;
+
+#define FULLMASK (~SMask_t(0))
 
 // The following defines the maximum number of redirectors. It is one greater
 // than the actual maximum as the zeroth is never used.
@@ -53,7 +53,8 @@ add_library(
   XrdCryptoLite
   SHARED
   XrdCrypto/XrdCryptoLite.cc              XrdCrypto/XrdCryptoLite.hh
-  XrdCrypto/XrdCryptoLite_bf32.cc )
+  XrdCrypto/XrdCryptoLite_bf32.cc
+  XrdCrypto/XrdCryptoLite_aes256.cc )
 
 if( BUILD_CRYPTO )
   target_link_libraries(
@@ -86,6 +87,7 @@ if( BUILD_CRYPTO )
     XrdCrypto/XrdCryptosslAux.cc            XrdCrypto/XrdCryptosslAux.hh
     XrdCrypto/XrdCryptosslgsiAux.cc
     XrdCrypto/XrdCryptosslCipher.cc         XrdCrypto/XrdCryptosslCipher.hh
+    XrdCrypto/XrdCryptosslKeyPool.cc        XrdCrypto/XrdCryptosslKeyPool.hh
     XrdCrypto/XrdCryptosslMsgDigest.cc      XrdCrypto/XrdCryptosslMsgDigest.hh
     XrdCrypto/XrdCryptosslRSA.cc            XrdCrypto/XrdCryptosslRSA.hh
     XrdCrypto/XrdCryptosslX509.cc           XrdCrypto/XrdCryptosslX509.hh
@@ -108,6 +110,20 @@ if( BUILD_CRYPTO )
     LINK_INTERFACE_LIBRARIES "" )
 endif()
 
+#-------------------------------------------------------------------------------
+# xrdcrypto_bench, not installed
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdcrypto_bench
+  XrdCrypto/XrdCryptoBench.cc )
+
+target_link_libraries(
+  xrdcrypto_bench
+  XrdCrypto
+  XrdUtils
+  pthread
+  ${CMAKE_DL_LIBS} )
+
 #-------------------------------------------------------------------------------
 # Install
 #-------------------------------------------------------------------------------
@@ -0,0 +1,575 @@
+/******************************************************************************/
+/*                                                                            */
+/*                     X r d C r y p t o B e n c h . c c                      */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+//
+//  Micro-benchmark for checksums, message digests, ciphers and security
+//  handshakes. For every algorithm, buffer size and thread count it reports
+//  the throughput and the latency of a single operation:
+//
+//  xrdcrypto_bench [-k cks,...] [-m md,...] [-e cipher,...] [-f factory]
+//                  [-s size,...] [-t threads,...] [-d seconds]
+//                  [-a prot,... -c seccfg]
+//
+//  Checksums are the XrdCksCalc ones (adler32, crc32, md5 and any loadable
+//  one, e.g. zcrc32) plus crc32c from XrdOucCRC. Digests and ciphers come
+//  from the crypto factory (ssl by default). Handshakes run the client and
+//  the server side of the named protocols in process, over a loopback end
+//  point; the server side is configured by the sec.protocol directives of
+//  the -c file and the client side by the usual XrdSec environment.
+//
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "XrdVersion.hh"
+#include "XrdCks/XrdCksCalc.hh"
+#include "XrdCks/XrdCksLoader.hh"
+#include "XrdCrypto/XrdCryptoCipher.hh"
+#include "XrdCrypto/XrdCryptoFactory.hh"
+#include "XrdCrypto/XrdCryptoMsgDigest.hh"
+#include "XrdNet/XrdNetAddr.hh"
+#include "XrdOuc/XrdOucCRC.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdOuc/XrdOucErrInfo.hh"
+#include "XrdSec/XrdSecInterface.hh"
+#include "XrdSec/XrdSecLoadSecurity.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+XrdVERSIONINFO(main, xrdcrypto_bench);
+
+/******************************************************************************/
+/*                         L o c a l   S t a t i c s                          */
+/******************************************************************************/
+
+namespace
+{
+double seconds = 1.0;
+
+long long nsNow()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// One operation of a benchmark, run repeatedly by a thread on its own state.
+// Run() returns false on failure.
+class BenchOp
+{
+public:
+   virtual bool Run() = 0;
+   virtual     ~BenchOp() {}
+};
+
+// Creates the per thread operation for a given buffer size, 0 if the
+// algorithm is not available.
+class BenchMaker
+{
+public:
+   virtual BenchOp *Make(int size) = 0;
+   virtual     ~BenchMaker() {}
+
+   std::string  kind;
+   std::string  name;
+   bool         sized;     // Processes a buffer of the given size
+};
+
+struct ThreadRes
+{
+   BenchOp               *op;
+   pthread_t              tid;
+   long long              ops;
+   long long              fails;
+   std::vector<long long> lat;    // nsec
+   XrdSysSemaphore       *go;
+};
+
+void *RunThread(void *arg)
+{
+   ThreadRes &r = *(ThreadRes *)arg;
+   long long t0, t1, end;
+
+   r.go->Wait();
+   end = nsNow() + (long long)(seconds * 1e9);
+   do {t0 = nsNow();
+       if (!r.op->Run()) r.fails++;
+       t1 = nsNow();
+       r.lat.push_back(t1 - t0);
+       r.ops++;
+      } while(t1 < end);
+   return (void *)0;
+}
+
+long long Pct(std::vector<long long> &v, double p)
+{
+   if (v.empty()) return 0;
+   return v[(size_t)(p * (v.size() - 1) + 0.5)];
+}
+
+bool Measure(BenchMaker &bm, int size, int nThreads)
+{
+   XrdSysSemaphore go(0);
+   std::vector<ThreadRes> res(nThreads);
+   long long t0, elapsed, ops = 0, fails = 0;
+   int i;
+
+// Set up the per thread state before starting the clock
+//
+   for (i = 0; i < nThreads; i++)
+       {res[i].op = bm.Make(size);
+        res[i].ops = res[i].fails = 0;
+        res[i].go = &go;
+        if (!res[i].op)
+           {printf("%-9s %-14s unavailable\n", bm.kind.c_str(), bm.name.c_str());
+            while(i--) delete res[i].op;
+            return false;
+           }
+       }
+
+   for (i = 0; i < nThreads; i++)
+       XrdSysThread::Run(&res[i].tid, RunThread, &res[i], XRDSYSTHREAD_HOLD,
+                         "xrdcrypto_bench");
+   t0 = nsNow();
+   for (i = 0; i < nThreads; i++) go.Post();
+
+   std::vector<long long> lat;
+   for (i = 0; i < nThreads; i++)
+       {XrdSysThread::Join(res[i].tid, 0);
+        ops   += res[i].ops;
+        fails += res[i].fails;
+        lat.insert(lat.end(), res[i].lat.begin(), res[i].lat.end());
+        delete res[i].op;
+       }
+   elapsed = nsNow() - t0;
+   std::sort(lat.begin(), lat.end());
+
+   double rate = ops / (elapsed / 1e9);
+   if (bm.sized)
+      printf("%-9s %-14s %9d %3d %9.3f GB/s %11.0f op/s %9.2f %9.2f %9.2f us%s\n",
+             bm.kind.c_str(), bm.name.c_str(), size, nThreads,
+             rate * size / 1e9, rate, Pct(lat, 0.5) / 1e3, Pct(lat, 0.99) / 1e3,
+             lat.back() / 1e3, fails ? " (failures)" : "");
+      else
+      printf("%-9s %-14s %9s %3d %9s      %11.1f op/s %9.2f %9.2f %9.2f us%s\n",
+             bm.kind.c_str(), bm.name.c_str(), "-", nThreads, "-",
+             rate, Pct(lat, 0.5) / 1e3, Pct(lat, 0.99) / 1e3,
+             lat.back() / 1e3, fails ? " (failures)" : "");
+   fflush(stdout);
+   return true;
+}
+
+void FillBuff(char *buff, int size)
+{
+   unsigned int x = 0x12345678;
+   for (int i = 0; i < size; i++) {x = x * 1103515245 + 12345; buff[i] = x >> 16;}
+}
+
+/******************************************************************************/
+/*                             C h e c k s u m s                              */
+/******************************************************************************/
+
+XrdCksLoader *cksLoader = 0;
+XrdSysMutex   cksMutex;
+
+class CksOp : public BenchOp
+{
+public:
+   bool Run() {calc->Init(); calc->Update(buff, size); calc->Final(); return true;}
+
+        CksOp(XrdCksCalc *c, int sz) : calc(c), size(sz)
+             {buff = (char *)malloc(sz); FillBuff(buff, sz);}
+       ~CksOp() {calc->Recycle(); free(buff);}
+private:
+   XrdCksCalc *calc;
+   char       *buff;
+   int         size;
+};
+
+class Crc32cOp : public BenchOp
+{
+public:
+   bool Run() {volatile uint32_t cs = XrdOucCRC::Calc32C(buff, size); (void)cs;
+               return true;
+              }
+
+        Crc32cOp(int sz) : size(sz) {buff = (char *)malloc(sz); FillBuff(buff, sz);}
+       ~Crc32cOp() {free(buff);}
+private:
+   char *buff;
+   int   size;
+};
+
+class CksMaker : public BenchMaker
+{
+public:
+   BenchOp *Make(int size)
+           {if (name == "crc32c") return new Crc32cOp(size);
+            XrdSysMutexHelper lck(cksMutex);
+            XrdCksCalc *calc = cksLoader->Load(name.c_str());
+            return (calc ? new CksOp(calc, size) : 0);
+           }
+
+   CksMaker(const char *n) {kind = "checksum"; name = n; sized = true;}
+};
+
+/******************************************************************************/
+/*                        M e s s a g e   D i g e s t                         */
+/******************************************************************************/
+
+XrdCryptoFactory *cryptoFactory = 0;
+
+class MdOp : public BenchOp
+{
+public:
+   bool Run() {return !md->Reset(name) && !md->Update(buff, size) && !md->Final();}
+
+        MdOp(XrdCryptoMsgDigest *m, const char *n, int sz) : md(m), name(n), size(sz)
+            {buff = (char *)malloc(sz); FillBuff(buff, sz);}
+       ~MdOp() {delete md; free(buff);}
+private:
+   XrdCryptoMsgDigest *md;
+   const char         *name;
+   char               *buff;
+   int                 size;
+};
+
+class MdMaker : public BenchMaker
+{
+public:
+   BenchOp *Make(int size)
+           {XrdCryptoMsgDigest *md;
+            if (!cryptoFactory || !(md = cryptoFactory->MsgDigest(name.c_str())))
+               return 0;
+            return new MdOp(md, name.c_str(), size);
+           }
+
+   MdMaker(const char *n) {kind = "digest"; name = n; sized = true;}
+};
+
+/******************************************************************************/
+/*                               C i p h e r s                                */
+/******************************************************************************/
+
+// Encrypts the buffer, or decrypts a buffer encrypted beforehand
+//
+class CipherOp : public BenchOp
+{
+public:
+   bool Run() {return (enc ? cip->Encrypt(buff, size, obuff)
+                           : cip->Decrypt(ebuff, elen, obuff)) > 0;
+              }
+
+        CipherOp(XrdCryptoCipher *c, bool e, int sz) : cip(c), enc(e), size(sz)
+                {buff  = (char *)malloc(sz); FillBuff(buff, sz);
+                 ebuff = (char *)malloc(cip->EncOutLength(sz));
+                 obuff = (char *)malloc(cip->EncOutLength(sz) + cip->DecOutLength(sz));
+                 elen  = cip->Encrypt(buff, sz, ebuff);
+                }
+       ~CipherOp() {delete cip; free(buff); free(ebuff); free(obuff);}
+
+   bool IsValid() {return elen > 0;}
+private:
+   XrdCryptoCipher *cip;
+   bool             enc;
+   char            *buff;
+   char            *ebuff;
+   char            *obuff;
+   int              size;
+   int              elen;
+};
+
+class CipherMaker : public BenchMaker
+{
+public:
+   BenchOp *Make(int size)
+           {XrdCryptoCipher *cip;
+            if (!cryptoFactory || !(cip = cryptoFactory->Cipher(cipName.c_str())))
+               return 0;
+            if (!cip->IsValid()) {delete cip; return 0;}
+            CipherOp *op = new CipherOp(cip, encrypt, size);
+            if (!op->IsValid()) {delete op; return 0;}
+            return op;
+           }
+
+   CipherMaker(const char *n, bool e) : cipName(n), encrypt(e)
+              {kind = (e ? "encrypt" : "decrypt"); name = n; sized = true;}
+private:
+   std::string cipName;
+   bool        encrypt;
+};
+
+/******************************************************************************/
+/*                            H a n d s h a k e s                             */
+/******************************************************************************/
+
+XrdSecService   *secService = 0;
+XrdSecGetProt_t  secGetProt = 0;
+XrdNetAddr       loopAddr;
+
+// A complete authentication: the server parameters for the protocol, the
+// client credentials and as many rounds of kXR_authmore as the protocol
+// needs, as XrdXrootdProtocol::do_Auth and the client drive it.
+//
+class HandshakeOp : public BenchOp
+{
+public:
+   bool Run()
+       {XrdOucErrInfo      cInfo, sInfo;
+        XrdSecParameters   sParms;
+        XrdSecParameters  *more = 0;
+        XrdSecCredentials *cred;
+        XrdSecProtocol    *cProt, *sProt;
+        bool ok = false;
+        int rc, rounds = 0;
+
+        cInfo.setEnv(&cEnv);
+        sParms.buffer = (char *)parms.c_str();
+        sParms.size   = parms.size() + 1;
+        if (!(cProt = secGetProt(loopAddr.Name("localhost"), loopAddr, sParms, &cInfo)))
+           {eText = cInfo.getErrText(); return false;}
+
+        if (!(cred = cProt->getCredentials(0, &cInfo)))
+           {eText = cInfo.getErrText(); cProt->Delete(); return false;}
+
+        if ((sProt = secService->getProtocol(loopAddr.Name("localhost"), loopAddr, cred, &sInfo)))
+           {while((rc = sProt->Authenticate(cred, &more, &sInfo)) > 0
+              &&  more && rounds++ < 16)
+                 {delete cred;
+                  cred = cProt->getCredentials(more, &cInfo);
+                  delete more; more = 0;
+                  if (!cred) {eText = cInfo.getErrText(); break;}
+                 }
+            ok = (rc == 0);
+            if (rc < 0) eText = sInfo.getErrText();
+            if (more) delete more;
+            sProt->Delete();
+           } else eText = sInfo.getErrText();
+        if (cred) delete cred;
+        cProt->Delete();
+        return ok;
+       }
+
+   const char *Error() {return eText.c_str();}
+
+   // The client tells sss its address as the server sees it
+   HandshakeOp(const std::string &p) : parms(p)
+              {char buff[256];
+               if (loopAddr.Format(buff, sizeof(buff), XrdNetAddrInfo::fmtAdv6))
+                  cEnv.Put("sockname", buff);
+              }
+private:
+   XrdOucEnv   cEnv;
+   std::string parms;
+   std::string eText;
+};
+
+class HandshakeMaker : public BenchMaker
+{
+public:
+   BenchOp *Make(int)
+           {const char *p;
+            int n;
+            if (!secService || !secGetProt
+            ||  !(p = secService->getParms(n, &loopAddr))) return 0;
+
+            // Offer only this protocol to the client
+            std::string all(p, (n > 0 && !p[n-1] ? n-1 : n)), tok = "&P=" + name;
+            std::string::size_type pos = all.find(tok + ","), end;
+            if (pos == std::string::npos)
+               {pos = all.find(tok);
+                if (pos == std::string::npos || (pos + tok.size() < all.size()
+                &&  all[pos + tok.size()] != '&'))
+                   {fprintf(stderr, "xrdcrypto_bench: %s is not configured\n",
+                            name.c_str());
+                    return 0;
+                   }
+               }
+            end = all.find("&P=", pos + 3);
+            HandshakeOp *op = new HandshakeOp(all.substr(pos, end == std::string::npos
+                                                              ? std::string::npos
+                                                              : end - pos));
+            if (!op->Run())
+               {fprintf(stderr, "xrdcrypto_bench: %s handshake failed; %s\n",
+                        name.c_str(), op->Error());
+                delete op;
+                return 0;
+               }
+            return op;
+           }
+
+   HandshakeMaker(const char *n) {kind = "handshake"; name = n; sized = false;}
+};
+
+/******************************************************************************/
+/*                                 U s a g e                                  */
+/******************************************************************************/
+
+void Usage(int rc)
+{
+   fprintf(stderr, "Usage: xrdcrypto_bench [-k cks,...] [-m md,...] [-e cipher,...] "
+                   "[-f factory]\n"
+                   "                       [-s size,...] [-t threads,...] "
+                   "[-d seconds]\n"
+                   "                       [-a prot,... -c seccfg]\n");
+   exit(rc);
+}
+
+std::vector<std::string> Split(const char *s)
+{
+   std::vector<std::string> v;
+   std::string str(s);
+   std::string::size_type b = 0, e;
+   while(b <= str.size())
+        {e = str.find(',', b);
+         if (e == std::string::npos) e = str.size();
+         if (e > b) v.push_back(str.substr(b, e - b));
+         b = e + 1;
+        }
+   return v;
+}
+
+int Size(const std::string &s)
+{
+   char *eP;
+   long long v = strtoll(s.c_str(), &eP, 10);
+   switch(*eP)
+         {case 'k': case 'K': v <<= 10; break;
+          case 'm': case 'M': v <<= 20; break;
+          case 'g': case 'G': v <<= 30; break;
+          default:  break;
+         }
+   return (v > 0 && v < (1LL << 31) ? (int)v : 0);
+}
+}
+
+/******************************************************************************/
+/*                          M A I N   P R O G R A M                           */
+/******************************************************************************/
+
+int main(int argc, char **argv)
+{
+   const char *cks = "adler32,crc32,crc32c,md5", *mds = "md5,sha1,sha256";
+   const char *ciphers = "bf-cbc,aes-256-cbc", *factory = "ssl";
+   const char *sizes = "1k,64k,1m,16m", *threads = 0, *prots = 0, *seccfg = 0;
+   char tbuff[64];
+   int c;
+
+   while((c = getopt(argc, argv, "k:m:e:f:s:t:d:a:c:h")) != -1)
+        {switch(c)
+               {case 'k': cks     = optarg;       break;
+                case 'm': mds     = optarg;       break;
+                case 'e': ciphers = optarg;       break;
+                case 'f': factory = optarg;       break;
+                case 's': sizes   = optarg;       break;
+                case 't': threads = optarg;       break;
+                case 'd': seconds = atof(optarg); break;
+                case 'a': prots   = optarg;       break;
+                case 'c': seccfg  = optarg;       break;
+                case 'h': Usage(0); break;
+                default:  Usage(1);
+               }
+        }
+   if (optind < argc || seconds <= 0 || (prots && !seccfg)) Usage(1);
+
+// By default use one thread and all of the cpus
+//
+   if (!threads)
+      {long n = sysconf(_SC_NPROCESSORS_ONLN);
+       snprintf(tbuff, sizeof(tbuff), (n > 1 ? "1,%ld" : "1"), n);
+       threads = tbuff;
+      }
+
+   std::vector<std::string> sizeV = Split(sizes), threadV = Split(threads);
+   std::vector<BenchMaker *> makers;
+   std::vector<std::string> v;
+   unsigned int i, j, k;
+
+   cksLoader = new XrdCksLoader(XrdVERSIONINFOVAR(main));
+   v = Split(cks);
+   for (i = 0; i < v.size(); i++) makers.push_back(new CksMaker(v[i].c_str()));
+
+   if (*mds || *ciphers)
+      {if (!(cryptoFactory = XrdCryptoFactory::GetCryptoFactory(factory)))
+          fprintf(stderr, "xrdcrypto_bench: unable to load crypto factory %s\n",
+                  factory);
+       v = Split(mds);
+       for (i = 0; i < v.size(); i++) makers.push_back(new MdMaker(v[i].c_str()));
+       v = Split(ciphers);
+       for (i = 0; i < v.size(); i++)
+           {makers.push_back(new CipherMaker(v[i].c_str(), true));
+            makers.push_back(new CipherMaker(v[i].c_str(), false));
+           }
+      }
+
+// The security framework, the server side is configured by the file
+//
+   if (prots)
+      {static XrdSysLogger logger;
+       static XrdSysError   eDest(&logger, "bench_");
+       char eBuff[2048];
+       if (!getenv("XRDINSTANCE"))
+          putenv((char *)"XRDINSTANCE=xrdcrypto_bench anon@localhost");
+       loopAddr.Set("127.0.0.1", 1094);
+       if (!(secService = XrdSecLoadSecService(&eDest, seccfg)))
+          fprintf(stderr, "xrdcrypto_bench: unable to load the security service\n");
+       if (!(secGetProt = XrdSecLoadSecFactory(eBuff, sizeof(eBuff))))
+          fprintf(stderr, "xrdcrypto_bench: %s\n", eBuff);
+       v = Split(prots);
+       for (i = 0; i < v.size(); i++) makers.push_back(new HandshakeMaker(v[i].c_str()));
+      }
+
+   printf("%-9s %-14s %9s %3s %14s %16s %9s %9s %9s\n", "kind", "name", "size",
+          "thr", "throughput", "rate", "p50", "p99", "max");
+   for (i = 0; i < makers.size(); i++)
+       {bool avail = true;
+        for (j = 0; avail && j < (makers[i]->sized ? sizeV.size() : 1); j++)
+            {int size = (makers[i]->sized ? Size(sizeV[j]) : 0);
+             if (makers[i]->sized && !size)
+                {fprintf(stderr, "xrdcrypto_bench: invalid size %s\n",
+                         sizeV[j].c_str());
+                 exit(1);
+                }
+             for (k = 0; avail && k < threadV.size(); k++)
+                 {int n = atoi(threadV[k].c_str());
+                  if (n > 0) avail = Measure(*makers[i], size, n);
+                 }
+            }
+       }
+
+// Plugins may still have threads running, do not tear them down under them
+//
+   fflush(stdout);
+   _exit(0);
+}
@@ -47,6 +47,13 @@ bool XrdCryptoCipher::Finalize(char *, int, const char *)
    return 0;
 }
 
+//_____________________________________________________________________________
+bool XrdCryptoCipher::EnableECDH()
+{
+   // Offer an elliptic-curve key agreement: not supported by default
+   return 0;
+}
+
 //_____________________________________________________________________________
 bool XrdCryptoCipher::IsValid()
 {
@@ -52,6 +52,8 @@ public:
 
    // Finalize key computation (key agreement)
    virtual bool Finalize(char *pub, int lpub, const char *t);
+   // Offer an elliptic-curve agreement in Public(), if supported
+   virtual bool EnableECDH();
 
    // Validity
    virtual bool IsValid();
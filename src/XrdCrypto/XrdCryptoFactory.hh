@@ -134,6 +134,9 @@ public:
    // Any possible notification
    virtual void Notify() { }
 
+   // Depth of the pool of pre-generated key pairs (0 = generate inline)
+   virtual void SetKeyPool(int) { }
+
    // Hook to a Key Derivation Function (PBKDF2 when possible)
    virtual XrdCryptoKDFunLen_t KDFunLen(); // Length of buffer
    virtual XrdCryptoKDFun_t KDFun();
@@ -50,9 +50,11 @@
 XrdCryptoLite *XrdCryptoLite::Create(int &rc, const char *Name, const char Type)
 {
    extern XrdCryptoLite *XrdCryptoLite_New_bf32(const char Type);
+   extern XrdCryptoLite *XrdCryptoLite_New_aes256(const char Type);
    XrdCryptoLite *cryptoP = 0;
 
-   if (!strcmp(Name, "bf32"))     cryptoP = XrdCryptoLite_New_bf32(Type);
+        if (!strcmp(Name, "bf32"))   cryptoP = XrdCryptoLite_New_bf32(Type);
+   else if (!strcmp(Name, "aes256")) cryptoP = XrdCryptoLite_New_aes256(Type);
 
 // Return appropriately
 //
@@ -48,6 +48,7 @@ public:
 
 //           Supported names:
 //           bf32      Blowfish with CRC32 validation.
+//           aes256    AES-256 GCM with tag validation.
 //
 static XrdCryptoLite *
              Create(int        &rc,        // errno when Create(...) == 0
@@ -0,0 +1,187 @@
+/******************************************************************************/
+/*                                                                            */
+/*               X r d C r y p t o L i t e _ a e s 2 5 6 . c c                */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdCrypto/XrdCryptoLite.hh"
+
+#ifdef HAVE_SSL
+
+#include <errno.h>
+#include <string.h>
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+/******************************************************************************/
+/*            C l a s s   X r d C r y p t o L i t e _ a e s 2 5 6             */
+/******************************************************************************/
+
+// This implementation uses AES-256 in GCM mode. The cipher key is the SHA-256
+// digest of the supplied key so that keys of any length may be used. Output
+// consists of a random 12 byte IV, the cipher text, and a 16 byte tag that
+// validates the result upon decryption. EVP uses the processor's AES
+// instructions (e.g. AES-NI) when it has them.
+//
+class XrdCryptoLite_aes256 : public XrdCryptoLite
+{
+public:
+
+virtual int  Decrypt(const char *key,      // Decryption key
+                     int         keyLen,   // Decryption key byte length
+                     const char *src,      // Buffer to be decrypted
+                     int         srcLen,   // Bytes length of src  buffer
+                     char       *dst,      // Buffer to hold decrypted result
+                     int         dstLen);  // Bytes length of dst  buffer
+
+virtual int  Encrypt(const char *key,      // Encryption key
+                     int         keyLen,   // Encryption key byte length
+                     const char *src,      // Buffer to be encrypted
+                     int         srcLen,   // Bytes length of src  buffer
+                     char       *dst,      // Buffer to hold encrypted result
+                     int         dstLen);  // Bytes length of dst  buffer
+
+         XrdCryptoLite_aes256(const char deType)
+                             : XrdCryptoLite(deType, ivLen+tagLen) {}
+        ~XrdCryptoLite_aes256() {}
+
+private:
+
+bool     SetKey(unsigned char *aesKey, const char *key, int keyLen);
+
+static const int ivLen  = 12;
+static const int tagLen = 16;
+static const int keySZ  = 32;
+};
+
+/******************************************************************************/
+/*                               D e c r y p t                                */
+/******************************************************************************/
+
+int XrdCryptoLite_aes256::Decrypt(const char *key,
+                                  int         keyLen,
+                                  const char *src,
+                                  int         srcLen,
+                                  char       *dst,
+                                  int         dstLen)
+{
+   EVP_CIPHER_CTX *ctx;
+   const unsigned char *iv  = (const unsigned char *)src;
+   const unsigned char *tag = (const unsigned char *)src + srcLen - tagLen;
+   unsigned char aesKey[keySZ];
+   int n, rc = -EPROTO, dLen = srcLen - ivLen - tagLen;
+
+// Make sure we have data and room for it
+//
+   if (dLen <= 0 || dstLen < dLen) return -EINVAL;
+
+// Set the key and get a cipher context
+//
+   if (!SetKey(aesKey, key, keyLen)) return -EINVAL;
+   if (!(ctx = EVP_CIPHER_CTX_new())) return -ENOMEM;
+
+// Decrypt and validate the tag
+//
+   if (1 == EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), 0, aesKey, iv)
+   &&  1 == EVP_DecryptUpdate(ctx, (unsigned char *)dst, &n,
+                              (const unsigned char *)src+ivLen, dLen)
+   &&  1 == EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, tagLen, (void *)tag)
+   &&  1 == EVP_DecryptFinal_ex(ctx, (unsigned char *)dst+n, &n)) rc = dLen;
+
+// Clean up and return result
+//
+   EVP_CIPHER_CTX_free(ctx);
+   memset(aesKey, 0, sizeof(aesKey));
+   return rc;
+}
+
+/******************************************************************************/
+/*                               E n c r y p t                                */
+/******************************************************************************/
+
+int XrdCryptoLite_aes256::Encrypt(const char *key,
+                                  int         keyLen,
+                                  const char *src,
+                                  int         srcLen,
+                                  char       *dst,
+                                  int         dstLen)
+{
+   EVP_CIPHER_CTX *ctx;
+   unsigned char *iv = (unsigned char *)dst, aesKey[keySZ];
+   int n, rc = -EPROTO;
+
+// Make sure that the destination has room for the IV and tag and we have data
+//
+   if (dstLen-srcLen < ivLen+tagLen || srcLen <= 0) return -EINVAL;
+
+// Set the key, generate a random IV, and get a cipher context
+//
+   if (!SetKey(aesKey, key, keyLen)) return -EINVAL;
+   if (1 != RAND_bytes(iv, ivLen)) return -EIO;
+   if (!(ctx = EVP_CIPHER_CTX_new())) return -ENOMEM;
+
+// Encrypt and append the tag
+//
+   if (1 == EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), 0, aesKey, iv)
+   &&  1 == EVP_EncryptUpdate(ctx, (unsigned char *)dst+ivLen, &n,
+                              (const unsigned char *)src, srcLen)
+   &&  1 == EVP_EncryptFinal_ex(ctx, (unsigned char *)dst+ivLen+n, &n)
+   &&  1 == EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, tagLen,
+                                dst+ivLen+srcLen)) rc = ivLen+srcLen+tagLen;
+
+// Clean up and return result
+//
+   EVP_CIPHER_CTX_free(ctx);
+   memset(aesKey, 0, sizeof(aesKey));
+   return rc;
+}
+
+/******************************************************************************/
+/*                                S e t K e y                                 */
+/******************************************************************************/
+
+bool XrdCryptoLite_aes256::SetKey(unsigned char *aesKey,
+                                  const char *key, int keyLen)
+{
+   unsigned int n;
+
+   if (keyLen <= 0) return false;
+   return 1 == EVP_Digest(key, keyLen, aesKey, &n, EVP_sha256(), 0)
+          && n == (unsigned int)keySZ;
+}
+#endif
+
+/******************************************************************************/
+/*              X r d C r y p t o L i t e _ N e w _ a e s 2 5 6               */
+/******************************************************************************/
+
+XrdCryptoLite *XrdCryptoLite_New_aes256(const char Type)
+{
+#ifdef HAVE_SSL
+   return (XrdCryptoLite *)(new XrdCryptoLite_aes256(Type));
+#else
+   return (XrdCryptoLite *)0;
+#endif
+}
@@ -33,9 +33,11 @@
 /* ************************************************************************** */
 #include <string.h>
 
+#include "XrdSut/XrdSutAux.hh"
 #include "XrdSut/XrdSutRndm.hh"
 #include "XrdCrypto/XrdCryptosslTrace.hh"
 #include "XrdCrypto/XrdCryptosslCipher.hh"
+#include "XrdCrypto/XrdCryptosslKeyPool.hh"
 
 //#include <openssl/dsa.h>
 #include <openssl/bio.h>
@@ -132,6 +134,90 @@ static int DSA_set0_key(DSA *d, BIGNUM *pub_key, BIGNUM *priv_key)
 }
 #endif
 
+// X25519 public parts travel after the DH public part in the key-agreement
+// buffer; peers not knowing about it just ignore the trailing section
+#define kX25519LEN 32
+static const char *kECDHBeg = "---BX25519---";
+static const char *kECDHEnd = "---EX25519---";
+
+//_____________________________________________________________________________
+static int ECDHPublic(EVP_PKEY *pkey, char *out)
+{
+   // Write the X25519 public part of pkey, enclosed by its markers, at out
+   // (at least 2*kX25519LEN+27 bytes). Returns the number of bytes written.
+
+#ifdef XRDCRYPTO_X25519
+   unsigned char raw[kX25519LEN];
+   size_t lraw = sizeof(raw);
+   char hex[2*kX25519LEN+1];
+   int lb = strlen(kECDHBeg), le = strlen(kECDHEnd);
+
+   if (!pkey || EVP_PKEY_get_raw_public_key(pkey, raw, &lraw) != 1
+       || lraw != kX25519LEN) return 0;
+   XrdSutToHex((const char *)raw, kX25519LEN, hex);
+   memcpy(out, kECDHBeg, lb);
+   memcpy(out+lb, hex, 2*kX25519LEN);
+   memcpy(out+lb+2*kX25519LEN, kECDHEnd, le);
+   return lb + 2*kX25519LEN + le;
+#else
+   return 0;
+#endif
+}
+
+//_____________________________________________________________________________
+static bool ECDHPeer(const char *pub, int lpub, unsigned char *key)
+{
+   // Extract the X25519 public part of the counterpart, if any, from the
+   // first lpub bytes of the key-agreement buffer at pub into key.
+
+   int lb = strlen(kECDHBeg), le = strlen(kECDHEnd), lhex = 2*kX25519LEN;
+   char hex[2*kX25519LEN+1];
+   int lout = 0;
+
+   if (!pub) return 0;
+   for (int i = 0; i + lb + lhex + le <= lpub; i++) {
+      if (memcmp(pub+i, kECDHBeg, lb)) continue;
+      if (memcmp(pub+i+lb+lhex, kECDHEnd, le)) return 0;
+      memcpy(hex, pub+i+lb, lhex);
+      hex[lhex] = 0;
+      return (!XrdSutFromHex(hex, (char *)key, lout) && lout == kX25519LEN);
+   }
+   return 0;
+}
+
+//_____________________________________________________________________________
+static char *ECDHSecret(EVP_PKEY *pkey, const unsigned char *peer, int &lsec)
+{
+   // Agree on the session key material using our X25519 key and the public
+   // part of the counterpart; the shared secret is hashed with SHA-256.
+   // Returns a buffer to be deleted by the caller, or 0 on failure.
+
+   lsec = 0;
+#ifdef XRDCRYPTO_X25519
+   unsigned char sec[kX25519LEN];
+   size_t lraw = sizeof(sec);
+   unsigned int lmd = 0;
+   char *ktmp = 0;
+
+   EVP_PKEY *ppeer = EVP_PKEY_new_raw_public_key(EVP_PKEY_X25519, 0,
+                                                 peer, kX25519LEN);
+   EVP_PKEY_CTX *pctx = (ppeer ? EVP_PKEY_CTX_new(pkey, 0) : 0);
+   if (pctx && EVP_PKEY_derive_init(pctx) == 1
+            && EVP_PKEY_derive_set_peer(pctx, ppeer) == 1
+            && EVP_PKEY_derive(pctx, sec, &lraw) == 1) {
+      ktmp = new char[EVP_MAX_MD_SIZE];
+      if (EVP_Digest(sec, lraw, (unsigned char *)ktmp, &lmd,
+                     EVP_sha256(), 0) == 1) lsec = lmd;
+         else {delete[] ktmp; ktmp = 0;}
+   }
+   if (pctx) EVP_PKEY_CTX_free(pctx);
+   if (ppeer) EVP_PKEY_free(ppeer);
+   return ktmp;
+#else
+   return 0;
+#endif
+}
+
 //_____________________________________________________________________________
 bool XrdCryptosslCipher::IsSupported(const char *cip)
 {
@@ -154,6 +240,7 @@ XrdCryptosslCipher::XrdCryptosslCipher(const char *t, int l)
    lIV = 0;
    cipher = 0;
    fDH = 0;
+   fECDH = 0;
    deflength = 1;
 
    // Check and set type
@@ -217,6 +304,7 @@ XrdCryptosslCipher::XrdCryptosslCipher(const char *t, int l,
    fIV = 0;
    lIV = 0;
    fDH = 0;
+   fECDH = 0;
    cipher = 0;
    deflength = 1;
 
@@ -270,6 +358,7 @@ XrdCryptosslCipher::XrdCryptosslCipher(XrdSutBucket *bck)
    fIV = 0;
    lIV = 0;
    fDH = 0;
+   fECDH = 0;
    cipher = 0;
    deflength = 1;
 
@@ -450,6 +539,7 @@ XrdCryptosslCipher::XrdCryptosslCipher(int bits, char *pub,
    fIV = 0;
    lIV = 0;
    fDH = 0;
+   fECDH = 0;
    cipher = 0;
    deflength = 1;
 
@@ -481,6 +571,12 @@ XrdCryptosslCipher::XrdCryptosslCipher(int bits, char *pub,
       //
       char *ktmp = 0;
       int ltmp = 0;
+      //
+      // If the counterpart offers X25519 and we support it, use it to agree
+      // on the key; the DH part is still generated for the public buffer
+      unsigned char peer[kX25519LEN];
+      bool ecdh = (ECDHPeer(pub, lpub, peer) &&
+                   (fECDH = XrdCryptosslKeyPool::GetX25519()));
       // Extract string with bignumber
       BIGNUM *bnpub = 0;
       char *pb = strstr(pub,"---BPUB---");
@@ -512,19 +608,26 @@ XrdCryptosslCipher::XrdCryptosslCipher(int bits, char *pub,
                   //
                   // generate DH key
                   if (DH_generate_key(fDH)) {
-                     // Now we can compute the cipher
-                     ktmp = new char[DH_size(fDH)];
-                     memset(ktmp, 0, DH_size(fDH));
-                     if (ktmp) {
-                        if ((ltmp = DH_compute_key((unsigned char *)ktmp,
-                                                    bnpub,fDH)) > 0)
+                     if (ecdh) {
+                        DEBUG("using X25519 key agreement");
+                        if ((ktmp = ECDHSecret(fECDH, peer, ltmp)))
                            valid = 1;
+                     } else {
+                        // Now we can compute the cipher
+                        ktmp = new char[DH_size(fDH)];
+                        memset(ktmp, 0, DH_size(fDH));
+                        if (ktmp) {
+                           if ((ltmp = DH_compute_key((unsigned char *)ktmp,
+                                                       bnpub,fDH)) > 0)
+                              valid = 1;
+                        }
                      }
                   }
                }
             }
             BIO_free(biop);
          }
+         BN_free(bnpub);
       }
       //
       // If a valid key has been computed, set the cipher
@@ -593,6 +696,8 @@ XrdCryptosslCipher::XrdCryptosslCipher(const XrdCryptosslCipher &c)
    SetBuffer(c.Length(),c.Buffer());
    // Set also the type
    SetType(c.Type());
+   // Ephemeral X25519 keys are never copied; see EnableECDH()
+   fECDH = 0;
    // DH
    fDH = 0;
    if (valid && c.fDH) {
@@ -646,14 +751,32 @@ void XrdCryptosslCipher::Cleanup()
       DH_free(fDH);
       fDH = 0;
    }
+   if (fECDH) {
+      EVP_PKEY_free(fECDH);
+      fECDH = 0;
+   }
 }
 
 //____________________________________________________________________________
-bool XrdCryptosslCipher::Finalize(char *pub, int /*lpub*/, const char *t)
+bool XrdCryptosslCipher::EnableECDH()
+{
+   // Add a X25519 key pair to a cipher prepared for key agreement, so that
+   // Public() offers it to the counterpart. Finalize() uses it if the
+   // counterpart answers with its own X25519 public part and falls back to
+   // DH otherwise. Returns true if X25519 is offered.
+
+   if (!fDH) return 0;
+   if (!fECDH) fECDH = XrdCryptosslKeyPool::GetX25519();
+   return (fECDH != 0);
+}
+
+//____________________________________________________________________________
+bool XrdCryptosslCipher::Finalize(char *pub, int lpub, const char *t)
 {
    // Finalize cipher during key agreement. Should be called
    // for a cipher build with special constructor defining member fDH.
    // The buffer pub should contain the public part of the counterpart.
+   // If we offered X25519 and the counterpart answered, that is used.
    // Sets also the name to 't', if different from the default one.
    // Used for key agreement.
    EPNAME("sslCipher::Finalize");
@@ -668,12 +791,21 @@ bool XrdCryptosslCipher::Finalize(char *pub, int /*lpub*/, const char *t)
    int ltmp = 0;
    valid = 0;
    if (pub) {
+      //
+      // X25519 agreement, if offered by both sides
+      unsigned char peer[kX25519LEN];
+      bool ecdh = (fECDH && ECDHPeer(pub, lpub, peer));
+      if (ecdh) {
+         DEBUG("using X25519 key agreement");
+         if ((ktmp = ECDHSecret(fECDH, peer, ltmp)))
+            valid = 1;
+      }
       //
       // Extract string with bignumber
       BIGNUM *bnpub = 0;
       char *pb = strstr(pub,"---BPUB---");
       char *pe = strstr(pub,"---EPUB--");
-      if (pb && pe) {
+      if (!ecdh && pb && pe) {
          //lpub = (int)(pb-pub);
          pb += 10;
          *pe = 0;
@@ -775,7 +907,7 @@ char *XrdCryptosslCipher::Public(int &lpub)
       // Prepare bio to export info buffer
       BIO *biop = BIO_new(BIO_s_mem());
       if (biop) {
-         int ltmp = Publen() + lhex + 20;
+         int ltmp = Publen() + lhex + 20 + 2*kX25519LEN + 30;
          char *pub = new char[ltmp];
          if (pub) {
             // Write parms first
@@ -801,6 +933,9 @@ char *XrdCryptosslCipher::Public(int &lpub)
                memcpy(p,"---EPUB---",10);
                // Calculate total length
                lpub += (20 + lhex);
+               // Our X25519 public part, if we offer it
+               if (fECDH)
+                  lpub += ECDHPublic(fECDH, pub + lpub);
             } else {
                if (phex) OPENSSL_free(phex);
             }
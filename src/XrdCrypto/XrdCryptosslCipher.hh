@@ -54,6 +54,7 @@ private:
    const EVP_CIPHER *cipher;
    EVP_CIPHER_CTX *ctx;
    DH         *fDH;
+   EVP_PKEY   *fECDH;
    bool        deflength;
    bool        valid;
 
@@ -73,6 +74,7 @@ public:
 
    // Finalize key computation (key agreement)
    bool Finalize(char *pub, int lpub, const char *t);
+   bool EnableECDH();
    void Cleanup();
 
    // Validity
@@ -35,6 +35,7 @@
 #include "XrdCrypto/XrdCryptosslFactory.hh"
 #include "XrdCrypto/XrdCryptosslAux.hh"
 #include "XrdCrypto/XrdCryptosslCipher.hh"
+#include "XrdCrypto/XrdCryptosslKeyPool.hh"
 #include "XrdCrypto/XrdCryptosslMsgDigest.hh"
 #include "XrdCrypto/XrdCryptosslRSA.hh"
 #include "XrdCrypto/XrdCryptosslX509.hh"
@@ -160,6 +161,14 @@ void XrdCryptosslFactory::SetTrace(kXR_int32 trace)
    }
 }
 
+//______________________________________________________________________________
+void XrdCryptosslFactory::SetKeyPool(int depth)
+{
+   // Keep up to 'depth' pre-generated key pairs of each kind in use
+
+   XrdCryptosslKeyPool::SetDepth(depth);
+}
+
 //______________________________________________________________________________
 XrdCryptoKDFunLen_t XrdCryptosslFactory::KDFunLen()
 {
@@ -56,6 +56,9 @@ public:
    // Set trace flags
    void SetTrace(kXR_int32 trace);
 
+   // Depth of the pool of pre-generated key pairs
+   void SetKeyPool(int depth);
+
    // Hook to Key Derivation Function (PBKDF2)
    XrdCryptoKDFunLen_t KDFunLen(); // Default Length of buffer
    XrdCryptoKDFun_t KDFun();
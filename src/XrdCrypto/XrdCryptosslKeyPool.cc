@@ -0,0 +1,280 @@
+/******************************************************************************/
+/*                                                                            */
+/*                X r d C r y p t o s s l K e y P o o l . c c                 */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/*                                                                            */
+/* Pool of pre-generated key pairs for the OpenSSL crypto module              */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <deque>
+#include <stdlib.h>
+#include <vector>
+
+#include <openssl/bn.h>
+#include <openssl/crypto.h>
+
+#include "XrdSys/XrdSysPthread.hh"
+#include "XrdCrypto/XrdCryptosslTrace.hh"
+#include "XrdCrypto/XrdCryptosslKeyPool.hh"
+
+/******************************************************************************/
+/*                         L o c a l   S t a t i c s                          */
+/******************************************************************************/
+
+namespace
+{
+// At most this many distinct RSA sizes are kept warm
+const unsigned int maxRSASizes = 4;
+
+struct RSAPool
+{
+   int               bits;
+   std::deque<RSA *> keys;
+};
+
+// The pool state is never destroyed: the refill thread may still be running
+// while static objects are torn down at exit
+struct PoolState
+{
+   XrdSysCondVar          poolCV;
+   std::vector<RSAPool>   rsaPool;
+   std::deque<EVP_PKEY *> x25519Pool;
+   bool                   x25519Used;
+   int                    poolDepth;
+   bool                   poolActive;
+   bool                   poolBusy;
+
+   PoolState() : poolCV(0), x25519Used(false), poolDepth(0),
+                 poolActive(false), poolBusy(false) {}
+};
+
+PoolState &Pool()
+{
+   static PoolState *pool = new PoolState;
+   return *pool;
+}
+
+//_____________________________________________________________________________
+void StopRefill()
+{
+   // At exit, wait for a key being generated before OpenSSL tears down
+   // its own state
+
+   PoolState &P = Pool();
+   P.poolCV.Lock();
+   P.poolDepth = 0;
+   while (P.poolBusy) P.poolCV.Wait();
+   P.poolCV.UnLock();
+}
+
+//_____________________________________________________________________________
+RSA *NewRSA(int bits)
+{
+   // Generate a RSA key with exponent 65537
+
+   RSA *kRSA = RSA_new();
+   BIGNUM *e = BN_new();
+   if (!kRSA || !e) {
+      if (kRSA) RSA_free(kRSA);
+      if (e) BN_free(e);
+      return 0;
+   }
+   BN_set_word(e, 0x10001);
+   if (RSA_generate_key_ex(kRSA, bits, e, NULL) != 1) {
+      RSA_free(kRSA);
+      kRSA = 0;
+   }
+   BN_free(e);
+   return kRSA;
+}
+
+//_____________________________________________________________________________
+EVP_PKEY *NewX25519()
+{
+   // Generate a X25519 key pair
+
+   EVP_PKEY *pkey = 0;
+#ifdef XRDCRYPTO_X25519
+   EVP_PKEY_CTX *pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_X25519, 0);
+   if (pctx) {
+      if (EVP_PKEY_keygen_init(pctx) != 1 ||
+          EVP_PKEY_keygen(pctx, &pkey) != 1) pkey = 0;
+      EVP_PKEY_CTX_free(pctx);
+   }
+#endif
+   return pkey;
+}
+}
+
+/******************************************************************************/
+/*                              S e t D e p t h                               */
+/******************************************************************************/
+
+void XrdCryptosslKeyPool::SetDepth(int depth)
+{
+   // Set the pool depth, starting the refill thread if needed
+   EPNAME("KeyPool::SetDepth");
+   PoolState &P = Pool();
+   pthread_t tid;
+
+   P.poolCV.Lock();
+   P.poolDepth = (depth > 0 ? depth : 0);
+   if (P.poolDepth && !P.poolActive) {
+      if (XrdSysThread::Run(&tid, XrdCryptosslKeyPool::Refill, 0, 0,
+                            "crypto key pool refill")) {
+         PRINT("unable to start key pool refill thread; keys generated inline");
+         P.poolDepth = 0;
+      } else {
+         P.poolActive = true;
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+         OPENSSL_atexit(StopRefill);
+#else
+         atexit(StopRefill);
+#endif
+      }
+   }
+   P.poolCV.Signal();
+   P.poolCV.UnLock();
+   DEBUG("key pool depth set to "<<depth);
+}
+
+/******************************************************************************/
+/*                                G e t R S A                                 */
+/******************************************************************************/
+
+RSA *XrdCryptosslKeyPool::GetRSA(int bits)
+{
+   // Get a RSA key from the pool or, if there is none, a fresh one
+   PoolState &P = Pool();
+   RSA *kRSA = 0;
+
+   P.poolCV.Lock();
+   if (P.poolDepth) {
+      unsigned int i;
+      for (i = 0; i < P.rsaPool.size(); i++)
+          if (P.rsaPool[i].bits == bits) break;
+      if (i < P.rsaPool.size()) {
+         if (!P.rsaPool[i].keys.empty()) {
+            kRSA = P.rsaPool[i].keys.front();
+            P.rsaPool[i].keys.pop_front();
+         }
+      } else if (P.rsaPool.size() < maxRSASizes) {
+         RSAPool newPool;
+         newPool.bits = bits;
+         P.rsaPool.push_back(newPool);
+      }
+      P.poolCV.Signal();
+   }
+   P.poolCV.UnLock();
+
+   return (kRSA ? kRSA : NewRSA(bits));
+}
+
+/******************************************************************************/
+/*                             G e t X 2 5 5 1 9                              */
+/******************************************************************************/
+
+EVP_PKEY *XrdCryptosslKeyPool::GetX25519()
+{
+   // Get a X25519 key pair from the pool or, if there is none, a fresh one
+   PoolState &P = Pool();
+   EVP_PKEY *pkey = 0;
+
+   P.poolCV.Lock();
+   if (P.poolDepth) {
+      if (!P.x25519Pool.empty()) {
+         pkey = P.x25519Pool.front();
+         P.x25519Pool.pop_front();
+      }
+      P.x25519Used = true;
+      P.poolCV.Signal();
+   }
+   P.poolCV.UnLock();
+
+   return (pkey ? pkey : NewX25519());
+}
+
+/******************************************************************************/
+/*                             H a s X 2 5 5 1 9                              */
+/******************************************************************************/
+
+bool XrdCryptosslKeyPool::HasX25519()
+{
+#ifdef XRDCRYPTO_X25519
+   return true;
+#else
+   return false;
+#endif
+}
+
+/******************************************************************************/
+/*                                R e f i l l                                 */
+/******************************************************************************/
+
+void *XrdCryptosslKeyPool::Refill(void *)
+{
+   // Top up every pool to the current depth, then wait for a key to be taken.
+   // Keys are generated without holding the lock. A pool is only filled once
+   // the corresponding key type has been asked for at least once.
+   PoolState &P = Pool();
+
+   P.poolCV.Lock();
+   while (1) {
+      bool added = false;
+      for (unsigned int i = 0; i < P.rsaPool.size(); i++) {
+         if ((int)P.rsaPool[i].keys.size() >= P.poolDepth) continue;
+         int bits = P.rsaPool[i].bits;
+         P.poolBusy = true;
+         P.poolCV.UnLock();
+         RSA *kRSA = NewRSA(bits);
+         P.poolCV.Lock();
+         P.poolBusy = false;
+         P.poolCV.Signal();
+         if (!kRSA) continue;
+         if ((int)P.rsaPool[i].keys.size() < P.poolDepth) {
+            P.rsaPool[i].keys.push_back(kRSA);
+            added = true;
+         } else RSA_free(kRSA);
+      }
+      if (P.x25519Used && (int)P.x25519Pool.size() < P.poolDepth) {
+         P.poolBusy = true;
+         P.poolCV.UnLock();
+         EVP_PKEY *pkey = NewX25519();
+         P.poolCV.Lock();
+         P.poolBusy = false;
+         P.poolCV.Signal();
+         if (pkey) {
+            if ((int)P.x25519Pool.size() < P.poolDepth) {
+               P.x25519Pool.push_back(pkey);
+               added = true;
+            } else EVP_PKEY_free(pkey);
+         }
+      }
+      if (!added) P.poolCV.Wait();
+   }
+   P.poolCV.UnLock();
+   return (void *)0;
+}
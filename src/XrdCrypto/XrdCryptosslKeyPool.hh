@@ -0,0 +1,70 @@
+#ifndef __CRYPTO_SSLKEYPOOL_H__
+#define __CRYPTO_SSLKEYPOOL_H__
+/******************************************************************************/
+/*                                                                            */
+/*                X r d C r y p t o s s l K e y P o o l . h h                 */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+/* ************************************************************************** */
+/*                                                                            */
+/* Pool of pre-generated key pairs for the OpenSSL crypto module              */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+
+// X25519 key agreement needs the raw key interface of OpenSSL 1.1.1
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L && defined(EVP_PKEY_X25519)
+#define XRDCRYPTO_X25519 1
+#endif
+
+// ---------------------------------------------------------------------------//
+//
+// Key pairs used only once per handshake (RSA keys for proxy requests and
+// X25519 ephemerals for the session cipher agreement) are expensive enough to
+// show up in the handshake latency. When a depth is set, a background thread
+// keeps up to 'depth' keys of each kind ready; RSA sizes are learned from the
+// requests. An empty (or disabled) pool falls back to generating inline.
+//
+// ---------------------------------------------------------------------------//
+class XrdCryptosslKeyPool
+{
+public:
+   // Set the pool depth; the refill thread is started on the first call
+   // with a positive value. A zero depth disables pooling.
+   static void      SetDepth(int depth);
+
+   // Get a RSA key of 'bits' bits with exponent 65537 (caller owns it)
+   static RSA      *GetRSA(int bits);
+
+   // Get a X25519 key pair (caller owns it); 0 if not supported
+   static EVP_PKEY *GetX25519();
+
+   // Whether X25519 key agreement is available in this build
+   static bool      HasX25519();
+
+   // Refill thread body (internal)
+   static void     *Refill(void *);
+};
+#endif
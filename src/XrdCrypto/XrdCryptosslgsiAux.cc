@@ -46,6 +46,7 @@
 #include "XrdSut/XrdSutRndm.hh"
 #include "XrdCrypto/XrdCryptogsiX509Chain.hh"
 #include "XrdCrypto/XrdCryptosslAux.hh"
+#include "XrdCrypto/XrdCryptosslKeyPool.hh"
 #include "XrdCrypto/XrdCryptosslRSA.hh"
 #include "XrdCrypto/XrdCryptosslTrace.hh"
 #include "XrdCrypto/XrdCryptosslX509.hh"
@@ -319,32 +320,15 @@ int XrdCryptosslX509CreateProxy(const char *fnc, const char *fnk,
       return -kErrPX_NoResources;
    }
    //
-   // Create the new PKI for the proxy (exponent 65537)
-   RSA *kPX = RSA_new();
+   // Create the new PKI for the proxy (exponent 65537), pre-generated if
+   // the key pool is enabled
+   RSA *kPX = XrdCryptosslKeyPool::GetRSA(bits);
    if (!kPX) {
       PRINT("proxy key could not be generated - return");
       EVP_PKEY_free(ekEEC);
       X509_free(xEEC);
       return -kErrPX_GenerateKey;
    }
-   BIGNUM *e = BN_new();
-   if (!e) {
-      PRINT("proxy key could not be generated - return");
-      RSA_free(kPX);
-      EVP_PKEY_free(ekEEC);
-      X509_free(xEEC);
-      return -kErrPX_GenerateKey;
-   }
-   BN_set_word(e, 0x10001);
-   if (RSA_generate_key_ex(kPX, bits, e, NULL) != 1) {
-      PRINT("proxy key could not be generated - return");
-      BN_free(e);
-      RSA_free(kPX);
-      EVP_PKEY_free(ekEEC);
-      X509_free(xEEC);
-      return -kErrPX_GenerateKey;
-   }
-   BN_free(e);
    //
    // Set the key into the request
    EVP_PKEY *ekPX = EVP_PKEY_new();
@@ -661,26 +645,13 @@ int XrdCryptosslX509CreateProxyReq(XrdCryptoX509 *xcpi,
    int bits = EVP_PKEY_bits(X509_get_pubkey(xpi));
    bits = (bits < 512) ? 512 : bits;
    //
-   // Create the new PKI for the proxy (exponent 65537)
-   RSA *kro = RSA_new();
+   // Create the new PKI for the proxy (exponent 65537), pre-generated if
+   // the key pool is enabled
+   RSA *kro = XrdCryptosslKeyPool::GetRSA(bits);
    if (!kro) {
       PRINT("proxy key could not be generated - return");
       return -kErrPX_GenerateKey;
    }
-   BIGNUM *e = BN_new();
-   if (!e) {
-      PRINT("proxy key could not be generated - return");
-      RSA_free(kro);
-      return -kErrPX_GenerateKey;
-   }
-   BN_set_word(e, 0x10001);
-   if (RSA_generate_key_ex(kro, bits, e, NULL) != 1) {
-      RSA_free(kro);
-      BN_free(e);
-      PRINT("proxy key could not be generated - return");
-      return -kErrPX_GenerateKey;
-   }
-   BN_free(e);
    //
    // Set the key into the request
    EVP_PKEY *ekro = EVP_PKEY_new();
@@ -32,6 +32,7 @@ add_executable(
   XrdCms/XrdCmsAdmin.cc           XrdCms/XrdCmsAdmin.hh
   XrdCms/XrdCmsBaseFS.cc          XrdCms/XrdCmsBaseFS.hh
   XrdCms/XrdCmsCache.cc           XrdCms/XrdCmsCache.hh
+  XrdCms/XrdCmsCacheSnap.cc       XrdCms/XrdCmsCacheSnap.hh
   XrdCms/XrdCmsCluster.cc         XrdCms/XrdCmsCluster.hh
   XrdCms/XrdCmsClustID.cc         XrdCms/XrdCmsClustID.hh
   XrdCms/XrdCmsConfig.cc          XrdCms/XrdCmsConfig.hh
@@ -41,6 +42,7 @@ add_executable(
   XrdCms/XrdCmsManList.cc         XrdCms/XrdCmsManList.hh
   XrdCms/XrdCmsManTree.cc         XrdCms/XrdCmsManTree.hh
   XrdCms/XrdCmsMeter.cc           XrdCms/XrdCmsMeter.hh
+  XrdCms/XrdCmsNSMap.cc           XrdCms/XrdCmsNSMap.hh
   XrdCms/XrdCmsNash.cc            XrdCms/XrdCmsNash.hh
   XrdCms/XrdCmsNode.cc            XrdCms/XrdCmsNode.hh
   XrdCms/XrdCmsPList.cc           XrdCms/XrdCmsPList.hh
@@ -51,6 +53,7 @@ add_executable(
   XrdCms/XrdCmsRRQ.cc             XrdCms/XrdCmsRRQ.hh
                                   XrdCms/XrdCmsSelect.hh
   XrdCms/XrdCmsState.cc           XrdCms/XrdCmsState.hh
+  XrdCms/XrdCmsStateQ.cc          XrdCms/XrdCmsStateQ.hh
   XrdCms/XrdCmsSupervisor.cc      XrdCms/XrdCmsSupervisor.hh
                                   XrdCms/XrdCmsTrace.hh )
 target_link_libraries(
@@ -27,6 +27,8 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <errno.h>
+
 #include "XrdFfs/XrdFfsDent.hh"
 
 #ifdef __cplusplus
@@ -265,6 +267,182 @@ void XrdFfsDent_cache_destroy()
         XrdFfsDent_dentcache_free(&XrdFfsDentCaches[i]);
 }
 
+/* 
+   managing caches for file attributes. Entries are keyed by the path seen
+   by FUSE and hold either a stat() result or the fact that the path does
+   not exist (errno ENOENT). They are filled by _getattr() and by _readdir()
+   when the data servers return the stat info along with the directory list.
+   Each hash bucket keeps at most XrdFfsDent_NATTRCHAIN entries, so the 
+   cache stays bounded without a separate purging thread.
+ */
+
+struct XrdFfsDentattr {
+    char *path;
+    time_t t0;
+    int nofile;
+    struct stat stbuf;
+    struct XrdFfsDentattr *next;
+};
+
+#define XrdFfsDent_NATTRSLOTS 4096
+#define XrdFfsDent_NATTRCHAIN 8
+struct XrdFfsDentattr *XrdFfsDentAttrs[XrdFfsDent_NATTRSLOTS];
+pthread_mutex_t XrdFfsDentAttrs_mutex = PTHREAD_MUTEX_INITIALIZER;
+int XrdFfsDentAttrs_life = 0;
+int XrdFfsDentAttrs_neglife = 0;
+
+unsigned int XrdFfsDent_attr_hash(const char *path)
+{
+    unsigned int h = 5381;
+    while (*path) h = h * 33 + (unsigned char)*path++;
+    return h % XrdFfsDent_NATTRSLOTS;
+}
+
+void XrdFfsDent_attr_free(struct XrdFfsDentattr *a)
+{
+    free(a->path);
+    free(a);
+}
+
+/* life and neglife are in seconds. A life of 0 disables the cache */
+void XrdFfsDent_attr_init(int life, int neglife)
+{
+    XrdFfsDentAttrs_life = (life > 0 ? life : 0);
+    XrdFfsDentAttrs_neglife = (neglife > 0 ? neglife : 0);
+}
+
+int XrdFfsDent_attr_enabled()
+{
+    return (XrdFfsDentAttrs_life > 0);
+}
+
+void XrdFfsDent_attr_put(const char *path, struct stat *stbuf, int nofile)
+{
+    struct XrdFfsDentattr *a, **pp;
+    unsigned int h;
+    int n = 0;
+
+    if (XrdFfsDentAttrs_life <= 0 || (nofile && XrdFfsDentAttrs_neglife <= 0)) return;
+
+    h = XrdFfsDent_attr_hash(path);
+    pthread_mutex_lock(&XrdFfsDentAttrs_mutex);
+    pp = &XrdFfsDentAttrs[h];
+    while ((a = *pp) != NULL)   // remove the old entry of this path
+        if (!strcmp(a->path, path))
+        {
+            *pp = a->next;
+            XrdFfsDent_attr_free(a);
+            break;
+        }
+        else pp = &a->next;
+
+    a = (struct XrdFfsDentattr*) malloc(sizeof(struct XrdFfsDentattr));
+    a->path = strdup(path);
+    a->t0 = time(NULL);
+    a->nofile = nofile;
+    if (stbuf != NULL) memcpy(&a->stbuf, stbuf, sizeof(struct stat));
+    else memset(&a->stbuf, 0, sizeof(struct stat));
+    a->next = XrdFfsDentAttrs[h];
+    XrdFfsDentAttrs[h] = a;
+
+    pp = &XrdFfsDentAttrs[h];  // keep the chain short, oldest entries are at the end
+    while ((a = *pp) != NULL && ++n <= XrdFfsDent_NATTRCHAIN) pp = &a->next;
+    *pp = NULL;
+    while (a != NULL)
+    {
+        struct XrdFfsDentattr *t = a->next;
+        XrdFfsDent_attr_free(a);
+        a = t;
+    }
+    pthread_mutex_unlock(&XrdFfsDentAttrs_mutex);
+}
+
+void XrdFfsDent_attr_fill(const char *path, struct stat *stbuf)
+{
+    XrdFfsDent_attr_put(path, stbuf, 0);
+}
+
+void XrdFfsDent_attr_nofile(const char *path)
+{
+    XrdFfsDent_attr_put(path, NULL, 1);
+}
+
+/*
+   _search() returns 1 and fills *stbuf if the path is cached, -1 with 
+   errno = ENOENT if the path is known not to exist, and 0 otherwise.
+ */
+int XrdFfsDent_attr_search(const char *path, struct stat *stbuf)
+{
+    struct XrdFfsDentattr *a, **pp;
+    unsigned int h;
+    int rval = 0;
+    time_t t1;
+
+    if (XrdFfsDentAttrs_life <= 0) return 0;
+
+    h = XrdFfsDent_attr_hash(path);
+    t1 = time(NULL);
+    pthread_mutex_lock(&XrdFfsDentAttrs_mutex);
+    pp = &XrdFfsDentAttrs[h];
+    while ((a = *pp) != NULL)
+    {
+        if (!strcmp(a->path, path))
+        {
+            if ((t1 - a->t0) >= (a->nofile ? XrdFfsDentAttrs_neglife : XrdFfsDentAttrs_life))
+            {
+                *pp = a->next;
+                XrdFfsDent_attr_free(a);
+            }
+            else if (a->nofile)
+            {
+                errno = ENOENT;
+                rval = -1;
+            }
+            else
+            {
+                memcpy(stbuf, &a->stbuf, sizeof(struct stat));
+                rval = 1;
+            }
+            break;
+        }
+        pp = &a->next;
+    }
+    pthread_mutex_unlock(&XrdFfsDentAttrs_mutex);
+    return rval;
+}
+
+/* _del() removes the path and its parent directory, whose mtime is changing too */
+void XrdFfsDent_attr_del(const char *path)
+{
+    struct XrdFfsDentattr *a, **pp;
+    char *p, *q;
+    int i;
+
+    if (XrdFfsDentAttrs_life <= 0) return;
+
+    p = strdup(path);
+    for (i = 0; i < 2; i++)
+    {
+        unsigned int h = XrdFfsDent_attr_hash(p);
+        pthread_mutex_lock(&XrdFfsDentAttrs_mutex);
+        pp = &XrdFfsDentAttrs[h];
+        while ((a = *pp) != NULL)
+            if (!strcmp(a->path, p))
+            {
+                *pp = a->next;
+                XrdFfsDent_attr_free(a);
+                break;
+            }
+            else pp = &a->next;
+        pthread_mutex_unlock(&XrdFfsDentAttrs_mutex);
+
+        if ((q = strrchr(p, '/')) == NULL) break;
+        if (q == p) q[1] = '\0';
+        else q[0] = '\0';
+    }
+    free(p);
+}
+
 /*
 #include <stdio.h>
 
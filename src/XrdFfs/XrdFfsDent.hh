@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include <pthread.h>
+#include <sys/stat.h>
 
 #ifdef __cplusplus
   extern "C" {
@@ -51,6 +52,15 @@ void XrdFfsDent_cache_destroy();
 int  XrdFfsDent_cache_fill(char *dname, char ***dnarray, int nents);
 int  XrdFfsDent_cache_search(char *dname, char *dentname);
 
+/* path keyed cache of stat() results, including non-existing entries */
+
+void XrdFfsDent_attr_init(int life, int neglife);
+int  XrdFfsDent_attr_enabled();
+void XrdFfsDent_attr_fill(const char *path, struct stat *stbuf);
+void XrdFfsDent_attr_nofile(const char *path);
+int  XrdFfsDent_attr_search(const char *path, struct stat *stbuf);
+void XrdFfsDent_attr_del(const char *path);
+
 #ifdef __cplusplus
   }
 #endif
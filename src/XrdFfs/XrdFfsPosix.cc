@@ -47,7 +47,10 @@
 #include <stdlib.h>
 #include <syslog.h>
 #include "XrdFfs/XrdFfsPosix.hh"
+#include "XrdPosix/XrdPosixMap.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
+#include "XrdCl/XrdClFileSystem.hh"
+#include "XrdCl/XrdClURL.hh"
 #include "XrdFfs/XrdFfsMisc.hh"
 #include "XrdFfs/XrdFfsDent.hh"
 #include "XrdFfs/XrdFfsQueue.hh"
@@ -409,6 +412,7 @@ int XrdFfsPosix_truncateall(const char *rdrurl, const char *path, off_t size, ui
 
 struct XrdFfsPosixX_readdirall_args {
     char *url;
+    const char *path;
     int *res;
     int *err;
     struct XrdFfsDentnames **dents;
@@ -423,12 +427,76 @@ struct XrdFfsPosixX_readdirall_args {
    because FUSE's _getattr will test the existance of the dir
    so we know that at least one data server has the directory.
  */
+/*
+   When the attribute cache is enabled, list the directory with kXR_dstat so
+   that the data server returns the stat info of each entry along with its
+   name (the "readdir plus"). The following ls -l then finds the attributes 
+   in the cache instead of issuing one stat() per entry to every data server.
+ */
+void XrdFfsPosix_x_readdirplus(struct XrdFfsPosixX_readdirall_args *args)
+{
+    XrdCl::URL url((std::string)args->url);
+    XrdCl::FileSystem fs(url);
+    XrdCl::DirectoryList *dList = 0;
+    XrdCl::XRootDStatus xStatus;
+    static uid_t myUID = getuid();
+    static gid_t myGID = getgid();
+    char path[MAXROOTURLLEN];
+    struct stat stbuf;
+    size_t plen;
+
+    xStatus = fs.DirList(url.GetPathWithParams(), XrdCl::DirListFlags::Stat, dList);
+    if (!xStatus.IsOK())
+    {
+        *(args->res) = XrdPosixMap::Result(xStatus);
+        *(args->err) = errno;
+        delete dList;
+        return;
+    }
+
+    path[0] = '\0';
+    strncat(path, args->path, MAXROOTURLLEN - 2);
+    plen = strlen(path);
+    if (plen == 0 || path[plen-1] != '/') path[plen++] = '/';
+
+    *(args->res) = 0;
+    for (XrdCl::DirectoryList::Iterator it = dList->Begin(); it != dList->End(); ++it)
+    {
+        const char *name = (*it)->GetName().c_str();
+        XrdCl::StatInfo *sInfo = (*it)->GetStatInfo();
+
+        XrdFfsDent_names_add(args->dents, (char*)name);
+        if (sInfo == NULL || plen + strlen(name) >= MAXROOTURLLEN) continue;
+
+        memset(&stbuf, 0, sizeof(struct stat));
+        stbuf.st_blksize = 64*1024;
+        stbuf.st_nlink   = 1;
+        stbuf.st_uid     = myUID;
+        stbuf.st_gid     = myGID;
+        stbuf.st_mode    = XrdPosixMap::Flags2Mode(&stbuf.st_rdev, sInfo->GetFlags());
+        stbuf.st_size    = sInfo->GetSize();
+        stbuf.st_blocks  = stbuf.st_size/512+1;
+        stbuf.st_atime   = stbuf.st_mtime = stbuf.st_ctime = sInfo->GetModTime();
+        stbuf.st_ino     = strtoll(sInfo->GetId().c_str(), 0, 10);
+
+        strcpy(path + plen, name);
+        XrdFfsDent_attr_fill(path, &stbuf);
+    }
+    delete dList;
+}
+
 void* XrdFfsPosix_x_readdirall(void* x)
 {
     struct XrdFfsPosixX_readdirall_args *args = (struct XrdFfsPosixX_readdirall_args*) x;
     DIR *dp;
     struct dirent *de;
 
+    if (XrdFfsDent_attr_enabled())
+    {
+        XrdFfsPosix_x_readdirplus(args);
+        return NULL;
+    }
+
 /*
    Xrootd's Opendir will not return NULL even under some error. For instance,
    when it is supposed to return ENOENT or ENOTDIR, it actually returns 
@@ -491,6 +559,7 @@ int XrdFfsPosix_readdirall(const char *rdrurl, const char *path, char*** direnta
         strncat(newurls[i], path,  MAXROOTURLLEN - strlen(newurls[i]) -1);
         XrdFfsMisc_xrd_secsss_editurl(newurls[i], user_uid, 0);
         args[i].url = newurls[i];
+        args[i].path = path;
         args[i].err = &errno_i[i];
         args[i].res = &res_i[i];
         args[i].dents = &dir_i[i];
@@ -750,6 +819,10 @@ int XrdFfsPosix_statall(const char *rdrurl, const char *path, struct stat *stbuf
 
     char *p1, *p2, *dir, *file, rootpath[MAXROOTURLLEN];
 
+// the attributes may have been cached by an earlier _statall() or _readdirall()
+    res = XrdFfsDent_attr_search(path, stbuf);
+    if (res != 0) return (res > 0 ? 0 : -1);
+
     rootpath[0] = '\0';
     strncat(rootpath,rdrurl, MAXROOTURLLEN - strlen(rootpath) -1);
     strncat(rootpath,path,  MAXROOTURLLEN - strlen(rootpath) -1);
@@ -770,6 +843,7 @@ int XrdFfsPosix_statall(const char *rdrurl, const char *path, struct stat *stbuf
          {
              free(p1);
              free(p2);
+             XrdFfsDent_attr_fill(path, stbuf);
              return 0;
          }
     }
@@ -818,6 +892,8 @@ int XrdFfsPosix_statall(const char *rdrurl, const char *path, struct stat *stbuf
     for (i = 0; i < nurls; i++)
         free(newurls[i]);
 
+    if (res == 0) XrdFfsDent_attr_fill(path, stbuf);
+    else if (errno == ENOENT) XrdFfsDent_attr_nofile(path);
     return res;
 }
 
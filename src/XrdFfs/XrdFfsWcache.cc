@@ -25,7 +25,6 @@
 /* The copyright holder's institutional names and contributor's names may not */
 /* be used to endorse or promote products derived from this software without  */
 /* specific prior written permission of the institution or contributor.       */
-/******************************************************************************/
 
 /* 
    When direct_io is not used, kernel will break large write to 4Kbyte  
@@ -35,6 +34,15 @@
    Note that fuse 2.8.0 pre2 or above and kernel 2.6.27 or above provide
    a big_writes option to allow > 4KByte writing. It will make this 
    smiple write caching obsolete. 
+
+   Even with big_writes each write still waits for a round trip to the data
+   server. The buffer size can therefore be raised to several MBytes, and 
+   full buffers can be written behind, asynchronously, with up to 
+   XrdFfsWcacheNflights writes in flight per file. Errors of those writes 
+   are reported by the next XrdFfsWcache_pwrite() or XrdFfsWcache_flush(). 
+   The memory used by all buffers, resident or in flight, is bounded by 
+   XrdFfsWcacheMaxmem (0 means no limit); a file that can not get a buffer
+   writes through to the data server instead.
 */
 #define XrdFfsWcacheBufsize 131072
 
@@ -57,6 +65,8 @@
 #include "XrdFfs/XrdFfsWcache.hh"
 #ifndef NOXRD
     #include "XrdFfs/XrdFfsPosix.hh"
+    #include "XrdPosix/XrdPosixCallBack.hh"
+    #include "XrdPosix/XrdPosixXrootd.hh"
 #endif
 
 #ifdef __cplusplus
@@ -68,6 +78,8 @@ struct XrdFfsWcacheFilebuf {
     size_t len;
     char *buf;
     pthread_mutex_t *mlock;
+    int nflights;  /* number of asynchronous writes in flight */
+    int error;     /* errno of the first failed asynchronous write */
 };
 
 struct XrdFfsWcacheFilebuf *XrdFfsWcacheFbufs;
@@ -75,6 +87,17 @@ struct XrdFfsWcacheFilebuf *XrdFfsWcacheFbufs;
 /* #include "xrdposix.h" */
 
 int XrdFfsPosix_baseFD, XrdFfsWcacheNFILES;
+
+size_t XrdFfsWcacheBsize = XrdFfsWcacheBufsize;
+int XrdFfsWcacheNflights = 0;
+long long XrdFfsWcacheMaxmem = 0;
+
+/* the following are protected by XrdFfsWcacheIO_mutex */
+long long XrdFfsWcacheMemused = 0;
+int XrdFfsWcacheAllflights = 0;
+pthread_mutex_t XrdFfsWcacheIO_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t XrdFfsWcacheIO_cond = PTHREAD_COND_INITIALIZER;
+
 void XrdFfsWcache_init(int basefd, int maxfd)
 {
     int fd;
@@ -99,11 +122,158 @@ void XrdFfsWcache_init(int basefd, int maxfd)
         XrdFfsWcacheFbufs[fd].len = 0;
         XrdFfsWcacheFbufs[fd].buf = NULL;
         XrdFfsWcacheFbufs[fd].mlock = NULL;
+        XrdFfsWcacheFbufs[fd].nflights = 0;
+        XrdFfsWcacheFbufs[fd].error = 0;
+    }
+}
+
+/* 
+   convert NNN[k|m|g] to bytes, returns -1 if the string is not valid 
+ */
+long long XrdFfsWcache_a2sz(const char *s)
+{
+    char *eP;
+    long long n;
+
+    if (s == NULL || *s == '\0') return -1;
+    n = strtoll(s, &eP, 10);
+    if (n < 0) return -1;
+    switch (*eP)
+    {
+        case 'g': case 'G': n *= 1024;
+             /* fall through */
+        case 'm': case 'M': n *= 1024;
+             /* fall through */
+        case 'k': case 'K': n *= 1024; eP++;
+             break;
+        default: break;
+    }
+    return (*eP == '\0' ? n : -1);
+}
+
+int XrdFfsWcache_config(const char *bufsize, int nflights, const char *maxmem)
+/* Set the size of the per file buffer, the number of asynchronous writes
+ * per file and the memory limit of all buffers. Must be called before any 
+ * file is created. 
+ *
+ * returns: 1 - ok
+ *          0 - error, an invalid value (errno = EINVAL)
+ */
+{
+    long long n;
+
+    if (bufsize != NULL)
+    {
+        if ((n = XrdFfsWcache_a2sz(bufsize)) < 4096 || n > 1024*1024*1024)
+        {
+            errno = EINVAL;
+            return 0;
+        }
+        XrdFfsWcacheBsize = (size_t)n;
+    }
+    if (maxmem != NULL)
+    {
+        if ((n = XrdFfsWcache_a2sz(maxmem)) < 0)
+        {
+            errno = EINVAL;
+            return 0;
+        }
+        XrdFfsWcacheMaxmem = n;
     }
+    XrdFfsWcacheNflights = (nflights > 0 ? nflights : 0);
+    return 1;
+}
+
+/* 
+   _getmem() accounts for a buffer. If wait is set and the memory limit is 
+   reached, it waits for writes in flight to release memory. Must be called 
+   with XrdFfsWcacheIO_mutex held. returns 1 if the buffer can be used.
+ */
+int XrdFfsWcache_getmem(int wait)
+{
+    while (XrdFfsWcacheMaxmem > 0 && XrdFfsWcacheMemused + (long long)XrdFfsWcacheBsize > XrdFfsWcacheMaxmem)
+    {
+        if (!wait || XrdFfsWcacheAllflights == 0) return 0;
+        pthread_cond_wait(&XrdFfsWcacheIO_cond, &XrdFfsWcacheIO_mutex);
+    }
+    XrdFfsWcacheMemused += XrdFfsWcacheBsize;
+    return 1;
+}
+
+void XrdFfsWcache_putmem(char *buf)
+{
+    pthread_mutex_lock(&XrdFfsWcacheIO_mutex);
+    XrdFfsWcacheMemused -= XrdFfsWcacheBsize;
+    pthread_cond_broadcast(&XrdFfsWcacheIO_cond);
+    pthread_mutex_unlock(&XrdFfsWcacheIO_mutex);
+    free(buf);
 }
 
+/*
+   _drain() waits for all writes in flight on the file and returns the error 
+   any of them had (and clears it) in errno, -1 on error and 0 otherwise.
+ */
+int XrdFfsWcache_drain(int fd)
+{
+    int rc = 0;
+
+    if (XrdFfsWcacheNflights == 0) return 0;
+
+    pthread_mutex_lock(&XrdFfsWcacheIO_mutex);
+    while (XrdFfsWcacheFbufs[fd].nflights > 0)
+        pthread_cond_wait(&XrdFfsWcacheIO_cond, &XrdFfsWcacheIO_mutex);
+    if (XrdFfsWcacheFbufs[fd].error)
+    {
+        errno = XrdFfsWcacheFbufs[fd].error;
+        XrdFfsWcacheFbufs[fd].error = 0;
+        rc = -1;
+    }
+    pthread_mutex_unlock(&XrdFfsWcacheIO_mutex);
+    return rc;
+}
+
+#ifdef __cplusplus
+  }
+#endif
+
+#ifndef NOXRD
+/* 
+   one asynchronous write of a full buffer. It owns the buffer and deletes 
+   itself when the write completes. 
+ */
+class XrdFfsWcacheFlight : public XrdPosixCallBackIO
+{
+public:
+
+void Complete(ssize_t Result)
+     {pthread_mutex_lock(&XrdFfsWcacheIO_mutex);
+      if (Result != (ssize_t)len && !XrdFfsWcacheFbufs[fd].error)
+          XrdFfsWcacheFbufs[fd].error = (Result < 0 && errno ? errno : EIO);
+      XrdFfsWcacheFbufs[fd].nflights--;
+      XrdFfsWcacheAllflights--;
+      pthread_mutex_unlock(&XrdFfsWcacheIO_mutex);
+      XrdFfsWcache_putmem(buf);
+      delete this;
+     }
+
+     XrdFfsWcacheFlight(int fdx, char *bp, size_t blen)
+                       : fd(fdx), buf(bp), len(blen) {}
+    ~XrdFfsWcacheFlight() {}
+
+private:
+int     fd;
+char   *buf;
+size_t  len;
+};
+#endif
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
 int XrdFfsWcache_create(int fd)
-/* Create a write cache buffer for a given file descriptor
+/* Create a write cache buffer for a given file descriptor. The buffer 
+ * itself is allocated by the first write that needs it.
  *
  * fd:      file descriptor
  *
@@ -116,9 +286,8 @@ int XrdFfsWcache_create(int fd)
 
     XrdFfsWcacheFbufs[fd].offset = 0;
     XrdFfsWcacheFbufs[fd].len = 0;
-    XrdFfsWcacheFbufs[fd].buf = (char*)malloc(XrdFfsWcacheBufsize);
-    if (XrdFfsWcacheFbufs[fd].buf == NULL)
-        return 0;
+    XrdFfsWcacheFbufs[fd].buf = NULL;
+    XrdFfsWcacheFbufs[fd].error = 0;
     XrdFfsWcacheFbufs[fd].mlock = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
     if (XrdFfsWcacheFbufs[fd].mlock == NULL)
         return 0;
@@ -133,10 +302,11 @@ void XrdFfsWcache_destroy(int fd)
 /*  XrdFfsWcache_flush(fd); */
     fd -= XrdFfsPosix_baseFD;
 
+    XrdFfsWcache_drain(fd);
     XrdFfsWcacheFbufs[fd].offset = 0;
     XrdFfsWcacheFbufs[fd].len = 0;
     if (XrdFfsWcacheFbufs[fd].buf != NULL) 
-        free(XrdFfsWcacheFbufs[fd].buf);
+        XrdFfsWcache_putmem(XrdFfsWcacheFbufs[fd].buf);
     XrdFfsWcacheFbufs[fd].buf = NULL;
     if (XrdFfsWcacheFbufs[fd].mlock != NULL)
     {
@@ -146,14 +316,60 @@ void XrdFfsWcache_destroy(int fd)
     XrdFfsWcacheFbufs[fd].mlock = NULL;
 }
 
-ssize_t XrdFfsWcache_flush(int fd)
+/*
+   _writeout() writes the buffer to the data server, behind the application 
+   if asynchronous writes are enabled and a new buffer is available. Must be 
+   called with the file's mlock held.
+ */
+ssize_t XrdFfsWcache_writeout(int fd, int async)
 {
     ssize_t rc;
-    fd -= XrdFfsPosix_baseFD;
+    char *nbuf = NULL;
 
     if (XrdFfsWcacheFbufs[fd].len == 0 || XrdFfsWcacheFbufs[fd].buf == NULL )
         return 0;
 
+#ifndef NOXRD
+    if (async && XrdFfsWcacheNflights > 0)
+    {
+        pthread_mutex_lock(&XrdFfsWcacheIO_mutex);
+        while (XrdFfsWcacheFbufs[fd].nflights >= XrdFfsWcacheNflights)
+            pthread_cond_wait(&XrdFfsWcacheIO_cond, &XrdFfsWcacheIO_mutex);
+        if (XrdFfsWcacheFbufs[fd].error)
+        {
+            errno = XrdFfsWcacheFbufs[fd].error;
+            XrdFfsWcacheFbufs[fd].error = 0;
+            pthread_mutex_unlock(&XrdFfsWcacheIO_mutex);
+            return -1;
+        }
+        if (XrdFfsWcache_getmem(1))
+        {
+            if ((nbuf = (char*)malloc(XrdFfsWcacheBsize)) != NULL)
+            {
+                XrdFfsWcacheFbufs[fd].nflights++;
+                XrdFfsWcacheAllflights++;
+            }
+            else XrdFfsWcacheMemused -= XrdFfsWcacheBsize;
+        }
+        pthread_mutex_unlock(&XrdFfsWcacheIO_mutex);
+
+        if (nbuf != NULL)
+        {
+            XrdFfsWcacheFlight *wP = new XrdFfsWcacheFlight(fd, XrdFfsWcacheFbufs[fd].buf, 
+                                                            XrdFfsWcacheFbufs[fd].len);
+            rc = XrdFfsWcacheFbufs[fd].len;
+            XrdPosixXrootd::Pwrite(fd + XrdFfsPosix_baseFD, XrdFfsWcacheFbufs[fd].buf,
+                                   XrdFfsWcacheFbufs[fd].len, XrdFfsWcacheFbufs[fd].offset, wP);
+            XrdFfsWcacheFbufs[fd].buf = nbuf;
+            XrdFfsWcacheFbufs[fd].offset = 0;
+            XrdFfsWcacheFbufs[fd].len = 0;
+            return rc;
+        }
+    }
+#endif
+
+/* synchronous write, after those in flight so that errors come in order */
+    if (XrdFfsWcache_drain(fd) < 0) return -1;
     rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, 
                             XrdFfsWcacheFbufs[fd].buf, XrdFfsWcacheFbufs[fd].len, XrdFfsWcacheFbufs[fd].offset);
     if (rc > 0)
@@ -164,6 +380,27 @@ ssize_t XrdFfsWcache_flush(int fd)
     return rc;
 }
 
+ssize_t XrdFfsWcache_flush(int fd)
+/* Write out the buffer and wait for all asynchronous writes of the file.
+ *
+ * returns: >= 0 - ok
+ *          -1   - error, error code in errno. This may be the error of an 
+ *                 earlier asynchronous write.
+ */
+{
+    ssize_t rc;
+    fd -= XrdFfsPosix_baseFD;
+
+    if (fd < 0 || fd >= XrdFfsWcacheNFILES || XrdFfsWcacheFbufs[fd].mlock == NULL)
+        return 0;
+
+    pthread_mutex_lock(XrdFfsWcacheFbufs[fd].mlock);
+    rc = XrdFfsWcache_writeout(fd, 0);
+    if (rc >= 0 && XrdFfsWcache_drain(fd) < 0) rc = -1;
+    pthread_mutex_unlock(XrdFfsWcacheFbufs[fd].mlock);
+    return rc;
+}
+
 ssize_t XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset)
 {
     ssize_t rc;
@@ -176,8 +413,10 @@ ssize_t XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset)
     }
 
 /* do not use caching under these cases */
-    if (len > XrdFfsWcacheBufsize/2 || fd >= XrdFfsWcacheNFILES)
+    if (len > XrdFfsWcacheBsize/2 || fd >= XrdFfsWcacheNFILES)
     {
+        if (fd < XrdFfsWcacheNFILES && XrdFfsWcache_flush(fd + XrdFfsPosix_baseFD) < 0)
+            return -1;
         rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
         return rc;
     }
@@ -190,17 +429,40 @@ ssize_t XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset)
    2. adding new data will exceed the current buffer 
 */ 
     if (offset != (off_t)(XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheFbufs[fd].len) ||
-        (off_t)(offset + len) > (XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheBufsize))
-        rc = XrdFfsWcache_flush(fd + XrdFfsPosix_baseFD);
+        (off_t)(offset + len) > (off_t)(XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheBsize))
+        rc = XrdFfsWcache_writeout(fd, 1);
 
-    errno = 0;
     if (rc < 0) 
     {
-        errno = ENOSPC;
+        if (XrdFfsWcacheNflights == 0) errno = ENOSPC;
         pthread_mutex_unlock(XrdFfsWcacheFbufs[fd].mlock);
         return -1;
     }
 
+/* get a buffer if the file doesn't have one, or write through if none is left */
+    if (XrdFfsWcacheFbufs[fd].buf == NULL)
+    {
+        pthread_mutex_lock(&XrdFfsWcacheIO_mutex);
+        rc = XrdFfsWcache_getmem(0);
+        pthread_mutex_unlock(&XrdFfsWcacheIO_mutex);
+        if (rc) XrdFfsWcacheFbufs[fd].buf = (char*)malloc(XrdFfsWcacheBsize);
+        if (XrdFfsWcacheFbufs[fd].buf == NULL)
+        {
+            if (rc)
+            {
+                pthread_mutex_lock(&XrdFfsWcacheIO_mutex);
+                XrdFfsWcacheMemused -= XrdFfsWcacheBsize;
+                pthread_mutex_unlock(&XrdFfsWcacheIO_mutex);
+            }
+            if (XrdFfsWcache_drain(fd) < 0) rc = -1;
+            else rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
+            pthread_mutex_unlock(XrdFfsWcacheFbufs[fd].mlock);
+            return rc;
+        }
+        XrdFfsWcacheFbufs[fd].len = 0;
+    }
+
+    errno = 0;
     bufptr = &XrdFfsWcacheFbufs[fd].buf[XrdFfsWcacheFbufs[fd].len];
     memcpy(bufptr, buf, len);
     if (XrdFfsWcacheFbufs[fd].len == 0)
@@ -32,6 +32,7 @@
 #endif
 
 void    XrdFfsWcache_init(int basefd, int maxfd);
+int     XrdFfsWcache_config(const char *bufsize, int nflights, const char *maxmem);
 int     XrdFfsWcache_create(int fd);
 void    XrdFfsWcache_destroy(int fd);
 ssize_t  XrdFfsWcache_flush(int fd);
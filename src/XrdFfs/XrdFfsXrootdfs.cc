@@ -64,7 +64,7 @@
 #include "XrdFfs/XrdFfsMisc.hh"
 #include "XrdFfs/XrdFfsWcache.hh"
 #include "XrdFfs/XrdFfsQueue.hh"
-//#include "XrdFfs/XrdFfsDent.hh"
+#include "XrdFfs/XrdFfsDent.hh"
 #include "XrdFfs/XrdFfsFsinfo.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 
@@ -80,12 +80,17 @@ struct XROOTDFS {
     bool ofsfwd;
     int  nworkers;
     int  maxfd;
+    int  attrcache;
+    int  negcache;
+    char *wcachesize;
+    int  wcacheasync;
+    char *wcachemem;
 };
 
 int cwdfd; // File descript of the initial working dir
 
 struct XROOTDFS xrootdfs;
-static struct fuse_opt xrootdfs_opts[14];
+static struct fuse_opt xrootdfs_opts[19];
 
 enum { OPT_KEY_HELP, OPT_KEY_SECSSS, };
 
@@ -128,6 +133,7 @@ static void* xrootdfs_init(struct fuse_conn_info *conn)
     XrdPosixXrootd *abc = new XrdPosixXrootd(-xrootdfs.maxfd);
     XrdFfsMisc_xrd_init(xrootdfs.rdr,xrootdfs.urlcachelife,0);
     XrdFfsWcache_init(abc->fdOrigin(), xrootdfs.maxfd);
+    XrdFfsDent_attr_init(xrootdfs.attrcache, xrootdfs.negcache);
 /*
    From FAQ:
       Miscellaneous threads should be started from the init() method.
@@ -373,6 +379,8 @@ static int xrootdfs_do_create(const char *path, const char *url, int oflags, boo
     if (use_link_id)
         p_link_id = &link_id;
 
+    XrdFfsDent_attr_del(path);
+
     XrdFfsMisc_xrd_secsss_register(fuse_get_context()->uid, fuse_get_context()->gid, p_link_id);
     strncat(rootpath, url, MAXROOTURLLEN - strlen(rootpath) - 1);
     strncat(rootpath, path, MAXROOTURLLEN - strlen(rootpath) - 1);
@@ -454,6 +462,8 @@ static int xrootdfs_mkdir(const char *path, mode_t mode)
 {
     int res;
     char rootpath[1024];
+
+    XrdFfsDent_attr_del(path);
 /*  
     Posix Mkdir() fails on the current version of Xrootd, 20071101-0808p1 
     So we avoid doing that. This is fixed in CVS head version.
@@ -493,6 +503,7 @@ static int xrootdfs_unlink(const char *path)
     int res;
     char rootpath[MAXROOTURLLEN];
 
+    XrdFfsDent_attr_del(path);
     rootpath[0]='\0';
     strncat(rootpath,xrootdfs.rdr, MAXROOTURLLEN - strlen(rootpath) -1);
     strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
@@ -529,6 +540,7 @@ static int xrootdfs_rmdir(const char *path)
 //  struct stat stbuf;
     char rootpath[MAXROOTURLLEN];
 
+    XrdFfsDent_attr_del(path);
     rootpath[0]='\0';
     strncat(rootpath,xrootdfs.rdr, MAXROOTURLLEN - strlen(rootpath) -1);
     strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
@@ -589,6 +601,8 @@ static int xrootdfs_rename(const char *from, const char *to)
     char from_path[MAXROOTURLLEN], to_path[MAXROOTURLLEN];
     struct stat stbuf;
 
+    XrdFfsDent_attr_del(from);
+    XrdFfsDent_attr_del(to);
     from_path[0]='\0';
     strncat(from_path, xrootdfs.rdr, MAXROOTURLLEN - strlen(from_path) -1);
     strncat(from_path, from, MAXROOTURLLEN - strlen(from_path) -1);
@@ -683,6 +697,7 @@ static int xrootdfs_ftruncate(const char *path, off_t size,
     int fd, res;
 //  char rootpath[1024];
                                                                                                                                            
+    XrdFfsDent_attr_del(path);
     fd = (int) fi->fh;
     XrdFfsWcache_flush(fd);
     res = XrdFfsPosix_ftruncate(fd, size);
@@ -712,6 +727,7 @@ static int xrootdfs_truncate(const char *path, off_t size)
     int res;
     char rootpath[MAXROOTURLLEN];
 
+    XrdFfsDent_attr_del(path);
     rootpath[0]='\0';
     strncat(rootpath,xrootdfs.rdr, MAXROOTURLLEN - strlen(rootpath) -1);
     strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
@@ -888,6 +904,14 @@ static int xrootdfs_statfs(const char *path, struct statvfs *stbuf)
  */
 }
 
+static int xrootdfs_flush(const char *path, struct fuse_file_info *fi)
+{
+/* called on each close(), report errors of asynchronous writes here */
+    if (XrdFfsWcache_flush((int) fi->fh) < 0)
+        return -errno;
+    return 0;
+}
+
 static int xrootdfs_release(const char *path, struct fuse_file_info *fi)
 {
     /* Just a stub.  This method is optional and can safely be left
@@ -902,6 +926,7 @@ static int xrootdfs_release(const char *path, struct fuse_file_info *fi)
     XrdFfsWcache_destroy(fd);
     XrdFfsPosix_close(fd);
     fi->fh = 0;
+    if ((fi->flags & O_ACCMODE) != O_RDONLY) XrdFfsDent_attr_del(path);
 /* 
    Return at here because the current version of Cluster Name Space daemon 
    doesn't implement the 'truncate' functon we originally planned.
@@ -989,8 +1014,8 @@ static int xrootdfs_fsync(const char *path, int isdatasync,
     int fd;
 
     fd = (int) fi->fh;
-    XrdFfsWcache_flush(fd);
-    XrdFfsPosix_fsync(fd);
+    if (XrdFfsWcache_flush(fd) < 0 || XrdFfsPosix_fsync(fd) < 0)
+        return -errno;
     return 0;
 }
 
@@ -1242,6 +1267,11 @@ static void xrootdfs_usage(const char *progname)
 "    -o maxfd=N               number of virtual file descriptors for posix requests, default 8192 (min 2048)\n"
 "    -o nworkers=N            number of workers to handle parallel requests to data servers, default 4\n"
 "    -o fastls=RDR            set to RDR when CNS is presented will cause stat() to go to redirector\n"
+"    -o attrcache=N           cache file attributes for N seconds, readdir also fetches them, default 0 (off)\n"
+"    -o negcache=N            with attrcache, remember non-existing files for N seconds, default 5\n"
+"    -o wcachesize=NNN[k/m]   size of the write cache of each open file, default 128k\n"
+"    -o wcacheasync=N         write up to N full write caches per file behind the application, default 0\n"
+"    -o wcachemem=NNN[k/m/g]  limit the memory of all write caches, default 0 (no limit)\n"
 "\n", progname);
 }
 
@@ -1294,6 +1324,7 @@ int main(int argc, char *argv[])
     xrootdfs_oper.read		= xrootdfs_read;
     xrootdfs_oper.write		= xrootdfs_write;
     xrootdfs_oper.statfs	= xrootdfs_statfs;
+    xrootdfs_oper.flush		= xrootdfs_flush;
     xrootdfs_oper.release	= xrootdfs_release;
     xrootdfs_oper.fsync		= xrootdfs_fsync;
     xrootdfs_oper.setxattr	= xrootdfs_setxattr;
@@ -1377,7 +1408,29 @@ int main(int argc, char *argv[])
     xrootdfs_opts[12].offset = offsetof(struct XROOTDFS, maxfd);
     xrootdfs_opts[12].value = 0;
 
-    xrootdfs_opts[13].templ = NULL;
+/* life time of cached file attributes and of non-existing entries */
+    xrootdfs_opts[13].templ = "attrcache=%d";
+    xrootdfs_opts[13].offset = offsetof(struct XROOTDFS, attrcache);
+    xrootdfs_opts[13].value = 0;
+
+    xrootdfs_opts[14].templ = "negcache=%d";
+    xrootdfs_opts[14].offset = offsetof(struct XROOTDFS, negcache);
+    xrootdfs_opts[14].value = 0;
+
+/* size of the write cache of each file, asynchronous writes per file and memory for all */
+    xrootdfs_opts[15].templ = "wcachesize=%s";
+    xrootdfs_opts[15].offset = offsetof(struct XROOTDFS, wcachesize);
+    xrootdfs_opts[15].value = 0;
+
+    xrootdfs_opts[16].templ = "wcacheasync=%d";
+    xrootdfs_opts[16].offset = offsetof(struct XROOTDFS, wcacheasync);
+    xrootdfs_opts[16].value = 0;
+
+    xrootdfs_opts[17].templ = "wcachemem=%s";
+    xrootdfs_opts[17].offset = offsetof(struct XROOTDFS, wcachemem);
+    xrootdfs_opts[17].value = 0;
+
+    xrootdfs_opts[18].templ = NULL;
 
 /* initialize struct xrootdfs */
 //    memset(&xrootdfs, 0, sizeof(xrootdfs));
@@ -1390,6 +1443,11 @@ int main(int argc, char *argv[])
     xrootdfs.urlcachelife = strdup("3650d"); /* 10 years */
     xrootdfs.nworkers = 4;
     xrootdfs.maxfd = 8192;
+    xrootdfs.attrcache = 0;
+    xrootdfs.negcache = 5;
+    xrootdfs.wcachesize = NULL;
+    xrootdfs.wcacheasync = 0;
+    xrootdfs.wcachemem = NULL;
 
 /* Get options from environment variables first */
     xrootdfs.rdr = getenv("XROOTDFS_RDRURL");
@@ -1400,6 +1458,11 @@ int main(int argc, char *argv[])
     if (getenv("XROOTDFS_OFSFWD") != NULL && ! strcmp(getenv("XROOTDFS_OFSFWD"),"1")) xrootdfs.ofsfwd = true;
     if (getenv("XROOTDFS_NWORKERS") != NULL) sscanf(getenv("XROOTDFS_NWORKERS"), "%d", &xrootdfs.nworkers);
     if (getenv("XROOTDFS_MAXFD") != NULL) sscanf(getenv("XROOTDFS_MAXFD"), "%d", &xrootdfs.maxfd);
+    if (getenv("XROOTDFS_ATTRCACHE") != NULL) sscanf(getenv("XROOTDFS_ATTRCACHE"), "%d", &xrootdfs.attrcache);
+    if (getenv("XROOTDFS_NEGCACHE") != NULL) sscanf(getenv("XROOTDFS_NEGCACHE"), "%d", &xrootdfs.negcache);
+    xrootdfs.wcachesize = getenv("XROOTDFS_WCACHESIZE");
+    if (getenv("XROOTDFS_WCACHEASYNC") != NULL) sscanf(getenv("XROOTDFS_WCACHEASYNC"), "%d", &xrootdfs.wcacheasync);
+    xrootdfs.wcachemem = getenv("XROOTDFS_WCACHEMEM");
 
 /* Parse XrootdFS options, will overwrite those defined in environment variables */
     fuse_opt_parse(&args, &xrootdfs, xrootdfs_opts, xrootdfs_opt_proc);
@@ -1434,6 +1497,12 @@ int main(int argc, char *argv[])
 
     if (xrootdfs.maxfd < 2048) xrootdfs.maxfd = 2048;
 
+    if (! XrdFfsWcache_config(xrootdfs.wcachesize, xrootdfs.wcacheasync, xrootdfs.wcachemem))
+    {
+        fprintf(stderr, "Invalid wcachesize or wcachemem value\n");
+        exit(1);
+    }
+
     signal(SIGUSR1,xrootdfs_sigusr1_handler);
 
     cwdfd = open(".",O_RDONLY);
@@ -27,6 +27,8 @@ add_library(
   XrdFileCache/XrdFileCacheIO.cc            XrdFileCache/XrdFileCacheIO.hh
   XrdFileCache/XrdFileCacheIOEntireFile.cc  XrdFileCache/XrdFileCacheIOEntireFile.hh
   XrdFileCache/XrdFileCacheIOFileBlock.cc   XrdFileCache/XrdFileCacheIOFileBlock.hh
+  XrdFileCache/XrdFileCacheFreqSketch.cc    XrdFileCache/XrdFileCacheFreqSketch.hh
+  XrdFileCache/XrdFileCacheSources.cc       XrdFileCache/XrdFileCacheSources.hh
   XrdFileCache/XrdFileCacheDecision.hh)
 
 target_link_libraries(
@@ -76,6 +78,32 @@ target_link_libraries(
   XrdCl
   XrdUtils )
 
+#-------------------------------------------------------------------------------
+# xrdpfc_replay, not installed
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdpfc_replay
+  XrdFileCache/XrdFileCacheReplay.cc
+  XrdFileCache/XrdFileCache.cc
+  XrdFileCache/XrdFileCacheConfiguration.cc
+  XrdFileCache/XrdFileCachePurge.cc
+  XrdFileCache/XrdFileCacheCommand.cc
+  XrdFileCache/XrdFileCacheFile.cc
+  XrdFileCache/XrdFileCacheVRead.cc
+  XrdFileCache/XrdFileCacheInfo.cc
+  XrdFileCache/XrdFileCacheIO.cc
+  XrdFileCache/XrdFileCacheIOEntireFile.cc
+  XrdFileCache/XrdFileCacheIOFileBlock.cc
+  XrdFileCache/XrdFileCacheFreqSketch.cc
+  XrdFileCache/XrdFileCacheSources.cc)
+
+target_link_libraries(
+  xrdpfc_replay
+  XrdServer
+  XrdCl
+  XrdUtils
+  pthread )
+
 #-------------------------------------------------------------------------------
 # Install
 #-------------------------------------------------------------------------------
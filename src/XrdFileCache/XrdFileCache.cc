@@ -19,7 +19,11 @@
 #include <fcntl.h>
 #include <sstream>
 #include <algorithm>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/statvfs.h>
+#include <sys/time.h>
 
 #include "XrdCl/XrdClConstants.hh"
 #include "XrdCl/XrdClURL.hh"
@@ -42,6 +46,16 @@ Cache * Cache::m_factory = NULL;
 
 XrdScheduler *Cache::schedP = NULL;
 
+namespace
+{
+long long usecNow()
+{
+   struct timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec * 1000000ll + tv.tv_usec;
+}
+}
+
 
 void *PurgeThread(void* cache_void)
 {
@@ -82,8 +96,7 @@ XrdOucCache2 *XrdOucGetCache2(XrdSysLogger *logger,
    }
    err.Emsg("Retrieve", "Success - returning a factory.");
 
-   pthread_t tid1;
-   XrdSysThread::Run(&tid1, ProcessWriteTaskThread, (void*)(&factory), 0, "XrdFileCache WriteTasks ");
+   factory.StartWriteThreads();
 
    pthread_t tid2;
    XrdSysThread::Run(&tid2, PrefetchThread, (void*)(&factory), 0, "XrdFileCache Prefetch ");
@@ -147,16 +160,45 @@ bool Cache::Decide(XrdOucCacheIO* io)
    return true;
 }
 
+bool Cache::Admit(const std::string &lfn)
+{
+   if ( ! m_configuration.m_admission) return true;
+
+   const int freq   = m_freq_sketch.Increment(lfn);
+   const int victim = __atomic_load_n(&m_admit_victim_freq, __ATOMIC_RELAXED);
+
+   if (victim < 0 || freq > victim) return true;
+
+   // Data that is already in the cache is always served from it.
+   struct stat st;
+   std::string info_path = lfn + Info::m_infoExtension;
+   if (m_output_fs->Stat(info_path.c_str(), &st) == XrdOssOK) return true;
+
+   TRACE(Debug, "Cache::Admit() declined " << lfn << ", frequency " << freq << " victim frequency " << victim);
+   return false;
+}
+
 Cache::Cache() :
    XrdOucCache(),
    m_log(0, "XrdFileCache_"),
    m_trace(0),
    m_traceID("Manager"),
    m_prefetch_condVar(0),
+   m_fg_requests(0),
    m_RAMblocks_used(0),
+   m_hot_blocks_used(0),
+   m_pool_base(0),
+   m_pool_size(0),
+   m_pool_slot(0),
+   m_pool_nslots(0),
+   m_pool_peak(0),
+   m_pool_heap(0),
    m_isClient(false),
+   m_purge_index_gen(0),
+   m_purge_index_valid(false),
    m_in_purge(false),
-   m_active_cond(0)
+   m_active_cond(0),
+   m_admit_victim_freq(-1)
 {
    m_trace = new XrdSysTrace("XrdFileCache");
    // default log level is Warning
@@ -166,7 +208,14 @@ Cache::Cache() :
 
 XrdOucCacheIO2 *Cache::Attach(XrdOucCacheIO2 *io, int Options)
 {
-   if (Cache::GetInstance().Decide(io))
+   bool admit = Cache::GetInstance().Decide(io);
+   if (admit && ! m_configuration.m_hdfsmode)
+   {
+      XrdCl::URL url(io->Path());
+      admit = Admit(url.GetPath());
+   }
+
+   if (admit)
    {
       TRACE(Info, "Cache::Attach() " << io->Path());
       IO* cio;
@@ -232,27 +281,92 @@ void Cache::RemoveWriteQEntriesFor(File *iFile)
 }
 
 
+void Cache::StartWriteThreads()
+{
+   int n = m_configuration.m_wqueue_threads;
+
+   if (n <= 0)
+   {
+      // One writer per partition of the data space(s).
+      XrdOssVSInfo sP;
+      n = (StatDataSpace(sP) >= 0) ? sP.Extents : 1;
+      n = std::max(1, std::min(n, 16));
+   }
+
+   TRACE(Info, "Cache::StartWriteThreads() starting " << n << " write threads.");
+
+   for (int i = 0; i < n; ++i)
+   {
+      pthread_t tid;
+      XrdSysThread::Run(&tid, ProcessWriteTaskThread, (void*) this, 0, "XrdFileCache WriteTasks ");
+   }
+}
+
+
 void Cache::ProcessWriteTasks()
 {
+   // When the RAM blocks are close to be used up blocks that are referenced
+   // only by the write queue go first as writing them releases their memory.
+   // Other queued blocks of the same file are taken along so that they can be
+   // written together, adjacent ones with a single system call.
+
+   const int max_blocks = m_configuration.m_wqueue_blocks;
+   const int max_scan   = 4 * max_blocks;
+
+   std::vector<Block*> blks;
+
    while (true)
    {
+      bool ram_is_low;
+      {
+         XrdSysMutexHelper lock(&m_RAMblock_mutex);
+         ram_is_low = m_RAMblocks_used >= m_configuration.m_NRamBuffers - m_configuration.m_NRamBuffers / 8;
+      }
+
       m_writeQ.condVar.Lock();
       while (m_writeQ.queue.empty())
       {
          m_writeQ.condVar.Wait();
       }
 
-      // MT -- optimize to pop several blocks if they are available (or swap the list).
-      // This makes sense especially for smallish block sizes.
+      std::list<Block*>::iterator bi = m_writeQ.queue.begin();
+      if (ram_is_low)
+      {
+         std::list<Block*>::iterator i = bi;
+         for (int n = 0; i != m_writeQ.queue.end() && n < max_scan; ++i, ++n)
+         {
+            if (__atomic_load_n(&(*i)->m_refcnt, __ATOMIC_RELAXED) == 1) { bi = i; break; }
+         }
+      }
+
+      File *file = (*bi)->m_file;
+      blks.push_back(*bi);
+      bi = m_writeQ.queue.erase(bi);
+
+      for (int n = 0; bi != m_writeQ.queue.end() && n < max_scan && (int) blks.size() < max_blocks; ++n)
+      {
+         if ((*bi)->m_file == file)
+         {
+            blks.push_back(*bi);
+            bi = m_writeQ.queue.erase(bi);
+         }
+         else
+         {
+            ++bi;
+         }
+      }
 
-      Block* block = m_writeQ.queue.front();
-      m_writeQ.queue.pop_front();
-      m_writeQ.size--;
-      m_writeQ.writes_between_purges += block->get_size();
-      TRACE(Dump, "Cache::ProcessWriteTasks for block " <<  (void*)(block) << " path " << block->m_file->lPath());
+      m_writeQ.size -= blks.size();
+      for (std::vector<Block*>::iterator i = blks.begin(); i != blks.end(); ++i)
+         m_writeQ.writes_between_purges += (*i)->get_size();
+      TRACE(Dump, "Cache::ProcessWriteTasks for " << blks.size() << " blocks, path " << file->lPath());
       m_writeQ.condVar.UnLock();
 
-      block->m_file->WriteBlockToDisk(block);
+      if (blks.size() == 1)
+         file->WriteBlockToDisk(blks.front());
+      else
+         file->WriteBlocksToDisk(blks);
+      blks.clear();
    }
 }
 
@@ -276,7 +390,127 @@ void Cache::RAMBlockReleased()
 }
 
 
-File* Cache::GetFile(const std::string& path, IO* iIO, long long off, long long filesize)
+bool Cache::RequestHotBlock()
+{
+   XrdSysMutexHelper lock(&m_RAMblock_mutex);
+   if ( m_hot_blocks_used < m_configuration.m_NHotBlocks )
+   {
+      m_hot_blocks_used++;
+      return true;
+   }
+   return false;
+}
+
+
+void Cache::HotBlockReleased()
+{
+   XrdSysMutexHelper lock(&m_RAMblock_mutex);
+   m_hot_blocks_used--;
+}
+
+
+void Cache::ConfigBlockPool()
+{
+   // Reserve one slot per RAM block. Huge pages are used when available and
+   // the memory is faulted in up front on a server, so that block requests
+   // neither call malloc nor take page faults on the data path.
+
+   const long long slot = m_configuration.m_bufferSize;
+   const int       n    = m_configuration.m_NRamBuffers;
+
+   if (n <= 0) return;
+
+   size_t size = (size_t) slot * n;
+   void  *base = MAP_FAILED;
+
+#if defined(MAP_ANONYMOUS)
+#if defined(MAP_HUGETLB)
+   const size_t hpsz = 2 * 1024 * 1024;
+   size_t hsize = (size + hpsz - 1) / hpsz * hpsz;
+   base = mmap(0, hsize, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (m_isClient ? 0 : MAP_POPULATE), -1, 0);
+   if (base != MAP_FAILED) size = hsize;
+#endif
+   if (base == MAP_FAILED)
+   {
+      base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#if defined(MADV_HUGEPAGE)
+      if (base != MAP_FAILED) madvise(base, size, MADV_HUGEPAGE);
+#endif
+      if (base != MAP_FAILED && ! m_isClient)
+      {
+         const long pgsz = sysconf(_SC_PAGESIZE);
+         for (size_t i = 0; i < size; i += pgsz) ((volatile char*) base)[i] = 0;
+      }
+   }
+#endif
+
+   if (base == MAP_FAILED)
+   {
+      TRACE(Warning, "Cache::ConfigBlockPool() can not map RAM pool, block buffers will be taken from heap.");
+      return;
+   }
+
+   XrdSysMutexHelper lock(&m_RAMblock_mutex);
+
+   m_pool_base   = (char*) base;
+   m_pool_size   = size;
+   m_pool_slot   = slot;
+   m_pool_nslots = n;
+   m_pool_free.reserve(n);
+   for (int i = n - 1; i >= 0; --i) m_pool_free.push_back(m_pool_base + i * slot);
+
+   TRACE(Info, "Cache::ConfigBlockPool() " << n << " slots of " << slot << " bytes.");
+}
+
+
+char* Cache::RequestBlockBuffer(int size)
+{
+   {
+      XrdSysMutexHelper lock(&m_RAMblock_mutex);
+
+      if (size <= m_pool_slot && ! m_pool_free.empty())
+      {
+         char *buff = m_pool_free.back();
+         m_pool_free.pop_back();
+         int used = m_pool_nslots - (int) m_pool_free.size();
+         if (used > m_pool_peak) m_pool_peak = used;
+         return buff;
+      }
+      m_pool_heap++;
+   }
+
+   return (char*) malloc(size > 0 ? size : 1);
+}
+
+
+void Cache::ReleaseBlockBuffer(char *buff)
+{
+   if (buff >= m_pool_base && buff < m_pool_base + m_pool_size)
+   {
+      XrdSysMutexHelper lock(&m_RAMblock_mutex);
+      m_pool_free.push_back(buff);
+   }
+   else
+   {
+      free(buff);
+   }
+}
+
+
+void Cache::GetBlockPoolStats(int &nSlots, int &nUsed, int &nPeak, long long &nHeap)
+{
+   XrdSysMutexHelper lock(&m_RAMblock_mutex);
+
+   nSlots = m_pool_nslots;
+   nUsed  = m_pool_nslots - (int) m_pool_free.size();
+   nPeak  = m_pool_peak;
+   nHeap  = m_pool_heap;
+}
+
+
+File* Cache::GetFile(const std::string& path, IO* iIO, long long off, long long filesize,
+                     const ContainerSlot *slot)
 {
    // Called from virtual IO::Attach
    
@@ -331,16 +565,34 @@ File* Cache::GetFile(const std::string& path, IO* iIO, long long off, long long
    }
 
    File* file = new File(iIO, path, off, filesize);
+   if (slot) file->SetContainer(*slot);
+
+   // With async open the file is published before its data and info files are
+   // opened. Reads go to the origin until the open, run in the background
+   // holding its own reference, completes.
+   bool async = m_configuration.m_async_open && ! m_isClient;
+
+   // Extra origin sources of a large file are located and opened in the
+   // background as well, see pfc.multisource.
+   bool sources = m_configuration.m_multiSource > 0 && ! m_configuration.m_hdfsmode &&
+                  ! m_isClient && filesize >= m_configuration.m_multiSourceMinSize;
+
+   if ( ! async) file->Open();
 
    {
       XrdSysCondVarHelper lock(&m_active_cond);
 
       inc_ref_cnt(file, false);
+      if (async)   inc_ref_cnt(file, false);
+      if (sources) inc_ref_cnt(file, false);
       m_active[file->GetLocalPath()] = file;
 
       m_active_cond.Broadcast();
    }
 
+   if (async) schedule_file_open(file);
+   if (sources) schedule_source_open(file, iIO->Path());
+
    return file;
 }
 
@@ -379,6 +631,48 @@ public:
 };
 
 
+class FileOpener : public XrdJob
+{
+private:
+   File *m_file;
+
+public:
+   FileOpener(File *f, const char *desc = "") :
+      XrdJob(desc),
+      m_file(f)
+   {}
+
+   void DoIt()
+   {
+      m_file->Open();
+      Cache::GetInstance().FileOpenDone(m_file);
+      delete this;
+   }
+};
+
+
+class SourceOpener : public XrdJob
+{
+private:
+   File        *m_file;
+   std::string  m_url;
+
+public:
+   SourceOpener(File *f, const std::string &url, const char *desc = "") :
+      XrdJob(desc),
+      m_file(f),
+      m_url(url)
+   {}
+
+   void DoIt()
+   {
+      m_file->OpenSources(m_url);
+      Cache::GetInstance().SourceOpenDone(m_file);
+      delete this;
+   }
+};
+
+
 class CommandExecutor : public XrdJob
 {
 private:
@@ -420,6 +714,43 @@ void Cache::schedule_file_sync(File* f, bool ref_cnt_already_set)
 }
 
 
+void Cache::schedule_file_open(File* f)
+{
+   // Called from GetFile() with the reference for the opener already set.
+
+   FileOpener* fo = new FileOpener(f);
+   if (schedP) schedP->Schedule(fo);
+      else {pthread_t tid;
+            XrdSysThread::Run(&tid, callDoIt, fo, 0, "FileOpener");
+           }
+}
+
+
+void Cache::schedule_source_open(File* f, const std::string &url)
+{
+   // Called from GetFile() with the reference for the opener already set.
+
+   SourceOpener* so = new SourceOpener(f, url);
+   if (schedP) schedP->Schedule(so);
+      else {pthread_t tid;
+            XrdSysThread::Run(&tid, callDoIt, so, 0, "SourceOpener");
+           }
+}
+
+
+void Cache::FileOpenDone(File* f)
+{
+   TRACE(Debug, "Cache::FileOpenDone " << f->GetLocalPath() << (f->isOpen() ? "" : " failed"));
+   dec_ref_cnt(f);
+}
+
+
+void Cache::SourceOpenDone(File* f)
+{
+   dec_ref_cnt(f);
+}
+
+
 void Cache::FileSyncDone(File* f)
 {
    dec_ref_cnt(f);
@@ -475,8 +806,20 @@ bool Cache::IsFileActiveOrPurgeProtected(const std::string& path)
 {
    XrdSysCondVarHelper lock(&m_active_cond);
 
-   return m_active.find(path)          != m_active.end() ||
-          m_purge_delay_set.find(path) != m_purge_delay_set.end();
+   if (m_active.find(path)          != m_active.end() ||
+       m_purge_delay_set.find(path) != m_purge_delay_set.end())
+      return true;
+
+   // In hdfs mode the blocks of a file are active under their own names.
+   if (m_configuration.m_hdfsmode)
+   {
+      const std::string pfx = path + "___";
+      ActiveMap_i it = m_active.lower_bound(pfx);
+      if (it != m_active.end() && it->first.compare(0, pfx.size(), pfx) == 0)
+         return true;
+   }
+
+   return false;
 }
 
 
@@ -523,11 +866,22 @@ File* Cache::GetNextFileToPrefetch()
       m_prefetch_condVar.Wait();
    }
 
-   //  std::sort(m_prefetchList.begin(), m_prefetchList.end(), myobject);
+   // Prefer the file whose reader is closest to the end of the blocks
+   // prefetched for it. Without active readers start from a random file so
+   // that no file is favoured.
+   File*  f    = 0;
+   double best = -1;
 
-   size_t l = m_prefetchList.size();
-   int idx = rand() % l;
-   File* f = m_prefetchList[idx];
+   for (PrefetchList::iterator it = m_prefetchList.begin(); it != m_prefetchList.end(); ++it)
+   {
+      double u = (*it)->GetPrefetchUrgency();
+      if (u >= 0 && (best < 0 || u < best))
+      {
+         f    = *it;
+         best = u;
+      }
+   }
+   if ( ! f) f = m_prefetchList[rand() % m_prefetchList.size()];
 
    m_prefetch_condVar.UnLock();
    return f;
@@ -536,17 +890,38 @@ File* Cache::GetNextFileToPrefetch()
 
 void Cache::Prefetch()
 {
-   int limitRAM = int( Cache::GetInstance().RefConfiguration().m_NRamBuffers * 0.7 );
+   const Configuration &conf = RefConfiguration();
+   int limitRAM = int( conf.m_NRamBuffers * 0.7 );
+
+   // With a bandwidth limit prefetching spends a budget that grows at the
+   // configured rate, up to one second worth of it.
+   long long budget      = 0;
+   long long budget_time = usecNow();
+
    while (true)
    {
       m_RAMblock_mutex.Lock();
       bool doPrefetch = (m_RAMblocks_used < limitRAM);
       m_RAMblock_mutex.UnLock();
 
+      if (doPrefetch && conf.m_prefetchFgPause)
+      {
+         doPrefetch = __atomic_load_n(&m_fg_requests, __ATOMIC_RELAXED) <= 0;
+      }
+
+      if (doPrefetch && conf.m_prefetchBandwidth > 0)
+      {
+         long long now = usecNow();
+         long long dt  = std::min(now - budget_time, 1000000ll);
+         budget      = std::min(budget + dt * conf.m_prefetchBandwidth / 1000000, conf.m_prefetchBandwidth);
+         budget_time = now;
+         doPrefetch  = budget > 0;
+      }
+
       if (doPrefetch)
       {
          File* f = GetNextFileToPrefetch();
-         f->Prefetch();
+         budget -= f->Prefetch() * conf.m_bufferSize;
       }
       else
       {
@@ -635,6 +1010,7 @@ int Cache::LocalFilePath(const char *curl, char *buff, int blen, LFP_Reason why)
                {
                   info.WriteIOStatSingle(info.GetFileSize());
                   info.Write(infoFile);
+                  PurgeIndexTouch(i_name);
                }
             }
             infoFile->Close();
@@ -29,7 +29,9 @@
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdFileCacheFile.hh"
 #include "XrdFileCacheDecision.hh"
+#include "XrdFileCacheFreqSketch.hh"
 
+class XrdOssVSInfo;
 class XrdOucStream;
 class XrdSysError;
 class XrdSysTrace;
@@ -39,6 +41,7 @@ class Log;
 }
 namespace XrdFileCache {
 class File;
+class FPurgeState;
 class IO;
 }
 
@@ -53,6 +56,9 @@ struct Configuration
    Configuration() :
       m_hdfsmode(false),
       m_allow_xrdpfc_command(false),
+      m_async_open(false),
+      m_block_cksum(true),
+      m_block_cksum_verify(true),
       m_data_space("public"),
       m_meta_space("public"),
       m_diskTotalSpace(-1),
@@ -64,26 +70,47 @@ struct Configuration
       m_purgeInterval(300),
       m_purgeColdFilesAge(-1),
       m_purgeColdFilesPeriod(-1),
+      m_purgeThreads(4),
+      m_purgeFullScanPeriod(12),
       m_bufferSize(1024*1024),
       m_RamAbsAvailable(0),
       m_NRamBuffers(-1),
       m_prefetch_max_blocks(10),
+      m_wqueue_blocks(16),
+      m_wqueue_threads(0),
+      m_NHotBlocks(0),
+      m_hotAccessCnt(2),
+      m_tierPromoteCnt(3),
+      m_tierFastLWM(0.80),
+      m_tierFastHWM(0.90),
+      m_admission(false),
+      m_admissionWidth(256*1024),
+      m_multiSource(0),
+      m_multiSourceMinSize(256*1024*1024),
+      m_prefetchBandwidth(0),
+      m_prefetchFgPause(false),
       m_hdfsbsize(128*1024*1024),
+      m_hdfscontainer(false),
       m_flushCnt(100)
    {}
 
    bool are_file_usage_limits_set()    const { return m_fileUsageMax > 0; }
    bool is_age_based_purge_in_effect() const { return m_purgeColdFilesAge > 0; }
    bool is_purge_plugin_set_up()       const { return false; }
+   bool are_tiers_set()                const { return ! m_tier_slow.empty(); }
 
    void calculate_fractional_usages(long long du, long long fu, double &frac_du, double &frac_fu);
 
    bool m_hdfsmode;                     //!< flag for enabling block-level operation
    bool m_allow_xrdpfc_command;         //!< flag for enabling access to /xrdpfc-command/ functionality.
+   bool m_async_open;                   //!< flag for opening local files in the background
+   bool m_block_cksum;                  //!< flag for storing crc32c of downloaded blocks
+   bool m_block_cksum_verify;           //!< flag for verifying crc32c of blocks read from disk
 
    std::string m_username;              //!< username passed to oss plugin
    std::string m_data_space;            //!< oss space for data files
    std::string m_meta_space;            //!< oss space for metadata files (cinfo)
+   std::string m_tier_slow;             //!< oss space of the slow tier, data space is the fast one
 
    long long m_diskTotalSpace;          //!< total disk space on configured partition or oss space
    long long m_diskUsageLWM;            //!< cache purge - disk usage low water mark
@@ -94,13 +121,31 @@ struct Configuration
    int       m_purgeInterval;           //!< sleep interval between cache purges
    int       m_purgeColdFilesAge;       //!< purge files older than this age
    int       m_purgeColdFilesPeriod;    //!< peform cold file purge every this many purge cycles
+   int       m_purgeThreads;            //!< number of threads scanning the cache for purge
+   int       m_purgeFullScanPeriod;     //!< rescan whole cache every this many purge scans
 
    long long m_bufferSize;              //!< prefetch buffer size, default 1MB
    long long m_RamAbsAvailable;         //!< available from configuration
    int       m_NRamBuffers;             //!< number of total in-memory cache blocks, cached
    int       m_prefetch_max_blocks;     //!< maximum number of blocks to prefetch per file
+   int       m_wqueue_blocks;           //!< maximum number of blocks of a file written in one go
+   int       m_wqueue_threads;          //!< number of threads writing blocks to disk, 0 for one per partition
+   int       m_NHotBlocks;              //!< number of blocks kept in RAM for hot files
+   int       m_hotAccessCnt;            //!< number of opens after which a file is hot
+
+   int       m_tierPromoteCnt;          //!< number of opens after which a file moves to the fast tier
+   double    m_tierFastLWM;             //!< fast tier usage fraction to demote down to
+   double    m_tierFastHWM;             //!< fast tier usage fraction above which files are demoted
+
+   bool      m_admission;               //!< admit new files only if used more often than the purge victim
+   long long m_admissionWidth;          //!< number of counters per row of the frequency sketch
+   int       m_multiSource;             //!< max number of extra origin sources per file, 0 to disable
+   long long m_multiSourceMinSize;      //!< minimum file size for fetching from extra sources
+   long long m_prefetchBandwidth;       //!< origin bandwidth for prefetching in bytes/s, 0 for no limit
+   bool      m_prefetchFgPause;         //!< pause prefetching while clients wait for blocks
 
    long long m_hdfsbsize;               //!< used with m_hdfsmode, default 128MB
+   bool      m_hdfscontainer;           //!< used with m_hdfsmode, keep blocks of a file in one container
    long long m_flushCnt;                //!< nuber of unsynced blcoks on disk before flush is called
 };
 
@@ -112,6 +157,7 @@ struct TmpConfiguration
    std::string m_fileUsageNominal;
    std::string m_fileUsageMax;
    std::string m_flushRaw;
+   std::string m_hotRaw;
 
    TmpConfiguration() :
       m_diskUsageLWM("0.90"), m_diskUsageHWM("0.95"),
@@ -168,6 +214,18 @@ public:
    //--------------------------------------------------------------------
    bool Decide(XrdOucCacheIO*);
 
+   //--------------------------------------------------------------------
+   //! \brief Count an access of a file, or of a file block in hdfs mode,
+   //! and decide if it is to be cached. When the last purge had to free
+   //! space, data not in the cache yet is only admitted if it was accessed
+   //! more often than the file that purge would remove next.
+   //!
+   //! @param lfn path of the data file in the cache
+   //!
+   //! @return true if the data is to be cached
+   //--------------------------------------------------------------------
+   bool Admit(const std::string &lfn);
+
    //------------------------------------------------------------------------
    //! Reference XrdFileCache configuration
    //------------------------------------------------------------------------
@@ -211,14 +269,43 @@ public:
    void RemoveWriteQEntriesFor(File *f);
 
    //---------------------------------------------------------------------
-   //! Separate task which writes blocks from ram to disk.
+   //! Separate task which writes blocks from ram to disk. Run by
+   //! m_wqueue_threads threads.
    //---------------------------------------------------------------------
    void ProcessWriteTasks();
 
+   //---------------------------------------------------------------------
+   //! Start the write queue threads.
+   //---------------------------------------------------------------------
+   void StartWriteThreads();
+
    bool RequestRAMBlock();
 
    void RAMBlockReleased();
 
+   //---------------------------------------------------------------------
+   //! Account for a downloaded block kept in RAM after its last use. Hot
+   //! blocks have their own budget, see pfc.ramhot.
+   //---------------------------------------------------------------------
+   bool RequestHotBlock();
+
+   void HotBlockReleased();
+
+   //---------------------------------------------------------------------
+   //! Get a buffer for a block. Buffers come from the pre-faulted RAM pool
+   //! when a slot is free and large enough, otherwise from the heap. The
+   //! contents are not initialized.
+   //---------------------------------------------------------------------
+   char* RequestBlockBuffer(int size);
+
+   void  ReleaseBlockBuffer(char *buff);
+
+   //---------------------------------------------------------------------
+   //! Get RAM pool occupancy: number of slots, slots in use, highest number
+   //! of slots in use and number of buffers that had to be taken from heap.
+   //---------------------------------------------------------------------
+   void  GetBlockPoolStats(int &nSlots, int &nUsed, int &nPeak, long long &nHeap);
+
    void RegisterPrefetchFile(File*);
    void DeRegisterPrefetchFile(File*);
 
@@ -226,22 +313,55 @@ public:
 
    void Prefetch();
 
+   //---------------------------------------------------------------------
+   //! Count block requests from the origin that clients wait for.
+   //---------------------------------------------------------------------
+   void ForegroundRequests(int n) { __atomic_add_fetch(&m_fg_requests, n, __ATOMIC_RELAXED); }
+
    XrdOss* GetOss() const { return m_output_fs; }
 
+   //---------------------------------------------------------------------
+   //! Space info of data files, summed over both tiers when these are set.
+   //---------------------------------------------------------------------
+   int StatDataSpace(XrdOssVSInfo &sP);
+
    bool IsFileActiveOrPurgeProtected(const std::string&);
    
-   File* GetFile(const std::string&, IO*, long long off = 0, long long filesize = 0);
+   File* GetFile(const std::string&, IO*, long long off = 0, long long filesize = 0,
+                 const ContainerSlot *slot = 0);
 
    void ReleaseFile(File*);
 
    void ScheduleFileSync(File* f) { schedule_file_sync(f, false); }
 
+   void FileOpenDone(File*);
+
+   void SourceOpenDone(File*);
+
    void FileSyncDone(File*);
    
    XrdSysTrace* GetTrace() { return m_trace; }
 
    void ExecuteCommandUrl(const std::string& command_url);
 
+   //---------------------------------------------------------------------
+   //! Mark directory of a cinfo file for rescan by the next purge.
+   //---------------------------------------------------------------------
+   void PurgeIndexTouch(const std::string& info_path);
+
+   //! Purge index entry, summary of cinfo files in one directory.
+   struct PurgeDirStat
+   {
+      long long nBytes;    //!< downloaded bytes
+      time_t    minTime;   //!< oldest access time, a lower bound when dirty
+      int       nFiles;    //!< number of cinfo files
+      bool      dirty;     //!< changed since last scanned
+      long long gen;       //!< index generation of last change
+
+      PurgeDirStat() : nBytes(0), minTime(0), nFiles(0), dirty(false), gen(0) {}
+   };
+   typedef std::map<std::string, PurgeDirStat> PurgeDirStatMap_t;
+
 private:
    bool ConfigParameters(std::string, XrdOucStream&, TmpConfiguration &tmpc);
    bool ConfigXeq(char *, XrdOucStream &);
@@ -250,6 +370,12 @@ private:
 
    bool cfg2bytes(const std::string &str, long long &store, long long totalSpace, const char *name);
 
+   void ConfigBlockPool();
+
+   void ScanForPurge(FPurgeState &purgeState, bool full_scan);
+
+   void Tier(bool promote);
+
    static Cache     *m_factory;         //!< this object
    static 
    XrdScheduler     *schedP;
@@ -268,9 +394,20 @@ private:
    Configuration m_configuration;           //!< configurable parameters
 
    XrdSysCondVar m_prefetch_condVar;        //!< central lock for this class
+   int           m_fg_requests;             //!< block requests clients wait for, see ForegroundRequests()
 
    XrdSysMutex m_RAMblock_mutex;            //!< central lock for this class
    int         m_RAMblocks_used;
+   int         m_hot_blocks_used;
+
+   // RAM pool of block buffers, protected by m_RAMblock_mutex
+   char              *m_pool_base;          //!< start of pool memory
+   size_t             m_pool_size;          //!< size of pool memory
+   long long          m_pool_slot;          //!< size of one slot
+   int                m_pool_nslots;        //!< number of slots
+   int                m_pool_peak;          //!< highest number of used slots
+   long long          m_pool_heap;          //!< buffers allocated from heap
+   std::vector<char*> m_pool_free;          //!< free slots
    bool        m_isClient;                  //!< True if running as client
 
    struct WriteQ
@@ -292,13 +429,26 @@ private:
 
    ActiveMap_t   m_active;
    FNameSet_t    m_purge_delay_set;
+
+   // purge index, cinfo summary per directory
+   PurgeDirStatMap_t m_purge_index;
+   XrdSysMutex       m_purge_index_mutex;
+   long long         m_purge_index_gen;
+   bool              m_purge_index_valid;
+
    bool          m_in_purge;
    XrdSysCondVar m_active_cond;
 
+   // admission control, see pfc.admission
+   FreqSketch    m_freq_sketch;
+   int           m_admit_victim_freq;       //!< frequency of next purge victim, -1 admits all
+
    void inc_ref_cnt(File*, bool lock);
    void dec_ref_cnt(File*);
 
    void schedule_file_sync(File*, bool ref_cnt_already_set);
+   void schedule_file_open(File*);
+   void schedule_source_open(File*, const std::string &url);
 
    // prefetching
    typedef std::vector<File*>  PrefetchList;
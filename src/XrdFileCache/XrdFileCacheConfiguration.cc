@@ -213,6 +213,10 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
       {
          m_configuration.m_allow_xrdpfc_command = true;
       }
+      else if (! strcmp(var,"pfc.asyncopen"))
+      {
+         m_configuration.m_async_open = true;
+      }
       else if (! strncmp(var,"pfc.", 4))
       {
          retval = ConfigParameters(std::string(var+4), Config, tmpc);
@@ -230,7 +234,7 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
    // sets default value for disk usage
    XrdOssVSInfo sP;
    {
-      if (m_output_fs->StatVS(&sP, m_configuration.m_data_space.c_str(), 1) < 0)
+      if (StatDataSpace(sP) < 0)
       {
          m_log.Emsg("Cache::ConfigParameters()", "error obtaining stat info for space ", m_configuration.m_data_space.c_str());
          return false;
@@ -293,6 +297,21 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
       TRACE(Warning, buff2);
    }
    m_configuration.m_NRamBuffers = static_cast<int>(m_configuration.m_RamAbsAvailable / m_configuration.m_bufferSize);
+   if (retval) ConfigBlockPool();
+
+   if (retval && m_configuration.m_admission) m_freq_sketch.Init(m_configuration.m_admissionWidth);
+
+   // get number of blocks hot files may keep in RAM
+   if ( ! tmpc.m_hotRaw.empty())
+   {
+      long long hotRam;
+      if (XrdOuca2x::a2sz(m_log, "Error getting ramhot size", tmpc.m_hotRaw.c_str(), &hotRam,
+                          m_configuration.m_bufferSize, 256ll * 1024 * 1024 * 1024))
+      {
+         return false;
+      }
+      m_configuration.m_NHotBlocks = static_cast<int>(hotRam / m_configuration.m_bufferSize);
+   }
    
 
    // Set tracing to debug if this is set in environment
@@ -312,7 +331,8 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
                       "       pfc.diskusage %lld %lld files %lld %lld %lld purgeinterval %d purgecoldfiles %d\n"
                       "       pfc.spaces %s %s\n"
                       "       pfc.trace %d\n"
-                      "       pfc.flush %lld",
+                      "       pfc.flush %lld\n"
+                      "       pfc.writequeue %d %d",
                       config_filename,
                       m_configuration.m_bufferSize,
                       m_configuration.m_prefetch_max_blocks,
@@ -323,14 +343,60 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
                       m_configuration.m_data_space.c_str(),
                       m_configuration.m_meta_space.c_str(),
                       m_trace->What,
-                      m_configuration.m_flushCnt);
+                      m_configuration.m_flushCnt,
+                      m_configuration.m_wqueue_blocks, m_configuration.m_wqueue_threads);
+
+
+
+      if (m_configuration.m_async_open)
+      {
+         loff += snprintf(buff + loff, sizeof(buff) - loff, "\n       pfc.asyncopen");
+      }
+
+      if (m_configuration.m_admission)
+      {
+         loff += snprintf(buff + loff, sizeof(buff) - loff, "\n       pfc.admission tinylfu width %lld",
+                          m_configuration.m_admissionWidth);
+      }
+
+      if (m_configuration.m_prefetchBandwidth > 0 || m_configuration.m_prefetchFgPause)
+      {
+         loff += snprintf(buff + loff, sizeof(buff) - loff, "\n       pfc.prefetchbw %lld%s",
+                          m_configuration.m_prefetchBandwidth, m_configuration.m_prefetchFgPause ? " fgpause" : "");
+      }
+
+      if (m_configuration.m_multiSource > 0)
+      {
+         loff += snprintf(buff + loff, sizeof(buff) - loff, "\n       pfc.multisource %d minsize %lld",
+                          m_configuration.m_multiSource, m_configuration.m_multiSourceMinSize);
+      }
 
+      if ( ! m_configuration.m_block_cksum_verify)
+      {
+         loff += snprintf(buff + loff, sizeof(buff) - loff, "\n       pfc.blockcksum %s",
+                          m_configuration.m_block_cksum ? "noverify" : "off");
+      }
+
+      if (m_configuration.m_NHotBlocks > 0)
+      {
+         loff += snprintf(buff + loff, sizeof(buff) - loff, "\n       pfc.ramhot %lld access %d",
+                          m_configuration.m_NHotBlocks * m_configuration.m_bufferSize,
+                          m_configuration.m_hotAccessCnt);
+      }
 
+      if (m_configuration.are_tiers_set())
+      {
+         loff += snprintf(buff + loff, sizeof(buff) - loff, "\n       pfc.tiers %s %s promote %d fastusage %.2f %.2f",
+                          m_configuration.m_data_space.c_str(), m_configuration.m_tier_slow.c_str(),
+                          m_configuration.m_tierPromoteCnt,
+                          m_configuration.m_tierFastLWM, m_configuration.m_tierFastHWM);
+      }
 
       if (m_configuration.m_hdfsmode)
       {
          char buff2[512];
-         snprintf(buff2, sizeof(buff2), "\tpfc.hdfsmode hdfsbsize %lld\n", m_configuration.m_hdfsbsize);
+         snprintf(buff2, sizeof(buff2), "\tpfc.hdfsmode hdfsbsize %lld%s\n", m_configuration.m_hdfsbsize,
+                  m_configuration.m_hdfscontainer ? " container" : "");
          loff += snprintf(&buff[loff], strlen(buff2), "%s", buff2);
       }
 
@@ -415,6 +481,22 @@ bool Cache::ConfigParameters(std::string part, XrdOucStream& config, TmpConfigur
                return false;
             }
          }
+         else if (strcmp(p, "purgethreads") == 0)
+         {
+            p = config.GetWord();
+            if (XrdOuca2x::a2i(m_log, "Error getting purgethreads", p, &m_configuration.m_purgeThreads, 1, 64))
+            {
+               return false;
+            }
+         }
+         else if (strcmp(p, "purgefullscan") == 0)
+         {
+            p = config.GetWord();
+            if (XrdOuca2x::a2i(m_log, "Error getting purgefullscan period", p, &m_configuration.m_purgeFullScanPeriod, 1, 1000))
+            {
+               return false;
+            }
+         }
          else
          {
             m_log.Emsg("Config", "Error: diskusage stanza contains unknown directive", p);
@@ -471,6 +553,96 @@ bool Cache::ConfigParameters(std::string part, XrdOucStream& config, TmpConfigur
          return false;
       }
    }
+   else if ( part == "writequeue" )
+   {
+      const char *p = config.GetWord();
+      if (XrdOuca2x::a2i(m_log, "Error getting writequeue blocks", p, &m_configuration.m_wqueue_blocks, 1, 1024))
+      {
+         return false;
+      }
+      if ((p = config.GetWord()))
+      {
+         if (XrdOuca2x::a2i(m_log, "Error getting writequeue threads", p, &m_configuration.m_wqueue_threads, 1, 64))
+         {
+            return false;
+         }
+      }
+   }
+   else if ( part == "ramhot" )
+   {
+      const char *p = config.GetWord();
+      if ( ! p)
+      {
+         m_log.Emsg("Config", "Error: pfc.ramhot requires the size of RAM for hot blocks.");
+         return false;
+      }
+      tmpc.m_hotRaw = p;
+
+      if ((p = config.GetWord()))
+      {
+         if (strcmp(p, "access") == 0)
+         {
+            p = config.GetWord();
+            if (XrdOuca2x::a2i(m_log, "Error getting ramhot access count", p, &m_configuration.m_hotAccessCnt, 1, 1000000))
+            {
+               return false;
+            }
+         }
+         else
+         {
+            m_log.Emsg("Config", "Error: ramhot stanza contains unknown directive", p);
+            return false;
+         }
+      }
+   }
+   else if ( part == "tiers" )
+   {
+      const char *fast = config.GetWord();
+      const char *slow = fast ? config.GetWord() : 0;
+      if ( ! slow)
+      {
+         m_log.Emsg("Config", "Error: pfc.tiers requires two parameters: <fast-space> <slow-space>.");
+         return false;
+      }
+      m_configuration.m_data_space = fast;
+      m_configuration.m_tier_slow  = slow;
+
+      const char *p = 0;
+      while ((p = config.GetWord()))
+      {
+         if (strcmp(p, "promote") == 0)
+         {
+            p = config.GetWord();
+            if (XrdOuca2x::a2i(m_log, "Error getting tiers promote count", p, &m_configuration.m_tierPromoteCnt, 1, 1000000))
+            {
+               return false;
+            }
+         }
+         else if (strcmp(p, "fastusage") == 0)
+         {
+            const char *lwm = config.GetWord();
+            const char *hwm = lwm ? config.GetWord() : 0;
+            if ( ! hwm)
+            {
+               m_log.Emsg("Config", "Error: tiers fastusage requires two arguments.");
+               return false;
+            }
+            m_configuration.m_tierFastLWM = strtod(lwm, 0);
+            m_configuration.m_tierFastHWM = strtod(hwm, 0);
+            if (m_configuration.m_tierFastLWM <= 0 || m_configuration.m_tierFastHWM > 1 ||
+                m_configuration.m_tierFastLWM >= m_configuration.m_tierFastHWM)
+            {
+               m_log.Emsg("Config", "Error: tiers fastusage should have 0 < low < high <= 1.");
+               return false;
+            }
+         }
+         else
+         {
+            m_log.Emsg("Config", "Error: tiers stanza contains unknown directive", p);
+            return false;
+         }
+      }
+   }
    else if ( part == "hdfsmode" || part == "filefragmentmode" )
    {
       if (part == "filefragmentmode")
@@ -479,8 +651,8 @@ bool Cache::ConfigParameters(std::string part, XrdOucStream& config, TmpConfigur
       }
       m_configuration.m_hdfsmode = true;
 
-      const char* params = config.GetWord();
-      if (params)
+      const char* params;
+      while ((params = config.GetWord()))
       {
          if (! strncmp("hdfsbsize", params, 9))
          {
@@ -492,6 +664,10 @@ bool Cache::ConfigParameters(std::string part, XrdOucStream& config, TmpConfigur
                return false;
             }
          }
+         else if (! strcmp("container", params))
+         {
+            m_configuration.m_hdfscontainer = true;
+         }
          else
          {
             m_log.Emsg("Config", "Error setting the fragment size parameter name");
@@ -503,6 +679,110 @@ bool Cache::ConfigParameters(std::string part, XrdOucStream& config, TmpConfigur
    {
       tmpc.m_flushRaw = config.GetWord();
    }
+   else if ( part == "admission" )
+   {
+      const char* p = config.GetWord();
+      if (p && ! strcmp(p, "tinylfu"))
+      {
+         m_configuration.m_admission = true;
+      }
+      else if (p && ! strcmp(p, "off"))
+      {
+         m_configuration.m_admission = false;
+      }
+      else
+      {
+         m_log.Emsg("Config", "Error: pfc.admission requires tinylfu or off.");
+         return false;
+      }
+
+      while ((p = config.GetWord()))
+      {
+         if (strcmp(p, "width") == 0)
+         {
+            if (XrdOuca2x::a2sz(m_log, "Error getting admission sketch width", config.GetWord(),
+                                &m_configuration.m_admissionWidth, 1024, 64*1024*1024))
+            {
+               return false;
+            }
+         }
+         else
+         {
+            m_log.Emsg("Config", "Error: admission stanza contains unknown directive", p);
+            return false;
+         }
+      }
+   }
+   else if ( part == "prefetchbw" )
+   {
+      const char* p = config.GetWord();
+      if ( ! p || XrdOuca2x::a2sz(m_log, "Error getting prefetch bandwidth", p,
+                                  &m_configuration.m_prefetchBandwidth, 0))
+      {
+         return false;
+      }
+
+      while ((p = config.GetWord()))
+      {
+         if (strcmp(p, "fgpause") == 0)
+         {
+            m_configuration.m_prefetchFgPause = true;
+         }
+         else
+         {
+            m_log.Emsg("Config", "Error: prefetchbw stanza contains unknown directive", p);
+            return false;
+         }
+      }
+   }
+   else if ( part == "multisource" )
+   {
+      const char* p = config.GetWord();
+      if ( ! p || XrdOuca2x::a2i(m_log, "Error getting number of extra sources", p,
+                                 &m_configuration.m_multiSource, 0, 16))
+      {
+         return false;
+      }
+
+      while ((p = config.GetWord()))
+      {
+         if (strcmp(p, "minsize") == 0)
+         {
+            if (XrdOuca2x::a2sz(m_log, "Error getting multisource minimum file size", config.GetWord(),
+                                &m_configuration.m_multiSourceMinSize, 0))
+            {
+               return false;
+            }
+         }
+         else
+         {
+            m_log.Emsg("Config", "Error: multisource stanza contains unknown directive", p);
+            return false;
+         }
+      }
+   }
+   else if ( part == "blockcksum" )
+   {
+      const char* p = config.GetWord();
+      if (p && ! strcmp(p, "on"))
+      {
+         m_configuration.m_block_cksum = m_configuration.m_block_cksum_verify = true;
+      }
+      else if (p && ! strcmp(p, "noverify"))
+      {
+         m_configuration.m_block_cksum        = true;
+         m_configuration.m_block_cksum_verify = false;
+      }
+      else if (p && ! strcmp(p, "off"))
+      {
+         m_configuration.m_block_cksum = m_configuration.m_block_cksum_verify = false;
+      }
+      else
+      {
+         m_log.Emsg("Config", "Error: pfc.blockcksum requires on, noverify, or off.");
+         return false;
+      }
+   }
    else
    {
       m_log.Emsg("Cache::ConfigParameters() unmatched pfc parameter", part.c_str());
@@ -515,6 +795,31 @@ bool Cache::ConfigParameters(std::string part, XrdOucStream& config, TmpConfigur
 //______________________________________________________________________________
 
 
+int Cache::StatDataSpace(XrdOssVSInfo &sP)
+{
+   // Data files are spread over the fast and the slow space when tiers are
+   // configured, purging looks at the two together.
+
+   int rc = m_output_fs->StatVS(&sP, m_configuration.m_data_space.c_str(), 1);
+
+   if (rc >= 0 && m_configuration.are_tiers_set())
+   {
+      XrdOssVSInfo slow;
+      if ((rc = m_output_fs->StatVS(&slow, m_configuration.m_tier_slow.c_str(), 1)) >= 0)
+      {
+         sP.Total += slow.Total;
+         sP.Free  += slow.Free;
+         if (slow.LFree > sP.LFree) sP.LFree = slow.LFree;
+         if (slow.Large > sP.Large) sP.Large = slow.Large;
+         sP.Extents += slow.Extents;
+      }
+   }
+   return rc;
+}
+
+//______________________________________________________________________________
+
+
 void Cache::EnvInfo(XrdOucEnv &theEnv)
 {
 // Extract out the pointer to the scheduler
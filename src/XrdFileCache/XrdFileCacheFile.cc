@@ -18,18 +18,24 @@
 
 
 #include "XrdFileCacheFile.hh"
+#include "XrdFileCacheSources.hh"
 #include "XrdFileCacheIO.hh"
 #include "XrdFileCacheTrace.hh"
 #include <stdio.h>
+#include <string.h>
 #include <sstream>
+#include <algorithm>
 #include <fcntl.h>
 #include <assert.h>
+#include <sys/time.h>
 #include "XrdCl/XrdClLog.hh"
 #include "XrdCl/XrdClConstants.hh"
 #include "XrdCl/XrdClFile.hh"
+#include "XrdSys/XrdSysProbe.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdOss/XrdOss.hh"
+#include "XrdOuc/XrdOucCRC.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
 #include "XrdFileCache.hh"
@@ -44,10 +50,124 @@ const int PREFETCH_MAX_ATTEMPTS = 10;
 
 
 Cache* cache() { return &Cache::GetInstance(); }
+
+bool block_offset_less(const Block *a, const Block *b) { return a->m_offset < b->m_offset; }
+
+long long usecNow()
+{
+   struct timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec * 1000000ll + tv.tv_usec;
+}
 }
 
 const char *File::m_traceID = "File";
 
+//==============================================================================
+//============================    BLOCK    =====================================
+//==============================================================================
+
+Block::Block(File *f, long long off, int size, bool prefetch) :
+   m_buff(cache()->RequestBlockBuffer(size)), m_size(size),
+   m_offset(off), m_file(f), m_prefetch(prefetch), m_refcnt(0),
+   m_errno(0), m_downloaded(false), m_req_time(0), m_hot(false),
+   m_source(-1)
+{}
+
+Block::~Block()
+{
+   if (m_buff) cache()->ReleaseBlockBuffer(m_buff);
+}
+
+//------------------------------------------------------------------------------
+
+void Block::set_error_and_free(int err)
+{
+   m_errno = err;
+   if (m_buff) cache()->ReleaseBlockBuffer(m_buff);
+   m_buff = 0;
+   m_size = 0;
+}
+
+//==============================================================================
+//=========================    BLOCK INDEX    ==================================
+//==============================================================================
+
+BlockIndex::~BlockIndex()
+{
+   for (int i = 0; i < m_nLeaves; ++i) delete [] m_leaves[i];
+   delete [] m_leaves;
+}
+
+//------------------------------------------------------------------------------
+
+void BlockIndex::Init(int nBlocks)
+{
+   int n = (nBlocks + kLeafSize - 1) >> kLeafBits;
+
+   if (n <= m_nLeaves) return;
+
+   Block ***leaves = new Block**[n];
+   for (int i = 0; i < n; ++i) leaves[i] = (i < m_nLeaves ? m_leaves[i] : 0);
+   delete [] m_leaves;
+   m_leaves  = leaves;
+   m_nLeaves = n;
+}
+
+//------------------------------------------------------------------------------
+
+void BlockIndex::Insert(int i, Block *b)
+{
+   if ((i >> kLeafBits) >= m_nLeaves) Init(i + 1);
+
+   Block **&leaf = m_leaves[i >> kLeafBits];
+   if ( ! leaf)
+   {
+      leaf = new Block*[kLeafSize];
+      memset(leaf, 0, kLeafSize * sizeof(Block*));
+   }
+   if ( ! leaf[i & kLeafMask]) ++m_size;
+   leaf[i & kLeafMask] = b;
+}
+
+//------------------------------------------------------------------------------
+
+bool BlockIndex::Erase(int i)
+{
+   if (i < 0 || (i >> kLeafBits) >= m_nLeaves) return false;
+
+   Block **leaf = m_leaves[i >> kLeafBits];
+   if ( ! leaf || ! leaf[i & kLeafMask]) return false;
+
+   leaf[i & kLeafMask] = 0;
+   --m_size;
+   return true;
+}
+
+//------------------------------------------------------------------------------
+
+Block* BlockIndex::Next(int &i) const
+{
+   if (i < 0) i = 0;
+
+   for (int l = i >> kLeafBits; l < m_nLeaves && m_size; ++l)
+   {
+      Block **leaf = m_leaves[l];
+      if ( ! leaf) continue;
+      for (int k = (l == (i >> kLeafBits) ? i & kLeafMask : 0); k < kLeafSize; ++k)
+      {
+         if (leaf[k])
+         {
+            i = (l << kLeafBits) + k;
+            return leaf[k];
+         }
+      }
+   }
+   return 0;
+}
+
+//==============================================================================
+
 //------------------------------------------------------------------------------
 
 File::File(IO *io, const std::string& path, long long iOffset, long long iFileSize) :
@@ -60,20 +180,42 @@ File::File(IO *io, const std::string& path, long long iOffset, long long iFileSi
    m_filename(path),
    m_offset(iOffset),
    m_fileSize(iFileSize),
+   m_dataPath(path),
+   m_infoPath(path + Info::m_infoExtension),
+   m_diskOffset(iOffset),
+   m_sources(0),
    m_non_flushed_cnt(0),
    m_in_sync(false),
+   m_hot_file(false),
+   m_nHot(0),
+   m_verify_slot(0),
    m_downloadCond(0),
    m_prefetchState(kOff),
    m_prefetchReadCnt(0),
    m_prefetchHitCnt(0),
    m_prefetchScore(1),
-   m_detachTimeIsLogged(false)
-{
-   Open();
-}
+   m_detachTimeIsLogged(false),
+   m_ap_type(kApNone),
+   m_ap_first(-1),
+   m_ap_last(-1),
+   m_ap_stride(0),
+   m_ap_run(0),
+   m_ap_window(1),
+   m_ap_next(0),
+   m_ap_len(0),
+   m_ap_todo(0),
+   m_ap_done(0),
+   m_ap_time(0),
+   m_ap_rate(0),
+   m_ap_latency(0)
+{}
 
 File::~File()
 {
+   m_downloadCond.Lock();
+   free_hot_blocks();
+   m_downloadCond.UnLock();
+
    if (m_infoFile)
    {
       TRACEF(Debug, "File::~File() close info ");
@@ -90,7 +232,9 @@ File::~File()
       m_output = NULL;
    }
 
-   TRACEF(Debug, "File::~File() ended, prefetch score = " <<  m_prefetchScore);
+   delete m_sources;
+
+   TRACEF(Debug, "File::~File() ended, prefetch score = " <<  m_prefetchScore << ", joined requests = " << m_stats.m_ReqsJoined);
 }
 
 //------------------------------------------------------------------------------
@@ -129,27 +273,26 @@ bool File::ioActive()
       //    Block* b = it->second;
       //    TRACEF(Dump, "File::ioActive block idx = " <<  b->m_offset/m_cfi.GetBufferSize() << " prefetch = " << b->prefetch <<  " refcnt " << b->refcnt);
       // }
-      TRACEF(Info, "ioActive block_map.size() = " << m_block_map.size());
+      TRACEF(Info, "ioActive block_map.size() = " << m_block_index.Size());
+
+      // Blocks kept for reuse are not needed any more.
+      free_hot_blocks();
 
       // Remove failed blocks.
-      BlockMap_i itr = m_block_map.begin();
-      while (itr != m_block_map.end())
+      Block *b;
+      int    bi = 0;
+      while ((b = m_block_index.Next(bi)) != 0)
       {
-         if (itr->second->is_failed() && itr->second->m_refcnt == 1)
+         if (b->is_failed() && b->m_refcnt == 1)
          {
-            BlockMap_i toErase = itr;
-            ++itr;
-            TRACEF(Debug, "Remove failed block " <<  toErase->second->m_offset/m_cfi.GetBufferSize());
-            free_block(toErase->second);
-         }
-         else
-         {
-            ++itr;
+            TRACEF(Debug, "Remove failed block " <<  b->m_offset/m_cfi.GetBufferSize());
+            free_block(b);
          }
+         ++bi;
       }
 
       // Check if map is empty.
-      blockMapEmpty = m_block_map.empty();
+      blockMapEmpty = m_block_index.Empty();
    }
 
    return ! blockMapEmpty;
@@ -176,6 +319,7 @@ bool File::FinalizeSyncBeforeExit()
        Stats loc_stats = m_stats.Clone();
        m_cfi.WriteIOStatDetach(loc_stats);
        m_detachTimeIsLogged = true;
+       cache()->PurgeIndexTouch(m_filename + Info::m_infoExtension);
        TRACEF(Debug, "File::FinalizeSyncBeforeExit scheduling sync to write detach stats");
        return true;
      }
@@ -207,7 +351,7 @@ IO* File::SetIO(IO *io)
    IO* oldIO = m_io;
    m_downloadCond.Lock();
    m_io = io;
-   if (io && m_prefetchState != kComplete)
+   if (io && m_is_open && m_prefetchState != kComplete)
    {
       cacheActivatePrefetch = true;
       m_prefetchState = kOn;
@@ -220,6 +364,16 @@ IO* File::SetIO(IO *io)
 
 //------------------------------------------------------------------------------
 
+void File::SetContainer(const ContainerSlot &slot)
+{
+   m_dataPath   = slot.m_dataPath;
+   m_infoPath   = slot.m_indexPath;
+   m_diskOffset = 0;
+   m_cfi.SetImageOffset(slot.m_infoOffset);
+}
+
+//------------------------------------------------------------------------------
+
 bool File::Open()
 {
    TRACEF(Dump, "File::Open() open file for disk cache ");
@@ -234,22 +388,28 @@ bool File::Open()
    char size_str[32]; sprintf(size_str, "%lld", m_fileSize);
    myEnv.Put("oss.asize",  size_str);
    myEnv.Put("oss.cgroup", conf.m_data_space.c_str());
-   if (myOss.Create(myUser, m_filename.c_str(), 0600, myEnv, XRDOSS_mkpath) != XrdOssOK)
+   if (myOss.Create(myUser, m_dataPath.c_str(), 0600, myEnv, XRDOSS_mkpath) != XrdOssOK)
    {
-      TRACEF(Error, "File::Open() Create failed for data file " << m_filename << ERRNO_AND_ERRSTR);
+      TRACEF(Error, "File::Open() Create failed for data file " << m_dataPath << ERRNO_AND_ERRSTR);
       return false;
    }
 
    m_output = myOss.newFile(myUser);
-   if (m_output->Open(m_filename.c_str(), O_RDWR, 0600, myEnv) != XrdOssOK)
+   if (m_output->Open(m_dataPath.c_str(), O_RDWR, 0600, myEnv) != XrdOssOK)
    {
-      TRACEF(Error, "File::Open() Open failed for data file " << m_filename << ERRNO_AND_ERRSTR);
+      TRACEF(Error, "File::Open() Open failed for data file " << m_dataPath << ERRNO_AND_ERRSTR);
       delete m_output; m_output = 0;
       return false;
    }
 
+   // In a container the extent of the block is allocated in one go.
+   if (m_diskOffset != m_offset && m_output->getFD() >= 0)
+   {
+      posix_fallocate(m_output->getFD(), m_offset, m_fileSize);
+   }
+
    // Create the info file
-   std::string ifn = m_filename + Info::m_infoExtension;
+   const std::string &ifn = m_infoPath;
 
    struct stat infoStat;
    bool fileExisted = (myOss.Stat(ifn.c_str(), &infoStat) == XrdOssOK);
@@ -288,8 +448,12 @@ bool File::Open()
 
    m_cfi.WriteIOStatAttach();
    m_downloadCond.Lock();
-   m_is_open = true;
-   m_prefetchState = (m_cfi.IsComplete()) ? kComplete : kOn;
+   m_block_index.Init(m_cfi.GetSizeInBits());
+   // With async open the file may have been detached in the meantime.
+   if (m_cfi.IsComplete()) m_prefetchState = kComplete;
+      else m_prefetchState = m_io ? kOn : kStopped;
+   __atomic_store_n(&m_is_open, true, __ATOMIC_RELEASE);
+   m_hot_file = conf.m_NHotBlocks > 0 && (int) m_cfi.GetAccessCnt() >= conf.m_hotAccessCnt;
    m_downloadCond.UnLock();
 
    if (m_prefetchState == kOn) cache()->RegisterPrefetchFile(this);
@@ -297,6 +461,28 @@ bool File::Open()
 }
 
 
+//------------------------------------------------------------------------------
+
+void File::OpenSources(const std::string &url)
+{
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+      if (m_prefetchState == kComplete || m_prefetchState == kStopped) return;
+   }
+
+   SourceSet *ss = new SourceSet;
+   int n = ss->Open(url, Cache::GetInstance().RefConfiguration().m_multiSource, m_fileSize);
+   if (n == 0)
+   {
+      delete ss;
+      return;
+   }
+
+   TRACEF(Info, "File::OpenSources() fetching blocks from " << n << " extra sources");
+   __atomic_store_n(&m_sources, ss, __ATOMIC_RELEASE);
+}
+
+
 //==============================================================================
 // Read and helpers
 //==============================================================================
@@ -350,12 +536,12 @@ Block* File::PrepareBlockRequest(int i, bool prefetch)
 
    Block *b = new Block(this, off, this_bs, prefetch); // should block be reused to avoid recreation
 
-   m_block_map[i] = b;
+   m_block_index.Insert(offsetIdx(i), b);
 
    // Actual Read request is issued in ProcessBlockRequests().
    TRACEF(Dump, "File::PrepareBlockRequest() " <<  i << " prefetch " <<  prefetch << " address " << (void*) b);
 
-   if (m_prefetchState == kOn && (int) m_block_map.size() > Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks)
+   if (m_prefetchState == kOn && m_block_index.Size() - m_nHot > Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks)
    {
       m_prefetchState = kHold;
       cache()->DeRegisterPrefetchFile(this);
@@ -368,11 +554,29 @@ void File::ProcessBlockRequests(BlockList_t& blks)
 {
    // This *must not* be called with block_map locked.
 
+   SourceSet *sources = __atomic_load_n(&m_sources, __ATOMIC_ACQUIRE);
+
+   int n_fg = 0;
+   for (BlockList_i bi = blks.begin(); bi != blks.end(); ++bi)
+   {
+      if ( ! (*bi)->m_prefetch) ++n_fg;
+   }
+   if (n_fg) cache()->ForegroundRequests(n_fg);
+
    for (BlockList_i bi = blks.begin(); bi != blks.end(); ++bi)
    {
       Block *b = *bi;
-      BlockResponseHandler* oucCB = new BlockResponseHandler(b);
-      m_io->GetInput()->Read(*oucCB, b->get_buff(), b->get_offset(), b->get_size());
+      b->m_req_time = usecNow();
+      if (sources) b->m_source = sources->Pick(b->get_size());
+      if (b->m_source > 0)
+      {
+         sources->Read(b->m_source, b);
+      }
+      else
+      {
+         BlockResponseHandler* oucCB = new BlockResponseHandler(b);
+         m_io->GetInput()->Read(*oucCB, b->get_buff(), b->get_offset(), b->get_size());
+      }
    }
 }
 
@@ -407,6 +611,162 @@ int File::RequestBlocksDirect(DirectResponseHandler *handler, IntList_t& blocks,
 
 //------------------------------------------------------------------------------
 
+bool File::IsOnDisk(long long req_off, long long req_size)
+{
+   // May be called without the download lock, see Info::TestBit().
+   // Blocks kept in RAM are served by the slow path.
+
+   if (__atomic_load_n(&m_nHot, __ATOMIC_RELAXED) > 0) return false;
+
+   if (req_size <= 0 || req_off + req_size > m_offset + m_fileSize) return false;
+
+   const long long BS        = m_cfi.GetBufferSize();
+   const int       idx_first = req_off / BS;
+   const int       idx_last  = (req_off + req_size - 1) / BS;
+
+   for (int block_idx = idx_first; block_idx <= idx_last; ++block_idx)
+   {
+      const int i = offsetIdx(block_idx);
+      if (i < 0 || i >= m_cfi.GetSizeInBits() || ! m_cfi.TestBit(i))
+         return false;
+   }
+   return true;
+}
+
+//------------------------------------------------------------------------------
+
+DirectJoin* File::JoinDirectFetch(int blk, char* req_buf, long long req_off, long long req_size)
+{
+   // Must be called w/ block_map locked.
+   // Join a direct fetch in progress that contains the part of the request
+   // falling into the block.
+
+   long long off, blk_off, size;
+   const long long BS = m_cfi.GetBufferSize();
+
+   overlap(blk, BS, req_off, req_size, off, blk_off, size);
+   const long long file_off = blk * BS + blk_off;
+
+   std::pair<DirectFetchMap_i, DirectFetchMap_i> r = m_direct_fetches.equal_range(blk);
+   for (DirectFetchMap_i i = r.first; i != r.second; ++i)
+   {
+      DirectFetch *df = i->second;
+      if (df->m_offset <= file_off && file_off + size <= df->m_offset + df->m_size)
+      {
+         DirectJoin *dj = new DirectJoin(df, req_buf + off, file_off, size);
+         df->m_joins.push_back(dj);
+         return dj;
+      }
+   }
+   return 0;
+}
+
+//------------------------------------------------------------------------------
+
+DirectFetch* File::AddDirectFetch(int blk, char* req_buf, long long req_off, long long req_size)
+{
+   // Must be called w/ block_map locked.
+
+   long long off, blk_off, size;
+   const long long BS = m_cfi.GetBufferSize();
+
+   overlap(blk, BS, req_off, req_size, off, blk_off, size);
+
+   DirectFetch *df = new DirectFetch(req_buf + off, blk * BS + blk_off, size);
+   m_direct_fetches.insert(std::make_pair(blk, df));
+   return df;
+}
+
+//------------------------------------------------------------------------------
+
+void File::FinishDirectFetches(DirectFetchList_t& fetches, int err)
+{
+   // Called by the fetcher once its direct reads have arrived, before it
+   // waits for anything else so that joined readers can not deadlock.
+
+   if (fetches.empty()) return;
+
+   const long long BS = m_cfi.GetBufferSize();
+
+   XrdSysCondVarHelper _lck(m_downloadCond);
+
+   for (DirectFetchList_t::iterator i = fetches.begin(); i != fetches.end(); ++i)
+   {
+      DirectFetch *df = *i;
+
+      std::pair<DirectFetchMap_i, DirectFetchMap_i> r = m_direct_fetches.equal_range(df->m_offset / BS);
+      for (DirectFetchMap_i mi = r.first; mi != r.second; ++mi)
+      {
+         if (mi->second == df) { m_direct_fetches.erase(mi); break; }
+      }
+
+      for (DirectJoinList_t::iterator j = df->m_joins.begin(); j != df->m_joins.end(); ++j)
+      {
+         DirectJoin *dj = *j;
+         if (err == 0)
+            memcpy(dj->m_buff, df->m_buff + (dj->m_offset - df->m_offset), dj->m_size);
+         dj->m_errno = err;
+         dj->m_done  = true;
+         dj->m_fetch = 0;
+      }
+      delete df;
+   }
+   fetches.clear();
+
+   m_downloadCond.Broadcast();
+}
+
+//------------------------------------------------------------------------------
+
+void File::CancelDirect(DirectFetchList_t& fetches, DirectJoinList_t& joins)
+{
+   // Must be called w/ block_map locked, before the lock was released after
+   // the fetches were added and the joins made.
+
+   for (DirectJoinList_t::iterator j = joins.begin(); j != joins.end(); ++j)
+   {
+      DirectJoinList_t &jl = (*j)->m_fetch->m_joins;
+      jl.erase(std::find(jl.begin(), jl.end(), *j));
+      delete *j;
+   }
+   joins.clear();
+
+   for (DirectFetchList_t::iterator i = fetches.begin(); i != fetches.end(); ++i)
+   {
+      for (DirectFetchMap_i mi = m_direct_fetches.begin(); mi != m_direct_fetches.end(); ++mi)
+      {
+         if (mi->second == *i) { m_direct_fetches.erase(mi); break; }
+      }
+      delete *i;
+   }
+   fetches.clear();
+}
+
+//------------------------------------------------------------------------------
+
+int File::WaitDirectJoins(DirectJoinList_t& joins)
+{
+   // Returns the number of bytes received or the first error.
+
+   int total = 0, err = 0;
+
+   XrdSysCondVarHelper _lck(m_downloadCond);
+
+   for (DirectJoinList_t::iterator j = joins.begin(); j != joins.end(); ++j)
+   {
+      while ( ! (*j)->m_done) m_downloadCond.Wait();
+
+      if ((*j)->m_errno && ! err) err = (*j)->m_errno;
+      total += (*j)->m_size;
+      delete *j;
+   }
+   joins.clear();
+
+   return err ? err : total;
+}
+
+//------------------------------------------------------------------------------
+
 int File::ReadBlocksFromDisk(std::list<int>& blocks,
                              char* req_buf, long long req_off, long long req_size)
 {
@@ -426,7 +786,7 @@ int File::ReadBlocksFromDisk(std::list<int>& blocks,
 
       overlap(*ii, BS, req_off, req_size, off, blk_off, size);
 
-      long long rs = m_output->Read(req_buf + off, *ii * BS + blk_off -m_offset, size);
+      long long rs = m_output->Read(req_buf + off, *ii * BS + blk_off - m_diskOffset, size);
       TRACEF(Dump, "File::ReadBlocksFromDisk block idx = " <<  *ii << " size= " << size);
 
       if (rs < 0)
@@ -441,6 +801,11 @@ int File::ReadBlocksFromDisk(std::list<int>& blocks,
          return -1;
       }
 
+      if (! verify_blocks(req_buf + off, *ii * BS + blk_off, size))
+      {
+         return -EIO;
+      }
+
       total += rs;
    }
 
@@ -449,7 +814,7 @@ int File::ReadBlocksFromDisk(std::list<int>& blocks,
 
 //------------------------------------------------------------------------------
 
-int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
+int File::Read(char* iUserBuff, long long iUserOff, int iUserSize, Stats *ioStats)
 {
    if ( ! isOpen())
    {
@@ -460,6 +825,53 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
 
    Stats loc_stats;
 
+   // Cache hit on blocks that are all on disk. The download bitmap is read
+   // atomically so these are served without taking the download lock, which
+   // is then only needed to account for prefetch hits.
+   if (IsOnDisk(iUserOff, iUserSize))
+   {
+      if (m_prefetchState == kOn || m_prefetchState == kHold)
+      {
+         XrdSysCondVarHelper _lck(m_downloadCond);
+         RecordAccess(iUserOff / BS, (iUserOff + iUserSize - 1) / BS, 0);
+      }
+
+      XrdSysProbe3(xrdpfc, read__hit, this, iUserOff, iUserSize);
+      int rs = m_output->Read(iUserBuff, iUserOff - m_diskOffset, iUserSize);
+      TRACEF(Dump, "File::Read() " << (void*)iUserBuff << " all on disk, size = " << rs);
+
+      if (rs != iUserSize)
+      {
+         TRACEF(Error, "File::Read() failed read from disk rc = " << rs);
+         return -1;
+      }
+
+      if (verify_blocks(iUserBuff, iUserOff, iUserSize))
+      {
+         if (m_hot_file) promote_hot_blocks(iUserBuff, iUserOff, iUserSize);
+
+         int prefetchHitsDisk = 0;
+         for (int block_idx = iUserOff / BS; block_idx <= (iUserOff + iUserSize - 1) / BS; ++block_idx)
+         {
+            if (m_cfi.TestPrefetchBit(offsetIdx(block_idx)))
+               prefetchHitsDisk++;
+         }
+         if (prefetchHitsDisk)
+         {
+            XrdSysCondVarHelper _lck(m_downloadCond);
+            m_prefetchHitCnt += prefetchHitsDisk;
+            m_prefetchScore = float(m_prefetchHitCnt)/m_prefetchReadCnt;
+         }
+
+         loc_stats.m_BytesDisk = rs;
+         m_stats.AddStats(loc_stats);
+         if (ioStats) ioStats->AddStats(loc_stats);
+         return rs;
+      }
+      // Blocks that failed verification were dropped from the download
+      // bitmap and are fetched again by the general path below.
+   }
+
    // lock
    // loop over reqired blocks:
    //   - if on disk, ok;
@@ -477,30 +889,47 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
    const int idx_first = iUserOff / BS;
    const int idx_last  = (iUserOff + iUserSize - 1) / BS;
 
+   RecordAccess(idx_first, idx_last, 0);
+
    BlockList_t blks_to_request, blks_to_process, blks_processed;
    IntList_t   blks_on_disk,    blks_direct;
 
+   DirectFetchList_t direct_fetches;
+   DirectJoinList_t  direct_joins;
+   DirectJoin       *dj;
+
    for (int block_idx = idx_first; block_idx <= idx_last; ++block_idx)
    {
       TRACEF(Dump, "File::Read() idx " << block_idx);
-      BlockMap_i bi = m_block_map.find(block_idx);
+      Block *bp = m_block_index.Find(offsetIdx(block_idx));
 
       // In RAM or incoming?
-      if (bi != m_block_map.end())
+      if (bp)
       {
-         inc_ref_count(bi->second);
-         TRACEF(Dump, "File::Read() " << iUserBuff << "inc_ref_count for existing block << " << bi->second << " idx = " <<  block_idx);
-         blks_to_process.push_front(bi->second);
+         XrdSysProbe2(xrdpfc, block__ram, this, block_idx);
+         if ( ! bp->is_finished()) ++loc_stats.m_ReqsJoined;
+         inc_ref_count(bp);
+         TRACEF(Dump, "File::Read() " << iUserBuff << "inc_ref_count for existing block << " << bp << " idx = " <<  block_idx);
+         blks_to_process.push_front(bp);
       }
       // On disk?
       else if (m_cfi.TestBit(offsetIdx(block_idx)))
       {
          TRACEF(Dump, "File::Read()  read from disk " <<  (void*)iUserBuff << " idx = " << block_idx);
+         XrdSysProbe2(xrdpfc, block__disk, this, block_idx);
          blks_on_disk.push_back(block_idx);
       }
+      // Being read directly by someone else?
+      else if ((dj = JoinDirectFetch(block_idx, iUserBuff, iUserOff, iUserSize)))
+      {
+         TRACEF(Dump, "File::Read() join direct fetch " << block_idx);
+         ++loc_stats.m_ReqsJoined;
+         direct_joins.push_back(dj);
+      }
       // Then we have to get it ...
       else
       {
+         XrdSysProbe2(xrdpfc, block__miss, this, block_idx);
          // Is there room for one more RAM Block?
          if (cache()->RequestRAMBlock())
          {
@@ -520,10 +949,13 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
          {
             TRACEF(Dump, "File::Read() direct block " << block_idx);
             blks_direct.push_back(block_idx);
+            direct_fetches.push_back(AddDirectFetch(block_idx, iUserBuff, iUserOff, iUserSize));
          }
       }
    }
 
+   if ( ! preProcOK) CancelDirect(direct_fetches, direct_joins);
+
    m_downloadCond.UnLock();
 
    if ( ! preProcOK)
@@ -551,6 +983,9 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
       // failed to send direct client request
       if (direct_size < 0)
       {
+         FinishDirectFetches(direct_fetches, -EIO);
+         WaitDirectJoins(direct_joins);
+         XrdSysCondVarHelper _lck(m_downloadCond);
          for (BlockList_i i = blks_to_process.begin(); i!= blks_to_process.end(); ++i )
             dec_ref_count(*i);
          delete direct_handler;
@@ -568,6 +1003,7 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
       {
          bytes_read += rc;
          loc_stats.m_BytesDisk += rc;
+         if (m_hot_file) promote_hot_blocks(iUserBuff, iUserOff, iUserSize);
       }
       else
       {
@@ -644,8 +1080,9 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
       finished.clear();
    }
 
-   // Fourth, make sure all direct requests have arrived
-   if (direct_handler != 0 && bytes_read >= 0)
+   // Fourth, make sure all direct requests have arrived and pass their data
+   // to the readers that joined them.
+   if (direct_handler != 0)
    {
       TRACEF(Dump, "File::Read() waiting for direct requests ");
 
@@ -656,6 +1093,8 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
          direct_handler->m_cond.Wait();
       }
 
+      FinishDirectFetches(direct_fetches, direct_handler->m_errno);
+
       if (direct_handler->m_errno == 0)
       {
          bytes_read += direct_size;
@@ -674,6 +1113,23 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
 
       delete direct_handler;
    }
+
+   // Fifth, wait for the direct requests of others we joined.
+   if ( ! direct_joins.empty())
+   {
+      int rc = WaitDirectJoins(direct_joins);
+      if (rc >= 0)
+      {
+         bytes_read += rc;
+         loc_stats.m_BytesMissed += rc;
+      }
+      else if ( ! error_cond)
+      {
+         error_cond = true;
+         errno = -rc;
+         TRACEF(Error, "File::Read(), joined direct read finished with error " << errno << " " << strerror(errno));
+      }
+   }
    assert(iUserSize >= bytes_read);
 
    // Last, stamp and release blocks, release file.
@@ -700,6 +1156,7 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
    }
 
    m_stats.AddStats(loc_stats);
+   if (ioStats) ioStats->AddStats(loc_stats);
 
    return error_cond ? -1ll : bytes_read;
 }
@@ -712,12 +1169,13 @@ void File::WriteBlockToDisk(Block* b)
    // write block buffer into disk file
    long long offset = b->m_offset - m_offset;
    long long size = (offset +  m_cfi.GetBufferSize()) > m_fileSize ? (m_fileSize - offset) : m_cfi.GetBufferSize();
+   long long disk_offset = b->m_offset - m_diskOffset;
    int buffer_remaining = size;
    int buffer_offset = 0;
    int cnt = 0;
    const char* buff = &b->m_buff[0];
    while ((buffer_remaining > 0) && // There is more to be written
-          (((retval = m_output->Write(buff, offset + buffer_offset, buffer_remaining)) != -1)
+          (((retval = m_output->Write(buff, disk_offset + buffer_offset, buffer_remaining)) != -1)
            || (errno == EINTR))) // Write occurs without an error
    {
       buffer_remaining -= retval;
@@ -737,36 +1195,75 @@ void File::WriteBlockToDisk(Block* b)
 
    // set bit fetched
    TRACEF(Dump, "File::WriteToDisk() success set bit for block " <<  b->m_offset << " size " <<  size);
-   int pfIdx =  (b->m_offset - m_offset)/m_cfi.GetBufferSize();
 
-   bool schedule_sync = false;
+   const uint32_t cksum = Cache::GetInstance().RefConfiguration().m_block_cksum ?
+                          XrdOucCRC::Calc32C(b->m_buff, size) : 0;
+
+   bool schedule_sync;
    {
       XrdSysCondVarHelper _lck(m_downloadCond);
 
-      m_cfi.SetBitWritten(pfIdx);
+      schedule_sync = mark_block_written(b, cksum);
+   }
 
-      if (b->m_prefetch)
-         m_cfi.SetBitPrefetch(pfIdx);
+   if (schedule_sync)
+   {
+      cache()->ScheduleFileSync(this);
+   }
+}
 
-      // clLog()->Dump(XrdCl::AppMsg, "File::WriteToDisk() dec_ref_count %d %s", pfIdx, lPath());
-      dec_ref_count(b);
+//------------------------------------------------------------------------------
+
+void File::WriteBlocksToDisk(std::vector<Block*>& blks)
+{
+   // Write several blocks with one vector write. If that fails the blocks are
+   // written one by one, which also retries and reports the failing one.
 
+   std::sort(blks.begin(), blks.end(), block_offset_less);
 
-      // set bit synced
-      if (m_in_sync)
+   std::vector<XrdOucIOVec> iov(blks.size());
+   long long total = 0;
+
+   for (size_t i = 0; i < blks.size(); ++i)
+   {
+      Block *b = blks[i];
+      long long offset = b->m_offset - m_offset;
+
+      iov[i].offset = b->m_offset - m_diskOffset;
+      iov[i].size   = (offset + m_cfi.GetBufferSize()) > m_fileSize ? (m_fileSize - offset) : m_cfi.GetBufferSize();
+      iov[i].info   = 0;
+      iov[i].data   = b->get_buff();
+      total += iov[i].size;
+   }
+
+   ssize_t retval = m_output->WriteV(&iov[0], (int) iov.size());
+   if (retval != total)
+   {
+      TRACEF(Warning, "File::WriteBlocksToDisk() vector write of " << blks.size() << " blocks failed, retval " << retval
+                      << "; writing blocks one by one.");
+      for (size_t i = 0; i < blks.size(); ++i)
       {
-         m_writes_during_sync.push_back(pfIdx);
+         WriteBlockToDisk(blks[i]);
       }
-      else
+      return;
+   }
+
+   TRACEF(Dump, "File::WriteBlocksToDisk() success for " << blks.size() << " blocks, " << total << " bytes");
+
+   std::vector<uint32_t> cksums(blks.size(), 0);
+   if (Cache::GetInstance().RefConfiguration().m_block_cksum)
+   {
+      for (size_t i = 0; i < blks.size(); ++i)
+         cksums[i] = XrdOucCRC::Calc32C(iov[i].data, iov[i].size);
+   }
+
+   bool schedule_sync = false;
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+
+      for (size_t i = 0; i < blks.size(); ++i)
       {
-         m_cfi.SetBitSynced(pfIdx);
-         ++m_non_flushed_cnt;
-         if (m_non_flushed_cnt >= Cache::GetInstance().RefConfiguration().m_flushCnt)
-         {
-            schedule_sync     = true;
-            m_in_sync         = true;
-            m_non_flushed_cnt = 0;
-         }
+         if (mark_block_written(blks[i], cksums[i])) schedule_sync = true;
       }
    }
 
@@ -778,6 +1275,134 @@ void File::WriteBlockToDisk(Block* b)
 
 //------------------------------------------------------------------------------
 
+bool File::mark_block_written(Block* b, uint32_t cksum)
+{
+   // Called under lock after the block was written. Returns true if the
+   // file should be synced.
+
+   int pfIdx =  (b->m_offset - m_offset)/m_cfi.GetBufferSize();
+
+   bool schedule_sync = false;
+
+   // The checksum must be in place before the block is seen as on disk.
+   if (Cache::GetInstance().RefConfiguration().m_block_cksum)
+      m_cfi.SetBlockCksum(pfIdx, cksum);
+
+   m_cfi.SetBitWritten(pfIdx);
+
+   if (b->m_prefetch)
+      m_cfi.SetBitPrefetch(pfIdx);
+
+   dec_ref_count(b);
+
+   // set bit synced
+   if (m_in_sync)
+   {
+      m_writes_during_sync.push_back(pfIdx);
+   }
+   else
+   {
+      m_cfi.SetBitSynced(pfIdx);
+      ++m_non_flushed_cnt;
+      if (m_non_flushed_cnt >= Cache::GetInstance().RefConfiguration().m_flushCnt)
+      {
+         schedule_sync     = true;
+         m_in_sync         = true;
+         m_non_flushed_cnt = 0;
+      }
+   }
+
+   return schedule_sync;
+}
+
+//------------------------------------------------------------------------------
+
+bool File::verify_blocks(const char* buff, long long off, long long size)
+{
+   // Check crc32c of the blocks read from disk. A block fully contained in
+   // the buffer is checked at once. For a block read in pieces the crc is
+   // extended as long as the pieces follow each other from the start of the
+   // block and checked when its end is reached; other partial reads are not
+   // checked. A block that does not match is dropped from the download
+   // bitmap so that it is fetched again. Returns false if any block did not
+   // match.
+
+   if ( ! Cache::GetInstance().RefConfiguration().m_block_cksum_verify) return true;
+
+   const long long BS  = m_cfi.GetBufferSize();
+   const long long end = off + size;
+   bool            ok  = true;
+
+   for (long long blk_off = (off / BS) * BS; blk_off < end; blk_off += BS)
+   {
+      const long long blk_end = std::min(blk_off + BS, m_offset + m_fileSize);
+      const long long lo      = std::max(off, blk_off);
+      const long long hi      = std::min(end, blk_end);
+
+      const int idx = offsetIdx(blk_off / BS);
+      uint32_t  cksum;
+      if ( ! m_cfi.GetBlockCksum(idx, cksum)) continue;
+
+      uint32_t crc = 0;
+      if (lo != blk_off || hi != blk_end)
+      {
+         // Piece of a block, find the stream it continues.
+         bool found = false;
+         {
+            XrdSysMutexHelper _lck(m_verify_mutex);
+            for (int i = 0; i < m_nVerifyStreams; ++i)
+            {
+               VerifyStream &vs = m_verify_streams[i];
+               if (vs.m_blk_off == blk_off && vs.m_next == lo)
+               {
+                  crc          = vs.m_crc;
+                  vs.m_blk_off = -1;
+                  found        = true;
+                  break;
+               }
+            }
+         }
+         if ( ! found && lo != blk_off) continue;
+
+         crc = XrdOucCRC::Calc32C(buff + (lo - off), hi - lo, crc);
+
+         if (hi != blk_end)
+         {
+            XrdSysMutexHelper _lck(m_verify_mutex);
+            int i;
+            for (i = 0; i < m_nVerifyStreams; ++i)
+               if (m_verify_streams[i].m_blk_off < 0) break;
+            if (i == m_nVerifyStreams)
+            {
+               i = m_verify_slot;
+               m_verify_slot = (m_verify_slot + 1) % m_nVerifyStreams;
+            }
+            m_verify_streams[i].m_blk_off = blk_off;
+            m_verify_streams[i].m_next    = hi;
+            m_verify_streams[i].m_crc     = crc;
+            continue;
+         }
+      }
+      else
+      {
+         crc = XrdOucCRC::Calc32C(buff + (lo - off), hi - lo);
+      }
+
+      if (crc != cksum)
+      {
+         TRACEF(Error, "File::verify_blocks() checksum mismatch for block " << idx << " at offset " << blk_off
+                       << ", block will be fetched again");
+         XrdSysCondVarHelper _lck(m_downloadCond);
+         m_cfi.ResetBitWritten(idx);
+         ok = false;
+      }
+   }
+
+   return ok;
+}
+
+//------------------------------------------------------------------------------
+
 void File::Sync()
 {
    TRACEF(Dump, "File::Sync()");
@@ -818,7 +1443,7 @@ void File::dec_ref_count(Block* b)
    assert(b->m_refcnt >= 0);
 
    // File::Read() can decrease ref count before waiting to be , prefetch starts with refcnt 0
-   if (b->m_refcnt == 0 && b->is_finished())
+   if (b->m_refcnt == 0 && b->is_finished() && ! keep_hot_block(b))
    {
       free_block(b);
    }
@@ -828,19 +1453,25 @@ void File::free_block(Block* b)
 {
    int i = b->m_offset/BufferSize();
    TRACEF(Dump, "File::free_block block " << b << "  idx =  " <<  i);
-   size_t ret = m_block_map.erase(i);
-   if (ret != 1)
+   if ( ! m_block_index.Erase(offsetIdx(i)))
    {
       // assert might be a better option than a warning
       TRACEF(Error, "File::free_block did not erase " <<  i  << " from map");
    }
+   else if (b->m_hot)
+   {
+      m_hot_list.erase(b->m_hot_it);
+      __atomic_store_n(&m_nHot, m_nHot - 1, __ATOMIC_RELAXED);
+      delete b;
+      cache()->HotBlockReleased();
+   }
    else
    {
       delete b;
       cache()->RAMBlockReleased();
    }
 
-   if (m_prefetchState == kHold && (int) m_block_map.size() < Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks)
+   if (m_prefetchState == kHold && m_block_index.Size() - m_nHot < Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks)
    {
       m_prefetchState = kOn;
       cache()->RegisterPrefetchFile(this);
@@ -849,14 +1480,124 @@ void File::free_block(Block* b)
 
 //------------------------------------------------------------------------------
 
+bool File::keep_hot_block(Block* b)
+{
+   // Called under lock when a finished block is no longer used. Returns true
+   // if the block stays in RAM. Only blocks that are on disk are kept so that
+   // they can be dropped at any time. When the hot budget is used up the least
+   // recently used block of this file makes room.
+
+   if (b->m_hot)
+   {
+      if ( ! m_hot_file) return false;
+      m_hot_list.splice(m_hot_list.begin(), m_hot_list, b->m_hot_it);
+      return true;
+   }
+
+   if ( ! m_hot_file || ! b->is_ok() || ! m_cfi.TestBit(offsetIdx(b->m_offset/BufferSize())))
+      return false;
+
+   if ( ! cache()->RequestHotBlock())
+   {
+      if (m_hot_list.empty() || m_hot_list.back()->m_refcnt > 0) return false;
+      free_block(m_hot_list.back());
+      if ( ! cache()->RequestHotBlock()) return false;
+   }
+
+   TRACEF(Dump, "File::keep_hot_block() " << (void*)b << " idx = " << b->m_offset/BufferSize());
+   m_hot_list.push_front(b);
+   b->m_hot_it = m_hot_list.begin();
+   b->m_hot    = true;
+   __atomic_store_n(&m_nHot, m_nHot + 1, __ATOMIC_RELAXED);
+   cache()->RAMBlockReleased();
+   return true;
+}
+
+//------------------------------------------------------------------------------
+
+void File::promote_hot_blocks(const char* buff, long long off, long long size)
+{
+   // Keep copies of the blocks just read from disk that are fully contained
+   // in the user buffer.
+
+   const long long BS  = m_cfi.GetBufferSize();
+   const long long end = std::min(off + size, m_offset + m_fileSize);
+
+   XrdSysCondVarHelper _lck(m_downloadCond);
+
+   for (long long blk = (off + BS - 1) / BS; blk * BS < end; ++blk)
+   {
+      const long long blk_off  = blk * BS;
+      const long long blk_size = std::min(BS, m_offset + m_fileSize - blk_off);
+
+      if (blk_off + blk_size > end) break;
+      if (m_block_index.Find(offsetIdx(blk)) || ! m_cfi.TestBit(offsetIdx(blk))) continue;
+
+      // The block is accounted as a regular RAM block until it becomes hot.
+      if ( ! cache()->RequestRAMBlock()) break;
+
+      Block *b = new Block(this, blk_off, blk_size, false);
+      memcpy(b->get_buff(), buff + (blk_off - off), blk_size);
+      b->m_downloaded = true;
+      m_block_index.Insert(offsetIdx(blk), b);
+
+      if ( ! keep_hot_block(b))
+      {
+         free_block(b);
+         break;
+      }
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void File::free_hot_blocks()
+{
+   // Called under lock. Blocks still being read are dropped when released.
+
+   BlockList_i i = m_hot_list.begin();
+   while (i != m_hot_list.end())
+   {
+      Block *b = *i++;
+      if (b->m_refcnt == 0) free_block(b);
+   }
+   m_hot_file = false;
+}
+
+//------------------------------------------------------------------------------
+
 void File::ProcessBlockResponse(Block* b, int res)
 {
+   if (b->m_source >= 0)
+   {
+      m_sources->Done(b->m_source, b->get_size(), usecNow() - b->m_req_time, res >= 0);
+
+      // A block that failed on an extra source is fetched again from the origin.
+      if (res < 0 && b->m_source > 0)
+      {
+         TRACEF(Info, "File::ProcessBlockResponse refetching block " << (int)(b->m_offset/BufferSize()) << " from origin");
+         b->m_source   = -1;
+         b->m_req_time = usecNow();
+         BlockResponseHandler* oucCB = new BlockResponseHandler(b);
+         m_io->GetInput()->Read(*oucCB, b->get_buff(), b->get_offset(), b->get_size());
+         return;
+      }
+   }
+
+   if ( ! b->m_prefetch) cache()->ForegroundRequests(-1);
+
    XrdSysCondVarHelper _lck(m_downloadCond);
 
    TRACEF(Dump, "File::ProcessBlockResponse " << (void*)b << "  " << b->m_offset/BufferSize());
+   XrdSysProbe3(xrdpfc, block__fetched, this, b->m_offset, res);
 
    if (res >= 0)
    {
+      if (b->m_req_time)
+      {
+         double lat = (usecNow() - b->m_req_time) / 1e6;
+         m_ap_latency = m_ap_latency > 0 ? 0.8 * m_ap_latency + 0.2 * lat : lat;
+      }
       b->m_downloaded = true;
       // Increase ref-count or the writer.
       TRACEF(Dump, "File::ProcessBlockResponse inc_ref_count " <<  (int)(b->m_offset/BufferSize()));
@@ -902,7 +1643,7 @@ int File::offsetIdx(int iIdx)
 
 //------------------------------------------------------------------------------
 
-void File::Prefetch()
+int File::Prefetch()
 {
    // Check that block is not on disk and not in RAM.
    // TODO: Could prefetch several blocks at once!
@@ -914,15 +1655,31 @@ void File::Prefetch()
       XrdSysCondVarHelper _lck(m_downloadCond);
 
       if (m_prefetchState != kOn)
-         return;
+         return 0;
 
-      for (int f = 0; f < m_cfi.GetSizeInBits(); ++f)
+      // First the blocks predicted from the access pattern.
+      int p;
+      while (m_prefetchState == kOn && (int) blks.size() < m_ap_window &&
+             (p = NextPredictedBlock()) >= 0)
+      {
+         if ( ! cache()->RequestRAMBlock())
+         {
+            --m_ap_done;
+            break;
+         }
+         TRACEF(Dump, "File::Prefetch take predicted block " << p);
+         blks.push_back( PrepareBlockRequest(p, true) );
+         m_prefetchReadCnt++;
+         m_prefetchScore = float(m_prefetchHitCnt)/m_prefetchReadCnt;
+      }
+
+      // Otherwise the first block that is not there yet.
+      for (int f = 0; blks.empty() && f < m_cfi.GetSizeInBits(); ++f)
       {
          if ( ! m_cfi.TestBit(f))
          {
             f += m_offset/m_cfi.GetBufferSize();
-            BlockMap_i bi = m_block_map.find(f);
-            if (bi == m_block_map.end())
+            if ( ! m_block_index.Find(offsetIdx(f)))
             {
                TRACEF(Dump, "File::Prefetch take block " << f);
                cache()->RequestRAMBlock();
@@ -948,8 +1705,121 @@ void File::Prefetch()
       m_downloadCond.UnLock();
       cache()->DeRegisterPrefetchFile(this);
    }
+   return (int) blks.size();
+}
+
+
+//------------------------------------------------------------------------------
+
+void File::RecordAccess(int first, int last, int nblks)
+{
+   // Must be called w/ block_map locked.
+   // Classifies the request against the previous one and predicts the blocks
+   // that the following requests will need. A request that starts within or
+   // shortly after the previous one and extends it is sequential; this also
+   // covers ROOT reading consecutive basket clusters with vector reads. A
+   // request displaced by the same number of blocks as the previous one is
+   // strided. nblks is the number of blocks touched when not contiguous.
+
+   const int max_blocks = Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks;
+   if (max_blocks <= 0) return;
+
+   const int       len = nblks > 0 ? nblks : last - first + 1;
+   const long long now = usecNow();
+
+   if (m_ap_time && now > m_ap_time)
+   {
+      double rate = len / ((now - m_ap_time) / 1e6);
+      m_ap_rate = m_ap_rate > 0 ? 0.8 * m_ap_rate + 0.2 * rate : rate;
+   }
+   m_ap_time = now;
+
+   AccessPattern_e type = kApNone;
+   const int stride = first - m_ap_first;
+
+   if (m_ap_last >= 0 && first >= m_ap_first && first <= m_ap_last + len && last > m_ap_last)
+      type = kApSequential;
+   else if (m_ap_first >= 0 && stride > 0 && stride == m_ap_stride)
+      type = kApStrided;
+
+   m_ap_run    = (type == kApNone) ? 0 : (type == m_ap_type ? m_ap_run + 1 : 1);
+   m_ap_type   = type;
+   m_ap_stride = stride;
+   m_ap_first  = first;
+   m_ap_last   = last;
+
+   if (type == kApNone)
+   {
+      m_ap_todo = m_ap_done = 0;
+      return;
+   }
+
+   // Prefetch enough blocks to hide the origin latency at the observed rate.
+   // Keep growing the window while prefetched blocks are used, halve it when
+   // most of them are not.
+   const int need = (int) (m_ap_latency * m_ap_rate) + 1;
+
+   if (m_prefetchScore < 0.5)
+      m_ap_window = std::max(1, m_ap_window / 2);
+   else
+      m_ap_window = std::max(need, m_ap_window + 1);
+   if (m_ap_window > max_blocks) m_ap_window = max_blocks;
+
+   if (type == kApSequential)
+   {
+      m_ap_next = last + 1;
+      m_ap_len  = m_ap_window;
+   }
+   else
+   {
+      m_ap_next = first + stride;
+      m_ap_len  = std::min(len, m_ap_window);
+   }
+   m_ap_todo = m_ap_window;
+   m_ap_done = 0;
+
+   TRACEF(Dump, "File::RecordAccess " << first << "-" << last << " pattern " << type
+          << " run " << m_ap_run << " window " << m_ap_window << " next " << m_ap_next);
+}
+
+//------------------------------------------------------------------------------
+
+int File::NextPredictedBlock()
+{
+   // Must be called w/ block_map locked.
+   // Returns the next predicted block that is neither on disk nor in RAM,
+   // or -1 when there is none.
+
+   while (m_ap_done < m_ap_todo)
+   {
+      const int k = m_ap_done++;
+      const int b = m_ap_next + (k / m_ap_len) * m_ap_stride + (k % m_ap_len);
+      const int i = offsetIdx(b);
+
+      if (i < 0 || i >= m_cfi.GetSizeInBits())
+      {
+         if (m_ap_type == kApSequential) m_ap_done = m_ap_todo;
+         continue;
+      }
+      if (m_cfi.TestBit(i) || m_block_index.Find(i)) continue;
+
+      return b;
+   }
+   return -1;
 }
 
+//------------------------------------------------------------------------------
+
+double File::GetPrefetchUrgency() const
+{
+   // Read without the lock, the value is only used to order files. The blocks
+   // handled from the prediction lie ahead of the reader's last request.
+
+   if (m_ap_done >= m_ap_todo || m_ap_rate <= 0) return -1;
+   if (usecNow() - m_ap_time > 10000000ll)       return -1;
+
+   return m_ap_done / m_ap_rate;
+}
 
 //------------------------------------------------------------------------------
 
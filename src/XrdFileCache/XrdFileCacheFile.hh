@@ -28,6 +28,8 @@
 #include "XrdFileCacheStats.hh"
 
 #include <string>
+#include <list>
+#include <vector>
 #include <map>
 
 class XrdJob;
@@ -43,6 +45,7 @@ namespace XrdFileCache
 class BlockResponseHandler;
 class DirectResponseHandler;
 class IO;
+class SourceSet;
 
 struct ReadVBlockListRAM;
 struct ReadVChunkListRAM;
@@ -56,38 +59,86 @@ namespace XrdFileCache
 
 class File;
 
+//! Place of a file block in the container files of IOFileBlock.
+struct ContainerSlot
+{
+   std::string m_dataPath;     //!< container data file
+   std::string m_indexPath;    //!< container index file
+   long long   m_infoOffset;   //!< offset of the block's info image in the index
+
+   ContainerSlot() : m_infoOffset(0) {}
+};
+
 class Block
 {
 public:
-   std::vector<char>   m_buff;
+   char               *m_buff;                          // slot from Cache's RAM pool
+   int                 m_size;
    long long           m_offset;
    File               *m_file;
    bool                m_prefetch;
    int                 m_refcnt;
    int                 m_errno;                         // stores negative errno
    bool                m_downloaded;
+   long long           m_req_time;                      // request time in usec
+   bool                m_hot;                           // kept in RAM after use, see File::dec_ref_count()
+   std::list<Block*>::iterator m_hot_it;                // position in File's hot list
+   int                 m_source;                        // index in File's SourceSet, -1 if not accounted there
 
-   Block(File *f, long long off, int size, bool m_prefetch) :
-      m_offset(off), m_file(f), m_prefetch(m_prefetch), m_refcnt(0),
-      m_errno(0), m_downloaded(false)
-   {
-      m_buff.resize(size);
-   }
+   Block(File *f, long long off, int size, bool m_prefetch);
+   ~Block();
 
    char*     get_buff(long long pos = 0) { return &m_buff[pos]; }
-   int       get_size()   { return (int) m_buff.size(); }
+   int       get_size()   { return m_size; }
    long long get_offset() { return m_offset; }
 
    bool is_finished() { return m_downloaded || m_errno != 0; }
    bool is_ok()       { return m_downloaded; }
    bool is_failed()   { return m_errno != 0; }
 
-   void set_error_and_free(int err)
+   void set_error_and_free(int err);
+};
+
+// ================================================================
+
+//----------------------------------------------------------------------------
+//! Two level radix index of in-memory blocks keyed by block number relative
+//! to the start of the cached region. Leaves are allocated on first use and
+//! kept until the index is destroyed. Must be used under File's download lock.
+//----------------------------------------------------------------------------
+class BlockIndex
+{
+public:
+   BlockIndex() : m_leaves(0), m_nLeaves(0), m_size(0) {}
+   ~BlockIndex();
+
+   //! Size the top level for the given number of blocks.
+   void   Init(int nBlocks);
+
+   Block* Find(int i) const
    {
-      m_errno = err;
-      std::vector<char> x;
-      m_buff.swap(x);
+      if (i < 0 || (i >> kLeafBits) >= m_nLeaves) return 0;
+      Block **leaf = m_leaves[i >> kLeafBits];
+      return leaf ? leaf[i & kLeafMask] : 0;
    }
+
+   void   Insert(int i, Block *b);
+   bool   Erase(int i);
+
+   //! Return first block with index >= i and set i to its index, or 0.
+   Block* Next(int &i) const;
+
+   int    Size()  const { return m_size; }
+   bool   Empty() const { return m_size == 0; }
+
+private:
+   static const int kLeafBits = 8;
+   static const int kLeafSize = 1 << kLeafBits;
+   static const int kLeafMask = kLeafSize - 1;
+
+   Block ***m_leaves;
+   int      m_nLeaves;
+   int      m_size;
 };
 
 // ================================================================
@@ -122,6 +173,42 @@ public:
 
 // ================================================================
 
+struct DirectFetch;
+
+//----------------------------------------------------------------------------
+//! A reader waiting for part of a direct fetch of another reader.
+//----------------------------------------------------------------------------
+struct DirectJoin
+{
+   DirectFetch *m_fetch;
+   char        *m_buff;     // where the data goes
+   long long    m_offset;   // file offset
+   int          m_size;
+   int          m_errno;    // stores negative errno
+   bool         m_done;
+
+   DirectJoin(DirectFetch *f, char *b, long long off, int size) :
+      m_fetch(f), m_buff(b), m_offset(off), m_size(size), m_errno(0), m_done(false) {}
+};
+
+//----------------------------------------------------------------------------
+//! Direct read of part of a block from the origin, done when no RAM block
+//! was available. Other readers needing a range it contains join it and
+//! get their data copied from the fetcher's buffer instead of issuing
+//! another request. Under File's download lock.
+//----------------------------------------------------------------------------
+struct DirectFetch
+{
+   char                    *m_buff;     // fetcher's buffer
+   long long                m_offset;   // file offset
+   int                      m_size;
+   std::vector<DirectJoin*> m_joins;
+
+   DirectFetch(char *b, long long off, int size) : m_buff(b), m_offset(off), m_size(size) {}
+};
+
+// ================================================================
+
 class File
 {
 public:
@@ -137,17 +224,32 @@ public:
 
    void BlockRemovedFromWriteQ(Block*);
    //! Open file handle for data file and info file on local disk.
+   //! Called from Cache::GetFile() or, with async open, from a scheduler thread.
    bool Open();
 
+   //----------------------------------------------------------------------
+   //! \brief Store data and info in shared container files, see
+   //! IOFileBlock. Data is kept at its offset in the original file, the
+   //! info image at info_offset of the index file. Called before Open().
+   //----------------------------------------------------------------------
+   void SetContainer(const ContainerSlot &slot);
+
+   //----------------------------------------------------------------------
+   //! \brief Open extra origin sources of url to fetch blocks from in
+   //! parallel, see SourceSet. Blocking, called from a scheduler job.
+   //----------------------------------------------------------------------
+   void OpenSources(const std::string &url);
+
    //! Vector read from disk if block is already downloaded, else ReadV from client.
-   int ReadV (const XrdOucIOVec *readV, int n);
+   //! Where the bytes came from is added to ioStats, if given.
+   int ReadV (const XrdOucIOVec *readV, int n, Stats *ioStats = 0);
 
-   int Read(char* buff, long long offset, int size);
+   int Read(char* buff, long long offset, int size, Stats *ioStats = 0);
 
    //----------------------------------------------------------------------
    //! \brief Data and cinfo files are open.
    //----------------------------------------------------------------------
-   bool isOpen() const { return m_is_open; }
+   bool isOpen() const { return __atomic_load_n(&m_is_open, __ATOMIC_ACQUIRE); }
 
    //----------------------------------------------------------------------
    //! \brief Initiate close. Return true if still IO active.
@@ -180,10 +282,18 @@ public:
    void ProcessBlockResponse(Block* b, int res);
    void WriteBlockToDisk(Block* b);
 
-   void Prefetch();
+   //! Write blocks of this file taken together from the write queue.
+   void WriteBlocksToDisk(std::vector<Block*>& blks);
+
+   //! Request the next blocks to prefetch, returns the number requested.
+   int  Prefetch();
 
    float GetPrefetchScore() const;
 
+   //! Seconds until the reader reaches the end of the blocks prefetched for
+   //! it, -1 if no active reader follows a predicted access pattern.
+   double GetPrefetchUrgency() const;
+
    //! Log path
    const char* lPath() const;
 
@@ -213,10 +323,16 @@ private:
    XrdOssDF      *m_infoFile;           //!< file handle for data-info file on disk
    Info           m_cfi;                //!< download status of file blocks and access statistics
 
-   std::string    m_filename;           //!< filename of data file on disk
+   std::string    m_filename;           //!< name of the cached file, also of data file on disk
    long long      m_offset;             //!< offset of cached file for block-based operation
    long long      m_fileSize;           //!< size of cached disk file for block-based operation
 
+   std::string    m_dataPath;           //!< data file on disk
+   std::string    m_infoPath;           //!< info file on disk
+   long long      m_diskOffset;         //!< offset in original file of start of data file
+
+   SourceSet     *m_sources;            //!< extra origin sources, set once, read atomically
+
    // fsync
    std::vector<int>  m_writes_during_sync;
    int  m_non_flushed_cnt;
@@ -228,11 +344,36 @@ private:
    typedef std::list<Block*>     BlockList_t;
    typedef BlockList_t::iterator BlockList_i;
 
-   typedef std::map<int, Block*> BlockMap_t;
-   typedef BlockMap_t::iterator  BlockMap_i;
+   BlockIndex m_block_index;        //!< in-memory blocks, under m_downloadCond
+
+   // In-flight direct fetches by block index, under m_downloadCond.
+   typedef std::multimap<int, DirectFetch*> DirectFetchMap_t;
+   typedef DirectFetchMap_t::iterator       DirectFetchMap_i;
+
+   DirectFetchMap_t m_direct_fetches;
+
+   // Blocks of a hot file kept in RAM after use, most recently used first.
+   // Under m_downloadCond, m_nHot is also read atomically by IsOnDisk().
+   bool        m_hot_file;          //!< file was accessed often enough to keep its blocks
+   BlockList_t m_hot_list;
+   int         m_nHot;
+
+   // Running crc32c of blocks read from disk piece by piece, in order. A slot
+   // is taken out of the table while its crc is being extended.
+   struct VerifyStream
+   {
+      long long m_blk_off;             //!< offset of the block, -1 for a free slot
+      long long m_next;                //!< offset the next piece has to start at
+      uint32_t  m_crc;                 //!< crc32c of the block up to m_next
+
+      VerifyStream() : m_blk_off(-1), m_next(0), m_crc(0) {}
+   };
 
+   static const int m_nVerifyStreams = 4;
 
-   BlockMap_t m_block_map;
+   VerifyStream  m_verify_streams[m_nVerifyStreams];
+   int           m_verify_slot;       //!< slot to reuse next
+   XrdSysMutex   m_verify_mutex;
 
    XrdSysCondVar m_downloadCond;
 
@@ -246,6 +387,26 @@ private:
    
    bool  m_detachTimeIsLogged;
 
+   // Access pattern detection, drives prefetching. Under m_downloadCond.
+   enum AccessPattern_e { kApNone, kApSequential, kApStrided };
+
+   AccessPattern_e m_ap_type;
+   int    m_ap_first;                  //!< first block of last request
+   int    m_ap_last;                   //!< last block of last request
+   int    m_ap_stride;                 //!< blocks between starts of last two requests
+   int    m_ap_run;                    //!< number of requests matching the pattern
+   int    m_ap_window;                 //!< number of blocks to prefetch ahead
+   int    m_ap_next;                   //!< first predicted block
+   int    m_ap_len;                    //!< predicted blocks per request
+   int    m_ap_todo;                   //!< number of predicted blocks
+   int    m_ap_done;                   //!< number of predicted blocks handled
+   long long m_ap_time;                //!< time of last request in usec
+   double m_ap_rate;                   //!< smoothed request rate in blocks/s
+   double m_ap_latency;                //!< smoothed origin latency in s
+
+   void RecordAccess(int first, int last, int nblks);
+   int  NextPredictedBlock();
+
    static const char *m_traceID;
    bool overlap(int blk,               // block to query
                 long long blk_size,    //
@@ -263,15 +424,31 @@ private:
    int    RequestBlocksDirect(DirectResponseHandler *handler, IntList_t& blocks,
                               char* buff, long long req_off, long long req_size);
 
+   bool   IsOnDisk(long long req_off, long long req_size);
+
+   // Direct fetch de-duplication
+   typedef std::vector<DirectFetch*> DirectFetchList_t;
+   typedef std::vector<DirectJoin*>  DirectJoinList_t;
+
+   DirectJoin*  JoinDirectFetch   (int blk, char* req_buf, long long req_off, long long req_size);
+   DirectFetch* AddDirectFetch    (int blk, char* req_buf, long long req_off, long long req_size);
+   void         FinishDirectFetches(DirectFetchList_t& fetches, int err);
+   void         CancelDirect      (DirectFetchList_t& fetches, DirectJoinList_t& joins);
+   int          WaitDirectJoins   (DirectJoinList_t& joins);
+
    int    ReadBlocksFromDisk(IntList_t& blocks,
                              char* req_buf, long long req_off, long long req_size);
 
    // VRead
    bool VReadValidate     (const XrdOucIOVec *readV, int n);
+   void VReadRecordAccess (const XrdOucIOVec *readV, int n);
    bool VReadPreProcess   (const XrdOucIOVec *readV, int n,
                            ReadVBlockListRAM&  blks_to_process,
                            ReadVBlockListDisk& blks_on_disk,
-                           std::vector<XrdOucIOVec>& chunkVec);
+                           std::vector<XrdOucIOVec>& chunkVec,
+                           DirectFetchList_t&  direct_fetches,
+                           DirectJoinList_t&   direct_joins,
+                           Stats&              loc_stats);
    int  VReadFromDisk     (const XrdOucIOVec *readV, int n,
                            ReadVBlockListDisk& blks_on_disk);
    int  VReadProcessBlocks(const XrdOucIOVec *readV, int n,
@@ -284,6 +461,13 @@ private:
    void dec_ref_count(Block*);
    void free_block(Block*);
 
+   bool mark_block_written(Block*, uint32_t cksum);
+   bool verify_blocks(const char* buff, long long off, long long size);
+
+   bool keep_hot_block(Block*);
+   void promote_hot_blocks(const char* buff, long long off, long long size);
+   void free_hot_blocks();
+
    int  offsetIdx(int idx);
 };
 
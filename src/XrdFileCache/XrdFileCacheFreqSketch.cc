@@ -0,0 +1,118 @@
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "XrdFileCacheFreqSketch.hh"
+
+using namespace XrdFileCache;
+
+//------------------------------------------------------------------------------
+
+void FreqSketch::Init(long long width)
+{
+   size_t w = 16;
+   while ((long long) w < width) w <<= 1;
+
+   XrdSysMutexHelper lock(&m_mutex);
+   m_table.assign(m_depth * w / 2, 0);
+   m_mask       = w - 1;
+   m_additions  = 0;
+   m_sampleSize = 10 * (long long) w;
+}
+
+//------------------------------------------------------------------------------
+
+void FreqSketch::indices(const std::string &key, size_t idx[m_depth]) const
+{
+   // FNV-1a, then the rows are indexed by double hashing of the mixed value.
+   uint64_t h = 14695981039346656037ull;
+   for (std::string::const_iterator i = key.begin(); i != key.end(); ++i)
+   {
+      h ^= (unsigned char) *i;
+      h *= 1099511628211ull;
+   }
+   h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+   h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+   h ^= h >> 33;
+
+   const uint64_t h2 = (h >> 32) | 1;
+   for (int r = 0; r < m_depth; ++r)
+      idx[r] = (size_t) (h + r * h2) & m_mask;
+}
+
+inline int FreqSketch::get(int row, size_t i) const
+{
+   const uint8_t b = m_table[row * (m_mask + 1) / 2 + i / 2];
+   return (i & 1) ? (b >> 4) : (b & 0x0f);
+}
+
+//------------------------------------------------------------------------------
+
+void FreqSketch::reset()
+{
+   // Halve all counters, under lock.
+   for (std::vector<uint8_t>::iterator i = m_table.begin(); i != m_table.end(); ++i)
+      *i = (*i >> 1) & 0x77;
+   m_additions /= 2;
+}
+
+//------------------------------------------------------------------------------
+
+int FreqSketch::Increment(const std::string &key)
+{
+   if ( ! m_mask) return 0;
+
+   size_t idx[m_depth];
+   indices(key, idx);
+
+   XrdSysMutexHelper lock(&m_mutex);
+
+   int min = 15;
+   for (int r = 0; r < m_depth; ++r)
+      min = std::min(min, get(r, idx[r]));
+
+   // Conservative update, only the smallest counters are raised.
+   if (min < 15)
+   {
+      for (int r = 0; r < m_depth; ++r)
+      {
+         if (get(r, idx[r]) != min) continue;
+         m_table[r * (m_mask + 1) / 2 + idx[r] / 2] += (idx[r] & 1) ? 0x10 : 0x01;
+      }
+      ++min;
+   }
+
+   if (++m_additions >= m_sampleSize) reset();
+
+   return min;
+}
+
+//------------------------------------------------------------------------------
+
+int FreqSketch::Estimate(const std::string &key)
+{
+   if ( ! m_mask) return 0;
+
+   size_t idx[m_depth];
+   indices(key, idx);
+
+   XrdSysMutexHelper lock(&m_mutex);
+
+   int min = 15;
+   for (int r = 0; r < m_depth; ++r)
+      min = std::min(min, get(r, idx[r]));
+   return min;
+}
@@ -0,0 +1,70 @@
+#ifndef __XRDFILECACHE_FREQSKETCH_HH__
+#define __XRDFILECACHE_FREQSKETCH_HH__
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+namespace XrdFileCache
+{
+//----------------------------------------------------------------------------
+//! Count-min sketch of recent access frequency, keyed by path. Counters are
+//! four bits wide and all of them are halved after a number of increments
+//! proportional to the width, so that old accesses fade out. Thread safe.
+//----------------------------------------------------------------------------
+class FreqSketch
+{
+public:
+   FreqSketch() : m_mask(0), m_additions(0), m_sampleSize(0) {}
+
+   //---------------------------------------------------------------------
+   //! Allocate counters, width is rounded up to a power of two.
+   //---------------------------------------------------------------------
+   void Init(long long width);
+
+   //---------------------------------------------------------------------
+   //! Count one access of key.
+   //!
+   //! @return estimated frequency including this access
+   //---------------------------------------------------------------------
+   int Increment(const std::string &key);
+
+   //---------------------------------------------------------------------
+   //! Estimated frequency of key, between 0 and 15.
+   //---------------------------------------------------------------------
+   int Estimate(const std::string &key);
+
+   bool IsInitialized() const { return m_mask != 0; }
+
+private:
+   static const int m_depth = 4;
+
+   void    indices(const std::string &key, size_t idx[m_depth]) const;
+   int     get(int row, size_t i) const;
+   void    reset();
+
+   std::vector<uint8_t> m_table;        //!< m_depth rows of two counters per byte
+   size_t               m_mask;         //!< width - 1
+   long long            m_additions;    //!< increments since the last halving
+   long long            m_sampleSize;   //!< increments between halvings
+   XrdSysMutex          m_mutex;
+};
+}
+
+#endif
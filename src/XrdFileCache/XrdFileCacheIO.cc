@@ -1,4 +1,8 @@
+#include <stdio.h>
+#include <string.h>
+
 #include "XrdFileCacheIO.hh"
+#include "XrdFileCacheStats.hh"
 #include "XrdFileCacheTrace.hh"
 
 using namespace XrdFileCache;
@@ -7,6 +11,18 @@ IO::IO(XrdOucCacheIO2 *io, XrdOucCacheStats &stats, Cache &cache) :
    m_statsGlobal(stats), m_cache(cache), m_traceID("IO"), m_io(io)
 {
    m_path = m_io->Path();
+
+   const char *cgi = strchr(m_path.c_str(), '?');
+   if (cgi) m_traceCtx.FromCgi(cgi + 1);
+}
+
+void IO::ReportSpan(const char *name, long long beg, long long off, int len, const Stats &st)
+{
+   char attr[256];
+   snprintf(attr, sizeof(attr), "\"off\":%lld,\"len\":%d,\"disk\":%lld,\"ram\":%lld,"
+            "\"missed\":%lld,\"joined\":%lld", off, len, st.m_BytesDisk,
+            st.m_BytesRam, st.m_BytesMissed, st.m_ReqsJoined);
+   m_traceCtx.Span(name, beg, XrdOucTraceCtx::Now() - beg, attr);
 }
 
 void IO::Update(XrdOucCacheIO2 &iocp)
@@ -5,11 +5,14 @@ class XrdSysTrace;
 
 #include "XrdFileCache.hh"
 #include "XrdOuc/XrdOucCache2.hh"
+#include "XrdOuc/XrdOucTraceCtx.hh"
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
 namespace XrdFileCache
 {
+class Stats;
+
 //----------------------------------------------------------------------------
 //! Base cache-io class that implements XrdOucCacheIO abstract methods.
 //----------------------------------------------------------------------------
@@ -53,7 +56,13 @@ protected:
    std::string  m_path;
    const char*  GetPath() { return m_path.c_str(); }
 
+   //! Reads of a file opened as part of a sampled trace are reported as spans.
+   bool Traced() const { return m_traceCtx.isSampled() && XrdOucTraceCtx::Exporting(); }
+
+   void ReportSpan(const char *name, long long beg, long long off, int len, const Stats &st);
+
 private:
+   XrdOucTraceCtx  m_traceCtx;          //!< trace context from the origin URL
    XrdOucCacheIO2 *m_io;                //!< original data source
    XrdSysMutex     updMutex;
    void SetInput(XrdOucCacheIO2*);
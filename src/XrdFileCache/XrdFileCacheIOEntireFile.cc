@@ -185,7 +185,17 @@ int IOEntireFile::Read(char *buff, long long off, int size)
    ssize_t bytes_read = 0;
    ssize_t retval = 0;
 
-   retval = m_file->Read(buff, off, size);
+   if (Traced())
+   {
+      Stats     ioStats;
+      long long beg = XrdOucTraceCtx::Now();
+      retval = m_file->Read(buff, off, size, &ioStats);
+      ReportSpan("pfc.read", beg, off, size, ioStats);
+   }
+   else
+   {
+      retval = m_file->Read(buff, off, size);
+   }
    if (retval >= 0)
    {
       bytes_read += retval;
@@ -210,6 +220,18 @@ int IOEntireFile::Read(char *buff, long long off, int size)
 int IOEntireFile::ReadV (const XrdOucIOVec *readV, int n)
 {
    TRACEIO(Dump, "IO::ReadV(), get " <<  n << " requests" );
+
+   if (Traced() && n > 0)
+   {
+      Stats     ioStats;
+      long long beg = XrdOucTraceCtx::Now();
+      int       len = 0;
+      int       retval = m_file->ReadV(readV, n, &ioStats);
+      for (int i = 0; i < n; ++i) len += readV[i].size;
+      ReportSpan("pfc.readv", beg, readV[0].offset, len, ioStats);
+      return retval;
+   }
+
    return m_file->ReadV(readV, n);
 }
 
@@ -35,14 +35,45 @@
 
 using namespace XrdFileCache;
 
+namespace
+{
+const char      ContainerMagic[8]   = "XrdPfcC";
+const long long ContainerSlotAlign  = 512;
+}
+
+//______________________________________________________________________________
+bool ContainerHeader::Read(XrdOssDF* fp)
+{
+   if (fp->Read(this, 0, sizeof(ContainerHeader)) != (ssize_t) sizeof(ContainerHeader))
+      return false;
+
+   return memcmp(m_magic, ContainerMagic, sizeof(m_magic)) == 0 &&
+          m_blockSize > 0 && m_slotSize > 0 && m_slotBase >= (long long) sizeof(ContainerHeader);
+}
+
+//______________________________________________________________________________
+bool ContainerHeader::Write(XrdOssDF* fp, long long blockSize, long long bufferSize)
+{
+   const int nBits = (blockSize - 1)/bufferSize + 1;
+
+   memcpy(m_magic, ContainerMagic, sizeof(m_magic));
+   m_blockSize = blockSize;
+   m_slotSize  = (Info::GetMaxImageSize(nBits) + ContainerSlotAlign - 1) / ContainerSlotAlign * ContainerSlotAlign;
+   m_slotBase  = ContainerSlotAlign;
+
+   return fp->Write(this, 0, sizeof(ContainerHeader)) == (ssize_t) sizeof(ContainerHeader);
+}
+
 //______________________________________________________________________________
 IOFileBlock::IOFileBlock(XrdOucCacheIO2 *io, XrdOucCacheStats &statsGlobal, Cache & cache) :
-  IO(io, statsGlobal, cache), m_localStat(0), m_info(cache.GetTrace(), false), m_infoFile(0)
+  IO(io, statsGlobal, cache), m_localStat(0), m_info(cache.GetTrace(), false), m_infoFile(0),
+  m_container(false)
 {
    m_blocksize = Cache::GetInstance().RefConfiguration().m_hdfsbsize;
    GetBlockSizeFromPath();
    initLocalStat();
    if (m_infoFile) m_info.WriteIOStatAttach();
+   if (m_localStat && Cache::GetInstance().RefConfiguration().m_hdfscontainer) initContainer();
 }
 
 //______________________________________________________________________________
@@ -91,6 +122,7 @@ void IOFileBlock::CloseInfoFile()
          // We do not maintain access statistics for individual blocks.
          Stats as;
          m_info.WriteIOStatDetach(as);
+         m_cache.PurgeIndexTouch(XrdCl::URL(GetPath()).GetPath() + Info::m_infoExtension);
       }
       m_info.Write(m_infoFile);
       m_infoFile->Fsync();
@@ -126,6 +158,50 @@ void IOFileBlock::GetBlockSizeFromPath()
    }
 }
 
+//______________________________________________________________________________
+void IOFileBlock::initContainer()
+{
+   // Open or create the container index. An index written for another
+   // block size is left alone and the blocks go to files of their own.
+
+   const Configuration &conf = m_cache.RefConfiguration();
+   std::string path = XrdCl::URL(GetPath()).GetPath() + Info::m_indexExtension;
+   XrdOucEnv   myEnv;
+
+   myEnv.Put("oss.cgroup", conf.m_meta_space.c_str());
+   if (m_cache.GetOss()->Create(conf.m_username.c_str(), path.c_str(), 0600, myEnv, XRDOSS_mkpath) != XrdOssOK)
+   {
+      TRACEIO(Error, "IOFileBlock::initContainer can't create index file " << path);
+      return;
+   }
+
+   XrdOssDF *fp = m_cache.GetOss()->newFile(conf.m_username.c_str());
+   if (fp->Open(path.c_str(), O_RDWR, 0600, myEnv) == XrdOssOK)
+   {
+      if (m_header.Read(fp))
+      {
+         const int nBits = (m_blocksize - 1)/conf.m_bufferSize + 1;
+         m_container = m_header.m_blockSize == m_blocksize &&
+                       m_header.m_slotSize  >= Info::GetMaxImageSize(nBits);
+         if ( ! m_container)
+         {
+            TRACEIO(Warning, "IOFileBlock::initContainer index of block size " << m_header.m_blockSize
+                             << " does not fit block size " << m_blocksize << ", not using container");
+         }
+      }
+      else
+      {
+         m_container = m_header.Write(fp, m_blocksize, conf.m_bufferSize);
+      }
+      fp->Close();
+   }
+   else
+   {
+      TRACEIO(Error, "IOFileBlock::initContainer can't open index file " << path);
+   }
+   delete fp;
+}
+
 //______________________________________________________________________________
 File* IOFileBlock::newBlockFile(long long off, int blocksize)
 {
@@ -140,8 +216,19 @@ File* IOFileBlock::newBlockFile(long long off, int blocksize)
    ss << &offExt[0];
    fname = ss.str();
 
+   if ( ! Cache::GetInstance().Admit(fname)) return 0;
+
    TRACEIO(Debug, "FileBlock::FileBlock(), create XrdFileCacheFile ");
 
+   if (m_container)
+   {
+      ContainerSlot slot;
+      slot.m_dataPath   = url.GetPath();
+      slot.m_indexPath  = slot.m_dataPath + Info::m_indexExtension;
+      slot.m_infoOffset = m_header.m_slotBase + (off / m_blocksize) * m_header.m_slotSize;
+      return Cache::GetInstance().GetFile(fname, this, off, blocksize, &slot);
+   }
+
    File* file = Cache::GetInstance().GetFile(fname, this, off, blocksize);
    return file;
 }
@@ -272,6 +359,18 @@ bool IOFileBlock::ioActive()
 
 //______________________________________________________________________________
 int IOFileBlock::Read(char *buff, long long off, int size)
+{
+   if ( ! Traced()) return ReadBlocks(buff, off, size, 0);
+
+   Stats     ioStats;
+   long long beg = XrdOucTraceCtx::Now();
+   int       retval = ReadBlocks(buff, off, size, &ioStats);
+   ReportSpan("pfc.read", beg, off, size, ioStats);
+   return retval;
+}
+
+//______________________________________________________________________________
+int IOFileBlock::ReadBlocks(char *buff, long long off, int size, Stats *ioStats)
 {
    // protect from reads over the file size
 
@@ -296,14 +395,14 @@ int IOFileBlock::Read(char *buff, long long off, int size)
    for (int blockIdx = idx_first; blockIdx <= idx_last; ++blockIdx )
    {
       // locate block
-      File* fb;
+      File* fb = 0;
       m_mutex.Lock();
       std::map<int, File*>::iterator it = m_blocks.find(blockIdx);
       if (it != m_blocks.end())
       {
          fb = it->second;
       }
-      else
+      else if (m_declined.find(blockIdx) == m_declined.end())
       {
          size_t pbs = m_blocksize;
          // check if this is last block
@@ -315,7 +414,10 @@ int IOFileBlock::Read(char *buff, long long off, int size)
          }
 
          fb = newBlockFile(blockIdx*m_blocksize, pbs);
-         m_blocks.insert(std::pair<int,File*>(blockIdx, (File*) fb));
+         if (fb)
+            m_blocks.insert(std::pair<int,File*>(blockIdx, (File*) fb));
+         else
+            m_declined.insert(blockIdx);
       }
       m_mutex.UnLock();
 
@@ -341,7 +443,7 @@ int IOFileBlock::Read(char *buff, long long off, int size)
 
       TRACEIO(Dump, "IOFileBlock::Read() block[ " << blockIdx << "] read-block-size[" << readBlockSize << "], offset[" << readBlockSize << "] off = " << off );
 
-      int retvalBlock = fb->Read(buff, off, readBlockSize);
+      int retvalBlock = fb ? fb->Read(buff, off, readBlockSize, ioStats) : GetInput()->Read(buff, off, readBlockSize);
 
       TRACEIO(Dump, "IOFileBlock::Read()  Block read returned " << retvalBlock);
       if (retvalBlock == readBlockSize)
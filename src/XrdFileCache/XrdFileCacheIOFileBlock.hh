@@ -18,6 +18,7 @@
 // along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
 //----------------------------------------------------------------------------------
 #include <map>
+#include <set>
 #include <string>
 
 #include "XrdOuc/XrdOucCache2.hh"
@@ -30,6 +31,26 @@ class XrdOssDF;
 
 namespace XrdFileCache
 {
+//----------------------------------------------------------------------------
+//! Header of a container index file. With pfc.hdfsmode container the blocks
+//! of a file are kept in one data file at their offsets in the original file
+//! and their info images in fixed size slots of one index file, instead of a
+//! data and an info file per block.
+//----------------------------------------------------------------------------
+struct ContainerHeader
+{
+   char      m_magic[8];      //!< "XrdPfcC"
+   long long m_blockSize;     //!< size of file-block
+   long long m_slotSize;      //!< size of an info slot
+   long long m_slotBase;      //!< offset of the first slot
+
+   //! Read the header, false if there is none.
+   bool Read(XrdOssDF* fp);
+
+   //! Set up for the given block and buffer sizes and write the header.
+   bool Write(XrdOssDF* fp, long long blockSize, long long bufferSize);
+};
+
 //----------------------------------------------------------------------------
 //! \brief Downloads original file into multiple files, chunked into
 //! blocks. Only blocks that are asked for are downloaded.
@@ -75,13 +96,18 @@ public:
 private:
    long long                  m_blocksize;       //!< size of file-block
    std::map<int, File*>       m_blocks;          //!< map of created blocks
+   std::set<int>              m_declined;        //!< blocks not admitted to the cache, read from origin
    XrdSysMutex                m_mutex;           //!< map mutex
    struct stat               *m_localStat;
    Info                       m_info;
    XrdOssDF*                  m_infoFile;
+   bool                       m_container;       //!< blocks are kept in container files
+   ContainerHeader            m_header;          //!< layout of the container index
 
    void  GetBlockSizeFromPath();
+   int   ReadBlocks(char *buff, long long off, int size, Stats *ioStats);
    int   initLocalStat();
+   void  initContainer();
    File* newBlockFile(long long off, int blocksize);
    void  CloseInfoFile();
 };
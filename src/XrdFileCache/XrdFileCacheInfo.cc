@@ -93,14 +93,75 @@ struct FpHelper
       return WriteRaw(&loc, sizeof(T));
    }
 };
+
+// Parses an info image that was read into memory in one go. Same interface
+// as the read side of FpHelper.
+struct MemHelper
+{
+   const char  *f_buf;
+   size_t       f_len;
+   size_t       f_off;
+   XrdSysTrace *f_trace;
+   const char  *m_traceID;
+   std::string  f_ttext;
+
+   XrdSysTrace* GetTrace() const { return f_trace; }
+
+   MemHelper(const char *buf, size_t len,
+             XrdSysTrace *trace, const char *tid, const std::string &ttext) :
+      f_buf(buf), f_len(len), f_off(0),
+      f_trace(trace), m_traceID(tid), f_ttext(ttext)
+   {}
+
+   // Returns true on error
+   bool ReadRaw(void *buf, ssize_t size, bool warnp = true)
+   {
+      if (f_off + size > f_len)
+      {
+         if (warnp)
+         {
+            TRACE(Warning, f_ttext << " off=" << f_off << " size=" << size
+                                   << " available=" << f_len - f_off);
+         }
+         return true;
+      }
+      memcpy(buf, f_buf + f_off, size);
+      f_off += size;
+      return false;
+   }
+
+   template<typename T> bool Read(T &loc, bool warnp = true)
+   {
+      return ReadRaw(&loc, sizeof(T), warnp);
+   }
+};
+
+// Assembles an info image in memory so that it can be written in one go.
+struct BufHelper
+{
+   std::vector<char> f_buf;
+
+   void WriteRaw(const void *buf, size_t size)
+   {
+      const char *p = (const char*) buf;
+      f_buf.insert(f_buf.end(), p, p + size);
+   }
+
+   template<typename T> void Write(const T &loc)
+   {
+      WriteRaw(&loc, sizeof(T));
+   }
+};
 }
 
 using namespace XrdFileCache;
 
 const char*  Info::m_infoExtension  = ".cinfo";
+const char*  Info::m_indexExtension = ".cindex";
 const char*  Info::m_traceID        = "Cinfo";
-const int    Info::m_defaultVersion = 2;
+const int    Info::m_defaultVersion = 3;
 const size_t Info::m_maxNumAccess   = 20;
+const size_t Info::m_readAheadSize  = 4096;
 
 //------------------------------------------------------------------------------
 
@@ -110,6 +171,8 @@ Info::Info(XrdSysTrace* trace, bool prefetchBuffer) :
    m_buff_written(0),  m_buff_prefetch(0),
    m_sizeInBits(0),
    m_complete(false),
+   m_imgOffset(0),
+   m_imgShared(false),
    m_cksCalc(0)
 {}
 
@@ -118,6 +181,8 @@ Info::~Info()
    if (m_store.m_buff_synced) free(m_store.m_buff_synced);
    if (m_buff_written) free(m_buff_written);
    if (m_buff_prefetch) free(m_buff_prefetch);
+   if (m_store.m_buff_cksummed) free(m_store.m_buff_cksummed);
+   if (m_store.m_block_cksums) free(m_store.m_block_cksums);
    delete m_cksCalc;
 }
 
@@ -164,12 +229,18 @@ void Info::ResizeBits(int s)
    if (m_store.m_buff_synced) free(m_store.m_buff_synced);
    if (m_buff_written) free(m_buff_written);
    if (m_buff_prefetch) free(m_buff_prefetch);
+   if (m_store.m_buff_cksummed) free(m_store.m_buff_cksummed);
+   if (m_store.m_block_cksums) free(m_store.m_block_cksums);
 
    m_sizeInBits = s;
-   m_buff_written        = (unsigned char*) malloc(GetSizeInBytes());
-   m_store.m_buff_synced = (unsigned char*) malloc(GetSizeInBytes());
-   memset(m_buff_written,        0, GetSizeInBytes());
-   memset(m_store.m_buff_synced, 0, GetSizeInBytes());
+   m_buff_written          = (unsigned char*) malloc(GetSizeInBytes());
+   m_store.m_buff_synced   = (unsigned char*) malloc(GetSizeInBytes());
+   m_store.m_buff_cksummed = (unsigned char*) malloc(GetSizeInBytes());
+   m_store.m_block_cksums  = (uint32_t*) malloc(m_sizeInBits * sizeof(uint32_t));
+   memset(m_buff_written,          0, GetSizeInBytes());
+   memset(m_store.m_buff_synced,   0, GetSizeInBytes());
+   memset(m_store.m_buff_cksummed, 0, GetSizeInBytes());
+   memset(m_store.m_block_cksums,  0, m_sizeInBits * sizeof(uint32_t));
 
    if (m_hasPrefetchBuffer)
    {
@@ -180,6 +251,15 @@ void Info::ResizeBits(int s)
 
 //------------------------------------------------------------------------------
 
+long long Info::GetMaxImageSize(int n)
+{
+   const long long nb = n ? (n - 1)/8 + 1 : 0;
+   return sizeof(int) + 2*sizeof(long long) + nb + 16 + sizeof(time_t) + sizeof(size_t) +
+          m_maxNumAccess * sizeof(AStat) + nb + n * sizeof(uint32_t);
+}
+
+//------------------------------------------------------------------------------
+
 bool Info::Read(XrdOssDF* fp, const std::string &fname)
 {
    // does not need lock, called only in File::Open
@@ -188,7 +268,17 @@ bool Info::Read(XrdOssDF* fp, const std::string &fname)
    std::string trace_pfx("Info:::Read() ");
    trace_pfx += fname + " ";
 
-   FpHelper r(fp, 0, m_trace, m_traceID, trace_pfx + "oss read failed");
+   // Read the whole image with as few reads as possible. The first read is
+   // large enough for most files, larger images need just one more.
+   std::vector<char> img(m_readAheadSize);
+   ssize_t ret = fp->Read(&img[0], m_imgOffset, img.size());
+   if (ret < 0)
+   {
+      TRACE(Warning, trace_pfx << "oss read failed error=" << strerror(errno));
+      return false;
+   }
+
+   MemHelper r(&img[0], ret, m_trace, m_traceID, trace_pfx + "short image");
 
    if (r.Read(m_store.m_version)) return false;
 
@@ -206,6 +296,19 @@ bool Info::Read(XrdOssDF* fp, const std::string &fname)
    if (r.Read(fs)) return false;
    SetFileSize(fs);
 
+   size_t need = r.f_off + GetSizeInBytes() + 16 + sizeof(time_t) + sizeof(size_t)
+                 + m_maxNumAccess * sizeof(AStat);
+   if (m_store.m_version >= 3)
+      need += GetSizeInBytes() + m_sizeInBits * sizeof(uint32_t);
+   if ((size_t) ret == img.size() && need > img.size())
+   {
+      img.resize(need);
+      ssize_t ret2 = fp->Read(&img[ret], m_imgOffset + ret, need - ret);
+      if (ret2 > 0) ret += ret2;
+      r.f_buf = &img[0];
+      r.f_len = ret;
+   }
+
    if (r.ReadRaw(m_store.m_buff_synced, GetSizeInBytes())) return false;
    memcpy(m_buff_written, m_store.m_buff_synced, GetSizeInBytes());
 
@@ -246,6 +349,19 @@ bool Info::Read(XrdOssDF* fp, const std::string &fname)
       if (r.Read(*it, sizeof(AStat))) return false;
    }
 
+   // read block checksums, only trusted for blocks that are also synced
+   if (m_store.m_version >= 3)
+   {
+      if (r.ReadRaw(m_store.m_buff_cksummed, GetSizeInBytes()) ||
+          r.ReadRaw(m_store.m_block_cksums, m_sizeInBits * sizeof(uint32_t)))
+      {
+         memset(m_store.m_buff_cksummed, 0, GetSizeInBytes());
+         return true;
+      }
+      for (int i = 0; i < GetSizeInBytes(); ++i)
+         m_store.m_buff_cksummed[i] &= m_store.m_buff_synced[i];
+   }
+
    return true;
 }
 
@@ -261,7 +377,7 @@ bool Info::ReadV1(XrdOssDF* fp, const std::string &fname)
    std::string trace_pfx("Info:::ReadV1() ");
    trace_pfx += fname + " ";
 
-   FpHelper r(fp, 0, m_trace, m_traceID, trace_pfx + "oss read failed");
+   FpHelper r(fp, m_imgOffset, m_trace, m_traceID, trace_pfx + "oss read failed");
 
 
 
@@ -330,34 +446,46 @@ bool Info::Write(XrdOssDF* fp, const std::string &fname)
    std::string trace_pfx("Info:::Write() ");
    trace_pfx += fname + " ";
 
-   if (XrdOucSxeq::Serialize(fp->getFD(), XrdOucSxeq::noWait))
+   if ( ! m_imgShared && XrdOucSxeq::Serialize(fp->getFD(), XrdOucSxeq::noWait))
    {
       TRACE(Error, trace_pfx << " lock failed " << strerror(errno));
       return false;
    }
 
-   FpHelper w(fp, 0, m_trace, m_traceID, trace_pfx + "oss write failed");
+   // Assemble the image and write it with a single write. The image never
+   // shrinks, so nothing of an older one is left behind it.
+   BufHelper b;
+   b.f_buf.reserve(sizeof(int) + 2*sizeof(long long) + GetSizeInBytes() + 16 +
+                   sizeof(time_t) + sizeof(size_t) +
+                   m_store.m_astats.size() * sizeof(AStat) +
+                   GetSizeInBytes() + m_sizeInBits * sizeof(uint32_t));
 
    m_store.m_version = m_defaultVersion;
-   if (w.Write(m_store.m_version))    return false;
-   if (w.Write(m_store.m_bufferSize)) return false;
-   if (w.Write(m_store.m_fileSize))   return false;
+   b.Write(m_store.m_version);
+   b.Write(m_store.m_bufferSize);
+   b.Write(m_store.m_fileSize);
 
-   if (w.WriteRaw(m_store.m_buff_synced, GetSizeInBytes())) return false;
+   b.WriteRaw(m_store.m_buff_synced, GetSizeInBytes());
 
    GetCksum(&m_store.m_buff_synced[0], &m_store.m_cksum[0]);
-   if (w.Write(m_store.m_cksum)) return false;
+   b.Write(m_store.m_cksum);
 
-   if (w.Write(m_store.m_creationTime)) return false;
+   b.Write(m_store.m_creationTime);
 
-   if (w.Write(m_store.m_accessCnt)) return false;
+   b.Write(m_store.m_accessCnt);
    for (std::vector<AStat>::iterator it = m_store.m_astats.begin(); it != m_store.m_astats.end(); ++it)
    {
-      if (w.WriteRaw(&(*it), sizeof(AStat))) return false;
+      b.WriteRaw(&(*it), sizeof(AStat));
    }
 
+   b.WriteRaw(m_store.m_buff_cksummed, GetSizeInBytes());
+   b.WriteRaw(m_store.m_block_cksums, m_sizeInBits * sizeof(uint32_t));
+
+   FpHelper w(fp, m_imgOffset, m_trace, m_traceID, trace_pfx + "oss write failed");
+   if (w.WriteRaw(&b.f_buf[0], b.f_buf.size())) return false;
+
    // Can this really fail?
-   if (XrdOucSxeq::Release(fp->getFD()))
+   if ( ! m_imgShared && XrdOucSxeq::Release(fp->getFD()))
    {
       TRACE(Error, trace_pfx << "un-lock failed");
    }
@@ -19,6 +19,7 @@
 //----------------------------------------------------------------------------------
 
 #include <stdio.h>
+#include <stdint.h>
 #include <time.h>
 #include <assert.h>
 #include <vector>
@@ -69,8 +70,11 @@ public:
       time_t             m_creationTime;           //!< time the info file was created
       size_t             m_accessCnt;              //!< number of written AStat structs
       std::vector<AStat> m_astats;                 //!< number of last m_maxAcessCnts
+      unsigned char     *m_buff_cksummed;          //!< blocks with a known crc32c, since version 3
+      uint32_t          *m_block_cksums;           //!< crc32c of each block, since version 3
 
-      Store () : m_version(1), m_bufferSize(-1), m_fileSize(0), m_buff_synced(0),m_creationTime(0), m_accessCnt(0) {}
+      Store () : m_version(1), m_bufferSize(-1), m_fileSize(0), m_buff_synced(0),m_creationTime(0), m_accessCnt(0),
+                 m_buff_cksummed(0), m_block_cksums(0) {}
    };
 
 
@@ -110,6 +114,33 @@ public:
    //---------------------------------------------------------------------
    void SetBitPrefetch(int i);
 
+   //---------------------------------------------------------------------
+   //! \brief Forget that a block was downloaded, e.g. when its data on
+   //! disk no longer matches the stored checksum
+   //!
+   //! @param i block index
+   //---------------------------------------------------------------------
+   void ResetBitWritten(int i);
+
+   //---------------------------------------------------------------------
+   //! \brief Store crc32c of a block. Must be called before the block is
+   //! marked as downloaded.
+   //!
+   //! @param i     block index
+   //! @param cksum crc32c of the whole block
+   //---------------------------------------------------------------------
+   void SetBlockCksum(int i, uint32_t cksum);
+
+   //---------------------------------------------------------------------
+   //! \brief Get crc32c of a downloaded block
+   //!
+   //! @param i     block index
+   //! @param cksum set to crc32c of the whole block
+   //!
+   //! @return false if the checksum of the block is not known
+   //---------------------------------------------------------------------
+   bool GetBlockCksum(int i, uint32_t &cksum) const;
+
    void SetBufferSize(long long);
    
    void SetFileSize(long long);
@@ -137,6 +168,20 @@ public:
    //---------------------------------------------------------------------
    bool Write(XrdOssDF* fp, const std::string &fname = "<unknown>");
 
+   //---------------------------------------------------------------------
+   //! \brief Keep the image at the given offset of a file shared with
+   //! other images, see IOFileBlock container files. Shared files are not
+   //! locked on write, each image has a single writer.
+   //!
+   //! @param off offset of the image
+   //---------------------------------------------------------------------
+   void SetImageOffset(long long off) { m_imgOffset = off; m_imgShared = true; }
+
+   //---------------------------------------------------------------------
+   //! Upper bound on the size of an image with n blocks.
+   //---------------------------------------------------------------------
+   static long long GetMaxImageSize(int n);
+
    //---------------------------------------------------------------------
    //! Disable allocating, writing, and reading of downlaod status
    //---------------------------------------------------------------------
@@ -193,7 +238,9 @@ public:
    long long GetBufferSize() const;
 
    //---------------------------------------------------------------------
-   //! Test if block at the given index is downlaoded
+   //! Test if block at the given index is downlaoded. The download and
+   //! prefetch bits are read and set atomically so that this may be called
+   //! without holding the lock that serializes the updates.
    //---------------------------------------------------------------------
    bool TestBit(int i) const;
 
@@ -243,9 +290,11 @@ public:
    void GetCksum( unsigned char* buff, char* digest);
 
    const static char*   m_infoExtension;
+   const static char*   m_indexExtension;
    const static char*   m_traceID;
    const static int     m_defaultVersion;
    const static size_t  m_maxNumAccess;
+   const static size_t  m_readAheadSize;
 
    XrdSysTrace* GetTrace() const {return m_trace; }
 
@@ -262,6 +311,9 @@ protected:
    int  m_sizeInBits;                        //!< cached
    bool m_complete;                          //!< cached
 
+   long long m_imgOffset;                    //!< offset of the image in the info file
+   bool      m_imgShared;                    //!< info file holds other images as well
+
 private:
    inline unsigned char cfiBIT(int n) const { return 1 << n; }
 
@@ -278,7 +330,7 @@ inline bool Info::TestBit(int i) const
    assert(cn < GetSizeInBytes());
 
    const int off = i - cn*8;
-   return (m_buff_written[cn] & cfiBIT(off)) == cfiBIT(off);
+   return (__atomic_load_n(&m_buff_written[cn], __ATOMIC_ACQUIRE) & cfiBIT(off)) == cfiBIT(off);
 }
 
 inline bool Info::TestPrefetchBit(int i) const
@@ -289,7 +341,7 @@ inline bool Info::TestPrefetchBit(int i) const
    assert(cn < GetSizeInBytes());
 
    const int off = i - cn*8;
-   return (m_buff_prefetch[cn] & cfiBIT(off)) == cfiBIT(off);
+   return (__atomic_load_n(&m_buff_prefetch[cn], __ATOMIC_ACQUIRE) & cfiBIT(off)) == cfiBIT(off);
 }
 
 inline int Info::GetNDownloadedBlocks() const
@@ -359,7 +411,7 @@ inline void Info::SetBitWritten(int i)
    assert(cn < GetSizeInBytes());
 
    const int off = i - cn*8;
-   m_buff_written[cn] |= cfiBIT(off);
+   __atomic_fetch_or(&m_buff_written[cn], cfiBIT(off), __ATOMIC_RELEASE);
 }
 
 inline void Info::SetBitPrefetch(int i)
@@ -370,7 +422,41 @@ inline void Info::SetBitPrefetch(int i)
    assert(cn < GetSizeInBytes());
 
    const int off = i - cn*8;
-   m_buff_prefetch[cn] |= cfiBIT(off);
+   __atomic_fetch_or(&m_buff_prefetch[cn], cfiBIT(off), __ATOMIC_RELEASE);
+}
+
+inline void Info::ResetBitWritten(int i)
+{
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   __atomic_fetch_and(&m_buff_written[cn], (unsigned char) ~cfiBIT(off), __ATOMIC_RELEASE);
+   __atomic_fetch_and(&m_store.m_buff_synced[cn], (unsigned char) ~cfiBIT(off), __ATOMIC_RELAXED);
+   __atomic_fetch_and(&m_store.m_buff_cksummed[cn], (unsigned char) ~cfiBIT(off), __ATOMIC_RELAXED);
+   m_complete = false;
+}
+
+inline void Info::SetBlockCksum(int i, uint32_t cksum)
+{
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   m_store.m_block_cksums[i] = cksum;
+   __atomic_fetch_or(&m_store.m_buff_cksummed[cn], cfiBIT(off), __ATOMIC_RELEASE);
+}
+
+inline bool Info::GetBlockCksum(int i, uint32_t &cksum) const
+{
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   if ((__atomic_load_n(&m_store.m_buff_cksummed[cn], __ATOMIC_ACQUIRE) & cfiBIT(off)) == 0)
+      return false;
+   cksum = m_store.m_block_cksums[i];
+   return true;
 }
 
 inline long long Info::GetBufferSize() const
@@ -1,15 +1,18 @@
 #include "XrdFileCache.hh"
 #include "XrdFileCacheTrace.hh"
+#include "XrdFileCacheIOFileBlock.hh"
 
 using namespace XrdFileCache;
 
 #include <fcntl.h>
 #include <sys/time.h>
+#include <algorithm>
+#include <vector>
 
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdSys/XrdSysTrace.hh"
 
-namespace
+namespace XrdFileCache
 {
 
 class FPurgeState
@@ -38,6 +41,10 @@ public:
    time_t    getMinTime()          const { return tMinTimeStamp; }
 
    long long getNBytesTotal()      const { return nBytesTotal; }
+   void      addNBytesTotal(long long n)   { nBytesTotal += n; }
+
+   bool      needsMore()           const { return nBytesAccum < nBytesReq; }
+   time_t    getNewestTime()       const { return fmap.empty() ? 0 : fmap.rbegin()->first; }
 
    void checkFile(const std::string& iPath, long long iNBytes, time_t iTime)
    {
@@ -77,6 +84,10 @@ private:
    long long nBytesTotal;
    time_t    tMinTimeStamp;
 };
+}
+
+namespace
+{
 
 XrdSysTrace* GetTrace()
 {
@@ -84,93 +95,518 @@ XrdSysTrace* GetTrace()
    return Cache::GetInstance().GetTrace();
 }
 
-void FillFileMapRecurse(XrdOssDF* iOssDF, const std::string& path, FPurgeState& purgeState)
+//------------------------------------------------------------------------------
+//! Scans cache directories for cinfo files with a pool of threads. Each
+//! directory is read by a single thread; the purge candidates go to the shared
+//! FPurgeState and a summary of each scanned directory is kept for the
+//! purge index. Subdirectories are scanned as well when recursing.
+//------------------------------------------------------------------------------
+
+class FPurgeScan
+{
+public:
+   FPurgeScan(FPurgeState &ps, bool recurse) :
+      m_state(ps), m_cond(0), m_busy(0), m_recurse(recurse) {}
+
+   void AddDir(const std::string &dir)
+   {
+      XrdSysCondVarHelper lock(&m_cond);
+      m_queue.push_back(dir);
+      m_cond.Signal();
+   }
+
+   void Run(int nThreads)
+   {
+      std::vector<pthread_t> tids;
+      for (int i = 1; i < nThreads; ++i)
+      {
+         pthread_t tid;
+         if (XrdSysThread::Run(&tid, Worker, this, XRDSYSTHREAD_HOLD, "XrdFileCache PurgeScan"))
+            break;
+         tids.push_back(tid);
+      }
+      Work();
+      for (std::vector<pthread_t>::iterator i = tids.begin(); i != tids.end(); ++i)
+         XrdSysThread::Join(*i, 0);
+   }
+
+   Cache::PurgeDirStatMap_t m_dirs; //!< summary of scanned directories
+
+private:
+   static void *Worker(void *arg)
+   {
+      static_cast<FPurgeScan*>(arg)->Work();
+      return 0;
+   }
+
+   void Work()
+   {
+      m_cond.Lock();
+      while (true)
+      {
+         if ( ! m_queue.empty())
+         {
+            std::string dir = m_queue.front();
+            m_queue.pop_front();
+            ++m_busy;
+            m_cond.UnLock();
+            ScanDir(dir);
+            m_cond.Lock();
+            --m_busy;
+            continue;
+         }
+         if (m_busy == 0) break;
+         m_cond.Wait();
+      }
+      m_cond.Broadcast();
+      m_cond.UnLock();
+   }
+
+   void CheckInfoFile(std::string np, XrdOssDF *fh, Cache::PurgeDirStat &ds);
+   void ScanDir(const std::string &path);
+
+   FPurgeState             &m_state;
+   XrdSysMutex              m_state_mutex;
+   XrdSysCondVar            m_cond;
+   std::list<std::string>   m_queue;
+   int                      m_busy;
+   bool                     m_recurse;
+};
+
+long long ContainerBytes(const std::string &info_path)
+{
+   // Downloaded bytes of all blocks in the container of a file, 0 if there
+   // is none. The container is purged as a whole together with the file.
+
+   static const char* m_traceID = "Purge";
+
+   XrdOss     *oss  = Cache::GetInstance().GetOss();
+   std::string path = info_path.substr(0, info_path.size() - strlen(Info::m_infoExtension)) + Info::m_indexExtension;
+   struct stat fstat;
+   long long   nBytes = 0;
+
+   if (oss->Stat(path.c_str(), &fstat) != XrdOssOK) return 0;
+
+   XrdOucEnv env;
+   XrdOssDF *fh = oss->newFile(Cache::GetInstance().RefConfiguration().m_username.c_str());
+   ContainerHeader header;
+   if (fh->Open(path.c_str(), O_RDONLY, 0600, env) == XrdOssOK && header.Read(fh))
+   {
+      for (long long off = header.m_slotBase; off < fstat.st_size; off += header.m_slotSize)
+      {
+         int version = 0;
+         if (fh->Read(&version, off, sizeof(int)) != sizeof(int) || version == 0) continue;
+
+         Info slot(Cache::GetInstance().GetTrace());
+         slot.SetImageOffset(off);
+         if (slot.Read(fh, path)) nBytes += slot.GetNDownloadedBytes();
+      }
+   }
+   else
+   {
+      TRACE(Warning, "ContainerBytes() can't read container index " << path);
+   }
+   fh->Close();
+   delete fh;
+
+   return nBytes;
+}
+
+void FPurgeScan::CheckInfoFile(std::string np, XrdOssDF *fh, Cache::PurgeDirStat &ds)
+{
+   static const char* m_traceID = "Purge";
+   XrdOucEnv env;
+
+   // We could also check if it is currently opened with Cache::HaveActiveFileWihtLocalPath()
+   // This is not really necessary because we do that check before unlinking the file
+   Info cinfo(Cache::GetInstance().GetTrace());
+   if (fh->Open(np.c_str(), O_RDONLY, 0600, env) == XrdOssOK && cinfo.Read(fh, np))
+   {
+      time_t accessTime;
+      if ( ! cinfo.GetLatestDetachTime(accessTime))
+      {
+         // cinfo file does not contain any known accesses, use stat.mtime instead.
+
+         TRACE(Debug, "FillFileMapRecurse() could not get access time for " << np << ", trying stat");
+
+         XrdOss* oss = Cache::GetInstance().GetOss();
+         struct stat fstat;
+
+         if (oss->Stat(np.c_str(), &fstat) == XrdOssOK)
+         {
+            accessTime = fstat.st_mtime;
+            TRACE(Dump, "FillFileMapRecurse() have access time for " << np << " via stat: " << accessTime);
+         }
+         else
+         {
+            // This really shouldn't happen ... but if it does remove cinfo and the data file right away.
+
+            TRACE(Warning, "FillFileMapRecurse() could not get access time for " << np
+                                                                                 << "; purging.");
+            oss->Unlink(np.c_str());
+            np = np.substr(0, np.size() - strlen(XrdFileCache::Info::m_infoExtension));
+            oss->Unlink(np.c_str());
+            fh->Close();
+            return;
+         }
+      }
+
+      long long nBytes = cinfo.GetNDownloadedBytes();
+      if (Cache::GetInstance().RefConfiguration().m_hdfscontainer) nBytes += ContainerBytes(np);
+
+      ds.nBytes += nBytes;
+      ds.nFiles++;
+      if (ds.minTime == 0 || accessTime < ds.minTime) ds.minTime = accessTime;
+
+      XrdSysMutexHelper lock(&m_state_mutex);
+      m_state.checkFile(np, nBytes, accessTime);
+   }
+   else
+   {
+      TRACE(Warning, "FillFileMapRecurse() can't open or read " << np << ", err " << strerror(errno)
+                                                                << "; purging.");
+      XrdOss* oss = Cache::GetInstance().GetOss();
+      oss->Unlink(np.c_str());
+      np = np.substr(0, np.size() - strlen(XrdFileCache::Info::m_infoExtension));
+      oss->Unlink(np.c_str());
+   }
+   fh->Close();
+}
+
+void FPurgeScan::ScanDir(const std::string &path)
 {
    char buff[256];
    XrdOucEnv env;
-   int rdr;
    const size_t InfoExtLen = strlen(XrdFileCache::Info::m_infoExtension);  // cached var
 
-   static const char* m_traceID = "Purge";
    Cache& factory = Cache::GetInstance();
-   while ((rdr = iOssDF->Readdir(&buff[0], 256)) >= 0)
+   const char *user = factory.RefConfiguration().m_username.c_str();
+
+   Cache::PurgeDirStat ds;
+
+   XrdOssDF* iOssDF = factory.GetOss()->newDir(user);
+   if (iOssDF->Opendir(path.c_str(), env) != XrdOssOK)
+   {
+      delete iOssDF;
+      return;
+   }
+
+   while (iOssDF->Readdir(&buff[0], 256) >= 0)
    {
-      // printf("readdir [%s]\n", buff);
       std::string np = path + "/" + std::string(buff);
       size_t fname_len = strlen(&buff[0]);
       if (fname_len == 0)
       {
-         // std::cout << "Finish read dir.[" << np <<"] Break loop \n";
          break;
       }
 
       if (strncmp("..", &buff[0], 2) && strncmp(".", &buff[0], 1))
       {
-         XrdOssDF* dh = factory.GetOss()->newDir(factory.RefConfiguration().m_username.c_str());
-         XrdOssDF* fh = factory.GetOss()->newFile(factory.RefConfiguration().m_username.c_str());
-
          if (fname_len > InfoExtLen && strncmp(&buff[fname_len - InfoExtLen], XrdFileCache::Info::m_infoExtension, InfoExtLen) == 0)
          {
-            // We could also check if it is currently opened with Cache::HaveActiveFileWihtLocalPath()
-            // This is not really necessary because we do that check before unlinking the file
-            Info cinfo(Cache::GetInstance().GetTrace());
-            if (fh->Open(np.c_str(), O_RDONLY, 0600, env) == XrdOssOK && cinfo.Read(fh, np))
-            {
-               time_t accessTime;
-               if (cinfo.GetLatestDetachTime(accessTime))
-               {
-                  // TRACE(Dump, "FillFileMapRecurse() checking " << buff << " accessTime  " << accessTime);
-                  purgeState.checkFile(np, cinfo.GetNDownloadedBytes(), accessTime);
-               }
-               else
-               {
-                  // cinfo file does not contain any known accesses, use stat.mtime instead.
-
-                  TRACE(Debug, "FillFileMapRecurse() could not get access time for " << np << ", trying stat");
-
-                  XrdOss* oss = Cache::GetInstance().GetOss();
-                  struct stat fstat;
-
-                  if (oss->Stat(np.c_str(), &fstat) == XrdOssOK)
-                  {
-                     accessTime = fstat.st_mtime;
-                     TRACE(Dump, "FillFileMapRecurse() have access time for " << np << " via stat: " << accessTime);
-                     purgeState.checkFile(np, cinfo.GetNDownloadedBytes(), accessTime);
-                  }
-                  else
-                  {
-                     // This really shouldn't happen ... but if it does remove cinfo and the data file right away.
-
-                     TRACE(Warning, "FillFileMapRecurse() could not get access time for " << np
-                                                                                          << "; purging.");
-                     oss->Unlink(np.c_str());
-                     np = np.substr(0, np.size() - strlen(XrdFileCache::Info::m_infoExtension));
-                     oss->Unlink(np.c_str());
-                  }
-               }
-            }
-            else
+            XrdOssDF* fh = factory.GetOss()->newFile(user);
+            CheckInfoFile(np, fh, ds);
+            delete fh;
+         }
+         else if (m_recurse)
+         {
+            XrdOssDF* dh = factory.GetOss()->newDir(user);
+            if (dh->Opendir(np.c_str(), env) == XrdOssOK)
             {
-               TRACE(Warning, "FillFileMapRecurse() can't open or read " << np << ", err " << strerror(errno)
-                                                                         << "; purging.");
-               XrdOss* oss = Cache::GetInstance().GetOss();
-               oss->Unlink(np.c_str());
-               np = np.substr(0, np.size() - strlen(XrdFileCache::Info::m_infoExtension));
-               oss->Unlink(np.c_str());
+               dh->Close();
+               AddDir(np);
             }
+            delete dh;
+         }
+      }
+   }
+   iOssDF->Close();
+   delete iOssDF;
+
+   XrdSysMutexHelper lock(&m_state_mutex);
+   m_dirs[path] = ds;
+}
+
+//------------------------------------------------------------------------------
+//! Collects complete files of one oss space for moving between cache tiers.
+//------------------------------------------------------------------------------
+
+struct TierCand
+{
+   std::string path;       //!< data file path
+   long long   nBytes;
+   int         nAccess;
+   time_t      time;
+
+   TierCand(const std::string& p, long long n, int a, time_t t) : path(p), nBytes(n), nAccess(a), time(t) {}
+
+   // Least used and oldest first.
+   bool operator<(const TierCand& o) const
+   {
+      return nAccess != o.nAccess ? nAccess < o.nAccess : time < o.time;
+   }
+};
+
+void TierScanDir(const std::string &path, const std::string &space, int min_access,
+                 std::vector<TierCand> &cands)
+{
+   static const char* m_traceID = "Tier";
+   char buff[256], xa[1024];
+   XrdOucEnv env;
+   const size_t InfoExtLen = strlen(XrdFileCache::Info::m_infoExtension);
+
+   Cache& factory = Cache::GetInstance();
+   XrdOss* oss = factory.GetOss();
+   const char *user = factory.RefConfiguration().m_username.c_str();
+
+   XrdOssDF* iOssDF = oss->newDir(user);
+   if (iOssDF->Opendir(path.c_str(), env) != XrdOssOK)
+   {
+      delete iOssDF;
+      return;
+   }
+
+   while (iOssDF->Readdir(&buff[0], 256) >= 0)
+   {
+      size_t fname_len = strlen(&buff[0]);
+      if (fname_len == 0) break;
+      if ( ! strncmp("..", &buff[0], 2) || ! strncmp(".", &buff[0], 1)) continue;
+
+      std::string np = path + "/" + std::string(buff);
+
+      if (fname_len <= InfoExtLen || strncmp(&buff[fname_len - InfoExtLen], XrdFileCache::Info::m_infoExtension, InfoExtLen))
+      {
+         XrdOssDF* dh = oss->newDir(user);
+         if (dh->Opendir(np.c_str(), env) == XrdOssOK)
+         {
+            dh->Close();
+            TierScanDir(np, space, min_access, cands);
+         }
+         delete dh;
+         continue;
+      }
+
+      Info cinfo(factory.GetTrace());
+      XrdOssDF* fh = oss->newFile(user);
+      bool ok = fh->Open(np.c_str(), O_RDONLY, 0600, env) == XrdOssOK && cinfo.Read(fh, np);
+      fh->Close();
+      delete fh;
+
+      if ( ! ok || ! cinfo.IsComplete() || (int) cinfo.GetAccessCnt() < min_access) continue;
+
+      std::string dataPath = np.substr(0, np.size() - InfoExtLen);
+      int xalen = sizeof(xa);
+      if (oss->StatXA(dataPath.c_str(), xa, xalen) != XrdOssOK) continue;
+
+      XrdOucEnv xaEnv(xa, xalen);
+      const char *cgroup = xaEnv.Get("oss.cgroup");
+      if ( ! cgroup || space != cgroup) continue;
+
+      time_t t = 0;
+      cinfo.GetLatestDetachTime(t);
+      cands.push_back(TierCand(dataPath, cinfo.GetNDownloadedBytes(), (int) cinfo.GetAccessCnt(), t));
+      TRACE(Dump, "TierScanDir() candidate " << dataPath << " in " << space << ", accesses " << cinfo.GetAccessCnt());
+   }
+   iOssDF->Close();
+   delete iOssDF;
+}
+
+} // end anon namespace
+
+//------------------------------------------------------------------------------
+
+void Cache::PurgeIndexTouch(const std::string &info_path)
+{
+   // Called when the access statistics of a cinfo file change or the file is
+   // removed. The directory will be rescanned on the next purge.
+
+   std::string::size_type pos = info_path.rfind('/');
+   std::string dir = (pos == std::string::npos) ? std::string() : info_path.substr(0, pos);
+
+   XrdSysMutexHelper lock(&m_purge_index_mutex);
+
+   PurgeDirStat &ds = m_purge_index[dir];
+   ds.dirty = true;
+   ds.gen   = ++m_purge_index_gen;
+}
+
+//------------------------------------------------------------------------------
+
+void Cache::ScanForPurge(FPurgeState &purgeState, bool full_scan)
+{
+   // Fill purgeState with purge candidates. A full scan walks the whole cache
+   // namespace and rebuilds the purge index. Otherwise only directories that
+   // changed since they were last scanned are read, plus unchanged ones in
+   // order of their oldest access time, for as long as they can still hold
+   // files older than the candidates found so far.
+
+   static const char *trc_pfx = "Cache::ScanForPurge() ";
+
+   const int nThreads = m_configuration.m_purgeThreads;
+
+   long long gen;
+   bool      valid;
+   {
+      XrdSysMutexHelper lock(&m_purge_index_mutex);
+      gen   = m_purge_index_gen;
+      valid = m_purge_index_valid;
+   }
+
+   if (full_scan || ! valid)
+   {
+      FPurgeScan scan(purgeState, true);
+      scan.AddDir("");
+      scan.Run(nThreads);
+
+      XrdSysMutexHelper lock(&m_purge_index_mutex);
+      for (PurgeDirStatMap_t::iterator i = m_purge_index.begin(); i != m_purge_index.end(); )
+      {
+         if (i->second.gen > gen) ++i;
+         else m_purge_index.erase(i++);
+      }
+      for (PurgeDirStatMap_t::iterator i = scan.m_dirs.begin(); i != scan.m_dirs.end(); ++i)
+      {
+         PurgeDirStat &ds = m_purge_index[i->first];
+         bool dirty = ds.gen > gen;
+         ds = i->second;
+         ds.dirty = dirty;
+      }
+      m_purge_index_valid = true;
+
+      TRACE(Debug, trc_pfx << "full scan of " << scan.m_dirs.size() << " directories.");
+      return;
+   }
+
+   // Split the index into changed and unchanged directories.
+   std::vector<std::pair<time_t, std::string> > clean;
+   FPurgeScan scan(purgeState, false);
+   int nDirty = 0;
+   {
+      XrdSysMutexHelper lock(&m_purge_index_mutex);
+      for (PurgeDirStatMap_t::iterator i = m_purge_index.begin(); i != m_purge_index.end(); ++i)
+      {
+         if (i->second.dirty)
+         {
+            scan.AddDir(i->first);
+            ++nDirty;
          }
-         else if (dh->Opendir(np.c_str(), env) == XrdOssOK)
+         else
          {
-            FillFileMapRecurse(dh, np, purgeState);
+            clean.push_back(std::make_pair(i->second.minTime, i->first));
+            purgeState.addNBytesTotal(i->second.nBytes);
          }
+      }
+   }
+   std::sort(clean.begin(), clean.end());
+
+   scan.Run(nThreads);
+
+   // Unchanged directories, oldest first, in batches of a few per thread.
+   size_t ci = 0;
+   while (ci < clean.size())
+   {
+      const time_t t = clean[ci].first;
+      if ( ! purgeState.needsMore() && t >= purgeState.getNewestTime() &&
+           ! (purgeState.getMinTime() > 0 && t < purgeState.getMinTime()))
+         break;
 
-         delete dh; dh = 0;
-         delete fh; fh = 0;
+      FPurgeScan batch(purgeState, false);
+      for (int n = 0; n < 4 * nThreads && ci < clean.size(); ++n, ++ci)
+      {
+         batch.AddDir(clean[ci].second);
+         XrdSysMutexHelper lock(&m_purge_index_mutex);
+         PurgeDirStatMap_t::iterator i = m_purge_index.find(clean[ci].second);
+         if (i != m_purge_index.end()) purgeState.addNBytesTotal(- i->second.nBytes);
       }
+      batch.Run(nThreads);
+      scan.m_dirs.insert(batch.m_dirs.begin(), batch.m_dirs.end());
+   }
+
+   XrdSysMutexHelper lock(&m_purge_index_mutex);
+   for (PurgeDirStatMap_t::iterator i = scan.m_dirs.begin(); i != scan.m_dirs.end(); ++i)
+   {
+      PurgeDirStat &ds = m_purge_index[i->first];
+      bool dirty = ds.gen > gen;
+      ds = i->second;
+      ds.dirty = dirty;
    }
+
+   TRACE(Debug, trc_pfx << "scanned " << nDirty << " changed and " << ci << " of "
+                        << clean.size() << " unchanged directories.");
 }
 
-} // end anon namespace
+//------------------------------------------------------------------------------
+
+void Cache::Tier(bool promote)
+{
+   // Move complete files between the fast and the slow data space. When the
+   // fast space is above its high watermark the least used files go to the
+   // slow one until the low watermark is reached. Otherwise, if requested,
+   // files on the slow space that are used often are brought back for as long
+   // as the fast space stays below the low watermark. A file is claimed in the
+   // active map while it is moved so that it can not be opened meanwhile.
+
+   static const char *trc_pfx = "Cache::Tier() ";
+
+   const Configuration &conf = m_configuration;
+   XrdOssVSInfo sP;
+
+   if (m_output_fs->StatVS(&sP, conf.m_data_space.c_str(), 1) < 0 || sP.Total <= 0)
+   {
+      TRACE(Error, trc_pfx << "can't get statvs for oss space " << conf.m_data_space);
+      return;
+   }
+
+   const long long used = sP.Total - sP.Free;
+   const long long lwm  = static_cast<long long>(sP.Total * conf.m_tierFastLWM);
+   const long long hwm  = static_cast<long long>(sP.Total * conf.m_tierFastHWM);
+
+   bool demote = used > hwm;
+   if ( ! demote && ( ! promote || used >= lwm)) return;
+
+   std::vector<TierCand> cands;
+   std::string from = demote ? conf.m_data_space : conf.m_tier_slow;
+   std::string to   = demote ? conf.m_tier_slow  : conf.m_data_space;
+   TierScanDir("", from, demote ? 0 : conf.m_tierPromoteCnt, cands);
+
+   std::sort(cands.begin(), cands.end());
+   if ( ! demote) std::reverse(cands.begin(), cands.end());
+
+   long long todo = demote ? used - lwm : lwm - used;
+   int       nMoved = 0;
+
+   for (std::vector<TierCand>::iterator i = cands.begin(); i != cands.end() && todo > 0; ++i)
+   {
+      if ( ! demote && i->nBytes > todo) continue;
+
+      {
+         XrdSysCondVarHelper lock(&m_active_cond);
+         if (m_active.find(i->path) != m_active.end()) continue;
+         m_active[i->path] = 0;
+      }
+
+      int rc = m_output_fs->Reloc(conf.m_username.c_str(), i->path.c_str(), to.c_str());
+
+      {
+         XrdSysCondVarHelper lock(&m_active_cond);
+         m_active.erase(i->path);
+         m_active_cond.Broadcast();
+      }
+
+      if (rc == XrdOssOK)
+      {
+         todo -= i->nBytes;
+         ++nMoved;
+         TRACE(Debug, trc_pfx << "moved " << i->path << " to " << to << ", accesses " << i->nAccess);
+      }
+      else
+      {
+         TRACE(Warning, trc_pfx << "can't move " << i->path << " to " << to << ", err " << strerror(-rc));
+      }
+   }
+
+   TRACE(Info, trc_pfx << (demote ? "demoted " : "promoted ") << nMoved << " of " << cands.size() << " candidate files.");
+}
 
 //------------------------------------------------------------------------------
 
@@ -188,6 +624,8 @@ void Cache::Purge()
    sleep(1);
 
    int  age_based_purge_countdown = 0; // enforce on first purge loop entry.
+   int  full_scan_countdown       = 0; // build purge index on first scan.
+   int  tier_promote_countdown    = 1; // look for files to promote on second loop.
    bool is_first = true;
 
    while (true)
@@ -203,7 +641,7 @@ void Cache::Purge()
       long long bytesToRemove_d = 0, bytesToRemove_f = 0;
 
       // get amount of space to potentially erase based on total disk usage
-      if (oss->StatVS(&sP, m_configuration.m_data_space.c_str(), 1) < 0)
+      if (StatDataSpace(sP) < 0)
       {
          TRACE(Error, trc_pfx << "can't get statvs for oss space " << m_configuration.m_data_space);
          continue;
@@ -213,6 +651,11 @@ void Cache::Purge()
          disk_usage = sP.Total - sP.Free;
          TRACE(Debug, trc_pfx << "used disk space " << disk_usage << " bytes.");
 
+         int nSlots, nUsed, nPeak; long long nHeap;
+         GetBlockPoolStats(nSlots, nUsed, nPeak, nHeap);
+         TRACE(Debug, trc_pfx << "RAM pool slots used " << nUsed << " of " << nSlots
+                      << ", peak " << nPeak << ", heap allocations " << nHeap << ".");
+
          if (disk_usage > m_configuration.m_diskUsageHWM)
          {
             bytesToRemove_d = disk_usage - m_configuration.m_diskUsageLWM;
@@ -266,6 +709,7 @@ void Cache::Purge()
 
       long long bytesToRemove_at_start = 0; // set after file scan
       int       deleted_file_count     = 0;
+      int       victim_freq            = -1; // admission threshold, see Cache::Admit()
 
       if (bytesToRemove > 0 || enforce_age_based_purge)
       {
@@ -277,13 +721,10 @@ void Cache::Purge()
             purgeState.setMinTime(time(0) - m_configuration.m_purgeColdFilesAge);
          }
 
-         XrdOssDF* dh = oss->newDir(m_configuration.m_username.c_str());
-         if (dh->Opendir("", env) == XrdOssOK)
-         {
-            FillFileMapRecurse(dh, "", purgeState);
-            dh->Close();
-         }
-         delete dh; dh = 0;
+         bool full_scan = --full_scan_countdown <= 0;
+         if (full_scan) full_scan_countdown = m_configuration.m_purgeFullScanPeriod;
+
+         ScanForPurge(purgeState, full_scan);
 
          estimated_file_usage = purgeState.getNBytesTotal();
 
@@ -317,7 +758,8 @@ void Cache::Purge()
 
          // Loop over map and remove files with oldest values of access time.
          struct stat fstat;
-         for (FPurgeState::map_i it = purgeState.fmap.begin(); it != purgeState.fmap.end(); ++it)
+         FPurgeState::map_i it;
+         for (it = purgeState.fmap.begin(); it != purgeState.fmap.end(); ++it)
          {
             // Finish when enough space has been freed but not while purging of cold files is in progress.
             if (bytesToRemove <= 0 && ! (m_configuration.is_age_based_purge_in_effect() && it->first < purgeState.getMinTime()))
@@ -354,8 +796,37 @@ void Cache::Purge()
                oss->Unlink(dataPath.c_str());
                TRACE(Dump, trc_pfx << "Removed file: '" << dataPath << "' size: " << it->second.nBytes <<
                      ", time: " << it->first);
+
+               PurgeIndexTouch(infoPath);
+
+               if (m_configuration.m_hdfscontainer)
+                  oss->Unlink((dataPath + Info::m_indexExtension).c_str());
+
+               if (m_configuration.m_admission)
+                  victim_freq = m_freq_sketch.Estimate(dataPath);
+            }
+         }
+
+         // While space had to be freed, new data has to be used more often
+         // than the file that would be removed next to be admitted.
+         if (m_configuration.m_admission && bytesToRemove_at_start > 0)
+         {
+            for ( ; it != purgeState.fmap.end(); ++it)
+            {
+               std::string infoPath = it->second.path;
+               std::string dataPath = infoPath.substr(0, infoPath.size() - strlen(XrdFileCache::Info::m_infoExtension));
+
+               if (IsFileActiveOrPurgeProtected(dataPath))
+                  continue;
+
+               victim_freq = m_freq_sketch.Estimate(dataPath);
+               break;
             }
          }
+         else
+         {
+            victim_freq = -1;
+         }
       }
 
       {
@@ -365,7 +836,20 @@ void Cache::Purge()
          m_in_purge = false;
       }
 
+      __atomic_store_n(&m_admit_victim_freq, victim_freq, __ATOMIC_RELAXED);
+      if (m_configuration.m_admission)
+      {
+         TRACE(Debug, trc_pfx << "admission victim frequency " << victim_freq << ".");
+      }
+
       TRACE(Info, trc_pfx << "Finished, removed " << deleted_file_count << " data files, total size " << bytesToRemove_at_start - bytesToRemove << " B.");
+
+      if (m_configuration.are_tiers_set())
+      {
+         bool promote = --tier_promote_countdown <= 0;
+         if (promote) tier_promote_countdown = m_configuration.m_purgeFullScanPeriod;
+         Tier(promote);
+      }
       sleep(m_configuration.m_purgeInterval);
    }
 }
@@ -0,0 +1,843 @@
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------
+// xrdpfc_replay: replays an access trace against an XrdFileCache instance that
+// fronts a simulated or a real origin and reports what the cache did. The trace
+// is a text file with one request per line, times in seconds from the start:
+//
+//    <time> open  <fileid> <path> [<size>]
+//    <time> read  <fileid> <offset> <length>
+//    <time> readv <fileid> <offset>:<length>[,<offset>:<length>...]
+//    <time> close <fileid>
+//
+// The file ids are those of the monitoring f-stream (dictionary ids), so a
+// trace is easily written by a collector of the f-stream and i/o records.
+// Lines starting with '#' are ignored. A file size missing from an open is
+// taken from the real origin or, for the simulated one, from the largest
+// extent read in the trace.
+//----------------------------------------------------------------------------------
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "XrdCl/XrdClFile.hh"
+#include "XrdOss/XrdOss.hh"
+#include "XrdOuc/XrdOucArgs.hh"
+#include "XrdOuc/XrdOucCache2.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+#include "XrdSys/XrdSysPthread.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+#include "XrdFileCache.hh"
+
+extern "C" XrdOucCache2 *XrdOucGetCache2(XrdSysLogger *logger,
+                                         const char   *config_filename,
+                                         const char   *parameters);
+
+using namespace XrdFileCache;
+
+namespace
+{
+long long usecNow()
+{
+   struct timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+void sleepUntil(long long usec)
+{
+   long long d = usec - usecNow();
+   if (d > 0) { struct timespec ts = { (time_t) (d / 1000000), (long) (d % 1000000) * 1000 }; nanosleep(&ts, 0); }
+}
+
+//! Contents of simulated origin files, a function of path and offset so that
+//! the data clients get can be verified.
+inline unsigned char PatternByte(unsigned int h, long long off)
+{
+   return (unsigned char) (h + off * 7 + (off >> 12));
+}
+
+unsigned int PathHash(const std::string &path)
+{
+   unsigned int h = 2166136261u;
+   for (size_t i = 0; i < path.size(); ++i) h = (h ^ (unsigned char) path[i]) * 16777619u;
+   return h;
+}
+
+//==============================================================================
+// Origin
+//==============================================================================
+
+class OriginIO;
+
+//------------------------------------------------------------------------------
+//! The link to the origin. Simulated requests complete after a fixed latency
+//! and, when a bandwidth is given, after the time to transfer them over a link
+//! shared by all requests. Real requests are XrdCl reads. Asynchronous reads
+//! are served by a pool of threads so that callbacks never run on the thread
+//! of the cache that issued them.
+//------------------------------------------------------------------------------
+class Origin
+{
+public:
+   Origin(const std::string &url, long long latency, long long bw, int nThreads) :
+      m_url(url), m_latency(latency), m_bw(bw), m_linkFree(0), m_cond(0),
+      m_bytes(0), m_reqs(0)
+   {
+      for (int i = 0; i < nThreads; ++i)
+      {
+         pthread_t tid;
+         XrdSysThread::Run(&tid, Worker, this, 0, "xrdpfc_replay origin");
+      }
+   }
+
+   bool IsReal() const { return ! m_url.empty(); }
+
+   const std::string& Url() const { return m_url; }
+
+   //! Time at which a simulated request of size len, issued now, completes.
+   long long Due(int len)
+   {
+      long long now = usecNow();
+      if (m_bw <= 0) return now + m_latency;
+      XrdSysMutexHelper lock(&m_linkMutex);
+      long long start = std::max(now + m_latency, m_linkFree);
+      m_linkFree = start + (long long) len * 1000000 / m_bw;
+      return m_linkFree;
+   }
+
+   int  Read(OriginIO *io, char *buff, long long off, int len);
+
+   void Submit(OriginIO *io, XrdOucCacheIOCB *cb, char *buff, long long off, int len)
+   {
+      Job j = { io, cb, buff, off, len, IsReal() ? 0 : Due(len) };
+      m_cond.Lock();
+      m_queue.push_back(j);
+      m_cond.Signal();
+      m_cond.UnLock();
+   }
+
+   void Account(int len)
+   {
+      __atomic_add_fetch(&m_bytes, len, __ATOMIC_RELAXED);
+      __atomic_add_fetch(&m_reqs,  1,   __ATOMIC_RELAXED);
+   }
+
+   long long GetBytes() const { return m_bytes; }
+   long long GetReqs()  const { return m_reqs; }
+
+private:
+   struct Job
+   {
+      OriginIO        *io;
+      XrdOucCacheIOCB *cb;
+      char            *buff;
+      long long        off;
+      int              len;
+      long long        due;
+   };
+
+   static void* Worker(void *arg);
+   void         Serve(const Job &j);
+
+   std::string      m_url;
+   long long        m_latency;   //!< usec
+   long long        m_bw;        //!< bytes/s, 0 if not limited
+   long long        m_linkFree;  //!< time the shared link is free
+   XrdSysMutex      m_linkMutex;
+   XrdSysCondVar    m_cond;
+   std::deque<Job>  m_queue;
+   long long        m_bytes;
+   long long        m_reqs;
+};
+
+//------------------------------------------------------------------------------
+//! One open origin file, this is what the cache is attached to.
+//------------------------------------------------------------------------------
+class OriginIO : public XrdOucCacheIO2
+{
+public:
+   OriginIO(Origin &o, const std::string &path, long long size) :
+      m_origin(o), m_path(path), m_size(size), m_hash(PathHash(path)),
+      m_file(0), m_reads(0)
+   {
+      if (o.IsReal())
+      {
+         m_url = o.Url() + "/" + path;
+         m_file = new XrdCl::File(false);
+         XrdCl::XRootDStatus st = m_file->Open(m_url, XrdCl::OpenFlags::Read);
+         XrdCl::StatInfo *si = 0;
+         if (st.IsOK()) st = m_file->Stat(false, si);
+         if (st.IsOK() && si) m_size = si->GetSize();
+         else m_size = -EIO;
+         delete si;
+      }
+      else
+      {
+         m_url = "root://origin.sim:1094/" + path;
+      }
+   }
+
+   ~OriginIO()
+   {
+      if (m_file)
+      {
+         if (m_file->IsOpen()) XrdCl::XRootDStatus st = m_file->Close();
+         delete m_file;
+      }
+   }
+
+   virtual long long   FSize() { return m_size; }
+   virtual const char *Path()  { return m_url.c_str(); }
+   virtual const char *Location() { return m_origin.IsReal() ? m_origin.Url().c_str() : "origin.sim"; }
+
+   virtual int Fstat(struct stat &sbuff)
+   {
+      if (m_size < 0) return (int) m_size;
+      sbuff.st_size   = m_size;
+      sbuff.st_blocks = (m_size + 511) / 512;
+      sbuff.st_mode   = S_IFREG | 0644;
+      sbuff.st_mtime  = sbuff.st_atime = sbuff.st_ctime = 1;
+      sbuff.st_ino    = m_hash;
+      return 0;
+   }
+
+   using XrdOucCacheIO2::Read;
+
+   virtual int Read(char *buff, long long off, int len)
+   {
+      __atomic_add_fetch(&m_reads, 1, __ATOMIC_RELAXED);
+      return m_origin.Read(this, buff, off, len);
+   }
+
+   virtual void Read(XrdOucCacheIOCB &iocb, char *buff, long long off, int len)
+   {
+      __atomic_add_fetch(&m_reads, 1, __ATOMIC_RELAXED);
+      m_origin.Submit(this, &iocb, buff, off, len);
+   }
+
+   virtual int Sync()                          { return 0; }
+   virtual int Trunc(long long)                { return -ENOTSUP; }
+   virtual int Write(char *, long long, int)   { return -ENOTSUP; }
+
+   //! Fill buff as the simulated origin would.
+   int Fill(char *buff, long long off, int len)
+   {
+      if (off >= m_size) return 0;
+      if (off + len > m_size) len = m_size - off;
+      for (int i = 0; i < len; ++i) buff[i] = PatternByte(m_hash, off + i);
+      return len;
+   }
+
+   //! Number of bytes of buff not matching the simulated origin.
+   long long Verify(const char *buff, long long off, int len) const
+   {
+      long long bad = 0;
+      for (int i = 0; i < len; ++i) if ((unsigned char) buff[i] != PatternByte(m_hash, off + i)) ++bad;
+      return bad;
+   }
+
+   XrdCl::File* GetXrdClFile() { return m_file; }
+   long long    GetReads() const { return __atomic_load_n(&m_reads, __ATOMIC_RELAXED); }
+
+private:
+   Origin       &m_origin;
+   std::string   m_path;
+   std::string   m_url;
+   long long     m_size;
+   unsigned int  m_hash;
+   XrdCl::File  *m_file;
+   long long     m_reads;
+};
+
+int Origin::Read(OriginIO *io, char *buff, long long off, int len)
+{
+   int res;
+   if (IsReal())
+   {
+      uint32_t bytesRead = 0;
+      XrdCl::XRootDStatus st = io->GetXrdClFile()->Read(off, len, buff, bytesRead);
+      res = st.IsOK() ? (int) bytesRead : -EIO;
+   }
+   else
+   {
+      sleepUntil(Due(len));
+      res = io->Fill(buff, off, len);
+   }
+   if (res > 0) Account(res);
+   return res;
+}
+
+void* Origin::Worker(void *arg)
+{
+   Origin *o = (Origin*) arg;
+   while (true)
+   {
+      o->m_cond.Lock();
+      while (o->m_queue.empty()) o->m_cond.Wait();
+      Job j = o->m_queue.front();
+      o->m_queue.pop_front();
+      o->m_cond.UnLock();
+      o->Serve(j);
+   }
+   return 0;
+}
+
+void Origin::Serve(const Job &j)
+{
+   int res;
+   if (IsReal())
+   {
+      uint32_t bytesRead = 0;
+      XrdCl::XRootDStatus st = j.io->GetXrdClFile()->Read(j.off, j.len, j.buff, bytesRead);
+      res = st.IsOK() ? (int) bytesRead : -EIO;
+   }
+   else
+   {
+      sleepUntil(j.due);
+      res = j.io->Fill(j.buff, j.off, j.len);
+   }
+   if (res > 0) Account(res);
+   j.cb->Done(res);
+}
+
+//==============================================================================
+// Trace
+//==============================================================================
+
+enum Op { kOpen = 0, kRead, kReadV, kClose, kNOps };
+
+const char *opName[kNOps] = { "open", "read", "readv", "close" };
+
+struct Event
+{
+   long long   t;        //!< usec from the start of the trace
+   Op          op;
+   long long   fid;
+   std::string path;
+   long long   size;
+   std::vector<std::pair<long long, int> > chunks;
+};
+
+bool EventBefore(const Event &a, const Event &b) { return a.t < b.t; }
+
+bool ParseTrace(const char *fn, std::vector<Event> &evs)
+{
+   FILE *fp = fopen(fn, "r");
+   if ( ! fp) { fprintf(stderr, "xrdpfc_replay: unable to open %s; %s\n", fn, strerror(errno)); return false; }
+
+   std::map<long long, size_t> lastOpen;
+   char line[65536];
+   int  lno = 0;
+   while (fgets(line, sizeof(line), fp))
+   {
+      ++lno;
+      char *save = 0;
+      char *tok  = strtok_r(line, " \t\n", &save);
+      if ( ! tok || *tok == '#') continue;
+
+      Event e;
+      e.t = (long long) (atof(tok) * 1e6);
+      e.size = 0;
+      char *op  = strtok_r(0, " \t\n", &save);
+      char *fid = strtok_r(0, " \t\n", &save);
+      char *a1  = strtok_r(0, " \t\n", &save);
+      char *a2  = strtok_r(0, " \t\n", &save);
+      if ( ! op || ! fid) { fprintf(stderr, "xrdpfc_replay: %s:%d: bad line\n", fn, lno); continue; }
+      e.fid = strtoll(fid, 0, 10);
+
+      if ( ! strcmp(op, "open") && a1)
+      {
+         e.op = kOpen; e.path = a1;
+         if (a2) e.size = strtoll(a2, 0, 10);
+         lastOpen[e.fid] = evs.size();
+      }
+      else if ( ! strcmp(op, "read") && a1 && a2)
+      {
+         e.op = kRead;
+         e.chunks.push_back(std::make_pair(strtoll(a1, 0, 10), atoi(a2)));
+      }
+      else if ( ! strcmp(op, "readv") && a1)
+      {
+         e.op = kReadV;
+         char *s2 = 0;
+         for (char *c = strtok_r(a1, ",", &s2); c; c = strtok_r(0, ",", &s2))
+         {
+            char *colon = strchr(c, ':');
+            if (colon) e.chunks.push_back(std::make_pair(strtoll(c, 0, 10), atoi(colon + 1)));
+         }
+      }
+      else if ( ! strcmp(op, "close"))
+      {
+         e.op = kClose;
+      }
+      else
+      {
+         fprintf(stderr, "xrdpfc_replay: %s:%d: bad line\n", fn, lno);
+         continue;
+      }
+
+      // Infer the size of the file from what is read of it.
+      if (e.op == kRead || e.op == kReadV)
+      {
+         std::map<long long, size_t>::iterator i = lastOpen.find(e.fid);
+         if (i == lastOpen.end()) continue;
+         Event &o = evs[i->second];
+         long long end = 0;
+         for (size_t k = 0; k < e.chunks.size(); ++k)
+            end = std::max(end, e.chunks[k].first + e.chunks[k].second);
+         if (o.size <= 0 && -o.size < end) o.size = -end;
+      }
+      evs.push_back(e);
+   }
+   fclose(fp);
+
+   // Inferred sizes were kept negative so as not to mix with given ones.
+   for (size_t i = 0; i < evs.size(); ++i) if (evs[i].size < 0) evs[i].size = -evs[i].size;
+
+   std::stable_sort(evs.begin(), evs.end(), EventBefore);
+   return true;
+}
+
+//==============================================================================
+// Replay
+//==============================================================================
+
+struct Results
+{
+   std::vector<long long> lat[kNOps];  //!< usec
+   long long nReq, nHit, bytes, errors, badBytes;
+
+   Results() : nReq(0), nHit(0), bytes(0), errors(0), badBytes(0) {}
+
+   void Add(const Results &r)
+   {
+      for (int i = 0; i < kNOps; ++i) lat[i].insert(lat[i].end(), r.lat[i].begin(), r.lat[i].end());
+      nReq += r.nReq; nHit += r.nHit; bytes += r.bytes; errors += r.errors; badBytes += r.badBytes;
+   }
+};
+
+//------------------------------------------------------------------------------
+//! An open file. The cache serves one IO per file, a second attach of a path
+//! takes the file away from the first IO. Overlapping opens of a path, which
+//! are frequent in real traces, therefore share the handle of the first one.
+//------------------------------------------------------------------------------
+struct Handle
+{
+   XrdOucCacheIO2 *cio;
+   OriginIO       *oio;
+   std::string     path;
+   int             refs;
+};
+
+//------------------------------------------------------------------------------
+//! Closed files are detached once the cache has no more I/O in progress on
+//! them, as XrdPosix does.
+//------------------------------------------------------------------------------
+class Reaper
+{
+public:
+   Reaper() : m_cond(0)
+   {
+      pthread_t tid;
+      XrdSysThread::Run(&tid, Run, this, 0, "xrdpfc_replay reaper");
+   }
+
+   void Add(Handle *h)
+   {
+      m_cond.Lock(); m_list.push_back(h); m_cond.UnLock();
+   }
+
+   void Drain()
+   {
+      m_cond.Lock();
+      while ( ! m_list.empty()) m_cond.Wait();
+      m_cond.UnLock();
+   }
+
+private:
+   static void* Run(void *arg)
+   {
+      Reaper *r = (Reaper*) arg;
+      while (true)
+      {
+         std::list<Handle*> done;
+         r->m_cond.Lock();
+         for (std::list<Handle*>::iterator i = r->m_list.begin(); i != r->m_list.end(); )
+         {
+            Handle *h = *i;
+            if (h->cio == h->oio || ! h->cio->ioActive()) { done.push_back(h); i = r->m_list.erase(i); }
+            else ++i;
+         }
+         r->m_cond.UnLock();
+
+         for (std::list<Handle*>::iterator i = done.begin(); i != done.end(); ++i)
+         {
+            if ((*i)->cio != (*i)->oio) (*i)->cio->Detach();
+            delete (*i)->oio;
+            delete *i;
+         }
+
+         r->m_cond.Lock();
+         if (r->m_list.empty()) r->m_cond.Broadcast();
+         r->m_cond.UnLock();
+         XrdSysTimer::Wait(10);
+      }
+      return 0;
+   }
+
+   XrdSysCondVar      m_cond;
+   std::list<Handle*> m_list;
+};
+
+//------------------------------------------------------------------------------
+//! Handles of the open paths.
+//------------------------------------------------------------------------------
+class OpenFiles
+{
+public:
+   OpenFiles(Origin &o, Reaper &r) : m_origin(o), m_reaper(r) {}
+
+   Handle* Open(const std::string &path, long long size)
+   {
+      XrdSysMutexHelper lock(&m_mutex);
+      std::map<std::string, Handle*>::iterator i = m_files.find(path);
+      if (i != m_files.end()) { ++i->second->refs; return i->second; }
+
+      Handle *h = new Handle;
+      h->oio  = new OriginIO(m_origin, path, size);
+      if (h->oio->FSize() < 0) { delete h->oio; delete h; return 0; }
+      h->cio  = Cache::GetInstance().Attach(h->oio);
+      h->path = path;
+      h->refs = 1;
+      m_files[path] = h;
+      return h;
+   }
+
+   void Close(Handle *h)
+   {
+      XrdSysMutexHelper lock(&m_mutex);
+      if (--h->refs > 0) return;
+      m_files.erase(h->path);
+      m_reaper.Add(h);
+   }
+
+private:
+   Origin                         &m_origin;
+   Reaper                         &m_reaper;
+   XrdSysMutex                     m_mutex;
+   std::map<std::string, Handle*>  m_files;
+};
+
+struct Worker
+{
+   std::vector<Event> evs;
+   Results            res;
+   OpenFiles         *files;
+   long long          start;
+   double             speed;
+   bool               verify;
+};
+
+void* RunWorker(void *arg)
+{
+   Worker &w = *(Worker*) arg;
+   std::map<long long, Handle*> files;
+   std::vector<char> buff;
+
+   for (size_t n = 0; n < w.evs.size(); ++n)
+   {
+      Event &e = w.evs[n];
+      if (w.speed > 0) sleepUntil(w.start + (long long) (e.t / w.speed));
+
+      std::map<long long, Handle*>::iterator fi = files.find(e.fid);
+      if (e.op != kOpen && fi == files.end()) continue;
+
+      Handle    *h  = (e.op != kOpen) ? fi->second : 0;
+      long long  t0 = usecNow();
+      bool       ok = true;
+      long long  r0 = h ? h->oio->GetReads() : 0;
+
+      switch (e.op)
+      {
+         case kOpen:
+         {
+            if (fi != files.end()) { w.files->Close(fi->second); files.erase(fi); }
+            if ((h = w.files->Open(e.path, e.size))) files[e.fid] = h;
+            else ok = false;
+            break;
+         }
+         case kRead:
+         {
+            long long off = e.chunks[0].first;
+            int       len = e.chunks[0].second;
+            if ((int) buff.size() < len) buff.resize(len);
+            int res = h->cio->Read(&buff[0], off, len);
+            if (res < 0) { ok = false; break; }
+            w.res.bytes += res;
+            if (w.verify) w.res.badBytes += h->oio->Verify(&buff[0], off, res);
+            break;
+         }
+         case kReadV:
+         {
+            std::vector<XrdOucIOVec> iov(e.chunks.size());
+            long long total = 0;
+            for (size_t k = 0; k < e.chunks.size(); ++k) total += e.chunks[k].second;
+            if ((long long) buff.size() < total) buff.resize(total);
+            total = 0;
+            for (size_t k = 0; k < e.chunks.size(); ++k)
+            {
+               iov[k].offset = e.chunks[k].first;
+               iov[k].size   = e.chunks[k].second;
+               iov[k].info   = 0;
+               iov[k].data   = &buff[total];
+               total += e.chunks[k].second;
+            }
+            int res = h->cio->ReadV(&iov[0], (int) iov.size());
+            if (res < 0) { ok = false; break; }
+            w.res.bytes += res;
+            if (w.verify)
+               for (size_t k = 0; k < iov.size(); ++k)
+                  w.res.badBytes += h->oio->Verify(iov[k].data, iov[k].offset, iov[k].size);
+            break;
+         }
+         case kClose:
+         {
+            w.files->Close(h);
+            files.erase(fi);
+            break;
+         }
+         default: break;
+      }
+
+      w.res.lat[e.op].push_back(usecNow() - t0);
+      if ( ! ok) { ++w.res.errors; continue; }
+      if (e.op == kRead || e.op == kReadV)
+      {
+         ++w.res.nReq;
+         if (h->oio->GetReads() == r0) ++w.res.nHit;
+      }
+   }
+
+   for (std::map<long long, Handle*>::iterator i = files.begin(); i != files.end(); ++i)
+      w.files->Close(i->second);
+   return 0;
+}
+
+//------------------------------------------------------------------------------
+//! Periodic sampling of RAM block and disk usage, to see what purge does.
+//------------------------------------------------------------------------------
+struct Sampler
+{
+   int       interval;    //!< seconds
+   bool      verbose;
+   int       peakUsed;
+   long long diskFirst, diskLast, diskMax, purges, purged;
+   volatile bool stop;
+
+   Sampler() : interval(1), verbose(false), peakUsed(0), diskFirst(-1), diskLast(-1),
+               diskMax(0), purges(0), purged(0), stop(false) {}
+
+   void Sample(long long t0)
+   {
+      int nSlots, nUsed, nPeak; long long nHeap;
+      Cache::GetInstance().GetBlockPoolStats(nSlots, nUsed, nPeak, nHeap);
+      peakUsed = std::max(peakUsed, nUsed);
+
+      XrdOssVSInfo sP;
+      if (Cache::GetInstance().StatDataSpace(sP) < 0) return;
+      long long used = sP.Total - sP.Free;
+      if (diskFirst < 0) diskFirst = used;
+      if (diskLast >= 0 && used < diskLast - (1 << 20)) { ++purges; purged += diskLast - used; }
+      diskLast = used;
+      diskMax  = std::max(diskMax, used);
+
+      if (verbose)
+         printf("%8.1f s  ram slots used %d of %d  disk used %lld MB\n",
+                (usecNow() - t0) / 1e6, nUsed, nSlots, used >> 20);
+   }
+};
+
+void* RunSampler(void *arg)
+{
+   Sampler &s = *(Sampler*) arg;
+   long long t0 = usecNow();
+   while ( ! s.stop)
+   {
+      s.Sample(t0);
+      XrdSysTimer::Snooze(s.interval);
+   }
+   return 0;
+}
+
+long long Percentile(std::vector<long long> &v, double p)
+{
+   if (v.empty()) return 0;
+   size_t i = (size_t) (p * (v.size() - 1) + 0.5);
+   return v[i];
+}
+}
+
+//______________________________________________________________________________
+
+int main(int argc, char *argv[])
+{
+   static const char* usage = "Usage: xrdpfc_replay -c config_file [-l log_file] [-j threads] [-x speed]\n"
+                              "                     [-o sim[:latency_ms[:MB/s]] | -o root://host[:port]]\n"
+                              "                     [-i interval] [-v] trace_file\n\n";
+   const char *cfgn = 0, *logn = 0, *orig = "sim";
+   int    nThreads = 8, interval = 1;
+   double speed = 1;
+   bool   verbose = false;
+
+   XrdSysLogger log;
+   XrdSysError  err(&log);
+   XrdOucArgs   Spec(&err, "xrdpfc_replay: ", "c:l:j:x:o:i:v", (const char *) 0);
+
+   Spec.Set(argc-1, &argv[1]);
+   char theOpt;
+   while ((theOpt = Spec.getopt()) != (char)-1)
+   {
+      switch (theOpt)
+      {
+         case 'c': cfgn     = Spec.argval;         break;
+         case 'l': logn     = Spec.argval;         break;
+         case 'j': nThreads = atoi(Spec.argval);   break;
+         case 'x': speed    = atof(Spec.argval);   break;
+         case 'o': orig     = Spec.argval;         break;
+         case 'i': interval = atoi(Spec.argval);   break;
+         case 'v': verbose  = true;                break;
+         default:  printf("%s", usage); exit(1);
+      }
+   }
+   const char *tracen = Spec.getarg();
+   if ( ! cfgn || ! tracen || nThreads < 1 || interval < 1) { printf("%s", usage); exit(1); }
+
+   // The origin.
+   std::string url;
+   long long   latency = 0, bw = 0;
+   if ( ! strncmp(orig, "sim", 3))
+   {
+      const char *p = strchr(orig, ':');
+      if (p)
+      {
+         latency = (long long) (atof(p + 1) * 1000);
+         if ((p = strchr(p + 1, ':'))) bw = (long long) (atof(p + 1) * 1024 * 1024);
+      }
+   }
+   else if ( ! strncmp(orig, "root://", 7))
+   {
+      url = orig;
+   }
+   else { printf("%s", usage); exit(1); }
+
+   std::vector<Event> evs;
+   if ( ! ParseTrace(tracen, evs)) exit(1);
+
+   // The cache, with its messages going to the log file. Configuration files
+   // are only processed for a named instance, as set up by xrootd.
+   if ( ! getenv("XRDINSTANCE")) putenv((char *) "XRDINSTANCE=xrdpfc_replay anon@localhost");
+   if (logn) log.Bind(logn, 0);
+   if ( ! XrdOucGetCache2(&log, cfgn, 0))
+   {
+      fprintf(stderr, "xrdpfc_replay: unable to configure the cache from %s\n", cfgn);
+      exit(1);
+   }
+
+   Origin    origin(url, latency, bw, 32);
+   Reaper    reaper;
+   OpenFiles files(origin, reaper);
+
+   // Requests on one file are replayed in order by the same thread.
+   std::vector<Worker> workers(nThreads);
+   for (size_t i = 0; i < evs.size(); ++i)
+      workers[(unsigned long long) evs[i].fid % nThreads].evs.push_back(evs[i]);
+
+   Sampler sampler;
+   sampler.interval = interval;
+   sampler.verbose  = verbose;
+   sampler.Sample(usecNow());
+   pthread_t stid;
+   XrdSysThread::Run(&stid, RunSampler, &sampler, XRDSYSTHREAD_HOLD, "xrdpfc_replay sampler");
+
+   long long start = usecNow();
+   std::vector<pthread_t> tids(nThreads);
+   for (int i = 0; i < nThreads; ++i)
+   {
+      workers[i].files  = &files;
+      workers[i].start  = start;
+      workers[i].speed  = speed;
+      workers[i].verify = url.empty();
+      XrdSysThread::Run(&tids[i], RunWorker, &workers[i], XRDSYSTHREAD_HOLD, "xrdpfc_replay client");
+   }
+   Results res;
+   for (int i = 0; i < nThreads; ++i)
+   {
+      XrdSysThread::Join(tids[i], 0);
+      res.Add(workers[i].res);
+   }
+   long long elapsed = usecNow() - start;
+   reaper.Drain();
+
+   sampler.stop = true;
+   XrdSysThread::Join(stid, 0);
+   sampler.Sample(start);
+
+   // Report
+   int nSlots, nUsed, nPeak; long long nHeap;
+   Cache::GetInstance().GetBlockPoolStats(nSlots, nUsed, nPeak, nHeap);
+
+   printf("replayed %zu events in %.1f s\n", evs.size(), elapsed / 1e6);
+   printf("client   %lld requests, %lld bytes, request hit rate %.1f%%\n",
+          res.nReq, res.bytes, res.nReq ? 100.0 * res.nHit / res.nReq : 0.0);
+   printf("origin   %lld requests, %lld bytes, %.2f of client bytes\n",
+          origin.GetReqs(), origin.GetBytes(), res.bytes ? (double) origin.GetBytes() / res.bytes : 0.0);
+   printf("latency  %-6s %8s %8s %8s %8s %8s (usec)\n", "", "count", "p50", "p90", "p99", "max");
+   for (int i = 0; i < kNOps; ++i)
+   {
+      std::vector<long long> &v = res.lat[i];
+      if (v.empty()) continue;
+      std::sort(v.begin(), v.end());
+      printf("         %-6s %8zu %8lld %8lld %8lld %8lld\n", opName[i], v.size(),
+             Percentile(v, 0.5), Percentile(v, 0.9), Percentile(v, 0.99), v.back());
+   }
+   printf("ram      %d pool slots, peak used %d (sampled %d), %lld heap buffers\n",
+          nSlots, nPeak, sampler.peakUsed, nHeap);
+   printf("disk     used %lld MB at start, %lld MB at end, %lld MB max, %lld purges freed %lld MB\n",
+          sampler.diskFirst >> 20, sampler.diskLast >> 20, sampler.diskMax >> 20,
+          sampler.purges, sampler.purged >> 20);
+   printf("errors   %lld failed requests, %lld bytes not matching the origin\n", res.errors, res.badBytes);
+
+   // The cache and its threads are never torn down, do not run the static
+   // destructors under them.
+   fflush(stdout);
+   _exit((res.errors || res.badBytes) ? 1 : 0);
+}
@@ -0,0 +1,219 @@
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <errno.h>
+#include <stdio.h>
+
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClFileSystem.hh"
+#include "XrdCl/XrdClURL.hh"
+#include "XrdCl/XrdClXRootDResponses.hh"
+
+#include "XrdFileCache.hh"
+#include "XrdFileCacheFile.hh"
+#include "XrdFileCacheSources.hh"
+#include "XrdFileCacheTrace.hh"
+
+using namespace XrdFileCache;
+
+const char *SourceSet::m_traceID = "SourceSet";
+
+namespace
+{
+//------------------------------------------------------------------------------
+//! Passes the result of a block read on an extra source to its File. A short
+//! read is reported as an error so that the block is refetched.
+//------------------------------------------------------------------------------
+class SourceResponseHandler : public XrdCl::ResponseHandler
+{
+public:
+   SourceResponseHandler(Block *b) : m_block(b) {}
+
+   virtual void HandleResponse(XrdCl::XRootDStatus *status, XrdCl::AnyObject *response)
+   {
+      int res = -EIO;
+      if (status->IsOK() && response)
+      {
+         XrdCl::ChunkInfo *chunk = 0;
+         response->Get(chunk);
+         if (chunk && (int) chunk->length == m_block->get_size()) res = chunk->length;
+      }
+      delete status;
+      delete response;
+
+      m_block->m_file->ProcessBlockResponse(m_block, res);
+      delete this;
+   }
+
+private:
+   Block *m_block;
+};
+}
+
+//------------------------------------------------------------------------------
+
+SourceSet::SourceSet()
+{
+   m_sources.push_back(Source(0, "origin"));
+}
+
+SourceSet::~SourceSet()
+{
+   for (std::vector<Source>::iterator i = m_sources.begin(); i != m_sources.end(); ++i)
+   {
+      if (i->m_file)
+      {
+         XrdCl::XRootDStatus st = i->m_file->Close();
+         delete i->m_file;
+      }
+   }
+}
+
+//------------------------------------------------------------------------------
+
+int SourceSet::Open(const std::string &url, int n, long long fileSize)
+{
+   XrdCl::URL origin(url);
+   if ( ! origin.IsValid()) return 0;
+
+   // Replicas, in the order the redirector returns them.
+   std::vector<std::string> hosts;
+   {
+      XrdCl::FileSystem      fs(origin);
+      XrdCl::LocationInfo   *locs = 0;
+      XrdCl::XRootDStatus    st   = fs.DeepLocate(origin.GetPathWithParams(), XrdCl::OpenFlags::None, locs);
+      if (st.IsOK() && locs)
+      {
+         for (XrdCl::LocationInfo::Iterator i = locs->Begin(); i != locs->End(); ++i)
+         {
+            bool seen = false;
+            for (size_t j = 0; j < hosts.size(); ++j) seen |= (hosts[j] == i->GetAddress());
+            if ( ! seen) hosts.push_back(i->GetAddress());
+         }
+      }
+      else
+      {
+         std::string err = st.ToString();
+         TRACE(Debug, "SourceSet::Open() locate failed for " << origin.GetPath() << ", " << err);
+      }
+      delete locs;
+   }
+   if (hosts.empty())
+   {
+      char port[16]; snprintf(port, sizeof(port), ":%d", origin.GetPort());
+      hosts.push_back(origin.GetHostName() + port);
+   }
+
+   for (int i = 0; i < n; ++i)
+   {
+      // XrdCl shares a connection among files with the same login and host,
+      // a distinct login name gives each extra source its own.
+      XrdCl::URL hp("root://" + hosts[i % hosts.size()]);
+      if ( ! hp.IsValid()) continue;
+      char login[16]; snprintf(login, sizeof(login), "pfc%d", i);
+      XrdCl::URL src(origin);
+      src.SetHostPort(hp.GetHostName(), hp.GetPort());
+      src.SetUserName(login);
+      std::string hostId = src.GetHostId();
+
+      XrdCl::File *f = new XrdCl::File(false);
+      XrdCl::XRootDStatus st = f->Open(src.GetURL(), XrdCl::OpenFlags::Read);
+      XrdCl::StatInfo *sinfo = 0;
+      if (st.IsOK()) st = f->Stat(false, sinfo);
+      if ( ! st.IsOK() || ! sinfo || (long long) sinfo->GetSize() != fileSize)
+      {
+         std::string err = st.IsOK() ? "size differs" : st.ToString();
+         TRACE(Info, "SourceSet::Open() not using " << hostId << " for " << origin.GetPath() << ", " << err);
+         if (f->IsOpen()) st = f->Close();
+         delete f;
+         delete sinfo;
+         continue;
+      }
+      delete sinfo;
+
+      TRACE(Debug, "SourceSet::Open() using " << hostId << " for " << origin.GetPath());
+      m_sources.push_back(Source(f, hostId));
+   }
+
+   return (int) m_sources.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+
+int SourceSet::Pick(int size)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+
+   // A source without a measurement gets one request to probe it, then the
+   // one expected to complete the request first is taken.
+   int    best  = 0;
+   double bestT = -1;
+   for (int i = 0; i < (int) m_sources.size(); ++i)
+   {
+      Source &s = m_sources[i];
+      if (s.m_failed) continue;
+      if (s.m_rate <= 0)
+      {
+         if (s.m_inflight == 0) { best = i; break; }
+         continue;
+      }
+      double t = (s.m_inflight + 1) * (double) size / s.m_rate;
+      if (bestT < 0 || t < bestT) { best = i; bestT = t; }
+   }
+
+   ++m_sources[best].m_inflight;
+   return best;
+}
+
+//------------------------------------------------------------------------------
+
+void SourceSet::Read(int idx, Block *b)
+{
+   SourceResponseHandler *handler = new SourceResponseHandler(b);
+   XrdCl::XRootDStatus st = m_sources[idx].m_file->Read(b->get_offset(), b->get_size(), b->get_buff(), handler);
+   if ( ! st.IsOK())
+   {
+      handler->HandleResponse(new XrdCl::XRootDStatus(st), 0);
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void SourceSet::Done(int idx, int size, long long usec, bool ok)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+
+   Source &s = m_sources[idx];
+
+   // Requests in flight on the same source share its bandwidth.
+   if (ok && usec > 0)
+   {
+      double rate = (double) size * s.m_inflight / (usec / 1e6);
+      s.m_rate = s.m_rate > 0 ? 0.8 * s.m_rate + 0.2 * rate : rate;
+   }
+   else if ( ! ok && idx > 0 && ! s.m_failed)
+   {
+      s.m_failed = true;
+      TRACE(Warning, "SourceSet::Done() read from " << s.m_host << " failed, not using it any more");
+   }
+   --s.m_inflight;
+}
+
+//------------------------------------------------------------------------------
+
+XrdSysTrace* SourceSet::GetTrace()
+{
+   return Cache::GetInstance().GetTrace();
+}
@@ -0,0 +1,99 @@
+#ifndef __XRDFILECACHE_SOURCES_HH__
+#define __XRDFILECACHE_SOURCES_HH__
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+class XrdSysTrace;
+
+namespace XrdCl
+{
+class File;
+}
+
+namespace XrdFileCache
+{
+class Block;
+
+//----------------------------------------------------------------------------
+//! Extra origin connections of a File, used to fetch blocks of a large file
+//! in parallel. Source 0 is the File's own IO, the others are XrdCl files
+//! opened on the replicas found by a deep locate of the origin URL, or on
+//! additional connections to the origin when there are fewer replicas than
+//! sources. Block requests go to the source expected to finish them first,
+//! given its observed throughput and the requests it already has in flight.
+//----------------------------------------------------------------------------
+class SourceSet
+{
+public:
+   SourceSet();
+   ~SourceSet();
+
+   //---------------------------------------------------------------------
+   //! Locate replicas of url and open up to n extra sources on them.
+   //! Replicas not reporting fileSize are not used. Blocking, called from
+   //! a scheduler job before the set is published.
+   //!
+   //! @return number of extra sources opened
+   //---------------------------------------------------------------------
+   int  Open(const std::string &url, int n, long long fileSize);
+
+   //---------------------------------------------------------------------
+   //! Select the source for a block request of given size and account it
+   //! as in flight.
+   //---------------------------------------------------------------------
+   int  Pick(int size);
+
+   //---------------------------------------------------------------------
+   //! Issue the read of block b on extra source idx, the response is passed
+   //! to File::ProcessBlockResponse(). Not to be called for source 0.
+   //---------------------------------------------------------------------
+   void Read(int idx, Block *b);
+
+   //---------------------------------------------------------------------
+   //! Account a finished request, usec is the time since it was issued.
+   //! A failed extra source is not used any more.
+   //---------------------------------------------------------------------
+   void Done(int idx, int size, long long usec, bool ok);
+
+   int  GetNSources() const { return (int) m_sources.size(); }
+
+   XrdSysTrace* GetTrace();
+
+private:
+   struct Source
+   {
+      XrdCl::File *m_file;            //!< 0 for the File's IO
+      std::string  m_host;            //!< for tracing
+      double       m_rate;            //!< smoothed throughput in bytes/s, 0 if not measured yet
+      int          m_inflight;        //!< requests in flight
+      bool         m_failed;
+
+      Source(XrdCl::File *f, const std::string &h) :
+         m_file(f), m_host(h), m_rate(0), m_inflight(0), m_failed(false) {}
+   };
+
+   std::vector<Source> m_sources;
+   XrdSysMutex         m_mutex;
+
+   static const char  *m_traceID;
+};
+}
+
+#endif
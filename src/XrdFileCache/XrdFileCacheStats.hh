@@ -35,11 +35,13 @@ public:
    //----------------------------------------------------------------------
    Stats() {
       m_BytesDisk = m_BytesRam = m_BytesMissed = 0;
+      m_ReqsJoined = 0;
    }
 
    long long m_BytesDisk;         //!< number of bytes served from disk cache
    long long m_BytesRam;          //!< number of bytes served from RAM cache
    long long m_BytesMissed;       //!< number of bytes served directly from XrdCl
+   long long m_ReqsJoined;        //!< number of block requests that joined a fetch in progress
 
    inline void AddStats(Stats &Src)
    {
@@ -48,6 +50,7 @@ public:
       m_BytesDisk   += Src.m_BytesDisk;
       m_BytesRam    += Src.m_BytesRam;
       m_BytesMissed += Src.m_BytesMissed;
+      m_ReqsJoined  += Src.m_ReqsJoined;
 
       m_MutexXfc.UnLock();
    }
@@ -77,7 +77,7 @@ using namespace XrdFileCache;
 
 //------------------------------------------------------------------------------
 
-int File::ReadV(const XrdOucIOVec *readV, int n)
+int File::ReadV(const XrdOucIOVec *readV, int n, Stats *ioStats)
 {
    if ( ! isOpen())
    {
@@ -96,15 +96,49 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
 
    int bytesRead = 0;
 
+   // Cache hit on chunks that are all on disk, served without the download
+   // lock as in File::Read().
+   int i;
+   for (i = 0; i < n; i++)
+      if ( ! IsOnDisk(readV[i].offset, readV[i].size)) break;
+
+   if (i == n)
+   {
+      if (m_prefetchState == kOn || m_prefetchState == kHold)
+      {
+         XrdSysCondVarHelper _lck(m_downloadCond);
+         VReadRecordAccess(readV, n);
+      }
+
+      for (i = 0; i < n; i++)
+      {
+         int rs = m_output->Read(readV[i].data, readV[i].offset - m_diskOffset, readV[i].size);
+         if (rs != readV[i].size)
+         {
+            TRACEF(Error, "ReadV failed read from disk rc = " << rs);
+            return -1;
+         }
+         bytesRead += rs;
+      }
+      loc_stats.m_BytesDisk = bytesRead;
+      m_stats.AddStats(loc_stats);
+      if (ioStats) ioStats->AddStats(loc_stats);
+      TRACEF(Dump, "VRead exit, all on disk, total = " << bytesRead);
+      return bytesRead;
+   }
+
    ReadVBlockListRAM              blocks_to_process;
    std::vector<ReadVChunkListRAM> blks_processed;
    ReadVBlockListDisk             blocks_on_disk;
    std::vector<XrdOucIOVec>       chunkVec;
    DirectResponseHandler         *direct_handler = 0;
+   DirectFetchList_t              direct_fetches;
+   DirectJoinList_t               direct_joins;
 
    // TODO The following call never fails (other than with out of mem exception).
    // This should be implemented in PrepareBlockRequest().
-   if ( ! VReadPreProcess(readV, n, blocks_to_process, blocks_on_disk, chunkVec))
+   if ( ! VReadPreProcess(readV, n, blocks_to_process, blocks_on_disk, chunkVec,
+                          direct_fetches, direct_joins, loc_stats))
    {
       bytesRead = -1;
       errno = ENOMEM;
@@ -152,7 +186,8 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
    }
 
    // check direct requests have arrived, get bytes read from read handle
-   if (bytesRead >= 0 && direct_handler != 0)
+   // and pass the data to the readers that joined them
+   if (direct_handler != 0)
    {
       XrdSysCondVarHelper _lck(direct_handler->m_cond);
 
@@ -161,6 +196,11 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
          direct_handler->m_cond.Wait();
       }
 
+      FinishDirectFetches(direct_fetches, direct_handler->m_errno);
+   }
+
+   if (bytesRead >= 0 && direct_handler != 0)
+   {
       if (direct_handler->m_errno == 0)
       {
          for (std::vector<XrdOucIOVec>::iterator i = chunkVec.begin(); i != chunkVec.end(); ++i)
@@ -176,6 +216,25 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
       }
    }
 
+   // wait for the direct requests of others we joined
+   if ( ! direct_joins.empty())
+   {
+      int rc = WaitDirectJoins(direct_joins);
+      if (bytesRead >= 0)
+      {
+         if (rc >= 0)
+         {
+            bytesRead += rc;
+            loc_stats.m_BytesMissed += rc;
+         }
+         else
+         {
+            errno = -rc;
+            bytesRead = -1;
+         }
+      }
+   }
+
    {
       XrdSysCondVarHelper _lck(m_downloadCond);
 
@@ -196,6 +255,7 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
       delete i->arr;
 
    m_stats.AddStats(loc_stats);
+   if (ioStats) ioStats->AddStats(loc_stats);
 
    TRACEF(Dump, "VRead exit, total = " << bytesRead);
    return bytesRead;
@@ -221,12 +281,19 @@ bool File::VReadValidate(const XrdOucIOVec *vr, int n)
 bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
                            ReadVBlockListRAM        &blocks_to_process,
                            ReadVBlockListDisk       &blocks_on_disk,
-                           std::vector<XrdOucIOVec> &chunkVec)
+                           std::vector<XrdOucIOVec> &chunkVec,
+                           DirectFetchList_t        &direct_fetches,
+                           DirectJoinList_t         &direct_joins,
+                           Stats                    &loc_stats)
 {
+   DirectJoin *dj;
+
    BlockList_t blks_to_request;
 
    m_downloadCond.Lock();
 
+   VReadRecordAccess(readV, n);
+
    for (int iov_idx = 0; iov_idx < n; iov_idx++)
    {
       const int blck_idx_first =  readV[iov_idx].offset / m_cfi.GetBufferSize();
@@ -236,11 +303,14 @@ bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
       {
          TRACEF(Dump, "VReadPreProcess chunk "<<  readV[iov_idx].size << "@"<< readV[iov_idx].offset);
 
-         BlockMap_i bi = m_block_map.find(block_idx);
-         if (bi != m_block_map.end())
+         Block *bp = m_block_index.Find(offsetIdx(block_idx));
+         if (bp)
          {
-            if (blocks_to_process.AddEntry(bi->second, iov_idx))
-               inc_ref_count(bi->second);
+            if (blocks_to_process.AddEntry(bp, iov_idx))
+            {
+               if ( ! bp->is_finished()) ++loc_stats.m_ReqsJoined;
+               inc_ref_count(bp);
+            }
 
             TRACEF(Dump, "VReadPreProcess block "<< block_idx <<" in map");
          }
@@ -250,13 +320,25 @@ bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
 
             TRACEF(Dump, "VReadPreProcess block "<< block_idx <<" , chunk idx = " << iov_idx << " on disk");
          }
+         else if ((dj = JoinDirectFetch(block_idx, readV[iov_idx].data, readV[iov_idx].offset, readV[iov_idx].size)))
+         {
+            ++loc_stats.m_ReqsJoined;
+            direct_joins.push_back(dj);
+
+            TRACEF(Dump, "VReadPreProcess join direct fetch " << block_idx);
+         }
          else
          {
             if (Cache::GetInstance().RequestRAMBlock())
             {
                Block *b = PrepareBlockRequest(block_idx, false);
                // TODO this can not fail (other than out of memory which we don't handle).
-               if (! b) return false;
+               if (! b)
+               {
+                  CancelDirect(direct_fetches, direct_joins);
+                  m_downloadCond.UnLock();
+                  return false;
+               }
                inc_ref_count(b);
                blocks_to_process.AddEntry(b, iov_idx);
                blks_to_request.push_back(b);
@@ -271,6 +353,7 @@ bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
                const long long BS = m_cfi.GetBufferSize();
                overlap(block_idx, BS, readV[iov_idx].offset, readV[iov_idx].size, off, blk_off, size);
                chunkVec.push_back(XrdOucIOVec2(readV[iov_idx].data+off, BS*block_idx + blk_off,size));
+               direct_fetches.push_back(AddDirectFetch(block_idx, readV[iov_idx].data, readV[iov_idx].offset, readV[iov_idx].size));
 
                TRACEF(Dump, "VReadPreProcess direct read " << block_idx);
             }
@@ -287,6 +370,31 @@ bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
 
 //------------------------------------------------------------------------------
 
+void File::VReadRecordAccess(const XrdOucIOVec *readV, int n)
+{
+   // Must be called w/ block_map locked.
+   // A vector read is handed to the access pattern detector as one request
+   // spanning its lowest to highest block.
+
+   const long long BS = m_cfi.GetBufferSize();
+   int first = -1, last = -1, nblks = 0, prev = -1;
+
+   for (int iov_idx = 0; iov_idx < n; iov_idx++)
+   {
+      const int bf =  readV[iov_idx].offset / BS;
+      const int bl = (readV[iov_idx].offset + readV[iov_idx].size - 1) / BS;
+
+      if (first < 0 || bf < first) first = bf;
+      if (bl > last) last = bl;
+      nblks += bl - bf + 1 - (bf == prev ? 1 : 0);
+      prev = bl;
+   }
+
+   if (first >= 0) RecordAccess(first, last, nblks);
+}
+
+//------------------------------------------------------------------------------
+
 int File::VReadFromDisk(const XrdOucIOVec *readV, int n, ReadVBlockListDisk& blocks_on_disk)
 {
    int bytes_read = 0;
@@ -305,9 +413,13 @@ int File::VReadFromDisk(const XrdOucIOVec *readV, int n, ReadVBlockListDisk& blo
 
          overlap(blockIdx, m_cfi.GetBufferSize(), readV[chunkIdx].offset, readV[chunkIdx].size, off, blk_off, size);
 
-         int rs = m_output->Read(readV[chunkIdx].data + off,  blockIdx*m_cfi.GetBufferSize() + blk_off - m_offset, size);
+         int rs = m_output->Read(readV[chunkIdx].data + off,  blockIdx*m_cfi.GetBufferSize() + blk_off - m_diskOffset, size);
          if (rs >= 0)
          {
+            if (rs == size && ! verify_blocks(readV[chunkIdx].data + off, blockIdx*m_cfi.GetBufferSize() + blk_off, size))
+            {
+               return -EIO;
+            }
             bytes_read += rs;
          }
          else
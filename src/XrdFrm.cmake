@@ -10,12 +10,14 @@ add_library(
   XrdFrm/XrdFrmConfig.cc        XrdFrm/XrdFrmConfig.hh
   XrdFrm/XrdFrmFiles.cc         XrdFrm/XrdFrmFiles.hh
   XrdFrm/XrdFrmMonitor.cc       XrdFrm/XrdFrmMonitor.hh
+  XrdFrm/XrdFrmScan.cc          XrdFrm/XrdFrmScan.hh
   XrdFrm/XrdFrmTSort.cc         XrdFrm/XrdFrmTSort.hh
   XrdFrm/XrdFrmCns.cc           XrdFrm/XrdFrmCns.hh
 
   XrdFrm/XrdFrmMigrate.cc       XrdFrm/XrdFrmMigrate.hh
   XrdFrm/XrdFrmReqBoss.cc       XrdFrm/XrdFrmReqBoss.hh
   XrdFrm/XrdFrmTransfer.cc      XrdFrm/XrdFrmTransfer.hh
+  XrdFrm/XrdFrmXfrCopy.cc       XrdFrm/XrdFrmXfrCopy.hh
   XrdFrm/XrdFrmXfrAgent.cc      XrdFrm/XrdFrmXfrAgent.hh
   XrdFrm/XrdFrmXfrDaemon.cc     XrdFrm/XrdFrmXfrDaemon.hh
                                 XrdFrm/XrdFrmXfrJob.hh
@@ -74,6 +76,7 @@ add_executable(
 target_link_libraries(
   frm_xfrd
   XrdFrm
+  XrdCl
   XrdServer
   XrdUtils
   pthread
@@ -90,6 +93,7 @@ add_executable(
 target_link_libraries(
   frm_xfragent
   XrdFrm
+  XrdCl
   XrdServer
   XrdUtils
   pthread
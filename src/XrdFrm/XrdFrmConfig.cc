@@ -150,11 +150,14 @@ XrdFrmConfig::XrdFrmConfig(SubSys ss, const char *vopts, const char *uinfo)
    QPath    = 0;
    AdminMode= 0740;
    xfrMax   = 2;
+   xfrFSMax = 0;
+   xfrWindow= 2;
    FailHold = 3*60*60;
    IdleHold = 10*60;
    WaitMigr = 60*60;
    WaitPurge= 600;
    WaitQChk = 300;
+   ScanThreads = 1;
    MSSCmd   = 0;
    memset(&xfrCmd, 0, sizeof(xfrCmd));
    xfrCmd[0].Desc = "copycmd in";     xfrCmd[1].Desc = "copycmd out";
@@ -1046,11 +1049,13 @@ int XrdFrmConfig::ConfigXeq(char *var, int mbok)
 
        if (!strcmp(var, "copycmd"       )) return xcopy();
        if (!strcmp(var, "copymax"       )) return xcmax();
+       if (!strcmp(var, "schedule"      )) return xsched();
        if (!strcmp(var, "oss.space"     )) return xspace();
 
        if (!strncmp(var, "migr.", 5))   // xfr.migr
       {char *vas = var+5;
        if (!strcmp(vas, "idlehold"      )) return xitm("idle time", IdleHold);
+       if (!strcmp(vas, "scanthreads"   )) return xsthr();
        if (!strcmp(vas, "waittime"      )) return xitm("migr wait", WaitMigr);
       }
       }
@@ -1066,6 +1071,7 @@ int XrdFrmConfig::ConfigXeq(char *var, int mbok)
        if (!strcmp(var, "policy"        )) return xpol();
        if (!strcmp(var, "polprog"       )) return xpolprog();
        if (!strcmp(var, "oss.space"     )) return xspace(1);
+       if (!strcmp(var, "scanthreads"   )) return xsthr();
        if (!strcmp(var, "waittime"      )) return xitm("purge wait",WaitPurge);
        if (!strcmp(var, "frm.all.monitor"))return xmon();
       }
@@ -1100,7 +1106,7 @@ int XrdFrmConfig::ConfigXfr()
            {if ((xfrCmd[i].theVec=ConfigCmd(xfrCmd[i].Desc, xfrCmd[i].theCmd)))
                ioOK[i%2]  = 1;
                else isBad = 1;
-           }
+           } else if (xfrCmd[i].Opts & cmdXrdCl) ioOK[i%2] = 1;
        }
 
 // Verify that we can actually do something
@@ -1398,9 +1404,10 @@ int XrdFrmConfig::xcnsd()
 
 /* Function: copycmd
 
-   Purpose:  To parse the directive: copycmd [Options] cmd [args]
+   Purpose:  To parse the directive: copycmd [Options] [cmd [args]]
 
    Options:  [in] [noalloc] [out] [rmerr] [stats] [timeout <sec>] [url] [xpd]
+             [xrdcl]
 
              in        use command for incomming copies.
              noalloc   do not pre-allocate space for incomming copies.
@@ -1411,12 +1418,15 @@ int XrdFrmConfig::xcnsd()
              timeout   how long the cmd can run before it is killed.
              url       use command for url-based transfers.
              xpd       extend monitoring with program data.
+             xrdcl     copy the file in-process using the XrdCl copy engine.
+                       The cmd is optional and, if specified, is only used
+                       should the in-process copy fail.
 
    Output: 0 upon success or !0 upon failure.
 */
 int XrdFrmConfig::xcopy()
 {  int cmdIO[2] = {0,0}, TLim=0, Stats=0, hasMDP=0, cmdUrl=0, noAlo=0, rmErr=0;
-   int monPD = 0;
+   int monPD = 0, useCl = 0;
    char *val, *theCmd = 0;
    struct copyopts {const char *opname; int *oploc;} cpopts[] =
          {
@@ -1427,7 +1437,8 @@ int XrdFrmConfig::xcopy()
           {"stats",  &Stats},
           {"timeout",&TLim},
           {"url",    &cmdUrl},
-          {"xpd",    &monPD}
+          {"xpd",    &monPD},
+          {"xrdcl",  &useCl}
          };
    int i, n, numopts = sizeof(cpopts)/sizeof(struct copyopts);
 
@@ -1449,13 +1460,13 @@ int XrdFrmConfig::xcopy()
 // Pick up the program
 //
    if (!val || !*val)
-      {Say.Emsg("Config", "copy command not specified"); return 1;}
-   if (Grab(val, &theCmd, -1)) return 1;
+      {if (!useCl) {Say.Emsg("Config", "copy command not specified"); return 1;}
+      } else if (Grab(val, &theCmd, -1)) return 1;
 
 // Find if $MDP is present here
 //
    if (!cmdIO[0] && !cmdIO[1]) cmdIO[0] = cmdIO[1] = 1;
-   if (cmdIO[1]) hasMDP = (strstr(theCmd, "$MDP") != 0);
+   if (cmdIO[1] && theCmd) hasMDP = (strstr(theCmd, "$MDP") != 0);
 
 // Initialzie the appropriate command structures
 //
@@ -1463,7 +1474,9 @@ int XrdFrmConfig::xcopy()
    i = 1;
    do {if (cmdIO[i])
           {if (xfrCmd[n].theCmd) free(xfrCmd[n].theCmd);
-           xfrCmd[n].theCmd = strdup(theCmd);
+           xfrCmd[n].theCmd = (theCmd ? strdup(theCmd) : 0);
+           if (useCl)  xfrCmd[n].Opts  |= cmdXrdCl;
+              else     xfrCmd[n].Opts  &=~cmdXrdCl;
            if (Stats)  xfrCmd[n].Opts  |= cmdStats;
            if (monPD)  xfrCmd[n].Opts  |= cmdXPD;
            if (hasMDP) xfrCmd[n].Opts  |= cmdMDP;
@@ -1477,7 +1490,7 @@ int XrdFrmConfig::xcopy()
 
 // All done
 //
-   free(theCmd);
+   if (theCmd) free(theCmd);
    return 0;
 }
 
@@ -1943,6 +1956,80 @@ int XrdFrmConfig::xqchk()
    return 0;
 }
 
+/******************************************************************************/
+/* Private:                        x s t h r                                  */
+/******************************************************************************/
+
+/* Function: xsthr
+
+   Purpose:  To parse the directive: scanthreads <num>
+
+             <num>     number of threads used to scan the name space. Each
+                       top level directory is scanned as an independent job
+                       when <num> is greater than one (the default is 1).
+
+   Output: 0 upon success or !0 upon failure.
+*/
+int XrdFrmConfig::xsthr()
+{   int nthr;
+    char *val;
+
+    if (!(val = cFile->GetWord()))
+       {Say.Emsg("Config", "scanthreads value not specified"); return 1;}
+    if (XrdOuca2x::a2i(Say, "scanthreads", val, &nthr, 1, scanMax)) return 1;
+    ScanThreads = nthr;
+    return 0;
+}
+
+/******************************************************************************/
+/* Private:                       x s c h e d                                 */
+/******************************************************************************/
+
+/* Function: xsched
+
+   Purpose:  To parse the directive: schedule [fsmax <n>] [window <n>]
+
+             fsmax     maximum number of concurrent inbound transfers into any
+                       one file system. The default, 0, imposes no limit.
+             window    number of queued requests per transfer agent that are
+                       considered when selecting the next transfer (def 2).
+                       Larger windows allow better ordering of requests
+                       carrying a tape volume hint (frm.vol and frm.pos cgi).
+
+   Output: 0 upon success or !0 upon failure.
+*/
+int XrdFrmConfig::xsched()
+{   int num;
+    char *val;
+
+    if (!(val = cFile->GetWord()))
+       {Say.Emsg("Config", "schedule parameters not specified"); return 1;}
+
+    while(val)
+         {     if (!strcmp(val, "fsmax"))
+                  {if (!(val = cFile->GetWord()))
+                      {Say.Emsg("Config","schedule fsmax value not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2i(Say,"schedule fsmax",val,&num,0))
+                      return 1;
+                   xfrFSMax = num;
+                  }
+          else if (!strcmp(val, "window"))
+                  {if (!(val = cFile->GetWord()))
+                      {Say.Emsg("Config","schedule window value not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2i(Say,"schedule window",val,&num,1,1024))
+                      return 1;
+                   xfrWindow = num;
+                  }
+          else {Say.Emsg("Config", "invalid schedule option -", val); return 1;}
+          val = cFile->GetWord();
+         }
+    return 0;
+}
+
 /******************************************************************************/
 /*                                  x s i t                                   */
 /******************************************************************************/
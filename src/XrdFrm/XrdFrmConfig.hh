@@ -81,6 +81,7 @@ static const int    cmdMDP   = 0x0002;
 static const int    cmdStats = 0x0004;
 static const int    cmdXPD   = 0x0008;
 static const int    cmdRME   = 0x0010;
+static const int    cmdXrdCl = 0x0020;
 
 int                 xfrIN;
 int                 xfrOUT;
@@ -97,11 +98,15 @@ int                 cmdHold;
 int                 AdminMode;
 int                 isAgent;
 int                 xfrMax;
+int                 xfrFSMax;    // Max inbound transfers per file system
+int                 xfrWindow;   // Queue slots per transfer agent
 int                 FailHold;
 int                 IdleHold;
 int                 WaitQChk;
 int                 WaitPurge;
 int                 WaitMigr;
+int                 ScanThreads;
+static const int    scanMax = 64;
 int                 haveCMS;
 int                 isOTO;
 int                 Fix;
@@ -206,7 +211,9 @@ int          xmon();
 int          xpol();
 int          xpolprog();
 int          xqchk();
+int          xsched();
 int          xsit();
+int          xsthr();
 int          xspace(int isPrg=0, int isXA=1);
 void         xspaceBuild(char *grp, char *fn, int isxa);
 int          xxfr();
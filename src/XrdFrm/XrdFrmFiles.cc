@@ -54,6 +54,7 @@ using namespace XrdFrm;
 /******************************************************************************/
 
 XrdOucHash<char>  XrdFrmFileset::BadFiles;
+XrdSysMutex       XrdFrmFileset::BadMutex;
   
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
@@ -195,8 +196,10 @@ int XrdFrmFileset::Screen(int needLF)
 
 // Issue message if we haven't issued one before
 //
+   BadMutex.Lock();
    if (!BadFiles.Add(badFN, 0, 0, Hash_data_is_key))
       Say.Emsg("Screen", What, badFN);
+   BadMutex.UnLock();
    return 0;
 }
 
@@ -379,10 +382,15 @@ void XrdFrmFiles::Complain(const char *dPath)
 {
    static const int OneDay = 24*60*60;
    static XrdOucHash<char> dTab;
+   static XrdSysMutex      dMutex;
+   int isOld;
 
 // We want to complain about old=style directories only once every 24 hours
 //
-   if (dTab.Add(dPath, 0, OneDay, Hash_data_is_key)) return;
+   dMutex.Lock();
+   isOld = (dTab.Add(dPath, 0, OneDay, Hash_data_is_key) != 0);
+   dMutex.UnLock();
+   if (isOld) return;
 
 // Complain about this directory
 //
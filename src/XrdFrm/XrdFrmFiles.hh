@@ -38,6 +38,7 @@
 #include "XrdOuc/XrdOucHash.hh"
 #include "XrdOuc/XrdOucNSWalk.hh"
 #include "XrdOuc/XrdOucXAttr.hh"
+#include "XrdSys/XrdSysPthread.hh"
 
 class  XrdOucTList;
 
@@ -74,7 +75,9 @@ const  char                * xyzPath(XrdOssPath::theSfx sfx)
 
 int                         dirPath(char *dBuff, int dBlen);
 
-static void                 Purge() {BadFiles.Purge();}
+static void                 Purge() {XrdSysMutexHelper mHelp(BadMutex);
+                                     BadFiles.Purge();
+                                    }
 
 int                         Refresh(int isMig=0, int doLock=1);
 
@@ -103,6 +106,7 @@ XrdOucNSWalk::NSEnt *File[XrdOssPath::sfxNum];
 XrdOucTList         *dInfo;     // Shared directory information
 
 static XrdOucHash<char> BadFiles;
+static XrdSysMutex      BadMutex;
 
 static const int     dLen = 0;  // Index to directory path length in dInfo
 static const int     dRef = 1;  // Index to the reference counter in dInfo
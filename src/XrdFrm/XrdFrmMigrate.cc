@@ -44,6 +44,7 @@
 #include "XrdFrm/XrdFrmFiles.hh"
 #include "XrdFrm/XrdFrmConfig.hh"
 #include "XrdFrm/XrdFrmMigrate.hh"
+#include "XrdFrm/XrdFrmScan.hh"
 #include "XrdFrm/XrdFrmTransfer.hh"
 #include "XrdFrm/XrdFrmXfrQueue.hh"
 #include "XrdSys/XrdSysPthread.hh"
@@ -262,15 +263,11 @@ void XrdFrmMigrate::Queue(XrdFrmFileset *sP)
   
 void XrdFrmMigrate::Scan()
 {
-   static const int Opts = XrdFrmFiles::Recursive | XrdFrmFiles::CompressD
-                         | XrdFrmFiles::NoAutoDel;
    static time_t lastHP = time(0), nowT = time(0);
 
-   XrdFrmConfig::VPInfo *vP = Config.pathList;
-   XrdFrmFileset *sP;
-   XrdFrmFiles   *fP;
+   XrdFrmScan nsScan(Add, 0);
    char buff[128];
-   int ec = 0, Bad = 0, aFiles = 0, bFiles = 0;
+   int Bad, aFiles, bFiles;
 
 // Purge that bad file table evey 24 hours to keep complaints down
 //
@@ -282,15 +279,8 @@ void XrdFrmMigrate::Scan()
 
 // Process each directory
 //
-   do {fP = new XrdFrmFiles(vP->Name, Opts, vP->Dir);
-       while((sP = fP->Get(ec,1)))
-            {aFiles++;
-             if (sP->Screen()) Add(sP);
-                else {delete sP; bFiles++;}
-            }
-       if (ec) Bad = 1;
-       delete fP;
-      } while((vP = vP->Next));
+   Bad = nsScan.Run(Config.ScanThreads);
+   aFiles = nsScan.aFiles; bFiles = nsScan.bFiles;
 
 // Indicate scan ended
 //
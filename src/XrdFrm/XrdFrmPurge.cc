@@ -49,7 +49,9 @@
 #include "XrdFrm/XrdFrmConfig.hh"
 #include "XrdFrm/XrdFrmMonitor.hh"
 #include "XrdFrm/XrdFrmPurge.hh"
+#include "XrdFrm/XrdFrmScan.hh"
 #include "XrdSys/XrdSysPlatform.hh"
+#include "XrdSys/XrdSysPthread.hh"
 
 using namespace XrdFrc;
 using namespace XrdFrm;
@@ -74,6 +76,7 @@ time_t expDirTime;
 time_t lowDirTime;
 int    numRMD;
 int    numEMD;
+XrdSysMutex dirMutex;  // Callbacks may come from several scan threads
 
      XrdFrmPurgeDir() {}
     ~XrdFrmPurgeDir() {}
@@ -95,6 +98,7 @@ void XrdFrmPurgeDir::isEmpty(struct stat *dStat, const char *dPath,
 
 // Check if this directory is still considered active
 //
+   XrdSysMutexHelper dHelp(dirMutex);
    numEMD++;
    if (dStat->st_mtime > expDirTime)
       {if (!lowDirTime || lowDirTime > dStat->st_mtime)
@@ -703,18 +707,13 @@ int XrdFrmPurge::PurgeFile(XrdFrmFileset *fP, const char *pFN)
   
 void XrdFrmPurge::Scan()
 {
-   static const int Opts = XrdFrmFiles::Recursive | XrdFrmFiles::CompressD
-                         | XrdFrmFiles::NoAutoDel;
    static time_t lastHP = time(0), nextDP = 0, nowT = time(0);
    static XrdFrmPurgeDir purgeDir;
    static XrdOucNSWalk::CallBack *cbP;
 
-   XrdFrmConfig::VPInfo *vP = Config.pathList;
-   XrdFrmFileset *sP;
-   XrdFrmFiles   *fP;
    const char *Extra;
    char buff[128];
-   int needLF, ec = 0, Bad = 0, aFiles = 0, bFiles = 0;
+   int Bad, aFiles, bFiles;
 
 // Purge that bad file table evey 24 hours to keep complaints down
 //
@@ -735,16 +734,10 @@ void XrdFrmPurge::Scan()
 
 // Process each directory
 //
-   do {fP = new XrdFrmFiles(vP->Name, Opts, vP->Dir, cbP);
-       needLF = vP->Val;
-       while((sP = fP->Get(ec,1)))
-            {aFiles++;
-             if (sP->Screen(needLF)) Add(sP);
-                else {delete sP; bFiles++;}
-            }
-       if (ec) Bad = 1;
-       delete fP;
-      } while((vP = vP->Next));
+  {XrdFrmScan nsScan(Add, XrdFrmScan::useVal, cbP);
+   Bad = nsScan.Run(Config.ScanThreads);
+   aFiles = nsScan.aFiles; bFiles = nsScan.bFiles;
+  }
 
 // If we did a directory purge, schedule the next one and say what we did
 //
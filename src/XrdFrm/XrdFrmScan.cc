@@ -0,0 +1,201 @@
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d F r m S c a n . c c                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "XrdFrc/XrdFrcTrace.hh"
+#include "XrdFrm/XrdFrmConfig.hh"
+#include "XrdFrm/XrdFrmFiles.hh"
+#include "XrdFrm/XrdFrmScan.hh"
+#include "XrdOuc/XrdOucTList.hh"
+
+using namespace XrdFrc;
+using namespace XrdFrm;
+
+/******************************************************************************/
+/*                     T h r e a d   I n t e r f a c e                        */
+/******************************************************************************/
+  
+void *XrdFrmScan::Worker(void *pp)
+{
+   XrdFrmScan *scP = (XrdFrmScan *)pp;
+
+   scP->Work();
+   return (void *)0;
+}
+
+/******************************************************************************/
+/*                                   R u n                                    */
+/******************************************************************************/
+  
+int XrdFrmScan::Run(int nThreads)
+{
+   static const int Opts = XrdFrmFiles::Recursive | XrdFrmFiles::CompressD
+                         | XrdFrmFiles::NoAutoDel;
+   XrdFrmConfig::VPInfo *vP = Config.pathList;
+   pthread_t tid[XrdFrmConfig::scanMax];
+   int i, nlf, rc, numT = 0;
+
+// Construct the job queue. When running single threaded each path is walked
+// as a whole, exactly as it always was. Otherwise we split each path into its
+// top level directories so that they can be walked in parallel.
+//
+   aFiles = bFiles = isBad = 0;
+   while(vP)
+        {nlf = (scMode & useVal ? vP->Val : 1);
+         if (nThreads > 1) Split(vP->Name, vP->Dir, nlf);
+            else jobQ = new scanJob(vP->Name, vP->Dir, Opts, nlf, jobQ);
+         vP = vP->Next;
+        }
+
+// The queue was built backwards, reverse it so paths go in configured order
+//
+  {scanJob *jP, *rP = 0;
+   while((jP = jobQ)) {jobQ = jP->Next; jP->Next = rP; rP = jP;}
+   jobQ = rP;
+  }
+
+// Start the additional threads, we will be one of the workers
+//
+   if (nThreads > XrdFrmConfig::scanMax) nThreads = XrdFrmConfig::scanMax;
+   for (i = 1; i < nThreads; i++)
+       {if ((rc = XrdSysThread::Run(&tid[numT], Worker, (void *)this,
+                                    XRDSYSTHREAD_HOLD, "name space scan")))
+           {Say.Emsg("Scan", rc, "create scan thread"); break;}
+        numT++;
+       }
+
+// Do our share of the work and wait for everyone else to finish
+//
+   Work();
+   for (i = 0; i < numT; i++) XrdSysThread::Join(tid[i], 0);
+   return isBad;
+}
+  
+/******************************************************************************/
+/* Private:                        S p l i t                                  */
+/******************************************************************************/
+  
+void XrdFrmScan::Split(const char *Path, XrdOucTList *XList, int needLF)
+{
+   static const int Opts = XrdFrmFiles::CompressD | XrdFrmFiles::NoAutoDel;
+   XrdOucTList *xP;
+   struct dirent *dp;
+   struct stat Stat;
+   char dBuff[MAXPATHLEN+1], *fP;
+   DIR *DFD;
+   int n;
+
+// If we cannot open the directory, let the walker report the problem
+//
+   if (!(DFD = opendir(Path)))
+      {jobQ = new scanJob(Path, XList, Opts|XrdFrmFiles::Recursive, needLF,
+                          jobQ);
+       return;
+      }
+
+// The files directly in this directory are handled by a non-recursive job
+//
+   jobQ = new scanJob(Path, XList, Opts, needLF, jobQ);
+
+// Construct the directory prefix (exclusions never end with a slash)
+//
+   n = strlen(Path);
+   if (n >= MAXPATHLEN-1) {closedir(DFD); return;}
+   strcpy(dBuff, Path);
+   while(n > 1 && dBuff[n-1] == '/') n--;
+   dBuff[n++] = '/'; fP = dBuff+n;
+
+// Each non-excluded subdirectory becomes a recursive job. Symlinked
+// directories are not followed, as is the case for a full walk.
+//
+   while((dp = readdir(DFD)))
+        {if (!strcmp(dp->d_name, ".") || !strcmp(dp->d_name, "..")) continue;
+         if (n + strlen(dp->d_name) >= sizeof(dBuff)) continue;
+         strcpy(fP, dp->d_name);
+         if (lstat(dBuff, &Stat) || !S_ISDIR(Stat.st_mode)) continue;
+         xP = XList;
+         while(xP && strcmp(dBuff, xP->text)) xP = xP->next;
+         if (!xP) jobQ = new scanJob(dBuff, XList,
+                                     Opts|XrdFrmFiles::Recursive,needLF,jobQ);
+        }
+   closedir(DFD);
+}
+  
+/******************************************************************************/
+/* Private:                         W a l k                                   */
+/******************************************************************************/
+  
+void XrdFrmScan::Walk(scanJob *jP)
+{
+   XrdFrmFiles   *fP = new XrdFrmFiles(jP->Path, jP->Opts, jP->XList, edCB);
+   XrdFrmFileset *sP;
+   int ec = 0, nA = 0, nB = 0;
+
+// Screen each fileset in parallel but add the survivors one at a time as the
+// Add functions manipulate shared tables.
+//
+   while((sP = fP->Get(ec,1)))
+        {nA++;
+         if (sP->Screen(jP->needLF))
+            {addMutex.Lock(); addFunc(sP); addMutex.UnLock();}
+            else {delete sP; nB++;}
+        }
+   delete fP;
+
+// Accumulate the statistics
+//
+   addMutex.Lock();
+   aFiles += nA; bFiles += nB;
+   if (ec) isBad = 1;
+   addMutex.UnLock();
+}
+  
+/******************************************************************************/
+/* Private:                         W o r k                                   */
+/******************************************************************************/
+  
+void XrdFrmScan::Work()
+{
+   scanJob *jP;
+
+// Process jobs until there are none left
+//
+   do {jobMutex.Lock();
+       if ((jP = jobQ)) jobQ = jP->Next;
+       jobMutex.UnLock();
+       if (!jP) break;
+       Walk(jP);
+       delete jP;
+      } while(1);
+}
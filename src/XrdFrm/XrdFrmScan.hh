@@ -0,0 +1,96 @@
+#ifndef __FRMSCAN_H__
+#define __FRMSCAN_H__
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d F r m S c a n . h h                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "XrdOuc/XrdOucNSWalk.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+class XrdFrmFileset;
+class XrdOucTList;
+
+/******************************************************************************/
+/*                       C l a s s   X r d F r m S c a n                      */
+/******************************************************************************/
+
+// XrdFrmScan walks all of the configured paths and hands each screened fileset
+// to the supplied Add function. With more than one thread, the top level
+// directories of each path become independent jobs that are walked in
+// parallel. Add() calls are always serialized by the scanner.
+//
+class XrdFrmScan
+{
+public:
+
+typedef void (*AddFunc)(XrdFrmFileset *sP);
+
+int         Run(int nThreads); // Returns !0 if errors were encountered
+
+int         aFiles;            // Number of filesets examined
+int         bFiles;            // Number of filesets failing screening
+
+            XrdFrmScan(AddFunc func, int mode, XrdOucNSWalk::CallBack *cbP=0)
+                      : aFiles(0), bFiles(0), addFunc(func), edCB(cbP),
+                        jobQ(0), scMode(mode), isBad(0) {}
+           ~XrdFrmScan() {}
+
+static const int useVal = 0x0001; // Screen() needLF is the path's r/w value
+
+private:
+
+struct scanJob
+      {scanJob     *Next;
+       char        *Path;
+       XrdOucTList *XList;
+       int          Opts;
+       int          needLF;
+
+                    scanJob(const char *path, XrdOucTList *xl, int opts,
+                            int nlf, scanJob *nP)
+                           : Next(nP), Path(strdup(path)), XList(xl),
+                             Opts(opts), needLF(nlf) {}
+                   ~scanJob() {if (Path) free(Path);}
+      };
+
+static void *Worker(void *pp);
+
+void         Split(const char *Path, XrdOucTList *XList, int needLF);
+void         Walk(scanJob *jP);
+void         Work();
+
+XrdSysMutex             addMutex;
+XrdSysMutex             jobMutex;
+AddFunc                 addFunc;
+XrdOucNSWalk::CallBack *edCB;
+scanJob                *jobQ;
+int                     scMode;
+int                     isBad;
+};
+#endif
@@ -46,6 +46,7 @@
 #include "XrdFrm/XrdFrmConfig.hh"
 #include "XrdFrm/XrdFrmMonitor.hh"
 #include "XrdFrm/XrdFrmTransfer.hh"
+#include "XrdFrm/XrdFrmXfrCopy.hh"
 #include "XrdFrm/XrdFrmXfrJob.hh"
 #include "XrdFrm/XrdFrmXfrQueue.hh"
 #include "XrdNet/XrdNetCmsNotify.hh"
@@ -111,7 +112,9 @@ XrdFrmTransfer::XrdFrmTransfer()
 // Construct program objects
 //
    for (i = 0; i < 4; i++)
-       xfrCmd[i] = (Config.xfrCmd[i].theVec ? new XrdOucProg(&Say) : 0);
+       xfrCmd[i] = (Config.xfrCmd[i].theVec
+                 || Config.xfrCmd[i].Opts & Config.cmdXrdCl
+                 ? new XrdOucProg(&Say) : 0);
 }
 
 /******************************************************************************/
@@ -207,7 +210,8 @@ const char *XrdFrmTransfer::Fetch()
    cmdArg.theSrc = theSrc;
    cmdArg.theDst = xfrP->PFN;
    cmdArg.theINS = xfrP->reqData.iName;
-   if (!SetupCmd(&cmdArg)) return "incoming transfer setup failed";
+   if (cmdArg.theVec && !SetupCmd(&cmdArg))
+      return "incoming transfer setup failed";
 
 // If the copycmd needs a placeholder in the filesystem for this transfer, we
 // must create one. We first remove any existing "anew" file because we will
@@ -233,7 +237,7 @@ const char *XrdFrmTransfer::Fetch()
 // the file we just fetched; then rename it to be the correct name.
 //
    xfrET = time(0);
-   if (!(rc = cmdArg.theCmd->Run(pdBuff, pdSZ)))
+   if (!(rc = RunCmd(iXfr, &cmdArg, pdBuff, pdSZ)))
       {if ((rc = Config.Stat(lfnpath, xfrP->PFN, &pfnStat)))
           {Say.Emsg("Fetch", lfnpath, "fetched but not resident!"); fSize = 0;}
           else {fSize  = pfnStat.st_size;
@@ -432,6 +436,39 @@ int XrdFrmTransfer::Init()
    return 1;
 }
 
+/******************************************************************************/
+/* Private:                       R u n C m d                                 */
+/******************************************************************************/
+  
+int XrdFrmTransfer::RunCmd(int iXfr, XrdFrmTranArg *argP, char *pdBuff,
+                           int pdSZ)
+{
+   char eBuff[512];
+   int rc;
+
+// If we are to copy in-process, do so. Only if that fails for a reason other
+// than a missing source do we fall back to the copy command, if there is one.
+//
+   if (Config.xfrCmd[iXfr].Opts & Config.cmdXrdCl)
+      {if (pdSZ) *pdBuff = 0;
+       rc = XrdFrmXfrCopy::Run(argP->theSrc, argP->theDst,
+                               Config.xfrCmd[iXfr].TLimit,
+                               (iXfr & XrdFrcRequest::outQ) != 0,
+                               eBuff, sizeof(eBuff));
+       if (!rc || rc == -2 || !argP->theVec)
+          {if (rc) Say.Emsg("Transfer", xfrP->reqData.LFN, "copy failed;",
+                            eBuff);
+           return rc;
+          }
+       Say.Emsg("Transfer", xfrP->reqData.LFN, "in-process copy failed; "
+                "trying copy command;", eBuff);
+      }
+
+// Run the copy command
+//
+   return argP->theCmd->Run(pdBuff, pdSZ);
+}
+
 /******************************************************************************/
 /* Private:                     S e t u p C m d                               */
 /******************************************************************************/
@@ -649,7 +686,8 @@ const char *XrdFrmTransfer::Throw()
    cmdArg.theINS = xfrP->reqData.iName;
    if (Config.xfrCmd[iXfr].Opts & Config.cmdMDP)
       mDP = TrackDC(lfnpath+xfrP->reqData.LFO, cmdArg.theMDP, Rfn);
-   if (!SetupCmd(&cmdArg)) return "outgoing transfer setup failed";
+   if (cmdArg.theVec && !SetupCmd(&cmdArg))
+      return "outgoing transfer setup failed";
 
 // Setup program monitoring data
 //
@@ -659,7 +697,7 @@ const char *XrdFrmTransfer::Throw()
 // migration request, cretae a fail file if one does not exist.
 //
    xfrET = time(0);
-   if ((rc = cmdArg.theCmd->Run(pdBuff, pdSZ)))
+   if ((rc = RunCmd(iXfr, &cmdArg, pdBuff, pdSZ)))
       {if (isMigr) ffMake(rc == -2);
        retMsg = "copy failed";
       }
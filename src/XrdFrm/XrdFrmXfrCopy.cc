@@ -0,0 +1,109 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d F r m X f r C o p y . c c                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <string>
+#include <time.h>
+
+#include "XProtocol/XProtocol.hh"
+#include "XrdCl/XrdClCopyProcess.hh"
+#include "XrdCl/XrdClPropertyList.hh"
+#include "XrdFrm/XrdFrmXfrCopy.hh"
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+class CopyTimer : public XrdCl::CopyProgressHandler
+{
+public:
+
+virtual bool ShouldCancel(uint16_t jobNum)
+                         {(void)jobNum;
+                          return tEnd && time(0) >= tEnd;
+                         }
+
+             CopyTimer(int tLim) : tEnd(tLim ? time(0)+tLim : 0) {}
+virtual     ~CopyTimer() {}
+
+time_t       tEnd;
+};
+}
+
+/******************************************************************************/
+/*                                   R u n                                    */
+/******************************************************************************/
+  
+int XrdFrmXfrCopy::Run(const char *Src, const char *Dst, int tLim, bool mkDir,
+                       char *eBuff, int eBlen)
+{
+   XrdCl::CopyProcess  cProc;
+   XrdCl::PropertyList props, results;
+   XrdCl::XRootDStatus st;
+   CopyTimer           cTimer(tLim);
+   std::string         srcURL(*Src == '/' ? "file://" : ""),
+                       dstURL(*Dst == '/' ? "file://" : "");
+
+// Local paths must be turned into file urls
+//
+   srcURL += Src; dstURL += Dst;
+
+// Describe the copy. The target may be a pre-allocated placeholder so we
+// always overwrite it.
+//
+   props.Set("source",         srcURL);
+   props.Set("target",         dstURL);
+   props.Set("force",          true);
+   props.Set("posc",           false);
+   props.Set("coerce",         false);
+   props.Set("makeDir",        mkDir);
+   props.Set("thirdParty",     "none");
+   props.Set("checkSumMode",   "none");
+   props.Set("checkSumType",   "");
+   props.Set("checkSumPreset", "");
+
+// Add the job, prepare it, and run it
+//
+   st = cProc.AddJob(props, &results);
+   if (st.IsOK()) st = cProc.Prepare();
+   if (st.IsOK()) st = cProc.Run(&cTimer);
+   if (st.IsOK() && results.HasProperty("status"))
+      st = results.Get<XrdCl::XRootDStatus>("status");
+
+// Return the result
+//
+   if (st.IsOK()) return 0;
+   std::string eMsg = st.ToStr();
+   while(!eMsg.empty() && eMsg[eMsg.size()-1] == '\n') eMsg.erase(eMsg.size()-1);
+   snprintf(eBuff, eBlen, "%s", eMsg.c_str());
+   if (st.errNo == kXR_NotFound || st.errNo == ENOENT
+   ||  st.code  == XrdCl::errNotFound) return -2;
+   return (st.errNo ? st.errNo : EIO);
+}
@@ -0,0 +1,50 @@
+#ifndef __FRMXFRCOPY_H__
+#define __FRMXFRCOPY_H__
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d F r m X f r C o p y . h h                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+// XrdFrmXfrCopy copies a file in-process using the XrdCl copy engine. All
+// copies share the XrdCl connection pool so that repeated transfers to the
+// same endpoint do not incur the cost of a fork/exec or a new login.
+//
+class XrdFrmXfrCopy
+{
+public:
+
+// Run() copies Src to Dst, either of which may be a url or a local path. The
+// copy is cancelled after tLim seconds unless tLim is zero; target directories
+// are created when mkDir is true. The return value mirrors XrdOucProg::Run():
+// 0 upon success, -2 if the source does not exist and a positive error
+// number otherwise, in which case eBuff holds the reason.
+//
+static int Run(const char *Src, const char *Dst, int tLim, bool mkDir,
+               char *eBuff, int eBlen);
+
+           XrdFrmXfrCopy() {}
+          ~XrdFrmXfrCopy() {}
+};
+#endif
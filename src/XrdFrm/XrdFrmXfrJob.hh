@@ -31,6 +31,7 @@
 /******************************************************************************/
   
 #include <sys/param.h>
+#include <sys/types.h>
 #include "XrdFrc/XrdFrcRequest.hh"
 
 class XrdFrcReqFile;
@@ -50,6 +51,10 @@ char           PFN[MAXPATHLEN+16];
 int            pfnEnd;
 int            RetCode;
 int            qNum;
+int            fsSlot;       // Index into the file system table or -1
+dev_t          fsDev;        // Target file system of an inbound transfer
+long long      volPos;       // Position within the volume (frm.pos cgi)
+char           Vol[64];      // Tape volume hint (frm.vol cgi) or null string
 char           Act;
 };
 #endif
@@ -28,6 +28,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 #include <stdio.h>
@@ -45,6 +46,7 @@
 #include "XrdFrm/XrdFrmXfrQueue.hh"
 #include "XrdNet/XrdNetMsg.hh"
 #include "XrdOss/XrdOss.hh"
+#include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucTList.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysFD.hh"
@@ -66,6 +68,9 @@ XrdSysSemaphore           XrdFrmXfrQueue::qReady(0);
 
 XrdFrmXfrQueue::theQueue  XrdFrmXfrQueue::xfrQ[XrdFrcRequest::numQ];
 
+XrdFrmXfrQueue::fsUse    *XrdFrmXfrQueue::fsTab = 0;
+int                       XrdFrmXfrQueue::fsWait = 0;
+
 /******************************************************************************/
 /* Public:                           A d d                                    */
 /******************************************************************************/
@@ -158,6 +163,7 @@ int XrdFrmXfrQueue::Add(XrdFrcRequest *rP, XrdFrcReqFile *reqFQ, int qNum)
    xP->qNum     = qNum;
    xP->Act      =*xfrType;
    xP->Type     = xfrType+1;
+   Hints(xP);
 
 // Add this to the table of requests
 //
@@ -165,11 +171,20 @@ int XrdFrmXfrQueue::Add(XrdFrcRequest *rP, XrdFrcReqFile *reqFQ, int qNum)
    hTab.Add(xP->reqFile, xP, 0, Hash_keep);
    hMutex.UnLock();
 
-// Place request in the appropriate transfer queue
+// Place request in the appropriate transfer queue ordered by priority. Most
+// requests have the same priority so we check the end of the queue first.
 //
    qMutex.Lock();
-   if (xfrQ[qNum].Last) {xfrQ[qNum].Last->Next = xP; xfrQ[qNum].Last = xP;}
-      else               xfrQ[qNum].Last       = xfrQ[qNum].First    = xP;
+   if (xfrQ[qNum].Last)
+      {if (xfrQ[qNum].Last->reqData.Prty >= rP->Prty)
+          {xfrQ[qNum].Last->Next = xP; xfrQ[qNum].Last = xP;}
+          else {XrdFrmXfrJob *pP = 0, *nP = xfrQ[qNum].First;
+                while(nP->reqData.Prty >= rP->Prty) {pP = nP; nP = nP->Next;}
+                xP->Next = nP;
+                if (pP) pP->Next = xP;
+                   else xfrQ[qNum].First = xP;
+               }
+      } else xfrQ[qNum].Last = xfrQ[qNum].First = xP;
    qMutex.UnLock();
    qReady.Post();
 
@@ -204,15 +219,89 @@ void XrdFrmXfrQueue::Done(XrdFrmXfrJob *xP, const char *Msg)
 //
    hMutex.Lock(); hTab.Del(xP->reqFile); hMutex.UnLock();
   
-// Place job element on the free queue
+// Place job element on the free queue, releasing its file system slot
 //
    qMutex.Lock();
+   if (xP->fsSlot >= 0) fsFree(xP);
    xP->Next = xfrQ[xP->qNum].Free;
    xfrQ[xP->qNum].Free = xP;
    xfrQ[xP->qNum].Avail.Post();
    qMutex.UnLock();
 }
 
+/******************************************************************************/
+/* Private:                       f s F r e e                                 */
+/******************************************************************************/
+  
+void XrdFrmXfrQueue::fsFree(XrdFrmXfrJob *xP) // Called with qMutex locked!
+{
+   XrdFrmXfrJob *jP;
+   int qNum;
+
+// Release the slot
+//
+   fsTab[xP->fsSlot].Active--;
+   xP->fsSlot = -1;
+
+// If any selection was skipped because of the file system limit, the agents
+// that skipped it went back to sleep. Wake them up to reconsider the queues.
+//
+   if (fsWait)
+      {fsWait = 0;
+       for (qNum = 0; qNum < XrdFrcRequest::numQ-1; qNum++)
+           {jP = xfrQ[qNum].First;
+            while(jP) {qReady.Post(); jP = jP->Next;}
+           }
+      }
+}
+
+/******************************************************************************/
+/* Private:                         f s O K                                   */
+/******************************************************************************/
+  
+int XrdFrmXfrQueue::fsOK(XrdFrmXfrJob *xP) // Called with qMutex locked!
+{
+   int i;
+
+// Outgoing requests and requests without a known file system are not limited
+//
+   if (!fsTab || !xP->fsDev) return 1;
+
+// Check if the target file system is at its limit
+//
+   for (i = 0; i < Config.xfrMax; i++)
+       if (fsTab[i].Active && fsTab[i].Dev == xP->fsDev)
+          return fsTab[i].Active < Config.xfrFSMax;
+   return 1;
+}
+
+/******************************************************************************/
+/* Private:                        f s T a k e                                */
+/******************************************************************************/
+  
+void XrdFrmXfrQueue::fsTake(XrdFrmXfrJob *xP) // Called with qMutex locked!
+{
+   int i, freeEnt = -1;
+
+// Outgoing requests and requests without a known file system are not limited
+//
+   if (!fsTab || !xP->fsDev) return;
+
+// Find the entry for this file system or a free one. Since each active job
+// occupies at most one entry we can never run out of entries.
+//
+   for (i = 0; i < Config.xfrMax; i++)
+       {if (!fsTab[i].Active) {if (freeEnt < 0) freeEnt = i;}
+           else if (fsTab[i].Dev == xP->fsDev) break;
+       }
+   if (i >= Config.xfrMax)
+      {if ((i = freeEnt) < 0) return;
+       fsTab[i].Dev = xP->fsDev;
+      }
+   fsTab[i].Active++;
+   xP->fsSlot = i;
+}
+
 /******************************************************************************/
 /* Public:                           G e t                                    */
 /******************************************************************************/
@@ -269,11 +358,12 @@ int XrdFrmXfrQueue::Init()
                                       XRDSYSTHREAD_BIND, "Stopfile monitor")))
            {Say.Emsg("main", retc, "create stopfile thread"); return 0;}
 
-   // Create twice as many free queue elements as we have xfr agents for the
-   // queue. This prevents stalls when a particular queue is stopped but keeps
-   // us from exceeding internal resources when we get flooded with requests.
+   // Create twice (or window times) as many free queue elements as we have
+   // xfr agents for the queue. This prevents stalls when a particular queue is
+   // stopped but keeps us from exceeding internal resources when we get
+   // flooded with requests. A larger window gives the scheduler more choice.
    //
-        n = Config.xfrMax*2;
+        n = Config.xfrMax*Config.xfrWindow;
         while(n--)
              {xP = new XrdFrmXfrJob;
               xP->Next = xfrQ[qNum].Free;
@@ -282,11 +372,109 @@ int XrdFrmXfrQueue::Init()
              }
        }
 
+// Allocate the file system usage table if inbound transfers are limited
+//
+   if (Config.xfrFSMax > 0)
+      {fsTab = new fsUse[Config.xfrMax];
+       memset(fsTab, 0, sizeof(fsUse)*Config.xfrMax);
+      }
+
 // All done
 //
    return 1;
 }
 
+/******************************************************************************/
+/* Private:                        H i n t s                                  */
+/******************************************************************************/
+  
+void XrdFrmXfrQueue::Hints(XrdFrmXfrJob *xP)
+{
+   XrdOucEnv myEnv(xP->reqData.Opaque ? xP->reqData.LFN+xP->reqData.Opaque:0);
+   struct stat buf;
+   char *val, pBuff[MAXPATHLEN], *Slash;
+
+// Extract the tape volume and position hints, if any
+//
+   if (!(val = myEnv.Get("frm.vol"))) *(xP->Vol) = 0;
+      else {strncpy(xP->Vol, val, sizeof(xP->Vol)-1);
+            xP->Vol[sizeof(xP->Vol)-1] = 0;
+           }
+   if (!(val = myEnv.Get("frm.pos"))) xP->volPos = 0;
+      else xP->volPos = strtoll(val, 0, 10);
+
+// For inbound requests with a file system limit, find the file system that
+// will hold the file. That is the one holding the nearest existing directory.
+//
+   xP->fsSlot = -1; xP->fsDev = 0;
+   if (!fsTab || xP->qNum & XrdFrcRequest::outQ) return;
+   strcpy(pBuff, xP->PFN);
+   while((Slash = rindex(pBuff, '/')) && Slash != pBuff)
+        {*Slash = 0;
+         if (!stat(pBuff, &buf)) {xP->fsDev = buf.st_dev; break;}
+        }
+}
+
+/******************************************************************************/
+/* Private:                         P i c k                                   */
+/******************************************************************************/
+  
+XrdFrmXfrJob *XrdFrmXfrQueue::Pick(int qNum, XrdFrmXfrJob **pP)
+{                                     // Called with qMutex locked!
+   XrdFrmXfrJob *xP, *prvP = 0, *vP;
+   theQueue *qP = &xfrQ[qNum];
+
+// Find the first job that can be run. The queue is ordered by priority and
+// then arrival time so this is the job we would choose absent any hints.
+//
+   for (xP = qP->First; xP; prvP = xP, xP = xP->Next)
+       {if (fsOK(xP)) break;
+        fsWait++;
+       }
+   if (!xP) return 0;
+
+// Prefer staying on the volume we last pulled from, continuing forward from
+// the last position and wrapping back to the start of the volume. This avoids
+// remounts and long seeks. We never override a higher priority request.
+//
+   if (*(qP->curVol)
+   &&  ((vP = PickVol(qNum, pP, qP->curVol, qP->curPos, xP->reqData.Prty))
+   ||   (vP = PickVol(qNum, pP, qP->curVol, -1,         xP->reqData.Prty))))
+      return vP;
+
+// Otherwise start on the volume of the selected job at its lowest position
+//
+   if (*(xP->Vol)
+   &&  (vP = PickVol(qNum, pP, xP->Vol, -1, xP->reqData.Prty))) return vP;
+
+// Return the selected job
+//
+   *pP = prvP;
+   return xP;
+}
+
+/******************************************************************************/
+/* Private:                      P i c k V o l                                */
+/******************************************************************************/
+  
+XrdFrmXfrJob *XrdFrmXfrQueue::PickVol(int qNum, XrdFrmXfrJob **pP,
+                                      const char *vol, long long minPos,
+                                      int prty)
+{                                     // Called with qMutex locked!
+   XrdFrmXfrJob *xP, *prvP = 0, *bestP = 0;
+
+// Find the runnable job on the volume with the lowest position >= minPos.
+// Only jobs of the same priority are considered (the queue is ordered).
+//
+   for (xP = xfrQ[qNum].First; xP; prvP = xP, xP = xP->Next)
+       {if (xP->reqData.Prty < prty) break;
+        if (xP->reqData.Prty > prty || xP->volPos < minPos
+        ||  strcmp(xP->Vol, vol) || !fsOK(xP)) continue;
+        if (!bestP || xP->volPos < bestP->volPos) {bestP = xP; *pP = prvP;}
+       }
+   return bestP;
+}
+
 /******************************************************************************/
 /* Private:                         P u l l                                   */
 /******************************************************************************/
@@ -294,7 +482,7 @@ int XrdFrmXfrQueue::Init()
 XrdFrmXfrJob *XrdFrmXfrQueue::Pull()
 {
    static int ioX = 0, prevQ[2] = {0,0};
-   XrdFrmXfrJob *xfrP;
+   XrdFrmXfrJob *xfrP, *x1P, *x2P, *p1P, *p2P, *prvP;
    int pikQ, theQ, Q1, Q2, nSel = 1;
 
 // Setup to pick a request equally multiplexing between all possible queues
@@ -309,20 +497,34 @@ do{ioX = (ioX + 1) & 1;
    if (xfrQ[Q1].Stop || Stopped(Q1)) Q1 = XrdFrcRequest::nilQ;
    if (xfrQ[Q2].Stop || Stopped(Q2)) Q2 = XrdFrcRequest::nilQ;
 
-// Pick the oldest possible request
+// Select the best candidate in each queue
+//
+   x1P = (Q1 == XrdFrcRequest::nilQ ? 0 : Pick(Q1, &p1P));
+   x2P = (Q2 == XrdFrcRequest::nilQ ? 0 : Pick(Q2, &p2P));
+
+// Pick the highest priority, oldest possible request
 //
-   if (xfrQ[Q1].First && xfrQ[Q2].First)
-      {     if (xfrQ[Q1].First->reqData.addTOD < xfrQ[Q2].First->reqData.addTOD)
-               theQ = Q1;
-       else if (xfrQ[Q1].First->reqData.addTOD > xfrQ[Q2].First->reqData.addTOD)
-               theQ = Q2;
+   if (x1P && x2P)
+      {     if (x1P->reqData.Prty   > x2P->reqData.Prty)   theQ = Q1;
+       else if (x1P->reqData.Prty   < x2P->reqData.Prty)   theQ = Q2;
+       else if (x1P->reqData.addTOD < x2P->reqData.addTOD) theQ = Q1;
+       else if (x1P->reqData.addTOD > x2P->reqData.addTOD) theQ = Q2;
        else theQ = (prevQ[pikQ] == Q1 ? Q2 : Q1);
-      }else theQ = (xfrQ[Q1].First    ? Q1 : Q2);
+      }else theQ = (x1P ? Q1 : Q2);
 
 // Dequeue the request (we may have an empty selectoin here)
 //
-   if ((xfrP = xfrQ[theQ].First)
-   &&  !(xfrQ[theQ].First = xfrP->Next)) xfrQ[theQ].Last = 0;
+   if (theQ == Q1) {xfrP = x1P; prvP = p1P;}
+      else         {xfrP = x2P; prvP = p2P;}
+   if (xfrP)
+      {if (prvP) prvP->Next = xfrP->Next;
+          else   xfrQ[theQ].First = xfrP->Next;
+       if (xfrQ[theQ].Last == xfrP) xfrQ[theQ].Last = prvP;
+       xfrP->Next = 0;
+       strcpy(xfrQ[theQ].curVol, xfrP->Vol);
+       xfrQ[theQ].curPos = xfrP->volPos;
+       fsTake(xfrP);
+      }
   } while(!xfrP && nSel--);
 
 // Return the job, if any
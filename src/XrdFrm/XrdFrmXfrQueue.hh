@@ -57,6 +57,13 @@ static void          StopMon(void *parg);
 
 private:
 
+static void          fsFree(XrdFrmXfrJob *xP);
+static int           fsOK(XrdFrmXfrJob *xP);
+static void          fsTake(XrdFrmXfrJob *xP);
+static void          Hints(XrdFrmXfrJob *xP);
+static XrdFrmXfrJob *Pick(int qNum, XrdFrmXfrJob **pP);
+static XrdFrmXfrJob *PickVol(int qNum, XrdFrmXfrJob **pP, const char *vol,
+                             long long minPos, int prty);
 static XrdFrmXfrJob *Pull();
 static int           Notify(XrdFrcRequest *rP,int qN,int rc,const char *msg=0);
 static void          Send2File(char *Dest, char *Msg, int Mln);
@@ -80,9 +87,16 @@ struct theQueue
               const char        *Name;
               int                Stop;
               int                qNum;
-              theQueue() : Avail(0),Free(0),First(0),Last(0),Alert(0),Stop(0) {}
+              long long          curPos;     // Position of the last pull
+              char               curVol[64]; // Volume   of the last pull
+              theQueue() : Avail(0),Free(0),First(0),Last(0),Alert(0),Stop(0),
+                           curPos(0) {*curVol = 0;}
              ~theQueue() {}
       };
 static theQueue                  xfrQ[XrdFrcRequest::numQ];
+
+struct fsUse {dev_t Dev; int Active;};
+static fsUse                    *fsTab;      // One entry per transfer agent
+static int                       fsWait;     // Pulls skipped due to fsmax
 };
 #endif
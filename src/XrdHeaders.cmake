@@ -59,6 +59,8 @@ set( XROOTD_PUBLIC_HEADERS
   XrdOuc/XrdOucIOVec.hh
   XrdOuc/XrdOucLock.hh
   XrdOuc/XrdOucName2Name.hh
+  XrdOuc/XrdOucOAHash.hh
+  XrdOuc/XrdOucOAHash.icc
   XrdOuc/XrdOucPinPath.hh
   XrdOuc/XrdOucRash.hh
   XrdOuc/XrdOucRash.icc
@@ -69,6 +71,7 @@ set( XROOTD_PUBLIC_HEADERS
   XrdOuc/XrdOucTable.hh
   XrdOuc/XrdOucTokenizer.hh
   XrdOuc/XrdOucTrace.hh
+  XrdOuc/XrdOucTraceCtx.hh
   XrdOuc/XrdOucUtils.hh
   XrdOuc/XrdOuca2x.hh
   XrdOuc/XrdOucEnum.hh
@@ -88,6 +91,7 @@ set( XROOTD_PUBLIC_HEADERS
   XrdSfs/XrdSfsInterface.hh
   XrdSys/XrdSysAtomics.hh
   XrdSys/XrdSysDNS.hh
+  XrdSys/XrdSysDRWLock.hh
   XrdSys/XrdSysError.hh
   XrdSys/XrdSysFD.hh
   XrdSys/XrdSysHeaders.hh
@@ -99,6 +103,7 @@ set( XROOTD_PUBLIC_HEADERS
   XrdSys/XrdSysPthread.hh
   XrdSys/XrdSysSemWait.hh
   XrdSys/XrdSysTimer.hh
+  XrdSys/XrdSysTimerWheel.hh
   XrdSys/XrdSysXAttr.hh
   XrdSys/XrdSysXSLock.hh
   XrdXml/XrdXmlReader.hh
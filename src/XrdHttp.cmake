@@ -5,6 +5,7 @@ include( XRootDCommon )
 #-------------------------------------------------------------------------------
 set( LIB_XRD_HTTP_UTILS XrdHttpUtils )
 set( MOD_XRD_HTTP       XrdHttp-${PLUGIN_VERSION} )
+set( MOD_XRD_HTTP_MTR   XrdHttpMetrics-${PLUGIN_VERSION} )
 
 #-------------------------------------------------------------------------------
 # Shared library version
@@ -36,6 +37,11 @@ if( BUILD_HTTP )
     MODULE
     XrdHttp/XrdHttpModule.cc )
 
+  add_library(
+    ${MOD_XRD_HTTP_MTR}
+    MODULE
+    XrdHttp/XrdHttpMetrics.cc )
+
   target_link_libraries(
     ${LIB_XRD_HTTP_UTILS}
     XrdServer
@@ -51,6 +57,12 @@ if( BUILD_HTTP )
     XrdUtils
     ${LIB_XRD_HTTP_UTILS} )
 
+  target_link_libraries(
+    ${MOD_XRD_HTTP_MTR}
+    XrdServer
+    XrdUtils
+    ${LIB_XRD_HTTP_UTILS} )
+
   set_target_properties(
     ${LIB_XRD_HTTP_UTILS}
     PROPERTIES
@@ -60,7 +72,7 @@ if( BUILD_HTTP )
     LINK_INTERFACE_LIBRARIES "" )
 
   set_target_properties(
-    ${MOD_XRD_HTTP}
+    ${MOD_XRD_HTTP} ${MOD_XRD_HTTP_MTR}
     PROPERTIES
     INTERFACE_LINK_LIBRARIES ""
     SUFFIX ".so"
@@ -70,7 +82,7 @@ if( BUILD_HTTP )
   # Install
   #-----------------------------------------------------------------------------
   install(
-    TARGETS ${LIB_XRD_HTTP_UTILS} ${MOD_XRD_HTTP}
+    TARGETS ${LIB_XRD_HTTP_UTILS} ${MOD_XRD_HTTP} ${MOD_XRD_HTTP_MTR}
     LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR} )
 
 endif()
@@ -0,0 +1,379 @@
+//------------------------------------------------------------------------------
+// This file is part of XrdHTTP: A pragmatic implementation of the
+// HTTP/WebDAV protocol for the Xrootd framework
+//
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+// File Date: Oct 2026
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+// An external handler that serves the server statistics in the Prometheus
+// text exposition format. Load it with
+//
+//   http.exthandler metrics libXrdHttpMetrics.so [<path>]
+//
+// where <path> is the url path to serve (default /metrics). The statistics
+// are those reported by the xrd.report directive and "xrdfs query stats a";
+// the xml is flattened so that <stats id="link"><in>5</in></stats> becomes
+// xrootd_link_in 5. Nested numbered <stats> elements become an id label and
+// string values are gathered into an <element>_info series. The xroot request
+// latency histograms are exported as real histograms with one bucket per
+// power of two microseconds.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Xrd/XrdStats.hh"
+#include "XrdHttp/XrdHttpExtHandler.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdVersion.hh"
+#include "XrdXrootd/XrdXrootdStats.hh"
+
+XrdVERSIONINFO(XrdHttpGetExtHandler, HttpMetrics);
+
+namespace
+{
+  const char *contentType = "Content-Type: text/plain; version=0.0.4; charset=utf-8";
+
+  // Collects the statistics snapshot; this is called with the stats lock held
+  // so it merely copies the text.
+  //
+  class StatsText : public XrdStats::CallBack
+  {
+  public:
+    void Info(const char *data, int dlen) {text.assign(data, dlen);}
+
+    std::string text;
+  };
+
+  // Series are grouped by family as the exposition format requires all
+  // samples of a metric to be adjacent. Families keep their first-seen order.
+  //
+  class Exposition
+  {
+  public:
+    void Add(const std::string &name, const std::string &labels,
+             const std::string &value) {
+      std::string &lines = Family(name);
+      lines += name;
+      if (!labels.empty()) {lines += '{'; lines += labels; lines += '}';}
+      lines += ' '; lines += value; lines += '\n';
+    }
+
+    std::string &Family(const std::string &name, const char *type = 0) {
+      std::map<std::string, size_t>::iterator it = index.find(name);
+      if (it != index.end()) return body[it->second];
+      index[name] = body.size();
+      body.push_back(type ? "# TYPE " + name + ' ' + type + '\n'
+                          : std::string());
+      return body.back();
+    }
+
+    void Text(std::string &out) {
+      for (size_t i = 0; i < body.size(); i++) out += body[i];
+    }
+
+  private:
+    std::map<std::string, size_t> index;
+    std::vector<std::string>      body;
+  };
+
+  // One open xml element
+  //
+  struct Frame
+  {
+    std::string name;    // Metric name prefix for this element
+    std::string id;      // Id label of a nested <stats> element
+    std::string info;    // String values found within a <stats> element
+    std::string text;    // Text seen so far
+    bool        isStats;
+    bool        hasKids;
+  };
+
+  void Sanitize(std::string &name) {
+    for (size_t i = 0; i < name.size(); i++) {
+      char c = name[i];
+      if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            (c >= '0' && c <= '9') || c == '_' || c == ':')) name[i] = '_';
+    }
+  }
+
+  void AddLabel(std::string &labels, const std::string &key,
+                const std::string &val) {
+    std::string k(key);
+    Sanitize(k);
+    if (!labels.empty()) labels += ',';
+    labels += k; labels += "=\"";
+    for (size_t i = 0; i < val.size(); i++) {
+      switch (val[i]) {
+        case '\\': labels += "\\\\"; break;
+        case '"':  labels += "\\\"";  break;
+        case '\n': labels += "\\n";   break;
+        default:   labels += val[i];  break;
+      }
+    }
+    labels += '"';
+  }
+
+  bool IsNumber(const std::string &text) {
+    char *eol;
+    if (text.empty()) return false;
+    strtod(text.c_str(), &eol);
+    return *eol == '\0';
+  }
+
+  // Return the value of attribute attr in the tag text or an empty string
+  //
+  std::string Attr(const std::string &tag, const char *attr) {
+    std::string key = std::string(" ") + attr + "=\"";
+    size_t beg = tag.find(key), end;
+    if (beg == std::string::npos) return std::string();
+    beg += key.size();
+    if ((end = tag.find('"', beg)) == std::string::npos) return std::string();
+    return tag.substr(beg, end - beg);
+  }
+}
+
+/******************************************************************************/
+/*                     C l a s s   X r d H t t p M e t r i c s                */
+/******************************************************************************/
+
+class XrdHttpMetrics : public XrdHttpExtHandler
+{
+public:
+
+  bool MatchesPath(const char *verb, const char *path) {
+    return !strcmp(verb, "GET") && path == urlPath;
+  }
+
+  int ProcessReq(XrdHttpExtReq &req);
+
+  int Init(const char *cfgfile) {return 0;}
+
+  XrdHttpMetrics(XrdStats *sP, XrdXrootdStats *xP, const char *path)
+    : xrdStats(sP), xrdXrootdStats(xP), urlPath(path) {}
+
+  virtual ~XrdHttpMetrics() {}
+
+private:
+
+  void Flatten(const std::string &xml, Exposition &exp);
+  void Latency(Exposition &exp);
+
+  XrdStats       *xrdStats;
+  XrdXrootdStats *xrdXrootdStats;
+  std::string     urlPath;
+};
+
+/******************************************************************************/
+/*                            P r o c e s s R e q                             */
+/******************************************************************************/
+
+int XrdHttpMetrics::ProcessReq(XrdHttpExtReq &req)
+{
+  StatsText  stats;
+  Exposition exp;
+  std::string body;
+
+  // Get a synchronized snapshot of everything the server can report
+  //
+  xrdStats->Stats(&stats, XRD_STATS_ALL | XRD_STATS_SYNC);
+
+  Flatten(stats.text, exp);
+  if (xrdXrootdStats) Latency(exp);
+  exp.Text(body);
+
+  return req.SendSimpleResp(200, "OK", contentType, body.c_str(), body.size());
+}
+
+/******************************************************************************/
+/* Private:                         F l a t t e n                             */
+/******************************************************************************/
+
+void XrdHttpMetrics::Flatten(const std::string &xml, Exposition &exp)
+{
+  std::vector<Frame> stack;
+  size_t pos = 0, gt;
+
+  while ((pos = xml.find('<', pos)) != std::string::npos) {
+    if ((gt = xml.find('>', pos)) == std::string::npos) break;
+    std::string tag = xml.substr(pos + 1, gt - pos - 1);
+    size_t next = xml.find('<', gt);
+    std::string text = xml.substr(gt + 1, (next == std::string::npos
+                                           ? xml.size() : next) - gt - 1);
+    pos = gt + 1;
+
+    // A closing tag emits the value of a leaf element or, for a <stats>
+    // element, the string values collected within it.
+    //
+    if (tag[0] == '/') {
+      if (stack.empty()) break;
+      Frame &f = stack.back();
+      std::string labels;
+      if (!f.id.empty()) AddLabel(labels, "id", f.id);
+      if (f.isStats) {
+        if (!f.info.empty()) {
+          if (!labels.empty()) labels += ',';
+          labels += f.info;
+          std::string name(f.name);
+          if (name.size() < 5 || name.compare(name.size() - 5, 5, "_info"))
+            name += "_info";
+          exp.Add(name, labels, "1");
+        }
+      } else if (!f.hasKids && stack.size() > 1) {
+        std::string val(f.text);
+        if (IsNumber(val)) exp.Add(f.name, labels, val);
+        else {
+          if (val.size() > 1 && val[0] == '"' && val[val.size()-1] == '"')
+            val = val.substr(1, val.size() - 2);
+          for (size_t i = stack.size() - 1; i-- > 0;)
+            if (stack[i].isStats) {
+              std::string key(tag.substr(1));
+              AddLabel(stack[i].info, key, val);
+              break;
+            }
+        }
+      }
+      stack.pop_back();
+      if (!stack.empty()) stack.back().text.clear();
+      continue;
+    }
+
+    // An opening tag. A count that precedes nested elements, as in
+    // <paths>2<stats id="0">..., is emitted under the parent's name.
+    //
+    std::string name = tag.substr(0, tag.find(' '));
+    Frame f;
+    f.isStats = false;
+    f.hasKids = false;
+    f.text    = text;
+    if (stack.empty()) {
+      f.name    = "xrootd";
+      f.isStats = true;
+      const char *rootAttrs[] = {"ver", "src", "pgm", "ins", "site"};
+      for (size_t i = 0; i < sizeof(rootAttrs)/sizeof(rootAttrs[0]); i++) {
+        std::string val = Attr(tag, rootAttrs[i]);
+        if (!val.empty()) AddLabel(f.info, rootAttrs[i], val);
+      }
+      std::string tos = Attr(tag, "tos");
+      if (IsNumber(tos)) exp.Add("xrootd_start_time_seconds", "", tos);
+    } else {
+      Frame &up = stack.back();
+      if (!up.hasKids && IsNumber(up.text) && stack.size() > 1 && !up.isStats) {
+        std::string labels;
+        if (!up.id.empty()) AddLabel(labels, "id", up.id);
+        exp.Add(up.name, labels, up.text);
+      }
+      up.hasKids = true;
+      f.id = up.id;
+      if (name == "stats") {
+        f.isStats = true;
+        std::string id = Attr(tag, "id");
+        if (stack.size() == 1) {
+          f.name = up.name + '_' + id;
+          Sanitize(f.name);
+        } else {
+          f.name = up.name;
+          f.id   = id;
+        }
+      } else {
+        f.name = up.name + '_' + name;
+        Sanitize(f.name);
+      }
+    }
+    stack.push_back(f);
+  }
+}
+
+/******************************************************************************/
+/* Private:                         L a t e n c y                             */
+/******************************************************************************/
+
+void XrdHttpMetrics::Latency(Exposition &exp)
+{
+  static const char *name = "xrootd_request_latency_seconds";
+  long long hist[XrdXrootdStats::latBkts], usec;
+  char val[64];
+
+  std::string &lines = exp.Family(name, "histogram");
+
+  // Buckets are reported at every power of two usec which keeps each
+  // histogram at 28 series; the last bucket also holds longer requests.
+  //
+  for (int op = 0; op < XrdXrootdStats::latOps; op++) {
+    if (!xrdXrootdStats->LatGet(op, hist, usec)) continue;
+    std::string opLabel;
+    AddLabel(opLabel, "op", XrdXrootdStats::LatName(op));
+    long long cum = 0;
+    for (int b = 0; b < XrdXrootdStats::latBkts; b++) {
+      cum += hist[b];
+      if ((b & 3) != 3 || b == XrdXrootdStats::latBkts - 1) continue;
+      snprintf(val, sizeof(val), "%.6f",
+               XrdXrootdStats::LatMax(b) / 1000000.0);
+      lines += name; lines += "_bucket{"; lines += opLabel;
+      lines += ",le=\""; lines += val; lines += "\"} ";
+      snprintf(val, sizeof(val), "%lld\n", cum);
+      lines += val;
+    }
+    lines += name; lines += "_bucket{"; lines += opLabel;
+    snprintf(val, sizeof(val), ",le=\"+Inf\"} %lld\n", cum);
+    lines += val;
+    lines += name; lines += "_sum{"; lines += opLabel;
+    snprintf(val, sizeof(val), "} %.6f\n", usec / 1000000.0);
+    lines += val;
+    lines += name; lines += "_count{"; lines += opLabel;
+    snprintf(val, sizeof(val), "} %lld\n", cum);
+    lines += val;
+  }
+}
+
+/******************************************************************************/
+/*                  X r d H t t p G e t E x t H a n d l e r                   */
+/******************************************************************************/
+
+extern "C"
+{
+XrdHttpExtHandler *XrdHttpGetExtHandler(XrdSysError *eDest, const char *confg,
+                                        const char *parms, XrdOucEnv *myEnv)
+{
+  XrdStats *sP = 0;
+  XrdXrootdStats *xP = 0;
+  const char *path = (parms && *parms ? parms : "/metrics");
+
+  if (myEnv) {
+    sP = (XrdStats *)myEnv->GetPtr("XrdStats*");
+    xP = (XrdXrootdStats *)myEnv->GetPtr("XrdXrootdStats*");
+  }
+  if (!sP) {
+    eDest->Emsg("Config", "Server statistics are not available to the "
+                "metrics handler.");
+    return 0;
+  }
+  if (*path != '/') {
+    eDest->Emsg("Config", "Invalid metrics path", path);
+    return 0;
+  }
+
+  if (!xP) eDest->Say("Config warning: xroot request latencies will not be "
+                      "exported as metrics.");
+  return new XrdHttpMetrics(sP, xP, path);
+}
+}
@@ -32,6 +32,7 @@
 #include "XrdOuc/XrdOucGMap.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdOuc/XrdOucPinLoader.hh"
+#include "XrdOuc/XrdOuca2x.hh"
 
 #include "XrdHttpTrace.hh"
 #include "XrdHttpProtocol.hh"
@@ -83,6 +84,10 @@ XrdOucHash<XrdHttpProtocol::StaticPreloadInfo> *XrdHttpProtocol::staticpreload =
 
 kXR_int32 XrdHttpProtocol::myRole = kXR_isManager;
 bool XrdHttpProtocol::selfhttps2http = false;
+bool XrdHttpProtocol::usektls = false;
+int  XrdHttpProtocol::sslsesscache = 20480;
+int  XrdHttpProtocol::sslsesstmo = 3600;
+bool XrdHttpProtocol::ssltickets = true;
 bool XrdHttpProtocol::isdesthttps = false;
 char *XrdHttpProtocol::sslcafile = 0;
 char *XrdHttpProtocol::secretkey = 0;
@@ -549,6 +554,26 @@ BIO *XrdHttpProtocol::CreateBIO(XrdLink *lp)
 #define TRACELINK Link
 
 int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
+{
+  int rc;
+
+  // A request that we answered on our own may have been pipelined with more
+  // requests that we already read. The poller will not tell us about those,
+  // so process them right away.
+  while ((rc = ProcessRequest(lp)) > 0
+  &&     CurrentReq.request == XrdHttpReq::rtUnset && BuffHasHeader()) {
+    TRACEI(REQ, " Processing pipelined request.");
+    lp = 0;
+  }
+
+  return rc;
+}
+
+/******************************************************************************/
+/*                        P r o c e s s R e q u e s t                         */
+/******************************************************************************/
+
+int XrdHttpProtocol::ProcessRequest(XrdLink *lp)
 {
   int rc = 0;
 
@@ -574,7 +599,9 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
   if (ishttps && !ssldone) {
 
       if (!ssl) {
-          sbio = CreateBIO(Link);
+          // The kernel can only take over encryption using a socket BIO
+          if (usektls) sbio = BIO_new_socket(Link->FDnum(), BIO_NOCLOSE);
+             else sbio = CreateBIO(Link);
           BIO_set_nbio(sbio, 1);
           ssl = SSL_new(sslctx);
         }
@@ -633,6 +660,20 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
 
       if (res != X509_V_OK) return -1;
       ssldone = true;
+      TRACEI(DEBUG, " TLS session " << (SSL_session_reused(ssl) ? "resumed" : "established"));
+
+      // See if the kernel now encrypts what we send. Let the admin know once
+      // should that not be the case.
+      if (usektls) {
+        static bool ktlsWarn = true;
+        ktlsSend = BIO_get_ktls_send(SSL_get_wbio(ssl));
+        TRACEI(DEBUG, " kTLS send " << (ktlsSend ? "enabled" : "unavailable"));
+        if (!ktlsSend && ktlsWarn) {
+          ktlsWarn = false;
+          eDest.Say("Warning: kernel TLS unavailable for ", Link->ID,
+                    "; using user-space TLS (is the tls module loaded?)");
+        }
+      }
     }
 
 
@@ -653,7 +694,12 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
       if (BuffUsed() < ResumeBytes) return 1;
 
 
-    } else
+    } else if (pipeWait) {
+      // We only wanted to see if a pipelined request can be started. That is
+      // not the case while the current one is still being answered.
+      pipeWait = false;
+      if (CurrentReq.request != XrdHttpReq::rtUnset) return 1;
+    } else if (CurrentReq.request != XrdHttpReq::rtUnset)
       CurrentReq.reqstate++;
   }
   DoingLogin = false;
@@ -663,12 +709,21 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
 
 
   if (!CurrentReq.headerok) {
+    char *line, save;
+
+    // Parse as many lines as possible. An empty line breaks. The lines are
+    // parsed in place in the buffer unless they wrap around its end.
+    while ((rc = BuffgetLine(line)) != 0) {
+      if (rc < 0) {
+        if ((rc = BuffgetLine(tmpline)) <= 0) break;
+        line = (char *)tmpline.c_str();
+      }
+      save = line[rc];
+      line[rc] = '\0';
+      TRACE(DEBUG, " rc:" << rc << " got hdr line: " << line);
 
-    // Read as many lines as possible into the buffer. An empty line breaks
-    while ((rc = BuffgetLine(tmpline)) > 0) {
-      TRACE(DEBUG, " rc:" << rc << " got hdr line: " << tmpline);
-
-      if ((rc == 2) && (tmpline[rc - 1] == '\n')) {
+      if ((rc == 2) && (line[rc - 1] == '\n')) {
+        line[rc] = save;
         CurrentReq.headerok = true;
         TRACE(DEBUG, " rc:" << rc << " detected header end.");
         break;
@@ -676,23 +731,22 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
 
 
       if (CurrentReq.request == CurrentReq.rtUnset) {
-        TRACE(DEBUG, " Parsing first line: " << tmpline);
-        int result = CurrentReq.parseFirstLine((char *)tmpline.c_str(), rc);
+        TRACE(DEBUG, " Parsing first line: " << line);
+        int result = CurrentReq.parseFirstLine(line, rc);
         if (result < 0) {
           TRACE(DEBUG, " Parsing of first line failed with " << result);
         }
       }
       else
-        CurrentReq.parseLine((char *)tmpline.c_str(), rc);
-
+        CurrentReq.parseLine(line, rc);
 
+      line[rc] = save;
     }
 
     // Here we have CurrentReq loaded with the header, or its relevant fields
 
     if (!CurrentReq.headerok) {
       TRACEI(REQ, " rc:" << rc << "Header not yet complete.");
-      CurrentReq.reqstate--;
       // Waiting for more data
       return 1;
     }
@@ -933,7 +987,14 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
   if (rc < 0)
      CurrentReq.reset();
 
-
+  // The client may have pipelined more requests that we already read. As the
+  // poller will not tell us about them, we have to ask to be called again once
+  // this request has been answered.
+  if (rc > 0 && CurrentReq.request != XrdHttpReq::rtUnset && BuffHasHeader()) {
+    TRACEI(REQ, " Pipelined request pending.");
+    pipeWait = true;
+    rc = 0;
+  }
 
   TRACEI(REQ, "Process is exiting rc:" << rc);
   return rc;
@@ -1071,6 +1132,8 @@ int XrdHttpProtocol::Config(const char *ConfigFN, XrdOucEnv *myEnv) {
       else if TS_Xeq("secxtractor", xsecxtractor);
       else if TS_Xeq3("exthandler", xexthandler);
       else if TS_Xeq("selfhttps2http", xselfhttps2http);
+      else if TS_Xeq("ktls", xktls);
+      else if TS_Xeq("tlsreuse", xtlsreuse);
       else if TS_Xeq("embeddedstatic", xembeddedstatic);
       else if TS_Xeq("listingredir", xlistredir);
       else if TS_Xeq("staticredir", xstaticredir);
@@ -1195,6 +1258,40 @@ int XrdHttpProtocol::BuffgetLine(XrdOucString &dest) {
   return 0;
 }
 
+int XrdHttpProtocol::BuffgetLine(char *&line) {
+
+  // Only a line that is contiguous and leaves room for a null byte after it
+  // can be used in place; anything else must be copied.
+  if (myBuffEnd < myBuffStart) return (BuffUsed() ? -1 : 0);
+
+  char *p = (char *)memchr(myBuffStart, '\n', myBuffEnd - myBuffStart);
+  if (!p) return 0;
+  if (p + 1 >= myBuff->buff + myBuff->bsize) return -1;
+
+  int l = p + 1 - myBuffStart;
+  line = myBuffStart;
+  BuffConsume(l);
+  return l;
+}
+
+bool XrdHttpProtocol::BuffHasHeader() {
+  char *p = myBuffStart, *bEnd = myBuff->buff + myBuff->bsize;
+  int n = BuffUsed(), l = 0;
+  bool cr = false;
+
+  // Look for a line that only has the CRLF, just as Process() does
+  while (n--) {
+    l++;
+    if (*p == '\n') {
+      if (l == 2 && cr) return true;
+      l = 0;
+    }
+    cr = (*p == '\r');
+    if (++p >= bEnd) p = myBuff->buff;
+  }
+  return false;
+}
+
 int XrdHttpProtocol::getDataOneShot(int blen, bool wait) {
   int rlen, maxread;
 
@@ -1397,6 +1494,31 @@ int XrdHttpProtocol::SendData(const char *body, int bodylen) {
   return 0;
 }
 
+int XrdHttpProtocol::SendData(const struct iovec *iov, int iovN) {
+
+  int bytes = 0;
+
+  for (int i = 0; i < iovN; i++) bytes += iov[i].iov_len;
+  if (!bytes) return 0;
+
+  TRACE(REQ, "Sending " << bytes << " bytes in " << iovN << " pieces");
+  if (ishttps) {
+    // There is no gather write for TLS, send the pieces one after the other
+    for (int i = 0; i < iovN; i++) {
+      if (!iov[i].iov_len) continue;
+      if (SSL_write(ssl, iov[i].iov_base, iov[i].iov_len) <= 0) {
+        ERR_print_errors(sslbio_err);
+        return -1;
+      }
+    }
+
+  } else {
+    if (Link->Send(iov, iovN, bytes) <= 0) return -1;
+  }
+
+  return 0;
+}
+
 int XrdHttpProtocol::StartSimpleResp(int code, const char *desc, const char *header_to_add, long long bodylen, bool keepalive) {
   std::stringstream ss;
   const std::string crlf = "\r\n";
@@ -1531,6 +1653,7 @@ int XrdHttpProtocol::Configure(char *parms, XrdProtocol_Config * pi) {
   pi->NetTCP->netIF.Display("Config ");
   pi->theEnv->PutPtr("XrdInet*", (void *)(pi->NetTCP));
   pi->theEnv->PutPtr("XrdNetIF*", (void *)(&(pi->NetTCP->netIF)));
+  pi->theEnv->PutPtr("XrdStats*", (void *)(pi->Stats));
 
   // Prohibit this program from executing as superuser
   //
@@ -1623,6 +1746,23 @@ extern "C" int verify_callback(int ok, X509_STORE_CTX * store) {
   return ok;
 }
 
+// We only speak HTTP/1.1. Saying so lets clients that offer several protocols
+// (e.g. h2 and http/1.1) settle on a persistent HTTP/1.1 connection right away.
+//
+#ifdef TLSEXT_TYPE_application_layer_protocol_negotiation
+extern "C" int alpn_callback(SSL *ssl, const unsigned char **out,
+                             unsigned char *outlen, const unsigned char *in,
+                             unsigned int inlen, void *arg) {
+  static const unsigned char protos[] = "\x08http/1.1";
+  unsigned char *sel;
+
+  if (SSL_select_next_proto(&sel, outlen, protos, sizeof(protos)-1, in, inlen)
+      != OPENSSL_NPN_NEGOTIATED) return SSL_TLSEXT_ERR_NOACK;
+  *out = sel;
+  return SSL_TLSEXT_ERR_OK;
+}
+#endif
+
 
 
 
@@ -1672,9 +1812,21 @@ int XrdHttpProtocol::InitSecurity() {
   sslctx = SSL_CTX_new((SSL_METHOD *)meth);
   //SSL_CTX_set_min_proto_version(sslctx, TLS1_2_VERSION);
   SSL_CTX_set_session_cache_mode(sslctx, SSL_SESS_CACHE_SERVER);
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+  if (usektls) SSL_CTX_set_options(sslctx, SSL_OP_ENABLE_KTLS);
+#endif
   SSL_CTX_set_session_id_context(sslctx, s_server_session_id_context,
           s_server_session_id_context_len);
 
+  // Returning clients resume their session instead of doing a full handshake,
+  // either from our cache or from a session ticket they hold.
+  SSL_CTX_sess_set_cache_size(sslctx, sslsesscache);
+  SSL_CTX_set_timeout(sslctx, sslsesstmo);
+  if (!ssltickets) SSL_CTX_set_options(sslctx, SSL_OP_NO_TICKET);
+#ifdef TLSEXT_TYPE_application_layer_protocol_negotiation
+  SSL_CTX_set_alpn_select_cb(sslctx, alpn_callback, 0);
+#endif
+
   /* An error write context */
   sslbio_err = BIO_new_fp(stderr, BIO_NOCLOSE);
 
@@ -1824,6 +1976,8 @@ void XrdHttpProtocol::Reset() {
   SecEntity.tident = XrdHttpSecEntityTident;
   ishttps = false;
   ssldone = false;
+  ktlsSend = false;
+  pipeWait = false;
 
   Bridge = 0;
   ssl = 0;
@@ -2380,6 +2534,112 @@ int XrdHttpProtocol::xselfhttps2http(XrdOucStream & Config) {
 
 
 
+/******************************************************************************/
+/*                                   x k t l s                                */
+/******************************************************************************/
+
+/* Function: xktls
+
+   Purpose:  To parse the directive: ktls <yes|no|0|1>
+
+             <val>    let the kernel encrypt data sent over HTTPS so that file
+                      data can be sent using sendfile()
+
+  Output: 0 upon success or !0 upon failure.
+ */
+
+int XrdHttpProtocol::xktls(XrdOucStream & Config) {
+  char *val;
+
+  // Get the flag
+  //
+  val = Config.GetWord();
+  if (!val || !val[0]) {
+    eDest.Emsg("Config", "ktls flag not specified");
+    return 1;
+  }
+
+  // Record the value
+  //
+  usektls = (!strcasecmp(val, "true") || !strcasecmp(val, "yes") || !strcmp(val, "1"));
+
+  // Kernel TLS requires OpenSSL 3.0 built with support for it
+  //
+#if !defined(SSL_OP_ENABLE_KTLS) || defined(OPENSSL_NO_KTLS)
+  if (usektls) {
+    eDest.Say("Config warning: kernel TLS is not supported by this OpenSSL; "
+              "using user-space TLS.");
+    usektls = false;
+  }
+#endif
+
+  return 0;
+}
+
+
+
+/******************************************************************************/
+/*                               x t l s r e u s e                            */
+/******************************************************************************/
+
+/* Function: xtlsreuse
+
+   Purpose:  To parse the directive: tlsreuse [cache <num>] [timeout <sec>]
+                                              [tickets {yes | no}]
+
+             cache    the maximum number of TLS sessions remembered so that
+                      returning clients can skip the full handshake.
+                      A value of 0 means no limit. The default is 20480.
+             timeout  the number of seconds a session may be resumed.
+                      The default is 3600.
+             tickets  whether clients may also resume sessions using session
+                      tickets. The default is yes.
+
+  Output: 0 upon success or !0 upon failure.
+ */
+
+int XrdHttpProtocol::xtlsreuse(XrdOucStream & Config) {
+  char *val;
+  int num;
+
+  if (!(val = Config.GetWord())) {
+    eDest.Emsg("Config", "tlsreuse parameter not specified");
+    return 1;
+  }
+
+  while (val) {
+    if (!strcmp(val, "cache")) {
+      if (!(val = Config.GetWord())) {
+        eDest.Emsg("Config", "tlsreuse cache value not specified");
+        return 1;
+      }
+      if (XrdOuca2x::a2i(eDest, "tlsreuse cache", val, &num, 0)) return 1;
+      sslsesscache = num;
+    } else if (!strcmp(val, "timeout")) {
+      if (!(val = Config.GetWord())) {
+        eDest.Emsg("Config", "tlsreuse timeout value not specified");
+        return 1;
+      }
+      if (XrdOuca2x::a2tm(eDest, "tlsreuse timeout", val, &num, 1)) return 1;
+      sslsesstmo = num;
+    } else if (!strcmp(val, "tickets")) {
+      if (!(val = Config.GetWord())) {
+        eDest.Emsg("Config", "tlsreuse tickets value not specified");
+        return 1;
+      }
+      ssltickets = (!strcasecmp(val, "true") || !strcasecmp(val, "yes") || !strcmp(val, "1"));
+    } else {
+      eDest.Emsg("Config", "invalid tlsreuse option -", val);
+      return 1;
+    }
+    val = Config.GetWord();
+  }
+
+  return 0;
+}
+
+
+
 /******************************************************************************/
 /*                            x s e c x t r a c t o r                         */
 /******************************************************************************/
@@ -139,6 +139,9 @@ private:
   /// Send some generic data to the client
   int SendData(const char *body, int bodylen);
 
+  /// Send a set of data pieces to the client with as few writes as possible
+  int SendData(const struct iovec *iov, int iovN);
+
   /// Deallocate resources, in order to reutilize an object of this class
   void Cleanup();
 
@@ -153,6 +156,9 @@ private:
   /// This primitive, for the way it is used, is not supposed to block
   int getDataOneShot(int blen, bool wait=false);
 
+  /// Process one request, or the next step of the current one
+  int ProcessRequest(XrdLink *lp);
+
   /// Create a new BIO object from an XrdLink.  Returns NULL on failure.
   static BIO *CreateBIO(XrdLink *lp);
   
@@ -169,6 +175,8 @@ private:
   static int xlistdeny(XrdOucStream &Config);
   static int xlistredir(XrdOucStream &Config);
   static int xselfhttps2http(XrdOucStream &Config);
+  static int xktls(XrdOucStream &Config);
+  static int xtlsreuse(XrdOucStream &Config);
   static int xembeddedstatic(XrdOucStream &Config);
   static int xstaticredir(XrdOucStream &Config);
   static int xstaticpreload(XrdOucStream &Config);
@@ -227,6 +235,11 @@ private:
   int BuffgetData(int blen, char **data, bool wait);
   /// Copy a full line of text from the buffer into dest. Zero if no line can be found in the buffer
   int BuffgetLine(XrdOucString &dest);
+  /// Point to a full line of text in the buffer, avoiding the copy. Zero if no line can be found
+  /// in the buffer, -1 if the line wraps around the buffer and must be copied
+  int BuffgetLine(char *&line);
+  /// Tells if a complete request header (i.e. up to the empty line) is in the buffer
+  bool BuffHasHeader();
 
   /// Sends a basic response. If the length is < 0 then it is calculated internally
   int SendSimpleResp(int code, const char *desc, const char *header_to_add, const char *body, long long bodylen, bool keepalive);
@@ -267,6 +280,12 @@ private:
   /// connection being established
   bool ssldone;
 
+  /// Tells that the kernel encrypts what we send, so sendfile can be used
+  bool ktlsSend;
+
+  /// Tells that we asked to be called again only to look for a pipelined request
+  bool pipeWait;
+
   static XrdCryptoFactory *myCryptoFactory;
 protected:
 
@@ -355,6 +374,14 @@ protected:
   
   /// If client is HTTPS, self-redirect with HTTP+token
   static bool selfhttps2http;
+
+  /// If true, let the kernel encrypt the data sent over HTTPS (kTLS)
+  static bool usektls;
+
+  /// Size of the TLS session cache, session lifetime and whether tickets are used
+  static int  sslsesscache;
+  static int  sslsesstmo;
+  static bool ssltickets;
   
   /// If true, use the embedded css and icons
   static bool embeddedstatic;
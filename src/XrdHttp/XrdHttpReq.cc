@@ -62,6 +62,9 @@
 #define MAX_TK_LEN      256
 #define MAX_RESOURCE_LEN 16384
 
+// The most we let the bridge read from the link for a single write
+#define MAX_DIRECT_WRITE (256*1024*1024)
+
 // This is to fix the trace macros
 #define TRACELINK prot->Link
 
@@ -145,12 +148,187 @@ int XrdHttpReq::parseBody(char *body, long long len) {
   return 1;
 }
 
+int XrdHttpReq::nextChunk() {
+  static const int maxLine = 4096;
+  XrdOucString tline;
+  char *line, *eol;
+  long long csz;
+  int rc;
+
+  while (chunkstate != ckDone) {
+
+    // Payload is written from where it sits, up to the end of the buffer
+    if (chunkstate == ckData) {
+      if (!chunkleft) {chunkstate = ckDataEnd; continue;}
+      int n = (prot->myBuffEnd >= prot->myBuffStart
+            ? prot->myBuffEnd - prot->myBuffStart
+            : prot->myBuff->buff + prot->myBuff->bsize - prot->myBuffStart);
+      if (n > chunkleft) n = (int)chunkleft;
+      if (!n) prot->ResumeBytes = min(chunkleft, (long long) prot->BuffAvailable());
+      return n;
+    }
+
+    // Everything else is a line
+    if ((rc = prot->BuffgetLine(line)) < 0) {
+      if ((rc = prot->BuffgetLine(tline)) > 0) line = (char *)tline.c_str();
+    }
+    if (rc <= 0) {
+      if (prot->BuffUsed() >= maxLine) return -1;
+      prot->ResumeBytes = prot->BuffUsed() + 1;
+      return 0;
+    }
+
+    switch (chunkstate) {
+      case ckSize:
+        if (!isxdigit(*line)) return -1;
+        csz = strtoll(line, &eol, 16);
+        if (csz < 0 || (*eol != ';' && *eol != '\r' && *eol != '\n'
+                                     && *eol != ' ' && *eol != '\t')) return -1;
+        TRACE(REQ, "Chunk of " << csz << " bytes");
+        chunkleft = csz;
+        chunkstate = (csz ? ckData : ckTrailer);
+        break;
+      case ckDataEnd:
+        if (*line != '\n' && (*line != '\r' || line[1] != '\n')) return -1;
+        chunkstate = ckSize;
+        break;
+      case ckTrailer:
+        // Trailer fields are of no interest, the empty line ends the body
+        if (*line == '\n' || (*line == '\r' && line[1] == '\n'))
+          chunkstate = ckDone;
+        break;
+      default:
+        return -1;
+    }
+  }
+
+  return 0;
+}
+
 XrdHttpReq::~XrdHttpReq() {
   //if (xmlbody) xmlFreeDoc(xmlbody);
 
   reset();
 }
 
+namespace
+{
+// The header lines that we look at. They are told apart by the length of the
+// name and, where that is not enough, by its first character.
+//
+enum hdrType {hdrOther = 0, hdrConnection, hdrHost, hdrRange, hdrContentLength,
+              hdrDestination, hdrWantDigest, hdrDepth, hdrExpect,
+              hdrTransferEncoding};
+
+struct hdrName {const char *name; hdrType type;};
+
+hdrType hdrLookup(const char *key, int klen)
+{
+  static const hdrName hdrConnNm = {"Connection",     hdrConnection};
+  static const hdrName hdrHostNm = {"Host",           hdrHost};
+  static const hdrName hdrRngNm  = {"Range",          hdrRange};
+  static const hdrName hdrCLenNm = {"Content-Length", hdrContentLength};
+  static const hdrName hdrDestNm = {"Destination",    hdrDestination};
+  static const hdrName hdrDigNm  = {"Want-Digest",    hdrWantDigest};
+  static const hdrName hdrDpthNm = {"Depth",          hdrDepth};
+  static const hdrName hdrExpNm  = {"Expect",         hdrExpect};
+  static const hdrName hdrTEncNm = {"Transfer-Encoding", hdrTransferEncoding};
+  const hdrName *hP;
+
+  switch (klen) {
+    case  4: hP = &hdrHostNm; break;
+    case  5: hP = ((*key | 0x20) == 'r' ? &hdrRngNm : &hdrDpthNm); break;
+    case  6: hP = &hdrExpNm; break;
+    case 10: hP = &hdrConnNm; break;
+    case 11: hP = ((*key | 0x20) == 'd' ? &hdrDestNm : &hdrDigNm); break;
+    case 14: hP = &hdrCLenNm; break;
+    case 17: hP = &hdrTEncNm; break;
+    default: return hdrOther;
+  }
+
+  return (strncasecmp(key, hP->name, klen) ? hdrOther : hP->type);
+}
+
+// Same for the request methods, which are case sensitive
+//
+XrdHttpReq::ReqType reqLookup(const char *key, int klen)
+{
+  struct reqName {const char *name; XrdHttpReq::ReqType type;};
+  static const reqName reqTab[] =
+         {{"GET",      XrdHttpReq::rtGET},    {"PUT",     XrdHttpReq::rtPUT},
+          {"HEAD",     XrdHttpReq::rtHEAD},   {"POST",    XrdHttpReq::rtPOST},
+          {"MOVE",     XrdHttpReq::rtMOVE},   {"PATCH",   XrdHttpReq::rtPATCH},
+          {"MKCOL",    XrdHttpReq::rtMKCOL},  {"DELETE",  XrdHttpReq::rtDELETE},
+          {"OPTIONS",  XrdHttpReq::rtOPTIONS},{"PROPFIND",XrdHttpReq::rtPROPFIND}};
+  int i, n;
+
+  switch (klen) {
+    case  3: i = 0; n = 2; break;
+    case  4: i = 2; n = 3; break;
+    case  5: i = 5; n = 2; break;
+    case  6: i = 7; n = 1; break;
+    case  7: i = 8; n = 1; break;
+    case  8: i = 9; n = 1; break;
+    default: return XrdHttpReq::rtUnknown;
+  }
+
+  for (n += i; i < n; i++)
+      if (!memcmp(key, reqTab[i].name, klen)) return reqTab[i].type;
+  return XrdHttpReq::rtUnknown;
+}
+
+// The multistatus element that wraps the PROPFIND response entries
+//
+const char propHead[] = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<D:multistatus xmlns:D=\"DAV:\" xmlns:ns1=\"http://apache.org/dav/props/\" xmlns:ns0=\"DAV:\">\n";
+const char propTail[] = "</D:multistatus>\n";
+const char propType[] = "Content-Type: text/xml; charset=\"utf-8\"";
+
+// Append to a PROPFIND response the element describing the entry 'name' in
+// directory 'dir' (or 'dir' itself when name is empty). Large listings have
+// many of these, so each one is formatted in one go from a template.
+//
+void propEntry(std::string &resp, const char *dir, const char *name,
+               long long size, long flags, time_t modtime)
+{
+  static const char fmt[] =
+    "<D:response xmlns:lp1=\"DAV:\" xmlns:lp2=\"http://apache.org/dav/props/\" xmlns:lp3=\"LCGDM:\">\n"
+    "<D:href>%s%s%s</D:href>\n"
+    "<D:propstat>\n<D:prop>\n"
+    "<lp1:getcontentlength>%lld</lp1:getcontentlength>\n"
+    "<lp1:getlastmodified>%s</lp1:getlastmodified>\n"
+    "%s%s"
+    "</D:prop>\n<D:status>HTTP/1.1 200 OK</D:status>\n</D:propstat>\n</D:response>\n";
+  static const char isDir[] = "<lp1:resourcetype><D:collection/></lp1:resourcetype>\n"
+                              "<lp1:iscollection>1</lp1:iscollection>\n";
+  static const char noDir[] = "<lp1:iscollection>0</lp1:iscollection>\n";
+  static const char isExe[] = "<lp1:executable>T</lp1:executable>\n"
+                              "<lp1:iscollection>1</lp1:iscollection>\n";
+  static const char noExe[] = "<lp1:executable>F</lp1:executable>\n";
+  static const int  eGuess = 1024;
+  const char *sep = (*name && *dir && dir[strlen(dir)-1] != '/' ? "/" : "");
+  const char *dirP = (flags & kXR_isDir ? isDir : noDir);
+  const char *exeP = (flags & kXR_xset  ? isExe : noExe);
+  size_t off = resp.size();
+  char mtime[64];
+  struct tm t1;
+  int n;
+
+  gmtime_r(&modtime, &t1);
+  strftime(mtime, sizeof(mtime), "%a, %d %b %Y %H:%M:%S GMT", &t1);
+
+  // Format the entry directly at the end of the response. Entries with very
+  // long names are formatted again once we know how much room they need.
+  //
+  resp.resize(off + eGuess);
+  n = snprintf(&resp[off], eGuess, fmt, dir, sep, name, size, mtime, dirP, exeP);
+  if (n >= eGuess) {
+    resp.resize(off + n + 1);
+    snprintf(&resp[off], n + 1, fmt, dir, sep, name, size, mtime, dirP, exeP);
+  }
+  resp.resize(off + n);
+}
+}
+
 int XrdHttpReq::parseLine(char *line, int len) {
 
   char *key = line;
@@ -177,9 +355,16 @@ int XrdHttpReq::parseLine(char *line, int len) {
   if (pos > 0) {
     line[pos] = 0;
     char *val = line + pos + 1;
+    char *vend = line + len;
 
-    // Trim left
+    // Trim left and right
     while ( (!isgraph(*val) || (!*val)) && (val < line+len)) val++;
+    while (vend > val && !isgraph(*(vend-1))) vend--;
+    int vlen = vend - val;
+
+    // We memorize the heaers also as a string
+    // because external plugins may need to process it differently
+    allheaders[key].assign(val, vlen);
 
     // Here we are supposed to initialize whatever flag or variable that is needed
     // by looking at the first token of the line
@@ -187,58 +372,56 @@ int XrdHttpReq::parseLine(char *line, int len) {
     // The value is val
     
     // Screen out the needed header lines
-    if (!strcmp(key, "Connection")) {
-
-      if (!strcasecmp(val, "Keep-Alive\r\n")) {
-        keepalive = true;
-      } else if (!strcasecmp(val, "close\r\n")) {
-        keepalive = false;
-      }
-
-    } else if (!strcmp(key, "Host")) {
-      parseHost(val);
-    } else if (!strcmp(key, "Range")) {
-      parseContentRange(val);
-    } else if (!strcmp(key, "Content-Length")) {
-      length = atoll(val);
-
-    } else if (!strcmp(key, "Destination")) {
-      destination.assign(val, line+len-val);
-      trim(destination);
-    } else if (!strcmp(key, "Want-Digest")) {
-      m_req_digest.assign(val, line + len - val);
-      trim(m_req_digest);
-    } else if (!strcmp(key, "Depth")) {
-      depth = -1;
-      if (strcmp(val, "infinity"))
-        depth = atoll(val);
-
-    } else if (!strcmp(key, "Expect") && strstr(val, "100-continue")) {
-      sendcontinue = true;
-    } else {
-      // Some headers need to be translated into "local" cgi info. In theory they should already be quoted
-      std::map< std:: string, std:: string > ::iterator it = prot->hdr2cgimap.find(key);
-      if (it != prot->hdr2cgimap.end()) {
-        std:: string s;
-        s.assign(val, line+len-val);
-        trim(s);
-        
-        if (hdr2cgistr.length() > 0) {
-          hdr2cgistr.append("&");
+    switch (hdrLookup(key, pos)) {
+      case hdrConnection:
+        if (vlen == 10 && !strncasecmp(val, "Keep-Alive", 10)) {
+          keepalive = true;
+        } else if (vlen == 5 && !strncasecmp(val, "close", 5)) {
+          keepalive = false;
         }
-        hdr2cgistr.append(it->second);
-        hdr2cgistr.append("=");
-        hdr2cgistr.append(s);
-        
-          
-      }
+        break;
+      case hdrHost:
+        parseHost(val);
+        break;
+      case hdrRange:
+        parseContentRange(val);
+        break;
+      case hdrContentLength:
+        length = atoll(val);
+        break;
+      case hdrDestination:
+        destination.assign(val, vlen);
+        break;
+      case hdrWantDigest:
+        m_req_digest.assign(val, vlen);
+        break;
+      case hdrDepth:
+        depth = -1;
+        if (strcmp(val, "infinity"))
+          depth = atoll(val);
+        break;
+      case hdrExpect:
+        if (strstr(val, "100-continue")) sendcontinue = true;
+        break;
+      case hdrTransferEncoding:
+        if (strcasestr(val, "chunked")) chunkstate = ckSize;
+        break;
+      default:
+        // Some headers need to be translated into "local" cgi info. In theory they should already be quoted
+        if (!prot->hdr2cgimap.empty()) {
+          std::map< std:: string, std:: string > ::iterator it = prot->hdr2cgimap.find(key);
+          if (it != prot->hdr2cgimap.end()) {
+            if (hdr2cgistr.length() > 0) {
+              hdr2cgistr.append("&");
+            }
+            hdr2cgistr.append(it->second);
+            hdr2cgistr.append("=");
+            hdr2cgistr.append(val, vlen);
+          }
+        }
+        break;
     }
 
-    // We memorize the heaers also as a string
-    // because external plugins may need to process it differently
-    std::string ss = val;
-    trim(ss);
-    allheaders[key] = ss;
     line[pos] = ':';
   }
 
@@ -381,31 +564,7 @@ int XrdHttpReq::parseFirstLine(char *line, int len) {
     *p = ' ';
 
     // Xlate the known header lines
-    if (!strcmp(key, "GET")) {
-      request = rtGET;
-    } else if (!strcmp(key, "HEAD")) {
-      request = rtHEAD;
-    } else if (!strcmp(key, "PUT")) {
-      request = rtPUT;
-    } else if (!strcmp(key, "POST")) {
-      request = rtPOST;
-    } else if (!strcmp(key, "PATCH")) {
-      request = rtPATCH;
-    } else if (!strcmp(key, "OPTIONS")) {
-      request = rtOPTIONS;
-    } else if (!strcmp(key, "DELETE")) {
-      request = rtDELETE;
-    } else if (!strcmp(key, "PROPFIND")) {
-      request = rtPROPFIND;
-
-    } else if (!strcmp(key, "MKCOL")) {
-      request = rtMKCOL;
-
-    } else if (!strcmp(key, "MOVE")) {
-      request = rtMOVE;
-    } else {
-      request = rtUnknown;
-    }
+    request = reqLookup(key, pos);
     
     requestverb = key;
 
@@ -413,6 +572,7 @@ int XrdHttpReq::parseFirstLine(char *line, int len) {
     // keepalive is disabled by default.
     if (!strcmp(p+1, "HTTP/1.0\r\n")) {
       keepalive = false;
+      http10 = true;
     }
     line[pos] = ' ';
   }
@@ -476,11 +636,22 @@ int XrdHttpReq::ReqReadV() {
     if (rwOps_split[i].bytestart > filesize) continue;
     if (rwOps_split[i].byteend > filesize - 1) rwOps_split[i].byteend = filesize - 1;
 
+    int len = rwOps_split[i].byteend - rwOps_split[i].bytestart + 1;
+    total_len += len;
+
+    // Ranges that follow each other are read as one element, the response
+    // is carved back into the requested parts when it is sent
+    if (j > 0 && len > 0 && ralist[j-1].rlen > 0
+        && ralist[j-1].offset + ralist[j-1].rlen == rwOps_split[i].bytestart
+        && ralist[j-1].rlen + len <= READV_MAXCHUNKSIZE) {
+      ralist[j-1].rlen += len;
+      continue;
+    }
+
     memcpy(&(ralist[j].fhandle), this->fhandle, 4);
 
     ralist[j].offset = rwOps_split[i].bytestart;
-    ralist[j].rlen = rwOps_split[i].byteend - rwOps_split[i].bytestart + 1;
-    total_len += ralist[j].rlen;
+    ralist[j].rlen = len;
     j++;
   }
 
@@ -501,22 +672,98 @@ int XrdHttpReq::ReqReadV() {
   return (j * sizeof (struct readahead_list));
 }
 
-std::string XrdHttpReq::buildPartialHdr(long long bytestart, long long byteend, long long fsz, char *token) {
-  ostringstream s;
+int XrdHttpReq::buildPartialHdr(char *buff, int blen, long long bytestart, long long byteend, long long fsz, const char *token) {
+
+  return snprintf(buff, blen, "\r\n--%s\r\n"
+                  "Content-type: text/plain; charset=UTF-8\r\n"
+                  "Content-range: bytes %lld-%lld/%lld\r\n\r\n",
+                  token, bytestart, byteend, fsz);
+}
 
-  s << "\r\n--" << token << "\r\n";
-  s << "Content-type: text/plain; charset=UTF-8\r\n";
-  s << "Content-range: bytes " << bytestart << "-" << byteend << "/" << fsz << "\r\n\r\n";
+int XrdHttpReq::buildPartialHdrEnd(char *buff, int blen, const char *token) {
 
-  return s.str();
+  return snprintf(buff, blen, "\r\n--%s--\r\n", token);
 }
 
-std::string XrdHttpReq::buildPartialHdrEnd(char *token) {
-  ostringstream s;
+int XrdHttpReq::sendReadVParts() {
+  static const int maxIOV = 64; // Pieces handed to a single write
+  static const int hdrSz = 160; // Large enough for any part header
+  struct iovec iov[maxIOV];
+  char hdrs[maxIOV / 2][hdrSz];
+  readahead_list *l;
+  char *p, *pend;
+  long long plen, k;
+  int len, n = 0, h = 0;
+
+  // Cycle on all the data that is coming from the server. As adjacent ranges
+  // were merged into a single readv element, a chunk may carry the data of
+  // more than one of the original ranges and a range may span many chunks.
+  // The part headers and the data slices, which stay in the response buffer,
+  // are gathered and written out together.
+  for (int i = 0; i < iovN; i++) {
+    p = (char *) iovP[i].iov_base;
+    pend = p + iovP[i].iov_len;
+    while (p < pend) {
+      l = (readahead_list *) p;
+      len = ntohl(l->rlen);
+      p += sizeof (readahead_list);
+
+      do {
+        // Skip the ranges that start beyond the end of the file
+        while (rwOpDone < rwOps.size() && rwOps[rwOpDone].bytestart > filesize) rwOpDone++;
+        if (rwOpDone >= rwOps.size()) break;
+
+        // Make sure that we have room for a header and a slice
+        if (n > maxIOV - 2 || h >= maxIOV / 2) {
+          if (prot->SendData(iov, n)) return -1;
+          n = h = 0;
+        }
+
+        ReadWriteOp &op = rwOps[rwOpDone];
+        plen = op.byteend - op.bytestart + 1;
+        if (!len && plen > 0) break;
+        if (rwOpPartialDone == 0) {
+          TRACEI(REQ, "Sending multipart: " << op.bytestart << "-" << op.byteend);
+          iov[n].iov_base = hdrs[h];
+          iov[n++].iov_len = buildPartialHdr(hdrs[h++], hdrSz, op.bytestart,
+                  op.byteend, filesize, "123456");
+        }
 
-  s << "\r\n--" << token << "--\r\n";
+        // Add the data relative to the current original range that we have
+        k = std::min((long long) len, plen - rwOpPartialDone);
+        if (k > 0) {
+          iov[n].iov_base = p;
+          iov[n++].iov_len = k;
+          p += k;
+          len -= k;
+          rwOpPartialDone += k;
+        }
+
+        // If we have all the data relative to the current original range
+        // then pass to the next one, otherwise wait for more data
+        if (rwOpPartialDone >= plen) {
+          rwOpDone++;
+          rwOpPartialDone = 0;
+        }
+      } while (len > 0);
+
+      // Whatever exceeds the ranges we were asked for is not sent
+      p += len;
+    }
+  }
+
+  while (rwOpDone < rwOps.size() && rwOps[rwOpDone].bytestart > filesize) rwOpDone++;
+  if (rwOpDone == rwOps.size()) {
+    if (n >= maxIOV || h >= maxIOV / 2) {
+      if (prot->SendData(iov, n)) return -1;
+      n = h = 0;
+    }
+    iov[n].iov_base = hdrs[h];
+    iov[n++].iov_len = buildPartialHdrEnd(hdrs[h++], hdrSz, "123456");
+    rwOpDone++;
+  }
 
-  return s.str();
+  return (n ? prot->SendData(iov, n) : 0);
 }
 
 bool XrdHttpReq::Data(XrdXrootd::Bridge::Context &info, //!< the result context
@@ -1108,7 +1355,7 @@ int XrdHttpReq::ProcessHTTPReq() {
             xrdreq.open.mode = 0;
             xrdreq.open.options = htons(kXR_retstat | kXR_open_read);
 
-            if (!prot->Bridge->Run((char *) &xrdreq, (char *) resourceplusopaque.c_str(), l)) {
+            if (!prot->Bridge->Run((char *) &xrdreq, (char *) resourceplusopaque.c_str(), l, true)) {
               prot->SendSimpleResp(404, NULL, NULL, (char *) "Could not run request.", 0, false);
               return -1;
             }
@@ -1170,7 +1417,7 @@ int XrdHttpReq::ProcessHTTPReq() {
               xrdreq.read.rlen = htonl(l);
             }
 
-            if (prot->ishttps) {
+            if (prot->ishttps && !prot->ktlsSend) {
               if (!prot->Bridge->setSF((kXR_char *) fhandle, false)) {
                 TRACE(REQ, " XrdBridge::SetSF(false) failed.");
 
@@ -1207,7 +1454,7 @@ int XrdHttpReq::ProcessHTTPReq() {
 
             length = ReqReadV();
 
-            if (!prot->Bridge->Run((char *) &xrdreq, (char *) ralist, length)) {
+            if (!prot->Bridge->Run((char *) &xrdreq, (char *) ralist, length, true)) {
               prot->SendSimpleResp(404, NULL, NULL, (char *) "Could not run read request.", 0, false);
               return -1;
             }
@@ -1233,6 +1480,14 @@ int XrdHttpReq::ProcessHTTPReq() {
       if (!fopened) {
 
         // --------- OPEN for write!
+        // A body of known length lets the storage reserve the space up front
+        if (chunkstate == ckNone && length > 0 && resourceplusopaque.find("oss.asize=") == STR_NPOS) {
+          char asz[48];
+          snprintf(asz, sizeof(asz), "%soss.asize=%lld",
+                   (resourceplusopaque.find('?') == STR_NPOS ? "?" : "&"), length);
+          resourceplusopaque.append(asz);
+        }
+
         memset(&xrdreq, 0, sizeof (ClientRequest));
         xrdreq.open.requestid = htons(kXR_open);
         l = resourceplusopaque.length() + 1;
@@ -1240,24 +1495,59 @@ int XrdHttpReq::ProcessHTTPReq() {
         xrdreq.open.mode = htons(kXR_ur | kXR_uw | kXR_gw | kXR_gr | kXR_or);
         xrdreq.open.options = htons(kXR_mkpath | kXR_open_wrto | kXR_delete);
 
-        if (!prot->Bridge->Run((char *) &xrdreq, (char *) resourceplusopaque.c_str(), l)) {
+        if (!prot->Bridge->Run((char *) &xrdreq, (char *) resourceplusopaque.c_str(), l, true)) {
           prot->SendSimpleResp(404, NULL, NULL, (char *) "Could not run request.", 0, keepalive);
           return -1;
         }
 
 
         // We want to be invoked again after this request is finished
-        // Only if there is data to fetch from the socket
-        if (prot->BuffUsed() > 0)
+        // Only if there is data to fetch from the socket. Over plain http a
+        // body of known length can be read by the bridge, so go on anyway.
+        if (prot->BuffUsed() > 0 || (!prot->ishttps && chunkstate == ckNone))
           return 0;
 
         return 1;
 
       } else {
 
-        // Check if we have finished
-        if (writtenbytes < length) {
+        // A chunked body is written a chunk at a time straight out of our
+        // buffer; the chunk framing is skipped over.
+        if (chunkstate != ckNone) {
+          int n = nextChunk();
+
+          if (n < 0) {
+            prot->SendSimpleResp(400, (char *) "Bad Request", NULL, (char *) "Invalid chunked request body.", 0, false);
+            return -1;
+          }
 
+          if (n > 0) {
+            // --------- WRITE
+            memset(&xrdreq, 0, sizeof (xrdreq));
+            xrdreq.write.requestid = htons(kXR_write);
+            memcpy(xrdreq.write.fhandle, fhandle, 4);
+            xrdreq.write.offset = htonll(writtenbytes);
+            xrdreq.write.dlen = htonl(n);
+            bufwrite = n;
+
+            TRACEI(REQ, "Writing chunk data " << n);
+            if (!prot->Bridge->Run((char *) &xrdreq, prot->myBuffStart, n)) {
+              prot->SendSimpleResp(404, NULL, NULL, (char *) "Could not run write request.", 0, false);
+              return -1;
+            }
+
+            // Look for more data as soon as this has been written
+            return 0;
+          }
+
+          // Wait for more data unless we have seen the end of the body
+          if (chunkstate != ckDone) return 1;
+        }
+
+        // Check if we have finished
+        if (chunkstate == ckNone && writtenbytes < length) {
+          long long left = length - writtenbytes;
+          int inbuff = prot->BuffUsed();
 
           // --------- WRITE
           memset(&xrdreq, 0, sizeof (xrdreq));
@@ -1266,15 +1556,37 @@ int XrdHttpReq::ProcessHTTPReq() {
 
 
           xrdreq.write.offset = htonll(writtenbytes);
-          xrdreq.write.dlen = htonl(prot->BuffUsed());
 
-          TRACEI(REQ, "Writing " << prot->BuffUsed());
-          if (!prot->Bridge->Run((char *) &xrdreq, prot->myBuffStart, prot->BuffUsed())) {
+          // Over plain http we let the bridge read the body from the link once
+          // our buffer is empty. It then reads in large pieces and may have
+          // several asynchronous writes in flight while reading the rest.
+          if (!prot->ishttps && !inbuff) {
+            int dlen = (left > MAX_DIRECT_WRITE ? MAX_DIRECT_WRITE : (int)left);
+            xrdreq.write.dlen = htonl(dlen);
+            bufwrite = 0;
+
+            TRACEI(REQ, "Writing " << dlen << " directly from the link");
+            if (!prot->Bridge->Run((char *) &xrdreq, 0, 0)) {
+              prot->SendSimpleResp(404, NULL, NULL, (char *) "Could not run write request.", 0, false);
+              return -1;
+            }
+
+            // Go on with the next write or the close once this is done
+            return 0;
+          }
+
+          // The buffer may already hold the start of a following request
+          if (inbuff > left) inbuff = (int)left;
+          xrdreq.write.dlen = htonl(inbuff);
+          bufwrite = inbuff;
+
+          TRACEI(REQ, "Writing " << inbuff);
+          if (!prot->Bridge->Run((char *) &xrdreq, prot->myBuffStart, inbuff)) {
             prot->SendSimpleResp(404, NULL, NULL, (char *) "Could not run write request.", 0, false);
             return -1;
           }
 
-          if (writtenbytes + prot->BuffUsed() >= length)
+          if (!prot->ishttps || writtenbytes + inbuff >= length)
             // Trigger an immediate recall after this request has finished
             return 0;
           else
@@ -1332,7 +1644,7 @@ int XrdHttpReq::ProcessHTTPReq() {
           l = resourceplusopaque.length() + 1;
           xrdreq.stat.dlen = htonl(l);
 
-          if (!prot->Bridge->Run((char *) &xrdreq, (char *) resourceplusopaque.c_str(), l)) {
+          if (!prot->Bridge->Run((char *) &xrdreq, (char *) resourceplusopaque.c_str(), l, true)) {
             prot->SendSimpleResp(501, NULL, NULL, (char *) "Could not run request.", 0, false);
             return -1;
           }
@@ -1426,7 +1738,7 @@ int XrdHttpReq::ProcessHTTPReq() {
           l = resourceplusopaque.length() + 1;
           xrdreq.stat.dlen = htonl(l);
 
-          if (!prot->Bridge->Run((char *) &xrdreq, (char *) resourceplusopaque.c_str(), l)) {
+          if (!prot->Bridge->Run((char *) &xrdreq, (char *) resourceplusopaque.c_str(), l, true)) {
             prot->SendSimpleResp(501, NULL, NULL, (char *) "Could not run request.", 0, false);
             return -1;
           }
@@ -1934,7 +2246,8 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
               } else
                 if (rwOps.size() > 1) {
                 // Multiple reads to perform, compose and send the header
-                int cnt = 0;
+                char hdr[160];
+                long long cnt = 0;
                 for (size_t i = 0; i < rwOps.size(); i++) {
 
                   if (rwOps[i].bytestart > filesize) continue;
@@ -1943,12 +2256,13 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
 
                   cnt += (rwOps[i].byteend - rwOps[i].bytestart + 1);
 
-                  cnt += buildPartialHdr(rwOps[i].bytestart,
+                  cnt += buildPartialHdr(hdr, sizeof (hdr),
+                          rwOps[i].bytestart,
                           rwOps[i].byteend,
                           filesize,
-                          (char *) "123456").size();
+                          "123456");
                 }
-                cnt += buildPartialHdrEnd((char *) "123456").size();
+                cnt += buildPartialHdrEnd(hdr, sizeof (hdr), "123456");
 
                 prot->SendSimpleResp(206, NULL, (char *) "Content-Type: multipart/byteranges; boundary=123456", NULL, cnt, keepalive);
                 return 0;
@@ -1997,56 +2311,13 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
             TRACEI(REQ, "Got data vectors to send:" << iovN);
             if (ntohs(xrdreq.header.requestid) == kXR_readv) {
               // Readv case, we must take out each individual header and format it according to the http rules
-              readahead_list *l;
-              char *p;
-              int len;
-
-              // Cycle on all the data that is coming from the server
-              for (int i = 0; i < iovN; i++) {
-
-                for (p = (char *) iovP[i].iov_base; p < (char *) iovP[i].iov_base + iovP[i].iov_len;) {
-                  l = (readahead_list *) p;
-                  len = ntohl(l->rlen);
-
-                  // Now we have a chunk coming from the server. This may be a partial chunk
-
-                  if (rwOpPartialDone == 0) {
-                    string s = buildPartialHdr(rwOps[rwOpDone].bytestart,
-                            rwOps[rwOpDone].byteend,
-                            filesize,
-                            (char *) "123456");
-
-                    TRACEI(REQ, "Sending multipart: " << rwOps[rwOpDone].bytestart << "-" << rwOps[rwOpDone].byteend);
-                    if (prot->SendData((char *) s.c_str(), s.size())) return -1;
-                  }
-
-                  // Send all the data we have
-                  if (prot->SendData(p + sizeof (readahead_list), len)) return -1;
-
-                  // If we sent all the data relative to the current original chunk request
-                  // then pass to the next chunk, otherwise wait for more data
-                  rwOpPartialDone += len;
-                  if (rwOpPartialDone >= rwOps[rwOpDone].byteend - rwOps[rwOpDone].bytestart + 1) {
-                    rwOpDone++;
-                    rwOpPartialDone = 0;
-                  }
-
-                  p += sizeof (readahead_list);
-                  p += len;
-
-                }
-              }
+              if (sendReadVParts()) return -1;
 
-              if (rwOpDone == rwOps.size()) {
-                string s = buildPartialHdrEnd((char *) "123456");
-                if (prot->SendData((char *) s.c_str(), s.size())) return -1;
-              }
-
-            } else
-              for (int i = 0; i < iovN; i++) {
-                if (prot->SendData((char *) iovP[i].iov_base, iovP[i].iov_len)) return -1;
-                writtenbytes += iovP[i].iov_len;
-              }
+            } else {
+              // Send the data right out of the server's buffers in one go
+              if (prot->SendData(iovP, iovN)) return -1;
+              for (int i = 0; i < iovN; i++) writtenbytes += iovP[i].iov_len;
+            }
               
             // Let's make sure that we avoid sending the same data twice,
             // in the case where PostProcessHTTPReq is invoked again
@@ -2097,12 +2368,14 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
         if (ntohs(xrdreq.header.requestid) == kXR_write) {
           int l = ntohl(xrdreq.write.dlen);
 
-          // Consume the written bytes
-          prot->BuffConsume(ntohl(xrdreq.write.dlen));
+          // Consume the written bytes that came from our buffer
+          prot->BuffConsume(bufwrite);
           writtenbytes += l;
+          if (chunkstate == ckData) chunkleft -= l;
 
           // We try to completely fill up our buffer before flushing
-          prot->ResumeBytes = min(length - writtenbytes, (long long) prot->BuffAvailable());
+          if (chunkstate == ckNone)
+            prot->ResumeBytes = min(length - writtenbytes, (long long) prot->BuffAvailable());
 
           return 0;
         }
@@ -2180,6 +2453,8 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
     {
 
       if (xrdresp == kXR_error) {
+        // Once the listing is being streamed all we can do is drop the link
+        if (chunkedresp) return -1;
         prot->SendSimpleResp(httpStatusCode, NULL, NULL,
                              httpStatusText.c_str(), httpStatusText.length(), false);
         return -1;
@@ -2206,59 +2481,15 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
                     &e.modtime);
 
             if (e.path.length() && (e.path != ".") && (e.path != "..")) {
-              /* The entry is filled. */
-
-
-              string p;
-              stringresp += "<D:response xmlns:lp1=\"DAV:\" xmlns:lp2=\"http://apache.org/dav/props/\" xmlns:lp3=\"LCGDM:\">\n";
-              stringresp += "<D:href>" + e.path + "</D:href>\n";
-              stringresp += "<D:propstat>\n<D:prop>\n";
-
-              // Now add the properties that we have to add
-
-              // File size
-              stringresp += "<lp1:getcontentlength>";
-              stringresp += itos(e.size);
-              stringresp += "</lp1:getcontentlength>\n";
-
-
-
-              stringresp += "<lp1:getlastmodified>";
-              stringresp += ISOdatetime(e.modtime);
-              stringresp += "</lp1:getlastmodified>\n";
-
-
-
-              if (e.flags & kXR_isDir) {
-                stringresp += "<lp1:resourcetype><D:collection/></lp1:resourcetype>\n";
-                stringresp += "<lp1:iscollection>1</lp1:iscollection>\n";
-              } else {
-                stringresp += "<lp1:iscollection>0</lp1:iscollection>\n";
-              }
-
-              if (e.flags & kXR_xset) {
-                stringresp += "<lp1:executable>T</lp1:executable>\n";
-                stringresp += "<lp1:iscollection>1</lp1:iscollection>\n";
-              } else {
-                stringresp += "<lp1:executable>F</lp1:executable>\n";
-              }
-
-
-
-              stringresp += "</D:prop>\n<D:status>HTTP/1.1 200 OK</D:status>\n</D:propstat>\n</D:response>\n";
-
-
+              propEntry(stringresp, e.path.c_str(), "", e.size, e.flags, e.modtime);
             }
-
-
           }
 
           // If this was the last bunch of entries, send the buffer and empty it immediately
           if (depth == 0) {
-            string s = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<D:multistatus xmlns:D=\"DAV:\" xmlns:ns1=\"http://apache.org/dav/props/\" xmlns:ns0=\"DAV:\">\n";
-            stringresp.insert(0, s);
-            stringresp += "</D:multistatus>\n";
-            prot->SendSimpleResp(207, (char *) "Multi-Status", (char *) "Content-Type: text/xml; charset=\"utf-8\"",
+            stringresp.insert(0, propHead);
+            stringresp += propTail;
+            prot->SendSimpleResp(207, (char *) "Multi-Status", propType,
                     (char *) stringresp.c_str(), stringresp.length(), keepalive);
             stringresp.clear();
             return keepalive ? 1 : -1;
@@ -2298,65 +2529,10 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
 
 
               if (e.path.length() && (e.path != ".") && (e.path != "..")) {
-                /* The entry is filled.
-          
-                  <D:response xmlns:lp1="DAV:" xmlns:lp2="http://apache.org/dav/props/" xmlns:lp3="LCGDM:">
-                      <D:href>/dpm/cern.ch/home/testers2.eu-emi.eu/</D:href>
-                      <D:propstat>
-                          <D:prop>
-                              <lp1:getcontentlength>1</lp1:getcontentlength>
-                              <lp1:getlastmodified>Tue, 01 May 2012 02:42:13 GMT</lp1:getlastmodified>
-                              <lp1:resourcetype>
-                                <D:collection/>
-                              </lp1:resourcetype>
-                          </D:prop>
-                      <D:status>HTTP/1.1 200 OK</D:status>
-                      </D:propstat>
-                  </D:response>
-                 */
-
-
-                string p = resource.c_str();
-                if (*p.rbegin() != '/') p += "/";
-                p += e.path;
-                stringresp += "<D:response xmlns:lp1=\"DAV:\" xmlns:lp2=\"http://apache.org/dav/props/\" xmlns:lp3=\"LCGDM:\">\n";
-                stringresp += "<D:href>" + p + "</D:href>\n";
-                stringresp += "<D:propstat>\n<D:prop>\n";
-
-
-
-                // Now add the properties that we have to add
-
-                // File size
-                stringresp += "<lp1:getcontentlength>";
-                stringresp += itos(e.size);
-                stringresp += "</lp1:getcontentlength>\n";
-
-                stringresp += "<lp1:getlastmodified>";
-                stringresp += ISOdatetime(e.modtime);
-                stringresp += "</lp1:getlastmodified>\n";
-
-                if (e.flags & kXR_isDir) {
-                  stringresp += "<lp1:resourcetype><D:collection/></lp1:resourcetype>\n";
-                  stringresp += "<lp1:iscollection>1</lp1:iscollection>\n";
-                } else {
-                  stringresp += "<lp1:iscollection>0</lp1:iscollection>\n";
-                }
-
-                if (e.flags & kXR_xset) {
-                  stringresp += "<lp1:executable>T</lp1:executable>\n";
-                  stringresp += "<lp1:iscollection>1</lp1:iscollection>\n";
-                } else {
-                  stringresp += "<lp1:executable>F</lp1:executable>\n";
-                }
-
-                stringresp += "</D:prop>\n<D:status>HTTP/1.1 200 OK</D:status>\n</D:propstat>\n</D:response>\n";
-
-
+                propEntry(stringresp, resource.c_str(), e.path.c_str(),
+                          e.size, e.flags, e.modtime);
               }
 
-
-
               if (endp) {
                   char *pp = (char *)strchr((const char *)endp, '\n');
                   if (pp) startp = pp+1;
@@ -2370,15 +2546,33 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
 
           // If this was the last bunch of entries, send the buffer and empty it immediately
           if (final_) {
-            string s = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<D:multistatus xmlns:D=\"DAV:\" xmlns:ns1=\"http://apache.org/dav/props/\" xmlns:ns0=\"DAV:\">\n";
-            stringresp.insert(0, s);
-            stringresp += "</D:multistatus>\n";
-            prot->SendSimpleResp(207, (char *) "Multi-Status", (char *) "Content-Type: text/xml; charset=\"utf-8\"",
-                    (char *) stringresp.c_str(), stringresp.length(), keepalive);
+            stringresp += propTail;
+            if (chunkedresp) {
+              if (prot->ChunkResp(stringresp.c_str(), stringresp.length())
+              ||  prot->ChunkResp(0, 0)) return -1;
+            } else {
+              stringresp.insert(0, propHead);
+              prot->SendSimpleResp(207, (char *) "Multi-Status", propType,
+                      (char *) stringresp.c_str(), stringresp.length(), keepalive);
+            }
             stringresp.clear();
             return keepalive ? 1 : -1;
           }
 
+          // More entries are coming. Send what we have so that the client sees
+          // the first entries right away and we need not keep the whole listing
+          // in memory. HTTP/1.0 clients do not understand chunked responses.
+          if (!http10 && !stringresp.empty()) {
+            if (!chunkedresp) {
+              stringresp.insert(0, propHead);
+              if (prot->StartChunkedResp(207, "Multi-Status", propType, keepalive))
+                return -1;
+              chunkedresp = true;
+            }
+            if (prot->ChunkResp(stringresp.c_str(), stringresp.length())) return -1;
+            stringresp.clear();
+          }
+
           break;
         } // default reqstate
       } // switch reqstate
@@ -2475,8 +2669,12 @@ void XrdHttpReq::reset() {
   keepalive = true;
   length = 0;
   filesize = 0;
-  depth = 0;
   sendcontinue = false;
+  http10 = false;
+  chunkstate = ckNone;
+  chunkleft = 0;
+  bufwrite = 0;
+  chunkedresp = false;
 
 
   /// State machine to talk to the bridge
@@ -2484,10 +2682,6 @@ void XrdHttpReq::reset() {
 
   memset(&xrdreq, 0, sizeof (xrdreq));
   memset(&xrdresp, 0, sizeof (xrdresp));
-  xrderrcode = kXR_noErrorYet;
-
-  etext.clear();
-  redirdest = "";
 
   stringresp = "";
 
@@ -93,6 +93,11 @@ private:
 
   void getfhandle();
 
+  /// Find the next piece of payload of a chunked request body, consuming the
+  /// chunk framing before it. Returns the number of payload bytes available
+  /// at the start of the buffer, 0 if more data is needed, -1 on bad framing.
+  int nextChunk();
+
   /// Cook and send the response after the bridge did something
   /// Return values:
   ///  0->everything OK, additionsl steps may be required
@@ -136,11 +141,14 @@ public:
   int ReqReadV();
   readahead_list *ralist;
 
-  /// Build a partial header for a multipart response
-  std::string buildPartialHdr(long long bytestart, long long byteend, long long filesize, char *token);
+  /// Build a partial header for a multipart response, returns its length
+  int buildPartialHdr(char *buff, int blen, long long bytestart, long long byteend, long long filesize, const char *token);
+
+  /// Build the closing part for a multipart response, returns its length
+  int buildPartialHdrEnd(char *buff, int blen, const char *token);
 
-  /// Build the closing part for a multipart response
-  std::string buildPartialHdrEnd(char *token);
+  /// Stream the data of a readv response as the parts of a multipart response
+  int sendReadVParts();
 
   // Appends the opaque info that we have
   // NOTE: this function assumes that the strings are unquoted, and will quote them
@@ -200,6 +208,18 @@ public:
   long long length;  // Total size from client for PUT; total length of response TO client for GET.
   int depth;
   bool sendcontinue;
+  /// True if the client spoke HTTP/1.0 and thus cannot take chunked responses
+  bool http10;
+  /// Where we are in a chunked request body (Transfer-Encoding: chunked)
+  enum ChunkState {ckNone = 0, ckSize, ckData, ckDataEnd, ckTrailer, ckDone};
+  ChunkState chunkstate;
+  /// Payload bytes left in the current chunk
+  long long chunkleft;
+  /// Bytes of the last write that came from our buffer, the rest (if any)
+  /// was read from the link by the bridge itself
+  int bufwrite;
+  /// True once the response is being sent in chunks
+  bool chunkedresp;
 
   /// The host field specified in the req
   std::string host;
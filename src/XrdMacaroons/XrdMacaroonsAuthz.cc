@@ -4,6 +4,8 @@
 
 #include <time.h>
 
+#include <openssl/evp.h>
+
 #include "macaroons.h"
 
 #include "XrdOuc/XrdOucEnv.hh"
@@ -24,6 +26,9 @@ public:
 
     const std::string &GetSecName() const {return m_sec_name;}
 
+    // Earliest expiry of the satisfied 'before' caveats; 0 if there were none.
+    time_t GetExpiry() const {return m_expiry;}
+
     static int verify_before_s(void *authz_ptr,
                                const unsigned char *pred,
                                size_t pred_sz);
@@ -53,6 +58,7 @@ private:
     std::string m_sec_name;
     Access_Operation m_oper;
     time_t m_now;
+    time_t m_expiry;
 };
 
 
@@ -131,15 +137,31 @@ Authz::Access(const XrdSecEntity *Entity, const char *path,
     }
     authz += 9;
 
-    struct macaroon_verifier *verifier = macaroon_verifier_create();
-    if (!verifier)
+    if (!path)
     {
-        m_log.Emsg("Access", "Failed to create a new macaroon verifier");
+        m_log.Emsg("Access", "Request with no provided path.");
         return XrdAccPriv_None;
     }
-    if (!path)
+
+    // The same token is normally presented for many requests; reuse an earlier
+    // verification of it for this path and operation if we have one.
+    std::string cache_key = CacheKey(authz, path, oper);
+    std::string cached_name;
+    if (cache_key.size() && CacheFind(cache_key, cached_name))
     {
-        m_log.Emsg("Access", "Request with no provided path.");
+        m_log.Log(LogMask::Debug, "Access", "Using cached macaroon verification for", path);
+        if (Entity && cached_name.size()) {
+            XrdSecEntity &myEntity = *const_cast<XrdSecEntity *>(Entity);
+            if (myEntity.name) {free(myEntity.name);}
+            myEntity.name = strdup(cached_name.c_str());
+        }
+        return AddPriv(oper, XrdAccPriv_None);
+    }
+
+    struct macaroon_verifier *verifier = macaroon_verifier_create();
+    if (!verifier)
+    {
+        m_log.Emsg("Access", "Failed to create a new macaroon verifier");
         return XrdAccPriv_None;
     }
 
@@ -173,6 +195,7 @@ Authz::Access(const XrdSecEntity *Entity, const char *path,
     {
         m_log.Emsg("Access", "Macaroon is for incorrect location", reinterpret_cast<const char *>(macaroon_loc));
         macaroon_verifier_destroy(verifier);
+        macaroon_destroy(macaroon);
         return m_chain ? m_chain->Access(Entity, path, oper, env) : XrdAccPriv_None;
     }
 
@@ -201,17 +224,88 @@ Authz::Access(const XrdSecEntity *Entity, const char *path,
         myEntity.name = strdup(check_helper.GetSecName().c_str());
     }
 
+    macaroon_verifier_destroy(verifier);
+    macaroon_destroy(macaroon);
+
+    if (cache_key.size())
+    {
+        CacheAdd(cache_key, check_helper.GetExpiry(), check_helper.GetSecName());
+    }
+
     // We passed verification - give the correct privilege.
     return AddPriv(oper, XrdAccPriv_None);
 }
 
 
+std::string
+Authz::CacheKey(const char *token, const char *path, Access_Operation oper)
+{
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len;
+
+    // Key on a digest so that tokens are not kept in memory.
+    if (!EVP_Digest(token, strlen(token), digest, &digest_len, EVP_sha256(), NULL))
+    {
+        return "";
+    }
+    std::string key(reinterpret_cast<const char *>(digest), digest_len);
+    key += static_cast<char>(oper);
+    key += path;
+    return key;
+}
+
+
+bool
+Authz::CacheFind(const std::string &key, std::string &name)
+{
+    XrdSysMutexHelper lock(m_cache_mutex);
+
+    std::unordered_map<std::string, CacheEntry>::iterator it = m_cache.find(key);
+    if (it == m_cache.end()) {return false;}
+    if (it->second.m_expiry <= time(NULL))
+    {
+        m_cache.erase(it);
+        return false;
+    }
+    name = it->second.m_name;
+    return true;
+}
+
+
+void
+Authz::CacheAdd(const std::string &key, time_t expiry, const std::string &name)
+{
+    time_t now = time(NULL);
+    if (!expiry || expiry > now + cache_lifetime) {expiry = now + cache_lifetime;}
+
+    XrdSysMutexHelper lock(m_cache_mutex);
+
+    // Keep the cache bounded; drop expired entries first and everything should
+    // that not be enough.
+    if (m_cache.size() >= cache_max)
+    {
+        for (std::unordered_map<std::string, CacheEntry>::iterator it = m_cache.begin();
+             it != m_cache.end(); )
+        {
+            if (it->second.m_expiry <= now) {it = m_cache.erase(it);}
+            else {++it;}
+        }
+        if (m_cache.size() >= cache_max) {m_cache.clear();}
+    }
+
+    CacheEntry &entry = m_cache[key];
+    entry.m_expiry = expiry;
+    entry.m_name = name;
+}
+
+
 AuthzCheck::AuthzCheck(const char *req_path, const Access_Operation req_oper, ssize_t max_duration, XrdSysError &log)
       : m_max_duration(max_duration),
         m_log(log),
         m_path(req_path),
         m_oper(req_oper),
-        m_now(time(NULL))
+        m_now(time(NULL)),
+        m_expiry(0)
 {
     switch (m_oper)
     {
@@ -313,6 +407,7 @@ AuthzCheck::verify_before(const unsigned char * pred, size_t pred_sz)
     }
 
     int result = (m_now >= caveat_time);
+    if (!result && (!m_expiry || caveat_time < m_expiry)) {m_expiry = caveat_time;}
     if (!result) m_log.Log(LogMask::Debug, "AuthzCheck", "verify before successful");
     else m_log.Log(LogMask::Debug, "AuthzCheck", "verify before failed");
     return result;
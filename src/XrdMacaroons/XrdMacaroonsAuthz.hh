@@ -1,6 +1,10 @@
 
+#include <string>
+#include <unordered_map>
+
 #include "XrdAcc/XrdAccAuthorize.hh"
 #include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPthread.hh"
 
 
 class XrdSysError;
@@ -34,6 +38,26 @@ public:
     }
 
 private:
+    // Successful verifications are cached by token digest, operation and path
+    // until the token expires (but at most cache_lifetime seconds).
+    struct CacheEntry
+    {
+        time_t m_expiry;
+        std::string m_name;
+    };
+
+    static std::string CacheKey(const char *token, const char *path,
+                                Access_Operation oper);
+    bool CacheFind(const std::string &key, std::string &name);
+    void CacheAdd(const std::string &key, time_t expiry,
+                  const std::string &name);
+
+    static const size_t cache_max = 8192;
+    static const time_t cache_lifetime = 300;
+
+    XrdSysMutex m_cache_mutex;
+    std::unordered_map<std::string, CacheEntry> m_cache;
+
     ssize_t m_max_duration;
     XrdAccAuthorize *m_chain;
     XrdSysError m_log;
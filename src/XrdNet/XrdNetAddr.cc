@@ -467,13 +467,15 @@ const char *XrdNetAddr::Set(struct addrinfo *rP, int Port, bool mapit)
 /*                              S e t C a c h e                               */
 /******************************************************************************/
   
-void XrdNetAddr::SetCache(int keeptime)
+void XrdNetAddr::SetCache(int keeptime, int negtime, int pfthreads)
 {
    static XrdNetCache theCache;
 
-// Set the cache keep time
+// Set the cache keep times and number of prefetch threads
 //
    theCache.SetKT(keeptime);
+   theCache.SetNT(negtime);
+   theCache.SetPF(pfthreads);
    dnsCache = (keeptime > 0 ? &theCache : 0);
 }
 
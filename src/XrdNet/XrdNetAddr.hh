@@ -170,9 +170,14 @@ const char *Set(struct addrinfo *rP, int port, bool mapit=false);
 //------------------------------------------------------------------------------
 //! Set the cache time for address to name resolutions. This method should only
 //! be called during initialization time. The default is to not use the cache.
+//!
+//! @param  keeptime seconds to keep a resolved name, zero disables the cache.
+//! @param  negtime  seconds to keep an address that could not be resolved.
+//! @param  pfthreads number of threads resolving names in the background for
+//!                  XrdNetAddrInfo::Prefetch(), zero disables prefetching.
 //------------------------------------------------------------------------------
 
-static void SetCache(int keeptime);
+static void SetCache(int keeptime, int negtime=0, int pfthreads=0);
 
 //------------------------------------------------------------------------------
 //! Force this object to work in IPV4 mode only. This method permanently sets
@@ -92,7 +92,8 @@ int XrdNetAddrInfo::Format(char *bAddr, int bLen, fmtUse theFmt, int fmtOpts)
 // Resolve address if need be and return result if possible
 //
    if (theFmt == fmtName || theFmt == fmtAuto)
-      {if (!hostName && dnsCache && !(hostName = dnsCache->Find(this))
+      {if (!hostName && dnsCache
+       && !(hostName = dnsCache->Find(this, theFmt == fmtName))
        &&  theFmt == fmtName) Resolve();
        if (hostName)
           {n = (omitP ? snprintf(bAddr, bLen, "%s",    hostName)
@@ -300,7 +301,7 @@ const char *XrdNetAddrInfo::Name(const char *eName, const char **eText)
 
 // If we already translated this name, just return the translation
 //
-   if (hostName || (dnsCache && (hostName = dnsCache->Find(this))))
+   if (hostName || (dnsCache && (hostName = dnsCache->Find(this, true))))
       return hostName;
 
 // Try to resolve this address
@@ -329,6 +330,18 @@ int XrdNetAddrInfo::Port()
    return ntohs(IP.v6.sin6_port);
 }
 
+/******************************************************************************/
+/*                              P r e f e t c h                               */
+/******************************************************************************/
+
+bool XrdNetAddrInfo::Prefetch()
+{
+// Nothing to do if we have the name; otherwise ask the cache to resolve it
+//
+   if (hostName) return true;
+   return dnsCache && dnsCache->Prefetch(this);
+}
+
 /******************************************************************************/
 /* Private:                        Q F i l l                                  */
 /******************************************************************************/
@@ -375,7 +388,10 @@ int XrdNetAddrInfo::Resolve()
    if ((rc = getnameinfo(&IP.Addr, n, hBuff+1, sizeof(hBuff)-2, 0, 0, 0)))
       {int ec = errno;
        if (Format(hBuff, sizeof(hBuff), fmtAddr, noPort))
-          {hostName = strdup(hBuff); return 0;}
+          {hostName = strdup(hBuff);
+           if (dnsCache) dnsCache->Add(this, hostName, true);
+           return 0;
+          }
        errno = ec;
        return rc;
       }
@@ -225,6 +225,17 @@ XrdNetSockAddr  *NetAddr() {return (sockAddr == (void *)&IP ? &IP : 0);}
 
 int         Port();
 
+//------------------------------------------------------------------------------
+//! Start resolving our host name in the background so that a later call to
+//! Name() finds it in the cache. Only effective when prefetching has been
+//! enabled via XrdNetAddr::SetCache().
+//!
+//! @return true  when the name is cached or being resolved.
+//!         false when the name is not resolved in the background.
+//------------------------------------------------------------------------------
+
+bool        Prefetch();
+
 //------------------------------------------------------------------------------
 //! Provide our protocol family.
 //!
@@ -326,6 +337,7 @@ XrdNetAddrInfo &operator=(XrdNetAddrInfo const &rhs)
                          }
 
 protected:
+friend class XrdNetCache;
        char               *LowCase(char *str);
        int                 QFill(char *bAddr, int bLen);
        int                 Resolve();
@@ -33,74 +33,111 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
-#include "XrdNet/XrdNetAddrInfo.hh"
+#include "XrdNet/XrdNetAddr.hh"
 #include "XrdNet/XrdNetCache.hh"
 
 /******************************************************************************/
 /*                        S t a t i c   M e m b e r s                         */
 /******************************************************************************/
   
-int XrdNetCache::keepTime = 0;
+int XrdNetCache::keepTime  = 0;
+int XrdNetCache::negTime   = 0;
+int XrdNetCache::pfThreads = 0;
 
+/******************************************************************************/
+/*                         T h r e a d   E n t r y                            */
+/******************************************************************************/
+
+namespace
+{
+void *XrdNetCacheResolver(void *carg)
+{
+   XrdNetCache *cP = (XrdNetCache *)carg;
+   return cP->Resolver();
+}
+}
+  
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
   
 XrdNetCache::XrdNetCache(int psize, int csize)
+                        : pfReady(0), pfFirst(0), pfLast(0), pfRunning(0)
 {
-     prevtablesize = psize;
-     nashtablesize = csize;
-     Threshold     = (csize * LoadMax) / 100;
-     nashnum       = 0;
-     nashtable     = (anItem **)malloc( (size_t)(csize*sizeof(anItem *)) );
-     memset((void *)nashtable, 0, (size_t)(csize*sizeof(anItem *)));
+   size_t memlen = (size_t)(csize*sizeof(anItem *));
+
+   for (int i = 0; i < Shards; i++)
+       {Shard[i].prevtablesize = psize;
+        Shard[i].nashtablesize = csize;
+        Shard[i].Threshold     = (csize * LoadMax) / 100;
+        Shard[i].nashnum       = 0;
+        Shard[i].nashtable     = (anItem **)malloc(memlen);
+        memset((void *)Shard[i].nashtable, 0, memlen);
+       }
 }
 
 /******************************************************************************/
 /* public                            A d d                                    */
 /******************************************************************************/
   
-void XrdNetCache::Add(XrdNetAddrInfo *hAddr, const char *hName)
+void XrdNetCache::Add(XrdNetAddrInfo *hAddr, const char *hName, bool isNeg)
 {
    anItem Item, *hip;
-   int    kent;
+   int    kt = (isNeg ? negTime : keepTime);
 
 // Get the key and make sure this is a valid address (should be)
 //
    if (!GenKey(Item, hAddr)) return;
+   aShard &theShard = ShardOf(Item);
 
-// We may be in a race condition, check we have this item
+// We may be in a race condition, check we have this item. A pending prefetch
+// of a failed resolution is simply dropped when we don't cache failures.
 //
-   myMutex.Lock();
-   if ((hip = Locate(Item)))
-      {if (hip->hName) free(hip->hName);
+   theShard.myCond.Lock();
+   if ((hip = Locate(theShard, Item)))
+      {if (!kt) {theShard.myCond.UnLock(); Done(Item); return;}
+       if (!hip->hName) theShard.myCond.Broadcast();
+          else free(hip->hName);
        hip->hName = strdup(hName);
-       hip->expTime = time(0) + keepTime;
-       myMutex.UnLock();
+       hip->expTime = time(0) + kt;
+       theShard.myCond.UnLock();
        return;
       }
 
-// Check if we should expand the table
+// Add a new entry unless this is a failure that we don't cache
 //
-   if (++nashnum > Threshold) Expand();
+   if (kt) Insert(theShard, new anItem(Item, hName, kt));
+   theShard.myCond.UnLock();
+}
 
-// Allocate a new entry
-//
-   hip = new anItem(Item, hName, keepTime);
+/******************************************************************************/
+/* private                          D o n e                                   */
+/******************************************************************************/
 
-// Add the entry to the table
+void XrdNetCache::Done(XrdNetCache::anItem &Item)
+{
+   anItem *hip, *pip;
+   aShard &theShard = ShardOf(Item);
+
+// Remove the entry if it is still pending and wake up anyone waiting for it
 //
-   kent = hip->aHash % nashtablesize;
-   hip->Next = nashtable[kent];
-   nashtable[kent] = hip;
-   myMutex.UnLock();
+   theShard.myCond.Lock();
+   if ((hip = Locate(theShard, Item, &pip)) && !hip->hName)
+      {if (pip) pip->Next = hip->Next;
+          else  theShard.nashtable[hip->aHash % theShard.nashtablesize]
+                                  = hip->Next;
+       theShard.nashnum--;
+       delete hip;
+       theShard.myCond.Broadcast();
+      }
+   theShard.myCond.UnLock();
 }
   
 /******************************************************************************/
 /* private                        E x p a n d                                 */
 /******************************************************************************/
   
-void XrdNetCache::Expand()
+void XrdNetCache::Expand(XrdNetCache::aShard &Shard)
 {
    int newsize, newent, i;
    size_t memlen;
@@ -108,7 +145,7 @@ void XrdNetCache::Expand()
 
 // Compute new size for table using a fibonacci series
 //
-   newsize = prevtablesize + nashtablesize;
+   newsize = Shard.prevtablesize + Shard.nashtablesize;
 
 // Allocate the new table
 //
@@ -118,8 +155,8 @@ void XrdNetCache::Expand()
 
 // Redistribute all of the current items
 //
-   for (i = 0; i < nashtablesize; i++)
-       {nip = nashtable[i];
+   for (i = 0; i < Shard.nashtablesize; i++)
+       {nip = Shard.nashtable[i];
         while(nip)
              {nextnip = nip->Next;
               newent  = nip->aHash % newsize;
@@ -131,53 +168,61 @@ void XrdNetCache::Expand()
 
 // Free the old table and plug in the new table
 //
-   free((void *)nashtable);
-   nashtable     = newtab;
-   prevtablesize = nashtablesize;
-   nashtablesize = newsize;
+   free((void *)Shard.nashtable);
+   Shard.nashtable     = newtab;
+   Shard.prevtablesize = Shard.nashtablesize;
+   Shard.nashtablesize = newsize;
 
 // Compute new expansion threshold
 //
-   Threshold = static_cast<int>((static_cast<long long>(newsize)*LoadMax)/100);
+   Shard.Threshold = static_cast<int>((static_cast<long long>(newsize)*LoadMax)
+                                     /100);
 }
 
 /******************************************************************************/
 /* public                           F i n d                                   */
 /******************************************************************************/
   
-char *XrdNetCache::Find(XrdNetAddrInfo *hAddr)
+char *XrdNetCache::Find(XrdNetAddrInfo *hAddr, bool wait)
 {
-  anItem Item, *nip, *pip = 0;
-  int kent;
+  anItem Item, *nip, *pip;
+  time_t now;
 
 // Get the hash for this address
 //
    if (!GenKey(Item, hAddr)) return 0;
+   aShard &theShard = ShardOf(Item);
 
-// Compute position of the hash table entry
+// Find the entry, waiting for a pending prefetch if so wanted
 //
-   myMutex.Lock();
-   kent = Item.aHash%nashtablesize;
+   theShard.myCond.Lock();
+   while((nip = Locate(theShard, Item, &pip)))
+        {now = time(0);
+         if (nip->expTime <= now) break;
+         if (nip->hName)
+            {char *hName = strdup(nip->hName);
+             theShard.myCond.UnLock();
+             return hName;
+            }
+         if (!wait) break;
+         theShard.myCond.Wait(static_cast<int>(nip->expTime - now));
+        }
 
-// Find the entry
+// Pending entries are left alone
 //
-   nip = nashtable[kent];
-   while(nip && *nip != Item) {pip = nip; nip = nip->Next;}
-   if (!nip) {myMutex.UnLock(); return 0;}
+   if (!nip || !(nip->expTime <= now))
+      {theShard.myCond.UnLock(); return 0;}
 
-// Make sure entry has not expired
+// The entry has expired
 //
-   if (nip->expTime > time(0))
-      {char *hName = strdup(nip->hName);
-       myMutex.UnLock();
-       return hName;
-      }
 
 // Remove the entry and return not found
 //
-   if (pip) pip->Next       = nip->Next;
-      else  nashtable[kent] = nip->Next;
-   myMutex.UnLock();
+   if (pip) pip->Next = nip->Next;
+      else  theShard.nashtable[Item.aHash % theShard.nashtablesize]
+                              = nip->Next;
+   theShard.nashnum--;
+   theShard.myCond.UnLock();
    delete nip;
    return 0;
 }
@@ -217,19 +262,116 @@ int XrdNetCache::GenKey(XrdNetCache::anItem &Item, XrdNetAddrInfo *hAddr)
    return 0;
 }
 
+/******************************************************************************/
+/* Private:                       I n s e r t                                 */
+/******************************************************************************/
+
+void XrdNetCache::Insert(XrdNetCache::aShard &Shard, XrdNetCache::anItem *hip)
+{
+   int kent;
+
+// Check if we should expand the table
+//
+   if (++Shard.nashnum > Shard.Threshold) Expand(Shard);
+
+// Add the entry to the table
+//
+   kent = hip->aHash % Shard.nashtablesize;
+   hip->Next = Shard.nashtable[kent];
+   Shard.nashtable[kent] = hip;
+}
+
 /******************************************************************************/
 /* Private:                       L o c a t e                                 */
 /******************************************************************************/
   
-XrdNetCache::anItem *XrdNetCache::Locate(XrdNetCache::anItem &Item)
+XrdNetCache::anItem *XrdNetCache::Locate(XrdNetCache::aShard &Shard,
+                                         XrdNetCache::anItem &Item,
+                                         XrdNetCache::anItem **pip)
 {
-  anItem *nip;
+  anItem *nip, *prv = 0;
   unsigned int kent;
 
 // Find the entry
 //
-   kent = Item.aHash%nashtablesize;
-   nip = nashtable[kent];
-   while(nip && *nip != Item) nip = nip->Next;
+   kent = Item.aHash%Shard.nashtablesize;
+   nip = Shard.nashtable[kent];
+   while(nip && *nip != Item) {prv = nip; nip = nip->Next;}
+   if (pip) *pip = prv;
    return nip;
 }
+
+/******************************************************************************/
+/* public                       P r e f e t c h                               */
+/******************************************************************************/
+
+bool XrdNetCache::Prefetch(XrdNetAddrInfo *hAddr)
+{
+   anItem Item, *hip;
+   aRequest *rP;
+   pthread_t tid;
+
+// Make sure prefetching is enabled and the address can be cached
+//
+   if (pfThreads <= 0 || !GenKey(Item, hAddr)) return false;
+   aShard &theShard = ShardOf(Item);
+
+// If we already have the entry (or are fetching it) there is nothing to do.
+// Otherwise, add a pending entry so that Find() can wait for the result.
+//
+   theShard.myCond.Lock();
+   if ((hip = Locate(theShard, Item)) && hip->expTime > time(0))
+      {theShard.myCond.UnLock();
+       return true;
+      }
+   if (hip)
+      {if (hip->hName) {free(hip->hName); hip->hName = 0;}
+       hip->expTime = time(0) + PendMax;
+      } else Insert(theShard, new anItem(Item, 0, PendMax));
+   theShard.myCond.UnLock();
+
+// Queue the request and start another resolver if we can
+//
+   rP = new aRequest;
+   rP->Next = 0;
+   memcpy(&(rP->IP), hAddr->SockAddr(), hAddr->SockSize());
+   pfMutex.Lock();
+   if (pfLast) pfLast->Next = rP;
+      else     pfFirst      = rP;
+   pfLast = rP;
+   if (pfRunning < pfThreads
+   &&  !XrdSysThread::Run(&tid, XrdNetCacheResolver, (void *)this,
+                          XRDSYSTHREAD_BIND, "DNS prefetch")) pfRunning++;
+   pfMutex.UnLock();
+   pfReady.Post();
+   return true;
+}
+
+/******************************************************************************/
+/* public                       R e s o l v e r                               */
+/******************************************************************************/
+
+void *XrdNetCache::Resolver()
+{
+   XrdNetAddr theAddr;
+   anItem     Item;
+   aRequest  *rP;
+
+// Resolve queued addresses forever. Resolve() adds the result to the cache
+// which wakes up anyone waiting for it. Should it not, we drop the pending
+// entry ourselves.
+//
+   while(1)
+        {pfReady.Wait();
+         pfMutex.Lock();
+         if ((rP = pfFirst) && !(pfFirst = rP->Next)) pfLast = 0;
+         pfMutex.UnLock();
+         if (!rP) continue;
+         if (!theAddr.Set(&(rP->IP.Addr)))
+            {theAddr.Resolve();
+             if (GenKey(Item, &theAddr)) Done(Item);
+            }
+         delete rP;
+        }
+   return (void *)0;
+}
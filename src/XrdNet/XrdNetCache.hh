@@ -34,6 +34,7 @@
 #include <time.h>
 #include <sys/types.h>
 
+#include "XrdNet/XrdNetSockAddr.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
 class XrdNetAddrInfo;
@@ -44,24 +45,43 @@ public:
 
 //------------------------------------------------------------------------------
 //! Add an address-hostname association to the cache. The address must be an
-//! INET family address; otherwise it is not added.
+//! INET family address; otherwise it is not added. Threads waiting for a
+//! prefetch of the address are woken up.
 //!
 //! @param  hAddr  points to the address of the name.
 //! @param  hName  points to the name to be associated with the address.
+//! @param  isNeg  when true, the name could not be resolved and hName is the
+//!                address text. The entry is then kept for the negative
+//!                keep time (see SetNT()).
 //------------------------------------------------------------------------------
 
-void   Add(XrdNetAddrInfo *hAddr, const char *hName);
+void   Add(XrdNetAddrInfo *hAddr, const char *hName, bool isNeg=false);
 
 //------------------------------------------------------------------------------
 //! Locate an address-hostname association in the cache.
 //!
 //! @param  hAddr  points to the address of the name.
+//! @param  wait   when true and the address is being prefetched, wait for the
+//!                prefetch to complete instead of returning failure.
 //!
 //! @return Success: an strdup'd string of the corresponding name.
 //!         Failure: 0;
 //------------------------------------------------------------------------------
 
-char  *Find(XrdNetAddrInfo *hAddr);
+char  *Find(XrdNetAddrInfo *hAddr, bool wait=false);
+
+//------------------------------------------------------------------------------
+//! Resolve the name of an address in the background, so that a later Find()
+//! does not need to wait for DNS. Nothing is done if the address is already
+//! cached or being prefetched.
+//!
+//! @param  hAddr  points to the address to resolve.
+//!
+//! @return true when the address is cached or queued for resolution and false
+//!         when prefetching is not enabled (see SetPF()).
+//------------------------------------------------------------------------------
+
+bool   Prefetch(XrdNetAddrInfo *hAddr);
 
 //------------------------------------------------------------------------------
 //! Set the default keep time for entries in the cache during initialization.
@@ -71,15 +91,34 @@ char  *Find(XrdNetAddrInfo *hAddr);
 static
 void   SetKT(int ktval) {keepTime = ktval;}
 
+//------------------------------------------------------------------------------
+//! Set the keep time for addresses that could not be resolved during
+//! initialization. Zero, the default, does not cache failed resolutions.
+//!
+//! @param  ntVal  the number of seconds to keep a negative entry.
+//------------------------------------------------------------------------------
+static
+void   SetNT(int ntval) {negTime = ntval;}
+
+//------------------------------------------------------------------------------
+//! Set the number of background threads resolving prefetched addresses during
+//! initialization. Zero, the default, disables prefetching.
+//!
+//! @param  pfVal  the number of resolver threads.
+//------------------------------------------------------------------------------
+static
+void   SetPF(int pfval) {pfThreads = pfval;}
+
 //------------------------------------------------------------------------------
 //! Constructor. When allocateing a new hash, two adjacent Fibonocci numbers.
-//! The series is simply n[j] = n[j-1] + n[j-2].
+//! The series is simply n[j] = n[j-1] + n[j-2]. The cache is split in Shards
+//! independently locked tables each of the given initial size.
 //!
 //! @param  psize  the correct Fibonocci antecedent to csize.
-//! @param  csize  the initial size of the table.
+//! @param  csize  the initial size of each table.
 //------------------------------------------------------------------------------
 
-       XrdNetCache(int psize = 987, int csize = 1597);
+       XrdNetCache(int psize = 89, int csize = 144);
 
 //------------------------------------------------------------------------------
 //! Destructor. The XrdNetCache object is not designed to be deleted. Doing
@@ -88,9 +127,13 @@ void   SetKT(int ktval) {keepTime = ktval;}
 
       ~XrdNetCache() {} // Never gets deleted
 
+void            *Resolver();
+
 private:
 
 static const int LoadMax = 80;
+static const int Shards  = 16;
+static const int PendMax = 30;  // Seconds a prefetch may take
 
 struct anItem
       {union    {long long aV6[2];
@@ -98,7 +141,7 @@ struct anItem
                  char      aVal[16];  // Enough for IPV4 or IPV6
                 };
        anItem   *Next;
-       char     *hName;
+       char     *hName;     // Nil while a prefetch is pending
        time_t    expTime;   // Expiration time
 unsigned int     aHash;     // Hash value
        int       aLen;      // Actual length 4 or 16
@@ -111,23 +154,46 @@ inline int       operator!=(const anItem &oth)
                  anItem() : Next(0), hName(0), aLen(0) {}
 
                  anItem(anItem &Item, const char *hn, int kt)
-                         : Next(0), hName(strdup(hn)), expTime(time(0)+kt),
+                         : Next(0), hName(hn ? strdup(hn) : 0),
+                           expTime(time(0)+kt),
                            aHash(Item.aHash), aLen(Item.aLen)
                          {memcpy(aVal, Item.aVal, Item.aLen);}
                 ~anItem() {if (hName) free(hName);}
       };
 
-void             Expand();
+struct aShard
+      {XrdSysCondVar    myCond;
+       anItem         **nashtable;
+       int              prevtablesize;
+       int              nashtablesize;
+       int              nashnum;
+       int              Threshold;
+
+                        aShard() : myCond(0) {}
+      };
+
+struct aRequest
+      {aRequest        *Next;
+       XrdNetSockAddr   IP;
+      };
+
+void             Done(anItem &Item);
+void             Expand(aShard &Shard);
 int              GenKey(anItem &Item, XrdNetAddrInfo *hAddr);
-anItem          *Locate(anItem &Item);
+void             Insert(aShard &Shard, anItem *hip);
+anItem          *Locate(aShard &Shard, anItem &Item, anItem **pip=0);
+inline aShard   &ShardOf(anItem &Item) {return Shard[Item.aHash % Shards];}
 
 static int       keepTime;
+static int       negTime;
+static int       pfThreads;
+
+aShard           Shard[Shards];
 
-XrdSysMutex      myMutex;
-anItem         **nashtable;
-int              prevtablesize;
-int              nashtablesize;
-int              nashnum;
-int              Threshold;
+XrdSysMutex      pfMutex;
+XrdSysSemaphore  pfReady;
+aRequest        *pfFirst;
+aRequest        *pfLast;
+int              pfRunning;
 };
 #endif
@@ -74,14 +74,7 @@ int XrdNetMsg::Send(const char *Buff, int Blen, const char *dest, int tmo)
 
    if (!Blen && !(Blen = strlen(Buff))) return  0;
 
-   if (!dest)
-       {if (!destOK)
-           {eDest->Emsg("Msg", "Destination not specified."); return -1;}
-        theDest = &dfltDest;
-       }
-      else if (specDest.Set(dest))
-              {eDest->Emsg("Msg", dest, "is unreachable");    return -1;}
-              else theDest = &specDest;
+   if (!(theDest = getDest(dest))) return -1;
 
    if (tmo >= 0 && !OK2Send(tmo, dest)) return 1;
 
@@ -112,9 +105,73 @@ int XrdNetMsg::Send(const struct iovec iov[], int iovcnt,
    return Send(buff, (int)(bp-buff), dest, -1);
 }
   
+/******************************************************************************/
+/*                              S e n d M a n y                               */
+/******************************************************************************/
+
+int XrdNetMsg::SendMany(const struct iovec msg[], int msgcnt,
+                        const char  *dest,        int tmo)
+{
+   XrdNetAddr *theDest;
+   int i, retc, rc = 0;
+
+   if (msgcnt <= 0) return 0;
+
+   if (!(theDest = getDest(dest))) return -1;
+
+   if (tmo >= 0 && !OK2Send(tmo, dest)) return 1;
+
+#ifdef __linux__
+// Hand the kernel as many messages as it will take at once. A failed message
+// is reported and skipped so that the ones that follow it are still sent.
+//
+   static const int mBatch = 64;
+   struct mmsghdr mMsg[mBatch];
+   int j, n;
+
+   for (i = 0; i < msgcnt; i += n)
+       {n = (msgcnt - i > mBatch ? mBatch : msgcnt - i);
+        memset(mMsg, 0, sizeof(mmsghdr)*n);
+        for (j = 0; j < n; j++)
+            {mMsg[j].msg_hdr.msg_name    = (void *)theDest->SockAddr();
+             mMsg[j].msg_hdr.msg_namelen = theDest->SockSize();
+             mMsg[j].msg_hdr.msg_iov     = (struct iovec *)&msg[i+j];
+             mMsg[j].msg_hdr.msg_iovlen  = 1;
+            }
+        do {retc = sendmmsg(FD, mMsg, n, 0);} while(retc < 0 && errno == EINTR);
+        if (retc < 0) {rc = retErr(errno, theDest); n = 1;}
+           else if (retc > 0) n = retc;
+       }
+#else
+   for (i = 0; i < msgcnt; i++)
+       {do {retc = sendto(FD, (Sokdata_t)msg[i].iov_base, msg[i].iov_len, 0,
+                          theDest->SockAddr(), theDest->SockSize());}
+           while (retc < 0 && errno == EINTR);
+        if (retc < 0) rc = retErr(errno, theDest);
+       }
+#endif
+   return rc;
+}
+  
 /******************************************************************************/
 /*                       P r i v a t e   M e t h o d s                        */
 /******************************************************************************/
+/******************************************************************************/
+/*                               g e t D e s t                                */
+/******************************************************************************/
+
+XrdNetAddr *XrdNetMsg::getDest(const char *dest)
+{
+   if (!dest)
+       {if (!destOK)
+           {eDest->Emsg("Msg", "Destination not specified."); return 0;}
+        return &dfltDest;
+       }
+   if (specDest.Set(dest))
+      {eDest->Emsg("Msg", dest, "is unreachable"); return 0;}
+   return &specDest;
+}
+
 /******************************************************************************/
 /*                               O K 2 S e n d                                */
 /******************************************************************************/
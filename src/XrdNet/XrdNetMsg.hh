@@ -87,6 +87,27 @@ int           Send(const struct  iovec iov[], // Remaining parms as above
                          int     iovcnt,      // Number of elements in iovec
                    const char   *dest=0,      // Hostname to send UDP datagram
                          int     tmo=-1);     // Timeout in ms (-1 = none)
+
+//------------------------------------------------------------------------------
+//! Send several UDP messages to an endpoint, in order, using as few system
+//! calls as the platform allows.
+//!
+//! @param  msg      The messages to send, one datagram per element.
+//! @param  msgcnt   The number of elements in msg.
+//! @param  dest     The endpint name which can be host:port or a named socket.
+//!                  If dest is zero, uses dest specified in the constructor.
+//! @param  timeout  maximum seconds to wait for a idle socket. When negative,
+//!                  the default, no time limit applies.
+//! @return <0       One or more messages not sent due to error.
+//! @return =0       All messages sent (well as defined by UDP)
+//! @return >0       Messages not sent, timeout occured.
+//------------------------------------------------------------------------------
+
+int           SendMany(const struct  iovec msg[], // Remaining parms as above
+                             int     msgcnt,      // Number of messages
+                       const char   *dest=0,      // Hostname to send datagrams
+                             int     tmo=-1);     // Timeout in ms (-1 = none)
+
 //------------------------------------------------------------------------------
 //! Constructor
 //!
@@ -111,6 +132,7 @@ protected:
 int OK2Send(int timeout, const char *dest);
 int retErr(int ecode, const char *theDest);
 int retErr(int ecode, XrdNetAddr *theDest);
+XrdNetAddr *getDest(const char *dest);
 
 XrdSysError       *eDest;
 XrdNetAddr         dfltDest;
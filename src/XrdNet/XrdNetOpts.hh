@@ -94,6 +94,16 @@
 //
 #define XRDNET_SERVER    0x10000000
 
+// Allow other server sockets to bind to the same port (SO_REUSEPORT) so that
+// the kernel distributes incomming connections across them.
+//
+#define XRDNET_REUSEPORT 0x20000000
+
+// Accept data in the SYN of incomming connections (TCP Fast Open), only used
+// when XRDNET_SERVER is specified.
+//
+#define XRDNET_FASTOPEN  0x40000000
+
 // Maximum backlog for incomming connections. The backlog value goes in low
 // order byte and is used only when XRDNET_SERVER is specified.
 //
@@ -32,7 +32,7 @@
 #include <ctype.h>
 #include <stdlib.h>
   
-#include "XrdOuc/XrdOucHash.hh"
+#include "XrdOuc/XrdOucOAHash.hh"
 #include "XrdOuc/XrdOucNList.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
@@ -69,7 +69,7 @@ XrdOucNList_Anchor        HostList;
 
 XrdNetTextList           *NetGroups;
 
-XrdOucHash<char>          OKHosts;
+XrdOucOAHash<char>        OKHosts;
 XrdSysMutex               okHMutex;
 XrdOucTrace              *eTrace;
 bool                      chkNetLst;
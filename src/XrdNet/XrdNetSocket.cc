@@ -35,6 +35,7 @@
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -266,6 +267,11 @@ int XrdNetSocket::Open(const char *inpath, int port, int flags, int windowsz)
        setOpts(SockFD, flags, eroute);
        if (setsockopt(SockFD,SOL_SOCKET,SO_REUSEADDR, (Sokdata_t)&one, szone)
        &&  eroute) eroute->Emsg("Open",errno,"set socket REUSEADDR for",epath);
+#ifdef SO_REUSEPORT
+       if ((flags & XRDNET_REUSEPORT) && (flags & XRDNET_SERVER)
+       &&  setsockopt(SockFD,SOL_SOCKET,SO_REUSEPORT, (Sokdata_t)&one, szone)
+       &&  eroute) eroute->Emsg("Open",errno,"set socket REUSEPORT for",epath);
+#endif
       }
 
 // Set the window size or udp buffer size, as needed (ignore errors)
@@ -281,6 +287,13 @@ int XrdNetSocket::Open(const char *inpath, int port, int flags, int windowsz)
                   {action = "listen on stream";
                    if (!(backlog = flags & XRDNET_BKLG))
                       backlog = XRDNETSOCKET_MAXBKLG;
+#ifdef TCP_FASTOPEN
+                   if ((flags & XRDNET_FASTOPEN)
+                   &&  setsockopt(SockFD, IPPROTO_TCP, TCP_FASTOPEN,
+                                  (Sokdata_t)&backlog, sizeof(backlog))
+                   &&  eroute) eroute->Emsg("Open", errno,
+                                            "set socket FASTOPEN for", epath);
+#endif
                    if (listen(SockFD, backlog)) myEC = errno;
                   }
        if (SockProt == PF_UNIX) chmod(inpath, S_IRWXU);
@@ -400,6 +413,50 @@ int XrdNetSocket::setOpts(int xfd, int opts, XrdSysError *eDest)
    return rc;
 }
 
+/******************************************************************************/
+/*                               s e t T u n e                                */
+/******************************************************************************/
+
+int XrdNetSocket::setTune(int xfd, const XrdNetSocket::TuneParms &parms,
+                          XrdSysError *eDest)
+{
+   int rc = 0;
+   const SOCKLEN_t szint = (SOCKLEN_t)sizeof(int);
+
+#ifdef TCP_NOTSENT_LOWAT
+   if (parms.lowat > 0
+   &&  setsockopt(xfd,IPPROTO_TCP,TCP_NOTSENT_LOWAT,(Sokdata_t)&parms.lowat,szint))
+      {rc = 1;
+       if (eDest) eDest->Emsg("setTune", errno, "set socket NOTSENT_LOWAT");
+      }
+#endif
+
+#ifdef SO_MAX_PACING_RATE
+   if (parms.pacing > 0)
+      {unsigned int rate = (parms.pacing < 0xffffffffLL
+                         ?  static_cast<unsigned int>(parms.pacing) : ~0U);
+       if (setsockopt(xfd, SOL_SOCKET, SO_MAX_PACING_RATE, (Sokdata_t)&rate,
+                      (SOCKLEN_t)sizeof(rate)))
+          {rc = 1;
+           if (eDest) eDest->Emsg("setTune", errno, "set socket pacing rate");
+          }
+      }
+#endif
+
+#ifdef TCP_CONGESTION
+   if (*parms.cc
+   &&  setsockopt(xfd, IPPROTO_TCP, TCP_CONGESTION, (Sokdata_t)parms.cc,
+                  (SOCKLEN_t)strlen(parms.cc)))
+      {rc = 1;
+       if (eDest) eDest->Emsg("setTune", errno, "set congestion control",
+                              parms.cc);
+      }
+#endif
+
+   if (parms.window > 0 && setWindow(xfd, parms.window, eDest)) rc = 1;
+   return rc;
+}
+
 /******************************************************************************/
 /*                             s e t W i n d o w                              */
 /******************************************************************************/
@@ -129,6 +129,25 @@ static int setWindow(int fd, int  Windowsz, XrdSysError *eDest=0);
 
 static int getWindow(int fd, int &Windowsz, XrdSysError *eDest=0);
 
+// Transmission tuning of a connected TCP socket, typically chosen per network
+// class (local or public). Zero or empty values leave the system default.
+//
+struct TuneParms
+      {long long pacing;   // SO_MAX_PACING_RATE in bytes per second
+       int       window;   // SO_SNDBUF and SO_RCVBUF (disables autotuning)
+       int       lowat;    // TCP_NOTSENT_LOWAT in bytes
+       char      cc[16];   // TCP_CONGESTION algorithm name
+
+       bool      isSet() const {return pacing || window || lowat || *cc;}
+
+                 TuneParms() : pacing(0), window(0), lowat(0) {*cc = 0;}
+      };
+
+// Apply tuning parameters to a socket. Options not supported by the platform
+// are silently ignored. Only when all option settings succeed is 0 returned.
+//
+static int setTune(int fd, const TuneParms &parms, XrdSysError *eDest=0);
+
 // Return socket file descriptor number (useful when attaching to a stream).
 //
 inline int  SockNum() {return SockFD;}
@@ -43,6 +43,7 @@
 #include <sys/types.h>
 
 #include "XrdCks/XrdCks.hh"
+#include "XrdCks/XrdCksCalc.hh"
 #include "XrdCks/XrdCksConfig.hh"
 #include "XrdCks/XrdCksData.hh"
 
@@ -67,6 +68,7 @@
 #include "XrdSys/XrdSysHeaders.hh"
 #include "XrdSys/XrdSysLogger.hh"
 #include "XrdSys/XrdSysPlatform.hh"
+#include "XrdSys/XrdSysProbe.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
 #include "XrdOuc/XrdOuca2x.hh"
@@ -139,6 +141,7 @@ XrdOfs::XrdOfs()
    myRole        = strdup("server");
    OssIsProxy    = 0;
    ossRW         =' ';
+   immPaths      = 0;
 
 // Obtain port number we will be using. Note that the constructor must occur
 // after the port number is known (i.e., this cannot be a global static).
@@ -151,6 +154,7 @@ XrdOfs::XrdOfs()
    poscLog = 0;
    poscHold= 10*60;
    poscAuto= 0;
+   poscSync= 1;
 
 // Set the configuration file name and dummy handle
 //
@@ -160,6 +164,7 @@ XrdOfs::XrdOfs()
 // Set checksum pointers
 //
    Cks       = 0;
+   CksInl    = 0;
    CksPfn    = true;
    CksPfn    = true;
    CksRdr    = true;
@@ -175,6 +180,8 @@ XrdOfsFile::XrdOfsFile(const char *user, int monid) : XrdSfsFile(user, monid)
    dorawio = 0;
    viaDel  = 0;
    myTPC   = 0;
+   ckInl   = 0;
+   ckInlOff= 0;
    tident = (user ? user : "");
 }
 
@@ -449,6 +456,7 @@ int XrdOfsFile::open(const char          *path,      // In
 // Trace entry
 //
    ZTRACE(open, std::hex <<open_mode <<"-" <<std::oct <<Mode <<std::dec <<" fn=" <<path);
+   XrdSysProbe3(xrdofs, open__start, this, path, open_mode);
 
 // Verify that this object is not already associated with an open file
 //
@@ -556,9 +564,14 @@ int XrdOfsFile::open(const char          *path,      // In
        OOIDENTENV(client, Open_Env);
       }
 
-// Get a handle for this file.
+// Get a handle for this file. Files in an immutable export opened r/o get a
+// handle of their own so that such opens never serialize on a shared handle.
+// Reads are never serialized, they go straight to the storage system.
 //
-   if ((retc = XrdOfsHandle::Alloc(path, isRW, &oP.hP)))
+   if (!isRW && !tpcKey && XrdOfsFS->immPaths && XrdOfsFS->isImmutable(path))
+      retc = XrdOfsHandle::Alloc(path, XrdOfsHandle::opPV, &oP.hP);
+      else retc = XrdOfsHandle::Alloc(path, isRW, &oP.hP);
+   if (retc)
       {if (retc > 0) return XrdOfsFS->Stall(error, retc, path);
        return XrdOfsFS->Emsg(epname, error, retc, "attach", path);
       }
@@ -594,6 +607,7 @@ int XrdOfsFile::open(const char          *path,      // In
       {dorawio = (oh->isCompressed && open_mode & SFS_O_RAWIO ? 1 : 0);
        if (tpcKey && isRW)
           return XrdOfsFS->Emsg(epname, error, EALREADY, "tpc", path);
+       if (isRW) oP.hP->isCksInl = 0;
        XrdOfsFS->ocMutex.Lock(); oh = oP.hP; XrdOfsFS->ocMutex.UnLock();
        FTRACE(open, "attach use=" <<oh->Usage());
        if (oP.poscNum > 0) XrdOfsFS->poscQ->Commit(path, oP.poscNum);
@@ -644,6 +658,13 @@ int XrdOfsFile::open(const char          *path,      // In
        dorawio = (open_mode & SFS_O_RAWIO ? 1 : 0);
       }
    oP.hP->Activate(oP.fP);
+
+// Start an inline checksum if so wanted. This is only possible when the file
+// starts out empty and stays valid only as long as we are the sole writer.
+//
+   if (XrdOfsFS->CksInl && (open_mode & crMask)
+   &&  (ckInl = XrdOfsFS->Cks->Object(*XrdOfsFS->CksInl ? XrdOfsFS->CksInl:0)))
+      {ckInlOff = 0; oP.hP->isCksInl = 1;}
    oP.hP->UnLock();
 
 // Send an open event if we must
@@ -695,6 +716,7 @@ int XrdOfsFile::close()  // In
 // Trace the call
 //
     FTRACE(close, "use=" <<oh->Usage()); // Unreliable trace, no origin lock
+    XrdSysProbe1(xrdofs, close__start, this);
 
 // Verify the handle (we briefly maintain a global lock)
 //
@@ -713,6 +735,10 @@ int XrdOfsFile::close()  // In
 //
    if (myTPC) {myTPC->Del(); myTPC = 0;}
 
+// Record the inline checksum, if any, while the file is still open
+//
+   if (ckInl) CksInlDone(hP);
+
 // Maintain statistics
 //
    OfsStats.sdMutex.Lock();
@@ -883,6 +909,7 @@ XrdSfsXferSize XrdOfsFile::read(XrdSfsFileOffset  offset,    // In
 // Perform required tracing
 //
    FTRACE(read, blen <<"@" <<offset);
+   XrdSysProbe3(xrdofs, read__start, this, offset, blen);
 
 // Make sure the offset is not too large
 //
@@ -898,6 +925,7 @@ XrdSfsXferSize XrdOfsFile::read(XrdSfsFileOffset  offset,    // In
                             (off_t)offset, (size_t)blen))
           : (XrdSfsXferSize)(oh->Select().Read((void *)buff,
                             (off_t)offset, (size_t)blen)));
+   XrdSysProbe2(xrdofs, read__done, this, nbytes);
    if (nbytes < 0)
       return XrdOfsFS->Emsg(epname, error, (int)nbytes, "read", oh->Name());
 
@@ -927,7 +955,9 @@ XrdSfsXferSize XrdOfsFile::readv(XrdOucIOVec     *readV,     // In
 {
    EPNAME("readv");
 
+   XrdSysProbe2(xrdofs, readv__start, this, readCount);
    XrdSfsXferSize nbytes = oh->Select().ReadV(readV, readCount);
+   XrdSysProbe2(xrdofs, readv__done, this, nbytes);
    if (nbytes < 0)
        return XrdOfsFS->Emsg(epname, error, (int)nbytes, "readv", oh->Name());
 
@@ -1012,6 +1042,7 @@ XrdSfsXferSize XrdOfsFile::write(XrdSfsFileOffset  offset,    // In
 // Perform any required tracing
 //
    FTRACE(write, blen <<"@" <<offset);
+   XrdSysProbe3(xrdofs, write__start, this, offset, blen);
 
 // Make sure the offset is not too large
 //
@@ -1030,9 +1061,14 @@ XrdSfsXferSize XrdOfsFile::write(XrdSfsFileOffset  offset,    // In
    oh->isPending = 1;
    nbytes = (XrdSfsXferSize)(oh->Select().Write((const void *)buff,
                             (off_t)offset, (size_t)blen));
+   XrdSysProbe2(xrdofs, write__done, this, nbytes);
    if (nbytes < 0)
       return XrdOfsFS->Emsg(epname, error, (int)nbytes, "write", oh);
 
+// Feed the inline checksum, if any
+//
+   if (ckInl) CksInlFeed(offset, buff, nbytes);
+
 // Return number of bytes written
 //
    return nbytes;
@@ -1055,8 +1091,9 @@ int XrdOfsFile::write(XrdSfsAio *aiop)
 
 // If this is a POSC file, we must convert the async call to a sync call as we
 // must trap any errors that unpersist the file. We can't do that via aio i/f.
+// The same applies to an inline checksum which must only see written data.
 //
-   if (oh->isRW == XrdOfsHandle::opPC)
+   if (oh->isRW == XrdOfsHandle::opPC || ckInl)
       {aiop->Result = this->write(aiop->sfsAio.aio_offset,
                                   (const char *)aiop->sfsAio.aio_buf,
                                   aiop->sfsAio.aio_nbytes);
@@ -1236,6 +1273,7 @@ int XrdOfsFile::truncate(XrdSfsFileOffset  flen)  // In
 // Perform the function
 //
    oh->isPending = 1;
+   if (ckInl && flen != ckInlOff) CksInlDrop();
    if ((retc = oh->Select().Ftruncate(flen)))
       return XrdOfsFS->Emsg(epname, error, retc, "truncate", oh);
 
@@ -1270,6 +1308,65 @@ int XrdOfsFile::getCXinfo(char cxtype[4], int &cxrsz)
 /******************************************************************************/
 /*                  P r i v a t e   F i l e   M e t h o d s                   */
 /******************************************************************************/
+/******************************************************************************/
+/* private                    C k s I n l D o n e                             */
+/******************************************************************************/
+
+void XrdOfsFile::CksInlDone(XrdOfsHandle *hP)
+{
+   EPNAME("CksInline");
+   XrdCksData  cksData;
+   struct stat Stat;
+   char        pfnBuff[MAXPATHLEN+8];
+   const char *Path = hP->Name(), *csName;
+   int         csLen, rc;
+
+// The checksum only applies if nobody else wrote into the file and the file
+// holds exactly the bytes that we have seen. The handle is locked here.
+//
+   if (hP->isCksInl && !hP->Select().Fstat(&Stat) && Stat.st_size == ckInlOff)
+      {csName = ckInl->Type(csLen);
+       cksData.Set(csName);
+       cksData.Set((const void *)ckInl->Final(), csLen);
+       if (XrdOfsFS->CksPfn
+       && !(Path = XrdOfsOss->Lfn2Pfn(Path, pfnBuff, MAXPATHLEN, rc)))
+          OfsEroute.Emsg(epname, rc, "set inline checksum for", hP->Name());
+          else if ((rc = XrdOfsFS->Cks->Set(Path, cksData)))
+                  OfsEroute.Emsg(epname, rc, "set inline checksum for",
+                                 hP->Name());
+                  else XTRACE(close, hP->Name(), csName <<" set inline");
+      }
+
+// We are done with the calculator
+//
+   hP->isCksInl = 0;
+   CksInlDrop();
+}
+
+/******************************************************************************/
+/* private                    C k s I n l D r o p                             */
+/******************************************************************************/
+
+void XrdOfsFile::CksInlDrop()
+{
+   ckInl->Recycle();
+   ckInl = 0;
+}
+
+/******************************************************************************/
+/* private                    C k s I n l F e e d                             */
+/******************************************************************************/
+
+void XrdOfsFile::CksInlFeed(XrdSfsFileOffset offset, const char *buff,
+                            XrdSfsXferSize   blen)
+{
+// Anything but the next sequential write means we cannot know the checksum
+// any more; the normal calculation will have to read the file back.
+//
+   if (offset != ckInlOff || !oh->isCksInl) CksInlDrop();
+      else {ckInl->Update(buff, blen); ckInlOff += blen;}
+}
+
 /******************************************************************************/
 /* protected                  G e n F W E v e n t                             */
 /******************************************************************************/
@@ -2222,6 +2319,26 @@ int XrdOfs::fsError(XrdOucErrInfo &myError, int rc)
                            {OfsStats.Data.numErrors++;   return SFS_ERROR;   }
 }
 
+/******************************************************************************/
+/*                           i s I m m u t a b l e                            */
+/******************************************************************************/
+
+// A path is immutable when it lies under one of the ofs.immutable paths. The
+// list is only built during configuration so no lock is needed.
+//
+bool XrdOfs::isImmutable(const char *path)
+{
+   XrdOucTList *tP = immPaths;
+
+   while(tP)
+        {if (!strncmp(path, tP->text, tP->val)
+         &&  (path[tP->val] == '/' || !path[tP->val]
+         ||   tP->text[tP->val-1] == '/')) return true;
+         tP = tP->next;
+        }
+   return false;
+}
+
 /******************************************************************************/
 /*                              R e f o r m a t                               */
 /******************************************************************************/
@@ -49,6 +49,7 @@ class XrdOucEnv;
 class XrdSysError;
 class XrdSysLogger;
 class XrdOucStream;
+class XrdOucTList;
 class XrdSfsAio;
 
 struct XrdVersionInfo;
@@ -97,6 +98,7 @@ char           dname[MAXNAMLEN];
 /*                            X r d O f s F i l e                             */
 /******************************************************************************/
 
+class XrdCksCalc;
 class XrdOfsTPC;
   
 class XrdOfsFile : public XrdSfsFile
@@ -163,10 +165,16 @@ protected:
 
 private:
 
+void           CksInlDone(XrdOfsHandle *hP);
+void           CksInlDrop();
+void           CksInlFeed(XrdSfsFileOffset offset, const char *buff,
+                          XrdSfsXferSize blen);
 void           GenFWEvent();
 
 XrdOfsHandle  *oh;
 XrdOfsTPC     *myTPC;
+XrdCksCalc    *ckInl;
+long long      ckInlOff;
 int            dorawio;
 char           viaDel;
 };
@@ -373,18 +381,22 @@ XrdOfsPoscq      *poscQ;          //    -> poscQ if  persist on close enabled
 char             *poscLog;        //    -> Directory for posc recovery log
 int               poscHold;       //       Seconds to hold a forced close
 short             poscAuto;       //  1 -> Automatic persist on close
+short             poscSync;       //       Millseconds to gather posc syncs
 
 char              ossRW;          // The oss r/w capability
 bool              CksPfn;         // Checksum needs a pfn
 bool              CksRdr;         // Checksum may be redirected (i.e. not local)
 XrdOfsConfigPI   *ofsConfig;      // Plugin   configurator
 XrdCks           *Cks;            // Checksum manager
+char             *CksInl;         // Inline checksum type ("" default, 0 off)
 char              Reserved[3];    // Reserved for future checksum stuff
 char              OssIsProxy;     // !0 if we detect the oss plugin is a proxy
 char              myRType[4];     // Role type for consistency with the cms
 
 XrdVersionInfo   *myVersion;      // Version number compiled against
 
+XrdOucTList      *immPaths;       // Paths whose files are never modified
+
 static XrdOfsHandle     *dummyHandle;
 XrdSysMutex              ocMutex; // Global mutex for open/close
 
@@ -406,14 +418,17 @@ int           ConfigRedir(XrdSysError &Eroute, XrdOucEnv *EnvInfo);
 int           ConfigTPC(XrdSysError &Eroute);
 char         *ConfigTPCDir(XrdSysError &Eroute, const char *xPath);
 const char   *Fname(const char *);
+bool          isImmutable(const char *path);
 int           Forward(int &Result, XrdOucErrInfo &Resp, struct fwdOpt &Fwd,
                       const char *arg1=0, const char *arg2=0,
                       XrdOucEnv  *Env1=0, XrdOucEnv  *Env2=0);
 int           Reformat(XrdOucErrInfo &);
 const char   *theRole(int opts);
+int           xcksi(XrdOucStream &, XrdSysError &);
 int           xcrds(XrdOucStream &, XrdSysError &);
 int           xexp(XrdOucStream &, XrdSysError &, bool);
 int           xforward(XrdOucStream &, XrdSysError &);
+int           ximm(XrdOucStream &, XrdSysError &);
 int           xmaxd(XrdOucStream &, XrdSysError &);
 int           xnmsg(XrdOucStream &, XrdSysError &);
 int           xnot(XrdOucStream &, XrdSysError &);
@@ -43,6 +43,8 @@
 #include "XrdVersion.hh"
 
 #include "XrdCks/XrdCks.hh"
+#include "XrdCks/XrdCksCalc.hh"
+#include "XrdCks/XrdCksData.hh"
 
 #include "XrdOfs/XrdOfs.hh"
 #include "XrdOfs/XrdOfsConfigPI.hh"
@@ -60,6 +62,7 @@
 #include "XrdSys/XrdSysHeaders.hh"
 #include "XrdOuc/XrdOucNSWalk.hh"
 #include "XrdOuc/XrdOucStream.hh"
+#include "XrdOuc/XrdOucTList.hh"
 #include "XrdOuc/XrdOucTrace.hh"
 #include "XrdOuc/XrdOucUtils.hh"
 
@@ -269,6 +272,15 @@ int XrdOfs::Configure(XrdSysError &Eroute, XrdOucEnv *EnvInfo) {
             ofsConfig->Plugin(Cks);
             CksPfn = !ofsConfig->OssCks();
             CksRdr = !ofsConfig->LclCks();
+            if (CksInl && !(Options & isManager))
+               {XrdCksCalc *csP = (Cks ? Cks->Object(*CksInl ? CksInl : 0) : 0);
+                if (csP) csP->Recycle();
+                   else {Eroute.Say("Config warning: inline checksum '",
+                                    (*CksInl ? CksInl : "default"),
+                                    "' is not supported; disabled.");
+                         free(CksInl); CksInl = 0;
+                        }
+               }
             if (Options & Authorize)
                {ofsConfig->Plugin(Authorization);
                 XrdOfsTPC::Init(Authorization);
@@ -355,16 +367,19 @@ void XrdOfs::Config_Display(XrdSysError &Eroute)
                                   "       all.role %s\n"
                                   "%s"
                                   "       ofs.maxdelay   %d\n"
-                                  "       ofs.persist    %s hold %d%s%s\n"
+                                  "       ofs.persist    %s hold %d sync %d%s%s\n"
                                   "       ofs.trace      %x",
               cloc, myRole,
               (Options & Authorize ? "       ofs.authorize\n" : ""),
                MaxDelay,
-               pval, poscHold, (poscLog ? " logdir " : ""),
+               pval, poscHold, poscSync, (poscLog ? " logdir " : ""),
                (poscLog ? poscLog    : ""), OfsTrace.What);
 
      Eroute.Say(buff);
      ofsConfig->Display();
+     if (CksInl) Eroute.Say("       ofs.cksinline ", CksInl);
+     XrdOucTList *tP = immPaths;
+     while(tP) {Eroute.Say("       ofs.immutable ", tP->text); tP = tP->next;}
 
      if (Options & Forwarding)
         {*fwbuff = 0;
@@ -401,6 +416,7 @@ void XrdOfs::Config_Display(XrdSysError &Eroute)
          setBuff("msgs ", 5);
          i=sprintf(fwbuff,"%d %d ",evsObject->maxSmsg(),evsObject->maxLmsg());
          setBuff(fwbuff, i);
+         if (evsObject->isBinary()) setBuff("binary ", 7);
          cloc = evsObject->Prog();
          if (*cloc != '>') setBuff("|",1);
          setBuff(cloc, strlen(cloc));
@@ -484,7 +500,7 @@ int XrdOfs::ConfigPosc(XrdSysError &Eroute)
 
 // Create object then initialize it
 //
-   poscQ = new XrdOfsPoscq(&Eroute, XrdOfsOss, poscLog);
+   poscQ = new XrdOfsPoscq(&Eroute, XrdOfsOss, poscLog, poscSync);
    rP = poscQ->Init(rc);
    if (!rc) return 1;
 
@@ -652,7 +668,8 @@ char *XrdOfs::ConfigTPCDir(XrdSysError &Eroute, const char *xPath)
 
 // list the contents of teh directory
 //
-   XrdOucNSWalk nsWalk(&Eroute, aPath, 0, XrdOucNSWalk::retFile);
+   XrdOucNSWalk nsWalk(&Eroute, aPath, 0, XrdOucNSWalk::retFile
+                                        | XrdOucNSWalk::retType);
    XrdOucNSWalk::NSEnt *nsX, *nsP = nsWalk.Index(rc);
    if (rc)
       {Eroute.Emsg("Config", rc, "list TPC path", aPath);
@@ -695,9 +712,11 @@ int XrdOfs::ConfigXeq(char *var, XrdOucStream &Config,
     TS_Bit("authorize",     Options, Authorize);
     TS_XPI("authlib",       theAutLib);
     TS_XPI("ckslib",        theCksLib);
+    TS_Xeq("cksinline",     xcksi);
     TS_Xeq("cksrdsz",       xcrds);
     TS_XPI("cmslib",        theCmsLib);
     TS_Xeq("forward",       xforward);
+    TS_Xeq("immutable",     ximm);
     TS_Xeq("maxdelay",      xmaxd);
     TS_Xeq("notify",        xnot);
     TS_Xeq("notifymsg",     xnmsg);
@@ -725,18 +744,54 @@ int XrdOfs::ConfigXeq(char *var, XrdOucStream &Config,
     return 0;
 }
 
+/******************************************************************************/
+/*                                 x c k s i                                  */
+/******************************************************************************/
+  
+/* Function: xcksi
+
+   Purpose:  To parse the directive: cksinline [<ckname>|off]
+
+             <ckname> the checksum to compute while a new file is written
+                      sequentially. The default checksum is used when not
+                      specified. The value is stored on close so that later
+                      checksum requests need not read the file again. Writes
+                      that arrive out of order fall back to the normal
+                      calculation. Specify off to disable.
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOfs::xcksi(XrdOucStream &Config, XrdSysError &Eroute)
+{
+   char *val = Config.GetWord();
+
+// Get the checksum name, if any
+//
+   if (CksInl) {free(CksInl); CksInl = 0;}
+   if (val && !strcmp(val, "off")) return 0;
+   if (val && strlen(val) >= XrdCksData::NameSize)
+      {Eroute.Emsg("Config", "cksinline checksum name too long"); return 1;}
+   CksInl = strdup(val ? val : "");
+   return 0;
+}
+
 /******************************************************************************/
 /*                                 x c r d s                                  */
 /******************************************************************************/
   
 /* Function: xcrds
 
-   Purpose:  To parse the directive: cksrdsz <size>
+   Purpose:  To parse the directive: cksrdsz <size> [parallel <n>]
 
              <size>  number of bytes to segment reads when calclulating a
                      checksum. Can be suffixed by k,m,g. Maximum is 1g and
                      is automatically set to be atleast 64k and to be a
                      multiple of 64k.
+             <n>     the number of file ranges that may be checksummed
+                     concurrently and then combined. This only applies to
+                     checksums that can be combined (adler32 and crc32).
+                     The default is 1 (i.e. sequential).
 
   Output: 0 upon success or !0 upon failure.
 */
@@ -746,6 +801,7 @@ int XrdOfs::xcrds(XrdOucStream &Config, XrdSysError &Eroute)
    static const long long maxRds = 1024*1024*1024;
    char *val;
    long long rdsz;
+   int rdpar = 1;
 
 // Get the size
 //
@@ -755,7 +811,21 @@ int XrdOfs::xcrds(XrdOucStream &Config, XrdSysError &Eroute)
 // Now convert it
 //
    if (XrdOuca2x::a2sz(Eroute, "cksrdsz size", val, &rdsz, 1, maxRds)) return 1;
-   ofsConfig->SetCksRdSz(static_cast<int>(rdsz));
+
+// Get the optional parallelism
+//
+   if ((val = Config.GetWord()) && val[0])
+      {if (strcmp(val, "parallel"))
+          {Eroute.Emsg("Config", "invalid cksrdsz option -", val); return 1;}
+       if (!(val = Config.GetWord()) || !val[0])
+          {Eroute.Emsg("Config", "cksrdsz parallel value not specified");
+           return 1;
+          }
+       if (XrdOuca2x::a2i(Eroute, "cksrdsz parallel", val, &rdpar, 1, 64))
+          return 1;
+      }
+
+   ofsConfig->SetCksRdSz(static_cast<int>(rdsz), rdpar);
    return 0;
 }
   
@@ -925,6 +995,46 @@ int XrdOfs::xforward(XrdOucStream &Config, XrdSysError &Eroute)
    return 0;
 }
   
+/******************************************************************************/
+/*                                  x i m m                                   */
+/******************************************************************************/
+
+/* Function: ximm
+
+   Purpose:  To parse the directive: immutable <path> [<path> ...]
+
+             <path>  the path prefix of files that are never modified while
+                     the server runs (e.g. a read-only dataset export). Files
+                     under it that are opened r/o get a handle of their own
+                     instead of sharing one per path, which spares concurrent
+                     opens and closes of popular files the handle locking.
+                     The directive may be repeated.
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOfs::ximm(XrdOucStream &Config, XrdSysError &Eroute)
+{
+   char *val;
+   int n = 0, plen;
+
+// Get each path, removing trailing slashes
+//
+   while((val = Config.GetWord()) && val[0])
+        {if (*val != '/')
+            {Eroute.Emsg("Config", "immutable path not absolute -", val);
+             return 1;
+            }
+         plen = strlen(val);
+         while(plen > 1 && val[plen-1] == '/') val[--plen] = 0;
+         immPaths = new XrdOucTList(val, plen, immPaths);
+         n++;
+        }
+
+   if (!n) {Eroute.Emsg("Config", "immutable path not specified"); return 1;}
+   return 0;
+}
+
 /******************************************************************************/
 /*                                 x m a x d                                  */
 /******************************************************************************/
@@ -1030,7 +1140,7 @@ int XrdOfs::xnmsg(XrdOucStream &Config, XrdSysError &Eroute)
 
 /* Function: xnot
 
-   Purpose:  Parse directive: notify <events> [msgs <min> [<max>]] 
+   Purpose:  Parse directive: notify <events> [msgs <min> [<max>]] [binary]
                                      {|<prog> | ><path>}
 
    Args:     <events> - one or more of: all chmod closer closew close mkdir mv
@@ -1038,7 +1148,10 @@ int XrdOfs::xnmsg(XrdOucStream &Config, XrdSysError &Eroute)
                         opaque and other possible information to be sent.
              msgs     - Maximum number of messages to keep and queue. The
                         <min> if for small messages (default 90) and <max> is
-                        for big messages (default 10).
+                        for big messages (default 10). Together they size
+                        the event queue; events are dropped when it is full.
+             binary   - send events as binary records (see XrdOfsEvsRecord)
+                        instead of formatted text messages.
              <prog>   - is the program to execute and dynamically feed messages
                         about the indicated events. Messages are piped to prog.
              <path>   - is the udp named socket to receive the message. The
@@ -1069,6 +1182,7 @@ int XrdOfs::xnot(XrdOucStream &Config, XrdSysError &Eroute)
     XrdOfsEvs::Event noval = XrdOfsEvs::None;
     int numopts = sizeof(noopts)/sizeof(struct notopts);
     int i, neg, msgL = 90, msgB = 10;
+    bool binary = false;
     char *val, parms[1024];
 
     if (!(val = Config.GetWord()))
@@ -1086,6 +1200,8 @@ int XrdOfs::xnot(XrdOucStream &Config, XrdSysError &Eroute)
               if (!(val = Config.GetWord())) break;
               continue;
              }
+          if (!strcmp(val, "binary"))
+             {binary = true; val = Config.GetWord(); continue;}
           if ((neg = (val[0] == '-' && val[1]))) val++;
           i = strlen(val);
           for (i = 0; i < numopts; i++)
@@ -1115,7 +1231,7 @@ int XrdOfs::xnot(XrdOucStream &Config, XrdSysError &Eroute)
 // Create an notification object
 //
    if (evsObject) delete evsObject;
-   evsObject = new XrdOfsEvs(noval, val, msgL, msgB);
+   evsObject = new XrdOfsEvs(noval, val, msgL, msgB, binary);
 
 // All done
 //
@@ -1130,12 +1246,15 @@ int XrdOfs::xnot(XrdOucStream &Config, XrdSysError &Eroute)
 
    Purpose:  To parse the directive: persist [auto | manual | off]
                                              [hold <sec>] [logdir <dirp>]
+                                             [sync <msec>]
 
              auto      POSC processing always on for creation requests
              manual    POSC processing must be requested (default)
              off       POSC processing is disabled
              <sec>     Seconds inclomplete files held (default 10m)
              <dirp>    Directory to hold POSC recovery log (default adminpath)
+             <msec>    Millseconds a recovery log sync waits for concurrent
+                       creates to join it (default 1, 0 never waits)
 
    Output: 0 upon success or !0 upon failure.
 */
@@ -1143,7 +1262,7 @@ int XrdOfs::xnot(XrdOucStream &Config, XrdSysError &Eroute)
 int XrdOfs::xpers(XrdOucStream &Config, XrdSysError &Eroute)
 {
    char *val;
-   int htime = -1, popt = -2;
+   int htime = -1, popt = -2, stime = -1;
 
    if (!(val = Config.GetWord()))
       {Eroute.Emsg("Config","persist option not specified");return 1;}
@@ -1169,6 +1288,14 @@ int XrdOfs::xpers(XrdOucStream &Config, XrdSysError &Eroute)
                   if (XrdOuca2x::a2tm(Eroute,"persist hold",val,&htime,0))
                       return 1;
                  }
+         else if (!strcmp(val, "sync"))
+                 {if (!(val = Config.GetWord()))
+                     {Eroute.Emsg("Config","persist sync value not specified");
+                      return 1;
+                     }
+                  if (XrdOuca2x::a2i(Eroute,"persist sync",val,&stime,0,1000))
+                      return 1;
+                 }
          else if (!strcmp(val, "logdir"))
                  {if (!(val = Config.GetWord()))
                      {Eroute.Emsg("Config","persist logdir path not specified");
@@ -1184,6 +1311,7 @@ int XrdOfs::xpers(XrdOucStream &Config, XrdSysError &Eroute)
 // Set values as needed
 //
    if (htime >= 0) poscHold = htime;
+   if (stime >= 0) poscSync = stime;
    if (popt  > -2) poscAuto = popt;
    return 0;
 }
@@ -1307,7 +1435,8 @@ int XrdOfs::xrole(XrdOucStream &Config, XrdSysError &Eroute)
                                          [restrict <path>]
                                          [streams <num>[,<max>]]
                                          [echo] [scan {stderr | stdout}]
-                                         [autorm] [pgm <path> [parms]]
+                                         [autorm] [engine <path>]
+                                         [pgm <path> [parms]]
                                          [fcreds  [?]<auth> =<evar>]
                                          [fcpath <path>]
 
@@ -1330,6 +1459,9 @@ int XrdOfs::xrole(XrdOucStream &Config, XrdSysError &Eroute)
                      the authentication's session key.
              echo    echo the pgm's output to the log.
              autorm  Remove file when copy fails.
+             engine  the path to the in-process copy engine plugin. Copies
+                     are run by the engine within the server and only jobs
+                     the engine declines are run by the pgm.
              scan    scan fr error messages either in stderr or stdout. The
                      default is to scan both.
              pgm     specifies the transfer command with optional paramaters.
@@ -1376,6 +1508,13 @@ int XrdOfs::xtpc(XrdOucStream &Config, XrdSysError &Eroute)
          if (!strcmp(val, "echo"))  {Parms.xEcho = 1; continue;}
          if (!strcmp(val, "logok")) {Parms.Logok = 1; continue;}
          if (!strcmp(val, "autorm")){Parms.autoRM = 1; continue;}
+         if (!strcmp(val, "engine"))
+            {if (!(val = Config.GetWord()))
+                {Eroute.Emsg("Config","tpc engine path not specified"); return 1;}
+             if (Parms.Eng) free(Parms.Eng);
+             Parms.Eng = strdup(val);
+             continue;
+            }
          if (!strcmp(val, "pgm"))
             {if (!Config.GetRest(pgm, sizeof(pgm)))
                 {Eroute.Emsg("Config", "tpc command line too long"); return 1;}
@@ -88,7 +88,7 @@ XrdOfsConfigPI::XrdOfsConfigPI(const char  *cfn,  XrdOucStream   *cfgP,
                                XrdSysError *errP, XrdVersionInfo *verP)
                  : autPI(0), cksPI(0), cmsPI(0), ossPI(0), urVer(verP),
                    Config(cfgP),  Eroute(errP), CksConfig(0), ConfigFN(cfn),
-                   CksAlg(0), CksRdsz(0), ossXAttr(false), ossCksio(false),
+                   CksAlg(0), CksRdsz(0), CksRdPar(1), ossXAttr(false), ossCksio(false),
                    Loaded(false), LoadOK(false), cksLcl(false)
 {
    int rc;
@@ -224,7 +224,9 @@ bool XrdOfsConfigPI::Load(int loadLib, XrdOucEnv *envP)
                                   "incompatible versions.");
            return false;
           }
-       cksPI = CksConfig->Configure(CksAlg, CksRdsz, (ossCksio ? ossPI : 0));
+       cksPI = CksConfig->Configure(CksAlg, CksRdsz, (ossCksio ? ossPI : 0),
+                CksRdPar, (envP ? (XrdScheduler *)envP->GetPtr("XrdScheduler*")
+                                : 0));
        if (!cksPI) return false;
       }
 
@@ -444,7 +446,11 @@ bool XrdOfsConfigPI::RepLib(XrdOfsConfigPI::TheLib what,
 /*                            S e t C k s R d S z                             */
 /******************************************************************************/
 
-void   XrdOfsConfigPI::SetCksRdSz(int rdsz) {CksRdsz = rdsz;}
+void   XrdOfsConfigPI::SetCksRdSz(int rdsz, int rdpar)
+{
+   CksRdsz  = rdsz;
+   CksRdPar = rdpar;
+}
   
 /******************************************************************************/
 /* Private:                    S e t u p A t t r                              */
@@ -183,9 +183,11 @@ bool   Plugin(XrdOss          *&piP);    //!< Get Oss plugin
 //! Set the checksum read size
 //!
 //! @param   rdsz    The chesum read size buffer.
+//! @param   rdpar   The number of file ranges that may be checksummed in
+//!                  parallel by the default checksum manager.
 //-----------------------------------------------------------------------------
 
-void   SetCksRdSz(int rdsz);
+void   SetCksRdSz(int rdsz, int rdpar=1);
 
 //-----------------------------------------------------------------------------
 //! Destructor
@@ -240,6 +242,7 @@ struct xxxLP
       }       LP[maxXXXLib];
 char         *CksAlg;
 int           CksRdsz;
+int           CksRdPar;
 bool          defLib[maxXXXLib];
 bool          ossXAttr;
 bool          ossCksio;
@@ -35,7 +35,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <sys/stat.h>
+#include <arpa/inet.h>
 
 #include "XrdOfs/XrdOfsEvs.hh"
 #include "XrdSys/XrdSysError.hh"
@@ -53,15 +55,12 @@ class XrdOfsEvsMsg
 {
 public:
 
-XrdOfsEvsMsg *next;
-char         *text;
-int           tlen;
-int           isBig;
+std::atomic<uint64_t> seq;   // Slot sequence number (see XrdOfsEvs.hh)
+int                   tlen;
+char                  text[XrdOfsEvs::maxMsgSize];
 
-             XrdOfsEvsMsg(char *tval=0, int big=0)
-                        {text = tval; tlen=0; isBig = big; next=0;}
-
-            ~XrdOfsEvsMsg() {if (text) free(text);}
+             XrdOfsEvsMsg() : seq(0), tlen(0) {}
+            ~XrdOfsEvsMsg() {}
 };
 
 /******************************************************************************/
@@ -115,8 +114,11 @@ void XrdOfsEvsFormat::Def(evFlags theFlags, const char *Fmt, ...)
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
   
-XrdOfsEvs::XrdOfsEvs(Event theEvents, const char *Target, int minq, int maxq)
+XrdOfsEvs::XrdOfsEvs(Event theEvents, const char *Target, int minq, int maxq,
+                     bool binary) : enqPos(0), deqPos(0), qSleep(false)
 {
+   uint64_t qSize = 16;
+   int i;
 
 // Set common variables
 //
@@ -126,11 +128,20 @@ XrdOfsEvs::XrdOfsEvs(Event theEvents, const char *Target, int minq, int maxq)
    eDest = 0; 
    theProg = 0;
    maxMin = minq; maxMax = maxq;
-   msgFirst = msgLast = msgFreeMax = msgFreeMin = 0;
-   numMax = numMin = 0; 
+   binFmt = binary;
    tid = 0;
    msgFD = -1;
 
+// Allocate the event queue and the batch buffer
+//
+   while(qSize < static_cast<uint64_t>(minq + maxq) && qSize < 65536) qSize <<= 1;
+   msgRing  = new XrdOfsEvsMsg[qSize];
+   ringMask = qSize - 1;
+   for (uint64_t j = 0; j < qSize; j++) msgRing[j].seq.store(j);
+   for (i = 0; i < nCount; i++) numDrop[i].store(0);
+   repDrop   = 0;
+   batchBuff = (char *)malloc(batchSize);
+
 // Initialize all static format entries that have not been initialized yet.
 // Note that format may be specified prior to this object being created!
 //
@@ -201,30 +212,38 @@ XrdOfsEvs::XrdOfsEvs(Event theEvents, const char *Target, int minq, int maxq)
 
 XrdOfsEvs::~XrdOfsEvs()
 {
-  XrdOfsEvsMsg *tp;
 
-// Kill the notification thread. This may cause a msg block to be orphaned
+// Kill the notification thread. This may cause a queued event to be lost
 // but, in practice, this object does not really get deleted after being 
 // started. So, the problem is moot.
 //
    endIT = 1;
    if (tid) XrdSysThread::Kill(tid);
 
-// Release all queued message bocks
+// Release the queue and everything else
 //
-  qMut.Lock();
-  while ((tp = msgFirst)) {msgFirst = tp->next; delete tp;}
+  delete [] msgRing;
+  free(batchBuff);
   if (theTarget) free(theTarget);
   if (msgFD >= 0)close(msgFD);
   if (theProg)   delete theProg;
-  qMut.UnLock();
+}
 
-// Release all free message blocks
-//
-  fMut.Lock();
-  while ((tp = msgFreeMax)) {msgFreeMax = tp->next; delete tp;}
-  while ((tp = msgFreeMin)) {msgFreeMin = tp->next; delete tp;}
-  fMut.UnLock();
+/******************************************************************************/
+/*                               D r o p p e d                                */
+/******************************************************************************/
+
+long long XrdOfsEvs::Dropped(Event eNum)
+{
+   long long num = 0;
+
+   if (eNum != All)
+      {int i = eNum & Mask;
+       return (i < nCount ? numDrop[i].load(std::memory_order_relaxed) : 0);
+      }
+   for (int i = 0; i < nCount; i++)
+       num += numDrop[i].load(std::memory_order_relaxed);
+   return num;
 }
 
 /******************************************************************************/
@@ -233,51 +252,59 @@ XrdOfsEvs::~XrdOfsEvs()
   
 void XrdOfsEvs::Notify(Event eID, XrdOfsEvsInfo &Info)
 {
-   static int warnings = 0;
    XrdOfsEvsFormat *fP;
    XrdOfsEvsMsg *tp;
    char modebuff[8], sizebuff[16];
-   int eNum, isBig = (eID & Mv), msgSize = (isBig ? maxMsgSize : minMsgSize);
+   uint64_t pos, seq;
+   int eNum, n;
 
 // Validate event number and set event name
 //
    eNum = eID & Mask;
    if (eNum < 0 || eNum >= nCount) return;
 
-// Check if we need to do any conversions
-//
-   fP = &MsgFmt[eNum];
-   if (fP->Flags & XrdOfsEvsFormat::cvtMode)
-      {sprintf(modebuff, "%o", static_cast<int>((Info.FMode() & S_IAMB)));
-       Info.Set(XrdOfsEvsInfo::evFMODE, modebuff);
-      } else Info.Set(XrdOfsEvsInfo::evFMODE, "$FMODE");
-   if (fP->Flags & XrdOfsEvsFormat::cvtFSize)
-      {sprintf(sizebuff, "%lld", Info.FSize());
-       Info.Set(XrdOfsEvsInfo::evFSIZE, sizebuff);
-      } else Info.Set(XrdOfsEvsInfo::evFSIZE, "$FSIZE");
-
-// Get a message block
-//
-   if (!(tp = getMsg(isBig)))
-      {if ((++warnings & 0xff) == 1)
-         {eDest->Emsg("Notify", "Ran out of message objects;", eName(eNum),
-                                "event notification not sent.");
-         }
-       return;
-      }
-
-// Format the message
+// Claim a queue slot. If the queue is full we drop the event; the sender
+// thread reports how many were lost. We never wait for the receiver.
 //
-   tp->tlen = fP->SNP(Info, tp->text, msgSize);
+   pos = enqPos.load(std::memory_order_relaxed);
+   while(1)
+        {tp  = &msgRing[pos & ringMask];
+         seq = tp->seq.load(std::memory_order_acquire);
+         if (seq == pos)
+            {if (enqPos.compare_exchange_weak(pos, pos+1,
+                                              std::memory_order_relaxed)) break;
+            }
+            else if (seq < pos)
+                    {numDrop[eNum].fetch_add(1, std::memory_order_relaxed);
+                     return;
+                    }
+                    else pos = enqPos.load(std::memory_order_relaxed);
+        }
 
-// Put the message on the queue and return
-//
-   tp->next = 0;
-   qMut.Lock();
-   if (msgLast) {msgLast->next = tp; msgLast = tp;}
-      else msgFirst = msgLast = tp;
-   qMut.UnLock();
-   qSem.Post();
+// Format the event directly into the slot
+//
+   if (binFmt) tp->tlen = Pack(eNum, Info, tp->text, maxMsgSize);
+      else {fP = &MsgFmt[eNum];
+            if (fP->Flags & XrdOfsEvsFormat::cvtMode)
+               {sprintf(modebuff, "%o", static_cast<int>((Info.FMode()&S_IAMB)));
+                Info.Set(XrdOfsEvsInfo::evFMODE, modebuff);
+               } else Info.Set(XrdOfsEvsInfo::evFMODE, "$FMODE");
+            if (fP->Flags & XrdOfsEvsFormat::cvtFSize)
+               {sprintf(sizebuff, "%lld", Info.FSize());
+                Info.Set(XrdOfsEvsInfo::evFSIZE, sizebuff);
+               } else Info.Set(XrdOfsEvsInfo::evFSIZE, "$FSIZE");
+            if ((n = fP->SNP(Info, tp->text, maxMsgSize)) < 0) n = 0;
+               else if (n >= maxMsgSize)
+                       {n = maxMsgSize-1; tp->text[n-1] = '\n';}
+            tp->tlen = n;
+           }
+
+// Publish the event and wake up the sender if it is sleeping
+//
+   tp->seq.store(pos+1, std::memory_order_release);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   if (qSleep.load(std::memory_order_relaxed) && qSleep.exchange(false))
+      qSem.Post();
 }
 
 /******************************************************************************/
@@ -365,26 +392,44 @@ void XrdOfsEvs::sendEvents(void)
    XrdOfsEvsMsg *tp;
    const char *theData[2] = {0,0};
          int   theDlen[2] = {0,0};
+   int bLen;
 
 // This is an endless loop that just gets things off the event queue and
 // send them out. This allows us to only hang a simgle thread should the
-// receiver get blocked, instead of the whole process.
-//
-   while(1)
-        {qSem.Wait();
-         qMut.Lock();
-         if (endIT) break;
-         if ((tp = msgFirst) && !(msgFirst = tp->next)) msgLast = 0;
-         qMut.UnLock();
-         if (tp) 
-            {if (!theProg) Feed(tp->text, tp->tlen);
-                else {theData[0] = tp->text; theDlen[0] = tp->tlen;
+// receiver get blocked, instead of the whole process. Whatever is ready is
+// copied into the batch buffer, freeing the slots, and sent in one write.
+//
+   while(!endIT)
+        {bLen = 0;
+         while(1)
+              {tp = &msgRing[deqPos & ringMask];
+               if (tp->seq.load(std::memory_order_acquire) != deqPos+1
+               ||  bLen + tp->tlen > batchSize) break;
+               memcpy(batchBuff+bLen, tp->text, tp->tlen);
+               bLen += tp->tlen;
+               tp->seq.store(deqPos+ringMask+1, std::memory_order_release);
+               deqPos++;
+              }
+
+         if (bLen)
+            {if (!theProg) Feed(batchBuff, bLen);
+                else {theData[0] = batchBuff; theDlen[0] = bLen;
                       theProg->Feed(theData, theDlen);
                      }
-             retMsg(tp);
+             Report();
+             continue;
             }
-         }
-   qMut.UnLock();
+
+      // Nothing is ready. Go to sleep unless an event was published after we
+      // looked, in which case whoever cleared qSleep will post the semaphore.
+      //
+         qSleep.store(true);
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+         tp = &msgRing[deqPos & ringMask];
+         if (tp->seq.load(std::memory_order_acquire) == deqPos+1
+         &&  qSleep.exchange(false)) continue;
+         qSem.Wait();
+        }
 }
 
 /******************************************************************************/
@@ -460,14 +505,18 @@ int XrdOfsEvs::Feed(const char *data, int dlen)
 {
    int retc;
 
-// Write the data. ince this is a udp socket all the data goes or none does
+// Write the data. A batch may exceed what the fifo takes in one write so we
+// keep writing until all of it has been sent.
 //
-  do { retc = write(msgFD, (const void *)data, (size_t)dlen);}
-       while (retc < 0 && errno == EINTR);
-  if (retc < 0)
-     {eDest->Emsg("EvsFeed", errno, "write to event socket", theTarget);
-      return -1;
-     }
+  while(dlen > 0)
+       {do { retc = write(msgFD, (const void *)data, (size_t)dlen);}
+            while (retc < 0 && errno == EINTR);
+        if (retc < 0)
+           {eDest->Emsg("EvsFeed", errno, "write to event socket", theTarget);
+            return -1;
+           }
+        data += retc; dlen -= retc;
+       }
 
 // All done
 //
@@ -475,63 +524,59 @@ int XrdOfsEvs::Feed(const char *data, int dlen)
 }
 
 /******************************************************************************/
-/*                                g e t M s g                                 */
+/*                                  P a c k                                   */
 /******************************************************************************/
 
-XrdOfsEvsMsg *XrdOfsEvs::getMsg(int bigmsg)
+int XrdOfsEvs::Pack(int eNum, XrdOfsEvsInfo &Info, char *buff, int blen)
 {
-   XrdOfsEvsMsg *tp;
-   int msz = 0;
-
-// Lock the free queue
-//
-   fMut.Lock();
-
-// Get a free element from the big or small queue, as needed
-//
-   if (bigmsg)
-        if ((tp = msgFreeMax)) msgFreeMax = tp->next;
-           else msz = maxMsgSize;
-   else if ((tp = msgFreeMin)) msgFreeMin = tp->next;
-           else msz = minMsgSize;
-
-// Check if we have to allocate a new item
-//
-   if (!tp && (numMax + numMin) < (maxMax + maxMin))
-      {if ((tp = new XrdOfsEvsMsg((char *)malloc(msz), bigmsg)))
-          {if (!(tp->text)) {delete tp; tp = 0;}
-              else if (bigmsg) numMax++;
-                      else     numMin++;
-          }
-      }
-
-// Unlock and return result
-//
-   fMut.UnLock();
-   return tp;
+   static const XrdOfsEvsInfo::evArg theArgs[] =
+                {XrdOfsEvsInfo::evTID,  XrdOfsEvsInfo::evLFN1,
+                 XrdOfsEvsInfo::evCGI1, XrdOfsEvsInfo::evLFN2,
+                 XrdOfsEvsInfo::evCGI2};
+   static const int numArgs = sizeof(theArgs)/sizeof(theArgs[0]);
+   XrdOfsEvsRecord theRec;
+   char *bP = buff + sizeof(theRec), *bE = buff + blen;
+   const char *aVal;
+   int i, n, aMax;
+
+// Copy the strings, truncating them when they do not fit while leaving room
+// for the null byte of each one that is still to come.
+//
+   for (i = 0; i < numArgs; i++)
+       {if (i > 2 && eNum != (Mv & Mask)) aVal = "";
+           else if (!(aVal = Info.Val(theArgs[i]))) aVal = "";
+        aMax = bE - bP - (numArgs - i - 1);
+        if ((n = strlcpy(bP, aVal, aMax)) >= aMax) n = aMax - 1;
+        bP += n + 1;
+       }
+
+// Fill out the header
+//
+   theRec.rLen  = htons(static_cast<uint16_t>(bP - buff));
+   theRec.eNum  = static_cast<uint8_t>(eNum);
+   theRec.Rsvd  = 0;
+   theRec.fMode = htonl(static_cast<uint32_t>(Info.FMode() & S_IAMB));
+   theRec.fSize = htonll(Info.FSize());
+   memcpy(buff, &theRec, sizeof(theRec));
+   return bP - buff;
 }
 
 /******************************************************************************/
-/*                                r e t M s g                                 */
+/*                                R e p o r t                                 */
 /******************************************************************************/
 
-void XrdOfsEvs::retMsg(XrdOfsEvsMsg *tp)
+void XrdOfsEvs::Report()
 {
-
-// Lock the free queue
-//
-   fMut.Lock();
-
-// Check if we exceeded the hold quotax
-//
-   if (tp->isBig)
-      if (numMax > maxMax) {delete tp; numMax--;}
-         else {tp->next = msgFreeMax; msgFreeMax = tp;}
-      else
-      if (numMin > maxMin) {delete tp; numMin--;}
-         else {tp->next = msgFreeMin; msgFreeMin = tp;}
-
-// Unlock and return
-//
-   fMut.UnLock();
+   static time_t lastRep = 0;
+   long long numNow = Dropped();
+   time_t    tNow;
+   char      buff[64];
+
+// Report the number of events dropped since the last report, at most once a
+// minute so that a stuck receiver does not flood the log.
+//
+   if (numNow == repDrop || (tNow = time(0)) < lastRep + 60) return;
+   snprintf(buff, sizeof(buff), "%lld", numNow - repDrop);
+   eDest->Emsg("Notify", buff, "event notifications dropped; event queue full.");
+   repDrop = numNow; lastRep = tNow;
 }
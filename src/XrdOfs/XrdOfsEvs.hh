@@ -31,6 +31,8 @@
 /*             Based on code developed by Derek Feichtinger, CERN.            */
 /******************************************************************************/
 
+#include <atomic>
+#include <stdint.h>
 #include <strings.h>
 #include "XrdSys/XrdSysPthread.hh"
 
@@ -117,6 +119,21 @@ const char                *Format;
 /*                             X r d O f s E v s                              */
 /******************************************************************************/
   
+/* When the "binary" option of ofs.notify is used, events are not formatted
+   as text but sent as the records below, each followed by the null terminated
+   tid, lfn, cgi, lfn2 and cgi2 (lfn2 and cgi2 are empty unless the event is a
+   mv). All binary values are in network byte order and many records are
+   usually sent in a single write.
+*/
+struct XrdOfsEvsRecord
+{
+uint16_t    rLen;      // Length of the record including this header
+uint8_t     eNum;      // Event number (i.e. XrdOfsEvs::Event & Mask)
+uint8_t     Rsvd;
+uint32_t    fMode;     // File mode (create, chmod, mkdir) or zero
+int64_t     fSize;     // File size (trunc) or zero
+};
+
 class XrdOfsEvs
 {
 public:
@@ -141,6 +158,13 @@ int         Enabled(Event theEvents) {return theEvents & enEvents;}
 int         maxSmsg() {return maxMin;}
 int         maxLmsg() {return maxMax;}
 
+int         isBinary() {return binFmt;}
+
+// Return the number of events of a kind (or all events) dropped because the
+// event queue was full.
+//
+long long   Dropped(Event eNum=All);
+
 void        Notify(Event eNum, XrdOfsEvsInfo &Info);
 
 static int  Parse(XrdSysError &Eroute, Event eNum, char *mText);
@@ -151,34 +175,47 @@ void        sendEvents(void);
 
 int         Start(XrdSysError *eobj);
 
-      XrdOfsEvs(Event theEvents, const char *Target, int minq=90, int maxq=10);
+// The queue holds minq+maxq events, rounded up to a power of two.
+//
+      XrdOfsEvs(Event theEvents, const char *Target, int minq=90, int maxq=10,
+                bool binary=false);
      ~XrdOfsEvs();
 
 private:
 const char     *eName(int eNum);
 int             Feed(const char *data, int dlen);
-XrdOfsEvsMsg   *getMsg(int bigmsg);
-void            retMsg(XrdOfsEvsMsg *tp);
+int             Pack(int eNum, XrdOfsEvsInfo &Info, char *buff, int blen);
+void            Report();
 
 static XrdOfsEvsFormat MsgFmt[XrdOfsEvs::nCount];
 
+static const int batchSize = 65536;
+
+// Events are queued in a bounded multi-producer ring. A producer claims a slot
+// by advancing enqPos and publishes it by setting the slot's sequence number;
+// the sender thread drains whatever is ready into one write. A full ring drops
+// the event and counts it. The sender only sleeps after setting qSleep, which
+// producers check after publishing.
+//
+XrdOfsEvsMsg   *msgRing;
+uint64_t        ringMask;
+std::atomic<uint64_t> enqPos;
+uint64_t        deqPos;
+std::atomic<bool> qSleep;
+std::atomic<long long> numDrop[nCount];
+long long       repDrop;
+char           *batchBuff;
+
 pthread_t       tid;
 char           *theTarget;
 Event           enEvents;
 XrdSysError    *eDest;
 XrdOucProg     *theProg;
-XrdSysMutex     qMut;
 XrdSysSemaphore qSem;
-XrdOfsEvsMsg   *msgFirst;
-XrdOfsEvsMsg   *msgLast;
-XrdSysMutex     fMut;
-XrdOfsEvsMsg   *msgFreeMax;
-XrdOfsEvsMsg   *msgFreeMin;
-int             endIT;
+volatile int    endIT;
 int             msgFD;
-int             numMax;
 int             maxMax;
-int             numMin;
 int             maxMin;
+bool            binFmt;
 };
 #endif
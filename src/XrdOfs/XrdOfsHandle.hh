@@ -130,12 +130,20 @@ char                isPending;    // 1-> File  is pending sync()
 char                isChanged;    // 1-> File was modified
 char                isCompressed; // 1-> File  is compressed
 char                isRW;         // T-> File  is open in r/w mode
+char                isCksInl;     // 1-> Inline checksum still matches the file
+char                isPrivate;    // 1-> Handle is not shared (not in a table)
 
 void                Activate(XrdOssDF *ssP) {ssi = ssP;}
 
 static const int    opRW = 1;
 static const int    opPC = 3;
+static const int    opPV = 4;     // Private r/o handle, see Alloc()
 
+// Opts is opRW or opPC for r/w handles. When opPV is set the handle is never
+// shared: it is not looked up nor entered in the handle table so that opens
+// of the same path never wait on one another. Only valid for files that are
+// open r/o and never modified while open (see ofs.immutable).
+//
 static       int    Alloc(const char *thePath,int Opts,XrdOfsHandle **Handle);
 static       int    Alloc(                             XrdOfsHandle **Handle);
 
@@ -170,7 +178,10 @@ inline       void   UnLock() {hMutex.UnLock();}
          ~XrdOfsHandle() {int retc; Retire(retc);}
 
 private:
-static int           Alloc(XrdOfsHanKey, int Opts, XrdOfsHandle **Handle);
+struct               HanShard;
+
+static int           Alloc(HanShard &hS, XrdOfsHanKey, int Opts,
+                           XrdOfsHandle **Handle);
        int           WaitLock(void);
 
 static const int     LockTries =   3; // Times to try for a lock
@@ -178,11 +189,28 @@ static const int     LockWait  = 333; // Mills to wait between tries
 static const int     nolokDelay=   3; // Secs to delay client when lock failed
 static const int     nomemDelay=  15; // Secs to delay client when ENOMEM
 
-static XrdSysMutex   myMutex;
-static XrdOfsHanTab  roTable;    // File handles open r/o
-static XrdOfsHanTab  rwTable;    // File Handles open r/w
+// Handles are spread over shards by the high order bits of the path hash. Each
+// shard has its own lock which protects its tables, free list, and the link
+// count of every handle whose path hashes to the shard.
+//
+static const int     shardBits = 5;
+static const int     shardNum  = 1 << shardBits;
+
+struct HanShard
+      {XrdSysMutex   Mutex;
+       XrdOfsHanTab  roTable;    // File handles open r/o
+       XrdOfsHanTab  rwTable;    // File Handles open r/w
+       XrdOfsHandle *Free;       // List of free handles
+
+                     HanShard() : roTable(89, 144), rwTable(89, 144), Free(0) {}
+      };
+
+static inline
+HanShard            &Shard(const XrdOfsHanKey &Key)
+                          {return Shards[Key.Hash >> (32 - shardBits)];}
+
+static HanShard      Shards[shardNum];
 static XrdOssDF     *ossDF;      // Dummy storage sysem
-static XrdOfsHandle *Free;       // List of free handles
 
        XrdSysMutex   hMutex;
        XrdOssDF     *ssi;        // Storage System Interface
@@ -50,7 +50,8 @@
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
 
-XrdOfsPoscq::XrdOfsPoscq(XrdSysError *erp, XrdOss *oss, const char *fn)
+XrdOfsPoscq::XrdOfsPoscq(XrdSysError *erp, XrdOss *oss, const char *fn,
+                         int syncms) : syncCV(0, "poscq sync")
 {
    eDest = erp;
    ossFS = oss;
@@ -59,6 +60,10 @@ XrdOfsPoscq::XrdOfsPoscq(XrdSysError *erp, XrdOss *oss, const char *fn)
    pocSZ = 0;
    pocIQ = 0;
    SlotList = SlotLust = 0;
+   syncWrt  = syncDone = 0;
+   syncIn   = 0;
+   syncMS   = (syncms < 0 ? 0 : syncms);
+   syncBusy = false;
 }
   
 /******************************************************************************/
@@ -276,17 +281,74 @@ void XrdOfsPoscq::FailIni(const char *txt)
    eDest->Emsg("Init", errno, txt, pocFN);
 }
 
+/******************************************************************************/
+/*                               r e q S y n c                                */
+/******************************************************************************/
+
+// Called with the record written and counted in syncIn. Returns 0 upon success
+// or -1 with errno set when the sync that was to cover the record failed.
+//
+int XrdOfsPoscq::reqSync()
+{
+   long long mySeq, upTo;
+   int rc;
+
+// Account for our record and wake up a leader waiting for writers to join
+//
+   syncCV.Lock();
+   mySeq = ++syncWrt;
+   if (!--syncIn) syncCV.Broadcast();
+
+// Wait for a sync that covers our record or lead the next one. A failed sync
+// does not advance syncDone so that every writer in the group tries on its own
+// and gets its own error.
+//
+   while(syncDone < mySeq)
+        {if (syncBusy) {syncCV.Wait(); continue;}
+         syncBusy = true;
+         if (syncMS && syncIn) syncCV.WaitMS(syncMS);
+         upTo = syncWrt;
+         syncCV.UnLock();
+         rc = fdatasync(pocFD);
+         syncCV.Lock();
+         syncBusy = false;
+         syncCV.Broadcast();
+         if (rc)
+            {rc = errno;
+             syncCV.UnLock();
+             errno = rc;
+             return -1;
+            }
+         if (upTo > syncDone) syncDone = upTo;
+        }
+   syncCV.UnLock();
+   return 0;
+}
+
 /******************************************************************************/
 /*                              r e q W r i t e                               */
 /******************************************************************************/
   
-int XrdOfsPoscq::reqWrite(void *Buff, int Bsz, int Offs)
+int XrdOfsPoscq::reqWrite(void *Buff, int Bsz, int Offs, bool doSync)
 {
    int rc = 0;
 
+// Only full records are synced, short updates hit the disk with the next sync
+//
+   doSync = doSync && Bsz > 8;
+   if (doSync) {syncCV.Lock(); syncIn++; syncCV.UnLock();}
+
    do {rc = pwrite(pocFD, Buff, Bsz, Offs);} while(rc < 0 && errno == EINTR);
 
-   if (rc >= 0 && Bsz > 8) rc = fsync(pocFD);
+   if (doSync)
+      {if (rc >= 0) rc = reqSync();
+          else {int ec = errno;
+                syncCV.Lock();
+                if (!--syncIn) syncCV.Broadcast();
+                syncCV.UnLock();
+                errno = ec;
+               }
+      }
 
    if (rc < 0) {eDest->Emsg("reqWrite",errno,"write", pocFN); return 0;}
    return 1;
@@ -313,14 +375,17 @@ int XrdOfsPoscq::ReWrite(XrdOfsPoscq::recEnt *rP)
    oldFD = pocFD; pocFD = newFD;
    oldFN = pocFN; pocFN = newFN;
 
-// Rewrite all records if we have any
+// Rewrite all records if we have any and sync them all at once
 //
    while(rP)
         {rP->Offset = Offs;
-         if (!reqWrite((void *)&rP->reqData, ReqSize, Offs)) {aOK = 0; break;}
+         if (!reqWrite((void *)&rP->reqData, ReqSize, Offs, false))
+            {aOK = 0; break;}
          Offs += ReqSize;
          rP = rP->Next;
         }
+   if (aOK && Offs > ReqOffs && fdatasync(newFD))
+      {eDest->Emsg("ReWrite",errno,"sync",newFN); aOK = 0;}
 
 // If all went well, rename the file
 //
@@ -72,13 +72,20 @@ static recEnt *List(XrdSysError *Say, const char *theFN);
 
 inline int     Num() {return pocIQ;}
 
-               XrdOfsPoscq(XrdSysError *erp, XrdOss *oss, const char *fn);
+// Records are made durable by group commit: a record added while another is
+// being synced is synced by the next fdatasync(), issued by a single thread on
+// behalf of all of them. The leader of a group waits up to syncMS milliseconds
+// for writers still writing their records to join it (0 does not wait).
+//
+               XrdOfsPoscq(XrdSysError *erp, XrdOss *oss, const char *fn,
+                           int syncms=1);
               ~XrdOfsPoscq() {}
 
 private:
 void   FailIni(const char *lfn);
 int    reqRead(void *Buff, int Offs);
-int    reqWrite(void *Buff, int Bsz, int Offs);
+int    reqSync();
+int    reqWrite(void *Buff, int Bsz, int Offs, bool doSync=true);
 int    ReWrite(recEnt *rP);
 int    VerOffset(const char *Lfn, int Offset);
 
@@ -88,6 +95,12 @@ struct FileSlot
       };
 
 XrdSysMutex  myMutex;
+XrdSysCondVar syncCV;
+long long    syncWrt;   // Number of records written (under syncCV)
+long long    syncDone;  // Number of records known to be durable
+int          syncIn;    // Writers between their write and reqSync()
+int          syncMS;    // Maximum time a group leader waits for others
+bool         syncBusy;  // A group leader is syncing
 XrdSysError *eDest;
 XrdOss      *ossFS;
 FileSlot    *SlotList;
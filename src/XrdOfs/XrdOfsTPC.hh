@@ -79,6 +79,7 @@ const char   *credPath() {return cPath;}
 virtual void  Del() {}
 
 struct  iParm {char *Pgm;
+               char *Eng;
                char *Ckst;
                char *cpath;
                int   fCreds;
@@ -91,7 +92,7 @@ struct  iParm {char *Pgm;
                int   Grab;
                int   xEcho;
                int   autoRM;
-                     iParm() : Pgm(0), Ckst(0), cpath(0), fCreds(0),
+                     iParm() : Pgm(0), Eng(0), Ckst(0), cpath(0), fCreds(0),
                                Dflttl(-1), Maxttl(-1),
                                Logok(-1), Strm(-1), SMax(64), Xmax(-1), Grab(0),
                                xEcho(-1), autoRM(-1) {}
@@ -0,0 +1,285 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O f s T P C C l . c c                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <string>
+
+#include "XProtocol/XProtocol.hh"
+#include "XrdCl/XrdClCopyProcess.hh"
+#include "XrdCl/XrdClPropertyList.hh"
+#include "XrdCl/XrdClXRootDResponses.hh"
+#include "XrdOfs/XrdOfsTPCEngine.hh"
+#include "XrdOuc/XrdOucCRC.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysFD.hh"
+#include "XrdSys/XrdSysPthread.hh"
+#include "XrdVersion.hh"
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+// Relay copy progress to the job and let the job cancel the copy.
+//
+class ClProgress : public XrdCl::CopyProgressHandler
+{
+public:
+
+void JobProgress(uint16_t jobNum, uint64_t bytesProcessed, uint64_t bytesTotal)
+                {Stat.Done = bytesProcessed; Stat.Size = bytesTotal;}
+
+bool ShouldCancel(uint16_t jobNum) {return Stat.Cancel;}
+
+     ClProgress(XrdOfsTPCEngine::Status &sP) : Stat(sP) {}
+    ~ClProgress() {}
+
+private:
+XrdOfsTPCEngine::Status &Stat;
+};
+
+// Forwarded credentials are handed to the security protocol through the cgi
+// it understands. Credentials for any other envar are left to the program.
+//
+struct credCgi {const char *Env; const char *Cgi;} credTab[] =
+              {{"X509_USER_PROXY", "xrd.gsiusrpxy"},
+               {"KRB5CCNAME",      "xrd.k5ccname"}
+              };
+
+static const int credNum = sizeof(credTab)/sizeof(credCgi);
+}
+
+/******************************************************************************/
+/*                     C l a s s   X r d O f s T P C C l                      */
+/******************************************************************************/
+
+// All copies run within this process so connections to a source are shared
+// by every job that reads from it. Jobs without forwarded credentials share
+// the server's identity. Jobs with forwarded credentials connect under a name
+// derived from the credentials so that they never share a connection that
+// was authenticated with someone else's credentials.
+//
+class XrdOfsTPCCl : public XrdOfsTPCEngine
+{
+public:
+
+int  Copy(const Parms &parms, Status &stat, char *eRec, int eLen);
+
+     XrdOfsTPCCl(XrdSysLogger *logP) : eDest(logP, "TpcCl_") {}
+    ~XrdOfsTPCCl() {}
+
+private:
+int  Creds(const Parms &parms, std::string &user, std::string &cgi,
+           char *eRec, int eLen);
+int  Fail(const XrdCl::XRootDStatus &st, const Status &stat,
+          char *eRec, int eLen);
+
+XrdSysError eDest;
+XrdSysMutex crdMutex;
+};
+
+/******************************************************************************/
+/*                                  C o p y                                   */
+/******************************************************************************/
+
+int XrdOfsTPCCl::Copy(const Parms &parms, Status &stat, char *eRec, int eLen)
+{
+   XrdCl::CopyProcess   cProc;
+   XrdCl::PropertyList  props, cfgProps, results;
+   XrdCl::XRootDStatus  st;
+   ClProgress           cProg(stat);
+   std::string srcURL(parms.Src), cksMode("none"), cksType, cksPreset;
+   std::string user, cgi;
+   std::string::size_type pos;
+   int rc;
+
+// If credentials are being forwarded then we need a separate connection. In
+// this case the tpc cgi is not needed (the program path does the same).
+//
+   if (parms.cEnv)
+      {if ((rc = Creds(parms, user, cgi, eRec, eLen))) return rc;
+       if ((pos = srcURL.find('?')) != std::string::npos) srcURL.erase(pos);
+       if ((pos = srcURL.find("://")) == std::string::npos)
+          {snprintf(eRec, eLen, "Copy failed; invalid source url.");
+           return EINVAL;
+          }
+       srcURL.insert(pos+3, user + '@');
+       srcURL += '?'; srcURL += cgi;
+      }
+
+// Determine the checksum option the same way xrdcp does. The type may be
+// followed by ":print" or ":source" or a preset checksum value.
+//
+   if (parms.Cks)
+      {std::string cks(parms.Cks), opt;
+       if ((pos = cks.find(':')) != std::string::npos)
+          {opt = cks.substr(pos+1); cks.erase(pos);}
+       cksType = cks;
+            if (opt.empty())     cksMode = "end2end";
+       else if (opt == "print")  cksMode = "target";
+       else if (opt == "source") cksMode = "source";
+       else {cksMode = "end2end"; cksPreset = opt;}
+      }
+
+// Describe the job. This mirrors what "xrdcp --server" would do.
+//
+   props.Set("source",         srcURL);
+   props.Set("target",         std::string("file://") + parms.Dst);
+   props.Set("force",          true);
+   props.Set("makeDir",        getenv("XRD_MAKEPATH") != 0);
+   props.Set("thirdParty",     "none");
+   props.Set("checkSumMode",   cksMode);
+   props.Set("checkSumType",   cksType);
+   props.Set("checkSumPreset", cksPreset);
+
+   if (!(st = cProc.AddJob(props, &results)).IsOK())
+      return Fail(st, stat, eRec, eLen);
+
+   cfgProps.Set("jobType", "configuration");
+   cfgProps.Set("parallel", 1);
+   cProc.AddJob(cfgProps, 0);
+
+// Run the copy
+//
+   if (!(st = cProc.Prepare()).IsOK()) return Fail(st, stat, eRec, eLen);
+   cProc.Run(&cProg);
+
+// Get the ending status of the job
+//
+   if (!results.Get("status", st)) st = XrdCl::XRootDStatus();
+   if (!st.IsOK()) return Fail(st, stat, eRec, eLen);
+   return 0;
+}
+
+/******************************************************************************/
+/* Private:                        C r e d s                                  */
+/******************************************************************************/
+
+int XrdOfsTPCCl::Creds(const Parms &parms, std::string &user, std::string &cgi,
+                       char *eRec, int eLen)
+{
+   static const int    oOpts = (O_CREAT | O_TRUNC | O_WRONLY);
+   static const mode_t oMode = (S_IRUSR | S_IWUSR);
+   const unsigned char *crd = (const unsigned char *)parms.Crd;
+   const char *cVar = 0;
+   char idBuff[24], cPath[1024], tPath[1060];
+   int fd, rc;
+
+// Find out how the credentials are passed to the security protocol
+//
+   for (int i = 0; i < credNum; i++)
+       if (!strcmp(parms.cEnv, credTab[i].Env)) {cVar = credTab[i].Cgi; break;}
+   if (!cVar) return -1;
+
+// The connection is named after the credentials. We use two checksums with
+// different polynomials so that distinct credentials get distinct names.
+//
+   snprintf(idBuff, sizeof(idBuff), "%08x%08x",
+            XrdOucCRC::CRC32(crd, parms.Csz),
+            XrdOucCRC::Calc32C(parms.Crd, parms.Csz));
+   user = idBuff;
+
+// The security protocol may need the credentials again whenever the
+// connection is reestablished, so the file outlives the job. Since it is
+// named after the credentials, it is only written once.
+//
+   if (snprintf(cPath, sizeof(cPath), "%s%s.creds", parms.cDir, idBuff)
+       >= (int)sizeof(cPath))
+      {snprintf(eRec, eLen, "Copy failed; credentials path too long.");
+       return ENAMETOOLONG;
+      }
+
+   crdMutex.Lock();
+   if (access(cPath, R_OK))
+      {snprintf(tPath, sizeof(tPath), "%s.%d", cPath, static_cast<int>(getpid()));
+       if ((fd = XrdSysFD_Open(tPath, oOpts, oMode)) < 0) rc = errno;
+          else {if (write(fd, parms.Crd, parms.Csz) != parms.Csz) rc = errno;
+                   else rc = 0;
+                close(fd);
+                if (!rc && rename(tPath, cPath)) rc = errno;
+                if (rc) unlink(tPath);
+               }
+       if (rc)
+          {crdMutex.UnLock();
+           eDest.Emsg("Copy", rc, "create credentials file", cPath);
+           snprintf(eRec, eLen, "Copy failed; unable to pass credentials.");
+           return rc;
+          }
+      }
+   crdMutex.UnLock();
+
+// Return the cgi to be used
+//
+   cgi  = cVar; cgi += '='; cgi += cPath;
+   return 0;
+}
+
+/******************************************************************************/
+/* Private:                         F a i l                                   */
+/******************************************************************************/
+
+int XrdOfsTPCCl::Fail(const XrdCl::XRootDStatus &st, const Status &stat,
+                      char *eRec, int eLen)
+{
+   int rc;
+
+// Convert the status to an errno
+//
+        if (stat.Cancel) rc = ECANCELED;
+   else if (st.code == XrdCl::errErrorResponse)
+           rc = XProtocol::toErrno(st.errNo);
+   else if (st.code == XrdCl::errOperationInterrupted) rc = ECANCELED;
+   else if (st.code == XrdCl::errCheckSumError) rc = EILSEQ;
+   else rc = (st.errNo ? st.errNo : EIO);
+
+// Format the message as xrdcp would have
+//
+   snprintf(eRec, eLen, "%s", st.ToStr().c_str());
+   return rc;
+}
+
+/******************************************************************************/
+/*                    X r d O f s T P C G e t E n g i n e                     */
+/******************************************************************************/
+
+extern "C"
+{
+XrdOfsTPCEngine *XrdOfsTPCGetEngine(XrdSysLogger *logP, int maxXfr)
+{
+   return new XrdOfsTPCCl(logP);
+}
+}
+
+XrdVERSIONINFO(XrdOfsTPCGetEngine,XrdOfsTPCCl);
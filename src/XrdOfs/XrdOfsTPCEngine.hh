@@ -0,0 +1,118 @@
+#ifndef __XRDOFSTPCENGINE_HH__
+#define __XRDOFSTPCENGINE_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d O f s T P C E n g i n e . h h                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+//------------------------------------------------------------------------------
+//! The XrdOfsTPCEngine class describes the interface to an in-process copy
+//! engine. When one is configured (ofs.tpc engine <path>) each TPC job thread
+//! hands its job to the engine instead of running the transfer program. The
+//! engine is called by as many threads as "ofs.tpc xfr" allows so it must be
+//! thread safe. It need not handle every job; declined jobs are run by the
+//! transfer program as before.
+//------------------------------------------------------------------------------
+
+class XrdSysLogger;
+
+class XrdOfsTPCEngine
+{
+public:
+
+//------------------------------------------------------------------------------
+//! Describe a copy job.
+//------------------------------------------------------------------------------
+
+struct Parms
+      {const char *Src;   //!< Source URL (xroot://host/lfn?cgi)
+       const char *Dst;   //!< Destination pfn
+       const char *Cks;   //!< Checksum type to verify or nil
+       const char *Org;   //!< Trace identifier of the requesting client
+       const char *cEnv;  //!< Creds envar name, nil if no creds are forwarded
+       const char *cDir;  //!< Directory where creds files may be placed
+       const char *Crd;   //!< The forwarded creds
+       int         Csz;   //!< Size of the forwarded creds
+       int         Strm;  //!< Number of TCP streams requested (0 -> default)
+      };
+
+//------------------------------------------------------------------------------
+//! Track the progress of a copy job. The engine updates Done and Size as the
+//! copy proceeds and must stop the copy as soon as it sees Cancel set.
+//------------------------------------------------------------------------------
+
+struct Status
+      {volatile bool      Cancel;  //!< Set by the job when it is cancelled
+       volatile long long Done;    //!< Bytes copied so far
+       volatile long long Size;    //!< Total bytes to copy, if known
+
+       void  Reset() {Cancel = false; Done = Size = 0;}
+
+             Status() {Reset();}
+      };
+
+//------------------------------------------------------------------------------
+//! Copy a file.
+//!
+//! @param  parms  - the job description.
+//! @param  stat   - the status object to be updated during the copy.
+//! @param  eRec   - buffer for the message describing a failure.
+//! @param  eLen   - size of the eRec buffer.
+//!
+//! @return =0     - the copy succeeded.
+//! @return >0     - the copy failed, the errno value is returned and eRec
+//!                  holds the reason.
+//! @return <0     - the engine declined the job, run the transfer program.
+//------------------------------------------------------------------------------
+
+virtual int  Copy(const Parms &parms, Status &stat, char *eRec, int eLen) = 0;
+
+             XrdOfsTPCEngine() {}
+virtual     ~XrdOfsTPCEngine() {}
+};
+
+/******************************************************************************/
+/*                    X r d O f s T P C G e t E n g i n e                     */
+/******************************************************************************/
+
+//------------------------------------------------------------------------------
+//! Obtain an instance of the copy engine. The plugin library must export:
+//!
+//! extern "C" XrdOfsTPCEngine *XrdOfsTPCGetEngine(XrdSysLogger *logP,
+//!                                                 int           maxXfr);
+//!
+//! @param  logP   - pointer to the logger to be used for messages.
+//! @param  maxXfr - the maximum number of copies that may run at once.
+//!
+//! @return A pointer to the engine or nil if it could not be initialized.
+//!
+//! The library must also declare its version using:
+//!
+//! XrdVERSIONINFO(XrdOfsTPCGetEngine,<name>);
+//------------------------------------------------------------------------------
+
+typedef XrdOfsTPCEngine *(*XrdOfsTPCGetEngine_t)(XrdSysLogger *logP,
+                                                  int           maxXfr);
+#endif
@@ -37,11 +37,13 @@
 #include "XrdOfs/XrdOfsTrace.hh"
 #include "XrdOss/XrdOss.hh"
 #include "XrdOuc/XrdOucCallBack.hh"
+#include "XrdOuc/XrdOucPinLoader.hh"
 #include "XrdOuc/XrdOucProg.hh"
 #include "XrdOuc/XrdOucTrace.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysFD.hh"
 #include "XrdSys/XrdSysHeaders.hh"
+#include "XrdVersion.hh"
 
 /******************************************************************************/
 /*                        G l o b a l   O b j e c t s                         */
@@ -51,9 +53,12 @@ extern XrdSysError  OfsEroute;
 extern XrdOucTrace  OfsTrace;
 extern XrdOss      *XrdOfsOss;
 
+XrdVERSIONINFOREF(XrdOfs);
+
 namespace XrdOfsTPCParms
 {
 extern char        *XfrProg;
+extern char        *XfrEng;
 extern char        *cksType;
 extern int          xfrMax;
 extern int          errMon;
@@ -69,6 +74,7 @@ using namespace XrdOfsTPCParms;
   
 XrdSysMutex        XrdOfsTPCProg::pgmMutex;
 XrdOfsTPCProg     *XrdOfsTPCProg::pgmIdle  = 0;
+XrdOfsTPCEngine   *XrdOfsTPCProg::xfrEng   = 0;
 
 /******************************************************************************/
 /*                     E x t e r n a l   L i n k a g e s                      */
@@ -127,6 +133,30 @@ XrdOfsTPCProg::XrdOfsTPCProg(XrdOfsTPCProg *Prev, int num, int errMon)
               Pname[sizeof(Pname)-1] = 0;
              }
   
+/******************************************************************************/
+/* Private:                        E n d e d                                  */
+/******************************************************************************/
+
+int XrdOfsTPCProg::Ended(int rc)
+{
+
+// Check if we should generate a message
+//
+   if (rc && !(*eRec)) sprintf(eRec, "Copy failed with return code %d", rc);
+
+// Log failures and optionally remove the file (Info would do that as well
+// but much later on, so we do it now).
+//
+   if (rc)
+      {OfsEroute.Emsg("TPC", Job->Info.Org, Job->Info.Lfn, eRec);
+       if (autoRM) XrdOfsOss->Unlink(Job->Info.Lfn);
+      } else Job->Info.Success();
+
+// All done
+//
+   return rc;
+}
+
 /******************************************************************************/
 /*                           E x p o r t C r e d s                            */
 /******************************************************************************/
@@ -166,13 +196,30 @@ int fd, rc;
   
 int XrdOfsTPCProg::Init()
 {
+   bool noPgm = false;
    int n;
 
-// Allocate copy program objects
+// Load the copy engine if one was specified
+//
+   if (XfrEng)
+      {XrdOucPinLoader myLib(&OfsEroute, &XrdVERSIONINFOVAR(XrdOfs),
+                             "tpc engine", XfrEng);
+       XrdOfsTPCGetEngine_t ep = (XrdOfsTPCGetEngine_t)
+                                 (myLib.Resolve("XrdOfsTPCGetEngine"));
+       if (!ep || !(xfrEng = ep(OfsEroute.logger(), xfrMax))) return 0;
+      }
+
+// Allocate copy program objects. With a copy engine the program only runs
+// jobs the engine declines, so its absence is not fatal (those jobs fail).
 //
    for (n = 0; n < xfrMax; n++)
        {pgmIdle = new XrdOfsTPCProg(pgmIdle, n, errMon);
-        if (pgmIdle->Prog.Setup(XfrProg, &OfsEroute)) return 0;
+        if (!noPgm && pgmIdle->Prog.Setup(XfrProg, &OfsEroute))
+           {if (!xfrEng) return 0;
+            OfsEroute.Say("Config warning: tpc jobs declined by the copy "
+                          "engine will fail.");
+            noPgm = true;
+           }
        }
 
 // All done
@@ -193,6 +240,7 @@ void XrdOfsTPCProg::Run()
 // another job to run. Note "Job" will always be valid.
 //
 do{rc = Xeq();
+   xfrStat.Reset();
    Job = Job->Done(this, eRec, rc);
   } while(Job);
 
@@ -245,6 +293,11 @@ int XrdOfsTPCProg::Xeq()
    char *Quest = index(Job->Info.Key, '?');
    int rc, aNum = 0;
 
+// If we have a copy engine, let it run the job. Should it decline the job, we
+// run the copy program as usual.
+//
+   if (xfrEng && (rc = XeqEng()) >= 0) return Ended(rc);
+
 // If we have credentials, write them out to a file
 //
    if (cFile.Path && (rc = ExportCreds(cFile.Path)))
@@ -316,19 +369,62 @@ int XrdOfsTPCProg::Xeq()
    if ((rc = Prog.RunDone(JobStream)) < 0) rc = -rc;
    DEBUG(Pname <<"ended with rc=" <<rc);
 
-// Check if we should generate a message
+// Finish up
 //
-   if (rc && !(*eRec)) sprintf(eRec, "Copy failed with return code %d", rc);
+   return Ended(rc);
+}
 
-// Log failures and optionally remove the file (Info would do that as well
-// but much later on, so we do it now).
+/******************************************************************************/
+/* Private:                       X e q E n g                                 */
+/******************************************************************************/
+
+int XrdOfsTPCProg::XeqEng()
+{
+   EPNAME("XeqEng");
+   XrdOfsTPCEngine::Parms eParms;
+   char *Quest = index(Job->Info.Key, '?'), *tident = Job->Info.Org;
+   int rc;
+
+// Describe the job to the engine. Forwarded credentials only apply when we
+// have a place to put them.
 //
-   if (rc)
-      {OfsEroute.Emsg("TPC", Job->Info.Org, Job->Info.Lfn, eRec);
-       if (autoRM) XrdOfsOss->Unlink(Job->Info.Lfn);
-      } else Job->Info.Success();
+   eParms.Src  = Job->Info.Key;
+   eParms.Dst  = Job->Info.Dst;
+   eParms.Cks  = (Job->Info.Cks ? Job->Info.Cks : XrdOfsTPCParms::cksType);
+   eParms.Org  = Job->Info.Org;
+   eParms.Strm = Job->Info.Str;
+   if (Job->Info.Csz > 0 && Job->Info.Crd && Job->Info.Env && Job->credPath())
+      {eParms.cEnv = Job->Info.Env;
+       eParms.cDir = Job->credPath();
+       eParms.Crd  = Job->Info.Crd;
+       eParms.Csz  = Job->Info.Csz;
+      } else {
+       eParms.cEnv = eParms.cDir = eParms.Crd = 0;
+       eParms.Csz  = 0;
+      }
 
-// All done
+// Echo out what we are doing if so desired
+//
+   if (doEcho)
+      {if (Quest) *Quest = 0;
+       OfsEroute.Say(Pname,tident," copying ",Job->Info.Key," to ",Job->Info.Dst);
+       if (Quest) *Quest = '?';
+      }
+
+// Run the copy
+//
+   *eRec = 0;
+   rc = xfrEng->Copy(eParms, xfrStat, eRec, sizeof(eRec));
+   eRec[sizeof(eRec)-1] = 0;
+
+// Report how it went
 //
+   if (rc < 0) {DEBUG(Pname <<"declined by engine; running program.");}
+      else if (doEcho)
+              {char buff[80];
+               snprintf(buff, sizeof(buff), "%lld of %lld bytes copied; rc=%d",
+                        xfrStat.Done, xfrStat.Size, rc);
+               OfsEroute.Say(Pname, "ended; ", buff);
+              }
    return rc;
 }
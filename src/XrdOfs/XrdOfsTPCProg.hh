@@ -30,6 +30,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include "XrdOfs/XrdOfsTPCEngine.hh"
 #include "XrdOuc/XrdOucProg.hh"
 #include "XrdOuc/XrdOucStream.hh"
 #include "XrdSys/XrdSysPthread.hh"
@@ -41,7 +42,7 @@ class XrdOfsTPCProg
 {
 public:
 
-       void      Cancel() {JobStream.Drain();}
+       void      Cancel() {xfrStat.Cancel = true; JobStream.Drain();}
 
 static int       Init();
 
@@ -56,9 +57,14 @@ XrdOfsTPCProg   *Start(XrdOfsTPCJob *jP, int &rc);
 
                 ~XrdOfsTPCProg() {}
 private:
+       int            Ended(int rc);
        int            ExportCreds(const char *path);
+       int            XeqEng();
 static XrdSysMutex    pgmMutex;
 static XrdOfsTPCProg *pgmIdle;
+static XrdOfsTPCEngine *xfrEng;
+
+       XrdOfsTPCEngine::Status xfrStat;
 
        XrdOucProg     Prog;
        XrdOucStream   JobStream;
@@ -45,6 +45,9 @@
 
 #include "XrdOss/XrdOssApi.hh"
 #include "XrdOss/XrdOssTrace.hh"
+#ifdef HAVE_IO_URING
+#include "XrdOss/XrdOssUring.hh"
+#endif
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysPthread.hh"
@@ -71,6 +74,8 @@ extern XrdOucTrace OssTrace;
 
 extern XrdSysError OssEroute;
 
+extern XrdOssSys  *XrdOssSS;
+
 int   XrdOssFile::AioFailure = 0;
 
 #ifdef _POSIX_ASYNCHRONOUS_IO
@@ -96,6 +101,17 @@ const int OSS_AIO_WRITE_DONE = SIGRTMAX;
 int XrdOssFile::Fsync(XrdSfsAio *aiop)
 {
 
+#ifdef HAVE_IO_URING
+// Use io_uring if so configured (we do the request synchronously if the ring
+// is full).
+//
+   if (XrdOssSys::AioType == 'u')
+      {int rc;
+       aiop->TIdent = tident;
+       if ((rc = XrdOssUring::Fsync(aiop, fd)) <= 0) return rc;
+      }
+#endif
+
 #ifdef _POSIX_ASYNCHRONOUS_IO
    int rc;
 
@@ -148,6 +164,21 @@ int XrdOssFile::Fsync(XrdSfsAio *aiop)
 int XrdOssFile::Read(XrdSfsAio *aiop)
 {
 
+#ifdef HAVE_IO_URING
+// Use io_uring if so configured
+//
+   if (XrdOssSys::AioType == 'u')
+      {int rc;
+       aiop->TIdent = tident;
+       if ((rc = XrdOssUring::Read(aiop, fd)) <= 0)
+          {if (!rc && XrdOssSS->raWindow)
+              Advise((off_t)aiop->sfsAio.aio_offset,
+                     (size_t)aiop->sfsAio.aio_nbytes);
+           return rc;
+          }
+      }
+#endif
+
 #ifdef _POSIX_ASYNCHRONOUS_IO
    EPNAME("AioRead");
    int rc;
@@ -164,7 +195,12 @@ int XrdOssFile::Read(XrdSfsAio *aiop)
 
        // Start the operation
        //
-          if (!(rc = aio_read(&aiop->sfsAio))) return 0;
+          if (!(rc = aio_read(&aiop->sfsAio)))
+             {if (XrdOssSS->raWindow)
+                 Advise((off_t)aiop->sfsAio.aio_offset,
+                        (size_t)aiop->sfsAio.aio_nbytes);
+              return 0;
+             }
           if (errno != EAGAIN && errno != ENOSYS) return -errno;
 
       // Aio failed keep track of the problem (msg every 1024 events). Note
@@ -205,6 +241,16 @@ int XrdOssFile::Read(XrdSfsAio *aiop)
   
 int XrdOssFile::Write(XrdSfsAio *aiop)
 {
+#ifdef HAVE_IO_URING
+// Use io_uring if so configured
+//
+   if (XrdOssSys::AioType == 'u')
+      {int rc;
+       aiop->TIdent = tident;
+       if ((rc = XrdOssUring::Write(aiop, fd)) <= 0) return rc;
+      }
+#endif
+
 #ifdef _POSIX_ASYNCHRONOUS_IO
    EPNAME("AioWrite");
    int rc;
@@ -253,6 +299,8 @@ int XrdOssFile::Write(XrdSfsAio *aiop)
 /******************************************************************************/
 
 int   XrdOssSys::AioAllOk = 0;
+char  XrdOssSys::AioType  = 'p';
+int   XrdOssSys::AioQDepth = 256;
   
 #if defined(_POSIX_ASYNCHRONOUS_IO) && !defined(HAVE_SIGWTI)
 // The folowing is for sigwaitinfo() emulation
@@ -274,6 +322,18 @@ extern "C" {extern void XrdOssAioWSH(int, siginfo_t *, void *);}
 
 int XrdOssSys::AioInit()
 {
+#ifdef HAVE_IO_URING
+// If io_uring was requested, try to use it. If we can't, we fall back to
+// using posix aio, if available.
+//
+   if (AioType == 'u')
+      {if (XrdOssUring::Init(AioQDepth)) return 1;
+       OssEroute.Say("Config warning: io_uring not available; "
+                     "using posix aio.");
+       AioType = 'p';
+      }
+#endif
+
 #if defined(_POSIX_ASYNCHRONOUS_IO)
    EPNAME("AioInit");
    extern void *XrdOssAioWait(void *carg);
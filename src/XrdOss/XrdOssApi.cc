@@ -40,6 +40,7 @@
 #include <sys/file.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/param.h>
 #ifdef __solaris__
 #include <sys/vnode.h>
@@ -52,7 +53,9 @@
 #include "XrdOss/XrdOssCache.hh"
 #include "XrdOss/XrdOssConfig.hh"
 #include "XrdOss/XrdOssError.hh"
+#include "XrdOss/XrdOssFdCache.hh"
 #include "XrdOss/XrdOssMio.hh"
+#include "XrdOss/XrdOssStatCache.hh"
 #include "XrdOss/XrdOssTrace.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucName2Name.hh"
@@ -65,6 +68,7 @@
 #include "XrdSys/XrdSysHeaders.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysPlugin.hh"
+#include "XrdSys/XrdSysProbe.hh"
 
 #ifdef XRDOSSCX
 #include "oocx_CXFile.h"
@@ -270,7 +274,9 @@ int XrdOssSys::Chmod(const char *path, mode_t mode, XrdOucEnv *envP)
 
 // Change the file only in the local filesystem.
 //
-   return (chmod(local_path, mode) ? -errno : XrdOssOK);
+   if (chmod(local_path, mode)) return -errno;
+   if (XrdOssStatCache::Enabled()) XrdOssStatCache::Purge(path);
+   return XrdOssOK;
 }
 
 /******************************************************************************/
@@ -427,6 +433,7 @@ int XrdOssSys::Truncate(const char *path, unsigned long long size,
 // Make sure we can modify this path
 //
    Check_RW(Truncate, path, "truncate");
+   if (XrdOssFdCache::Enabled()) XrdOssFdCache::Purge(path);
 
 // Generate local path
 //
@@ -450,6 +457,7 @@ int XrdOssSys::Truncate(const char *path, unsigned long long size,
 //
    if (truncate(local_path, size)) return -errno;
    XrdOssCache::Adjust(local_path,static_cast<long long>(size)-oldsz,&statbuff);
+   if (XrdOssStatCache::Enabled()) XrdOssStatCache::Purge(path);
    return XrdOssOK;
 }
   
@@ -686,6 +694,7 @@ int XrdOssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
    int retc, mopts;
    char actual_path[MAXPATHLEN+1], *local_path;
    struct stat buf;
+   bool fdcOK, isCached = false;
 
 // Return an error if this object is already open
 //
@@ -712,10 +721,18 @@ int XrdOssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
           else return OssEroute.Emsg("Open",-XRDOSS_E8005,"open r/w",path);
       }
 
+// Plain read/only opens of local files may reuse the descriptor of a recently
+// closed copy of the same file, avoiding the open and the fstat below.
+//
+   fdcOK = XrdOssFdCache::Enabled() && Oflag == O_RDONLY
+        && !(popts & (XRDEXP_REMOTE | XRDEXP_PURGE));
+   if (fdcOK && (fd = XrdOssFdCache::Get(path, local_path, buf)) >= 0)
+      isCached = true;
+
 // If we can open the local copy. If not found, try to stage it in if possible.
 // Note that stage will regenerate the right local and remote paths.
 //
-   if ( (fd = (int)Open_ufs(local_path, Oflag, Mode, popts)) == -ENOENT
+   else if ( (fd = (int)Open_ufs(local_path, Oflag, Mode, popts)) == -ENOENT
    && (popts & XRDEXP_REMOTE))
       {if (!(popts & XRDEXP_STAGE))
           return OssEroute.Emsg("Open",-XRDOSS_E8006,"open",path);
@@ -727,11 +744,14 @@ int XrdOssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
 // This interface supports only regular files. Complain if this is not one.
 //
    if (fd >= 0)
-      {do {retc = fstat(fd, &buf);} while(retc && errno == EINTR);
+      {if (isCached) retc = 0;
+          else do {retc = fstat(fd, &buf);} while(retc && errno == EINTR);
        if (!retc && !(buf.st_mode & S_IFREG))
           {close(fd); fd = (buf.st_mode & S_IFDIR ? -EISDIR : -ENOTBLK);}
        if (Oflag & (O_WRONLY | O_RDWR))
-          {FSize = buf.st_size; cacheP = XrdOssCache::Find(local_path);}
+          {FSize = buf.st_size; cacheP = XrdOssCache::Find(local_path);
+           trimTail = XrdOssSS->paMin >= 0;
+          }
           else {if (buf.st_mode & XRDSFS_POSCPEND && fd >= 0)
                    {close(fd); fd=-ETXTBSY;}
                 FSize = -1; cacheP = 0;
@@ -741,6 +761,22 @@ int XrdOssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
                  if (!retc && (buf.st_mode & S_IFDIR)) fd = -EISDIR;
                 }
 
+// Remember the path if the descriptor may be cached when the file is closed
+//
+   if (fd >= 0 && fdcOK) fdcPath = strdup(path);
+
+// A file open for update may change at any time so its stat information must
+// not be cached until it is closed.
+//
+   if (fd >= 0 && (Oflag & (O_WRONLY | O_RDWR)) && XrdOssStatCache::Enabled())
+      {stcPath = strdup(path);
+       XrdOssStatCache::Hold(path);
+      }
+
+// Find the partition holding the file should its load need to be tracked
+//
+   if (fd >= 0) ioFS = XrdOssCache::ioFind(buf.st_dev);
+
 // See if should memory map this file. For now, extended attributes are only
 // needed when memory mapping is enabled and can apply only to specific files.
 // So, we read them here should we need them.
@@ -777,21 +813,40 @@ int XrdOssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
 */
 int XrdOssFile::Close(long long *retsz)
 {
+    int rc = 0;
+
     if (fd < 0) return -XRDOSS_E8004;
-    if (retsz || cacheP)
+    if (retsz || cacheP || trimTail)
        {struct stat buf;
         int retc;
         do {retc = fstat(fd, &buf);} while(retc && errno == EINTR);
         if (cacheP && FSize != buf.st_size)
            XrdOssCache::Adjust(cacheP, buf.st_size - FSize);
         if (retsz) *retsz = buf.st_size;
+     // Release what was preallocated but not written (see Prealloc()). A
+     // truncate to the current size frees the blocks past the end of file.
+     //
+        if (trimTail && !retc
+        &&  (long long)buf.st_blocks * 512 > buf.st_size + buf.st_blksize
+        &&  ftruncate(fd, buf.st_size))
+           OssEroute.Emsg("Close", errno, "release preallocated space");
        }
-    if (close(fd)) return -errno;
+    if (fdcPath)
+       {bool kept = !mmFile && !cxobj && XrdOssFdCache::Put(fdcPath, fd);
+        free(fdcPath); fdcPath = 0;
+        if (!kept && close(fd)) rc = -errno;
+       } else if (close(fd)) rc = -errno;
+    if (stcPath)
+       {XrdOssStatCache::Release(stcPath);
+        free(stcPath); stcPath = 0;
+       }
+    if (rc) return rc;
     if (mmFile) {XrdOssMio::Recycle(mmFile); mmFile = 0;}
 #ifdef XRDOSSCX
     if (cxobj) {delete cxobj; cxobj = 0;}
 #endif
-    fd = -1; FSize = -1; cacheP = 0;
+    fd = -1; FSize = -1; cacheP = 0; ioFS = 0; trimTail = false;
+    raReset();
     return XrdOssOK;
 }
 
@@ -840,17 +895,26 @@ ssize_t XrdOssFile::Read(off_t offset, size_t blen)
 ssize_t XrdOssFile::Read(void *buff, off_t offset, size_t blen)
 {
      ssize_t retval;
+     long long tBeg = 0;
 
      if (fd < 0) return (ssize_t)-XRDOSS_E8004;
 
+     if (ioFS) tBeg = XrdOssCache::ioBeg(ioFS);
+     XrdSysProbe4(xrdoss, read__start, this, fd, offset, blen);
+
 #ifdef XRDOSSCX
      if (cxobj)  
         if (XrdOssSS->DirFlags & XrdOssNOSSDEC) return (ssize_t)-XRDOSS_E8021;
            else   retval = cxobj->Read((char *)buff, blen, offset);
         else 
 #endif
-             do { retval = pread(fd, buff, blen, offset); }
-                while(retval < 0 && errno == EINTR);
+             {do { retval = pread(fd, buff, blen, offset); }
+                 while(retval < 0 && errno == EINTR);
+              if (XrdOssSS->raWindow && retval > 0) Advise(offset, retval);
+             }
+
+     XrdSysProbe2(xrdoss, read__done, this, retval);
+     if (ioFS) XrdOssCache::ioEnd(ioFS, tBeg);
 
      return (retval >= 0 ? retval : (ssize_t)-errno);
 }
@@ -907,12 +971,14 @@ ssize_t XrdOssFile::ReadV(XrdOucIOVec *readV, int n)
 
 // Read in the vector and do a pre-advise if we support that
 //
+   long long tBeg = (ioFS ? XrdOssCache::ioBeg(ioFS) : 0);
    for (i = 0; i < n; i++)
        {do {rdsz = pread(fd, readV[i].data, readV[i].size, readV[i].offset);}
            while(rdsz < 0 && errno == EINTR);
         if (rdsz < 0 || rdsz != readV[i].size)
            {totBytes =  (rdsz < 0 ? -errno : -ESPIPE); break;}
         totBytes += rdsz;
+        if (XrdOssSS->raWindow) Advise(readV[i].offset, rdsz);
 #if defined(__linux__) && defined(HAVE_ATOMICS)
         if (nPR < n && readV[nPR].size > 0)
            {begOff = XrdOssSS->prPMask &  readV[nPR].offset;
@@ -931,12 +997,99 @@ ssize_t XrdOssFile::ReadV(XrdOucIOVec *readV, int n)
 
 // All done, return bytes read.
 //
+   if (ioFS) XrdOssCache::ioEnd(ioFS, tBeg);
 #if defined(__linux__) && defined(HAVE_ATOMICS)
    if (XrdOssSS->prDepth) AtomicDec((XrdOssSS->prActive));
 #endif
    return totBytes;
 }
 
+/******************************************************************************/
+/*                                A d v i s e                                 */
+/******************************************************************************/
+
+/*
+  Function: Track the access pattern of the file and tell the kernel about it.
+
+  Input:    offset    - The offset of the read just done.
+            rlen      - The number of bytes read.
+
+  Notes:    1) Up to raStreams read streams are followed so that interleaved
+               ones (e.g. the several chunks a client keeps in flight) are
+               recognized. A read starting within a readahead window of where
+               one of them left off continues it; anything else is random and
+               starts a new stream in place of the oldest. A few reads of the
+               same kind in a row switch the fadvise() advice so that kernel
+               readahead is enlarged or turned off.
+            2) While sequential, the next oss.readahead window is kept
+               prefetched for the stream and, if so configured, the pages
+               more than two windows behind it are dropped from the page cache.
+            3) The state is updated without a lock. Concurrent readers of a
+               shared file handle may confuse it but all it drives are hints.
+*/
+
+void XrdOssFile::Advise(off_t offset, size_t rlen)
+{
+#if defined(__linux__)
+   EPNAME("Advise");
+   static const short seqRun = 3, rndRun = 3;
+   long long rEnd = offset + rlen, window = XrdOssSS->raWindow;
+   raStream *sP;
+   int i;
+
+// Classify this read relative to the streams we know about
+//
+   for (i = 0; i < raStreams; i++)
+       if (offset >= raTrack[i].next - window
+       &&  offset <= raTrack[i].next + window) break;
+
+   if (i < raStreams)
+      {sP = &raTrack[i];
+       if (raRun < 0) raRun = 0;
+       if (raRun < seqRun) raRun++;
+       if (rEnd > sP->next) sP->next = rEnd;
+      } else {
+       sP = &raTrack[(int)raLast];
+       raLast = (raLast + 1) % raStreams;
+       if (raRun > 0) raRun = 0;
+       if (raRun > -rndRun) raRun--;
+       sP->next = rEnd; sP->ahead = 0;
+       sP->behind = offset & XrdOssSS->prPMask;
+      }
+
+// Change the advice when the pattern has changed
+//
+   if (raRun >= seqRun && raMode != raSeq)
+      {posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+       TRACE(Debug, "fadvise(" <<fd <<",sequential) at " <<offset);
+       raMode = raSeq;
+      }
+      else if (raRun <= -rndRun && raMode != raRnd)
+              {posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+               TRACE(Debug, "fadvise(" <<fd <<",random) at " <<offset);
+               raMode = raRnd;
+              }
+   if (raMode != raSeq || raRun <= 0) return;
+
+// Refill the readahead window once half of it has been consumed
+//
+   rEnd = sP->next;
+   if (sP->ahead < rEnd + window/2)
+      {long long begOff = (sP->ahead > rEnd ? sP->ahead : rEnd);
+       posix_fadvise(fd, begOff, rEnd + window - begOff, POSIX_FADV_WILLNEED);
+       sP->ahead = rEnd + window;
+      }
+
+// Drop what the stream has left behind, a window at a time
+//
+   if (XrdOssSS->raDrop && rEnd - sP->behind >= 3*window)
+      {long long endOff = (rEnd - 2*window) & XrdOssSS->prPMask;
+       posix_fadvise(fd, sP->behind, endOff - sP->behind, POSIX_FADV_DONTNEED);
+       sP->behind = endOff;
+      }
+#endif
+}
+
 /******************************************************************************/
 /*                               R e a d R a w                                */
 /******************************************************************************/
@@ -987,19 +1140,101 @@ ssize_t XrdOssFile::ReadRaw(void *buff, off_t offset, size_t blen)
 ssize_t XrdOssFile::Write(const void *buff, off_t offset, size_t blen)
 {
      ssize_t retval;
+     long long tBeg = 0;
 
      if (fd < 0) return (ssize_t)-XRDOSS_E8004;
 
      if (XrdOssSS->MaxSize && (long long)(offset+blen) > XrdOssSS->MaxSize)
         return (ssize_t)-XRDOSS_E8007;
 
+     if (ioFS) tBeg = XrdOssCache::ioBeg(ioFS);
+     XrdSysProbe4(xrdoss, write__start, this, fd, offset, blen);
+
      do { retval = pwrite(fd, buff, blen, offset); }
           while(retval < 0 && errno == EINTR);
 
+     XrdSysProbe2(xrdoss, write__done, this, retval);
+     if (ioFS) XrdOssCache::ioEnd(ioFS, tBeg);
+
      if (retval < 0) retval = (retval == EBADF && cxobj ? -XRDOSS_E8022 : -errno);
      return retval;
 }
 
+/******************************************************************************/
+/*                                W r i t e V                                 */
+/******************************************************************************/
+
+/*
+  Function: Write the data described by the vector to the associated file.
+            Runs of elements that are adjacent in the file are written with
+            a single pwritev() call.
+
+  Input:    writeV    - Array of elements describing the data.
+            n         - Number of elements.
+
+  Output:   Returns the number of bytes written upon success and -errno o/w.
+*/
+
+ssize_t XrdOssFile::WriteV(XrdOucIOVec *writeV, int n)
+{
+#if defined(__linux__) || defined(__FreeBSD__)
+   static const int maxIOV = 64;
+   struct iovec iov[maxIOV];
+   ssize_t retval, totBytes = 0;
+   long long tBeg = 0, runOff, runLen;
+   int i = 0, j, k;
+
+   if (fd < 0) return (ssize_t)-XRDOSS_E8004;
+
+   if (ioFS) tBeg = XrdOssCache::ioBeg(ioFS);
+
+   while(i < n)
+        {runOff = writeV[i].offset; runLen = 0;
+         for (j = i; j < n && j - i < maxIOV
+                  && writeV[j].offset == runOff + runLen; j++)
+             {iov[j-i].iov_base = writeV[j].data;
+              iov[j-i].iov_len  = writeV[j].size;
+              runLen += writeV[j].size;
+             }
+
+         if (XrdOssSS->MaxSize && runOff + runLen > XrdOssSS->MaxSize)
+            {totBytes = -XRDOSS_E8007; break;}
+
+         XrdSysProbe4(xrdoss, write__start, this, fd, runOff, runLen);
+         do { retval = pwritev(fd, iov, j - i, runOff); }
+              while(retval < 0 && errno == EINTR);
+         XrdSysProbe2(xrdoss, write__done, this, retval);
+
+         if (retval < 0)
+            {totBytes = (errno == EBADF && cxobj ? -XRDOSS_E8022 : -errno);
+             break;
+            }
+
+// A short write is finished element by element
+//
+         if (retval < runLen)
+            {for (k = i; k < j && retval >= writeV[k].size; k++)
+                 retval -= writeV[k].size;
+             for (; k < j; k++, retval = 0)
+                 {ssize_t rc = Write(writeV[k].data + retval,
+                                     writeV[k].offset + retval,
+                                     writeV[k].size - retval);
+                  if (rc != writeV[k].size - retval)
+                     {totBytes = (rc < 0 ? rc : -ESPIPE); break;}
+                 }
+             if (totBytes < 0) break;
+            }
+         totBytes += runLen;
+         i = j;
+        }
+
+   if (ioFS) XrdOssCache::ioEnd(ioFS, tBeg);
+   return totBytes;
+#else
+   return XrdOssDF::WriteV(writeV, n);
+#endif
+}
+
 /******************************************************************************/
 /*                                F c h m o d                                 */
 /******************************************************************************/
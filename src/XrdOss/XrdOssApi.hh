@@ -32,6 +32,7 @@
 
 #include <sys/types.h>
 #include <errno.h>
+#include <string.h>
 #include "XrdSys/XrdSysHeaders.hh"
 
 #include "XrdOss/XrdOss.hh"
@@ -79,6 +80,7 @@ unsigned long long  pflags;
 class oocx_CXFile;
 class XrdSfsAio;
 class XrdOssCache_FS;
+class XrdOssCache_FSData;
 class XrdOssMioFile;
   
 class XrdOssFile : public XrdOssDF
@@ -106,26 +108,50 @@ ssize_t ReadV(XrdOucIOVec *readV, int);
 ssize_t ReadRaw(    void *, off_t, size_t);
 ssize_t Write(const void *, off_t, size_t);
 int     Write(XrdSfsAio *aiop);
+ssize_t WriteV(XrdOucIOVec *writeV, int);
  
         // Constructor and destructor
         XrdOssFile(const char *tid)
                   {cxobj = 0; rawio = 0; cxpgsz = 0; cxid[0] = '\0';
-                   mmFile = 0; tident = tid;
+                   mmFile = 0; tident = tid; fdcPath = 0; stcPath = 0; ioFS = 0;
+                   trimTail = false; raReset();
                   }
 
 virtual ~XrdOssFile() {if (fd >= 0) Close();}
 
 private:
+void    Advise(off_t offset, size_t rlen);
 int     Open_ufs(const char *, int, int, unsigned long long);
 
+void    raReset() {memset(raTrack, 0, sizeof(raTrack));
+                   raRun = 0; raMode = raNone; raLast = 0;
+                  }
+
+enum {raNone = 0, raSeq, raRnd};
+static const int raStreams = 4;
+
+struct raStream
+      {long long next;          // Offset following the last read
+       long long ahead;         // Offset up to which readahead was issued
+       long long behind;        // Offset below which pages were dropped
+      };
+
 static int      AioFailure;
 oocx_CXFile    *cxobj;
 XrdOssCache_FS *cacheP;
 XrdOssMioFile  *mmFile;
 const char     *tident;
+char           *fdcPath;        // -> Path if fd may be cached upon close
+char           *stcPath;        // -> Path if held in the stat cache
+XrdOssCache_FSData *ioFS;       // -> Partition for load tracking, if any
 long long       FSize;
 int             rawio;
 int             cxpgsz;
+bool            trimTail;       // Release blocks allocated past EOF upon close
+raStream        raTrack[raStreams]; // Read streams being followed
+short           raRun;          // >0 sequential reads in a row, <0 random ones
+char            raMode;         // Advice currently in effect (raNone etc)
+char            raLast;         // Stream to be replaced by the next random read
 char            cxid[4];
 };
 
@@ -193,6 +219,8 @@ int       Stats(char *bp, int bl);
 
 static int   AioInit();
 static int   AioAllOk;
+static char  AioType;           // 'p' -> posix aio, 'u' -> io_uring
+static int   AioQDepth;         // Submission queue depth for io_uring
 
 static int   runOld;            // Run in backward compatability mode
 
@@ -272,6 +300,10 @@ long long         prPMask;   //    Page hi order bit mask
 int               prPSize;   //    preread page size
 int               prBytes;   //    preread byte limit
 int               prActive;  //    preread activity count
+long long         paMin;     //    preallocation minimum size, -1 if disabled
+int               paExtSz;   //    preallocation XFS extent size hint
+int               raWindow;  //    readahead window, 0 if hints disabled
+bool              raDrop;    //    drop pages behind sequential readers
 short             prDepth;   //    preread depth
 short             prQSize;   //    preread maximum allowed
 
@@ -286,6 +318,7 @@ protected:
 long long minalloc;          //    Minimum allocation
 int       ovhalloc;          //    Allocation overage
 int       fuzalloc;          //    Allocation fuzz
+int       ldalloc;           //    Allocation considers partition load
 int       cscanint;          //    Seconds between cache scans
 int       xfrspeed;          //    Average transfer speed (bytes/second)
 int       xfrovhd;           //    Minimum seconds to get a file
@@ -313,6 +346,7 @@ int                BreakLink(const char *local_path, struct stat &statbuff);
 int                CalcTime();
 int                CalcTime(XrdOssStage_Req *req);
 int                SetFattr(XrdOssCreateInfo &crInfo, int datfd, time_t mtime);
+void               Prealloc(int datfd, long long fsize);
 void               doScrub();
 int                Find(XrdOssStage_Req *req, void *carg);
 int                getCname(const char *path, struct stat *sbuff, char *cgbuff);
@@ -339,20 +373,25 @@ void   ConfigStats(XrdSysError &Eroute);
 void   ConfigStats(dev_t Devnum, char *lP);
 int    ConfigXeq(char *, XrdOucStream &, XrdSysError &);
 void   List_Path(const char *, const char *, unsigned long long, XrdSysError &);
+int    xaio(XrdOucStream &Config, XrdSysError &Eroute);
 int    xalloc(XrdOucStream &Config, XrdSysError &Eroute);
+int    xprealloc(XrdOucStream &Config, XrdSysError &Eroute);
 int    xcache(XrdOucStream &Config, XrdSysError &Eroute);
 int    xcachescan(XrdOucStream &Config, XrdSysError &Eroute);
 int    xdefault(XrdOucStream &Config, XrdSysError &Eroute);
+int    xfdcache(XrdOucStream &Config, XrdSysError &Eroute);
 int    xfdlimit(XrdOucStream &Config, XrdSysError &Eroute);
 int    xmaxsz(XrdOucStream &Config, XrdSysError &Eroute);
 int    xmemf(XrdOucStream &Config, XrdSysError &Eroute);
 int    xnml(XrdOucStream &Config, XrdSysError &Eroute);
 int    xpath(XrdOucStream &Config, XrdSysError &Eroute);
 int    xprerd(XrdOucStream &Config, XrdSysError &Eroute);
+int    xrdahead(XrdOucStream &Config, XrdSysError &Eroute);
 int    xspace(XrdOucStream &Config, XrdSysError &Eroute, int *isCD=0);
 int    xspace(XrdOucStream &Config, XrdSysError &Eroute,
               const char *grp, bool isAsgn);
 int    xspaceBuild(char *grp, char *fn, int isxa, XrdSysError &Eroute);
+int    xstc(XrdOucStream &Config, XrdSysError &Eroute);
 int    xstg(XrdOucStream &Config, XrdSysError &Eroute);
 int    xstl(XrdOucStream &Config, XrdSysError &Eroute);
 int    xusage(XrdOucStream &Config, XrdSysError &Eroute);
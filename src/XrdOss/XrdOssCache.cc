@@ -37,6 +37,7 @@
 #include <sys/param.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <vector>
 
 #include "XrdOss/XrdOssCache.hh"
 #include "XrdOss/XrdOssOpaque.hh"
@@ -45,6 +46,7 @@
 #include "XrdOss/XrdOssTrace.hh"
 #include "XrdSys/XrdSysHeaders.hh"
 #include "XrdSys/XrdSysPlatform.hh"
+#include "XrdSys/XrdSysPthread.hh"
   
 /******************************************************************************/
 /*            G l o b a l s   a n d   S t a t i c   M e m b e r s             */
@@ -71,9 +73,66 @@ double              XrdOssCache::fuzAlloc= 0.0;
 long long           XrdOssCache::minAlloc= 0;
 int                 XrdOssCache::fsCount = 0;
 int                 XrdOssCache::ovhAlloc= 0;
+int                 XrdOssCache::ldAlloc = 0;
 int                 XrdOssCache::Quotas  = 0;
+int                 XrdOssCache::scanTmo = 10;
 int                 XrdOssCache::Usage   = 0;
 
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+// Each partition is scanned by its own thread so that the partitions are
+// scanned in parallel and a hung file system only holds up its own thread.
+// All of the job state is protected by scanCV.
+//
+class ScanJob
+{
+public:
+
+XrdOssCache_FSData *fsdp;
+XrdSysSemaphore     jobSem;
+long long           frsz;     // Free space found by the last scan
+int                 retc;     // errno from the last scan or 0
+bool                busy;     // A scan is in progress
+bool                done;     // A result is available for the current round
+bool                hung;     // The scan did not finish in time
+
+                    ScanJob(XrdOssCache_FSData *fP)
+                           : fsdp(fP), jobSem(0), frsz(0), retc(0),
+                             busy(false), done(false), hung(false) {}
+                   ~ScanJob() {}
+};
+
+XrdSysCondVar          scanCV(0, "cache scan");
+XrdSysMutex            scanMutex;     // Serializes scan rounds
+std::vector<ScanJob *> scanJobs;
+int                    scanPend = 0;
+
+void *ScanPart(void *carg)
+{
+   ScanJob *jP = static_cast<ScanJob *>(carg);
+   long long frsz, llT;
+   int retc;
+
+// Wait for a request, get the free space, and report the result
+//
+   while(1)
+        {jP->jobSem.Wait();
+         frsz = XrdOssCache_FS::freeSpace(llT, jP->fsdp->path);
+         retc = (frsz < 0 ? errno : 0);
+         scanCV.Lock();
+         jP->frsz = frsz; jP->retc = retc;
+         jP->busy = false; jP->done = true;
+         if (!jP->hung && --scanPend <= 0) scanCV.Signal();
+         scanCV.UnLock();
+        }
+   return (void *)0;
+}
+}
+
 /******************************************************************************/
 /*            X r d O s s C a c h e _ F S D a t a   M e t h o d s             */
 /******************************************************************************/
@@ -98,6 +157,8 @@ XrdOssCache_FSData::XrdOssCache_FSData(const char *fsp,
      next = 0;
      stat = 0;
      seen = 0;
+     ioActive  = 0;
+     ioLatency = 0;
 }
   
 /******************************************************************************/
@@ -419,7 +480,7 @@ int XrdOssCache::Alloc(XrdOssCache::allocInfo &aInfo)
    XrdOssPath::fnInfo Info;
    XrdOssCache_FS *fsp, *fspend, *fsp_sel;
    XrdOssCache_Group *cgp = 0;
-   long long size, maxfree, curfree;
+   long long size, maxfree, curfree, curcost, mincost = 0;
    int rc, madeDir, datfd = 0;
 
 // Compute appropriate allocation size
@@ -447,6 +508,18 @@ int XrdOssCache::Alloc(XrdOssCache::allocInfo &aInfo)
        curfree = fsp->fsdata->frsz;
        if (size > curfree) continue;
 
+// When load is to be considered, choose the least busy partition as measured
+// by the requests in progress and their latency. Ties go to the most free.
+//
+       if (ldAlloc)
+          {curcost = static_cast<long long>(fsp->fsdata->ioActive + 1)
+                   * static_cast<long long>(fsp->fsdata->ioLatency + 1);
+           if (!fsp_sel || curcost < mincost
+           ||  (curcost == mincost && curfree > maxfree))
+              {fsp_sel = fsp; mincost = curcost; maxfree = curfree;}
+           continue;
+          }
+
              if (fuzAlloc > 0.999) {fsp_sel = fsp; break;}
        else  if (!fuzAlloc || !fsp_sel)
                 {if (curfree > maxfree) {fsp_sel = fsp; maxfree = curfree;}}
@@ -558,16 +631,34 @@ int XrdOssCache::Init(const char *UPath, const char *Qfile, int isSOL)
 
 /******************************************************************************/
 
-int XrdOssCache::Init(long long aMin, int ovhd, int aFuzz)
+int XrdOssCache::Init(long long aMin, int ovhd, int aFuzz, int aLoad)
 {
 // Set values
 //
    minAlloc = aMin;
    ovhAlloc = ovhd;
    fuzAlloc = static_cast<double>(aFuzz)/100.0;
+   ldAlloc  = aLoad;
    return 0;
 }
 
+/******************************************************************************/
+/*                                i o F i n d                                 */
+/******************************************************************************/
+  
+XrdOssCache_FSData *XrdOssCache::ioFind(dev_t devID)
+{
+   XrdOssCache_FSData *fsdp;
+
+// Load is only tracked if allocation depends on it. Partitions are only ever
+// added to the front of the list so it can be safely run without the lock.
+//
+   if (!ldAlloc) return 0;
+   fsdp = fsdata;
+   while(fsdp && fsdp->fsid != devID) fsdp = fsdp->next;
+   return fsdp;
+}
+
 /******************************************************************************/
 /*                                  L i s t                                   */
 /******************************************************************************/
@@ -627,12 +718,9 @@ char *XrdOssCache::Parse(const char *token, char *cbuff, int cblen)
 
 void *XrdOssCache::Scan(int cscanint)
 {
-   EPNAME("CacheScan")
-   XrdOssCache_FSData *fsdp;
    XrdOssCache_Group  *fsgp;
    const struct timespec naptime = {cscanint, 0};
-   long long frsz, llT; // llT is a dummy temporary
-   int retc, dbgMsg, dbgNoMsg, dbgDoMsg;
+   int dbgMsg, dbgNoMsg, dbgDoMsg;
 
 // Try to prevent floodingthe log with scan messages
 //
@@ -647,42 +735,13 @@ void *XrdOssCache::Scan(int cscanint)
          dbgDoMsg = !dbgNoMsg--;
          if (dbgDoMsg) dbgNoMsg = dbgMsg;
 
-        // Get the cache context lock
-        //
-           Mutex.Lock();
-
         // Scan through all filesystems skip filesystem that have been
         // recently adjusted to avoid fs statstics latency problems.
         //
-           fsSize =  0;
-           fsTotFr=  0;
-           fsFree =  0;
-           fsdp = fsdata;
-           while(fsdp)
-                {retc = 0;
-                 if ((fsdp->stat & XrdOssFSData_REFRESH)
-                 || !(fsdp->stat & XrdOssFSData_ADJUSTED) || cscanint <= 0)
-                     {frsz = XrdOssCache_FS::freeSpace(llT,fsdp->path);
-                      if (frsz < 0) OssEroute.Emsg("CacheScan", errno ,
-                                    "state file system ",(char *)fsdp->path);
-                         else {fsdp->frsz = frsz;
-                               fsdp->stat &= ~(XrdOssFSData_REFRESH |
-                                               XrdOssFSData_ADJUSTED);
-                               if (dbgDoMsg)
-                                  {DEBUG("New free=" <<fsdp->frsz <<" path=" <<fsdp->path);}
-                               }
-                     } else fsdp->stat |= XrdOssFSData_REFRESH;
-                 if (!retc)
-                    {if (fsdp->frsz > fsFree)
-                        {fsFree = fsdp->frsz; fsSize = fsdp->size;}
-                     fsTotFr += fsdp->frsz;
-                    }
-                 fsdp = fsdp->next;
-                }
+           ScanAll(cscanint <= 0, dbgDoMsg);
 
-        // Unlock the cache and if we have quotas check them out
+        // If we have quotas check them out
         //
-           Mutex.UnLock();
            if (cscanint <= 0) return (void *)0;
            if (Quotas) XrdOssSpace::Quotas();
 
@@ -702,3 +761,111 @@ void *XrdOssCache::Scan(int cscanint)
 //
    return (void *)0;
 }
+
+/******************************************************************************/
+/*                               S c a n A l l                                */
+/******************************************************************************/
+
+void XrdOssCache::ScanAll(bool all, bool dbgDoMsg)
+{
+   EPNAME("CacheScan")
+   XrdOssCache_FSData *fsdp;
+   ScanJob *jP;
+   pthread_t tid;
+   time_t tNow, tEnd;
+   int i, retc, numJobs;
+
+// Only one scan round may be in progress at a time
+//
+   scanMutex.Lock();
+
+// The first time through, create a scan thread for each partition. Should
+// that fail, the partition is simply not scanned.
+//
+   if (scanJobs.empty())
+      {fsdp = fsdata;
+       while(fsdp)
+            {jP = new ScanJob(fsdp);
+             if ((retc = XrdSysThread::Run(&tid, ScanPart, (void *)jP,
+                                           0, "cache partition scan")))
+                {OssEroute.Emsg("CacheScan", retc, "create scan thread for",
+                                fsdp->path);
+                 delete jP;
+                } else scanJobs.push_back(jP);
+             fsdp = fsdp->next;
+            }
+      }
+   numJobs = scanJobs.size();
+
+// Select the partitions to be scanned. A partition recently adjusted is
+// skipped once; we note that no adjustment has happened since the scan was
+// started so that we can tell if one happened during the scan.
+//
+   Mutex.Lock();
+   scanCV.Lock();
+   scanPend = 0;
+   for (i = 0; i < numJobs; i++)
+       {jP = scanJobs[i]; fsdp = jP->fsdp;
+        jP->done = false;
+        if (!all && !(fsdp->stat & XrdOssFSData_REFRESH)
+        &&           (fsdp->stat & XrdOssFSData_ADJUSTED))
+           {fsdp->stat |= XrdOssFSData_REFRESH; continue;}
+        fsdp->stat &= ~XrdOssFSData_ADJUSTED;
+        if (jP->busy) continue;
+        if (jP->hung)
+           {OssEroute.Emsg("CacheScan", "Partition", fsdp->path,
+                           "is responding again.");
+            jP->hung = false;
+           }
+        jP->busy = true; scanPend++;
+        jP->jobSem.Post();
+       }
+   Mutex.UnLock();
+
+// Wait for all of the scans to complete or for the time limit to be reached.
+// Partitions that did not respond in time keep their last known values.
+//
+   tEnd = time(0) + scanTmo;
+   while(scanPend > 0 && (tNow = time(0)) < tEnd)
+        scanCV.Wait(static_cast<int>(tEnd - tNow));
+   for (i = 0; i < numJobs; i++)
+       {jP = scanJobs[i];
+        if (jP->busy && !jP->hung)
+           {jP->hung = true;
+            OssEroute.Emsg("CacheScan", "Partition", jP->fsdp->path,
+                           "is not responding; using last known free space.");
+           }
+       }
+   scanCV.UnLock();
+
+// Update the partition information and the totals. A partition adjusted
+// while being scanned keeps its adjusted value and is refreshed next time.
+//
+   Mutex.Lock();
+   fsSize =  0;
+   fsTotFr=  0;
+   fsFree =  0;
+   for (i = 0; i < numJobs; i++)
+       {jP = scanJobs[i]; fsdp = jP->fsdp;
+        if (jP->done)
+           {if (jP->retc) OssEroute.Emsg("CacheScan", jP->retc,
+                                  "state file system ",(char *)fsdp->path);
+               else if (fsdp->stat & XrdOssFSData_ADJUSTED)
+                       fsdp->stat |= XrdOssFSData_REFRESH;
+               else {fsdp->frsz = jP->frsz;
+                     fsdp->stat &= ~XrdOssFSData_REFRESH;
+                     if (dbgDoMsg)
+                        {DEBUG("New free=" <<fsdp->frsz <<" path=" <<fsdp->path);}
+                    }
+           }
+       }
+   fsdp = fsdata;
+   while(fsdp)
+        {if (fsdp->frsz > fsFree)
+            {fsFree = fsdp->frsz; fsSize = fsdp->size;}
+         fsTotFr += fsdp->frsz;
+         fsdp = fsdp->next;
+        }
+   Mutex.UnLock();
+   scanMutex.UnLock();
+}
@@ -33,6 +33,7 @@
 #include <time.h>
 #include <sys/stat.h>
 #include "XrdOuc/XrdOucDLlist.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
@@ -114,6 +115,8 @@ const char         *path;
 time_t              updt;
 int                 stat;
 unsigned int        seen;
+int                 ioActive;   // I/O requests in progress (atomic)
+int                 ioLatency;  // Smoothed I/O latency in microseconds
 
        XrdOssCache_FSData(const char *, STATFS_t &, dev_t);
       ~XrdOssCache_FSData() {if (path) free((void *)path);}
@@ -219,7 +222,24 @@ static XrdOssCache_FS *Find(const char *Path, int lklen=0);
 
 static int             Init(const char *UDir, const char *Qfile, int isSOL);
 
-static int             Init(long long aMin, int ovhd, int aFuzz);
+static int             Init(long long aMin, int ovhd, int aFuzz, int aLoad=0);
+
+// The following track the I/O load of each partition when allocation is to
+// take load into account. ioFind() returns the partition holding a file given
+// the device of the file or nil if load is not being tracked. ioBeg() and
+// ioEnd() bracket each I/O request against the partition.
+//
+static XrdOssCache_FSData *ioFind(dev_t devID);
+
+static inline long long ioBeg(XrdOssCache_FSData *fsdP)
+                             {AtomicInc(fsdP->ioActive); return ioClock();}
+
+static inline void      ioEnd(XrdOssCache_FSData *fsdP, long long tBeg)
+                             {int lat = static_cast<int>(ioClock() - tBeg);
+                              AtomicDec(fsdP->ioActive);
+                              // Lost updates only make this less precise
+                              fsdP->ioLatency += (lat - fsdP->ioLatency)/8;
+                             }
 
 static void            List(const char *lname, XrdSysError &Eroute);
 
@@ -227,6 +247,8 @@ static char           *Parse(const char *token, char *cbuff, int cblen);
 
 static void           *Scan(int cscanint);
 
+static int                 scanTmo;  // Seconds to wait for a partition scan
+
                        XrdOssCache() {}
                       ~XrdOssCache() {}
 
@@ -244,9 +266,19 @@ static int                 fsCount;  // Number of file systems
 
 private:
 
+static long long           ioClock()
+                                  {struct timespec tNow;
+                                   clock_gettime(CLOCK_MONOTONIC, &tNow);
+                                   return tNow.tv_sec*1000000LL
+                                        + tNow.tv_nsec/1000;
+                                  }
+
+static void                ScanAll(bool all, bool dbgDoMsg);
+
 static long long           minAlloc;
 static double              fuzAlloc;
 static int                 ovhAlloc;
+static int                 ldAlloc;
 static int                 Quotas;
 static int                 Usage;
 };
@@ -48,9 +48,11 @@
 #include "XrdOss/XrdOssCache.hh"
 #include "XrdOss/XrdOssConfig.hh"
 #include "XrdOss/XrdOssError.hh"
+#include "XrdOss/XrdOssFdCache.hh"
 #include "XrdOss/XrdOssMio.hh"
 #include "XrdOss/XrdOssOpaque.hh"
 #include "XrdOss/XrdOssSpace.hh"
+#include "XrdOss/XrdOssStatCache.hh"
 #include "XrdOss/XrdOssTrace.hh"
 #include "XrdOuc/XrdOuca2x.hh"
 #include "XrdOuc/XrdOucEnv.hh"
@@ -186,6 +188,11 @@ XrdOssSys::XrdOssSys()
    minalloc      = 0;
    ovhalloc      = 0;
    fuzalloc      = 0;
+   ldalloc       = 0;
+   paMin         = -1;
+   paExtSz       = 0;
+   raWindow      = 0;
+   raDrop        = false;
    xfrspeed      = 9*1024*1024;
    xfrovhd       = 30;
    xfrhold       =  3*60*60;
@@ -296,7 +303,7 @@ int XrdOssSys::Configure(const char *configfn, XrdSysError &Eroute,
    Solitary = ((val = getenv("XRDREDIRECT")) && !strcmp(val, "Q"));
    if (Solitary) Eroute.Say("++++++ Configuring standalone mode . . .");
    NoGo |= XrdOssCache::Init(UDir, QFile, Solitary)
-          |XrdOssCache::Init(minalloc, ovhalloc, fuzalloc);
+          |XrdOssCache::Init(minalloc, ovhalloc, fuzalloc, ldalloc);
 
 // Configure the MSS interface including staging
 //
@@ -329,6 +336,10 @@ int XrdOssSys::Configure(const char *configfn, XrdSysError &Eroute,
 //
    if (!NoGo) ConfigStats(Eroute);
 
+// Start watching for changes to files whose stat information is cached
+//
+   if (!NoGo && !XrdOssStatCache::Start(Eroute)) NoGo = 1;
+
 // Start up the cache scan thread unless specifically told not to. Some programs
 // like the cmsd manually handle space updates.
 //
@@ -387,8 +398,8 @@ void XrdOssSys::Config_Display(XrdSysError &Eroute)
         else cloc = ConfigFN;
 
      snprintf(buff, sizeof(buff), "Config effective %s oss configuration:\n"
-                                  "       oss.alloc        %lld %d %d\n"
-                                  "       oss.cachescan    %d\n"
+                                  "       oss.alloc        %lld %d %d%s\n"
+                                  "       oss.cachescan    %d timeout %d\n"
                                   "       oss.fdlimit      %d %d\n"
                                   "       oss.maxsize      %lld\n"
                                   "%s%s%s"
@@ -401,8 +412,8 @@ void XrdOssSys::Config_Display(XrdSysError &Eroute)
                                   "       oss.trace        %x\n"
                                   "       oss.xfr          %d deny %d keep %d",
              cloc,
-             minalloc, ovhalloc, fuzalloc,
-             cscanint,
+             minalloc, ovhalloc, fuzalloc, (ldalloc ? " load" : ""),
+             cscanint, XrdOssCache::scanTmo,
              FDFence, FDLimit, MaxSize,
              XrdOssConfig_Val(N2N_Lib,    namelib),
              XrdOssConfig_Val(LocalRoot,  localroot),
@@ -417,6 +428,18 @@ void XrdOssSys::Config_Display(XrdSysError &Eroute)
 
      Eroute.Say(buff);
 
+     if (paMin >= 0)
+        {snprintf(buff, sizeof(buff), "       oss.prealloc     min %lld extsz %d",
+                  paMin, paExtSz);
+         Eroute.Say(buff);
+        }
+
+     if (raWindow)
+        {snprintf(buff, sizeof(buff), "       oss.readahead    %d%s",
+                  raWindow, (raDrop ? " dropbehind" : ""));
+         Eroute.Say(buff);
+        }
+
      XrdOssMio::Display(Eroute);
 
      XrdOssCache::List("       oss.", Eroute);
@@ -971,18 +994,23 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
     int nosubs;
     XrdOucEnv *myEnv = 0;
 
+   TS_Xeq("aio",           xaio);
    TS_Xeq("alloc",         xalloc);
    TS_Xeq("cache",         xcache);
    TS_Xeq("cachescan",     xcachescan);
    TS_Xeq("defaults",      xdefault);
+   TS_Xeq("fdcache",       xfdcache);
    TS_Xeq("fdlimit",       xfdlimit);
    TS_Xeq("maxsize",       xmaxsz);
    TS_Xeq("memfile",       xmemf);
    TS_Xeq("namelib",       xnml);
    TS_Xeq("path",          xpath);
+   TS_Xeq("prealloc",      xprealloc);
    TS_Xeq("preread",       xprerd);
+   TS_Xeq("readahead",     xrdahead);
    TS_Xeq("space",         xspace);
    TS_Xeq("stagecmd",      xstg);
+   TS_Xeq("statcache",     xstc);
    TS_Xeq("statlib",       xstl);
    TS_Xeq("trace",         xtrace);
    TS_Xeq("usage",         xusage);
@@ -1040,13 +1068,59 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
    return 0;
 }
 
+/******************************************************************************/
+/*                                  x a i o                                   */
+/******************************************************************************/
+
+/* Function: xaio
+
+   Purpose:  To parse the directive: aio {posix | uring [qdepth <n>]}
+
+             posix       use posix asynchronous I/O (the default).
+             uring       use io_uring, if the kernel supports it. Otherwise,
+                         posix asynchronous I/O is used.
+             <n>         the io_uring submission queue depth (default 256).
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xaio(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val;
+    int qd;
+
+    if (!(val = Config.GetWord()))
+       {Eroute.Emsg("Config", "aio type not specified"); return 1;}
+
+    if (!strcmp(val, "posix")) {AioType = 'p'; return 0;}
+
+    if (strcmp(val, "uring"))
+       {Eroute.Emsg("Config", "invalid aio type -", val); return 1;}
+
+#ifndef HAVE_IO_URING
+    Eroute.Say("Config warning: io_uring not supported; using posix aio.");
+#else
+    AioType = 'u';
+#endif
+
+    if ((val = Config.GetWord()))
+       {if (strcmp(val, "qdepth"))
+           {Eroute.Emsg("Config", "invalid aio option -", val); return 1;}
+        if (!(val = Config.GetWord()))
+           {Eroute.Emsg("Config", "aio qdepth value not specified"); return 1;}
+        if (XrdOuca2x::a2i(Eroute, "aio qdepth", val, &qd, 1, 32768)) return 1;
+        AioQDepth = qd;
+       }
+    return 0;
+}
+
 /******************************************************************************/
 /*                                x a l l o c                                 */
 /******************************************************************************/
 
 /* Function: aalloc
 
-   Purpose:  To parse the directive: alloc <min> [<headroom> [<fuzz>]]
+   Purpose:  To parse the directive: alloc <min> [<headroom> [<fuzz>]] [load]
 
              <min>       minimum amount of free space needed in a partition.
                          (asterisk uses default).
@@ -1056,6 +1130,10 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
                          quantities that may be ignored when selecting a cache
                            0 - reduces to finding the largest free space
                          100 - reduces to simple round-robin allocation
+             load        select the partition with the least I/O load (based
+                         on the number of requests in progress and on recent
+                         latency) among those with enough free space. The
+                         fuzz is then ignored.
 
    Output: 0 upon success or !0 upon failure.
 */
@@ -1066,25 +1144,38 @@ int XrdOssSys::xalloc(XrdOucStream &Config, XrdSysError &Eroute)
     long long mina = 0;
     int       fuzz = 0;
     int       hdrm = 0;
+    int       load = 0;
 
     if (!(val = Config.GetWord()))
        {Eroute.Emsg("Config", "alloc minfree not specified"); return 1;}
     if (strcmp(val, "*") &&
         XrdOuca2x::a2sz(Eroute, "alloc minfree", val, &mina, 0)) return 1;
 
-    if ((val = Config.GetWord()))
+    if ((val = Config.GetWord()) && strcmp(val, "load"))
        {if (strcmp(val, "*") &&
             XrdOuca2x::a2i(Eroute,"alloc headroom",val,&hdrm,0,100)) return 1;
 
-        if ((val = Config.GetWord()))
+        if ((val = Config.GetWord()) && strcmp(val, "load"))
            {if (strcmp(val, "*") &&
             XrdOuca2x::a2i(Eroute, "alloc fuzz", val, &fuzz, 0, 100)) return 1;
+            val = Config.GetWord();
            }
        }
 
+    if (val)
+       {if (strcmp(val, "load"))
+           {Eroute.Emsg("Config", "invalid alloc option -", val); return 1;}
+#ifdef HAVE_ATOMICS
+        load = 1;
+#else
+        Eroute.Say("Config warning: alloc load not supported; ignored.");
+#endif
+       }
+
     minalloc = mina;
     ovhalloc = hdrm;
     fuzalloc = fuzz;
+    ldalloc  = load;
     return 0;
 }
 
@@ -1122,9 +1213,12 @@ int XrdOssSys::xcache(XrdOucStream &Config, XrdSysError &Eroute)
 
 /* Function: xcachescan
 
-   Purpose:  To parse the directive: cachescan <num>
+   Purpose:  To parse the directive: cachescan <num> [timeout <sec>]
 
              <num>     number of seconds between cache scans.
+             <sec>     number of seconds to wait for partitions to be scanned
+                       (default 10). Partitions are scanned in parallel and
+                       those not responding in time keep their last values.
 
    Output: 0 upon success or !0 upon failure.
 */
@@ -1136,6 +1230,16 @@ int XrdOssSys::xcachescan(XrdOucStream &Config, XrdSysError &Eroute)
        {Eroute.Emsg("Config", "cachescan not specified"); return 1;}
     if (XrdOuca2x::a2tm(Eroute, "cachescan", val, &cscan, 30)) return 1;
     cscanint = cscan;
+
+    if ((val = Config.GetWord()))
+       {if (strcmp(val, "timeout"))
+           {Eroute.Emsg("Config", "invalid cachescan option -", val); return 1;}
+        if (!(val = Config.GetWord()))
+           {Eroute.Emsg("Config", "cachescan timeout not specified"); return 1;}
+        if (XrdOuca2x::a2tm(Eroute, "cachescan timeout", val, &cscan, 1))
+           return 1;
+        XrdOssCache::scanTmo = cscan;
+       }
     return 0;
 }
 
@@ -1159,6 +1263,50 @@ int XrdOssSys::xdefault(XrdOucStream &Config, XrdSysError &Eroute)
    return 0;
 }
   
+/******************************************************************************/
+/*                              x f d c a c h e                               */
+/******************************************************************************/
+
+/* Function: xfdcache
+
+   Purpose:  To parse the directive: fdcache {off | <num> [hold <sec>]}
+
+             off      does not cache file descriptors (the default).
+             <num>    maximum number of descriptors of closed read/only files
+                      to keep for reuse by a subsequent open of the same file.
+                      Cached descriptors count against the fdlimit.
+             <sec>    maximum number of seconds (or M, H, etc) a descriptor is
+                      kept (default 60).
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xfdcache(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val;
+    int num, hold = 60;
+
+    if (!(val = Config.GetWord()))
+       {Eroute.Emsg("Config", "fdcache value not specified"); return 1;}
+
+    if (!strcmp(val, "off")) {XrdOssFdCache::Init(0, 0); return 0;}
+
+    if (XrdOuca2x::a2i(Eroute, "fdcache value", val, &num, 1)) return 1;
+
+    if ((val = Config.GetWord()))
+       {if (strcmp(val, "hold"))
+           {Eroute.Emsg("Config", "invalid fdcache option -", val); return 1;}
+        if (!(val = Config.GetWord()))
+           {Eroute.Emsg("Config", "fdcache hold value not specified");
+            return 1;
+           }
+        if (XrdOuca2x::a2tm(Eroute, "fdcache hold", val, &hold, 1)) return 1;
+       }
+
+    XrdOssFdCache::Init(num, hold);
+    return 0;
+}
+
 /******************************************************************************/
 /*                              x f d l i m i t                               */
 /******************************************************************************/
@@ -1227,12 +1375,17 @@ int XrdOssSys::xmaxsz(XrdOucStream &Config, XrdSysError &Eroute)
 /* Function: xmemf
 
    Purpose:  Parse the directive: memfile [off] [max <msz>]
-                                          [check xattr] [preload]
+                                          [check xattr] [preload] [hugepages]
+                                          [advise <hint>]
 
+             advise     Tells the kernel how mapped files will be read. The
+                        <hint> is one of normal, random, sequential, willneed.
              check      Applies memory mapping options based on file's xattrs.
                         For backward compatibility, we also accept:
                         "[check {keep | lock | map}]" which implies check xattr.
              all        Preloads the complete file into memory.
+             hugepages  Aligns large mappings so transparent huge pages can be
+                        used, where the file system supports them.
              off        Disables memory mapping regardless of other options.
              on         Enables memory mapping
              preload    Preloads the file after every opn reference.
@@ -1244,7 +1397,7 @@ int XrdOssSys::xmaxsz(XrdOucStream &Config, XrdSysError &Eroute)
 int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
 {
     char *val;
-    int i, j, V_check=-1, V_preld = -1, V_on=-1;
+    int i, j, V_check=-1, V_preld = -1, V_on=-1, V_huge = -1, V_advise = -1;
     long long V_max = 0;
 
     static struct mmapopts {const char *opname; int otyp;
@@ -1253,7 +1406,9 @@ int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
         {"off",        0, ""},
         {"preload",    1, "memfile preload"},
         {"check",      2, "memfile check"},
-        {"max",        3, "memfile max"}};
+        {"max",        3, "memfile max"},
+        {"advise",     4, "memfile advise"},
+        {"hugepages",  5, "memfile hugepages"}};
     int numopts = sizeof(mmopts)/sizeof(struct mmapopts);
 
     if (!(val = Config.GetWord()))
@@ -1264,7 +1419,8 @@ int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
               if (!strcmp(val, mmopts[i].opname)) break;
           if (i >= numopts)
              Eroute.Say("Config warning: ignoring invalid memfile option '",val,"'.");
-             else {if (mmopts[i].otyp >  1 && !(val = Config.GetWord()))
+             else {if (mmopts[i].otyp >  1 && mmopts[i].otyp < 5
+                   && !(val = Config.GetWord()))
                       {Eroute.Emsg("Config","memfile",mmopts[i].opname,
                                    "value not specified");
                        return 1;
@@ -1291,6 +1447,21 @@ int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
                                                 mmopts[i].opmsg, val, &V_max,
                                                 10*1024*1024)) return 1;
                                   break;
+                          case 4:      if (!strcmp("normal",     val))
+                                          V_advise = OSSMIO_ADVNONE;
+                                  else if (!strcmp("random",     val))
+                                          V_advise = OSSMIO_ADVRAND;
+                                  else if (!strcmp("sequential", val))
+                                          V_advise = OSSMIO_ADVSEQ;
+                                  else if (!strcmp("willneed",   val))
+                                          V_advise = OSSMIO_ADVWILL;
+                                  else {Eroute.Emsg("Config",
+                                        "invalid memfile advise hint -", val);
+                                        return 1;
+                                       }
+                                  break;
+                          case 5: V_huge = 1;
+                                  break;
                           default: V_on = 0; break;
                          }
                   val = Config.GetWord();
@@ -1299,7 +1470,7 @@ int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
 
 // Set the values
 //
-   XrdOssMio::Set(V_on, V_preld, V_check);
+   XrdOssMio::Set(V_on, V_preld, V_check, V_huge, V_advise);
    XrdOssMio::Set(V_max);
    return 0;
 }
@@ -1381,6 +1552,60 @@ int XrdOssSys::xpath(XrdOucStream &Config, XrdSysError &Eroute)
    return 1;
 }
 
+/******************************************************************************/
+/*                             x p r e a l l o c                              */
+/******************************************************************************/
+
+/* Function: xprealloc
+
+   Purpose:  To parse the directive: prealloc {off | [min <size>] [extsz <esz>]}
+
+             <size>   files expected (oss.asize) to be at least this large
+                      have their blocks reserved when they are created. The
+                      default is 1m. Blocks not written are released on close.
+             <esz>    on XFS, also allocate new extents in units of <esz>
+                      bytes. The default is not to set an extent size hint.
+             off      do not preallocate, the default.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xprealloc(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val;
+    long long mins = 1024*1024, esz = 0;
+
+    if ((val = Config.GetWord()) && !strcmp(val, "off"))
+       {paMin = -1; paExtSz = 0; return 0;}
+
+    while(val)
+         {     if (!strcmp(val, "min"))
+                  {if (!(val = Config.GetWord()))
+                      {Eroute.Emsg("Config", "prealloc min not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2sz(Eroute, "prealloc min", val, &mins, 0))
+                      return 1;
+                  }
+          else if (!strcmp(val, "extsz"))
+                  {if (!(val = Config.GetWord()))
+                      {Eroute.Emsg("Config", "prealloc extsz not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2sz(Eroute, "prealloc extsz", val, &esz,
+                                       0, 1024*1024*1024)) return 1;
+                  }
+          else {Eroute.Emsg("Config", "invalid prealloc option -", val);
+                return 1;
+               }
+          val = Config.GetWord();
+         }
+
+    paMin   = mins;
+    paExtSz = static_cast<int>(esz);
+    return 0;
+}
+
 /******************************************************************************/
 /*                                x p r e r d                                 */
 /******************************************************************************/
@@ -1455,6 +1680,54 @@ int XrdOssSys::xprerd(XrdOucStream &Config, XrdSysError &Eroute)
       return 0;
 }
   
+/******************************************************************************/
+/*                              x r d a h e a d                               */
+/******************************************************************************/
+
+/* Function: xrdahead
+
+   Purpose:  To parse the directive: readahead {off | on | <window>} [dropbehind]
+
+             <window> the number of bytes to keep prefetched ahead of a reader
+                      found to be reading sequentially. Readers found to be
+                      reading randomly have kernel readahead turned off.
+                      Specifying "on" sets the value to 4M. The max is 1G.
+             off      do not track access patterns, the default.
+             dropbehind also drop from the page cache whatever a sequential
+                      reader has left more than two windows behind.
+
+   Notes:    Reads sent with sendfile() do not pass through the oss and are
+             left to the kernel's own readahead.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xrdahead(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val;
+    long long win;
+    bool drop = false;
+
+      if (!(val = Config.GetWord()))
+         {Eroute.Emsg("Config", "readahead window not specified"); return 1;}
+
+      if (!strcmp(val, "off")) {raWindow = 0; raDrop = false; return 0;}
+      if (!strcmp(val, "on")) win = 4*1024*1024;
+         else if (XrdOuca2x::a2sz(Eroute, "readahead window", val, &win,
+                                  prPSize, 1024*1024*1024)) return 1;
+
+      while((val = Config.GetWord()))
+           {if (!strcmp(val, "dropbehind")) drop = true;
+               else {Eroute.Emsg("Config","invalid readahead option -",val);
+                     return 1;
+                    }
+           }
+
+      raWindow = static_cast<int>(win);
+      raDrop   = drop;
+      return 0;
+}
+  
 /******************************************************************************/
 /*                                x s p a c e                                 */
 /******************************************************************************/
@@ -1662,6 +1935,58 @@ int XrdOssSys::xstg(XrdOucStream &Config, XrdSysError &Eroute)
    return 0;
 }
 
+/******************************************************************************/
+/*                                  x s t c                                   */
+/******************************************************************************/
+
+/* Function: xstc
+
+   Purpose:  To parse the directive: statcache {off | <num> [ttl <sec>] [inotify]}
+
+             off      does not cache stat information (the default).
+             <num>    maximum number of stat results to keep for reuse by a
+                      subsequent stat of the same file.
+             <sec>    maximum number of seconds (or M, H, etc) a result is
+                      kept (default 5). Changes made on other hosts are only
+                      seen once the result expires.
+             inotify  also use inotify to discard results for files changed
+                      on this host outside of the server (Linux only).
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xstc(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val;
+    int num, ttl = 5;
+    bool inotify = false;
+
+    if (!(val = Config.GetWord()))
+       {Eroute.Emsg("Config", "statcache value not specified"); return 1;}
+
+    if (!strcmp(val, "off")) {XrdOssStatCache::Init(0, 0, false); return 0;}
+
+    if (XrdOuca2x::a2i(Eroute, "statcache value", val, &num, 1)) return 1;
+
+    while((val = Config.GetWord()))
+         {if (!strcmp(val, "inotify")) inotify = true;
+             else if (!strcmp(val, "ttl"))
+                     {if (!(val = Config.GetWord()))
+                         {Eroute.Emsg("Config", "statcache ttl value not specified");
+                          return 1;
+                         }
+                      if (XrdOuca2x::a2tm(Eroute,"statcache ttl",val,&ttl,1))
+                         return 1;
+                     }
+             else {Eroute.Emsg("Config", "invalid statcache option -", val);
+                   return 1;
+                  }
+         }
+
+    XrdOssStatCache::Init(num, ttl, inotify);
+    return 0;
+}
+
 /******************************************************************************/
 /*                                  x s t l                                   */
 /******************************************************************************/
@@ -38,6 +38,11 @@
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
   
 #include "XrdOss/XrdOssCopy.hh"
 #include "XrdOss/XrdOssTrace.hh"
@@ -69,7 +74,7 @@ off_t XrdOssCopy::Copy(const char *inFn, const char *outFn, int outFD)
    struct utimbuf tBuff;
    struct stat buf, bufO, bufSL;
    char *inBuff, *bP;
-   off_t  Offset=0, fileSize;
+   off_t  Offset=0, mmStart, fileSize;
    size_t ioSize, copySize;
    ssize_t rLen;
    int rc;
@@ -102,9 +107,18 @@ off_t XrdOssCopy::Copy(const char *inFn, const char *outFn, int outFD)
        return fileSize;
       }
 
+// Have the kernel copy the data if it can. Whatever it could not copy is
+// copied below, starting over at the last whole segment.
+//
+   if (fileSize > 0 && (Offset = KernelCopy(In.FD, Out.FD, fileSize)))
+      {Offset  -= Offset % (off_t)segSize;
+       copySize = fileSize - Offset;
+      }
+   mmStart = Offset;
+
 // We now copy 1MB segments using direct I/O
 //
-   ioSize = (fileSize < (off_t)segSize ? fileSize : segSize);
+   ioSize = (copySize < segSize ? copySize : segSize);
    while(copySize)
         {if ((inBuff = (char *)mmap(0, ioSize, PROT_READ, 
 #if defined(__FreeBSD__)
@@ -123,11 +137,11 @@ off_t XrdOssCopy::Copy(const char *inFn, const char *outFn, int outFD)
 // check if there was an error and if we can recover
 
    if (copySize)
-   { if ((off_t)copySize != fileSize) return -EIO;
+   { if (Offset != mmStart) return -EIO;
      // Do a traditional copy (note that we didn't copy anything yet)
      OssEroute.Emsg("Copy", "Trying traditional copy for", inFn, "...");
      char ioBuff[segSize];
-     off_t rdSize, wrSize = segSize, inOff=0;
+     off_t rdSize, wrSize = segSize, inOff=Offset;
      while(copySize)
           {if (copySize < segSize) rdSize = wrSize = copySize;
               else rdSize = segSize;
@@ -160,6 +174,44 @@ off_t XrdOssCopy::Copy(const char *inFn, const char *outFn, int outFD)
    return fileSize;
 }
 
+/******************************************************************************/
+/* private:                   K e r n e l C o p y                             */
+/******************************************************************************/
+
+// Returns the number of leading bytes of the input copied to the output, 0 if
+// the kernel cannot copy between these files.
+//
+off_t XrdOssCopy::KernelCopy(int inFD, int outFD, off_t fileSize)
+{
+#ifdef __linux__
+   static const size_t cfrSize = 64*1024*1024;
+
+// A reflink shares the data blocks, which is possible when both partitions
+// are on the same filesystem (e.g. btrfs subvolumes) that supports it.
+//
+#ifdef FICLONE
+   if (!ioctl(outFD, FICLONE, inFD)) return fileSize;
+#endif
+
+// Otherwise copy in large chunks without passing the data through user space.
+// The kernel advances the offsets by what it copied.
+//
+#ifdef __NR_copy_file_range
+   loff_t inOff = 0, outOff = 0;
+   ssize_t rc;
+   while(inOff < fileSize)
+        {size_t n = (fileSize - inOff < (off_t)cfrSize ? fileSize - inOff
+                                                         : cfrSize);
+         rc = syscall(__NR_copy_file_range, inFD, &inOff, outFD, &outOff, n, 0);
+         if (rc < 0 && errno == EINTR) continue;
+         if (rc <= 0) break;
+        }
+   return inOff;
+#endif
+#endif
+   return 0;
+}
+
 /******************************************************************************/
 /* private:                        W r i t e                                  */
 /******************************************************************************/
@@ -40,6 +40,7 @@ static off_t Copy(const char *inFn, const char *outFn, int outFD);
             ~XrdOssCopy() {}
 
 private:
+static off_t KernelCopy(int inFD, int outFD, off_t fileSize);
 static int   Write(const char *, int, char *, size_t, off_t);
 };
 #endif
@@ -45,6 +45,10 @@
 #if defined(__solaris__) || defined(AIX)
 #include <sys/vnode.h>
 #endif
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
 
 #include "XrdFrc/XrdFrcXAttr.hh"
 #include "XrdOss/XrdOssApi.hh"
@@ -55,6 +59,7 @@
 #include "XrdOss/XrdOssOpaque.hh"
 #include "XrdOss/XrdOssPath.hh"
 #include "XrdOss/XrdOssSpace.hh"
+#include "XrdOss/XrdOssStatCache.hh"
 #include "XrdOss/XrdOssTrace.hh"
 #include "XrdOuc/XrdOuca2x.hh"
 #include "XrdOuc/XrdOucEnv.hh"
@@ -75,6 +80,25 @@ extern XrdOucTrace OssTrace;
 
 extern XrdOssSys  *XrdOssSS;
 
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+// Return the expected file size passed by the client, or -1 if none
+//
+long long SizeHint(XrdOucEnv &env)
+{
+   long long fsize;
+   char *tmp;
+
+   if (!(tmp = env.Get(OSS_ASIZE))
+   ||  XrdOuca2x::a2sz(OssEroute,"invalid asize",tmp,&fsize,0)) return -1;
+   return fsize;
+}
+}
+
 /******************************************************************************/
 /*                         L o c a l   C l a s s e s                          */
 /******************************************************************************/
@@ -159,6 +183,7 @@ int XrdOssSys::Create(const char *tident, const char *path, mode_t access_mode,
        do {datfd = open(local_path, Opts>>8, access_mode);}
                    while(datfd < 0 && errno == EINTR);
        if (datfd < 0) return -errno;
+       if (Opts>>8 & O_TRUNC) Prealloc(datfd, SizeHint(env));
        if ((retc = SetFattr(crInfo, datfd, buf.st_mtime))) return retc;
        if (Opts>>8 & O_TRUNC && buf.st_size)
           {off_t theSize = buf.st_size;
@@ -166,6 +191,7 @@ int XrdOssSys::Create(const char *tident, const char *path, mode_t access_mode,
                         XrdOssCache::Adjust(local_path, -theSize, &buf);
                        }
           }
+       if (XrdOssStatCache::Enabled()) XrdOssStatCache::Purge(path);
        return 0;
       }
 
@@ -213,6 +239,10 @@ int XrdOssSys::Create(const char *tident, const char *path, mode_t access_mode,
        if (plP) plP->Set(plP->Flag() | XRDEXP_NOXATTR);
       }
 
+// Any cached stat information for this path no longer applies
+//
+   if (XrdOssStatCache::Enabled()) XrdOssStatCache::Purge(path);
+
 // All done.
 //
    return retc;
@@ -258,6 +288,10 @@ int XrdOssSys::Alloc_Cache(XrdOssCreateInfo &crInfo, XrdOucEnv &env)
    aInfo.aMode  = crInfo.Amode;
    if ((datfd = XrdOssCache::Alloc(aInfo)) < 0) return datfd;
 
+// Reserve the space for the file when its size is known
+//
+   Prealloc(datfd, aInfo.cgSize);
+
 // Set the pfn as the extended attribute if we are in new mode
 //
    if (!runOld && !(crInfo.pOpts & XRDEXP_NOXATTR)
@@ -302,10 +336,14 @@ int XrdOssSys::Alloc_Local(XrdOssCreateInfo &crInfo, XrdOucEnv &env)
 
 // Simply open the file in the local filesystem, creating it if need be.
 //
-   do {datfd = open(crInfo.Path, O_CREAT|O_TRUNC, crInfo.Amode);}
+   do {datfd = open(crInfo.Path, O_CREAT|O_TRUNC|O_WRONLY, crInfo.Amode);}
                while(datfd < 0 && errno == EINTR);
    if (datfd < 0) return -errno;
 
+// Reserve the space for the file when its size is known
+//
+   Prealloc(datfd, SizeHint(env));
+
 // Set extended attributes for this newly created file if allowed to do so.
 // SetFattr() alaways closes the provided file descriptor!
 //
@@ -316,6 +354,44 @@ int XrdOssSys::Alloc_Local(XrdOssCreateInfo &crInfo, XrdOucEnv &env)
    return XrdOssOK;
 }
   
+/******************************************************************************/
+/*                              P r e a l l o c                               */
+/******************************************************************************/
+
+/* Function: Reserve the disk blocks of a file expected to have fsize bytes so
+             that interleaved uploads do not fragment each other. The file size
+             is not changed; blocks that end up not being written are released
+             when the file is closed (see XrdOssFile::Close()). Failures are
+             not errors, the file then simply grows as it is written.
+*/
+void XrdOssSys::Prealloc(int datfd, long long fsize)
+{
+   EPNAME("Prealloc")
+
+// Do nothing unless enabled and the size is known and large enough
+//
+   if (paMin < 0 || fsize <= 0 || fsize < paMin) return;
+
+#ifdef __linux__
+// On XFS have new extents allocated in units of the hinted size. This must be
+// set while the file is still empty; other filesystems reject it.
+//
+#ifdef FS_IOC_FSSETXATTR
+   if (paExtSz)
+      {struct fsxattr fsx;
+       if (!ioctl(datfd, FS_IOC_FSGETXATTR, &fsx))
+          {fsx.fsx_xflags |= FS_XFLAG_EXTSIZE;
+           fsx.fsx_extsize = paExtSz;
+           ioctl(datfd, FS_IOC_FSSETXATTR, &fsx);
+          }
+      }
+#endif
+
+   if (fallocate(datfd, FALLOC_FL_KEEP_SIZE, 0, fsize))
+      {DEBUG("unable to reserve " <<fsize <<" bytes; " <<strerror(errno));}
+#endif
+}
+
 /******************************************************************************/
 /*                              S e t F a t t r                               */
 /******************************************************************************/
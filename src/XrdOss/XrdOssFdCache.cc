@@ -0,0 +1,235 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d O s s F d C a c h e . c c                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+
+#include "XrdOss/XrdOssFdCache.hh"
+#include "XrdOss/XrdOssTrace.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+extern XrdOucTrace OssTrace;
+
+extern XrdSysError OssEroute;
+
+int XrdOssFdCache::maxFD    = 0;
+int XrdOssFdCache::holdTime = 0;
+
+/******************************************************************************/
+/*                          L o c a l   O b j e c t s                         */
+/******************************************************************************/
+
+namespace
+{
+// Each cached descriptor is in the path map and on a list ordered by the time
+// it was cached, most recent first. The list is used to expire descriptors.
+//
+struct fdEnt;
+
+typedef std::multimap<std::string, fdEnt *> fdMap_t;
+
+struct fdEnt
+      {fdEnt            *Next;
+       fdEnt            *Prev;
+       fdMap_t::iterator mapIt;
+       time_t            Expires;
+       time_t            Mtime;
+       off_t             Size;
+       ino_t             Ino;
+       dev_t             Dev;
+       int               fd;
+      };
+
+XrdSysMutex  fdMutex;
+fdMap_t      fdMap;
+fdEnt       *fdFirst = 0;
+fdEnt       *fdLast  = 0;
+int          fdNum   = 0;
+
+// Remove an entry from the list and the map. The caller must hold fdMutex.
+//
+void Unchain(fdEnt *eP)
+{
+   if (eP->Prev) eP->Prev->Next = eP->Next;
+      else fdFirst = eP->Next;
+   if (eP->Next) eP->Next->Prev = eP->Prev;
+      else fdLast  = eP->Prev;
+   fdMap.erase(eP->mapIt);
+   fdNum--;
+}
+
+// Close and delete a chain of entries linked via Next.
+//
+void Discard(fdEnt *eP)
+{
+   fdEnt *nP;
+
+   while(eP) {nP = eP->Next; close(eP->fd); delete eP; eP = nP;}
+}
+
+// Remove entries that have expired or exceed the limit. Returns the chain of
+// removed entries which must be discarded once fdMutex is released.
+//
+fdEnt *Trim(time_t Now, int Limit)
+{
+   fdEnt *eP, *rP = 0;
+
+   while((eP = fdLast) && (eP->Expires <= Now || fdNum > Limit))
+        {Unchain(eP);
+         eP->Next = rP; rP = eP;
+        }
+   return rP;
+}
+}
+
+/******************************************************************************/
+/*                                   G e t                                    */
+/******************************************************************************/
+  
+int XrdOssFdCache::Get(const char *path, const char *lclPath,
+                       struct stat &Stat)
+{
+   EPNAME("FdCache")
+   fdEnt *eP = 0, *xP;
+   fdMap_t::iterator it;
+   time_t Now = time(0);
+   int retc;
+
+// Get rid of any old descriptors and see if we have one for this path
+//
+   fdMutex.Lock();
+   xP = Trim(Now, maxFD);
+   if ((it = fdMap.find(path)) != fdMap.end())
+      {eP = it->second;
+       Unchain(eP);
+      }
+   fdMutex.UnLock();
+   Discard(xP);
+   if (!eP) return -1;
+
+// Make sure the descriptor still refers to the file at this path and that the
+// file has not changed since it was closed.
+//
+   do {retc = stat(lclPath, &Stat);} while(retc && errno == EINTR);
+   if (retc || Stat.st_dev != eP->Dev || Stat.st_ino   != eP->Ino
+   ||  Stat.st_size != eP->Size       || Stat.st_mtime != eP->Mtime)
+      {DEBUG("discarding changed fd=" <<eP->fd <<" path=" <<path);
+       eP->Next = 0;
+       Discard(eP);
+       return -1;
+      }
+
+// Return the descriptor
+//
+   retc = eP->fd;
+   delete eP;
+   DEBUG("reusing fd=" <<retc <<" path=" <<path);
+   return retc;
+}
+
+/******************************************************************************/
+/*                                  I n i t                                   */
+/******************************************************************************/
+  
+void XrdOssFdCache::Init(int maxfd, int hold)
+{
+   maxFD    = maxfd;
+   holdTime = hold;
+}
+
+/******************************************************************************/
+/*                                 P u r g e                                  */
+/******************************************************************************/
+  
+void XrdOssFdCache::Purge(const char *path)
+{
+   std::pair<fdMap_t::iterator, fdMap_t::iterator> range;
+   fdEnt *eP, *rP = 0;
+
+// Remove all of the entries for this path
+//
+   fdMutex.Lock();
+   range = fdMap.equal_range(path);
+   while(range.first != range.second)
+        {eP = (range.first++)->second;
+         Unchain(eP);
+         eP->Next = rP; rP = eP;
+        }
+   fdMutex.UnLock();
+
+// Close the descriptors
+//
+   Discard(rP);
+}
+
+/******************************************************************************/
+/*                                   P u t                                    */
+/******************************************************************************/
+  
+bool XrdOssFdCache::Put(const char *path, int fd)
+{
+   struct stat Stat;
+   fdEnt *eP, *xP;
+   time_t Now = time(0);
+   int retc;
+
+// Record what the file looks like now so we can check it upon reuse
+//
+   do {retc = fstat(fd, &Stat);} while(retc && errno == EINTR);
+   if (retc || !S_ISREG(Stat.st_mode) || !Stat.st_nlink) return false;
+
+   eP = new fdEnt;
+   eP->Prev    = 0;
+   eP->Expires = Now + holdTime;
+   eP->Mtime   = Stat.st_mtime;
+   eP->Size    = Stat.st_size;
+   eP->Ino     = Stat.st_ino;
+   eP->Dev     = Stat.st_dev;
+   eP->fd      = fd;
+
+// Add the entry at the front of the list and make room if need be
+//
+   fdMutex.Lock();
+   eP->mapIt = fdMap.insert(fdMap_t::value_type(path, eP));
+   if ((eP->Next = fdFirst)) fdFirst->Prev = eP;
+      else fdLast = eP;
+   fdFirst = eP;
+   fdNum++;
+   xP = Trim(Now, maxFD);
+   fdMutex.UnLock();
+   Discard(xP);
+   return true;
+}
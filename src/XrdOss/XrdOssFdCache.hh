@@ -0,0 +1,70 @@
+#ifndef __XRDOSSFDCACHE_HH__
+#define __XRDOSSFDCACHE_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d O s s F d C a c h e . h h                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+
+#include <sys/stat.h>
+
+// The XrdOssFdCache class keeps the descriptors of recently closed read/only
+// files so that the next open of the same file can reuse one instead of going
+// through the file system. It is used by XrdOssFile::Open() and Close() when
+// "oss.fdcache" is specified. A cached descriptor is only handed out if the
+// file still has the same device, inode, size, and modification time and it
+// has not been held longer than the configured time.
+//
+class XrdOssFdCache
+{
+public:
+
+// Return true if descriptors are being cached.
+//
+static bool  Enabled() {return maxFD > 0;}
+
+// Obtain a cached descriptor for path. The lclPath is used to validate it and
+// Stat is filled in with the file's information. Returns the descriptor or
+// -1 if there is none that can be used.
+//
+static int   Get(const char *path, const char *lclPath, struct stat &Stat);
+
+// Enable caching of up to maxfd descriptors held for at most hold seconds.
+//
+static void  Init(int maxfd, int hold);
+
+// Close any cached descriptors for path as the file has changed.
+//
+static void  Purge(const char *path);
+
+// Offer the descriptor of a closed file. Returns true if the descriptor was
+// kept. Otherwise, the caller must close it.
+//
+static bool  Put(const char *path, int fd);
+
+private:
+
+static int   maxFD;
+static int   holdTime;
+};
+#endif
@@ -29,6 +29,7 @@
 /******************************************************************************/
 
 #include <unistd.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <sys/param.h>
 #include <sys/types.h>
@@ -47,7 +48,7 @@
 /*                      S t a t i c   V a r i a b l e s                       */
 /******************************************************************************/
 
-XrdOucHash<XrdOssMioFile> XrdOssMio::MM_Hash;
+XrdOucOAHash<XrdOssMioFile> XrdOssMio::MM_Hash;
 
 XrdSysMutex    XrdOssMio::MM_Mutex;
 
@@ -59,6 +60,8 @@ char           XrdOssMio::MM_on       = 1;
 char           XrdOssMio::MM_chk      = 0;
 char           XrdOssMio::MM_okmlock  = 1;
 char           XrdOssMio::MM_preld    = 0;
+char           XrdOssMio::MM_huge     = 0;
+char           XrdOssMio::MM_advise   = OSSMIO_ADVNONE;
 long long      XrdOssMio::MM_pagsz    = (long long)sysconf(_SC_PAGESIZE);
 #ifdef __APPLE__
 long long      XrdOssMio::MM_pages    = 1024*1024*1024;
@@ -68,6 +71,11 @@ long long      XrdOssMio::MM_pages    = (long long)sysconf(_SC_PHYS_PAGES);
 long long      XrdOssMio::MM_max      = MM_pagsz*MM_pages/2;
 long long      XrdOssMio::MM_inuse    = 0;
 
+// Mappings at least this big are aligned so that transparent huge pages can
+// back them (the PMD size on all current Linux platforms we run on).
+//
+static const long long MM_hugesz = 2*1024*1024;
+
 extern XrdSysError OssEroute;
 
 extern XrdOucTrace OssTrace;
@@ -78,11 +86,14 @@ extern XrdOucTrace OssTrace;
 
 void XrdOssMio::Display(XrdSysError &Eroute)
 {
+     static const char *advName[] = {"", " advise random",
+                                     " advise sequential", " advise willneed"};
      char buff[1080];
-     snprintf(buff, sizeof(buff), "       oss.memfile %s%s%s max %lld",
+     snprintf(buff, sizeof(buff), "       oss.memfile %s%s%s max %lld%s%s",
              (MM_on      ? ""            : "off "),
              (MM_preld   ? "preload"     : ""),
-             (MM_chk     ? "check xattr" : ""), MM_max);
+             (MM_chk     ? "check xattr" : ""), MM_max,
+             (MM_huge    ? " hugepages"  : ""), advName[(int)MM_advise]);
      Eroute.Say(buff);
 }
 
@@ -99,6 +110,7 @@ XrdOssMioFile *XrdOssMio::Map(char *path, int fd, int opts)
    XrdOssMioFile *mp;
    void *thefile;
    char hashname[64];
+   bool isHuge;
 
 // Get the size of the file
 //
@@ -124,6 +136,7 @@ XrdOssMioFile *XrdOssMio::Map(char *path, int fd, int opts)
       {DEBUG("Reusing mmap; usecnt=" <<mp->inUse <<" path=" <<path);
        if (!(mp->Status & OSSMIO_MPRM) && !mp->inUse) Reclaim(mp);
        mp->inUse++;
+       mp->Hits++;
        return mp;
       }
 
@@ -139,10 +152,13 @@ XrdOssMioFile *XrdOssMio::Map(char *path, int fd, int opts)
 
 // Memory map the file
 //
-   if ((thefile = mmap(0,statb.st_size,PROT_READ,MAP_PRIVATE,fd,0))==MAP_FAILED)
+   if ((thefile = mapFile(fd, statb.st_size, isHuge)) == MAP_FAILED)
       {OssEroute.Emsg("Mio", errno, "mmap file", path);
+       MM_inuse -= statb.st_size;
        return 0;
-      } else {DEBUG("mmap " <<statb.st_size <<" bytes for " <<path);}
+      } else {DEBUG("mmap " <<statb.st_size <<" bytes for " <<path
+                    <<(isHuge ? " (huge pages)" : ""));
+             }
 
 // Lock the file, if need be. Turn off locking if we don't have privs
 //
@@ -213,6 +229,62 @@ XrdOssMioFile *XrdOssMio::Map(char *path, int fd, int opts)
 #endif
 }
 
+/******************************************************************************/
+/*                               m a p F i l e                                */
+/******************************************************************************/
+
+void *XrdOssMio::mapFile(int fd, off_t size, bool &isHuge)
+{
+#if defined(_POSIX_MAPPED_FILES)
+   void *theMap = MAP_FAILED;
+
+   isHuge = false;
+
+#if defined(MADV_HUGEPAGE)
+// Transparent huge pages can only back a mapping aligned on a huge page. So,
+// reserve enough address space to align the file and map it over the aligned
+// part, releasing what remains. Whether huge pages are actually used depends
+// on the file system (e.g. tmpfs with huge pages, or read-only file THP).
+//
+   if (MM_huge && size >= MM_hugesz)
+      {size_t rsz = size + MM_hugesz, msz = (size + MM_pagsz-1) & ~(MM_pagsz-1);
+       char *rP, *aP;
+       if ((rP = (char *)mmap(0, rsz, PROT_NONE,
+                        MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0))
+              != MAP_FAILED)
+          {aP = (char *)(((uintptr_t)rP + MM_hugesz - 1) & ~(MM_hugesz - 1));
+           if ((theMap = mmap(aP, size, PROT_READ, MAP_PRIVATE|MAP_FIXED,
+                              fd, 0)) == MAP_FAILED) munmap(rP, rsz);
+              else {if (aP > rP) munmap(rP, aP - rP);
+                    if (aP + msz < rP + rsz)
+                       munmap(aP + msz, (rP + rsz) - (aP + msz));
+                    isHuge = !madvise(theMap, size, MADV_HUGEPAGE);
+                   }
+          }
+      }
+#endif
+
+// Map the file in the usual way if we did not map it above
+//
+   if (theMap == MAP_FAILED
+   && (theMap = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+      return MAP_FAILED;
+
+// Tell the kernel how we expect the file to be used
+//
+   switch(MM_advise)
+         {case OSSMIO_ADVRAND: madvise(theMap, size, MADV_RANDOM);     break;
+          case OSSMIO_ADVSEQ:  madvise(theMap, size, MADV_SEQUENTIAL); break;
+          case OSSMIO_ADVWILL: madvise(theMap, size, MADV_WILLNEED);   break;
+          default: break;
+         }
+   return theMap;
+#else
+   isHuge = false;
+   return (void *)-1;
+#endif
+}
+
 /******************************************************************************/
 /*                               p r e L o a d                                */
 /******************************************************************************/
@@ -224,6 +296,12 @@ void *XrdOssMio::preLoad(void *arg)
    char *Bend = Base + mp->Size;
    long long MY_pagsz = MM_pagsz;
 
+// Let the kernel start reading the file in while we touch it below
+//
+#if defined(_POSIX_MAPPED_FILES)
+   madvise(Base, mp->Size, MADV_WILLNEED);
+#endif
+
 // Reference each page until we are done. This is somewhat obtuse but we
 // are trying to keep the compiler from optimizing out the code.
 //
@@ -247,10 +325,19 @@ int XrdOssMio::Reclaim(off_t amount)
    XrdOssMioFile *mp;
    DEBUG("Trying to reclaim " <<amount <<" bytes.");
 
-// Try to reclaim memory
+// Try to reclaim memory. Idle mappings are examined oldest first. One that
+// was referenced more than once since it was last examined gets another
+// chance with half its hits; others are unmapped. So, frequently opened
+// files stay mapped while those used once are reclaimed first.
 //
    while((mp = MM_Idle) && amount > 0)
-        {MM_Idle = mp->Next;
+        {if (!(MM_Idle = mp->Next)) MM_IdleLast = 0;
+         if (mp->Hits > 1 && MM_Idle)
+            {mp->Hits >>= 1;
+             mp->Next = 0;
+             MM_IdleLast->Next = mp; MM_IdleLast = mp;
+             continue;
+            }
          MM_inuse -= mp->Size;
          amount   -= mp->Size;
          MM_Hash.Del(mp->HashName);  // This will delete the object
@@ -314,11 +401,15 @@ void XrdOssMio::Recycle(XrdOssMioFile *mp)
 /*                                   S e t                                    */
 /******************************************************************************/
   
-void XrdOssMio::Set(int V_on, int V_preld,  int V_check)
+void XrdOssMio::Set(int V_on, int V_preld,  int V_check, int V_huge,
+                    int V_advise)
 {
    if (V_on      >= 0) MM_on      = (char)V_on;
    if (V_preld   >= 0) MM_preld   = (char)V_preld;
    if (V_check   >= 0) MM_chk     = (char)V_check;
+   if (V_huge    >= 0) MM_huge    = (char)V_huge;
+   if (V_advise  >= 0 && V_advise <= OSSMIO_ADVWILL)
+      MM_advise = (char)V_advise;
 }
 
 void XrdOssMio::Set(long long V_max)
@@ -31,7 +31,7 @@
 /******************************************************************************/
 
 #include "XrdSys/XrdSysError.hh"
-#include "XrdOuc/XrdOucHash.hh"
+#include "XrdOuc/XrdOucOAHash.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdOss/XrdOssMioFile.hh"
 
@@ -40,6 +40,13 @@
 #define OSSMIO_MLOK 0x0001
 #define OSSMIO_MMAP 0x0002
 #define OSSMIO_MPRM 0x0004
+
+// The following are the madvise() hints that Set() accepts
+//
+#define OSSMIO_ADVNONE 0
+#define OSSMIO_ADVRAND 1
+#define OSSMIO_ADVSEQ  2
+#define OSSMIO_ADVWILL 3
   
 class XrdOssMio
 {
@@ -56,15 +63,17 @@ static void          *preLoad(void *arg);
 
 static void           Recycle(XrdOssMioFile *mp);
 
-static void           Set(int V_off, int V_preld, int V_check);
+static void           Set(int V_off, int V_preld, int V_check,
+                          int V_huge=-1, int V_advise=-1);
 
 static void           Set(long long V_max);
 
 private:
 static int  Reclaim(off_t amount);
 static int  Reclaim(XrdOssMioFile *mp);
+static void *mapFile(int fd, off_t size, bool &isHuge);
 
-static XrdOucHash<XrdOssMioFile> MM_Hash;
+static XrdOucOAHash<XrdOssMioFile> MM_Hash;
 
 static XrdSysMutex    MM_Mutex;
 static XrdOssMioFile *MM_Perm;
@@ -75,6 +84,8 @@ static char       MM_on;
 static char       MM_chk;
 static char       MM_okmlock;
 static char       MM_preld;
+static char       MM_huge;
+static char       MM_advise;
 static long long  MM_max;
 static long long  MM_pagsz;
 static long long  MM_pages;
@@ -42,7 +42,7 @@ off_t Export(void **Addr) {*Addr = Base; return Size;}
 
        XrdOssMioFile(char *hname)
                     {strcpy(HashName, hname); 
-                     inUse = 1; Next = 0; Size = 0;
+                     inUse = 1; Next = 0; Size = 0; Hits = 1;
                     }
       ~XrdOssMioFile();
 
@@ -53,6 +53,7 @@ dev_t          Dev;
 ino_t          Ino;
 int            Status;
 int            inUse;
+unsigned int   Hits;     // References since the last reclaim pass
 void          *Base;
 off_t          Size;
 char           HashName[64];
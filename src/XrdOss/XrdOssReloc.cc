@@ -48,6 +48,7 @@
 #include "XrdOss/XrdOssError.hh"
 #include "XrdOss/XrdOssPath.hh"
 #include "XrdOss/XrdOssSpace.hh"
+#include "XrdOss/XrdOssStatCache.hh"
 #include "XrdOss/XrdOssTrace.hh"
 #include "XrdOuc/XrdOucUtils.hh"
 #include "XrdSys/XrdSysError.hh"
@@ -171,6 +172,7 @@ int XrdOssSys::Reloc(const char *tident, const char *path,
 //
    if (!anchor && rename(tbuff, local_path) < 0) return -errno;
    PF.tbuff = 0; PF.pbuff = 0; rc = 0;
+   if (!anchor && XrdOssStatCache::Enabled()) XrdOssStatCache::Purge(path);
 
 // Now create a symlink from the cache pfn to the actual path (xa runOld only)
 //
@@ -43,7 +43,9 @@
 #include "XrdOss/XrdOssApi.hh"
 #include "XrdOss/XrdOssCache.hh"
 #include "XrdOss/XrdOssError.hh"
+#include "XrdOss/XrdOssFdCache.hh"
 #include "XrdOss/XrdOssPath.hh"
+#include "XrdOss/XrdOssStatCache.hh"
 #include "XrdOss/XrdOssTrace.hh"
 #include "XrdOuc/XrdOucExport.hh"
 #include "XrdOuc/XrdOucUtils.hh"
@@ -106,6 +108,11 @@ int XrdOssSys::Rename(const char *oldname, const char *newname,
 //
    if ( (retc = GenLocalPath( oldname, local_path_Old))
      || (retc = GenLocalPath( newname, local_path_New)) ) return retc;
+
+// Any cached descriptors for either file no longer apply
+//
+   if (XrdOssFdCache::Enabled())
+      {XrdOssFdCache::Purge(oldname); XrdOssFdCache::Purge(newname);}
    if (remotefs
      && (((retc = GenRemotePath(oldname, remote_path_Old))
      ||   (retc = GenRemotePath(newname, remote_path_New)))) ) return retc;
@@ -131,6 +138,8 @@ int XrdOssSys::Rename(const char *oldname, const char *newname,
                retc = RenameLink(local_path_Old, local_path_New);
                else if (rename(local_path_Old, local_path_New)) retc = -errno;
     DEBUG("lcl rc=" <<retc <<" op=" <<local_path_Old <<" np=" <<local_path_New);
+    if (XrdOssStatCache::Enabled())
+       {XrdOssStatCache::Purge(oldname); XrdOssStatCache::Purge(newname);}
 
 // For migratable space, rename all suffix variations of the base file
 //
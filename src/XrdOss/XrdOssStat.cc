@@ -46,6 +46,7 @@
 #include "XrdOss/XrdOssOpaque.hh"
 #include "XrdOss/XrdOssPath.hh"
 #include "XrdOss/XrdOssSpace.hh"
+#include "XrdOss/XrdOssStatCache.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucName2Name.hh"
 #include "XrdOuc/XrdOucPList.hh"
@@ -71,8 +72,15 @@ int XrdOssSys::Stat(const char *path, struct stat *buff, int opts,
 {
     const int ro_Mode = ~(S_IWUSR | S_IWGRP | S_IWOTH);
     char actual_path[MAXPATHLEN+1], *local_path, *remote_path;
-    unsigned long long popts;
+    unsigned long long popts, stcTicket = 0;
     int retc;
+    bool stcOK;
+
+// Return cached information if we have it. We don't cache results that come
+// from a stat plug-in or when the access time must be updated.
+//
+   stcOK = XrdOssStatCache::Enabled() && !STT_Func && !(opts & XRDOSS_updtatm);
+   if (stcOK && XrdOssStatCache::Get(path, *buff, stcTicket)) return XrdOssOK;
 
 // Construct the processing options for this path
 //
@@ -95,6 +103,7 @@ int XrdOssSys::Stat(const char *path, struct stat *buff, int opts,
       } else retc = stat(local_path, buff);
    if (!retc)
       {if (popts & XRDEXP_NOTRW) buff->st_mode &= ro_Mode;
+       if (stcOK) XrdOssStatCache::Put(path, local_path, *buff, stcTicket);
        if (opts & XRDOSS_updtatm && (buff->st_mode & S_IFMT) == S_IFREG)
           {struct utimbuf times;
            times.actime  = time(0);
@@ -479,7 +488,8 @@ int XrdOssSys::getStats(char *buff, int blen)
 //
    if (!buff) return ptag1sz + (ptag2sz * numDP) + stag3sz + lenDP
                    + stag1sz + (stag2sz * numCG) + stag3sz
-                   + stagqsz + stagssz;
+                   + stagqsz + stagssz
+                   + (XrdOssStatCache::Enabled() ? XrdOssStatCache::Stats(0,0):0);
 
 // Make sure we have enough space for one entry
 //
@@ -527,9 +537,13 @@ int XrdOssSys::getStats(char *buff, int blen)
 
 // Insert trailer
 //
-   if (blen >= stag3sz) {strcpy(bp, stag3); bp += (stag3sz-1);}
+   if (blen >= stag3sz) {strcpy(bp, stag3); bp += (stag3sz-1); blen -= (stag3sz-1);}
       else return dpNum;
 
+// Add stat cache statistics, if any
+//
+   if (XrdOssStatCache::Enabled()) bp += XrdOssStatCache::Stats(bp, blen);
+
 // All done
 //
    return bp - buff;
@@ -0,0 +1,471 @@
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d O s s S t a t C a c h e . c c                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <unordered_map>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+#include "XrdOss/XrdOssStatCache.hh"
+#include "XrdOss/XrdOssTrace.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+extern XrdOucTrace OssTrace;
+
+extern XrdSysError OssEroute;
+
+int  XrdOssStatCache::maxEnt    = 0;
+int  XrdOssStatCache::ttlTime   = 0;
+bool XrdOssStatCache::useNotify = false;
+
+/******************************************************************************/
+/*                          L o c a l   O b j e c t s                         */
+/******************************************************************************/
+
+namespace
+{
+// Each entry is in the path map and on a list ordered by the time it was
+// added, most recent first. The list is used to expire entries. When inotify
+// is used, each entry also refers to the watched directory holding it; the
+// directory is no longer watched once it has no entries.
+//
+struct dirEnt;
+struct stEnt;
+
+typedef std::unordered_map<std::string, stEnt  *> stMap_t;
+typedef std::unordered_map<std::string, dirEnt *> dirMap_t;
+typedef std::unordered_map<int,         dirEnt *> wdMap_t;
+typedef std::unordered_map<std::string, int>      busyMap_t;
+
+struct dirEnt
+      {const std::string *Name;   // Logical directory path ending with a slash
+       int                wd;
+       int                Refs;
+      };
+
+struct stEnt
+      {stEnt             *Next;
+       stEnt             *Prev;
+       const std::string *Path;
+       dirEnt            *dirP;
+       time_t             Expires;
+       struct stat        Stat;
+      };
+
+XrdSysMutex        stMutex;
+stMap_t            stMap;
+dirMap_t           dirMap;
+wdMap_t            wdMap;
+busyMap_t          busyMap;
+stEnt             *stFirst = 0;
+stEnt             *stLast  = 0;
+int                stNum   = 0;
+int                inFD    = -1;
+unsigned long long stGen   = 1;
+long long          numHits = 0;
+long long          numMiss = 0;
+
+// Stop watching a directory when its last entry goes away. The caller must
+// hold stMutex.
+//
+void DirDrop(dirEnt *dP)
+{
+   if (!dP || --dP->Refs > 0) return;
+#if defined(__linux__)
+   inotify_rm_watch(inFD, dP->wd);
+#endif
+   wdMap.erase(dP->wd);
+   dirMap.erase(*dP->Name);
+   delete dP;
+}
+
+// Remove and delete an entry. The caller must hold stMutex.
+//
+void Remove(stEnt *eP)
+{
+   if (eP->Prev) eP->Prev->Next = eP->Next;
+      else stFirst = eP->Next;
+   if (eP->Next) eP->Next->Prev = eP->Prev;
+      else stLast  = eP->Prev;
+   DirDrop(eP->dirP);
+   stMap.erase(*eP->Path);
+   stNum--;
+   delete eP;
+}
+
+// Remove the entry for path, if any. The caller must hold stMutex.
+//
+void Remove(const std::string &path)
+{
+   stMap_t::iterator it = stMap.find(path);
+
+   if (it != stMap.end()) Remove(it->second);
+}
+
+#if defined(__linux__)
+// Watch the directory holding path, if possible. We can only do so when the
+// logical and physical file names are the same as the events we receive only
+// have the file name. The caller must hold stMutex.
+//
+dirEnt *DirAdd(const char *path, const char *lclPath)
+{
+   static const uint32_t inMask = IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE
+                                | IN_CREATE | IN_DELETE | IN_MOVED_FROM
+                                | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF
+                                | IN_ONLYDIR;
+   static bool warned = false;
+   const char *lSlash = rindex(path, '/'), *pSlash = rindex(lclPath, '/');
+   dirMap_t::iterator it;
+   dirEnt *dP;
+   int wd;
+
+// Make sure the file names are the same
+//
+   if (inFD < 0 || !lSlash || !pSlash || strcmp(lSlash, pSlash)) return 0;
+
+// If we are already watching the directory, just count the entry
+//
+   std::string lDir(path, lSlash - path + 1);
+   if ((it = dirMap.find(lDir)) != dirMap.end())
+      {it->second->Refs++;
+       return it->second;
+      }
+
+// Add a watch. Two logical directories may refer to the same physical one; in
+// that case only the first one is watched.
+//
+   std::string pDir(lclPath, (pSlash == lclPath ? 1 : pSlash - lclPath));
+   if ((wd = inotify_add_watch(inFD, pDir.c_str(), inMask)) < 0)
+      {if (!warned && errno == ENOSPC)
+          {OssEroute.Emsg("StatCache", "inotify watch limit reached; some "
+                          "entries will only expire.");
+           warned = true;
+          }
+       return 0;
+      }
+   if (wdMap.find(wd) != wdMap.end()) return 0;
+
+   dP = new dirEnt;
+   dP->Name = &(dirMap.insert(dirMap_t::value_type(lDir, dP)).first->first);
+   dP->wd   = wd;
+   dP->Refs = 1;
+   wdMap[wd] = dP;
+   return dP;
+}
+
+// Process an inotify event. The caller must hold stMutex.
+//
+void Event(struct inotify_event *evP)
+{
+   wdMap_t::iterator it;
+   dirEnt *dP;
+   stEnt  *eP, *nP;
+
+// Should the queue have overflowed, we must assume everything changed
+//
+   if (evP->mask & IN_Q_OVERFLOW)
+      {while(stFirst) Remove(stFirst);
+       stGen++;
+       return;
+      }
+
+// Find the directory
+//
+   if ((it = wdMap.find(evP->wd)) == wdMap.end()) return;
+   dP = it->second;
+   stGen++;
+
+// If the directory itself went away or is no longer watched, remove every
+// entry in it. The last one removed also deletes the directory entry.
+//
+   if (evP->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_IGNORED))
+      {eP = stFirst;
+       while(eP) {nP = eP->Next; if (eP->dirP == dP) Remove(eP); eP = nP;}
+       return;
+      }
+
+// Remove the file and, as its contents changed, the directory itself
+//
+   if (evP->len && *evP->name)
+      {std::string path(*dP->Name);
+       Remove(path + evP->name);
+       if (evP->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+       &&  path.size() > 1)
+          {path.erase(path.size()-1);
+           Remove(path);
+          }
+      }
+}
+#else
+dirEnt *DirAdd(const char *path, const char *lclPath) {return 0;}
+#endif
+}
+
+/******************************************************************************/
+/*                     E x t e r n a l   T h r e a d s                        */
+/******************************************************************************/
+
+#if defined(__linux__)
+void *XrdOssStatCacheNotify(void *carg)
+{
+   char buff[16384] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+   struct inotify_event *evP;
+   char *bP;
+   int n;
+
+// Read events and process each one, in order
+//
+   while(1)
+        {if ((n = read(inFD, buff, sizeof(buff))) <= 0)
+            {if (n < 0 && errno == EINTR) continue;
+             OssEroute.Emsg("StatCache", errno, "read inotify events");
+             break;
+            }
+         stMutex.Lock();
+         for (bP = buff; bP < buff + n; bP += sizeof(*evP) + evP->len)
+             {evP = (struct inotify_event *)bP;
+              Event(evP);
+             }
+         stMutex.UnLock();
+        }
+
+// Nothing else can be done. Watched entries can no longer be trusted and new
+// ones will simply expire.
+//
+   stMutex.Lock();
+   close(inFD); inFD = -1;
+   while(stFirst) Remove(stFirst);
+   stGen++;
+   stMutex.UnLock();
+   return (void *)0;
+}
+#endif
+
+/******************************************************************************/
+/*                                   G e t                                    */
+/******************************************************************************/
+  
+bool XrdOssStatCache::Get(const char *path, struct stat &Stat,
+                          unsigned long long &Ticket)
+{
+   stMap_t::iterator it;
+   time_t Now = time(0);
+
+// Look up the path. An expired entry is simply removed.
+//
+   stMutex.Lock();
+   if ((it = stMap.find(path)) != stMap.end())
+      {if (it->second->Expires > Now)
+          {Stat = it->second->Stat;
+           numHits++;
+           stMutex.UnLock();
+           return true;
+          }
+       Remove(it->second);
+      }
+
+// Issue a ticket so that we can tell whether the file was changed while its
+// information was obtained.
+//
+   numMiss++;
+   Ticket = stGen;
+   stMutex.UnLock();
+   return false;
+}
+
+/******************************************************************************/
+/*                                  H o l d                                   */
+/******************************************************************************/
+  
+void XrdOssStatCache::Hold(const char *path)
+{
+   std::string thePath(path);
+
+   stMutex.Lock();
+   busyMap[thePath]++;
+   Remove(thePath);
+   stGen++;
+   stMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                                  I n i t                                   */
+/******************************************************************************/
+  
+void XrdOssStatCache::Init(int maxent, int ttl, bool inotify)
+{
+   maxEnt    = maxent;
+   ttlTime   = ttl;
+   useNotify = inotify;
+}
+
+/******************************************************************************/
+/*                                 P u r g e                                  */
+/******************************************************************************/
+  
+void XrdOssStatCache::Purge(const char *path)
+{
+   std::string thePath(path);
+
+   stMutex.Lock();
+   Remove(thePath);
+   stGen++;
+   stMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                                   P u t                                    */
+/******************************************************************************/
+  
+void XrdOssStatCache::Put(const char *path, const char *lclPath,
+                          struct stat &Stat, unsigned long long Ticket)
+{
+   std::pair<stMap_t::iterator, bool> rslt;
+   std::string thePath(path);
+   stEnt *eP;
+   time_t Now = time(0);
+
+// Do not cache the information if something changed since the ticket was
+// issued or if the file is open for update.
+//
+   stMutex.Lock();
+   if (Ticket != stGen || busyMap.find(thePath) != busyMap.end())
+      {stMutex.UnLock();
+       return;
+      }
+
+// Add the entry, replacing any that was added in the meantime
+//
+   eP = new stEnt;
+   rslt = stMap.insert(stMap_t::value_type(thePath, eP));
+   if (!rslt.second)
+      {Remove(rslt.first->second);
+       rslt = stMap.insert(stMap_t::value_type(thePath, eP));
+      }
+   eP->Path    = &(rslt.first->first);
+   eP->Prev    = 0;
+   eP->Expires = Now + ttlTime;
+   eP->Stat    = Stat;
+   eP->dirP    = (useNotify ? DirAdd(path, lclPath) : 0);
+   if ((eP->Next = stFirst)) stFirst->Prev = eP;
+      else stLast = eP;
+   stFirst = eP;
+   stNum++;
+
+// Make room if need be and get rid of expired entries
+//
+   while(stLast && (stNum > maxEnt || stLast->Expires <= Now)) Remove(stLast);
+   stMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                               R e l e a s e                                */
+/******************************************************************************/
+  
+void XrdOssStatCache::Release(const char *path)
+{
+   std::string thePath(path);
+   busyMap_t::iterator it;
+
+   stMutex.Lock();
+   if ((it = busyMap.find(thePath)) != busyMap.end() && --(it->second) <= 0)
+      busyMap.erase(it);
+   Remove(thePath);
+   stGen++;
+   stMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                                 S t a r t                                  */
+/******************************************************************************/
+  
+bool XrdOssStatCache::Start(XrdSysError &Eroute)
+{
+#if defined(__linux__)
+   pthread_t tid;
+   int retc;
+
+   if (!maxEnt || !useNotify) return true;
+
+   if ((inFD = inotify_init1(IN_CLOEXEC)) < 0)
+      {Eroute.Emsg("Config", errno, "initialize inotify for the stat cache");
+       return false;
+      }
+
+   if ((retc = XrdSysThread::Run(&tid, XrdOssStatCacheNotify, (void *)0,
+                                 0, "stat cache notify")))
+      {Eroute.Emsg("Config", retc, "create stat cache notify thread");
+       close(inFD); inFD = -1;
+       return false;
+      }
+#else
+   if (maxEnt && useNotify)
+      {Eroute.Say("Config warning: inotify is not supported on this platform; "
+                  "statcache inotify option ignored.");
+       useNotify = false;
+      }
+#endif
+   return true;
+}
+
+/******************************************************************************/
+/*                                 S t a t s                                  */
+/******************************************************************************/
+  
+int XrdOssStatCache::Stats(char *buff, int blen)
+{
+   static const char stfmt[] = "<stcache><num>%d</num><hits>%lld</hits>"
+                               "<miss>%lld</miss><ratio>%d</ratio></stcache>";
+   long long hits, miss;
+   int num, ratio, n;
+
+// If only the size is wanted, return it
+//
+   if (!buff) return sizeof(stfmt) + (16*4);
+
+// Get the counters and compute the hit ratio (in percent)
+//
+   stMutex.Lock();
+   num = stNum; hits = numHits; miss = numMiss;
+   stMutex.UnLock();
+   ratio = (hits + miss ? static_cast<int>((hits * 100) / (hits + miss)) : 0);
+
+// Format the statistics
+//
+   n = snprintf(buff, blen, stfmt, num, hits, miss, ratio);
+   return (n < blen ? n : 0);
+}
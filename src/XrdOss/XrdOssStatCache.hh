@@ -0,0 +1,90 @@
+#ifndef __XRDOSSSTATCACHE_HH__
+#define __XRDOSSSTATCACHE_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d O s s S t a t C a c h e . h h                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+
+#include <sys/stat.h>
+
+class XrdSysError;
+
+// The XrdOssStatCache class keeps the result of recent successful stat calls
+// keyed by logical path so that XrdOssSys::Stat() can skip the name mapping
+// and the file system round trip. It is used when "oss.statcache" is given.
+// Entries live for a short time and are purged whenever the file is changed
+// through the oss (create, open for update, close, truncate, unlink, etc).
+// Optionally, inotify is used to also catch changes made on this host outside
+// of the server. A stat of a file that is open for update is never cached.
+//
+class XrdOssStatCache
+{
+public:
+
+// Return true if stat results are being cached.
+//
+static bool  Enabled() {return maxEnt > 0;}
+
+// Find the cached stat information for path. Returns true and fills in Stat
+// if found. Otherwise, Ticket is set and must be passed to Put() so that a
+// result obtained while the file was being changed is not cached.
+//
+static bool  Get(const char *path, struct stat &Stat, unsigned long long &Ticket);
+
+// Mark path as being open for update (Hold) or no longer so (Release). Each
+// Hold must be followed by a Release. Both purge the path.
+//
+static void  Hold(const char *path);
+static void  Release(const char *path);
+
+// Cache up to maxent entries for at most ttl seconds, optionally using inotify.
+//
+static void  Init(int maxent, int ttl, bool inotify);
+
+// Remove path from the cache as the file has changed.
+//
+static void  Purge(const char *path);
+
+// Add the stat information for path. The lclPath is the physical path used
+// to obtain it; it is only used to watch its directory.
+//
+static void  Put(const char *path, const char *lclPath, struct stat &Stat,
+                 unsigned long long Ticket);
+
+// Start the inotify thread, if needed. Returns true upon success.
+//
+static bool  Start(XrdSysError &Eroute);
+
+// Format statistics into buff (see XrdOssSys::getStats()). If buff is nil,
+// return the maximum length needed.
+//
+static int   Stats(char *buff, int blen);
+
+private:
+
+static int   maxEnt;
+static int   ttlTime;
+static bool  useNotify;
+};
+#endif
@@ -42,8 +42,10 @@
 #include "XrdOss/XrdOssCache.hh"
 #include "XrdOss/XrdOssConfig.hh"
 #include "XrdOss/XrdOssError.hh"
+#include "XrdOss/XrdOssFdCache.hh"
 #include "XrdOss/XrdOssOpaque.hh"
 #include "XrdOss/XrdOssPath.hh"
+#include "XrdOss/XrdOssStatCache.hh"
 #include "XrdOss/XrdOssTrace.hh"
 
 /******************************************************************************/
@@ -124,6 +126,7 @@ int XrdOssSys::Unlink(const char *path, int Opts, XrdOucEnv *eP)
        if ( (retc = GenLocalPath( path,  local_path))
        ||   (retc = GenRemotePath(path, remote_path)) ) return retc;
        haslf &= XRDEXP_MAKELF;
+       if (XrdOssFdCache::Enabled()) XrdOssFdCache::Purge(path);
       }
 
 // Check if this path is really a directory of a symbolic link elsewhere
@@ -136,6 +139,9 @@ int XrdOssSys::Unlink(const char *path, int Opts, XrdOucEnv *eP)
                         if (local_path[i-1] != '/') strcpy(local_path+i, "/");
                         if ((retc = rmdir(local_path))) retc = -errno;
                         DEBUG("dir rc=" <<retc <<" path=" <<local_path);
+                        if (!(Opts & XRDOSS_isPFN)
+                        &&  XrdOssStatCache::Enabled())
+                           XrdOssStatCache::Purge(path);
                         return retc;
                        } else doAdjust = 1;
 
@@ -167,6 +173,11 @@ int XrdOssSys::Unlink(const char *path, int Opts, XrdOucEnv *eP)
        DEBUG("rmt rc=" <<retc2 <<" path=" <<remote_path);
       }
 
+// Any cached stat information for this path no longer applies
+//
+   if (!(Opts & XRDOSS_isPFN) && XrdOssStatCache::Enabled())
+      XrdOssStatCache::Purge(path);
+
 // All done
 //
    return retc;
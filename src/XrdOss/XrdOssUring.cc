@@ -0,0 +1,338 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O s s U r i n g . c c                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#ifdef HAVE_IO_URING
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "XrdOss/XrdOssTrace.hh"
+#include "XrdOss/XrdOssUring.hh"
+#include "XrdSfs/XrdSfsAio.hh"
+#include "XrdSys/XrdSysAtomics.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+extern XrdOucTrace OssTrace;
+
+extern XrdSysError OssEroute;
+
+/******************************************************************************/
+/*                          L o c a l   O b j e c t s                         */
+/******************************************************************************/
+
+namespace
+{
+// The low bits of the user data of each request tell us what completed
+//
+static const unsigned long long isRead  = 0;
+static const unsigned long long isWrite = 1;
+static const unsigned long long tagMask = 3;
+
+// The ring shared with the kernel
+//
+int                  ringFD = -1;
+unsigned            *sqHead;
+unsigned            *sqTail;
+unsigned            *sqMask;
+unsigned            *sqArray;
+unsigned             sqEntries;
+unsigned             sqLocal;     // Next tail value, protected by sqMutex
+unsigned             sqPend;      // Entries not yet submitted (sqMutex)
+struct io_uring_sqe *sqes;
+unsigned            *cqHead;
+unsigned            *cqTail;
+unsigned            *cqMask;
+struct io_uring_cqe *cqes;
+int                  cqEntries;
+int                  inFlight = 0;
+
+XrdSysMutex          sqMutex;     // Serializes filling submission entries
+XrdSysMutex          subMutex;    // Held by the thread doing the submits
+
+int sysSetup(unsigned entries, struct io_uring_params *p)
+   {return (int)syscall(__NR_io_uring_setup, entries, p);}
+
+int sysEnter(unsigned toSubmit, unsigned minComplete, unsigned flags)
+   {return (int)syscall(__NR_io_uring_enter, ringFD, toSubmit, minComplete,
+                        flags, (void *)0, 0);
+   }
+
+void *ringMap(size_t len, unsigned long long off)
+   {void *mP = mmap(0, len, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                    ringFD, off);
+    return (mP == MAP_FAILED ? 0 : mP);
+   }
+}
+
+/******************************************************************************/
+/*            E x t e r n a l   T h r e a d   I n t e r f a c e s             */
+/******************************************************************************/
+
+void *XrdOssUringReap(void *carg)
+{
+   return XrdOssUring::Reap();
+}
+
+/******************************************************************************/
+/*                                 F s y n c                                  */
+/******************************************************************************/
+
+int XrdOssUring::Fsync(XrdSfsAio *aiop, int fd)
+{
+   return Queue(aiop, fd, IORING_OP_FSYNC, isWrite);
+}
+
+/******************************************************************************/
+/*                                  I n i t                                   */
+/******************************************************************************/
+
+bool XrdOssUring::Init(int qdepth)
+{
+   EPNAME("UringInit");
+   struct io_uring_params parms;
+   pthread_t tid;
+   char *sqRing, *cqRing;
+   int retc;
+
+// Create the ring
+//
+   memset(&parms, 0, sizeof(parms));
+   if ((ringFD = sysSetup(qdepth, &parms)) < 0)
+      {OssEroute.Emsg("AioInit", errno, "create io_uring");
+       return false;
+      }
+
+// We need IORING_OP_READ and IORING_OP_WRITE which came with the feature below
+//
+   if (!(parms.features & IORING_FEAT_RW_CUR_POS))
+      {OssEroute.Emsg("AioInit", "io_uring is too old to be used.");
+       close(ringFD); ringFD = -1;
+       return false;
+      }
+
+// Map the submission ring, the completion ring, and the submission entries
+//
+   sqRing = (char *)ringMap(parms.sq_off.array + parms.sq_entries
+                            * sizeof(unsigned), IORING_OFF_SQ_RING);
+   cqRing = (char *)ringMap(parms.cq_off.cqes + parms.cq_entries
+                            * sizeof(struct io_uring_cqe), IORING_OFF_CQ_RING);
+   sqes   = (struct io_uring_sqe *)ringMap(parms.sq_entries
+                            * sizeof(struct io_uring_sqe), IORING_OFF_SQES);
+   if (!sqRing || !cqRing || !sqes)
+      {OssEroute.Emsg("AioInit", errno, "map io_uring");
+       close(ringFD); ringFD = -1;
+       return false;
+      }
+
+// Establish the ring pointers
+//
+   sqHead    = (unsigned *)(sqRing + parms.sq_off.head);
+   sqTail    = (unsigned *)(sqRing + parms.sq_off.tail);
+   sqMask    = (unsigned *)(sqRing + parms.sq_off.ring_mask);
+   sqArray   = (unsigned *)(sqRing + parms.sq_off.array);
+   sqEntries = parms.sq_entries;
+   sqLocal   = *sqTail;
+   sqPend    = 0;
+   cqHead    = (unsigned *)(cqRing + parms.cq_off.head);
+   cqTail    = (unsigned *)(cqRing + parms.cq_off.tail);
+   cqMask    = (unsigned *)(cqRing + parms.cq_off.ring_mask);
+   cqes      = (struct io_uring_cqe *)(cqRing + parms.cq_off.cqes);
+   cqEntries = static_cast<int>(parms.cq_entries);
+
+// Start the completion thread
+//
+   if ((retc = XrdSysThread::Run(&tid, XrdOssUringReap, (void *)0,
+                                 0, "io_uring reaper")))
+      {OssEroute.Emsg("AioInit", retc, "create io_uring reaper thread");
+       close(ringFD); ringFD = -1;
+       return false;
+      }
+
+// All done
+//
+   DEBUG("io_uring started; sq=" <<sqEntries <<" cq=" <<cqEntries);
+   return true;
+}
+
+/******************************************************************************/
+/*                                  R e a d                                   */
+/******************************************************************************/
+
+int XrdOssUring::Read(XrdSfsAio *aiop, int fd)
+{
+   return Queue(aiop, fd, IORING_OP_READ, isRead);
+}
+
+/******************************************************************************/
+/*                                  R e a p                                   */
+/******************************************************************************/
+
+void *XrdOssUring::Reap()
+{
+   EPNAME("UringReap");
+   struct io_uring_cqe *cqe;
+   XrdSfsAio *aiop;
+   unsigned long long udata;
+   unsigned head, tail;
+
+// We are the only consumer of the completion ring. Wait for completions and
+// invoke the completion method of each request.
+//
+   head = *cqHead;
+   do {tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+       if (head == tail)
+          {if (sysEnter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+              {OssEroute.Emsg("AioWait", errno, "wait for io_uring events");
+               sleep(1);
+              }
+           continue;
+          }
+       while(head != tail)
+            {cqe  = &cqes[head & *cqMask];
+             udata = cqe->user_data;
+             aiop  = (XrdSfsAio *)(udata & ~tagMask);
+             aiop->Result = cqe->res;
+             head++;
+             __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+             AtomicDec(inFlight);
+             DEBUG((udata & tagMask ? "write" : "read") <<" completed for "
+                   <<aiop->TIdent <<"; result=" <<aiop->Result);
+             if (udata & isWrite) aiop->doneWrite();
+                else               aiop->doneRead();
+            }
+      } while(1);
+   return (void *)0;
+}
+
+/******************************************************************************/
+/*                                 W r i t e                                  */
+/******************************************************************************/
+
+int XrdOssUring::Write(XrdSfsAio *aiop, int fd)
+{
+   return Queue(aiop, fd, IORING_OP_WRITE, isWrite);
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                 Q u e u e                                  */
+/******************************************************************************/
+
+int XrdOssUring::Queue(XrdSfsAio *aiop, int fd, int opc, int tag)
+{
+   struct io_uring_sqe *sqe;
+   unsigned idx;
+   int n;
+
+// Make sure the completion ring cannot overflow. If it could, the caller
+// will do the request synchronously.
+//
+   AtomicBeg(sqMutex);
+   AtomicFAdd(n, inFlight, 1);
+   AtomicEnd(sqMutex);
+   if (n >= cqEntries) {AtomicDec(inFlight); return 1;}
+
+// Obtain a submission entry, if one is available
+//
+   sqMutex.Lock();
+   if (sqLocal - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+      {sqMutex.UnLock();
+       AtomicDec(inFlight);
+       return 1;
+      }
+   idx = sqLocal & *sqMask;
+   sqe = &sqes[idx];
+
+// Fill out the entry
+//
+   memset(sqe, 0, sizeof(struct io_uring_sqe));
+   sqe->opcode    = opc;
+   sqe->fd        = fd;
+   if (opc != IORING_OP_FSYNC)
+      {sqe->off  = aiop->sfsAio.aio_offset;
+       sqe->addr = (unsigned long long)aiop->sfsAio.aio_buf;
+       sqe->len  = aiop->sfsAio.aio_nbytes;
+      }
+   sqe->user_data = (unsigned long long)aiop | tag;
+
+// Make the entry visible to the kernel
+//
+   sqArray[idx] = idx;
+   sqLocal++;
+   __atomic_store_n(sqTail, sqLocal, __ATOMIC_RELEASE);
+   sqPend++;
+   sqMutex.UnLock();
+
+// Submit whatever is pending (ours and possibly others)
+//
+   Submit();
+   return 0;
+}
+
+/******************************************************************************/
+/*                                S u b m i t                                 */
+/******************************************************************************/
+
+// Only one thread at a time submits entries. Others that find the submit lock
+// held simply leave their entries for the current submitter which rechecks
+// for pending entries after releasing the lock. This batches submissions
+// when many requests arrive at the same time.
+//
+void XrdOssUring::Submit()
+{
+   unsigned numPend;
+   int rc;
+
+   while(subMutex.CondLock())
+        {sqMutex.Lock(); numPend = sqPend; sqPend = 0; sqMutex.UnLock();
+         while(numPend)
+              {if ((rc = sysEnter(numPend, 0, 0)) > 0) numPend -= rc;
+                  else if (rc < 0 && errno == EINTR)
+                          continue;
+                  else {if (rc < 0)
+                           OssEroute.Emsg("AioSubmit", errno,
+                                          "submit io_uring requests");
+                        break;
+                       }
+              }
+         subMutex.UnLock();
+         sqMutex.Lock(); numPend = sqPend; sqMutex.UnLock();
+         if (!numPend) break;
+        }
+}
+#endif
@@ -0,0 +1,63 @@
+#ifndef __XRDOSSURING_HH__
+#define __XRDOSSURING_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O s s U r i n g . h h                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+// The XrdOssUring class implements the io_uring engine for asynchronous I/O.
+// It is used by XrdOssFile::Read(), Write() and Fsync() for XrdSfsAio
+// requests when "oss.aio uring" is specified and the kernel supports it.
+// Requests are placed in a single submission ring and submitted in batches;
+// a single thread reaps completions and invokes the request's done method.
+//
+class XrdSfsAio;
+
+class XrdOssUring
+{
+public:
+
+// Initialize the ring with qdepth submission entries. Returns true if the
+// engine is usable and false otherwise (the reason has been logged).
+//
+static bool  Init(int qdepth);
+
+// Queue a request. The return values are those of XrdOssFile::Read(aiop):
+// 0 -> queued, >0 -> not queued (ring full), <0 -> -errno.
+//
+static int   Fsync(XrdSfsAio *aiop, int fd);
+static int   Read (XrdSfsAio *aiop, int fd);
+static int   Write(XrdSfsAio *aiop, int fd);
+
+// Completion thread; only called by Init().
+//
+static void *Reap();
+
+private:
+
+static int   Queue(XrdSfsAio *aiop, int fd, int opc, int tag);
+static void  Submit();
+};
+#endif
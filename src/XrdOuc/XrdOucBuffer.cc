@@ -30,9 +30,11 @@
   
 #ifndef WIN32
 #include <unistd.h>
+#include <sys/mman.h>
 #endif
 #include <sys/types.h>
 #include <stdlib.h>
+#include <string.h>
 #if !defined(__APPLE__) && !defined(__FreeBSD__)
 #include <malloc.h>
 #endif
@@ -54,9 +56,10 @@ int   XrdOucBuffPool::alignit = sysconf(_SC_PAGESIZE);
 /******************************************************************************/
   
 XrdOucBuffPool::XrdOucBuffPool(int minsz, int maxsz,
-                               int minh,  int maxh, int rate)
+                               int minh,  int maxh, int rate, int slabs)
+                : slabNum(0)
 {
-   int keep, pct, i, n = 0;
+   int keep, pct, i, k, n = 0;
 
 // Adjust the minsz
 //
@@ -71,6 +74,14 @@ XrdOucBuffPool::XrdOucBuffPool(int minsz, int maxsz,
    if (maxh < minh) maxh = minh;
    if (rate < 0) rate = 0;
 
+// Establish the slab limit. The slab number must fit in the upper bits of a
+// 32-bit slab index (the lower bits being the buffer number in the slab).
+//
+   if (slabs < 0) slabs = 0;
+      else if (slabs >= (1 << (32 - slabShft))) slabs = (1 << (32-slabShft))-1;
+   slabLim = slabs;
+   slabTab = (slabLim ? new char *[slabLim]() : 0);
+
 // Round up the maxsz and make it a multiple of 4k
 //
    if (!(slots = maxsz / incBsz))  slots = 1;
@@ -93,9 +104,28 @@ XrdOucBuffPool::XrdOucBuffPool(int minsz, int maxsz,
                     else if (keep < minh) keep = minh;
                 }
         bSlot[i].maxbuff = keep;
+        bSlot[i].stride  = (bSlot[i].size < alignit ? bSlot[i].size
+                         : (bSlot[i].size + alignit - 1) / alignit * alignit);
+        k = slabSize / bSlot[i].stride;
+        bSlot[i].perSlab = (slabLim && k > 1 ? k : 0);
        }
 }
 
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+XrdOucBuffPool::~XrdOucBuffPool()
+{
+   int n = (slabNum < slabLim ? (int)slabNum : slabLim);
+
+// Release the slot vector and then all of the slabs
+//
+   delete [] bSlot;
+   for (int i = 0; i < n; i++) if (slabTab[i]) free(slabTab[i]);
+   if (slabTab) delete [] slabTab;
+}
+
 /******************************************************************************/
 /*                                 A l l o c                                  */
 /******************************************************************************/
@@ -104,14 +134,26 @@ XrdOucBuffer *XrdOucBuffPool::Alloc(int bsz)
 {
   XrdOucBuffPool::BuffSlot *sP;
   XrdOucBuffer  *bP;
+  unsigned int sidx;
   int snum;
 
 // Compute buffer slot
 //
-   snum = (bsz <= incBsz ? 0 : (bsz + rndBsz) >> shfBsz);
+   snum = (bsz <= incBsz ? 0 : ((bsz + rndBsz) >> shfBsz) - 1);
    if (snum >= slots) return 0;
    sP = &bSlot[snum];
 
+// Use a slab buffer if this size is carved out of slabs. The free list is
+// lock-free; the slot lock is only taken when a new slab must be added.
+//
+   if (sP->perSlab && ((sidx = SlabGet(sP)) || (sidx = SlabGrow(sP))))
+      {bP = new XrdOucBuffer(this, snum);
+       bP->data = SlabAddr(sP, sidx);
+       bP->sidx = sidx;
+       sP->nAlloc.fetch_add(1, std::memory_order_relaxed);
+       return bP;
+      }
+
 // Lock the data area
 //
    sP->SlotMutex.Lock();
@@ -137,8 +179,140 @@ XrdOucBuffer *XrdOucBuffPool::Alloc(int bsz)
 
 // Return the buffer
 //
+   if (bP) {sP->nAlloc.fetch_add(1, std::memory_order_relaxed);
+            sP->nHeap.fetch_add(1, std::memory_order_relaxed);
+           } else sP->nFail.fetch_add(1, std::memory_order_relaxed);
    return bP;
 }
+
+/******************************************************************************/
+/* Private:                      R e c y c l e                                */
+/******************************************************************************/
+
+void XrdOucBuffPool::Recycle(XrdOucBuffer *bP)
+{
+   BuffSlot *sP = &bSlot[bP->slot];
+
+// Slab buffers always go back on the slab free list, the buffer object is
+// simply deleted. Heap buffers are subject to the hold limits.
+//
+   sP->nRecycle.fetch_add(1, std::memory_order_relaxed);
+   if (bP->sidx)
+      {SlabPut(sP, bP->sidx, bP->sidx);
+       bP->data = 0;
+       delete bP;
+      } else sP->Recycle(bP);
+}
+
+/******************************************************************************/
+/* Private:                      S l a b G e t                                */
+/******************************************************************************/
+
+unsigned int XrdOucBuffPool::SlabGet(XrdOucBuffPool::BuffSlot *sP)
+{
+   unsigned long long hval, nval;
+   unsigned int sidx, snxt;
+
+// Pop the first free buffer. The link to the next free buffer lives in the
+// buffer itself; should the buffer be taken by someone else while we look
+// at it the tag in the upper half of the head will have changed and the
+// exchange fails. Slab memory is never returned so the load is always safe.
+//
+   hval = sP->slabFree.load(std::memory_order_acquire);
+   do {if (!(sidx = static_cast<unsigned int>(hval))) return 0;
+       snxt = __atomic_load_n((unsigned int *)SlabAddr(sP, sidx),
+                              __ATOMIC_RELAXED);
+       nval = (((hval >> 32) + 1) << 32) | snxt;
+      } while(!sP->slabFree.compare_exchange_weak(hval, nval,
+                                                  std::memory_order_acquire,
+                                                  std::memory_order_acquire));
+   return sidx;
+}
+
+/******************************************************************************/
+/* Private:                     S l a b G r o w                               */
+/******************************************************************************/
+
+unsigned int XrdOucBuffPool::SlabGrow(XrdOucBuffPool::BuffSlot *sP)
+{
+   XrdSysMutexHelper mHelp(sP->SlotMutex);
+   unsigned int sidx, sbase;
+   void *memP;
+   int snum;
+
+// Someone may have added a slab while we waited for the lock
+//
+   if ((sidx = SlabGet(sP))) return sidx;
+
+// Reserve a slab number, giving up if we ran out of slabs
+//
+   if (slabNum.load(std::memory_order_relaxed) >= slabLim
+   ||  (snum = slabNum.fetch_add(1)) >= slabLim) return 0;
+
+// Allocate the slab on a huge page boundary and ask for huge pages
+//
+   if (posix_memalign(&memP, slabSize, slabSize)) return 0;
+#ifdef MADV_HUGEPAGE
+   madvise(memP, slabSize, MADV_HUGEPAGE);
+#endif
+   slabTab[snum] = (char *)memP;
+
+// Chain all but the first buffer together and place them on the free list.
+// The first buffer is returned to the caller.
+//
+   sbase = (static_cast<unsigned int>(snum) << slabShft) + 1;
+   if (sP->perSlab > 1)
+      {for (int i = 1; i < sP->perSlab-1; i++)
+           *(unsigned int *)SlabAddr(sP, sbase+i) = sbase+i+1;
+       SlabPut(sP, sbase+1, sbase+sP->perSlab-1);
+      }
+   return sbase;
+}
+
+/******************************************************************************/
+/* Private:                      S l a b P u t                                */
+/******************************************************************************/
+
+void XrdOucBuffPool::SlabPut(XrdOucBuffPool::BuffSlot *sP,
+                             unsigned int sfirst, unsigned int slast)
+{
+   unsigned long long hval, nval;
+
+// Push the chain that runs from sfirst to slast onto the free list
+//
+   hval = sP->slabFree.load(std::memory_order_relaxed);
+   do {__atomic_store_n((unsigned int *)SlabAddr(sP, slast),
+                        static_cast<unsigned int>(hval), __ATOMIC_RELAXED);
+       nval = (((hval >> 32) + 1) << 32) | sfirst;
+      } while(!sP->slabFree.compare_exchange_weak(hval, nval,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+}
+
+/******************************************************************************/
+/*                            S t a t i s t i c s                             */
+/******************************************************************************/
+
+void XrdOucBuffPool::Statistics(XrdOucBuffPool::BuffStats &stats)
+{
+   int n = (slabNum < slabLim ? (int)slabNum : slabLim);
+
+// Sum up the per-slot counters
+//
+   memset(&stats, 0, sizeof(stats));
+   for (int i = 0; i < slots; i++)
+       {stats.numAlloc   += bSlot[i].nAlloc.load(std::memory_order_relaxed);
+        stats.numFail    += bSlot[i].nFail.load(std::memory_order_relaxed);
+        stats.numHeap    += bSlot[i].nHeap.load(std::memory_order_relaxed);
+        stats.numRecycle += bSlot[i].nRecycle.load(std::memory_order_relaxed);
+       }
+
+// Count the slabs actually allocated
+//
+   for (int i = 0; i < n; i++) if (slabTab[i]) stats.slabs++;
+   stats.slabBytes = static_cast<long long>(stats.slabs) * slabSize;
+   stats.slabMax   = slabLim;
+}
   
 /******************************************************************************/
 /*      X r d O u c B u f f P o o l : : B u f f S l o t   M e t h o d s       */
@@ -186,7 +360,7 @@ void XrdOucBuffPool::BuffSlot::Recycle(XrdOucBuffer *bP)
   
 XrdOucBuffer::XrdOucBuffer(char *buff, int blen)
 {
-   static XrdOucBuffPool nullPool(0, 0, 0, 0, 0);
+   static XrdOucBuffPool nullPool(0, 0, 0, 0, 0, 0);
 
 // Initialize the one time buffer
 //
@@ -195,6 +369,7 @@ XrdOucBuffer::XrdOucBuffer(char *buff, int blen)
    doff = 0;
    size = blen;
    slot = 0;
+   sidx = 0;
    buffPool = &nullPool;
 };
 
@@ -30,6 +30,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <atomic>
 #include <stdlib.h>
 
 #include "XrdOuc/XrdOucChain.hh"
@@ -76,6 +77,24 @@ public:
 
 inline int          MaxSize() const {return maxBsz;}
 
+//-----------------------------------------------------------------------------
+//! Obtain buffer pool statistics.
+//!
+//! @param  stats - reference to the structure that is to receive the counts.
+//-----------------------------------------------------------------------------
+
+struct BuffStats
+      {long long numAlloc;    //!< Buffers handed out by Alloc()
+       long long numFail;     //!< Alloc() calls that could not be satisfied
+       long long numHeap;     //!< Buffers allocated outside of a slab
+       long long numRecycle;  //!< Buffers recycled
+       long long slabBytes;   //!< Bytes of memory held in slabs
+       int       slabs;       //!< Number of slabs allocated
+       int       slabMax;     //!< Maximum number of slabs allowed
+      };
+
+       void          Statistics(BuffStats &stats);
+
 //-----------------------------------------------------------------------------
 //! Constructor
 //!
@@ -95,37 +114,69 @@ inline int          MaxSize() const {return maxBsz;}
 //! @param  rate  - specifies how quickly the hold vale is to be reduced as
 //!                 buffer sizes increase. A rate of 0 specifies a purely linear
 //!                 decrease. Higher values logrithmically decrease the hold.
+//! @param  slabs - the maximum number of 2MB slabs (huge pages where
+//!                 available) that may be used to carve out buffers of up to
+//!                 1MB. Slab buffers are kept on lock-free free lists and the
+//!                 memory is held until the pool is destroyed; the minh, maxh
+//!                 and rate values only apply to buffers allocated from the
+//!                 heap once the slabs are exhausted or for larger sizes.
+//!                 A value of zero disables the use of slabs.
 //-----------------------------------------------------------------------------
 
        XrdOucBuffPool(int minsz=4096, int  maxsz=65536,
                       int minh=1,     int  maxh=16,
-                      int rate=1);
+                      int rate=1,     int  slabs=64);
 
 //-----------------------------------------------------------------------------
 //! Destructor - You must not destroy this object prior to recycling all
 //!              oustanding buffers allocated out of this pool.
 //-----------------------------------------------------------------------------
 
-      ~XrdOucBuffPool() {delete [] bSlot;}
+      ~XrdOucBuffPool();
 
 private:
 static int            alignit;
+static const int      slabSize = 2*1024*1024;
+static const int      slabShft = 16;
 
 struct BuffSlot
-      {XrdSysMutex    SlotMutex;
+      {std::atomic<unsigned long long> slabFree; // tag<<32 | index+1
+       std::atomic<long long>          nAlloc;
+       std::atomic<long long>          nFail;
+       std::atomic<long long>          nHeap;
+       std::atomic<long long>          nRecycle;
+       XrdSysMutex    SlotMutex;
        XrdOucBuffer  *buffFree;
        int            size;
+       int            stride;
+       short          perSlab;
        short          numbuff;
        short          maxbuff;
 
        void           Recycle(XrdOucBuffer *bP);
 
-                      BuffSlot() : buffFree(0), size(0),
+                      BuffSlot() : slabFree(0), nAlloc(0), nFail(0), nHeap(0),
+                                   nRecycle(0), buffFree(0), size(0),
+                                   stride(0),   perSlab(0),
                                    numbuff(0),  maxbuff(0) {}
                      ~BuffSlot();
       };
 
+inline char     *SlabAddr(BuffSlot *sP, unsigned int sidx)
+                         {sidx--;
+                          return slabTab[sidx >> slabShft]
+                               + (sidx & ((1 << slabShft) - 1)) * sP->stride;
+                         }
+unsigned int     SlabGet(BuffSlot *sP);
+unsigned int     SlabGrow(BuffSlot *sP);
+void             SlabPut(BuffSlot *sP, unsigned int sfirst,
+                         unsigned int slast);
+void             Recycle(XrdOucBuffer *bP);
+
 BuffSlot *bSlot;
+char    **slabTab;
+std::atomic<int> slabNum;
+int       slabLim;
 int       incBsz;
 int       shfBsz;
 int       rndBsz;
@@ -217,7 +268,7 @@ inline int           DataLen() {return dlen;}
 //! Recycle the buffer. The buffer may be reused in the future.
 //-----------------------------------------------------------------------------
 
-inline void         Recycle()  {buffPool->bSlot[slot].Recycle(this);}
+inline void         Recycle()  {buffPool->Recycle(this);}
 
 //-----------------------------------------------------------------------------
 //! Resize the buffer.
@@ -259,18 +310,20 @@ inline void         SetLen(int dataL, int dataO=0) {dlen = dataL; doff = dataO;}
 private:
       XrdOucBuffer(XrdOucBuffPool *pP, int snum)
                   : data(0), dlen(0), doff(0), size(pP->bSlot[snum].size),
-                    slot(snum), buffPool(pP) {}
+                    slot(snum), sidx(0), buffPool(pP) {}
 
       XrdOucBuffer()
-                  : data(0), dlen(0), doff(0), size(0), slot(0), buffPool(0) {}
+                  : data(0), dlen(0), doff(0), size(0), slot(0), sidx(0),
+                    buffPool(0) {}
 
-     ~XrdOucBuffer() {if (data) free(data);}
+     ~XrdOucBuffer() {if (data && !sidx) free(data);}
 
       char           *data;
       int             dlen;
       int             doff;
       int             size;
       int             slot;
+      unsigned int    sidx;   // Slab index+1 when data is in a slab
 union{XrdOucBuffer   *buffNext;
       XrdOucBuffPool *buffPool;
      };
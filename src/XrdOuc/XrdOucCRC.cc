@@ -44,6 +44,8 @@
    Status:
       Public Domain
 */
+#include <string.h>
+
 #include "XrdOucCRC.hh"
 
 /*****************************************************************/
@@ -138,6 +140,282 @@ unsigned int XrdOucCRC::crctable[256] =
 /*                   End of CRC Lookup Table                     */
 /*****************************************************************/
 
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define XRDOUC_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+typedef unsigned int (*Crc32Sum_t)(const unsigned int *, unsigned int,
+                                   const unsigned char *, int);
+
+// Slicing-by-8 tables for the reflected polynomial, SliceTab[0] is the class
+// lookup table and entry k gives the CRC of a byte followed by k zero bytes.
+//
+unsigned int SliceTab[8][256];
+
+/******************************************************************************/
+/*                              C r c S l i c e                               */
+/******************************************************************************/
+
+unsigned int CrcSlice(const unsigned int *tab, unsigned int crc,
+                      const unsigned char *p, int reclen)
+{
+   while(reclen >= 8)
+        {unsigned int one = crc ^ ((unsigned int)p[0]
+                                 | (unsigned int)p[1] <<  8
+                                 | (unsigned int)p[2] << 16
+                                 | (unsigned int)p[3] << 24);
+         crc = SliceTab[7][one & 0xff]         ^ SliceTab[6][(one >> 8) & 0xff]
+             ^ SliceTab[5][(one >> 16) & 0xff] ^ SliceTab[4][one >> 24]
+             ^ SliceTab[3][p[4]]               ^ SliceTab[2][p[5]]
+             ^ SliceTab[1][p[6]]               ^ SliceTab[0][p[7]];
+         p += 8; reclen -= 8;
+        }
+   while(reclen-- > 0) crc = tab[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+   return crc;
+}
+
+#ifdef XRDOUC_X86_SIMD
+/******************************************************************************/
+/*                              C r c P C L M U L                             */
+/******************************************************************************/
+
+// Folding with carry-less multiplication as described in Intel's "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction". The
+// constants are the bit reflected x^n mod P values for the CRC-32 polynomial
+// followed by a Barrett reduction to 32 bits.
+//
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i CrcFold(__m128i x, __m128i k, __m128i next)
+{
+   return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                      _mm_clmulepi64_si128(x, k, 0x11)),
+                        next);
+}
+
+__attribute__((target("pclmul,sse4.1")))
+unsigned int CrcPCLMUL(const unsigned int *tab, unsigned int crc,
+                       const unsigned char *p, int reclen)
+{
+   if (reclen < 64) return CrcSlice(tab, crc, p, reclen);
+
+   const __m128i k2k1  = _mm_set_epi64x(0x1c6e41596LL, 0x154442bd4LL);
+   const __m128i k4k3  = _mm_set_epi64x(0x0ccaa009eLL, 0x1751997d0LL);
+   const __m128i k5    = _mm_set_epi64x(0,             0x163cd6124LL);
+   const __m128i poly  = _mm_set_epi64x(0x1f7011641LL, 0x1db710641LL);
+   const __m128i mask  = _mm_setr_epi32(-1, 0, 0, 0);
+   const __m128i *q = (const __m128i *)p;
+   __m128i x1, x2, x3, x4, t;
+
+   x1 = _mm_xor_si128(_mm_loadu_si128(q+0), _mm_cvtsi32_si128(crc));
+   x2 = _mm_loadu_si128(q+1);
+   x3 = _mm_loadu_si128(q+2);
+   x4 = _mm_loadu_si128(q+3);
+   q += 4; reclen -= 64;
+
+// Fold 64 bytes at a time
+//
+   while(reclen >= 64)
+        {x1 = CrcFold(x1, k2k1, _mm_loadu_si128(q+0));
+         x2 = CrcFold(x2, k2k1, _mm_loadu_si128(q+1));
+         x3 = CrcFold(x3, k2k1, _mm_loadu_si128(q+2));
+         x4 = CrcFold(x4, k2k1, _mm_loadu_si128(q+3));
+         q += 4; reclen -= 64;
+        }
+
+// Fold the four accumulators into one and then 16 bytes at a time
+//
+   x1 = CrcFold(x1, k4k3, x2);
+   x1 = CrcFold(x1, k4k3, x3);
+   x1 = CrcFold(x1, k4k3, x4);
+   while(reclen >= 16)
+        {x1 = CrcFold(x1, k4k3, _mm_loadu_si128(q));
+         q++; reclen -= 16;
+        }
+
+// Fold 128 bits to 64 bits and then to 32 bits
+//
+   t  = _mm_clmulepi64_si128(k4k3, x1, 0x01);
+   x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), t);
+   t  = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k5, 0x00);
+   x1 = _mm_xor_si128(_mm_srli_si128(x1, 4), t);
+
+// Barrett reduction to the final 32 bit value
+//
+   t  = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), poly, 0x10);
+   t  = _mm_clmulepi64_si128(_mm_and_si128(t, mask), poly, 0x00);
+   crc = (unsigned int)_mm_extract_epi32(_mm_xor_si128(x1, t), 1);
+
+   return CrcSlice(tab, crc, (const unsigned char *)q, reclen);
+}
+#endif
+
+/******************************************************************************/
+/*                              C r c P i c k                                 */
+/******************************************************************************/
+
+unsigned int CrcPick(const unsigned int *, unsigned int,
+                     const unsigned char *, int);
+
+Crc32Sum_t Crc32Sum = CrcPick;
+
+// The first call builds the tables and selects the kernel for the processor
+// we are running on. A racing first call recomputes identical values.
+//
+unsigned int CrcPick(const unsigned int *tab, unsigned int crc,
+                     const unsigned char *p, int reclen)
+{
+   Crc32Sum_t theSum = CrcSlice;
+
+   for (int i = 0; i < 256; i++)
+       {unsigned int v = SliceTab[0][i] = tab[i];
+        for (int k = 1; k < 8; k++)
+            SliceTab[k][i] = v = (v >> 8) ^ tab[v & 0xff];
+       }
+
+#ifdef XRDOUC_X86_SIMD
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+      theSum = CrcPCLMUL;
+#endif
+
+   Crc32Sum = theSum;
+   return theSum(tab, crc, p, reclen);
+}
+
+/******************************************************************************/
+/*                             C R C 3 2 C                                    */
+/******************************************************************************/
+
+// The CRC32C functions work on the internal (pre and post inverted) value.
+// The page function computes the checksum of n consecutive full pages.
+//
+typedef uint32_t (*Crc32CSum_t)(uint32_t, const unsigned char *, size_t);
+typedef void     (*Crc32CPgs_t)(const unsigned char *, int, uint32_t *);
+
+// Slicing-by-8 tables for the reflected Castagnoli polynomial
+//
+uint32_t Tab32C[8][256];
+
+uint32_t Crc32CSlice(uint32_t crc, const unsigned char *p, size_t n)
+{
+   while(n >= 8)
+        {uint32_t one = crc ^ ((uint32_t)p[0]       | (uint32_t)p[1] <<  8
+                             | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+         crc = Tab32C[7][one & 0xff]         ^ Tab32C[6][(one >> 8) & 0xff]
+             ^ Tab32C[5][(one >> 16) & 0xff] ^ Tab32C[4][one >> 24]
+             ^ Tab32C[3][p[4]]               ^ Tab32C[2][p[5]]
+             ^ Tab32C[1][p[6]]               ^ Tab32C[0][p[7]];
+         p += 8; n -= 8;
+        }
+   while(n--) crc = Tab32C[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+   return crc;
+}
+
+void Crc32CSlicePgs(const unsigned char *p, int n, uint32_t *csval)
+{
+   for (int i = 0; i < n; i++, p += XrdOucCRC::PageSize)
+       csval[i] = ~Crc32CSlice(0xffffffff, p, XrdOucCRC::PageSize);
+}
+
+#if defined(XRDOUC_X86_SIMD)
+// The crc32 instruction has a latency of three cycles but a throughput of one
+// per cycle, so pages are checksummed three at a time.
+//
+__attribute__((target("sse4.2")))
+uint32_t Crc32CHW(uint32_t crc, const unsigned char *p, size_t n)
+{
+   while(n && ((uintptr_t)p & 7)) {crc = _mm_crc32_u8(crc, *p++); n--;}
+#if defined(__x86_64__)
+   uint64_t crc64 = crc, v;
+   while(n >= 8)
+        {memcpy(&v, p, 8); crc64 = _mm_crc32_u64(crc64, v); p += 8; n -= 8;}
+   crc = static_cast<uint32_t>(crc64);
+#else
+   uint32_t v;
+   while(n >= 4)
+        {memcpy(&v, p, 4); crc = _mm_crc32_u32(crc, v); p += 4; n -= 4;}
+#endif
+   while(n--) crc = _mm_crc32_u8(crc, *p++);
+   return crc;
+}
+
+__attribute__((target("sse4.2")))
+void Crc32CHWPgs(const unsigned char *p, int n, uint32_t *csval)
+{
+   const int pgsz = XrdOucCRC::PageSize;
+
+#if defined(__x86_64__)
+   while(n >= 3)
+        {uint64_t c0 = 0xffffffff, c1 = 0xffffffff, c2 = 0xffffffff, v;
+         for (int k = 0; k < pgsz; k += 8)
+             {memcpy(&v, p+k,        8); c0 = _mm_crc32_u64(c0, v);
+              memcpy(&v, p+k+pgsz,   8); c1 = _mm_crc32_u64(c1, v);
+              memcpy(&v, p+k+pgsz*2, 8); c2 = _mm_crc32_u64(c2, v);
+             }
+         csval[0] = ~static_cast<uint32_t>(c0);
+         csval[1] = ~static_cast<uint32_t>(c1);
+         csval[2] = ~static_cast<uint32_t>(c2);
+         p += pgsz*3; csval += 3; n -= 3;
+        }
+#endif
+   while(n-- > 0) {*csval++ = ~Crc32CHW(0xffffffff, p, pgsz); p += pgsz;}
+}
+#endif
+
+uint32_t Crc32CPick(uint32_t, const unsigned char *, size_t);
+void     Crc32CPickPgs(const unsigned char *, int, uint32_t *);
+
+Crc32CSum_t Crc32CSum = Crc32CPick;
+Crc32CPgs_t Crc32CPgs = Crc32CPickPgs;
+
+// The first call builds the tables and selects the kernels. As for CRC32, a
+// racing first call simply recomputes identical values.
+//
+void Crc32CInit()
+{
+   Crc32CSum_t theSum = Crc32CSlice;
+   Crc32CPgs_t thePgs = Crc32CSlicePgs;
+
+   for (int i = 0; i < 256; i++)
+       {uint32_t v = i;
+        for (int k = 0; k < 8; k++) v = (v >> 1) ^ (0x82F63B78 & (0 - (v & 1)));
+        Tab32C[0][i] = v;
+       }
+   for (int i = 0; i < 256; i++)
+       {uint32_t v = Tab32C[0][i];
+        for (int k = 1; k < 8; k++)
+            Tab32C[k][i] = v = (v >> 8) ^ Tab32C[0][v & 0xff];
+       }
+
+#ifdef XRDOUC_X86_SIMD
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("sse4.2")) {theSum = Crc32CHW; thePgs = Crc32CHWPgs;}
+#endif
+
+   Crc32CSum = theSum;
+   Crc32CPgs = thePgs;
+}
+
+uint32_t Crc32CPick(uint32_t crc, const unsigned char *p, size_t n)
+{
+   Crc32CInit();
+   return Crc32CSum(crc, p, n);
+}
+
+void Crc32CPickPgs(const unsigned char *p, int n, uint32_t *csval)
+{
+   Crc32CInit();
+   Crc32CPgs(p, n, csval);
+}
+}
+
 /* Calculate CRC-32 Checksum for NAACCR Record,
    skipping area of record containing checksum field.
 
@@ -161,6 +439,7 @@ unsigned int XrdOucCRC::crctable[256] =
      Compute CRC for complete buffer
      Use unsigned int instead of long to insure 32 bit values.
      Make this a C++ class.
+     Process eight bytes at a time or fold with carry-less multiplication.
 */
 unsigned int XrdOucCRC::CRC32(const unsigned char *p, int reclen)
 {
@@ -168,11 +447,79 @@ unsigned int XrdOucCRC::CRC32(const unsigned char *p, int reclen)
    const unsigned int CRC32_XOROT = 0xffffffff;
    unsigned int crc = CRC32_XINIT;
 
-// Process each byte
+// Process the buffer
 //
-   while(reclen-- > 0) crc = crctable[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+   crc = Crc32Sum(crctable, crc, p, reclen);
 
 // Return XOR out value
 //
    return crc ^ CRC32_XOROT;
 }
+
+/******************************************************************************/
+/*                               C a l c 3 2 C                                */
+/******************************************************************************/
+
+uint32_t XrdOucCRC::Calc32C(const void *data, size_t count, uint32_t prevcs)
+{
+   return ~Crc32CSum(~prevcs, (const unsigned char *)data, count);
+}
+
+/******************************************************************************/
+
+int XrdOucCRC::Calc32C(const void *data, size_t count, long long offset,
+                       uint32_t *csval)
+{
+   const unsigned char *p = (const unsigned char *)data;
+   int n, pgnum = 0, pgoff = static_cast<int>(offset & (PageSize-1));
+
+// Handle a leading partial page
+//
+   if (pgoff && count)
+      {n = PageSize - pgoff;
+       if ((size_t)n > count) n = count;
+       csval[pgnum++] = Calc32C(p, n);
+       p += n; count -= n;
+      }
+
+// Handle all of the full pages and then a trailing partial page
+//
+   if ((n = count >> PageBits))
+      {Crc32CPgs(p, n, csval+pgnum);
+       pgnum += n; p += (size_t)n << PageBits; count &= (PageSize-1);
+      }
+   if (count) csval[pgnum++] = Calc32C(p, count);
+   return pgnum;
+}
+
+/******************************************************************************/
+/*                                V e r 3 2 C                                 */
+/******************************************************************************/
+
+int XrdOucCRC::Ver32C(const void *data, size_t count, long long offset,
+                      const uint32_t *csval, uint32_t &valcs)
+{
+   const unsigned char *p = (const unsigned char *)data;
+   uint32_t pgcs[64];
+   int n, pgnum = 0, pgoff = static_cast<int>(offset & (PageSize-1));
+
+// Verify a leading partial page
+//
+   if (pgoff && count)
+      {n = PageSize - pgoff;
+       if ((size_t)n > count) n = count;
+       if ((valcs = Calc32C(p, n)) != csval[0]) return 0;
+       pgnum++; p += n; count -= n; offset += n;
+      }
+
+// Verify the remaining pages in batches so that full pages are done together
+//
+   while(count)
+        {n = (count > (size_t)64*PageSize ? 64*PageSize : count);
+         int k = Calc32C(p, n, offset, pgcs);
+         for (int i = 0; i < k; i++)
+             if (pgcs[i] != csval[pgnum+i]) {valcs = pgcs[i]; return pgnum+i;}
+         pgnum += k; p += n; count -= n; offset += n;
+        }
+   return -1;
+}
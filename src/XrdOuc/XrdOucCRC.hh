@@ -30,12 +30,77 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <stddef.h>
+#include <stdint.h>
+
 class XrdOucCRC
 {
 public:
 
 static unsigned int CRC32(const unsigned char *rec, int reclen);
 
+//-----------------------------------------------------------------------------
+//! Compute a CRC32C (Castagnoli polynomial) checksum.
+//!
+//! @param  data   - pointer to the data.
+//! @param  count  - number of bytes to checksum.
+//! @param  prevcs - the checksum of the preceding data when computing the
+//!                  value piecewise, zero otherwise.
+//!
+//! @return The CRC32C checksum.
+//-----------------------------------------------------------------------------
+
+static uint32_t     Calc32C(const void *data, size_t count, uint32_t prevcs=0);
+
+//-----------------------------------------------------------------------------
+//! Compute a CRC32C checksum for each page of data. Pages are aligned on file
+//! offsets so the first and last page may be short.
+//!
+//! @param  data   - pointer to the data.
+//! @param  count  - number of bytes to checksum.
+//! @param  offset - the file offset corresponding to data.
+//! @param  csval  - pointer to a vector large enough to hold PgCount() values.
+//!
+//! @return The number of checksums placed in csval.
+//-----------------------------------------------------------------------------
+
+static int          Calc32C(const void *data, size_t count, long long offset,
+                            uint32_t *csval);
+
+//-----------------------------------------------------------------------------
+//! Verify the CRC32C checksum of each page of data (see above).
+//!
+//! @param  data   - pointer to the data.
+//! @param  count  - number of bytes to verify.
+//! @param  offset - the file offset corresponding to data.
+//! @param  csval  - pointer to the expected checksums, one per page.
+//! @param  valcs  - receives the computed checksum of the first bad page.
+//!
+//! @return -1 when all checksums match, otherwise the index of the first page
+//!         whose checksum does not match.
+//-----------------------------------------------------------------------------
+
+static int          Ver32C(const void *data, size_t count, long long offset,
+                           const uint32_t *csval, uint32_t &valcs);
+
+//-----------------------------------------------------------------------------
+//! Compute the number of pages spanned by a byte range.
+//!
+//! @param  offset - the starting file offset.
+//! @param  count  - number of bytes.
+//!
+//! @return The number of pages.
+//-----------------------------------------------------------------------------
+
+static int          PgCount(long long offset, size_t count)
+                           {if (!count) return 0;
+                            return static_cast<int>(((offset + count - 1)
+                                   >> PageBits) - (offset >> PageBits) + 1);
+                           }
+
+static const int    PageBits = 12;
+static const int    PageSize = 1 << PageBits;
+
                     XrdOucCRC() {}
                    ~XrdOucCRC() {}
 
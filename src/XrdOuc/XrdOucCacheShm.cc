@@ -0,0 +1,649 @@
+/******************************************************************************/
+/*                                                                            */
+/*                     X r d O u c C a c h e S h m . c c                      */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "XrdOuc/XrdOucCacheShm.hh"
+#include "XrdSys/XrdSysHeaders.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+/******************************************************************************/
+/*                         L o c a l   D e f i n e s                          */
+/******************************************************************************/
+
+namespace
+{
+const uint32_t shmMagic   = 0x58534843; // "XSHC"
+const uint32_t shmVersion = 1;
+const int      shmStale   = 30;         // Seconds a page may stay locked
+const long long hugeAlign = 2*1024*1024;
+
+// Stamp used to order the pages of a set, 16ms resolution is plenty
+//
+inline uint32_t Stamp()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint32_t)(ts.tv_sec*64 + (ts.tv_nsec >> 24));
+}
+}
+
+/******************************************************************************/
+/*                    S h a r e d   S e g m e n t   L a y o u t               */
+/******************************************************************************/
+
+// The segment starts with a header followed by the slot table and the pages.
+// Everything in it must be position independent as each process maps it at a
+// different address.
+//
+struct XrdOucCacheShm::Header
+{
+std::atomic<uint32_t>  Magic;     // Set last when the segment is formatted
+uint32_t               Version;
+int32_t                PageSize;
+int32_t                Ways;
+uint64_t               SetNum;
+int64_t                DataOff;
+int64_t                MapSize;
+std::atomic<long long> Hits;
+std::atomic<long long> Miss;
+std::atomic<long long> Evict;
+std::atomic<long long> Store;
+std::atomic<long long> Inval;
+};
+
+struct XrdOucCacheShm::Slot
+{
+std::atomic<uint64_t>  Key;       // File key, 0 if the slot is empty
+std::atomic<long long> Page;      // Page number within the file
+std::atomic<uint32_t>  Seq;       // Odd while the slot is being replaced
+std::atomic<uint32_t>  Used;      // Stamp of the last reference
+std::atomic<uint32_t>  Len;       // Valid bytes in the page
+std::atomic<uint32_t>  LockT;     // Time the slot was locked
+};
+
+/******************************************************************************/
+/*                   C l a s s   X r d O u c C a c h e S h m I O              */
+/******************************************************************************/
+
+class XrdOucCacheShmIO : public XrdOucCacheIO
+{
+public:
+
+long long   FSize() {return ioObj->FSize();}
+
+const char *Path()  {return ioObj->Path();}
+
+int         Read (char *Buffer, long long Offset, int Length);
+
+int         Sync() {return ioObj->Sync();}
+
+int         Trunc(long long Offset);
+
+int         Write(char *Buffer, long long Offset, int Length);
+
+XrdOucCacheIO *Base()   {return ioObj;}
+
+XrdOucCacheIO *Detach();
+
+bool        ioActive() {return ioObj->ioActive();}
+
+            XrdOucCacheShmIO(XrdOucCacheShm *cP, XrdOucCacheIO *ioP, int opts);
+
+private:
+           ~XrdOucCacheShmIO() {}
+
+void        Drop(long long Offset, long long Length);
+int         Pass(char *Buffer, long long Offset, int Length);
+
+XrdOucCacheShm *Cache;
+XrdOucCacheIO  *ioObj;
+uint64_t        fKey;
+bool            isADB;
+bool            isRW;
+};
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdOucCacheShmIO::XrdOucCacheShmIO(XrdOucCacheShm *cP, XrdOucCacheIO *ioP,
+                                   int opts)
+                 : Cache(cP), ioObj(ioP), fKey(0),
+                   isADB((opts & XrdOucCache::optADB) != 0),
+                   isRW((opts & XrdOucCache::optRW) != 0)
+{
+   const char *path = ioP->Path();
+   long long fsz = ioP->FSize();
+   uint64_t hval = 0xcbf29ce484222325ULL;
+
+// The key is a hash of the path and the size of the file, so that every
+// process opening the same file uses the same key. Files of unknown size are
+// not cached at all.
+//
+   if (fsz < 0 || !path) return;
+   while(*path) {hval ^= (unsigned char)*path++; hval *= 0x100000001b3ULL;}
+   hval ^= (uint64_t)fsz;
+   hval *= 0x9e3779b97f4a7c15ULL;
+   fKey = (hval ? hval : 1);
+}
+
+/******************************************************************************/
+/*                                D e t a c h                                 */
+/******************************************************************************/
+
+XrdOucCacheIO *XrdOucCacheShmIO::Detach()
+{
+   XrdOucCacheIO *ioP = ioObj;
+   bool delIO = isADB;
+
+// Add our statistics to the cache and report them if so wanted
+//
+   Cache->Stats.Add(Statistics);
+   if (Cache->Lgs)
+      {char sBuff[4096];
+       snprintf(sBuff, sizeof(sBuff),
+                      "Cache: Stats: %lld Read; %lld Get; %lld Pass; "
+                      "%lld Write; %d Hits; %d Miss; Path %s\n",
+                      Statistics.BytesRead, Statistics.BytesGet,
+                      Statistics.BytesPass, Statistics.BytesWrite,
+                      Statistics.Hits,      Statistics.Miss,
+                      ioP->Path());
+       cerr <<sBuff;
+      }
+
+// Remove ourselves and return the underlying object unless we own it
+//
+   Cache->Attached--;
+   delete this;
+   if (delIO) {delete ioP; return 0;}
+   return ioP;
+}
+
+/******************************************************************************/
+/*                                  R e a d                                   */
+/******************************************************************************/
+
+int XrdOucCacheShmIO::Read(char *Buffer, long long Offset, int Length)
+{
+   const int pSize = Cache->pageSize;
+   long long page = Offset >> Cache->pageShft;
+   char *pBuff = 0, *pgP, *dst;
+   int pOff = (int)(Offset & (pSize-1)), done = 0, want, got, rc = 0;
+   bool whole;
+   int Hits = 0, Miss = 0;
+   long long bGet = 0, bRead = 0;
+
+// Reads of files we may be writing and large reads go straight through
+//
+   if (!fKey || isRW || Length > Cache->maxCache || Offset < 0)
+      return Pass(Buffer, Offset, Length);
+
+// Run through all the pages covered by the request. A page found in the cache
+// is copied directly into the caller's buffer. A missing page is read as a
+// whole, into the caller's buffer if it covers the page and into a scratch
+// page otherwise, and then placed in the cache.
+//
+   while(done < Length)
+        {want = pSize - pOff;
+         if (want > Length - done) want = Length - done;
+         dst = Buffer + done;
+
+         if (Cache->Fetch(fKey, page, dst, pOff, want, got))
+            {Hits++; bGet += got;
+            } else {
+             Miss++;
+             whole = (!pOff && want == pSize);
+             if (whole) pgP = dst;
+                else {if (!pBuff && !(pBuff = (char *)malloc(pSize)))
+                         {rc = -ENOMEM; break;}
+                      pgP = pBuff;
+                     }
+             if ((rc = ioObj->Read(pgP, page*pSize, pSize)) < 0) break;
+             bRead += rc;
+             if (rc > 0) Cache->Store(fKey, page, pgP, rc);
+             got = rc - pOff;
+             if (got > want) got = want;
+             if (got < 0) got = 0;
+             if (!whole && got) memcpy(dst, pBuff+pOff, got);
+            }
+
+         done += got;
+         if (got < want) {rc = 0; break;}
+         pOff = 0; page++; rc = 0;
+        }
+
+// Update the statistics and return
+//
+   if (pBuff) free(pBuff);
+   Statistics.Lock();
+   Statistics.Hits += Hits; Statistics.Miss += Miss;
+   Statistics.BytesGet += bGet; Statistics.BytesRead += bRead;
+   Statistics.UnLock();
+   return (rc < 0 && !done ? rc : done);
+}
+
+/******************************************************************************/
+/*                                 T r u n c                                  */
+/******************************************************************************/
+
+int XrdOucCacheShmIO::Trunc(long long Offset)
+{
+   long long fsz = ioObj->FSize();
+   int rc = ioObj->Trunc(Offset);
+
+   if (fKey && fsz > Offset) Drop(Offset, fsz - Offset);
+   return rc;
+}
+
+/******************************************************************************/
+/*                                 W r i t e                                  */
+/******************************************************************************/
+
+int XrdOucCacheShmIO::Write(char *Buffer, long long Offset, int Length)
+{
+   int rc = ioObj->Write(Buffer, Offset, Length);
+
+   if (fKey && Length > 0) Drop(Offset, Length);
+   if (rc > 0)
+      {Statistics.Lock(); Statistics.BytesWrite += rc; Statistics.UnLock();}
+   return rc;
+}
+
+/******************************************************************************/
+/*                                  D r o p                                   */
+/******************************************************************************/
+
+void XrdOucCacheShmIO::Drop(long long Offset, long long Length)
+{
+   long long page = Offset >> Cache->pageShft;
+   long long last = (Offset + Length - 1) >> Cache->pageShft;
+
+   while(page <= last) Cache->Drop(fKey, page++);
+}
+
+/******************************************************************************/
+/*                                  P a s s                                   */
+/******************************************************************************/
+
+int XrdOucCacheShmIO::Pass(char *Buffer, long long Offset, int Length)
+{
+   int rc = ioObj->Read(Buffer, Offset, Length);
+
+   if (rc > 0)
+      {Statistics.Lock(); Statistics.BytesPass += rc; Statistics.UnLock();}
+   return rc;
+}
+
+/******************************************************************************/
+/*                 C l a s s   X r d O u c C a c h e S h m                    */
+/******************************************************************************/
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdOucCacheShm::XrdOucCacheShm(int &rc, XrdOucCache::Parms &ParmV,
+                               const char *name)
+              : shmName(strdup(name)), Base((char *)MAP_FAILED), Hdr(0), Slots(0), mapSize(0),
+                dataOff(0), setNum(0), pageSize(0), pageShft(0), maxCache(0),
+                Dbg(0), Lgs(0), Attached(0)
+{
+   struct stat Stat;
+   char shmName[1024];
+   const char *fn;
+   bool isFile = (strchr(name+1, '/') != 0);
+   int fd, i, oflags = O_RDWR|O_CREAT|O_EXCL;
+   bool isNew = true;
+
+// Copy over options
+//
+   if (ParmV.Options & Debug)    Lgs = Dbg = (ParmV.Options & Debug);
+   if (ParmV.Options & logStats) Lgs = 1;
+
+// Open the segment, creating it if need be. The creator formats it.
+//
+   if (isFile) {fn = name; fd = open(fn, oflags, 0660);}
+      else {snprintf(shmName, sizeof(shmName), "%s%s",
+                     (*name == '/' ? "" : "/"), name);
+            fn = shmName; fd = shm_open(fn, oflags, 0660);
+           }
+   if (fd < 0 && errno == EEXIST)
+      {isNew = false;
+       oflags = O_RDWR;
+       fd = (isFile ? open(fn, oflags) : shm_open(fn, oflags, 0));
+      }
+   if (fd < 0) {rc = errno; return;}
+
+// If we created the segment, size it according to our parameters. Otherwise
+// wait for whoever created it to finish doing so and use its geometry.
+//
+   if (isNew)
+      {if (!Format(ParmV) || ftruncate(fd, mapSize))
+          {rc = errno ? errno : EINVAL; close(fd);
+           if (isFile) unlink(fn); else shm_unlink(fn);
+           return;
+          }
+      } else {
+       for (i = 0; i < 100; i++)
+           {if (fstat(fd, &Stat)) {rc = errno; close(fd); return;}
+            if (Stat.st_size >= (off_t)sizeof(Header)) break;
+            XrdSysTimer::Wait(50);
+           }
+       if (i >= 100) {rc = ETIMEDOUT; close(fd); return;}
+       mapSize = Stat.st_size;
+      }
+
+// Map the segment
+//
+   Base = (char *)mmap(0, mapSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+   rc = errno;
+   close(fd);
+   if (Base == MAP_FAILED)
+      {if (isNew) {if (isFile) unlink(fn); else shm_unlink(fn);}
+       return;
+      }
+   Hdr = (Header *)Base;
+
+// Publish the geometry when we are the creator
+//
+   if (isNew)
+      {Hdr->Version  = shmVersion;
+       Hdr->PageSize = pageSize;
+       Hdr->Ways     = setWays;
+       Hdr->SetNum   = setNum;
+       Hdr->DataOff  = dataOff;
+       Hdr->MapSize  = mapSize;
+       Hdr->Magic.store(shmMagic, std::memory_order_release);
+      } else {
+       for (i = 0; i < 100 && Hdr->Magic.load(std::memory_order_acquire)
+                              != shmMagic; i++) XrdSysTimer::Wait(50);
+       if (i >= 100 || Hdr->Version != shmVersion || Hdr->Ways != setWays
+       ||  Hdr->MapSize > mapSize)
+          {rc = (i >= 100 ? ETIMEDOUT : EINVAL); return;}
+       pageSize = Hdr->PageSize;
+       setNum   = Hdr->SetNum;
+       dataOff  = Hdr->DataOff;
+      }
+   Slots = (Slot *)(Base + ((sizeof(Header) + 63) & ~63));
+
+// Establish the remaining values
+//
+   for (pageShft = 0; (1 << pageShft) < pageSize; pageShft++) {}
+   maxCache = (ParmV.Max2Cache < pageSize ? pageSize : ParmV.Max2Cache);
+
+   if (Dbg) cerr <<"Cache: " <<(isNew ? "Created " : "Attached to ") <<name
+                 <<' ' <<setNum*setWays <<" pages of " <<pageSize <<endl;
+   rc = 0;
+}
+
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+// The segment is left for the other processes that use it
+
+XrdOucCacheShm::~XrdOucCacheShm()
+{
+   if (Base != MAP_FAILED) munmap(Base, mapSize);
+   free(shmName);
+}
+
+/******************************************************************************/
+/*                                A t t a c h                                 */
+/******************************************************************************/
+
+XrdOucCacheIO *XrdOucCacheShm::Attach(XrdOucCacheIO *ioP, int Options)
+{
+   Attached++;
+   return new XrdOucCacheShmIO(this, ioP, Options);
+}
+
+/******************************************************************************/
+/*                              C o u n t e r s                               */
+/******************************************************************************/
+
+void XrdOucCacheShm::Counters(XrdOucCacheShm::ShmCounters &cnt)
+{
+   cnt.Hits  = Hdr->Hits.load();
+   cnt.Miss  = Hdr->Miss.load();
+   cnt.Evict = Hdr->Evict.load();
+   cnt.Store = Hdr->Store.load();
+   cnt.Inval = Hdr->Inval.load();
+}
+
+/******************************************************************************/
+/*                                C r e a t e                                 */
+/******************************************************************************/
+
+XrdOucCacheShm *XrdOucCacheShm::Create(XrdOucCache::Parms &ParmV,
+                                       const char *name)
+{
+   XrdOucCacheShm *cP;
+   int rc;
+
+   if (!name || !*name) {errno = EINVAL; return 0;}
+
+   cP = new XrdOucCacheShm(rc, ParmV, name);
+   if (rc) {delete cP; cP = 0; errno = rc;}
+   return cP;
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                  D r o p                                   */
+/******************************************************************************/
+
+void XrdOucCacheShm::Drop(uint64_t key, long long page)
+{
+   Slot *sP = Slots + SetOf(key, page)*setWays;
+   unsigned int seq;
+
+   for (int i = 0; i < setWays; i++, sP++)
+       {if (sP->Key.load(std::memory_order_relaxed) != key
+        ||  sP->Page.load(std::memory_order_relaxed) != page) continue;
+        if (!Lock(sP, seq)) continue;
+        if (sP->Key.load(std::memory_order_relaxed) == key
+        &&  sP->Page.load(std::memory_order_relaxed) == page)
+           {sP->Key.store(0, std::memory_order_relaxed);
+            Hdr->Inval++;
+           }
+        UnLock(sP, seq);
+       }
+}
+
+/******************************************************************************/
+/*                                 F e t c h                                  */
+/******************************************************************************/
+
+// Copy up to len bytes at offset pOff of the page into buff. The copy is made
+// without any lock and is only valid when the page did not change meanwhile.
+//
+bool XrdOucCacheShm::Fetch(uint64_t key, long long page, char *buff,
+                           int pOff, int len, int &got)
+{
+   uint64_t set = SetOf(key, page);
+   Slot *sP = Slots + set*setWays;
+   unsigned int seq, plen, now;
+
+   for (int i = 0; i < setWays; i++, sP++)
+       {seq = sP->Seq.load(std::memory_order_acquire);
+        if (seq & 1
+        ||  sP->Key.load(std::memory_order_relaxed)  != key
+        ||  sP->Page.load(std::memory_order_relaxed) != page) continue;
+
+        plen = sP->Len.load(std::memory_order_relaxed);
+        if (plen > (unsigned int)pageSize) break;
+        got  = (int)plen - pOff;
+        if (got > len) got = len;
+        if (got < 0)   got = 0;
+        if (got) memcpy(buff, Data(set*setWays + i) + pOff, got);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sP->Seq.load(std::memory_order_relaxed) != seq) break;
+
+        now = Stamp();
+        if (sP->Used.load(std::memory_order_relaxed) != now)
+           sP->Used.store(now, std::memory_order_relaxed);
+        Hdr->Hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+       }
+
+   Hdr->Miss.fetch_add(1, std::memory_order_relaxed);
+   return false;
+}
+
+/******************************************************************************/
+/*                                F o r m a t                                 */
+/******************************************************************************/
+
+// Compute the geometry of a new segment from the parameters. Invalid values
+// silently revert to the default as for the private cache.
+//
+bool XrdOucCacheShm::Format(XrdOucCache::Parms &ParmV)
+{
+   long long pages, slotEnd;
+   int minPag = (ParmV.minPages <= 0 ? 256 : ParmV.minPages);
+
+   pageSize = ParmV.PageSize;
+   if (pageSize < 4096 || pageSize > 16*1024*1024
+   ||  (pageSize & (pageSize-1))) pageSize = 32768;
+
+   pages = (ParmV.CacheSize > 0 ? ParmV.CacheSize : 104857600) / pageSize;
+   if (pages < minPag) pages = minPag;
+   setNum = (pages + setWays - 1) / setWays;
+   pages  = setNum * setWays;
+
+   slotEnd  = ((sizeof(Header) + 63) & ~63) + pages*sizeof(Slot);
+   dataOff  = (slotEnd + pageSize - 1) & ~((long long)pageSize - 1);
+   mapSize  = dataOff + pages*pageSize;
+   mapSize  = (mapSize + hugeAlign - 1) & ~(hugeAlign - 1);
+   errno = 0;
+   return true;
+}
+
+/******************************************************************************/
+/*                                  L o c k                                   */
+/******************************************************************************/
+
+// Take ownership of a slot for replacement. A slot left locked by a process
+// that went away is taken over once it has been locked for too long.
+//
+XrdOucCacheShm::Slot *XrdOucCacheShm::Lock(Slot *sP, unsigned int &seq)
+{
+   uint32_t then, now;
+
+   seq = sP->Seq.load(std::memory_order_relaxed);
+   if (seq & 1)
+      {now = (uint32_t)time(0); then = sP->LockT.load();
+       if (now - then < (uint32_t)shmStale
+       ||  !sP->LockT.compare_exchange_strong(then, now)) return 0;
+       sP->Key.store(0, std::memory_order_relaxed);
+       seq--;
+      } else {
+       if (!sP->Seq.compare_exchange_strong(seq, seq+1)) return 0;
+       sP->LockT.store((uint32_t)time(0), std::memory_order_relaxed);
+      }
+   std::atomic_thread_fence(std::memory_order_release);
+   return sP;
+}
+
+/******************************************************************************/
+/*                                 S e t O f                                  */
+/******************************************************************************/
+
+uint64_t XrdOucCacheShm::SetOf(uint64_t key, long long page)
+{
+   uint64_t hval = (key ^ (uint64_t)page) * 0x9e3779b97f4a7c15ULL;
+
+   return (hval >> 17) % setNum;
+}
+
+/******************************************************************************/
+/*                                 S t o r e                                  */
+/******************************************************************************/
+
+// Place a page in its set replacing an empty or the least recently used slot.
+// Caching is best effort, if the slot we want is busy we simply give up.
+//
+void XrdOucCacheShm::Store(uint64_t key, long long page, const char *buff,
+                           int plen)
+{
+   uint64_t set = SetOf(key, page), oldKey;
+   Slot *sP = Slots + set*setWays, *vP = 0;
+   uint32_t now = Stamp(), age, vAge = 0, tNow = (uint32_t)time(0);
+   unsigned int seq;
+   int i, vNum = 0;
+
+// Find the victim. Slots that are being replaced only qualify when stale.
+//
+   for (i = 0; i < setWays; i++, sP++)
+       {if (sP->Key.load(std::memory_order_relaxed) == key
+        &&  sP->Page.load(std::memory_order_relaxed) == page) return;
+        if (sP->Seq.load(std::memory_order_relaxed) & 1
+        &&  tNow - sP->LockT.load() < (uint32_t)shmStale) continue;
+        if (!sP->Key.load(std::memory_order_relaxed))
+           {if (!vP || vAge != ~0U) {vP = sP; vNum = i; vAge = ~0U;}
+            continue;
+           }
+        age = now - sP->Used.load(std::memory_order_relaxed);
+        if (!vP || age > vAge) {vP = sP; vNum = i; vAge = age;}
+       }
+   if (!vP || !Lock(vP, seq)) return;
+
+// Replace the page. The key is cleared first so that nobody can mistake a
+// half written page for the previous one should we die here.
+//
+   oldKey = vP->Key.load(std::memory_order_relaxed);
+   vP->Key.store(0, std::memory_order_relaxed);
+   memcpy(Data(set*setWays + vNum), buff, plen);
+   vP->Page.store(page, std::memory_order_relaxed);
+   vP->Len.store(plen,  std::memory_order_relaxed);
+   vP->Used.store(now,  std::memory_order_relaxed);
+   vP->Key.store(key,   std::memory_order_relaxed);
+   UnLock(vP, seq);
+
+   if (oldKey) Hdr->Evict.fetch_add(1, std::memory_order_relaxed);
+   Hdr->Store.fetch_add(1, std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+/*                                U n L o c k                                 */
+/******************************************************************************/
+
+void XrdOucCacheShm::UnLock(Slot *sP, unsigned int seq)
+{
+   sP->Seq.store(seq+2, std::memory_order_release);
+}
@@ -0,0 +1,144 @@
+#ifndef __XRDOUCCACHESHM_HH__
+#define __XRDOUCCACHESHM_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                     X r d O u c C a c h e S h m . h h                      */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <atomic>
+#include <stdint.h>
+
+#include "XrdOuc/XrdOucCache.hh"
+
+/* The class defined here implements a memory cache that lives in a shared
+   memory segment so that every process on the node attaching to the segment
+   (e.g. several xrootd proxies or XrdPosix preload clients) shares the cached
+   pages. Pages are identified by a hash of the file's path and size, so the
+   same file read by different processes hits the same pages.
+
+   Notes: 1. The segment is named by the Create() argument. A name without an
+             embedded slash is a POSIX shared memory object (shm_open()).
+             Otherwise, it is the path of a file that is mapped, which allows
+             placing the cache on hugetlbfs (e.g. /dev/hugepages/xrdcache).
+          2. The first process creates and formats the segment using its
+             parameters. Later processes use the existing geometry whatever
+             parameters they pass.
+          3. The cache is organized as sets of eight pages. A page can only be
+             placed in the set selected by its hash and the least recently
+             used page of the set is evicted to make room for it.
+          4. Lookups take no lock. Each page carries a sequence number that is
+             odd while the page is being replaced; a reader copies the page
+             and discards the copy if the sequence number changed meanwhile.
+          5. A page being filled by a process that died is reclaimed after a
+             few seconds.
+          6. Writes and truncates are passed through and drop the affected
+             pages. Changes made to a file by other means are not noticed
+             until its size changes.
+          7. Reads larger than Max2Cache bypass the cache. Prereads are not
+             supported.
+          8. PageSize must be a power of 2 between 4K and 16MB and the cache
+             holds at least minPages pages.
+          9. Hit, miss, eviction and store counters are kept in the segment and
+             cover all the processes using it (see Counters()).
+*/
+
+class XrdOucCacheShmIO;
+
+class XrdOucCacheShm : public XrdOucCache
+{
+friend class XrdOucCacheShmIO;
+public:
+
+XrdOucCacheIO *Attach(XrdOucCacheIO *ioP, int Options=0);
+
+int            isAttached() {return Attached.load();}
+
+/* Counters()  Returns the shared counters of the segment.
+*/
+struct ShmCounters
+      {long long Hits;      // Pages found in the cache
+       long long Miss;      // Pages not found in the cache
+       long long Evict;     // Valid pages replaced by another page
+       long long Store;     // Pages placed in the cache
+       long long Inval;     // Pages dropped because of a write or truncate
+      };
+
+void           Counters(ShmCounters &cnt);
+
+/* Create()    Creates an instance of a shared cache using the specified
+               parameters and segment name (see notes above).
+
+               Success: returns a pointer to a new instance of the cache.
+               Failure: a null pointer is returned with errno set to indicate
+                        the problem.
+*/
+static
+XrdOucCacheShm *Create(Parms &Params, const char *name);
+
+/* Create()    The inherited form creates another instance using the segment
+               of this one. Pre-read parameters are ignored.
+*/
+XrdOucCache   *Create(Parms &Params, XrdOucCacheIO::aprParms *aprP=0)
+                     {(void)aprP; return Create(Params, shmName);}
+
+/* The following holds statistics for the cache itself. It is updated as
+   associated cacheIO objects are detached and their statistics are added.
+*/
+XrdOucCacheStats Stats;
+
+              ~XrdOucCacheShm();
+
+private:
+
+struct Header;
+struct Slot;
+
+               XrdOucCacheShm(int &rc, Parms &Parms, const char *name);
+
+bool           Fetch(uint64_t key, long long page, char *buff,
+                     int pOff, int len, int &got);
+char          *Data(uint64_t idx) {return Base + dataOff + idx*pageSize;}
+void           Drop(uint64_t key, long long page);
+bool           Format(Parms &Parms);
+Slot          *Lock(Slot *sP, unsigned int &seq);
+uint64_t       SetOf(uint64_t key, long long page);
+void           Store(uint64_t key, long long page, const char *buff, int plen);
+void           UnLock(Slot *sP, unsigned int seq);
+
+static const int setWays = 8;
+
+char            *shmName;     // Name of the segment
+char            *Base;        // Base of the mapped segment
+Header          *Hdr;
+Slot            *Slots;
+long long        mapSize;
+long long        dataOff;     // Offset of the first page in the segment
+uint64_t         setNum;      // Number of sets
+int              pageSize;
+int              pageShft;    // log2(pageSize)
+int              maxCache;    // Largest read to cache
+char             Dbg;         // Debug setting
+char             Lgs;         // Log statistics
+std::atomic<int> Attached;
+};
+#endif
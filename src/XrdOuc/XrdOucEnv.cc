@@ -40,9 +40,9 @@
   
 XrdOucEnv::XrdOucEnv(const char *vardata, int varlen, 
                      const XrdSecEntity *secent)
-                    : env_Hash(8,13), secEntity(secent)
+                    : env_Hash(0), secEntity(secent), cgiNum(0)
 {
-   char *vdp, varsave, *varname, *varvalu;
+   char *vdp, *varname, *varvalu;
 
    if (!vardata) {global_env = 0; global_len = 0; return;}
 
@@ -54,11 +54,18 @@ XrdOucEnv::XrdOucEnv(const char *vardata, int varlen,
 //
    while(*vardata == '&' && varlen) {vardata++; varlen--;}
    if (!varlen) {global_env = 0; global_len = 0; return;}
-   global_env = (char *)malloc(varlen+2);
+   global_env = (char *)malloc(2*(varlen+2));
    *global_env = '&'; vdp = global_env+1;
    memcpy((void *)vdp, (const void *)vardata, (size_t)varlen);
    *(vdp+varlen) = '\0'; global_len = varlen+1;
 
+// The variables are split in place in the second half of the buffer so that
+// callers may modify the values without affecting the string in Env().
+//
+   vdp = global_env + global_len + 1;
+   memcpy((void *)vdp, (const void *)(global_env+1), (size_t)varlen+1);
+   memset((void *)cgiTab, 0, sizeof(cgiTab));
+
 // scan through the string looking for '&'
 //
    while(*vdp)
@@ -71,16 +78,73 @@ XrdOucEnv::XrdOucEnv(const char *vardata, int varlen,
          varvalu = ++vdp;
 
          while(*vdp && *vdp != '&') vdp++;  // &....=....&
-         varsave = *vdp; *vdp = '\0';
+         if (*vdp) *vdp++ = '\0';
 
-         if (*varname && *varvalu)
-            env_Hash.Rep(varname, strdup(varvalu), 0, Hash_dofree);
-
-         *vdp = varsave; *(varvalu-1) = '=';
+         if (*varname && *varvalu) cgiAdd(varname, varvalu);
         }
    return;
 }
 
+/******************************************************************************/
+/* Private:                       c g i A d d                                 */
+/******************************************************************************/
+
+void XrdOucEnv::cgiAdd(char *varname, char *varvalu)
+{
+   unsigned int hval = cgiHash(varname);
+   int i = hval & (cgiMax-1);
+
+// Replace an existing entry (the last setting wins)
+//
+   while(cgiTab[i].name)
+        {if (cgiTab[i].hval == hval && !strcmp(cgiTab[i].name, varname))
+            {cgiTab[i].value = varvalu; return;}
+         i = (i+1) & (cgiMax-1);
+        }
+
+// When the table is full enough, further variables go into the hash
+//
+   if (cgiNum >= cgiLim)
+      {Hash()->Rep(varname, strdup(varvalu), 0, Hash_dofree);
+       return;
+      }
+   cgiTab[i].name  = varname;
+   cgiTab[i].value = varvalu;
+   cgiTab[i].hval  = hval;
+   cgiNum++;
+}
+
+/******************************************************************************/
+/* Private:                      c g i F i n d                                */
+/******************************************************************************/
+
+char *XrdOucEnv::cgiFind(const char *varname)
+{
+   unsigned int hval = cgiHash(varname);
+   int i = hval & (cgiMax-1);
+
+   while(cgiTab[i].name)
+        {if (cgiTab[i].hval == hval && !strcmp(cgiTab[i].name, varname))
+            return cgiTab[i].value;
+         i = (i+1) & (cgiMax-1);
+        }
+   return 0;
+}
+
+/******************************************************************************/
+/* Private:                      c g i H a s h                                */
+/******************************************************************************/
+
+unsigned int XrdOucEnv::cgiHash(const char *varname)
+{
+   unsigned int hval = 2166136261U;
+
+// FNV-1a which is plenty for the few short names we see
+//
+   while(*varname) {hval ^= (unsigned char)*varname++; hval *= 16777619U;}
+   return hval;
+}
+
 /******************************************************************************/
 /*                               D e l i m i t                                */
 /******************************************************************************/
@@ -168,7 +232,7 @@ long XrdOucEnv::GetInt(const char *varname)
 // Retrieve a char* value from the Hash table and convert it into a long.
 // Return -999999999 if the varname does not exist
 //
-  if ((cP = env_Hash.Find(varname)) == NULL) return -999999999;
+  if ((cP = Get(varname)) == NULL) return -999999999;
   return atol(cP);
 }
 
@@ -182,7 +246,7 @@ void XrdOucEnv::PutInt(const char *varname, long value)
 //
   char stringValue[24];
   sprintf(stringValue, "%ld", value);
-  env_Hash.Rep(varname, strdup(stringValue), 0, Hash_dofree);
+  Hash()->Rep(varname, strdup(stringValue), 0, Hash_dofree);
 }
 
 /******************************************************************************/
@@ -197,7 +261,7 @@ void *XrdOucEnv::GetPtr(const char *varname)
 
 // Retrieve the variable from the hash
 //
-   if ((cP = env_Hash.Find(varname)) == NULL) return (void *)0;
+   if ((cP = Get(varname)) == NULL) return (void *)0;
 
 // Verify that the string is not too long or too short
 //
@@ -240,5 +304,5 @@ void XrdOucEnv::PutPtr(const char *varname, void *value)
 
 // Replace the value in he hash
 //
-   env_Hash.Rep(varname, strdup(Buff), 0, Hash_dofree);
+   Hash()->Rep(varname, strdup(Buff), 0, Hash_dofree);
 }
@@ -34,7 +34,7 @@
 #ifndef WIN32
 #include <strings.h>
 #endif
-#include "XrdOuc/XrdOucHash.hh"
+#include "XrdOuc/XrdOucOAHash.hh"
 
 class XrdSecEntity;
 
@@ -61,7 +61,11 @@ static bool  Import( const char *var, long  &val );
 // Get() returns the address of the string associated with the variable
 //       name. If no association exists, zero is returned.
 //
-       char *Get(const char *varname) {return env_Hash.Find(varname);}
+       char *Get(const char *varname)
+                {char *val;
+                 if (env_Hash && (val = env_Hash->Find(varname))) return val;
+                 return (cgiNum ? cgiFind(varname) : 0);
+                }
 
 // GetInt() returns a long integer value. If the variable varname is not found
 //           in the hash table, return -999999999.       
@@ -78,7 +82,7 @@ static bool  Import( const char *var, long  &val );
 //       duplicated (value here, variable by env_Hash).
 //
        void  Put(const char *varname, const char *value)
-                {env_Hash.Rep((char *)varname, strdup(value), 0, Hash_dofree);}
+                {Hash()->Rep((char *)varname, strdup(value), 0, Hash_dofree);}
 
 // PutInt() puts a long integer value into the hash. Internally, the value gets
 //          converted into a char*
@@ -102,18 +106,38 @@ static bool  Import( const char *var, long  &val );
 inline const XrdSecEntity *secEnv() const {return secEntity;}
 
 // Use the constructor to define the initial variable settings. The passed
-// string is duplicated and the copy can be retrieved using Env().
+// string is duplicated and the copy can be retrieved using Env(). The CGI
+// variables refer to a second copy of the string split in place; they are
+// indexed by a small table inside the object and only spill into a hash
+// when there are many of them. Variables added later always go to the hash.
 //
        XrdOucEnv(const char *vardata=0, int vardlen=0, 
                  const XrdSecEntity *secent=0);
 
-      ~XrdOucEnv() {if (global_env) free((void *)global_env);}
+      ~XrdOucEnv() {if (global_env) free((void *)global_env);
+                    if (env_Hash) delete env_Hash;
+                   }
 
 private:
 
-XrdOucHash<char> env_Hash;
+static const int cgiMax = 16;  // Must be a power of 2
+static const int cgiLim = 12;  // Entries in cgiTab before using env_Hash
+
+struct cgiEnt {const char *name; char *value; unsigned int hval;};
+
+void              cgiAdd(char *varname, char *varvalu);
+char             *cgiFind(const char *varname);
+static
+unsigned int      cgiHash(const char *varname);
+XrdOucOAHash<char> *Hash() {if (!env_Hash) env_Hash = new XrdOucOAHash<char>(8,13);
+                          return env_Hash;
+                         }
+
+XrdOucOAHash<char> *env_Hash;
 const XrdSecEntity *secEntity;
 char *global_env;
 int   global_len;
+int   cgiNum;
+cgiEnt cgiTab[cgiMax];
 };
 #endif
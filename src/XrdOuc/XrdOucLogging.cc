@@ -199,6 +199,7 @@ bool XrdOucLogging:: configLog(XrdSysError &eDest,
 //
    logParms.keepV = logInfo.keepV;
    logParms.hiRes = logInfo.hiRes;
+   logParms.asyncQ= logInfo.asyncQ;
    if (!XrdSysLogging::Configure(*(eDest.logger()), logParms))
       {eDest.Emsg("Config", "Log configuration failed.");
        return false;
@@ -43,9 +43,10 @@ public:
               const char     *iName;
               const char     *cfgFn;
               int             keepV;
+              int             asyncQ;
               bool            hiRes;
               configLogInfo() : logArg(0), xrdEnv(0), iName(0), cfgFn(0),
-                                keepV(1),  hiRes(false) {}
+                                keepV(1),  asyncQ(0), hiRes(false) {}
              };
 
 static bool  configLog(XrdSysError &eDest, configLogInfo &logInfo);
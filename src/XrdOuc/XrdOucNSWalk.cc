@@ -33,6 +33,10 @@
 #include <errno.h>
 #include <dirent.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#endif
 
 #include "XrdOuc/XrdOucNSWalk.hh"
 #include "XrdOuc/XrdOucTList.hh"
@@ -42,6 +46,35 @@
 
 using namespace std;
 
+/******************************************************************************/
+/*                         L o c a l   D e f i n e s                          */
+/******************************************************************************/
+
+// On Linux directories are read with getdents64() into a large buffer instead
+// of readdir()'s 32K and entries are stat'ed with statx() asking only for the
+// fields that will be used, which spares remote file systems the work.
+//
+#if defined(__linux__) && defined(SYS_getdents64) && defined(HAVE_FSTATAT)
+#define NSWALK_GETDENTS 1
+
+namespace
+{
+struct linux_dirent64
+      {unsigned long long d_ino;
+       long long          d_off;
+       unsigned short     d_reclen;
+       unsigned char      d_type;
+       char               d_name[1];
+      };
+
+static const int dBsz = 1024*1024;
+}
+#endif
+
+#if defined(NSWALK_GETDENTS) && defined(STATX_TYPE)
+#define NSWALK_STATX 1
+#endif
+
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -59,17 +92,18 @@ XrdOucNSWalk::XrdOucNSWalk(XrdSysError *erp, const char *dpath,
       else   LKFn = 0;
    Opts = opts;
    DPfd = LKfd = -1;
+   dBuff= 0; dBlen = dBoff = 0;
    errOK= opts & skpErrs;
    DEnts= 0;
    edCB = 0;
 
 // Copy the exclude list if one exists
 //
-   if (!xlist) XList = 0;
-      else while(xlist)
-                {XList = new XrdOucTList(xlist->text,xlist->ival,XList);
-                 xlist = xlist->next;
-                }
+   XList = 0;
+   while(xlist)
+        {XList = new XrdOucTList(xlist->text,xlist->ival,XList);
+         xlist = xlist->next;
+        }
 }
 
 /******************************************************************************/
@@ -81,6 +115,7 @@ XrdOucNSWalk::~XrdOucNSWalk()
    XrdOucTList *tP;
 
    if (LKFn) free(LKFn);
+   if (dBuff) free(dBuff);
 
    while((tP = DList)) {DList = tP->next; delete tP;}
 
@@ -163,7 +198,8 @@ int XrdOucNSWalk::Build()
                                                  if (F>0) close(F);
                                                 }
                  } theEnt;
-   struct dirent  *dp;
+   XrdOucNSWalk::NSEnt::Etype dType;
+   const char     *dName;
    int             rc = 0, getLI = Opts & retLink;
    int             nEnt = 0, xLKF = 0, chkED = (edCB != 0) && (LKFn != 0);
 
@@ -171,8 +207,17 @@ int XrdOucNSWalk::Build()
 //
    isEmpty = 0;
 
-// If we can optimize with a directory file descriptor, get one
+// If we can optimize with a directory file descriptor, get one. When reading
+// the directory ourselves we need nothing else.
 //
+#if defined(NSWALK_GETDENTS)
+   if ((DPfd = open(DPath, O_RDONLY|O_DIRECTORY)) < 0)
+      return Emsg("Build", errno, "open directory", DPath);
+   theEnt.F = DPfd;
+   if (!dBuff && !(dBuff = (char *)malloc(dBsz)))
+      return Emsg("Build", ENOMEM, "read directory", DPath);
+   dBlen = dBoff = 0;
+#else
 #ifdef HAVE_FSTATAT
    if ((DPfd = open(DPath, O_RDONLY)) < 0) rc = errno;
       else theEnt.F = DPfd;
@@ -184,18 +229,30 @@ int XrdOucNSWalk::Build()
 //
    if (!(theEnt.D = opendir(DPath)))
       return Emsg("Build", errno, "open directory", DPath);
+#endif
 
-// Process the entries
+// Process the entries. When the directory tells us the type of an entry we
+// need not stat it unless it will be returned.
 //
    errno = 0;
-   while((dp = readdir(theEnt.D)))
-        {if (!strcmp(dp->d_name, ".") || !strcmp(dp->d_name, "..")) continue;
-         strcpy(File, dp->d_name); nEnt++;
+   while((dName = getEnt(theEnt.D, dType)))
+        {if (!strcmp(dName, ".") || !strcmp(dName, "..")) continue;
+         strcpy(File, dName); nEnt++;
          if (!theEnt.P) theEnt.P = new NSEnt();
-         rc = getStat(theEnt.P, getLI);
+         if ((dType == NSEnt::isDir  && (!(Opts & retDir)  || Opts & retType))
+         ||  (dType == NSEnt::isFile && (!(Opts & retFile) || Opts & retType))
+         ||  (dType == NSEnt::isMisc && !(Opts & retMisc)))
+            {theEnt.P->Type = dType; rc = 0;
+             memset(&theEnt.P->Stat, 0, sizeof(struct stat));
+             if (dType != NSEnt::isMisc)
+                theEnt.P->Stat.st_mode = (dType == NSEnt::isDir ? S_IFDIR
+                                                                : S_IFREG);
+            }
+            else rc = getStat(theEnt.P, getLI);
          switch(theEnt.P->Type)
                {case NSEnt::isDir:
-                     if (Opts & Recurse && (!getLI || !isSymlink())
+                     if (Opts & Recurse
+                     && (!getLI || dType == NSEnt::isDir || !isSymlink())
                      &&  (!XList || !inXList(File)))
                         DList = new XrdOucTList(DPath, 0, DList);
                      if (!(Opts & retDir)) continue;
@@ -255,6 +312,63 @@ int XrdOucNSWalk::Emsg(const char *pfx, int rc, const char *txt1,
    return rc;
 }
 
+/******************************************************************************/
+/*                                g e t E n t                                 */
+/******************************************************************************/
+
+// Return the next entry name in the directory and, when known, its type in
+// dType (isBad when it is not known). Null is returned at the end with errno
+// set to zero or, on failure, to the error.
+//
+const char *XrdOucNSWalk::getEnt(DIR *dirP, XrdOucNSWalk::NSEnt::Etype &dType)
+{
+   unsigned char dt;
+   const char *dName;
+
+#if defined(NSWALK_GETDENTS)
+   struct linux_dirent64 *deP;
+   int rc;
+
+   if (dBoff >= dBlen)
+      {do {rc = syscall(SYS_getdents64, DPfd, dBuff, dBsz);}
+          while(rc < 0 && errno == EINTR);
+       if (rc <= 0) {if (!rc) errno = 0; return 0;}
+       dBlen = rc; dBoff = 0;
+      }
+   deP = (struct linux_dirent64 *)(dBuff + dBoff);
+   dBoff += deP->d_reclen;
+   dt = deP->d_type; dName = deP->d_name;
+#else
+   struct dirent *dp;
+
+   if (!(dp = readdir(dirP))) return 0;
+   dName = dp->d_name;
+#ifdef _DIRENT_HAVE_D_TYPE
+   dt = dp->d_type;
+#else
+   dt = 0;
+#endif
+#endif
+
+// Convert the type, symlinks must be stat'ed as if the type were unknown
+//
+   switch(dt)
+#ifdef DT_DIR
+         {case DT_DIR:  dType = NSEnt::isDir;  break;
+          case DT_REG:  dType = NSEnt::isFile; break;
+          case DT_LNK:  dType = NSEnt::isLink; break;
+          case DT_FIFO:
+          case DT_CHR:
+          case DT_BLK:
+          case DT_SOCK: dType = NSEnt::isMisc; break;
+          default:      dType = NSEnt::isBad;  break;
+         }
+#else
+         {default:      dType = NSEnt::isBad;  break;}
+#endif
+   return dName;
+}
+
 /******************************************************************************/
 /*                               g e t L i n k                                */
 /******************************************************************************/
@@ -282,9 +396,13 @@ int XrdOucNSWalk::getStat(XrdOucNSWalk::NSEnt *eP, int doLstat)
 {
    int rc;
 
-// The following code either uses fstatat() or regular stat()
+// The following code either uses statx(), fstatat() or regular stat()
 //
-#ifdef HAVE_FSTATAT
+#if defined(NSWALK_STATX)
+   struct statx sx;
+   unsigned int sxMask = (Opts & retType ? STATX_TYPE : STATX_BASIC_STATS);
+do{rc = statx(DPfd, File, (doLstat ? AT_SYMLINK_NOFOLLOW : 0), sxMask, &sx);
+#elif defined(HAVE_FSTATAT)
 do{rc = fstatat(DPfd, File, &(eP->Stat), (doLstat ? AT_SYMLINK_NOFOLLOW : 0));
 #else
 do{rc = doLstat ? lstat(DPath, &(eP->Stat)) : stat(DPath, &(eP->Stat));
@@ -301,6 +419,28 @@ do{rc = doLstat ? lstat(DPath, &(eP->Stat)) : stat(DPath, &(eP->Stat));
        return rc;
       }
 
+#if defined(NSWALK_STATX)
+   memset(&eP->Stat, 0, sizeof(struct stat));
+   eP->Stat.st_mode = sx.stx_mode;
+   if (sxMask != STATX_TYPE)
+      {eP->Stat.st_dev    = makedev(sx.stx_dev_major, sx.stx_dev_minor);
+       eP->Stat.st_ino    = sx.stx_ino;
+       eP->Stat.st_nlink  = sx.stx_nlink;
+       eP->Stat.st_uid    = sx.stx_uid;
+       eP->Stat.st_gid    = sx.stx_gid;
+       eP->Stat.st_rdev   = makedev(sx.stx_rdev_major, sx.stx_rdev_minor);
+       eP->Stat.st_size   = sx.stx_size;
+       eP->Stat.st_blksize= sx.stx_blksize;
+       eP->Stat.st_blocks = sx.stx_blocks;
+       eP->Stat.st_atim.tv_sec  = sx.stx_atime.tv_sec;
+       eP->Stat.st_atim.tv_nsec = sx.stx_atime.tv_nsec;
+       eP->Stat.st_mtim.tv_sec  = sx.stx_mtime.tv_sec;
+       eP->Stat.st_mtim.tv_nsec = sx.stx_mtime.tv_nsec;
+       eP->Stat.st_ctim.tv_sec  = sx.stx_ctime.tv_sec;
+       eP->Stat.st_ctim.tv_nsec = sx.stx_ctime.tv_nsec;
+      }
+#endif
+
 // Set appropraite type
 //
         if ((eP->Stat.st_mode & S_IFMT) == S_IFDIR) eP->Type = NSEnt::isDir;
@@ -31,6 +31,7 @@
 /******************************************************************************/
 
 #include <stdlib.h>
+#include <dirent.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -114,6 +115,7 @@ static const int retIDLO=  0x0020; // Names returned in decreasing length order
 static const int retIILO=  0x0040; // Names returned in increasing length order
 static const int Recurse=  0x0080; // Recursive traversal, 1 Level per Index()
 static const int noPath =  0x0100; // Do not include the full directory path
+static const int retType=  0x0200; // Only Type is needed (Stat may be empty)
 static const int skpErrs=  0x8000; // Skip any entry causing an error
 
              XrdOucNSWalk(XrdSysError *erp,  // Error msg object. If 0->silent
@@ -128,11 +130,18 @@ static const int skpErrs=  0x8000; // Skip any entry causing an error
 //       If either fails, the the directory is not indexed and Index() will
 //       return null pointer with rc != 0. Note that the lkfn is not returned
 //       as a directory entry if an empty directory call back has been set.
+//
+// Note: Where the directory entry supplies the file type, entries that are
+//       not returned (e.g. subdirectories when only files are returned) are
+//       not stat'ed. With retType, returned files and directories are not
+//       stat'ed either and only Type is valid for them; st_mode holds just
+//       the file type bits and the rest of Stat is zero.
 
 private:
 void          addEnt(XrdOucNSWalk::NSEnt *eP);
 int           Build();
 int           Emsg(const char *pfx, int rc, const char *tx1, const char *tx2=0);
+const char   *getEnt(DIR *dirP, XrdOucNSWalk::NSEnt::Etype &dType);
 int           getLink(XrdOucNSWalk::NSEnt *eP);
 int           getStat(XrdOucNSWalk::NSEnt *eP, int doLstat=0);
 int           getStat();
@@ -150,6 +159,9 @@ CallBack     *edCB;
 const char   *mPfx;
 char          DPath[1032];
 char         *File;
+char         *dBuff;
+int           dBlen;
+int           dBoff;
 char         *LKFn;
 int           LKfd;
 int           DPfd;
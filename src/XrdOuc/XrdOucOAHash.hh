@@ -0,0 +1,142 @@
+#ifndef __OUC_OAHASH__
+#define __OUC_OAHASH__
+/******************************************************************************/
+/*                                                                            */
+/*                       X r d O u c O A H a s h . h h                        */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <sys/types.h>
+#include <string.h>
+#include <time.h>
+
+#include "XrdOuc/XrdOucHash.hh"
+
+//------------------------------------------------------------------------------
+//! XrdOucOAHash is a drop in replacement for XrdOucHash that keeps its items
+//! in one open addressed (Robin Hood) table instead of hash chains. The API,
+//! options (see XrdOucHash_Options) and entry lifetimes are the same. Short
+//! keys that are copied (i.e. neither Hash_keep nor Hash_data_is_key) are
+//! stored inside the table slot, so most lookups touch a single cache line
+//! and never chase a pointer until the key matches.
+//!
+//! Unlike XrdOucHash, a pointer returned by Apply() for the key is only valid
+//! during the call as items move around the table.
+//------------------------------------------------------------------------------
+
+template<class T>
+class XrdOucOAHash
+{
+public:
+
+// Add() adds a new item to the hash. If it exists and repl = 0 then the old
+//       entry is returned and the new data is not added. Otherwise the current
+//       entry is replaced (see Rep()) and 0 is returned. If we have no memory
+//       to add the new entry, an ENOMEM exception is thrown. The LifeTime value
+//       is the number of seconds this entry is to be considered valid (zero
+//       keeps it until deleted). See XrdOucHash::Add() for the options.
+//
+T           *Add(const char *KeyVal, T *KeyData, const int LifeTime=0,
+                 XrdOucHash_Options opt=Hash_default);
+
+// Del() deletes the item from the hash. If it doesn't exist, it returns
+//       -ENOENT. Otherwise 0 is returned. If the Hash_count option is specified
+//       then the entry is only deleted when the entry count is below 0.
+//
+int          Del(const char *KeyVal, XrdOucHash_Options opt = Hash_default);
+
+// Find() simply looks up an entry in the table. It can optionally return the
+//        lifetime associated with the entry.
+//
+T           *Find(const char *KeyVal, time_t *KeyTime=0);
+
+// Num() returns the number of items in the hash table
+//
+int          Num() {return hashnum;}
+
+// Purge() simply deletes all of the items in the table.
+//
+void         Purge();
+
+// Rep() is simply Add() that allows replacement.
+//
+T           *Rep(const char *KeyVal, T *KeyData, const int LifeTime=0,
+                 XrdOucHash_Options opt=Hash_default)
+                {return Add(KeyVal, KeyData, LifeTime,
+                            (XrdOucHash_Options)(opt | Hash_replace));}
+
+// Apply() applies the specified function to every item in the hash. The
+//         first argument is the key value, the second is the associated data,
+//         the third argument is whatever is the passed in void *variable, The
+//         following actions occur for values returned by the applied function:
+//         <0 - The hash table item is deleted.
+//         =0 - The next hash table item is processed.
+//         >0 - Processing stops and the hash table item is returned.
+//
+T           *Apply(int (*func)(const char *, T *, void *), void *Arg);
+
+// The arguments are the same as for XrdOucHash. The table size is rounded up
+// to a power of two and psize is ignored. The load may not exceed 90%.
+//
+    XrdOucOAHash(int psize = 89, int size=144, int load=80);
+   ~XrdOucOAHash() {if (hashtable) {Purge(); free(hashtable); hashtable = 0;}}
+
+private:
+
+static const int shortKey = 24;
+
+struct Slot
+      {T            *keydata;
+       const char   *keyval;    // Nil when the key is in keyshort
+       time_t        keytime;
+       unsigned int  keyhash;
+       int           keycount;
+       short         keydist;   // Probe distance + 1, 0 means empty
+       short         entopts;
+       char          keyshort[shortKey];
+
+inline const char   *Key() {return (keyval ? keyval : keyshort);}
+      };
+
+void           Expand();
+unsigned int   HashVal(const char *KeyVal, size_t &KeyLen);
+void           Insert(Slot &item);
+void           Release(Slot &item);
+void           Remove(unsigned int kent);
+int            Search(const char *KeyVal, unsigned int khash);
+
+Slot          *hashtable;
+unsigned int   hashmask;
+int            hashnum;
+int            hashmax;
+int            hashload;
+};
+
+/******************************************************************************/
+/*                 A c t u a l   I m p l e m e n t a t i o n                  */
+/******************************************************************************/
+
+#include "XrdOuc/XrdOucOAHash.icc"
+#endif
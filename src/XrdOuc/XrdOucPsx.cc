@@ -286,10 +286,13 @@ bool XrdOucPsx::Parse(char *var, XrdOucStream &Config, XrdSysError &eDest)
    TS_Xeq("cache",         ParseCache);
    TS_Xeq("cachelib",      ParseCLib);
    TS_Xeq("ciosync",       ParseCio);
+   TS_Xeq("hedge",         ParseHedge);
    TS_Xeq("inetmode",      ParseINet);
    TS_Xeq("namelib",       ParseNLib);
+   TS_Xeq("readahead",     ParseRdAhead);
    TS_Xeq("setopt",        ParseSet);
    TS_Xeq("trace",         ParseTrace);
+   TS_Xeq("writebehind",   ParseWrBehind);
 
    // No match found, complain.
    //
@@ -316,6 +319,8 @@ bool XrdOucPsx::Parse(char *var, XrdOucStream &Config, XrdSysError &eDest)
              pagesize  size of each cache page (can be suffixed with k, m, g).
              preread   [minpages [minrdsz]] [perf nn [recalc]]
              r/w       enables caching for files opened read/write.
+             shared    <name> use the shared memory cache named <name> that is
+                       shared by all processes on the node using the name.
              sfiles    {on | off | .<sfx>}
              size      size of cache in bytes  (can be suffixed with k, m, g).
 
@@ -326,7 +331,8 @@ bool XrdOucPsx::ParseCache(XrdSysError *Eroute, XrdOucStream &Config)
 {
    long long llVal, cSize=-1, m2Cache=-1, pSize=-1, minPg = -1;
    const char *ivN = 0;
-   char  *val, *sfSfx = 0, sfVal = '0', lgVal = '0', dbVal = '0', rwVal = '0';
+   char  *val, *sfSfx = 0, *shmName = 0, sfVal = '0', lgVal = '0';
+   char  dbVal = '0', rwVal = '0';
    char eBuff[2048], pBuff[1024], *eP;
    struct sztab {const char *Key; long long *Val;} szopts[] =
                {{"max2cache", &m2Cache},
@@ -366,6 +372,12 @@ do{for (i = 0; i < numopts; i++) if (!strcmp(szopts[i].Key, val)) break;
                 break;
                }
        else if (!strcmp("r/w", val)) rwVal = '1';
+       else if (!strcmp("shared", val))
+               {if (shmName) {free(shmName); shmName = 0;}
+                if (!(val = Config.GetWord()) || strlen(val) > 255
+                ||  strchr(val, '&')) ivN = "shared";
+                   else shmName = strdup(val);
+               }
        else if (!strcmp("sfiles", val))
                {if (sfSfx) {free(sfSfx); sfSfx = 0;}
                      if (!(val = Config.GetWord())) ivN = "sfiles";
@@ -403,6 +415,8 @@ do{for (i = 0; i < numopts; i++) if (!strcmp(szopts[i].Key, val)) break;
           else {strcat(eP, "&optsf="); strcat(eBuff, sfSfx); free(sfSfx);}
       }
    if (rwVal != '0') strcat(eP, "&optwr=1");
+   if (shmName)
+      {strcat(eP, "&shmname="); strcat(eP, shmName); free(shmName);}
    if (*pBuff)       strcat(eP, pBuff);
 
    mCache = strdup(eBuff);
@@ -543,6 +557,72 @@ bool XrdOucPsx::ParseCLib(XrdSysError *Eroute, XrdOucStream &Config)
    return true;
 }
   
+/******************************************************************************/
+/*                            P a r s e H e d g e                             */
+/******************************************************************************/
+
+/* Function: ParseHedge
+
+   Purpose:  To parse the directive: hedge [pct <p>] [min <ms>] [max <ms>]
+
+             <p>       the latency percentile after which a read is also sent
+                       to another replica (default 95).
+             min <ms>  never hedge a read sooner than this (default 20).
+             max <ms>  always hedge a read after this long (default 2000).
+
+  Output: true upon success or false upon failure.
+*/
+
+bool XrdOucPsx::ParseHedge(XrdSysError *Eroute, XrdOucStream &Config)
+{
+   char *val;
+   int pct = 95, minMS = hedgeMin, maxMS = hedgeMax;
+
+// Process the options, all of which are optional
+//
+   while((val = Config.GetWord()))
+        {     if (!strcmp(val, "pct"))
+                 {if (!(val = Config.GetWord()))
+                     {Eroute->Emsg("Config", "hedge pct not specified");
+                      return false;
+                     }
+                  if (XrdOuca2x::a2i(*Eroute,"hedge pct",val,&pct,1,99))
+                     return false;
+                 }
+         else if (!strcmp(val, "min"))
+                 {if (!(val = Config.GetWord()))
+                     {Eroute->Emsg("Config", "hedge min not specified");
+                      return false;
+                     }
+                  if (XrdOuca2x::a2i(*Eroute,"hedge min",val,&minMS,1))
+                     return false;
+                 }
+         else if (!strcmp(val, "max"))
+                 {if (!(val = Config.GetWord()))
+                     {Eroute->Emsg("Config", "hedge max not specified");
+                      return false;
+                     }
+                  if (XrdOuca2x::a2i(*Eroute,"hedge max",val,&maxMS,1))
+                     return false;
+                 }
+         else {Eroute->Emsg("Config", "invalid hedge option -", val);
+               return false;
+              }
+        }
+
+// Make sure the bounds make sense
+//
+   if (maxMS < minMS)
+      {Eroute->Emsg("Config", "hedge max is less than min"); return false;}
+
+// Set values and return success
+//
+   hedgePct = pct;
+   hedgeMin = minMS;
+   hedgeMax = maxMS;
+   return true;
+}
+  
 /******************************************************************************/
 /*                             P a r s e I N e t                              */
 /******************************************************************************/
@@ -628,6 +708,42 @@ bool XrdOucPsx::ParseNLib(XrdSysError *Eroute, XrdOucStream &Config)
    return true;
 }
 
+/******************************************************************************/
+/*                          P a r s e R d A h e a d                           */
+/******************************************************************************/
+
+/* Function: ParseRdAhead
+
+   Purpose:  To parse the directive: readahead <bsz>
+
+             <bsz>     the size of each of the two read-ahead blocks used for
+                       files opened read-only (can be suffixed with k or m);
+                       zero disables read-ahead.
+
+  Output: true upon success or false upon failure.
+*/
+
+bool XrdOucPsx::ParseRdAhead(XrdSysError *Eroute, XrdOucStream &Config)
+{
+   long long bsz;
+   char *val;
+
+// Get the block size
+//
+   if (!(val = Config.GetWord()) || !val[0])
+      {Eroute->Emsg("Config", "readahead block size not specified");
+       return false;
+      }
+   if (strcmp(val, "0")
+   &&  XrdOuca2x::a2sz(*Eroute,"readahead block size",val,&bsz,
+                       4096, 64*1024*1024)) return false;
+
+// Set value and return success
+//
+   raSize = (strcmp(val, "0") ? static_cast<int>(bsz) : 0);
+   return true;
+}
+  
 /******************************************************************************/
 /*                              P a r s e S e t                               */
 /******************************************************************************/
@@ -673,6 +789,7 @@ bool XrdOucPsx::ParseSet(XrdSysError *Eroute, XrdOucStream &Config)
          {"RequestTimeout",        "RequestTimeout",1},      // Default 1800
          {"StreamTimeout",         "StreamTimeout",1},
          {"TransactionTimeout",    "",1},
+         {"WorkerQueues",          "WorkerQueues",0},        // Default    0
          {"WorkerThreads",         "WorkerThreads",0}        // Set To    64
        };
     int i, numopts = sizeof(Sopts)/sizeof(const char *);
@@ -763,6 +880,51 @@ bool XrdOucPsx::ParseTrace(XrdSysError *Eroute, XrdOucStream &Config)
     return true;
 }
 
+/******************************************************************************/
+/*                         P a r s e W r B e h i n d                          */
+/******************************************************************************/
+
+/* Function: ParseWrBehind
+
+   Purpose:  To parse the directive: writebehind <bsz> [<num>]
+
+             <bsz>     the size of each write-behind block used for files
+                       opened for update (can be suffixed with k or m); zero
+                       disables write-behind.
+             <num>     the maximum number of blocks in flight (default 4).
+
+  Output: true upon success or false upon failure.
+*/
+
+bool XrdOucPsx::ParseWrBehind(XrdSysError *Eroute, XrdOucStream &Config)
+{
+   long long bsz = 0;
+   char *val;
+   int num = 4;
+
+// Get the block size
+//
+   if (!(val = Config.GetWord()) || !val[0])
+      {Eroute->Emsg("Config", "writebehind block size not specified");
+       return false;
+      }
+   if (strcmp(val, "0")
+   &&  XrdOuca2x::a2sz(*Eroute,"writebehind block size",val,&bsz,
+                       4096, 64*1024*1024)) return false;
+
+// Get the optional number of blocks
+//
+   if ((val = Config.GetWord()) && val[0]
+   &&  XrdOuca2x::a2i(*Eroute,"writebehind blocks",val,&num,1,64))
+      return false;
+
+// Set values and return success
+//
+   wbSize = static_cast<int>(bsz);
+   wbNum  = num;
+   return true;
+}
+  
 /******************************************************************************/
 /*                               S e t R o o t                                */
 /******************************************************************************/
@@ -56,14 +56,20 @@ bool      ParseCio(XrdSysError *Eroute, XrdOucStream &Config);
 
 bool      ParseCLib(XrdSysError *Eroute, XrdOucStream &Config);
 
+bool      ParseHedge(XrdSysError *Eroute, XrdOucStream &Config);
+
 bool      ParseINet(XrdSysError *Eroute, XrdOucStream &Config);
 
 bool      ParseNLib(XrdSysError *Eroute, XrdOucStream &Config);
 
+bool      ParseRdAhead(XrdSysError *Eroute, XrdOucStream &Config);
+
 bool      ParseSet(XrdSysError *Eroute, XrdOucStream &Config);
 
 bool      ParseTrace(XrdSysError *Eroute, XrdOucStream &Config);
 
+bool      ParseWrBehind(XrdSysError *Eroute, XrdOucStream &Config);
+
 void      SetRoot(const char *lroot, const char *oroot=0);
 
 XrdOucName2Name   *theN2N;   // -> File mapper object
@@ -77,6 +83,12 @@ int                traceLvl;
 int                debugLvl;
 int                cioWait;
 int                cioTries;
+int                hedgePct;
+int                hedgeMin;
+int                hedgeMax;
+int                raSize;
+int                wbSize;
+int                wbNum;
 bool               useV4;
 bool               xLfn2Pfn;
 bool               xPfn2Lfn;
@@ -86,6 +98,8 @@ bool               xNameLib;
                    : theN2N(0), theCache(0), theCache2(0), mCache(0),
                      setFirst(0), setLast(0), maxRHCB(0),
                      traceLvl(0), debugLvl(0), cioWait(0), cioTries(0),
+                     hedgePct(0), hedgeMin(20), hedgeMax(2000),
+                     raSize(0), wbSize(0), wbNum(4),
                      useV4(false), xLfn2Pfn(false), xPfn2Lfn(false),
                      xNameLib(false),
                      LocalRoot(0), RemotRoot(0), N2NLib(0), N2NParms(0),
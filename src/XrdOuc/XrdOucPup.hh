@@ -31,8 +31,12 @@
 /******************************************************************************/
 
 #include <stddef.h>
+#include <string.h>
+#include <netinet/in.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+
+#include "XrdSys/XrdSysPlatform.hh"
   
 class  XrdSysError;
 struct iovec;
@@ -154,6 +158,56 @@ static int   Unpack(char **buff, const char *bend, char **data, int &dlen);
        int   Unpack(const char *buff, const char *bend, XrdOucPupArgs *pup,
                           char *base);
 
+// Unpack #3: Unpacks one element of a layout known at compile time, advancing
+//            buff past it. These are inline so that a parser for a fixed
+//            layout reduces to straight-line code; they accept exactly what
+//            Unpack #2 accepts for the element but produce no messages, so
+//            upon failure the caller should fall back to Unpack #2 for the
+//            diagnostic. UnpackStr() expects a PT_char element, setting data
+//            to null for an empty one, which is only valid when opt is true.
+//            UnpackNum() expects a PT_short, PT_int, or PT_longlong element
+//            per the size of the target. Both return true upon success.
+//
+static inline
+       bool  UnpackStr(const char *&buff, const char *bend, char *&data,
+                       int &dlen, bool opt=false)
+                      {unsigned short xlen;
+                       if (buff+sizeof(xlen) > bend || (*buff & PT_short))
+                          return false;
+                       memcpy(&xlen, buff, sizeof(xlen));
+                       buff += sizeof(xlen);
+                       if (!(dlen = ntohs(xlen))) {data = 0; return opt;}
+                       if (buff+dlen > bend) return false;
+                       data = (char *)buff; buff += dlen;
+                       return true;
+                      }
+
+template<typename T>
+static inline
+       bool  UnpackNum(const char *&buff, const char *bend, T &data)
+                      {static const int dtype = (sizeof(T) == 2 ? PT_short
+                                              : (sizeof(T) == 4 ? PT_int
+                                                                : PT_longlong));
+                       union {unsigned long long b64;
+                              unsigned int       b32;
+                              unsigned short     b16;
+                              unsigned char      b08;} temp;
+                       const char *dp;
+                       int dlen;
+                       if (buff+2 > bend || (*buff & PT_MaskT) != dtype)
+                          return false;
+                       if (!(dlen = (*buff & PT_MaskB)>>3)) dlen = 2;
+                       dp = (*buff & PT_Inline ? buff : buff+1);
+                       if (dp+dlen > bend) return false;
+                       memcpy(&temp.b64, dp, dlen);
+                       if (dp == buff) temp.b08 &= PT_MaskD;
+                       buff = dp + dlen;
+                            if (sizeof(T) == 2) data = ntohs(temp.b16);
+                       else if (sizeof(T) == 4) data = ntohl(temp.b32);
+                       else                     data = ntohll(temp.b64);
+                       return true;
+                      }
+
        XrdOucPup(XrdSysError *erp=0, XrdOucPupNames *nms=0)
                 {eDest = erp, Names = nms;}
       ~XrdOucPup() {}
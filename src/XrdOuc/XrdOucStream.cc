@@ -253,6 +253,14 @@ int XrdOucStream::Attach(int FileDescriptor, int bsz)
     Close();
     myInfo = saveInfo;
 
+    // Regular files (i.e. config files) are read in one go so that records
+    // are located in memory without refilling and shifting the buffer.
+    //
+    struct stat Stat;
+    if (bsz && !fstat(FileDescriptor, &Stat) && S_ISREG(Stat.st_mode)
+    &&  Stat.st_size > bsz && Stat.st_size < maxFBsz)
+       bsz = static_cast<int>(Stat.st_size) + 1;
+
     // Allocate a new buffer for this stream
     //
     if (!bsz) buff = 0;
@@ -1351,9 +1359,9 @@ char *XrdOucStream::vSubs(char *Var)
    char *vp, *sp, *dp, *vnp, ec, bkp, valbuff[maxVLen], Nil = 0;
    int n;
 
-// Check for substitution
+// Check for substitution, most tokens have none and need not be copied
 //
-   if (!Var) return Var;
+   if (!Var || !strpbrk(Var, "$\\")) return Var;
    sp = Var; dp = valbuff; n = maxVLen-1; *varVal = '\0';
 
    while(*sp && n > 0)
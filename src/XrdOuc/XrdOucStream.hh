@@ -221,6 +221,7 @@ private:
         int   xMsg(const char *txt1, const char *txt2=0, const char *txt3=0);
 
 static const int maxVLen = 512;
+static const int maxFBsz = 64*1024*1024;
 static const int llBsz   = 1024;
 
         int   FD;
@@ -0,0 +1,259 @@
+/******************************************************************************/
+/*                                                                            */
+/*                     X r d O u c T r a c e C t x . c c                      */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include "XrdNet/XrdNetAddr.hh"
+#include "XrdOuc/XrdOucTraceCtx.hh"
+#include "XrdSys/XrdSysFD.hh"
+
+/******************************************************************************/
+/*                        S t a t i c   M e m b e r s                         */
+/******************************************************************************/
+
+const char *XrdOucTraceCtx::CgiKey    = "xrd.traceparent";
+
+int         XrdOucTraceCtx::expFD     = -1;
+int         XrdOucTraceCtx::sampleN   = 0;
+int         XrdOucTraceCtx::sampleCnt = 0;
+
+/******************************************************************************/
+/*                         L o c a l   M e t h o d s                          */
+/******************************************************************************/
+
+namespace
+{
+char myHost[64] = {0};
+
+bool HexVal(const char *hex, int n, unsigned long long &val)
+{
+   val = 0;
+   for (int i = 0; i < n; i++)
+       {int c = hex[i];
+             if (c >= '0' && c <= '9') c -= '0';
+        else if (c >= 'a' && c <= 'f') c -= 'a' - 10;
+        else return false;
+        val = (val << 4) | c;
+       }
+   return true;
+}
+}
+
+/******************************************************************************/
+/*                                  E m i t                                   */
+/******************************************************************************/
+  
+void XrdOucTraceCtx::Emit(const char *buff, int blen)
+{
+   if (expFD >= 0 && blen > 0 && write(expFD, buff, blen) < 0) {}
+}
+
+/******************************************************************************/
+/*                                E x p o r t                                 */
+/******************************************************************************/
+  
+bool XrdOucTraceCtx::Export(const char *dest)
+{
+   int fd;
+
+// Spans are written with one write() each so that they stay whole in a file
+// shared by several layers or processes and map to one datagram each.
+//
+   if (!strncmp(dest, "udp://", 6))
+      {XrdNetAddr  netAddr;
+       const char *eText = netAddr.Set(dest+6);
+       if (eText) {errno = EHOSTUNREACH; return false;}
+       if ((fd = XrdSysFD_Socket(netAddr.Family(), SOCK_DGRAM, 0)) < 0)
+          return false;
+       if (connect(fd, netAddr.SockAddr(), netAddr.SockSize()))
+          {int rc = errno; close(fd); errno = rc; return false;}
+      } else {
+       if ((fd = XrdSysFD_Open(dest, O_WRONLY|O_CREAT|O_APPEND, 0644)) < 0)
+          return false;
+      }
+
+   if (!*myHost && gethostname(myHost, sizeof(myHost)-1)) strcpy(myHost, "?");
+
+   if (expFD >= 0) close(expFD);
+   expFD = fd;
+   return true;
+}
+
+/******************************************************************************/
+/*                               F r o m C g i                                */
+/******************************************************************************/
+  
+bool XrdOucTraceCtx::FromCgi(const char *cgi)
+{
+   static const int keyLen = strlen(CgiKey);
+   const char *cP = cgi;
+
+   if (!cgi) return false;
+
+   while((cP = strstr(cP, CgiKey)))
+        {if ((cP == cgi || *(cP-1) == '&' || *(cP-1) == '?')
+         &&  *(cP+keyLen) == '=') return Parse(cP+keyLen+1);
+         cP += keyLen;
+        }
+   return false;
+}
+
+/******************************************************************************/
+/*                                F o r m a t                                 */
+/******************************************************************************/
+  
+int XrdOucTraceCtx::Format(char *buff, int blen) const
+{
+   int n = snprintf(buff, blen, "00-%016llx%016llx-%016llx-%02x",
+                    traceHi, traceLo, spanID, flags);
+   return (n < blen ? n : 0);
+}
+
+/******************************************************************************/
+/*                                 N e w I D                                  */
+/******************************************************************************/
+  
+unsigned long long XrdOucTraceCtx::NewID()
+{
+   static unsigned long long seed = 0;
+   unsigned long long z;
+
+// Ids need only be unique, not unpredictable; a splitmix64 sequence started
+// from the clock and pid serves.
+//
+   if (!__atomic_load_n(&seed, __ATOMIC_RELAXED))
+      {unsigned long long s = (Now() << 16) ^ getpid();
+       unsigned long long e = 0;
+       __atomic_compare_exchange_n(&seed, &e, s, false,
+                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+      }
+
+   z = __atomic_add_fetch(&seed, 0x9e3779b97f4a7c15ULL, __ATOMIC_RELAXED);
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+   z =  z ^ (z >> 31);
+   return (z ? z : 1);
+}
+
+/******************************************************************************/
+/*                                   N o w                                    */
+/******************************************************************************/
+  
+long long XrdOucTraceCtx::Now()
+{
+   struct timeval tv;
+
+   gettimeofday(&tv, 0);
+   return static_cast<long long>(tv.tv_sec)*1000000 + tv.tv_usec;
+}
+
+/******************************************************************************/
+/*                                 P a r s e                                  */
+/******************************************************************************/
+  
+bool XrdOucTraceCtx::Parse(const char *tp)
+{
+   unsigned long long hi, lo, sid, flg;
+
+// Only version 00 is understood: 00-<32 hex>-<16 hex>-<2 hex>
+//
+   if (strncmp(tp, "00-", 3) || tp[35] != '-' || tp[52] != '-'
+   ||  !HexVal(tp+3,  16, hi)  || !HexVal(tp+19, 16, lo)
+   ||  !HexVal(tp+36, 16, sid) || !HexVal(tp+53,  2, flg)
+   ||  (tp[55] && tp[55] != '&')
+   ||  !(hi | lo) || !sid) return false;
+
+   traceHi = hi; traceLo = lo; spanID = sid;
+   flags   = static_cast<unsigned char>(flg);
+   return true;
+}
+
+/******************************************************************************/
+/*                                S a m p l e                                 */
+/******************************************************************************/
+  
+bool XrdOucTraceCtx::Sample()
+{
+   int n = sampleN;
+
+   if (!n) return false;
+   return __atomic_fetch_add(&sampleCnt, 1, __ATOMIC_RELAXED) % n == 0;
+}
+
+/******************************************************************************/
+/*                                  S p a n                                   */
+/******************************************************************************/
+  
+void XrdOucTraceCtx::Span(const char *name, long long begUs, long long durUs,
+                          const char *attr) const
+{
+   char buff[1024];
+   int  n;
+
+   if (expFD < 0 || !isSampled()) return;
+
+   if ((n = SpanText(buff, sizeof(buff), name, begUs, durUs, attr)))
+      Emit(buff, n);
+}
+
+/******************************************************************************/
+/*                              S p a n T e x t                               */
+/******************************************************************************/
+  
+int XrdOucTraceCtx::SpanText(char *buff, int blen, const char *name,
+                             long long begUs, long long durUs,
+                             const char *attr) const
+{
+   int n;
+
+   n = snprintf(buff, blen, "{\"trace\":\"%016llx%016llx\",\"span\":\"%016llx\","
+                "\"parent\":\"%016llx\",\"name\":\"%s\",\"host\":\"%s\","
+                "\"beg_us\":%lld,\"dur_us\":%lld%s%s%s}\n",
+                traceHi, traceLo, NewID(), spanID, name,
+                (*myHost ? myHost : "?"), begUs, durUs,
+                (attr ? ",\"attr\":{" : ""), (attr ? attr : ""),
+                (attr ? "}" : ""));
+   return (n < blen ? n : 0);
+}
+
+/******************************************************************************/
+/*                                 S t a r t                                  */
+/******************************************************************************/
+  
+void XrdOucTraceCtx::Start()
+{
+   traceHi = NewID();
+   traceLo = NewID();
+   spanID  = NewID();
+   flags   = 0x01;
+}
@@ -0,0 +1,147 @@
+#ifndef __OUC_TRACECTX__
+#define __OUC_TRACECTX__
+/******************************************************************************/
+/*                                                                            */
+/*                     X r d O u c T r a c e C t x . h h                      */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+//------------------------------------------------------------------------------
+//! XrdOucTraceCtx is the trace context that follows a file open from the
+//! client through proxies and caches down to the storage. It travels as the
+//! open CGI element xrd.traceparent=<ctx> where <ctx> has the W3C traceparent
+//! layout "00-<32 hex trace id>-<16 hex parent span id>-<2 hex flags>".
+//!
+//! Each layer that finds a sampled context times its work on the file and
+//! reports it as a span: one line of JSON naming the trace, a new span id,
+//! the parent span id from the context, the stage (e.g. "pfc.read"), the host
+//! and the start time and duration in microseconds. Spans go to the exporter
+//! set with Export(), which is process wide so that all layers loaded in a
+//! server share it, and may in addition be passed to a layer's own monitoring.
+//------------------------------------------------------------------------------
+
+class XrdOucTraceCtx
+{
+public:
+
+static const char *CgiKey;      // "xrd.traceparent"
+static const int   CtxLen = 55; // Length of the text form of a context
+
+//------------------------------------------------------------------------------
+//! Send spans to a collector.
+//!
+//! @param  dest   - "udp://<host>:<port>" sends a datagram per span, anything
+//!                  else is the path of a file spans are appended to.
+//!
+//! @return true upon success and false otherwise, with errno set.
+//------------------------------------------------------------------------------
+
+static bool        Export(const char *dest);
+
+static bool        Exporting() {return expFD >= 0;}
+
+//------------------------------------------------------------------------------
+//! Send a span formatted by SpanText() to the exporter, if any.
+//------------------------------------------------------------------------------
+
+static void        Emit(const char *buff, int blen);
+
+//------------------------------------------------------------------------------
+//! Start new traces for one in every n files that arrive without one; zero,
+//! the default, never starts any.
+//------------------------------------------------------------------------------
+
+static void        SetSample(int n) {sampleN = (n > 0 ? n : 0);}
+
+static bool        Sample();
+
+//------------------------------------------------------------------------------
+//! Extract the context from a CGI string.
+//!
+//! @return true if a valid context was found, false otherwise.
+//------------------------------------------------------------------------------
+
+       bool        FromCgi(const char *cgi);
+
+//------------------------------------------------------------------------------
+//! Format the context as a traceparent value into buff.
+//!
+//! @return the length of the text or 0 if the buffer was too small.
+//------------------------------------------------------------------------------
+
+       int         Format(char *buff, int blen) const;
+
+       bool        isSampled() const {return (flags & 0x01) != 0;}
+
+       bool        isSet() const {return (traceHi | traceLo) != 0;}
+
+//------------------------------------------------------------------------------
+//! Return the current time in microseconds since the epoch.
+//------------------------------------------------------------------------------
+
+static long long   Now();
+
+       bool        Parse(const char *tp);
+
+//------------------------------------------------------------------------------
+//! Report a span of this context to the exporter, if any. The attributes, if
+//! any, are a JSON object body (e.g. "\"off\":0,\"len\":4096").
+//------------------------------------------------------------------------------
+
+       void        Span(const char *name, long long begUs, long long durUs,
+                        const char *attr=0) const;
+
+//------------------------------------------------------------------------------
+//! Format a span of this context into buff.
+//!
+//! @return the length of the text or 0 if the buffer was too small.
+//------------------------------------------------------------------------------
+
+       int         SpanText(char *buff, int blen, const char *name,
+                            long long begUs, long long durUs,
+                            const char *attr=0) const;
+
+//------------------------------------------------------------------------------
+//! Start a new sampled trace rooted at this process.
+//------------------------------------------------------------------------------
+
+       void        Start();
+
+       XrdOucTraceCtx() : traceHi(0), traceLo(0), spanID(0), flags(0) {}
+      ~XrdOucTraceCtx() {}
+
+unsigned long long traceHi;
+unsigned long long traceLo;
+unsigned long long spanID;      // Span of the layer that passed the context
+unsigned char      flags;
+
+private:
+
+static unsigned long long NewID();
+
+static int         expFD;
+static int         sampleN;
+static int         sampleCnt;
+};
+#endif
@@ -42,12 +42,49 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #endif
+#include <map>
+#include <string>
+
 #include "XrdNet/XrdNetUtils.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucUtils.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
+#include "XrdSys/XrdSysPthread.hh"
 #include "XrdOuc/XrdOucStream.hh"
+
+/******************************************************************************/
+/*                         L o c a l   M e t h o d s                          */
+/******************************************************************************/
+
+namespace
+{
+XrdSysMutex                 hmMutex;
+std::map<std::string, bool> hmCache;
+
+// Host patterns ending with a plus are expanded via DNS. Every component
+// processes the same config file so we remember the outcome of the expansion
+// instead of resolving the host list again for each of them.
+//
+bool hostMatch(const char *hname, const char *hpat)
+{
+   size_t n = strlen(hpat);
+
+   if (!n || hpat[n-1] != '+') return XrdNetUtils::Match(hname, hpat);
+
+   std::string key(hpat);
+   key += ' ';
+   key += hname;
+
+   XrdSysMutexHelper mHelp(hmMutex);
+   std::map<std::string, bool>::iterator it = hmCache.find(key);
+   if (it != hmCache.end()) return it->second;
+
+   bool isOK = XrdNetUtils::Match(hname, hpat);
+   hmCache[key] = isOK;
+   return isOK;
+}
+}
   
 /******************************************************************************/
 /*                              e n d s W i t h                               */
@@ -121,7 +158,7 @@ int XrdOucUtils::doIf(XrdSysError *eDest, XrdOucStream &Config,
 // Check if we are one of the listed hosts
 //
    if (!is1of(val, brk))
-      {do {hostok = XrdNetUtils::Match(hname, val);
+      {do {hostok = hostMatch(hname, val);
            val = Config.GetWord();
           } while(!hostok && val && !is1of(val, brk));
       if (hostok)
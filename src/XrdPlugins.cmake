@@ -7,6 +7,7 @@ include( XRootDCommon )
 set( LIB_XRD_BWM        XrdBwm-${PLUGIN_VERSION} )
 set( LIB_XRD_N2NO2P     XrdN2No2p-${PLUGIN_VERSION} )
 set( LIB_XRD_PSS        XrdPss-${PLUGIN_VERSION} )
+set( LIB_XRD_TPCCL      XrdOfsTPCCl-${PLUGIN_VERSION} )
 set( LIB_XRD_GPFS       XrdOssSIgpfsT-${PLUGIN_VERSION} )
 set( LIB_XRD_ZCRC32     XrdCksCalczcrc32-${PLUGIN_VERSION} )
 set( LIB_XRD_THROTTLE   XrdThrottle-${PLUGIN_VERSION} )
@@ -25,12 +26,14 @@ add_library(
   XrdPss/XrdPssAioCB.cc      XrdPss/XrdPssAioCB.hh
   XrdPss/XrdPss.cc           XrdPss/XrdPss.hh
   XrdPss/XrdPssCks.cc        XrdPss/XrdPssCks.hh
-  XrdPss/XrdPssConfig.cc )
+  XrdPss/XrdPssConfig.cc
+  XrdPss/XrdPssPool.cc       XrdPss/XrdPssPool.hh )
 
 target_link_libraries(
   ${LIB_XRD_PSS}
   XrdFfs
   XrdPosix
+  XrdCl
   XrdUtils )
 
 set_target_properties(
@@ -39,6 +42,25 @@ set_target_properties(
   INTERFACE_LINK_LIBRARIES ""
   LINK_INTERFACE_LIBRARIES "" )
 
+#-------------------------------------------------------------------------------
+# The in-process TPC copy engine
+#-------------------------------------------------------------------------------
+add_library(
+  ${LIB_XRD_TPCCL}
+  MODULE
+  XrdOfs/XrdOfsTPCCl.cc      XrdOfs/XrdOfsTPCEngine.hh )
+
+target_link_libraries(
+  ${LIB_XRD_TPCCL}
+  XrdCl
+  XrdUtils )
+
+set_target_properties(
+  ${LIB_XRD_TPCCL}
+  PROPERTIES
+  INTERFACE_LINK_LIBRARIES ""
+  LINK_INTERFACE_LIBRARIES "" )
+
 #-------------------------------------------------------------------------------
 # The XrdBwm module
 #-------------------------------------------------------------------------------
@@ -50,6 +72,7 @@ add_library(
   XrdBwm/XrdBwmHandle.cc       XrdBwm/XrdBwmHandle.hh
   XrdBwm/XrdBwmLogger.cc       XrdBwm/XrdBwmLogger.hh
   XrdBwm/XrdBwmPolicy1.cc      XrdBwm/XrdBwmPolicy1.hh
+  XrdBwm/XrdBwmPolicy2.cc      XrdBwm/XrdBwmPolicy2.hh
                                XrdBwm/XrdBwmPolicy.hh
                                XrdBwm/XrdBwmTrace.hh )
 
@@ -133,6 +156,7 @@ add_library(
   XrdThrottle/XrdThrottleFileSystemConfig.cc
   XrdThrottle/XrdThrottleFile.cc
   XrdThrottle/XrdThrottleManager.cc    XrdThrottle/XrdThrottleManager.hh
+  XrdThrottle/XrdThrottleBucket.cc     XrdThrottle/XrdThrottleBucket.hh
 )
 
 target_link_libraries(
@@ -150,5 +174,5 @@ set_target_properties(
 # Install
 #-------------------------------------------------------------------------------
 install(
-  TARGETS ${LIB_XRD_PSS} ${LIB_XRD_BWM} ${LIB_XRD_GPFS} ${LIB_XRD_ZCRC32} ${LIB_XRD_THROTTLE} ${LIB_XRD_N2NO2P}
+  TARGETS ${LIB_XRD_PSS} ${LIB_XRD_TPCCL} ${LIB_XRD_BWM} ${LIB_XRD_GPFS} ${LIB_XRD_ZCRC32} ${LIB_XRD_THROTTLE} ${LIB_XRD_N2NO2P}
   LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR} )
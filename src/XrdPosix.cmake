@@ -22,10 +22,12 @@ add_library(
   XrdPosix/XrdPosixDir.cc          XrdPosix/XrdPosixDir.hh
   XrdPosix/XrdPosixFile.cc         XrdPosix/XrdPosixFile.hh
   XrdPosix/XrdPosixFileRH.cc       XrdPosix/XrdPosixFileRH.hh
+  XrdPosix/XrdPosixHedge.cc        XrdPosix/XrdPosixHedge.hh
   XrdPosix/XrdPosixMap.cc          XrdPosix/XrdPosixMap.hh
   XrdPosix/XrdPosixObject.cc       XrdPosix/XrdPosixObject.hh
                                    XrdPosix/XrdPosixObjGuard.hh
   XrdPosix/XrdPosixPrepIO.cc       XrdPosix/XrdPosixPrepIO.hh
+  XrdPosix/XrdPosixSeqIO.cc        XrdPosix/XrdPosixSeqIO.hh
                                    XrdPosix/XrdPosixTrace.hh
   XrdPosix/XrdPosixXrootd.cc       XrdPosix/XrdPosixXrootd.hh
   XrdPosix/XrdPosixXrootdPath.cc   XrdPosix/XrdPosixXrootdPath.hh
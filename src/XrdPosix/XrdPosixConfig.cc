@@ -35,6 +35,7 @@
 
 #include "XrdOuc/XrdOucCache2.hh"
 #include "XrdOuc/XrdOucCacheDram.hh"
+#include "XrdOuc/XrdOucCacheShm.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucPsx.hh"
 #include "XrdOuc/XrdOucTList.hh"
@@ -42,8 +43,10 @@
 #include "XrdPosix/XrdPosixCacheBC.hh"
 #include "XrdPosix/XrdPosixConfig.hh"
 #include "XrdPosix/XrdPosixFileRH.hh"
+#include "XrdPosix/XrdPosixHedge.hh"
 #include "XrdPosix/XrdPosixMap.hh"
 #include "XrdPosix/XrdPosixPrepIO.hh"
+#include "XrdPosix/XrdPosixSeqIO.hh"
 #include "XrdPosix/XrdPosixTrace.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 #include "XrdPosix/XrdPosixXrootdPath.hh"
@@ -106,6 +109,7 @@ void XrdPosixConfig::EnvInfo(XrdOucEnv &theEnv)
 // optsf=<val> - optimize structured file: 1 = all, 0 = off, .<sfx> specific
 // optwr=1     - cache can be written to.
 // pagesz=n    - individual byte size of a page (can be suffized in k, m, g).
+// shmname=<n> - use the shared memory cache <n> (see XrdOucCacheShm.hh).
 //
 
 void XrdPosixConfig::initEnv(char *eData)
@@ -167,6 +171,17 @@ void XrdPosixConfig::initEnv(char *eData)
       myParms.Options |= XrdOucCache::canPreRead;
 // if ((tP = theEnv.Get("optwr")) && *tP && *tP != '0') isRW = 1;
 
+// A shared memory cache, if wanted, replaces whatever cache implementation
+// was to be used.
+//
+   if ((tP = theEnv.Get("shmname")) && *tP)
+      {XrdOucCacheShm *shmCache;
+       if (!(shmCache = XrdOucCacheShm::Create(myParms, tP)))
+          {DMSG("initEnv", strerror(errno) <<" creating shared cache " <<tP);}
+          else XrdPosixGlobals::theCache = new XrdPosixCacheBC(shmCache);
+       return;
+      }
+
 // Use the default cache if one was not provided
 //
    if (!XrdPosixGlobals::myCache) XrdPosixGlobals::myCache = &dramCache;
@@ -252,6 +267,16 @@ void XrdPosixConfig::SetConfig(XrdOucPsx &parms)
        XrdPosixGlobals::ddInterval = (parms.cioWait  < 10 ? 10 : parms.cioWait);
       }
 
+// Enable hedged reads if so wanted
+//
+   if (parms.hedgePct > 0)
+      XrdPosixHedge::Configure(parms.hedgePct, parms.hedgeMin, parms.hedgeMax);
+
+// Enable read-ahead and write-behind if so wanted
+//
+   if (parms.raSize > 0 || parms.wbSize > 0)
+      XrdPosixSeqIO::Configure(parms.raSize, parms.wbSize, parms.wbNum);
+
 // Handle the caching options
 //
         if (parms.theCache2)
@@ -40,7 +40,9 @@
 #include "XrdPosix/XrdPosixCallBack.hh"
 #include "XrdPosix/XrdPosixFile.hh"
 #include "XrdPosix/XrdPosixFileRH.hh"
+#include "XrdPosix/XrdPosixHedge.hh"
 #include "XrdPosix/XrdPosixPrepIO.hh"
+#include "XrdPosix/XrdPosixSeqIO.hh"
 #include "XrdPosix/XrdPosixTrace.hh"
 #include "XrdPosix/XrdPosixXrootdPath.hh"
 
@@ -87,10 +89,11 @@ int            XrdPosixFile::ddNum    =  0;
 
 XrdPosixFile::XrdPosixFile(bool &aOK, const char *path, XrdPosixCallBack *cbP,
                            int Opts)
-             : XCio((XrdOucCacheIO2 *)this), PrepIO(0),
+             : XCio((XrdOucCacheIO2 *)this), PrepIO(0), hedgeP(0), seqP(0),
                mySize(0), myMtime(0), myInode(0), myMode(0),
                theCB(cbP), fLoc(0), cOpt(0),
-               isStream(Opts & isStrm ? 1 : 0)
+               isStream(Opts & isStrm ? 1 : 0),
+               canHedge(Opts & isUpdt ? 0 : 1)
 {
 // Handle path generation. This is trickt as we may have two namespaces. One
 // for the origin and one for the cache.
@@ -111,6 +114,11 @@ XrdPosixFile::XrdPosixFile(bool &aOK, const char *path, XrdPosixCallBack *cbP,
 // Set cache update option
 //
    if (Opts & isUpdt) cOpt |= XrdOucCache::optRW;
+
+// Set up read-ahead or write-behind, as configured
+//
+   if (XrdPosixSeqIO::Enabled(Opts & isUpdt))
+      seqP = new XrdPosixSeqIO(this, Opts & isUpdt);
 }
   
 /******************************************************************************/
@@ -127,9 +135,11 @@ XrdPosixFile::~XrdPosixFile()
 //
    if (clFile.IsOpen()) {XrdCl::XRootDStatus status = clFile.Close();};
 
-// Get rid of defered open object
+// Get rid of defered open object and any hedging state
 //
    if (PrepIO) delete PrepIO;
+   if (hedgeP) delete hedgeP;
+   if (seqP)   delete seqP;
 
 // Free the path and location information
 //
@@ -365,6 +375,18 @@ int XrdPosixFile::Read (char *Buff, long long Offs, int Len)
 {
    XrdCl::XRootDStatus Status;
    uint32_t bytes;
+   int rc;
+
+// Use read-ahead if we can
+//
+   if (seqP && seqP->Read(Buff, Offs, Len, rc)) return rc;
+
+// Hedge the read if so wanted
+//
+   if (canHedge && XrdPosixHedge::Enabled())
+      {XrdOucIOVec ioV = {Offs, Len, 0, Buff};
+       return XrdPosixHedge::Read(this, &ioV, 1);
+      }
 
 // Issue read and return appropriately
 //
@@ -382,8 +404,9 @@ void XrdPosixFile::Read (XrdOucCacheIOCB &iocb, char *buff, long long offs,
    XrdPosixFileRH *rhp =  XrdPosixFileRH::Alloc(&iocb, this, offs, rlen,
                                                 XrdPosixFileRH::isRead);
 
-// Issue read
+// Issue read after any write-behind completes
 //
+   if (seqP) seqP->Drain();
    Status = clFile.Read((uint64_t)offs, (uint32_t)rlen, buff, rhp);
 
 // Check status
@@ -402,6 +425,15 @@ int XrdPosixFile::ReadV (const XrdOucIOVec *readV, int n)
    XrdCl::VectorReadInfo *vrInfo = 0;
    int nbytes = 0;
 
+// Make sure any write-behind completes
+//
+   if (seqP) seqP->Drain();
+
+// Hedge the readv if so wanted
+//
+   if (canHedge && XrdPosixHedge::Enabled())
+      return XrdPosixHedge::Read(this, readV, n);
+
 // Copy in the vector (would be nice if we didn't need to do this)
 //
    chunkVec.reserve(n);
@@ -443,8 +475,9 @@ void XrdPosixFile::ReadV(XrdOucCacheIOCB &iocb, const XrdOucIOVec *readV, int n)
                                            ));
        }
 
-// Issue the readv.
+// Issue the readv after any write-behind completes
 //
+   if (seqP) seqP->Drain();
    XrdPosixFileRH *rhp =  XrdPosixFileRH::Alloc(&iocb, this, 0, nbytes,
                                                 XrdPosixFileRH::isReadV);
    Status = clFile.VectorRead(chunkVec, (void *)0, rhp);
@@ -487,14 +520,25 @@ bool XrdPosixFile::Stat(XrdCl::XRootDStatus &Status, bool force)
 /*                                  S y n c                                   */
 /******************************************************************************/
 
+int XrdPosixFile::Sync()
+{
+// Any write-behind must complete, and its errors are reported, first
+//
+   if (seqP && seqP->Drain(true)) return -1;
+   return XrdPosixMap::Result(clFile.Sync());
+}
+
+/******************************************************************************/
+
 void XrdPosixFile::Sync(XrdOucCacheIOCB &iocb)
 {
    XrdCl::XRootDStatus Status;
    XrdPosixFileRH *rhp =  XrdPosixFileRH::Alloc(&iocb, this, 0, 0,
                                                 XrdPosixFileRH::nonIO);
 
-// Issue read
+// Issue sync after any write-behind completes, reporting its errors
 //
+   if (seqP && seqP->Drain(true)) {rhp->Sched(-errno); return;}
    Status = clFile.Sync(rhp);
 
 // Check status
@@ -502,6 +546,18 @@ void XrdPosixFile::Sync(XrdOucCacheIOCB &iocb)
    if (!Status.IsOK()) rhp->Sched(-XrdPosixMap::Result(Status));
 }
   
+/******************************************************************************/
+/*                                 T r u n c                                  */
+/******************************************************************************/
+
+int XrdPosixFile::Trunc(long long Offset)
+{
+// Any write-behind must complete, and its errors are reported, first
+//
+   if (seqP && seqP->Drain(true)) return -1;
+   return XrdPosixMap::Result(clFile.Truncate((uint64_t)Offset));
+}
+  
 /******************************************************************************/
 /*                                 W r i t e                                  */
 /******************************************************************************/
@@ -509,6 +565,11 @@ void XrdPosixFile::Sync(XrdOucCacheIOCB &iocb)
 int XrdPosixFile::Write(char *Buff, long long Offs, int Len)
 {
    XrdCl::XRootDStatus Status;
+   int rc;
+
+// Use write-behind if we can
+//
+   if (seqP && seqP->Write(Buff, Offs, Len, rc)) return rc;
 
 // Issue read and return appropriately
 //
@@ -526,8 +587,9 @@ void XrdPosixFile::Write(XrdOucCacheIOCB &iocb, char *buff, long long offs,
    XrdPosixFileRH *rhp =  XrdPosixFileRH::Alloc(&iocb, this, offs, wlen,
                                                 XrdPosixFileRH::isWrite);
 
-// Issue read
+// Issue write after any write-behind completes
 //
+   if (seqP) seqP->Drain();
    Status = clFile.Write((uint64_t)offs, (uint32_t)wlen, buff, rhp);
 
 // Check status
@@ -53,7 +53,9 @@
 /******************************************************************************/
 
 class XrdPosixCallBack;
+class XrdPosixHedge;
 class XrdPosixPrepIO;
+class XrdPosixSeqIO;
 
 class XrdPosixFile : public XrdPosixObject, 
                      public XrdOucCacheIO2,
@@ -64,6 +66,8 @@ public:
 
 XrdOucCacheIO2 *XCio;
 XrdPosixPrepIO *PrepIO;
+XrdPosixHedge  *hedgeP;
+XrdPosixSeqIO  *seqP;
 XrdCl::File     clFile;
 
        long long     addOffset(long long offs, int updtSz=0)
@@ -130,12 +134,11 @@ static void          DelayedDestroy(XrdPosixFile *fp);
 
        bool          Stat(XrdCl::XRootDStatus &Status, bool force=false);
 
-       int           Sync() {return XrdPosixMap::Result(clFile.Sync());}
+       int           Sync();
 
        void          Sync(XrdOucCacheIOCB &iocb);
 
-       int           Trunc(long long Offset)
-                          {return XrdPosixMap::Result(clFile.Truncate((uint64_t)Offset));}
+       int           Trunc(long long Offset);
 
        void          UpdtSize(size_t newsz)
                               {updMutex.Lock();
@@ -191,5 +194,6 @@ char       *fOpen;
 char       *fLoc;
 union {int  cOpt; int numTries;};
 char        isStream;
+char        canHedge;
 };
 #endif
@@ -0,0 +1,416 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d P o s i x H e d g e . c c                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClFileSystem.hh"
+#include "XrdCl/XrdClURL.hh"
+#include "XrdCl/XrdClXRootDResponses.hh"
+#include "XrdNet/XrdNetAddr.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
+#include "XrdPosix/XrdPosixFile.hh"
+#include "XrdPosix/XrdPosixHedge.hh"
+#include "XrdPosix/XrdPosixMap.hh"
+#include "XrdPosix/XrdPosixTrace.hh"
+
+/******************************************************************************/
+/*                        S t a t i c   M e m b e r s                         */
+/******************************************************************************/
+
+XrdSysMutex XrdPosixHedge::histMutex;
+long long   XrdPosixHedge::histSum  = 0;
+int         XrdPosixHedge::histBin[XrdPosixHedge::numBins] = {0};
+int         XrdPosixHedge::threshUS = 0;
+int         XrdPosixHedge::hedgePct = 95;
+int         XrdPosixHedge::hedgeMin = 20;
+int         XrdPosixHedge::hedgeMax = 2000;
+bool        XrdPosixHedge::isOn     = false;
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+// The number of samples needed before the percentile is trusted and the
+// number after which the histogram is aged.
+//
+static const int minSamples = 64;
+static const int maxSamples = 4096;
+
+long long Now()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return static_cast<long long>(ts.tv_sec)*1000000 + ts.tv_nsec/1000;
+}
+
+// A hedged read. It is shared by the caller and every request sent for it;
+// the last one to let go of it deletes it.
+//
+class HedgeReq
+{
+public:
+
+XrdSysCondVar       reqCV;
+XrdCl::XRootDStatus reqStat[2];
+char               *reqBuff[2];
+int                 reqDone[2];
+int                 reqGot[2];
+int                 reqBytes;
+int                 numRefs;
+
+void  Drop() {bool last;
+              reqCV.Lock(); last = (--numRefs == 0); reqCV.UnLock();
+              if (last) delete this;
+             }
+
+      HedgeReq(int bytes) : reqCV(0), reqBytes(bytes), numRefs(1)
+              {reqBuff[0] = reqBuff[1] = 0; reqDone[0] = reqDone[1] = 0;
+               reqGot[0]  = reqGot[1]  = bytes;
+              }
+     ~HedgeReq() {if (reqBuff[0]) free(reqBuff[0]);
+                  if (reqBuff[1]) free(reqBuff[1]);
+                 }
+};
+
+// The response handler for one of the requests of a hedged read. A plain read
+// may come back short, a vector read either reads everything or fails.
+//
+class HedgeRH : public XrdCl::ResponseHandler
+{
+public:
+
+void HandleResponse(XrdCl::XRootDStatus *status, XrdCl::AnyObject *response)
+       {XrdCl::ChunkInfo *cInfo = 0;
+        theReq->reqCV.Lock();
+        theReq->reqStat[theIdx] = *status;
+        if (status->IsOK() && response && isRead)
+           {response->Get(cInfo);
+            if (cInfo) theReq->reqGot[theIdx] = cInfo->length;
+           }
+        theReq->reqDone[theIdx] = 1;
+        theReq->reqCV.Signal();
+        theReq->reqCV.UnLock();
+        delete status;
+        delete response;
+        theReq->Drop();
+        theFile->unRef();
+        delete this;
+       }
+
+     HedgeRH(HedgeReq *rP, XrdPosixFile *fP, int idx, bool rd)
+            : theReq(rP), theFile(fP), theIdx(idx), isRead(rd) {}
+    ~HedgeRH() {}
+
+HedgeReq     *theReq;
+XrdPosixFile *theFile;
+int           theIdx;
+bool          isRead;
+};
+
+// Send the read to the given file. The data goes into a private buffer laid
+// out in the order of the vector.
+//
+bool Issue(XrdPosixFile *fp, XrdCl::File &theFile, HedgeReq *rP, int idx,
+           const XrdOucIOVec *readV, int n)
+{
+   XrdCl::XRootDStatus Status;
+   HedgeRH *rhP;
+   char *bP;
+
+   if (!(bP = rP->reqBuff[idx] = (char *)malloc(rP->reqBytes ? rP->reqBytes:1)))
+      {rP->reqStat[idx] = XrdCl::XRootDStatus(XrdCl::stError,
+                                              XrdCl::errOSError, ENOMEM);
+       rP->reqDone[idx] = 1;
+       return false;
+      }
+
+   rP->reqCV.Lock(); rP->numRefs++; rP->reqCV.UnLock();
+   fp->Ref();
+   rhP = new HedgeRH(rP, fp, idx, n == 1);
+
+   if (n == 1)
+      Status = theFile.Read((uint64_t)readV->offset, (uint32_t)readV->size,
+                            bP, rhP);
+      else {XrdCl::ChunkList chunkVec;
+            chunkVec.reserve(n);
+            for (int i = 0; i < n; i++)
+                {chunkVec.push_back(XrdCl::ChunkInfo((uint64_t)readV[i].offset,
+                                                     (uint32_t)readV[i].size,
+                                                     (void   *)bP));
+                 bP += readV[i].size;
+                }
+            Status = theFile.VectorRead(chunkVec, (void *)0, rhP);
+           }
+
+// If the request could not be sent, the handler will never be called
+//
+   if (!Status.IsOK())
+      {rP->reqCV.Lock();
+       rP->reqStat[idx] = Status;
+       rP->reqDone[idx] = 1;
+       rP->numRefs--;
+       rP->reqCV.UnLock();
+       fp->unRef();
+       delete rhP;
+       return false;
+      }
+   return true;
+}
+}
+
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+XrdPosixHedge::~XrdPosixHedge()
+{
+   if (altFile)
+      {if (altFile->IsOpen()) {XrdCl::XRootDStatus Status = altFile->Close();}
+       delete altFile;
+      }
+}
+
+/******************************************************************************/
+/*                             C o n f i g u r e                              */
+/******************************************************************************/
+
+void XrdPosixHedge::Configure(int pct, int minMS, int maxMS)
+{
+   hedgePct = (pct < 1 ? 1 : (pct > 99 ? 99 : pct));
+   hedgeMin = (minMS < 1 ? 1 : minMS);
+   hedgeMax = (maxMS < hedgeMin ? hedgeMin : maxMS);
+   isOn     = true;
+}
+
+/******************************************************************************/
+/*                                  R e a d                                   */
+/******************************************************************************/
+
+int XrdPosixHedge::Read(XrdPosixFile *fp, const XrdOucIOVec *readV, int n)
+{
+   EPNAME("Hedge");
+   XrdPosixHedge *hP;
+   XrdCl::File   *altF = 0;
+   HedgeReq      *rP;
+   long long      tBeg = Now(), tWait;
+   int            i, bytes = 0, win = -1, issued = 1;
+   bool           findAlt = false;
+
+// Get the hedge state for this file
+//
+   fp->updLock();
+   if (!(hP = fp->hedgeP)) hP = fp->hedgeP = new XrdPosixHedge;
+   fp->updUnLock();
+
+// Send the read to the primary
+//
+   for (i = 0; i < n; i++) bytes += readV[i].size;
+   rP = new HedgeReq(bytes);
+   Issue(fp, fp->clFile, rP, 0, readV, n);
+
+// Wait for it up to the threshold
+//
+   rP->reqCV.Lock();
+   tWait = Threshold();
+   while(!rP->reqDone[0])
+        {long long tLeft = tWait - (Now() - tBeg);
+         if (tLeft <= 0) break;
+         rP->reqCV.WaitMS(static_cast<int>((tLeft+999)/1000));
+        }
+
+// If the primary is still outstanding send the read to the alternate, should
+// we have one. If we don't, start looking for one for subsequent reads.
+//
+   if (!rP->reqDone[0])
+      {hP->altMutex.Lock();
+       if (hP->altState == altOpen) altF = hP->altFile;
+          else if (hP->altState == altNone)
+                  {hP->altState = altFind; findAlt = true;}
+       hP->altMutex.UnLock();
+       if (altF)
+          {rP->reqCV.UnLock();
+           if (Issue(fp, *altF, rP, 1, readV, n)) issued = 2;
+           rP->reqCV.Lock();
+           DEBUG("read stalled " <<(Now()-tBeg)/1000 <<"ms; hedged to alternate "
+                 <<fp->Origin());
+          }
+      }
+
+// Wait for the first successful response or for everything to have failed
+//
+   do {for (i = 0; i < issued; i++)
+           if (rP->reqDone[i] && rP->reqStat[i].IsOK()) {win = i; break;}
+       if (win >= 0) break;
+       for (i = 0; i < issued && rP->reqDone[i]; i++) {}
+       if (i >= issued) break;
+       rP->reqCV.Wait();
+      } while(1);
+   rP->reqCV.UnLock();
+
+// Start looking for an alternate if we need to. The thread holds a reference
+// to the file so the file cannot go away underneath it.
+//
+   if (findAlt)
+      {pthread_t tid;
+       fp->Ref();
+       if (XrdSysThread::Run(&tid, XrdPosixHedge::FindAlt, (void *)fp,
+                             0, "PosixHedge"))
+          {fp->unRef();
+           hP->altMutex.Lock(); hP->altState = altFail; hP->altMutex.UnLock();
+          }
+      }
+
+// Copy out the data from the winner or return the primary's error. This is
+// unlocked as nobody writes into a completed request's buffer.
+//
+   if (win < 0) bytes = XrdPosixMap::Result(rP->reqStat[0]);
+      else {char *bP = rP->reqBuff[win];
+            Record(Now() - tBeg);
+            if (n == 1) memcpy(readV->data, bP, (bytes = rP->reqGot[win]));
+               else for (i = 0; i < n; i++)
+                        {memcpy(readV[i].data, bP, readV[i].size);
+                         bP += readV[i].size;
+                        }
+            if (win) DEBUG("alternate won for " <<fp->Origin());
+           }
+
+// All done
+//
+   rP->Drop();
+   return bytes;
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                               F i n d A l t                                */
+/******************************************************************************/
+
+void *XrdPosixHedge::FindAlt(void *arg)
+{
+   EPNAME("HedgeFind");
+   XrdPosixFile  *fp = (XrdPosixFile *)arg;
+   XrdPosixHedge *hP = fp->hedgeP;
+   XrdCl::LocationInfo *locInfo = 0;
+   XrdCl::File   *altF = 0;
+   XrdNetAddr     curAddr, locAddr;
+   std::string    curNode, altNode;
+
+// Find out where we are now and where else the file is
+//
+   XrdCl::URL theURL(fp->Origin());
+   XrdCl::FileSystem theFS(theURL);
+   if (fp->clFile.GetProperty("DataServer", curNode)
+   &&  !curAddr.Set(curNode.substr(curNode.find('@')+1).c_str())
+   &&  theFS.DeepLocate(theURL.GetPath(), XrdCl::OpenFlags::None,
+                        locInfo).IsOK() && locInfo)
+      {XrdCl::LocationInfo::Iterator it;
+       for (it = locInfo->Begin(); it != locInfo->End(); it++)
+           {if (!it->IsServer() || locAddr.Set(it->GetAddress().c_str()))
+               continue;
+            if (!locAddr.Same(&curAddr, true))
+               {altNode = it->GetAddress(); break;}
+           }
+      }
+   delete locInfo;
+
+// Open the alternate, if we found one
+//
+   if (!altNode.empty())
+      {XrdCl::URL altURL(theURL);
+       XrdCl::URL altHP("root://" + altNode);
+       altURL.SetHostPort(altHP.GetHostName(), altHP.GetPort());
+       altF = new XrdCl::File(false);
+       if (!altF->Open(altURL.GetURL(), XrdCl::OpenFlags::Read).IsOK())
+          {delete altF; altF = 0;}
+      }
+   DEBUG((altF ? "using " : "no alternate for ") <<fp->Origin()
+         <<(altF ? " at " : "") <<(altF ? altNode.c_str() : ""));
+
+// Record the outcome and let go of the file
+//
+   hP->altMutex.Lock();
+   hP->altFile  = altF;
+   hP->altState = (altF ? altOpen : altFail);
+   hP->altMutex.UnLock();
+   fp->unRef();
+   return (void *)0;
+}
+
+/******************************************************************************/
+/*                                R e c o r d                                 */
+/******************************************************************************/
+
+void XrdPosixHedge::Record(long long usec)
+{
+   int i, bin = 0, need, cnt;
+
+// Bin i holds latencies below 2**i microseconds
+//
+   while(usec && bin < numBins-1) {usec >>= 1; bin++;}
+
+// Add the sample and age the histogram once in a while. Recompute the
+// threshold every so often.
+//
+   histMutex.Lock();
+   histBin[bin]++;
+   if (++histSum >= maxSamples)
+      {histSum = 0;
+       for (i = 0; i < numBins; i++) histSum += (histBin[i] >>= 1);
+      }
+   if (histSum >= minSamples && !(histSum & 15))
+      {need = static_cast<int>(histSum * hedgePct / 100);
+       for (i = 0, cnt = 0; i < numBins-1; i++)
+           if ((cnt += histBin[i]) >= need) break;
+       threshUS = (1 << i);
+      }
+   histMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                             T h r e s h o l d                              */
+/******************************************************************************/
+
+long long XrdPosixHedge::Threshold()
+{
+   long long tUS;
+
+   histMutex.Lock();
+   tUS = (histSum >= minSamples && threshUS ? threshUS : hedgeMax*1000LL);
+   histMutex.UnLock();
+
+   if (tUS < hedgeMin*1000LL) return hedgeMin*1000LL;
+   if (tUS > hedgeMax*1000LL) return hedgeMax*1000LL;
+   return tUS;
+}
@@ -0,0 +1,89 @@
+#ifndef __XRDPOSIXHEDGE_HH__
+#define __XRDPOSIXHEDGE_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d P o s i x H e d g e . h h                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdSys/XrdSysPthread.hh"
+
+/* XrdPosixHedge implements hedged reads for files opened read-only. A read is
+   first sent to the data server the file was opened at. Should it not complete
+   within the configured percentile of recent read latencies, the same read is
+   also sent to another replica of the file and whichever completes first is
+   used; the result of the other is discarded when it arrives (the client has
+   no way to cancel a request in flight). The alternate replica is found with
+   a deep locate at the origin the first time a read on the file stalls and it
+   is then opened in the background. Because either request may complete last
+   both read into private buffers and the data is copied to the caller's.
+*/
+
+struct XrdOucIOVec;
+class XrdPosixFile;
+
+namespace XrdCl {class File;}
+
+class XrdPosixHedge
+{
+public:
+
+// Set the hedging parameters; this enables hedging. The threshold is the pct
+// percentile of recent read latencies bounded by minMS and maxMS.
+//
+static void Configure(int pct, int minMS, int maxMS);
+
+static bool Enabled() {return isOn;}
+
+// Perform a hedged read of the n elements in readV. Returns the number of
+// bytes read or -1 with errno set, just as XrdPosixFile::Read() and ReadV().
+//
+static int  Read(XrdPosixFile *fp, const XrdOucIOVec *readV, int n);
+
+            XrdPosixHedge() : altFile(0), altState(altNone) {}
+           ~XrdPosixHedge();
+
+private:
+
+static void *FindAlt(void *fp);
+static void  Record(long long usec);
+static long long Threshold();
+
+enum altStat {altNone = 0, altFind, altOpen, altFail};
+
+XrdSysMutex  altMutex;
+XrdCl::File *altFile;
+altStat      altState;
+
+static const int    numBins = 32;
+static XrdSysMutex  histMutex;
+static long long    histSum;
+static int          histBin[numBins];
+static int          threshUS;
+static int          hedgePct;
+static int          hedgeMin;
+static int          hedgeMax;
+static bool         isOn;
+};
+#endif
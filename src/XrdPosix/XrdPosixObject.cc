@@ -30,6 +30,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sched.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
 
@@ -50,6 +51,8 @@ int              XrdPosixObject::baseFD   =  0;
 int              XrdPosixObject::freeFD   =  0;
 int              XrdPosixObject::posxFD   =  0;
 int              XrdPosixObject::devNull  = -1;
+unsigned int     XrdPosixObject::rcuIdx   =  0;
+int              XrdPosixObject::rcuCnt[2]= {0, 0};
 
 /******************************************************************************/
 /*                              A s s i g n F D                               */
@@ -77,8 +80,12 @@ bool XrdPosixObject::AssignFD(bool isStream)
           } while(1);
       }
 
-// Enter object in out vector of objects and assign it the FD
+// Enter object in out vector of objects and assign it the FD. It must be
+// complete before it shows up as there are readers that don't take the lock.
 //
+#ifdef HAVE_ATOMICS
+   __sync_synchronize();
+#endif
    myFiles[fd] = this;
    if (fd > highFD) highFD = fd;
    fdNum  = fd + baseFD;
@@ -125,11 +132,11 @@ do{if (fd >= lastFD || fd < baseFD)
        continue;
       }
 
-// If the global lock is to be held, then release the object lock as this
-// is a call to destroy the object and there is no need for the local lock.
+// If the global lock is to be held this is a call to release the object. We
+// keep it write locked as well so readers that found it in the table without
+// the global lock cannot lock it before it is out of the table for good.
 //
-   if (glk) oP->UnLock();
-      else  fdMutex.UnLock();
+   if (!glk) fdMutex.UnLock();
    return dP;
   } while(1);
 
@@ -150,6 +157,23 @@ XrdPosixFile *XrdPosixObject::File(int fd, bool glk)
    int  waitCount = 0;
    bool haveLock;
 
+#ifdef HAVE_ATOMICS
+// Ordinary lookups first try to get at the object without the global lock.
+// Objects are only deleted after they have been removed from the table and
+// every reader that may have seen them has left (see Quiesce()), so we can
+// safely look at whatever we find. Should the object be write locked we take
+// the long way around, as the object may be on its way out.
+//
+   if (!glk && fd < lastFD && fd >= baseFD)
+      {unsigned int idx = AtomicGet(rcuIdx) & 1;
+       AtomicInc(rcuCnt[idx]);
+       oP = ((XrdPosixObject * volatile *)myFiles)[fd - baseFD];
+       haveLock = oP && oP->Who(&fP) && oP->objMutex.CondReadLock();
+       AtomicDec(rcuCnt[idx]);
+       if (haveLock) return fP;
+      }
+#endif
+
 // Validate the fildes
 //
 do{if (fd >= lastFD || fd < baseFD)
@@ -176,11 +200,11 @@ do{if (fd >= lastFD || fd < baseFD)
        continue;
       }
 
-// If the global lock is to be held, then release the object lock as this
-// is a call to destroy the object and there is no need for the local lock.
+// If the global lock is to be held this is a call to release the object. We
+// keep it write locked as well so readers that found it in the table without
+// the global lock cannot lock it before it is out of the table for good.
 //
-   if (glk) oP->UnLock();
-      else  fdMutex.UnLock();
+   if (!glk) fdMutex.UnLock();
    return fP;
   } while(1);
 
@@ -259,6 +283,12 @@ void XrdPosixObject::Release(XrdPosixObject *oP, bool needlk)
        close(oP->fdNum);
       }
 
+// Wait for any reader that may have found the object without the global lock
+//
+#ifdef HAVE_ATOMICS
+   Quiesce();
+#endif
+
 // Zorch the object fd and release the global lock
 //
    oP->fdNum = -1;
@@ -280,6 +310,7 @@ XrdPosixDir *XrdPosixObject::ReleaseDir(int fd)
 // Release it and return the underlying object
 //
    Release((XrdPosixObject *)dP, false);
+   ((XrdPosixObject *)dP)->UnLock();
    return dP;
 }
 
@@ -298,9 +329,30 @@ XrdPosixFile *XrdPosixObject::ReleaseFile(int fd)
 // Release it and return the underlying object
 //
    Release((XrdPosixObject *)fP, false);
+   ((XrdPosixObject *)fP)->UnLock();
    return fP;
 }
   
+/******************************************************************************/
+/*                               Q u i e s c e                                */
+/******************************************************************************/
+
+// Must be called with the global lock held after an object was removed from
+// the table. Lock-free readers count themselves in one of two counters. We
+// drain each in turn, steering new readers to the other one, so we only wait
+// for readers that may have seen the object and those never block.
+//
+void XrdPosixObject::Quiesce()
+{
+   unsigned int idx;
+
+   for (int i = 0; i < 2; i++)
+       {idx = AtomicGet(rcuIdx) & 1;
+        AtomicInc(rcuIdx);
+        while(AtomicGet(rcuCnt[idx])) sched_yield();
+       }
+}
+  
 /******************************************************************************/
 /*                              S h u t d o w n                               */
 /******************************************************************************/
@@ -98,6 +98,8 @@ protected:
 
 private:
 
+static void             Quiesce();
+
 static XrdSysMutex      fdMutex;
 static XrdPosixObject **myFiles;
 static int              lastFD;
@@ -106,5 +108,7 @@ static int              baseFD;
 static int              freeFD;
 static int              posxFD;
 static int              devNull;
+static unsigned int     rcuIdx;
+static int              rcuCnt[2];
 };
 #endif
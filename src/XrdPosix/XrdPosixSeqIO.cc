@@ -0,0 +1,418 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d P o s i x S e q I O . c c                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClXRootDResponses.hh"
+#include "XrdPosix/XrdPosixFile.hh"
+#include "XrdPosix/XrdPosixMap.hh"
+#include "XrdPosix/XrdPosixSeqIO.hh"
+
+/******************************************************************************/
+/*                        S t a t i c   M e m b e r s                         */
+/******************************************************************************/
+
+int XrdPosixSeqIO::raSize = 0;
+int XrdPosixSeqIO::wbSize = 0;
+int XrdPosixSeqIO::wbMax  = 4;
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+// The response handler for a read-ahead or write-behind block. It holds a
+// reference to the file so that the file cannot go away while it is pending.
+//
+class SeqRH : public XrdCl::ResponseHandler
+{
+public:
+
+void HandleResponse(XrdCl::XRootDStatus *status, XrdCl::AnyObject *response)
+       {XrdPosixFile *fP = theFile;
+        int rc;
+        if (!status->IsOK()) {XrdPosixMap::Result(*status); rc = -errno;}
+           else if (!isRead) rc = theBlk->size;
+                   else {XrdCl::ChunkInfo *cInfo = 0;
+                         if (response) response->Get(cInfo);
+                         rc = (cInfo ? static_cast<int>(cInfo->length) : 0);
+                        }
+        theSeq->Done(theBlk, rc);
+        delete status;
+        delete response;
+        fP->unRef();
+        delete this;
+       }
+
+     SeqRH(XrdPosixSeqIO *sP, XrdPosixFile *fP, XrdPosixSeqIO::Block *bP,
+           bool rd) : theSeq(sP), theFile(fP), theBlk(bP), isRead(rd) {}
+    ~SeqRH() {}
+
+XrdPosixSeqIO        *theSeq;
+XrdPosixFile         *theFile;
+XrdPosixSeqIO::Block *theBlk;
+bool                  isRead;
+};
+}
+  
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdPosixSeqIO::XrdPosixSeqIO(XrdPosixFile *fp, bool isUpdt)
+             : ioCV(0), theFile(fp), raNext(0), wbCur(0), wbFree(0),
+               wbBusy(0), wbNum(0), wbErr(0), wbMode(isUpdt)
+{
+   memset(raBlk, 0, sizeof(raBlk));
+}
+
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+XrdPosixSeqIO::~XrdPosixSeqIO()
+{
+   Block *bP;
+
+// Nothing can be in flight as each pending block holds a file reference
+//
+   if (raBlk[0].buff) free(raBlk[0].buff);
+   if (raBlk[1].buff) free(raBlk[1].buff);
+   if (wbCur) {wbCur->next = wbFree; wbFree = wbCur;}
+   while((bP = wbFree)) {wbFree = bP->next; free(bP->buff); delete bP;}
+}
+
+/******************************************************************************/
+/*                             C o n f i g u r e                              */
+/******************************************************************************/
+
+void XrdPosixSeqIO::Configure(int rasz, int wbsz, int wbnum)
+{
+   raSize = (rasz  > 0 ? rasz  : 0);
+   wbSize = (wbsz  > 0 ? wbsz  : 0);
+   wbMax  = (wbnum > 0 ? wbnum : 1);
+}
+
+/******************************************************************************/
+/*                                  D o n e                                   */
+/******************************************************************************/
+
+void XrdPosixSeqIO::Done(Block *bP, int rc)
+{
+   ioCV.Lock();
+   Finish(bP, rc);
+   ioCV.UnLock();
+}
+
+/******************************************************************************/
+/*                                 D r a i n                                  */
+/******************************************************************************/
+
+int XrdPosixSeqIO::Drain(bool report)
+{
+   Block *bP;
+   int rc;
+
+// Push out the block being filled and wait for everything to complete
+//
+   ioCV.Lock();
+   if ((bP = wbCur)) {wbCur = 0; Dispatch(bP);}
+   while(wbBusy) ioCV.Wait();
+   rc = wbErr;
+   if (report) wbErr = 0;
+   ioCV.UnLock();
+
+   if (rc) {errno = rc; return -1;}
+   return 0;
+}
+  
+/******************************************************************************/
+/*                                  R e a d                                   */
+/******************************************************************************/
+
+bool XrdPosixSeqIO::Read(char *buff, long long offs, int rlen, int &rc)
+{
+   Block *bP;
+   long long pos, bOffs;
+   int avail, done = 0;
+
+// Reads of a file being updated must see every write that preceded them
+//
+   if (wbMode) {Drain(); return false;}
+
+// Large reads go straight through as do reads that are not sequential. Note
+// that a read that starts in one of our blocks is sequential enough.
+//
+   if (rlen <= 0 || rlen >= raSize) return false;
+   ioCV.Lock();
+   if (offs != raNext && !Find(offs))
+      {raNext = offs + rlen;
+       ioCV.UnLock();
+       return false;
+      }
+   raNext = offs + rlen;
+
+// Allocate our buffers the first time around
+//
+   if (!raBlk[0].buff)
+      {if (!(raBlk[0].buff = (char *)malloc(raSize))
+       ||  !(raBlk[1].buff = (char *)malloc(raSize)))
+          {if (raBlk[0].buff) {free(raBlk[0].buff); raBlk[0].buff = 0;}
+           ioCV.UnLock();
+           return false;
+          }
+      }
+
+// Copy out the data block by block, reading blocks as needed. As other threads
+// may be using the same blocks, we recheck everything after waiting.
+//
+   while(done < rlen)
+        {pos = offs + done;
+         if (!(bP = Find(pos)) && !(bP = Fetch(pos, 0)))
+            {ioCV.Wait(); continue;}
+         bOffs = bP->offs;
+         while(bP->busy) ioCV.Wait();
+         if (bP->offs != bOffs || !bP->size) continue;
+
+         // A failed block is dropped so that the data is read again next time
+         //
+         if (bP->rc < 0)
+            {if (!done) {errno = -bP->rc; done = -1;}
+             bP->size = 0;
+             break;
+            }
+
+         // A short block marks the end of the file. Otherwise, start reading
+         // the next block now that we have moved into this one.
+         //
+         if ((avail = static_cast<int>(bP->offs + bP->rc - pos)) <= 0) break;
+         if (bP->rc == bP->size) Fetch(bP->offs + bP->size, bP);
+         if (avail > rlen - done) avail = rlen - done;
+         memcpy(buff + done, bP->buff + (pos - bP->offs), avail);
+         done += avail;
+        }
+   ioCV.UnLock();
+
+// All done
+//
+   rc = done;
+   return true;
+}
+
+/******************************************************************************/
+/*                                 W r i t e                                  */
+/******************************************************************************/
+
+bool XrdPosixSeqIO::Write(char *buff, long long offs, int wlen, int &rc)
+{
+   Block *bP;
+
+// Only files open for update do write-behind
+//
+   if (!wbMode || wlen <= 0) return false;
+   ioCV.Lock();
+
+// Report any earlier failure. It is also reported by the next sync or close.
+//
+   if (wbErr) {ioCV.UnLock(); errno = wbErr; rc = -1; return true;}
+
+// Large writes go straight through once everything before them is written
+//
+   if (wlen >= wbSize)
+      {if ((bP = wbCur)) {wbCur = 0; Dispatch(bP);}
+       while(wbBusy) ioCV.Wait();
+       ioCV.UnLock();
+       return false;
+      }
+
+// Find a block to hold the data. We append to the current block when the write
+// follows it and fits. Otherwise, the current block is sent and a new one is
+// started, waiting for one to complete should too many be in flight.
+//
+   do {if (wbCur && offs == wbCur->offs + wbCur->size
+       &&  wbCur->size + wlen <= wbSize) break;
+       if ((bP = wbCur)) {wbCur = 0; Dispatch(bP); continue;}
+            if (wbFree) {bP = wbFree; wbFree = bP->next;}
+       else if (wbNum < wbMax)
+               {bP = new Block;
+                if (!(bP->buff = (char *)malloc(wbSize)))
+                   {delete bP; ioCV.UnLock(); errno = ENOMEM; rc = -1;
+                    return true;
+                   }
+                wbNum++;
+               }
+       else {ioCV.Wait(); continue;}
+       bP->offs = offs; bP->size = 0; bP->rc = 0; bP->busy = false;
+       wbCur = bP;
+       break;
+      } while(1);
+
+// Copy in the data and send the block along once it is full
+//
+   memcpy(wbCur->buff + wbCur->size, buff, wlen);
+   wbCur->size += wlen;
+   if (wbCur->size == wbSize) {bP = wbCur; wbCur = 0; Dispatch(bP);}
+   ioCV.UnLock();
+
+// All done
+//
+   rc = wlen;
+   return true;
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                              D i s p a t c h                               */
+/******************************************************************************/
+
+// Must be called with the ioCV lock held. The block must not be wbCur.
+//
+void XrdPosixSeqIO::Dispatch(Block *bP)
+{
+   XrdCl::XRootDStatus Status;
+   Block *xP;
+   SeqRH *rhP;
+
+// Wait for any block in flight that overlaps this one so that writes to the
+// same bytes complete in the order they were made.
+//
+   do {for (xP = wbBusy; xP; xP = xP->next)
+           if (xP->offs < bP->offs + bP->size && bP->offs < xP->offs + xP->size)
+              break;
+       if (!xP) break;
+       ioCV.Wait();
+      } while(1);
+
+// Place the block on the busy list and send it
+//
+   bP->busy = true;
+   bP->next = wbBusy;
+   wbBusy   = bP;
+   theFile->Ref();
+   rhP = new SeqRH(this, theFile, bP, false);
+   Status = theFile->clFile.Write((uint64_t)bP->offs, (uint32_t)bP->size,
+                                  bP->buff, rhP);
+
+// If the write could not be sent the handler will never be called
+//
+   if (!Status.IsOK())
+      {delete rhP;
+       theFile->unRef();
+       XrdPosixMap::Result(Status);
+       Finish(bP, -errno);
+      }
+}
+
+/******************************************************************************/
+/*                                 F e t c h                                  */
+/******************************************************************************/
+
+// Must be called with the ioCV lock held. Starts reading the block at offs into
+// a read-ahead block other than skip, unless some block already holds it.
+// Returns the block or nil if all of them are busy.
+//
+XrdPosixSeqIO::Block *XrdPosixSeqIO::Fetch(long long offs, Block *skip)
+{
+   XrdCl::XRootDStatus Status;
+   Block *bP;
+   SeqRH *rhP;
+
+// Find a block to use
+//
+   if ((bP = Find(offs))) return bP;
+        if (&raBlk[0] != skip && !raBlk[0].busy) bP = &raBlk[0];
+   else if (&raBlk[1] != skip && !raBlk[1].busy) bP = &raBlk[1];
+   else return 0;
+
+// Send the read
+//
+   bP->offs = offs;
+   bP->size = raSize;
+   bP->rc   = 0;
+   bP->busy = true;
+   theFile->Ref();
+   rhP = new SeqRH(this, theFile, bP, true);
+   Status = theFile->clFile.Read((uint64_t)offs, (uint32_t)raSize,
+                                 bP->buff, rhP);
+
+// If the read could not be sent the handler will never be called
+//
+   if (!Status.IsOK())
+      {delete rhP;
+       theFile->unRef();
+       XrdPosixMap::Result(Status);
+       bP->rc   = -errno;
+       bP->busy = false;
+      }
+   return bP;
+}
+
+/******************************************************************************/
+/*                                  F i n d                                   */
+/******************************************************************************/
+
+// Must be called with the ioCV lock held
+//
+XrdPosixSeqIO::Block *XrdPosixSeqIO::Find(long long offs)
+{
+   for (int i = 0; i < 2; i++)
+       if (raBlk[i].size && offs >= raBlk[i].offs
+       &&  offs < raBlk[i].offs + raBlk[i].size) return &raBlk[i];
+   return 0;
+}
+
+/******************************************************************************/
+/*                                F i n i s h                                 */
+/******************************************************************************/
+
+// Must be called with the ioCV lock held. Write-behind blocks go back to the
+// free list, the first write error being kept for later.
+//
+void XrdPosixSeqIO::Finish(Block *bP, int rc)
+{
+   Block *xP, *pP = 0;
+
+   bP->rc   = rc;
+   bP->busy = false;
+   if (wbMode)
+      {if (rc < 0 && !wbErr) wbErr = -rc;
+       for (xP = wbBusy; xP && xP != bP; xP = xP->next) pP = xP;
+       if (xP)
+          {if (pP) pP->next = bP->next;
+              else wbBusy   = bP->next;
+          }
+       bP->next = wbFree;
+       wbFree   = bP;
+      }
+   ioCV.Broadcast();
+}
@@ -0,0 +1,109 @@
+#ifndef __XRDPOSIXSEQIO_HH__
+#define __XRDPOSIXSEQIO_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d P o s i x S e q I O . h h                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdSys/XrdSysPthread.hh"
+
+/* XrdPosixSeqIO speeds up small sequential I/O. Files opened read-only get
+   double buffered read-ahead: once reads are found to be sequential the block
+   holding the requested data and the one after it are read asynchronously and
+   subsequent reads are served from them, the next block being requested as
+   soon as reading moves into the current one. Files opened for update get
+   write-behind: contiguous small writes are gathered into blocks that are
+   written asynchronously with a bound on the number of blocks in flight. A
+   block overlapping one still in flight waits for it so writes complete in
+   order. Write errors are reported by the next write and by the following
+   sync or close. Large requests always go straight through.
+*/
+
+class XrdPosixFile;
+
+class XrdPosixSeqIO
+{
+public:
+
+// Set the read-ahead and write-behind block sizes (0 disables the feature)
+// and the maximum number of write-behind blocks in flight.
+//
+static void Configure(int rasz, int wbsz, int wbnum);
+
+// Return true if the feature applicable to a file with the given update mode
+// is enabled.
+//
+static bool Enabled(bool isUpdt) {return (isUpdt ? wbSize : raSize) > 0;}
+
+// Wait for all write-behind blocks to complete. If report is true, pending
+// errors are returned and cleared. Returns 0 or -1 with errno set.
+//
+int         Drain(bool report=false);
+
+// Perform a read or write. Returns false if the request is not handled here
+// and must be done by the caller. Otherwise, rc is the number of bytes read or
+// written or -1 with errno set.
+//
+bool        Read (char *buff, long long offs, int rlen, int &rc);
+
+bool        Write(char *buff, long long offs, int wlen, int &rc);
+
+            XrdPosixSeqIO(XrdPosixFile *fp, bool isUpdt);
+           ~XrdPosixSeqIO();
+
+struct Block
+      {Block     *next;
+       char      *buff;
+       long long  offs;
+       int        size;
+       int        rc;
+       bool       busy;
+      };
+
+void        Done(Block *bP, int rc);
+
+private:
+
+void        Dispatch(Block *bP);
+Block      *Fetch(long long offs, Block *skip);
+Block      *Find(long long offs);
+void        Finish(Block *bP, int rc);
+
+XrdSysCondVar  ioCV;
+XrdPosixFile  *theFile;
+Block          raBlk[2];
+long long      raNext;
+Block         *wbCur;
+Block         *wbFree;
+Block         *wbBusy;
+int            wbNum;
+int            wbErr;
+bool           wbMode;
+
+static int     raSize;
+static int     wbSize;
+static int     wbMax;
+};
+#endif
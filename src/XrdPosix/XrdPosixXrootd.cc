@@ -65,6 +65,7 @@
 #include "XrdPosix/XrdPosixFileRH.hh"
 #include "XrdPosix/XrdPosixMap.hh"
 #include "XrdPosix/XrdPosixPrepIO.hh"
+#include "XrdPosix/XrdPosixSeqIO.hh"
 #include "XrdPosix/XrdPosixTrace.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 #include "XrdPosix/XrdPosixXrootdPath.hh"
@@ -253,6 +254,7 @@ int XrdPosixXrootd::Close(int fildes)
    EPNAME("Close");
    XrdCl::XRootDStatus Status;
    XrdPosixFile *fP;
+   int wbErr = 0;
    bool ret;
 
 // Map the file number to the file object. In the prcess we relese the file
@@ -261,6 +263,10 @@ int XrdPosixXrootd::Close(int fildes)
    if (!(fP = XrdPosixObject::ReleaseFile(fildes)))
       {errno = EBADF; return -1;}
 
+// Write out anything still held for write-behind. Its failure is the close's.
+//
+   if (fP->seqP && fP->seqP->Drain(true)) wbErr = errno;
+
 // Close the file if there is no active I/O (possible caching). Delete the
 // object if the close was successful (it might not be).
 //
@@ -276,6 +282,7 @@ int XrdPosixXrootd::Close(int fildes)
 
 // Return final result
 //
+   if (wbErr && ret) {errno = wbErr; return -1;}
    return (ret ? 0 : XrdPosixMap::Result(Status));
 }
 
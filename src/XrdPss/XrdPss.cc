@@ -50,6 +50,8 @@
 #include "XrdFfs/XrdFfsPosix.hh"
 #include "XrdNet/XrdNetSecurity.hh"
 #include "XrdPss/XrdPss.hh"
+#include "XrdPss/XrdPssAioCB.hh"
+#include "XrdPss/XrdPssPool.hh"
 #include "XrdPosix/XrdPosixConfig.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 
@@ -85,6 +87,8 @@ static XrdScheduler *schedP = 0;
 
        XrdOucSid    *sidP   = 0;
 
+       XrdPssPool   *poolP  = 0;
+
 static const char *ofslclCGI = "ofs.lcl=1";
 static const int   ofslclCGL = strlen(ofslclCGI);
 
@@ -650,7 +654,8 @@ int XrdPssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
 {
    unsigned long long popts = XrdPssSys::XPList.Find(path);
    const char *Cgi;
-   char pbuff[PBsz], cbuff[CBsz];
+   const char *theIdent = tident;
+   char pbuff[PBsz], cbuff[CBsz], idBuff[24];
    int CgiLen, retc;
    bool tpcMode = (Oflag & O_NOFOLLOW) != 0;
    bool rwMode  = (Oflag & (O_WRONLY | O_RDWR | O_APPEND)) != 0;
@@ -697,9 +702,14 @@ int XrdPssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
           }
       }
 
+// If we have a channel pool then use one of its (warm) channels
+//
+   if (poolP && !XrdPssSys::outProxy)
+      theIdent = poolP->Ident(tident, idBuff, sizeof(idBuff));
+
 // Convert path to URL
 //
-   if (!XrdPssSys::P2URL(retc,pbuff,PBsz,path,0,Cgi,CgiLen,tident,
+   if (!XrdPssSys::P2URL(retc,pbuff,PBsz,path,0,Cgi,CgiLen,theIdent,
                          XrdPssSys::xLfn2Pfn)) return retc;
 
 // Try to open and if we failed, return an error
@@ -809,13 +819,31 @@ ssize_t XrdPssFile::ReadV(XrdOucIOVec     *readV,     // In
   Output:   Returns the number of bytes read upon success and -errno upon failure.
             If the number of bytes read is less than requested, it is considered
             an error.
+
+  Notes:    Large vectors are split into up to rvSplit pieces that are sent to
+            the origin asynchronously so that they are all in flight at once.
+            We only wait for the last one to come back.
 */
 {
+    static const int minPiece = 16;
     ssize_t retval;
+    int i, n, pieces;
 
     if (fd < 0) return (ssize_t)-XRDOSS_E8004;
 
-    return (retval = XrdPosixXrootd::VRead(fd, readV, readCount)) < 0 ? (ssize_t)-errno : retval;;
+    if ((pieces = readCount/minPiece) > XrdPssSys::rvSplit)
+       pieces = XrdPssSys::rvSplit;
+    if (pieces < 2)
+       return (retval = XrdPosixXrootd::VRead(fd, readV, readCount)) < 0
+              ? (ssize_t)-errno : retval;
+
+    XrdPssVecCB vecCB(pieces);
+    for (i = 0; i < pieces; i++)
+        {n = readCount/pieces + (i < readCount%pieces ? 1 : 0);
+         XrdPosixXrootd::VRead(fd, readV, n, &vecCB);
+         readV += n;
+        }
+    return vecCB.Wait();
 }
 
 /******************************************************************************/
@@ -174,6 +174,10 @@ static const char  *hdrData;
 static const char  *urlRdr;
 static int          Streams;
 static int          Workers;
+static int          rvSplit;
+static int          PoolNum;
+static int          PoolStby;
+static int          PoolChk;
 static int          Trace;
 
 static bool         outProxy; // True means outgoing proxy
@@ -210,5 +214,6 @@ int    xdef( XrdSysError *Eroute, XrdOucStream &Config);
 int    xexp( XrdSysError *Eroute, XrdOucStream &Config);
 int    xperm(XrdSysError *errp,   XrdOucStream &Config);
 int    xorig(XrdSysError *errp,   XrdOucStream &Config);
+int    xpool(XrdSysError *errp,   XrdOucStream &Config);
 };
 #endif
@@ -105,3 +105,35 @@ void XrdPssAioCB::Recycle()
            }
    myMutex.UnLock();
 }
+
+/******************************************************************************/
+/*                 X r d P s s V e c C B : : C o m p l e t e                  */
+/******************************************************************************/
+
+void XrdPssVecCB::Complete(ssize_t result)
+{
+   bool isLast;
+
+// Accumulate the result, the first error wins
+//
+   myMutex.Lock();
+   if (result < 0) {if (!theRC) theRC = (errno ? -errno : -EIO);}
+      else numBytes += result;
+   isLast = (--numLeft == 0);
+   myMutex.UnLock();
+
+// Wake up the waiter once all the pieces are in. The waiter owns this object
+// so we must not touch it after posting.
+//
+   if (isLast) theSem.Post();
+}
+
+/******************************************************************************/
+/*                     X r d P s s V e c C B : : W a i t                      */
+/******************************************************************************/
+
+ssize_t XrdPssVecCB::Wait()
+{
+   theSem.Wait();
+   return (theRC ? (ssize_t)theRC : numBytes);
+}
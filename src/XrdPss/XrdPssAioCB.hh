@@ -61,4 +61,33 @@ union  {XrdSfsAio   *theAIOP;
        };
 bool                 isWrite;
 };
+
+/******************************************************************************/
+/*                     C l a s s   X r d P s s V e c C B                      */
+/******************************************************************************/
+
+// XrdPssVecCB collects the results of a vector read issued to the origin as
+// several asynchronous pieces. The caller issues all of the pieces and then
+// waits once for every one of them to complete.
+  
+class XrdPssVecCB : public XrdPosixCallBackIO
+{
+public:
+
+virtual void         Complete(ssize_t Result);
+
+        ssize_t      Wait();
+
+             XrdPssVecCB(int pieces) : theSem(0), numBytes(0), numLeft(pieces),
+                                       theRC(0) {}
+virtual     ~XrdPssVecCB() {}
+
+private:
+
+XrdSysMutex          myMutex;
+XrdSysSemaphore      theSem;
+ssize_t              numBytes;
+int                  numLeft;
+int                  theRC;
+};
 #endif
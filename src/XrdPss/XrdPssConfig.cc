@@ -49,6 +49,7 @@
 #include "XrdNet/XrdNetSecurity.hh"
 
 #include "XrdPss/XrdPss.hh"
+#include "XrdPss/XrdPssPool.hh"
 
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysHeaders.hh"
@@ -105,6 +106,10 @@ const char  *XrdPssSys::hdrData   =  0;
 const char  *XrdPssSys::urlRdr    =  0;
 int          XrdPssSys::Streams   =512;
 int          XrdPssSys::Workers   = 16;
+int          XrdPssSys::rvSplit   =  4;
+int          XrdPssSys::PoolNum   =  0;
+int          XrdPssSys::PoolStby  =  0;
+int          XrdPssSys::PoolChk   = 60;
 
 char         XrdPssSys::allChmod  =  0;
 char         XrdPssSys::allMkdir  =  0;
@@ -127,6 +132,8 @@ extern XrdSysError      eDest;
 
 extern XrdOucSid       *sidP;
 
+extern XrdPssPool      *poolP;
+
 static const int maxHLen = 1024;
 }
 
@@ -301,6 +308,13 @@ int XrdPssSys::Configure(const char *cfn)
    urlPlen = sprintf(theRdr, hdrData, "", "", "", "", "", "", "", "");
    urlPlain= strdup(theRdr);
 
+// Start the channel pool if so wanted
+//
+   if (PoolNum)
+      {poolP = new XrdPssPool(PoolNum, PoolStby, PoolChk);
+       if (!poolP->Start(eDest, hdrData)) return 1;
+      }
+
 // Export the origin
 //
    theRdr[urlPlen-1] = 0;
@@ -455,11 +469,15 @@ int XrdPssSys::ConfigXeq(char *var, XrdOucStream &Config)
    TS_Xeq("config",        xconf);
    TS_Xeq("defaults",      xdef);
    TS_Xeq("export",        xexp);
+   TS_PSX("hedge",         ParseHedge);
    TS_PSX("inetmode",      ParseINet);
    TS_Xeq("origin",        xorig);
    TS_Xeq("permit",        xperm);
+   TS_Xeq("pool",          xpool);
+   TS_PSX("readahead",     ParseRdAhead);
    TS_PSX("setopt",        ParseSet);
    TS_PSX("trace",         ParseTrace);
+   TS_PSX("writebehind",   ParseWrBehind);
 
    // Copy the variable name as this may change because it points to an
    // internal buffer in Config. The vagaries of effeciency. Then get value.
@@ -502,6 +520,7 @@ const char *XrdPssSys::getDomain(const char *hName)
    Purpose:  To parse the directive: config <keyword> <value>
 
              <keyword> is one of the following:
+             rvsplit   max number of pieces a readv is sent to the origin as
              streams   number of i/o   streams
              workers   number of queue workers
 
@@ -513,7 +532,8 @@ int XrdPssSys::xconf(XrdSysError *Eroute, XrdOucStream &Config)
    char  *val, *kvp;
    int    kval;
    struct Xtab {const char *Key; int *Val;} Xopts[] =
-               {{"streams", &Streams},
+               {{"rvsplit", &rvSplit},
+                {"streams", &Streams},
                 {"workers", &Workers}};
    int i, numopts = sizeof(Xopts)/sizeof(struct Xtab);
 
@@ -713,3 +733,50 @@ do {if (!(val = Config.GetWord()))
 
     return 0;
 }
+
+/******************************************************************************/
+/*                                 x p o o l                                  */
+/******************************************************************************/
+
+/* Function: xpool
+
+   Purpose:  To parse the directive: pool <num> [standby <snum>] [check <sec>]
+
+             <num>     the number of origin channels opens are spread over.
+             <snum>    the number of additional channels used when a regular
+                       channel fails its health check (default 0).
+             <sec>     the interval between health checks which also keeps
+                       the channels from idling out (default 60).
+
+   Output: 0 upon success or 1 upon failure.
+*/
+
+int XrdPssSys::xpool(XrdSysError *Eroute, XrdOucStream &Config)
+{
+   char *val;
+   int   num;
+
+   if (!(val = Config.GetWord()))
+      {Eroute->Emsg("Config", "pool size not specified."); return 1;}
+   if (XrdOuca2x::a2i(*Eroute, "pool size", val, &num, 1, 1024)) return 1;
+   PoolNum = num;
+
+   while((val = Config.GetWord()) && *val)
+        {if (!strcmp("standby", val))
+            {if (!(val = Config.GetWord()))
+                {Eroute->Emsg("Config", "pool standby not specified."); return 1;}
+             if (XrdOuca2x::a2i(*Eroute, "pool standby", val, &num, 0, 1024))
+                return 1;
+             PoolStby = num;
+            }
+         else if (!strcmp("check", val))
+            {if (!(val = Config.GetWord()))
+                {Eroute->Emsg("Config", "pool check not specified."); return 1;}
+             if (XrdOuca2x::a2tm(*Eroute, "pool check", val, &num, 1)) return 1;
+             PoolChk = num;
+            }
+         else {Eroute->Emsg("Config", "invalid pool option -", val); return 1;}
+        }
+
+   return 0;
+}
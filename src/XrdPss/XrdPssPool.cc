@@ -0,0 +1,164 @@
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d P s s P o o l . c c                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "XrdCl/XrdClFileSystem.hh"
+#include "XrdCl/XrdClURL.hh"
+#include "XrdPss/XrdPssPool.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPthread.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdPssPool::XrdPssPool(int num, int standby, int chkint)
+           : eDest(0), numChan(num), numStby(standby), chkInt(chkint)
+{
+   int i, n = num + standby;
+
+// Allocate the channels. Logins are short, the client limits them to eight
+// characters. Channels start out as being up so that we do not divert any
+// opens before the first check.
+//
+   Chans = new Chan[n];
+   for (i = 0; i < n; i++)
+       {snprintf(Chans[i].Login, sizeof(Chans[i].Login),
+                 (i < num ? "pxp%d" : "pxs%d"), (i < num ? i : i - num));
+        Chans[i].URL = 0;
+        Chans[i].Up  = true;
+       }
+}
+
+/******************************************************************************/
+/*                                 I d e n t                                  */
+/******************************************************************************/
+
+const char *XrdPssPool::Ident(const char *tident, char *buff, int blen)
+{
+   const char *cP;
+   int i, k, n = 0;
+
+// The trace identifier is of the form "user.pid:fd@host". We use the fd to
+// pick the channel so that all opens from a connection use the same one.
+//
+   if (tident && (cP = index(tident, ':'))) n = atoi(cP+1);
+   if (n < 0) n = -n;
+   i = n % numChan;
+
+// If the channel is down use a standby one, if possible. Should everything be
+// down we stick with the original one and let the client sort it out.
+//
+   if (!Chans[i].Up)
+      for (k = 0; k < numStby; k++)
+          {n = numChan + (i + k) % numStby;
+           if (Chans[n].Up) {i = n; break;}
+          }
+
+// Format the login
+//
+   snprintf(buff, blen, "=%s@", Chans[i].Login);
+   return buff;
+}
+
+/******************************************************************************/
+/*                                 S t a r t                                  */
+/******************************************************************************/
+
+bool XrdPssPool::Start(XrdSysError &eP, const char *hdr)
+{
+   pthread_t tid;
+   char id[24], url[1024];
+   int i, n;
+
+// Construct the root url for each login
+//
+   eDest = &eP;
+   for (i = 0; i < numChan + numStby; i++)
+       {sprintf(id, "%s@", Chans[i].Login);
+        n = snprintf(url, sizeof(url), hdr, id, id, id, id, id, id, id, id);
+        if (n >= (int)sizeof(url))
+           {eP.Emsg("Pool", "Origin url too long for channel pool.");
+            return false;
+           }
+        Chans[i].URL = strdup(url);
+       }
+
+// Start the monitor thread which will also establish the channels
+//
+   if (XrdSysThread::Run(&tid, XrdPssPool::Monitor, (void *)this, 0,
+                         "Pss channel pool"))
+      {eP.Emsg("Pool", errno, "start channel pool monitor"); return false;}
+   return true;
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                 C h e c k                                  */
+/******************************************************************************/
+
+void XrdPssPool::Check()
+{
+   uint16_t tmo = (chkInt < 30 ? chkInt : 30);
+   bool up;
+
+// Ping each channel. This creates the channel should it not exist and tells
+// us whether the origin is responsive over that channel.
+//
+   for (int i = 0; i < numChan + numStby; i++)
+       {XrdCl::FileSystem fs((XrdCl::URL(Chans[i].URL)), false);
+        XrdCl::XRootDStatus st = fs.Ping(tmo);
+        up = st.IsOK();
+        if (up != Chans[i].Up)
+           {if (up) eDest->Emsg("Pool", "Origin channel", Chans[i].Login,
+                                "is up again.");
+               else eDest->Emsg("Pool", "Origin channel", Chans[i].Login,
+                                st.ToString().c_str());
+            Chans[i].Up = up;
+           }
+       }
+}
+
+/******************************************************************************/
+/*                               M o n i t o r                                */
+/******************************************************************************/
+
+void *XrdPssPool::Monitor(void *pp)
+{
+   XrdPssPool *poolP = (XrdPssPool *)pp;
+
+   while(1) {poolP->Check(); XrdSysTimer::Snooze(poolP->chkInt);}
+   return (void *)0;
+}
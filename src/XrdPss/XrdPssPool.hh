@@ -0,0 +1,77 @@
+#ifndef _XRDPSS_POOL_H
+#define _XRDPSS_POOL_H
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d P s s P o o l . h h                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+/* XrdPssPool maintains a fixed set of logins to the origin. The client keeps
+   one channel per origin and login name, so normally each client connection
+   gets its own channel that is set up on its first open and torn down once
+   it idles out. With a pool, opens use one of the pool's logins instead, chosen
+   by the client's connection so the mapping is stable. A monitor thread pings
+   each login right away and then periodically: this sets up the channels
+   (including any authentication) before they are needed, keeps them from
+   idling out, and checks their health. Opens mapped to a channel that failed
+   its last check use one of the standby logins until it recovers.
+*/
+
+class XrdSysError;
+
+class XrdPssPool
+{
+public:
+
+// Return the login to be used for the client identified by tident, formatted
+// as "=<login>@" into buff. This is suitable as the tident for P2URL().
+//
+const char *Ident(const char *tident, char *buff, int blen);
+
+// Start the monitor thread. The hdr is the URL header format, as used by
+// P2URL(), with up to eight substitutions for the login.
+//
+bool        Start(XrdSysError &eDest, const char *hdr);
+
+            XrdPssPool(int num, int standby, int chkint);
+           ~XrdPssPool() {} // Never deleted
+
+private:
+
+static void *Monitor(void *pp);
+       void  Check();
+
+struct Chan
+      {char *URL;
+       char  Login[16];
+       bool  Up;
+      };
+
+XrdSysError *eDest;
+Chan        *Chans;
+int          numChan;
+int          numStby;
+int          chkInt;
+};
+#endif
@@ -21,12 +21,14 @@ add_library(
                                       XrdSec/XrdSecInterface.hh
   XrdSec/XrdSecPManager.cc            XrdSec/XrdSecPManager.hh
   XrdSec/XrdSecProtocolhost.cc        XrdSec/XrdSecProtocolhost.hh
+  XrdSec/XrdSecProtocoltkt.cc         XrdSec/XrdSecProtocoltkt.hh
   XrdSec/XrdSecServer.cc              XrdSec/XrdSecServer.hh
   XrdSec/XrdSecTLayer.cc              XrdSec/XrdSecTLayer.hh
   XrdSec/XrdSecTrace.hh )
 
 target_link_libraries(
   ${LIB_XRD_SEC}
+  XrdCryptoLite
   XrdUtils
   pthread
   ${CMAKE_DL_LIBS} )
@@ -592,6 +592,22 @@ virtual XrdSecProtocol *getProtocol(const char              *host,    // In
 //------------------------------------------------------------------------------
 
 virtual                ~XrdSecService() {}
+
+//------------------------------------------------------------------------------
+//! Obtain a ticket that the client may present on later logins instead of
+//! authenticating again. This method is appended to preserve the ABI.
+//!
+//! @param  entity   The identity of the just authenticated client.
+//! @param  endPoint the XrdNetAddrInfo object describing the client end-point.
+//!
+//! @return Pointer to the parameters to be sent to the client with the final
+//!         authentication response or a null pointer if no ticket is issued.
+//!         The caller must delete the returned object.
+//------------------------------------------------------------------------------
+
+virtual XrdSecParameters *getTicket(XrdSecEntity   &entity,
+                                    XrdNetAddrInfo &endPoint)
+                                   {(void) entity; (void) endPoint; return 0;}
 };
   
 /******************************************************************************/
@@ -148,6 +148,7 @@ XrdSecProtocol *XrdSecPManager::Get(const char       *hname,
                                     XrdSecParameters &secparm,
                                     XrdOucErrInfo    *eri)
 {
+   static const char tktMark[] = "&P=tkt";
    char secbuff[4096], *nscan, *pname, *pargs, *bp = secbuff;
    char pcomp[XrdSecPROTOIDSIZE+4], *compProt;
    XrdSecProtList *pl;
@@ -191,6 +192,30 @@ XrdSecProtocol *XrdSecPManager::Get(const char       *hname,
        compProt[i+1] = ','; compProt[i+2] = 0; *pcomp = ',';
       } else compProt = 0;
 
+// The server always lists the ticket protocol last so that clients unaware of
+// it only get to it after all else failed. We try it first, if wanted, and
+// drop it from the token so that it is not tried again should it fail.
+//
+   i = sizeof(tktMark)-1;
+   if (secparm.size >= i
+   &&  !strncmp(secparm.buffer+secparm.size-i, tktMark, i))
+      {secparm.size -= i;
+       if (!isProxy && (!wantProt || strstr(compProt, ",tkt,")))
+          {XrdSysMutexHelper pmHelper(pmMutex);
+           if ((pl = Lookup("tkt")) || (pl = ldPO(erp, 'c', "tkt")))
+              {if ((pp = pl->ep('c', hname, endPoint, 0, erp)))
+                  {DEBUG("Using tkt protocol");
+                   if (compProt) free(compProt);
+                   return pp;
+                  }
+              }
+          }
+       if (secparm.size <= 0)
+          {if (compProt) free(compProt);
+           return (XrdSecProtocol *)0;
+          }
+      }
+
 // Copy the string into a local buffer so that we can simplify some comparisons
 // and isolate ourselves from server protocol errors.
 //
@@ -292,6 +317,7 @@ XrdSecProtList *XrdSecPManager::ldPO(XrdOucErrInfo *eMsg,  // In
                                      const char    *spath) // In
 {
    extern XrdSecProtocol *XrdSecProtocolhostObject(PROTPARMS);
+   extern XrdSecProtocol *XrdSecProtocoltktObject(PROTPARMS);
    static XrdVERSIONINFODEF(clVer, SecClnt, XrdVNUMBER, XrdVERSION);
    static XrdVERSIONINFODEF(srVer, SecSrvr, XrdVNUMBER, XrdVERSION);
    XrdVersionInfo *myVer = (pmode == 'c' ? &clVer : &srVer);
@@ -310,6 +336,10 @@ XrdSecProtList *XrdSecPManager::ldPO(XrdOucErrInfo *eMsg,  // In
 //
    if (!strcmp(pid, "host")) return Add(eMsg,pid,XrdSecProtocolhostObject,0);
 
+// The "tkt" protocol is builtin as well.
+//
+   if (!strcmp(pid, "tkt"))  return Add(eMsg,pid,XrdSecProtocoltktObject,0);
+
 // Form library name (versioned) and object creator name and bundle id
 //
    snprintf(poname, sizeof(poname), "libXrdSec%s.so", pid);
@@ -39,6 +39,7 @@
 #define COMMON_DIGEST_FOR_OPENSSL
 #include "CommonCrypto/CommonDigest.h"
 #else
+#include "openssl/evp.h"
 #include "openssl/sha.h"
 #endif
 
@@ -67,6 +68,45 @@ struct XrdSecReq
 
 using namespace XrdSecProtection; // Fix warnings from slc5 compiler!
 
+/******************************************************************************/
+/*             S t r u c t   X r d S e c P r o t e c t H a s h                */
+/******************************************************************************/
+
+// Each request is hashed so the digest context is allocated once per object
+// and reinitialised for every request. A client may sign requests from more
+// than one thread, hence the mutex. EVP picks the fastest implementation the
+// processor has (e.g. the SHA or ARMv8 crypto extensions).
+//
+#ifndef __APPLE__
+struct XrdSecProtectHash
+{
+XrdSysMutex  hMutex;
+EVP_MD_CTX  *mdCTX;
+
+             XrdSecProtectHash() : mdCTX(EVP_MD_CTX_create()) {}
+            ~XrdSecProtectHash() {if (mdCTX) EVP_MD_CTX_destroy(mdCTX);}
+};
+
+namespace
+{
+// Look up the digest once; with OpenSSL 3 passing EVP_sha256() to the digest
+// init would fetch the implementation again for every request.
+//
+const EVP_MD *GetMD()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+   EVP_MD *mdP = EVP_MD_fetch(0, "SHA256", 0);
+   if (mdP) return mdP;
+#endif
+   return EVP_sha256();
+}
+
+const EVP_MD *sha256MD = GetMD();
+}
+#else
+struct XrdSecProtectHash {};
+#endif
+
 /******************************************************************************/
 /*                       C l a s s   X r d S e c V e c                        */
 /******************************************************************************/
@@ -120,6 +160,7 @@ kXR_login,     kXR_signIgnore, kXR_signIgnore, kXR_signIgnore, kXR_signIgnore,
 kXR_mkdir,     kXR_signIgnore, kXR_signNeeded, kXR_signNeeded, kXR_signNeeded,
 kXR_mv,        kXR_signNeeded, kXR_signNeeded, kXR_signNeeded, kXR_signNeeded, 
 kXR_open,      kXR_signLikely, kXR_signNeeded, kXR_signNeeded, kXR_signNeeded, 
+kXR_pgread,    kXR_signIgnore, kXR_signIgnore, kXR_signIgnore, kXR_signNeeded,
 kXR_ping,      kXR_signIgnore, kXR_signIgnore, kXR_signIgnore, kXR_signIgnore, 
 kXR_prepare,   kXR_signIgnore, kXR_signIgnore, kXR_signIgnore, kXR_signNeeded,
 kXR_protocol,  kXR_signIgnore, kXR_signIgnore, kXR_signIgnore, kXR_signIgnore, 
@@ -140,12 +181,36 @@ kXR_write,     kXR_signIgnore, kXR_signIgnore, kXR_signNeeded, kXR_signNeeded,
 0);
 }
 
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+XrdSecProtect::~XrdSecProtect()
+{
+   if (hashCTX) delete hashCTX;
+}
+
 /******************************************************************************/
 /* Private:                      G e t S H A 2                                */
 /******************************************************************************/
 
 bool XrdSecProtect::GetSHA2(unsigned char *hBuff, struct iovec *iovP, int iovN)
 {
+#ifndef __APPLE__
+// Use the digest context of this object, if we have one
+//
+   if (hashCTX && hashCTX->mdCTX)
+      {XrdSysMutexHelper hLock(hashCTX->hMutex);
+       EVP_MD_CTX *mdCTX = hashCTX->mdCTX;
+       if (1 != EVP_DigestInit_ex(mdCTX, sha256MD, 0)) return false;
+       for (int i = 0; i < iovN; i++)
+           {if (1 != EVP_DigestUpdate(mdCTX, iovP[i].iov_base, iovP[i].iov_len))
+               return false;
+           }
+       return (1 == EVP_DigestFinal_ex(mdCTX, hBuff, 0));
+      }
+#endif
+
    SHA256_CTX sha256;
 
 // Initialize the hash calculattion
@@ -164,6 +229,19 @@ bool XrdSecProtect::GetSHA2(unsigned char *hBuff, struct iovec *iovP, int iovN)
   return (1 == SHA256_Final(hBuff, &sha256));
 }
 
+/******************************************************************************/
+/* Private:                      N e w H a s h                                */
+/******************************************************************************/
+
+XrdSecProtectHash *XrdSecProtect::NewHash()
+{
+#ifndef __APPLE__
+   return new XrdSecProtectHash;
+#else
+   return 0;
+#endif
+}
+
 /******************************************************************************/
 /* Private:                       S c r e e n                                 */
 /******************************************************************************/
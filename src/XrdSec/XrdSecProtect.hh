@@ -49,6 +49,7 @@
 /******************************************************************************/
   
 struct iovec;
+struct XrdSecProtectHash;
 class  XrdSecProtectParms;
 class  XrdSecProtocol;
 
@@ -131,27 +132,29 @@ virtual const char  *Verify(SecurityRequest  &secreq,
 //! Destructor
 //------------------------------------------------------------------------------
 
-virtual ~XrdSecProtect() {}
+virtual ~XrdSecProtect();
 
 protected:
 
          XrdSecProtect(XrdSecProtocol *aprot=0, bool edok=true)     // Client!
                       : Need2Secure(&XrdSecProtect::Screen),
                         authProt(aprot), secVec(0), lastSeqno(1),
-                        edOK(edok), secVerData(false)
+                        hashCTX(NewHash()), edOK(edok), secVerData(false)
                         {}
 
          XrdSecProtect(XrdSecProtocol *aprot, XrdSecProtect &pRef, // Server!
                        bool edok=true)
                       : Need2Secure(&XrdSecProtect::Screen),
                         authProt(aprot), secVec(pRef.secVec),
-                        lastSeqno(0), edOK(edok),
+                        lastSeqno(0), hashCTX(NewHash()), edOK(edok),
                         secVerData(pRef.secVerData) {}
 
 void     SetProtection(const ServerResponseReqs_Protocol &inReqs);
 
 private:
 bool            GetSHA2(unsigned char *hBuff, struct iovec *iovP, int iovN);
+static
+XrdSecProtectHash *NewHash();
 bool            Screen(ClientRequest &thereq);
 
 XrdSecProtocol              *authProt;
@@ -160,6 +163,7 @@ ServerResponseReqs_Protocol  myReqs;
 union {kXR_unt64             lastSeqno;  // Used by Secure()
        kXR_unt64             nextSeqno;  // Used by Verify()
       };
+XrdSecProtectHash           *hashCTX;    // Digest context kept for reuse
 bool                         edOK;
 bool                         secVerData;
 static const unsigned int    maxRIX = kXR_REQFENCE-kXR_auth;
@@ -0,0 +1,455 @@
+/******************************************************************************/
+/*                                                                            */
+/*                  X r d S e c P r o t o c o l t k t . c c                   */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+
+#include "XrdCrypto/XrdCryptoLite.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdOuc/XrdOucErrInfo.hh"
+#include "XrdSec/XrdSecEntity.hh"
+#include "XrdSec/XrdSecProtocoltkt.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                         L o c a l   D e f i n e s                          */
+/******************************************************************************/
+
+// A ticket is the key id followed by the sealed data, all in hex. The sealed
+// data starts with a random nonce and ends with random padding so that equal
+// tickets differ and any tampering spills into bytes the checksum covers. The
+// maximum size keeps the ticket within the security token limit of 4K.
+//
+#define tktKeySZ   32
+#define tktNonceSZ  8
+#define tktPadSZ   16
+#define tktMaxSZ 1536
+
+/******************************************************************************/
+/*                          S t a t i c   I t e m s                           */
+/******************************************************************************/
+
+namespace
+{
+struct tktKey {unsigned int kid; time_t born; char key[tktKeySZ];};
+
+struct tktInfo {std::string tkt; time_t expires;};
+
+XrdSysMutex    tktMutex;
+tktKey         tktKeys[2];      // [0] current key and [1] previous key
+XrdCryptoLite *tktCrypto = 0;
+int            tktLife   = 0;
+int            tktRotate = 0;
+int            tktRand   = -1;
+
+std::map<std::string, tktInfo> tktStore;  // Client side tickets
+}
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+int Fatal(XrdOucErrInfo *erp, int rc, const char *etxt)
+{
+   if (erp) erp->setErrInfo(rc, etxt);
+   return -1;
+}
+
+bool Random(char *buff, int blen)
+{
+   int rc;
+
+   while(blen > 0)
+        {if ((rc = read(tktRand, buff, blen)) <= 0)
+            {if (rc < 0 && errno == EINTR) continue;
+             return false;
+            }
+         buff += rc; blen -= rc;
+        }
+   return true;
+}
+
+bool newKey(tktKey &newkey)
+{
+   do {if (!Random((char *)&newkey.kid, sizeof(newkey.kid))) return false;
+      } while(!newkey.kid || newkey.kid == tktKeys[0].kid
+                          || newkey.kid == tktKeys[1].kid);
+   newkey.born = time(0);
+   return Random(newkey.key, sizeof(newkey.key));
+}
+
+// Must be called with the tktMutex held. After a rotation the current key
+// becomes the previous one and the key before that is no longer valid.
+//
+void Rotate()
+{
+   tktKey newkey;
+
+   if (time(0) - tktKeys[0].born >= tktRotate && newKey(newkey))
+      {tktKeys[1] = tktKeys[0];
+       tktKeys[0] = newkey;
+      }
+}
+
+void toHex(const char *src, int slen, char *dst)
+{
+   static const char hv[] = "0123456789abcdef";
+
+   for (int i = 0; i < slen; i++)
+       {*dst++ = hv[(src[i] >> 4) & 0x0f];
+        *dst++ = hv[ src[i]       & 0x0f];
+       }
+   *dst = '\0';
+}
+
+bool fromHex(const char *src, int dlen, char *dst)
+{
+   int i, n, v;
+
+   for (i = 0; i < dlen*2; i++)
+       {     if (src[i] >= '0' && src[i] <= '9') v = src[i] - '0';
+        else if (src[i] >= 'a' && src[i] <= 'f') v = src[i] - 'a' + 10;
+        else return false;
+        n = i >> 1;
+        if (i & 1) dst[n] = (char)((dst[n] << 4) | v);
+           else    dst[n] = (char)v;
+       }
+   return true;
+}
+}
+
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+XrdSecProtocoltkt::~XrdSecProtocoltkt()
+{
+   if (theHost)     free(theHost);
+   if (theTicket)   free(theTicket);
+   if (Entity.name) free(Entity.name);
+   if (Entity.vorg) free(Entity.vorg);
+   if (Entity.role) free(Entity.role);
+   if (Entity.grps) free(Entity.grps);
+}
+
+/******************************************************************************/
+/*                          A u t h e n t i c a t e                           */
+/******************************************************************************/
+
+int XrdSecProtocoltkt::Authenticate(XrdSecCredentials  *cred,
+                                    XrdSecParameters  **parms,
+                                    XrdOucErrInfo      *einfo)
+{
+   char cBuff[tktMaxSZ+8], pBuff[sizeof(cBuff)], key[tktKeySZ], addr[256];
+   char *fld[7], *bP, *eP;
+   unsigned int kid;
+   int i, cLen, pLen, hLen;
+
+// Make sure we have a ticket here (i.e. "tkt\0" followed by the key id)
+//
+   hLen = cred->size - 4;
+   if (hLen < (int)sizeof(kid)*2 || memcmp(cred->buffer, "tkt", 4))
+      return Fatal(einfo, EINVAL, "Invalid ticket credentials.");
+   cLen = (hLen - sizeof(kid)*2) / 2;
+   if (cLen > (int)sizeof(cBuff)
+   || !fromHex(cred->buffer+4, sizeof(kid), (char *)&kid)
+   || !fromHex(cred->buffer+4+sizeof(kid)*2, cLen, cBuff))
+      return Fatal(einfo, EINVAL, "Invalid ticket credentials.");
+
+// Get the key the ticket was sealed with, it may have been retired
+//
+   tktMutex.Lock();
+   if (tktCrypto) Rotate();
+   for (i = 0; i < 2; i++) if (kid && kid == tktKeys[i].kid) break;
+   if (i < 2) memcpy(key, tktKeys[i].key, sizeof(key));
+   tktMutex.UnLock();
+   if (i >= 2) return Fatal(einfo, EACCES, "Ticket is no longer valid.");
+
+// Unseal the ticket
+//
+   pLen = tktCrypto->Decrypt(key, sizeof(key), cBuff, cLen,
+                             pBuff, sizeof(pBuff));
+   if (pLen <= tktNonceSZ + tktPadSZ)
+      return Fatal(einfo, EACCES, "Ticket is invalid.");
+
+// Split out the fields: expiry, address, protocol, name, vorg, role, grps
+//
+   bP = pBuff + tktNonceSZ; eP = pBuff + pLen - tktPadSZ;
+   for (i = 0; i < 7; i++)
+       {fld[i] = bP;
+        if (!(bP = (char *)memchr(bP, 0, eP - bP)))
+           return Fatal(einfo, EACCES, "Ticket is invalid.");
+        bP++;
+       }
+
+// Verify the ticket is still valid and was issued to this client
+//
+   if (atoll(fld[0]) <= (long long)time(0))
+      return Fatal(einfo, EACCES, "Ticket has expired.");
+   epAddr.Format(addr, sizeof(addr), XrdNetAddrInfo::fmtAddr,
+                                     XrdNetAddrInfo::noPort);
+   if (strcmp(addr, fld[1]))
+      return Fatal(einfo, EACCES, "Ticket was issued to another address.");
+
+// Restore the identity
+//
+   strncpy(Entity.prot, fld[2], XrdSecPROTOIDSIZE-1);
+   Entity.prot[XrdSecPROTOIDSIZE-1] = '\0';
+   if (*fld[3]) Entity.name = strdup(fld[3]);
+   if (*fld[4]) Entity.vorg = strdup(fld[4]);
+   if (*fld[5]) Entity.role = strdup(fld[5]);
+   if (*fld[6]) Entity.grps = strdup(fld[6]);
+   Entity.host     = theHost;
+   Entity.addrInfo = &epAddr;
+   return 0;
+}
+
+/******************************************************************************/
+/*                             C o n f i g u r e                              */
+/******************************************************************************/
+
+bool XrdSecProtocoltkt::Configure(int lifetime, int rotate,
+                                  XrdOucErrInfo *einfo)
+{
+   tktKey firstKey;
+   int rc;
+
+// Get the cipher used to seal tickets
+//
+   if (!(tktCrypto = XrdCryptoLite::Create(rc, "bf32")))
+      {einfo->setErrInfo(rc, "XrdSec: Ticket cipher is not available.");
+       return false;
+      }
+
+// Generate the first key
+//
+   if ((tktRand = open("/dev/urandom", O_RDONLY)) < 0 || !newKey(firstKey))
+      {einfo->setErrInfo(errno, "XrdSec: Unable to generate ticket key.");
+       delete tktCrypto; tktCrypto = 0;
+       return false;
+      }
+   tktKeys[0] = firstKey;
+
+// Set the periods
+//
+   tktLife   = lifetime;
+   tktRotate = (rotate < lifetime ? lifetime : rotate);
+   return true;
+}
+
+/******************************************************************************/
+/*                                  F i n d                                   */
+/******************************************************************************/
+
+char *XrdSecProtocoltkt::Find(const char *tkey)
+{
+   XrdSysMutexHelper tktHelper(tktMutex);
+   std::map<std::string, tktInfo>::iterator it = tktStore.find(tkey);
+
+   if (it == tktStore.end()) return 0;
+   if (it->second.expires <= time(0)) {tktStore.erase(it); return 0;}
+   return strdup(it->second.tkt.c_str());
+}
+
+/******************************************************************************/
+/*                        g e t C r e d e n t i a l s                         */
+/******************************************************************************/
+
+XrdSecCredentials *XrdSecProtocoltkt::getCredentials(XrdSecParameters *parm,
+                                                     XrdOucErrInfo    *einfo)
+{
+   char *bP;
+   int n;
+
+// Only client objects have a ticket
+//
+   if (!theTicket)
+      {Fatal(einfo, ENOENT, "No ticket available."); return 0;}
+
+// The credentials are the protocol name followed by the ticket
+//
+   n  = strlen(theTicket);
+   bP = (char *)malloc(n+4);
+   memcpy(bP, "tkt", 4);
+   memcpy(bP+4, theTicket, n);
+   return new XrdSecCredentials(bP, n+4);
+}
+
+/******************************************************************************/
+/*                                 I s s u e                                  */
+/******************************************************************************/
+
+XrdSecParameters *XrdSecProtocoltkt::Issue(XrdSecEntity   &entity,
+                                           XrdNetAddrInfo &endPoint)
+{
+   char pBuff[tktMaxSZ], cBuff[tktMaxSZ+8], key[tktKeySZ], addr[256];
+   char prot[XrdSecPROTOIDSIZE+1], *bP, *tP;
+   const char *fld[6];
+   unsigned int kid;
+   int i, n, cLen;
+
+// Take a copy of the current key, replacing it first if it got too old
+//
+   if (!tktCrypto) return 0;
+   tktMutex.Lock();
+   Rotate();
+   kid = tktKeys[0].kid;
+   memcpy(key, tktKeys[0].key, sizeof(key));
+   tktMutex.UnLock();
+
+// Fill out the fields to be sealed
+//
+   endPoint.Format(addr, sizeof(addr), XrdNetAddrInfo::fmtAddr,
+                                       XrdNetAddrInfo::noPort);
+   strncpy(prot, entity.prot, XrdSecPROTOIDSIZE);
+   prot[XrdSecPROTOIDSIZE] = '\0';
+   fld[0] = addr;
+   fld[1] = prot;
+   fld[2] = (entity.name ? entity.name : "");
+   fld[3] = (entity.vorg ? entity.vorg : "");
+   fld[4] = (entity.role ? entity.role : "");
+   fld[5] = (entity.grps ? entity.grps : "");
+
+// Construct the ticket's contents; identities too large get no ticket
+//
+   if (!Random(pBuff, tktNonceSZ)) return 0;
+   bP = pBuff + tktNonceSZ;
+   bP += sprintf(bP, "%lld", (long long)(time(0) + tktLife)) + 1;
+   for (i = 0; i < 6; i++)
+       {n = strlen(fld[i]) + 1;
+        if (n > pBuff + sizeof(pBuff) - tktPadSZ - bP) return 0;
+        memcpy(bP, fld[i], n); bP += n;
+       }
+   if (!Random(bP, tktPadSZ)) return 0;
+   bP += tktPadSZ;
+
+// Seal it
+//
+   cLen = tktCrypto->Encrypt(key, sizeof(key), pBuff, bP - pBuff,
+                             cBuff, sizeof(cBuff));
+   if (cLen <= 0) return 0;
+
+// Return the token that tells the client about the ticket
+//
+   tP = (char *)malloc(32 + (sizeof(kid) + cLen)*2);
+   n  = sprintf(tP, "&P=tkt,t:%d:", tktLife);
+   toHex((char *)&kid, sizeof(kid), tP+n);
+   toHex(cBuff, cLen, tP+n+sizeof(kid)*2);
+   return new XrdSecParameters(tP, strlen(tP));
+}
+
+/******************************************************************************/
+/*                                  S a v e                                   */
+/******************************************************************************/
+
+void XrdSecProtocoltkt::Save(const char *tkey, const char *parms)
+{
+   XrdSysMutexHelper tktHelper(tktMutex);
+   std::map<std::string, tktInfo>::iterator it;
+   time_t now = time(0);
+   char *eP;
+   int life;
+
+// The parameters are "<lifetime>:<ticket>"
+//
+   life = strtol(parms, &eP, 10);
+   if (life <= 0 || *eP != ':' || !*(eP+1)) return;
+
+// Drop any tickets that have expired and record this one
+//
+   it = tktStore.begin();
+   while(it != tktStore.end())
+        {if (it->second.expires <= now) tktStore.erase(it++);
+            else ++it;
+        }
+   tktInfo &tInfo = tktStore[tkey];
+   tInfo.tkt     = eP+1;
+   tInfo.expires = now + life;
+}
+
+/******************************************************************************/
+/*                 X r d S e c P r o t o c o l t k t I n i t                  */
+/******************************************************************************/
+
+// This is a builtin protocol so we don't define an Init method. The server
+// configures it via Configure() when tickets are enabled.
+
+/******************************************************************************/
+/*               X r d S e c P r o t o c o l t k t O b j e c t                */
+/******************************************************************************/
+
+// As with the host protocol, this is statically linked into the shared library
+// as a native protocol and need not be defined as extern "C".
+//
+XrdSecProtocol *XrdSecProtocoltktObject(const char              who,
+                                        const char             *hostname,
+                                              XrdNetAddrInfo   &endPoint,
+                                        const char             *parms,
+                                              XrdOucErrInfo    *einfo)
+{
+   XrdOucEnv *envP = (einfo ? einfo->getEnv() : 0);
+   const char *user = 0, *uid = 0, *gid = 0;
+   char tkey[1024], *tkt;
+
+// Servers always get an object, it validates any ticket it is handed
+//
+   if (who == 's') return new XrdSecProtocoltkt(hostname, endPoint);
+
+// Proxies act on behalf of many clients and never use tickets. Otherwise, a
+// ticket applies to the login name and the credential source being used.
+//
+   if (!getenv("XrdSecPROXY"))
+      {if (envP)
+          {user = envP->Get("username");
+           uid  = envP->Get("xrdcl.secuid");
+           gid  = envP->Get("xrdcl.secgid");
+          }
+       snprintf(tkey, sizeof(tkey), "%s@%s:%d?%s:%s", (user ? user : ""),
+                hostname, endPoint.Port(), (uid ? uid : ""), (gid ? gid : ""));
+
+// Record a ticket we were just handed or use one we already have
+//
+       if (parms && !strncmp(parms, "t:", 2))
+          XrdSecProtocoltkt::Save(tkey, parms+2);
+          else if ((tkt = XrdSecProtocoltkt::Find(tkey)))
+                  return new XrdSecProtocoltkt(hostname, endPoint, tkt);
+      }
+
+// There is no ticket to be used
+//
+   if (einfo) einfo->setErrInfo(ENOENT, "");
+   return 0;
+}
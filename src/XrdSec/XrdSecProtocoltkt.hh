@@ -0,0 +1,99 @@
+#ifndef __SEC_PROTOCOL_TKT_H__
+#define __SEC_PROTOCOL_TKT_H__
+/******************************************************************************/
+/*                                                                            */
+/*                  X r d S e c P r o t o c o l t k t . h h                   */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <string.h>
+#include <time.h>
+
+#include "XrdNet/XrdNetAddrInfo.hh"
+#include "XrdSec/XrdSecInterface.hh"
+
+/* XrdSecProtocoltkt is the builtin ticket protocol. Once a client has been
+   authenticated by some other protocol the server may hand it a ticket in the
+   final authentication response. The ticket holds the client's identity and
+   address sealed with a server key that is never disclosed and keys are
+   periodically replaced. On later logins to the same server the client simply
+   presents the ticket and the server restores the identity without having to
+   redo the (usually expensive) original authentication. A ticket that cannot
+   be unsealed, was issued to a different address, or has expired is rejected
+   and the client falls back to the next protocol in the list. Tickets convey
+   no session key so they cannot be used where requests must be signed.
+*/
+
+class XrdOucErrInfo;
+class XrdSecEntity;
+
+class XrdSecProtocoltkt : public XrdSecProtocol
+{
+public:
+
+        int                Authenticate  (XrdSecCredentials  *cred,
+                                          XrdSecParameters  **parms,
+                                          XrdOucErrInfo      *einfo=0);
+
+        XrdSecCredentials *getCredentials(XrdSecParameters  *parm=0,
+                                          XrdOucErrInfo     *einfo=0);
+
+// Server side: enable ticket issuance. Tickets are valid for lifetime seconds
+// and the sealing key is replaced every rotate seconds; tickets sealed with
+// the key just replaced remain valid. Returns false with einfo set on failure.
+//
+static  bool               Configure(int lifetime, int rotate,
+                                     XrdOucErrInfo *einfo);
+
+// Server side: issue a ticket for the authenticated entity connected from
+// endPoint. The result is to be sent to the client or is nil if a ticket
+// could not be issued.
+//
+static  XrdSecParameters  *Issue(XrdSecEntity   &entity,
+                                 XrdNetAddrInfo &endPoint);
+
+// Client side: record a ticket (i.e. the token parameters) for later logins.
+//
+static  void               Save(const char *tkey, const char *parms);
+
+// Client side: return a copy of a recorded valid ticket or nil.
+//
+static  char              *Find(const char *tkey);
+
+void                       Delete() {delete this;}
+
+              XrdSecProtocoltkt(const char *host, XrdNetAddrInfo &endPoint,
+                                char *ticket=0)
+                               : XrdSecProtocol("tkt"), theTicket(ticket)
+                               {theHost = strdup(host);
+                                epAddr = endPoint;
+                               }
+             ~XrdSecProtocoltkt();
+private:
+
+XrdNetAddrInfo epAddr;
+char          *theHost;
+char          *theTicket;
+};
+#endif
@@ -43,12 +43,14 @@
 #include "XrdSys/XrdSysLogger.hh"
 #include "XrdSys/XrdSysHeaders.hh"
 #include "XrdSys/XrdSysError.hh"
+#include "XrdOuc/XrdOuca2x.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucErrInfo.hh"
 #include "XrdNet/XrdNetAddr.hh"
 
 #include "XrdSec/XrdSecInterface.hh"
 #include "XrdSec/XrdSecProtector.hh"
+#include "XrdSec/XrdSecProtocoltkt.hh"
 #include "XrdSec/XrdSecServer.hh"
 #include "XrdSec/XrdSecTrace.hh"
 
@@ -275,6 +277,8 @@ XrdSecServer::XrdSecServer(XrdSysLogger *lp) : eDest(lp, "sec_")
       }
    Enforce     = 0;
    implauth    = 0;
+   tktLife     = 0;
+   tktRotate   = 0;
 }
   
 /******************************************************************************/
@@ -368,6 +372,23 @@ XrdSecProtocol *XrdSecServer::getProtocol(const char              *host,
    return PManager.Get(host, endPoint, cred->buffer, einfo);
 }
 
+/******************************************************************************/
+/*                             g e t T i c k e t                              */
+/******************************************************************************/
+
+XrdSecParameters *XrdSecServer::getTicket(XrdSecEntity   &entity,
+                                          XrdNetAddrInfo &endPoint)
+{
+   EPNAME("getTicket")
+
+// Host authentication is not worth a ticket
+//
+   if (!tktLife || !strcmp(entity.prot, "host")) return 0;
+
+   DEBUG("Issuing " <<entity.prot <<" ticket to " <<entity.tident);
+   return XrdSecProtocoltkt::Issue(entity, endPoint);
+}
+
 /******************************************************************************/
 /*        C o n f i g   F i l e   P r o c e s s i n g   M e t h o d s         */
 /******************************************************************************/
@@ -552,6 +573,7 @@ int XrdSecServer::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute
     TS_Xeq("protbind",      xpbind);
     TS_Xeq("protocol",      xprot);
     TS_Xeq("protparm",      xpparm);
+    TS_Xeq("tickets",       xtkt);
     TS_Xeq("trace",         xtrace);
 
     // No match found, complain.
@@ -913,6 +935,54 @@ int XrdSecServer::xpparm(XrdOucStream &Config, XrdSysError &Eroute)
   return 0;
 }
   
+/******************************************************************************/
+/*                                  x t k t                                   */
+/******************************************************************************/
+
+/* Function: xtkt
+
+   Purpose:  To parse the directive: tickets <life> [rotate <rint>]
+
+             <life>  the number of seconds a ticket remains valid. Clients
+                     authenticated by another protocol are given a ticket that
+                     they may use to login again without reauthenticating.
+             <rint>  the interval at which the key sealing tickets is replaced.
+                     It is at least <life>, which is also the default.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdSecServer::xtkt(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val;
+    int life, rint = 0;
+
+// Get the lifetime
+//
+   if (!(val = Config.GetWord()) || !val[0])
+      {Eroute.Emsg("Config", "ticket lifetime not specified"); return 1;}
+   if (XrdOuca2x::a2tm(Eroute, "ticket lifetime", val, &life, 1)) return 1;
+
+// Get the optional rotation interval
+//
+   if ((val = Config.GetWord()) && val[0])
+      {if (strcmp(val, "rotate"))
+          {Eroute.Emsg("Config", "invalid tickets option -", val); return 1;}
+       if (!(val = Config.GetWord()) || !val[0])
+          {Eroute.Emsg("Config", "ticket rotate interval not specified");
+           return 1;
+          }
+       if (XrdOuca2x::a2tm(Eroute,"ticket rotate interval",val,&rint,1))
+          return 1;
+      }
+
+// All done
+//
+   tktLife   = life;
+   tktRotate = (rint < life ? life : rint);
+   return 0;
+}
+
 /******************************************************************************/
 /*                                x t r a c e                                 */
 /******************************************************************************/
@@ -1039,12 +1109,63 @@ int XrdSecServer::ProtBind_Complete(XrdSysError &Eroute)
    if (implauth && !PManager.Load(&erp, 's', "host", 0, 0))
       {Eroute.Emsg("Config", erp.getErrText()); return 1;}
 
+// Add the ticket protocol, if wanted, to the end of every non-empty token
+//
+   if (tktLife && TktBind_Complete(Eroute)) return 1;
+
 // Free up the constructed default sectoken
 //
    free(SToken); SToken = STBuff = 0; STBlen = 0;
    return 0;
 }
  
+/******************************************************************************/
+/*                      T k t B i n d _ C o m p l e t e                       */
+/******************************************************************************/
+
+int XrdSecServer::TktBind_Complete(XrdSysError &Eroute)
+{
+    EPNAME("TktBind_Complete")
+    static const char tktMark[] = "&P=tkt";
+    XrdOucErrInfo erp;
+    XrdSecProtBind *bp;
+    XrdSecPMask_t pnum;
+    char *tBuff;
+    int n = 0;
+
+// Configure the ticket protocol and add it to the set of protocols
+//
+   if (!XrdSecProtocoltkt::Configure(tktLife, tktRotate, &erp)
+   ||  !PManager.Load(&erp, 's', "tkt", 0, 0))
+      {Eroute.Emsg("Config", erp.getErrText()); return 1;}
+   pnum = PManager.Find("tkt");
+
+// Append the ticket protocol to each binding that actually has protocols. It
+// must be last (see XrdSecPManager::Get()) and is always allowed.
+//
+   for (bp = bpDefault; bp; bp = (bp == bpDefault ? bpFirst : bp->next))
+       {if (!bp->SecToken.buffer || !bp->SecToken.size) continue;
+        tBuff = (char *)malloc(bp->SecToken.size + sizeof(tktMark));
+        strcpy(tBuff, bp->SecToken.buffer);
+        strcat(tBuff, tktMark);
+        free(bp->SecToken.buffer);
+        bp->SecToken.buffer = tBuff;
+        bp->SecToken.size   = strlen(tBuff);
+        bp->ValidProts     |= pnum;
+        DEBUG("Ticketed sectoken for " <<(bp == bpDefault ? "*" : bp->thost)
+              <<": '" <<tBuff <<"'");
+        n++;
+       }
+
+// Warn if this is all pointless
+//
+   if (!n) {Eroute.Say("Config warning: tickets enabled but no protocols "
+                       "are used; tickets disabled.");
+            tktLife = 0;
+           }
+   return 0;
+}
+
 /******************************************************************************/
 /*                      X r d S e c g e t S e r v i c e                       */
 /******************************************************************************/
@@ -54,6 +54,11 @@ XrdSecProtocol         *getProtocol(const char              *host,    // In
                                     const XrdSecCredentials *cred,    // In
                                     XrdOucErrInfo           *einfo=0);// Out
 
+// = 0 -> No ticket is issued for the client.
+// ! 0 -> Parameters to be sent to the client holding its ticket.
+//
+XrdSecParameters       *getTicket(XrdSecEntity &entity, XrdNetAddrInfo &endPoint);
+
 int                     Configure(const char *cfn);
 
                         XrdSecServer(XrdSysLogger *lp);
@@ -73,15 +78,19 @@ char           *STBuff;
 int             STBlen;
 int             Enforce;
 int             implauth;
+int             tktLife;
+int             tktRotate;
 
 int             add2token(XrdSysError &erp,char *,char **,int &,XrdSecPMask_t &);
 int             ConfigFile(const char *cfn);
 int             ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute);
 int             ProtBind_Complete(XrdSysError &Eroute);
+int             TktBind_Complete(XrdSysError &Eroute);
 int             xlevel(XrdOucStream &Config, XrdSysError &Eroute);
 int             xpbind(XrdOucStream &Config, XrdSysError &Eroute);
 int             xpparm(XrdOucStream &Config, XrdSysError &Eroute);
 int             xprot(XrdOucStream &Config, XrdSysError &Eroute);
+int             xtkt(XrdOucStream &Config, XrdSysError &Eroute);
 int             xtrace(XrdOucStream &Config, XrdSysError &Eroute);
 };
 #endif
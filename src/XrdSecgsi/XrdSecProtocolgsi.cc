@@ -165,6 +165,8 @@ int    XrdSecProtocolgsi::VOMSCertFmt = -1;
 int    XrdSecProtocolgsi::MonInfoOpt = 0;
 bool   XrdSecProtocolgsi::HashCompatibility = 1;
 bool   XrdSecProtocolgsi::TrustDNS = true;
+int    XrdSecProtocolgsi::KeyPoolDepth = 0;
+bool   XrdSecProtocolgsi::OfferECDH = 0;
 //
 // Crypto related info
 int  XrdSecProtocolgsi::ncrypt    = 0;                 // Number of factories
@@ -179,6 +181,9 @@ XrdSutCache  XrdSecProtocolgsi::cacheCert(8,13); // Server certificates info cac
 XrdSutCache  XrdSecProtocolgsi::cachePxy(8,13);  // Client proxies cache (Fibonacci-based sizes)
 XrdSutCache  XrdSecProtocolgsi::cacheGMAPFun; // Entries mapped by GMAPFun (default size 144)
 XrdSutCache  XrdSecProtocolgsi::cacheAuthzFun; // Entities filled by AuthzFun (default size 144)
+XrdOucHash<char> XrdSecProtocolgsi::cacheVfy; // Client chains recently verified
+XrdSysMutex  XrdSecProtocolgsi::mutexVfy;     // Protects cacheVfy
+int          XrdSecProtocolgsi::nVfyAdds = 0; // Additions since cacheVfy was purged
 //
 // Services
 XrdOucGMap *XrdSecProtocolgsi::servGMap = 0; // Grid map service
@@ -238,6 +243,14 @@ static const char *ServerStepStr(int ksrv)
       return gsiServerSteps[ksrv];
 }
 
+//_____________________________________________________________________________
+static int VfyPurge(const char *, char *, void *)
+{
+   // Keep the entry: when applied to the verification cache the expired
+   // entries are dropped by the hash table itself
+   return 0;
+}
+
 
 /******************************************************************************/
 /*       D u m p  o f   H a n d s h a k e   v a r i a b l e s                 */
@@ -428,6 +441,9 @@ char *XrdSecProtocolgsi::Init(gsiOptions opt, XrdOucErrInfo *erp)
    // Name hashing algorithm compatibility
    if (opt.hashcomp == 0) HashCompatibility = 0;
 
+   // Pool of pre-generated keys
+   if (opt.keypool > 0) KeyPoolDepth = opt.keypool;
+
    //
    // Operation mode
    Server = (opt.mode == 's');
@@ -577,6 +593,7 @@ char *XrdSecProtocolgsi::Init(gsiOptions opt, XrdOucErrInfo *erp)
                   cryptName[ncrypt].insert(cf->Name(),0,strlen(cf->Name())+1);
                   cf->SetTrace(trace);
                   cf->Notify();
+                  if (KeyPoolDepth > 0) cf->SetKeyPool(KeyPoolDepth);
                   // Ref cipher
                   if (!(refcip[ncrypt] = cf->Cipher(0,0,0))) {
                      PRINT("ref cipher for module "<<ncpt<<
@@ -608,6 +625,9 @@ char *XrdSecProtocolgsi::Init(gsiOptions opt, XrdOucErrInfo *erp)
          return Parms;
       }
       //
+      // Whether to offer X25519 for the session cipher agreement
+      OfferECDH = (opt.ecdh > 0);
+      //
       // List of supported / wanted ciphers
       if (opt.cipher)
          DefCipher = opt.cipher;
@@ -1737,8 +1757,13 @@ int XrdSecProtocolgsi::Authenticate(XrdSecCredentials *cred,
       //
       // Client required us to send our certificate and cipher public part:
       // add first this last one.
+      // If we offer X25519, the public info comes from a copy of the
+      // reference cipher carrying a fresh key for this handshake.
+      if (OfferECDH && (hs->Hcip = sessionCF->Cipher(*(hs->Rcip)))) {
+         if (!(hs->Hcip->EnableECDH())) SafeDelete(hs->Hcip);
+      }
       // Extract buffer with public info for the cipher agreement
-      if (!(bpub = hs->Rcip->Public(lpub))) 
+      if (!(bpub = (hs->Hcip ? hs->Hcip : hs->Rcip)->Public(lpub))) 
          return ErrS(hs->ID,ei,bpar,bmai,0, kGSErrNoPublic,
                                          "session",stepstr);
       //
@@ -2287,6 +2312,7 @@ void gsiOptions::Print(XrdOucTrace *t)
          if (vomsfunparms) POPTS(t, " VOMS extraction function parms: ignored (no VOMS extraction function defined)");
       }
       POPTS(t, " MonInfo option: "<< moninfo);
+      POPTS(t, " X25519 key agreement offered: "<< ecdh);
       if (!hashcomp)
          POPTS(t, " Name hashing algorithm compatibility OFF");
    }
@@ -2294,6 +2320,7 @@ void gsiOptions::Print(XrdOucTrace *t)
    POPTS(t, " Crypto modules: "<< (clist ? clist : XrdSecProtocolgsi::DefCrypto));
    POPTS(t, " Ciphers: "<< (cipher ? cipher : XrdSecProtocolgsi::DefCipher));
    POPTS(t, " MDigests: "<< (md ? md : XrdSecProtocolgsi::DefMD));
+   if (keypool > 0) POPTS(t, " Pre-generated keys pool depth: "<< keypool);
    if (trustdns) {
       POPTS(t, " Trusting DNS for hostname checking");
    } else {
@@ -2373,6 +2400,8 @@ char *XrdSecProtocolgsiInit(const char mode,
       //                                     handshake fails.
       //             "XrdSecGSIUSEDEFAULTHASH" If this variable is set only the default
       //                                     name hashing algorithm is used
+      //             "XrdSecGSIKEYPOOL"      Number of pre-generated keys of each
+      //                                     kind kept ready; 0 generate inline [0]
 
       //
       opts.mode = mode;
@@ -2465,6 +2494,11 @@ char *XrdSecProtocolgsiInit(const char mode,
       if (cenv)
          opts.hashcomp = 0;
 
+      // Pool of pre-generated keys
+      cenv = getenv("XrdSecGSIKEYPOOL");
+      if (cenv)
+         opts.keypool = atoi(cenv);
+
       // DNS trusting control
       if ((cenv = getenv("XrdSecGSITRUSTDNS")))
          opts.trustdns = (!strcmp(cenv, "0")) ? false : true;
@@ -2536,6 +2570,8 @@ char *XrdSecProtocolgsiInit(const char mode,
       //              [-vomsfunparms:<voms_function_init_parameters>]
       //              [-defaulthash]
       //              [-trustdns:<0|1>]
+      //              [-keypool:<depth>]
+      //              [-ecdh:<0|1>]
       //
       int debug = -1;
       String clist = "";
@@ -2566,6 +2602,8 @@ char *XrdSecProtocolgsiInit(const char mode,
       int moninfo = 0;
       int hashcomp = 1;
       int trustdns = 1;
+      int keypool = 0;
+      int ecdh = 0;
       char *op = 0;
       while (inParms.GetLine()) { 
          while ((op = inParms.GetToken())) {
@@ -2631,6 +2669,10 @@ char *XrdSecProtocolgsiInit(const char mode,
                hashcomp = 0;
             } else if (!strncmp(op, "-trustdns:",10)) {
                trustdns = atoi(op+10);
+            } else if (!strncmp(op, "-keypool:",9)) {
+               keypool = atoi(op+9);
+            } else if (!strncmp(op, "-ecdh:",6)) {
+               ecdh = atoi(op+6);
             } else {
                PRINT("ignoring unknown switch: "<<op);
             }
@@ -2653,6 +2695,8 @@ char *XrdSecProtocolgsiInit(const char mode,
       opts.moninfo = moninfo;
       opts.hashcomp = hashcomp;
       opts.trustdns = (trustdns <= 0) ? false : true;
+      opts.keypool = (keypool > 0) ? keypool : 0;
+      opts.ecdh = ecdh;
       if (clist.length() > 0)
          opts.clist = (char *)clist.c_str();
       if (certdir.length() > 0)
@@ -3470,8 +3514,12 @@ int XrdSecProtocolgsi::ServerDoCert(XrdSutBuffer *br,  XrdSutBuffer **bm,
          hs->Chain = 0;
          return -1;
       }
-      // Prepare cipher agreement: get a copy of the reference cipher
-      if (!(sessionKey = sessionCF->Cipher(*(hs->Rcip)))) {
+      // Prepare cipher agreement: get a copy of the reference cipher,
+      // unless we prepared one offering X25519
+      if (hs->Hcip) {
+         sessionKey = hs->Hcip;
+         hs->Hcip = 0;
+      } else if (!(sessionKey = sessionCF->Cipher(*(hs->Rcip)))) {
          cmsg = "cannot get reference cipher";
          hs->Chain = 0;
          return -1;
@@ -3549,6 +3597,10 @@ int XrdSecProtocolgsi::ServerDoCert(XrdSutBuffer *br,  XrdSutBuffer **bm,
    }
    // The new chain must be deleted at destruction
    hs->Options |= kOptsDelChn;
+   //
+   // Tag the chain for the verification cache while it only has the CA
+   String vtag;
+   VfyTag(bck, vtag);
 
    // Get hook to parsing function
    XrdCryptoX509ParseBucket_t ParseBucket = sessionCF->X509ParseBucket();
@@ -3565,13 +3617,24 @@ int XrdSecProtocolgsi::ServerDoCert(XrdSutBuffer *br,  XrdSutBuffer **bm,
       return -1;
    }
    //
-   // Verify the chain
-   x509ChainVerifyOpt_t vopt = {0,static_cast<int>(hs->TimeStamp),-1,hs->Crl};
-   XrdCryptoX509Chain::EX509ChainErr ecode = XrdCryptoX509Chain::kNone;
-   if (!(hs->Chain->Verify(ecode, &vopt))) {
-      cmsg = "certificate chain verification failed: ";
-      cmsg += hs->Chain->LastError();
-      return -1;
+   // Verify the chain, unless the very same chain was verified against the
+   // same CA and CRL already; then we only need to reorder it, as verifying
+   // would do
+   if (vtag.length() > 0 && VfyCached(vtag.c_str())) {
+      if (hs->Chain->Reorder() != 0) {
+         cmsg = "certificate chain verification failed: inconsistent chain";
+         return -1;
+      }
+      DEBUG("chain verification result taken from cache");
+   } else {
+      x509ChainVerifyOpt_t vopt = {0,static_cast<int>(hs->TimeStamp),-1,hs->Crl};
+      XrdCryptoX509Chain::EX509ChainErr ecode = XrdCryptoX509Chain::kNone;
+      if (!(hs->Chain->Verify(ecode, &vopt))) {
+         cmsg = "certificate chain verification failed: ";
+         cmsg += hs->Chain->LastError();
+         return -1;
+      }
+      if (vtag.length() > 0) VfyCache(vtag.c_str(), hs->Chain);
    }
 
    //
@@ -4664,6 +4727,7 @@ int XrdSecProtocolgsi::ParseCrypto(String clist)
               XrdCryptoFactory::GetCryptoFactory(hs->CryptoMod.c_str()))) {
             sessionCF->SetTrace(GSITrace->What);
             if (QTRACE(Debug)) sessionCF->Notify();
+            if (!Server && KeyPoolDepth > 0) sessionCF->SetKeyPool(KeyPoolDepth);
             int fid = sessionCF->ID();
             int i = 0;
             // Retrieve the index in local table
@@ -5250,6 +5314,71 @@ XrdSecgsiVOMS_t XrdSecProtocolgsi::LoadVOMSFun(const char *plugin,
 }
 
 
+//_____________________________________________________________________________
+bool XrdSecProtocolgsi::VfyTag(XrdSutBucket *bck, String &tag)
+{
+   // Tag identifying the verification of the client chain in bucket 'bck'
+   // against the CA currently in hs->Chain and the CRL in use: a digest of
+   // the certificates as received plus the CA and CRL versions.
+   // Returns false if the tag could not be computed. 
+
+   tag = "";
+   XrdCryptoX509 *xca = hs->Chain->Begin();
+   XrdCryptoMsgDigest *md = sessionCF->MsgDigest("sha256");
+   if (!xca || !md) {
+      SafeDelete(md);
+      return 0;
+   }
+
+   char vers[128], hex[2*64+1];
+   snprintf(vers, sizeof(vers), "%s:%lld:%lld:%lld", xca->SubjectHash(),
+            (long long)xca->SerialNumber(), (long long)xca->NotAfter(),
+            (hs->Crl ? (long long)hs->Crl->LastUpdate() : 0LL));
+   md->Update(bck->buffer, bck->size);
+   md->Update(vers, strlen(vers));
+   md->Final();
+   if (md->Length()*2 < (int)sizeof(hex)
+       && !XrdSutToHex(md->Buffer(), md->Length(), hex)) tag = hex;
+   delete md;
+   return (tag.length() > 0);
+}
+
+//_____________________________________________________________________________
+bool XrdSecProtocolgsi::VfyCached(const char *tag)
+{
+   // Check whether the chain tagged 'tag' was verified successfully and is
+   // still valid; expired entries are ignored by the hash table.
+
+   XrdSysMutexHelper vfyHelper(mutexVfy);
+   return (cacheVfy.Find(tag) != 0);
+}
+
+//_____________________________________________________________________________
+void XrdSecProtocolgsi::VfyCache(const char *tag, X509Chain *chain)
+{
+   // Record the successful verification of the chain tagged 'tag'. The entry
+   // expires when the first certificate in the chain does.
+   EPNAME("VfyCache");
+
+   time_t notafter = 0;
+   XrdCryptoX509 *xc = chain->Begin();
+   while (xc) {
+      if (!notafter || xc->NotAfter() < notafter) notafter = xc->NotAfter();
+      xc = chain->Next();
+   }
+   int ttl = (int)(notafter - time(0));
+   if (ttl <= 0) return;
+
+   XrdSysMutexHelper vfyHelper(mutexVfy);
+   // Drop the entries that expired every now and then
+   if (++nVfyAdds >= 1024) {
+      cacheVfy.Apply(VfyPurge, 0);
+      nVfyAdds = 0;
+   }
+   cacheVfy.Add(tag, 0, ttl, Hash_data_is_key);
+   DEBUG("chain verification cached for "<<ttl<<" secs");
+}
+
 //_____________________________________________________________________________
 bool XrdSecProtocolgsi::ServerCertNameOK(const char *subject, XrdOucString &emsg)
 {
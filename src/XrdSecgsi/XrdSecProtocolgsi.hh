@@ -200,6 +200,8 @@ public:
    char  *vomsfunparms;// [s] parameters for the function to fill VOMS [0]
    int    moninfo; // [s] 0 do not look for; 1 use DN as default
    int    hashcomp; // [cs] 1 send hash names with both algorithms; 0 send only the default [1]
+   int    keypool; // [cs] depth of the pool of pre-generated keys; 0 generate inline [0]
+   int    ecdh;   // [s] 1 offer X25519 key agreement for the session cipher [0]
 
    bool   trustdns; // [cs] 'true' if DNS is trusted [true]
 
@@ -211,7 +213,8 @@ public:
                   gmapfun = 0; gmapfunparms = 0; authzfun = 0; authzfunparms = 0; authzto = -1;
                   ogmap = 1; dlgpxy = 0; sigpxy = 1; srvnames = 0;
                   exppxy = 0; authzpxy = 0;
-                  vomsat = 1; vomsfun = 0; vomsfunparms = 0; moninfo = 0; hashcomp = 1; trustdns = true; }
+                  vomsat = 1; vomsfun = 0; vomsfunparms = 0; moninfo = 0; hashcomp = 1; trustdns = true;
+                  keypool = 0; ecdh = 0; }
    virtual ~gsiOptions() { } // Cleanup inside XrdSecProtocolgsiInit
    void Print(XrdOucTrace *t); // Print summary of gsi option status
 };
@@ -345,6 +348,8 @@ private:
    static int              MonInfoOpt;
    static bool             HashCompatibility;
    static bool             TrustDNS;
+   static int              KeyPoolDepth;
+   static bool             OfferECDH;
    //
    // Crypto related info
    static int              ncrypt;                  // Number of factories
@@ -359,6 +364,9 @@ private:
    static XrdSutCache   cachePxy;  // Client proxies cache; 
    static XrdSutCache   cacheGMAPFun; // Cache for entries mapped by GMAPFun
    static XrdSutCache   cacheAuthzFun; // Cache for entities filled by AuthzFun
+   static XrdOucHash<char> cacheVfy;  // Client chains recently verified
+   static XrdSysMutex      mutexVfy;  // mutex to control access to cacheVfy
+   static int              nVfyAdds;  // Additions since cacheVfy was purged
    //
    // Services
    static XrdOucGMap      *servGMap;  // Grid mapping service 
@@ -427,6 +435,11 @@ private:
    static int     VerifyCRL(XrdCryptoX509Crl *crl, XrdCryptoX509 *xca, XrdOucString crldir,
                            XrdCryptoFactory *CF, int hashalg);
    bool           ServerCertNameOK(const char *subject, String &e);
+
+   // Cache of client chain verifications
+   bool           VfyTag(XrdSutBucket *bck, String &tag);
+   static bool    VfyCached(const char *tag);
+   static void    VfyCache(const char *tag, X509Chain *chain);
    static XrdSutCacheEntry *GetSrvCertEnt(XrdSutCERef   &gcref,
                                        XrdCryptoFactory *cf,
                                        time_t timestamp, String &cal);
@@ -489,6 +502,7 @@ public:
    String            CryptoMod;     // crypto module in use
    int               RemVers;       // Version run by remote counterpart
    XrdCryptoCipher  *Rcip;          // reference cipher
+   XrdCryptoCipher  *Hcip;          // handshake cipher offering X25519 (servers)
    XrdSutBucket     *Cbck;          // Bucket with the certificate in export form
    String            ID;            // Handshake ID (dummy for clients)
    XrdSutPFEntry    *Cref;          // Cache reference
@@ -504,12 +518,13 @@ public:
    XrdSutBuffer     *Parms;         // Buffer with server parms on first iteration 
 
    gsiHSVars() { Iter = 0; TimeStamp = -1; CryptoMod = "";
-                 RemVers = -1; Rcip = 0;
+                 RemVers = -1; Rcip = 0; Hcip = 0;
                  Cbck = 0;
                  ID = ""; Cref = 0; Pent = 0; Chain = 0; Crl = 0; PxyChain = 0;
                  RtagOK = 0; Tty = 0; LastStep = 0; Options = 0; HashAlg = 0; Parms = 0;}
 
    ~gsiHSVars() { SafeDelete(Cref);
+                  SafeDelete(Hcip);
                   if (Options & kOptsDelChn) {
                      // Do not delete the CA certificate in the cached reference
                      if (Chain) Chain->Cleanup(1);
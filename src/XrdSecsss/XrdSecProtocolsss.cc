@@ -78,7 +78,8 @@ int            XrdSecProtocolsss::deltaTime  =13;
 int            XrdSecProtocolsss::ktFixed    = 0;
 
 struct XrdSecProtocolsss::Crypto XrdSecProtocolsss::CryptoTab[] = {
-       {"bf32", XrdSecsssRR_Hdr::etBFish32},
+       {"bf32",   XrdSecsssRR_Hdr::etBFish32},
+       {"aes256", XrdSecsssRR_Hdr::etAES256},
        {0, '0'}
        };
   
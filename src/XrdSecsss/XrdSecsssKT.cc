@@ -29,6 +29,7 @@
 /******************************************************************************/
 
 #include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -36,6 +37,9 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
 
 #include "XrdSecsss/XrdSecsssKT.hh"
 
@@ -57,11 +61,10 @@ int XrdSecsssKT::randFD = -1;
 void *XrdSecsssKTRefresh(void *Data)
 {
    XrdSecsssKT *theKT = (XrdSecsssKT *)Data;
-   struct timespec naptime = {theKT->RefrTime(), 0};
 
-// Loop and check if keytab has changed
+// Loop and check if keytab has changed (this never returns)
 //
-   while(1) {nanosleep(&naptime, 0); theKT->Refresh();}
+   theKT->Watch();
 
    return (void *)0;
 }
@@ -80,7 +83,7 @@ XrdSecsssKT::XrdSecsssKT(XrdOucErrInfo *eInfo, const char *kPath,
 
 // Do some common initialization
 //
-   ktRefID= 0;
+   ktRefID= 0; ktWatchFD = -1;
    ktPath = (kPath ? strdup(kPath) : 0);
    ktList = 0; kthiID = 0; ktMode = oMode; ktRefT = (time_t)refrInt;
    if (eInfo) eInfo->setErrCode(0);
@@ -110,8 +113,9 @@ XrdSecsssKT::XrdSecsssKT(XrdOucErrInfo *eInfo, const char *kPath,
 
 // Now read in the whole key table and start possible refresh thread
 //
-   if ((ktList = getKeyTab(eInfo, sbuf.st_mtime, sbuf.st_mode))
-   && (oMode != isAdmin) && (!eInfo || eInfo->getErrInfo() == 0))
+   ktList = getKeyTab(eInfo, sbuf.st_mtime, sbuf.st_mode);
+   doIndex();
+   if (ktList && (oMode != isAdmin) && (!eInfo || eInfo->getErrInfo() == 0))
       {if ((retc = XrdSysThread::Run(&ktRefID,XrdSecsssKTRefresh, (void *)this,
                                      XRDSYSTHREAD_HOLD)))
           {eMsg("sssKT", errno, eText); eInfo->setErrInfo(-1, eText);}
@@ -139,6 +143,7 @@ XrdSecsssKT::~XrdSecsssKT()
 
 // Now we can safely clean up
 //
+   if (ktWatchFD >= 0) {close(ktWatchFD); ktWatchFD = -1;}
    if (ktPath) {free(ktPath); ktPath = 0;}
 
    while((ktP = ktList)) {ktList = ktList->Next; delete ktP;}
@@ -171,6 +176,7 @@ void XrdSecsssKT::addKey(ktEnt &ktNew)
    if (ktPP) ktPP->Next = &ktNew;
       else   ktList     = &ktNew;
    ktNew.Next = ktP;
+   doIndex();
 }
 
 /******************************************************************************/
@@ -192,6 +198,7 @@ int XrdSecsssKT::delKey(ktEnt &ktDel)
             } else {ktPP = ktP; ktP = ktP->Next;}
         }
 
+   if (nDel) doIndex();
    return nDel;
 }
 
@@ -211,8 +218,11 @@ int XrdSecsssKT::getKey(ktEnt &theEnt)
 // Find first key by key name (used normally by clients) or by keyID
 //
    if (!*theEnt.Data.Name)
-      {if (theEnt.Data.ID >= 0) 
-          while(ktP && ktP->Data.ID != theEnt.Data.ID)  ktP = ktP->Next;
+      {if (theEnt.Data.ID >= 0)
+          {std::unordered_map<long long, ktEnt *>::iterator it;
+           it  = ktByID.find(theEnt.Data.ID);
+           ktP = (it == ktByID.end() ? 0 : it->second);
+          }
       }
       else {while(ktP && strcmp(ktP->Data.Name,theEnt.Data.Name)) ktP=ktP->Next;
             while(ktP && ktP->Data.Exp <= time(0))
@@ -299,7 +309,7 @@ void XrdSecsssKT::genKey(char *kBP, int kLen)
 /*                               R e f r e s h                                */
 /******************************************************************************/
   
-void XrdSecsssKT::Refresh()
+void XrdSecsssKT::Refresh(bool force)
 {
    XrdOucErrInfo eInfo;
    ktEnt *ktNew, *ktOld, *ktNext;
@@ -309,13 +319,14 @@ void XrdSecsssKT::Refresh()
 // Get change time of keytable and if changed, update it
 //
    if (stat(ktPath, &sbuf) == 0)
-      {if (sbuf.st_mtime == ktMtime) return;
+      {if (!force && sbuf.st_mtime == ktMtime) return;
        if ((ktNew = getKeyTab(&eInfo, sbuf.st_mtime, sbuf.st_mode))
        && eInfo.getErrInfo() == 0)
-          {myMutex.Lock(); ktOld = ktList; ktList = ktNew; myMutex.UnLock();
+          {myMutex.Lock(); ktOld = ktList; ktList = ktNew; doIndex();
+           myMutex.UnLock();
           } else ktOld = ktNew;
        while(ktOld) {ktNext = ktOld->Next; delete ktOld; ktOld = ktNext;}
-       if ((retc == eInfo.getErrInfo()) == 0) return;
+       if (!(retc = eInfo.getErrInfo())) return;
       } else retc = errno;
 
 // Refresh failed
@@ -387,9 +398,84 @@ int XrdSecsssKT::Rewrite(int Keep, int &numKeys, int &numTot, int &numExp)
    return retc;
 }
 
+/******************************************************************************/
+/*                                 W a t c h                                  */
+/******************************************************************************/
+
+void XrdSecsssKT::Watch()
+{
+   struct timespec naptime = {ktRefT, 0};
+#ifdef __linux__
+   static const int evMask = IN_CLOSE_WRITE | IN_MOVED_TO;
+   struct inotify_event *evP;
+   struct pollfd pollFD;
+   char evBuff[4096] __attribute__ ((aligned(__alignof__(inotify_event))));
+   char *fName, *ktDir;
+   int n, pos, wMS = (ktRefT < 2147483 ? ktRefT*1000 : 2147483647);
+   bool isKT;
+
+// Watch the directory of the keytab, it is usually replaced by a rename. The
+// periodic check is kept should events not be delivered (e.g. NFS).
+//
+   ktDir = strdup(ktPath);
+   if ((fName = rindex(ktDir, '/'))) *fName++ = 0;
+      else fName = ktDir;
+   if ((ktWatchFD = inotify_init1(IN_CLOEXEC)) >= 0
+   &&  inotify_add_watch(ktWatchFD, (fName != ktDir ? (*ktDir ? ktDir : "/")
+                                                    : "."), evMask) < 0)
+      {eMsg("Watch", errno, "Unable to watch keytable ", ktPath);
+       close(ktWatchFD); ktWatchFD = -1;
+      }
+
+// Reload the keytab as soon as it is rewritten
+//
+   if (ktWatchFD >= 0)
+      {pollFD.fd = ktWatchFD; pollFD.events = POLLIN;
+       while(1)
+            {pollFD.revents = 0;
+             if ((n = poll(&pollFD, 1, wMS)) < 0)
+                {if (errno == EINTR) continue;
+                 break;
+                }
+             if (!n) {Refresh(); continue;}
+             if ((n = read(ktWatchFD, evBuff, sizeof(evBuff))) <= 0) continue;
+             isKT = false;
+             for (pos = 0; pos < n; pos += sizeof(inotify_event) + evP->len)
+                 {evP = (struct inotify_event *)(evBuff + pos);
+                  if (evP->len && !strcmp(evP->name, fName)) isKT = true;
+                 }
+             if (isKT) Refresh(true);
+            }
+       eMsg("Watch", errno, "Unable to watch keytable ", ktPath);
+      }
+   free(ktDir);
+#endif
+
+// Loop and check if keytab has changed
+//
+   while(1) {nanosleep(&naptime, 0); Refresh();}
+}
+
 /******************************************************************************/
 /*                       P r i v a t e   M e t h o d s                        */
 /******************************************************************************/
+/******************************************************************************/
+/*                               d o I n d e x                                */
+/******************************************************************************/
+
+// The caller must hold myMutex unless no other thread can as yet see ktList.
+// Only the first key for an ID is indexed, which is what a scan would find.
+//
+void XrdSecsssKT::doIndex()
+{
+   ktEnt *ktP = ktList;
+
+   ktByID.clear();
+   while(ktP) {ktByID.insert(std::make_pair(ktP->Data.ID, ktP));
+               ktP = ktP->Next;
+              }
+}
+
 /******************************************************************************/
 /*                                  e M s g                                   */
 /******************************************************************************/
@@ -32,6 +32,7 @@
   
 #include <string.h>
 #include <time.h>
+#include <unordered_map>
 #include "XrdSys/XrdSysPthread.hh"
 
 class XrdOucErrInfo;
@@ -99,10 +100,12 @@ int    getKey(ktEnt &ktEql);
 
 ktEnt *keyList() {return ktList;}
 
-void   Refresh();
+void   Refresh(bool force=false);
 
 time_t RefrTime() {return ktRefT;}
 
+void   Watch();
+
 int    Rewrite(int Keep, int &numKeys, int &numTot, int &numExp);
 
 int    Same(const char *path) {return (ktPath && !strcmp(ktPath, path));}
@@ -116,6 +119,7 @@ enum   xMode {isAdmin = 0, isClient, isServer};
       ~XrdSecsssKT();
 
 private:
+void   doIndex();
 int    eMsg(const char *epn, int rc, const char *txt1,
             const char *txt2=0, const char *txt3=0, const char *txt4=0);
 ktEnt *getKeyTab(XrdOucErrInfo *eInfo, time_t Mtime, mode_t Amode);
@@ -128,11 +132,13 @@ ktEnt *ktDecode0(XrdOucStream &kTab, XrdOucErrInfo *eInfo);
 XrdSysMutex myMutex;
 char       *ktPath;
 ktEnt      *ktList;
+std::unordered_map<long long, ktEnt *> ktByID; // Index of ktList by key ID
 time_t      ktMtime;
 xMode       ktMode;
 time_t      ktRefT;
 int         kthiID;
 pthread_t   ktRefID;
+int         ktWatchFD;
 static int  randFD;
 };
 #endif
@@ -41,6 +41,7 @@ char      ProtID[4];                 // Protocol ID ("sss")
 char      Pad[3];                    // Padding bytes
 char      EncType;                   // Encryption type as one of:
 static const char etBFish32 = '0';   // Blowfish
+static const char etAES256  = '1';   // AES-256 GCM
 
 long long KeyID;                     // Key ID for encryption
 };
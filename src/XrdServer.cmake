@@ -45,6 +45,7 @@ add_library(
   XrdXrootd/XrdXrootdTransSend.cc       XrdXrootd/XrdXrootdTransSend.hh
   XrdXrootd/XrdXrootdXeq.cc
   XrdXrootd/XrdXrootdXeqAio.cc
+  XrdXrootd/XrdXrootdXio.cc             XrdXrootd/XrdXrootdXio.hh
                                         XrdXrootd/XrdXrootdTrace.hh
                                         XrdXrootd/XrdXrootdXPath.hh
                                         XrdXrootd/XrdXrootdReqID.hh
@@ -66,6 +67,7 @@ add_library(
   XrdOfs/XrdOfsStats.cc         XrdOfs/XrdOfsStats.hh
   XrdOfs/XrdOfsTPC.cc           XrdOfs/XrdOfsTPC.hh
   XrdOfs/XrdOfsTPCAuth.cc       XrdOfs/XrdOfsTPCAuth.hh
+                                XrdOfs/XrdOfsTPCEngine.hh
   XrdOfs/XrdOfsTPCJob.cc        XrdOfs/XrdOfsTPCJob.hh
   XrdOfs/XrdOfsTPCInfo.cc       XrdOfs/XrdOfsTPCInfo.hh
   XrdOfs/XrdOfsTPCProg.cc       XrdOfs/XrdOfsTPCProg.hh
@@ -104,6 +106,7 @@ add_library(
   XrdOss/XrdOssCopy.cc         XrdOss/XrdOssCopy.hh
   XrdOss/XrdOssCreate.cc
                                XrdOss/XrdOssOpaque.hh
+  XrdOss/XrdOssFdCache.cc      XrdOss/XrdOssFdCache.hh
   XrdOss/XrdOssMio.cc          XrdOss/XrdOssMio.hh
                                XrdOss/XrdOssMioFile.hh
   XrdOss/XrdOssMSS.cc
@@ -113,9 +116,11 @@ add_library(
   XrdOss/XrdOssSpace.cc        XrdOss/XrdOssSpace.hh
   XrdOss/XrdOssStage.cc        XrdOss/XrdOssStage.hh
   XrdOss/XrdOssStat.cc         XrdOss/XrdOssStatInfo.hh
+  XrdOss/XrdOssStatCache.cc    XrdOss/XrdOssStatCache.hh
                                XrdOss/XrdOssUnlink.cc
                                XrdOss/XrdOssError.hh
                                XrdOss/XrdOss.hh
+  XrdOss/XrdOssUring.cc        XrdOss/XrdOssUring.hh
 
   #-----------------------------------------------------------------------------
   # XrdAcc - Authorization
@@ -164,7 +169,8 @@ target_link_libraries(
   ${CMAKE_DL_LIBS}
   pthread
   ${EXTRA_LIBS}
-  ${SOCKET_LIBRARY} )
+  ${SOCKET_LIBRARY}
+  ${ZLIB_LIBRARY} )
 
 set_target_properties(
   XrdServer
@@ -34,6 +34,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include "XrdOuc/XrdOucCRC.hh"
 #include "XrdOuc/XrdOucErrInfo.hh"
 #include "XrdOuc/XrdOucIOVec.hh"
 #include "XrdOuc/XrdOucSFVec.hh"
@@ -827,6 +828,33 @@ virtual XrdSfsXferSize readv(XrdOucIOVec      *readV,
                              return totbytes;
                             }
 
+//-----------------------------------------------------------------------------
+//! Read file pages into a buffer and return the CRC32C checksum of each page.
+//! Pages are XrdOucCRC::PageSize bytes aligned on file offsets, so the first
+//! and the last page may be short. The default implementation reads the data
+//! and computes the checksums; implementations that store per-page checksums
+//! should override it to return them (they must correspond to the data).
+//!
+//! @param  offset  - The offset where the read is to start.
+//! @param  buffer  - pointer to buffer where the bytes are to be placed.
+//! @param  size    - The number of bytes to read.
+//! @param  csvec   - pointer to a vector where the checksums are to be placed.
+//!                   It must hold XrdOucCRC::PgCount(offset, size) values.
+//!
+//! @return >= 0      The number of bytes that placed in buffer.
+//! @return SFS_ERROR File could not be read, error holds the reason.
+//-----------------------------------------------------------------------------
+
+virtual XrdSfsXferSize pgRead(XrdSfsFileOffset   offset,
+                              char              *buffer,
+                              XrdSfsXferSize     size,
+                              uint32_t          *csvec)
+                             {XrdSfsXferSize rdsz = read(offset, buffer, size);
+                              if (rdsz > 0)
+                                 XrdOucCRC::Calc32C(buffer, rdsz, offset, csvec);
+                              return rdsz;
+                             }
+
 //-----------------------------------------------------------------------------
 //! Send file bytes via a XrdSfsDio sendfile object to a client (optional).
 //!
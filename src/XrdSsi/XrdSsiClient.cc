@@ -29,6 +29,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <string>
 #include <string.h>
@@ -72,6 +73,7 @@ extern XrdSsiLogger::MCB_t *msgCBCl;
        XrdCl::Env   *clEnvP   = 0;
        short         maxTCB   = 300;
        short         maxCLW   =  30;
+       int           maxReqs  =   0;
        Atomic(bool)  initDone(false);
        bool          dsTTLSet = false;
        bool          reqTOSet = false;
@@ -114,6 +116,7 @@ virtual       ~XrdSsiClientProvider() {}
 
 private:
 void SetLogger();
+void SetMaxReqs();
 void SetScheduler();
 };
 
@@ -141,6 +144,7 @@ XrdSsiService *XrdSsiClientProvider::GetService(XrdSsiErrInfo     &eInfo,
       if (!dsTTLSet) clEnvP->PutInt("DataServerTTL",  maxTMO);
       if (!reqTOSet) clEnvP->PutInt("RequestTimeout", maxTMO);
       if (!strTOSet) clEnvP->PutInt("StreamTimeout",  maxTMO);
+      SetMaxReqs();
       initDone = true;
       clMutex.UnLock();
      }
@@ -220,6 +224,28 @@ void XrdSsiClientProvider::SetLogger()
       }
 }
   
+/******************************************************************************/
+/*      X r d S s i C l i e n t P r o v i d e r : : S e t M a x R e q s       */
+/******************************************************************************/
+
+// The number of requests a session keeps in flight at the server is bounded
+// by XRDSSIMAXREQS, if set. Additional requests are queued at the client and
+// sent, in order, as earlier ones finish. This keeps bursts of requests from
+// overloading the server.
+//
+void XrdSsiClientProvider::SetMaxReqs()
+{
+   const char *cP = getenv("XRDSSIMAXREQS");
+   char *eP;
+   long n;
+
+   if (!cP) return;
+   n = strtol(cP, &eP, 10);
+   if (*eP || n < 0 || n > 0x7fffffff)
+      Log.Emsg("Config", "Invalid XRDSSIMAXREQS value; ignoring", cP);
+      else maxReqs = static_cast<int>(n);
+}
+
 /******************************************************************************/
 /*    X r d S s i C l i e n t P r o v i d e r : : S e t S c h e d u l e r     */
 /******************************************************************************/
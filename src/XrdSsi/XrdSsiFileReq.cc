@@ -29,8 +29,10 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <arpa/inet.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "XrdOuc/XrdOucBuffer.hh"
 #include "XrdOuc/XrdOucERoute.hh"
@@ -78,6 +80,13 @@ using namespace XrdSsi;
 
 namespace
 {
+long long Now() // Monotonic clock in microseconds
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return static_cast<long long>(ts.tv_sec)*1000000 + ts.tv_nsec/1000;
+}
+
 const char     *rspstID[XrdSsiFileReq::isMax] =
                                       {" [new",   " [begun", " [bound",
                                        " [abort", " [done"
@@ -124,8 +133,10 @@ void XrdSsiFileReq::Activate(XrdOucBuffer *oP, XrdSfsXioHandle *bR, int rSz)
    sfsBref = bR;
    reqSize = rSz;
 
-// Now schedule ourselves to process this request. The state is new.
+// Now schedule ourselves to process this request. The state is new. Record
+// when so we can tell how long requests wait for a thread to process them.
 //
+   schedTime = Now();
    Sched->Schedule((XrdJob *)this);
 }
 
@@ -309,6 +320,7 @@ void XrdSsiFileReq::DoIt()
                          DEBUGXQ("Calling service processor");
                          frqMutex.UnLock();
                          Stats.Bump(Stats.ReqProcs);
+                         Stats.QTime(Now() - schedTime);
                          Service->ProcessRequest((XrdSsiRequest      &)*this,
                                                  (XrdSsiFileResource &)*fileR);
                          return;
@@ -557,7 +569,9 @@ void XrdSsiFileReq::Init(const char *cID)
    reqSize    = 0;
    respBuf    = 0;
    respOff    = 0;
+   schedTime  = 0;
    fileSz     = 0; // Also does respLen = 0;
+   respIdx    = 0;
    myState    = wtReq;
    urState    = isNew;
   *rID        = 0;
@@ -615,6 +629,13 @@ bool XrdSsiFileReq::ProcessResponse(const XrdSsiErrInfo  &eInfo,
                respLen = 0;
                Stats.Bump(Stats.RspStrm);
                break;
+          case XrdSsiRespInfo::isIOVec:
+               fileSz  = 0;
+               for (int i = 0; i < Resp.iovcnt; i++) fileSz += Resp.iovP[i].iov_len;
+               respIdx = 0;
+               DEBUGXQ("Resp iovec cnt="<<Resp.iovcnt<<" sz="<<fileSz);
+               Stats.Bump(Stats.RspData);
+               break;
           default:
                DEBUGXQ("Resp invalid!!!!");
                return false;
@@ -696,6 +717,23 @@ XrdSfsXferSize XrdSsiFileReq::Read(bool           &done,      // Out
                done = strmEOF && strBuff == 0;
                return nbytes;
                break;
+          case XrdSsiRespInfo::isIOVec:
+               if (fileSz <= 0) {done = true; myState = odRsp; return 0;}
+               if (blen > fileSz) blen = fileSz;
+               nbytes = 0;
+               while(nbytes < blen)
+                    {const struct iovec *iov = &(Resp->iovP[respIdx]);
+                     long long seglen = (long long)iov->iov_len - respOff;
+                     if (seglen > blen - nbytes) seglen = blen - nbytes;
+                     memcpy(buff+nbytes, (char *)iov->iov_base+respOff, seglen);
+                     nbytes += seglen; respOff += seglen;
+                     if (respOff >= (long long)iov->iov_len)
+                        {respIdx++; respOff = 0;}
+                    }
+               fileSz -= nbytes;
+               if (!fileSz) {myState = odRsp; done = true;}
+               return nbytes;
+               break;
           default: break;
          };
 
@@ -837,8 +875,8 @@ int XrdSsiFileReq::Send(XrdSfsDio *sfDio, XrdSfsXferSize blen)
 {
    static const char *epname = "send";
    XrdSsiRespInfo const *Resp = XrdSsiRRAgent::RespP(this);
-   XrdOucSFVec sfVec[2];
-   int rc;
+   XrdOucSFVec sfVec[XrdOucSFVec::sfMax];
+   int rc, sfN = 2;
 
 // A send should never be issued unless a response has been set. Return a
 // continuation which will cause Read() to be called to return the error.
@@ -874,6 +912,13 @@ int XrdSsiFileReq::Send(XrdSfsDio *sfDio, XrdSfsXferSize blen)
                if (Resp->strmP->Type() == XrdSsiStream::isPassive) return 1;
                return sendStrmA(Resp->strmP, sfDio, blen);
                break;
+          case XrdSsiRespInfo::isIOVec:
+               if (fileSz > 0)
+                  {if (blen > fileSz) blen = fileSz;
+                   if (!(sfN = sendIOV(Resp->iovP, sfVec, blen))) return 1;
+                   if (!fileSz) myState = odRsp;
+                  } else blen = 0;
+               break;
           default: myState = erRsp;
                    return Emsg(epname, EFAULT, "send");
                    break;
@@ -881,9 +926,9 @@ int XrdSsiFileReq::Send(XrdSfsDio *sfDio, XrdSfsXferSize blen)
 
 // Send off the data
 //
-   if (!blen) {sfVec[1].buffer = rID; myState = odRsp;}
-   sfVec[1].sendsz = blen;
-   rc = sfDio->SendFile(sfVec, 2);
+   if (!blen) {sfVec[1].buffer = rID; myState = odRsp; sfN = 2;}
+   if (sfN == 2) sfVec[1].sendsz = blen;
+   rc = sfDio->SendFile(sfVec, sfN);
 
 // If send succeeded, indicate the action to be taken
 //
@@ -896,6 +941,38 @@ int XrdSsiFileReq::Send(XrdSfsDio *sfDio, XrdSfsXferSize blen)
    return Emsg(epname, rc, "send");
 }
 
+/******************************************************************************/
+/* Private:                      s e n d I O V                                */
+/******************************************************************************/
+
+// Describe the next blen bytes of an iovec response in sfVec[1..n], which
+// lets them be sent from where they reside. Returns n+1, or zero when the data
+// spans more segments than a single send can hold; the caller then has the
+// data copied via Read(). The response position only advances upon success.
+//
+int XrdSsiFileReq::sendIOV(const struct iovec *iovP, XrdOucSFVec *sfVec,
+                           XrdSfsXferSize blen)
+{
+   long long seglen, segOff = respOff;
+   int sfN = 1, segIdx = respIdx, xlen = blen;
+
+   while(xlen > 0)
+        {if (sfN >= XrdOucSFVec::sfMax) return 0;
+         seglen = (long long)iovP[segIdx].iov_len - segOff;
+         if (seglen > xlen) seglen = xlen;
+         if (seglen > 0)
+            {sfVec[sfN].buffer = (char *)iovP[segIdx].iov_base + segOff;
+             sfVec[sfN].sendsz = seglen;
+             sfVec[sfN].fdnum  = -1;
+             sfN++; xlen -= seglen; segOff += seglen;
+            }
+         if (segOff >= (long long)iovP[segIdx].iov_len) {segIdx++; segOff = 0;}
+        }
+
+   respIdx = segIdx; respOff = segOff; fileSz -= blen;
+   return sfN;
+}
+
 /******************************************************************************/
 /* Private:                    s e n d S t r m A                              */
 /******************************************************************************/
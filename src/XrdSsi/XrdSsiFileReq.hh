@@ -40,7 +40,9 @@
 #include "XrdSsi/XrdSsiStream.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
+struct iovec;
 class  XrdOucErrInfo;
+struct XrdOucSFVec;
 class  XrdSfsXioHandle;
 class  XrdSsiAlert;
 class  XrdSsiFileResource;
@@ -124,6 +126,8 @@ XrdSfsXferSize         readStrmA(XrdSsiStream *strmP, char *buff,
                                  XrdSfsXferSize blen);
 XrdSfsXferSize         readStrmP(XrdSsiStream *strmP, char *buff,
                                  XrdSfsXferSize blen);
+int                    sendIOV(const struct iovec *iovP, XrdOucSFVec *sfVec,
+                               XrdSfsXferSize blen);
 int                    sendStrmA(XrdSsiStream *strmP, XrdSfsDio *sfDio,
                                  XrdSfsXferSize blen);
 void                   Recycle();
@@ -151,9 +155,11 @@ XrdSsiFileResource    *fileR;
 XrdSsiFileSess        *fileP;
 char                  *respBuf;
 long long              respOff;
+long long              schedTime;
 union {long long       fileSz;
        int             respLen;
       };
+int                    respIdx;
 XrdSfsXioHandle       *sfsBref;
 XrdOucBuffer          *oucBuff;
 XrdSsiStream::Buffer  *strBuff;
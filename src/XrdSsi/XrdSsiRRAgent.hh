@@ -64,5 +64,13 @@ static void            ResetResponder(XrdSsiResponder *rP)
 
 static void            SetMutex(XrdSsiRequest *rP, XrdSsiMutex *mP)
                                {rP->rrMutex = mP;}
+
+static bool            TakeBack(XrdSsiRequest *rP, XrdSsiResponder *respP)
+                               {rP->rrMutex->Lock();
+                                bool isOK = (rP->theRespond == respP);
+                                if (isOK) rP->theRespond = 0;
+                                rP->rrMutex->UnLock();
+                                return isOK;
+                               }
 };
 #endif
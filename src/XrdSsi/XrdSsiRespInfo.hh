@@ -39,6 +39,7 @@
 //-----------------------------------------------------------------------------
 
 class XrdSsiStream;
+struct iovec;
 
 struct  XrdSsiRespInfo
        {union {const char   *buff;    //!< ->buffer     when rType == isData
@@ -46,16 +47,19 @@ struct  XrdSsiRespInfo
                const char   *eMsg;    //!< ->msg text   when rType == isError
                long long     fsize;   //!< ->file size  when rType == isFile
                XrdSsiStream *strmP;   //!< ->SsiStream  when rType == isStream
+         const struct iovec *iovP;    //!< ->iovec      when rType == isIOVec
               };
         union {      int     blen;    //!<   buffer len When rType == isData
                                       //!<   buffer len When rType == isHandle
                      int     eNum;    //!<   errno      When rType == isError
                      int     fdnum;   //!<   filedesc   When rType == isFile
+                     int     iovcnt;  //!<   elements   When rType == isIOVec
               };
                      int     mdlen;   //!<    Metadata length
                const char   *mdata;   //!< -> Metadata about response.
 
-        enum   Resp_t {isNone = 0, isData, isError, isFile, isStream, isHandle};
+        enum   Resp_t {isNone = 0, isData, isError, isFile, isStream, isHandle,
+                       isIOVec};
         Resp_t rType;
 
         inline void  Init() {fsize=0; blen=0; mdlen=0; mdata=0; rType=isNone;}
@@ -65,6 +69,7 @@ struct  XrdSsiRespInfo
                                     if (rType == isHandle) return "isHandle";
                                     if (rType == isFile  ) return "isFile";
                                     if (rType == isStream) return "isStream";
+                                    if (rType == isIOVec ) return "isIOVec";
                                     if (rType == isNone  ) return "isNone";
                                     return "isUndef";
                                    }
@@ -27,6 +27,8 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <sys/uio.h>
+
 #include "XrdSsi/XrdSsiAtomics.hh"
 #include "XrdSsi/XrdSsiResponder.hh"
 #include "XrdSsi/XrdSsiRRAgent.hh"
@@ -307,6 +309,33 @@ XrdSsiResponder::Status XrdSsiResponder::SetResponse(XrdSsiStream *strmP)
    SSI_XEQ_RESPONSE;
 }
 
+/******************************************************************************/
+
+XrdSsiResponder::Status XrdSsiResponder::SetResponse(const struct iovec *iov,
+                                                           int           iovcnt)
+{
+
+// Validate object for a response
+//
+   SSI_VAL_RESPONSE;
+
+// An empty vector is simply a nil response
+//
+   if (!iov || iovcnt <= 0)
+      {reqP->Resp.buff  = 0;
+       reqP->Resp.blen  = 0;
+       reqP->Resp.rType = XrdSsiRespInfo::isData;
+      } else {
+       reqP->Resp.iovP   = iov;
+       reqP->Resp.iovcnt = iovcnt;
+       reqP->Resp.rType  = XrdSsiRespInfo::isIOVec;
+      }
+
+// Complete the response
+//
+   SSI_XEQ_RESPONSE;
+}
+
 /******************************************************************************/
 /*                         U n B i n d R e q u e s t                          */
 /******************************************************************************/
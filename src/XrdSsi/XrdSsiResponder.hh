@@ -235,6 +235,25 @@ inline Status  SetNilResponse() {return SetResponse((const char *)0,0);}
 
        Status  SetResponse(XrdSsiStream *strmP);
 
+//-----------------------------------------------------------------------------
+//! Set a list of memory buffers containing data as the request response. The
+//! buffers are sent in order, as if they were one buffer, directly from where
+//! they reside (i.e. without being copied into an intermediate buffer). This
+//! avoids assembling large responses made up of separately allocated pieces.
+//!
+//! @param  iov    pointer to the vector describing the buffers. The vector
+//!                and the buffers must remain valid until
+//!                XrdSsiResponder::Finished() is called.
+//! @param  iovcnt the number of elements in iov.
+//!
+//! @return       See Status enum for possible values.
+//!
+//! @note Remote clients see this as a data response of the combined length.
+//!       Requests issued in-process receive the isIOVec response as is.
+//-----------------------------------------------------------------------------
+
+       Status  SetResponse(const struct iovec *iov, int iovcnt);
+
 //-----------------------------------------------------------------------------
 //! This class is meant to be inherited by an object that will actually posts
 //! responses.
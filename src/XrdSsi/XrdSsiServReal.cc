@@ -30,8 +30,12 @@
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
   
+#include "Xrd/XrdJob.hh"
+#include "Xrd/XrdScheduler.hh"
 #include "XrdSsi/XrdSsiResource.hh"
+#include "XrdSsi/XrdSsiResponder.hh"
 #include "XrdSsi/XrdSsiRRAgent.hh"
 #include "XrdSsi/XrdSsiScale.hh"
 #include "XrdSsi/XrdSsiServReal.hh"
@@ -46,10 +50,74 @@
 namespace XrdSsi
 {
        XrdSsiScale   sidScale;
+extern XrdScheduler *schedP;
+extern int           maxReqs;
 }
 
 using namespace XrdSsi;
 
+namespace
+{
+long long Now() // Monotonic clock in microseconds
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return static_cast<long long>(ts.tv_sec)*1000000 + ts.tv_nsec/1000;
+}
+}
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+// A request that has to wait because the service already has as many requests
+// in flight as it is allowed is bound to one of these until it can be sent.
+// This lets the requester cancel it in the usual way, by calling Finished().
+//
+class XrdSsiServPend : public XrdSsiResponder
+{
+public:
+
+void  Finished(      XrdSsiRequest  &rqstR,
+               const XrdSsiRespInfo &rInfo,
+                     bool            cancel=false)
+              {std::deque<XrdSsiServPend *>::iterator it;
+               servP->myMutex.Lock();
+               for (it = servP->pendQ.begin(); it != servP->pendQ.end(); ++it)
+                   if (*it == this) {servP->pendQ.erase(it); break;}
+               servP->myMutex.UnLock();
+               UnBindRequest();
+               delete this;
+              }
+
+      XrdSsiServPend(XrdSsiServReal *sP, XrdSsiRequest &rqstR,
+                     XrdSsiResource &rsrc)
+                    : servP(sP), rqstP(&rqstR), resource(rsrc),
+                      pendTime(Now()) {BindRequest(rqstR);}
+     ~XrdSsiServPend() {}
+
+XrdSsiServReal *servP;
+XrdSsiRequest  *rqstP;
+XrdSsiResource  resource;
+long long       pendTime;
+};
+
+namespace
+{
+class SendJob : public XrdJob
+{
+public:
+
+void  DoIt() {servP->SendPend(); delete this;}
+
+      SendJob(XrdSsiServReal *sP) : servP(sP) {}
+     ~SendJob() {}
+
+private:
+XrdSsiServReal *servP;
+};
+}
+
 /******************************************************************************/
 /*                            D e s t r u c t o r                             */
 /******************************************************************************/
@@ -160,11 +228,11 @@ bool XrdSsiServReal::GenURL(XrdSsiResource *rP, char *buff, int blen, int uEnt)
 }
 
 /******************************************************************************/
-/*                        P r o c e s s R e q u e s t                         */
+/* Private:                     D i s p a t c h                               */
 /******************************************************************************/
 
-void XrdSsiServReal::ProcessRequest(XrdSsiRequest  &reqRef,
-                                    XrdSsiResource &resRef)
+void XrdSsiServReal::Dispatch(XrdSsiRequest  &reqRef,
+                              XrdSsiResource &resRef)
 {
    static const uint32_t useCache = XrdSsiResource::Reusable
                                   | XrdSsiResource::Discard;
@@ -179,6 +247,7 @@ void XrdSsiServReal::ProcessRequest(XrdSsiRequest  &reqRef,
 //
    if (resRef.rName.length() == 0)
       {XrdSsiUtils::RetErr(reqRef, "Resource name missing.", EINVAL);
+       ReqDone();
        return;
       }
 
@@ -194,6 +263,7 @@ void XrdSsiServReal::ProcessRequest(XrdSsiRequest  &reqRef,
 //
    if ((uEnt = sidScale.getEnt()) < 0)
       {XrdSsiUtils::RetErr(reqRef, "Out of stream resources.", ENOSR);
+       ReqDone();
        return;
       }
 
@@ -202,6 +272,7 @@ void XrdSsiServReal::ProcessRequest(XrdSsiRequest  &reqRef,
    if (!GenURL(&resRef, epURL, sizeof(epURL), uEnt))
       {XrdSsiUtils::RetErr(reqRef, "Resource url is too long.", ENAMETOOLONG);
        sidScale.retEnt(uEnt);
+       ReqDone();
        return;
       }
 
@@ -210,6 +281,7 @@ void XrdSsiServReal::ProcessRequest(XrdSsiRequest  &reqRef,
    if (!(sObj = Alloc(resRef.rName.c_str(), uEnt, hold)))
       {XrdSsiUtils::RetErr(reqRef, "Insufficient memory.", ENOMEM);
        sidScale.retEnt(uEnt);
+       ReqDone();
        return;
       }
 
@@ -222,7 +294,7 @@ void XrdSsiServReal::ProcessRequest(XrdSsiRequest  &reqRef,
 // be successful. If Provision() fails, we need to delete the session object
 // because its file object now is in an usable state (funky client interface).
 //
-   if (!(sObj->Provision(&reqRef, epURL))) Recycle(sObj, false);
+   if (!(sObj->Provision(&reqRef, epURL))) {Recycle(sObj, false); ReqDone();}
 
 // If this was started with a reusable resource, put the session in the cache.
 // The resource key was constructed by the call to ResReuse() and the cache
@@ -231,6 +303,37 @@ void XrdSsiServReal::ProcessRequest(XrdSsiRequest  &reqRef,
    if (hold) resCache[resKey] = sObj;
 }
 
+/******************************************************************************/
+/*                        P r o c e s s R e q u e s t                         */
+/******************************************************************************/
+
+void XrdSsiServReal::ProcessRequest(XrdSsiRequest  &reqRef,
+                                    XrdSsiResource &resRef)
+{
+   EPNAME("ProcessRequest");
+   static const char *tident = "ServProcess";
+
+// If the number of requests in flight is limited and we reached the limit,
+// queue this request. It is also queued if others are already waiting so
+// that requests are sent in the order they were presented.
+//
+   if (maxReqs)
+      {myMutex.Lock();
+       if (actvReq >= maxReqs || !pendQ.empty())
+          {pendQ.push_back(new XrdSsiServPend(this, reqRef, resRef));
+           DEBUG("Queued request; active=" <<actvReq <<" queued=" <<pendQ.size());
+           myMutex.UnLock();
+           return;
+          }
+       actvReq++;
+       myMutex.UnLock();
+      }
+
+// Send off the request
+//
+   Dispatch(reqRef, resRef);
+}
+
 /******************************************************************************/
 /*                               R e c y c l e                                */
 /******************************************************************************/
@@ -262,6 +365,26 @@ void XrdSsiServReal::Recycle(XrdSsiSessReal *sObj, bool reuse)
            }
 }
 
+/******************************************************************************/
+/*                               R e q D o n e                                */
+/******************************************************************************/
+
+// Called each time a request leaves flight, whether it was sent or not. If
+// requests are waiting, schedule sending them as we may hold session locks.
+
+void XrdSsiServReal::ReqDone()
+{
+   if (!maxReqs) return;
+
+   myMutex.Lock();
+   actvReq--;
+   if (!pendQ.empty())
+      {sendJob++;
+       XrdSsi::schedP->Schedule(new SendJob(this));
+      }
+   myMutex.UnLock();
+}
+
 /******************************************************************************/
 /* Private:                     R e s R e u s e                               */
 /******************************************************************************/
@@ -301,6 +424,42 @@ bool XrdSsiServReal::ResReuse(XrdSsiRequest  &reqRef,
    return true;
 }
   
+/******************************************************************************/
+/*                              S e n d P e n d                               */
+/******************************************************************************/
+
+void XrdSsiServReal::SendPend()
+{
+   EPNAME("SendPend");
+   static const char *tident = "ServSendPend";
+   XrdSsiServPend *pendP;
+   XrdSsiRequest  *rqstP;
+   long long       qWait;
+
+// Send off as many waiting requests as we can now have in flight. A request
+// that is being cancelled no longer belongs to us and is simply passed over;
+// taking it back is done with our lock held so that the cancel waits for us.
+//
+   myMutex.Lock();
+   sendJob--;
+   while(!pendQ.empty() && actvReq < maxReqs)
+        {pendP = pendQ.front();
+         pendQ.pop_front();
+         rqstP = pendP->rqstP;
+         if (!XrdSsiRRAgent::TakeBack(rqstP, pendP)) continue;
+         actvReq++;
+         XrdSsiResource resource(pendP->resource);
+         qWait = Now() - pendP->pendTime;
+         XrdSsiRRAgent::ResetResponder(pendP);
+         delete pendP;
+         myMutex.UnLock();
+         DEBUG("Sending request queued for " <<qWait <<" usec");
+         Dispatch(*rqstP, resource);
+         myMutex.Lock();
+        }
+   myMutex.UnLock();
+}
+
 /******************************************************************************/
 /*                                  S t o p                                   */
 /******************************************************************************/
@@ -310,7 +469,8 @@ bool XrdSsiServReal::Stop()
 // Make sure we are clean
 //
    myMutex.Lock();
-   if (actvSes) {myMutex.UnLock(); return false;}
+   if (actvSes || actvReq || sendJob || !pendQ.empty())
+      {myMutex.UnLock(); return false;}
    myMutex.UnLock();
    delete this;
    return true;
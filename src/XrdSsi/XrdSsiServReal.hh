@@ -29,6 +29,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <deque>
 #include <map>
 #include <string>
 
@@ -36,6 +37,7 @@
 #include "XrdSys/XrdSysPthread.hh"
 
 class XrdSsiResource;
+class XrdSsiServPend;
 class XrdSsiSessReal;
 
 class XrdSsiServReal : public XrdSsiService
@@ -46,18 +48,25 @@ void           ProcessRequest(XrdSsiRequest &reqRef, XrdSsiResource &resRef);
 
 void           Recycle(XrdSsiSessReal *sObj, bool reuse);
 
+void           ReqDone();
+
+void           SendPend();
+
 bool           Stop();
 
 void           StopReuse(const char *resKey);
 
                XrdSsiServReal(const char *contact, int hObj)
                              : manNode(strdup(contact)), freeSes(0),
-                               freeCnt(0), freeMax(hObj), actvSes(0) {}
+                               freeCnt(0), freeMax(hObj), actvSes(0),
+                               actvReq(0), sendJob(0) {}
 
               ~XrdSsiServReal();
 private:
+friend class XrdSsiServPend;
 
 XrdSsiSessReal *Alloc(const char *sName, int uent, bool hold);
+void            Dispatch(XrdSsiRequest &reqRef, XrdSsiResource &resRef);
 bool            GenURL(XrdSsiResource *rP, char *buff, int blen, int uEnt);
 bool            ResReuse(XrdSsiRequest  &reqRef, XrdSsiResource &resRef,
                          std::string    &resKey);
@@ -71,5 +80,8 @@ XrdSsiSessReal *freeSes;
 int             freeCnt;
 int             freeMax;
 int             actvSes;
+int             actvReq;   // Requests in flight when maxReqs is in effect
+int             sendJob;   // Scheduled SendPend() calls not yet run
+std::deque<XrdSsiServPend *> pendQ;
 };
 #endif
@@ -174,6 +174,7 @@ XrdSsiTaskReal *XrdSsiSessReal::NewTask(XrdSsiRequest *reqP)
    if ((tP = freeTask)) freeTask = tP->attList.next;
       else {if (!alocLeft || !(tP = new XrdSsiTaskReal(this)))
                {XrdSsiUtils::RetErr(*reqP, "Too many active requests.", EMLINK);
+                myService->ReqDone();
                 return 0;
                }
             alocLeft--;
@@ -340,9 +341,10 @@ void XrdSsiSessReal::TaskFinished(XrdSsiTaskReal *tP)
 //
    tP->ClrEvent();
 
-// Return the request entry number
+// Return the request entry number and tell the service the request is gone
 //
    XrdSsi::sidScale.retEnt(uEnt);
+   myService->ReqDone();
 
 // Place the task on the free list. If we can shutdown, then unprovision which
 // will drive a shutdown. The returns without the sessMutex, otherwise we must
@@ -29,6 +29,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sched.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -76,13 +77,14 @@ struct ShmInfo
        int   highUse;       // Offset to high memory that is used
        char  reUse;         // When non-zero items can be reused (r/o locking)
        char  multW;         // When non-zero multiple writers are allowed
-       char  rsvd1;
+       char  seqLock;       // When non-zero writers maintain seqNum
        char  rsvd2;
        int   maxKeys;       // Maximum number of keys
        int   maxKeySz;      // Longest allowed key (not including null byte)
        int   hashID;        // The name of the hash
        char  typeID[64];    // Name of the type stored here
        char  myName[64];    // Name of the implementation
+       int   seqNum;        // Odd while reusable items are being changed
       };
 #define SHMINFO(x) ((ShmInfo *)shmBase)->x
 
@@ -98,6 +100,11 @@ struct ShmInfo
 
 int       PageMask = ~(sysconf(_SC_PAGESIZE)-1);
 int       PageSize =   sysconf(_SC_PAGESIZE);
+
+// Number of times a reader retries a lock-free lookup before it falls back to
+// locking the file. This guarantees progress should a writer die mid-update.
+//
+const int SeqTries = 64;
 }
 
 /******************************************************************************/
@@ -237,7 +244,9 @@ XrdSsiShMam::XrdSsiShMam(XrdSsiShMat::NewParms &parms) : XrdSsiShMat(parms)
    lockRO    = true;
    lockRW    = true;
    reUse     = false;
+   useSeq    = false;
    useAtomic = true;
+   shmSeqNum = 0;
 
 // Initialize r/w mutexes
 //
@@ -271,9 +280,11 @@ bool XrdSsiShMam::AddItem(void *newdata, void *olddata, const char *key,
 //
    if (verNum != SHMINFO(verNum)) ReMap(RWLock);
 
-// Lock the file if we have multiple writers or recycling items
+// Lock the file if we have multiple writers or recycling items. When items
+// are recycled, tell lock-free readers that items are being changed.
 //
    if (lockRW && !lockInfo.FLock()) return false;
+   lockInfo.SeqBegin();
 
 // First try to find the item
 //
@@ -414,6 +425,7 @@ bool XrdSsiShMam::Attach(int tout, bool isrw)
    keyPos     = SHMINFO(keyPos);
    maxKLen    = SHMINFO(maxKeySz);
    xntP.intP  = SHMADDR(int, SHMINFO(index)); shmIndex = xntP.antP;
+   xntP.intP  = &SHMINFO(seqNum);            shmSeqNum = xntP.antP;
    shmSlots   = SHMINFO(slots);
    shmItemSz  = SHMINFO(itemSz);
    shmInfoSz  = SHMINFO(infoSz);
@@ -502,6 +514,7 @@ bool XrdSsiShMam::Create(XrdSsiShMat::CRZParms &parms)
    theInfo.highUse  = theInfo.index;
    theInfo.reUse    = reUse;
    theInfo.multW    = multW;
+   theInfo.seqLock  = 1;
    theInfo.keyPos   = keyPos = shmTypeSz + sizeof(MemItem);
    theInfo.maxKeys  = maxEnts;
    theInfo.maxKeySz = maxKLen = parms.maxKLen;
@@ -541,6 +554,7 @@ bool XrdSsiShMam::Create(XrdSsiShMat::CRZParms &parms)
 //
    memcpy(shmBase, &theInfo, sizeof(theInfo));
    xntP.intP  = SHMADDR(int, SHMINFO(index)); shmIndex = xntP.antP;
+   xntP.intP  = &SHMINFO(seqNum);            shmSeqNum = xntP.antP;
    shmSlots = parms.indexSz;
 
 // A created table has, by definition, a single writer until it is exported.
@@ -575,6 +589,7 @@ bool XrdSsiShMam::DelItem(void *data, const char *key, int hash)
 // We need to do this prior to file locking as the requirements may change.
 //
    if (lockRW && !lockInfo.FLock()) return false;
+   lockInfo.SeqBegin();
 
 // First try to find the item
 //
@@ -867,6 +882,17 @@ bool XrdSsiShMam::GetItem(void *data, const char *key, int hash)
 //
    if (verNum != SHMINFO(verNum)) ReMap(ROLock);
 
+// When writers tell us when recycled items are being changed, we need not lock
+// the file; we simply redo the lookup should it have overlapped an update.
+//
+   if (useSeq)
+      {int rc = SeqGet(data, key, hash);
+       if (rc >= 0)
+          {if (!rc) errno = ENOENT;
+           return rc != 0;
+          }
+      }
+
 // Lock the file if we have multiple writers or recycling items
 //
    if (lockRO && !lockInfo.FLock()) return false;
@@ -995,6 +1021,7 @@ int  XrdSsiShMam::Info(const char *vname, char *buff, int blen)
    if (!strcmp(vname, "maxkeylen")) return SHMINFO(maxKeySz);
    if (!strcmp(vname, "multw"))     return multW;
    if (!strcmp(vname, "reuse"))     return reUse;
+   if (!strcmp(vname, "seqlock"))   return useSeq;
    if (!strcmp(vname, "type"))
       {int n = strlen(SHMINFO(typeID));
        if (!buff || blen < n) {errno = EMSGSIZE; return -1;}
@@ -1194,6 +1221,81 @@ void XrdSsiShMam::RetItem(MemItem *iP)
       }
 }
 
+/******************************************************************************/
+/* Private:                     S e q B e g i n                               */
+/******************************************************************************/
+
+// Called with the file locked R/W. A sequence number left odd by a writer
+// that died mid-update is simply kept odd.
+
+void XrdSsiShMam::SeqBegin()
+{
+#if __cplusplus >= 201103L
+   int seq = shmSeqNum->load(std::memory_order_relaxed);
+   shmSeqNum->store(seq | 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+#endif
+}
+
+/******************************************************************************/
+/* Private:                       S e q E n d                                 */
+/******************************************************************************/
+
+void XrdSsiShMam::SeqEnd()
+{
+#if __cplusplus >= 201103L
+   int seq = shmSeqNum->load(std::memory_order_relaxed);
+   shmSeqNum->store((seq | 1) + 1, std::memory_order_release);
+#endif
+}
+
+/******************************************************************************/
+/* Private:                       S e q G e t                                 */
+/******************************************************************************/
+
+// Look up an item without locking the file. The lookup is simply redone if
+// the sequence number shows that items were changed while it was under way.
+// Since an item may be recycled under us, keys are compared within the key
+// area and chains are never followed for more steps than there can be items.
+// Returns 1 if found, 0 if not, and -1 if the caller should lock and retry.
+
+int XrdSsiShMam::SeqGet(void *data, const char *key, int hash)
+{
+#if __cplusplus >= 201103L
+   MemItem *theItem;
+   int hEnt, iOff, n, seq, maxItems = SHMINFO(maxKeys);
+   bool found;
+
+// If no hash was supplied, get one and compute the index table entry
+//
+   if (!hash) hash = HashVal(key);
+   hEnt = (unsigned int)hash % shmSlots;
+   if (hEnt == 0) hEnt = 1;
+
+// Try the lookup until it did not overlap an update
+//
+   for (int i = 0; i < SeqTries; i++)
+       {if ((seq = shmSeqNum->load(std::memory_order_acquire)) & 1)
+           {sched_yield(); continue;}
+        iOff = Atomic_GET_STRICT(shmIndex[hEnt]);
+        found = false; n = 0;
+        while(iOff && n++ < maxItems)
+             {theItem = SHMADDR(MemItem, iOff);
+              if (hash == theItem->hash
+              &&  !strncmp(key, ITEM_KEY(theItem), maxKLen+1))
+                 {if (data) memcpy(data, ITEM_VAL(theItem), shmTypeSz);
+                  found = true;
+                  break;
+                 }
+              iOff = Atomic_GET_STRICT(theItem->next);
+             }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (shmSeqNum->load(std::memory_order_relaxed) == seq) return found;
+       }
+#endif
+   return -1;
+}
+
 /******************************************************************************/
 /* Private:                   S e t L o c k i n g                             */
 /******************************************************************************/
@@ -1205,9 +1307,14 @@ void XrdSsiShMam::SetLocking(bool isrw)
 #ifdef NEED_ATOMIC_MUTEX
    lockRO   = lockRW = true;
 #else
-// A reader must lock the file R/O if objects are being reused
+// A reader must lock the file R/O if objects are being reused unless writers
+// maintain the sequence number, which lets readers detect concurrent changes.
+// Tables created before that was done are always locked.
 //
    lockRO   = reUse =  SHMINFO(reUse);
+#if __cplusplus >= 201103L
+   useSeq   = reUse && SHMINFO(seqLock);
+#endif
 
 // A writer must lock the file R/W if objects are being reused or the file may
 // have multiple writers
@@ -1259,6 +1366,9 @@ void XrdSsiShMam::SwapMap(XrdSsiShMam &newMap)
    newMap.shmBase  =  0;
    shmIndex        = newMap.shmIndex;
    newMap.shmIndex =  0;
+   shmSeqNum       = newMap.shmSeqNum;
+   newMap.shmSeqNum=  0;
+   useSeq          = newMap.useSeq;
    lockRO          = newMap.lockRO;
    lockRW          = newMap.lockRW;
    reUse           = newMap.reUse;
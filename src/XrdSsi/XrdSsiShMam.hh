@@ -85,6 +85,9 @@ bool     Lock(bool doRW=false, bool nowait=false);
 MemItem *NewItem();
 bool     ReMap(LockType iHave);
 void     RetItem(MemItem *iP);
+int      SeqGet(void *data, const char *key, int hash);
+void     SeqBegin();
+void     SeqEnd();
 void     SetLocking(bool isrw);
 void     SwapMap(XrdSsiShMam &newMap);
 void     Snooze(int sec);
@@ -99,13 +102,21 @@ inline bool  FLock() {if (!(shmemP->Lock(lkType))) return false;
                       doUnLock = true; return true;
                      }
 
+inline void  SeqBegin() {if (shmemP->useSeq)
+                            {shmemP->SeqBegin(); inSeq = true;}
+                        }
+
+inline void  SeqEnd() {if (inSeq) {shmemP->SeqEnd(); inSeq = false;}}
+
              XLockHelper(XrdSsiShMam *shmemp, LockType lktype)
-                        : shmemP(shmemp), lkType(lktype), doUnLock(false)
+                        : shmemP(shmemp), lkType(lktype), doUnLock(false),
+                          inSeq(false)
                         {if (lktype == RWLock)
                                  pthread_rwlock_wrlock(&(shmemP->myMutex));
                             else pthread_rwlock_rdlock(&(shmemP->myMutex));
                         }
             ~XLockHelper() {int rc = errno;
+                            SeqEnd();
                             if (lkType == RWLock && shmemP->syncOn
                             &&  shmemP->syncQWR > shmemP->syncQSZ)
                                shmemP-> Flush();
@@ -117,6 +128,7 @@ private:
 XrdSsiShMam *shmemP;
 LockType     lkType;
 bool         doUnLock;
+bool         inSeq;
 };
 
 pthread_mutex_t   lkMutex;
@@ -126,6 +138,7 @@ char       *shmTemp;
 long long   shmSize;
 char       *shmBase;
 Atomic(int)*shmIndex;
+Atomic(int)*shmSeqNum;
 int         shmSlots;
 int         shmItemSz;
 int         shmInfoSz;
@@ -144,6 +157,7 @@ bool        isRW;
 bool        lockRO;
 bool        lockRW;
 bool        reUse;
+bool        useSeq;
 bool        multW;
 bool        useAtomic;
 bool        syncBase;
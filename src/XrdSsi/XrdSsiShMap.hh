@@ -304,6 +304,7 @@ bool         Get(const char *key, T &val);
 //!                 maxkeylen   - Longest allowed key
 //!                 multw       - If 1 map supports multiple writers, else 0
 //!                 reuse       - If 1 map allows object reuse, else 0
+//!                 seqlock     - If 1 lookups do not lock the map, else 0
 //!                 type        - Name of the data type in the table.
 //!                 typesz      - The number of bytes in the map's data type
 //!
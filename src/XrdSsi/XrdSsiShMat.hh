@@ -209,6 +209,7 @@ virtual bool Enumerate(void *&jar) = 0;
 //!                 maxkeylen   - Longest allowed key
 //!                 multw       - If table supports multiple writers, else 0
 //!                 reuse       - If table allows object reuse, else 0
+//!                 seqlock     - If lookups do not lock the table, else 0
 //!                 type        - Name of the data type in the table.
 //!                 typesz      - The number of bytes in the table's data type
 //!
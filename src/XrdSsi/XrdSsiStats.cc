@@ -54,6 +54,8 @@ fsP      = 0;
 ReqBytes      = 0; // Stats: Number of requests bytes total
 ReqMaxsz      = 0; // Stats: Number of requests largest size
 RspMDBytes    = 0; // Stats: Number of metada  response bytes
+ReqQTime      = 0; // Stats: Total usec requests waited to be run
+ReqQTmax      = 0; // Stats: Longest usec a request waited to run
 ReqAborts     = 0; // Stats: Number of request aborts
 ReqAlerts     = 0; // Stats: Number of request alerts
 ReqBound      = 0; // Stats: Number of requests bound
@@ -93,6 +95,7 @@ int XrdSsiStats::Stats(char *buff, int blen)
    "<ab>%d</ab><proc>%d</proc><gets>%d</gets>"
    "<relb>%d</relb><al>%d</al><fin>%d</fin>"
    "<can>%d</can><finf>%d</finf><perr>%d</perr>"
+   "<qtm>%lld</qtm><qmx>%lld</qmx>"
    "</req><rsp>"
    "<bad>%d</bad><cbk>%d</cbk><data>%d</data><errs>%d</errs>"
    "<file>%d</file><str>%d</str><rdy>%d</rdy><unr>%d</unr>"
@@ -115,6 +118,7 @@ int XrdSsiStats::Stats(char *buff, int blen)
        /*<ab>*/       INMax, INMax, INMax,
        /*<relb>*/     INMax, INMax, INMax,
        /*<can>*/      INMax, INMax, INMax,
+       /*<qtm>*/      LLMax, LLMax,
        /*<bad>*/      INMax, INMax, INMax, INMax,
        /*<file>*/     INMax, INMax, INMax, INMax, LLMax,
        /*<res>*/      INMax, INMax);
@@ -130,6 +134,7 @@ int XrdSsiStats::Stats(char *buff, int blen)
                   ReqAborts,  ReqProcs,    ReqGets,
                   ReqRelBuf,  ReqAlerts,   ReqFinished,
                   ReqCancels, ReqFinForce, ReqPrepErrs,
+                  ReqQTime,   ReqQTmax,
                   RspBad,     RspCallBK,   RspData,      RspErrs,
                   RspFile,    RspStrm,     RspReady,     RspUnRdy,
                   RspMDBytes, ResAdds,     ResRems);
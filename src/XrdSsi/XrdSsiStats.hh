@@ -40,6 +40,8 @@ public:
 long long        ReqBytes;     // Stats: Number of requests bytes total
 long long        ReqMaxsz;     // Stats: Number of requests largest size
 long long        RspMDBytes;   // Stats: Number of metada  response bytes
+long long        ReqQTime;     // Stats: Total usec requests waited to be run
+long long        ReqQTmax;     // Stats: Longest usec a request waited to run
 int              ReqAborts;    // Stats: Number of request aborts
 int              ReqAlerts;    // Stats: Number of request alerts
 int              ReqBound;     // Stats: Number of requests bound
@@ -65,6 +67,13 @@ int              SsiErrs;      // Stats: Number of SSI detected errors
 int              ResAdds;      // Stats: Number of resource additions
 int              ResRems;      // Stats: Number of resource removals
 
+void             QTime(long long usec)
+                      {statsMutex.Lock();
+                       ReqQTime += usec;
+                       if (usec > ReqQTmax) ReqQTmax = usec;
+                       statsMutex.UnLock();
+                      }
+
 void             setFS(XrdSfsFileSystem *fsp) {fsP = fsp;}
 
 int              Stats(char *buff, int blen);
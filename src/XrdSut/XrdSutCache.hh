@@ -59,13 +59,13 @@ public:
 
       XrdSutCacheEntry *cent = 0;
 
-      // Exclusive access to the table
-      XrdSysMutexHelper raii(mtx);
-
-      // Look for an entry
-      if (!(cent = table.Find(tag))) {
-         // none found
-         return cent;
+      // Exclusive access to the table, just for the lookup: entries are never
+      // removed, so we can wait for the entry without blocking the others.
+      {XrdSysMutexHelper raii(mtx);
+       if (!(cent = table.Find(tag))) {
+          // none found
+          return cent;
+       }
       }
 
       // We found an existing entry:
@@ -90,23 +90,25 @@ public:
       rdlock = false;
       XrdSutCacheEntry *cent = 0;
 
-      // Exclusive access to the table
-      XrdSysMutexHelper raii(mtx);
-
-      // Look for an entry
-      if (!(cent = table.Find(tag))) {
-         // If none, create a new one and write-lock for validation
-         cent = new XrdSutCacheEntry(tag);
-         int status = 0;
-         cent->rwmtx.WriteLock( status );
-         if (status) {
-            // A problem occured: delete the entry and fail
-            delete cent;
-            return (XrdSutCacheEntry *)0;
-         }
-         // Register it in the table
-         table.Add(tag, cent);
-         return cent;
+      // Exclusive access to the table, just for the lookup or the insertion.
+      // Entries are never removed, so we can wait for the entry (that may be
+      // being validated, e.g. a CA whose CRL is being reloaded) without
+      // blocking the threads using the other entries.
+      {XrdSysMutexHelper raii(mtx);
+       if (!(cent = table.Find(tag))) {
+          // If none, create a new one and write-lock for validation
+          cent = new XrdSutCacheEntry(tag);
+          int status = 0;
+          cent->rwmtx.WriteLock( status );
+          if (status) {
+             // A problem occured: delete the entry and fail
+             delete cent;
+             return (XrdSutCacheEntry *)0;
+          }
+          // Register it in the table
+          table.Add(tag, cent);
+          return cent;
+       }
       }
 
       // We found an existing entry:
@@ -134,6 +136,16 @@ public:
                cent->status = kCE_inactive;
                return cent;
             }
+            // Another thread may have validated it while we were waiting
+            if ((*condition)(cent, arg)) {
+               cent->rwmtx.UnLock();
+               cent->rwmtx.ReadLock( status );
+               if (status) {
+                  cent->status = kCE_inactive;
+                  return cent;
+               }
+               rdlock = true;
+            }
           }
       } else {
           // Good and valid entry
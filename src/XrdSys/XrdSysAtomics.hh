@@ -55,6 +55,7 @@
 #define AtomicFZAP(w,x)     w =  __sync_fetch_and_and(&x, 0)
 #define AtomicGet(x)        __sync_fetch_and_or(&x, 0)
 #define AtomicInc(x)        __sync_fetch_and_add(&x, 1)
+#define AtomicOr(x, y)      __sync_fetch_and_or(&x, y)
 #define AtomicSub(x, y)     __sync_fetch_and_sub(&x, y)
 #define AtomicFSub(w,x,y)   w =  __sync_fetch_and_sub(&x, y)
 #define AtomicZAP(x)        __sync_fetch_and_and(&x, 0)
@@ -70,6 +71,7 @@
 #define AtomicFZAP(w,x)    {w = x; x = 0;}
 #define AtomicGet(x)        x
 #define AtomicInc(x)        x++
+#define AtomicOr(x, y)      x |= y
 #define AtomicSub(x, y)     x -= y          // When assigning use AtomicFSub!
 #define AtomicFSub(w,x,y)  {w = x; x -= y;}
 #define AtomicZAP(x)        x = 0
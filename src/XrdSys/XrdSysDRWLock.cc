@@ -0,0 +1,88 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d S y s D R W L o c k . c c                       */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <sched.h>
+
+#include "XrdSys/XrdSysDRWLock.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+/******************************************************************************/
+/*                             W r i t e L o c k                              */
+/******************************************************************************/
+
+void XrdSysDRWLock::WriteLock()
+{
+   int i, spins = 0;
+
+// Only one writer at a time. Once we announce ourselves no new reader gets
+// in; the ones that already did are waited for.
+//
+   wrMutex.Lock();
+   wrBusy.store(1);
+
+   for (i = 0; i < slotNum; i++)
+       {while(rdrCnt[i].Count.load(std::memory_order_acquire))
+             {if (++spins < 128) sched_yield();
+                 else XrdSysTimer::Wait(1);
+             }
+       }
+}
+
+/******************************************************************************/
+/*                           W r i t e U n L o c k                            */
+/******************************************************************************/
+
+void XrdSysDRWLock::WriteUnLock()
+{
+
+// Clear the writer indicator under the condvar lock so that a reader about to
+// wait cannot miss the wakeup.
+//
+   wrWait.Lock();
+   wrBusy.store(0);
+   wrWait.Broadcast();
+   wrWait.UnLock();
+   wrMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                              R e a d W a i t                               */
+/******************************************************************************/
+
+// Called when a writer was seen after our counter was incremented. We back
+// out so the writer can proceed and retry once it is done.
+//
+void XrdSysDRWLock::ReadWait(std::atomic<int> &rCnt)
+{
+   do {rCnt.fetch_sub(1, std::memory_order_release);
+       wrWait.Lock();
+       while(wrBusy.load()) wrWait.Wait();
+       wrWait.UnLock();
+       rCnt.fetch_add(1);
+      } while(wrBusy.load());
+}
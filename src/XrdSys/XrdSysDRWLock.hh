@@ -0,0 +1,141 @@
+#ifndef __XRDSYSDRWLOCK_HH__
+#define __XRDSYSDRWLOCK_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d S y s D R W L o c k . h h                       */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <atomic>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+//-----------------------------------------------------------------------------
+//! A distributed reader/writer lock for read-mostly data. Each reader only
+//! touches one of a set of counters, each in its own cache line, selected by
+//! the calling thread. Readers running on different cpus therefore do not
+//! contend for a shared cache line as they do with XrdSysRWLock and
+//! XrdSysXSLock. The price is paid by writers which must wait for every
+//! counter to drain, so the lock only pays off when writes are rare (e.g.
+//! a table that is replaced on reconfiguration).
+//!
+//! Writers have priority: once a writer has announced itself new readers
+//! wait for it to finish. Consequently, read locks may not be obtained
+//! recursively and a read lock may not be upgraded.
+//-----------------------------------------------------------------------------
+
+class XrdSysDRWLock
+{
+public:
+
+//-----------------------------------------------------------------------------
+//! Obtain a shared (read) lock.
+//-----------------------------------------------------------------------------
+
+inline void ReadLock()
+           {std::atomic<int> &rCnt = Slot();
+            rCnt.fetch_add(1);
+            if (wrBusy.load()) ReadWait(rCnt);
+           }
+
+//-----------------------------------------------------------------------------
+//! Release a shared (read) lock.
+//-----------------------------------------------------------------------------
+
+inline void ReadUnLock() {Slot().fetch_sub(1, std::memory_order_release);}
+
+//-----------------------------------------------------------------------------
+//! Obtain an exclusive (write) lock.
+//-----------------------------------------------------------------------------
+
+       void WriteLock();
+
+//-----------------------------------------------------------------------------
+//! Release an exclusive (write) lock.
+//-----------------------------------------------------------------------------
+
+       void WriteUnLock();
+
+            XrdSysDRWLock() : wrBusy(0), wrWait(0) {}
+           ~XrdSysDRWLock() {}
+
+private:
+
+       void ReadWait(std::atomic<int> &rCnt);
+
+// The slot is derived from the thread's identity so that a thread always
+// releases the counter it incremented without having to remember it.
+//
+inline std::atomic<int> &Slot()
+           {uint64_t tid = (uint64_t)(uintptr_t)pthread_self();
+            tid *= 0x9e3779b97f4a7c15ULL;
+            return rdrCnt[tid >> (64 - slotBits)].Count;
+           }
+
+static const int slotBits = 6;
+static const int slotNum  = 1 << slotBits;
+
+// Counters are a cache line apart. They are padded rather than aligned so that
+// objects holding the lock can still be allocated with plain new.
+//
+struct RdrSlot
+      {std::atomic<int> Count;
+       char             Pad[64 - sizeof(std::atomic<int>)];
+       RdrSlot() : Count(0) {}
+      };
+
+RdrSlot          rdrCnt[slotNum];
+std::atomic<int> wrBusy;     // A writer holds or is waiting for the lock
+XrdSysMutex      wrMutex;    // Serializes writers
+XrdSysCondVar    wrWait;     // Readers wait here for the writer to finish
+};
+
+/******************************************************************************/
+/*                  X r d S y s D R W L o c k H e l p e r                     */
+/******************************************************************************/
+
+// XrdSysDRWLockHelper: scoped lock for XrdSysDRWLock
+
+class XrdSysDRWLockHelper
+{
+public:
+
+inline void UnLock() {if (lck) {if (isRd) lck->ReadUnLock();
+                                   else   lck->WriteUnLock();
+                                lck = 0;
+                               }
+                     }
+
+            XrdSysDRWLockHelper(XrdSysDRWLock &l, bool rd=true)
+                               : lck(&l), isRd(rd)
+                               {if (rd) l.ReadLock();
+                                   else l.WriteLock();
+                               }
+           ~XrdSysDRWLockHelper() {UnLock();}
+
+private:
+XrdSysDRWLock *lck;
+bool           isRd;
+};
+#endif
@@ -36,6 +36,8 @@
 #include <string>
 #include <cstdlib>
 
+#include "XrdSys/XrdSysPthread.hh"
+
 namespace XrdSys
 {
   //----------------------------------------------------------------------------
@@ -74,6 +76,10 @@ namespace XrdSys
   //! It solves the races at the cost of limiting the maximal value storable in
   //! the semaphore to 20 bits and the possible number of threads waiting for
   //! the value to change to 12 bits.
+  //!
+  //! A waiter spins for up to XrdSysSpin::Count() tries before it registers
+  //! itself and sleeps, and Post only makes the wake up syscall when someone
+  //! is registered, so quick handoffs stay in user space.
   //----------------------------------------------------------------------------
   class LinuxSemaphore
   {
@@ -113,6 +119,17 @@ namespace XrdSys
       //------------------------------------------------------------------------
       inline void Wait()
       {
+        //----------------------------------------------------------------------
+        // The semaphore is usually posted shortly, so try for a while before
+        // going through the expense of sleeping
+        //----------------------------------------------------------------------
+        for( int i = XrdSysSpin::Count(); i > 0; --i )
+        {
+          if( CondWait() )
+            return;
+          XrdSysSpin::Pause();
+        }
+
         //----------------------------------------------------------------------
         // Examine the state of the semaphore and atomically decrement it if
         // possible. If CondWait fails, it means that the semaphore value was 0.
@@ -158,7 +175,7 @@ namespace XrdSys
               pthread_cleanup_push( Cleanup, pValue );
               pthread_setcanceltype( PTHREAD_CANCEL_ASYNCHRONOUS, 0 );
 
-              r = syscall( SYS_futex, pValue, FUTEX_WAIT, newVal, 0, 0, 0 );
+              r = syscall( SYS_futex, pValue, FUTEX_WAIT_PRIVATE, newVal, 0, 0, 0 );
 
               pthread_setcanceltype( PTHREAD_CANCEL_DEFERRED, 0 );
               pthread_cleanup_pop( 0 );
@@ -230,7 +247,7 @@ namespace XrdSys
           if( __sync_bool_compare_and_swap( pValue, value, newVal ) )
           {
             if( waiters )
-              syscall( SYS_futex, pValue, FUTEX_WAKE, 1, 0, 0, 0 );
+              syscall( SYS_futex, pValue, FUTEX_WAKE_PRIVATE, 1, 0, 0, 0 );
             return;
           }
         }
@@ -107,6 +107,385 @@ void Snatch(struct iovec *iov, int iovnum) // Called with logger mutex locked!
 
 bool XrdSysLogger::doForward = false;
 
+/******************************************************************************/
+/*                 A s y n c h r o n o u s   Q u e u e i n g                  */
+/******************************************************************************/
+
+// Each thread that logs while the logger runs asynchronously gets its own byte
+// ring. Only the owning thread advances inHead and only the drainer (i.e. the
+// holder of drainMtx) advances inTail so that no locks are needed to queue a
+// message. Messages are copied in whole so the ring always holds a sequence of
+// complete lines which can be handed to writev() as is. Rings are pushed onto
+// a singly linked list that is only ever extended at its head; a ring whose
+// thread has exited is freed by the drainer once empty and not at the head.
+//
+namespace
+{
+struct LogRing
+      {LogRing                        *next;
+       char                           *buff;
+       unsigned long long              bmask;
+       std::atomic<unsigned long long> inHead;
+       std::atomic<unsigned long long> inTail;
+       std::atomic<unsigned int>       numLost;
+       std::atomic<bool>               orphan;
+       int                             stLen;   // Pending cerr bytes
+       char                            stage[2048];
+
+       LogRing(unsigned int bsz) : next(0), buff((char *)malloc(bsz)),
+                                   bmask(bsz-1), inHead(0), inTail(0),
+                                   numLost(0), orphan(false), stLen(0) {}
+      ~LogRing() {if (buff) free(buff);}
+      };
+
+void RingExit(void *ring)
+     {static_cast<LogRing *>(ring)->orphan.store(true);}
+
+// This stream buffer replaces the one used by cerr so that trace records are
+// queued like any other message. Characters are staged per thread and are
+// only queued at a line boundary so lines from different threads never mix.
+//
+class LogStreamBuf : public std::streambuf
+{
+public:
+
+     LogStreamBuf(XrdSysLoggerAQ *aq) : aqP(aq) {}
+    ~LogStreamBuf() {}
+
+protected:
+
+int_type        overflow(int_type c)
+                        {if (c != traits_type::eof())
+                            {char ch = static_cast<char>(c); Add(&ch, 1);}
+                         return traits_type::not_eof(c);
+                        }
+std::streamsize xsputn(const char *s, std::streamsize n)
+                      {Add(s, n); return n;}
+int             sync();
+
+private:
+void            Add(const char *s, std::streamsize n);
+
+XrdSysLoggerAQ *aqP;
+};
+
+LogStreamBuf   *aqBuff  = 0;
+std::streambuf *cerrBuf = 0;
+}
+
+class XrdSysLoggerAQ
+{
+public:
+
+bool     Drain();
+
+LogRing *GetRing();
+
+bool     Queue(int iovcnt, struct iovec *iov);
+
+void     Write(struct iovec *iov, int iovcnt);
+
+void     Writer();
+
+static void AsyncExit();
+
+static void AsyncFork();
+
+         XrdSysLoggerAQ(XrdSysLogger *lP, int qsize)
+                       : logP(lP), ringList(0), wakeUp(0), wIdle(false)
+                       {unsigned int qsz = 8192;
+                        while((int)qsz < qsize && qsz < 16*1024*1024) qsz <<= 1;
+                        ringSize = qsz;
+                        ringMax  = qsz >> 2;
+                       }
+        ~XrdSysLoggerAQ() {} // Never deleted once started
+
+XrdSysMutex          drainMtx;
+pthread_key_t        ringKey;
+
+static XrdSysLogger  *aqLogger;
+
+private:
+
+static const int     maxIOV = 1024;
+
+XrdSysLogger        *logP;
+std::atomic<LogRing*>ringList;
+XrdSysSemaphore      wakeUp;
+std::atomic<bool>    wIdle;
+unsigned int         ringSize;
+unsigned int         ringMax;
+};
+
+namespace
+{
+void LogStreamBuf::Add(const char *s, std::streamsize n)
+{
+   LogRing *rP = aqP->GetRing();
+   struct iovec iov;
+   int k;
+
+   while(n > 0)
+        {if (rP->stLen >= (int)sizeof(rP->stage))
+            {iov.iov_base = rP->stage; iov.iov_len = rP->stLen;
+             if (!aqP->Queue(1, &iov)) aqP->Write(&iov, 1);
+             rP->stLen = 0;
+            }
+         k = sizeof(rP->stage) - rP->stLen;
+         if (k > n) k = n;
+         memcpy(rP->stage + rP->stLen, s, k);
+         rP->stLen += k; s += k; n -= k;
+        }
+}
+
+int LogStreamBuf::sync()
+{
+   LogRing *rP = aqP->GetRing();
+   struct iovec iov;
+
+   if (rP->stLen && rP->stage[rP->stLen-1] == '\n')
+      {iov.iov_base = rP->stage; iov.iov_len = rP->stLen;
+       if (!aqP->Queue(1, &iov)) aqP->Write(&iov, 1);
+       rP->stLen = 0;
+      }
+   return 0;
+}
+}
+
+/******************************************************************************/
+/*                      X r d S y s L o g g e r A Q : :                       */
+/******************************************************************************/
+XrdSysLogger *XrdSysLoggerAQ::aqLogger = 0;
+
+/******************************************************************************/
+/*                             A s y n c E x i t                              */
+/******************************************************************************/
+
+void XrdSysLoggerAQ::AsyncExit()
+{
+   XrdSysLoggerAQ *aqP = aqLogger->aQueue.load();
+
+// Write out anything still queued when the process exits
+//
+   if (aqP)
+      {aqP->drainMtx.Lock();
+       std::cerr.rdbuf(cerrBuf);
+       aqP->Drain();
+       aqP->drainMtx.UnLock();
+      }
+}
+
+/******************************************************************************/
+/*                             A s y n c F o r k                              */
+/******************************************************************************/
+
+void XrdSysLoggerAQ::AsyncFork()
+{
+
+// A forked child has no writer thread so it must revert to synchronous output
+//
+   if (aqBuff) std::cerr.rdbuf(cerrBuf);
+   aqLogger->aQueue.store(0);
+}
+
+/******************************************************************************/
+/*                                 D r a i n                                  */
+/******************************************************************************/
+
+// Called with drainMtx held. Returns true if anything was written.
+
+bool XrdSysLoggerAQ::Drain()
+{
+   struct iovec iov[maxIOV];
+   LogRing *rDone[maxIOV/2], *rP, *rPrev = 0;
+   unsigned long long rHead[maxIOV/2], head, tail, hOff, tOff;
+   int iovNum = 0, rNum = 0;
+   unsigned int nLost = 0;
+   bool didIO = false;
+
+// Run through all of the rings collecting whatever is pending. We stop to
+// write whenever the vector fills up. Empty rings of exited threads are freed.
+//
+   rP = ringList.load();
+   while(rP)
+        {nLost += rP->numLost.exchange(0);
+         bool gone = rP->orphan.load();
+         tail = rP->inTail.load(std::memory_order_relaxed);
+         head = rP->inHead.load();
+         if (head == tail)
+            {if (gone && rPrev)
+                {rPrev->next = rP->next;
+                 delete rP;
+                 rP = rPrev->next;
+                } else {rPrev = rP; rP = rP->next;}
+             continue;
+            }
+         hOff = head & rP->bmask; tOff = tail & rP->bmask;
+         if (hOff > tOff)
+            {iov[iovNum].iov_base = rP->buff + tOff;
+             iov[iovNum++].iov_len = hOff - tOff;
+            } else {
+             iov[iovNum].iov_base = rP->buff + tOff;
+             iov[iovNum++].iov_len = rP->bmask + 1 - tOff;
+             if (hOff)
+                {iov[iovNum].iov_base = rP->buff;
+                 iov[iovNum++].iov_len = hOff;
+                }
+            }
+         rDone[rNum] = rP; rHead[rNum++] = head;
+         if (iovNum >= maxIOV-1)
+            {Write(iov, iovNum);
+             for (int i = 0; i < rNum; i++)
+                 rDone[i]->inTail.store(rHead[i], std::memory_order_release);
+             iovNum = rNum = 0; didIO = true;
+            }
+         rPrev = rP; rP = rP->next;
+        }
+
+// Write out whatever remains
+//
+   if (iovNum)
+      {Write(iov, iovNum);
+       for (int i = 0; i < rNum; i++)
+           rDone[i]->inTail.store(rHead[i], std::memory_order_release);
+       didIO = true;
+      }
+
+// Report any lost messages
+//
+   if (nLost)
+      {struct timeval tVal;
+       char tbuff[32], mbuff[80];
+       gettimeofday(&tVal, 0);
+       iov[0].iov_base = tbuff;
+       iov[0].iov_len  = XrdSysLogger::TimeStamp(tVal, XrdSysThread::Num(),
+                                      tbuff, sizeof(tbuff), logP->hiRes);
+       iov[1].iov_base = mbuff;
+       iov[1].iov_len  = snprintf(mbuff, sizeof(mbuff), "Logger dropped %u "
+                                  "message(s); log output is too slow.\n", nLost);
+       Write(iov, 2);
+      }
+   return didIO;
+}
+
+/******************************************************************************/
+/*                               G e t R i n g                                */
+/******************************************************************************/
+  
+LogRing *XrdSysLoggerAQ::GetRing()
+{
+   LogRing *rP = (LogRing *)pthread_getspecific(ringKey);
+
+// Allocate a ring for this thread if it does not have one and push it onto
+// the ring list. Only the list head is ever changed by anyone but the drainer.
+//
+   if (!rP)
+      {rP = new LogRing(ringSize);
+       rP->next = ringList.load();
+       while(!ringList.compare_exchange_weak(rP->next, rP)) {}
+       pthread_setspecific(ringKey, rP);
+      }
+   return rP;
+}
+
+/******************************************************************************/
+/*                                 Q u e u e                                  */
+/******************************************************************************/
+
+// Returns false if the message should be written synchronously.
+
+bool XrdSysLoggerAQ::Queue(int iovcnt, struct iovec *iov)
+{
+   LogRing *rP;
+   unsigned long long head, tail;
+   unsigned int mlen = 0, bOff, k;
+
+// Compute the message length. Huge messages bypass the queue.
+//
+   for (int i = 0; i < iovcnt; i++) mlen += iov[i].iov_len;
+   if (mlen > ringMax) return false;
+
+// Get our ring and check if there is room for the message. If not, drop it.
+//
+   if (!(rP = GetRing()) || !rP->buff) return false;
+   head = rP->inHead.load(std::memory_order_relaxed);
+   tail = rP->inTail.load(std::memory_order_acquire);
+   if (ringSize - (head - tail) < mlen)
+      {rP->numLost++;
+       return true;
+      }
+
+// Copy in the message, wrapping as necessary
+//
+   bOff = head & rP->bmask;
+   for (int i = 0; i < iovcnt; i++)
+       {const char *src = (const char *)iov[i].iov_base;
+        unsigned int slen = iov[i].iov_len;
+        k = ringSize - bOff;
+        if (k > slen) k = slen;
+        memcpy(rP->buff + bOff, src, k);
+        if (k < slen) memcpy(rP->buff, src + k, slen - k);
+        bOff = (bOff + slen) & rP->bmask;
+       }
+
+// Publish the message and wake up the writer if it is waiting for work. The
+// store and the load below must not be reordered (see Writer()).
+//
+   rP->inHead.store(head + mlen);
+   if (wIdle.load() && wIdle.exchange(false)) wakeUp.Post();
+   return true;
+}
+
+/******************************************************************************/
+/*                                 W r i t e                                  */
+/******************************************************************************/
+  
+void XrdSysLoggerAQ::Write(struct iovec *iov, int iovcnt)
+{
+   ssize_t retc;
+
+// Write everything out, handling partial writes as we may have a lot queued.
+//
+   while(iovcnt)
+        {do {retc = writev(logP->eFD, (const struct iovec *)iov, iovcnt);}
+            while (retc < 0 && errno == EINTR);
+         if (retc < 0) return;
+         while(iovcnt && (size_t)retc >= iov->iov_len)
+              {retc -= iov->iov_len; iov++; iovcnt--;}
+         if (iovcnt)
+            {iov->iov_base = (char *)iov->iov_base + retc;
+             iov->iov_len -= retc;
+            }
+        }
+}
+
+/******************************************************************************/
+/*                                W r i t e r                                 */
+/******************************************************************************/
+
+void XrdSysLoggerAQ::Writer()
+{
+
+// Drain until there is nothing left. Then advertise that we are idle and look
+// once more so that a message queued just before the flag was set is not
+// left behind. Queue() publishes before testing the flag, so either we see
+// its message or it sees the flag and wakes us up. Any extra post simply
+// causes one more pass.
+//
+   while(1)
+        {drainMtx.Lock();
+         bool didIO = Drain();
+         drainMtx.UnLock();
+         if (didIO) continue;
+         wIdle.store(true);
+         drainMtx.Lock();
+         didIO = Drain();
+         drainMtx.UnLock();
+         if (!didIO) wakeUp.Wait();
+         wIdle.store(false);
+        }
+}
+  
 /******************************************************************************/
 /*            E x t e r n a l   T h r e a d   I n t e r f a c e s             */
 /******************************************************************************/
@@ -134,6 +513,12 @@ void  *XrdSysLoggerRT(void *carg)
        return (void *)0;
       }
 
+void  *XrdSysLoggerWR(void *carg)
+      {XrdSysLoggerAQ *aqP = (XrdSysLoggerAQ *)carg;
+       aqP->Writer();
+       return (void *)0;
+      }
+
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -153,6 +538,7 @@ XrdSysLogger::XrdSysLogger(int ErrFD, int dorotate)
    hiRes   = false;
    fifoFN  = 0;
    reserved1 = 0;
+   aQueue  = 0;
 
 // Establish default log file name
 //
@@ -288,6 +674,24 @@ void XrdSysLogger::Capture(XrdOucTListFIFO *tFIFO)
    Logger_Mutex.UnLock();
 }
   
+/******************************************************************************/
+/*                                 F l u s h                                  */
+/******************************************************************************/
+
+void XrdSysLogger::Flush()
+{
+   XrdSysLoggerAQ *aqP = aQueue.load();
+
+// Write out anything that has been queued before syncing the file
+//
+   if (aqP)
+      {aqP->drainMtx.Lock();
+       aqP->Drain();
+       aqP->drainMtx.UnLock();
+      }
+   fsync(eFD);
+}
+
 /******************************************************************************/
 /*                             P a r s e K e e p                              */
 /******************************************************************************/
@@ -354,6 +758,12 @@ void XrdSysLogger::Put(int iovcnt, struct iovec *iov)
        iov[0].iov_len  = TimeStamp(tVal, tID, tbuff, sizeof(tbuff), hiRes);
       }
 
+// Queue the message if we are running asynchronously and are not capturing.
+// Otherwise, the message is written in line.
+//
+   XrdSysLoggerAQ *aqP = aQueue.load(std::memory_order_acquire);
+   if (aqP && !tFifo && aqP->Queue(iovcnt, iov)) return;
+
 // Obtain the serailization mutex if need be
 //
    Logger_Mutex.Lock();
@@ -377,6 +787,62 @@ void XrdSysLogger::Put(int iovcnt, struct iovec *iov)
    Logger_Mutex.UnLock();
 }
   
+/******************************************************************************/
+/*                              s e t A s y n c                               */
+/******************************************************************************/
+
+int XrdSysLogger::setAsync(int qsize)
+{
+   static XrdSysMutex aqMutex;
+   XrdSysMutexHelper  aqHelp(aqMutex);
+   XrdSysLoggerAQ *aqP;
+   pthread_t tid;
+   int rc;
+
+// Only one logger may be asynchronous and it stays that way
+//
+   if (aQueue.load()) return 0;
+   if (XrdSysLoggerAQ::aqLogger) return -EEXIST;
+
+// Allocate the queue anchor and the key used to find each thread's ring
+//
+   aqP = new XrdSysLoggerAQ(this, qsize);
+   if ((rc = pthread_key_create(&aqP->ringKey, RingExit)))
+      {delete aqP;
+       return -rc;
+      }
+
+// Start the writer thread
+//
+   if (XrdSysThread::Run(&tid, XrdSysLoggerWR, (void *)aqP, 0,
+                         "Logfile writer"))
+      {rc = errno;
+       pthread_key_delete(aqP->ringKey);
+       delete aqP;
+       return -rc;
+      }
+
+// Make sure queued messages are written at exit and that a forked child
+// does not queue messages that nobody will ever write.
+//
+   XrdSysLoggerAQ::aqLogger = this;
+   atexit(XrdSysLoggerAQ::AsyncExit);
+   pthread_atfork(0, 0, XrdSysLoggerAQ::AsyncFork);
+
+// Route cerr through the queue as well if it shares our file descriptor. We
+// do this under the logger mutex so no trace record is in progress.
+//
+   if (eFD == STDERR_FILENO)
+      {aqBuff = new LogStreamBuf(aqP);
+       Logger_Mutex.Lock();
+       cerr.flush();
+       cerrBuf = cerr.rdbuf(aqBuff);
+       aQueue.store(aqP, std::memory_order_release);
+       Logger_Mutex.UnLock();
+      } else aQueue.store(aqP, std::memory_order_release);
+   return 0;
+}
+
 /******************************************************************************/
 /* Private:                         T i m e                                   */
 /******************************************************************************/
@@ -836,6 +1302,12 @@ void XrdSysLogger::zHandler()
                   continue;
                  }
 
+// When output is asynchronous, everything queued before midnight must be
+// written to the old file and nothing may be written while we switch files.
+//
+         XrdSysLoggerAQ *aqP = aQueue.load();
+         if (aqP) {aqP->drainMtx.Lock(); aqP->Drain();}
+
          Logger_Mutex.Lock();
          ReBind();
 
@@ -846,6 +1318,7 @@ void XrdSysLogger::zHandler()
               }
          tP = taskQ;
          Logger_Mutex.UnLock();
+         if (aqP) aqP->drainMtx.UnLock();
 
          if (tP)
             {if (XrdSysThread::Run(&tid, XrdSysLoggerMN, (void *)tP, 0,
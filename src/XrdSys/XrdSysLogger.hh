@@ -40,6 +40,8 @@
 #include "XrdSys/XrdWin32.hh"
 #endif
 
+#include <atomic>
+
 #include "XrdSys/XrdSysPthread.hh"
 
 //-----------------------------------------------------------------------------
@@ -48,10 +50,12 @@
 //-----------------------------------------------------------------------------
 
 class XrdOucTListFIFO;
+class XrdSysLoggerAQ;
 
 class XrdSysLogger
 {
 public:
+friend class XrdSysLoggerAQ;
 
 //-----------------------------------------------------------------------------
 //! Constructor
@@ -146,10 +150,11 @@ int Bind(const char *path, int lfh=0);
 void Capture(XrdOucTListFIFO *tFIFO);
 
 //-----------------------------------------------------------------------------
-//! Flush any pending output
+//! Flush any pending output. When running asynchronously, all queued messages
+//! are written before the file is synced.
 //-----------------------------------------------------------------------------
 
-void Flush() {fsync(eFD);}
+void Flush();
 
 //-----------------------------------------------------------------------------
 //! Get the file descriptor passed at construction time.
@@ -182,6 +187,26 @@ int  ParseKeep(const char *arg);
 
 void Put(int iovcnt, struct iovec *iov);
 
+//-----------------------------------------------------------------------------
+//! Switch to asynchronous output. Each thread then copies its messages into a
+//! private lock-free queue which is drained by a single writer thread using
+//! batched writev() calls. A thread whose queue is full drops the message
+//! instead of waiting; the writer periodically reports the number of lost
+//! messages. Output sent to cerr (i.e. trace records) is queued as well when
+//! the logger writes to stderr. Asynchronous mode cannot be turned off and
+//! only one logger may use it. It should be enabled after the process has
+//! daemonized as the writer thread does not survive a fork.
+//!
+//! @param  qsize     The size of each per-thread queue in bytes. It is rounded
+//!                   up to a power of two between 8K and 16M. Messages longer
+//!                   than a quarter of the queue are written synchronously.
+//!
+//! @return  0        Processing successful.
+//! @return <0        Unable to start, returned value is -errno of the reason.
+//-----------------------------------------------------------------------------
+
+int  setAsync(int qsize=65536);
+
 //-----------------------------------------------------------------------------
 //! Set call-out to logging plug-in on or off.
 //-----------------------------------------------------------------------------
@@ -275,6 +300,7 @@ char      *fifoFN;
 bool       hiRes;
 bool       doLFR;
 pthread_t  lfhTID;
+std::atomic<XrdSysLoggerAQ *> aQueue;
 
 static bool doForward;
 
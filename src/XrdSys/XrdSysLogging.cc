@@ -89,6 +89,14 @@ bool XrdSysLogging::Configure(XrdSysLogger &logr, Parms &parms)
        lclOut = true;
       }
 
+// Write local output asynchronously if so wanted
+//
+   if (parms.asyncQ && (rc = logr.setAsync(parms.asyncQ)))
+      {sprintf(eBuff, "Error %d (%s) starting asynchronous logging.\n",
+               -rc, strerror(-rc));
+       return EMsg(logr, eBuff);
+      }
+
 // If we are not sending output to a remote destination, we are done
 //
    if (!parms.logpi) {lclOut = true; return true;}
@@ -66,8 +66,10 @@ struct Parms
        XrdSysLogPI_t  logpi;    //!< -> log plugin object or nil if none
        int            bufsz;    //!<    size of message buffer, -1 default, or 0
        int            keepV;    //!<    log keep argument
+       int            asyncQ;   //!<    per-thread async queue size or 0
        bool           hiRes;    //!<    log using high resolution timestamp
-       Parms() : logfn(0), logpi(0), bufsz(-1), keepV(0), hiRes(false) {}
+       Parms() : logfn(0), logpi(0), bufsz(-1), keepV(0), asyncQ(0),
+                 hiRes(false) {}
       ~Parms() {}
      };
 
@@ -0,0 +1,59 @@
+#ifndef __XRDSYS_PROBE_HH__
+#define __XRDSYS_PROBE_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d S y s P r o b e . h h                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+/* The following macros define user space statically defined tracing (USDT)
+   probe points. When the platform provides <sys/sdt.h> each probe compiles
+   to a single no-op instruction plus a note describing it, so it costs
+   nothing unless a tracer (e.g. bpftrace, perf, or SystemTap) attaches to
+   it. Otherwise, the macros expand to nothing. Probes are named by provider
+   (the component) and event, with a double underscore in the event name
+   becoming a dash in the tracer, e.g.
+
+   XrdSysProbe2(xrootd, request__start, reqID, dlen);   // xrootd:request-start
+
+   Arguments should be integers or pointers. Keep them cheap to compute as
+   they are evaluated even when the probe is not attached.
+*/
+
+#ifdef HAVE_SDT
+#include <sys/sdt.h>
+
+#define XrdSysProbe(prv, evt)                  DTRACE_PROBE(prv, evt)
+#define XrdSysProbe1(prv, evt, a)              DTRACE_PROBE1(prv, evt, a)
+#define XrdSysProbe2(prv, evt, a, b)           DTRACE_PROBE2(prv, evt, a, b)
+#define XrdSysProbe3(prv, evt, a, b, c)        DTRACE_PROBE3(prv, evt, a, b, c)
+#define XrdSysProbe4(prv, evt, a, b, c, d)     DTRACE_PROBE4(prv, evt, a, b, c, d)
+#else
+#define XrdSysProbe(prv, evt)
+#define XrdSysProbe1(prv, evt, a)
+#define XrdSysProbe2(prv, evt, a, b)
+#define XrdSysProbe3(prv, evt, a, b, c)
+#define XrdSysProbe4(prv, evt, a, b, c, d)
+#endif
+#endif
@@ -102,9 +102,11 @@ int XrdSysCondVar::Wait()
 
 // Wait for the condition
 //
+   __atomic_add_fetch(&nWait, 1, __ATOMIC_SEQ_CST);
    if (relMutex) Lock();
    retc = pthread_cond_wait(&cvar, &cmut);
    if (relMutex) UnLock();
+   __atomic_sub_fetch(&nWait, 1, __ATOMIC_SEQ_CST);
    return retc;
 }
 
@@ -130,6 +132,7 @@ int XrdSysCondVar::WaitMS(int msec)
 
 // Get the mutex before getting the time
 //
+   __atomic_add_fetch(&nWait, 1, __ATOMIC_SEQ_CST);
    if (relMutex) Lock();
 
 // Get current time of day
@@ -153,6 +156,7 @@ int XrdSysCondVar::WaitMS(int msec)
    while (retc && (retc == EINTR));
 
    if (relMutex) UnLock();
+   __atomic_sub_fetch(&nWait, 1, __ATOMIC_SEQ_CST);
 
 // Determine how to return
 //
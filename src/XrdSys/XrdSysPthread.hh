@@ -35,6 +35,7 @@
 #endif
 #include <pthread.h>
 #include <signal.h>
+#include <unistd.h>
 #ifdef AIX
 #include <sys/sem.h>
 #else
@@ -43,12 +44,63 @@
 
 #include "XrdSys/XrdSysError.hh"
 
+/******************************************************************************/
+/*                            X r d S y s S p i n                             */
+/******************************************************************************/
+
+// XrdSysSpin bounds the busy waiting the synchronization objects below do
+//            before putting a thread to sleep. Most handoffs complete within
+//            a few microseconds, so a short spin usually avoids the cost of a
+//            futex sleep and wakeup. Count() is zero on a uniprocessor, where
+//            spinning can only delay the thread we are waiting for. All of it
+//            is inline so that users of the inline methods below need not
+//            link against libXrdUtils.
+
+class XrdSysSpin
+{
+public:
+
+static
+inline int  Count()
+            {static const int n = (sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 100 : 0);
+             return n;
+            }
+
+static
+inline void InitMutex(pthread_mutex_t *mtx)
+            {
+#ifdef PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP
+             pthread_mutexattr_t attr;
+             if (Count() && !pthread_mutexattr_init(&attr))
+                {pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+                 pthread_mutex_init(mtx, &attr);
+                 pthread_mutexattr_destroy(&attr);
+                 return;
+                }
+#endif
+             pthread_mutex_init(mtx, NULL);
+            }
+
+static
+inline void Pause()
+            {
+#if defined(__x86_64__) || defined(__i386__)
+             __builtin_ia32_pause();
+#elif defined(__aarch64__)
+             __asm__ __volatile__("yield");
+#endif
+            }
+};
+
 /******************************************************************************/
 /*                         X r d S y s C o n d V a r                          */
 /******************************************************************************/
   
 // XrdSysCondVar implements the standard POSIX-compliant condition variable.
 //               Methods correspond to the equivalent pthread condvar functions.
+//               Signal() and Broadcast() return at once when no thread is
+//               waiting; waiters register before taking the mutex so that
+//               no signal that could have been received is skipped.
 
 class XrdSysCondVar
 {
@@ -56,12 +108,16 @@ public:
 
 inline void  Lock()           {pthread_mutex_lock(&cmut);}
 
-inline void  Signal()         {if (relMutex) pthread_mutex_lock(&cmut);
+inline void  Signal()         {if (!__atomic_load_n(&nWait, __ATOMIC_SEQ_CST))
+                                  return;
+                               if (relMutex) pthread_mutex_lock(&cmut);
                                pthread_cond_signal(&cvar);
                                if (relMutex) pthread_mutex_unlock(&cmut);
                               }
 
-inline void  Broadcast()      {if (relMutex) pthread_mutex_lock(&cmut);
+inline void  Broadcast()      {if (!__atomic_load_n(&nWait, __ATOMIC_SEQ_CST))
+                                  return;
+                               if (relMutex) pthread_mutex_lock(&cmut);
                                pthread_cond_broadcast(&cvar);
                                if (relMutex) pthread_mutex_unlock(&cmut);
                               }
@@ -75,8 +131,9 @@ inline void  UnLock()         {pthread_mutex_unlock(&cmut);}
       XrdSysCondVar(      int   relm=1, // 0->Caller will handle lock/unlock
                     const char *cid=0   // ID string for debugging only
                    ) {pthread_cond_init(&cvar, NULL);
-                      pthread_mutex_init(&cmut, NULL);
+                      XrdSysSpin::InitMutex(&cmut);
                       relMutex = relm; condID = (cid ? cid : "unk");
+                      nWait = 0;
                      }
      ~XrdSysCondVar() {pthread_cond_destroy(&cvar);
                        pthread_mutex_destroy(&cmut);
@@ -86,6 +143,7 @@ private:
 pthread_cond_t  cvar;
 pthread_mutex_t cmut;
 int             relMutex;
+int             nWait;     // Threads in Wait() or WaitMS()
 const char     *condID;
 };
 
@@ -196,7 +254,7 @@ inline void   Lock() {pthread_mutex_lock(&cs);}
 
 inline void UnLock() {pthread_mutex_unlock(&cs);}
 
-        XrdSysMutex() {pthread_mutex_init(&cs, NULL);}
+        XrdSysMutex() {XrdSysSpin::InitMutex(&cs);}
        ~XrdSysMutex() {pthread_mutex_destroy(&cs);}
 
 protected:
@@ -348,6 +406,9 @@ XrdSysRWLock *lck;
 //                 should be self-evident. Note that on certain platforms
 //                 semaphores need to be implemented based on condition
 //                 variables since no native implementation is available.
+//                 Otherwise, Wait() spins for up to XrdSysSpin::Count() tries
+//                 before sleeping; Post() only enters the kernel when there
+//                 is a waiter to wake.
   
 #ifdef __APPLE__
 class XrdSysSemaphore
@@ -391,7 +452,11 @@ inline void Post() {if (sem_post(&h_semaphore))
                        {throw "sem_post() failed";}
                    }
 
-inline void Wait() {while (sem_wait(&h_semaphore))
+inline void Wait() {for (int i = XrdSysSpin::Count(); i > 0; i--)
+                        {if (!sem_trywait(&h_semaphore)) return;
+                         XrdSysSpin::Pause();
+                        }
+                    while (sem_wait(&h_semaphore))
                           {if (EINTR != errno) 
                               {throw "sem_wait() failed";}
                           }
@@ -0,0 +1,205 @@
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d S y s T i m e r W h e e l . c c                    */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdSys/XrdSysTimerWheel.hh"
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdSysTimerWheel::XrdSysTimerWheel(long long now) : curTick(now), numEnt(0)
+{
+   for (int i = 0; i < wLevels; i++)
+       {lvlCnt[i] = 0;
+        for (int j = 0; j < wSlots; j++)
+            wheel[i][j].tmNext = wheel[i][j].tmPrev = &wheel[i][j];
+       }
+   pastDue.tmNext = pastDue.tmPrev = &pastDue;
+   lvlCnt[wLevels] = 0;
+}
+
+/******************************************************************************/
+/*                                   A d d                                    */
+/******************************************************************************/
+
+void XrdSysTimerWheel::Add(Entry *ep, long long when)
+{
+   if (ep->tmPrev) Cancel(ep);
+   ep->tmWhen = when;
+   Link(ep);
+   numEnt++;
+}
+
+/******************************************************************************/
+/*                                C a n c e l                                 */
+/******************************************************************************/
+
+bool XrdSysTimerWheel::Cancel(Entry *ep)
+{
+   if (!ep->tmPrev) return false;
+
+   ep->tmPrev->tmNext = ep->tmNext;
+   ep->tmNext->tmPrev = ep->tmPrev;
+   ep->tmNext = ep->tmPrev = 0;
+   lvlCnt[ep->tmLevel]--;
+   numEnt--;
+   return true;
+}
+
+/******************************************************************************/
+/*                                E x p i r e                                 */
+/******************************************************************************/
+
+XrdSysTimerWheel::Entry *XrdSysTimerWheel::Expire(long long now)
+{
+   Entry *first = 0, *last = 0, *hP, *ep;
+
+// Entries added for ticks we already processed go first
+//
+   while((ep = pastDue.tmNext) != &pastDue)
+        {pastDue.tmNext = ep->tmNext; ep->tmNext->tmPrev = &pastDue;
+         ep->tmNext = ep->tmPrev = 0;
+         lvlCnt[wLevels]--; numEnt--;
+         if (last) last->tmNext = ep;
+            else first = ep;
+         last = ep;
+        }
+
+// Walk the ticks up to now. Spans where the lowest level is empty are skipped
+// up to the next point where the upper levels move down, so an idle wheel
+// costs nothing and a sparse one little.
+//
+   while(curTick <= now)
+        {if (!numEnt) {curTick = now+1; break;}
+         if (!(curTick & wMask)) Cascade(1);
+         if (!lvlCnt[0])
+            {long long next = (curTick | wMask) + 1;
+             curTick = (next > now ? now+1 : next);
+             continue;
+            }
+
+         hP = &wheel[0][curTick & wMask];
+         while((ep = hP->tmNext) != hP)
+              {hP->tmNext = ep->tmNext; ep->tmNext->tmPrev = hP;
+               ep->tmNext = ep->tmPrev = 0;
+               lvlCnt[0]--; numEnt--;
+               if (last) last->tmNext = ep;
+                  else first = ep;
+               last = ep;
+              }
+         curTick++;
+        }
+
+   return first;
+}
+
+/******************************************************************************/
+/*                              N e x t T i c k                               */
+/******************************************************************************/
+
+long long XrdSysTimerWheel::NextTick() const
+{
+   long long tick, bound = curTick | wMask;
+
+   if (!numEnt) return -1;
+   if (lvlCnt[wLevels]) return curTick-1;
+
+// If we are at a point where upper levels move down, they have to do so now
+//
+   if (!(curTick & wMask) && numEnt > lvlCnt[0]) return curTick;
+
+   if (lvlCnt[0])
+      for (tick = curTick; tick <= bound; tick++)
+          {const Entry *hP = &wheel[0][tick & wMask];
+           if (hP->tmNext != hP) return tick;
+          }
+
+   return bound + 1;
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                               C a s c a d e                                */
+/******************************************************************************/
+
+// Move the entries of the current slot of the given level down. This is done
+// when the index of the level below wraps to zero, i.e. when the slot becomes
+// the one covering the next 256^lvl ticks. The level above goes first as its
+// entries may land in the slot we are about to redistribute.
+//
+void XrdSysTimerWheel::Cascade(int lvl)
+{
+   int idx = (curTick >> (wBits*lvl)) & wMask;
+   Entry *hP = &wheel[lvl][idx], *ep, *np;
+
+   if (!idx && lvl < wLevels-1) Cascade(lvl+1);
+
+   if ((ep = hP->tmNext) == hP) return;
+   hP->tmNext = hP->tmPrev = hP;
+
+   while(ep != hP)
+        {np = ep->tmNext;
+         lvlCnt[lvl]--;
+         Link(ep);
+         ep = np;
+        }
+}
+
+/******************************************************************************/
+/*                                  L i n k                                   */
+/******************************************************************************/
+
+void XrdSysTimerWheel::Link(Entry *ep)
+{
+   const unsigned long long range = 1ULL << (wBits*wLevels);
+   long long when = ep->tmWhen;
+   unsigned long long delta = when - curTick;
+   Entry *hP;
+   int lvl = 0;
+
+// Entries for ticks already processed wait for the next Expire() call
+//
+   if (when < curTick)
+      {hP = &pastDue; lvl = wLevels;}
+      else {
+
+// Find the level whose span covers the entry, far entries are parked in the
+// last slot of the top level and looked at again when we get there.
+//
+       if (delta >= range) {when = curTick + range - 1; lvl = wLevels-1;}
+          else while(lvl < wLevels-1 && delta >= (1ULL << (wBits*(lvl+1))))
+                    lvl++;
+       hP = &wheel[lvl][(when >> (wBits*lvl)) & wMask];
+      }
+
+   ep->tmNext = hP;
+   ep->tmPrev = hP->tmPrev;
+   hP->tmPrev->tmNext = ep;
+   hP->tmPrev = ep;
+   ep->tmLevel = lvl;
+   lvlCnt[lvl]++;
+}
@@ -0,0 +1,152 @@
+#ifndef __XRDSYSTIMERWHEEL_HH__
+#define __XRDSYSTIMERWHEEL_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d S y s T i m e r W h e e l . h h                    */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+//-----------------------------------------------------------------------------
+//! A hierarchical timing wheel. Entries are kept in four levels of 256 slots
+//! each; level n holds the entries due within 256^(n+1) ticks. Adding and
+//! cancelling an entry is O(1). Entries migrate towards level 0 as their
+//! time approaches, so each one is touched at most once per level. What a
+//! tick is (a second, a millisecond) is up to the user; the wheel never
+//! reads a clock. Entries more than 2^32 ticks away are parked at the top
+//! level and recycled until they come in range.
+//!
+//! The wheel does no locking, the user must serialize all calls.
+//-----------------------------------------------------------------------------
+
+class XrdSysTimerWheel
+{
+public:
+
+//-----------------------------------------------------------------------------
+//! A timer entry. Objects to be scheduled inherit (or contain) this class.
+//-----------------------------------------------------------------------------
+
+class Entry
+{
+friend class XrdSysTimerWheel;
+public:
+
+//! Return true if the entry is in a wheel.
+
+bool       Pending() const {return tmPrev != 0;}
+
+//! Return the tick at which the entry expires (only valid when pending or
+//! when just returned by Expire()).
+
+long long  When() const {return tmWhen;}
+
+//! Return the next entry on the list returned by Expire().
+
+Entry     *Next() const {return tmNext;}
+
+           Entry() : tmNext(0), tmPrev(0), tmWhen(0), tmLevel(0) {}
+          ~Entry() {}
+
+private:
+Entry     *tmNext;
+Entry     *tmPrev;
+long long  tmWhen;
+int        tmLevel;
+};
+
+//-----------------------------------------------------------------------------
+//! Add an entry to the wheel, removing it first if it is already pending.
+//!
+//! @param  ep     Pointer to the entry.
+//! @param  when   The tick at which it expires. An entry for a tick that
+//!                has already been processed expires on the next call to
+//!                Expire(), whatever its argument.
+//-----------------------------------------------------------------------------
+
+void       Add(Entry *ep, long long when);
+
+//-----------------------------------------------------------------------------
+//! Remove an entry from the wheel.
+//!
+//! @param  ep     Pointer to the entry.
+//!
+//! @return true if the entry was pending and false otherwise.
+//-----------------------------------------------------------------------------
+
+bool       Cancel(Entry *ep);
+
+//-----------------------------------------------------------------------------
+//! Return the number of pending entries.
+//-----------------------------------------------------------------------------
+
+int        Count() const {return numEnt;}
+
+//-----------------------------------------------------------------------------
+//! Advance the wheel and remove all entries expiring at or before now.
+//!
+//! @param  now    The current tick.
+//!
+//! @return The expired entries linked through Next(), in order of expiry
+//!         (entries of the same tick in no particular order), or nil if
+//!         none expired.
+//-----------------------------------------------------------------------------
+
+Entry     *Expire(long long now);
+
+//-----------------------------------------------------------------------------
+//! Return the tick at which Expire() should be called next.
+//!
+//! @return The tick of the earliest entry if it is in the lowest level,
+//!         otherwise the tick at which entries next move down (which is
+//!         never later than the earliest entry). If the wheel is empty, a
+//!         negative value is returned.
+//-----------------------------------------------------------------------------
+
+long long  NextTick() const;
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//!
+//! @param  now    The current tick.
+//-----------------------------------------------------------------------------
+
+           XrdSysTimerWheel(long long now=0);
+
+          ~XrdSysTimerWheel() {}
+
+private:
+
+static const int wBits   = 8;
+static const int wSlots  = 1 << wBits;
+static const int wMask   = wSlots - 1;
+static const int wLevels = 4;
+
+void       Cascade(int lvl);
+void       Link(Entry *ep);
+
+Entry      wheel[wLevels][wSlots]; // circular list anchors
+Entry      pastDue;                // anchor of entries for processed ticks
+int        lvlCnt[wLevels+1];      // entries in each level and past due
+long long  curTick;                // the next tick to be processed
+int        numEnt;
+};
+#endif
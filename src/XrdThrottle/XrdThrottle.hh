@@ -101,6 +101,7 @@ private:
 
    unique_sfs_ptr m_sfs;
    int m_uid; // A unique identifier for this user; has no meaning except for the fairshare.
+   XrdThrottleBucket *m_bucket; // The user's token bucket, if buckets are used for the fairshare.
    std::string m_loadshed;
    std::string m_user;
    XrdThrottleManager &m_throttle;
@@ -237,12 +238,20 @@ private:
    int
    xtrace(XrdOucStream &Config);
 
+   int
+   xfairshare(XrdOucStream &Config);
+
+   int
+   xmanager(XrdOucStream &Config);
+
    static FileSystem  *m_instance;
    XrdSysError         m_eroute;
    XrdOucTrace         m_trace;
    std::string         m_config_file;
    XrdSfsFileSystem   *m_sfs_ptr;
    bool                m_initialized;
+   bool                m_loadshed_manager;
+   std::string         m_manager_host;
    XrdThrottleManager  m_throttle;
    XrdVersionInfo     *myVersion;
 
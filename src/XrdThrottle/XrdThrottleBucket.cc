@@ -0,0 +1,356 @@
+#include "XrdThrottleBucket.hh"
+
+#include <sstream>
+#include <time.h>
+
+#include "XrdSys/XrdSysAtomics.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+#define XRD_TRACE m_trace->
+#include "XrdThrottle/XrdThrottleTrace.hh"
+
+const char *
+XrdThrottleFairShare::TraceID = "ThrottleFairShare";
+
+/*
+ * Compare and swap; the engine is only enabled when atomics are available.
+ */
+static inline bool
+CompareAndSwap(long long &x, long long oldval, long long newval)
+{
+#ifdef HAVE_ATOMICS
+   return __sync_bool_compare_and_swap(&x, oldval, newval);
+#else
+   if (x != oldval) return false;
+   x = newval;
+   return true;
+#endif
+}
+
+XrdThrottleBucket::XrdThrottleBucket(XrdThrottleBucket *parent, long long now) :
+   m_bytes(0),
+   m_ops(0),
+   m_byte_rate(1),
+   m_ops_rate(1),
+   m_byte_cap(0),
+   m_ops_cap(0),
+   m_burst_us(1),
+   m_last(now),
+   m_active(0),
+   m_refs(0),
+   m_parent(parent),
+   m_head(0),
+   m_tail(0),
+   m_waiting(0)
+{
+   for (int i=0; i<m_bins; i++) m_hist[i] = 0;
+}
+
+/*
+ * Add tokens to a bucket without letting it exceed its capacity.
+ */
+void
+XrdThrottleBucket::Credit(long long &tokens, long long amount, long long cap)
+{
+   long long cur, next;
+   do
+   {
+      cur = AtomicGet(tokens);
+      next = cur + amount;
+      if (next > cap) next = cap;
+   } while (!CompareAndSwap(tokens, cur, next));
+}
+
+/*
+ * Microseconds until a bucket with the given tokens is out of debt.
+ */
+long long
+XrdThrottleBucket::Deficit(long long tokens, long long rate)
+{
+   return (tokens > 0) ? 0 : (-tokens)/rate + 1;
+}
+
+/*
+ * Credit the tokens accrued since the last refill.  Only the thread that
+ * manages to advance the refill time does the crediting.
+ */
+void
+XrdThrottleBucket::Refill(long long now)
+{
+   long long last = AtomicGet(m_last);
+   if (now <= last || !CompareAndSwap(m_last, last, now)) return;
+
+   long long elapsed = now - last;
+   if (elapsed > m_burst_us) elapsed = m_burst_us;
+   Credit(m_bytes, m_byte_rate * elapsed, m_byte_cap);
+   Credit(m_ops,   m_ops_rate  * elapsed, m_ops_cap);
+}
+
+void
+XrdThrottleBucket::SetRates(long long byte_rate, long long ops_rate, long long burst_us)
+{
+   m_byte_rate = (byte_rate > 0) ? byte_rate : 1;
+   m_ops_rate  = (ops_rate  > 0) ? ops_rate  : 1;
+   m_burst_us  = burst_us;
+   m_byte_cap  = m_byte_rate * burst_us;
+   m_ops_cap   = m_ops_rate  * burst_us;
+}
+
+/*
+ * Debit the request from this bucket and its parent if neither is in debt;
+ * otherwise set waitus to the time until both should have recovered.
+ */
+bool
+XrdThrottleBucket::Take(long long now, long long reqsize, long long reqops, long long &waitus)
+{
+   XrdThrottleBucket *parent = m_parent;
+   long long wait = 0, need;
+
+   Refill(now);
+   if (parent) parent->Refill(now);
+
+   if (reqsize)
+   {
+      wait = Deficit(AtomicGet(m_bytes), m_byte_rate);
+      if (parent && (need = Deficit(AtomicGet(parent->m_bytes), parent->m_byte_rate)) > wait)
+         wait = need;
+   }
+   if (reqops)
+   {
+      if ((need = Deficit(AtomicGet(m_ops), m_ops_rate)) > wait)
+         wait = need;
+      if (parent && (need = Deficit(AtomicGet(parent->m_ops), parent->m_ops_rate)) > wait)
+         wait = need;
+   }
+   if (wait)
+   {
+      waitus = wait;
+      return false;
+   }
+
+   if (reqsize)
+   {
+      AtomicSub(m_bytes, reqsize * 1000000);
+      if (parent) AtomicSub(parent->m_bytes, reqsize * 1000000);
+   }
+   if (reqops)
+   {
+      AtomicSub(m_ops, reqops * 1000000);
+      if (parent) AtomicSub(parent->m_ops, reqops * 1000000);
+   }
+   return true;
+}
+
+XrdThrottleFairShare::XrdThrottleFairShare(XrdOucTrace *tP, float bytes_per_second,
+                                           float ops_per_second, int burst_ms) :
+   m_trace(tP),
+   m_byte_rate(bytes_per_second > 0 ? static_cast<long long>(bytes_per_second) : 1),
+   m_ops_rate(ops_per_second > 0 ? static_cast<long long>(ops_per_second) : 1),
+   m_burst_us(static_cast<long long>(burst_ms) * 1000),
+   m_queued(0)
+{
+}
+
+long long
+XrdThrottleFairShare::Now()
+{
+   struct timespec now = {0, 0};
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return static_cast<long long>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+/*
+ * Users are identified the same way as for the hashed shares; a user
+ * without a VO belongs to the default class.  New buckets start full
+ * with an equal split of the current rates.
+ */
+XrdThrottleBucket *
+XrdThrottleFairShare::Get(const char *user, const char *vo)
+{
+   std::string uname, cname = (vo ? vo : "");
+   const char *cur = user;
+   while (cur && *cur && *cur != '@' && *cur != '.')
+   {
+      uname += *cur;
+      cur++;
+   }
+
+   long long now = Now();
+   XrdSysMutexHelper lock(m_mutex);
+   Class *&cls = m_classes[cname];
+   if (!cls)
+   {
+      long long n = m_classes.size();
+      cls = new Class(now);
+      cls->m_bucket.SetRates(m_byte_rate / n, m_ops_rate / n, m_burst_us);
+      cls->m_bucket.m_bytes = cls->m_bucket.m_byte_cap;
+      cls->m_bucket.m_ops = cls->m_bucket.m_ops_cap;
+   }
+   XrdThrottleBucket *&bucket = cls->m_users[uname];
+   if (!bucket)
+   {
+      long long n = cls->m_users.size();
+      bucket = new XrdThrottleBucket(&cls->m_bucket, now);
+      bucket->SetRates(cls->m_bucket.m_byte_rate / n, cls->m_bucket.m_ops_rate / n, m_burst_us);
+      bucket->m_bytes = bucket->m_byte_cap;
+      bucket->m_ops = bucket->m_ops_cap;
+      TRACE(FAIRSHARE, "Created bucket for user " << uname << " in class " << (cname.empty() ? "-" : cname));
+   }
+   bucket->m_refs++;
+   return bucket;
+}
+
+void
+XrdThrottleFairShare::Release(XrdThrottleBucket *bucket)
+{
+   XrdSysMutexHelper lock(m_mutex);
+   bucket->m_refs--;
+}
+
+/*
+ * The fast path takes the tokens without any lock.  A request that cannot
+ * pass joins the user's queue; only the head of the queue waits for the
+ * buckets to refill and it hands over to the next request when done.
+ */
+long long
+XrdThrottleFairShare::Apply(XrdThrottleBucket *bucket, int reqsize, int reqops)
+{
+   XrdThrottleBucket *cls = bucket->m_parent;
+   long long start = Now(), waitus;
+
+   AtomicInc(bucket->m_active);
+   AtomicInc(cls->m_active);
+   if (!AtomicGet(bucket->m_waiting) && bucket->Take(start, reqsize, reqops, waitus))
+   {
+      AtomicInc(cls->m_hist[0]);
+      return 0;
+   }
+
+   AtomicInc(m_queued);
+   XrdThrottleBucket::Waiter me;
+   bucket->m_mutex.Lock();
+   AtomicInc(bucket->m_waiting);
+   if (bucket->m_tail) bucket->m_tail->m_next = &me;
+   else bucket->m_head = &me;
+   bucket->m_tail = &me;
+   bool is_head = (bucket->m_head == &me);
+   bucket->m_mutex.UnLock();
+
+   if (!is_head) me.m_sem.Wait();
+
+   // The rates may change at any recompute; do not sleep too long at once.
+   while (!bucket->Take(Now(), reqsize, reqops, waitus))
+   {
+      TRACE(DEBUG, "Sleeping " << waitus << "us to wait for throttle fairshare.");
+      XrdSysTimer::Wait(waitus >= 100000 ? 100 : static_cast<int>(waitus/1000) + 1);
+   }
+
+   bucket->m_mutex.Lock();
+   bucket->m_head = me.m_next;
+   if (bucket->m_head) bucket->m_head->m_sem.Post();
+   else bucket->m_tail = 0;
+   AtomicDec(bucket->m_waiting);
+   bucket->m_mutex.UnLock();
+   AtomicDec(m_queued);
+
+   long long delay_us = Now() - start, delay_ms = delay_us / 1000;
+   int bin = 1;
+   while (delay_ms && bin < XrdThrottleBucket::m_bins-1)
+   {
+      delay_ms >>= 1;
+      bin++;
+   }
+   AtomicInc(cls->m_hist[bin]);
+   return delay_us;
+}
+
+int
+XrdThrottleFairShare::Queued()
+{
+   return AtomicGet(m_queued);
+}
+
+/*
+ * Split the total rates evenly over the classes that saw requests in the
+ * last interval and each class rate evenly over its active users.  Idle
+ * users get the same rate so they can start right away; user buckets no
+ * longer referenced by any file are dropped.
+ */
+void
+XrdThrottleFairShare::Recompute()
+{
+   XrdSysMutexHelper lock(m_mutex);
+
+   long long active_classes = 0;
+   std::map<std::string, Class*>::iterator it;
+   for (it = m_classes.begin(); it != m_classes.end(); ++it)
+   {
+      if (AtomicGet(it->second->m_bucket.m_active)) active_classes++;
+   }
+   if (!active_classes) active_classes = 1;
+   long long class_byte_rate = m_byte_rate / active_classes;
+   long long class_ops_rate  = m_ops_rate  / active_classes;
+
+   it = m_classes.begin();
+   while (it != m_classes.end())
+   {
+      Class *cls = it->second;
+      const char *cname = it->first.empty() ? "-" : it->first.c_str();
+      int requests;
+      requests = AtomicFAZ(cls->m_bucket.m_active);
+      cls->m_bucket.SetRates(class_byte_rate, class_ops_rate, m_burst_us);
+
+      long long active_users = 0;
+      std::map<std::string, XrdThrottleBucket*>::iterator uit;
+      for (uit = cls->m_users.begin(); uit != cls->m_users.end(); ++uit)
+      {
+         if (AtomicGet(uit->second->m_active)) active_users++;
+      }
+      if (!active_users) active_users = 1;
+      long long user_byte_rate = class_byte_rate / active_users;
+      long long user_ops_rate  = class_ops_rate  / active_users;
+
+      uit = cls->m_users.begin();
+      while (uit != cls->m_users.end())
+      {
+         XrdThrottleBucket *bucket = uit->second;
+         int used;
+         used = AtomicFAZ(bucket->m_active);
+         if (!used && !bucket->m_refs)
+         {
+            delete bucket;
+            cls->m_users.erase(uit++);
+            continue;
+         }
+         bucket->SetRates(user_byte_rate, user_ops_rate, m_burst_us);
+         ++uit;
+      }
+
+      int hist[XrdThrottleBucket::m_bins];
+      for (int i=0; i<XrdThrottleBucket::m_bins; i++)
+      {
+         hist[i] = AtomicFAZ(cls->m_bucket.m_hist[i]);
+      }
+      if (requests && TRACING(TRACE_FAIRSHARE))
+      {
+         std::stringstream ss;
+         ss << "Class " << cname << ": " << requests << " requests, " << cls->m_users.size()
+            << " users; delays none=" << hist[0];
+         for (int i=1; i<XrdThrottleBucket::m_bins; i++)
+         {
+            if (!hist[i]) continue;
+            if (i == XrdThrottleBucket::m_bins-1) ss << " more=" << hist[i];
+            else ss << " <" << (1 << (i-1)) << "ms=" << hist[i];
+         }
+         TRACE(FAIRSHARE, ss.str());
+      }
+
+      if (cls->m_users.empty())
+      {
+         delete cls;
+         m_classes.erase(it++);
+         continue;
+      }
+      ++it;
+   }
+}
@@ -0,0 +1,152 @@
+
+/*
+ * XrdThrottleBucket
+ *
+ * Token-bucket fairshare for the throttle manager.
+ *
+ * Every user gets its own bucket that hangs off the bucket of its class
+ * (the user's VO); a request passes once both its user and class buckets
+ * have tokens left and then debits both, so the buckets may go briefly
+ * into debt.  Buckets are refilled continuously from the elapsed time, so
+ * there is no notion of an interval boundary on the request path.  The
+ * periodic recompute only redistributes the configured rates: the total
+ * is split evenly over the active classes and each class rate evenly over
+ * its active users.
+ *
+ * The request path is lock-free as long as a user has tokens.  Otherwise
+ * the request queues behind any other blocked request of the same user
+ * and only the head of the queue sleeps on the bucket; when it passes it
+ * wakes exactly the next one.
+ *
+ * Tokens are kept in millionths so that refills over short periods are
+ * not lost to rounding.
+ */
+
+#ifndef __XrdThrottleBucket_hh_
+#define __XrdThrottleBucket_hh_
+
+#include <map>
+#include <string>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+class XrdOucTrace;
+
+class XrdThrottleBucket
+{
+
+friend class XrdThrottleFairShare;
+
+private:
+
+struct Waiter
+{
+   Waiter() : m_sem(0), m_next(0) {}
+
+   XrdSysSemaphore m_sem;
+   Waiter         *m_next;
+};
+
+            XrdThrottleBucket(XrdThrottleBucket *parent, long long now);
+
+           ~XrdThrottleBucket() {}
+
+bool        Take(long long now, long long reqsize, long long reqops, long long &waitus);
+
+void        Refill(long long now);
+
+void        SetRates(long long byte_rate, long long ops_rate, long long burst_us);
+
+static
+void        Credit(long long &tokens, long long amount, long long cap);
+
+static
+long long   Deficit(long long tokens, long long rate);
+
+// Tokens, in millionths; may be negative.
+long long   m_bytes;
+long long   m_ops;
+// Refill rates in tokens per second and the maximum tokens held.
+long long   m_byte_rate;
+long long   m_ops_rate;
+long long   m_byte_cap;
+long long   m_ops_cap;
+long long   m_burst_us;
+// Time of the last refill in microseconds.
+long long   m_last;
+// Number of requests seen since the last recompute.
+int         m_active;
+// Number of open files referring to this bucket (users only).
+int         m_refs;
+
+XrdThrottleBucket *m_parent;
+
+// The queue of blocked requests.
+XrdSysMutex m_mutex;
+Waiter     *m_head;
+Waiter     *m_tail;
+int         m_waiting;
+
+// Histogram of throttle delays (classes only); bin 0 holds the requests
+// that were not delayed and bin i those delayed less than 2^(i-1) ms.
+static const
+int         m_bins = 16;
+int         m_hist[m_bins];
+};
+
+class XrdThrottleFairShare
+{
+
+public:
+
+// Obtain the bucket for the user in the given class, creating it as
+// needed; each call must be matched by a call to Release().
+XrdThrottleBucket *
+            Get(const char *user, const char *vo);
+
+void        Release(XrdThrottleBucket *bucket);
+
+// Wait until the request may pass.  Returns the delay in microseconds.
+long long   Apply(XrdThrottleBucket *bucket, int reqsize, int reqops);
+
+// Number of requests currently waiting for tokens.
+int         Queued();
+
+// Redistribute the rates over the active classes and users, drop unused
+// user buckets and report the delay histograms.
+void        Recompute();
+
+            XrdThrottleFairShare(XrdOucTrace *tP, float bytes_per_second,
+                                 float ops_per_second, int burst_ms);
+
+           ~XrdThrottleFairShare() {} // Never deleted
+
+private:
+
+struct Class
+{
+   Class(long long now) : m_bucket(0, now) {}
+
+   XrdThrottleBucket m_bucket;
+   std::map<std::string, XrdThrottleBucket*> m_users;
+};
+
+static
+long long   Now();
+
+XrdOucTrace * m_trace;
+
+long long   m_byte_rate;
+long long   m_ops_rate;
+long long   m_burst_us;
+
+int         m_queued;
+
+XrdSysMutex m_mutex; // Protects the maps, not the buckets
+std::map<std::string, Class*> m_classes;
+
+static const char *TraceID;
+
+};
+
+#endif
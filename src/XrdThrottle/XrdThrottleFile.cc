@@ -18,7 +18,7 @@ using namespace XrdThrottle;
 
 #define DO_THROTTLE(amount) \
 DO_LOADSHED \
-m_throttle.Apply(amount, 1, m_uid); \
+m_throttle.Apply(amount, 1, m_uid, m_bucket); \
 XrdThrottleTimer xtimer = m_throttle.StartIOTimer();
 
 class ErrorSentry
@@ -66,13 +66,16 @@ File::File(const char                     *user,
      m_sfs(sfs),
 #endif
      m_uid(0),
+     m_bucket(0),
      m_user(user),
      m_throttle(throttle),
      m_eroute(eroute)
 {}
 
 File::~File()
-{}
+{
+   m_throttle.ReleaseBucket(m_bucket);
+}
 
 int
 File::open(const char                *fileName,
@@ -82,6 +85,7 @@ File::open(const char                *fileName,
            const char                *opaque)
 {
    m_uid = XrdThrottleManager::GetUid(client->name);
+   if (!m_bucket) m_bucket = m_throttle.GetBucket(client->name, client->vorg);
    m_throttle.PrepLoadShed(opaque, m_loadshed);
    ErrorSentry sentry(error, m_sfs->error, true);
    return m_sfs->open(fileName, openMode, createMode, client, opaque);
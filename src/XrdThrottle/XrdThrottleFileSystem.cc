@@ -90,7 +90,10 @@ int
 FileSystem::getStats(char *buff,
                      int   blen)
 {
-   return m_sfs_ptr->getStats(buff, blen);
+   if (!buff) return m_throttle.Stats(0, 0) + m_sfs_ptr->getStats(0, 0);
+
+   int n = m_throttle.Stats(buff, blen);
+   return n + m_sfs_ptr->getStats(buff + n, blen - n);
 }
 
 const char *
@@ -1,6 +1,7 @@
 
 #include <fcntl.h>
 
+#include "XrdNet/XrdNetUtils.hh"
 #include "XrdSys/XrdSysPlugin.hh"
 #include "XrdOuc/XrdOuca2x.hh"
 #include "XrdOuc/XrdOucEnv.hh"
@@ -79,7 +80,8 @@ XrdVERSIONINFO(XrdSfsGetFileSystem, FileSystem);
 FileSystem* FileSystem::m_instance = 0;
 
 FileSystem::FileSystem()
-   : m_eroute(0), m_trace(&m_eroute), m_sfs_ptr(0), m_initialized(false), m_throttle(&m_eroute, &m_trace)
+   : m_eroute(0), m_trace(&m_eroute), m_sfs_ptr(0), m_initialized(false),
+     m_loadshed_manager(false), m_throttle(&m_eroute, &m_trace)
 {
    myVersion = &XrdVERSIONINFOVAR(XrdSfsGetFileSystem);
 }
@@ -148,12 +150,28 @@ FileSystem::Configure(XrdSysError & log, XrdSfsFileSystem *native_fs)
       TS_Xeq("throttle.throttle", xthrottle);
       TS_Xeq("throttle.loadshed", xloadshed);
       TS_Xeq("throttle.trace", xtrace);
+      TS_Xeq("throttle.fairshare", xfairshare);
+      if (!strcmp("all.manager", var) || !strcmp("cms.manager", var))
+      {
+         xmanager(Config);
+      }
       if (NoGo)
       {
          log.Emsg("Config", "Throttle configuration failed.");
       }
    }
 
+   // Shedding to the manager needs to know who the manager is.
+   if (m_loadshed_manager)
+   {
+      if (m_manager_host.empty())
+      {
+         log.Emsg("Config", "loadshed manager specified but no manager is configured.");
+         return 1;
+      }
+      m_throttle.SetLoadShedHost(m_manager_host);
+   }
+
    // Load the filesystem object.
    m_sfs_ptr = native_fs ? native_fs : LoadFS(fslib, m_eroute, m_config_file);
    if (!m_sfs_ptr) return 1;
@@ -171,18 +189,23 @@ FileSystem::Configure(XrdSysError & log, XrdSfsFileSystem *native_fs)
 /* Function: xthrottle
 
    Purpose:  To parse the directive: throttle [data <drate>] [iops <irate>] [concurrency <climit>] [interval <rint>]
+                                              [latency <lat>] [minconcurrency <cmin>]
 
              <drate>    maximum bytes per second through the server.
              <irate>    maximum IOPS per second through the server.
              <climit>   maximum number of concurrent IO connections.
              <rint>     minimum interval in milliseconds between throttle re-computing.
+             <lat>      target IO latency in milliseconds; when specified, the
+                        concurrency limit is adjusted at each interval to hold
+                        it, up to <climit> (default 1024).
+             <cmin>     the lowest adaptive concurrency limit (default 1).
 
    Output: 0 upon success or !0 upon failure.
 */
 int
 FileSystem::xthrottle(XrdOucStream &Config)
 {
-    long long drate = -1, irate = -1, rint = 1000, climit = -1;
+    long long drate = -1, irate = -1, rint = 1000, climit = -1, lat = 0, cmin = 1;
     char *val;
 
     while ((val = Config.GetWord()))
@@ -211,6 +234,18 @@ FileSystem::xthrottle(XrdOucStream &Config)
              {m_eroute.Emsg("Config", "Concurrency limit not specified."); return 1;}
           if (XrdOuca2x::a2sz(m_eroute,"Concurrency limit value",val,&climit,1)) return 1;
        }
+       else if (strcmp("latency", val) == 0)
+       {
+          if (!(val = Config.GetWord()))
+             {m_eroute.Emsg("Config", "latency target not specified."); return 1;}
+          if (XrdOuca2x::a2ll(m_eroute,"latency target value",val,&lat,1,60000)) return 1;
+       }
+       else if (strcmp("minconcurrency", val) == 0)
+       {
+          if (!(val = Config.GetWord()))
+             {m_eroute.Emsg("Config", "minimum concurrency not specified."); return 1;}
+          if (XrdOuca2x::a2ll(m_eroute,"minimum concurrency value",val,&cmin,1,1000000)) return 1;
+       }
        else
        {
           m_eroute.Emsg("Config", "Warning - unknown throttle option specified", val, ".");
@@ -218,6 +253,7 @@ FileSystem::xthrottle(XrdOucStream &Config)
     }
 
     m_throttle.SetThrottles(drate, irate, climit, static_cast<float>(rint)/1000.0);
+    m_throttle.SetAdaptive(static_cast<int>(lat*1000), static_cast<int>(cmin));
     return 0;
 }
 
@@ -227,20 +263,30 @@ FileSystem::xthrottle(XrdOucStream &Config)
 
 /* Function: xloadshed
 
-   Purpose:  To parse the directive: loadshed host <hostname> [port <port>] [frequency <freq>]
+   Purpose:  To parse the directive: loadshed {host <hostname> | manager} [port <port>] [frequency <freq>]
+                                              [queue <qdepth>] [wait <qwait>]
 
-             <hostname> hostname of server to shed load to.  Required
+             <hostname> hostname of server to shed load to.
+             manager    shed load to the cluster manager (see all.manager),
+                        asking it to select a server other than this one; the
+                        cmsd then picks the least loaded eligible server.
              <port>     port of server to shed load to.  Defaults to 1094
              <freq>     A value from 1 to 100 specifying how often to shed load
                         (1 = 1% chance; 100 = 100% chance; defaults to 10).
+             <qdepth>   only shed load while at least this many requests wait
+                        in the throttle.
+             <qwait>    only shed load while the average delay, in milliseconds,
+                        of the requests that had to wait exceeds this value.
+                        Without <qdepth> or <qwait>, load is shed whenever a
+                        throttle limit was hit during the current interval.
 
    Output: 0 upon success or !0 upon failure.
 */
 int FileSystem::xloadshed(XrdOucStream &Config)
 {
-    long long port = 0, freq = 0;
+    long long port = 1094, freq = 10, qdepth = 0, qwait = 0;
     char *val;
-    std::string hostname;
+    std::string hostname, avoid;
 
     while ((val = Config.GetWord()))
     {
@@ -250,6 +296,22 @@ int FileSystem::xloadshed(XrdOucStream &Config)
              {m_eroute.Emsg("Config", "loadshed hostname not specified."); return 1;}
           hostname = val;
        }
+       else if (strcmp("manager", val) == 0)
+       {
+          m_loadshed_manager = true;
+       }
+       else if (strcmp("queue", val) == 0)
+       {
+          if (!(val = Config.GetWord()))
+             {m_eroute.Emsg("Config", "loadshed queue depth not specified."); return 1;}
+          if (XrdOuca2x::a2ll(m_eroute,"loadshed queue depth",val,&qdepth,1,1000000)) return 1;
+       }
+       else if (strcmp("wait", val) == 0)
+       {
+          if (!(val = Config.GetWord()))
+             {m_eroute.Emsg("Config", "loadshed wait not specified."); return 1;}
+          if (XrdOuca2x::a2ll(m_eroute,"loadshed wait",val,&qwait,1,600000)) return 1;
+       }
        else if (strcmp("port", val) == 0)
        {
           if (!(val = Config.GetWord()))
@@ -268,13 +330,115 @@ int FileSystem::xloadshed(XrdOucStream &Config)
        }
     }
 
-    if (hostname.empty())
+    if (hostname.empty() == !m_loadshed_manager)
     {
-        m_eroute.Emsg("Config", "must specify hostname for loadshed parameter.");
+        m_eroute.Emsg("Config", "must specify either hostname or manager for loadshed parameter.");
         return 1;
     }
 
+    if (m_loadshed_manager)
+    {
+        char *myName = XrdNetUtils::MyHostName(0);
+        if (!myName)
+        {
+            m_eroute.Emsg("Config", "unable to determine host name for loadshed manager.");
+            return 1;
+        }
+        avoid = myName;
+        free(myName);
+    }
+
     m_throttle.SetLoadShed(hostname, port, freq);
+    m_throttle.SetLoadShedPolicy(static_cast<int>(qdepth), static_cast<int>(qwait*1000), avoid);
+    return 0;
+}
+
+/******************************************************************************/
+/*                             x m a n a g e r                                */
+/******************************************************************************/
+
+/* Function: xmanager
+
+   Purpose:  To note the first host of the directive:
+
+             manager [meta | peer | proxy] [all | any] <host>[+][:<port>|<port>] [if ...]
+
+             The host is only used to shed load to the manager; the port is
+             the cmsd port and is ignored.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+int FileSystem::xmanager(XrdOucStream &Config)
+{
+    char *val;
+
+    if (!m_manager_host.empty()) return 0;
+
+    while ((val = Config.GetWord()))
+    {
+       if (!strcmp("meta", val) || !strcmp("peer", val) || !strcmp("proxy", val)
+       ||  !strcmp("all",  val) || !strcmp("any",  val)) continue;
+       std::string host = val;
+       size_t pos = host.find_first_of("+:");
+       if (pos != std::string::npos) host.erase(pos);
+       m_manager_host = host;
+       break;
+    }
+    return 0;
+}
+
+/******************************************************************************/
+/*                           x f a i r s h a r e                              */
+/******************************************************************************/
+
+/* Function: xfairshare
+
+   Purpose:  To parse the directive: fairshare {shares | buckets [burst <time>]}
+
+             shares     users are hashed into a fixed number of shares that
+                        are refilled at each recompute interval (the default).
+             buckets    each user gets a token bucket within the bucket of its
+                        VO; the buckets are refilled continuously.
+             <time>     the time, in milliseconds, a bucket may accumulate
+                        unused tokens for (default 1000).
+
+   Output: 0 upon success or !0 upon failure.
+*/
+int
+FileSystem::xfairshare(XrdOucStream &Config)
+{
+    long long burst = 1000;
+    bool buckets;
+    char *val;
+
+    if (!(val = Config.GetWord()))
+       {m_eroute.Emsg("Config", "fairshare mode not specified."); return 1;}
+    if (strcmp("shares", val) == 0) buckets = false;
+    else if (strcmp("buckets", val) == 0) buckets = true;
+    else {m_eroute.Emsg("Config", "invalid fairshare mode", val); return 1;}
+
+    while ((val = Config.GetWord()))
+    {
+       if (buckets && strcmp("burst", val) == 0)
+       {
+          if (!(val = Config.GetWord()))
+             {m_eroute.Emsg("Config", "fairshare burst not specified."); return 1;}
+          if (XrdOuca2x::a2ll(m_eroute,"fairshare burst value",val,&burst,1,3600000)) return 1;
+       }
+       else
+       {
+          m_eroute.Emsg("Config", "Warning - unknown fairshare option specified", val, ".");
+       }
+    }
+
+#ifndef HAVE_ATOMICS
+    if (buckets)
+       {m_eroute.Say("Config warning: fairshare buckets not supported; using shares.");
+        buckets = false;
+       }
+#endif
+
+    m_throttle.SetFairShare(buckets, static_cast<int>(burst));
     return 0;
 }
 
@@ -304,6 +468,7 @@ int FileSystem::xtrace(XrdOucStream &Config)
       {"iops",      TRACE_IOPS},
       {"bandwidth", TRACE_BANDWIDTH},
       {"ioload",    TRACE_IOLOAD},
+      {"fairshare", TRACE_FAIRSHARE},
    };
    int i, neg, trval = 0, numopts = sizeof(tropts)/sizeof(struct traceopts);
 
@@ -1,5 +1,9 @@
 
 #include "XrdThrottleManager.hh"
+#include "XrdThrottleBucket.hh"
+
+#include <stdio.h>
+#include <string.h>
 
 #include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysTimer.hh"
@@ -29,17 +33,42 @@ XrdThrottleManager::XrdThrottleManager(XrdSysError *lP, XrdOucTrace *tP) :
    m_bytes_per_second(-1),
    m_ops_per_second(-1),
    m_concurrency_limit(-1),
+   m_latency_target_us(0),
+   m_concurrency_min(1),
+   m_concurrency_max(-1),
+   m_concurrency_hit(0),
+   m_latency_sum_us(0),
+   m_latency_count(0),
+   m_stable_latency_us(0),
    m_last_round_allocation(100*1024),
+   m_use_buckets(false),
+   m_burst_ms(1000),
+   m_fairshare(0),
    m_io_counter(0),
+   m_stable_io_counter(0),
    m_loadshed_host(""),
    m_loadshed_port(0),
    m_loadshed_frequency(0),
-   m_loadshed_limit_hit(0)
+   m_loadshed_limit_hit(0),
+   m_loadshed_queue(0),
+   m_loadshed_wait_us(0),
+   m_queued(0),
+   m_delay_sum_us(0),
+   m_delay_count(0),
+   m_stable_delay_us(0)
 {
    m_stable_io_wait.tv_sec = 0;
    m_stable_io_wait.tv_nsec = 0;
 }
 
+static inline long long
+MonotonicUs()
+{
+   struct timespec now = {0, 0};
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return static_cast<long long>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
 void
 XrdThrottleManager::Init()
 {
@@ -61,6 +90,22 @@ XrdThrottleManager::Init()
    m_io_wait.tv_sec = 0;
    m_io_wait.tv_nsec = 0;
 
+   // An adaptive limit starts at the configured concurrency, if any.
+   if (m_latency_target_us > 0)
+   {
+      m_concurrency_max = (m_concurrency_limit > 0) ? m_concurrency_limit : 1024;
+      if (m_concurrency_min > m_concurrency_max) m_concurrency_min = m_concurrency_max;
+      m_concurrency_limit = m_concurrency_max;
+      TRACE(DEBUG, "Adaptive concurrency between " << m_concurrency_min << " and " << m_concurrency_max
+                   << " for a target latency of " << m_latency_target_us << "us.");
+   }
+
+   if (m_use_buckets && IsThrottling())
+   {
+      TRACE(DEBUG, "Using token buckets for the throttle fairshare.");
+      m_fairshare = new XrdThrottleFairShare(m_trace, m_bytes_per_second, m_ops_per_second, m_burst_ms);
+   }
+
    int rc;
    pthread_t tid;
    if ((rc = XrdSysThread::Run(&tid, XrdThrottleManager::RecomputeBootstrap, static_cast<void *>(this), 0, "Buffer Manager throttle")))
@@ -109,12 +154,26 @@ XrdThrottleManager::StealShares(int uid, int &reqsize, int &reqops)
  * this applies the limits as best possible, stalling the thread if necessary.
  */
 void
-XrdThrottleManager::Apply(int reqsize, int reqops, int uid)
+XrdThrottleManager::Apply(int reqsize, int reqops, int uid, XrdThrottleBucket *bucket)
 {
    if (m_bytes_per_second < 0)
       reqsize = 0;
    if (m_ops_per_second < 0)
       reqops = 0;
+   if (bucket)
+   {
+      long long delay_us;
+      if ((reqsize || reqops) && (delay_us = m_fairshare->Apply(bucket, reqsize, reqops)))
+      {
+         AtomicBeg(m_compute_var);
+         AtomicInc(m_loadshed_limit_hit);
+         AtomicAdd(m_delay_sum_us, delay_us);
+         AtomicInc(m_delay_count);
+         AtomicEnd(m_compute_var);
+      }
+      return;
+   }
+   long long start_us = 0;
    while (reqsize || reqops)
    {
       // Subtract the requested out of the shares
@@ -142,15 +201,37 @@ XrdThrottleManager::Apply(int reqsize, int reqops, int uid)
       {
          if (reqsize) TRACE(BANDWIDTH, "Sleeping to wait for throttle fairshare.");
          if (reqops) TRACE(IOPS, "Sleeping to wait for throttle fairshare.");
+         if (!start_us)
+         {
+            start_us = MonotonicUs();
+            AtomicBeg(m_compute_var);
+            AtomicInc(m_queued);
+            AtomicEnd(m_compute_var);
+         }
          m_compute_var.Wait();
          AtomicBeg(m_compute_var);
          AtomicInc(m_loadshed_limit_hit);
          AtomicEnd(m_compute_var);
       }
    }
+   if (start_us) RecordDelay(start_us);
 
 }
 
+/*
+ * Account for a request that had to wait in the throttle.
+ */
+void
+XrdThrottleManager::RecordDelay(long long start_us)
+{
+   long long delay_us = MonotonicUs() - start_us;
+   AtomicBeg(m_compute_var);
+   AtomicDec(m_queued);
+   AtomicAdd(m_delay_sum_us, delay_us);
+   AtomicInc(m_delay_count);
+   AtomicEnd(m_compute_var);
+}
+
 void *
 XrdThrottleManager::RecomputeBootstrap(void *instance)
 {
@@ -191,54 +272,74 @@ XrdThrottleManager::Recompute()
 void
 XrdThrottleManager::RecomputeInternal()
 {
-   // Compute total shares for this interval; 
    float intervals_per_second = 1.0/m_interval_length_seconds;
-   float total_bytes_shares = m_bytes_per_second / intervals_per_second;
-   float total_ops_shares   = m_ops_per_second / intervals_per_second;
 
-   // Compute the number of active users; a user is active if they used
-   // any primary share during the last interval;
-   AtomicBeg(m_compute_var);
-   float active_users = 0;
-   long bytes_used = 0;
-   for (int i=0; i<m_max_users; i++)
+   // The token buckets refill by themselves; only their rates change.
+   if (m_fairshare)
+   {
+      m_fairshare->Recompute();
+      int limit_hit = AtomicFAZ(m_loadshed_limit_hit);
+      TRACE(DEBUG, "Throttle limit hit " << limit_hit << " times during last interval.");
+   }
+   else
    {
-      int primary = AtomicFAZ(m_primary_bytes_shares[i]);
-      if (primary != m_last_round_allocation)
+      // Compute total shares for this interval; 
+      float total_bytes_shares = m_bytes_per_second / intervals_per_second;
+      float total_ops_shares   = m_ops_per_second / intervals_per_second;
+
+      // Compute the number of active users; a user is active if they used
+      // any primary share during the last interval;
+      AtomicBeg(m_compute_var);
+      float active_users = 0;
+      long bytes_used = 0;
+      for (int i=0; i<m_max_users; i++)
+      {
+         int primary = AtomicFAZ(m_primary_bytes_shares[i]);
+         if (primary != m_last_round_allocation)
+         {
+            active_users++;
+            if (primary >= 0)
+               m_secondary_bytes_shares[i] = primary;
+            primary = AtomicFAZ(m_primary_ops_shares[i]);
+            if (primary >= 0)
+                m_secondary_ops_shares[i] = primary;
+            bytes_used += (primary < 0) ? m_last_round_allocation : (m_last_round_allocation-primary);
+         }
+      }
+
+      if (active_users == 0)
       {
          active_users++;
-         if (primary >= 0)
-            m_secondary_bytes_shares[i] = primary;
-         primary = AtomicFAZ(m_primary_ops_shares[i]);
-         if (primary >= 0)
-             m_secondary_ops_shares[i] = primary;
-         bytes_used += (primary < 0) ? m_last_round_allocation : (m_last_round_allocation-primary);
       }
-   }
 
-   if (active_users == 0)
-   {
-      active_users++;
-   }
+      // Note we allocate the same number of shares to *all* users, not
+      // just the active ones.  If a new user becomes active in the next
+      // interval, we'll go over our bandwidth budget just a bit.
+      m_last_round_allocation = static_cast<int>(total_bytes_shares / active_users);
+      int ops_shares = static_cast<int>(total_ops_shares / active_users);
+      TRACE(BANDWIDTH, "Round byte allocation " << m_last_round_allocation << " ; last round used " << bytes_used << ".");
+      TRACE(IOPS, "Round ops allocation " << ops_shares);
+      for (int i=0; i<m_max_users; i++)
+      {
+         m_primary_bytes_shares[i] = m_last_round_allocation;
+         m_primary_ops_shares[i] = ops_shares;
+      }
 
-   // Note we allocate the same number of shares to *all* users, not
-   // just the active ones.  If a new user becomes active in the next
-   // interval, we'll go over our bandwidth budget just a bit.
-   m_last_round_allocation = static_cast<int>(total_bytes_shares / active_users);
-   int ops_shares = static_cast<int>(total_ops_shares / active_users);
-   TRACE(BANDWIDTH, "Round byte allocation " << m_last_round_allocation << " ; last round used " << bytes_used << ".");
-   TRACE(IOPS, "Round ops allocation " << ops_shares);
-   for (int i=0; i<m_max_users; i++)
-   {
-      m_primary_bytes_shares[i] = m_last_round_allocation;
-      m_primary_ops_shares[i] = ops_shares;
+      // Reset the loadshed limit counter.
+      int limit_hit = AtomicFAZ(m_loadshed_limit_hit);
+      TRACE(DEBUG, "Throttle limit hit " << limit_hit << " times during last interval.");
+
+      AtomicEnd(m_compute_var);
    }
 
-   // Reset the loadshed limit counter.
-   int limit_hit = AtomicFAZ(m_loadshed_limit_hit);
-   TRACE(DEBUG, "Throttle limit hit " << limit_hit << " times during last interval.");
+   if (m_latency_target_us > 0) AdaptConcurrency();
 
-   AtomicEnd(m_compute_var);
+   // Compute the expected wait of a request that has to wait.
+   long long delay_sum;
+   int delay_count;
+   AtomicFZAP(delay_sum, m_delay_sum_us);
+   AtomicFZAP(delay_count, m_delay_count);
+   m_stable_delay_us = delay_count ? delay_sum / delay_count : 0;
 
    // Update the IO counters
    m_compute_var.Lock();
@@ -257,6 +358,50 @@ XrdThrottleManager::RecomputeInternal()
    m_compute_var.Broadcast();
 }
 
+/*
+ * Move the concurrency limit towards the value that should hold the latency
+ * target, gradient style: the limit is scaled by the ratio of the target to
+ * the average latency seen during the last interval.  A decrease is at most
+ * by half per interval; an increase is at most by a quarter, at least by one,
+ * and only done if the latency is at least 10% below the target and the
+ * limit actually held back some requests.
+ */
+void
+XrdThrottleManager::AdaptConcurrency()
+{
+   long long sum;
+   int count, hits;
+   AtomicFZAP(sum, m_latency_sum_us);
+   AtomicFZAP(count, m_latency_count);
+   AtomicFZAP(hits, m_concurrency_hit);
+   if (!count) return;
+
+   long long avg = sum / count;
+   if (!avg) avg = 1;
+   m_stable_latency_us = avg;
+
+   int limit = m_concurrency_limit, next = limit;
+   if (avg > m_latency_target_us)
+   {
+      next = static_cast<int>(static_cast<long long>(limit) * m_latency_target_us / avg);
+      if (next < limit/2) next = limit/2;
+   }
+   else if (hits && avg < m_latency_target_us - m_latency_target_us/10)
+   {
+      next = static_cast<int>(static_cast<long long>(limit) * m_latency_target_us / avg);
+      if (next > limit + limit/4) next = limit + limit/4;
+      if (next <= limit) next = limit + 1;
+   }
+   if (next < m_concurrency_min) next = m_concurrency_min;
+   if (next > m_concurrency_max) next = m_concurrency_max;
+
+   if (next != limit)
+   {
+      m_concurrency_limit = next;
+      TRACE(IOLOAD, "Average IO latency " << avg << "us over " << count << " IOs; concurrency limit changed from " << limit << " to " << next << ".");
+   }
+}
+
 /*
  * Do a simple hash across the username.
  */
@@ -275,6 +420,21 @@ XrdThrottleManager::GetUid(const char *username)
    return hval;
 }
 
+/*
+ * Get the token bucket for a user; files release it when they go away.
+ */
+XrdThrottleBucket *
+XrdThrottleManager::GetBucket(const char *username, const char *vo)
+{
+   return m_fairshare ? m_fairshare->Get(username, vo) : 0;
+}
+
+void
+XrdThrottleManager::ReleaseBucket(XrdThrottleBucket *bucket)
+{
+   if (bucket) m_fairshare->Release(bucket);
+}
+
 /*
  * Create an IO timer object; increment the number of outstanding IOs.
  */
@@ -284,10 +444,19 @@ XrdThrottleManager::StartIOTimer()
    AtomicBeg(m_compute_var);
    int cur_counter = AtomicInc(m_io_counter);
    AtomicEnd(m_compute_var);
+   long long start_us = 0;
    while (m_concurrency_limit >= 0 && cur_counter > m_concurrency_limit)
    {
+      if (!start_us)
+      {
+         start_us = MonotonicUs();
+         AtomicBeg(m_compute_var);
+         AtomicInc(m_queued);
+         AtomicEnd(m_compute_var);
+      }
       AtomicBeg(m_compute_var);
       AtomicInc(m_loadshed_limit_hit);
+      AtomicInc(m_concurrency_hit);
       AtomicDec(m_io_counter);
       AtomicEnd(m_compute_var);
       m_compute_var.Wait();
@@ -295,6 +464,7 @@ XrdThrottleManager::StartIOTimer()
       cur_counter = AtomicInc(m_io_counter);
       AtomicEnd(m_compute_var);
    }
+   if (start_us) RecordDelay(start_us);
    return XrdThrottleTimer(*this);
 }
 
@@ -302,10 +472,15 @@ XrdThrottleManager::StartIOTimer()
  * Finish recording an IO timer.
  */
 void
-XrdThrottleManager::StopIOTimer(struct timespec timer)
+XrdThrottleManager::StopIOTimer(struct timespec timer, long long wall_us)
 {
    AtomicBeg(m_compute_var);
    AtomicDec(m_io_counter);
+   if (m_latency_target_us > 0)
+   {
+      AtomicAdd(m_latency_sum_us, wall_us);
+      AtomicInc(m_latency_count);
+   }
    AtomicAdd(m_io_wait.tv_sec, timer.tv_sec);
    // Note this may result in tv_nsec > 1e9
    AtomicAdd(m_io_wait.tv_nsec, timer.tv_nsec);
@@ -314,7 +489,9 @@ XrdThrottleManager::StopIOTimer(struct timespec timer)
 
 /*
  * Check the counters to see if we have hit any throttle limits in the
- * current time period.  If so, shed the client randomly.
+ * current time period.  If so, shed the client randomly.  When a queue
+ * or wait threshold is set, only shed while the throttle queue is at
+ * least that deep or waiting requests are delayed at least that long.
  *
  * If the client has already been load-shedded once and reconnected to this
  * server, then do not load-shed it again.
@@ -326,7 +503,16 @@ XrdThrottleManager::CheckLoadShed(const std::string &opaque)
    {
       return false;
    }
-   if (AtomicGet(m_loadshed_limit_hit) == 0)
+   if (m_loadshed_queue || m_loadshed_wait_us)
+   {
+      int queued = AtomicGet(m_queued) + (m_fairshare ? m_fairshare->Queued() : 0);
+      if (!(m_loadshed_queue && queued >= m_loadshed_queue)
+      &&  !(m_loadshed_wait_us && m_stable_delay_us >= m_loadshed_wait_us))
+      {
+         return false;
+      }
+   }
+   else if (AtomicGet(m_loadshed_limit_hit) == 0)
    {
       return false;
    }
@@ -356,13 +542,38 @@ XrdThrottleManager::PrepLoadShed(const char * opaque, std::string &lsOpaque)
       {
          return;
       }
-      lsOpaque = opaque;
-      lsOpaque += "&throttle.shed=1";
+      if (m_loadshed_avoid.empty())
+      {
+         lsOpaque = opaque;
+         lsOpaque += "&throttle.shed=1";
+         return;
+      }
+      // Merge ourselves into the list of hosts the client already tried.
+      const char *tried = env.Get("tried");
+      std::string avoid = tried ? std::string(tried) + "," + m_loadshed_avoid : m_loadshed_avoid;
+      const char *cur = opaque;
+      while (*cur)
+      {
+         const char *end = strchr(cur, '&');
+         size_t len = end ? static_cast<size_t>(end - cur) : strlen(cur);
+         if (len && strncmp(cur, "tried=", 6) && strncmp(cur, "triedrc=", 8))
+         {
+            lsOpaque.append(cur, len);
+            lsOpaque += "&";
+         }
+         cur += len;
+         if (*cur) cur++;
+      }
+      lsOpaque += "throttle.shed=1&tried=" + avoid + "&triedrc=resel";
    }
-   else
+   else if (m_loadshed_avoid.empty())
    {
       lsOpaque = "throttle.shed=1";
    }
+   else
+   {
+      lsOpaque = "throttle.shed=1&tried=" + m_loadshed_avoid + "&triedrc=resel";
+   }
 }
 
 void
@@ -373,3 +584,21 @@ XrdThrottleManager::PerformLoadShed(const std::string &opaque, std::string &host
    host += opaque;
    port = m_loadshed_port;
 }
+
+/*
+ * Report the current IO load and concurrency limit; a limit of -1 means
+ * there is none and a target of zero that the limit is static.
+ */
+int
+XrdThrottleManager::Stats(char *buff, int blen)
+{
+   static const char statfmt[] = "<stats id=\"throttle\"><io>%d</io><lim>%d</lim>"
+                                 "<lat>%lld</lat><tgt>%d</tgt></stats>";
+   static const int statsz = sizeof(statfmt) + (3*11) + 20;
+
+   if (!buff) return statsz;
+   if (blen < statsz) return 0;
+
+   return snprintf(buff, blen, statfmt, AtomicGet(m_io_counter), m_concurrency_limit,
+                   m_stable_latency_us, m_latency_target_us);
+}
@@ -15,6 +15,14 @@
  * Note that we do not actually keep close track of users, but rather
  * put them into a hash.  This way, we can pretend there's a constant
  * number of users and use a lock-free algorithm.
+ *
+ * The concurrency limit may be adaptive: at each interval it is raised or
+ * lowered in proportion to how far the average I/O latency is from a
+ * target, between a floor and the configured limit.
+ *
+ * Alternatively, the fairshare can be done with per-user token buckets
+ * grouped by VO (see XrdThrottleBucket.hh); a file then passes its bucket
+ * to Apply() instead of relying on the hashed uid.
  */
 
 #ifndef __XrdThrottleManager_hh_
@@ -36,6 +44,8 @@
 
 class XrdSysError;
 class XrdOucTrace;
+class XrdThrottleBucket;
+class XrdThrottleFairShare;
 class XrdThrottleTimer;
 
 class XrdThrottleManager
@@ -47,7 +57,7 @@ public:
 
 void        Init();
 
-void        Apply(int reqsize, int reqops, int uid);
+void        Apply(int reqsize, int reqops, int uid, XrdThrottleBucket *bucket=0);
 
 bool        IsThrottling() {return (m_ops_per_second > 0) || (m_bytes_per_second > 0);}
 
@@ -55,14 +65,34 @@ void        SetThrottles(float reqbyterate, float reqoprate, int concurrency, fl
             {m_interval_length_seconds = interval_length; m_bytes_per_second = reqbyterate;
              m_ops_per_second = reqoprate; m_concurrency_limit = concurrency;}
 
+void        SetAdaptive(int target_us, int min_concurrency)
+            {m_latency_target_us = target_us; m_concurrency_min = min_concurrency;}
+
+void        SetFairShare(bool buckets, int burst_ms)
+            {m_use_buckets = buckets; m_burst_ms = burst_ms;}
+
 void        SetLoadShed(std::string &hostname, unsigned port, unsigned frequency)
             {m_loadshed_host = hostname; m_loadshed_port = port; m_loadshed_frequency = frequency;}
 
-//int         Stats(char *buff, int blen, int do_sync=0) {return m_pool.Stats(buff, blen, do_sync);}
+void        SetLoadShedHost(const std::string &hostname) {m_loadshed_host = hostname;}
+
+// Shed only when at least queue requests wait in the throttle or waiting
+// requests were delayed by wait_us on average; when avoid is not empty,
+// redirected clients ask the cmsd to select a server other than avoid.
+void        SetLoadShedPolicy(int queue, int wait_us, const std::string &avoid)
+            {m_loadshed_queue = queue; m_loadshed_wait_us = wait_us; m_loadshed_avoid = avoid;}
+
+int         Stats(char *buff, int blen);
 
 static
 int         GetUid(const char *username);
 
+// Return the token bucket of a user; nil unless bucket fairshare is used.
+XrdThrottleBucket *
+            GetBucket(const char *username, const char *vo);
+
+void        ReleaseBucket(XrdThrottleBucket *bucket);
+
 XrdThrottleTimer StartIOTimer();
 
 void        PrepLoadShed(const char *opaque, std::string &lsOpaque);
@@ -77,7 +107,7 @@ void        PerformLoadShed(const std::string &opaque, std::string &host, unsign
 
 protected:
 
-void        StopIOTimer(struct timespec);
+void        StopIOTimer(struct timespec, long long wall_us);
 
 private:
 
@@ -85,6 +115,10 @@ void        Recompute();
 
 void        RecomputeInternal();
 
+void        AdaptConcurrency();
+
+void        RecordDelay(long long start_us);
+
 static
 void *      RecomputeBootstrap(void *pp);
 
@@ -105,6 +139,16 @@ float       m_bytes_per_second;
 float       m_ops_per_second;
 int         m_concurrency_limit;
 
+// Adaptive concurrency; the limit moves between the floor and the maximum
+// to hold the latency target (zero when the limit is static).
+int         m_latency_target_us;
+int         m_concurrency_min;
+int         m_concurrency_max;
+int         m_concurrency_hit;
+long long   m_latency_sum_us;
+int         m_latency_count;
+long long   m_stable_latency_us;
+
 // Maintain the shares
 static const
 int         m_max_users;
@@ -114,6 +158,11 @@ std::vector<int> m_primary_ops_shares;
 std::vector<int> m_secondary_ops_shares;
 int         m_last_round_allocation;
 
+// Token bucket fairshare; nil when the hashed shares are used.
+bool        m_use_buckets;
+int         m_burst_ms;
+XrdThrottleFairShare *m_fairshare;
+
 // Active IO counter
 int         m_io_counter;
 struct timespec m_io_wait;
@@ -126,6 +175,16 @@ std::string m_loadshed_host;
 unsigned m_loadshed_port;
 unsigned m_loadshed_frequency;
 int m_loadshed_limit_hit;
+int m_loadshed_queue;
+int m_loadshed_wait_us;
+std::string m_loadshed_avoid;
+
+// Requests currently waiting in the throttle and the average delay of the
+// requests that had to wait during the last interval.
+int         m_queued;
+long long   m_delay_sum_us;
+int         m_delay_count;
+long long   m_stable_delay_us;
 
 static const char *TraceID;
 
@@ -145,6 +204,15 @@ void StopTimer()
    int retval = clock_gettime(clock_id, &end_timer);
 #else
    int retval = -1;
+#endif
+   long long wall_us = 0;
+#if defined(__linux__)
+   struct timespec end_wall = {0, 0};
+   if (likely(clock_gettime(CLOCK_MONOTONIC, &end_wall) == 0))
+   {
+      wall_us = static_cast<long long>(end_wall.tv_sec - m_wall.tv_sec) * 1000000
+              + (end_wall.tv_nsec - m_wall.tv_nsec) / 1000;
+   }
 #endif
    if (likely(retval == 0))
    {
@@ -158,7 +226,7 @@ void StopTimer()
    }
    if (m_timer.tv_nsec != -1)
    {
-      m_manager.StopIOTimer(end_timer);
+      m_manager.StopIOTimer(end_timer, wall_us);
    }
    m_timer.tv_sec = 0;
    m_timer.tv_nsec = -1;
@@ -179,8 +247,15 @@ XrdThrottleTimer(XrdThrottleManager & manager) :
 {
 #if defined(__linux__)
    int retval = clock_gettime(clock_id, &m_timer);
+   if (unlikely(clock_gettime(CLOCK_MONOTONIC, &m_wall) == -1))
+   {
+      m_wall.tv_sec = 0;
+      m_wall.tv_nsec = 0;
+   }
 #else
    int retval = -1;
+   m_wall.tv_sec = 0;
+   m_wall.tv_nsec = 0;
 #endif
    if (unlikely(retval == -1))
    {
@@ -192,6 +267,7 @@ XrdThrottleTimer(XrdThrottleManager & manager) :
 private:
 XrdThrottleManager &m_manager;
 struct timespec m_timer;
+struct timespec m_wall; // Elapsed time, unlike m_timer which may be CPU time
 
 static int clock_id;
 };
@@ -10,6 +10,7 @@
 #define TRACE_IOPS      0x0002
 #define TRACE_IOLOAD    0x0004
 #define TRACE_DEBUG     0x0008
+#define TRACE_FAIRSHARE 0x0010
 
 #ifndef NODEBUG
 
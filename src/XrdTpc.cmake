@@ -21,6 +21,7 @@ if( BUILD_TPC )
     XrdTpc/XrdTpcConfigure.cc
     XrdTpc/XrdTpcMultistream.cc
     XrdTpc/XrdTpcCurlMulti.cc     XrdTpc/XrdTpcCurlMulti.hh
+    XrdTpc/XrdTpcCurlShare.cc     XrdTpc/XrdTpcCurlShare.hh
     XrdTpc/XrdTpcState.cc         XrdTpc/XrdTpcState.hh
     XrdTpc/XrdTpcStream.cc        XrdTpc/XrdTpcStream.hh
     XrdTpc/XrdTpcTPC.cc           XrdTpc/XrdTpcTPC.hh)
@@ -1,9 +1,12 @@
 
 #include "XrdTpcTPC.hh"
+#include "XrdTpcStream.hh"
+#include "XrdTpcCurlShare.hh"
 
 #include <dlfcn.h>
 #include <fcntl.h>
 
+#include "XrdOuc/XrdOuca2x.hh"
 #include "XrdOuc/XrdOucStream.hh"
 #include "XrdOuc/XrdOucPinPath.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
@@ -100,6 +103,86 @@ bool TPCHandler::ConfigureFSLib(XrdOucStream &Config, std::string &path1, bool &
     return true;
 }
 
+/**
+ * tpc.buffers [size <bsz>] [limit <msz>]
+ *
+ * Sets the size of the buffers used to hold the data of pull requests until
+ * it is written and the maximum memory used for them across all transfers.
+ */
+bool TPCHandler::ConfigureBuffers(XrdOucStream &Config)
+{
+    long long buffer_size = BufferPool::BufferSize();
+    long long max_memory = 1024LL*1024*1024;
+    char *val;
+    if (!(val = Config.GetWord())) {
+        m_log.Emsg("Config", "tpc.buffers parameters not specified");
+        return false;
+    }
+    while (val) {
+        if (!strcmp("size", val)) {
+            if (!(val = Config.GetWord())) {
+                m_log.Emsg("Config", "tpc.buffers size value not specified");
+                return false;
+            }
+            if (XrdOuca2x::a2sz(m_log, "tpc.buffers size", val, &buffer_size,
+                                64*1024, 64*1024*1024)) {return false;}
+        } else if (!strcmp("limit", val)) {
+            if (!(val = Config.GetWord())) {
+                m_log.Emsg("Config", "tpc.buffers limit value not specified");
+                return false;
+            }
+            if (XrdOuca2x::a2sz(m_log, "tpc.buffers limit", val, &max_memory,
+                                1024*1024)) {return false;}
+        } else {
+            m_log.Emsg("Config", "invalid tpc.buffers option", val);
+            return false;
+        }
+        val = Config.GetWord();
+    }
+    BufferPool::Configure(buffer_size, max_memory);
+    return true;
+}
+
+/**
+ * tpc.readahead [depth <num>] [readers <num>]
+ *
+ * Sets how many buffers of the source file push requests keep read ahead
+ * (0 disables read-ahead) and how many threads fill them.
+ */
+bool TPCHandler::ConfigureReadAhead(XrdOucStream &Config)
+{
+    int depth = m_readahead_depth, readers = m_readahead_readers;
+    char *val;
+    if (!(val = Config.GetWord())) {
+        m_log.Emsg("Config", "tpc.readahead parameters not specified");
+        return false;
+    }
+    while (val) {
+        if (!strcmp("depth", val)) {
+            if (!(val = Config.GetWord())) {
+                m_log.Emsg("Config", "tpc.readahead depth value not specified");
+                return false;
+            }
+            if (XrdOuca2x::a2i(m_log, "tpc.readahead depth", val, &depth,
+                               0, 1024)) {return false;}
+        } else if (!strcmp("readers", val)) {
+            if (!(val = Config.GetWord())) {
+                m_log.Emsg("Config", "tpc.readahead readers value not specified");
+                return false;
+            }
+            if (XrdOuca2x::a2i(m_log, "tpc.readahead readers", val, &readers,
+                               1, 64)) {return false;}
+        } else {
+            m_log.Emsg("Config", "invalid tpc.readahead option", val);
+            return false;
+        }
+        val = Config.GetWord();
+    }
+    m_readahead_depth = depth;
+    m_readahead_readers = readers;
+    return true;
+}
+
 bool TPCHandler::Configure(const char *configfn, XrdOucEnv *myEnv)
 {
     XrdOucStream Config(&m_log, getenv("XRDINSTANCE"), myEnv, "=====> ");
@@ -148,6 +231,44 @@ bool TPCHandler::Configure(const char *configfn, XrdOucEnv *myEnv)
                 return false;
             }
             m_cadir = val;
+        } else if (!strcmp("tpc.buffers", val)) {
+            if (!ConfigureBuffers(Config)) {
+                Config.Close();
+                return false;
+            }
+        } else if (!strcmp("tpc.readahead", val)) {
+            if (!ConfigureReadAhead(Config)) {
+                Config.Close();
+                return false;
+            }
+        } else if (!strcmp("tpc.connections", val)) {
+            int max_conns;
+            if (!(val = Config.GetWord())) {
+                Config.Close();
+                m_log.Emsg("Config", "tpc.connections value not specified");
+                return false;
+            }
+            if (XrdOuca2x::a2i(m_log, "tpc.connections", val, &max_conns,
+                               1, 4096)) {
+                Config.Close();
+                return false;
+            }
+            CurlShare::SetMaxConnections(max_conns);
+        } else if (!strcmp("tpc.streams", val)) {
+            if (!(val = Config.GetWord())) {
+                Config.Close();
+                m_log.Emsg("Config", "tpc.streams value not specified");
+                return false;
+            }
+            if (!strcmp("adaptive", val)) {
+                m_adaptive_streams = true;
+            } else if (!strcmp("fixed", val)) {
+                m_adaptive_streams = false;
+            } else {
+                Config.Close();
+                m_log.Emsg("Config", "tpc.streams value is invalid", val);
+                return false;
+            }
         }
     }
     Config.Close();
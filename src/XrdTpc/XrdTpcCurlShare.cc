@@ -0,0 +1,63 @@
+
+#include "XrdTpcCurlShare.hh"
+
+using namespace TPC;
+
+CURLSH *CurlShare::m_share = NULL;
+long CurlShare::m_max_conns = 64;
+XrdSysMutex CurlShare::m_locks[CURL_LOCK_DATA_LAST];
+
+
+bool
+CurlShare::Init()
+{
+    if (m_share) {return true;}
+    if (!(m_share = curl_share_init())) {return false;}
+
+    if (curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, &CurlShare::Lock) ||
+        curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, &CurlShare::Unlock) ||
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS) ||
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION)) {
+        curl_share_cleanup(m_share);
+        m_share = NULL;
+        return false;
+    }
+#if LIBCURL_VERSION_NUM >= 0x073900
+    // Connection sharing appeared in libcurl 7.57; older versions still get
+    // the TLS session and DNS caches.
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+    return true;
+}
+
+
+void
+CurlShare::Attach(CURL *curl)
+{
+    if (!m_share || !curl) {return;}
+    curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+    curl_easy_setopt(curl, CURLOPT_MAXCONNECTS, m_max_conns);
+}
+
+
+void
+CurlShare::AttachMulti(CURLM *multi)
+{
+    if (!m_share || !multi) {return;}
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, m_max_conns);
+}
+
+
+void
+CurlShare::Lock(CURL *curl, curl_lock_data data, curl_lock_access access,
+                void *userptr)
+{
+    m_locks[data].Lock();
+}
+
+
+void
+CurlShare::Unlock(CURL *curl, curl_lock_data data, void *userptr)
+{
+    m_locks[data].UnLock();
+}
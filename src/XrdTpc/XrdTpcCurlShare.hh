@@ -0,0 +1,45 @@
+
+/**
+ * A process-wide libcurl share.
+ *
+ * Every transfer handle is attached to the same share so that connections,
+ * TLS sessions and DNS lookups outlive the transfer that made them; the
+ * next transfer to the same endpoint picks up the warm connection instead of
+ * paying for a new TCP and TLS handshake.  libcurl only reuses a cached
+ * connection for a request with the same host, port and TLS settings
+ * (including any client credentials), so the cache is keyed accordingly.
+ */
+
+#include <curl/curl.h>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+namespace TPC {
+
+class CurlShare {
+public:
+    // Create the share; must be called after curl_global_init.  Returns
+    // false if the share could not be set up, transfers then work as before.
+    static bool Init();
+
+    // Let the easy handle use the shared caches.
+    static void Attach(CURL *curl);
+
+    // Size the connection cache of a multi handle so that idle connections
+    // kept for other transfers are not closed as soon as this one ends.
+    static void AttachMulti(CURLM *multi);
+
+    // Maximum number of idle connections kept around.
+    static void SetMaxConnections(long max_conns) {m_max_conns = max_conns;}
+
+private:
+    static void Lock(CURL *curl, curl_lock_data data, curl_lock_access access,
+                     void *userptr);
+    static void Unlock(CURL *curl, curl_lock_data data, void *userptr);
+
+    static CURLSH *m_share;
+    static long m_max_conns;
+    static XrdSysMutex m_locks[CURL_LOCK_DATA_LAST];
+};
+
+}
@@ -7,6 +7,7 @@
 #include "XrdTpcTPC.hh"
 #include "XrdTpcState.hh"
 #include "XrdTpcCurlMulti.hh"
+#include "XrdTpcCurlShare.hh"
 
 #include "XrdSys/XrdSysError.hh"
 
@@ -32,11 +33,14 @@ class MultiCurlHandler {
 public:
     MultiCurlHandler(std::vector<State*> &states) :
         m_handle(curl_multi_init()),
-        m_states(states)
+        m_states(states),
+        m_limit(states.size()),
+        m_bytes_done(0)
     {
         if (m_handle == NULL) {
             throw CurlHandlerSetupError("Failed to initialize a libcurl multi-handle");
         }
+        CurlShare::AttachMulti(m_handle);
         m_avail_handles.reserve(states.size());
         m_active_handles.reserve(states.size());
         for (std::vector<State*>::const_iterator state_iter = states.begin();
@@ -79,6 +83,7 @@ public:
              state_iter != m_states.end();
              state_iter++) {
             if (curl == (*state_iter)->GetHandle()) {
+                m_bytes_done += (*state_iter)->BytesTransferred();
                 (*state_iter)->ResetAfterRequest();
                 break;
             }
@@ -111,6 +116,37 @@ public:
         return current_offset;
     }
 
+    // Limit the number of transfers that may run at the same time.
+    void SetLimit(size_t limit) {m_limit = limit;}
+
+    // Resume the transfers that paused for lack of buffers, provided that
+    // some buffers have become available.  Returns true if a transfer is
+    // still waiting.
+    bool UnpauseTransfers() {
+        bool paused = false;
+        for (std::vector<State*>::iterator state_iter = m_states.begin();
+             state_iter != m_states.end();
+             state_iter++) {
+            if (!(*state_iter)->IsPaused()) {continue;}
+            if ((*state_iter)->AvailableBuffers() > 0) {
+                (*state_iter)->Unpause();
+            }
+            paused = paused || (*state_iter)->IsPaused();
+        }
+        return paused;
+    }
+
+    // Total number of bytes received, including the running transfers.
+    off_t BytesTransferred() const {
+        off_t bytes = m_bytes_done;
+        for (std::vector<State*>::const_iterator state_iter = m_states.begin();
+             state_iter != m_states.end();
+             state_iter++) {
+            bytes += (*state_iter)->BytesTransferred();
+        }
+        return bytes;
+    }
+
 private:
 
     bool StartTransfer(off_t offset, size_t size) {
@@ -168,7 +204,7 @@ private:
                 }
             }
         }
-        if (!idle_handles) {
+        if (!idle_handles || (m_active_handles.size() >= m_limit)) {
             return false;
         }
         ssize_t available_buffers = m_states[0]->AvailableBuffers();
@@ -182,6 +218,58 @@ private:
     std::vector<CURL *> m_avail_handles;
     std::vector<CURL *> m_active_handles;
     std::vector<State*> &m_states;
+    size_t m_limit;
+    off_t m_bytes_done;
+};
+
+/**
+ * Adjusts the number of concurrent streams based on the throughput measured
+ * over each marker period.  The client-requested stream count is used as the
+ * upper bound; the tuner starts halfway and keeps moving in the same
+ * direction for as long as the throughput does not drop.
+ */
+class StreamTuner {
+public:
+    StreamTuner(size_t max_streams, bool adaptive) :
+        m_max(max_streams),
+        m_limit(adaptive ? (max_streams + 1) / 2 : max_streams),
+        m_step(1),
+        m_adaptive(adaptive && (max_streams > 1)),
+        m_last_bytes(0),
+        m_last_time(0),
+        m_last_rate(0)
+    {}
+
+    size_t Limit() const {return m_limit;}
+
+    void Update(off_t bytes, time_t now) {
+        if (!m_adaptive) {return;}
+        if (!m_last_time) {
+            m_last_time = now;
+            m_last_bytes = bytes;
+            return;
+        }
+        if (now <= m_last_time) {return;}
+        double rate = static_cast<double>(bytes - m_last_bytes) / (now - m_last_time);
+        m_last_bytes = bytes;
+        m_last_time = now;
+
+        // The last change made things worse; go the other way.
+        if (rate < m_last_rate * 0.95) {m_step = -m_step;}
+        m_last_rate = rate;
+
+        if ((m_step > 0) && (m_limit < m_max)) {m_limit++;}
+        else if ((m_step < 0) && (m_limit > 1)) {m_limit--;}
+    }
+
+private:
+    size_t m_max;
+    size_t m_limit;
+    int m_step;
+    bool m_adaptive;
+    off_t m_last_bytes;
+    time_t m_last_time;
+    double m_last_rate;
 };
 }
 
@@ -216,6 +304,8 @@ int TPCHandler::RunCurlWithStreamsImpl(XrdHttpExtReq &req, State &state,
     // Create the multi-handle and add in the current transfer to it.
     MultiCurlHandler mch(handles);
     CURLM *multi_handle = mch.Get();
+    StreamTuner tuner(streams, m_adaptive_streams);
+    mch.SetLimit(tuner.Limit());
 
     // Start response to client prior to the first call to curl_multi_perform
     int retval = req.StartChunkedResp(201, "Created", "Content-Type: text/plain");
@@ -236,12 +326,16 @@ int TPCHandler::RunCurlWithStreamsImpl(XrdHttpExtReq &req, State &state,
         time_t now = time(NULL);
         time_t next_marker = last_marker + m_marker_period;
         if (now >= next_marker) {
-            if (SendPerfMarker(req, current_offset)) {
+            off_t bytes_transferred = mch.BytesTransferred();
+            if (SendPerfMarker(req, bytes_transferred)) {
                 return -1;
             }
             last_marker = now;
+            tuner.Update(bytes_transferred, now);
+            mch.SetLimit(tuner.Limit());
         }
 
+        bool paused = mch.UnpauseTransfers();
         mres = curl_multi_perform(multi_handle, &running_handles);
         if (mres == CURLM_CALL_MULTI_PERFORM) {
             // curl_multi_perform should be called again immediately.  On newer
@@ -270,7 +364,7 @@ int TPCHandler::RunCurlWithStreamsImpl(XrdHttpExtReq &req, State &state,
             break;
         }
 
-        if (running_handles < static_cast<int>(streams)) {
+        if (running_handles < static_cast<int>(tuner.Limit())) {
             // Issue new transfers if there is still pending work to do.
             // Otherwise, continue running until there are no handles left.
             if (current_offset != content_size) {
@@ -285,12 +379,14 @@ int TPCHandler::RunCurlWithStreamsImpl(XrdHttpExtReq &req, State &state,
         if (max_sleep_time <= 0) {
             continue;
         }
+        // Paused transfers are retried as soon as the writers made some room.
+        int max_sleep_ms = paused ? 10 : max_sleep_time*1000;
         int fd_count;
 #ifdef HAVE_CURL_MULTI_WAIT
-        mres = curl_multi_wait(multi_handle, NULL, 0, max_sleep_time*1000,
+        mres = curl_multi_wait(multi_handle, NULL, 0, max_sleep_ms,
                                &fd_count);
 #else
-        mres = curl_multi_wait_impl(multi_handle, max_sleep_time*1000,
+        mres = curl_multi_wait_impl(multi_handle, max_sleep_ms,
                                     &fd_count);
 #endif
         if (mres != CURLM_OK) {
@@ -323,9 +419,13 @@ int TPCHandler::RunCurlWithStreamsImpl(XrdHttpExtReq &req, State &state,
 
     // Generate the final response back to the client.
     std::stringstream ss;
+    bool flushed = handles[0]->Flush();
     if (res != CURLE_OK) {
         m_log.Emsg(log_prefix, "request failed when processing", curl_easy_strerror(res));
         ss << "failure: " << curl_easy_strerror(res);
+    } else if (!flushed) {
+        ss << "failure: Failed to write the data to local storage";
+        m_log.Emsg(log_prefix, "Failed to write the data to local storage");
     } else if (current_offset != content_size) {
         ss << "failure: Internal logic error led to early abort";
         m_log.Emsg(log_prefix, "Internal logic error led to early abort");
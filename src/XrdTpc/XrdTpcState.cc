@@ -9,6 +9,7 @@
 
 #include <curl/curl.h>
 
+#include "XrdTpcCurlShare.hh"
 #include "XrdTpcState.hh"
 #include "XrdTpcStream.hh"
 
@@ -29,6 +30,7 @@ void State::Move(State &other)
     m_push = other.m_push;
     m_recv_status_line = other.m_recv_status_line;
     m_recv_all_headers = other.m_recv_all_headers;
+    m_paused = other.m_paused;
     m_offset = other.m_offset;
     m_start_offset = other.m_start_offset;
     m_status_code = other.m_status_code;
@@ -109,6 +111,7 @@ void State::ResetAfterRequest() {
     m_content_length = -1;
     m_recv_all_headers = false;
     m_recv_status_line = false;
+    m_paused = false;
 }
 
 size_t State::HeaderCB(char *buffer, size_t size, size_t nitems, void *userdata)
@@ -181,6 +184,11 @@ int State::Write(char *buffer, size_t size) {
     if (retval == SFS_ERROR) {
         return -1;
     }
+    // No buffer space for this data yet; libcurl keeps it until we unpause.
+    if (!retval && size) {
+        m_paused = true;
+        return CURL_WRITEFUNC_PAUSE;
+    }
     m_offset += retval;
     return retval;
 }
@@ -207,6 +215,7 @@ State *State::Duplicate() {
     if (!curl) {
         throw std::runtime_error("Failed to duplicate existing curl handle.");
     }
+    CurlShare::Attach(curl);
 
     State *state = new State(0, *m_stream, curl, m_push);
 
@@ -238,3 +247,17 @@ int State::AvailableBuffers() const
 {
     return m_stream->AvailableBuffers();
 }
+
+void State::Unpause()
+{
+    if (!m_paused) {return;}
+    // Note that libcurl may call the write callback (and pause again) from
+    // within curl_easy_pause.
+    m_paused = false;
+    curl_easy_pause(m_curl, CURLPAUSE_CONT);
+}
+
+bool State::Flush()
+{
+    return m_stream->Finalize() == SFS_OK;
+}
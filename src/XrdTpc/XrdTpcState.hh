@@ -22,6 +22,7 @@ public:
         m_push(true),
         m_recv_status_line(false),
         m_recv_all_headers(false),
+        m_paused(false),
         m_offset(0),
         m_start_offset(0),
         m_status_code(-1),
@@ -38,6 +39,7 @@ public:
         m_push(push),
         m_recv_status_line(false),
         m_recv_all_headers(false),
+        m_paused(false),
         m_offset(0),
         m_start_offset(start_offset),
         m_status_code(-1),
@@ -67,6 +69,16 @@ public:
 
     int AvailableBuffers() const;
 
+    // True if libcurl was told to hold the data as there was no room for it.
+    bool IsPaused() const {return m_paused;}
+
+    // Let libcurl deliver the data held back by a previous pause.
+    void Unpause();
+
+    // Wait until all the received data is in the file; returns false if the
+    // data could not be written.
+    bool Flush();
+
     // Returns true if at least one byte of the response has been received,
     // but not the entire contents of the response.
     bool BodyTransferInProgress() const {return m_offset && (m_offset != m_content_length);}
@@ -98,6 +110,7 @@ private:
     bool m_push;  // whether we are transferring in "push-mode"
     bool m_recv_status_line;  // whether we have received a status line in the response from the remote host.
     bool m_recv_all_headers;  // true if we have seen the end of headers.
+    bool m_paused;  // true if the write callback paused the transfer.
     off_t m_offset;  // number of bytes we have received.
     off_t m_start_offset;  // offset where we started in the file.
     int m_status_code;  // status code from HTTP response.
@@ -3,16 +3,93 @@
 
 #include "XrdSfs/XrdSfsInterface.hh"
 
+#include <stdlib.h>
+
+#include <algorithm>
+
 using namespace TPC;
 
-Stream::~Stream()
+XrdSysMutex BufferPool::m_mutex;
+std::vector<char*> BufferPool::m_idle;
+size_t BufferPool::m_buffer_size = 1024*1024;
+size_t BufferPool::m_max_buffers = 1024;
+size_t BufferPool::m_in_use = 0;
+
+
+void
+BufferPool::Configure(size_t buffer_size, size_t max_memory)
+{
+    XrdSysMutexHelper lock(m_mutex);
+    m_buffer_size = buffer_size;
+    m_max_buffers = max_memory / buffer_size;
+    if (!m_max_buffers) {m_max_buffers = 1;}
+}
+
+
+char *
+BufferPool::Get()
+{
+    XrdSysMutexHelper lock(m_mutex);
+    if (m_in_use >= m_max_buffers) {return NULL;}
+    char *buffer;
+    if (!m_idle.empty()) {
+        buffer = m_idle.back();
+        m_idle.pop_back();
+    } else if (!(buffer = static_cast<char*>(malloc(m_buffer_size)))) {
+        return NULL;
+    }
+    m_in_use++;
+    return buffer;
+}
+
+
+void
+BufferPool::Release(char *buffer)
+{
+    XrdSysMutexHelper lock(m_mutex);
+    m_in_use--;
+    // Keep some buffers around for the next transfers but give the memory
+    // back once we are well below the limit.
+    if (m_idle.size() < m_max_buffers/4) {
+        m_idle.push_back(buffer);
+    } else {
+        free(buffer);
+    }
+}
+
+
+size_t
+BufferPool::Available()
+{
+    XrdSysMutexHelper lock(m_mutex);
+    return m_max_buffers - m_in_use;
+}
+
+
+Stream::Stream(std::unique_ptr<XrdSfsFile> fh, size_t max_buffers)
+    : m_cond(0, "TPC stream"),
+      m_max_buffers(max_buffers),
+      m_fh(std::move(fh)),
+      m_offset(0),
+      m_read_next(0),
+      m_read_end(0),
+      m_writer_active(false),
+      m_done(false),
+      m_error(false)
 {
-    for (std::vector<Entry*>::iterator buffer_iter = m_buffers.begin();
-        buffer_iter != m_buffers.end();
-        buffer_iter++) {
-        delete *buffer_iter;
-        *buffer_iter = NULL;
+    if (!m_max_buffers) {return;}
+    if (XrdSysThread::Run(&m_writer_tid, Stream::StartWriter, this,
+                          XRDSYSTHREAD_HOLD, "TPC writer")) {
+        m_error = true;
+    } else {
+        m_writer_active = true;
     }
+}
+
+
+Stream::~Stream()
+{
+    Finalize();
     m_fh->close();
 }
 
@@ -23,78 +100,371 @@ Stream::Stat(struct stat* buf)
     return m_fh->stat(buf);
 }
 
+
+void *
+Stream::StartWriter(void *arg)
+{
+    static_cast<Stream*>(arg)->Writer();
+    return NULL;
+}
+
+
+void
+Stream::Writer()
+{
+    m_cond.Lock();
+    while (!m_error) {
+        std::map<off_t, Entry*>::iterator iter = m_entries.find(m_offset);
+        if ((iter == m_entries.end()) || !iter->second->m_sealed) {
+            if (m_done) {break;}
+            m_cond.Wait();
+            continue;
+        }
+
+        // Nobody else touches a sealed entry, we can write it unlocked.
+        Entry *entry = iter->second;
+        m_cond.UnLock();
+        int retval = m_fh->write(entry->m_offset, entry->m_buffer, entry->m_size);
+        m_cond.Lock();
+
+        if (retval != static_cast<int>(entry->m_size)) {
+            m_error = true;
+        } else {
+            m_offset += retval;
+        }
+        m_entries.erase(entry->m_offset);
+        BufferPool::Release(entry->m_buffer);
+        delete entry;
+        m_cond.Broadcast();
+    }
+    m_cond.Broadcast();
+    m_cond.UnLock();
+}
+
+
+bool
+Stream::ReadAhead(off_t file_size, size_t depth, unsigned readers)
+{
+    if (m_max_buffers || !m_reader_tids.empty() || !depth || !readers) {
+        return false;
+    }
+    m_cond.Lock();
+    m_max_buffers = depth;
+    m_read_next = 0;
+    m_read_end = file_size;
+    m_cond.UnLock();
+
+    for (unsigned idx = 0; idx < readers; idx++) {
+        pthread_t tid;
+        if (XrdSysThread::Run(&tid, Stream::StartReader, this,
+                              XRDSYSTHREAD_HOLD, "TPC reader")) {
+            break;
+        }
+        m_reader_tids.push_back(tid);
+    }
+    return !m_reader_tids.empty();
+}
+
+
+void *
+Stream::StartReader(void *arg)
+{
+    static_cast<Stream*>(arg)->Reader();
+    return NULL;
+}
+
+
+void
+Stream::Reader()
+{
+    const size_t capacity = BufferPool::BufferSize();
+
+    m_cond.Lock();
+    while (!m_done && !m_error) {
+        // Nothing left to fetch or enough fetched already.
+        if ((m_read_next >= m_read_end) || (m_entries.size() >= m_max_buffers)) {
+            m_cond.Wait();
+            continue;
+        }
+        char *buffer = BufferPool::Get();
+        if (!buffer) {
+            // Other transfers hold all the memory; Read() goes to the file
+            // for whatever we could not fetch.
+            m_cond.WaitMS(10);
+            continue;
+        }
+
+        // Claim the next block and read it unlocked; nobody else touches an
+        // entry until it is sealed.
+        Entry *entry = new Entry(m_read_next, buffer);
+        size_t len = std::min(static_cast<off_t>(capacity), m_read_end - m_read_next);
+        m_entries[m_read_next] = entry;
+        m_read_next += len;
+        m_cond.UnLock();
+        int retval = m_fh->read(entry->m_offset, entry->m_buffer, len);
+        m_cond.Lock();
+
+        if (retval < 0) {
+            m_error = true;
+        } else {
+            entry->m_size = retval;
+        }
+        entry->m_sealed = true;
+        m_cond.Broadcast();
+    }
+    m_cond.Broadcast();
+    m_cond.UnLock();
+}
+
+
+// Must be called with the lock held; returns the offset right after the
+// data that can be written out without waiting for any other data.
+off_t
+Stream::HeadOffset() const
+{
+    off_t head = m_offset;
+    std::map<off_t, Entry*>::const_iterator iter;
+    while ((iter = m_entries.find(head)) != m_entries.end()) {
+        head += iter->second->m_size;
+    }
+    return head;
+}
+
+
+// Must be called with the lock held.
+void
+Stream::ReleaseEntries()
+{
+    for (std::map<off_t, Entry*>::iterator iter = m_entries.begin();
+         iter != m_entries.end();
+         iter++) {
+        BufferPool::Release(iter->second->m_buffer);
+        delete iter->second;
+    }
+    m_entries.clear();
+}
+
+
 int
 Stream::Write(off_t offset, const char *buf, size_t size)
 {
-    bool buffer_accepted = false;
-    int retval = size;
-    if (offset < m_offset) {
+    const size_t capacity = BufferPool::BufferSize();
+
+    m_cond.Lock();
+    if (m_error || (offset < m_offset)) {
+        m_cond.UnLock();
         return SFS_ERROR;
     }
-    if (offset == m_offset) {
-        retval = m_fh->write(offset, buf, size);
-        buffer_accepted = true;
-        if (retval != SFS_ERROR) {
-            m_offset += retval;
+
+    // Find the buffer this data continues, if there is one.
+    Entry *tail = NULL;
+    std::map<off_t, Entry*>::iterator iter = m_entries.lower_bound(offset);
+    if (iter != m_entries.begin()) {
+        --iter;
+        Entry *entry = iter->second;
+        if (!entry->m_sealed &&
+            (entry->m_offset + static_cast<off_t>(entry->m_size) == offset)) {
+            tail = entry;
         }
-        // If there are no in-use buffers, then we don't need to
-        // do any accounting.
-        if (m_avail_count == m_buffers.size()) {
-            return retval;
-        }
-    }
-    // Even if we already accepted the current data, always
-    // iterate through available buffers and try to write as
-    // much out to disk as possible.
-    Entry *avail_entry;
-    bool buffer_was_written;
-    size_t avail_count = 0;
-    do {
-        avail_count = 0;
-        avail_entry = NULL;
-        buffer_was_written = false;
-        for (std::vector<Entry*>::iterator entry_iter = m_buffers.begin();
-             entry_iter != m_buffers.end();
-             entry_iter++) {
-            // Always try to dump from memory.
-            if ((*entry_iter)->Write(*this) > 0) {
-                buffer_was_written = true;
-            }
-            if ((*entry_iter)->Available()) { // Empty buffer
-                if (!avail_entry) {avail_entry = *entry_iter;}
-                avail_count ++;
-            }
-            else if (!buffer_accepted && (*entry_iter)->Accept(offset, buf, size)) {
-                buffer_accepted = true;
-            }
-        }
-    } while ((avail_count != m_buffers.size()) && buffer_was_written);
-    m_avail_count = avail_count;
-
-    if (!buffer_accepted) {  // No place for this data in allocated buffers
-        if (!avail_entry) {  // No available buffers to allocate.
-            return SFS_ERROR;
+    }
+
+    // Get all the buffers we need up-front; the data is either taken in
+    // its entirety or not at all.
+    size_t room = tail ? capacity - tail->m_size : 0;
+    size_t needed = (size > room) ? (size - room + capacity - 1) / capacity : 0;
+    std::vector<char*> buffers;
+    while ((buffers.size() < needed) &&
+           (m_entries.size() + buffers.size() < m_max_buffers)) {
+        char *buffer = BufferPool::Get();
+        if (!buffer) {break;}
+        buffers.push_back(buffer);
+    }
+
+    if (buffers.size() < needed) {
+        for (std::vector<char*>::iterator buf_iter = buffers.begin();
+             buf_iter != buffers.end();
+             buf_iter++) {
+            BufferPool::Release(*buf_iter);
+        }
+        // Out-of-order data has to wait until some buffers are freed.
+        if (offset != HeadOffset()) {
+            m_cond.UnLock();
+            return 0;
         }
-        if (!avail_entry->Accept(offset, buf, size)) {  // Empty buffer cannot accept?!?
+        // This data is next in line, so write it as soon as everything in
+        // front of it is on disk.  This guarantees progress however busy
+        // the buffer pool is.
+        if (tail) {
+            tail->m_sealed = true;
+            m_cond.Broadcast();
+        }
+        while (!m_error && (m_offset != offset)) {m_cond.Wait();}
+        if (m_error) {
+            m_cond.UnLock();
             return SFS_ERROR;
         }
-        m_avail_count --;
+        m_cond.UnLock();
+        int retval = m_fh->write(offset, buf, size);
+        m_cond.Lock();
+        if (retval != static_cast<int>(size)) {
+            m_error = true;
+            retval = SFS_ERROR;
+        } else {
+            m_offset += retval;
+        }
+        m_cond.Broadcast();
+        m_cond.UnLock();
+        return retval;
     }
 
-    // If we have low buffer occupancy, then release memory.
-    if ((m_buffers.size() > 2) && (m_avail_count * 2 > m_buffers.size())) {
-        for (std::vector<Entry*>::iterator entry_iter = m_buffers.begin();
-             entry_iter != m_buffers.end();
-             entry_iter++) {
-            (*entry_iter)->ShrinkIfUnused();
+    // Copy the data into the buffers; full ones are handed to the writer.
+    bool sealed = false;
+    Entry *last = tail;
+    off_t cur_offset = offset;
+    size_t remaining = size;
+    if (tail && remaining) {
+        size_t len = std::min(room, remaining);
+        memcpy(tail->m_buffer + tail->m_size, buf, len);
+        tail->m_size += len;
+        buf += len;
+        cur_offset += len;
+        remaining -= len;
+    }
+    for (std::vector<char*>::iterator buf_iter = buffers.begin();
+         buf_iter != buffers.end();
+         buf_iter++) {
+        if (last && (last->m_size == capacity)) {last->m_sealed = sealed = true;}
+        Entry *entry = new Entry(cur_offset, *buf_iter);
+        size_t len = std::min(capacity, remaining);
+        memcpy(entry->m_buffer, buf, len);
+        entry->m_size = len;
+        m_entries[cur_offset] = entry;
+        buf += len;
+        cur_offset += len;
+        remaining -= len;
+        last = entry;
+    }
+
+    // The last buffer cannot grow once it is full or it reaches data that
+    // was already received.
+    if (last && !last->m_sealed &&
+        ((last->m_size == capacity) || m_entries.count(cur_offset))) {
+        last->m_sealed = sealed = true;
+    }
+    if (sealed) {m_cond.Broadcast();}
+    m_cond.UnLock();
+
+    return size;
+}
+
+
+int
+Stream::Finalize()
+{
+    if (!m_reader_tids.empty()) {
+        m_cond.Lock();
+        m_done = true;
+        m_cond.Broadcast();
+        m_cond.UnLock();
+        for (std::vector<pthread_t>::iterator iter = m_reader_tids.begin();
+             iter != m_reader_tids.end();
+             iter++) {
+            XrdSysThread::Join(*iter, NULL);
         }
+        m_reader_tids.clear();
+        m_cond.Lock();
+        ReleaseEntries();
+        bool failed = m_error;
+        m_cond.UnLock();
+        return failed ? SFS_ERROR : SFS_OK;
     }
 
-    return retval;
+    if (m_writer_active) {
+        m_cond.Lock();
+        for (std::map<off_t, Entry*>::iterator iter = m_entries.begin();
+             iter != m_entries.end();
+             iter++) {
+            iter->second->m_sealed = true;
+        }
+        m_done = true;
+        m_cond.Broadcast();
+        m_cond.UnLock();
+        XrdSysThread::Join(m_writer_tid, NULL);
+        m_writer_active = false;
+    }
+
+    // Anything left could not be written as some data in front of it never
+    // arrived.
+    m_cond.Lock();
+    bool incomplete = !m_entries.empty();
+    ReleaseEntries();
+    bool failed = m_error || incomplete;
+    m_cond.UnLock();
+
+    return failed ? SFS_ERROR : SFS_OK;
 }
 
+
+size_t
+Stream::AvailableBuffers() const
+{
+    m_cond.Lock();
+    size_t held = m_entries.size();
+    m_cond.UnLock();
+    size_t avail = (m_max_buffers > held) ? m_max_buffers - held : 0;
+    return std::min(avail, BufferPool::Available());
+}
+
+
 int
 Stream::Read(off_t offset, char *buf, size_t size)
 {
+    if (m_reader_tids.empty()) {
+        return m_fh->read(offset, buf, size);
+    }
+
+    m_cond.Lock();
+    while (true) {
+        if (m_error) {
+            m_cond.UnLock();
+            return SFS_ERROR;
+        }
+
+        // Anything in front of the requested offset is no longer needed.
+        std::map<off_t, Entry*>::iterator iter = m_entries.begin();
+        while ((iter != m_entries.end()) && iter->second->m_sealed &&
+               (iter->second->m_offset + static_cast<off_t>(iter->second->m_size) <= offset)) {
+            BufferPool::Release(iter->second->m_buffer);
+            delete iter->second;
+            m_entries.erase(iter++);
+            m_cond.Broadcast();
+        }
+
+        // Find the block holding the offset; if no reader fetched or is
+        // fetching it (e.g., the transfer was restarted) read it directly.
+        iter = m_entries.upper_bound(offset);
+        if (iter == m_entries.begin()) {break;}
+        --iter;
+        Entry *entry = iter->second;
+        if (!entry->m_sealed) {
+            m_cond.Wait();
+            continue;
+        }
+        off_t end = entry->m_offset + static_cast<off_t>(entry->m_size);
+        if (offset >= end) {break;}
+
+        size_t len = std::min(static_cast<off_t>(size), end - offset);
+        memcpy(buf, entry->m_buffer + (offset - entry->m_offset), len);
+        if (offset + static_cast<off_t>(len) == end) {
+            BufferPool::Release(entry->m_buffer);
+            delete entry;
+            m_entries.erase(iter);
+            m_cond.Broadcast();
+        }
+        m_cond.UnLock();
+        return len;
+    }
+    m_cond.UnLock();
+
     return m_fh->read(offset, buf, size);
 }
@@ -5,120 +5,130 @@
  * The abstraction layer is necessary to do the necessary buffering
  * of multi-stream writes where the underlying filesystem only
  * supports single-stream writes.
+ *
+ * Data handed to Write() is copied into buffers taken from a pool that
+ * is shared by all concurrent transfers; a per-stream writer thread
+ * drains the buffers to the file in offset order so that the libcurl
+ * callbacks never wait on the disk.
+ *
+ * For reading, reader threads may fill buffers from the same pool ahead of
+ * the position Read() is called for, so that push transfers find the data
+ * already in memory.
  */
 
+#include <sys/types.h>
+
+#include <map>
 #include <memory>
 #include <vector>
 
 #include <cstring>
 
+#include "XrdSys/XrdSysPthread.hh"
+
 struct stat;
 
 class XrdSfsFile;
 
 namespace TPC {
+
+/**
+ * Process-wide pool of fixed-size transfer buffers.  The total amount of
+ * memory handed out is capped so that many simultaneous transfers cannot
+ * exhaust the host.
+ */
+class BufferPool {
+public:
+    // Set the buffer size and the maximum memory that may be handed out.
+    // Must be called before the first buffer is obtained.
+    static void Configure(size_t buffer_size, size_t max_memory);
+
+    // Returns NULL if the memory limit has been reached.
+    static char *Get();
+
+    static void Release(char *buffer);
+
+    // Number of buffers that may still be obtained.
+    static size_t Available();
+
+    static size_t BufferSize() {return m_buffer_size;}
+
+private:
+    static XrdSysMutex m_mutex;
+    static std::vector<char*> m_idle;
+    static size_t m_buffer_size;
+    static size_t m_max_buffers;
+    static size_t m_in_use;
+};
+
 class Stream {
 public:
-    Stream(std::unique_ptr<XrdSfsFile> fh, size_t max_blocks, size_t buffer_size)
-        : m_avail_count(max_blocks),
-          m_fh(std::move(fh)),
-          m_offset(0)
-    {
-        m_buffers.reserve(max_blocks);
-        for (size_t idx=0; idx < max_blocks; idx++) {
-            m_buffers.push_back(new Entry(buffer_size));
-        }
-    }
+    // A stream with max_buffers == 0 is only used for reading.
+    Stream(std::unique_ptr<XrdSfsFile> fh, size_t max_buffers);
 
     ~Stream();
 
     int Stat(struct stat *);
 
+    // Returns the number of bytes read (possibly less than requested), 0 at
+    // the end of the file or SFS_ERROR.
     int Read(off_t offset, char *buffer, size_t size);
 
+    // Start reading the file sequentially ahead of Read(), keeping up to
+    // `depth` buffers filled using `readers` threads.  Only valid for
+    // streams used for reading.  Returns false if no reader could be started
+    // in which case Read() goes to the file directly.
+    bool ReadAhead(off_t file_size, size_t depth, unsigned readers);
+
+    // Returns the number of bytes accepted, SFS_ERROR on failure or 0 if
+    // there is currently no buffer space for out-of-order data; in the
+    // latter case the caller should retry the same data later.
     int Write(off_t offset, const char *buffer, size_t size);
 
-    size_t AvailableBuffers() const {return m_avail_count;}
+    // Wait until all buffered data has been written to the file.  Returns
+    // SFS_OK if every write succeeded and SFS_ERROR otherwise.
+    int Finalize();
+
+    size_t AvailableBuffers() const;
 
 private:
 
-    class Entry {
-    public:
-        Entry(size_t capacity) :
-            m_offset(-1),
-            m_capacity(capacity),
-            m_size(0)
-        {}
+    Stream(const Stream&) = delete;
 
-        bool Available() const {return m_offset == -1;}
-
-        int Write(Stream &stream) {
-            if (Available() || !CanWrite(stream)) {return 0;}
-            // Currently, only full writes are accepted.
-            int size_desired = m_size;
-            int retval = stream.Write(m_offset, &m_buffer[0], size_desired);
-            m_size = 0;
-            m_offset = -1;
-            if (retval != size_desired) {
-                return -1;
-            }
-            return retval;
-        }
-
-        bool Accept(off_t offset, const char *buf, size_t size) {
-            // Validate acceptance criteria.
-            if ((m_offset != -1) && (offset != m_offset + static_cast<ssize_t>(m_size))) {
-                return false;
-            }
-            if (size > m_capacity - m_size) {
-                return false;
-            }
-
-            // Inflate the underlying buffer if needed.
-            ssize_t new_bytes_needed = (m_size + size) - m_buffer.capacity();
-            if (new_bytes_needed > 0) {
-                m_buffer.reserve(m_capacity);
-            }
-
-            // Finally, do the copy.
-            memcpy(&m_buffer[0] + m_size, buf, size);
-            m_size += size;
-            if (m_offset == -1) {
-                m_offset = offset;
-            }
-            return true;
-        }
-
-        void ShrinkIfUnused() {
-           if (!Available()) {return;}
-#if __cplusplus > 199711L
-           m_buffer.shrink_to_fit();
-#endif
-        }
-
-        void Move(Entry &other) {
-            m_buffer.swap(other.m_buffer);
-            m_offset = other.m_offset;
-            m_size = other.m_size;
-        }
-
-    private:
-
-        Entry(const Entry&) = delete;
-
-        bool CanWrite(Stream &stream) const {
-            return (m_size > 0) && (m_offset == stream.m_offset);
-        }
+    struct Entry {
+        Entry(off_t offset, char *buffer) :
+            m_offset(offset),
+            m_size(0),
+            m_sealed(false),
+            m_buffer(buffer)
+        {}
 
         off_t m_offset;  // Offset within file that m_buffer[0] represents.
-        size_t m_capacity;
         size_t m_size;  // Number of bytes held in buffer.
-        std::vector<char> m_buffer;
+        bool m_sealed;  // No more data will be added; may be written out.
+        char *m_buffer;
     };
 
-    size_t m_avail_count;
+    static void *StartWriter(void *);
+    void Writer();
+
+    static void *StartReader(void *);
+    void Reader();
+
+    off_t HeadOffset() const;
+    void ReleaseEntries();
+
+    mutable XrdSysCondVar m_cond;
+    size_t m_max_buffers;
     std::unique_ptr<XrdSfsFile> m_fh;
-    off_t m_offset;
-    std::vector<Entry*> m_buffers;
+    off_t m_offset;  // Number of bytes written to the file.
+    std::map<off_t, Entry*> m_entries;
+    pthread_t m_writer_tid;
+    std::vector<pthread_t> m_reader_tids;
+    off_t m_read_next;  // Next offset a reader will fetch.
+    off_t m_read_end;  // Size of the file being read ahead.
+    bool m_writer_active;
+    bool m_done;
+    bool m_error;
 };
 }
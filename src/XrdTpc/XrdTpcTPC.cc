@@ -20,12 +20,16 @@
 #include "XrdTpcStream.hh"
 #include "XrdTpcTPC.hh"
 #include "XrdTpcCurlMulti.hh"
+#include "XrdTpcCurlShare.hh"
 
 using namespace TPC;
 
 uint64_t TPCHandler::m_monid{0};
 int TPCHandler::m_marker_period = 5;
 size_t TPCHandler::m_block_size = 16*1024*1024;
+bool TPCHandler::m_adaptive_streams = true;
+size_t TPCHandler::m_readahead_depth = 8;
+unsigned TPCHandler::m_readahead_readers = 2;
 XrdSysMutex TPCHandler::m_monid_mutex;
 
 XrdVERSIONINFO(XrdHttpGetExtHandler, HttpTPC);
@@ -229,6 +233,7 @@ int TPCHandler::RunCurlWithUpdates(CURL *curl, XrdHttpExtReq &req, State &state,
         curl_easy_cleanup(curl);
         return req.SendSimpleResp(500, NULL, NULL, msg, 0);
     }
+    CurlShare::AttachMulti(multi_handle);
 
     CURLMcode mres;
     mres = curl_multi_add_handle(multi_handle, curl);
@@ -266,6 +271,7 @@ int TPCHandler::RunCurlWithUpdates(CURL *curl, XrdHttpExtReq &req, State &state,
             }
             last_marker = now;
         }
+        state.Unpause();
         mres = curl_multi_perform(multi_handle, &running_handles);
         if (mres == CURLM_CALL_MULTI_PERFORM) {
             // curl_multi_perform should be called again immediately.  On newer
@@ -295,11 +301,13 @@ int TPCHandler::RunCurlWithUpdates(CURL *curl, XrdHttpExtReq &req, State &state,
         if (max_sleep_time <= 0) {
             continue;
         }
+        // A paused transfer is retried as soon as the writer made some room.
+        int max_sleep_ms = state.IsPaused() ? 10 : max_sleep_time*1000;
         int fd_count;
 #ifdef HAVE_CURL_MULTI_WAIT
-        mres = curl_multi_wait(multi_handle, NULL, 0, max_sleep_time*1000, &fd_count);
+        mres = curl_multi_wait(multi_handle, NULL, 0, max_sleep_ms, &fd_count);
 #else
-        mres = curl_multi_wait_impl(multi_handle, max_sleep_time*1000, &fd_count);
+        mres = curl_multi_wait_impl(multi_handle, max_sleep_ms, &fd_count);
 #endif
         if (mres != CURLM_OK) {
             break;
@@ -349,12 +357,16 @@ int TPCHandler::RunCurlWithUpdates(CURL *curl, XrdHttpExtReq &req, State &state,
 
     // Generate the final response back to the client.
     std::stringstream ss;
+    bool flushed = state.Flush();
     if (res != CURLE_OK) {
         m_log.Emsg(log_prefix, "Remote server failed request", curl_easy_strerror(res));
         ss << "failure: " << curl_easy_strerror(res);
     } else if (state.GetStatusCode() >= 400) {
         ss << "failure: Remote side failed with status code " << state.GetStatusCode();
         m_log.Emsg(log_prefix, "Remote server failed request", ss.str().c_str());
+    } else if (!flushed) {
+        ss << "failure: Failed to write the data to local storage";
+        m_log.Emsg(log_prefix, "Failed to write the data to local storage");
     } else {
         ss << "success: Created";
     }
@@ -398,6 +410,7 @@ int TPCHandler::ProcessPushReq(const std::string & resource, XrdHttpExtReq &req)
         char msg[] = "Failed to initialize internal transfer resources";
         return req.SendSimpleResp(500, NULL, NULL, msg, 0);
     }
+    CurlShare::Attach(curl);
     char *name = req.GetSecEntity().name;
     AtomicBeg(m_monid_mutex);
     uint64_t file_monid = AtomicInc(m_monid);
@@ -430,7 +443,13 @@ int TPCHandler::ProcessPushReq(const std::string & resource, XrdHttpExtReq &req)
     }
     curl_easy_setopt(curl, CURLOPT_URL, resource.c_str());
 
-    Stream stream(std::move(fh), 0, 0);
+    Stream stream(std::move(fh), 0);
+    // Keep the disk ahead of libcurl so that the read callback only copies
+    // data that is already in memory.
+    struct stat buf;
+    if (m_readahead_depth && (SFS_OK == stream.Stat(&buf))) {
+        stream.ReadAhead(buf.st_size, m_readahead_depth, m_readahead_readers);
+    }
     State state(0, stream, curl, true);
     state.CopyHeaders(req);
 
@@ -447,6 +466,7 @@ int TPCHandler::ProcessPullReq(const std::string &resource, XrdHttpExtReq &req)
             char msg[] = "Failed to initialize internal transfer resources";
             return req.SendSimpleResp(500, NULL, NULL, msg, 0);
     }
+    CurlShare::Attach(curl);
     char *name = req.GetSecEntity().name;
     std::unique_ptr<XrdSfsFile> fh(m_sfs->newFile(name, m_monid++));
     if (!fh.get()) {
@@ -498,7 +518,10 @@ int TPCHandler::ProcessPullReq(const std::string &resource, XrdHttpExtReq &req)
         curl_easy_setopt(curl, CURLOPT_CAPATH, m_cadir.c_str());
     }
     curl_easy_setopt(curl, CURLOPT_URL, resource.c_str());
-    Stream stream(std::move(fh), streams, m_block_size);
+    // Each stream may buffer up to a full block ahead of the data that can
+    // be written out.
+    size_t buffer_size = BufferPool::BufferSize();
+    Stream stream(std::move(fh), streams * ((m_block_size + buffer_size - 1) / buffer_size));
     State state(0, stream, curl, false);
     state.CopyHeaders(req);
 
@@ -521,6 +544,10 @@ XrdHttpExtHandler *XrdHttpGetExtHandler(XrdSysError *log, const char * config, c
         log->Emsg("Initialize", "libcurl failed to initialize");
         return NULL;
     }
+    if (!CurlShare::Init()) {
+        log->Emsg("Initialize", "libcurl share failed to initialize; "
+                  "connections will not be reused across transfers");
+    }
 
     TPCHandler *retval{NULL};
     if (!config) {
@@ -63,10 +63,15 @@ private:
 
     bool ConfigureFSLib(XrdOucStream &Config, std::string &path1, bool &path1_alt,
                         std::string &path2, bool &path2_alt);
+    bool ConfigureBuffers(XrdOucStream &Config);
+    bool ConfigureReadAhead(XrdOucStream &Config);
     bool Configure(const char *configfn, XrdOucEnv *myEnv);
 
     static int m_marker_period;
     static size_t m_block_size;
+    static bool m_adaptive_streams;
+    static size_t m_readahead_depth;
+    static unsigned m_readahead_readers;
     bool m_desthttps;
     std::string m_cadir;
     static XrdSysMutex m_monid_mutex;
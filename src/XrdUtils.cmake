@@ -26,6 +26,7 @@ add_library(
   #-----------------------------------------------------------------------------
   XrdSys/XrdSysDNS.cc           XrdSys/XrdSysDNS.hh
   XrdSys/XrdSysDir.cc           XrdSys/XrdSysDir.hh
+  XrdSys/XrdSysDRWLock.cc       XrdSys/XrdSysDRWLock.hh
                                 XrdSys/XrdSysFD.hh
   XrdSys/XrdSysPlugin.cc        XrdSys/XrdSysPlugin.hh
   XrdSys/XrdSysPriv.cc          XrdSys/XrdSysPriv.hh
@@ -33,6 +34,7 @@ add_library(
   XrdSys/XrdSysPthread.cc       XrdSys/XrdSysPthread.hh
                                 XrdSys/XrdSysSemWait.hh
   XrdSys/XrdSysTimer.cc         XrdSys/XrdSysTimer.hh
+  XrdSys/XrdSysTimerWheel.cc    XrdSys/XrdSysTimerWheel.hh
   XrdSys/XrdSysTrace.cc         XrdSys/XrdSysTrace.hh
   XrdSys/XrdSysUtils.cc         XrdSys/XrdSysUtils.hh
   XrdSys/XrdSysXSLock.cc        XrdSys/XrdSysXSLock.hh
@@ -67,12 +69,15 @@ add_library(
   XrdOuc/XrdOucCacheData.cc     XrdOuc/XrdOucCacheData.hh
   XrdOuc/XrdOucCacheDram.cc     XrdOuc/XrdOucCacheDram.hh
   XrdOuc/XrdOucCacheReal.cc     XrdOuc/XrdOucCacheReal.hh
+  XrdOuc/XrdOucCacheShm.cc      XrdOuc/XrdOucCacheShm.hh
                                 XrdOuc/XrdOucCacheSlot.hh
   XrdOuc/XrdOucCallBack.cc      XrdOuc/XrdOucCallBack.hh
   XrdOuc/XrdOucCRC.cc           XrdOuc/XrdOucCRC.hh
   XrdOuc/XrdOucEnv.cc           XrdOuc/XrdOucEnv.hh
                                 XrdOuc/XrdOucHash.hh
                                 XrdOuc/XrdOucHash.icc
+                                XrdOuc/XrdOucOAHash.hh
+                                XrdOuc/XrdOucOAHash.icc
   XrdOuc/XrdOucERoute.cc        XrdOuc/XrdOucERoute.hh
                                 XrdOuc/XrdOucErrInfo.hh
   XrdOuc/XrdOucExport.cc        XrdOuc/XrdOucExport.hh
@@ -100,6 +105,7 @@ add_library(
   XrdOuc/XrdOucTokenizer.cc     XrdOuc/XrdOucTokenizer.hh
   XrdOuc/XrdOucTPC.cc           XrdOuc/XrdOucTPC.hh
   XrdOuc/XrdOucTrace.cc         XrdOuc/XrdOucTrace.hh
+  XrdOuc/XrdOucTraceCtx.cc      XrdOuc/XrdOucTraceCtx.hh
   XrdOuc/XrdOucUtils.cc         XrdOuc/XrdOucUtils.hh
   XrdOuc/XrdOucVerName.cc       XrdOuc/XrdOucVerName.hh
                                 XrdOuc/XrdOucChain.hh
@@ -173,13 +179,13 @@ add_library(
   # XrdCks
   #-----------------------------------------------------------------------------
   XrdCks/XrdCksAssist.cc           XrdCks/XrdCksAssist.hh
+  XrdCks/XrdCksCalcadler32.cc      XrdCks/XrdCksCalcadler32.hh
   XrdCks/XrdCksCalccrc32.cc        XrdCks/XrdCksCalccrc32.hh
   XrdCks/XrdCksCalcmd5.cc          XrdCks/XrdCksCalcmd5.hh
   XrdCks/XrdCksConfig.cc           XrdCks/XrdCksConfig.hh
   XrdCks/XrdCksLoader.cc           XrdCks/XrdCksLoader.hh
   XrdCks/XrdCksManager.cc          XrdCks/XrdCksManager.hh
   XrdCks/XrdCksManOss.cc           XrdCks/XrdCksManOss.hh
-                                   XrdCks/XrdCksCalcadler32.hh
                                    XrdCks/XrdCksCalc.hh
                                    XrdCks/XrdCksData.hh
                                    XrdCks/XrdCks.hh
@@ -142,6 +142,13 @@ Bridge       *Login(Result       *rsltP, //!< The result callback object
 //!                 xdataL >= "dlen": no additional bytes will be read from the
 //!                                   network. The request data is complete.
 //!
+//! @param  xdataPin when true, the caller promises that the xdataP buffer will
+//!                 not be altered or deleted until the Result Free() callback
+//!                 is invoked, just as for write requests. The bridge then
+//!                 refers to the buffer instead of keeping its own copy of the
+//!                 data for re-issuing the request after a delay. When false,
+//!                 the buffer may be reused as soon as Run() returns.
+//!
 //! @return true    the request has been accepted. Processing will start when
 //!                 the caller returns from the Process() method.
 //!                 A response will come via a Result object callback.
@@ -151,7 +158,8 @@ Bridge       *Login(Result       *rsltP, //!< The result callback object
 
 virtual bool  Run(const char *xreqP,       //!< xrootd request header
                         char *xdataP=0,    //!< xrootd request data (optional)
-                        int   xdataL=0     //!< xrootd request data length
+                        int   xdataL=0,    //!< xrootd request data length
+                        bool  xdataPin=false //!< xdataP stays valid until Free()
                  ) = 0;
 
 //-----------------------------------------------------------------------------
@@ -391,7 +399,8 @@ virtual int   File(Bridge::Context &info,  //!< the result context
 //! was supplied. Normally, he buffer is pinned and cannot be reused until the
 //! write completes. This callback provides the notification that the buffer is
 //! no longer in use. The callback is invoked prior to any other callbacks and
-//! is only invoked if a buffer was supplied.
+//! is only invoked if a buffer was supplied. It is also invoked for the buffer
+//! of any other request that was pinned (i.e. Run() with xdataPin true).
 //!
 //! @param  info    the context associated with this call.
 //! @param  buffP   pointer to the buffer.
@@ -55,6 +55,7 @@
 #include "XrdOuc/XrdOucReqID.hh"
 #include "XrdOuc/XrdOucStream.hh"
 #include "XrdOuc/XrdOucTrace.hh"
+#include "XrdOuc/XrdOucTraceCtx.hh"
 #include "XrdOuc/XrdOucUtils.hh"
 #include "XrdSec/XrdSecLoadSecurity.hh"
 #include "XrdSys/XrdSysError.hh"
@@ -154,6 +155,7 @@ int XrdXrootdProtocol::Configure(char *parms, XrdProtocol_Config *pi)
    eDest.logger(pi->eDest->logger());
    XrdXrootdTrace = new XrdOucTrace(&eDest);
    SI           = new XrdXrootdStats(pi->Stats);
+   if (pi->theEnv) pi->theEnv->PutPtr("XrdXrootdStats*", SI);
    Sched        = pi->Sched;
    BPool        = pi->BPool;
    hailWait     = pi->hailWait;
@@ -331,6 +333,10 @@ int XrdXrootdProtocol::Configure(char *parms, XrdProtocol_Config *pi)
    else if (!as_noaio) XrdXrootdAioReq::Init(as_segsize, as_maxperreq, as_maxpersrv);
    else eDest.Say("Config warning: asynchronous I/O has been disabled!");
 
+// Make sure a merged readv fits in a buffer
+//
+   if (rv_span > maxBuffsz) rv_span = maxBuffsz;
+
 // Create the file lock manager
 //
    Locker = (XrdXrootdFileLock *)new XrdXrootdFileLock1();
@@ -446,6 +452,10 @@ int XrdXrootdProtocol::Configure(char *parms, XrdProtocol_Config *pi)
           }
       }
 
+// Start releasing buffers held by idle links if so wanted
+//
+   if (idle_rel) IdleScan();
+
 // Return success
 //
    free(adminp);
@@ -482,6 +492,7 @@ int XrdXrootdProtocol::Config(const char *ConfigFN)
          if (ismine)
             {     if TS_Xeq("async",         xasync);
              else if TS_Xeq("chksum",        xcksum);
+             else if TS_Xeq("compress",      xcmp);
              else if TS_Xeq("diglib",        xdig);
              else if TS_Xeq("export",        xexp);
              else if TS_Xeq("fslib",         xfsl);
@@ -492,8 +503,14 @@ int XrdXrootdProtocol::Config(const char *ConfigFN)
              else if TS_Xeq("prep",          xprep);
              else if TS_Xeq("redirect",      xred);
              else if TS_Xeq("seclib",        xsecl);
+             else if TS_Xeq("spans",         xspans);
              else if TS_Xeq("trace",         xtrace);
              else if TS_Xeq("limit",         xlimit);
+             else if TS_Xeq("latency",       xlatency);
+             else if TS_Xeq("readv",         xreadv);
+             else if TS_Xeq("streams",       xstrm);
+             else if TS_Xeq("idlemem",       xidle);
+             else if TS_Xeq("reqahead",      xrda);
              else {eDest.Say("Config warning: ignoring unknown directive '",var,"'.");
                    Config.Echo();
                    continue;
@@ -581,7 +598,7 @@ int XrdXrootdProtocol::ConfigSecurity(XrdOucEnv &xEnv, const char *cfn)
    Purpose:  To parse directive: async [limit <aiopl>] [maxsegs <msegs>]
                                        [maxtot <mtot>] [segsize <segsz>]
                                        [minsize <iosz>] [maxstalls <cnt>]
-                                       [force] [syncw] [off] [nosf]
+                                       [force] [syncw] [off] [nosf] [writev]
 
              <aiopl>  maximum number of async ops per link. Default 8.
              <msegs>  maximum number of async ops per request. Default 8.
@@ -600,6 +617,8 @@ int XrdXrootdProtocol::ConfigSecurity(XrdOucEnv &xEnv, const char *cfn)
              syncw    Use synchronous i/o for write requests.
              off      Disables async i/o
              nosf     Disables use of sendfile to send data to the client.
+             writev   Writes the segments of a writev request to a single file
+                      using async i/o, merging adjacent segments.
 
    Output: 0 upon success or 1 upon failure.
 */
@@ -610,7 +629,7 @@ int XrdXrootdProtocol::xasync(XrdOucStream &Config)
     int  i, ppp;
     int  V_force=-1, V_syncw = -1, V_off = -1, V_mstall = -1, V_nosf = -1;
     int  V_limit=-1, V_msegs=-1, V_mtot=-1, V_minsz=-1, V_segsz=-1;
-    int  V_minsf=-1;
+    int  V_minsf=-1, V_aiowv=-1;
     long long llp;
     struct asyncopts {const char *opname; int minv; int *oploc;
                       const char *opmsg;} asopts[] =
@@ -619,6 +638,7 @@ int XrdXrootdProtocol::xasync(XrdOucStream &Config)
         {"off",       -1, &V_off,   ""},
         {"nosf",      -1, &V_nosf,  ""},
         {"syncw",     -1, &V_syncw, ""},
+        {"writev",    -1, &V_aiowv, ""},
         {"limit",      0, &V_limit, "async limit"},
         {"segsize", 4096, &V_segsz, "async segsize"},
         {"maxsegs",    0, &V_msegs, "async maxsegs"},
@@ -688,6 +708,7 @@ int XrdXrootdProtocol::xasync(XrdOucStream &Config)
    if (V_syncw > 0) as_syncw     = 1;
    if (V_nosf  > 0) as_nosf      = 1;
    if (V_minsf > 0) as_minsfsz   = V_minsf;
+   if (V_aiowv > 0) as_aiowv     = 1;
 
    return 0;
 }
@@ -777,6 +798,56 @@ int XrdXrootdProtocol::xcksum(XrdOucStream &Config)
    return 0;
 }
   
+/******************************************************************************/
+/*                                  x c m p                                   */
+/******************************************************************************/
+
+/* Function: xcmp
+
+   Purpose:  To parse the directive: compress [level <n>] [min <sz>] | off
+
+             level <n>  The zlib compression level, 1 (fastest, the default)
+                        to 9, used for kXR_read and kXR_readv responses to
+                        clients asking for compressed responses.
+             min   <sz> Responses smaller than <sz> are sent uncompressed.
+                        The default is 4k.
+             off        Disables compression, the default.
+
+   Output: 0 upon success or 1 upon failure.
+*/
+
+int XrdXrootdProtocol::xcmp(XrdOucStream &Config)
+{
+   long long llp;
+   int lvl = 1, minsz = cmp_minsz;
+   char *val;
+
+   while((val = Config.GetWord()))
+        {     if (!strcmp("off", val)) lvl = 0;
+         else if (!strcmp("level", val))
+                 {if (!(val = Config.GetWord()))
+                     {eDest.Emsg("Config", "compress level not specified");
+                      return 1;
+                     }
+                  if (XrdOuca2x::a2i(eDest, "compress level", val, &lvl, 1, 9))
+                     return 1;
+                 }
+         else if (!strcmp("min", val))
+                 {if (!(val = Config.GetWord()))
+                     {eDest.Emsg("Config", "compress min value not specified");
+                      return 1;
+                     }
+                  if (XrdOuca2x::a2sz(eDest, "compress min", val, &llp, 0,
+                                      1048576)) return 1;
+                  minsz = static_cast<int>(llp);
+                 }
+         else {eDest.Emsg("Config", "invalid compress option -", val); return 1;}
+        }
+
+   cmp_level = lvl; cmp_minsz = minsz;
+   return 0;
+}
+
 /******************************************************************************/
 /*                                  x d i g                                   */
 /******************************************************************************/
@@ -1698,3 +1769,268 @@ int XrdXrootdProtocol::xlimit(XrdOucStream &Config)
    if (plimit >= 0) {PrepareLimit = plimit;}
    return 0;
 }
+
+/******************************************************************************/
+/*                              x l a t e n c y                               */
+/******************************************************************************/
+
+/* Function: xlatency
+
+   Purpose:  To parse the directive: latency {off | sample <n>}
+
+             off             Do not record request latencies.
+             sample <n>      Record the latency of one out of every <n>
+                             requests on each connection. The default is 1.
+
+   Output: 0 upon success or 1 upon failure.
+*/
+int XrdXrootdProtocol::xlatency(XrdOucStream &Config)
+{
+   int smpl;
+   char *val;
+
+   if (!(val = Config.GetWord()))
+      {eDest.Emsg("Config", "latency parameter not specified"); return 1;}
+
+   if (!strcmp("off", val)) {lat_smpl = 0; return 0;}
+
+   if (strcmp("sample", val))
+      {eDest.Emsg("Config", "invalid latency option -", val); return 1;}
+
+   if (!(val = Config.GetWord()))
+      {eDest.Emsg("Config", "latency sample value not specified"); return 1;}
+   if (XrdOuca2x::a2i(eDest, "latency sample", val, &smpl, 1)) return 1;
+
+   lat_smpl = smpl;
+   return 0;
+}
+
+/******************************************************************************/
+/*                                x r e a d v                                 */
+/******************************************************************************/
+
+/* Function: xreadv
+
+   Purpose:  To parse the directive: readv [gap <gsz>] [span <ssz>] [off]
+
+             gap  <gsz>      Merge readv segments that are no more than <gsz>
+                             bytes apart into a single read. Specifying a gap
+                             enables merging which is off by default.
+             span <ssz>      The maximum number of bytes a merged read may
+                             cover. The default is 1m.
+             off             Disables merging of readv segments.
+
+   Output: 0 upon success or 1 upon failure.
+*/
+int XrdXrootdProtocol::xreadv(XrdOucStream &Config)
+{
+   long long llp;
+   int rvgap = rv_gap, rvspan = rv_span;
+   char *val;
+
+   if (!(val = Config.GetWord()))
+      {eDest.Emsg("Config", "readv parameter not specified"); return 1;}
+
+   while(val)
+        {     if (!strcmp("off", val)) rvgap = -1;
+         else if (!strcmp("gap", val))
+                 {if (!(val = Config.GetWord()))
+                     {eDest.Emsg("Config", "readv gap value not specified");
+                      return 1;
+                     }
+                  if (XrdOuca2x::a2sz(eDest,"readv gap",val,&llp,0,1048576))
+                     return 1;
+                  rvgap = static_cast<int>(llp);
+                 }
+         else if (!strcmp("span", val))
+                 {if (!(val = Config.GetWord()))
+                     {eDest.Emsg("Config", "readv span value not specified");
+                      return 1;
+                     }
+                  if (XrdOuca2x::a2sz(eDest,"readv span",val,&llp,4096,
+                                      maxTransz)) return 1;
+                  rvspan = static_cast<int>(llp);
+                 }
+         else {eDest.Emsg("Config", "invalid readv option -", val); return 1;}
+         val = Config.GetWord();
+        }
+
+   rv_gap = rvgap; rv_span = rvspan;
+   return 0;
+}
+
+/******************************************************************************/
+/*                                x s p a n s                                 */
+/******************************************************************************/
+
+/* Function: xspans
+
+   Purpose:  To parse the directive: spans {off | [export <dest>] [sample <n>]}
+
+             off             Do not record spans (the default).
+             export <dest>   Where spans are sent, one line of JSON each:
+                             udp://<host>:<port> or the path of a file to
+                             append them to. Spans are also reported as
+                             monitoring info records when those are enabled.
+             sample <n>      Start a trace for one out of every <n> files
+                             opened without one. The default is 0, only
+                             files the client opened as part of a trace
+                             (xrd.traceparent CGI element) are traced.
+
+             The spans of a traced file time its reads; sendfile and async
+             reads are timed through their dispatch only.
+
+   Output: 0 upon success or 1 upon failure.
+*/
+int XrdXrootdProtocol::xspans(XrdOucStream &Config)
+{
+   int smpl = 0;
+   char *val, *dest = 0;
+
+   if (!(val = Config.GetWord()))
+      {eDest.Emsg("Config", "spans parameter not specified"); return 1;}
+
+   if (!strcmp("off", val)) {spanOn = false; return 0;}
+
+   while(val)
+        {     if (!strcmp("export", val))
+                 {if (!(val = Config.GetWord()))
+                     {eDest.Emsg("Config", "spans export destination not "
+                                           "specified");
+                      return 1;
+                     }
+                  if (dest) free(dest);
+                  dest = strdup(val);
+                 }
+         else if (!strcmp("sample", val))
+                 {if (!(val = Config.GetWord()))
+                     {eDest.Emsg("Config", "spans sample value not specified");
+                      if (dest) free(dest);
+                      return 1;
+                     }
+                  if (XrdOuca2x::a2i(eDest, "spans sample", val, &smpl, 0))
+                     {if (dest) free(dest); return 1;}
+                 }
+         else {eDest.Emsg("Config", "invalid spans option -", val);
+               if (dest) free(dest);
+               return 1;
+              }
+         val = Config.GetWord();
+        }
+
+   if (dest)
+      {bool aOK = XrdOucTraceCtx::Export(dest);
+       if (!aOK) eDest.Emsg("Config", errno, "export spans to", dest);
+       free(dest);
+       if (!aOK) return 1;
+      }
+
+   XrdOucTraceCtx::SetSample(smpl);
+   spanOn = true;
+   return 0;
+}
+  
+/******************************************************************************/
+/*                                 x s t r m                                  */
+/******************************************************************************/
+
+/* Function: xstrm
+
+   Purpose:  To parse the directive: streams [lan <n>] [wan <n>]
+
+             lan <n>  The number of parallel data substreams suggested to
+                      clients connecting from a private network address.
+             wan <n>  The number of parallel data substreams suggested to
+                      clients connecting from a public network address.
+
+             The suggestion is returned in the kXR_protocol response and
+             clients may bind that many substreams for large reads. The
+             default is 0 (no suggestion) and the maximum is 15.
+
+   Output: 0 upon success or 1 upon failure.
+*/
+int XrdXrootdProtocol::xstrm(XrdOucStream &Config)
+{
+   int lanN = strm_lan, wanN = strm_wan, *nP;
+   char *val;
+
+   if (!(val = Config.GetWord()))
+      {eDest.Emsg("Config", "streams parameter not specified"); return 1;}
+
+   while(val)
+        {     if (!strcmp("lan", val)) nP = &lanN;
+         else if (!strcmp("wan", val)) nP = &wanN;
+         else {eDest.Emsg("Config", "invalid streams option -", val); return 1;}
+         if (!(val = Config.GetWord()))
+            {eDest.Emsg("Config", "streams value not specified"); return 1;}
+         if (XrdOuca2x::a2i(eDest, "streams value", val, nP, 0,
+                            maxStreams-1)) return 1;
+         val = Config.GetWord();
+        }
+
+   strm_lan = lanN; strm_wan = wanN;
+   return 0;
+}
+  
+/******************************************************************************/
+/*                                 x i d l e                                  */
+/******************************************************************************/
+
+/* Function: xidle
+
+   Purpose:  To parse the directive: idlemem {<tm> | off}
+
+             <tm>     The number of seconds a link may stay idle before the
+                      request buffers it holds are returned to the buffer
+                      pool. They are reobtained on the next request.
+             off      Never release buffers (the default).
+
+   Output: 0 upon success or 1 upon failure.
+*/
+int XrdXrootdProtocol::xidle(XrdOucStream &Config)
+{
+   int itm;
+   char *val;
+
+   if (!(val = Config.GetWord()))
+      {eDest.Emsg("Config", "idlemem time not specified"); return 1;}
+
+   if (!strcmp(val, "off")) itm = 0;
+      else if (XrdOuca2x::a2tm(eDest,"idlemem time",val,&itm,1)) return 1;
+
+   idle_rel = itm;
+   return 0;
+}
+
+/******************************************************************************/
+/*                                  x r d a                                   */
+/******************************************************************************/
+
+/* Function: xrda
+
+   Purpose:  To parse the directive: reqahead {<sz> | off}
+
+             <sz>     The size of the per link buffer that request headers and
+                      arguments are read into. Whatever the client has already
+                      sent, up to <sz> bytes, is read with a single recv() so
+                      that pipelined requests are handled without going back
+                      to the poller. The maximum is 64k.
+             off      Read each request piece separately (the default).
+
+   Output: 0 upon success or 1 upon failure.
+*/
+int XrdXrootdProtocol::xrda(XrdOucStream &Config)
+{
+   long long rsz;
+   char *val;
+
+   if (!(val = Config.GetWord()))
+      {eDest.Emsg("Config", "reqahead size not specified"); return 1;}
+
+   if (!strcmp(val, "off")) rsz = 0;
+      else if (XrdOuca2x::a2sz(eDest,"reqahead size",val,&rsz,
+                               sizeof(ClientRequest), 65536)) return 1;
+
+   rda_size = static_cast<int>(rsz);
+   return 0;
+}
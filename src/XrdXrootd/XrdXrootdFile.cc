@@ -35,6 +35,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
   
+#include "XrdOuc/XrdOucTraceCtx.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
@@ -63,12 +64,6 @@ extern XrdOucTrace      *XrdXrootdTrace;
 namespace
 {
              XrdSysError   *eDest;
-
-static const unsigned long  heldSpotV = 1UL;;
-
-static       XrdXrootdFile *heldSpotP = (XrdXrootdFile *)1;
-
-static const unsigned long  heldMask = ~1UL;
 }
 
 /******************************************************************************/
@@ -92,6 +87,7 @@ XrdXrootdFile::XrdXrootdFile(const char *id, const char *path, XrdSfsFile *fp,
     AsyncMode= (async ? 1 : 0);
     fhProc   = 0;
     ID       = id;
+    traceCtx = 0;
 
     Stats.Init();
 
@@ -146,6 +142,8 @@ XrdXrootdFile::~XrdXrootdFile()
    if (fhProc) fhProc->Avail(fHandle);
 
    if (FileKey) free(FileKey);
+
+   if (traceCtx) delete traceCtx;
 }
 
 /******************************************************************************/
@@ -157,22 +155,19 @@ XrdXrootdFile::~XrdXrootdFile()
   
 int XrdXrootdFileTable::Add(XrdXrootdFile *fp)
 {
-   const int allocsz = XRD_FTABSIZE*sizeof(fp);
-   XrdXrootdFile **newXTab, **oldXTab;
+   XrdXrootdFTSlot *sP;
    int i;
 
 // If we have a file handle processor, see if it can give us a file handle
-// that's already in our table.
+// that's already in our table. The slot gets a new generation as the handle
+// now refers to a different file.
 //
    if (fhProc && (i = fhProc->Get()) >= 0) 
-      {XrdXrootdFile **fP;
-       if (i < XRD_FTABSIZE)   fP = &FTab[i];
-          else {i -= XRD_FTABSIZE;
-                if (XTab && i < XTnum) fP = &XTab[i];
-                   else fP = 0;
-               }
-       if (fP && *fP == heldSpotP)
-          {*fP = fp;
+      {if ((sP = Slot(i)) && sP->Next == slotHeld)
+          {sP->fileP = fp;
+           sP->Gen   = (sP->Gen + 1) & genMask;
+           sP->Next  = slotInUse;
+           i = Handle(i & slotMask, sP->Gen);
            TRACEI(FS, "reusing fh " <<i <<" for " <<fp->FileKey);
            return i;
           }
@@ -181,89 +176,104 @@ int XrdXrootdFileTable::Add(XrdXrootdFile *fp)
        eDest->Emsg("FTab_Add", "Invalid recycled fHandle",fhn,"ignored.");
       }
 
-// Find a free spot in the internal table
+// Take the first free slot, adding slots if we have run out
 //
-   for (i = FTfree; i < XRD_FTABSIZE; i++) if (!FTab[i]) break;
-
-   if (i < XRD_FTABSIZE)
-      {FTab[i] = fp; FTfree = i+1; return i;}
+   if (freeSlot < 0 && !Extend()) return -1;
+   i  = freeSlot;
+   sP = &Chunk[i >> chunkBits][i & chunkMask];
+   freeSlot  = sP->Next;
+   sP->fileP = fp;
+   sP->Next  = slotInUse;
+   return Handle(i, sP->Gen);
+}
+ 
+/******************************************************************************/
+/*                                   D e l                                    */
+/******************************************************************************/
+  
+XrdXrootdFile *XrdXrootdFileTable::Del(XrdXrootdMonitor *monP, int fnum,
+                                       bool dodel)
+{
+   XrdXrootdFTSlot *sP;
+   XrdXrootdFile *fp;
 
-// Allocate an external table if we do not have one
+// Find the slot and make sure the handle is still valid
 //
-   if (!XTab)
-      {if (!(XTab = (XrdXrootdFile **)malloc(allocsz))) return -1;
-       memset((void *)XTab, 0, allocsz);
-       XTnum   = XRD_FTABSIZE;
-       XTfree  = 1;
-       XTab[0] = fp;
-       return XRD_FTABSIZE;
-      }
+   if (!(sP = Slot(fnum)) || !(fp = sP->fileP)) return 0;
 
-// Find a free spot in the external table
+// Either free the slot or hold it until the file is actually closed. A freed
+// slot gets a new generation so that the old handle is no longer valid.
 //
-   for (i = XTfree; i < XTnum; i++) if (!XTab[i]) break;
-   if (i < XTnum)
-      {XTab[i] = fp; XTfree = i+1; return i+XRD_FTABSIZE;}
-
-// Extend the table
+   sP->fileP = 0;
+   if (dodel)
+      {sP->Gen  = (sP->Gen + 1) & genMask;
+       sP->Next = freeSlot;
+       freeSlot = fnum & slotMask;
+      } else sP->Next = slotHeld;
+
+// Finish up
 //
-   if (!(newXTab = (XrdXrootdFile **)malloc(XTnum*sizeof(XrdXrootdFile *)+allocsz)))
-      return -1;
-   memcpy((void *)newXTab, (const void *)XTab, XTnum*sizeof(XrdXrootdFile *));
-   memset((void *)(newXTab+XTnum), 0, allocsz);
-   oldXTab = XTab;
-   XTab = newXTab;
-   XTab[XTnum] = fp;
-   i = XTnum;
-   XTfree = XTnum+1;
-   XTnum += XRD_FTABSIZE;
-   free(oldXTab);
-   return i+XRD_FTABSIZE;
+   XrdXrootdFileStats &Stats = fp->Stats;
+
+   if (monP) monP->Close(Stats.FileID,
+                         Stats.xfr.read + Stats.xfr.readv,
+                         Stats.xfr.write);
+   if (Stats.MonEnt != -1) XrdXrootdMonFile::Close(&Stats, false);
+   if (dodel) {delete fp; fp = 0;}  // Will do the close
+      else {if (!fhProc) fhProc = new XrdXrootdFileHP;
+               else fhProc->Ref();
+            fp->fHandle = fnum;
+            fp->fhProc  = fhProc;
+            TRACEI(FS, "defer fh " <<fnum <<" del for " <<fp->FileKey);
+           }
+   return fp;
 }
- 
+
 /******************************************************************************/
-/*                                   D e l                                    */
+/* Private                        E x t e n d                                 */
 /******************************************************************************/
   
-XrdXrootdFile *XrdXrootdFileTable::Del(XrdXrootdMonitor *monP, int fnum,
-                                       bool dodel)
+bool XrdXrootdFileTable::Extend()
 {
-   union {XrdXrootdFile *fp; unsigned long fv;};
-   XrdXrootdFile *repVal = (dodel ? 0 : heldSpotP);
-   int  fh = fnum;
-
-   if (fnum < XRD_FTABSIZE) 
-      {fp = FTab[fnum];
-       FTab[fnum] = repVal;
-       if (fnum < FTfree) FTfree = fnum;
-      } else {
-       fnum -= XRD_FTABSIZE;
-       if (XTab && fnum < XTnum)
-          {fp = XTab[fnum];
-           XTab[fnum] = repVal;
-           if (fnum < XTfree) XTfree = fnum;
-          }
-           else fp = 0;
-      }
+   XrdXrootdFTSlot *cP;
+   void *mP;
+   int i;
 
-   fv &= heldMask;
-
-   if (fp)
-      {XrdXrootdFileStats &Stats = fp->Stats;
-
-       if (monP) monP->Close(Stats.FileID,
-                             Stats.xfr.read + Stats.xfr.readv,
-                             Stats.xfr.write);
-       if (Stats.MonEnt != -1) XrdXrootdMonFile::Close(&Stats, false);
-       if (dodel) {delete fp; fp = 0;}  // Will do the close
-          else {if (!fhProc) fhProc = new XrdXrootdFileHP;
-                   else fhProc->Ref();
-                fp->fHandle = fh;
-                fp->fhProc  = fhProc;
-                TRACEI(FS, "defer fh " <<fh <<" del for " <<fp->FileKey);
-               }
+// Check if we can have more slots
+//
+   if (slotNum + chunkSize > slotMask + 1) return false;
+
+// Extend the chunk table if it is full. Chunks themselves never move.
+//
+   if (chunkNum >= chunkMax)
+      {int newMax = (chunkMax ? chunkMax*2 : 4);
+       XrdXrootdFTSlot **newTab = (XrdXrootdFTSlot **)
+                                  realloc(Chunk, newMax*sizeof(cP));
+       if (!newTab) return false;
+       Chunk = newTab; chunkMax = newMax;
       }
-   return fp;
+
+// Allocate a chunk of slots aligned on a cache line
+//
+   if (posix_memalign(&mP, 64, chunkSize*sizeof(XrdXrootdFTSlot)))
+      return false;
+   cP = (XrdXrootdFTSlot *)mP;
+
+// Initialize the slots and chain them onto the free list
+//
+   for (i = 0; i < chunkSize; i++)
+       {cP[i].fileP = 0;
+        cP[i].Gen   = 0;
+        cP[i].Next  = slotNum + i + 1;
+       }
+   cP[chunkSize-1].Next = freeSlot;
+   freeSlot = slotNum;
+
+// Add the chunk to the table
+//
+   Chunk[chunkNum++] = cP;
+   slotNum += chunkSize;
+   return true;
 }
 
 /******************************************************************************/
@@ -276,36 +286,25 @@ XrdXrootdFile *XrdXrootdFileTable::Del(XrdXrootdMonitor *monP, int fnum,
 //
 void XrdXrootdFileTable::Recycle(XrdXrootdMonitor *monP)
 {
-   int i;
+   XrdXrootdFile *fP;
+   int i, j;
 
-// Delete all objects from the internal table (see warning)
+// Delete all objects from the table (see warning)
 //
-   FTfree = 0;
-   for (i = 0; i < XRD_FTABSIZE; i++)
-       if (FTab[i] && FTab[i] != heldSpotP)
-          {XrdXrootdFileStats &Stats = FTab[i]->Stats;
-           if (monP) monP->Close(Stats.FileID,
-                                 Stats.xfr.read+Stats.xfr.readv,
-                                 Stats.xfr.write);
-           if (Stats.MonEnt != -1) XrdXrootdMonFile::Close(&Stats, true);
-           delete FTab[i]; FTab[i] = 0;
-          }
-
-// Delete all objects from the external table (see warning)
-//
-if (XTab)
-  {for (i = 0; i < XTnum; i++)
-      {if (XTab[i] && XTab[i] != heldSpotP)
-          {XrdXrootdFileStats &Stats = XTab[i]->Stats;
-           if (monP) monP->Close(Stats.FileID,
-                                 Stats.xfr.read+Stats.xfr.readv,
-                                 Stats.xfr.write);
-           if (Stats.MonEnt != -1) XrdXrootdMonFile::Close(&Stats, true);
-           delete XTab[i];
-          }
+   for (i = 0; i < chunkNum; i++)
+       {for (j = 0; j < chunkSize; j++)
+            {if (!(fP = Chunk[i][j].fileP)) continue;
+             XrdXrootdFileStats &Stats = fP->Stats;
+             if (monP) monP->Close(Stats.FileID,
+                                   Stats.xfr.read+Stats.xfr.readv,
+                                   Stats.xfr.write);
+             if (Stats.MonEnt != -1) XrdXrootdMonFile::Close(&Stats, true);
+             delete fP;
+            }
+        free(Chunk[i]);
        }
-   free(XTab); XTab = 0; XTnum = 0; XTfree = 0;
-  }
+   if (Chunk) free(Chunk);
+   Chunk = 0; chunkNum = chunkMax = slotNum = 0; freeSlot = -1;
 
 // If we have a filehandle processor, delete it. Note that it will stay alive
 // until all requests for file handles against it are resolved.
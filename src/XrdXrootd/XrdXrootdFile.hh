@@ -90,6 +90,7 @@ bool             noMore;
 /*                         X r d X r o o t d F i l e                          */
 /******************************************************************************/
 
+class XrdOucTraceCtx;
 class XrdSfsFile;
 class XrdXrootdFileLock;
 class XrdXrootdMonitor;
@@ -113,6 +114,7 @@ union {int         fdNum;        // File descriptor number if regular file
       };
 XrdXrootdFileHP   *fhProc;       // File handle processor (set at close time)
 const char        *ID;           // File user
+XrdOucTraceCtx    *traceCtx;     // Trace context if the file is traced
 
 XrdXrootdFileStats Stats;        // File access statistics
 
@@ -134,12 +136,18 @@ static const char        *TraceID;
 /*                    X r d X r o o t d F i l e T a b l e                     */
 /******************************************************************************/
 
-// The before define the structure of the file table. We will have FTABSIZE
-// internal table entries. We will then provide an external linear table
-// that increases by FTABSIZE entries. There is one file table per link and
-// it is owned by the base protocol object.
+// A file handle is made up of the slot number in the file table and the
+// generation of the slot. The generation changes each time the slot is freed
+// so that a handle to a closed file never refers to a file subsequently opened
+// in the same slot. Slots are allocated in cache line aligned chunks that never
+// move once allocated and free slots are kept on a list. There is one file
+// table per link and it is owned by the base protocol object.
 //
-#define XRD_FTABSIZE   16
+struct XrdXrootdFTSlot
+      {XrdXrootdFile *fileP;     // The file or nil if free or held
+       unsigned int   Gen;       // Current generation of this slot
+       int            Next;      // Next free slot or one of the below
+      };
   
 // WARNING! Manipulation (i.e., Add/Del/delete) of this object must be
 //          externally serialized at the link level. Only one thread
@@ -154,34 +162,54 @@ public:
        XrdXrootdFile *Del(XrdXrootdMonitor *monP, int fnum, bool dodel=true);
 
 inline XrdXrootdFile *Get(int fnum)
-                         {if (fnum >= 0)
-                             {if (fnum < XRD_FTABSIZE) return FTab[fnum];
-                              if (XTab && (fnum-XRD_FTABSIZE)<XTnum)
-                                 return XTab[fnum-XRD_FTABSIZE];
-                             }
-                          return (XrdXrootdFile *)0;
+                         {XrdXrootdFTSlot *sP = Slot(fnum);
+                          return (sP ? sP->fileP : (XrdXrootdFile *)0);
                          }
 
        void           Recycle(XrdXrootdMonitor *monP);
 
-       XrdXrootdFileTable(unsigned int mid=0) : fhProc(0), FTfree(0), monID(mid),
-                                                XTab(0), XTnum(0), XTfree(0)
-                         {memset((void *)FTab, 0, sizeof(FTab));}
+       XrdXrootdFileTable(unsigned int mid=0) : fhProc(0), monID(mid),
+                                                Chunk(0), chunkNum(0),
+                                                chunkMax(0), slotNum(0),
+                                                freeSlot(-1) {}
 
 private:
 
       ~XrdXrootdFileTable() {} // Always use Recycle() to delete this object!
 
+static const int chunkBits = 6;                   // 64 slots per chunk
+static const int chunkSize = 1 << chunkBits;
+static const int chunkMask = chunkSize - 1;
+static const int slotBits  = 20;                  // At most 1M open files
+static const int slotMask  = (1 << slotBits) - 1;
+static const int genMask   = (1 << (31 - slotBits)) - 1;
+static const int slotInUse = -2;
+static const int slotHeld  = -3;
+
+bool               Extend();
+
+inline int         Handle(int sNum, unsigned int gen)
+                         {return static_cast<int>(gen << slotBits) | sNum;}
+
+inline XrdXrootdFTSlot *Slot(int fnum)
+                         {int sNum = fnum & slotMask;
+                          if (fnum < 0 || sNum >= slotNum) return 0;
+                          XrdXrootdFTSlot *sP =
+                                    &Chunk[sNum >> chunkBits][sNum & chunkMask];
+                          if (sP->Gen != static_cast<unsigned int>(fnum)
+                                         >> slotBits) return 0;
+                          return sP;
+                         }
+
 static const char *TraceID;
 static const char *ID;
 XrdXrootdFileHP   *fhProc;
+unsigned int       monID;
 
-XrdXrootdFile *FTab[XRD_FTABSIZE];
-int            FTfree;
-unsigned int   monID;
-
-XrdXrootdFile **XTab;
-int             XTnum;
-int             XTfree;
+XrdXrootdFTSlot  **Chunk;
+int                chunkNum;
+int                chunkMax;
+int                slotNum;
+int                freeSlot;
 };
 #endif
@@ -29,7 +29,7 @@
 
 #include <stdlib.h>
 
-#include "XrdOuc/XrdOucHash.hh"
+#include "XrdOuc/XrdOucOAHash.hh"
 
 #include "XrdXrootd/XrdXrootdFileLock1.hh"
  
@@ -67,7 +67,7 @@ XrdSysMutex *mp;
 /*                               G l o b a l s                                */
 /******************************************************************************/
   
-XrdOucHash<XrdXrootdFileLockInfo> XrdXrootdLockTable;
+XrdOucOAHash<XrdXrootdFileLockInfo> XrdXrootdLockTable;
 
 XrdSysMutex  XrdXrootdFileLock1::LTMutex;
 
@@ -30,6 +30,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdXrootd/XrdXrootdMonData.hh"
 
 class XrdXrootdFileStats
@@ -41,6 +42,8 @@ short               MonEnt;   // Set by mon: entry in reporting table or -1
 char                monLvl;   // Set by mon: level of data collection needed
 char                xfrXeq;   // Transfer has occurred
 long long           fSize;    // Size of file when opened
+unsigned long long *xfrDirt;  // Set by mon: where to flag I/O activity
+unsigned long long  xfrMask;  // Set by mon: the flag for this file
 XrdXrootdMonStatXFR xfr;
 XrdXrootdMonStatOPS ops;
 struct {double      read;     // sum(read_size[i] **2) i = 1 to Ops.read
@@ -53,6 +56,7 @@ enum monLevel {monOff = 0, monOn = 1, monOps = 2, monSsq = 3};
 
        void Init()
                 {FileID = 0; MonEnt = -1; monLvl = xfrXeq = 0;
+                 xfrDirt = 0; xfrMask = 0;
                  memset(&xfr, 0, sizeof(xfr));
                  memset(&ops, 0, sizeof(ops));
                  ops.rsMin = 0x7fff;
@@ -60,9 +64,14 @@ enum monLevel {monOff = 0, monOn = 1, monOps = 2, monSsq = 3};
                  ssq.read  = ssq.readv = ssq.write = ssq.rsegs = 0.0;
                 };
 
+inline void xfrSet()
+                 {xfrXeq = 1;
+                  if (xfrDirt) AtomicOr(*xfrDirt, xfrMask);
+                 }
+
 inline void rdOps(int rsz)
                  {if (monLvl)
-                     {xfr.read += rsz; ops.read++; xfrXeq = 1;
+                     {xfr.read += rsz; ops.read++; if (!xfrXeq) xfrSet();
                       if (monLvl > 1)
                          {if (rsz < ops.rdMin) ops.rdMin = rsz;
                           if (rsz > ops.rdMax) ops.rdMax = rsz;
@@ -75,7 +84,8 @@ inline void rdOps(int rsz)
 
 inline void rvOps(int rsz, int ssz)
                  {if (monLvl)
-                     {xfr.readv += rsz; ops.readv++; ops.rsegs += ssz; xfrXeq=1;
+                     {xfr.readv += rsz; ops.readv++; ops.rsegs += ssz;
+                      if (!xfrXeq) xfrSet();
                       if (monLvl > 1)
                          {if (rsz < ops.rvMin) ops.rvMin = rsz;
                           if (rsz > ops.rvMax) ops.rvMax = rsz;
@@ -93,7 +103,7 @@ inline void rvOps(int rsz, int ssz)
 
 inline void wrOps(int wsz)
                  {if (monLvl)
-                     {xfr.write += wsz; ops.write++; xfrXeq = 1;
+                     {xfr.write += wsz; ops.write++; if (!xfrXeq) xfrSet();
                       if (monLvl > 1)
                          {if (wsz < ops.wrMin) ops.wrMin = wsz;
                           if (wsz > ops.wrMax) ops.wrMax = wsz;
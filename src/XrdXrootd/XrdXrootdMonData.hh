@@ -100,6 +100,7 @@ const kXR_char XROOTD_MON_MAPINFO       = 'i';
 const kXR_char XROOTD_MON_MAPMIGR       = 'm'; // Internal use only!
 const kXR_char XROOTD_MON_MAPPURG       = 'p';
 const kXR_char XROOTD_MON_MAPREDR       = 'r';
+const kXR_char XROOTD_MON_MAPSPAN       = 'S'; // Span of a traced file
 const kXR_char XROOTD_MON_MAPSTAG       = 's'; // Internal use only!
 const kXR_char XROOTD_MON_MAPTRCE       = 't';
 const kXR_char XROOTD_MON_MAPUSER       = 'u';
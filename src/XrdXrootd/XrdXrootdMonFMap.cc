@@ -63,6 +63,19 @@ bool XrdXrootdMonFMap::Free(int slotNum)
    return true;
 }
 
+/******************************************************************************/
+/*                                   G e t                                    */
+/******************************************************************************/
+  
+XrdXrootdFileStats *XrdXrootdMonFMap::Get(int slotNum)
+{
+// Return the pointer if the slot is in use
+//
+   if (!fMap || slotNum < 0 || slotNum >= fmSize || fMap[slotNum].cVal & invVal)
+      return 0;
+   return fMap[slotNum].vPtr;
+}
+
 /******************************************************************************/
 /* Private:                         I n i t                                   */
 /******************************************************************************/
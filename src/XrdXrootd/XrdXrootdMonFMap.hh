@@ -30,6 +30,8 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <string.h>
+
 class XrdXrootdFileStats;
 
 class XrdXrootdMonFMap
@@ -46,14 +48,22 @@ static const int    fmSize = 512;
 static const int    fmHold = 31;
 static const int    fmMask = 0x01ff;
 static const int    fmShft = 9;
+static const int    dmSize = fmSize / 64;
+
+unsigned long long  dirty[dmSize]; // Slots having I/O since the last report
 
 bool                Free(int slotNum);
 
+XrdXrootdFileStats *Get(int slotNum);
+
 int                 Insert(XrdXrootdFileStats  *fsP);
 
 XrdXrootdFileStats *Next(int &slotNum);
 
-                    XrdXrootdMonFMap() : fMap(0) {free.cVal = 0;}
+                    XrdXrootdMonFMap() : fMap(0)
+                                       {free.cVal = 0;
+                                        memset(dirty, 0, sizeof(dirty));
+                                       }
                    ~XrdXrootdMonFMap() {}
 private:
 
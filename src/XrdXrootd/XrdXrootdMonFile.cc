@@ -99,6 +99,7 @@ void XrdXrootdMonFile::Close(XrdXrootdFileStats *fsP, bool isDisc)
        iSlot = iEnt &  XrdXrootdMonFMap::fmMask;
        fsP->MonEnt = -1;
        fmMutex.Lock();
+       fsP->xfrDirt = 0;
        if (fmMap[iMap].Free(iSlot)) fmUse[iMap]--;
        if (iMap == fmHWM) while(fmHWM >= 0 && !fmUse[fmHWM]) fmHWM--;
        fmMutex.UnLock();
@@ -249,7 +250,8 @@ void XrdXrootdMonFile::DoIt()
 void XrdXrootdMonFile::DoXFR()
 {
    XrdXrootdFileStats *fsP;
-   int keep, i, n, hwm;
+   unsigned long long dBits;
+   int i, j, n, hwm;
 
 // Reset interval counter
 //
@@ -261,24 +263,24 @@ void XrdXrootdMonFile::DoXFR()
    hwm = fmHWM;
    fmMutex.UnLock();
 
-// Report on all the files we have registered. This is a CPU burner as we
-// periodically drop the lock to allow open/close requests to come through.
+// Report on the files that had I/O since the last report. Each file flags
+// its first I/O after a report in its map's dirty bits, so we only need to
+// look at the flagged slots. We drop the lock after each group of 64 slots to
+// allow open/close requests to come through.
 //
    for (i = 0; i <= hwm; i++)
-       {fmMutex.Lock();
-        if (fmUse[i])
-           {n    = 0;
-            keep = XrdXrootdMonFMap::fmHold;
-            while((fsP = fmMap[i].Next(n)))
-                 {if (fsP->xfrXeq) DoXFR(fsP);
-                  if (!keep--)
-                     {fmMutex.UnLock();
-                      keep = XrdXrootdMonFMap::fmHold;
-                      fmMutex.Lock();
-                     }
-                 }
-           }
-        fmMutex.UnLock();
+       {if (!fmUse[i]) continue;
+        for (j = 0; j < XrdXrootdMonFMap::dmSize; j++)
+            {if (!fmMap[i].dirty[j]) continue;
+             fmMutex.Lock();
+             AtomicFZAP(dBits, fmMap[i].dirty[j]);
+             while(dBits)
+                  {n = __builtin_ctzll(dBits); dBits &= dBits - 1;
+                   if ((fsP = fmMap[i].Get(j*64 + n)) && fsP->xfrXeq)
+                      DoXFR(fsP);
+                  }
+             fmMutex.UnLock();
+            }
        }
 }
 
@@ -496,6 +498,10 @@ void XrdXrootdMonFile::Open(XrdXrootdFileStats *fsP, const char *Path,
    fsP->MonEnt = (sNum | (i << XrdXrootdMonFMap::fmShft)) & 0xffff;
    fsP->monLvl = fsLVL;
    fsP->xfrXeq = 0;
+   if (sNum >= 0)
+      {fsP->xfrDirt = &fmMap[i].dirty[sNum >> 6];
+       fsP->xfrMask = 1ULL << (sNum & 63);
+      }
 
 // Compute the size of this record
 //
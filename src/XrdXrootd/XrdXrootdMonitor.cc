@@ -34,6 +34,7 @@
 #include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #if !defined(__APPLE__) && !defined(__FreeBSD__)
 #include <malloc.h>
 #endif
@@ -43,6 +44,7 @@
 #include "XrdNet/XrdNetMsg.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucUtils.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 
@@ -74,6 +76,16 @@ XrdXrootdMonitor::MonRdrBuff
 XrdXrootdMonitor::MonRdrBuff
                   *XrdXrootdMonitor::rdrMP      = 0;
 XrdSysMutex        XrdXrootdMonitor::rdrMutex;
+XrdXrootdMonitor::MonSendQ
+                  *XrdXrootdMonitor::sendFirst  = 0;
+XrdXrootdMonitor::MonSendQ
+                  *XrdXrootdMonitor::sendLast   = 0;
+XrdXrootdMonitor::MonSendQ
+                  *XrdXrootdMonitor::sendFree   = 0;
+XrdSysMutex        XrdXrootdMonitor::sendQMutex;
+XrdSysMutex        XrdXrootdMonitor::sendMutex;
+int                XrdXrootdMonitor::sendQNum   = 0;
+bool               XrdXrootdMonitor::sendBusy   = false;
 int                XrdXrootdMonitor::monBlen    = 0;
 int                XrdXrootdMonitor::lastEnt    = 0;
 int                XrdXrootdMonitor::lastRnt    = 0;
@@ -181,6 +193,25 @@ XrdScheduler  *Sched;     // System scheduler
 int            Window;
 };
 
+/******************************************************************************/
+/*           C l a s s   X r d X r o o t d M o n i t o r _ S e n d            */
+/******************************************************************************/
+
+class XrdXrootdMonitor_Send : public XrdJob
+{
+public:
+
+void          DoIt() {XrdXrootdMonitor::SendQ();}
+
+      XrdXrootdMonitor_Send() : XrdJob("monitor sender") {}
+     ~XrdXrootdMonitor_Send() {}
+};
+
+namespace
+{
+XrdXrootdMonitor_Send sendJob;
+}
+
 /******************************************************************************/
 /*            C l a s s   X r d X r o o t d M o n i t o r L o c k             */
 /******************************************************************************/
@@ -905,9 +936,9 @@ void XrdXrootdMonitor::fillHeader(XrdXrootdMonHeader *hdr,
 
 // Generate a new sequence number
 //
-   seqMutex.Lock();
-   myseq = 0x00ff & (seq++);
-   seqMutex.UnLock();
+   AtomicBeg(seqMutex);
+   myseq = 0x00ff & AtomicInc(seq);
+   AtomicEnd(seqMutex);
 
 // Fill in the header
 //
@@ -948,12 +979,18 @@ void XrdXrootdMonitor::Flush()
    now = lastWindow + sizeWindow;
    setTMark(monBuff, nextEnt, now);
 
-// Send off the buffer and reinitialize it
-//
-   if (this != altMon) Send(XROOTD_MON_IO, (void *)monBuff, size);
-      else {Send(XROOTD_MON_FILE, (void *)monBuff, size);
-            FlushTime = localWindow + autoFlush;
-           }
+// Send off the buffer and reinitialize it. Normally, the buffer is queued for
+// the background sender and we continue with a fresh one. Otherwise, we must
+// send it ourselves.
+//
+   if (this != altMon)
+      {if (!Queue(XROOTD_MON_IO, size))
+          Send(XROOTD_MON_IO, (void *)monBuff, size);
+      } else {
+       if (!Queue(XROOTD_MON_FILE, size))
+          Send(XROOTD_MON_FILE, (void *)monBuff, size);
+       FlushTime = localWindow + autoFlush;
+      }
    setTMark(monBuff, 0, localWindow);
    nextEnt = 1;
 }
@@ -1041,6 +1078,52 @@ void XrdXrootdMonitor::Mark()
    lastWindow = localWindow;
 }
  
+/******************************************************************************/
+/*                                 Q u e u e                                  */
+/******************************************************************************/
+  
+bool XrdXrootdMonitor::Queue(int monMode, int size)
+{
+   MonSendQ *qP;
+
+// We can only queue buffers if we have a scheduler to run the sender
+//
+   if (!Sched) return false;
+
+// Get an idle queue element, allocating a new one if need be. Should the
+// sender be falling behind, the caller must send the buffer itself.
+//
+   sendQMutex.Lock();
+   if (sendQNum >= sendQMax) {sendQMutex.UnLock(); return false;}
+   if ((qP = sendFree)) sendFree = qP->Next;
+      else {if (!(qP = new MonSendQ)
+            ||  !(qP->Buff = (XrdXrootdMonBuff *)memalign(getpagesize(),monBlen)))
+               {if (qP) delete qP;
+                sendQMutex.UnLock();
+                return false;
+               }
+           }
+
+// Exchange our full buffer with the element's spare one and queue it
+//
+   XrdXrootdMonBuff *fullBuff = monBuff;
+   monBuff  = qP->Buff;
+   qP->Buff = fullBuff;
+   qP->Size = size;
+   qP->Mode = monMode;
+   qP->Next = 0;
+   if (sendLast) sendLast->Next = qP;
+      else sendFirst = qP;
+   sendLast = qP;
+   sendQNum++;
+
+// Get the sender going if it is not already running
+//
+   if (!sendBusy) {sendBusy = true; Sched->Schedule((XrdJob *)&sendJob);}
+   sendQMutex.UnLock();
+   return true;
+}
+
 /******************************************************************************/
 /*                                  S e n d                                   */
 /******************************************************************************/
@@ -1050,7 +1133,6 @@ int XrdXrootdMonitor::Send(int monMode, void *buff, int blen)
 #ifndef NODEBUG
     const char *TraceID = "Monitor";
 #endif
-    static XrdSysMutex sendMutex;
     int rc1, rc2;
 
     sendMutex.Lock();
@@ -1069,6 +1151,64 @@ int XrdXrootdMonitor::Send(int monMode, void *buff, int blen)
     return (rc1 ? rc1 : rc2);
 }
 
+/******************************************************************************/
+/*                                 S e n d Q                                  */
+/******************************************************************************/
+  
+void XrdXrootdMonitor::SendQ()
+{
+#ifndef NODEBUG
+   const char *TraceID = "Monitor";
+#endif
+   static const int sendBatch = 64;
+   MonSendQ *qP, *qList[sendBatch];
+   struct iovec iov1[sendBatch], iov2[sendBatch];
+   int i, n, n1, n2;
+
+// Take whatever has accumulated while the previous batch was being sent and
+// send it to each destination, in order, with as few system calls as we can.
+// The elements are then returned to the idle list where their buffers become
+// spares for the next filled buffers.
+//
+   sendQMutex.Lock();
+   while(sendFirst)
+        {for (n = 0; n < sendBatch && (qP = sendFirst); n++)
+             {if (!(sendFirst = qP->Next)) sendLast = 0;
+              qList[n] = qP;
+             }
+         sendQNum -= n;
+         sendQMutex.UnLock();
+
+         for (i = n1 = n2 = 0; i < n; i++)
+             {qP = qList[i];
+              if (qP->Mode & monMode1)
+                 {iov1[n1].iov_base = (void *)qP->Buff;
+                  iov1[n1++].iov_len = qP->Size;
+                 }
+              if (qP->Mode & monMode2)
+                 {iov2[n2].iov_base = (void *)qP->Buff;
+                  iov2[n2++].iov_len = qP->Size;
+                 }
+             }
+
+         sendMutex.Lock();
+         if (n1 && InetDest1)
+            {int rc = InetDest1->SendMany(iov1, n1);
+             TRACE(DEBUG,n1 <<" buffers sent to " <<Dest1 <<" rc=" <<rc);
+            }
+         if (n2 && InetDest2)
+            {int rc = InetDest2->SendMany(iov2, n2);
+             TRACE(DEBUG,n2 <<" buffers sent to " <<Dest2 <<" rc=" <<rc);
+            }
+         sendMutex.UnLock();
+
+         sendQMutex.Lock();
+         for (i = 0; i < n; i++) {qList[i]->Next = sendFree; sendFree = qList[i];}
+        }
+   sendBusy = false;
+   sendQMutex.UnLock();
+}
+
 /******************************************************************************/
 /*                            s t a r t C l o c k                             */
 /******************************************************************************/
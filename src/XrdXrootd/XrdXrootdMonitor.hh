@@ -63,6 +63,7 @@
 class XrdScheduler;
 class XrdNetMsg;
 class XrdXrootdMonFile;
+class XrdXrootdMonitor_Send;
   
 /******************************************************************************/
 /*                C l a s s   X r d X r o o t d M o n i t o r                 */
@@ -74,6 +75,7 @@ public:
        class User;
 friend class User;
 friend class XrdXrootdMonFile;
+friend class XrdXrootdMonitor_Send;
 
 // All values for Add_xx() must be passed in network byte order
 //
@@ -170,6 +172,11 @@ inline kXR_unt32   MapPath(const char *Path)
                                                         *this, Path);
                           }
 
+inline kXR_unt32   MapSpan(const char *Span)
+                          {return XrdXrootdMonitor::Map(XROOTD_MON_MAPSPAN,
+                                                        *this, Span);
+                          }
+
        void        Register(const char *Uname, const char *Hname,
                             const char *Pname);
 
@@ -203,6 +210,25 @@ struct MonRdrBuff
 static MonRdrBuff        *rdrMP;
 static XrdSysMutex        rdrMutex;
 
+// Full trace buffers are handed off to a background sender so that threads
+// filling them never wait on the network. Idle elements hold a spare buffer.
+//
+struct MonSendQ
+      {MonSendQ          *Next;
+       XrdXrootdMonBuff  *Buff;
+       int                Size;
+       int                Mode;
+      };
+
+static MonSendQ          *sendFirst;
+static MonSendQ          *sendLast;
+static MonSendQ          *sendFree;
+static XrdSysMutex        sendQMutex;
+static XrdSysMutex        sendMutex;     // Serializes sends to the collectors
+static int                sendQNum;
+static bool               sendBusy;
+static const int          sendQMax = 256;
+
 inline void              Add_io(kXR_unt32 duid, kXR_int32 blen, kXR_int64 offs)
                                {if (lastWindow != currWindow) Mark();
                                    else if (nextEnt == lastEnt) Flush();
@@ -222,7 +248,9 @@ static kXR_unt32         GetDictID();
 static kXR_unt32         Map(char  code, XrdXrootdMonitor::User &uInfo,
                              const char *path);
        void              Mark();
+       bool              Queue(int mmode, int size);
 static int               Send(int mmode, void *buff, int size);
+static void              SendQ();
 static void              startClock();
 static void              unAlloc(XrdXrootdMonitor *monp);
 
@@ -27,6 +27,8 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
  
+#include <time.h>
+
 #include "XrdVersion.hh"
 
 #include "XrdSfs/XrdSfsInterface.hh"
@@ -34,7 +36,9 @@
 #include "Xrd/XrdLink.hh"
 #include "XProtocol/XProtocol.hh"
 #include "XrdOuc/XrdOucStream.hh"
+#include "XrdOuc/XrdOucTraceCtx.hh"
 #include "XrdSec/XrdSecProtect.hh"
+#include "XrdSys/XrdSysProbe.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdXrootd/XrdXrootdAio.hh"
 #include "XrdXrootd/XrdXrootdFile.hh"
@@ -109,6 +113,19 @@ int                   XrdXrootdProtocol::as_force     = 0;
 int                   XrdXrootdProtocol::as_noaio     = 0;
 int                   XrdXrootdProtocol::as_nosf      = 0;
 int                   XrdXrootdProtocol::as_syncw     = 0;
+int                   XrdXrootdProtocol::as_aiowv     = 0;
+int                   XrdXrootdProtocol::rv_gap       = -1;
+int                   XrdXrootdProtocol::rv_span      = 1048576;
+int                   XrdXrootdProtocol::lat_smpl     = 1;
+bool                  XrdXrootdProtocol::spanOn       = false;
+int                   XrdXrootdProtocol::cmp_level    = 0;
+int                   XrdXrootdProtocol::cmp_minsz    = 4096;
+int                   XrdXrootdProtocol::strm_lan     = 0;
+int                   XrdXrootdProtocol::strm_wan     = 0;
+int                   XrdXrootdProtocol::idle_rel     = 0;
+int                   XrdXrootdProtocol::rda_size     = 0;
+XrdSysMutex           XrdXrootdProtocol::idleMutex;
+XrdXrootdProtocol    *XrdXrootdProtocol::idleFirst    = 0;
 
 const char           *XrdXrootdProtocol::myInst  = 0;
 const char           *XrdXrootdProtocol::TraceID = "Protocol";
@@ -194,6 +211,25 @@ int XrdgetProtocolPort(const char *pname, char *parms, XrdProtocol_Config *pi)
 }
 }
   
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+class XrdXrootdIdleJob : public XrdJob
+{
+public:
+
+void DoIt() {XrdXrootdProtocol::IdleScan();}
+
+     XrdXrootdIdleJob() : XrdJob("idle buffer release") {}
+    ~XrdXrootdIdleJob() {}
+};
+
+XrdXrootdIdleJob idleJob;
+}
+  
 /******************************************************************************/
 /*               X r d P r o t o c o l X r o o t d   C l a s s                */
 /******************************************************************************/
@@ -234,6 +270,60 @@ XrdXrootdProtocol XrdXrootdProtocol::operator =(const XrdXrootdProtocol &rhs)
    return *this;
 }
 
+/******************************************************************************/
+/*                              I d l e S c a n                               */
+/******************************************************************************/
+
+// Release the buffers held by links that have not been serviced for idle_rel
+// seconds. A link being serviced, waiting for the rest of a request or with
+// async I/O outstanding is left alone. The next request simply obtains new
+// buffers. Bound streams are skipped as they are driven by the main stream.
+//
+void XrdXrootdProtocol::IdleScan()
+{
+   XrdXrootdProtocol *pP;
+   time_t    now = time(0), idleBeg = now - idle_rel;
+   long long idleMem = 0, relMem = 0;
+   int       idleNum = 0, ival;
+
+   idleMutex.Lock();
+   for (pP = idleFirst; pP; pP = pP->idleNext)
+       {if (!pP->idleLock.CondLock()) continue;
+        if (!pP->inIO && !pP->Resume && pP->idleTime <= idleBeg
+        &&  pP->Status != XRD_BOUNDPATH && pP->Link->UseCnt() <= 1)
+           {if (pP->argp)
+               {relMem += pP->argp->bsize;
+                BPool->Release(pP->argp); pP->argp = 0;
+               }
+            if (pP->cmpBuff)
+               {relMem += pP->cmpBsz;
+                free(pP->cmpBuff); pP->cmpBuff = 0; pP->cmpBsz = 0;
+               }
+            if (pP->rdaBuff && pP->rdaBeg == pP->rdaEnd)
+               {relMem += rda_size;
+                free(pP->rdaBuff); pP->rdaBuff = 0;
+               }
+            idleNum++;
+            idleMem += sizeof(XrdLink) + sizeof(XrdXrootdProtocol);
+           }
+        pP->idleLock.UnLock();
+       }
+   idleMutex.UnLock();
+
+// Update the statistics
+//
+   SI->statsMutex.Lock();
+   SI->IdleNum  = idleNum;
+   SI->IdleMem  = idleMem;
+   SI->IdleRel += relMem;
+   SI->statsMutex.UnLock();
+
+// Reschedule ourselves
+//
+   ival = (idle_rel > 1 ? idle_rel/2 : 1);
+   Sched->Schedule((XrdJob *)&idleJob, now+ival);
+}
+  
 /******************************************************************************/
 /*                                 M a t c h                                  */
 /******************************************************************************/
@@ -262,6 +352,7 @@ static  struct hs_response
 
 XrdXrootdProtocol *xp;
 int dlen, rc;
+bool doCmp = false;
 
 // Peek at the first 20 bytes of data
 //
@@ -297,7 +388,9 @@ int dlen, rc;
         int rspLen;
         memcpy(&Request, hsRqst, sizeof(Request));
         memcpy(hsprot.Hdr.streamid,hsRqst->streamid,sizeof(hsprot.Hdr.streamid));
-        rspLen              = do_Protocol(&hsprot.Rsp);
+        rspLen              = do_Protocol(&hsprot.Rsp, lp);
+        doCmp               = cmp_level && hsRqst->clientpv
+                            && hsRqst->flags & kXR_wantcmp;
         hsprot.Hdr.dlen     = htonl(rspLen);
         hsprot.Hdr.status   = 0;
         iov[1].iov_len      = sizeof(hsprot.Hdr) + rspLen;
@@ -327,9 +420,27 @@ int dlen, rc;
    SI->Bump(SI->Count);
    xp->Link = lp;
    xp->Response.Set(lp);
+   xp->cmpResp = doCmp;
+   xp->rdaOn   = rda_size > 0;
    strcpy(xp->Entity.prot, "host");
    xp->Entity.host = (char *)lp->Host();
    xp->Entity.addrInfo = lp->AddrInfo();
+
+// Requests that do not block may be run by the poller thread if so configured
+//
+   lp->armInline();
+
+// Make the link a candidate for buffer release should it become idle
+//
+   if (idle_rel)
+      {xp->idleTime = time(0);
+       idleMutex.Lock();
+       if ((xp->idleNext = idleFirst)) idleFirst->idlePrev = xp;
+       xp->idlePrev = 0;
+       idleFirst = xp;
+       xp->idleOn = 1;
+       idleMutex.UnLock();
+      }
    return (XrdProtocol *)xp;
 }
  
@@ -341,14 +452,35 @@ int dlen, rc;
 #define TRACELINK Link
   
 int XrdXrootdProtocol::Process(XrdLink *lp) // We ignore the argument here
+{
+   int rc;
+
+// If this link may have its buffers released when idle, tell IdleScan() that
+// it is being serviced. Requests that were read ahead must be handled before
+// we return as the poller will not tell us about them again.
+//
+   if (idleOn) {idleLock.Lock(); inIO = 1; idleLock.UnLock();}
+   do {rc = ProcessIO();} while(!rc && rdaEnd > rdaBeg && !Resume);
+   if (idleOn)
+      {idleLock.Lock(); inIO = 0; idleTime = time(0); idleLock.UnLock();}
+   return rc;
+}
+
+/******************************************************************************/
+/*                     p r i v a t e   P r o c e s s I O                      */
+/******************************************************************************/
+  
+int XrdXrootdProtocol::ProcessIO()
 {
    int rc;
    kXR_unt16 reqID;
 
-// Check if we are servicing a slow link
+// Check if we are servicing a slow link. When running on the poller thread
+// the rest of the request is always left to a worker thread.
 //
    if (Resume)
-      {if (myBlen && (rc = getData("data", myBuff, myBlen)) != 0)
+      {if (Link->isInline()) {Link->Offload(); return 0;}
+       if (myBlen && (rc = getData("data", myBuff, myBlen)) != 0)
           {if (rc < 0 && myAioReq) myAioReq->Recycle(-1);
            return rc;
           }
@@ -375,6 +507,7 @@ int XrdXrootdProtocol::Process(XrdLink *lp) // We ignore the argument here
    Response.Set(Request.header.streamid);
    TRACEP(REQ, "req=" <<XProtocol::reqName(reqID)
                <<" dlen=" <<Request.header.dlen);
+   XrdSysProbe3(xrootd, request__arrive, this, reqID, Request.header.dlen);
 
 // Every request has an associated data length. It better be >= 0 or we won't
 // be able to know how much data to read.
@@ -405,6 +538,31 @@ int XrdXrootdProtocol::Process(XrdLink *lp) // We ignore the argument here
           {Resume = &XrdXrootdProtocol::Process2; return rc;}
       }
 
+// When running on the poller thread only do requests that should not block.
+// Everything else is resumed by a worker thread.
+//
+   if (Link->isInline())
+      {bool noBlock;
+       switch(reqID)
+             {case kXR_ping:
+              case kXR_protocol:
+              case kXR_stat:
+              case kXR_statx: noBlock = true;
+                              break;
+              case kXR_read:  noBlock = !Request.header.dlen
+                                      && ntohl(Request.read.rlen) <= maxInline;
+                              break;
+              default:        noBlock = false;
+                              break;
+             }
+       if (!noBlock)
+          {Link->Offload();
+           myBlen = 0;
+           Resume = &XrdXrootdProtocol::Process2;
+           return 0;
+          }
+      }
+
 // Continue with request processing at the resume point
 //
    return Process2();
@@ -415,6 +573,76 @@ int XrdXrootdProtocol::Process(XrdLink *lp) // We ignore the argument here
 /******************************************************************************/
   
 int XrdXrootdProtocol::Process2()
+{
+   struct timespec tBeg, tEnd;
+   long long spanBeg = 0;
+   int rc, reqID;
+
+// Process the request, timing a sample of them for the latency statistics.
+// The time covers the request's dispatch, which includes sending the response
+// for all but callback (async) and multi-buffer transfers. The same holds for
+// the reads of traced files, which the read functions mark in spanFile.
+//
+   reqID = Request.header.requestid;
+   XrdSysProbe2(xrootd, request__start, this, reqID);
+   if (spanOn) spanBeg = XrdOucTraceCtx::Now();
+   if (!lat_smpl || ++latCount < lat_smpl) rc = ProcReq();
+      else {latCount = 0;
+            clock_gettime(CLOCK_MONOTONIC, &tBeg);
+            rc = ProcReq();
+            clock_gettime(CLOCK_MONOTONIC, &tEnd);
+            SI->LatAdd(reqID, (tEnd.tv_sec  - tBeg.tv_sec) * 1000000LL
+                            + (tEnd.tv_nsec - tBeg.tv_nsec) / 1000);
+           }
+   if (spanFile) ReportSpan(reqID, spanBeg);
+   XrdSysProbe3(xrootd, request__done, this, reqID, rc);
+   return rc;
+}
+
+/******************************************************************************/
+/*                    p r i v a t e   R e p o r t S p a n                     */
+/******************************************************************************/
+  
+void XrdXrootdProtocol::ReportSpan(int reqID, long long tBeg)
+{
+   const char *name;
+   char attr[256], span[1024];
+   int n;
+
+// Report the read just processed for a traced file to the span exporter and,
+// if enabled, as an info record to the monitoring
+//
+   switch(reqID)
+         {case kXR_read:   name = "xrootd.read";   break;
+          case kXR_pgread: name = "xrootd.pgread"; break;
+          case kXR_readv:  name = "xrootd.readv";  break;
+          default:         spanFile = 0; return;
+         }
+
+   if (spanFsUs < 0)
+      snprintf(attr, sizeof(attr), "\"off\":%lld,\"len\":%d,\"user\":\"%s\"",
+               spanOff, spanLen, Link->ID);
+      else snprintf(attr, sizeof(attr), "\"off\":%lld,\"len\":%d,"
+                    "\"fs_us\":%lld,\"user\":\"%s\"",
+                    spanOff, spanLen, spanFsUs, Link->ID);
+
+   n = spanFile->traceCtx->SpanText(span, sizeof(span), name, tBeg,
+                                    XrdOucTraceCtx::Now() - tBeg, attr);
+   spanFile = 0;
+   if (!n) return;
+
+   XrdOucTraceCtx::Emit(span, n);
+   if (Monitor.Info())
+      {span[n-1] = '\0';
+       Monitor.MapSpan(span);
+      }
+}
+
+/******************************************************************************/
+/*                       p r i v a t e   P r o c R e q                        */
+/******************************************************************************/
+  
+int XrdXrootdProtocol::ProcReq()
 {
 // If we are verifying requests, see if this request needs to be verified
 //
@@ -461,6 +689,7 @@ int XrdXrootdProtocol::Process2()
 //
    switch(Request.header.requestid)   // First, the ones with file handles
          {case kXR_read:     return do_Read();
+          case kXR_pgread:   return do_PgRead();
           case kXR_readv:    return do_ReadV();
           case kXR_write:    return do_Write();
           case kXR_writev:   return do_WriteV();
@@ -604,6 +833,18 @@ void XrdXrootdProtocol::Recycle(XrdLink *lp, int csec, const char *reason)
    char *sfxp, ctbuff[24], buff[128], Flags = (reason ? XROOTD_MON_FORCED : 0);
    const char *What;
 
+// Take ourselves off the list of idle candidates
+//
+   if (idleOn)
+      {idleMutex.Lock();
+       if (idleNext) idleNext->idlePrev = idlePrev;
+       if (idlePrev) idlePrev->idleNext = idleNext;
+          else       idleFirst          = idleNext;
+       idleNext = idlePrev = 0;
+       idleOn = 0;
+       idleMutex.UnLock();
+      }
+
 // Check for disconnect or unbind
 //
    if (Status == XRD_BOUNDPATH) {What = "unbind"; Flags |= XROOTD_MON_BOUNDP;}
@@ -790,6 +1031,15 @@ void XrdXrootdProtocol::Cleanup()
 // Handle writev appendage
 //
    if (wvInfo) {free(wvInfo); wvInfo = 0;}
+
+// Handle compression buffer
+//
+   if (cmpBuff) {free(cmpBuff); cmpBuff = 0; cmpBsz = 0;}
+
+// Handle the read-ahead buffer
+//
+   if (rdaBuff) {free(rdaBuff); rdaBuff = 0;}
+   rdaBeg = rdaEnd = 0;
 }
   
 /******************************************************************************/
@@ -800,6 +1050,19 @@ int XrdXrootdProtocol::getData(const char *dtype, char *buff, int blen)
 {
    int rlen;
 
+// Small pieces (request headers and arguments) are taken from the read-ahead
+// buffer, which is refilled with as much as the socket has queued. This way
+// pipelined requests cost one recv() for several of them.
+//
+   if (rdaOn)
+      {if (blen <= rda_size) return getAhead(dtype, buff, blen);
+       if ((rlen = rdaEnd - rdaBeg))
+          {memcpy(buff, rdaBuff+rdaBeg, rlen);
+           rdaBeg = rdaEnd = 0;
+           buff += rlen; blen -= rlen;
+          }
+      }
+
 // Read the data but reschedule he link if we have not received all of the
 // data within the timeout interval.
 //
@@ -816,6 +1079,51 @@ int XrdXrootdProtocol::getData(const char *dtype, char *buff, int blen)
    return 0;
 }
 
+/******************************************************************************/
+/*                              g e t A h e a d                               */
+/******************************************************************************/
+
+// Either all of blen bytes are taken from the buffer or none at all, so that a
+// request header can be re-read from the start when the link was slow.
+//
+int XrdXrootdProtocol::getAhead(const char *dtype, char *buff, int blen)
+{
+   int rlen, have = rdaEnd - rdaBeg;
+
+// Serve the request from the buffer if we have it all
+//
+   if (have >= blen)
+      {memcpy(buff, rdaBuff+rdaBeg, blen);
+       if ((rdaBeg += blen) == rdaEnd) rdaBeg = rdaEnd = 0;
+       return 0;
+      }
+
+// Make sure we have a buffer and move any leftover to its front
+//
+   if (!rdaBuff && !(rdaBuff = (char *)malloc(rda_size)))
+      {rdaOn = false;
+       return getData(dtype, buff, blen);
+      }
+   if (rdaBeg) {memmove(rdaBuff, rdaBuff+rdaBeg, have); rdaBeg = 0; rdaEnd = have;}
+
+// Read at least what we are missing and whatever else is there
+//
+   rlen = Link->RecvAtLeast(rdaBuff+have, blen-have, rda_size-have, readWait);
+   if (rlen  < 0)
+      {if (rlen != -ENOMSG) return Link->setEtext("link read error");
+          else return -1;
+      }
+   rdaEnd += rlen;
+   if (rdaEnd < blen)
+      {myBuff = buff; myBlen = blen;
+       TRACEP(REQ, dtype <<" timeout; read " <<rdaEnd <<" of " <<blen <<" bytes");
+       return 1;
+      }
+   memcpy(buff, rdaBuff, blen);
+   if ((rdaBeg = blen) == rdaEnd) rdaBeg = rdaEnd = 0;
+   return 0;
+}
+
 /******************************************************************************/
 /*                                 R e s e t                                  */
 /******************************************************************************/
@@ -836,6 +1144,19 @@ void XrdXrootdProtocol::Reset()
    myAioReq           = 0;
    myFile             = 0;
    wvInfo             = 0;
+   inWrite            = 0;
+   idleNext           = 0;
+   idlePrev           = 0;
+   idleTime           = 0;
+   idleOn             = 0;
+   inIO               = 0;
+   cmpBuff            = 0;
+   cmpBsz             = 0;
+   cmpResp            = false;
+   rdaBuff            = 0;
+   rdaBeg             = 0;
+   rdaEnd             = 0;
+   rdaOn              = false;
    numReads           = 0;
    numReadP           = 0;
    numReadV           = 0;
@@ -872,4 +1193,6 @@ void XrdXrootdProtocol::Reset()
    Entity.Reset();
    memset(Stream,  0, sizeof(Stream));
    PrepareCount       = 0;
+   latCount           = 0;
+   spanFile           = 0;
 }
@@ -37,6 +37,7 @@
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSec/XrdSecInterface.hh"
 #include "XrdSfs/XrdSfsDio.hh"
+#include "XrdSfs/XrdSfsXio.hh"
 
 #include "Xrd/XrdObject.hh"
 #include "Xrd/XrdProtocol.hh"
@@ -67,6 +68,7 @@
 class XrdNetSocket;
 class XrdOucEnv;
 class XrdOucErrInfo;
+struct XrdOucIOVec;
 class XrdOucReqID;
 class XrdOucStream;
 class XrdOucTList;
@@ -75,6 +77,7 @@ class XrdOucTrace;
 class XrdSecProtect;
 class XrdSecProtector;
 class XrdSfsDirectory;
+class XrdSfsFile;
 class XrdSfsFileSystem;
 class XrdSecProtocol;
 class XrdBuffer;
@@ -90,7 +93,8 @@ class XrdXrootdStats;
 class XrdXrootdWVInfo;
 class XrdXrootdXPath;
 
-class XrdXrootdProtocol : public XrdProtocol, public XrdSfsDio
+class XrdXrootdProtocol : public XrdProtocol, public XrdSfsDio,
+                          public XrdSfsXio
 {
 friend class XrdXrootdAdmin;
 friend class XrdXrootdAioReq;
@@ -108,6 +112,10 @@ static int           Configure(char *parms, XrdProtocol_Config *pi);
 
        int           Process2();
 
+       int           ProcessIO();
+
+       int           ProcReq();
+
        int           ProcSig();
 
        void          Recycle(XrdLink *lp, int consec, const char *reason);
@@ -122,6 +130,12 @@ static int           Configure(char *parms, XrdProtocol_Config *pi);
 
 static int           StatGen(struct stat &buf, char *xxBuff);
 
+static void          IdleScan();
+
+       XioStatus     Swap(const char      * curBuff,
+                          XrdSfsXioHandle *&curHand,
+                          XrdSfsXioHandle * oldHand=0);
+
 //            XrdXrootdProtocol operator =(const XrdXrootdProtocol &rhs) = delete;
               XrdXrootdProtocol operator =(const XrdXrootdProtocol &rhs);
               XrdXrootdProtocol();
@@ -154,9 +168,11 @@ enum RD_func {RD_chmod = 0, RD_chksum,  RD_dirlist, RD_locate, RD_mkdir,
        int   do_Offload(int pathID, int isRead);
        int   do_OffloadIO();
        int   do_Open();
+       int   do_PgRead();
        int   do_Ping();
        int   do_Prepare();
-       int   do_Protocol(ServerResponseBody_Protocol *rsp=0);
+       int   do_Protocol(ServerResponseBody_Protocol *rsp=0,
+                         XrdLink *lp=0);
        int   do_Putfile();
        int   do_Qconf();
        int   do_Qfh();
@@ -166,7 +182,9 @@ enum RD_func {RD_chmod = 0, RD_chksum,  RD_dirlist, RD_locate, RD_mkdir,
        int   do_Qxattr();
        int   do_Read();
        int   do_ReadV();
+       int   do_ReadVsf(XrdOucIOVec *rdVec, int rdVecNum);
        int   do_ReadAll(int asyncOK=1);
+       int   do_ReadCmp();
        int   do_ReadNone(int &retc, int &pathID);
        int   do_Rm();
        int   do_Rmdir();
@@ -174,6 +192,7 @@ enum RD_func {RD_chmod = 0, RD_chksum,  RD_dirlist, RD_locate, RD_mkdir,
        int   do_Set_Mon(XrdOucTokenizer &setargs);
        int   do_Stat();
        int   do_Statx();
+       int   do_StatxFull();
        int   do_Sync();
        int   do_Truncate();
        int   do_Write();
@@ -181,6 +200,8 @@ enum RD_func {RD_chmod = 0, RD_chksum,  RD_dirlist, RD_locate, RD_mkdir,
        int   do_WriteCont();
        int   do_WriteNone();
        int   do_WriteV();
+       int   do_WriteVAio();
+       int   do_WriteVAioCont();
        int   do_WriteVec();
 
        int   aio_Error(const char *op, int ecode);
@@ -199,18 +220,24 @@ static int   ConfigSecurity(XrdOucEnv &xEnv, const char *cfn);
        int   fsOvrld(char opc, const char *Path, char *Cgi);
        int   fsRedirNoEnt(const char *eMsg, char *Cgi, int popt);
        int   getBuff(const int isRead, int Quantum);
+       int   getAhead(const char *dtype, char *buff, int blen);
        int   getData(const char *dtype, char *buff, int blen);
        void  logLogin(bool xauth=false);
 static int   mapMode(int mode);
+       bool  OpenClose(XrdXrootdFile *xp, int fhandle);
 static void  PidFile();
+       void  ReportSpan(int reqID, long long tBeg);
        void  Reset();
 static int   rpCheck(char *fn, char **opaque);
        int   rpEmsg(const char *op, char *fn);
+       int   rvRead(XrdSfsFile *fP, XrdOucIOVec *rdV, int rdN);
+       int   SendCmp(XResponseType rcode, char *data, int dlen);
        int   vpEmsg(const char *op, char *fn);
 static int   Squash(char *);
 static int   xapath(XrdOucStream &Config);
 static int   xasync(XrdOucStream &Config);
 static int   xcksum(XrdOucStream &Config);
+static int   xcmp(XrdOucStream &Config);
 static int   xdig(XrdOucStream &Config);
 static int   xexp(XrdOucStream &Config);
 static int   xexpdo(char *path, int popt=0);
@@ -228,6 +255,12 @@ static bool  xred_xok(int     func, char *rHost[2], int rPort[2]);
 static int   xsecl(XrdOucStream &Config);
 static int   xtrace(XrdOucStream &Config);
 static int   xlimit(XrdOucStream &Config);
+static int   xlatency(XrdOucStream &Config);
+static int   xspans(XrdOucStream &Config);
+static int   xreadv(XrdOucStream &Config);
+static int   xstrm(XrdOucStream &Config);
+static int   xidle(XrdOucStream &Config);
+static int   xrda(XrdOucStream &Config);
 
 static XrdObjectQ<XrdXrootdProtocol> ProtStack;
 XrdObject<XrdXrootdProtocol>         ProtLink;
@@ -306,9 +339,20 @@ static int                 as_force;     // aio to be forced
 static int                 as_noaio;     // aio is disabled
 static int                 as_nosf;      // sendfile is disabled
 static int                 as_syncw;     // writes to be synchronous
+static int                 as_aiowv;     // writev segments to use aio
 static int                 maxBuffsz;    // Maximum buffer size we can have
 static int                 maxTransz;    // Maximum transfer size we can have
 static const int           maxRvecsz = 1024;   // Maximum read vector size
+static int                 rv_gap;       // readv merge gap (-1 -> no merging)
+static int                 rv_span;      // readv maximum merged bytes
+static int                 lat_smpl;     // Time 1 of n requests (0 -> off)
+static bool                spanOn;       // Time the reads of traced files
+static int                 cmp_level;    // Read response compression level
+static int                 cmp_minsz;    // Smallest response to compress
+static int                 strm_lan;     // Substreams suggested to lan clients
+static int                 strm_wan;     // Substreams suggested to wan clients
+static int                 idle_rel;     // Release buffers after idle secs
+static int                 rda_size;     // Request read-ahead buffer size
 static const int           maxWvecsz = 1024;   // Maximum writ vector size
 
 // Statistical area
@@ -367,6 +411,13 @@ int                        myBlast;
 int                       (XrdXrootdProtocol::*Resume)();
 XrdXrootdFile             *myFile;
 XrdXrootdWVInfo           *wvInfo;
+char                      *cmpBuff;      // Compressed read response
+int                        cmpBsz;
+bool                       cmpResp;      // Compressed read responses wanted
+char                      *rdaBuff;      // Request bytes read ahead of need
+int                        rdaBeg;       // Offset of the first unused byte
+int                        rdaEnd;       // Offset past the last unused byte
+bool                       rdaOn;        // Read ahead on this link
 union {
 long long                  myOffset;
 long long                  myWVBytes;
@@ -383,6 +434,10 @@ static int                 hcMax;
        int                 hcNow;
        int                 halfBSize;
 
+// Largest read done by the poller thread in run-to-completion mode
+//
+static const unsigned int  maxInline = 65536;
+
 // This area is used for parallel streams
 //
 static const int           maxStreams = 16;
@@ -403,6 +458,19 @@ XrdXrootdPio              *pioFree;
 short                      PathID;
 char                       doWrite;
 char                       doWriteC;
+char                       inWrite;     // In XrdSfsFile::write() (see Swap())
+
+// Links idle for idle_rel seconds have their buffers released by IdleScan().
+// The lock is held while the fields below are changed and while releasing.
+//
+static XrdSysMutex         idleMutex;   // Protects the list of idle candidates
+static XrdXrootdProtocol  *idleFirst;
+XrdXrootdProtocol         *idleNext;
+XrdXrootdProtocol         *idlePrev;
+XrdSysMutex                idleLock;
+time_t                     idleTime;    // When we last serviced the link
+char                       idleOn;      // On the list of idle candidates
+char                       inIO;        // Servicing the link
 unsigned char              rvSeq;
 unsigned char              wvSeq;
 
@@ -413,6 +481,17 @@ static bool                LimitError;  // Indicates that hitting a limit should
 int                        PrepareCount;
 static int                 PrepareLimit;
 
+// Request latency sampling
+//
+int                        latCount;
+
+// Read of a traced file (see Process2)
+//
+XrdXrootdFile             *spanFile;
+long long                  spanOff;
+long long                  spanFsUs;
+int                        spanLen;
+
 // Buffers to handle client requests
 //
 XrdXrootdReqID             ReqID;
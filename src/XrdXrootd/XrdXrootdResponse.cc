@@ -319,6 +319,34 @@ int XrdXrootdResponse::Send(XrdOucSFVec *sfvec, int sfvnum, int dlen)
 
 /******************************************************************************/
 
+int XrdXrootdResponse::Send(XResponseType rcode, XrdOucSFVec *sfvec,
+                            int sfvnum, int dlen)
+{
+   if (rcode == kXR_ok) return Send(sfvec, sfvnum, dlen);
+
+   TRACES(RSP, "sendfile " <<dlen <<" data bytes; status=" <<rcode);
+
+// Partial sendfile responses are not supported by the bridge
+//
+   if (Bridge) return Link->setEtext("send failure");
+
+// We are only called should sendfile be enabled for this response
+//
+   Resp.status = static_cast<kXR_unt16>(htons(rcode));
+   Resp.dlen   = static_cast<kXR_int32>(htonl(dlen));
+   sfvec[0].buffer = (char *)&Resp;
+   sfvec[0].sendsz = sizeof(Resp);
+   sfvec[0].fdnum  = -1;
+
+// Send off the request
+//
+    if (Link->Send(sfvec, sfvnum) < 0)
+       return Link->setEtext("sendfile failure");
+    return 0;
+}
+
+/******************************************************************************/
+
 int XrdXrootdResponse::Send(XrdXrootdReqID &ReqID, 
                             XResponseType   Status,
                             struct iovec   *IOResp, 
@@ -62,6 +62,8 @@ const  char *ID() {return (const char *)trsid;}
        int   Send(XResponseType rcode, int info, const char *data, int dsz=-1);
        int   Send(int fdnum, long long offset, int dlen);
        int   Send(XrdOucSFVec *sfvec, int sfvnum, int dlen);
+       int   Send(XResponseType rcode, XrdOucSFVec *sfvec, int sfvnum,
+                  int dlen);
 static int   Send(XrdXrootdReqID &ReqID,  XResponseType Status,
                   struct iovec   *IOResp, int           iornum, int  iolen);
 
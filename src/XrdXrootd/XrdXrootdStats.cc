@@ -28,8 +28,13 @@
 /******************************************************************************/
  
 #include <stdio.h>
+#include <string.h>
+#include <netinet/in.h>
   
+#include "XProtocol/XProtocol.hh"
 #include "Xrd/XrdStats.hh"
+#include "XrdSys/XrdSysAtomics.hh"
+#include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
 #include "XrdXrootd/XrdXrootdResponse.hh"
 #include "XrdXrootd/XrdXrootdStats.hh"
@@ -72,6 +77,113 @@ AuthBad  = 0;     // Stats: Number of authentication failures
 aokSCnt  = 0;     // Stats: Number of signature successes
 badSCnt  = 0;     // Stats: Number of signature failures
 ignSCnt  = 0;     // Stats: Number of signature ignored
+IdleNum  = 0;     // Stats: Number of idle links (idlemem)
+IdleMem  = 0;     // Stats: Memory held by idle links
+IdleRel  = 0;     // Stats: Buffer bytes released from idle links
+
+memset(latHist, 0, sizeof(latHist));
+memset(latTotT, 0, sizeof(latTotT));
+}
+
+/******************************************************************************/
+/*                                L a t A d d                                 */
+/******************************************************************************/
+  
+void XrdXrootdStats::LatAdd(int reqid, long long usec)
+{
+   int op, bkt = LatBkt(usec);
+
+// Map the request to its latency class
+//
+   switch(reqid)
+         {case kXR_open:    op = latOpen;   break;
+          case kXR_read:
+          case kXR_pgread:  op = latRead;   break;
+          case kXR_readv:   op = latReadV;  break;
+          case kXR_write:   op = latWrite;  break;
+          case kXR_writev:  op = latWriteV; break;
+          case kXR_stat:
+          case kXR_statx:   op = latStat;   break;
+          case kXR_sync:    op = latSync;   break;
+          case kXR_close:   op = latClose;  break;
+          default:          op = latMisc;   break;
+         }
+
+// Record the latency
+//
+   AtomicBeg(statsMutex);
+   AtomicInc(latHist[op][bkt]);
+   AtomicAdd(latTotT[op], usec);
+   AtomicEnd(statsMutex);
+}
+
+/******************************************************************************/
+/*                                L a t G e t                                 */
+/******************************************************************************/
+
+// Copy out the bucket counts and the total latency in usec for a request
+// class. The histogram must have room for latBkts counts.
+//
+bool XrdXrootdStats::LatGet(int op, long long *hist, long long &usec)
+{
+   if (op < 0 || op >= latOps) return false;
+
+   statsMutex.Lock();
+   memcpy(hist, latHist[op], sizeof(latHist[op]));
+   usec = latTotT[op];
+   statsMutex.UnLock();
+   return true;
+}
+
+/******************************************************************************/
+/*                               L a t N a m e                                */
+/******************************************************************************/
+
+const char *XrdXrootdStats::LatName(int op)
+{
+   static const char *latName[latOps] = {"open", "rd", "rv", "wr", "wv",
+                                         "stat", "sync", "close", "misc"};
+
+   return (op >= 0 && op < latOps ? latName[op] : "?");
+}
+
+/******************************************************************************/
+/*                              L a t S t a t s                               */
+/******************************************************************************/
+
+// The binary form is "lat1" followed by the number of request classes and the
+// number of buckets per class as 4-byte integers and then, for each class, the
+// bucket counts as 8-byte integers. All values are in network byte order.
+// Buckets 0 through 3 hold latencies of exactly 0 through 3 usec and bucket
+// b > 3 covers [(4 + b%4) << (b/4 - 1), (5 + b%4) << (b/4 - 1)) usec.
+//
+int XrdXrootdStats::LatStats(char *buff, int blen)
+{
+   kXR_int32 iVal;
+   long long lVal;
+   int len = 12 + (latOps * latBkts * sizeof(long long));
+
+// Make sure the buffer is large enough
+//
+   if (blen < len) return 0;
+
+// Insert the header
+//
+   memcpy(buff, "lat1", 4);
+   iVal = htonl(latOps);  memcpy(buff+4, &iVal, sizeof(iVal));
+   iVal = htonl(latBkts); memcpy(buff+8, &iVal, sizeof(iVal));
+   buff += 12;
+
+// Insert each histogram
+//
+   statsMutex.Lock();
+   for (int i = 0; i < latOps; i++)
+       for (int j = 0; j < latBkts; j++)
+           {lVal = htonll(latHist[i][j]);
+            memcpy(buff, &lVal, sizeof(lVal)); buff += sizeof(lVal);
+           }
+   statsMutex.UnLock();
+   return len;
 }
 
 /******************************************************************************/
@@ -88,7 +200,10 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
    "<sig><ok>%d</ok><bad>%d</bad><ign>%d</ign></sig>"
    "<aio><num>%lld</num><max>%d</max><rej>%lld</rej></aio>"
    "<err>%d</err><rdr>%lld</rdr><dly>%d</dly>"
-   "<lgn><num>%d</num><af>%d</af><au>%d</au><ua>%d</ua></lgn></stats>";
+   "<lgn><num>%d</num><af>%d</af><au>%d</au><ua>%d</ua></lgn>"
+   "<idle><num>%d</num><mem>%lld</mem><rel>%lld</rel></idle>";
+   static const char latfmt[] = "<%s><n>%lld</n><avg>%lld</avg>"
+   "<p50>%lld</p50><p90>%lld</p90><p99>%lld</p99><p999>%lld</p999></%s>";
 //                                   1 2 3 4 5 6 7 8
    static const long long LLMax = 0x7fffffffffffffffLL;
    static const int       INMax = 0x7fffffff;
@@ -104,7 +219,13 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
                       INMax, INMax,
                       INMax, INMax, INMax,
                       LLMax, INMax, LLMax, INMax, LLMax, INMax,
-                      INMax, INMax, INMax, INMax);
+                      INMax, INMax, INMax, INMax,
+                      INMax, LLMax, LLMax);
+       for (int i = 0; i < latOps; i++)
+           len += snprintf(dummy, sizeof(dummy), latfmt, LatName(i),
+                           LLMax, LLMax, LLMax, LLMax, LLMax, LLMax,
+                           LatName(i));
+       len += sizeof("<lat></lat></stats>");
        return len + (fsP ? fsP->getStats(0,0) : 0);
       }
 
@@ -118,8 +239,23 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
                   putfCnt, miscCnt,
                   aokSCnt, badSCnt, ignSCnt,
                   AsyncNum, AsyncMax, AsyncRej, errorCnt, redirCnt, stallCnt,
-                  LoginAT, AuthBad, LoginAU, LoginUA);
+                  LoginAT, AuthBad, LoginAU, LoginUA,
+                  IdleNum, IdleMem, IdleRel);
+
+// Add the request latency summaries (percentiles are bucket bounds in usec)
+//
+   if (len < blen) len += snprintf(buff+len, blen-len, "<lat>");
+   for (int i = 0; i < latOps && len < blen; i++)
+       {long long num = 0;
+        for (int j = 0; j < latBkts; j++) num += latHist[i][j];
+        len += snprintf(buff+len, blen-len, latfmt, LatName(i), num,
+                        (num ? latTotT[i]/num : 0),
+                        LatPct(i, num, 500), LatPct(i, num, 900),
+                        LatPct(i, num, 990), LatPct(i, num, 999), LatName(i));
+       }
+   if (len < blen) len += snprintf(buff+len, blen-len, "</lat></stats>");
    statsMutex.UnLock();
+   if (len >= blen) return blen;
 
 // Now include filesystem statistics and return
 //
@@ -154,6 +290,10 @@ int XrdXrootdStats::Stats(XrdXrootdResponse &resp, const char *opts)
                  case 'u': xopts |= XRD_STATS_PROC; break;    // u_sage
                  case 'p': xopts |= XRD_STATS_PROT; break;    // p_rotocol
                  case 's': xopts |= XRD_STATS_SCHD; break;    // s_scheduler
+                 case 'h': {char hBuff[latOps*latBkts*sizeof(long long)+16];
+                            int hLen = LatStats(hBuff, sizeof(hBuff));
+                            return resp.Send((void *)hBuff, hLen);
+                           }
                  default:  break;
                 }
           opts++;
@@ -164,3 +304,54 @@ int XrdXrootdStats::Stats(XrdXrootdResponse &resp, const char *opts)
     xstats->Stats(&statsResp, xopts);
     return statsResp.rc;
 }
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                L a t B k t                                 */
+/******************************************************************************/
+  
+int XrdXrootdStats::LatBkt(long long usec)
+{
+   int msb, bkt;
+
+// The first four buckets are exact, after that there are four per octave
+//
+   if (usec < 4) return (usec < 0 ? 0 : static_cast<int>(usec));
+   msb = 63 - __builtin_clzll(static_cast<unsigned long long>(usec));
+   bkt = ((msb - 1) << 2) + static_cast<int>((usec >> (msb - 2)) & 3);
+   return (bkt < latBkts ? bkt : latBkts - 1);
+}
+
+/******************************************************************************/
+/*                                L a t M a x                                 */
+/******************************************************************************/
+  
+long long XrdXrootdStats::LatMax(int bkt)
+{
+   int shft = (bkt >> 2) - 1;
+
+   if (bkt < 4) return bkt;
+   return (static_cast<long long>(4 + (bkt & 3)) << shft)
+        + (1LL << shft) - 1;
+}
+
+/******************************************************************************/
+/*                                L a t P c t                                 */
+/******************************************************************************/
+
+// Return the upper bound of the bucket holding the pcnt/1000 percentile.
+// The caller must hold the stats mutex.
+//
+long long XrdXrootdStats::LatPct(int op, long long num, int pcnt)
+{
+   long long want = (num * pcnt + 999) / 1000, have = 0;
+
+   if (!num) return 0;
+   for (int j = 0; j < latBkts; j++)
+       {have += latHist[op][j];
+        if (have >= want) return LatMax(j);
+       }
+   return LatMax(latBkts-1);
+}
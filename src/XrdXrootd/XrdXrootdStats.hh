@@ -67,6 +67,28 @@ int              AuthBad;      // Stats: Number of authentication failures
 int              aokSCnt;      // Stats: Number of signature successes
 int              badSCnt;      // Stats: Number of signature failures
 int              ignSCnt;      // Stats: Number of signature ignored
+int              IdleNum;      // Stats: Number of idle links (idlemem)
+long long        IdleMem;      // Stats: Memory held by idle links
+long long        IdleRel;      // Stats: Buffer bytes released from idle links
+
+// Request latencies are kept in log-linear histograms with four buckets for
+// each power of two microseconds, one histogram per request class.
+//
+enum LatOp       {latOpen = 0, latRead,  latReadV, latWrite, latWriteV,
+                  latStat,     latSync,  latClose, latMisc,  latOps};
+
+static const int latBkts = 108;  // Up to 2**27 usec, the last one has more
+
+void             LatAdd(int reqid, long long usec);
+
+bool             LatGet(int op, long long *hist, long long &usec);
+
+static long long LatMax(int bkt); // Largest latency in usec held by bkt
+
+static
+const char      *LatName(int op);
+
+int              LatStats(char *buff, int blen);
 
 void             setFS(XrdSfsFileSystem *fsp) {fsP = fsp;}
 
@@ -78,7 +100,12 @@ int              Stats(XrdXrootdResponse &resp, const char *opts);
                 ~XrdXrootdStats() {}
 private:
 
+static int        LatBkt(long long usec);
+       long long  LatPct(int op, long long num, int pcnt);
+
 XrdSfsFileSystem *fsP;
 XrdStats *xstats;
+long long         latHist[latOps][latBkts];
+long long         latTotT[latOps];
 };
 #endif
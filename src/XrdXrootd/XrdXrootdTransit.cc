@@ -239,6 +239,7 @@ void XrdXrootdTransit::Init(XrdXrootd::Bridge::Result *respP, // Private
 // Set standard stuff
 //
    runArgs   = 0;
+   runAData  = 0;
    runALen   = 0;
    runABsz   = 0;
    runError  = 0;
@@ -415,7 +416,7 @@ int XrdXrootdTransit::Process()
 // be deleted while a timer is outstanding as the link has been disabled. So,
 // we can reissue the request with little worry.
 //
-   if (!runALen || RunCopy(runArgs, runALen)) {
+   if (!runALen || RunCopy(runAData, runALen)) {
       do{rc = Process2();
         if (rc == 0) {
           rc = realProt->Process(NULL);
@@ -561,7 +562,8 @@ bool XrdXrootdTransit::ReqWrite(char *xdataP, int xdataL)
 /*                                   R u n                                    */
 /******************************************************************************/
   
-bool XrdXrootdTransit::Run(const char *xreqP, char *xdataP, int xdataL)
+bool XrdXrootdTransit::Run(const char *xreqP, char *xdataP, int xdataL,
+                           bool xdataPin)
 {
    int movLen, rc;
 
@@ -599,22 +601,28 @@ bool XrdXrootdTransit::Run(const char *xreqP, char *xdataP, int xdataL)
 
 // If this is a write request, we will need to do a lot more
 //
+   wBuff = 0;
    if (Request.header.requestid == kXR_write) return ReqWrite(xdataP, xdataL);
 
 // Obtain any needed buffer and handle any existing data arguments. Also, we
 // need to keep a shadow copy of the request arguments should we get a wait
-// and will need to re-issue the request (the server mangles the args).
+// and will need to re-issue the request (the server mangles the args). When
+// the caller pinned its buffer, that buffer serves as the shadow copy and is
+// released via Free() once the final response is known.
 //
    if (Request.header.dlen)
       {movLen = (xdataL < Request.header.dlen ? xdataL : Request.header.dlen);
        if (!RunCopy(xdataP, movLen)) return true;
-       if (!runArgs || movLen > runABsz)
-          {if (runArgs) free(runArgs);
-           if (!(runArgs = (char *)malloc(movLen)))
-              return Fail(kXR_NoMemory, "Insufficient memory");
-           runABsz = movLen;
-          }
-       memcpy(runArgs, xdataP, movLen); runALen = movLen;
+       if (xdataPin) {runAData = wBuff = xdataP; wBLen = xdataL;}
+          else {if (!runArgs || movLen > runABsz)
+                   {if (runArgs) free(runArgs);
+                    if (!(runArgs = (char *)malloc(movLen)))
+                       return Fail(kXR_NoMemory, "Insufficient memory");
+                    runABsz = movLen;
+                   }
+                memcpy(runArgs, xdataP, movLen); runAData = runArgs;
+               }
+       runALen = movLen;
        if ((myBlen = Request.header.dlen - movLen))
           {myBuff = argp->buff + movLen;
            Resume = &XrdXrootdProtocol::Process2;
@@ -716,6 +724,7 @@ int XrdXrootdTransit::Send(long long offset, int dlen, int fdnum)
 // Effect callback (this is always a final result)
 //
    runDone = true;
+   if (wBuff) respObj->Free(sfInfo, wBuff, wBLen);
    return (respObj->File(sfInfo, dlen) ? 0 : -1);
 }
 
@@ -730,6 +739,7 @@ int XrdXrootdTransit::Send(XrdOucSFVec *sfvec, int sfvnum, int dlen)
 // Effect callback (this is always a final result)
 //
    runDone = true;
+   if (wBuff) respObj->Free(sfInfo, wBuff, wBLen);
    return (respObj->File(sfInfo, dlen) ? 0 : -1);
 }
 
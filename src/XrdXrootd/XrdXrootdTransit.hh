@@ -121,7 +121,8 @@ const char   *ReqTable();
 
 bool          Run(const char *xreqP,       //!< xrootd request header
                         char *xdataP=0,    //!< xrootd request data (optional)
-                        int   xdataL=0     //!< xrootd request data length
+                        int   xdataL=0,    //!< xrootd request data length
+                        bool  xdataPin=false //!< xdataP stays valid until Free()
                  );
 
 //-----------------------------------------------------------------------------
@@ -196,6 +197,7 @@ XrdProtocol                 *realProt;
 XrdXrootd::Bridge::Result   *respObj;
 const char                  *runEText;
 char                        *runArgs;
+char                        *runAData;
 int                          runALen;
 int                          runABsz;
 int                          runError;
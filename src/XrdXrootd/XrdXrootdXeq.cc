@@ -27,19 +27,25 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <algorithm>
+#include <vector>
+#include <atomic>
 #include <errno.h>
 #include <stdio.h>
 #include <sys/time.h>
+#include <zlib.h>
 
 #include "XrdSfs/XrdSfsInterface.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysTimer.hh"
+#include "XrdOuc/XrdOucCRC.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucReqID.hh"
 #include "XrdOuc/XrdOucTList.hh"
 #include "XrdOuc/XrdOucStream.hh"
 #include "XrdOuc/XrdOucTokenizer.hh"
+#include "XrdOuc/XrdOucTraceCtx.hh"
 #include "XrdOuc/XrdOucUtils.hh"
 #include "XrdSec/XrdSecInterface.hh"
 #include "XrdSec/XrdSecProtector.hh"
@@ -58,6 +64,7 @@
 #include "XrdXrootd/XrdXrootdProtocol.hh"
 #include "XrdXrootd/XrdXrootdStats.hh"
 #include "XrdXrootd/XrdXrootdTrace.hh"
+#include "XrdXrootd/XrdXrootdXio.hh"
 #include "XrdXrootd/XrdXrootdXPath.hh"
 
 #include "XrdVersion.hh"
@@ -72,6 +79,15 @@ extern XrdOucTrace *XrdXrootdTrace;
 /*                      L o c a l   S t r u c t u r e s                       */
 /******************************************************************************/
   
+// Orders readv request indices by file offset for the readv planner
+//
+struct XrdXrootdRVOrder
+       {XrdOucIOVec *rdV;
+        bool operator()(int i, int j) const
+                       {return rdV[i].offset < rdV[j].offset;}
+        XrdXrootdRVOrder(XrdOucIOVec *vP) : rdV(vP) {}
+       };
+
 struct XrdXrootdFHandle
        {kXR_int32 handle;
 
@@ -210,9 +226,13 @@ int XrdXrootdProtocol::do_Auth()
 // Now try to authenticate the client using the current protocol
 //
    if (!(rc = AuthProt->Authenticate(&cred, &parm, &eMsg)))
-      {rc = Response.Send(); Status &= ~XRD_NEED_AUTH; SI->Bump(SI->LoginAU);
-       Client = &AuthProt->Entity; numReads = 0; strcpy(Entity.prot, "host");
+      {Status &= ~XRD_NEED_AUTH; SI->Bump(SI->LoginAU);
        if (DHS) Protect = DHS->New4Server(*AuthProt,clientPV&XrdOucEI::uVMask);
+       if (Protect || !strncmp(Entity.prot, "tkt", sizeof(Entity.prot))
+       ||  !(parm = CIA->getTicket(AuthProt->Entity, *(Link->AddrInfo()))))
+          rc = Response.Send();
+          else {rc = Response.Send(parm->buffer, parm->size); delete parm;}
+       Client = &AuthProt->Entity; numReads = 0; strcpy(Entity.prot, "host");
        if (Monitor.Logins() && Monitor.Auths()) MonAuth();
        logLogin(true);
        return rc;
@@ -331,6 +351,7 @@ int XrdXrootdProtocol::do_Bind()
    CapVer = pp->CapVer;
    Status = XRD_BOUNDPATH;
    clientPV = pp->clientPV;
+   cmpResp  = pp->cmpResp;
 
 // Get the required number of parallel I/O objects
 //
@@ -1272,8 +1293,14 @@ int XrdXrootdProtocol::do_Open()
    XrdXrootdFile *xp;
    struct stat statbuf;
    struct ServerResponseBody_Open myResp;
+   struct ServerResponseOpen_Read rdResp;
    int resplen = sizeof(myResp.fhandle);
-   struct iovec IOResp[3];  // Note that IOResp[0] is completed by Response
+   int rdOpts, rdLen, iovN = 1;
+   long long rdOffs;
+   XrdBuffer *rdBuff = 0;
+   struct iovec IOResp[5];  // Note that IOResp[0] is completed by Response
+   XrdOucTraceCtx tCtx;
+   std::string tCgi;
 
 // Keep Statistics
 //
@@ -1283,6 +1310,9 @@ int XrdXrootdProtocol::do_Open()
 //
    mode = (int)ntohs(Request.open.mode);
    opts = (int)ntohs(Request.open.options);
+   rdOpts = Request.open.optiont;
+   rdLen  = (rdOpts & kXR_ordata ? (int)ntohl(Request.open.rdlen) : 0);
+   rdOffs = (long long)ntohl(Request.open.rdoffs);
 
 // Map the mode and options
 //
@@ -1329,6 +1359,19 @@ int XrdXrootdProtocol::do_Open()
 //
    if (rpCheck(fn, &opaque)) return rpEmsg("Opening", fn);
 
+// When spans are recorded, pick up the trace context passed by the client or
+// start a new trace should this file be sampled. A new trace is passed on to
+// the file system in the CGI so that a proxy forwards it to the origin.
+//
+   if (spanOn && !tCtx.FromCgi(opaque) && XrdOucTraceCtx::Sample())
+      {char tp[XrdOucTraceCtx::CtxLen+1];
+       tCtx.Start();
+       tCtx.Format(tp, sizeof(tp));
+       if (opaque && *opaque) {tCgi = opaque; tCgi += '&';}
+       tCgi += XrdOucTraceCtx::CgiKey; tCgi += '='; tCgi += tp;
+       opaque = (char *)tCgi.c_str();
+      }
+
 // Check if this is a local dig type file
 //
    doDig = (digFS && SFS_LCLPATH(fn));
@@ -1382,6 +1425,10 @@ int XrdXrootdProtocol::do_Open()
       }
    oHelp.fp = fp;
 
+// Allow the file system to take ownership of our receive buffers on writes
+//
+   fp->setXio(this);
+
 // The open is elegible for a defered response, indicate we're ok with that
 //
    fp->error.setErrCB(&openCB, ReqID.getID());
@@ -1402,6 +1449,7 @@ int XrdXrootdProtocol::do_Open()
        return Response.Send(kXR_NoMemory, ebuff);
       }
    oHelp.xp = xp;
+   if (tCtx.isSampled()) xp->traceCtx = new XrdOucTraceCtx(tCtx);
 
 // Serialize the link
 //
@@ -1447,12 +1495,7 @@ int XrdXrootdProtocol::do_Open()
 
 // If client wants a stat in open, return the stat information
 //
-   if (retStat)
-      {retStat = StatGen(statbuf, ebuff);
-       IOResp[1].iov_base = (char *)&myResp; IOResp[1].iov_len = sizeof(myResp);
-       IOResp[2].iov_base =         ebuff;   IOResp[2].iov_len = retStat;
-       resplen = sizeof(myResp) + retStat;
-      }
+   if (retStat) retStat = StatGen(statbuf, ebuff);
 
 // If we are monitoring, send off a path to dictionary mapping (must try 1st!)
 //
@@ -1472,12 +1515,140 @@ int XrdXrootdProtocol::do_Open()
 //
    memcpy((void *)myResp.fhandle,(const void *)&fhandle,sizeof(myResp.fhandle));
    numFiles++;
+   oHelp.isOK = true;
+
+// If the client asked for data along with the open, read it now. Should that
+// fail the file stays open and the client will read it in the usual way.
+//
+   if (rdLen > 0 && rdLen <= maxBuffsz && (rdBuff = BPool->Obtain(rdLen)))
+      {int rlen = xp->XrdSfsp->read((XrdSfsFileOffset)rdOffs, rdBuff->buff,
+                                    (XrdSfsXferSize)rdLen);
+       TRACEP(FS, "open read " <<rdLen <<'@' <<rdOffs <<" rc=" <<rlen);
+       if (rlen < 0) {BPool->Release(rdBuff); rdBuff = 0;}
+          else {xp->Stats.rdOps(rlen);
+                memset(&rdResp, 0, sizeof(rdResp));
+                rdResp.rdlen = static_cast<kXR_int32>(htonl(rlen));
+                if (rdOpts & kXR_orclose && usage == 'r'
+                &&  OpenClose(xp, fhandle))
+                   rdResp.flags = kXR_orclosed;
+                IOResp[1].iov_base = (char *)&myResp;
+                IOResp[1].iov_len  = sizeof(myResp);
+                IOResp[2].iov_base = (char *)&rdResp;
+                IOResp[2].iov_len  = sizeof(rdResp);
+                IOResp[3].iov_base = rdBuff->buff;
+                IOResp[3].iov_len  = rlen;
+                iovN = 4;
+                resplen = sizeof(myResp) + sizeof(rdResp) + rlen;
+               }
+      }
+
+// Add any stat information
+//
+   if (retStat)
+      {if (iovN == 1)
+          {IOResp[1].iov_base = (char *)&myResp;
+           IOResp[1].iov_len  = resplen = sizeof(myResp);
+           iovN = 2;
+          }
+       IOResp[iovN].iov_base = ebuff;
+       IOResp[iovN++].iov_len = retStat;
+       resplen += retStat;
+      }
 
 // Respond (failure is not an option now)
 //
-   oHelp.isOK = true;
-   if (retStat)  return Response.Send(IOResp, 3, resplen);
-      else       return Response.Send((void *)&myResp, resplen);
+   if (iovN > 1) rc = Response.Send(IOResp, iovN, resplen);
+      else       rc = Response.Send((void *)&myResp, resplen);
+   if (rdBuff) BPool->Release(rdBuff);
+   return rc;
+}
+
+/******************************************************************************/
+/*                             d o _ P g R e a d                              */
+/******************************************************************************/
+  
+int XrdXrootdProtocol::do_PgRead()
+{
+   static const int pgMax = 256;       // Pages per response (iovec limit)
+   static const int pgMsk = kXR_pgPageSZ - 1;
+   struct iovec ioVec[pgMax*2+3];
+   uint32_t csVec[pgMax+1];
+   XrdXrootdFHandle fh(Request.pgread.fhandle);
+   int rc, xframt, rdlen, pgnum, ioNum, Quantum;
+   char *buff;
+   numReads++;
+
+// Unmarshall the data
+//
+   myIOLen  = ntohl(Request.pgread.rlen);
+              n2hll(Request.pgread.offset, myOffset);
+
+// Find the file object
+//
+   if (!FTab || !(myFile = FTab->Get(fh.handle)))
+      return Response.Send(kXR_FileNotOpen,
+                           "pgread does not refer to an open file");
+   if (spanOn && myFile->traceCtx)
+      {spanFile = myFile; spanOff = myOffset; spanLen = myIOLen; spanFsUs = -1;}
+
+// Trace and verify read length is not negative
+//
+   TRACEP(FS, "fh=" <<fh.handle <<" pgread " <<myIOLen <<'@' <<myOffset);
+   if ( myIOLen < 0) return Response.Send(kXR_ArgInvalid,
+                                          "Read length is negative");
+
+// If we are monitoring, insert a read entry
+//
+   if (Monitor.InOut())
+      Monitor.Agent->Add_rd(myFile->Stats.FileID, Request.pgread.rlen,
+                                                  Request.pgread.offset);
+
+// Short circuit processing if read length is zero
+//
+   if (!myIOLen) return Response.Send();
+
+// Get a buffer. Each response carries up to pgMax pages and all but the last
+// response must end on a page boundary so that the client sees whole units.
+//
+   Quantum = (maxBuffsz < pgMax*kXR_pgPageSZ ? maxBuffsz : pgMax*kXR_pgPageSZ);
+   if (Quantum < kXR_pgPageSZ) Quantum = kXR_pgPageSZ;
+   if (Quantum > myIOLen) Quantum = myIOLen;
+   if (!argp || Quantum < halfBSize || Quantum > argp->bsize)
+      {if ((rc = getBuff(1, Quantum)) <= 0) return rc;}
+      else if (hcNow < hcNext) hcNow++;
+   buff = argp->buff;
+
+// Read the pages and send them interleaved with their checksums. As with
+// read, statistics record the original amount of the request.
+//
+   myFile->Stats.rdOps(myIOLen);
+   do {rdlen = Quantum;
+       if (rdlen < myIOLen) rdlen -= (myOffset + rdlen) & pgMsk;
+       if ((xframt = myFile->XrdSfsp->pgRead(myOffset, buff, rdlen, csVec)) <= 0)
+          break;
+       pgnum = XrdOucCRC::PgCount(myOffset, xframt);
+       ioNum = 1;
+       for (int i = 0, pglen, pgoff = 0; i < pgnum; i++)
+           {pglen = kXR_pgPageSZ - ((myOffset + pgoff) & pgMsk);
+            if (pglen > xframt - pgoff) pglen = xframt - pgoff;
+            csVec[i] = htonl(csVec[i]);
+            ioVec[ioNum  ].iov_base = (char *)&csVec[i];
+            ioVec[ioNum++].iov_len  = sizeof(uint32_t);
+            ioVec[ioNum  ].iov_base = buff + pgoff;
+            ioVec[ioNum++].iov_len  = pglen;
+            pgoff += pglen;
+           }
+       rc = xframt + pgnum*sizeof(uint32_t);
+       if (xframt >= myIOLen) return Response.Send(ioVec, ioNum, rc);
+       if (Response.Send(kXR_oksofar, ioVec, ioNum, rc) < 0) return -1;
+       myOffset += xframt; myIOLen -= xframt;
+       if (myIOLen < Quantum) Quantum = myIOLen;
+      } while(myIOLen);
+
+// Determine why we ended here
+//
+   if (xframt == 0) return Response.Send();
+   return fsError(xframt, 0, myFile->XrdSfsp->error, 0, 0);
 }
 
 /******************************************************************************/
@@ -1612,7 +1783,8 @@ int XrdXrootdProtocol::do_Prepare()
 /*                           d o _ P r o t o c o l                            */
 /******************************************************************************/
   
-int XrdXrootdProtocol::do_Protocol(ServerResponseBody_Protocol *rsp)
+int XrdXrootdProtocol::do_Protocol(ServerResponseBody_Protocol *rsp,
+                                   XrdLink *lp)
 {
    static kXR_int32 verNum = static_cast<kXR_int32>(htonl(kXR_PROTOCOLVERSION));
    static kXR_int32 theRle = static_cast<kXR_int32>(htonl(myRole));
@@ -1637,6 +1809,15 @@ int XrdXrootdProtocol::do_Protocol(ServerResponseBody_Protocol *rsp)
        &&  Request.protocol.flags & kXR_secreqs)
           RespLen += DHS->ProtResp(respP->secreq, *(Link->AddrInfo()), cvn);
        respP->flags = theRle;
+       if (cmp_level && Request.protocol.flags & kXR_wantcmp)
+          {cmpResp = true;
+           respP->flags |= static_cast<kXR_int32>(htonl(kXR_cmpRead));
+          }
+       if (!isRedir && (strm_lan || strm_wan))
+          {int nStrm = ((lp ? lp : Link)->AddrInfo()->isPrivate()
+                     ? strm_lan : strm_wan);
+           respP->flags |= static_cast<kXR_int32>(htonl(nStrm << kXR_strmShft));
+          }
       } else {
        respP->flags = theRlf;
       }
@@ -2030,6 +2211,8 @@ int XrdXrootdProtocol::do_Read()
    if (!FTab || !(myFile = FTab->Get(fh.handle)))
       return Response.Send(kXR_FileNotOpen,
                            "read does not refer to an open file");
+   if (spanOn && myFile->traceCtx)
+      {spanFile = myFile; spanOff = myOffset; spanLen = myIOLen; spanFsUs = -1;}
 
 // Trace and verify read length is not negative
 //
@@ -2069,6 +2252,10 @@ int XrdXrootdProtocol::do_ReadAll(int asyncOK)
    int rc, xframt, Quantum = (myIOLen > maxBuffsz ? maxBuffsz : myIOLen);
    char *buff;
 
+// Compressed responses always go through a buffer
+//
+   if (cmpResp) return do_ReadCmp();
+
 // If this file is memory mapped, short ciruit all the logic and immediately
 // transfer the requested data to minimize latency.
 //
@@ -2116,7 +2303,11 @@ int XrdXrootdProtocol::do_ReadAll(int asyncOK)
 // amount of the request even if we really do not get to read that much!
 //
    myFile->Stats.rdOps(myIOLen);
-   do {if ((xframt = myFile->XrdSfsp->read(myOffset, buff, Quantum)) <= 0) break;
+   if (spanFile) spanFsUs = 0;
+   do {long long fsBeg = (spanFile ? XrdOucTraceCtx::Now() : 0);
+       xframt = myFile->XrdSfsp->read(myOffset, buff, Quantum);
+       if (spanFile) spanFsUs += XrdOucTraceCtx::Now() - fsBeg;
+       if (xframt <= 0) break;
        if (xframt >= myIOLen) return Response.Send(buff, xframt);
        if (Response.Send(kXR_oksofar, buff, xframt) < 0) return -1;
        myOffset += xframt; myIOLen -= xframt;
@@ -2129,6 +2320,48 @@ int XrdXrootdProtocol::do_ReadAll(int asyncOK)
    return fsError(xframt, 0, myFile->XrdSfsp->error, 0, 0);
 }
 
+/******************************************************************************/
+/*                            d o _ R e a d C m p                             */
+/******************************************************************************/
+
+// Same as the buffered part of do_ReadAll() but each response is compressed.
+//
+int XrdXrootdProtocol::do_ReadCmp()
+{
+   int rc, xframt, Quantum = (myIOLen > maxBuffsz ? maxBuffsz : myIOLen);
+   char *buff;
+
+// Make sure we have a large enough buffer
+//
+   if (!argp || Quantum < halfBSize || Quantum > argp->bsize)
+      {if ((rc = getBuff(1, Quantum)) <= 0) return rc;}
+      else if (hcNow < hcNext) hcNow++;
+   buff = argp->buff;
+
+// Now read all of the data, the mmap case is simply a source of data here
+//
+   myFile->Stats.rdOps(myIOLen);
+   do {if (myFile->isMMapped)
+          {if (myOffset >= myFile->Stats.fSize) {xframt = 0; break;}
+           xframt = myFile->Stats.fSize - myOffset;
+           if (xframt > Quantum) xframt = Quantum;
+           memcpy(buff, myFile->mmAddr+myOffset, xframt);
+          } else {
+           if ((xframt = myFile->XrdSfsp->read(myOffset, buff, Quantum)) <= 0)
+              break;
+          }
+       if (xframt >= myIOLen) return SendCmp(kXR_ok, buff, xframt);
+       if (SendCmp(kXR_oksofar, buff, xframt) < 0) return -1;
+       myOffset += xframt; myIOLen -= xframt;
+       if (myIOLen < Quantum) Quantum = myIOLen;
+      } while(myIOLen);
+
+// Determine why we ended here
+//
+   if (xframt == 0) return Response.Send();
+   return fsError(xframt, 0, myFile->XrdSfsp->error, 0, 0);
+}
+
 /******************************************************************************/
 /*                           d o _ R e a d N o n e                            */
 /******************************************************************************/
@@ -2247,11 +2480,32 @@ int XrdXrootdProtocol::do_ReadV()
    if (totSZ > 0x7fffffffLL)
       return Response.Send(kXR_NoMemory, "Total readv transfer is too large");
 
+// If the first file is traced, the readv is reported as its span
+//
+   if (spanOn && FTab && (myFile = FTab->Get(rdVec[0].info)) && myFile->traceCtx)
+      {spanFile = myFile; spanOff = rdVec[0].offset;
+       spanLen  = static_cast<int>(totSZ - rdVecLen); spanFsUs = -1;
+      }
+
 // Calculate the transfer unit which will be the smaller of the maximum
 // transfer unit and the actual amount we need to transfer.
 //
    if ((Quantum = static_cast<int>(totSZ)) > maxTransz) Quantum = maxTransz;
-   
+
+// If every segment can be sent directly from its file, we use sendfile() to
+// avoid copying the data. The segments must be large enough to make it worth
+// it and lie within the file as we cannot recover from a short sendfile().
+//
+   if (!as_nosf && !cmpResp && FTab && Response.isOurs()
+   &&  (totSZ - rdVecLen)/rdVBreak >= as_minsfsz)
+      {for (i = 0; i < rdVBreak; i++)
+           {if (!(myFile = FTab->Get(rdVec[i].info)) || !myFile->sfEnabled
+            ||  myFile->fdNum < 0
+            ||  rdVec[i].offset + rdVec[i].size > myFile->Stats.fSize) break;
+           }
+       if (i >= rdVBreak) return do_ReadVsf(rdVec, rdVBreak);
+      }
+
 // Now obtain the right size buffer
 //
    if ((Quantum < halfBSize && Quantum > 1024) || Quantum > argp->bsize)
@@ -2281,7 +2535,7 @@ int XrdXrootdProtocol::do_ReadV()
 //
    for (i = 0; i < rdVecNum; i++)
        {if (rdVec[i].info != currFH)
-           {xfrSZ = myFile->XrdSfsp->readv(&rdVec[rdVNow], i-rdVNow);
+           {xfrSZ = rvRead(myFile->XrdSfsp, &rdVec[rdVNow], i-rdVNow);
             if (xfrSZ != rdVAmt) break;
             rdVNum = i - rdVBeg; rdVXfr += rdVAmt;
             myFile->Stats.rvOps(rdVXfr, rdVNum);
@@ -2303,11 +2557,12 @@ int XrdXrootdProtocol::do_ReadV()
 
         if (Qleft < (rdVec[i].size + hdrSZ))
            {if (rdVAmt)
-               {xfrSZ = myFile->XrdSfsp->readv(&rdVec[rdVNow], i-rdVNow);
+               {xfrSZ = rvRead(myFile->XrdSfsp, &rdVec[rdVNow], i-rdVNow);
                 if (xfrSZ != rdVAmt) break;
                }
-            if (Response.Send(kXR_oksofar,argp->buff,Quantum-Qleft) < 0)
-               return -1;
+            if ((cmpResp ? SendCmp(kXR_oksofar, argp->buff, Quantum-Qleft)
+                         : Response.Send(kXR_oksofar,argp->buff,Quantum-Qleft))
+                < 0) return -1;
             Qleft = Quantum;
             buffp = argp->buff;
             rdVNow = i; rdVXfr += rdVAmt; rdVAmt = 0;
@@ -2334,7 +2589,80 @@ int XrdXrootdProtocol::do_ReadV()
 
 // All done, return result of the last segment or just zero
 //
-   return (Quantum != Qleft ? Response.Send(argp->buff, Quantum-Qleft) : 0);
+   if (Quantum == Qleft) return 0;
+   if (cmpResp) return SendCmp(kXR_ok, argp->buff, Quantum-Qleft);
+   return Response.Send(argp->buff, Quantum-Qleft);
+}
+
+/******************************************************************************/
+/*                             d o _ R e a d V s f                            */
+/******************************************************************************/
+
+// Send a readv response using sendfile(). The caller has verified that each
+// segment refers to an open sendfile enabled file and lies within that file.
+// Each response frame carries the segment headers from memory and the data
+// from the file and is limited by the number of sendfile elements we can use.
+//
+int XrdXrootdProtocol::do_ReadVsf(XrdOucIOVec *rdVec, int rdVecNum)
+{
+   static const int hdrSZ  = sizeof(readahead_list);
+   static const int maxSeg = (XrdOucSFVec::sfMax - 1) / 2;
+   XrdOucSFVec sfVec[XrdOucSFVec::sfMax];
+   struct readahead_list rvHdr[maxSeg];
+   XrdXrootdFile *fP;
+   int rvMon = Monitor.InOut();
+   int ioMon = (rvMon > 1);
+   int i, k, rdVBeg = 0, rdVXfr = 0, frLen = 0, sfN = 1, segN = 0;
+   char vType = (ioMon ? XROOTD_MON_READU : XROOTD_MON_READV);
+
+// Account for each run of segments that refer to the same file just as if
+// the segments were actually read.
+//
+   rvSeq++;
+   for (i = 0; i < rdVecNum; i++)
+       {rdVXfr += rdVec[i].size;
+        if (i+1 < rdVecNum && rdVec[i+1].info == rdVec[i].info) continue;
+        fP = FTab->Get(rdVec[i].info);
+        fP->Stats.rvOps(rdVXfr, i+1-rdVBeg);
+        if (rvMon)
+           {Monitor.Agent->Add_rv(fP->Stats.FileID, htonl(rdVXfr),
+                                  htons(i+1-rdVBeg), rvSeq, vType);
+            if (ioMon) for (k = rdVBeg; k <= i; k++)
+                Monitor.Agent->Add_rd(fP->Stats.FileID,
+                        htonl(rdVec[k].size), htonll(rdVec[k].offset));
+           }
+        rdVBeg = i+1; rdVXfr = 0;
+       }
+
+// Now run through the segments sending a response frame whenever it is full
+//
+   for (i = 0; i < rdVecNum; i++)
+       {if (segN && (segN >= maxSeg || frLen+hdrSZ+rdVec[i].size > maxTransz))
+           {if (Response.Send(kXR_oksofar, sfVec, sfN, frLen) < 0) return -1;
+            frLen = 0; sfN = 1; segN = 0;
+           }
+        fP = FTab->Get(rdVec[i].info);
+        memcpy(rvHdr[segN].fhandle, &rdVec[i].info, sizeof(rvHdr[segN].fhandle));
+        rvHdr[segN].rlen   = htonl(rdVec[i].size);
+        rvHdr[segN].offset = htonll(rdVec[i].offset);
+        sfVec[sfN].buffer  = (char *)&rvHdr[segN];
+        sfVec[sfN].sendsz  = hdrSZ;
+        sfVec[sfN].fdnum   = -1;
+        sfN++; segN++;
+        if (rdVec[i].size)
+           {sfVec[sfN].offset = static_cast<off_t>(rdVec[i].offset);
+            sfVec[sfN].sendsz = rdVec[i].size;
+            sfVec[sfN].fdnum  = fP->fdNum;
+            sfN++;
+           }
+        frLen += hdrSZ + rdVec[i].size;
+        TRACEP(FS,"fh=" <<rdVec[i].info <<" readV " <<rdVec[i].size <<'@'
+                  <<rdVec[i].offset <<" sendfile");
+       }
+
+// Send the last frame
+//
+   return Response.Send(sfVec, sfN, frLen);
 }
 
 /******************************************************************************/
@@ -2567,6 +2895,10 @@ int XrdXrootdProtocol::do_Statx()
 //
    STATIC_REDIRECT(RD_stat);
 
+// Full stat information is gathered by the bulk handler
+//
+   if (Request.stat.options & kXR_sfull) return do_StatxFull();
+
 // Cycle through all of the paths in the list
 //
    while((path = pathlist.GetLine()))
@@ -2588,6 +2920,146 @@ int XrdXrootdProtocol::do_Statx()
    return Response.Send(argp->buff, respinfo-argp->buff);
 }
 
+/******************************************************************************/
+/*                          d o _ S t a t x F u l l                           */
+/******************************************************************************/
+
+namespace
+{
+// The paths of a bulk stat are handed out one at a time to the protocol thread
+// and to up to maxWorkers scheduler threads. Paths whose stat wants something
+// else than an answer (e.g. a redirect) are left for the protocol thread to
+// redo so that the client gets the usual response for them.
+//
+class StatxBulk
+{
+public:
+
+static const int maxWorkers = 8;
+static const int notDone    = -1;
+
+XrdSfsFileSystem   *fsP;
+const XrdSecEntity *Client;
+const char         *tident;
+char              **Path;
+char              **Cgi;
+struct stat        *Stat;
+int                *eCode;     // 0, kXR error code or notDone for each path
+int                 pNum;
+XrdSysSemaphore     Done;
+
+void Run()
+    {XrdOucErrInfo eInfo(tident);
+     int i, rc, ec;
+     while((i = nextP++) < pNum && !isStopped)
+          {rc = fsP->stat(Path[i], &Stat[i], eInfo, Client, Cgi[i]);
+                if (rc == SFS_OK)    eCode[i] = 0;
+           else if (rc == SFS_ERROR) {eInfo.getErrText(ec);
+                                      eCode[i] = XProtocol::mapError(ec);
+                                     }
+           else isStopped = true;
+           eInfo.Reset();
+          }
+    }
+
+     StatxBulk(int num) : fsP(0), Client(0), tident(0), pNum(num), Done(0),
+                          nextP(0), isStopped(false)
+                        {Path  = new char *[num];
+                         Cgi   = new char *[num];
+                         Stat  = new struct stat[num];
+                         eCode = new int[num];
+                         for (int i = 0; i < num; i++) eCode[i] = notDone;
+                        }
+    ~StatxBulk() {delete [] Path; delete [] Cgi; delete [] Stat; delete [] eCode;}
+
+private:
+std::atomic<int>  nextP;
+std::atomic<bool> isStopped;
+};
+
+class StatxWorker : public XrdJob
+{
+public:
+
+void DoIt() {bulkP->Run(); bulkP->Done.Post(); delete this;}
+
+     StatxWorker(StatxBulk *bP) : XrdJob("statx worker"), bulkP(bP) {}
+    ~StatxWorker() {}
+
+private:
+StatxBulk *bulkP;
+};
+}
+
+int XrdXrootdProtocol::do_StatxFull()
+{
+   static XrdXrootdCallBack statxCB("xstat", XROOTD_MON_STAT);
+   XrdOucTokenizer pathlist(argp->buff);
+   char *path, *opaque, *rBuff, *bP;
+   int i, rc, pNum = 0, nWorkers;
+
+// Count the paths and make sure we can handle all of them
+//
+   for (bP = argp->buff; *bP; bP++) if (*bP == '\n') pNum++;
+   if (bP == argp->buff) return Response.Send(kXR_ArgMissing, "No paths specified");
+   if (*(bP-1) != '\n') pNum++;
+   if (pNum > kXR_maxStatx)
+      return Response.Send(kXR_ArgTooLong, "Too many paths specified");
+
+// Prescreen all of the paths
+//
+   StatxBulk bulk(pNum);
+   for (i = 0; i < pNum && (path = pathlist.GetLine()); i++)
+       {if (rpCheck(path, &opaque)) return rpEmsg("Stating", path);
+        if (!Squash(path))          return vpEmsg("Stating", path);
+        bulk.Path[i] = path; bulk.Cgi[i] = opaque;
+       }
+   if (!(bulk.pNum = pNum = i))
+      return Response.Send(kXR_ArgMissing, "No paths specified");
+
+// Stat the paths. Every eight paths get a worker, we take a share ourselves.
+//
+   bulk.fsP = osFS; bulk.Client = CRED; bulk.tident = Link->ID;
+   nWorkers = (pNum-1)/8;
+   if (nWorkers > StatxBulk::maxWorkers) nWorkers = StatxBulk::maxWorkers;
+   for (i = 0; i < nWorkers; i++) Sched->Schedule(new StatxWorker(&bulk));
+   bulk.Run();
+   for (i = 0; i < nWorkers; i++) bulk.Done.Wait();
+   TRACEP(FS, "statx " <<pNum <<" paths using " <<nWorkers+1 <<" threads");
+
+// Redo whatever was left over. The first path that cannot be answered right
+// away determines the response to the whole request.
+//
+   XrdOucErrInfo myError(Link->ID,&statxCB,ReqID.getID(),Monitor.Did,clientPV);
+   for (i = 0; i < pNum; i++)
+       {if (bulk.eCode[i] != StatxBulk::notDone) continue;
+        rc = osFS->stat(bulk.Path[i], &bulk.Stat[i], myError, CRED, bulk.Cgi[i]);
+        TRACEP(FS, "rc=" <<rc <<" stat " <<bulk.Path[i]);
+        if (rc == SFS_OK) bulk.eCode[i] = 0;
+           else if (rc == SFS_ERROR)
+                   {myError.getErrText(rc);
+                    bulk.eCode[i] = XProtocol::mapError(rc);
+                   }
+           else return fsError(rc, XROOTD_MON_STAT, myError,
+                               bulk.Path[i], bulk.Cgi[i]);
+        myError.Reset();
+       }
+
+// Format the results, a line holds at most 70 characters
+//
+   bP = rBuff = (char *)malloc((unsigned int)pNum*72);
+   for (i = 0; i < pNum; i++)
+       {if (!bulk.eCode[i]) bP += StatGen(bulk.Stat[i], bP) - 1;
+           else bP += sprintf(bP, "!%d", bulk.eCode[i]);
+        *bP++ = '\n';
+       }
+   *(bP-1) = 0;
+
+   rc = Response.Send(rBuff, bP-rBuff);
+   free(rBuff);
+   return rc;
+}
+
 /******************************************************************************/
 /*                               d o _ S y n c                                */
 /******************************************************************************/
@@ -2782,7 +3254,10 @@ int XrdXrootdProtocol::do_WriteAll()
                 }
              return rc;
             }
-         if ((rc = myFile->XrdSfsp->write(myOffset, argp->buff, Quantum)) < 0)
+         inWrite = 1;
+         rc = myFile->XrdSfsp->write(myOffset, argp->buff, Quantum);
+         inWrite = 0;
+         if (rc < 0)
             {myIOLen  = myIOLen-Quantum; myEInfo[0] = rc;
              return do_WriteNone();
             }
@@ -2810,7 +3285,10 @@ int XrdXrootdProtocol::do_WriteCont()
 
 // Write data that was finaly finished comming in
 //
-   if ((rc = myFile->XrdSfsp->write(myOffset, argp->buff, myBlast)) < 0)
+   inWrite = 1;
+   rc = myFile->XrdSfsp->write(myOffset, argp->buff, myBlast);
+   inWrite = 0;
+   if (rc < 0)
       {myIOLen  = myIOLen-myBlast; myEInfo[0] = rc;
        return do_WriteNone();
       }
@@ -2828,20 +3306,21 @@ int XrdXrootdProtocol::do_WriteCont()
   
 int XrdXrootdProtocol::do_WriteNone()
 {
-   int rlen, blen = (myIOLen > argp->bsize ? argp->bsize : myIOLen);
+   int rc, blen = (myIOLen > argp->bsize ? argp->bsize : myIOLen);
 
-// Discard any data being transmitted
+// Discard any data being transmitted. This goes through getData() as some of
+// the data may have been read ahead.
 //
    TRACEP(REQ, "discarding " <<myIOLen <<" bytes");
    while(myIOLen > 0)
-        {rlen = Link->Recv(argp->buff, blen, readWait);
-         if (rlen  < 0) return Link->setEtext("link read error");
-         myIOLen -= rlen;
-         if (rlen < blen) 
-            {myBlen   = 0;
+        {if ((rc = getData("discard", argp->buff, blen)))
+            {if (rc < 0) return rc;
+             myIOLen -= blen - myBlen;
+             myBlen   = 0;
              Resume   = &XrdXrootdProtocol::do_WriteNone;
              return 1;
             }
+         myIOLen -= blen;
          if (myIOLen < blen) blen = myIOLen;
         }
 
@@ -3021,12 +3500,171 @@ int XrdXrootdProtocol::do_WriteV()
    myBuff        = argp->buff;
    myBlast       = 0;
 
+// If allowed, write the segments asynchronously. This only works when all of
+// them go to the same file, as the aio request is tied to one file.
+//
+   if (as_aiowv && !as_syncw && !wvInfo->doSync && myFile->AsyncMode
+   &&  wrVec[wrVecNum-1].info == wrVec[0].info)
+      {int rc;
+       freeInfo.doit = false;
+       if ((rc = do_WriteVAio()) != -EAGAIN)
+          {if (rc != -EIO) return rc;
+           myEInfo[0] = SFS_ERROR;
+           myFile->XrdSfsp->error.setErrInfo(rc, "I/O error");
+           return do_WriteNone();
+          }
+       SI->AsyncRej++;
+       myIOLen = wrVec[0].size;
+       freeInfo.doit = true;
+      }
+
 // Now we simply start the write operations
 //
    freeInfo.doit = false;
    return do_WriteVec();
 }
 
+/******************************************************************************/
+/*                          d o _ W r i t e V A i o                           */
+/******************************************************************************/
+
+// Writes the segments of a writev request as aio writes. Segments that follow
+// each other on disk are merged and several writes are kept in flight, so the
+// device sees all of them at once while we read the data from the link. When
+// the last piece has been dispatched we go on with the next request; the
+// response is sent by the aio request object once all of the writes completed.
+// Returns -EAGAIN when the request does not qualify, otherwise as aio_Write().
+//
+int XrdXrootdProtocol::do_WriteVAio()
+{
+   XrdOucIOVec *wrVec = wvInfo->wrVec;
+   long long totSZ = 0;
+   int i, k, wrVecNum = wvInfo->vEnd;
+
+// All segments must be for the same file and must not overlap, otherwise
+// parallel writes could leave a different result than the sequential ones.
+//
+   std::vector<std::pair<long long, int> > segs;
+   segs.reserve(wrVecNum);
+   for (i = 0; i < wrVecNum; i++)
+       {if (wrVec[i].info != wvInfo->curFH) return -EAGAIN;
+        segs.push_back(std::make_pair(wrVec[i].offset, wrVec[i].size));
+        totSZ += wrVec[i].size;
+       }
+   std::sort(segs.begin(), segs.end());
+   for (i = 1; i < wrVecNum; i++)
+       if (segs[i-1].first + segs[i-1].second > segs[i].first) return -EAGAIN;
+
+// Check that this is worth it and that we are not swamping the link
+//
+   if (totSZ < as_miniosz || totSZ > 0x7fffffff
+   ||  Link->UseCnt() >= as_maxperlnk) return -EAGAIN;
+
+// Allocate a request object to handle this request, it is sized by myIOLen
+//
+   myIOLen  = static_cast<int>(totSZ);
+   if (!(myAioReq = XrdXrootdAioReq::Alloc(this, 'w'))) return -EAGAIN;
+   myFile->Stats.wvOps(myIOLen, wrVecNum);
+
+// Merge segments that follow each other in the vector and on disk
+//
+   for (i = 1, k = 0; i < wrVecNum; i++)
+       {if (wrVec[k].offset + wrVec[k].size == wrVec[i].offset
+        &&  (long long)wrVec[k].size + wrVec[i].size <= 0x3fffffff)
+           wrVec[k].size += wrVec[i].size;
+           else wrVec[++k] = wrVec[i];
+       }
+   wvInfo->vEnd = k+1;
+   TRACEP(FS,"fh=" <<wvInfo->curFH <<" aio writeV " <<totSZ <<':' <<wrVecNum
+              <<" as " <<k+1);
+
+// Start dispatching
+//
+   wvInfo->vPos = 0;
+   myOffset     = wrVec[0].offset;
+   if (myStalls) myStalls--;
+   return do_WriteVAioCont();
+}
+
+/******************************************************************************/
+/*                      d o _ W r i t e V A i o C o n t                       */
+/******************************************************************************/
+
+// myFile   = file to be written
+// myOffset = Offset at which to write the next piece
+// myIOLen  = Number of bytes left to read from the socket for the request
+// myBlast  = Number of bytes of a pending piece already read from the socket
+// myAioReq = -> Aio Request
+// wvInfo   = merged segments with vPos the one being written
+  
+int XrdXrootdProtocol::do_WriteVAioCont()
+{
+   XrdXrootdAio *aiop;
+   long long runEnd;
+   int Quantum, rc = 0;
+
+// If we are resuming a piece whose data finally arrived, write it out
+//
+   if (myBlast)
+      {aiop = myAioReq->Pop();
+       if ((rc = myAioReq->Write(aiop)))
+          {myIOLen = myIOLen-myBlast;
+           if (wvInfo) {free(wvInfo); wvInfo = 0;}
+           return aio_Error("write", rc);
+          }
+       myOffset += myBlast; myIOLen -= myBlast; myBlast = 0;
+      }
+
+// Read the data piece by piece, each piece stays within a merged segment
+//
+   while (myIOLen > 0)
+        {runEnd = wvInfo->wrVec[wvInfo->vPos].offset
+                + wvInfo->wrVec[wvInfo->vPos].size;
+         if (myOffset >= runEnd)
+            {wvInfo->vPos++;
+             myOffset = wvInfo->wrVec[wvInfo->vPos].offset;
+             continue;
+            }
+
+         if (!(aiop = myAioReq->getAio()))
+            {Resume = &XrdXrootdProtocol::do_WriteVAioCont;
+             myBlen = 0; myBlast = 0;
+             return -EINPROGRESS;
+            }
+
+         Quantum = aiop->buffp->bsize;
+         if (runEnd - myOffset < Quantum)
+            Quantum = static_cast<int>(runEnd - myOffset);
+         if ((rc = getData("aiodata", aiop->buffp->buff, Quantum)))
+            {if (rc > 0)
+                {Resume = &XrdXrootdProtocol::do_WriteVAioCont;
+                 myBlast = Quantum;
+                 myAioReq->Push(aiop);
+                 myStalls++;
+                 return 1;
+                }
+             myAioReq->Recycle(-1, aiop);
+             break;
+            }
+
+         aiop->sfsAio.aio_nbytes = Quantum;
+         aiop->sfsAio.aio_offset = myOffset;
+         myIOLen -= Quantum; myOffset += Quantum;
+         if ((rc = myAioReq->Write(aiop)))
+            {if (wvInfo) {free(wvInfo); wvInfo = 0;}
+             return aio_Error("write", rc);
+            }
+        }
+
+// We have dispatched everything
+//
+   if (myStalls <= as_maxstalls) myStalls = 0;
+   if (wvInfo) {free(wvInfo); wvInfo = 0;}
+   myAioReq = 0;
+   Resume   = 0;
+   return rc;
+}
+
 /******************************************************************************/
 /*                           d o _ W r i t e V e c                            */
 /******************************************************************************/
@@ -3178,6 +3816,50 @@ void XrdXrootdProtocol::SetFD(int fildes)
       else myFile->fdNum = fildes;
 }
 
+/******************************************************************************/
+/*                                  S w a p                                   */
+/******************************************************************************/
+
+// The file system may take the buffer holding the data it is asked to write
+// instead of copying it. We replace it with either a buffer it took earlier
+// or a fresh one from the pool so that the next write still has one.
+//
+XrdSfsXio::XioStatus XrdXrootdProtocol::Swap(const char      * curBuff,
+                                             XrdSfsXioHandle *&curHand,
+                                             XrdSfsXioHandle * oldHand)
+{
+   XrdXrootdXioHandle *hP;
+   XrdBuffer *newBP;
+   int *blen;
+
+   curHand = 0;
+
+// Buffers can only be exchanged while the data they hold is being written
+//
+   if (!inWrite) return NotWrite;
+   if (!argp || curBuff != argp->buff) return BadBuff;
+
+// Reuse the returned buffer if there is one, otherwise get a new one
+//
+   if (oldHand)
+      {if (!(hP = dynamic_cast<XrdXrootdXioHandle *>(oldHand)))
+          return BadHandle;
+       hP->Buffer(&blen);
+       if (*blen < argp->bsize) return BadHandle;
+       argp = hP->Exchange(argp);
+      } else {
+       if (!(newBP = BPool->Obtain(argp->bsize))) return TooMany;
+       if (!(hP = XrdXrootdXioHandle::Alloc(BPool, argp)))
+          {BPool->Release(newBP); return TooMany;}
+       argp = newBP;
+      }
+
+// All done
+//
+   curHand = hP;
+   return allOK;
+}
+
 /******************************************************************************/
 /*                       U t i l i t y   M e t h o d s                        */
 /******************************************************************************/
@@ -3346,11 +4028,20 @@ int XrdXrootdProtocol::fsOvrld(char opC, const char *Path, char *Cgi)
       }
 
 // If there is a stall value, then delay the client
+//
+// Clients that understand it also get a millisecond hint placed after the
+// message's null byte. It is spread over the second half of the stall so that
+// the clients stalled together do not all come back together.
 //
    if (OD_Stall)
-      {TRACEI(STALL, Response.ID()<<"stalling client for "<<OD_Stall<<" sec");
+      {char wBuff[64];
+       int wMS = OD_Stall*500, wLen;
+       wMS += static_cast<int>(random() % (wMS+1));
+       wLen = snprintf(wBuff, sizeof(wBuff), "server is overloaded%cms=%d",
+                       0, wMS);
+       TRACEI(STALL, Response.ID()<<"stalling client for "<<OD_Stall<<" sec");
        SI->stallCnt++;
-       return Response.Send(kXR_wait, OD_Stall, "server is overloaded");
+       return Response.Send(kXR_wait, OD_Stall, wBuff, wLen);
       }
 
 // We were unsuccessful, return overload as an error
@@ -3541,6 +4232,30 @@ void XrdXrootdProtocol::MonAuth()
    if (Entity.moninfo) {free(Entity.moninfo); Entity.moninfo = 0;}
 }
   
+/******************************************************************************/
+/*                             O p e n C l o s e                              */
+/******************************************************************************/
+
+// Close a file just opened and read on behalf of a kXR_open with kXR_orclose.
+// Only a close that completes at once is done here; otherwise the file is left
+// open for the client to close. As the file is only being read, a failing
+// close is of no consequence. Returns true if the file was closed.
+//
+bool XrdXrootdProtocol::OpenClose(XrdXrootdFile *xp, int fhandle)
+{
+   int rc;
+
+   xp->XrdSfsp->error.setErrCB(0);
+   rc = xp->XrdSfsp->close();
+   TRACEP(FS, "open close rc=" <<rc <<" fh=" <<fhandle);
+   if (rc >= SFS_STALL || rc == SFS_STARTED) return false;
+
+   SI->Bump(SI->miscCnt);
+   FTab->Del((Monitor.Files() ? Monitor.Agent : 0), fhandle, true);
+   numFiles--;
+   return true;
+}
+
 /******************************************************************************/
 /*                               r p C h e c k                                */
 /******************************************************************************/
@@ -3580,6 +4295,131 @@ int XrdXrootdProtocol::rpEmsg(const char *op, char *fn)
    return Response.Send(kXR_NotAuthorized, buff);
 }
  
+/******************************************************************************/
+/*                               S e n d C m p                                */
+/******************************************************************************/
+
+// Send a read response prefixed by the compression header. The data is sent
+// as is when it is small or does not compress.
+//
+int XrdXrootdProtocol::SendCmp(XResponseType rcode, char *data, int dlen)
+{
+   ServerResponseCmp_Read cmpHdr;
+   struct iovec ioV[3];
+   uLongf clen = 0;
+   int bsz;
+
+   if (dlen >= cmp_minsz)
+      {bsz = static_cast<int>(compressBound(dlen));
+       if (bsz > cmpBsz)
+          {free(cmpBuff);
+           cmpBsz = ((cmpBuff = (char *)malloc(bsz)) ? bsz : 0);
+          }
+       if (cmpBuff)
+          {clen = cmpBsz;
+           if (compress2((Bytef *)cmpBuff, &clen, (const Bytef *)data, dlen,
+                         cmp_level) != Z_OK || clen >= (uLongf)dlen) clen = 0;
+          }
+      }
+
+   cmpHdr.rlen = htonl(dlen);
+   cmpHdr.clen = htonl(static_cast<int>(clen));
+   ioV[1].iov_base = (char *)&cmpHdr;
+   ioV[1].iov_len  = sizeof(cmpHdr);
+   ioV[2].iov_base = (clen ? cmpBuff : data);
+   ioV[2].iov_len  = (clen ? clen    : dlen);
+   TRACEP(FS, "compressed " <<dlen <<" to " <<clen <<" bytes");
+   return Response.Send(rcode, ioV, 3);
+}
+
+/******************************************************************************/
+/*                                r v R e a d                                 */
+/******************************************************************************/
+
+// The readv planner. When enabled, the segments are sorted by offset and
+// segments that overlap or lie within rv_gap bytes of each other are merged
+// into a single read into a scratch buffer and then copied to their place in
+// the response. Single segments are read directly into the response. All of
+// the reads are issued with one call to the file's readv() method. The return
+// value is the number of bytes placed in the segments or the readv() error.
+//
+int XrdXrootdProtocol::rvRead(XrdSfsFile *fP, XrdOucIOVec *rdV, int rdN)
+{
+   XrdOucIOVec rvPlan[maxRvecsz];
+   int rvIdx[maxRvecsz], rvBeg[maxRvecsz], rvEnd[maxRvecsz];
+   XrdBuffer *bP;
+   XrdSfsXferSize rc, planTot = 0, wantTot = 0;
+   long long segBeg, segEnd, newEnd;
+   char *sBuff;
+   int i, j, k, n, planN = 0, sLeft;
+
+// Check if we should do any planning at all
+//
+   if (rv_gap < 0 || rdN < 2 || rdN > maxRvecsz) return fP->readv(rdV, rdN);
+
+// Sort the segments by offset
+//
+   for (i = 0; i < rdN; i++) rvIdx[i] = i;
+   std::sort(rvIdx, rvIdx+rdN, XrdXrootdRVOrder(rdV));
+
+// Get a scratch buffer for merged reads
+//
+   if (!(bP = BPool->Obtain(rv_span))) return fP->readv(rdV, rdN);
+   sBuff = bP->buff; sLeft = bP->bsize;
+
+// Group the segments. A group ends when the next segment is too far away or
+// the group would no longer fit in what is left of the scratch buffer.
+//
+   i = 0;
+   while(i < rdN)
+        {k = rvIdx[i];
+         segBeg = rdV[k].offset; segEnd = segBeg + rdV[k].size;
+         wantTot += rdV[k].size;
+         for (j = i+1; j < rdN; j++)
+             {XrdOucIOVec &nV = rdV[rvIdx[j]];
+              if (nV.offset > segEnd + rv_gap) break;
+              newEnd = nV.offset + nV.size;
+              if (newEnd < segEnd) newEnd = segEnd;
+              if (newEnd - segBeg > sLeft) break;
+              segEnd = newEnd; wantTot += nV.size;
+             }
+         rvPlan[planN].offset = segBeg;
+         rvPlan[planN].size   = static_cast<int>(segEnd - segBeg);
+         rvPlan[planN].info   = 0;
+         if (j - i == 1) rvPlan[planN].data = rdV[k].data;
+            else {rvPlan[planN].data = sBuff;
+                  sBuff += rvPlan[planN].size; sLeft -= rvPlan[planN].size;
+                 }
+         rvBeg[planN] = i; rvEnd[planN] = j;
+         planTot += rvPlan[planN].size;
+         planN++; i = j;
+        }
+
+// Issue the reads. A short read means that some segment is past the eof.
+//
+   TRACEP(FS, "readv planned " <<rdN <<" segments as " <<planN <<" reads");
+   if ((rc = fP->readv(rvPlan, planN)) != planTot)
+      {BPool->Release(bP);
+       return (rc < 0 ? rc : 0);
+      }
+
+// Scatter the merged reads into their segments
+//
+   for (n = 0; n < planN; n++)
+       {if (rvEnd[n] - rvBeg[n] < 2) continue;
+        for (i = rvBeg[n]; i < rvEnd[n]; i++)
+            {XrdOucIOVec &sV = rdV[rvIdx[i]];
+             memcpy(sV.data, rvPlan[n].data + (sV.offset - rvPlan[n].offset),
+                    sV.size);
+            }
+       }
+
+// All done
+//
+   BPool->Release(bP);
+   return wantTot;
+}
+
 /******************************************************************************/
 /*                                 S e t S F                                  */
 /******************************************************************************/
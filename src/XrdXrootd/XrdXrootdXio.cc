@@ -0,0 +1,68 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d X r o o t d X i o . c c                         */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "Xrd/XrdBuffer.hh"
+#include "XrdXrootd/XrdXrootdXio.hh"
+
+/******************************************************************************/
+/*                        S t a t i c   O b j e c t s                         */
+/******************************************************************************/
+
+std::atomic<int> XrdXrootdXioHandle::numOut(0);
+
+/******************************************************************************/
+/*                                 A l l o c                                  */
+/******************************************************************************/
+
+XrdXrootdXioHandle *XrdXrootdXioHandle::Alloc(XrdBuffManager *bmP,
+                                              XrdBuffer      *bP)
+{
+
+// Plug-ins holding on to too many buffers would drain the pool
+//
+   if (numOut.fetch_add(1) >= maxOut) {numOut--; return 0;}
+   return new XrdXrootdXioHandle(bmP, bP);
+}
+
+/******************************************************************************/
+/*                                B u f f e r                                 */
+/******************************************************************************/
+
+char *XrdXrootdXioHandle::Buffer(int **blen)
+{
+   if (blen) *blen = &bufP->bsize;
+   return bufP->buff;
+}
+
+/******************************************************************************/
+/*                               R e c y c l e                                */
+/******************************************************************************/
+
+void XrdXrootdXioHandle::Recycle()
+{
+   bMgr->Release(bufP);
+   numOut--;
+   delete this;
+}
@@ -0,0 +1,65 @@
+#ifndef __XRDXROOTDXIO_HH__
+#define __XRDXROOTDXIO_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d X r o o t d X i o . h h                         */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <atomic>
+
+#include "XrdSfs/XrdSfsXio.hh"
+
+class XrdBuffer;
+class XrdBuffManager;
+
+/* The following class describes a receive buffer whose ownership has been
+   taken by a file system plug-in via XrdSfsXio::Swap(). The buffer is returned
+   to the buffer pool when the plug-in recycles the handle.
+*/
+
+class XrdXrootdXioHandle : public XrdSfsXioHandle
+{
+public:
+
+static XrdXrootdXioHandle *Alloc(XrdBuffManager *bmP, XrdBuffer *bP);
+
+       char      *Buffer(int **blen=0);
+
+       XrdBuffer *Exchange(XrdBuffer *bP)
+                          {XrdBuffer *oldP = bufP; bufP = bP; return oldP;}
+
+       void       Recycle();
+
+static const int  maxOut = 1024; // Maximum number of buffers held by plug-ins
+
+private:
+           XrdXrootdXioHandle(XrdBuffManager *bmP, XrdBuffer *bP)
+                             : bMgr(bmP), bufP(bP) {}
+          ~XrdXrootdXioHandle() {}
+
+static std::atomic<int> numOut;
+
+XrdBuffManager *bMgr;
+XrdBuffer      *bufP;
+};
+#endif
@@ -0,0 +1,647 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------
+// xrdbench drives reproducible workloads against an xrootd server so that
+// changes to the server data path can be compared run to run. Unless a URL is
+// given, it starts the xrootd built next to it with the default ofs/oss
+// serving a scratch directory on tmpfs and stops it when done.
+//------------------------------------------------------------------------------
+
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClFileSystem.hh"
+#include "XrdCl/XrdClURL.hh"
+#include "XrdCl/XrdClXRootDResponses.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <pwd.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#ifndef XRDBENCH_XROOTD
+#define XRDBENCH_XROOTD "xrootd"
+#endif
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Benchmark parameters
+  //----------------------------------------------------------------------------
+  struct Config
+  {
+    Config(): xrootd( XRDBENCH_XROOTD ), workDir( "/dev/shm" ), threads( 8 ),
+              clients( 1 ), ops( 2000 ), smallFiles( 1000 ),
+              fileSize( 256*1024*1024 ), blockSize( 1024*1024 ),
+              vecSegs( 64 ), vecSegMax( 32*1024 ), vecWindow( 8*1024*1024 ),
+              keep( false ) {}
+
+    std::string xrootd;      // path to the xrootd executable
+    std::string workDir;     // where the scratch directory is created
+    std::string url;         // use this server instead of starting one
+    std::string workloads;   // comma separated list to run
+    int         threads;     // number of concurrent workers
+    int         clients;     // number of distinct connections
+    int         ops;         // operations per worker
+    int         smallFiles;  // files used by stat and open
+    long long   fileSize;    // size of the file used for reads
+    int         blockSize;   // sequential read size
+    int         vecSegs;     // segments per vector read
+    int         vecSegMax;   // maximum vector segment size
+    long long   vecWindow;   // span of a vector read (like a ROOT basket set)
+    bool        keep;        // keep the scratch directory
+  };
+
+  Config cfg;
+
+  //----------------------------------------------------------------------------
+  // Per worker results
+  //----------------------------------------------------------------------------
+  struct Result
+  {
+    Result(): bytes( 0 ), errors( 0 ) {}
+    std::vector<uint32_t> latency;   // microseconds, one per operation
+    long long             bytes;
+    int                   errors;
+    std::string           lastError;
+  };
+
+  typedef bool (*OpFunc)( int wid, int seq, XrdCl::File *file, char *buff,
+                          Result &res );
+
+  struct Workload
+  {
+    const char *name;
+    const char *what;
+    bool        usesFile;   // worker keeps the large file open
+    OpFunc      func;
+  };
+
+  unsigned int   *seeds = 0;
+
+  //----------------------------------------------------------------------------
+  // Helpers
+  //----------------------------------------------------------------------------
+  inline uint64_t NowNS()
+  {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  }
+
+  //----------------------------------------------------------------------------
+  // Spread workers over the requested number of connections. XrdCl shares a
+  // channel per host and user, so distinct user names give distinct links.
+  //----------------------------------------------------------------------------
+  std::string ServerURL( int wid )
+  {
+    if( cfg.clients <= 1 ) return cfg.url;
+    XrdCl::URL url( cfg.url );
+    char uname[32];
+    snprintf( uname, sizeof( uname ), "bench%d", wid % cfg.clients );
+    url.SetUserName( uname );
+    return url.GetURL();
+  }
+
+  std::string SmallPath( int n )
+  {
+    char path[64];
+    snprintf( path, sizeof( path ), "/xrdbench/small/f%05d", n );
+    return path;
+  }
+
+  bool Failed( Result &res, const XrdCl::XRootDStatus &st )
+  {
+    res.errors++;
+    res.lastError = st.ToStr();
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  // The operations
+  //----------------------------------------------------------------------------
+  bool DoStat( int wid, int, XrdCl::File*, char*, Result &res )
+  {
+    static __thread XrdCl::FileSystem *fs = 0;
+    if( !fs ) fs = new XrdCl::FileSystem( XrdCl::URL( ServerURL( wid ) ) );
+    XrdCl::StatInfo *info = 0;
+    XrdCl::XRootDStatus st = fs->Stat( SmallPath( rand_r( &seeds[wid] )
+                                                  % cfg.smallFiles ), info );
+    delete info;
+    return st.IsOK() ? true : Failed( res, st );
+  }
+
+  bool DoOpen( int wid, int, XrdCl::File*, char*, Result &res )
+  {
+    XrdCl::File f;
+    std::string url = ServerURL( wid ) + "/" +
+                      SmallPath( rand_r( &seeds[wid] ) % cfg.smallFiles );
+    XrdCl::XRootDStatus st = f.Open( url, XrdCl::OpenFlags::Read );
+    if( !st.IsOK() ) return Failed( res, st );
+    st = f.Close();
+    return st.IsOK() ? true : Failed( res, st );
+  }
+
+  bool DoRead( int wid, int seq, XrdCl::File *file, char *buff, Result &res )
+  {
+    long long nblk = cfg.fileSize / cfg.blockSize;
+    uint64_t  off  = ((long long)seq + (long long)wid * nblk / cfg.threads)
+                     % nblk * cfg.blockSize;
+    uint32_t  got  = 0;
+    XrdCl::XRootDStatus st = file->Read( off, cfg.blockSize, buff, got );
+    if( !st.IsOK() ) return Failed( res, st );
+    res.bytes += got;
+    return true;
+  }
+
+  bool DoPgRead( int wid, int seq, XrdCl::File *file, char *buff, Result &res )
+  {
+    long long nblk = cfg.fileSize / cfg.blockSize;
+    uint64_t  off  = ((long long)seq + (long long)wid * nblk / cfg.threads)
+                     % nblk * cfg.blockSize;
+    static __thread std::vector<uint32_t> *cksums = 0;
+    if( !cksums ) cksums = new std::vector<uint32_t>();
+    uint32_t  got  = 0;
+    XrdCl::XRootDStatus st = file->PgRead( off, cfg.blockSize, buff, *cksums,
+                                           got );
+    if( !st.IsOK() ) return Failed( res, st );
+    res.bytes += got;
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // A ROOT-like vector read: many small, ascending segments scattered over a
+  // window of the file.
+  //----------------------------------------------------------------------------
+  bool DoReadV( int wid, int, XrdCl::File *file, char *buff, Result &res )
+  {
+    unsigned int *sp = &seeds[wid];
+    long long span = std::min( cfg.vecWindow, cfg.fileSize );
+    uint64_t  base = (uint64_t)( rand_r( sp ) % ( cfg.fileSize - span + 1 ) );
+    std::vector<uint64_t> offs( cfg.vecSegs );
+    for( int i = 0; i < cfg.vecSegs; ++i )
+      offs[i] = base + ( (uint64_t)rand_r( sp ) * 4096 + rand_r( sp ) )
+                       % ( span - cfg.vecSegMax );
+    std::sort( offs.begin(), offs.end() );
+
+    XrdCl::ChunkList chunks;
+    char *bp = buff;
+    for( int i = 0; i < cfg.vecSegs; ++i )
+    {
+      uint32_t len = 64 + rand_r( sp ) % ( cfg.vecSegMax - 64 );
+      chunks.push_back( XrdCl::ChunkInfo( offs[i], len, bp ) );
+      bp += len;
+    }
+
+    XrdCl::VectorReadInfo *info = 0;
+    XrdCl::XRootDStatus st = file->VectorRead( chunks, 0, info );
+    if( info ) res.bytes += info->GetSize();
+    delete info;
+    return st.IsOK() ? true : Failed( res, st );
+  }
+
+  Workload workloads[] =
+  {
+    { "stat",   "stat of random small files",            false, DoStat   },
+    { "open",   "open and close of random small files",  false, DoOpen   },
+    { "read",   "sequential reads of the large file",    true,  DoRead   },
+    { "pgread", "sequential checksummed page reads",     true,  DoPgRead },
+    { "readv",  "ROOT-like vector reads",                true,  DoReadV  }
+  };
+  const int numWorkloads = sizeof( workloads ) / sizeof( workloads[0] );
+
+  //----------------------------------------------------------------------------
+  // Worker thread
+  //----------------------------------------------------------------------------
+  struct Worker
+  {
+    int              wid;
+    Workload        *wl;
+    Result           res;
+    pthread_barrier_t *start;
+  };
+
+  void *RunWorker( void *arg )
+  {
+    Worker      *w    = static_cast<Worker*>( arg );
+    XrdCl::File *file = 0;
+    size_t       bsz  = std::max( (size_t)cfg.blockSize,
+                                  (size_t)cfg.vecSegs * cfg.vecSegMax );
+    char        *buff = new char[bsz];
+
+    w->res.latency.reserve( cfg.ops );
+    if( w->wl->usesFile )
+    {
+      file = new XrdCl::File();
+      XrdCl::XRootDStatus st = file->Open( ServerURL( w->wid ) +
+                                           "//xrdbench/large.dat",
+                                           XrdCl::OpenFlags::Read );
+      if( !st.IsOK() )
+      {
+        Failed( w->res, st );
+        delete file;
+        file = 0;
+      }
+    }
+
+    pthread_barrier_wait( w->start );
+    if( !w->wl->usesFile || file )
+      for( int i = 0; i < cfg.ops; ++i )
+      {
+        uint64_t t0 = NowNS();
+        bool ok = w->wl->func( w->wid, i, file, buff, w->res );
+        if( ok ) w->res.latency.push_back( ( NowNS() - t0 ) / 1000 );
+      }
+    pthread_barrier_wait( w->start );
+
+    if( file )
+    {
+      XrdCl::XRootDStatus st = file->Close();
+      delete file;
+    }
+    delete [] buff;
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Run one workload and print a line of results
+  //----------------------------------------------------------------------------
+  bool RunWorkload( Workload &wl )
+  {
+    std::vector<Worker>    wv( cfg.threads );
+    std::vector<pthread_t> tv( cfg.threads );
+    pthread_barrier_t      start;
+
+    pthread_barrier_init( &start, 0, cfg.threads + 1 );
+    for( int i = 0; i < cfg.threads; ++i )
+    {
+      wv[i].wid = i; wv[i].wl = &wl; wv[i].start = &start;
+      if( pthread_create( &tv[i], 0, RunWorker, &wv[i] ) )
+      {
+        fprintf( stderr, "xrdbench: unable to start thread; %s\n",
+                 strerror( errno ) );
+        exit( 4 );
+      }
+    }
+
+    pthread_barrier_wait( &start );
+    uint64_t t0 = NowNS();
+    pthread_barrier_wait( &start );
+    double secs = ( NowNS() - t0 ) / 1e9;
+    for( int i = 0; i < cfg.threads; ++i ) pthread_join( tv[i], 0 );
+    pthread_barrier_destroy( &start );
+
+    std::vector<uint32_t> lat;
+    long long bytes = 0;
+    int errors = 0;
+    std::string lastError;
+    for( int i = 0; i < cfg.threads; ++i )
+    {
+      lat.insert( lat.end(), wv[i].res.latency.begin(),
+                  wv[i].res.latency.end() );
+      bytes  += wv[i].res.bytes;
+      errors += wv[i].res.errors;
+      if( !wv[i].res.lastError.empty() ) lastError = wv[i].res.lastError;
+    }
+    std::sort( lat.begin(), lat.end() );
+
+    size_t n = lat.size();
+#define PCTL(p) ( n ? lat[std::min( n - 1, (size_t)( n * p ) )] : 0 )
+    printf( "%-7s %4d %4d %9zu %8.3f %10.0f %9.1f %8u %8u %8u %8u %8u %6d\n",
+            wl.name, cfg.threads, cfg.clients, n, secs, n / secs,
+            bytes / secs / ( 1024.0 * 1024.0 ), PCTL( 0.50 ), PCTL( 0.90 ),
+            PCTL( 0.99 ), PCTL( 0.999 ), n ? lat[n - 1] : 0, errors );
+#undef PCTL
+    fflush( stdout );
+    if( errors )
+      fprintf( stderr, "xrdbench: %s: %d error(s), last: %s\n", wl.name,
+               errors, lastError.c_str() );
+    return errors == 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Server management
+  //----------------------------------------------------------------------------
+  std::string benchDir;
+  pid_t       serverPid = 0;
+
+  int FreePort()
+  {
+    struct sockaddr_in sa;
+    socklen_t          sl = sizeof( sa );
+    int                fd = socket( AF_INET, SOCK_STREAM, 0 );
+    memset( &sa, 0, sizeof( sa ) );
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    if( fd < 0 || bind( fd, (struct sockaddr*)&sa, sizeof( sa ) )
+    ||  getsockname( fd, (struct sockaddr*)&sa, &sl ) )
+    {
+      if( fd >= 0 ) close( fd );
+      return -1;
+    }
+    close( fd );
+    return ntohs( sa.sin_port );
+  }
+
+  bool MakeFile( const std::string &path, long long size )
+  {
+    int fd = open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if( fd < 0 ) return false;
+    std::vector<char> buff( 1024*1024 );
+    unsigned int seed = 1;
+    for( size_t i = 0; i < buff.size(); ++i ) buff[i] = rand_r( &seed );
+    while( size > 0 )
+    {
+      size_t n = std::min( (long long)buff.size(), size );
+      if( write( fd, &buff[0], n ) != (ssize_t)n ) { close( fd ); return false; }
+      size -= n;
+    }
+    return close( fd ) == 0;
+  }
+
+  bool StartServer()
+  {
+    char dir[1024];
+    snprintf( dir, sizeof( dir ), "%s/xrdbench.%d", cfg.workDir.c_str(),
+              (int)getpid() );
+    benchDir = dir;
+    std::string data = benchDir + "/data", adm = benchDir + "/adm";
+    std::string small = data + "/xrdbench/small";
+    if( mkdir( dir, 0755 ) || mkdir( data.c_str(), 0755 )
+    ||  mkdir( adm.c_str(), 0755 ) || mkdir( ( data + "/xrdbench" ).c_str(), 0755 )
+    ||  mkdir( small.c_str(), 0755 ) )
+    {
+      fprintf( stderr, "xrdbench: unable to create %s; %s\n", dir,
+               strerror( errno ) );
+      return false;
+    }
+
+    printf( "# creating %d small files and a %lld MB file in %s\n",
+            cfg.smallFiles, cfg.fileSize >> 20, dir );
+    for( int i = 0; i < cfg.smallFiles; ++i )
+      if( !MakeFile( data + SmallPath( i ), 1024 ) ) return false;
+    if( !MakeFile( data + "/xrdbench/large.dat", cfg.fileSize ) )
+    {
+      fprintf( stderr, "xrdbench: unable to create the test files; %s\n",
+               strerror( errno ) );
+      return false;
+    }
+
+    int port = FreePort();
+    if( port < 0 ) return false;
+    std::string cfn = benchDir + "/xrootd.cf";
+    FILE *cf = fopen( cfn.c_str(), "w" );
+    if( !cf ) return false;
+    fprintf( cf, "xrd.port %d\n"
+                 "all.export /xrdbench\n"
+                 "oss.localroot %s\n"
+                 "all.adminpath %s\n"
+                 "all.pidpath %s\n", port, data.c_str(), adm.c_str(),
+                 adm.c_str() );
+    fclose( cf );
+
+    // Running as root the server must switch to an unprivileged user, which
+    // must then be able to get at the scratch directory.
+    //
+    std::vector<const char*> argv;
+    std::string log = benchDir + "/xrootd.log";
+    argv.push_back( cfg.xrootd.c_str() );
+    argv.push_back( "-c" ); argv.push_back( cfn.c_str() );
+    argv.push_back( "-l" ); argv.push_back( log.c_str() );
+    if( getuid() == 0 )
+    {
+      struct passwd *pw = getpwnam( "nobody" );
+      if( pw )
+      {
+        std::string paths[] = { benchDir, data, adm, data + "/xrdbench", small };
+        for( size_t i = 0; i < sizeof( paths ) / sizeof( paths[0] ); ++i )
+          if( chown( paths[i].c_str(), pw->pw_uid, pw->pw_gid ) ) {}
+        argv.push_back( "-R" ); argv.push_back( "nobody" );
+      }
+    }
+    argv.push_back( 0 );
+
+    if( ( serverPid = fork() ) < 0 ) return false;
+    if( !serverPid )
+    {
+      execv( argv[0], const_cast<char* const*>( &argv[0] ) );
+      execvp( argv[0], const_cast<char* const*>( &argv[0] ) );
+      fprintf( stderr, "xrdbench: unable to run %s; %s\n", argv[0],
+               strerror( errno ) );
+      _exit( 127 );
+    }
+
+    char url[64];
+    snprintf( url, sizeof( url ), "root://localhost:%d", port );
+    cfg.url = url;
+
+    // Wait for the server to come up
+    //
+    XrdCl::FileSystem fs( ( XrdCl::URL( cfg.url ) ) );
+    for( int i = 0; i < 100; ++i )
+    {
+      int status;
+      if( waitpid( serverPid, &status, WNOHANG ) == serverPid )
+      {
+        fprintf( stderr, "xrdbench: xrootd exited; see %s\n", log.c_str() );
+        serverPid = 0;
+        return false;
+      }
+      XrdCl::StatInfo *info = 0;
+      XrdCl::XRootDStatus st = fs.Stat( "/xrdbench/large.dat", info, 1 );
+      delete info;
+      if( st.IsOK() )
+      {
+        printf( "# xrootd pid %d serving %s\n", (int)serverPid, url );
+        return true;
+      }
+      usleep( 100000 );
+    }
+    fprintf( stderr, "xrdbench: xrootd did not come up; see %s\n", log.c_str() );
+    return false;
+  }
+
+  void StopServer()
+  {
+    if( serverPid )
+    {
+      kill( serverPid, SIGTERM );
+      waitpid( serverPid, 0, 0 );
+      serverPid = 0;
+    }
+    if( !benchDir.empty() && !cfg.keep )
+    {
+      std::string cmd = "rm -rf '" + benchDir + "'";
+      if( system( cmd.c_str() ) ) {}
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Usage
+  //----------------------------------------------------------------------------
+  void Usage( int rc )
+  {
+    fprintf( stderr,
+      "Usage: xrdbench [-b <bsz>] [-c <conns>] [-d <dir>] [-f <fsz>] [-k]\n"
+      "                [-m <files>] [-n <ops>] [-t <threads>] [-u <url>]\n"
+      "                [-v <segs>[,<maxseg>[,<window>]]] [-x <xrootd>]\n"
+      "                [<workload>[,<workload>...]]\n\n"
+      "-b  sequential read size (default 1m)\n"
+      "-c  number of distinct client connections (default 1)\n"
+      "-d  directory for the scratch area (default /dev/shm)\n"
+      "-f  size of the large file (default 256m)\n"
+      "-k  keep the scratch area\n"
+      "-m  number of small files (default 1000)\n"
+      "-n  operations per thread (default 2000)\n"
+      "-t  number of threads (default 8)\n"
+      "-u  use the server at url, which must already hold the test files\n"
+      "-v  vector read segments, maximum segment size and window\n"
+      "    (default 64,32k,8m)\n"
+      "-x  xrootd executable (default " XRDBENCH_XROOTD ")\n\n"
+      "Workloads:\n" );
+    for( int i = 0; i < numWorkloads; ++i )
+      fprintf( stderr, "  %-7s %s\n", workloads[i].name, workloads[i].what );
+    fprintf( stderr, "  all     all of the above (default)\n" );
+    exit( rc );
+  }
+
+  long long Size( const char *arg )
+  {
+    char *end;
+    long long val = strtoll( arg, &end, 10 );
+    switch( *end )
+    {
+      case 'k': case 'K': val <<= 10; end++; break;
+      case 'm': case 'M': val <<= 20; end++; break;
+      case 'g': case 'G': val <<= 30; end++; break;
+    }
+    if( *end || val <= 0 )
+    {
+      fprintf( stderr, "xrdbench: invalid size '%s'\n", arg );
+      Usage( 2 );
+    }
+    return val;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Main
+//------------------------------------------------------------------------------
+int main( int argc, char **argv )
+{
+  int c;
+  while( ( c = getopt( argc, argv, "b:c:d:f:hkm:n:t:u:v:x:" ) ) != -1 )
+  {
+    switch( c )
+    {
+      case 'b': cfg.blockSize  = Size( optarg );        break;
+      case 'c': cfg.clients    = Size( optarg );        break;
+      case 'd': cfg.workDir    = optarg;                break;
+      case 'f': cfg.fileSize   = Size( optarg );        break;
+      case 'k': cfg.keep       = true;                  break;
+      case 'm': cfg.smallFiles = Size( optarg );        break;
+      case 'n': cfg.ops        = Size( optarg );        break;
+      case 't': cfg.threads    = Size( optarg );        break;
+      case 'u': cfg.url        = optarg;                break;
+      case 'v':
+      {
+        std::string v( optarg );
+        size_t p = v.find( ',' );
+        cfg.vecSegs = Size( v.substr( 0, p ).c_str() );
+        if( p != std::string::npos )
+        {
+          v = v.substr( p + 1 );
+          p = v.find( ',' );
+          cfg.vecSegMax = Size( v.substr( 0, p ).c_str() );
+          if( p != std::string::npos )
+            cfg.vecWindow = Size( v.substr( p + 1 ).c_str() );
+        }
+        break;
+      }
+      case 'x': cfg.xrootd     = optarg;                break;
+      case 'h': Usage( 0 );                         break;
+      default:  Usage( 2 );
+    }
+  }
+  cfg.workloads = ( optind < argc ? argv[optind] : "all" );
+  if( cfg.vecSegMax < 128 || cfg.vecWindow <= cfg.vecSegMax
+  ||  cfg.blockSize > cfg.fileSize )
+  {
+    fprintf( stderr, "xrdbench: inconsistent read sizes\n" );
+    Usage( 2 );
+  }
+
+  // Pick the workloads
+  //
+  std::vector<Workload*> todo;
+  std::string wlist = "," + cfg.workloads + ",";
+  for( int i = 0; i < numWorkloads; ++i )
+    if( wlist == ",all," ||
+        wlist.find( std::string( "," ) + workloads[i].name + "," )
+        != std::string::npos )
+      todo.push_back( &workloads[i] );
+  if( todo.empty() )
+  {
+    fprintf( stderr, "xrdbench: no known workload in '%s'\n",
+             cfg.workloads.c_str() );
+    Usage( 2 );
+  }
+
+  seeds = new unsigned int[cfg.threads];
+  for( int i = 0; i < cfg.threads; ++i ) seeds[i] = 12345 + i;
+
+  // Get a server
+  //
+  if( cfg.url.empty() && !StartServer() )
+  {
+    StopServer();
+    return 3;
+  }
+  signal( SIGPIPE, SIG_IGN );
+
+  printf( "%-7s %4s %4s %9s %8s %10s %9s %8s %8s %8s %8s %8s %6s\n",
+          "#load", "thr", "conn", "ops", "secs", "ops/s", "MB/s", "p50us",
+          "p90us", "p99us", "p999us", "maxus", "errs" );
+  bool ok = true;
+  for( size_t i = 0; i < todo.size(); ++i )
+    if( !RunWorkload( *todo[i] ) ) ok = false;
+
+  StopServer();
+  return ok ? 0 : 1;
+}
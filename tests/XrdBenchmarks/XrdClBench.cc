@@ -0,0 +1,760 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------
+// xrdclbench measures the per request cost of the client machinery. The
+// in-memory benchmarks exercise the SID manager, the handler lookup in the
+// incoming queue and request marshalling directly. The round trip ones go
+// through the post master and the asynchronous socket handler against a fake
+// loopback server that answers with canned responses, so that the figures
+// are not dominated by a real storage back end.
+//------------------------------------------------------------------------------
+
+#include "Server.hh"
+#include "TestEnv.hh"
+
+#include "XProtocol/XProtocol.hh"
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClFileSystem.hh"
+#include "XrdCl/XrdClInQueue.hh"
+#include "XrdCl/XrdClMessage.hh"
+#include "XrdCl/XrdClMessageUtils.hh"
+#include "XrdCl/XrdClPostMasterInterfaces.hh"
+#include "XrdCl/XrdClSIDManager.hh"
+#include "XrdCl/XrdClXRootDResponses.hh"
+#include "XrdCl/XrdClXRootDTransport.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+//------------------------------------------------------------------------------
+// Count every heap allocation made by the process. Operator new goes through
+// malloc, so this covers both.
+//------------------------------------------------------------------------------
+namespace
+{
+  std::atomic<uint64_t> numAllocs( 0 );
+}
+
+#ifdef __GLIBC__
+extern "C"
+{
+  void *__libc_malloc( size_t size );
+  void *__libc_calloc( size_t n, size_t size );
+  void *__libc_realloc( void *ptr, size_t size );
+
+  void *malloc( size_t size )
+  {
+    numAllocs.fetch_add( 1, std::memory_order_relaxed );
+    return __libc_malloc( size );
+  }
+
+  void *calloc( size_t n, size_t size )
+  {
+    numAllocs.fetch_add( 1, std::memory_order_relaxed );
+    return __libc_calloc( n, size );
+  }
+
+  void *realloc( void *ptr, size_t size )
+  {
+    numAllocs.fetch_add( 1, std::memory_order_relaxed );
+    return __libc_realloc( ptr, size );
+  }
+}
+#endif
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Benchmark parameters
+  //----------------------------------------------------------------------------
+  struct Config
+  {
+    Config(): threads( 1 ), ops( 0 ), inflight( 256 ), readSize( 4096 ),
+              vecSegs( 64 ), vecSegSize( 4096 ), port( 0 ) {}
+
+    int threads;     // number of concurrent workers
+    int ops;         // operations per worker, 0 is the benchmark default
+    int inflight;    // outstanding handlers per worker in the inqueue test
+    int readSize;    // size of a plain read
+    int vecSegs;     // segments per vector read
+    int vecSegSize;  // size of a vector read segment
+    int port;        // port of the fake server
+  };
+
+  Config cfg;
+
+  struct Bench;
+  typedef bool (*BenchFunc)( Bench &bench, int wid, int ops );
+
+  struct Bench
+  {
+    const char *name;
+    const char *what;
+    int         defOps;     // default operations per worker
+    bool        remote;     // needs the fake server
+    BenchFunc   func;
+  };
+
+  //----------------------------------------------------------------------------
+  // Helpers
+  //----------------------------------------------------------------------------
+  inline uint64_t NowNS()
+  {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  }
+
+  std::string ServerURL()
+  {
+    char url[64];
+    snprintf( url, sizeof( url ), "root://127.0.0.1:%d", cfg.port );
+    return url;
+  }
+
+  bool Failed( const char *what, const XrdCl::XRootDStatus &st )
+  {
+    fprintf( stderr, "xrdclbench: %s failed; %s\n", what, st.ToStr().c_str() );
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  // SID allocation and release, the workers share one manager like the
+  // requests sent over one channel do
+  //----------------------------------------------------------------------------
+  XrdCl::SIDManager *sidMgr = 0;
+
+  bool BenchSID( Bench&, int, int ops )
+  {
+    uint8_t sid[2];
+    for( int i = 0; i < ops; ++i )
+    {
+      if( !sidMgr->AllocateSID( sid ).IsOK() ) return false;
+      sidMgr->ReleaseSID( sid );
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Handler registration and lookup in the incoming queue, each worker keeps
+  // its own window of outstanding requests
+  //----------------------------------------------------------------------------
+  class BenchMsgHandler: public XrdCl::IncomingMsgHandler
+  {
+    public:
+      BenchMsgHandler( uint16_t sid = 0 ): pSid( sid ) {}
+
+      virtual uint16_t Examine( XrdCl::Message* )
+      {
+        return Take | RemoveHandler;
+      }
+
+      virtual uint16_t GetSid() const { return pSid; }
+
+      void SetSid( uint16_t sid ) { pSid = sid; }
+
+    private:
+      uint16_t pSid;
+  };
+
+  XrdCl::InQueue *inQueue = 0;
+
+  bool BenchInQueue( Bench&, int wid, int ops )
+  {
+    std::vector<BenchMsgHandler> handlers( cfg.inflight );
+    std::vector<XrdCl::Message*> responses( cfg.inflight );
+    for( int i = 0; i < cfg.inflight; ++i )
+    {
+      uint16_t sid = wid * cfg.inflight + i + 1;
+      handlers[i].SetSid( sid );
+      responses[i] = new XrdCl::Message( 8 );
+      ServerResponseHeader *hdr =
+        (ServerResponseHeader*)responses[i]->GetBuffer();
+      memset( hdr, 0, 8 );
+      hdr->streamid[0] = sid & 0xff;
+      hdr->streamid[1] = sid >> 8;
+      inQueue->AddMessageHandler( &handlers[i], 0 );
+    }
+
+    bool ok = true;
+    for( int i = 0; i < ops; ++i )
+    {
+      int      n = i % cfg.inflight;
+      time_t   expires;
+      uint16_t action;
+      if( inQueue->GetHandlerForMessage( responses[n], expires, action )
+          != &handlers[n] )
+      {
+        fprintf( stderr, "xrdclbench: inqueue returned the wrong handler\n" );
+        ok = false;
+        break;
+      }
+      inQueue->AddMessageHandler( &handlers[n], 0 );
+    }
+
+    for( int i = 0; i < cfg.inflight; ++i )
+    {
+      inQueue->RemoveMessageHandler( &handlers[i] );
+      delete responses[i];
+    }
+    return ok;
+  }
+
+  //----------------------------------------------------------------------------
+  // Build a read request the way the file state handler does and marshall it
+  //----------------------------------------------------------------------------
+  bool BenchMarshall( Bench&, int, int ops )
+  {
+    uint8_t fhandle[4] = { 1, 2, 3, 4 };
+    for( int i = 0; i < ops; ++i )
+    {
+      XrdCl::Message    *msg;
+      ClientReadRequest *req;
+      XrdCl::MessageUtils::CreateRequest( msg, req );
+      req->requestid = kXR_read;
+      req->offset    = (uint64_t)i * 4096;
+      req->rlen      = 4096;
+      memcpy( req->fhandle, fhandle, 4 );
+      if( !XrdCl::XRootDTransport::MarshallRequest( msg ).IsOK() )
+      {
+        delete msg;
+        return false;
+      }
+      delete msg;
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // The request description that is attached to every message for logging
+  //----------------------------------------------------------------------------
+  bool BenchDescribe( Bench&, int, int ops )
+  {
+    XrdCl::Message    *msg;
+    ClientReadRequest *req;
+    XrdCl::MessageUtils::CreateRequest( msg, req );
+    req->requestid = kXR_read;
+    req->rlen      = 4096;
+    for( int i = 0; i < ops; ++i )
+    {
+      req->offset = (uint64_t)i * 4096;
+      XrdCl::XRootDTransport::SetDescription( msg );
+    }
+    delete msg;
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Round trips through the post master and the socket handler
+  //----------------------------------------------------------------------------
+  bool BenchPing( Bench&, int, int ops )
+  {
+    XrdCl::FileSystem fs( ( XrdCl::URL( ServerURL() ) ) );
+    for( int i = 0; i < ops; ++i )
+    {
+      XrdCl::XRootDStatus st = fs.Ping();
+      if( !st.IsOK() ) return Failed( "ping", st );
+    }
+    return true;
+  }
+
+  bool BenchRead( Bench&, int wid, int ops )
+  {
+    XrdCl::File f;
+    XrdCl::XRootDStatus st = f.Open( ServerURL() + "//bench/file",
+                                     XrdCl::OpenFlags::Read );
+    if( !st.IsOK() ) return Failed( "open", st );
+
+    std::vector<char> buff( cfg.readSize );
+    for( int i = 0; i < ops && st.IsOK(); ++i )
+    {
+      uint32_t got = 0;
+      st = f.Read( (uint64_t)( wid * ops + i ) * cfg.readSize, cfg.readSize,
+                   &buff[0], got );
+      if( st.IsOK() && got != (uint32_t)cfg.readSize )
+      {
+        fprintf( stderr, "xrdclbench: short read of %u bytes\n", got );
+        return false;
+      }
+    }
+    if( !st.IsOK() ) return Failed( "read", st );
+    st = f.Close();
+    return st.IsOK() ? true : Failed( "close", st );
+  }
+
+  //----------------------------------------------------------------------------
+  // Vector reads, where the response has to be split into the user chunks
+  //----------------------------------------------------------------------------
+  bool BenchReadV( Bench&, int, int ops )
+  {
+    XrdCl::File f;
+    XrdCl::XRootDStatus st = f.Open( ServerURL() + "//bench/file",
+                                     XrdCl::OpenFlags::Read );
+    if( !st.IsOK() ) return Failed( "open", st );
+
+    std::vector<char> buff( (size_t)cfg.vecSegs * cfg.vecSegSize );
+    XrdCl::ChunkList  chunks;
+    for( int i = 0; i < cfg.vecSegs; ++i )
+      chunks.push_back( XrdCl::ChunkInfo( (uint64_t)i * 3 * cfg.vecSegSize,
+                                          cfg.vecSegSize,
+                                          &buff[(size_t)i * cfg.vecSegSize] ) );
+    for( int i = 0; i < ops && st.IsOK(); ++i )
+    {
+      XrdCl::VectorReadInfo *info = 0;
+      st = f.VectorRead( chunks, 0, info );
+      delete info;
+    }
+    if( !st.IsOK() ) return Failed( "vector read", st );
+    st = f.Close();
+    return st.IsOK() ? true : Failed( "close", st );
+  }
+
+  Bench benches[] =
+  {
+    { "sid",      "allocate and release a stream id",    5000000, false,
+      BenchSID      },
+    { "inqueue",  "register and look up a handler",      5000000, false,
+      BenchInQueue  },
+    { "marshall", "build and marshall a read request",   2000000, false,
+      BenchMarshall },
+    { "describe", "format a request description",        1000000, false,
+      BenchDescribe },
+    { "ping",     "kXR_ping round trip",                   20000, true,
+      BenchPing     },
+    { "read",     "kXR_read round trip",                   20000, true,
+      BenchRead     },
+    { "readv",    "kXR_readv round trip",                  10000, true,
+      BenchReadV    }
+  };
+  const int numBenches = sizeof( benches ) / sizeof( benches[0] );
+
+  //----------------------------------------------------------------------------
+  // The fake server
+  //----------------------------------------------------------------------------
+  bool ReadAll( int sock, void *buff, size_t size )
+  {
+    char *bp = (char*)buff;
+    while( size )
+    {
+      ssize_t n = read( sock, bp, size );
+      if( n <= 0 )
+      {
+        if( n < 0 && errno == EINTR ) continue;
+        return false;
+      }
+      bp += n; size -= n;
+    }
+    return true;
+  }
+
+  bool WriteAll( int sock, const void *buff, size_t size )
+  {
+    const char *bp = (const char*)buff;
+    while( size )
+    {
+      ssize_t n = write( sock, bp, size );
+      if( n < 0 )
+      {
+        if( errno == EINTR ) continue;
+        return false;
+      }
+      bp += n; size -= n;
+    }
+    return true;
+  }
+
+  class BenchServerHandler: public XrdClTests::ClientHandler
+  {
+    public:
+      virtual void HandleConnection( int sock )
+      {
+        Serve( sock );
+        close( sock );
+      }
+
+    private:
+      bool Respond( int sock, const kXR_char *sid, uint16_t status,
+                    const void *body, uint32_t blen )
+      {
+        ServerResponseHeader hdr;
+        hdr.streamid[0] = sid[0];
+        hdr.streamid[1] = sid[1];
+        hdr.status      = htons( status );
+        hdr.dlen        = htonl( blen );
+        pOut.assign( (char*)&hdr, sizeof( hdr ) );
+        if( blen ) pOut.append( (const char*)body, blen );
+        return WriteAll( sock, pOut.data(), pOut.size() );
+      }
+
+      void Serve( int sock )
+      {
+        //----------------------------------------------------------------------
+        // The initial handshake
+        //----------------------------------------------------------------------
+        char hs[20];
+        if( !ReadAll( sock, hs, sizeof( hs ) ) ) return;
+        kXR_int32 hsResp[4] = { 0, (kXR_int32)htonl( 8 ),
+                                (kXR_int32)htonl( kXR_PROTOCOLVERSION ),
+                                (kXR_int32)htonl( kXR_DataServer ) };
+        if( !WriteAll( sock, hsResp, sizeof( hsResp ) ) ) return;
+
+        //----------------------------------------------------------------------
+        // Requests
+        //----------------------------------------------------------------------
+        std::vector<char> zeros( std::max( (size_t)cfg.readSize,
+                                           (size_t)cfg.vecSegSize ) );
+        std::vector<char> body;
+        ClientRequestHdr  req;
+        while( ReadAll( sock, &req, sizeof( req ) ) )
+        {
+          uint32_t dlen = ntohl( req.dlen );
+          body.resize( dlen );
+          if( dlen && !ReadAll( sock, &body[0], dlen ) ) return;
+
+          bool ok;
+          switch( ntohs( req.requestid ) )
+          {
+            case kXR_protocol:
+            {
+              kXR_int32 resp[2] = { (kXR_int32)htonl( kXR_PROTOCOLVERSION ),
+                                    (kXR_int32)htonl( kXR_isServer ) };
+              ok = Respond( sock, req.streamid, kXR_ok, resp, sizeof( resp ) );
+              break;
+            }
+            case kXR_login:
+            {
+              char sessid[16];
+              memset( sessid, 0, sizeof( sessid ) );
+              ok = Respond( sock, req.streamid, kXR_ok, sessid,
+                            sizeof( sessid ) );
+              break;
+            }
+            case kXR_open:
+            {
+              char resp[64];
+              memset( resp, 0, 12 );
+              int n = snprintf( resp + 12, sizeof( resp ) - 12,
+                                "1 1099511627776 0 0" );
+              ok = Respond( sock, req.streamid, kXR_ok, resp, 12 + n + 1 );
+              break;
+            }
+            case kXR_read:
+            {
+              ClientReadRequest *rr = (ClientReadRequest*)&req;
+              uint32_t rlen = std::min( (uint32_t)ntohl( rr->rlen ),
+                                        (uint32_t)zeros.size() );
+              ok = Respond( sock, req.streamid, kXR_ok, &zeros[0], rlen );
+              break;
+            }
+            case kXR_readv:
+            {
+              // Echo every segment header followed by its data
+              std::string resp;
+              for( size_t off = 0; off + sizeof( readahead_list ) <= dlen;
+                   off += sizeof( readahead_list ) )
+              {
+                readahead_list *rl = (readahead_list*)&body[off];
+                uint32_t rlen = std::min( (uint32_t)ntohl( rl->rlen ),
+                                          (uint32_t)zeros.size() );
+                rl->rlen = htonl( rlen );
+                resp.append( (char*)rl, sizeof( readahead_list ) );
+                resp.append( &zeros[0], rlen );
+              }
+              ok = Respond( sock, req.streamid, kXR_ok, resp.data(),
+                            resp.size() );
+              break;
+            }
+            case kXR_ping:
+            case kXR_close:
+              ok = Respond( sock, req.streamid, kXR_ok, 0, 0 );
+              break;
+            default:
+            {
+              char resp[64];
+              kXR_int32 err = htonl( kXR_Unsupported );
+              memcpy( resp, &err, 4 );
+              int n = snprintf( resp + 4, sizeof( resp ) - 4,
+                                "request not emulated" );
+              ok = Respond( sock, req.streamid, kXR_error, resp, 4 + n + 1 );
+              break;
+            }
+          }
+          if( !ok ) return;
+        }
+      }
+
+      std::string pOut;
+  };
+
+  class BenchServerFactory: public XrdClTests::ClientHandlerFactory
+  {
+    public:
+      virtual XrdClTests::ClientHandler *CreateHandler()
+      {
+        return new BenchServerHandler();
+      }
+  };
+
+  XrdClTests::Server *fakeServer = 0;
+
+  int FreePort()
+  {
+    struct sockaddr_in sa;
+    socklen_t          sl = sizeof( sa );
+    int                fd = socket( AF_INET, SOCK_STREAM, 0 );
+    memset( &sa, 0, sizeof( sa ) );
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    if( fd < 0 || bind( fd, (struct sockaddr*)&sa, sizeof( sa ) )
+    ||  getsockname( fd, (struct sockaddr*)&sa, &sl ) )
+    {
+      if( fd >= 0 ) close( fd );
+      return -1;
+    }
+    close( fd );
+    return ntohs( sa.sin_port );
+  }
+
+  //----------------------------------------------------------------------------
+  // The client shares one connection between all the workers, so the server
+  // has to accept just one client. The server thread is not joined; it goes
+  // away with the process.
+  //----------------------------------------------------------------------------
+  bool StartServer()
+  {
+    if( ( cfg.port = FreePort() ) < 0 ) return false;
+    fakeServer = new XrdClTests::Server( XrdClTests::Server::Inet4 );
+    if( !fakeServer->Setup( cfg.port, 1, new BenchServerFactory() )
+    ||  !fakeServer->Start() )
+    {
+      fprintf( stderr, "xrdclbench: unable to start the fake server\n" );
+      return false;
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Worker thread
+  //----------------------------------------------------------------------------
+  struct Worker
+  {
+    int                wid;
+    int                ops;
+    Bench             *bench;
+    bool               ok;
+    uint64_t           t0;
+    uint64_t           t1;
+    pthread_barrier_t *start;
+  };
+
+  //----------------------------------------------------------------------------
+  // The workers time themselves, the main thread may well be scheduled only
+  // after they are done
+  //----------------------------------------------------------------------------
+  void *RunWorker( void *arg )
+  {
+    Worker *w = static_cast<Worker*>( arg );
+    pthread_barrier_wait( w->start );
+    w->t0 = NowNS();
+    w->ok = w->bench->func( *w->bench, w->wid, w->ops );
+    w->t1 = NowNS();
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Run one benchmark and print a line of results
+  //----------------------------------------------------------------------------
+  bool RunBench( Bench &bench )
+  {
+    int ops = ( cfg.ops ? cfg.ops : bench.defOps );
+
+    //--------------------------------------------------------------------------
+    // Warm up so that connections, caches and free lists are in place
+    //--------------------------------------------------------------------------
+    if( !bench.func( bench, 0, std::max( ops / 100, 1 ) ) ) return false;
+
+    std::vector<Worker>    wv( cfg.threads );
+    std::vector<pthread_t> tv( cfg.threads );
+    pthread_barrier_t      start;
+
+    pthread_barrier_init( &start, 0, cfg.threads + 1 );
+    for( int i = 0; i < cfg.threads; ++i )
+    {
+      wv[i].wid = i; wv[i].ops = ops; wv[i].bench = &bench;
+      wv[i].ok = false; wv[i].start = &start;
+      if( pthread_create( &tv[i], 0, RunWorker, &wv[i] ) )
+      {
+        fprintf( stderr, "xrdclbench: unable to start thread; %s\n",
+                 strerror( errno ) );
+        exit( 4 );
+      }
+    }
+
+    uint64_t a0 = numAllocs.load( std::memory_order_relaxed );
+    pthread_barrier_wait( &start );
+    for( int i = 0; i < cfg.threads; ++i ) pthread_join( tv[i], 0 );
+    uint64_t na = numAllocs.load( std::memory_order_relaxed ) - a0;
+    pthread_barrier_destroy( &start );
+
+    bool     ok = true;
+    uint64_t t0 = wv[0].t0, t1 = wv[0].t1;
+    for( int i = 0; i < cfg.threads; ++i )
+    {
+      if( !wv[i].ok ) ok = false;
+      t0 = std::min( t0, wv[i].t0 );
+      t1 = std::max( t1, wv[i].t1 );
+    }
+    uint64_t ns = t1 - t0;
+
+    double total = (double)ops * cfg.threads;
+    printf( "%-9s %4d %10d %10.1f %12.0f %10.2f %s\n", bench.name,
+            cfg.threads, ops, ns / (double)ops, total / ( ns / 1e9 ),
+            na / total, ok ? "" : "FAILED" );
+    fflush( stdout );
+    return ok;
+  }
+
+  //----------------------------------------------------------------------------
+  // Usage
+  //----------------------------------------------------------------------------
+  void Usage( int rc )
+  {
+    fprintf( stderr,
+      "Usage: xrdclbench [-b <rsz>] [-i <inflight>] [-n <ops>] [-t <threads>]\n"
+      "                  [-v <segs>[,<segsz>]] [<bench>[,<bench>...]]\n\n"
+      "-b  size of a plain read (default 4k)\n"
+      "-i  outstanding handlers per thread for inqueue (default 256)\n"
+      "-n  operations per thread (default depends on the benchmark)\n"
+      "-t  number of threads (default 1)\n"
+      "-v  vector read segments and segment size (default 64,4k)\n\n"
+      "ns/op is the wall time per operation of one thread, allocs/op counts\n"
+      "the heap allocations made by the whole process, client threads\n"
+      "included.\n\n"
+      "Benchmarks:\n" );
+    for( int i = 0; i < numBenches; ++i )
+      fprintf( stderr, "  %-9s %s\n", benches[i].name, benches[i].what );
+    fprintf( stderr, "  all       all of the above (default)\n" );
+    exit( rc );
+  }
+
+  long long Size( const char *arg )
+  {
+    char *end;
+    long long val = strtoll( arg, &end, 10 );
+    switch( *end )
+    {
+      case 'k': case 'K': val <<= 10; end++; break;
+      case 'm': case 'M': val <<= 20; end++; break;
+    }
+    if( *end || val <= 0 || val > 0x7fffffff )
+    {
+      fprintf( stderr, "xrdclbench: invalid size '%s'\n", arg );
+      Usage( 2 );
+    }
+    return val;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Main
+//------------------------------------------------------------------------------
+int main( int argc, char **argv )
+{
+  int c;
+  while( ( c = getopt( argc, argv, "b:hi:n:t:v:" ) ) != -1 )
+  {
+    switch( c )
+    {
+      case 'b': cfg.readSize = Size( optarg );          break;
+      case 'i': cfg.inflight = Size( optarg );          break;
+      case 'n': cfg.ops      = Size( optarg );          break;
+      case 't': cfg.threads  = Size( optarg );          break;
+      case 'v':
+      {
+        std::string v( optarg );
+        size_t p = v.find( ',' );
+        cfg.vecSegs = Size( v.substr( 0, p ).c_str() );
+        if( p != std::string::npos )
+          cfg.vecSegSize = Size( v.substr( p + 1 ).c_str() );
+        break;
+      }
+      case 'h': Usage( 0 );                             break;
+      default:  Usage( 2 );
+    }
+  }
+  if( cfg.inflight * cfg.threads >= 0xffff )
+  {
+    fprintf( stderr, "xrdclbench: too many outstanding handlers\n" );
+    Usage( 2 );
+  }
+
+  // Pick the benchmarks
+  //
+  std::vector<Bench*> todo;
+  std::string blist = "," + std::string( optind < argc ? argv[optind] : "all" )
+                    + ",";
+  bool remote = false;
+  for( int i = 0; i < numBenches; ++i )
+    if( blist == ",all," ||
+        blist.find( std::string( "," ) + benches[i].name + "," )
+        != std::string::npos )
+    {
+      todo.push_back( &benches[i] );
+      if( benches[i].remote ) remote = true;
+    }
+  if( todo.empty() )
+  {
+    fprintf( stderr, "xrdclbench: no known benchmark in '%s'\n",
+             blist.c_str() );
+    Usage( 2 );
+  }
+
+  signal( SIGPIPE, SIG_IGN );
+  sidMgr  = new XrdCl::SIDManager();
+  inQueue = new XrdCl::InQueue();
+  if( remote && !StartServer() ) return 3;
+
+  printf( "%-9s %4s %10s %10s %12s %10s\n", "#bench", "thr", "ops", "ns/op",
+          "ops/s", "allocs/op" );
+  bool ok = true;
+  for( size_t i = 0; i < todo.size(); ++i )
+    if( !RunBench( *todo[i] ) ) ok = false;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,1118 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------
+// xrdcmsbench measures how a cmsd manager scales. It logs in a number of
+// emulated data servers, which answer the manager's state, usage, space and
+// ping requests according to a file presence and a load model, and then drives
+// selects and locates through director logins, the way an xrootd redirector
+// does. Unless a manager is given, it starts the cmsd built next to it.
+//------------------------------------------------------------------------------
+
+#include "XProtocol/YProtocol.hh"
+#include "XrdCms/XrdCmsParser.hh"
+#include "XrdCms/XrdCmsRRData.hh"
+#include "XrdCms/XrdCmsTypes.hh"
+#include "XrdOuc/XrdOucPup.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <pwd.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+
+#ifndef XRDBENCH_CMSD
+#define XRDBENCH_CMSD "cmsd"
+#endif
+
+using namespace XrdCms;
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Benchmark parameters
+  //----------------------------------------------------------------------------
+  struct Config
+  {
+    Config(): cmsd( XRDBENCH_CMSD ), workDir( "/dev/shm" ), servers( 32 ),
+              files( 100000 ), replicas( 2 ), pending( 0 ), missing( 0 ),
+              stateDelay( 0 ), loadBase( 20 ), loadSpread( 10 ),
+              loadSkew( 0 ), batchq( false ), directors( 4 ), window( 32 ),
+              ops( 20000 ), rate( 0 ), ops2( "read" ), keep( false ) {}
+
+    std::string cmsd;        // path to the cmsd executable
+    std::string workDir;     // where the scratch directory is created
+    std::string manager;     // use this manager instead of starting one
+    std::string extra;       // additional directives for the started cmsd
+    int         servers;     // number of emulated data servers
+    int         files;       // size of the name space
+    int         replicas;    // servers holding each file
+    int         pending;     // percent of replicas reported as pending
+    int         missing;     // percent of requests for files nobody has
+    int         stateDelay;  // microseconds a server takes to answer a state
+    int         loadBase;    // load reported by the servers (percent)
+    int         loadSpread;  // random variation of the load
+    int         loadSkew;    // additional load of the last server
+    bool        batchq;      // servers accept batched state queries
+    int         directors;   // number of director logins
+    int         window;      // outstanding requests per director
+    int         ops;         // requests per director
+    int         rate;        // total requests per second, 0 for no limit
+    std::string ops2;        // comma separated list of request kinds
+    bool        keep;        // keep the scratch directory
+  };
+
+  Config          cfg;
+  std::string     manHost = "localhost";
+  int             manPort = 0;
+  volatile bool   stopping = false;
+
+  const int       basePort = 40000;   // data ports given to emulated servers
+
+  //----------------------------------------------------------------------------
+  // Helpers
+  //----------------------------------------------------------------------------
+  inline uint64_t NowNS()
+  {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  }
+
+  int Connect()
+  {
+    struct addrinfo hints, *res = 0;
+    char port[16];
+    memset( &hints, 0, sizeof( hints ) );
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf( port, sizeof( port ), "%d", manPort );
+    if( getaddrinfo( manHost.c_str(), port, &hints, &res ) || !res ) return -1;
+    int fd = socket( res->ai_family, SOCK_STREAM, 0 );
+    if( fd >= 0 && connect( fd, res->ai_addr, res->ai_addrlen ) )
+    {
+      close( fd );
+      fd = -1;
+    }
+    freeaddrinfo( res );
+    if( fd >= 0 )
+    {
+      int one = 1;
+      setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof( one ) );
+    }
+    return fd;
+  }
+
+  bool RecvAll( int fd, char *buff, int blen )
+  {
+    while( blen > 0 )
+    {
+      ssize_t n = recv( fd, buff, blen, 0 );
+      if( n <= 0 )
+      {
+        if( n < 0 && errno == EINTR ) continue;
+        return false;
+      }
+      buff += n; blen -= n;
+    }
+    return true;
+  }
+
+  bool SendAll( int fd, struct iovec *iov, int iovcnt )
+  {
+    while( iovcnt > 0 )
+    {
+      ssize_t n = writev( fd, iov, iovcnt );
+      if( n < 0 )
+      {
+        if( errno == EINTR ) continue;
+        return false;
+      }
+      while( iovcnt > 0 && n >= (ssize_t)iov->iov_len )
+      {
+        n -= iov->iov_len; iov++; iovcnt--;
+      }
+      if( iovcnt > 0 )
+      {
+        iov->iov_base = (char*)iov->iov_base + n;
+        iov->iov_len -= n;
+      }
+    }
+    return true;
+  }
+
+  bool Send( int fd, CmsRRHdr hdr, const char *data, int dlen )
+  {
+    struct iovec iov[2];
+    hdr.datalen = htons( static_cast<unsigned short>( dlen ) );
+    iov[0].iov_base = (char*)&hdr;         iov[0].iov_len = sizeof( hdr );
+    iov[1].iov_base = const_cast<char*>( data ); iov[1].iov_len = dlen;
+    return SendAll( fd, iov, dlen ? 2 : 1 );
+  }
+
+  //----------------------------------------------------------------------------
+  // Receive one message; the body is null terminated for convenience
+  //----------------------------------------------------------------------------
+  bool Recv( int fd, CmsRRHdr &hdr, std::vector<char> &body, int &dlen )
+  {
+    if( !RecvAll( fd, (char*)&hdr, sizeof( hdr ) ) ) return false;
+    dlen = ntohs( hdr.datalen );
+    if( (int)body.size() < dlen + 1 ) body.resize( dlen + 1 );
+    if( dlen && !RecvAll( fd, &body[0], dlen ) ) return false;
+    body[dlen] = 0;
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Log in as the XrdCmsLogin client side does and check the reply
+  //----------------------------------------------------------------------------
+  bool Login( int fd, CmsLoginData &data, std::string &err )
+  {
+    static const int xNum = 20;
+    struct iovec iov[xNum];
+    char         work[xNum*12];
+    CmsRRHdr     hdr = { 0, kYR_login, 0, 0 };
+    int          iovcnt;
+
+    data.Version = kYR_Version;
+    if( !( iovcnt = Parser.Pack( kYR_login, &iov[1], &iov[xNum],
+                                 (char*)&data, work ) ) )
+    {
+      err = "unable to pack login data";
+      return false;
+    }
+    hdr.datalen = data.Size;
+    iov[0].iov_base = (char*)&hdr; iov[0].iov_len = sizeof( hdr );
+    if( !SendAll( fd, iov, iovcnt + 1 ) )
+    {
+      err = strerror( errno );
+      return false;
+    }
+
+    std::vector<char> body;
+    int dlen;
+    if( !Recv( fd, hdr, body, dlen ) )
+    {
+      err = "login rejected";
+      return false;
+    }
+    if( hdr.rrCode == kYR_error && dlen > (int)sizeof( kXR_unt32 ) )
+      err = &body[sizeof( kXR_unt32 )];
+    else if( hdr.rrCode == kYR_try )
+      err = "asked to try another manager";
+    else if( hdr.rrCode != kYR_login )
+      err = "unexpected login response";
+    else return true;
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  // The file presence model. Files are spread round robin by name hash, each
+  // one held by cfg.replicas consecutive servers, and a fraction of the copies
+  // is reported as pending (i.e. being staged). The probe file is everywhere.
+  //----------------------------------------------------------------------------
+  const char *probePath = "/cmsbench/probe";
+
+  std::string FilePath( int n, bool miss )
+  {
+    char path[64];
+    snprintf( path, sizeof( path ), "/cmsbench/%c%07d", miss ? 'm' : 'f', n );
+    return path;
+  }
+
+  int Holds( int server, const char *path )
+  {
+    if( !strcmp( path, probePath ) ) return CmsHaveRequest::Online;
+    if( strncmp( path, "/cmsbench/f", 11 ) ) return 0;
+
+    uint32_t h = 2166136261U;
+    for( const char *p = path; *p; ++p ) h = ( h ^ (unsigned char)*p ) * 16777619U;
+    int first = h % cfg.servers;
+    if( ( server - first + cfg.servers ) % cfg.servers >= cfg.replicas ) return 0;
+    return ( ( h >> 8 ) + server ) % 100 < (uint32_t)cfg.pending
+           ? CmsHaveRequest::Pending : CmsHaveRequest::Online;
+  }
+
+  //----------------------------------------------------------------------------
+  // Emulated data server
+  //----------------------------------------------------------------------------
+  enum SrvCount { sState, sStateV, sSVPaths, sPing, sUsage, sSpace, sOther,
+                  sHave, sHaveV, sNumCounts };
+  const char *srvCountName[] = { "state", "statev", "svpaths", "ping", "usage",
+                                 "space", "other", "have", "havev" };
+
+  struct DataServer
+  {
+    DataServer(): idx( 0 ), fd( -1 ), state( 0 ), seed( 0 )
+    { memset( counts, 0, sizeof( counts ) ); }
+    int          idx;
+    int          fd;
+    volatile int state;      // 0 logging in, 1 logged in, -1 failed
+    unsigned int seed;
+    long long    counts[sNumCounts];
+    pthread_t    tid;
+    std::string  err;
+  };
+
+  int Load( DataServer *ds, int scale )
+  {
+    int skew = ( cfg.servers > 1 ? cfg.loadSkew * ds->idx / ( cfg.servers - 1 )
+                                 : 0 );
+    int val  = cfg.loadBase + skew;
+    if( cfg.loadSpread )
+      val += rand_r( &ds->seed ) % ( 2 * cfg.loadSpread + 1 ) - cfg.loadSpread;
+    val = val * scale / 100;
+    return std::max( 0, std::min( 100, val ) );
+  }
+
+  void SendLoad( DataServer *ds )
+  {
+    CmsRRHdr hdr = { 0, kYR_load, 0, 0 };
+    char loadbuff[CmsLoadRequest::numLoad];
+    char respbuff[sizeof( loadbuff ) + 2 + sizeof( int ) + 2], *bp = respbuff;
+    int  blen;
+
+    loadbuff[CmsLoadRequest::cpuLoad] = static_cast<char>( Load( ds, 100 ) );
+    loadbuff[CmsLoadRequest::netLoad] = static_cast<char>( Load( ds, 50 ) );
+    loadbuff[CmsLoadRequest::xeqLoad] = static_cast<char>( Load( ds, 50 ) );
+    loadbuff[CmsLoadRequest::memLoad] = static_cast<char>( Load( ds, 30 ) );
+    loadbuff[CmsLoadRequest::pagLoad] = 0;
+    loadbuff[CmsLoadRequest::dskLoad] = static_cast<char>( Load( ds, 100 ) );
+    blen  = XrdOucPup::Pack( &bp, loadbuff, sizeof( loadbuff ) );
+    blen += XrdOucPup::Pack( &bp, 1024*1024U );
+    Send( ds->fd, hdr, respbuff, blen );
+  }
+
+  void SendAvail( DataServer *ds )
+  {
+    CmsRRHdr hdr = { 0, kYR_avail, 0, 0 };
+    char buff[sizeof( int )*2 + 2], *bp = buff;
+    int  blen;
+
+    blen  = XrdOucPup::Pack( &bp, 1024*1024U );
+    blen += XrdOucPup::Pack( &bp, (unsigned int)Load( ds, 100 ) );
+    Send( ds->fd, hdr, buff, blen );
+  }
+
+  void *RunServer( void *arg )
+  {
+    DataServer       *ds = static_cast<DataServer*>( arg );
+    CmsRRHdr          hdr;
+    std::vector<char> body, bmap;
+    char              sid[64];
+    int               dlen;
+
+    snprintf( sid, sizeof( sid ), "xrdcmsbench-%d-%d", (int)getpid(), ds->idx );
+    CmsLoginData data;
+    memset( &data, 0, sizeof( data ) );
+    data.Mode     = CmsLoginData::kYR_server
+                  | ( cfg.batchq ? (int)CmsLoginData::kYR_batchq : 0 );
+    data.HoldTime = static_cast<int>( getpid() );
+    data.tSpace   = 1024;
+    data.fSpace   = 1024*1024;
+    data.mSpace   = 1024;
+    data.fsNum    = 1;
+    data.fsUtil   = 10;
+    data.dPort    = basePort + ds->idx;
+    data.SID      = (kXR_char*)sid;
+    data.Paths    = (kXR_char*)"w /cmsbench\n";
+
+    if( ( ds->fd = Connect() ) < 0 )
+    {
+      ds->err = strerror( errno );
+      ds->state = -1;
+      return 0;
+    }
+    if( !Login( ds->fd, data, ds->err ) )
+    {
+      ds->state = -1;
+      return 0;
+    }
+    ds->state = 1;
+
+    while( Recv( ds->fd, hdr, body, dlen ) )
+    {
+      switch( hdr.rrCode )
+      {
+        case kYR_state:
+        {
+          ds->counts[sState]++;
+          char *path = &body[0], *bp = path;
+          int   plen = dlen;
+          if( !( hdr.modifier & kYR_raw )
+          &&  !XrdOucPup::Unpack( &bp, bp + dlen, &path, plen ) ) break;
+          int have = Holds( ds->idx, path );
+          if( !have || hdr.modifier & CmsStateRequest::kYR_noresp ) break;
+          if( cfg.stateDelay ) usleep( cfg.stateDelay );
+          hdr.rrCode   = kYR_have;
+          hdr.modifier = static_cast<kXR_char>( have | kYR_raw );
+          Send( ds->fd, hdr, path, strlen( path ) + 1 );
+          ds->counts[sHave]++;
+          break;
+        }
+        case kYR_statev:
+        {
+          ds->counts[sStateV]++;
+          bmap.assign( dlen / 4 + 1, 0 );
+          int n = 0, found = 0;
+          for( char *p = &body[0]; p < &body[0] + dlen; p += strlen( p ) + 1, n++ )
+          {
+            int have = Holds( ds->idx, p );
+            if( have ) found++;
+            bmap[n >> 2] |= have << ( ( n & 3 ) << 1 );
+          }
+          ds->counts[sSVPaths] += n;
+          if( !found ) break;
+          if( cfg.stateDelay ) usleep( cfg.stateDelay );
+          hdr.rrCode   = kYR_havev;
+          hdr.modifier = kYR_raw;
+          Send( ds->fd, hdr, &bmap[0], ( n + 3 ) / 4 );
+          ds->counts[sHaveV]++;
+          break;
+        }
+        case kYR_ping:
+          ds->counts[sPing]++;
+          hdr.rrCode = kYR_pong; hdr.modifier = 0;
+          Send( ds->fd, hdr, 0, 0 );
+          break;
+        case kYR_usage:
+          ds->counts[sUsage]++;
+          SendLoad( ds );
+          break;
+        case kYR_space:
+          ds->counts[sSpace]++;
+          SendAvail( ds );
+          break;
+        case kYR_try:
+          ds->err   = "turned away by the manager";
+          ds->state = -1;
+          return 0;
+        default:
+          ds->counts[sOther]++;
+      }
+    }
+    if( !stopping )
+    {
+      ds->err   = "manager closed the connection";
+      ds->state = -1;
+    }
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Director side
+  //----------------------------------------------------------------------------
+  enum Outcome { oRedirect, oWait, oError, oData, oLost, oNumOutcomes };
+  const char *outcomeName[] = { "redirect", "wait", "error", "data", "lost" };
+
+  struct Request
+  {
+    const char *name;
+    int         code;
+    unsigned    opts;
+  };
+
+  Request requests[] =
+  {
+    { "read",   kYR_select, 0                           },
+    { "stat",   kYR_select, CmsSelectRequest::kYR_stat  },
+    { "write",  kYR_select, CmsSelectRequest::kYR_write },
+    { "locate", kYR_locate, 0                           }
+  };
+  const int numRequests = sizeof( requests ) / sizeof( requests[0] );
+  std::vector<Request*> mix;
+
+  struct Slot
+  {
+    Slot(): gen( 0 ), busy( false ), t0( 0 ), rq( 0 ), file( 0 ),
+            miss( false ) {}
+    unsigned gen;
+    bool     busy;
+    uint64_t t0;
+    Request *rq;
+    int      file;
+    bool     miss;
+  };
+
+  struct Director
+  {
+    Director(): idx( 0 ), fd( -1 ), ok( false ), seed( 0 ), waitResp( 0 ),
+                unmatched( 0 ), misdirected( 0 ), t0( 0 ), t1( 0 ) {}
+    int                   idx;
+    int                   fd;
+    bool                  ok;
+    unsigned int          seed;
+    std::vector<uint32_t> latency[oNumOutcomes];   // microseconds
+    std::vector<long long> perServer;              // redirects per server
+    long long             waitResp;
+    long long             unmatched;
+    long long             misdirected;
+    uint64_t              t0, t1;
+    pthread_t             tid;
+    pthread_barrier_t    *start;
+    std::string           err;
+  };
+
+  bool SendRequest( Director *dir, Request *rq, unsigned sid,
+                    const std::string &path )
+  {
+    static const int xNum = 8;
+    struct iovec iov[xNum];
+    char         work[xNum*12];
+    XrdCmsRRData data;
+    int          iovcnt;
+
+    memset( (void*)&data, 0, sizeof( data ) );
+    data.Ident = const_cast<char*>( "" );
+    data.Opts  = rq->opts;
+    data.Path  = const_cast<char*>( path.c_str() );
+    if( !( iovcnt = Parser.Pack( rq->code, &iov[1], &iov[xNum], (char*)&data,
+                                 work ) ) ) return false;
+    data.Request.streamid = sid;
+    data.Request.rrCode   = static_cast<kXR_char>( rq->code );
+    data.Request.modifier = 0;
+    iov[0].iov_base = (char*)&data.Request;
+    iov[0].iov_len  = sizeof( data.Request );
+    return SendAll( dir->fd, iov, iovcnt + 1 );
+  }
+
+  bool DirectorLogin( Director *dir )
+  {
+    CmsLoginData data;
+    memset( &data, 0, sizeof( data ) );
+    data.Mode     = CmsLoginData::kYR_director;
+    data.HoldTime = static_cast<int>( getpid() );
+    if( ( dir->fd = Connect() ) < 0 )
+    {
+      dir->err = strerror( errno );
+      return false;
+    }
+    return Login( dir->fd, data, dir->err );
+  }
+
+  //----------------------------------------------------------------------------
+  // Keep a window of requests outstanding, optionally paced to a rate, and
+  // match the replies (which may come out of order) by stream id.
+  //----------------------------------------------------------------------------
+  void *RunDirector( void *arg )
+  {
+    Director         *dir = static_cast<Director*>( arg );
+    std::vector<Slot> slots( cfg.window );
+    std::vector<int>  freeSlots;
+    std::vector<char> body;
+    CmsRRHdr          hdr;
+    int               dlen, sent = 0, done = 0;
+    uint64_t          interval = 0, due;
+
+    for( int i = cfg.window - 1; i >= 0; --i ) freeSlots.push_back( i );
+    for( int i = 0; i < oNumOutcomes; ++i ) dir->latency[i].reserve( cfg.ops );
+    dir->perServer.assign( cfg.servers, 0 );
+    if( cfg.rate ) interval = 1000000000ULL * cfg.directors / cfg.rate;
+
+    pthread_barrier_wait( dir->start );
+    dir->t0 = due = NowNS();
+    while( done < cfg.ops )
+    {
+      uint64_t now = NowNS();
+      while( sent < cfg.ops && !freeSlots.empty() && ( !interval || now >= due ) )
+      {
+        int   s  = freeSlots.back();
+        Slot &sl = slots[s];
+        freeSlots.pop_back();
+        sl.busy = true; sl.gen++;
+        sl.miss = cfg.missing &&
+                  (int)( rand_r( &dir->seed ) % 100 ) < cfg.missing;
+        sl.file = rand_r( &dir->seed ) % cfg.files;
+        sl.t0   = now;
+        sl.rq   = mix[sent % mix.size()];
+        if( !SendRequest( dir, sl.rq, ( ( sl.gen & 0xffff ) << 16 ) | s,
+                          FilePath( sl.file, sl.miss ) ) )
+        {
+          dir->err = "unable to send request";
+          dir->t1 = NowNS();
+          return 0;
+        }
+        sent++;
+        if( interval ) due += interval;
+        now = NowNS();
+      }
+
+      struct pollfd pfd = { dir->fd, POLLIN, 0 };
+      int timeout = 30000;
+      if( interval && sent < cfg.ops && !freeSlots.empty() )
+        timeout = due > now ? ( due - now ) / 1000000 : 0;
+      int rc = poll( &pfd, 1, timeout );
+      if( rc < 0 && errno == EINTR ) continue;
+      if( rc == 0 && timeout == 30000 ) break;
+      if( rc == 0 ) continue;
+      if( !Recv( dir->fd, hdr, body, dlen ) )
+      {
+        dir->err = "manager closed the connection";
+        break;
+      }
+
+      if( hdr.rrCode == kYR_ping )
+      {
+        hdr.rrCode = kYR_pong;
+        Send( dir->fd, hdr, 0, 0 );
+        continue;
+      }
+      if( hdr.rrCode == kYR_waitresp && !( hdr.modifier & CmsResponse::kYR_async ) )
+      {
+        dir->waitResp++;
+        continue;
+      }
+
+      unsigned s = hdr.streamid & 0xffff;
+      if( s >= slots.size() || !slots[s].busy
+      ||  ( slots[s].gen & 0xffff ) != ( hdr.streamid >> 16 ) )
+      {
+        dir->unmatched++;
+        continue;
+      }
+      Slot &sl = slots[s];
+      int outcome;
+      switch( hdr.rrCode )
+      {
+        case kYR_redirect:
+        {
+          outcome = oRedirect;
+          kXR_unt32 port;
+          if( dlen < (int)sizeof( port ) ) break;
+          memcpy( &port, &body[0], sizeof( port ) );
+          int srv = (int)ntohl( port ) - basePort;
+          if( srv >= 0 && srv < cfg.servers )
+          {
+            dir->perServer[srv]++;
+            if( sl.rq->opts != CmsSelectRequest::kYR_write
+            &&  !Holds( srv, FilePath( sl.file, sl.miss ).c_str() ) )
+              dir->misdirected++;
+          }
+          break;
+        }
+        case kYR_wait:  outcome = oWait;  break;
+        case kYR_data:  outcome = oData;  break;
+        default:        outcome = oError; break;
+      }
+      dir->latency[outcome].push_back( ( NowNS() - sl.t0 ) / 1000 );
+      sl.busy = false;
+      freeSlots.push_back( s );
+      done++;
+    }
+    dir->t1 = NowNS();
+    for( size_t i = 0; i < slots.size(); ++i )
+      if( slots[i].busy ) dir->latency[oLost].push_back( 0 );
+    if( done + (int)dir->latency[oLost].size() < cfg.ops && dir->err.empty() )
+      dir->err = "no reply for 30 seconds";
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Wait until the manager redirects a select for the probe file
+  //----------------------------------------------------------------------------
+  bool WaitReady()
+  {
+    Director dir;
+    if( !DirectorLogin( &dir ) )
+    {
+      fprintf( stderr, "xrdcmsbench: director login failed; %s\n",
+               dir.err.c_str() );
+      return false;
+    }
+    std::vector<char> body;
+    CmsRRHdr hdr;
+    int dlen;
+    bool ready = false;
+    for( int i = 0; i < 300 && !ready; ++i )
+    {
+      if( !SendRequest( &dir, &requests[0], 1, probePath ) ) break;
+      do
+      {
+        if( !Recv( dir.fd, hdr, body, dlen ) ) { i = 300; break; }
+      } while( hdr.streamid != 1 || hdr.rrCode == kYR_waitresp );
+      if( hdr.rrCode == kYR_redirect ) ready = true;
+      else usleep( 100000 );
+    }
+    close( dir.fd );
+    if( !ready ) fprintf( stderr, "xrdcmsbench: manager never redirected\n" );
+    return ready;
+  }
+
+  //----------------------------------------------------------------------------
+  // Manager management
+  //----------------------------------------------------------------------------
+  std::string benchDir;
+  pid_t       cmsdPid = 0;
+
+  int FreePort()
+  {
+    struct sockaddr_in sa;
+    socklen_t          sl = sizeof( sa );
+    int                fd = socket( AF_INET, SOCK_STREAM, 0 );
+    memset( &sa, 0, sizeof( sa ) );
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    if( fd < 0 || bind( fd, (struct sockaddr*)&sa, sizeof( sa ) )
+    ||  getsockname( fd, (struct sockaddr*)&sa, &sl ) )
+    {
+      if( fd >= 0 ) close( fd );
+      return -1;
+    }
+    close( fd );
+    return ntohs( sa.sin_port );
+  }
+
+  bool StartManager()
+  {
+    char dir[1024];
+    snprintf( dir, sizeof( dir ), "%s/xrdcmsbench.%d", cfg.workDir.c_str(),
+              (int)getpid() );
+    benchDir = dir;
+    std::string adm = benchDir + "/adm";
+    if( mkdir( dir, 0755 ) || mkdir( adm.c_str(), 0755 ) )
+    {
+      fprintf( stderr, "xrdcmsbench: unable to create %s; %s\n", dir,
+               strerror( errno ) );
+      return false;
+    }
+
+    if( ( manPort = FreePort() ) < 0 ) return false;
+    std::string cfn = benchDir + "/cmsd.cf";
+    FILE *cf = fopen( cfn.c_str(), "w" );
+    if( !cf ) return false;
+    fprintf( cf, "all.role manager\n"
+                 "all.manager localhost:%d\n"
+                 "all.export /cmsbench\n"
+                 "all.adminpath %s\n"
+                 "all.pidpath %s\n"
+                 "cms.delay startup 1 servers %d service 1\n%s\n",
+                 manPort, adm.c_str(), adm.c_str(),
+                 std::min( cfg.servers, STMax ), cfg.extra.c_str() );
+    fclose( cf );
+
+    std::vector<const char*> argv;
+    std::string log = benchDir + "/cmsd.log";
+    argv.push_back( cfg.cmsd.c_str() );
+    argv.push_back( "-c" ); argv.push_back( cfn.c_str() );
+    argv.push_back( "-l" ); argv.push_back( log.c_str() );
+    if( getuid() == 0 )
+    {
+      struct passwd *pw = getpwnam( "nobody" );
+      if( pw )
+      {
+        if( chown( dir, pw->pw_uid, pw->pw_gid ) ) {}
+        if( chown( adm.c_str(), pw->pw_uid, pw->pw_gid ) ) {}
+        argv.push_back( "-R" ); argv.push_back( "nobody" );
+      }
+    }
+    argv.push_back( 0 );
+
+    if( ( cmsdPid = fork() ) < 0 ) return false;
+    if( !cmsdPid )
+    {
+      execv( argv[0], const_cast<char* const*>( &argv[0] ) );
+      execvp( argv[0], const_cast<char* const*>( &argv[0] ) );
+      fprintf( stderr, "xrdcmsbench: unable to run %s; %s\n", argv[0],
+               strerror( errno ) );
+      _exit( 127 );
+    }
+
+    // Wait for the manager to listen
+    //
+    for( int i = 0; i < 100; ++i )
+    {
+      int status, fd;
+      if( waitpid( cmsdPid, &status, WNOHANG ) == cmsdPid )
+      {
+        fprintf( stderr, "xrdcmsbench: cmsd exited; see %s\n", log.c_str() );
+        cmsdPid = 0;
+        return false;
+      }
+      if( ( fd = Connect() ) >= 0 )
+      {
+        close( fd );
+        printf( "# cmsd pid %d managing localhost:%d\n", (int)cmsdPid,
+                manPort );
+        return true;
+      }
+      usleep( 100000 );
+    }
+    fprintf( stderr, "xrdcmsbench: cmsd did not come up; see %s\n",
+             log.c_str() );
+    return false;
+  }
+
+  void StopManager()
+  {
+    if( cmsdPid )
+    {
+      kill( cmsdPid, SIGTERM );
+      waitpid( cmsdPid, 0, 0 );
+      cmsdPid = 0;
+    }
+    if( !benchDir.empty() && !cfg.keep )
+    {
+      std::string cmd = "rm -rf '" + benchDir + "'";
+      if( system( cmd.c_str() ) ) {}
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // CPU seconds used so far by the manager we started
+  //----------------------------------------------------------------------------
+  double ManagerCPU()
+  {
+    char fn[64], buff[1024];
+    snprintf( fn, sizeof( fn ), "/proc/%d/stat", (int)cmsdPid );
+    FILE *fp = ( cmsdPid ? fopen( fn, "r" ) : 0 );
+    if( !fp ) return -1;
+    size_t n = fread( buff, 1, sizeof( buff ) - 1, fp );
+    fclose( fp );
+    buff[n] = 0;
+    char *p = strrchr( buff, ')' );
+    unsigned long long utime, stime;
+    if( !p || sscanf( p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+                             "%llu %llu", &utime, &stime ) != 2 ) return -1;
+    return double( utime + stime ) / sysconf( _SC_CLK_TCK );
+  }
+
+  //----------------------------------------------------------------------------
+  // Usage
+  //----------------------------------------------------------------------------
+  void Usage( int rc )
+  {
+    fprintf( stderr,
+      "Usage: xrdcmsbench [-b] [-c <dirs>] [-d <dir>] [-e <directive>] [-f <files>]\n"
+      "                   [-k] [-l <base>[,<spread>[,<skew>]]] [-m <host:port>]\n"
+      "                   [-n <ops>] [-o <kind>[,<kind>...]] [-p <pct>]\n"
+      "                   [-q <rate>] [-r <replicas>] [-s <servers>]\n"
+      "                   [-u <pct>] [-w <window>] [-x <cmsd>] [-y <us>]\n\n"
+      "-b  servers accept batched state queries (statev), which the manager\n"
+      "    only sends when given -e 'cms.delay qbatch <msec>'\n"
+      "-c  number of director logins (default 4)\n"
+      "-d  directory for the scratch area (default /dev/shm)\n"
+      "-e  additional directive for the started cmsd (may be repeated)\n"
+      "-f  number of files in the name space (default 100000)\n"
+      "-k  keep the scratch area\n"
+      "-l  server load in percent, its random spread and the extra load of\n"
+      "    the last server (default 20,10,0)\n"
+      "-m  use the manager at host:port\n"
+      "-n  requests per director (default 20000)\n"
+      "-o  request kinds to cycle through: read, stat, write, locate\n"
+      "    (default read)\n"
+      "-p  percent of file copies reported as pending (default 0)\n"
+      "-q  total requests per second, 0 for as fast as possible (default 0)\n"
+      "-r  number of servers holding each file (default 2)\n"
+      "-s  number of emulated data servers (default 32)\n"
+      "-u  percent of requests for files no server has (default 0)\n"
+      "-w  outstanding requests per director (default 32)\n"
+      "-x  cmsd executable (default " XRDBENCH_CMSD ")\n"
+      "-y  microseconds a server takes to answer a state query (default 0)\n" );
+    exit( rc );
+  }
+
+  int Number( const char *arg, int min )
+  {
+    char *end;
+    long val = strtol( arg, &end, 10 );
+    switch( *end )
+    {
+      case 'k': case 'K': val *= 1000;    end++; break;
+      case 'm': case 'M': val *= 1000000; end++; break;
+    }
+    if( *end || val < min )
+    {
+      fprintf( stderr, "xrdcmsbench: invalid number '%s'\n", arg );
+      Usage( 2 );
+    }
+    return val;
+  }
+
+  void PrintLatency( const char *name, std::vector<uint32_t> &lat,
+                     long long total )
+  {
+    std::sort( lat.begin(), lat.end() );
+    size_t n = lat.size();
+    if( !n ) return;
+#define PCTL(p) lat[std::min( n - 1, (size_t)( n * p ) )]
+    printf( "%-9s %9zu %6.2f %8u %8u %8u %8u %8u\n", name, n,
+            100.0 * n / total, PCTL( 0.50 ), PCTL( 0.90 ), PCTL( 0.99 ),
+            PCTL( 0.999 ), lat[n - 1] );
+#undef PCTL
+  }
+}
+
+//------------------------------------------------------------------------------
+// Main
+//------------------------------------------------------------------------------
+int main( int argc, char **argv )
+{
+  int c;
+  while( ( c = getopt( argc, argv, "bc:d:e:f:hkl:m:n:o:p:q:r:s:u:w:x:y:" ) )
+         != -1 )
+  {
+    switch( c )
+    {
+      case 'b': cfg.batchq     = true;                  break;
+      case 'c': cfg.directors  = Number( optarg, 1 );   break;
+      case 'd': cfg.workDir    = optarg;                break;
+      case 'e': cfg.extra     += std::string( optarg ) + "\n"; break;
+      case 'f': cfg.files      = Number( optarg, 1 );   break;
+      case 'k': cfg.keep       = true;                  break;
+      case 'l':
+      {
+        int v[3] = { cfg.loadBase, cfg.loadSpread, cfg.loadSkew };
+        if( sscanf( optarg, "%d,%d,%d", &v[0], &v[1], &v[2] ) < 1
+        ||  v[0] < 0 || v[1] < 0 || v[2] < 0 )
+        {
+          fprintf( stderr, "xrdcmsbench: invalid load model '%s'\n", optarg );
+          Usage( 2 );
+        }
+        cfg.loadBase = v[0]; cfg.loadSpread = v[1]; cfg.loadSkew = v[2];
+        break;
+      }
+      case 'm': cfg.manager    = optarg;                break;
+      case 'n': cfg.ops        = Number( optarg, 1 );   break;
+      case 'o': cfg.ops2       = optarg;                break;
+      case 'p': cfg.pending    = Number( optarg, 0 );   break;
+      case 'q': cfg.rate       = Number( optarg, 0 );   break;
+      case 'r': cfg.replicas   = Number( optarg, 0 );   break;
+      case 's': cfg.servers    = Number( optarg, 1 );   break;
+      case 'u': cfg.missing    = Number( optarg, 0 );   break;
+      case 'w': cfg.window     = Number( optarg, 1 );   break;
+      case 'x': cfg.cmsd       = optarg;                break;
+      case 'y': cfg.stateDelay = Number( optarg, 0 );   break;
+      case 'h': Usage( 0 );                         break;
+      default:  Usage( 2 );
+    }
+  }
+  if( optind < argc || cfg.window > 0xffff || cfg.pending > 100
+  ||  cfg.missing > 100 )
+    Usage( 2 );
+  cfg.replicas = std::min( cfg.replicas, cfg.servers );
+
+  // Pick the request kinds
+  //
+  std::string olist = cfg.ops2 + ",";
+  for( size_t b = 0, e; ( e = olist.find( ',', b ) ) != std::string::npos;
+       b = e + 1 )
+  {
+    std::string kind = olist.substr( b, e - b );
+    int i;
+    for( i = 0; i < numRequests && kind != requests[i].name; ++i ) {}
+    if( i >= numRequests )
+    {
+      fprintf( stderr, "xrdcmsbench: unknown request kind '%s'\n",
+               kind.c_str() );
+      Usage( 2 );
+    }
+    mix.push_back( &requests[i] );
+  }
+
+  // Get a manager
+  //
+  signal( SIGPIPE, SIG_IGN );
+  if( !cfg.manager.empty() )
+  {
+    size_t p = cfg.manager.rfind( ':' );
+    if( p == std::string::npos || !( manPort = atoi( &cfg.manager[p + 1] ) ) )
+    {
+      fprintf( stderr, "xrdcmsbench: invalid manager '%s'\n",
+               cfg.manager.c_str() );
+      Usage( 2 );
+    }
+    manHost = cfg.manager.substr( 0, p );
+  }
+  else if( !StartManager() )
+  {
+    StopManager();
+    return 3;
+  }
+
+  // Log in the data servers. A manager takes at most STMax of them, the others
+  // are expected to be turned away.
+  //
+  std::vector<DataServer> sv( cfg.servers );
+  int loggedIn = 0;
+  for( int i = 0; i < cfg.servers; ++i )
+  {
+    sv[i].idx = i; sv[i].seed = 777 + i;
+    if( pthread_create( &sv[i].tid, 0, RunServer, &sv[i] ) )
+    {
+      fprintf( stderr, "xrdcmsbench: unable to start thread; %s\n",
+               strerror( errno ) );
+      exit( 4 );
+    }
+  }
+  for( int i = 0; i < 50 && loggedIn < cfg.servers; ++i )
+  {
+    usleep( 100000 );
+    loggedIn = 0;
+    for( int j = 0; j < cfg.servers; ++j )
+      if( sv[j].state ) loggedIn++;
+  }
+  bool ok = WaitReady();
+  loggedIn = 0;
+  for( int i = 0; i < cfg.servers; ++i )
+    if( sv[i].state > 0 ) loggedIn++;
+    else if( loggedIn == i )
+      fprintf( stderr, "xrdcmsbench: server %d not logged in; %s\n", i,
+               sv[i].err.c_str() );
+  printf( "# %d of %d servers logged in; %d files, %d replicas, %d%% pending, "
+          "load %d+-%d skew %d%s\n", loggedIn, cfg.servers, cfg.files,
+          cfg.replicas, cfg.pending, cfg.loadBase, cfg.loadSpread,
+          cfg.loadSkew, cfg.batchq ? ", batched queries" : "" );
+  ok = ok && loggedIn > 0;
+
+  // Drive the directors
+  //
+  std::vector<Director> dv( cfg.directors );
+  double secs = 0, cpu0 = ManagerCPU(), cpu1 = cpu0;
+  if( ok )
+  {
+    pthread_barrier_t start;
+    pthread_barrier_init( &start, 0, cfg.directors + 1 );
+    for( int i = 0; i < cfg.directors; ++i )
+    {
+      dv[i].idx = i; dv[i].seed = 12345 + i; dv[i].start = &start;
+      if( !DirectorLogin( &dv[i] ) )
+      {
+        fprintf( stderr, "xrdcmsbench: director login failed; %s\n",
+                 dv[i].err.c_str() );
+        exit( 4 );
+      }
+      if( pthread_create( &dv[i].tid, 0, RunDirector, &dv[i] ) )
+      {
+        fprintf( stderr, "xrdcmsbench: unable to start thread; %s\n",
+                 strerror( errno ) );
+        exit( 4 );
+      }
+    }
+    pthread_barrier_wait( &start );
+    for( int i = 0; i < cfg.directors; ++i ) pthread_join( dv[i].tid, 0 );
+    pthread_barrier_destroy( &start );
+    cpu1 = ManagerCPU();
+
+    uint64_t t0 = dv[0].t0, t1 = dv[0].t1;
+    for( int i = 1; i < cfg.directors; ++i )
+    {
+      t0 = std::min( t0, dv[i].t0 );
+      t1 = std::max( t1, dv[i].t1 );
+    }
+    secs = ( t1 - t0 ) / 1e9;
+  }
+
+  // Stop the servers
+  //
+  stopping = true;
+  for( int i = 0; i < cfg.directors; ++i )
+    if( dv[i].fd >= 0 ) close( dv[i].fd );
+  for( int i = 0; i < cfg.servers; ++i )
+    if( sv[i].fd >= 0 ) shutdown( sv[i].fd, SHUT_RDWR );
+  for( int i = 0; i < cfg.servers; ++i )
+  {
+    pthread_join( sv[i].tid, 0 );
+    if( sv[i].fd >= 0 ) close( sv[i].fd );
+  }
+
+  // Report
+  //
+  if( ok )
+  {
+    std::vector<uint32_t> lat[oNumOutcomes];
+    std::vector<long long> perServer( cfg.servers, 0 );
+    long long total = 0, waitResp = 0, unmatched = 0, misdirected = 0;
+    for( int i = 0; i < cfg.directors; ++i )
+    {
+      for( int j = 0; j < oNumOutcomes; ++j )
+      {
+        lat[j].insert( lat[j].end(), dv[i].latency[j].begin(),
+                       dv[i].latency[j].end() );
+        total += dv[i].latency[j].size();
+      }
+      for( int j = 0; j < cfg.servers; ++j )
+        perServer[j] += dv[i].perServer[j];
+      waitResp    += dv[i].waitResp;
+      unmatched   += dv[i].unmatched;
+      misdirected += dv[i].misdirected;
+      if( !dv[i].err.empty() )
+      {
+        fprintf( stderr, "xrdcmsbench: director %d: %s\n", i,
+                 dv[i].err.c_str() );
+        ok = false;
+      }
+    }
+
+    printf( "# %lld requests (%s) from %d directors, window %d, in %.3f s: "
+            "%.0f req/s", total, cfg.ops2.c_str(), cfg.directors, cfg.window,
+            secs, total / secs );
+    if( cpu0 >= 0 && cpu1 >= 0 )
+      printf( ", cmsd cpu %.1f%%", 100.0 * ( cpu1 - cpu0 ) / secs );
+    printf( "\n%-9s %9s %6s %8s %8s %8s %8s %8s\n", "#reply", "count", "pct",
+            "p50us", "p90us", "p99us", "p999us", "maxus" );
+    for( int i = 0; i < oNumOutcomes; ++i )
+      PrintLatency( outcomeName[i], lat[i], total );
+
+    long long rmin = -1, rmax = 0;
+    for( int i = 0; i < cfg.servers; ++i )
+      if( sv[i].state > 0 )
+      {
+        rmin = ( rmin < 0 ? perServer[i] : std::min( rmin, perServer[i] ) );
+        rmax = std::max( rmax, perServer[i] );
+      }
+    printf( "# redirects per server min %lld max %lld; %lld misdirected, "
+            "%lld waitresp, %lld unmatched\n", std::max( rmin, 0LL ), rmax,
+            misdirected, waitResp, unmatched );
+
+    long long counts[sNumCounts] = { 0 };
+    for( int i = 0; i < cfg.servers; ++i )
+      for( int j = 0; j < sNumCounts; ++j ) counts[j] += sv[i].counts[j];
+    printf( "# server messages:" );
+    for( int j = 0; j < sNumCounts; ++j )
+      printf( " %s %lld", srvCountName[j], counts[j] );
+    printf( "\n" );
+    if( lat[oLost].size() ) ok = false;
+  }
+
+  StopManager();
+  return ok ? 0 : 1;
+}